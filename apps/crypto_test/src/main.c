@@ -26,6 +26,7 @@
 #include "crypto/crypto.h"
 #include "mbedtls/aes.h"
 #include "tinycrypt/aes.h"
+#include "tinycrypt/sha256.h"
 
 struct vector_data {
     char *plain;
@@ -282,6 +283,49 @@ run_benchmark(char *name, block_encrypt_func_t encfn, void *data, uint8_t iter)
     }
     printf("done in %lu ticks\n", os_time_get() - t);
 }
+
+/*
+ * Reports cost of tinycrypt kernels in CPU cycles per byte, computed from
+ * elapsed cputime and CRYPTOTEST_CPU_FREQ_MHZ.
+ */
+static void
+print_cpb(char *name, uint32_t start, uint32_t bytes)
+{
+    uint32_t usecs;
+    uint32_t cpb;
+
+    usecs = os_cputime_ticks_to_usecs(os_cputime_get32() - start);
+    cpb = (uint64_t)usecs * MYNEWT_VAL(CRYPTOTEST_CPU_FREQ_MHZ) * 100 / bytes;
+
+    printf("%s: %lu us, %lu.%02lu cycles/byte\n", name, (unsigned long)usecs,
+           (unsigned long)(cpb / 100), (unsigned long)(cpb % 100));
+}
+
+static void
+run_cpb_benchmark(struct tc_aes_key_sched_struct *tc_aes)
+{
+    struct tc_sha256_state_struct sha;
+    uint8_t output[TC_SHA256_DIGEST_SIZE];
+    uint16_t blkidx;
+    uint32_t start;
+    int i;
+
+    start = os_cputime_get32();
+    for (i = 0; i < 8; i++) {
+        for (blkidx = 0; blkidx < 4096; blkidx += AES_BLOCK_LEN) {
+            tc_aes_encrypt(output, &aes_128_ecb_input[blkidx], tc_aes);
+        }
+    }
+    print_cpb("TINYCRYPT AES-128", start, 8 * 4096);
+
+    start = os_cputime_get32();
+    tc_sha256_init(&sha);
+    for (i = 0; i < 8; i++) {
+        tc_sha256_update(&sha, aes_128_ecb_input, 4096);
+    }
+    tc_sha256_final(output, &sha);
+    print_cpb("TINYCRYPT SHA-256", start, 8 * 4096);
+}
 #endif /* MYNEWT_VAL(CRYPTOTEST_BENCHMARK) */
 
 #if MYNEWT_VAL(CRYPTOTEST_CONCURRENCY)
@@ -407,6 +451,143 @@ run_inplace_test(struct crypto_dev *crypto)
 }
 #endif /* MYNEWT_VAL(CRYPTOTEST_INPLACE) */
 
+#if MYNEWT_VAL(CRYPTOTEST_AEAD)
+struct aead_test {
+    uint16_t mode;
+    char *name;
+    char *key;
+    char *nonce;
+    uint16_t noncelen;
+    char *aad;
+    uint32_t aadlen;
+    char *plain;
+    char *cipher;
+    uint32_t len;
+    char *tag;
+    uint16_t taglen;
+};
+
+static int
+aead_op(struct crypto_dev *crypto, uint8_t op, struct aead_test *t,
+        uint8_t *buf, uint8_t *tag)
+{
+    if (t->mode == CRYPTO_MODE_GCM) {
+        if (op == CRYPTO_OP_ENCRYPT) {
+            return crypto_encrypt_aes_gcm(crypto, t->key, 128, t->nonce,
+                    t->noncelen, t->aad, t->aadlen, buf, buf, t->len, tag,
+                    t->taglen);
+        }
+        return crypto_decrypt_aes_gcm(crypto, t->key, 128, t->nonce,
+                t->noncelen, t->aad, t->aadlen, buf, buf, t->len, tag,
+                t->taglen);
+    }
+
+    if (op == CRYPTO_OP_ENCRYPT) {
+        return crypto_encrypt_aes_ccm(crypto, t->key, 128, t->nonce,
+                t->noncelen, t->aad, t->aadlen, buf, buf, t->len, tag,
+                t->taglen);
+    }
+    return crypto_decrypt_aes_ccm(crypto, t->key, 128, t->nonce,
+            t->noncelen, t->aad, t->aadlen, buf, buf, t->len, tag,
+            t->taglen);
+}
+
+void
+run_aead_test(struct crypto_dev *crypto)
+{
+    /*
+     * GCM: "The Galois/Counter Mode of Operation", test case 4
+     * CCM: RFC 3610, packet vector #1
+     */
+    struct aead_test data[] = {
+        {
+            .mode = CRYPTO_MODE_GCM,
+            .name = "AES-128-GCM",
+            .key =
+            "\xfe\xff\xe9\x92\x86\x65\x73\x1c\x6d\x6a\x8f\x94\x67\x30\x83\x08",
+            .nonce = "\xca\xfe\xba\xbe\xfa\xce\xdb\xad\xde\xca\xf8\x88",
+            .noncelen = 12,
+            .aad =
+            "\xfe\xed\xfa\xce\xde\xad\xbe\xef\xfe\xed\xfa\xce\xde\xad\xbe\xef"
+            "\xab\xad\xda\xd2",
+            .aadlen = 20,
+            .plain =
+            "\xd9\x31\x32\x25\xf8\x84\x06\xe5\xa5\x59\x09\xc5\xaf\xf5\x26\x9a"
+            "\x86\xa7\xa9\x53\x15\x34\xf7\xda\x2e\x4c\x30\x3d\x8a\x31\x8a\x72"
+            "\x1c\x3c\x0c\x95\x95\x68\x09\x53\x2f\xcf\x0e\x24\x49\xa6\xb5\x25"
+            "\xb1\x6a\xed\xf5\xaa\x0d\xe6\x57\xba\x63\x7b\x39",
+            .cipher =
+            "\x42\x83\x1e\xc2\x21\x77\x74\x24\x4b\x72\x21\xb7\x84\xd0\xd4\x9c"
+            "\xe3\xaa\x21\x2f\x2c\x02\xa4\xe0\x35\xc1\x7e\x23\x29\xac\xa1\x2e"
+            "\x21\xd5\x14\xb2\x54\x66\x93\x1c\x7d\x8f\x6a\x5a\xac\x84\xaa\x05"
+            "\x1b\xa3\x0b\x39\x6a\x0a\xac\x97\x3d\x58\xe0\x91",
+            .len = 60,
+            .tag = "\x5b\xc9\x4f\xbc\x32\x21\xa5\xdb\x94\xfa\xe9\x5a\xe7\x12\x1a\x47",
+            .taglen = 16,
+        },
+        {
+            .mode = CRYPTO_MODE_CCM,
+            .name = "AES-128-CCM",
+            .key =
+            "\xc0\xc1\xc2\xc3\xc4\xc5\xc6\xc7\xc8\xc9\xca\xcb\xcc\xcd\xce\xcf",
+            .nonce = "\x00\x00\x00\x03\x02\x01\x00\xa0\xa1\xa2\xa3\xa4\xa5",
+            .noncelen = 13,
+            .aad =
+            "\x00\x01\x02\x03\x04\x05\x06\x07",
+            .aadlen = 8,
+            .plain =
+            "\x08\x09\x0a\x0b\x0c\x0d\x0e\x0f\x10\x11\x12\x13\x14\x15\x16\x17"
+            "\x18\x19\x1a\x1b\x1c\x1d\x1e",
+            .cipher =
+            "\x58\x8c\x97\x9a\x61\xc6\x63\xd2\xf0\x66\xd0\xc2\xc0\xf9\x89\x80"
+            "\x6d\x5f\x6b\x61\xda\xc3\x84",
+            .len = 23,
+            .tag = "\x17\xe8\xd1\x2c\xfd\xf9\x26\xe0",
+            .taglen = 8,
+        },
+    };
+    uint8_t i;
+    int rc;
+    uint8_t buf[64];
+    uint8_t tag[AES_BLOCK_LEN];
+
+    for (i = 0; i < ARRAY_SIZE(data); i++) {
+        memcpy(buf, data[i].plain, data[i].len);
+
+        printf("%s enc: ", data[i].name);
+        rc = aead_op(crypto, CRYPTO_OP_ENCRYPT, &data[i], buf, tag);
+        if (rc == 0 && memcmp(buf, data[i].cipher, data[i].len) == 0 &&
+            memcmp(tag, data[i].tag, data[i].taglen) == 0) {
+            printf("ok\n");
+        } else {
+            printf("fail\n");
+        }
+
+        memcpy(buf, data[i].cipher, data[i].len);
+        memcpy(tag, data[i].tag, data[i].taglen);
+
+        printf("%s dec: ", data[i].name);
+        rc = aead_op(crypto, CRYPTO_OP_DECRYPT, &data[i], buf, tag);
+        if (rc == 0 && memcmp(buf, data[i].plain, data[i].len) == 0) {
+            printf("ok\n");
+        } else {
+            printf("fail\n");
+        }
+
+        memcpy(buf, data[i].cipher, data[i].len);
+        tag[0] ^= 1;
+
+        printf("%s auth: ", data[i].name);
+        rc = aead_op(crypto, CRYPTO_OP_DECRYPT, &data[i], buf, tag);
+        if (rc == SYS_EACCES) {
+            printf("ok\n");
+        } else {
+            printf("fail\n");
+        }
+    }
+}
+#endif /* MYNEWT_VAL(CRYPTOTEST_AEAD) */
+
 #if MYNEWT_VAL(CRYPTOTEST_IOVEC)
 struct iov_data_block {
     char *plain;
@@ -623,6 +804,11 @@ main(void)
     run_inplace_test(crypto);
 #endif
 
+#if MYNEWT_VAL(CRYPTOTEST_AEAD)
+    printf("\n=== AEAD encrypt/decrypt ===\n");
+    run_aead_test(crypto);
+#endif
+
 #if MYNEWT_VAL(CRYPTOTEST_IOVEC)
     printf("\n=== iovec encrypt/decrypt ===\n");
     run_iovec_test(crypto);
@@ -642,6 +828,9 @@ main(void)
         run_benchmark("TINYCRYPT", tc_enc_block, &tc_aes, iterations);
         os_time_delay(OS_TICKS_PER_SEC);
     }
+
+    printf("\n=== Cycles per byte ===\n");
+    run_cpb_benchmark(&tc_aes);
 #endif
 
 #if MYNEWT_VAL(CRYPTOTEST_CONCURRENCY)
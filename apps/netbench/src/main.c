@@ -0,0 +1,850 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Network throughput and latency benchmark over mn_socket, so it runs the
+ * same on lwIP and on native sockets.  Two instances talk to each other,
+ * one running the server side (started at boot), the other driving tests
+ * from the shell:
+ *
+ *  nb tcp <addr> [secs] [streams] [len]   TCP streams to <addr>'s sink
+ *  nb udp <addr> [secs] [len]             UDP datagrams to <addr>'s sink
+ *  nb ping <addr> [count] [len] [tcp]     ping-pong through <addr>'s echo
+ *  nb stats                               what the local sink received
+ *
+ * The sink listens on NETBENCH_PORT, the echo on NETBENCH_PORT + 1, both
+ * TCP and UDP.  Results are printed as one JSON object per line:
+ *
+ *  {"bench":"tcp","streams":2,"len":1024,"ms":10000,"bytes":5324800,
+ *   "bps":4259840,"cpu":38,"isr":11,"msys_1":{"blocks":24,"min_free":3}}
+ *
+ * "cpu" and "isr" are the percentage of time spent outside the idle task
+ * and in interrupt handlers, reported when OS_TASK_CPU_STATS is enabled.
+ * The msys low watermarks are reset at the start of each test.
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include "os/mynewt.h"
+#include "console/console.h"
+#include "shell/shell.h"
+#include "parse/parse.h"
+#include "mn_socket/mn_socket.h"
+
+#ifdef ARCH_sim
+#include <mcu/mcu_sim.h>
+#endif
+
+#define NB_PORT                 MYNEWT_VAL(NETBENCH_PORT)
+#define NB_STREAMS_MAX          MYNEWT_VAL(NETBENCH_STREAMS_MAX)
+#define NB_CONNS_MAX            MYNEWT_VAL(NETBENCH_CONNS_MAX)
+#define NB_LEN_MAX              1460
+#define NB_STACK_SIZE           OS_STACK_ALIGN(MYNEWT_VAL(NETBENCH_STACK_SIZE))
+
+/* How long a ping waits for its echo */
+#define NB_PING_TMO             OS_TICKS_PER_SEC
+
+enum nb_test {
+    NB_TEST_NONE = 0,
+    NB_TEST_TCP,
+    NB_TEST_UDP,
+    NB_TEST_PING_UDP,
+    NB_TEST_PING_TCP,
+};
+
+/*
+ * A socket of a test or of the server.  Socket callbacks run in the
+ * network stack's task; they only post the socket's event, which the
+ * benchmark task services.
+ */
+struct nb_sock {
+    struct os_event ns_ev;
+    struct mn_socket *ns_sock;
+    uint64_t ns_bytes;
+    uint32_t ns_start;
+    uint8_t ns_connected:1;
+    uint8_t ns_closed:1;
+    uint8_t ns_echo:1;
+    uint8_t ns_udp:1;
+};
+
+static struct os_task nb_task;
+static os_stack_t nb_stack[NB_STACK_SIZE];
+static struct os_eventq nb_evq;
+
+/* Data sent by tests */
+static uint8_t nb_pattern[NB_LEN_MAX];
+
+/*** Current test, driven from the shell. */
+
+static struct {
+    enum nb_test test;
+    struct mn_sockaddr_in addr;
+    uint32_t secs;
+    uint16_t len;
+    uint8_t streams;
+    uint32_t count;
+
+    uint32_t start;
+    uint64_t idle;
+    uint64_t isr;
+    struct nb_sock socks[NB_STREAMS_MAX];
+
+    /* Ping state */
+    uint32_t seq;
+    uint32_t sent_at;
+    uint32_t rtt_min;
+    uint32_t rtt_max;
+    uint64_t rtt_sum;
+    uint32_t rtt_n;
+    uint32_t lost;
+} nb;
+
+static struct os_callout nb_end_callout;
+static struct os_callout nb_retry_callout;
+static struct os_event nb_start_ev;
+
+/*** Server side. */
+
+static struct nb_sock nb_srv_listen[2];
+static struct nb_sock nb_srv_udp[2];
+static struct nb_sock nb_srv_conns[NB_CONNS_MAX];
+static uint64_t nb_srv_udp_bytes;
+static uint32_t nb_srv_udp_pkts;
+static uint32_t nb_srv_udp_first;
+static uint32_t nb_srv_udp_last;
+
+static void nb_sock_event(struct os_event *ev);
+
+static uint32_t
+nb_ms_since(uint32_t start)
+{
+    return os_cputime_ticks_to_usecs(os_cputime_get32() - start) / 1000;
+}
+
+static uint64_t
+nb_bps(uint64_t bytes, uint32_t ms)
+{
+    return ms ? bytes * 1000 / ms : 0;
+}
+
+/*
+ * Reset the msys low watermarks and sample the CPU counters, at the start
+ * of a test.
+ */
+static void
+nb_stats_start(void)
+{
+    struct os_mempool_info omi;
+    struct os_mempool *mp;
+#if MYNEWT_VAL(OS_TASK_CPU_STATS)
+    struct os_cpu_stats ocs;
+#endif
+    os_sr_t sr;
+
+    mp = NULL;
+    while ((mp = os_mempool_info_get_next(mp, &omi)) != NULL) {
+        if (!strncmp(omi.omi_name, "msys", 4)) {
+            OS_ENTER_CRITICAL(sr);
+            mp->mp_min_free = mp->mp_num_free;
+            OS_EXIT_CRITICAL(sr);
+        }
+    }
+
+#if MYNEWT_VAL(OS_TASK_CPU_STATS)
+    os_cpu_stats_get(&ocs);
+    nb.idle = ocs.ocs_idle_time;
+    nb.isr = ocs.ocs_isr_time;
+#endif
+    nb.start = os_cputime_get32();
+}
+
+/*
+ * Print the end of a result line: CPU use and msys watermarks.
+ */
+static void
+nb_stats_report(void)
+{
+    struct os_mempool_info omi;
+    struct os_mempool *mp;
+#if MYNEWT_VAL(OS_TASK_CPU_STATS)
+    struct os_cpu_stats ocs;
+    uint32_t elapsed;
+    uint32_t idle;
+    uint32_t isr;
+
+    elapsed = os_cputime_get32() - nb.start;
+    os_cpu_stats_get(&ocs);
+    idle = ocs.ocs_idle_time - nb.idle;
+    isr = ocs.ocs_isr_time - nb.isr;
+    if (elapsed) {
+        console_printf(",\"cpu\":%lu,\"isr\":%lu",
+                       (unsigned long)(100 - (uint64_t)idle * 100 / elapsed),
+                       (unsigned long)((uint64_t)isr * 100 / elapsed));
+    }
+#endif
+
+    mp = NULL;
+    while ((mp = os_mempool_info_get_next(mp, &omi)) != NULL) {
+        if (!strncmp(omi.omi_name, "msys", 4)) {
+            console_printf(",\"%s\":{\"blocks\":%d,\"min_free\":%d}",
+                           omi.omi_name, omi.omi_num_blocks,
+                           omi.omi_min_free);
+        }
+    }
+    console_printf("}\n");
+}
+
+static void
+nb_readable(void *arg, int err)
+{
+    struct nb_sock *ns;
+
+    ns = arg;
+    if (err) {
+        ns->ns_closed = 1;
+    }
+    os_eventq_put(&nb_evq, &ns->ns_ev);
+}
+
+static void
+nb_writable(void *arg, int err)
+{
+    struct nb_sock *ns;
+
+    ns = arg;
+    if (err) {
+        ns->ns_closed = 1;
+    } else {
+        ns->ns_connected = 1;
+    }
+    os_eventq_put(&nb_evq, &ns->ns_ev);
+}
+
+static const union mn_socket_cb nb_sock_cbs = {
+    .socket.readable = nb_readable,
+    .socket.writable = nb_writable,
+};
+
+static void
+nb_sock_close(struct nb_sock *ns)
+{
+    if (ns->ns_sock) {
+        mn_socket_set_cbs(ns->ns_sock, NULL, NULL);
+        mn_close(ns->ns_sock);
+        ns->ns_sock = NULL;
+    }
+    os_eventq_remove(&nb_evq, &ns->ns_ev);
+}
+
+static struct os_mbuf *
+nb_mbuf(uint16_t len)
+{
+    struct os_mbuf *m;
+
+    m = os_msys_get_pkthdr(len, 0);
+    if (m == NULL) {
+        return NULL;
+    }
+    if (os_mbuf_append(m, nb_pattern, len)) {
+        os_mbuf_free_chain(m);
+        return NULL;
+    }
+    return m;
+}
+
+/*** Server */
+
+static void
+nb_srv_conn_event(struct nb_sock *ns)
+{
+    struct os_mbuf *m;
+    uint32_t ms;
+
+    while (mn_recvfrom(ns->ns_sock, &m, NULL) == 0) {
+        if (ns->ns_bytes == 0) {
+            ns->ns_start = os_cputime_get32();
+        }
+        ns->ns_bytes += OS_MBUF_PKTLEN(m);
+        if (!ns->ns_echo || mn_sendto(ns->ns_sock, m, NULL)) {
+            os_mbuf_free_chain(m);
+        }
+    }
+
+    if (ns->ns_closed) {
+        if (!ns->ns_echo && ns->ns_bytes) {
+            ms = nb_ms_since(ns->ns_start);
+            console_printf("{\"bench\":\"tcp_rx\",\"ms\":%lu,\"bytes\":%llu,"
+                           "\"bps\":%llu}\n", (unsigned long)ms,
+                           (unsigned long long)ns->ns_bytes,
+                           (unsigned long long)nb_bps(ns->ns_bytes, ms));
+        }
+        nb_sock_close(ns);
+    }
+}
+
+static void
+nb_srv_udp_event(struct nb_sock *ns)
+{
+    struct mn_sockaddr_in from;
+    struct os_mbuf *m;
+
+    while (mn_recvfrom(ns->ns_sock, &m, (struct mn_sockaddr *)&from) == 0) {
+        if (ns->ns_echo) {
+            if (mn_sendto(ns->ns_sock, m, (struct mn_sockaddr *)&from)) {
+                os_mbuf_free_chain(m);
+            }
+            continue;
+        }
+        if (nb_srv_udp_pkts == 0) {
+            nb_srv_udp_first = os_cputime_get32();
+        }
+        nb_srv_udp_last = os_cputime_get32();
+        nb_srv_udp_bytes += OS_MBUF_PKTLEN(m);
+        nb_srv_udp_pkts++;
+        os_mbuf_free_chain(m);
+    }
+}
+
+static int
+nb_srv_newconn(void *arg, struct mn_socket *new)
+{
+    struct nb_sock *listen;
+    struct nb_sock *ns;
+    int i;
+
+    listen = arg;
+    for (i = 0; i < NB_CONNS_MAX; i++) {
+        ns = &nb_srv_conns[i];
+        if (ns->ns_sock == NULL) {
+            memset(ns, 0, sizeof(*ns));
+            ns->ns_ev.ev_cb = nb_sock_event;
+            ns->ns_ev.ev_arg = ns;
+            ns->ns_sock = new;
+            ns->ns_echo = listen->ns_echo;
+            mn_socket_set_cbs(new, ns, &nb_sock_cbs);
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static const union mn_socket_cb nb_listen_cbs = {
+    .listen.newconn = nb_srv_newconn,
+};
+
+static int
+nb_srv_start(int echo)
+{
+    struct mn_sockaddr_in msin;
+    struct nb_sock *ns;
+    int rc;
+
+    memset(&msin, 0, sizeof(msin));
+    msin.msin_len = sizeof(msin);
+    msin.msin_family = MN_AF_INET;
+    msin.msin_port = htons(NB_PORT + echo);
+
+    ns = &nb_srv_listen[echo];
+    ns->ns_echo = echo;
+    rc = mn_socket(&ns->ns_sock, MN_PF_INET, MN_SOCK_STREAM, 0);
+    if (rc) {
+        return rc;
+    }
+    mn_socket_set_cbs(ns->ns_sock, ns, &nb_listen_cbs);
+    rc = mn_bind(ns->ns_sock, (struct mn_sockaddr *)&msin);
+    if (rc == 0) {
+        rc = mn_listen(ns->ns_sock, NB_CONNS_MAX);
+    }
+    if (rc) {
+        return rc;
+    }
+
+    ns = &nb_srv_udp[echo];
+    ns->ns_ev.ev_cb = nb_sock_event;
+    ns->ns_ev.ev_arg = ns;
+    ns->ns_echo = echo;
+    ns->ns_udp = 1;
+    rc = mn_socket(&ns->ns_sock, MN_PF_INET, MN_SOCK_DGRAM, 0);
+    if (rc) {
+        return rc;
+    }
+    mn_socket_set_cbs(ns->ns_sock, ns, &nb_sock_cbs);
+    return mn_bind(ns->ns_sock, (struct mn_sockaddr *)&msin);
+}
+
+/*** Client tests */
+
+static bool
+nb_is_test_sock(const struct nb_sock *ns)
+{
+    return ns >= nb.socks && ns < nb.socks + NB_STREAMS_MAX;
+}
+
+static void
+nb_test_end(void)
+{
+    uint64_t bytes;
+    uint32_t ms;
+    int i;
+
+    os_callout_stop(&nb_end_callout);
+    os_callout_stop(&nb_retry_callout);
+
+    ms = nb_ms_since(nb.start);
+    bytes = 0;
+    for (i = 0; i < NB_STREAMS_MAX; i++) {
+        bytes += nb.socks[i].ns_bytes;
+        nb_sock_close(&nb.socks[i]);
+    }
+
+    switch (nb.test) {
+    case NB_TEST_TCP:
+    case NB_TEST_UDP:
+        console_printf("{\"bench\":\"%s\",\"streams\":%u,\"len\":%u,"
+                       "\"ms\":%lu,\"bytes\":%llu,\"bps\":%llu",
+                       nb.test == NB_TEST_TCP ? "tcp" : "udp",
+                       nb.streams, nb.len, (unsigned long)ms,
+                       (unsigned long long)bytes,
+                       (unsigned long long)nb_bps(bytes, ms));
+        break;
+    default:
+        console_printf("{\"bench\":\"ping_%s\",\"len\":%u,\"n\":%lu,"
+                       "\"lost\":%lu,\"min_us\":%lu,\"avg_us\":%lu,"
+                       "\"max_us\":%lu",
+                       nb.test == NB_TEST_PING_TCP ? "tcp" : "udp", nb.len,
+                       (unsigned long)nb.rtt_n, (unsigned long)nb.lost,
+                       (unsigned long)os_cputime_ticks_to_usecs(nb.rtt_min),
+                       (unsigned long)(nb.rtt_n ?
+                           os_cputime_ticks_to_usecs(nb.rtt_sum / nb.rtt_n) :
+                           0),
+                       (unsigned long)os_cputime_ticks_to_usecs(nb.rtt_max));
+        break;
+    }
+    nb_stats_report();
+
+    nb.test = NB_TEST_NONE;
+}
+
+/*
+ * Send on a throughput test socket until the stack pushes back.
+ */
+static void
+nb_stream_fill(struct nb_sock *ns)
+{
+    struct os_mbuf *m;
+    int rc;
+
+    if (!ns->ns_connected) {
+        return;
+    }
+
+    while (1) {
+        m = nb_mbuf(nb.len);
+        if (m == NULL) {
+            /* Out of mbufs; try again shortly */
+            os_callout_reset(&nb_retry_callout, 1);
+            return;
+        }
+        rc = mn_sendto(ns->ns_sock, m,
+                       ns->ns_udp ? (struct mn_sockaddr *)&nb.addr : NULL);
+        if (rc) {
+            os_mbuf_free_chain(m);
+            if (rc != MN_ENOBUFS && rc != MN_EAGAIN) {
+                ns->ns_closed = 1;
+            } else if (ns->ns_udp) {
+                /* UDP sockets do not report writable again */
+                os_callout_reset(&nb_retry_callout, 1);
+            }
+            return;
+        }
+        ns->ns_bytes += nb.len;
+    }
+}
+
+static void
+nb_ping_send(void)
+{
+    struct nb_sock *ns;
+    struct os_mbuf *m;
+    int rc;
+
+    ns = &nb.socks[0];
+    if (nb.seq == nb.count) {
+        nb_test_end();
+        return;
+    }
+    nb.seq++;
+    ns->ns_bytes = 0;
+
+    m = nb_mbuf(nb.len);
+    if (m == NULL) {
+        nb.lost++;
+        os_callout_reset(&nb_retry_callout, 1);
+        return;
+    }
+    nb.sent_at = os_cputime_get32();
+    rc = mn_sendto(ns->ns_sock, m,
+                   ns->ns_udp ? (struct mn_sockaddr *)&nb.addr : NULL);
+    if (rc) {
+        os_mbuf_free_chain(m);
+        nb.lost++;
+        os_callout_reset(&nb_retry_callout, 1);
+        return;
+    }
+    os_callout_reset(&nb_end_callout, NB_PING_TMO);
+}
+
+static void
+nb_ping_event(struct nb_sock *ns)
+{
+    struct os_mbuf *m;
+    uint32_t rtt;
+
+    if (nb.seq == 0) {
+        /* Connected, or UDP socket ready */
+        if (ns->ns_connected) {
+            nb_ping_send();
+        }
+        return;
+    }
+
+    while (mn_recvfrom(ns->ns_sock, &m, NULL) == 0) {
+        ns->ns_bytes += OS_MBUF_PKTLEN(m);
+        os_mbuf_free_chain(m);
+    }
+    if (ns->ns_bytes < nb.len) {
+        return;
+    }
+
+    rtt = os_cputime_get32() - nb.sent_at;
+    if (nb.rtt_n == 0 || rtt < nb.rtt_min) {
+        nb.rtt_min = rtt;
+    }
+    if (rtt > nb.rtt_max) {
+        nb.rtt_max = rtt;
+    }
+    nb.rtt_sum += rtt;
+    nb.rtt_n++;
+    nb_ping_send();
+}
+
+static void
+nb_sock_event(struct os_event *ev)
+{
+    struct nb_sock *ns;
+
+    ns = ev->ev_arg;
+    if (!nb_is_test_sock(ns)) {
+        if (ns->ns_udp) {
+            nb_srv_udp_event(ns);
+        } else {
+            nb_srv_conn_event(ns);
+        }
+        return;
+    }
+
+    if (nb.test == NB_TEST_NONE || ns->ns_sock == NULL) {
+        return;
+    }
+
+    if (nb.test == NB_TEST_PING_TCP || nb.test == NB_TEST_PING_UDP) {
+        if (ns->ns_closed) {
+            nb_test_end();
+        } else {
+            nb_ping_event(ns);
+        }
+        return;
+    }
+
+    /* Throughput tests ignore anything sent back */
+    if (!ns->ns_udp) {
+        struct os_mbuf *m;
+
+        while (mn_recvfrom(ns->ns_sock, &m, NULL) == 0) {
+            os_mbuf_free_chain(m);
+        }
+    }
+    if (ns->ns_closed) {
+        console_printf("nb: stream %d closed\n", (int)(ns - nb.socks));
+        nb_sock_close(ns);
+        return;
+    }
+    nb_stream_fill(ns);
+}
+
+static void
+nb_end_cb(struct os_event *ev)
+{
+    if (nb.test == NB_TEST_PING_TCP || nb.test == NB_TEST_PING_UDP) {
+        if (nb.seq == 0) {
+            console_printf("nb: connect timed out\n");
+            nb_test_end();
+            return;
+        }
+        /* Echo did not come back */
+        nb.lost++;
+        nb_ping_send();
+        return;
+    }
+    if (nb.test != NB_TEST_NONE) {
+        nb_test_end();
+    }
+}
+
+static void
+nb_retry_cb(struct os_event *ev)
+{
+    int i;
+
+    switch (nb.test) {
+    case NB_TEST_TCP:
+    case NB_TEST_UDP:
+        for (i = 0; i < nb.streams; i++) {
+            if (nb.socks[i].ns_sock) {
+                nb_stream_fill(&nb.socks[i]);
+            }
+        }
+        break;
+    case NB_TEST_PING_TCP:
+    case NB_TEST_PING_UDP:
+        nb_ping_send();
+        break;
+    default:
+        break;
+    }
+}
+
+static void
+nb_start_cb(struct os_event *ev)
+{
+    struct nb_sock *ns;
+    uint8_t type;
+    int count;
+    int rc;
+    int i;
+
+    nb.seq = 0;
+    nb.rtt_n = 0;
+    nb.rtt_sum = 0;
+    nb.rtt_min = 0;
+    nb.rtt_max = 0;
+    nb.lost = 0;
+
+    type = (nb.test == NB_TEST_TCP || nb.test == NB_TEST_PING_TCP) ?
+           MN_SOCK_STREAM : MN_SOCK_DGRAM;
+    count = (nb.test == NB_TEST_TCP) ? nb.streams : 1;
+
+    nb_stats_start();
+
+    for (i = 0; i < count; i++) {
+        ns = &nb.socks[i];
+        memset(ns, 0, sizeof(*ns));
+        ns->ns_ev.ev_cb = nb_sock_event;
+        ns->ns_ev.ev_arg = ns;
+        ns->ns_udp = type == MN_SOCK_DGRAM;
+
+        rc = mn_socket(&ns->ns_sock, MN_PF_INET, type, 0);
+        if (rc) {
+            console_printf("nb: socket failed: %d\n", rc);
+            nb_test_end();
+            return;
+        }
+        mn_socket_set_cbs(ns->ns_sock, ns, &nb_sock_cbs);
+
+        if (ns->ns_udp) {
+            ns->ns_connected = 1;
+            os_eventq_put(&nb_evq, &ns->ns_ev);
+        } else {
+            rc = mn_connect(ns->ns_sock, (struct mn_sockaddr *)&nb.addr);
+            if (rc) {
+                console_printf("nb: connect failed: %d\n", rc);
+                nb_test_end();
+                return;
+            }
+        }
+    }
+
+    if (nb.test == NB_TEST_TCP || nb.test == NB_TEST_UDP) {
+        os_callout_reset(&nb_end_callout, nb.secs * OS_TICKS_PER_SEC);
+    } else {
+        /* Time allowed for the connection */
+        os_callout_reset(&nb_end_callout, NB_PING_TMO);
+    }
+}
+
+/*** Shell */
+
+static int
+nb_parse_addr(const char *str, uint16_t port)
+{
+    memset(&nb.addr, 0, sizeof(nb.addr));
+    nb.addr.msin_len = sizeof(nb.addr);
+    nb.addr.msin_family = MN_AF_INET;
+    nb.addr.msin_port = htons(port);
+    if (mn_inet_pton(MN_PF_INET, str, &nb.addr.msin_addr) != 1) {
+        console_printf("nb: bad address %s\n", str);
+        return SYS_EINVAL;
+    }
+    return 0;
+}
+
+static int
+nb_arg(int argc, char **argv, int idx, long long min, long long max,
+       long long dflt, int *rc)
+{
+    if (argc <= idx || *rc) {
+        return dflt;
+    }
+    return parse_ll_bounds(argv[idx], min, max, rc);
+}
+
+static void
+nb_stats_cmd(void)
+{
+    uint32_t ms;
+
+    ms = nb_srv_udp_pkts ?
+         os_cputime_ticks_to_usecs(nb_srv_udp_last - nb_srv_udp_first) / 1000 :
+         0;
+    console_printf("{\"bench\":\"udp_rx\",\"pkts\":%lu,\"ms\":%lu,"
+                   "\"bytes\":%llu,\"bps\":%llu}\n",
+                   (unsigned long)nb_srv_udp_pkts, (unsigned long)ms,
+                   (unsigned long long)nb_srv_udp_bytes,
+                   (unsigned long long)nb_bps(nb_srv_udp_bytes, ms));
+    nb_srv_udp_pkts = 0;
+    nb_srv_udp_bytes = 0;
+}
+
+static int
+nb_cmd(int argc, char **argv)
+{
+    int rc;
+
+    rc = 0;
+    if (argc < 2) {
+        goto usage;
+    }
+
+    if (!strcmp(argv[1], "stats")) {
+        nb_stats_cmd();
+        return 0;
+    }
+
+    if (argc < 3) {
+        goto usage;
+    }
+    if (nb.test != NB_TEST_NONE) {
+        console_printf("nb: test in progress\n");
+        return 0;
+    }
+
+    if (!strcmp(argv[1], "tcp")) {
+        nb.secs = nb_arg(argc, argv, 3, 1, 3600, 10, &rc);
+        nb.streams = nb_arg(argc, argv, 4, 1, NB_STREAMS_MAX, 1, &rc);
+        nb.len = nb_arg(argc, argv, 5, 1, NB_LEN_MAX, 1024, &rc);
+        nb.test = NB_TEST_TCP;
+        rc = rc ? rc : nb_parse_addr(argv[2], NB_PORT);
+    } else if (!strcmp(argv[1], "udp")) {
+        nb.secs = nb_arg(argc, argv, 3, 1, 3600, 10, &rc);
+        nb.len = nb_arg(argc, argv, 4, 1, NB_LEN_MAX, 1024, &rc);
+        nb.streams = 1;
+        nb.test = NB_TEST_UDP;
+        rc = rc ? rc : nb_parse_addr(argv[2], NB_PORT);
+    } else if (!strcmp(argv[1], "ping")) {
+        nb.count = nb_arg(argc, argv, 3, 1, 1000000, 100, &rc);
+        nb.len = nb_arg(argc, argv, 4, 1, NB_LEN_MAX, 64, &rc);
+        nb.test = (argc > 5 && !strcmp(argv[5], "tcp")) ?
+                  NB_TEST_PING_TCP : NB_TEST_PING_UDP;
+        rc = rc ? rc : nb_parse_addr(argv[2], NB_PORT + 1);
+    } else {
+        goto usage;
+    }
+
+    if (rc) {
+        nb.test = NB_TEST_NONE;
+        goto usage;
+    }
+
+    os_eventq_put(&nb_evq, &nb_start_ev);
+    return 0;
+
+usage:
+    console_printf("usage: nb tcp <addr> [secs] [streams] [len]\n"
+                   "       nb udp <addr> [secs] [len]\n"
+                   "       nb ping <addr> [count] [len] [tcp]\n"
+                   "       nb stats\n");
+    return 0;
+}
+
+static struct shell_cmd nb_shell_cmd = {
+    .sc_cmd = "nb",
+    .sc_cmd_func = nb_cmd,
+};
+
+static void
+nb_task_handler(void *arg)
+{
+    int rc;
+
+    rc = nb_srv_start(0);
+    if (rc == 0) {
+        rc = nb_srv_start(1);
+    }
+    if (rc) {
+        console_printf("nb: server failed: %d\n", rc);
+    }
+
+    while (1) {
+        os_eventq_run(&nb_evq);
+    }
+}
+
+int
+main(int argc, char **argv)
+{
+    int i;
+
+#ifdef ARCH_sim
+    mcu_sim_parse_args(argc, argv);
+#endif
+
+    sysinit();
+
+    for (i = 0; i < NB_LEN_MAX; i++) {
+        nb_pattern[i] = '0' + i % 10;
+    }
+
+    os_eventq_init(&nb_evq);
+    nb_start_ev.ev_cb = nb_start_cb;
+    os_callout_init(&nb_end_callout, &nb_evq, nb_end_cb, NULL);
+    os_callout_init(&nb_retry_callout, &nb_evq, nb_retry_cb, NULL);
+
+    os_task_init(&nb_task, "netbench", nb_task_handler, NULL,
+                 MYNEWT_VAL(NETBENCH_TASK_PRIO), OS_WAIT_FOREVER, nb_stack,
+                 NB_STACK_SIZE);
+
+    shell_cmd_register(&nb_shell_cmd);
+    console_printf("{\"bench\":\"info\",\"port\":%d}\n", NB_PORT);
+
+    while (1) {
+        os_eventq_run(os_eventq_dflt_get());
+    }
+}
@@ -0,0 +1,403 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Kernel primitive benchmarks.
+ *
+ * Each measurement takes OSBENCH_ITERATIONS samples of the time from one
+ * point to another, usually from an action in the main task to the
+ * moment the higher priority benchmark task runs because of it.  Results
+ * are printed to the console as one JSON object per line:
+ *
+ *  {"bench":"info","bsp":"nordic_pca10040","arch":"cortex_m4",
+ *   "unit":"cycles","freq":64000000,"iterations":1000}
+ *  {"bench":"sem_wakeup","n":1000,"min":412,"avg":420,"max":1283}
+ *  ...
+ *  {"bench":"done"}
+ *
+ * Times are in CPU cycles where the core has a DWT cycle counter, and in
+ * os_cputime ticks otherwise; "unit" and "freq" say which.
+ *
+ * With OSBENCH_MEM, the memory benchmarks in osbench_mem.c follow.
+ */
+
+#include <assert.h>
+#include <string.h>
+#include "os/mynewt.h"
+#include "console/console.h"
+#include "osbench.h"
+
+#define STRX(x)                 #x
+#define STR(x)                  STRX(x)
+
+#define OSBENCH_STACK_SIZE      OS_STACK_ALIGN(256)
+
+/* Far enough out that the callouts under test never expire. */
+#define OSBENCH_CALLOUT_TICKS   (OS_TICKS_PER_SEC * 3600)
+
+static struct os_task osbench_task;
+static os_stack_t osbench_stack[OSBENCH_STACK_SIZE];
+
+/* Benchmark task side of the current measurement. */
+static void (*osbench_task_fn)(void);
+static struct os_sem osbench_start_sem;
+
+static struct os_sem osbench_sem;
+static struct os_sem osbench_done_sem;
+static struct os_mutex osbench_mutex;
+static struct os_eventq osbench_evq;
+static struct os_event osbench_ev;
+static struct hal_timer osbench_timer;
+static struct os_callout osbench_callouts[MYNEWT_VAL(OSBENCH_CALLOUTS) + 1];
+
+struct osbench_stat osbench_stat;
+volatile uint32_t osbench_t0;
+
+void
+osbench_reset(void)
+{
+    memset(&osbench_stat, 0, sizeof(osbench_stat));
+}
+
+void
+osbench_stop(void)
+{
+    uint32_t delta;
+
+    delta = osbench_now() - osbench_t0;
+
+    if (osbench_stat.n == 0 || delta < osbench_stat.min) {
+        osbench_stat.min = delta;
+    }
+    if (delta > osbench_stat.max) {
+        osbench_stat.max = delta;
+    }
+    osbench_stat.sum += delta;
+    osbench_stat.n++;
+}
+
+void
+osbench_report(const char *name, const char *param, int value)
+{
+    console_printf("{\"bench\":\"%s\"", name);
+    if (param != NULL) {
+        console_printf(",\"%s\":%d", param, value);
+    }
+    console_printf(",\"n\":%lu,\"min\":%lu,\"avg\":%lu,\"max\":%lu}\n",
+                   (unsigned long)osbench_stat.n,
+                   (unsigned long)osbench_stat.min,
+                   (unsigned long)(osbench_stat.n ?
+                                   osbench_stat.sum / osbench_stat.n : 0),
+                   (unsigned long)osbench_stat.max);
+}
+
+/**
+ * Runs one measurement: task_fn in the benchmark task, main_fn in the
+ * main task.  The benchmark task has the higher priority, so it runs until
+ * it blocks waiting for the main task, and is done by the time main_fn
+ * returns.
+ */
+static void
+osbench_run(const char *name, void (*task_fn)(void), void (*main_fn)(void))
+{
+    osbench_reset();
+
+    osbench_task_fn = task_fn;
+    os_sem_release(&osbench_start_sem);
+    main_fn();
+
+    osbench_report(name, NULL, 0);
+}
+
+static void
+osbench_task_handler(void *arg)
+{
+    while (1) {
+        os_sem_pend(&osbench_start_sem, OS_TIMEOUT_NEVER);
+        osbench_task_fn();
+    }
+}
+
+/*
+ * Context switch: the main task wakes the sleeping benchmark task and
+ * switches to it directly, the least the scheduler can do.
+ */
+static void
+osbench_ctx_sw_task(void)
+{
+    os_sr_t sr;
+    int i;
+
+    for (i = 0; i < OSBENCH_ITERATIONS; i++) {
+        OS_ENTER_CRITICAL(sr);
+        os_sched_sleep(&osbench_task, OS_TIMEOUT_NEVER);
+        OS_EXIT_CRITICAL(sr);
+        os_sched(NULL);
+        osbench_stop();
+    }
+}
+
+static void
+osbench_ctx_sw_main(void)
+{
+    os_sr_t sr;
+    int i;
+
+    for (i = 0; i < OSBENCH_ITERATIONS; i++) {
+        osbench_start();
+        OS_ENTER_CRITICAL(sr);
+        os_sched_wakeup(&osbench_task);
+        OS_EXIT_CRITICAL(sr);
+        os_sched(&osbench_task);
+    }
+}
+
+/* os_sem_release() to the return from os_sem_pend() in the waiter. */
+static void
+osbench_sem_task(void)
+{
+    int i;
+
+    for (i = 0; i < OSBENCH_ITERATIONS; i++) {
+        os_sem_pend(&osbench_sem, OS_TIMEOUT_NEVER);
+        osbench_stop();
+    }
+}
+
+static void
+osbench_sem_main(void)
+{
+    int i;
+
+    for (i = 0; i < OSBENCH_ITERATIONS; i++) {
+        osbench_start();
+        os_sem_release(&osbench_sem);
+    }
+}
+
+/* os_eventq_put() to the event callback in the task running the queue. */
+static void
+osbench_eventq_cb(struct os_event *ev)
+{
+    osbench_stop();
+}
+
+static void
+osbench_eventq_task(void)
+{
+    int i;
+
+    for (i = 0; i < OSBENCH_ITERATIONS; i++) {
+        os_eventq_run(&osbench_evq);
+    }
+}
+
+static void
+osbench_eventq_main(void)
+{
+    int i;
+
+    for (i = 0; i < OSBENCH_ITERATIONS; i++) {
+        osbench_start();
+        os_eventq_put(&osbench_evq, &osbench_ev);
+    }
+}
+
+/*
+ * os_mutex_release() by the owner to the return from os_mutex_pend() in
+ * the waiter.  The owner runs at the waiter's priority meanwhile.
+ */
+static void
+osbench_mutex_task(void)
+{
+    int i;
+
+    for (i = 0; i < OSBENCH_ITERATIONS; i++) {
+        os_sem_pend(&osbench_sem, OS_TIMEOUT_NEVER);
+        os_mutex_pend(&osbench_mutex, OS_TIMEOUT_NEVER);
+        osbench_stop();
+        os_mutex_release(&osbench_mutex);
+    }
+}
+
+static void
+osbench_mutex_main(void)
+{
+    int i;
+
+    for (i = 0; i < OSBENCH_ITERATIONS; i++) {
+        os_mutex_pend(&osbench_mutex, OS_TIMEOUT_NEVER);
+        /* Lets the benchmark task block on the mutex. */
+        os_sem_release(&osbench_sem);
+        osbench_start();
+        os_mutex_release(&osbench_mutex);
+    }
+}
+
+/*
+ * os_sem_release() in a hal_timer interrupt to the return from
+ * os_sem_pend() in the waiting task.
+ */
+static void
+osbench_isr_timer_cb(void *arg)
+{
+    osbench_start();
+    os_sem_release(&osbench_sem);
+}
+
+static void
+osbench_isr_task(void)
+{
+    int i;
+
+    for (i = 0; i < OSBENCH_ITERATIONS; i++) {
+        os_sem_pend(&osbench_sem, OS_TIMEOUT_NEVER);
+        osbench_stop();
+        os_sem_release(&osbench_done_sem);
+    }
+}
+
+static void
+osbench_isr_main(void)
+{
+    int i;
+
+    for (i = 0; i < OSBENCH_ITERATIONS; i++) {
+        os_cputime_timer_relative(&osbench_timer, 100);
+        os_sem_pend(&osbench_done_sem, OS_TIMEOUT_NEVER);
+    }
+}
+
+static void
+osbench_callout_cb(struct os_event *ev)
+{
+}
+
+/*
+ * os_callout_reset() with a number of other callouts armed.  The one
+ * being reset expires last, so the whole list is walked to insert it.
+ */
+static void
+osbench_callout(int armed)
+{
+    struct os_callout *probe;
+    int i;
+
+    osbench_reset();
+
+    for (i = 0; i < armed; i++) {
+        os_callout_reset(&osbench_callouts[i], OSBENCH_CALLOUT_TICKS + i);
+    }
+
+    probe = &osbench_callouts[armed];
+    for (i = 0; i < OSBENCH_ITERATIONS; i++) {
+        osbench_start();
+        os_callout_reset(probe, OSBENCH_CALLOUT_TICKS + armed);
+        osbench_stop();
+    }
+
+    for (i = 0; i <= armed; i++) {
+        os_callout_stop(&osbench_callouts[i]);
+    }
+
+    osbench_report("callout_reset", "callouts", armed);
+}
+
+static void
+osbench_init(void)
+{
+    int rc;
+    int i;
+
+    osbench_clock_init();
+
+    os_sem_init(&osbench_start_sem, 0);
+    os_sem_init(&osbench_sem, 0);
+    os_sem_init(&osbench_done_sem, 0);
+    os_mutex_init(&osbench_mutex);
+    os_eventq_init(&osbench_evq);
+    osbench_ev.ev_cb = osbench_eventq_cb;
+    os_cputime_timer_init(&osbench_timer, osbench_isr_timer_cb, NULL);
+    for (i = 0; i < MYNEWT_VAL(OSBENCH_CALLOUTS) + 1; i++) {
+        os_callout_init(&osbench_callouts[i], os_eventq_dflt_get(),
+                        osbench_callout_cb, NULL);
+    }
+
+    rc = os_task_init(&osbench_task, "osbench", osbench_task_handler, NULL,
+                      MYNEWT_VAL(OSBENCH_TASK_PRIO), OS_WAIT_FOREVER,
+                      osbench_stack, OSBENCH_STACK_SIZE);
+    assert(rc == 0);
+}
+
+static void
+osbench_run_all(void)
+{
+    int armed;
+
+    console_printf("{\"bench\":\"info\",\"bsp\":\"%s\",\"arch\":\"%s\","
+                   "\"unit\":\"%s\",\"freq\":%lu,\"iterations\":%d}\n",
+                   STR(BSP_NAME), STR(ARCH_NAME), OSBENCH_UNIT,
+                   (unsigned long)OSBENCH_FREQ, OSBENCH_ITERATIONS);
+
+    osbench_run("ctx_switch", osbench_ctx_sw_task, osbench_ctx_sw_main);
+    osbench_run("sem_wakeup", osbench_sem_task, osbench_sem_main);
+    osbench_run("eventq_dispatch", osbench_eventq_task, osbench_eventq_main);
+    osbench_run("mutex_handoff", osbench_mutex_task, osbench_mutex_main);
+    osbench_run("isr_to_task", osbench_isr_task, osbench_isr_main);
+
+    armed = 0;
+    while (1) {
+        osbench_callout(armed);
+        if (armed == MYNEWT_VAL(OSBENCH_CALLOUTS)) {
+            break;
+        }
+        armed = armed ? min(armed * 2, MYNEWT_VAL(OSBENCH_CALLOUTS)) : 1;
+    }
+
+#if MYNEWT_VAL(OSBENCH_MEM)
+    osbench_mem_run();
+#endif
+
+    console_printf("{\"bench\":\"done\"}\n");
+}
+
+/**
+ * main
+ *
+ * Runs the benchmarks once, then serves the default event queue.
+ *
+ * @return int NOTE: this function should never return!
+ */
+int
+main(int argc, char **argv)
+{
+    sysinit();
+
+    osbench_init();
+#if MYNEWT_VAL(OSBENCH_MEM)
+    osbench_mem_init();
+#endif
+    osbench_run_all();
+
+    while (1) {
+        os_eventq_run(os_eventq_dflt_get());
+    }
+
+    return 0;
+}
@@ -0,0 +1,95 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef H_OSBENCH_
+#define H_OSBENCH_
+
+#include <inttypes.h>
+#include "os/mynewt.h"
+
+#define OSBENCH_ITERATIONS      MYNEWT_VAL(OSBENCH_ITERATIONS)
+
+#ifdef DWT_CTRL_CYCCNTENA_Msk
+#define OSBENCH_UNIT            "cycles"
+#define OSBENCH_FREQ            SystemCoreClock
+
+static inline void
+osbench_clock_init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+static inline uint32_t
+osbench_now(void)
+{
+    return DWT->CYCCNT;
+}
+#else
+#define OSBENCH_UNIT            "cputime"
+#define OSBENCH_FREQ            MYNEWT_VAL(OS_CPUTIME_FREQ)
+
+static inline void
+osbench_clock_init(void)
+{
+}
+
+static inline uint32_t
+osbench_now(void)
+{
+    return os_cputime_get32();
+}
+#endif
+
+struct osbench_stat {
+    uint32_t n;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+};
+
+/* Samples of the current measurement. */
+extern struct osbench_stat osbench_stat;
+extern volatile uint32_t osbench_t0;
+
+static inline void
+osbench_start(void)
+{
+    osbench_t0 = osbench_now();
+}
+
+/** Adds the time since osbench_start() as a sample. */
+void osbench_stop(void);
+
+/** Throws away the samples, for the next measurement. */
+void osbench_reset(void);
+
+/**
+ * Prints the samples as a JSON line, with one extra integer "param" field
+ * if param is not NULL.
+ */
+void osbench_report(const char *name, const char *param, int value);
+
+#if MYNEWT_VAL(OSBENCH_MEM)
+void osbench_mem_init(void);
+void osbench_mem_run(void);
+#endif
+
+#endif
@@ -0,0 +1,429 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(OSBENCH_MEM)
+
+/*
+ * Memory benchmarks: mbuf chain operations, memory pools, msys pool
+ * selection and the heap.  They use pools of their own, so other users of
+ * msys and the heap do not show in the numbers, except for the heap
+ * results, which start from whatever state the heap is in.
+ */
+
+#include <assert.h>
+#include <string.h>
+#include "console/console.h"
+#include "osbench.h"
+
+#define OSBENCH_MBUF_DATA       MYNEWT_VAL(OSBENCH_MBUF_DATA_SIZE)
+#define OSBENCH_MBUF_CHAIN      MYNEWT_VAL(OSBENCH_MBUF_CHAIN)
+#define OSBENCH_MBUF_BLOCK      (OSBENCH_MBUF_DATA + sizeof(struct os_mbuf))
+/* Room for a chain being built while another is freed. */
+#define OSBENCH_MBUF_COUNT      (2 * OSBENCH_MBUF_CHAIN + 1)
+
+#define OSBENCH_BLOCK_SIZE      32
+#define OSBENCH_BLOCK_COUNT     8
+/* How often the interrupt competing for the memory pool fires, in usecs. */
+#define OSBENCH_BLOCK_ISR_US    20
+
+#define OSBENCH_MSYS_POOLS      3
+#define OSBENCH_MSYS_COUNT      2
+#define OSBENCH_MSYS_BLOCK(i)   ((48 << (i)) + sizeof(struct os_mbuf) + \
+                                 sizeof(struct os_mbuf_pkthdr))
+
+#define OSBENCH_MALLOC_SLOTS    MYNEWT_VAL(OSBENCH_MALLOC_SLOTS)
+#define OSBENCH_MALLOC_MAX      MYNEWT_VAL(OSBENCH_MALLOC_MAX)
+/* Largest block looked for when measuring fragmentation. */
+#define OSBENCH_MALLOC_PROBE    (64 * 1024)
+
+static os_membuf_t osbench_mbuf_mem[
+    OS_MEMPOOL_SIZE(OSBENCH_MBUF_COUNT, OSBENCH_MBUF_BLOCK)];
+static struct os_mempool osbench_mbuf_mempool;
+static struct os_mbuf_pool osbench_mbuf_pool;
+
+static os_membuf_t osbench_block_mem[
+    OS_MEMPOOL_SIZE(OSBENCH_BLOCK_COUNT, OSBENCH_BLOCK_SIZE)];
+static struct os_mempool osbench_block_pool;
+static struct hal_timer osbench_block_timer;
+
+static os_membuf_t osbench_msys_mem[OSBENCH_MSYS_POOLS][
+    OS_MEMPOOL_SIZE(OSBENCH_MSYS_COUNT, OSBENCH_MSYS_BLOCK(
+                    OSBENCH_MSYS_POOLS - 1))];
+static struct os_mempool osbench_msys_mempools[OSBENCH_MSYS_POOLS];
+static struct os_mbuf_pool osbench_msys_pools[OSBENCH_MSYS_POOLS];
+
+static uint8_t osbench_flat[OSBENCH_MBUF_CHAIN * OSBENCH_MBUF_DATA];
+static void *osbench_slots[OSBENCH_MALLOC_SLOTS];
+static uint16_t osbench_slot_sizes[OSBENCH_MALLOC_SLOTS];
+static uint32_t osbench_rand_state;
+
+static uint32_t
+osbench_rand(void)
+{
+    osbench_rand_state = osbench_rand_state * 1103515245 + 12345;
+    return osbench_rand_state >> 16;
+}
+
+/* A chain of n full mbufs. */
+static struct os_mbuf *
+osbench_mbuf_chain(int n)
+{
+    struct os_mbuf *om;
+    int rc;
+
+    om = os_mbuf_get(&osbench_mbuf_pool, 0);
+    assert(om != NULL);
+    rc = os_mbuf_append(om, osbench_flat, n * OSBENCH_MBUF_DATA);
+    assert(rc == 0);
+
+    return om;
+}
+
+/*
+ * os_mbuf_append() of n mbufs worth of data to an empty mbuf, then
+ * os_mbuf_copydata() of it all back out.
+ */
+static void
+osbench_mbuf_append(int n)
+{
+    struct os_mbuf *om;
+    int rc;
+    int i;
+
+    osbench_reset();
+    for (i = 0; i < OSBENCH_ITERATIONS; i++) {
+        om = os_mbuf_get(&osbench_mbuf_pool, 0);
+        assert(om != NULL);
+
+        osbench_start();
+        rc = os_mbuf_append(om, osbench_flat, n * OSBENCH_MBUF_DATA);
+        osbench_stop();
+        assert(rc == 0);
+
+        os_mbuf_free_chain(om);
+    }
+    osbench_report("mbuf_append", "mbufs", n);
+
+    osbench_reset();
+    om = osbench_mbuf_chain(n);
+    for (i = 0; i < OSBENCH_ITERATIONS; i++) {
+        osbench_start();
+        rc = os_mbuf_copydata(om, 0, n * OSBENCH_MBUF_DATA, osbench_flat);
+        osbench_stop();
+        assert(rc == 0);
+    }
+    os_mbuf_free_chain(om);
+    osbench_report("mbuf_copydata", "mbufs", n);
+}
+
+/*
+ * os_mbuf_pullup() of a chain of n mbufs holding together one mbuf worth
+ * of data.
+ */
+static void
+osbench_mbuf_pullup(int n)
+{
+    struct os_mbuf *om;
+    struct os_mbuf *next;
+    int chunk;
+    int rc;
+    int i;
+    int j;
+
+    chunk = OSBENCH_MBUF_DATA / n;
+
+    osbench_reset();
+    for (i = 0; i < OSBENCH_ITERATIONS; i++) {
+        om = os_mbuf_get(&osbench_mbuf_pool, 0);
+        assert(om != NULL);
+        rc = os_mbuf_append(om, osbench_flat, chunk);
+        assert(rc == 0);
+        for (j = 1; j < n; j++) {
+            next = os_mbuf_get(&osbench_mbuf_pool, 0);
+            assert(next != NULL);
+            rc = os_mbuf_append(next, osbench_flat, chunk);
+            assert(rc == 0);
+            os_mbuf_concat(om, next);
+        }
+
+        osbench_start();
+        om = os_mbuf_pullup(om, n * chunk);
+        osbench_stop();
+        assert(om != NULL);
+
+        os_mbuf_free_chain(om);
+    }
+    osbench_report("mbuf_pullup", "mbufs", n);
+}
+
+static void
+osbench_block_timer_cb(void *arg)
+{
+    void *block;
+
+    block = os_memblock_get(&osbench_block_pool);
+    if (block != NULL) {
+        os_memblock_put(&osbench_block_pool, block);
+    }
+    os_cputime_timer_relative(&osbench_block_timer, OSBENCH_BLOCK_ISR_US);
+}
+
+/*
+ * os_memblock_get() and os_memblock_put(), alone and with an interrupt
+ * frequently taking and returning blocks of the same pool.
+ */
+static void
+osbench_memblock(int contended)
+{
+    void *blocks[OSBENCH_BLOCK_COUNT / 2];
+    const char *get_name;
+    const char *put_name;
+    int i;
+    int j;
+
+    if (contended) {
+        get_name = "memblock_get_contended";
+        put_name = "memblock_put_contended";
+        os_cputime_timer_relative(&osbench_block_timer, OSBENCH_BLOCK_ISR_US);
+    } else {
+        get_name = "memblock_get";
+        put_name = "memblock_put";
+    }
+
+    /* Gets are timed in one pass, puts in another. */
+    osbench_reset();
+    for (i = 0; i < OSBENCH_ITERATIONS; i++) {
+        for (j = 0; j < OSBENCH_BLOCK_COUNT / 2; j++) {
+            osbench_start();
+            blocks[j] = os_memblock_get(&osbench_block_pool);
+            osbench_stop();
+            assert(blocks[j] != NULL);
+        }
+        for (j = 0; j < OSBENCH_BLOCK_COUNT / 2; j++) {
+            os_memblock_put(&osbench_block_pool, blocks[j]);
+        }
+    }
+    osbench_report(get_name, NULL, 0);
+
+    osbench_reset();
+    for (i = 0; i < OSBENCH_ITERATIONS; i++) {
+        for (j = 0; j < OSBENCH_BLOCK_COUNT / 2; j++) {
+            blocks[j] = os_memblock_get(&osbench_block_pool);
+            assert(blocks[j] != NULL);
+        }
+        for (j = 0; j < OSBENCH_BLOCK_COUNT / 2; j++) {
+            osbench_start();
+            os_memblock_put(&osbench_block_pool, blocks[j]);
+            osbench_stop();
+        }
+    }
+
+    if (contended) {
+        os_cputime_timer_stop(&osbench_block_timer);
+    }
+
+    osbench_report(put_name, NULL, 0);
+}
+
+/* os_msys_get() for a data size, which has to pick a pool first. */
+static void
+osbench_msys(int dsize)
+{
+    struct os_mbuf *om;
+    int i;
+
+    osbench_reset();
+    for (i = 0; i < OSBENCH_ITERATIONS; i++) {
+        osbench_start();
+        om = os_msys_get(dsize, 0);
+        osbench_stop();
+        if (om != NULL) {
+            os_mbuf_free_chain(om);
+        }
+    }
+    osbench_report("msys_get", "dsize", dsize);
+}
+
+/*
+ * A random mix of os_malloc() and os_free() over OSBENCH_MALLOC_SLOTS
+ * slots of up to OSBENCH_MALLOC_MAX bytes.  The same sequence is run twice,
+ * timing the mallocs the first time and the frees the second.  Afterwards
+ * the size of the largest block still available says how fragmented the
+ * heap is.
+ */
+static void
+osbench_malloc_pass(int time_malloc, int *out_failed, int *out_live)
+{
+    uint16_t size;
+    int failed;
+    int slot;
+    int live;
+    int i;
+
+    osbench_rand_state = 1;
+    failed = 0;
+    live = 0;
+
+    osbench_reset();
+    for (i = 0; i < 4 * OSBENCH_ITERATIONS; i++) {
+        slot = osbench_rand() % OSBENCH_MALLOC_SLOTS;
+        if (osbench_slots[slot] == NULL) {
+            size = 1 + osbench_rand() % OSBENCH_MALLOC_MAX;
+            if (time_malloc) {
+                osbench_start();
+            }
+            osbench_slots[slot] = os_malloc(size);
+            if (time_malloc) {
+                osbench_stop();
+            }
+            if (osbench_slots[slot] == NULL) {
+                failed++;
+            } else {
+                osbench_slot_sizes[slot] = size;
+                live += size;
+            }
+        } else {
+            if (!time_malloc) {
+                osbench_start();
+            }
+            os_free(osbench_slots[slot]);
+            if (!time_malloc) {
+                osbench_stop();
+            }
+            osbench_slots[slot] = NULL;
+            live -= osbench_slot_sizes[slot];
+        }
+    }
+
+    *out_failed = failed;
+    *out_live = live;
+}
+
+static int
+osbench_malloc_largest(void)
+{
+    void *p;
+    int lo;
+    int hi;
+    int mid;
+
+    /* Largest size known to fit, and smallest known not to. */
+    lo = 0;
+    hi = OSBENCH_MALLOC_PROBE + 1;
+    while (hi - lo > 1) {
+        mid = lo + (hi - lo) / 2;
+        p = os_malloc(mid);
+        if (p != NULL) {
+            os_free(p);
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+static void
+osbench_malloc_free_all(void)
+{
+    int i;
+
+    for (i = 0; i < OSBENCH_MALLOC_SLOTS; i++) {
+        os_free(osbench_slots[i]);
+        osbench_slots[i] = NULL;
+    }
+}
+
+static void
+osbench_malloc(void)
+{
+    int largest;
+    int failed;
+    int live;
+
+    osbench_malloc_pass(1, &failed, &live);
+    largest = osbench_malloc_largest();
+    osbench_report("malloc", "max_size", OSBENCH_MALLOC_MAX);
+    osbench_malloc_free_all();
+
+    osbench_malloc_pass(0, &failed, &live);
+    osbench_report("free", "max_size", OSBENCH_MALLOC_MAX);
+    osbench_malloc_free_all();
+
+    console_printf("{\"bench\":\"heap\",\"live\":%d,\"largest\":%d,"
+                   "\"failed\":%d}\n", live, largest, failed);
+}
+
+void
+osbench_mem_init(void)
+{
+    int rc;
+    int i;
+
+    rc = os_mempool_init(&osbench_mbuf_mempool, OSBENCH_MBUF_COUNT,
+                         OSBENCH_MBUF_BLOCK, osbench_mbuf_mem, "osbench_mbuf");
+    assert(rc == 0);
+    rc = os_mbuf_pool_init(&osbench_mbuf_pool, &osbench_mbuf_mempool,
+                           OSBENCH_MBUF_BLOCK, OSBENCH_MBUF_COUNT);
+    assert(rc == 0);
+
+    rc = os_mempool_init(&osbench_block_pool, OSBENCH_BLOCK_COUNT,
+                         OSBENCH_BLOCK_SIZE, osbench_block_mem,
+                         "osbench_block");
+    assert(rc == 0);
+    os_cputime_timer_init(&osbench_block_timer, osbench_block_timer_cb, NULL);
+
+    for (i = 0; i < OSBENCH_MSYS_POOLS; i++) {
+        rc = os_mempool_init(&osbench_msys_mempools[i], OSBENCH_MSYS_COUNT,
+                             OSBENCH_MSYS_BLOCK(i), osbench_msys_mem[i],
+                             "osbench_msys");
+        assert(rc == 0);
+        rc = os_mbuf_pool_init(&osbench_msys_pools[i],
+                               &osbench_msys_mempools[i],
+                               OSBENCH_MSYS_BLOCK(i), OSBENCH_MSYS_COUNT);
+        assert(rc == 0);
+        rc = os_msys_register(&osbench_msys_pools[i]);
+        assert(rc == 0);
+    }
+}
+
+void
+osbench_mem_run(void)
+{
+    int n;
+
+    for (n = 1; n <= OSBENCH_MBUF_CHAIN; n *= 2) {
+        osbench_mbuf_append(n);
+        osbench_mbuf_pullup(n);
+    }
+
+    osbench_memblock(0);
+    osbench_memblock(1);
+
+    for (n = 16; n <= 1024; n *= 4) {
+        osbench_msys(n);
+    }
+
+    osbench_malloc();
+}
+
+#endif
@@ -0,0 +1,228 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Flash storage benchmarks.
+ *
+ * Everything runs in the main task, on the flash area
+ * STOREBENCH_FLASH_AREA, which each benchmark erases or formats first.
+ * Results are printed to the console as one JSON object per line:
+ *
+ *  {"bench":"info","bsp":"native","area":4,"size":32768,"sectors":2}
+ *  {"bench":"fcb_append","size":64,"n":1024,"avg":96,"p50":90,
+ *   "p90":104,"p99":180,"max":41230,"bytes_per_sec":665000}
+ *  {"bench":"fcb_rotate","n":3,"avg":40210,...}
+ *  ...
+ *  {"bench":"done"}
+ *
+ * Times are in microseconds.  The "_rotate" and "_gc" lines are the pauses
+ * the measurement before them took to free up flash.
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include "os/mynewt.h"
+#include "console/console.h"
+#include "storebench.h"
+
+#define STRX(x)                 #x
+#define STR(x)                  STRX(x)
+
+#define STOREBENCH_BUF_SIZE     max(STOREBENCH_ENTRY_SIZE, \
+                                    MYNEWT_VAL(STOREBENCH_FILE_SIZE))
+
+static uint32_t storebench_ops_samples[STOREBENCH_SAMPLES];
+static uint32_t storebench_gc_samples[MYNEWT_VAL(STOREBENCH_PAUSES)];
+
+struct storebench_stat storebench_ops = {
+    .ss_samples = storebench_ops_samples,
+    .ss_cap = STOREBENCH_SAMPLES,
+};
+struct storebench_stat storebench_gc = {
+    .ss_samples = storebench_gc_samples,
+    .ss_cap = MYNEWT_VAL(STOREBENCH_PAUSES),
+};
+
+const struct flash_area *storebench_fa;
+struct flash_area storebench_sectors[MYNEWT_VAL(STOREBENCH_SECTORS)];
+int storebench_sector_cnt;
+
+uint8_t storebench_buf[STOREBENCH_BUF_SIZE];
+
+void
+storebench_add(struct storebench_stat *st, uint32_t t0, uint32_t bytes)
+{
+    uint32_t usecs;
+
+    usecs = os_cputime_ticks_to_usecs(os_cputime_get32() - t0);
+
+    if (st->ss_n < st->ss_cap) {
+        st->ss_samples[st->ss_n] = usecs;
+    }
+    if (usecs > st->ss_max) {
+        st->ss_max = usecs;
+    }
+    st->ss_sum += usecs;
+    st->ss_bytes += bytes;
+    st->ss_n++;
+}
+
+static void
+storebench_clear(struct storebench_stat *st)
+{
+    st->ss_n = 0;
+    st->ss_max = 0;
+    st->ss_sum = 0;
+    st->ss_bytes = 0;
+}
+
+void
+storebench_reset(void)
+{
+    storebench_clear(&storebench_ops);
+    storebench_clear(&storebench_gc);
+}
+
+static int
+storebench_cmp(const void *a, const void *b)
+{
+    uint32_t x;
+    uint32_t y;
+
+    x = *(const uint32_t *)a;
+    y = *(const uint32_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+void
+storebench_report(const char *name, const char *param, int value,
+                  struct storebench_stat *st)
+{
+    uint32_t kept;
+    uint32_t *s;
+
+    kept = min(st->ss_n, st->ss_cap);
+    s = st->ss_samples;
+    qsort(s, kept, sizeof(*s), storebench_cmp);
+
+    console_printf("{\"bench\":\"%s\"", name);
+    if (param != NULL) {
+        console_printf(",\"%s\":%d", param, value);
+    }
+    console_printf(",\"n\":%lu", (unsigned long)st->ss_n);
+    if (st->ss_n == 0) {
+        console_printf("}\n");
+        return;
+    }
+    console_printf(",\"avg\":%lu,\"p50\":%lu,\"p90\":%lu,\"p99\":%lu,"
+                   "\"max\":%lu",
+                   (unsigned long)(st->ss_sum / st->ss_n),
+                   (unsigned long)s[(kept - 1) * 50 / 100],
+                   (unsigned long)s[(kept - 1) * 90 / 100],
+                   (unsigned long)s[(kept - 1) * 99 / 100],
+                   (unsigned long)st->ss_max);
+    if (st->ss_bytes != 0 && st->ss_sum != 0) {
+        console_printf(",\"bytes_per_sec\":%lu",
+                       (unsigned long)(st->ss_bytes * 1000000 / st->ss_sum));
+    }
+    console_printf("}\n");
+}
+
+int
+storebench_erase(void)
+{
+    return flash_area_erase(storebench_fa, 0, storebench_fa->fa_size);
+}
+
+static void
+storebench_init(void)
+{
+    int rc;
+    int i;
+
+    rc = flash_area_open(MYNEWT_VAL(STOREBENCH_FLASH_AREA), &storebench_fa);
+    assert(rc == 0);
+
+    rc = flash_area_to_sectors(MYNEWT_VAL(STOREBENCH_FLASH_AREA),
+                               &storebench_sector_cnt, NULL);
+    assert(rc == 0);
+    assert(storebench_sector_cnt <= MYNEWT_VAL(STOREBENCH_SECTORS));
+    flash_area_to_sectors(MYNEWT_VAL(STOREBENCH_FLASH_AREA),
+                          &storebench_sector_cnt, storebench_sectors);
+
+    for (i = 0; i < STOREBENCH_BUF_SIZE; i++) {
+        storebench_buf[i] = i;
+    }
+}
+
+static void
+storebench_run_all(void)
+{
+    console_printf("{\"bench\":\"info\",\"bsp\":\"%s\",\"area\":%d,"
+                   "\"size\":%lu,\"sectors\":%d}\n",
+                   STR(BSP_NAME), MYNEWT_VAL(STOREBENCH_FLASH_AREA),
+                   (unsigned long)storebench_fa->fa_size,
+                   storebench_sector_cnt);
+
+#if MYNEWT_VAL(STOREBENCH_FCB)
+    storebench_fcb_run();
+#endif
+#if MYNEWT_VAL(STOREBENCH_FCB2)
+    storebench_fcb2_run();
+#endif
+#if MYNEWT_VAL(STOREBENCH_LOG)
+    storebench_log_run();
+#endif
+#if MYNEWT_VAL(STOREBENCH_CONF)
+    storebench_conf_run();
+#endif
+    /* Last, as these leave a file system on the area. */
+#if MYNEWT_VAL(STOREBENCH_NFFS)
+    storebench_nffs_run();
+#endif
+#if MYNEWT_VAL(STOREBENCH_FS)
+    storebench_fs_run();
+#endif
+
+    console_printf("{\"bench\":\"done\"}\n");
+}
+
+/**
+ * main
+ *
+ * Runs the benchmarks once, then serves the default event queue.
+ *
+ * @return int NOTE: this function should never return!
+ */
+int
+main(int argc, char **argv)
+{
+    sysinit();
+
+    storebench_init();
+    storebench_run_all();
+
+    while (1) {
+        os_eventq_run(os_eventq_dflt_get());
+    }
+
+    return 0;
+}
@@ -0,0 +1,99 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef H_STOREBENCH_
+#define H_STOREBENCH_
+
+#include <inttypes.h>
+#include "os/mynewt.h"
+#include "flash_map/flash_map.h"
+
+#define STOREBENCH_SAMPLES      MYNEWT_VAL(STOREBENCH_SAMPLES)
+#define STOREBENCH_ENTRY_SIZE   MYNEWT_VAL(STOREBENCH_ENTRY_SIZE)
+
+/*
+ * Durations of one kind of operation, in microseconds.  The first ss_cap
+ * are kept for the percentiles; count, sum and max cover all of them.
+ */
+struct storebench_stat {
+    uint32_t *ss_samples;
+    uint32_t ss_cap;
+    uint32_t ss_n;
+    uint32_t ss_max;
+    uint64_t ss_sum;
+    uint64_t ss_bytes;
+};
+
+/* Operations under test, and the GC pauses among them. */
+extern struct storebench_stat storebench_ops;
+extern struct storebench_stat storebench_gc;
+
+/* The area under test, and its sectors. */
+extern const struct flash_area *storebench_fa;
+extern struct flash_area storebench_sectors[MYNEWT_VAL(STOREBENCH_SECTORS)];
+extern int storebench_sector_cnt;
+
+/* Filler for everything written. */
+extern uint8_t storebench_buf[];
+
+static inline uint32_t
+storebench_start(void)
+{
+    return os_cputime_get32();
+}
+
+/**
+ * Adds the time since t0, from storebench_start(), as a sample of st;
+ * bytes is how much the operation moved, for the throughput.
+ */
+void storebench_add(struct storebench_stat *st, uint32_t t0, uint32_t bytes);
+
+/** Throws away the samples of both stats, for the next measurement. */
+void storebench_reset(void);
+
+/**
+ * Prints the samples of st as a JSON line, with one extra integer "param"
+ * field if param is not NULL.
+ */
+void storebench_report(const char *name, const char *param, int value,
+                       struct storebench_stat *st);
+
+/** Erases the whole area under test. */
+int storebench_erase(void);
+
+#if MYNEWT_VAL(STOREBENCH_FCB)
+void storebench_fcb_run(void);
+#endif
+#if MYNEWT_VAL(STOREBENCH_FCB2)
+void storebench_fcb2_run(void);
+#endif
+#if MYNEWT_VAL(STOREBENCH_LOG)
+void storebench_log_run(void);
+#endif
+#if MYNEWT_VAL(STOREBENCH_CONF)
+void storebench_conf_run(void);
+#endif
+#if MYNEWT_VAL(STOREBENCH_NFFS)
+void storebench_nffs_run(void);
+#endif
+#if MYNEWT_VAL(STOREBENCH_FS)
+void storebench_fs_run(void);
+#endif
+
+#endif
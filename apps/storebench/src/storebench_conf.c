@@ -0,0 +1,94 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Config load benchmark: the time to read every record back from an FCB
+ * config store, the way conf_load() does at boot, against the number of
+ * records in it.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include "os/mynewt.h"
+#include "config/config_fcb.h"
+#include "storebench.h"
+
+#define STOREBENCH_CONF_MAGIC   0x53424346
+#define STOREBENCH_CONF_LOADS   8
+
+static struct conf_fcb storebench_cf = {
+    .cf_fcb.f_magic = STOREBENCH_CONF_MAGIC,
+    .cf_fcb.f_sectors = storebench_sectors,
+};
+
+static void
+storebench_conf_load_cb(char *name, char *val, void *cb_arg)
+{
+    int *cnt;
+
+    cnt = cb_arg;
+    (*cnt)++;
+}
+
+void
+storebench_conf_run(void)
+{
+    struct conf_store *cs;
+    char name[16];
+    char val[12];
+    uint32_t t0;
+    int records;
+    int target;
+    int cnt;
+    int rc;
+    int i;
+
+    rc = storebench_erase();
+    assert(rc == 0);
+    storebench_cf.cf_fcb.f_sector_cnt = storebench_sector_cnt;
+    rc = conf_fcb_src(&storebench_cf);
+    assert(rc == 0);
+    cs = &storebench_cf.cf_store;
+
+    records = 0;
+    target = 1;
+    while (1) {
+        for (; records < target; records++) {
+            snprintf(name, sizeof(name), "sb/%d", records);
+            snprintf(val, sizeof(val), "%d", records);
+            rc = cs->cs_itf->csi_save(cs, name, val);
+            assert(rc == 0);
+        }
+
+        storebench_reset();
+        for (i = 0; i < STOREBENCH_CONF_LOADS; i++) {
+            cnt = 0;
+            t0 = storebench_start();
+            rc = cs->cs_itf->csi_load(cs, storebench_conf_load_cb, &cnt);
+            storebench_add(&storebench_ops, t0, 0);
+            assert(rc == 0 && cnt == records);
+        }
+        storebench_report("conf_load", "records", records, &storebench_ops);
+
+        if (target == MYNEWT_VAL(STOREBENCH_CONF_RECORDS)) {
+            break;
+        }
+        target = min(target * 4, MYNEWT_VAL(STOREBENCH_CONF_RECORDS));
+    }
+}
@@ -0,0 +1,214 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * FCB and FCB2 append and walk benchmarks.
+ *
+ * STOREBENCH_SAMPLES entries are appended to an empty FCB spanning the
+ * whole area, rotating out the oldest sector whenever it fills up; the
+ * rotations are the GC pauses.  What is left is then walked once, reading
+ * every entry.
+ */
+
+#include <assert.h>
+#include <string.h>
+#include "os/mynewt.h"
+#include "storebench.h"
+#if MYNEWT_VAL(STOREBENCH_FCB)
+#include "fcb/fcb.h"
+#endif
+#if MYNEWT_VAL(STOREBENCH_FCB2)
+#include "fcb/fcb2.h"
+#endif
+
+#define STOREBENCH_FCB_MAGIC    0x53424643
+
+static uint8_t storebench_rbuf[STOREBENCH_ENTRY_SIZE];
+
+/* Entries and bytes seen by a walk. */
+struct storebench_walk {
+    int entries;
+    uint32_t bytes;
+};
+
+#if MYNEWT_VAL(STOREBENCH_FCB)
+static struct fcb storebench_fcb;
+
+static int
+storebench_fcb_walk_cb(struct fcb_entry *loc, void *arg)
+{
+    struct storebench_walk *walk;
+
+    walk = arg;
+    flash_area_read(loc->fe_area, loc->fe_data_off, storebench_rbuf,
+                    min(loc->fe_data_len, sizeof(storebench_rbuf)));
+    walk->entries++;
+    walk->bytes += loc->fe_data_len;
+
+    return 0;
+}
+
+void
+storebench_fcb_run(void)
+{
+    struct storebench_walk walk;
+    struct fcb_entry loc;
+    struct fcb *fcb;
+    uint32_t t0;
+    int rc;
+    int i;
+
+    fcb = &storebench_fcb;
+
+    rc = storebench_erase();
+    assert(rc == 0);
+    memset(fcb, 0, sizeof(*fcb));
+    fcb->f_magic = STOREBENCH_FCB_MAGIC;
+    fcb->f_version = 1;
+    fcb->f_sector_cnt = storebench_sector_cnt;
+    fcb->f_sectors = storebench_sectors;
+    rc = fcb_init(fcb);
+    assert(rc == 0);
+
+    storebench_reset();
+    for (i = 0; i < STOREBENCH_SAMPLES; i++) {
+        t0 = storebench_start();
+        rc = fcb_append(fcb, STOREBENCH_ENTRY_SIZE, &loc);
+        if (rc == FCB_ERR_NOSPACE) {
+            rc = fcb_rotate(fcb);
+            assert(rc == 0);
+            storebench_add(&storebench_gc, t0, 0);
+
+            t0 = storebench_start();
+            rc = fcb_append(fcb, STOREBENCH_ENTRY_SIZE, &loc);
+        }
+        assert(rc == 0);
+        rc = flash_area_write(loc.fe_area, loc.fe_data_off, storebench_buf,
+                              STOREBENCH_ENTRY_SIZE);
+        assert(rc == 0);
+        rc = fcb_append_finish(fcb, &loc);
+        assert(rc == 0);
+        storebench_add(&storebench_ops, t0, STOREBENCH_ENTRY_SIZE);
+    }
+    storebench_report("fcb_append", "size", STOREBENCH_ENTRY_SIZE,
+                      &storebench_ops);
+    storebench_report("fcb_rotate", NULL, 0, &storebench_gc);
+
+    storebench_reset();
+    memset(&walk, 0, sizeof(walk));
+    t0 = storebench_start();
+    rc = fcb_walk(fcb, NULL, storebench_fcb_walk_cb, &walk);
+    assert(rc == 0);
+    storebench_add(&storebench_ops, t0, walk.bytes);
+    storebench_report("fcb_walk", "entries", walk.entries, &storebench_ops);
+}
+#endif
+
+#if MYNEWT_VAL(STOREBENCH_FCB2)
+static struct fcb2 storebench_fcb2;
+static struct flash_sector_range
+    storebench_ranges[MYNEWT_VAL(STOREBENCH_SECTORS)];
+
+static int
+storebench_fcb2_walk_cb(struct fcb2_entry *loc, void *arg)
+{
+    struct storebench_walk *walk;
+
+    walk = arg;
+    fcb2_read(loc, 0, storebench_rbuf,
+              min(loc->fe_data_len, sizeof(storebench_rbuf)));
+    walk->entries++;
+    walk->bytes += loc->fe_data_len;
+
+    return 0;
+}
+
+void
+storebench_fcb2_run(void)
+{
+    struct storebench_walk walk;
+    struct fcb2_entry loc;
+    struct fcb2 *fcb;
+    uint32_t t0;
+    int range_cnt;
+    int rc;
+    int i;
+
+    fcb = &storebench_fcb2;
+
+    rc = storebench_erase();
+    assert(rc == 0);
+    memset(fcb, 0, sizeof(*fcb));
+
+    /*
+     * Ranges are filled in here rather than with fcb2_init_flash_area(),
+     * which allocates them on every call.
+     */
+    range_cnt = MYNEWT_VAL(STOREBENCH_SECTORS);
+    rc = flash_area_to_sector_ranges(MYNEWT_VAL(STOREBENCH_FLASH_AREA),
+                                     &range_cnt, storebench_ranges);
+    assert(rc == 0);
+    for (i = 0; i < range_cnt; i++) {
+        fcb->f_sector_cnt += storebench_ranges[i].fsr_sector_count;
+    }
+    fcb->f_magic = STOREBENCH_FCB_MAGIC;
+    fcb->f_version = 1;
+    fcb->f_range_cnt = range_cnt;
+    fcb->f_ranges = storebench_ranges;
+    rc = fcb2_init(fcb);
+    assert(rc == 0);
+
+    storebench_reset();
+    for (i = 0; i < STOREBENCH_SAMPLES; i++) {
+        t0 = storebench_start();
+        rc = fcb2_append(fcb, STOREBENCH_ENTRY_SIZE, &loc);
+        if (rc == FCB2_ERR_NOSPACE) {
+            rc = fcb2_rotate(fcb);
+            assert(rc == 0);
+            storebench_add(&storebench_gc, t0, 0);
+
+            t0 = storebench_start();
+            rc = fcb2_append(fcb, STOREBENCH_ENTRY_SIZE, &loc);
+        }
+        assert(rc == 0);
+        rc = fcb2_write(&loc, 0, storebench_buf, STOREBENCH_ENTRY_SIZE);
+        assert(rc == 0);
+        rc = fcb2_append_finish(&loc);
+        assert(rc == 0);
+        storebench_add(&storebench_ops, t0, STOREBENCH_ENTRY_SIZE);
+    }
+#if MYNEWT_VAL(FCB2_WRITE_COMBINE)
+    /* The newest entries are still buffered; writing them out counts. */
+    t0 = storebench_start();
+    fcb2_flush(fcb);
+    storebench_add(&storebench_ops, t0, 0);
+#endif
+    storebench_report("fcb2_append", "size", STOREBENCH_ENTRY_SIZE,
+                      &storebench_ops);
+    storebench_report("fcb2_rotate", NULL, 0, &storebench_gc);
+
+    storebench_reset();
+    memset(&walk, 0, sizeof(walk));
+    t0 = storebench_start();
+    rc = fcb2_walk(fcb, FCB2_SECTOR_OLDEST, storebench_fcb2_walk_cb, &walk);
+    assert(rc == 0);
+    storebench_add(&storebench_ops, t0, walk.bytes);
+    storebench_report("fcb2_walk", "entries", walk.entries, &storebench_ops);
+}
+#endif
@@ -0,0 +1,198 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * File system benchmarks.
+ *
+ * NFFS: the area is formatted, then filled with STOREBENCH_FILE_SIZE files
+ * to 0, 25, 50 and 75% of its usable space, timing each file written and,
+ * at each level, a restore (nffs_detect()) as done when mounting at boot.
+ * Garbage collection runs inside the writes that need it, and stands out
+ * as their maximum.
+ *
+ * Files: one file of STOREBENCH_FILE_CHUNKS chunks is written and read
+ * back through fs/fs, so this runs on any file system holding
+ * STOREBENCH_FS_DIR, FatFs included.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include "os/mynewt.h"
+#include "fs/fs.h"
+#include "storebench.h"
+#if MYNEWT_VAL(STOREBENCH_NFFS)
+#include "nffs/nffs.h"
+#endif
+
+#define STOREBENCH_FS_DIR       MYNEWT_VAL(STOREBENCH_FS_DIR)
+#define STOREBENCH_FILE_SIZE    MYNEWT_VAL(STOREBENCH_FILE_SIZE)
+
+static uint8_t storebench_rbuf[STOREBENCH_FILE_SIZE];
+
+#if MYNEWT_VAL(STOREBENCH_NFFS)
+static struct nffs_area_desc storebench_descs[MYNEWT_VAL(NFFS_NUM_AREAS) + 1];
+
+static int
+storebench_nffs_write(int idx)
+{
+    struct fs_file *file;
+    char path[32];
+    int rc;
+
+    snprintf(path, sizeof(path), "%s/f%d", STOREBENCH_FS_DIR, idx);
+    rc = fs_open(path, FS_ACCESS_WRITE | FS_ACCESS_TRUNCATE, &file);
+    if (rc != 0) {
+        return rc;
+    }
+    rc = fs_write(file, storebench_buf, STOREBENCH_FILE_SIZE);
+    fs_close(file);
+
+    return rc;
+}
+
+static void
+storebench_nffs_unlink(int idx)
+{
+    char path[32];
+
+    snprintf(path, sizeof(path), "%s/f%d", STOREBENCH_FS_DIR, idx);
+    fs_unlink(path);
+}
+
+void
+storebench_nffs_run(void)
+{
+    uint32_t largest;
+    uint32_t usable;
+    uint32_t filled;
+    uint32_t t0;
+    int files;
+    int cnt;
+    int pct;
+    int rc;
+    int i;
+
+    cnt = MYNEWT_VAL(NFFS_NUM_AREAS);
+    rc = nffs_misc_desc_from_flash_area(MYNEWT_VAL(STOREBENCH_FLASH_AREA),
+                                        &cnt, storebench_descs);
+    assert(rc == 0 && cnt >= 2);
+
+    /* One area is always kept free as the scratch area. */
+    usable = 0;
+    largest = 0;
+    for (i = 0; i < cnt; i++) {
+        usable += storebench_descs[i].nad_length;
+        largest = max(largest, storebench_descs[i].nad_length);
+    }
+    usable -= largest;
+
+    storebench_reset();
+    t0 = storebench_start();
+    rc = nffs_format(storebench_descs);
+    storebench_add(&storebench_ops, t0, 0);
+    assert(rc == 0);
+    storebench_report("nffs_format", NULL, 0, &storebench_ops);
+
+    rc = fs_mkdir(STOREBENCH_FS_DIR);
+    assert(rc == 0);
+
+    files = 0;
+    filled = 0;
+    for (pct = 0; pct <= 75; pct += 25) {
+        if (pct > 0) {
+            storebench_reset();
+            rc = 0;
+            while (filled < usable / 100 * pct) {
+                t0 = storebench_start();
+                rc = storebench_nffs_write(files);
+                storebench_add(&storebench_ops, t0, STOREBENCH_FILE_SIZE);
+                if (rc != 0) {
+                    break;
+                }
+                files++;
+                filled += STOREBENCH_FILE_SIZE;
+            }
+            storebench_report("nffs_write", "fill_pct", pct,
+                              &storebench_ops);
+            if (rc != 0) {
+                /* Full short of the level; the overhead is bigger. */
+                break;
+            }
+        }
+
+        storebench_reset();
+        t0 = storebench_start();
+        rc = nffs_detect(storebench_descs);
+        storebench_add(&storebench_ops, t0, 0);
+        assert(rc == 0);
+        storebench_report("nffs_restore", "fill_pct", pct, &storebench_ops);
+    }
+
+    /* Leaves the space to the file benchmark. */
+    for (i = 0; i < files; i++) {
+        storebench_nffs_unlink(i);
+    }
+}
+#endif
+
+void
+storebench_fs_run(void)
+{
+    struct fs_file *file;
+    uint32_t len;
+    uint32_t t0;
+    int rc;
+    int i;
+
+    rc = fs_mkdir(STOREBENCH_FS_DIR);
+    assert(rc == 0 || rc == FS_EEXIST);
+
+    storebench_reset();
+    rc = fs_open(STOREBENCH_FS_DIR "/file", FS_ACCESS_WRITE |
+                 FS_ACCESS_TRUNCATE, &file);
+    assert(rc == 0);
+    for (i = 0; i < MYNEWT_VAL(STOREBENCH_FILE_CHUNKS); i++) {
+        t0 = storebench_start();
+        rc = fs_write(file, storebench_buf, STOREBENCH_FILE_SIZE);
+        storebench_add(&storebench_ops, t0, STOREBENCH_FILE_SIZE);
+        if (rc != 0) {
+            break;
+        }
+    }
+    fs_close(file);
+    storebench_report("fs_write", "size", STOREBENCH_FILE_SIZE,
+                      &storebench_ops);
+
+    storebench_reset();
+    rc = fs_open(STOREBENCH_FS_DIR "/file", FS_ACCESS_READ, &file);
+    assert(rc == 0);
+    while (1) {
+        t0 = storebench_start();
+        rc = fs_read(file, STOREBENCH_FILE_SIZE, storebench_rbuf, &len);
+        if (rc != 0 || len == 0) {
+            break;
+        }
+        storebench_add(&storebench_ops, t0, len);
+    }
+    fs_close(file);
+    storebench_report("fs_read", "size", STOREBENCH_FILE_SIZE,
+                      &storebench_ops);
+
+    fs_unlink(STOREBENCH_FS_DIR "/file");
+}
@@ -0,0 +1,140 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Log append and walk benchmarks, on an FCB (or FCB2) log spanning the
+ * whole area.  The log rotates out its oldest sector by itself when full,
+ * so those pauses show up in the tail of the append latencies.
+ */
+
+#include <assert.h>
+#include <string.h>
+#include "os/mynewt.h"
+#include "log/log.h"
+#include "storebench.h"
+
+#define STOREBENCH_LOG_MAGIC    0x5342474c
+
+static struct log storebench_log;
+static struct fcb_log storebench_fcb_log;
+#if MYNEWT_VAL(LOG_FCB2)
+static struct flash_sector_range
+    storebench_log_ranges[MYNEWT_VAL(STOREBENCH_SECTORS)];
+#endif
+
+static uint8_t storebench_rbuf[STOREBENCH_ENTRY_SIZE];
+
+/* Entries and bytes seen by a walk. */
+struct storebench_log_walk {
+    int entries;
+    uint32_t bytes;
+};
+
+static int
+storebench_log_walk_cb(struct log *log, struct log_offset *log_offset,
+                       const struct log_entry_hdr *hdr, const void *dptr,
+                       uint16_t len)
+{
+    struct storebench_log_walk *walk;
+
+    walk = log_offset->lo_arg;
+    log_read_body(log, dptr, storebench_rbuf, 0,
+                  min(len, sizeof(storebench_rbuf)));
+    walk->entries++;
+    walk->bytes += len;
+
+    return 0;
+}
+
+static void
+storebench_log_init(void)
+{
+#if MYNEWT_VAL(LOG_FCB)
+    struct fcb *fcbp;
+#elif MYNEWT_VAL(LOG_FCB2)
+    struct fcb2 *fcbp;
+    int range_cnt;
+    int i;
+#endif
+    int rc;
+
+    rc = storebench_erase();
+    assert(rc == 0);
+
+    fcbp = &storebench_fcb_log.fl_fcb;
+#if MYNEWT_VAL(LOG_FCB)
+    fcbp->f_magic = STOREBENCH_LOG_MAGIC;
+    fcbp->f_version = g_log_info.li_version;
+    fcbp->f_sector_cnt = storebench_sector_cnt;
+    fcbp->f_sectors = storebench_sectors;
+    rc = fcb_init(fcbp);
+#elif MYNEWT_VAL(LOG_FCB2)
+    range_cnt = MYNEWT_VAL(STOREBENCH_SECTORS);
+    rc = flash_area_to_sector_ranges(MYNEWT_VAL(STOREBENCH_FLASH_AREA),
+                                     &range_cnt, storebench_log_ranges);
+    assert(rc == 0);
+    for (i = 0; i < range_cnt; i++) {
+        fcbp->f_sector_cnt += storebench_log_ranges[i].fsr_sector_count;
+    }
+    fcbp->f_magic = STOREBENCH_LOG_MAGIC;
+    fcbp->f_version = g_log_info.li_version;
+    fcbp->f_range_cnt = range_cnt;
+    fcbp->f_ranges = storebench_log_ranges;
+    rc = fcb2_init(fcbp);
+#endif
+    assert(rc == 0);
+
+    rc = log_register("storebench", &storebench_log, &log_fcb_handler,
+                      &storebench_fcb_log, LOG_SYSLEVEL);
+    assert(rc == 0);
+}
+
+void
+storebench_log_run(void)
+{
+    struct storebench_log_walk walk;
+    struct log_offset off;
+    uint32_t t0;
+    int rc;
+    int i;
+
+    storebench_log_init();
+
+    storebench_reset();
+    for (i = 0; i < STOREBENCH_SAMPLES; i++) {
+        t0 = storebench_start();
+        rc = log_append_body(&storebench_log, LOG_MODULE_DEFAULT,
+                             LOG_LEVEL_INFO, LOG_ETYPE_BINARY,
+                             storebench_buf, STOREBENCH_ENTRY_SIZE);
+        assert(rc == 0);
+        storebench_add(&storebench_ops, t0, STOREBENCH_ENTRY_SIZE);
+    }
+    storebench_report("log_append", "size", STOREBENCH_ENTRY_SIZE,
+                      &storebench_ops);
+
+    storebench_reset();
+    memset(&walk, 0, sizeof(walk));
+    memset(&off, 0, sizeof(off));
+    off.lo_arg = &walk;
+    t0 = storebench_start();
+    rc = log_walk_body(&storebench_log, storebench_log_walk_cb, &off);
+    assert(rc == 0);
+    storebench_add(&storebench_ops, t0, walk.bytes);
+    storebench_report("log_walk", "entries", walk.entries, &storebench_ops);
+}
@@ -18,10 +18,14 @@
  */
 
 #include <assert.h>
+#include <string.h>
 #include "os/mynewt.h"
 #include "bootutil/bootutil.h"
 #include "bootutil/image.h"
 #include "config/config.h"
+#if MYNEWT_VAL(SPLIT_VALIDATE_CACHE)
+#include "flash_map/flash_map.h"
+#endif
 #include "split/split.h"
 #include "split_priv.h"
 
@@ -101,6 +105,82 @@ split_mode_set(split_mode_t split_mode)
     return 0;
 }
 
+#if MYNEWT_VAL(SPLIT_VALIDATE_CACHE)
+/*
+ * Reads the SHA256 TLV of the image in a slot, and where it would be
+ * entered.  Only the header and TLV area are read, not the image.
+ */
+static int
+split_slot_hash(int slot, uint8_t *hash, void **entry)
+{
+    const struct flash_area *fa;
+    struct image_header hdr;
+    struct image_tlv_info info;
+    struct image_tlv tlv;
+    uint32_t off;
+    uint32_t end;
+    int rc;
+
+    rc = flash_area_open(flash_area_id_from_image_slot(slot), &fa);
+    if (rc != 0) {
+        return SYS_EIO;
+    }
+
+    rc = SYS_EIO;
+    if (flash_area_read(fa, 0, &hdr, sizeof(hdr))) {
+        goto out;
+    }
+    rc = SYS_ENOENT;
+    if (hdr.ih_magic != IMAGE_MAGIC) {
+        goto out;
+    }
+
+    off = hdr.ih_hdr_size + hdr.ih_img_size;
+    if (flash_area_read(fa, off, &info, sizeof(info)) ||
+        info.it_magic != IMAGE_TLV_INFO_MAGIC) {
+        goto out;
+    }
+    end = off + info.it_tlv_tot;
+    for (off += sizeof(info); off + sizeof(tlv) <= end;
+         off += sizeof(tlv) + tlv.it_len) {
+        if (flash_area_read(fa, off, &tlv, sizeof(tlv))) {
+            break;
+        }
+        if (tlv.it_type == IMAGE_TLV_SHA256 &&
+            tlv.it_len == SPLIT_VCACHE_LEN / 2) {
+            if (flash_area_read(fa, off + sizeof(tlv), hash, tlv.it_len)) {
+                break;
+            }
+            *entry = (void *)(fa->fa_off + hdr.ih_hdr_size);
+            rc = 0;
+            break;
+        }
+    }
+
+out:
+    flash_area_close(fa);
+    return rc;
+}
+
+/*
+ * Builds the cache key for the images now in the slots; the entry point
+ * is that of the split image.
+ */
+static int
+split_vcache_key(uint8_t *key, void **entry)
+{
+    void *loader_entry;
+    int rc;
+
+    rc = split_slot_hash(LOADER_IMAGE_SLOT, key, &loader_entry);
+    if (rc != 0) {
+        return rc;
+    }
+    return split_slot_hash(SPLIT_IMAGE_SLOT, key + SPLIT_VCACHE_LEN / 2,
+                           entry);
+}
+#endif
+
 /**
  * This validates and provides the loader image data
  *
@@ -110,6 +190,11 @@ int
 split_app_go(void **entry, int toboot)
 {
     split_mode_t split_mode;
+#if MYNEWT_VAL(SPLIT_VALIDATE_CACHE)
+    uint8_t cached[SPLIT_VCACHE_LEN];
+    uint8_t key[SPLIT_VCACHE_LEN];
+    int have_key;
+#endif
     int run_app;
     int rc;
 
@@ -156,11 +241,28 @@ split_app_go(void **entry, int toboot)
         }
     }
 
+#if MYNEWT_VAL(SPLIT_VALIDATE_CACHE)
+    /* A slot that has been written since carries a different TLV. */
+    have_key = split_vcache_key(key, entry) == 0;
+    if (have_key && split_vcache_get(cached) == 0 &&
+        !memcmp(cached, key, sizeof(key))) {
+        return 0;
+    }
+#endif
+
     rc = split_go(LOADER_IMAGE_SLOT, SPLIT_IMAGE_SLOT, entry);
     if (rc != 0) {
         /* Images don't match; clear split status. */
         split_write_split(SPLIT_MODE_LOADER);
     }
 
+#if MYNEWT_VAL(SPLIT_VALIDATE_CACHE)
+    if (rc == 0 && have_key) {
+        split_vcache_write(key);
+    } else {
+        split_vcache_write(NULL);
+    }
+#endif
+
     return rc;
 }
@@ -41,6 +41,11 @@ static struct conf_handler split_conf_handler = {
     .ch_export = split_conf_export
 };
 
+#if MYNEWT_VAL(SPLIT_VALIDATE_CACHE)
+static uint8_t split_vcache[SPLIT_VCACHE_LEN];
+static uint8_t split_vcache_valid;
+#endif
+
 int
 split_conf_init(void)
 {
@@ -62,6 +67,15 @@ split_conf_get(int argc, char **argv, char *buf, int max_len)
             split_mode = split_mode_get();
             return conf_str_from_value(CONF_INT8, &split_mode, buf, max_len);
         }
+#if MYNEWT_VAL(SPLIT_VALIDATE_CACHE)
+        if (!strcmp(argv[0], "vcache")) {
+            if (!split_vcache_valid) {
+                return "";
+            }
+            return conf_str_from_bytes(split_vcache, sizeof(split_vcache),
+                                       buf, max_len);
+        }
+#endif
     }
     return NULL;
 }
@@ -70,6 +84,9 @@ static int
 split_conf_set(int argc, char **argv, char *val)
 {
     split_mode_t split_mode;
+#if MYNEWT_VAL(SPLIT_VALIDATE_CACHE)
+    int len;
+#endif
     int rc;
 
     if (argc == 1) {
@@ -86,6 +103,19 @@ split_conf_set(int argc, char **argv, char *val)
 
             return 0;
         }
+#if MYNEWT_VAL(SPLIT_VALIDATE_CACHE)
+        if (!strcmp(argv[0], "vcache")) {
+            len = sizeof(split_vcache);
+            if (!val || conf_bytes_from_str(val, split_vcache, &len) != 0 ||
+                len != sizeof(split_vcache)) {
+                /* Deleted, or not something we wrote; validate again. */
+                split_vcache_valid = 0;
+                return 0;
+            }
+            split_vcache_valid = 1;
+            return 0;
+        }
+#endif
     }
     return -1;
 }
@@ -101,10 +131,20 @@ split_conf_export(void (*func)(char *name, char *val), enum conf_export_tgt tgt)
 {
     split_mode_t split_mode;
     char buf[4];
+#if MYNEWT_VAL(SPLIT_VALIDATE_CACHE)
+    char vbuf[CONF_STR_FROM_BYTES_LEN(SPLIT_VCACHE_LEN)];
+#endif
 
     split_mode = split_mode_get();
     conf_str_from_value(CONF_INT8, &split_mode, buf, sizeof(buf));
     func("split/status", buf);
+#if MYNEWT_VAL(SPLIT_VALIDATE_CACHE)
+    if (split_vcache_valid &&
+        conf_str_from_bytes(split_vcache, sizeof(split_vcache),
+                            vbuf, sizeof(vbuf))) {
+        func("split/vcache", vbuf);
+    }
+#endif
     return 0;
 }
 
@@ -124,3 +164,51 @@ split_write_split(split_mode_t split_mode)
     }
     return conf_save_one("split/status", str);
 }
+
+#if MYNEWT_VAL(SPLIT_VALIDATE_CACHE)
+/**
+ * Reads the image pair last validated.
+ *
+ * @return                      0 on success; SYS_ENOENT if there is none.
+ */
+int
+split_vcache_get(uint8_t *key)
+{
+    if (!split_vcache_valid) {
+        return SYS_ENOENT;
+    }
+    memcpy(key, split_vcache, sizeof(split_vcache));
+    return 0;
+}
+
+/**
+ * Persists the image pair just validated, or forgets the cached one if
+ * key is NULL.  Flash is only written when the value changes.
+ */
+int
+split_vcache_write(const uint8_t *key)
+{
+    char str[CONF_STR_FROM_BYTES_LEN(SPLIT_VCACHE_LEN)];
+
+    if (!key) {
+        if (!split_vcache_valid) {
+            return 0;
+        }
+        split_vcache_valid = 0;
+        return conf_save_one("split/vcache", NULL);
+    }
+
+    if (split_vcache_valid &&
+        !memcmp(split_vcache, key, sizeof(split_vcache))) {
+        return 0;
+    }
+    memcpy(split_vcache, key, sizeof(split_vcache));
+    split_vcache_valid = 1;
+
+    if (!conf_str_from_bytes(split_vcache, sizeof(split_vcache),
+                             str, sizeof(str))) {
+        return -1;
+    }
+    return conf_save_one("split/vcache", str);
+}
+#endif
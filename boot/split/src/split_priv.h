@@ -20,6 +20,7 @@
 #ifndef SPLIT_PRIV_H
 #define SPLIT_PRIV_H
 
+#include "os/mynewt.h"
 #include "bootutil/bootutil.h"
 
 #ifdef __cplusplus
@@ -30,6 +31,14 @@ int split_conf_init(void);
 int split_mgmt_register(void);
 int split_read_split(split_mode_t *split);
 
+#if MYNEWT_VAL(SPLIT_VALIDATE_CACHE)
+/* SHA256 TLVs of the loader and split images, in that order. */
+#define SPLIT_VCACHE_LEN    (2 * 32)
+
+int split_vcache_get(uint8_t *key);
+int split_vcache_write(const uint8_t *key);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -303,6 +303,16 @@ void EccPoint_mult(uECC_word_t * result, const uECC_word_t * point,
 		   const uECC_word_t * scalar, const uECC_word_t * initial_Z,
 		   bitcount_t num_bits, uECC_Curve curve);
 
+/*
+ * @brief Point multiplication of curve generator, result = scalar * G;
+ * uses fixed-base comb when built with TC_ECC_FIXED_BASE_COMB
+ * @param result OUT -- Product of G and scalar
+ * @param scalar IN -- scalar
+ * @param curve IN -- elliptic curve
+ */
+void EccPoint_mult_G(uECC_word_t *result, const uECC_word_t *scalar,
+		     uECC_Curve curve);
+
 /*
  * @brief Constant-time comparison to zero - secure way to compare long integers
  * @param vli IN -- very long integer
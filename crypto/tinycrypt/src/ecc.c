@@ -788,21 +788,239 @@ uECC_word_t regularize_k(const uECC_word_t * const k, uECC_word_t *k0,
 	return carry;
 }
 
-uECC_word_t EccPoint_compute_public_key(uECC_word_t *result,
-					uECC_word_t *private_key,
-					uECC_Curve curve)
+#if defined(TC_ECC_FIXED_BASE_COMB)
+/*
+ * Fixed-base comb for multiples of the P-256 generator: 4 teeth spaced 65
+ * bits apart. The scalar is made odd and recoded so every bit is +1 or -1,
+ * hence every comb column selects one of the 8 points
+ * (2^195 +- 2^130 +- 2^65 +- 1) * G below, possibly negated, and is never
+ * zero. Each column costs one doubling and one mixed addition, with table
+ * lookups done in constant time.
+ */
+#define COMB_TEETH (4)
+#define COMB_SPACING (65)
+#define COMB_WORDS BITS_TO_WORDS(COMB_TEETH * COMB_SPACING)
+
+static const uECC_word_t comb_G[8][NUM_ECC_WORDS * 2] = {
+	{
+		0x2695307f, 0xe3c7c30e, 0x106a96c3, 0xbaf5b3d6,
+		0xe96f6a1a, 0x362483c7, 0xac6822d8, 0xcf6f7459,
+		0xf92bf156, 0x8dde1e5e, 0x010e4114, 0x2b9118f9,
+		0x6cf85bfc, 0x7799f779, 0xb42de80e, 0x5025e75a
+	},
+	{
+		0xced8fcd7, 0x1ac3bcbc, 0x3bbcda7d, 0xd1da0627,
+		0x3e88d79f, 0x31f8311c, 0x655bdbed, 0x85de27ed,
+		0x038da636, 0x8044536b, 0x142ecda9, 0x2285e441,
+		0xaed793c2, 0xb3a00b4d, 0xf73cc5a5, 0x68d69d80
+	},
+	{
+		0x94ae5641, 0x3833c1f9, 0xe6166769, 0x1141eef8,
+		0x8c19e892, 0xa8eb278d, 0x7a2960c7, 0xdd993680,
+		0x3a9a01b3, 0x5335147c, 0xc51bfc75, 0x9451e1e8,
+		0xdeb6dcb4, 0xcf21d16d, 0x47685ef1, 0x45a315ba
+	},
+	{
+		0x610a63e6, 0x18598c98, 0xafdd6d0a, 0x03e775fd,
+		0xe085479e, 0xd0212790, 0xc2d4013f, 0x2f677640,
+		0x8d1314aa, 0x21b9832e, 0x3c53541b, 0xad0f57df,
+		0x5a76589c, 0xf785deb9, 0x227765de, 0x5570b05a
+	},
+	{
+		0xa3fa916a, 0x4bad0da1, 0xbd8c3a30, 0x7322ecfe,
+		0x84ba6650, 0x177d7f84, 0xf1e28c51, 0x06a12b8f,
+		0xc27e0a73, 0x3e16efd0, 0xd906e05e, 0x48e454bb,
+		0xc5c14d53, 0x2f6f2db6, 0x38e294e6, 0x046edc1f
+	},
+	{
+		0xe1131ebc, 0xa7cfb7f7, 0x700ee0d7, 0x7df021b5,
+		0x68b23dd7, 0x1fdc2b9c, 0x384c4a0d, 0xd0781325,
+		0x9d1e972b, 0xdc6baf17, 0xb885e602, 0x4b2e64cc,
+		0xc46cf9cc, 0x85abf35f, 0x75cf444a, 0x28bb7e3d
+	},
+	{
+		0x80666cc2, 0xb3506c55, 0xfdc5946d, 0x67ce1671,
+		0xf05aa5b2, 0x2ca7d451, 0xb2dfc4bb, 0x164b67c9,
+		0x2fe2f12f, 0x1c6e801f, 0x7c15d82c, 0x042311e3,
+		0x877b7afa, 0x303d8cb4, 0x68e668d3, 0x6eed994d
+	},
+	{
+		0x0022aec1, 0xe04c2087, 0xe63e79ec, 0x1b9f70f5,
+		0xbe592b8e, 0x44e937e9, 0x1aef2907, 0xec00424c,
+		0x0f7b2c17, 0x8c1d85ec, 0x1319541d, 0x2c79e2c6,
+		0x3ebabc49, 0xd2c54994, 0xa027d39a, 0xbd0df249
+	}
+};
+
+/* Loads +-comb_G[] entry for column col of the recoded scalar. */
+static void comb_select(uECC_word_t *x, uECC_word_t *y,
+			const uECC_word_t *recoded, bitcount_t col,
+			uECC_Curve curve)
+{
+	uECC_word_t ny[NUM_ECC_WORDS];
+	uECC_word_t zero[NUM_ECC_WORDS] = {0};
+	uECC_word_t top;
+	uECC_word_t mask;
+	unsigned int idx;
+	unsigned int i;
+	wordcount_t j;
+	wordcount_t num_words = curve->num_words;
+
+	top = !!uECC_vli_testBit(recoded, col + (COMB_TEETH - 1) * COMB_SPACING);
+	idx = 0;
+	for (i = 0; i < COMB_TEETH - 1; ++i) {
+		idx |= ((!!uECC_vli_testBit(recoded, col + i * COMB_SPACING)) ^
+			top ^ 1) << i;
+	}
+
+	uECC_vli_clear(x, num_words);
+	uECC_vli_clear(y, num_words);
+	for (i = 0; i < 8; ++i) {
+		mask = (uECC_word_t)0 - (((i ^ idx) - 1) >> 31);
+		for (j = 0; j < num_words; ++j) {
+			x[j] |= comb_G[i][j] & mask;
+			y[j] |= comb_G[i][num_words + j] & mask;
+		}
+	}
+
+	/* top tooth clear means the column value is negative */
+	uECC_vli_modSub(ny, zero, y, curve->p, num_words);
+	mask = (uECC_word_t)0 - (top ^ 1);
+	for (j = 0; j < num_words; ++j) {
+		y[j] = (ny[j] & mask) | (y[j] & ~mask);
+	}
+}
+
+/*
+ * (X1, Y1, Z1) += (x2, y2) with x2, y2 affine. Returns non-zero if points
+ * share x coordinate, in which case the result is not valid.
+ */
+static uECC_word_t comb_add(uECC_word_t *X1, uECC_word_t *Y1,
+			    uECC_word_t *Z1, const uECC_word_t *x2,
+			    const uECC_word_t *y2, uECC_Curve curve)
+{
+	uECC_word_t t1[NUM_ECC_WORDS];
+	uECC_word_t t2[NUM_ECC_WORDS];
+	uECC_word_t t3[NUM_ECC_WORDS];
+	uECC_word_t t4[NUM_ECC_WORDS];
+	wordcount_t num_words = curve->num_words;
+
+	uECC_vli_modSquare_fast(t1, Z1, curve); /* t1 = z1^2 */
+	uECC_vli_modMult_fast(t2, x2, t1, curve); /* t2 = x2*z1^2 = U2 */
+	uECC_vli_modMult_fast(t1, t1, Z1, curve); /* t1 = z1^3 */
+	uECC_vli_modMult_fast(t1, t1, y2, curve); /* t1 = y2*z1^3 = S2 */
+	uECC_vli_modSub(t2, t2, X1, curve->p, num_words); /* t2 = U2 - x1 = H */
+	uECC_vli_modSub(t1, t1, Y1, curve->p, num_words); /* t1 = S2 - y1 = R */
+
+	uECC_vli_modMult_fast(Z1, Z1, t2, curve); /* z3 = z1*H */
+	uECC_vli_modSquare_fast(t3, t2, curve); /* t3 = H^2 */
+	uECC_vli_modMult_fast(t4, t3, t2, curve); /* t4 = H^3 */
+	uECC_vli_modMult_fast(t3, X1, t3, curve); /* t3 = x1*H^2 = V */
+
+	uECC_vli_modSquare_fast(X1, t1, curve); /* x3 = R^2 */
+	uECC_vli_modSub(X1, X1, t4, curve->p, num_words); /* x3 = R^2 - H^3 */
+	uECC_vli_modSub(X1, X1, t3, curve->p, num_words);
+	uECC_vli_modSub(X1, X1, t3, curve->p, num_words); /* x3 -= 2*V */
+
+	uECC_vli_modSub(t3, t3, X1, curve->p, num_words); /* t3 = V - x3 */
+	uECC_vli_modMult_fast(t3, t3, t1, curve); /* t3 = R*(V - x3) */
+	uECC_vli_modMult_fast(t4, Y1, t4, curve); /* t4 = y1*H^3 */
+	uECC_vli_modSub(Y1, t3, t4, curve->p, num_words); /* y3 */
+
+	return uECC_vli_isZero(t2, num_words);
+}
+
+/* Returns 0 if an exceptional case was hit and result is not valid. */
+static int EccPoint_mult_comb(uECC_word_t *result, const uECC_word_t *scalar,
+			      uECC_Curve curve)
 {
+	uECC_word_t k0[COMB_WORDS];
+	uECC_word_t k1[COMB_WORDS];
+	uECC_word_t n[COMB_WORDS];
+	uECC_word_t ones[COMB_WORDS];
+	uECC_word_t X[NUM_ECC_WORDS];
+	uECC_word_t Y[NUM_ECC_WORDS];
+	uECC_word_t Z[NUM_ECC_WORDS];
+	uECC_word_t tx[NUM_ECC_WORDS];
+	uECC_word_t ty[NUM_ECC_WORDS];
+	uECC_word_t mask;
+	uECC_word_t exc;
+	bitcount_t col;
+	wordcount_t num_words = curve->num_words;
+	wordcount_t j;
+
+	/* n is odd, so exactly one of k + n and k + 2n is odd */
+	uECC_vli_clear(n, COMB_WORDS);
+	uECC_vli_set(n, curve->n, num_words);
+	uECC_vli_clear(k0, COMB_WORDS);
+	uECC_vli_set(k0, scalar, num_words);
+	uECC_vli_add(k0, k0, n, COMB_WORDS);
+	uECC_vli_add(k1, k0, n, COMB_WORDS);
+	mask = (uECC_word_t)0 - (k0[0] & 1);
+	for (j = 0; j < COMB_WORDS; ++j) {
+		k0[j] = (k0[j] & mask) | (k1[j] & ~mask);
+	}
+
+	/* recoded = (k + 2^260 - 1) / 2, bit i set means digit +1, else -1 */
+	for (j = 0; j < COMB_WORDS; ++j) {
+		ones[j] = (uECC_word_t)-1;
+	}
+	ones[COMB_WORDS - 1] >>=
+		COMB_WORDS * uECC_WORD_BITS - COMB_TEETH * COMB_SPACING;
+	uECC_vli_add(k0, k0, ones, COMB_WORDS);
+	uECC_vli_rshift1(k0, COMB_WORDS);
+
+	comb_select(X, Y, k0, COMB_SPACING - 1, curve);
+	uECC_vli_clear(Z, num_words);
+	Z[0] = 1;
+
+	exc = 0;
+	for (col = COMB_SPACING - 2; col >= 0; --col) {
+		curve->double_jacobian(X, Y, Z, curve);
+		comb_select(tx, ty, k0, col, curve);
+		exc |= comb_add(X, Y, Z, tx, ty, curve);
+	}
+
+	uECC_vli_modInv(Z, Z, curve->p, num_words);
+	apply_z(X, Y, Z, curve);
+
+	uECC_vli_set(result, X, num_words);
+	uECC_vli_set(result + num_words, Y, num_words);
+
+	uECC_vli_clear(k0, COMB_WORDS);
+	uECC_vli_clear(k1, COMB_WORDS);
+
+	return !exc;
+}
+#endif
 
+void EccPoint_mult_G(uECC_word_t *result, const uECC_word_t *scalar,
+		     uECC_Curve curve)
+{
 	uECC_word_t tmp1[NUM_ECC_WORDS];
- 	uECC_word_t tmp2[NUM_ECC_WORDS];
+	uECC_word_t tmp2[NUM_ECC_WORDS];
 	uECC_word_t *p2[2] = {tmp1, tmp2};
 	uECC_word_t carry;
 
+#if defined(TC_ECC_FIXED_BASE_COMB)
+	if (uECC_vli_equal(curve->G, curve_secp256r1.G, NUM_ECC_WORDS * 2) == 0 &&
+	    EccPoint_mult_comb(result, scalar, curve)) {
+		return;
+	}
+#endif
+
 	/* Regularize the bitcount for the private key so that attackers cannot
 	 * use a side channel attack to learn the number of leading zeros. */
-	carry = regularize_k(private_key, tmp1, tmp2, curve);
+	carry = regularize_k(scalar, tmp1, tmp2, curve);
 
 	EccPoint_mult(result, curve->G, p2[!carry], 0, curve->num_n_bits + 1, curve);
+}
+
+uECC_word_t EccPoint_compute_public_key(uECC_word_t *result,
+					uECC_word_t *private_key,
+					uECC_Curve curve)
+{
+	EccPoint_mult_G(result, private_key, curve);
 
 	if (EccPoint_isZero(result, curve)) {
 		return 0;
@@ -73,6 +73,17 @@ int tc_sha256_update(TCSha256State_t s, const uint8_t *data, size_t datalen)
 	}
 
 	while (datalen-- > 0) {
+#if defined(TC_SHA256_FAST)
+		/* whole blocks are compressed straight from the input */
+		if (s->leftover_offset == 0 &&
+		    datalen + 1 >= TC_SHA256_BLOCK_SIZE) {
+			compress(s->iv, data);
+			data += TC_SHA256_BLOCK_SIZE;
+			datalen -= TC_SHA256_BLOCK_SIZE - 1;
+			s->bits_hashed += (TC_SHA256_BLOCK_SIZE << 3);
+			continue;
+		}
+#endif
 		s->leftover[s->leftover_offset++] = *(data++);
 		if (s->leftover_offset >= TC_SHA256_BLOCK_SIZE) {
 			compress(s->iv, s->leftover);
@@ -178,6 +189,73 @@ static inline unsigned int BigEndian(const uint8_t **c)
 	return n;
 }
 
+#if defined(TC_SHA256_FAST)
+/*
+ * Message words are fetched with a single load and byte swap where the core
+ * handles unaligned little-endian loads (e.g. ARMv7-M), byte by byte
+ * otherwise. Rounds are unrolled by 8 so the working variables never move.
+ */
+#if defined(__ARM_FEATURE_UNALIGNED) && \
+    defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+static inline unsigned int load_be32(const uint8_t *p)
+{
+	unsigned int n;
+
+	__builtin_memcpy(&n, p, sizeof(n));
+	return __builtin_bswap32(n);
+}
+#else
+static inline unsigned int load_be32(const uint8_t *p)
+{
+	return BigEndian(&p);
+}
+#endif
+
+#define W(i)(work_space[(i) & 0x0f])
+#define W_UPDATE(i)(W(i) += sigma1(W((i) + 14)) + W((i) + 9) + \
+		    sigma0(W((i) + 1)))
+
+#define ROUND(a, b, c, d, e, f, g, h, w, k) do { \
+		unsigned int _t1 = (h) + Sigma1(e) + Ch(e, f, g) + (k) + (w); \
+		(d) += _t1; \
+		(h) = _t1 + Sigma0(a) + Maj(a, b, c); \
+	} while (0)
+
+#define ROUND8(i, w) do { \
+		ROUND(a, b, c, d, e, f, g, h, w((i) + 0), k256[(i) + 0]); \
+		ROUND(h, a, b, c, d, e, f, g, w((i) + 1), k256[(i) + 1]); \
+		ROUND(g, h, a, b, c, d, e, f, w((i) + 2), k256[(i) + 2]); \
+		ROUND(f, g, h, a, b, c, d, e, w((i) + 3), k256[(i) + 3]); \
+		ROUND(e, f, g, h, a, b, c, d, w((i) + 4), k256[(i) + 4]); \
+		ROUND(d, e, f, g, h, a, b, c, w((i) + 5), k256[(i) + 5]); \
+		ROUND(c, d, e, f, g, h, a, b, w((i) + 6), k256[(i) + 6]); \
+		ROUND(b, c, d, e, f, g, h, a, w((i) + 7), k256[(i) + 7]); \
+	} while (0)
+
+static void compress(unsigned int *iv, const uint8_t *data)
+{
+	unsigned int a, b, c, d, e, f, g, h;
+	unsigned int work_space[16];
+	unsigned int i;
+
+	a = iv[0]; b = iv[1]; c = iv[2]; d = iv[3];
+	e = iv[4]; f = iv[5]; g = iv[6]; h = iv[7];
+
+	for (i = 0; i < 16; ++i) {
+		work_space[i] = load_be32(data + 4 * i);
+	}
+
+	ROUND8(0, W);
+	ROUND8(8, W);
+
+	for (i = 16; i < 64; i += 8) {
+		ROUND8(i, W_UPDATE);
+	}
+
+	iv[0] += a; iv[1] += b; iv[2] += c; iv[3] += d;
+	iv[4] += e; iv[5] += f; iv[6] += g; iv[7] += h;
+}
+#else
 static void compress(unsigned int *iv, const uint8_t *data)
 {
 	unsigned int a, b, c, d, e, f, g, h;
@@ -215,3 +293,4 @@ static void compress(unsigned int *iv, const uint8_t *data)
 	iv[0] += a; iv[1] += b; iv[2] += c; iv[3] += d;
 	iv[4] += e; iv[5] += f; iv[6] += g; iv[7] += h;
 }
+#endif /* TC_SHA256_FAST */
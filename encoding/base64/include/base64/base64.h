@@ -32,7 +32,35 @@ int base64_pad(char *, int);
 int base64_decode_len(const char *str);
 int base64_decode_maxlen(const char *str, void *data, int len);
 
+/*
+ * Incremental encoding, for data that arrives in pieces, e.g. an mbuf
+ * chain one buffer at a time.  The output is the same as base64_encode()
+ * of all the data at once.
+ */
+struct base64_encoder {
+    uint8_t be_buf[3];      /* bytes not yet encoded */
+    uint8_t be_len;
+};
+
+void base64_encoder_init(struct base64_encoder *be);
+
+/*
+ * Encodes len bytes of data, along with any left over from the previous
+ * call, and returns the number of characters written to s: at most
+ * BASE64_ENCODE_STREAM_SIZE(len).  Not null-terminated.
+ */
+int base64_encoder_update(struct base64_encoder *be, const void *data,
+                          int len, char *s);
+
+/*
+ * Encodes what is left and returns the number of characters written to s:
+ * at most 4.  Not null-terminated.
+ */
+int base64_encoder_finish(struct base64_encoder *be, char *s,
+                          uint8_t should_pad);
+
 #define BASE64_ENCODE_SIZE(__size) (((((__size) - 1) / 3) * 4) + 4)
+#define BASE64_ENCODE_STREAM_SIZE(__size) ((((__size) + 2) / 3) * 4)
 
 #ifdef __cplusplus
 }
@@ -24,11 +24,13 @@
 
 TEST_CASE_DECL(hex2str)
 TEST_CASE_DECL(str2hex)
+TEST_CASE_DECL(base64_stream)
 
 TEST_SUITE(hex_fmt_test_suite)
 {
     hex2str();
     str2hex();
+    base64_stream();
 }
 
 int
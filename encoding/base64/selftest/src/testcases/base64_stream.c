@@ -0,0 +1,81 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <string.h>
+#include "encoding_test_priv.h"
+#include "base64/base64.h"
+
+TEST_CASE_SELF(base64_stream)
+{
+    struct base64_encoder be;
+    uint8_t data[32];
+    uint8_t out[32];
+    char whole[BASE64_ENCODE_SIZE(sizeof(data)) + 1];
+    char streamed[BASE64_ENCODE_SIZE(sizeof(data)) + 1];
+    int chunk;
+    int size;
+    int off;
+    int len;
+    int rc;
+    int i;
+
+    for (i = 0; i < sizeof(data); i++) {
+        data[i] = i * 37;
+    }
+
+    /* Any split of the input gives the same output as one call. */
+    for (size = 0; size <= sizeof(data); size++) {
+        rc = base64_encode(data, size, whole, 1);
+        TEST_ASSERT(rc == (size ? BASE64_ENCODE_SIZE(size) : 0));
+
+        for (chunk = 1; chunk <= 4; chunk++) {
+            base64_encoder_init(&be);
+            len = 0;
+            for (off = 0; off < size; off += chunk) {
+                len += base64_encoder_update(&be, data + off,
+                  size - off < chunk ? size - off : chunk, streamed + len);
+            }
+            len += base64_encoder_finish(&be, streamed + len, 1);
+            streamed[len] = '\0';
+            TEST_ASSERT(len == rc);
+            TEST_ASSERT(!strcmp(whole, streamed));
+        }
+
+        rc = base64_decode(whole, out);
+        TEST_ASSERT(rc == size);
+        TEST_ASSERT(!memcmp(out, data, size));
+    }
+
+    rc = base64_encode("ab", 2, whole, 0);
+    TEST_ASSERT(rc == 3 && !strcmp(whole, "YWI"));
+
+    rc = base64_decode_maxlen("YWJjZGVm", out, 4);
+    TEST_ASSERT(rc == 4 && !memcmp(out, "abcd", 4));
+
+    /*
+     * Test invalid input
+     */
+    rc = base64_decode("YW", out);
+    TEST_ASSERT(rc < 0);
+
+    rc = base64_decode("Y=I=", out);
+    TEST_ASSERT(rc < 0);
+
+    rc = base64_decode("YW\nI", out);
+    TEST_ASSERT(rc < 0);
+}
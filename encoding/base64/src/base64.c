@@ -41,72 +41,147 @@
 #include <stdlib.h>
 #include <string.h>
 
-#include <stdio.h>
-
 #include <base64/base64.h>
 
 static const char base64_chars[] =
     "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 
+/*
+ * Value of a base64 digit, or -1.  Range checks instead of a search through
+ * the alphabet, or a 256 byte table.
+ */
 static int
 pos(char c)
 {
-    const char *p;
-    for (p = base64_chars; *p; p++)
-        if (*p == c)
-            return p - base64_chars;
+    if (c >= 'A' && c <= 'Z') {
+        return c - 'A';
+    }
+    if (c >= 'a' && c <= 'z') {
+        return c - 'a' + 26;
+    }
+    if (c >= '0' && c <= '9') {
+        return c - '0' + 52;
+    }
+    if (c == '+') {
+        return 62;
+    }
+    if (c == '/') {
+        return 63;
+    }
     return -1;
 }
 
+static void
+base64_encode_triple(const unsigned char *q, char *p)
+{
+    uint32_t c;
+
+    c = ((uint32_t)q[0] << 16) | ((uint32_t)q[1] << 8) | q[2];
+    p[0] = base64_chars[(c >> 18) & 0x3f];
+    p[1] = base64_chars[(c >> 12) & 0x3f];
+    p[2] = base64_chars[(c >> 6) & 0x3f];
+    p[3] = base64_chars[c & 0x3f];
+}
+
+/* Encodes the last 1 or 2 bytes of the input. */
+static int
+base64_encode_tail(const unsigned char *q, int rem, char *p,
+                   uint8_t should_pad)
+{
+    unsigned char last[3];
+
+    last[0] = q[0];
+    last[1] = rem > 1 ? q[1] : 0;
+    last[2] = 0;
+    base64_encode_triple(last, p);
+    if (should_pad) {
+        memset(p + rem + 1, '=', 3 - rem);
+        return 4;
+    }
+    return rem + 1;
+}
+
 int
 base64_encode(const void *data, int size, char *s, uint8_t should_pad)
 {
+    const unsigned char *q;
     char *p;
+    int full;
     int i;
-    int c;
-    const unsigned char *q;
-    char *last;
-    int diff;
 
+    q = (const unsigned char *) data;
     p = s;
 
-    q = (const unsigned char *) data;
-    last = NULL;
-    i = 0;
-    while (i < size) {
-        c = q[i++];
-        c *= 256;
-        if (i < size)
-            c += q[i];
-        i++;
-        c *= 256;
-        if (i < size)
-            c += q[i];
-        i++;
-        p[0] = base64_chars[(c & 0x00fc0000) >> 18];
-        p[1] = base64_chars[(c & 0x0003f000) >> 12];
-        p[2] = base64_chars[(c & 0x00000fc0) >> 6];
-        p[3] = base64_chars[(c & 0x0000003f) >> 0];
-        last = p;
+    full = size - size % 3;
+    for (i = 0; i < full; i += 3) {
+        base64_encode_triple(q + i, p);
         p += 4;
     }
+    if (i < size) {
+        p += base64_encode_tail(q + i, size - i, p, should_pad);
+    }
 
-    if (last) {
-        diff = i - size;
-        if (diff > 0) {
-            if (should_pad) {
-                memset(last + (4 - diff), '=', diff);
-            } else {
-                p = last + (4 - diff);
-            }
+    *p = 0;
+
+    return (p - s);
+}
+
+void
+base64_encoder_init(struct base64_encoder *be)
+{
+    be->be_len = 0;
+}
+
+int
+base64_encoder_update(struct base64_encoder *be, const void *data, int len,
+                      char *s)
+{
+    const unsigned char *q;
+    char *p;
+
+    q = data;
+    p = s;
+
+    /* Complete the group left over from the previous call. */
+    if (be->be_len != 0) {
+        while (be->be_len < 3 && len > 0) {
+            be->be_buf[be->be_len++] = *q++;
+            len--;
+        }
+        if (be->be_len < 3) {
+            return 0;
         }
+        base64_encode_triple(be->be_buf, p);
+        p += 4;
+        be->be_len = 0;
     }
 
-    *p = 0;
+    while (len >= 3) {
+        base64_encode_triple(q, p);
+        p += 4;
+        q += 3;
+        len -= 3;
+    }
+
+    memcpy(be->be_buf, q, len);
+    be->be_len = len;
 
     return (p - s);
 }
 
+int
+base64_encoder_finish(struct base64_encoder *be, char *s, uint8_t should_pad)
+{
+    int len;
+
+    len = 0;
+    if (be->be_len != 0) {
+        len = base64_encode_tail(be->be_buf, be->be_len, s, should_pad);
+        be->be_len = 0;
+    }
+    return len;
+}
+
 int
 base64_pad(char *buf, int len)
 {
@@ -122,92 +197,122 @@ base64_pad(char *buf, int len)
     return (4 - remainder);
 }
 
-#define DECODE_ERROR -1
-
-static unsigned int
-token_decode(const char *token)
+static int
+base64_is_start(char c)
 {
-    int i;
-    unsigned int val = 0;
-    int marker = 0;
-    if (strlen(token) < 4)
-        return DECODE_ERROR;
-    for (i = 0; i < 4; i++) {
-        val *= 64;
-        if (token[i] == '=')
-            marker++;
-        else if (marker > 0)
-            return DECODE_ERROR;
-        else
-            val += pos(token[i]);
-    }
-    if (marker > 2)
-        return DECODE_ERROR;
-    return (marker << 24) | val;
+    return c == '=' || pos(c) >= 0;
 }
 
-int
-base64_decode(const char *str, void *data)
+/*
+ * Decodes one group of four characters into *val.
+ *
+ * @return The number of '=' at the end of the group; -1 if it is malformed.
+ */
+static int
+token_decode(const char *token, uint32_t *val)
 {
-    const char *p;
-    unsigned char *q;
+    int d[4];
+    int marker;
+    int i;
 
-    q = data;
-    for (p = str; *p && (*p == '=' || strchr(base64_chars, *p)); p += 4) {
-        unsigned int val = token_decode(p);
-        unsigned int marker = (val >> 24) & 0xff;
-        if (val == DECODE_ERROR) {
-            return -1;
+    /* Common case first: four digits, no padding. */
+    if (token[0] != '\0' && token[1] != '\0' &&
+        token[2] != '\0' && token[3] != '\0') {
+        d[0] = pos(token[0]);
+        d[1] = pos(token[1]);
+        d[2] = pos(token[2]);
+        d[3] = pos(token[3]);
+        if ((d[0] | d[1] | d[2] | d[3]) >= 0) {
+            *val = ((uint32_t)d[0] << 18) | ((uint32_t)d[1] << 12) |
+                   ((uint32_t)d[2] << 6) | d[3];
+            return 0;
         }
-        *q++ = (val >> 16) & 0xff;
-        if (marker < 2) {
-            *q++ = (val >> 8) & 0xff;
+    }
+
+    *val = 0;
+    marker = 0;
+    for (i = 0; i < 4; i++) {
+        if (token[i] == '\0') {
+            return -1;
         }
-        if (marker < 1) {
-            *q++ = val & 0xff;
+        *val <<= 6;
+        if (token[i] == '=') {
+            marker++;
+        } else if (marker > 0) {
+            return -1;
+        } else {
+            d[0] = pos(token[i]);
+            if (d[0] < 0) {
+                return -1;
+            }
+            *val += d[0];
         }
     }
-    return q - (unsigned char *) data;
+    if (marker > 2) {
+        return -1;
+    }
+    return marker;
 }
 
-int
-base64_decode_maxlen(const char *str, void *data, int len)
+/*
+ * Decodes groups until the string ends, or a character that can't start
+ * one is found.  If maxlen is not negative, decoding stops as soon as
+ * maxlen bytes have been written.
+ */
+static int
+base64_decode_internal(const char *str, void *data, int maxlen)
 {
     const char *p;
     unsigned char *q;
+    uint32_t val;
+    int marker;
+    int room;
 
     q = data;
-    for (p = str; *p && (*p == '=' || strchr(base64_chars, *p)); p += 4) {
-        unsigned int val = token_decode(p);
-        unsigned int marker = (val >> 24) & 0xff;
-
-        if (val == DECODE_ERROR) {
+    room = maxlen;
+    for (p = str; base64_is_start(*p); p += 4) {
+        marker = token_decode(p, &val);
+        if (marker < 0) {
             return -1;
         }
 
-        *q++ = (val >> 16) & 0xff;
-        if (q - (unsigned char *)data >= len) {
-            break;
-        }
-
-        if (marker < 2) {
-            *q++ = (val >> 8) & 0xff;
-            if (q - (unsigned char *)data >= len) {
-                break;
+        if (maxlen < 0 || room > 3 - marker) {
+            *q++ = (val >> 16) & 0xff;
+            if (marker < 2) {
+                *q++ = (val >> 8) & 0xff;
+            }
+            if (marker < 1) {
+                *q++ = val & 0xff;
             }
+            room -= 3 - marker;
+            continue;
         }
 
-        if (marker < 1) {
-            *q++ = val & 0xff;
-            if (q - (unsigned char *)data >= len) {
-                break;
+        /* The output fills up within this group. */
+        *q++ = (val >> 16) & 0xff;
+        if (--room > 0 && marker < 2) {
+            *q++ = (val >> 8) & 0xff;
+            if (--room > 0 && marker < 1) {
+                *q++ = val & 0xff;
             }
         }
+        break;
     }
-
     return q - (unsigned char *) data;
 }
 
+int
+base64_decode(const char *str, void *data)
+{
+    return base64_decode_internal(str, data, -1);
+}
+
+int
+base64_decode_maxlen(const char *str, void *data, int len)
+{
+    return base64_decode_internal(str, data, len);
+}
+
 int
 base64_decode_len(const char *str)
 {
@@ -23,6 +23,9 @@
 
 TEST_CASE_DECL(test_json_simple_encode);
 TEST_CASE_DECL(test_json_simple_decode);
+TEST_CASE_DECL(test_json_stream_decode);
+TEST_CASE_DECL(test_json_encode_escape);
+TEST_CASE_DECL(test_json_encode_int);
 
 TEST_SUITE(test_json_suite)
 {
@@ -31,6 +34,9 @@ TEST_SUITE(test_json_suite)
 
     test_json_simple_encode();
     test_json_simple_decode();
+    test_json_stream_decode();
+    test_json_encode_escape();
+    test_json_encode_int();
 
     free(bigbuf);
 }
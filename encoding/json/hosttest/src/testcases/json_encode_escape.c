@@ -0,0 +1,71 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "test_json_priv.h"
+
+/* Output longer than the encoder's buffer is flushed part way through. */
+#define JSON_ESCAPE_LONG_REPS   10
+
+/* A run without escapes this long bypasses the buffer. */
+#define JSON_ESCAPE_LONG_RUN    70
+
+TEST_CASE(test_json_encode_escape)
+{
+    struct json_encoder encoder;
+    struct json_value value;
+    char expected[JSON_BIGBUF_SIZE];
+    char str[JSON_BIGBUF_SIZE];
+    int rc;
+    int i;
+
+    /* Only je_write, je_arg and je_wr_commas need setting up. */
+    buf_index = 0;
+    memset(&encoder, 0xa5, sizeof(encoder));
+    encoder.je_write = test_write;
+    encoder.je_arg = NULL;
+    encoder.je_wr_commas = 0;
+
+    JSON_VALUE_STRING(&value, "a\"b/c\\d\te\rf\ng\fh\bi");
+    rc = json_encode_array_value(&encoder, &value);
+    TEST_ASSERT(rc == 0);
+
+    bigbuf[buf_index] = '\0';
+    TEST_ASSERT(strcmp(bigbuf,
+                       "\"a\\\"b\\/c\\\\d\\te\\rf\\ng\\fh\\bi\"") == 0,
+                "%s", bigbuf);
+
+    /* Runs and escapes straddling the buffer size. */
+    str[0] = '\0';
+    strcpy(expected, ",\"");
+    for (i = 0; i < JSON_ESCAPE_LONG_REPS; i++) {
+        strcat(str, "0123456\"");
+        strcat(expected, "0123456\\\"");
+    }
+    memset(str + strlen(str), 'x', JSON_ESCAPE_LONG_RUN);
+    str[JSON_ESCAPE_LONG_REPS * 8 + JSON_ESCAPE_LONG_RUN] = '\0';
+    strcat(expected, str + JSON_ESCAPE_LONG_REPS * 8);
+    strcat(expected, "\"");
+
+    buf_index = 0;
+    JSON_VALUE_STRING(&value, str);
+    rc = json_encode_array_value(&encoder, &value);
+    TEST_ASSERT(rc == 0);
+
+    bigbuf[buf_index] = '\0';
+    TEST_ASSERT(strcmp(bigbuf, expected) == 0, "%s", bigbuf);
+}
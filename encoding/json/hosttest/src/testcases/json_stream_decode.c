@@ -0,0 +1,144 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <stdio.h>
+#include "test_json_priv.h"
+
+static char test_stream_log[256];
+
+/* Records each event as "<key>:<what> ". */
+static int
+test_stream_cb(struct json_stream *js, const struct json_stream_event *ev,
+               void *arg)
+{
+    size_t off;
+
+    off = strlen(test_stream_log);
+    switch (ev->jse_type) {
+    case JSON_STREAM_EV_OBJ_START:
+        snprintf(test_stream_log + off, sizeof(test_stream_log) - off,
+                 "%d:{ ", ev->jse_key);
+        break;
+    case JSON_STREAM_EV_ARR_START:
+        snprintf(test_stream_log + off, sizeof(test_stream_log) - off,
+                 "%d:[ ", ev->jse_key);
+        break;
+    case JSON_STREAM_EV_OBJ_END:
+        snprintf(test_stream_log + off, sizeof(test_stream_log) - off, "} ");
+        break;
+    case JSON_STREAM_EV_ARR_END:
+        snprintf(test_stream_log + off, sizeof(test_stream_log) - off, "] ");
+        break;
+    case JSON_STREAM_EV_STRING:
+    case JSON_STREAM_EV_NUMBER:
+        snprintf(test_stream_log + off, sizeof(test_stream_log) - off,
+                 "%d:%.*s%s ", ev->jse_key, ev->jse_len, ev->jse_val,
+                 ev->jse_more ? "+" : "");
+        break;
+    case JSON_STREAM_EV_TRUE:
+        snprintf(test_stream_log + off, sizeof(test_stream_log) - off,
+                 "%d:T ", ev->jse_key);
+        break;
+    case JSON_STREAM_EV_FALSE:
+        snprintf(test_stream_log + off, sizeof(test_stream_log) - off,
+                 "%d:F ", ev->jse_key);
+        break;
+    case JSON_STREAM_EV_NULL:
+        snprintf(test_stream_log + off, sizeof(test_stream_log) - off,
+                 "%d:N ", ev->jse_key);
+        break;
+    }
+    return 0;
+}
+
+static int
+test_stream_parse(const struct json_stream_keys *keys, const char *doc,
+                  int chunk, uint16_t tok_size)
+{
+    struct json_stream js;
+    char tok[16];
+    int len;
+    int off;
+    int rc;
+
+    TEST_ASSERT_FATAL(tok_size <= sizeof(tok));
+    test_stream_log[0] = '\0';
+    json_stream_init(&js, keys, tok, tok_size, test_stream_cb, NULL);
+
+    len = strlen(doc);
+    for (off = 0; off < len; off += chunk) {
+        rc = json_stream_feed(&js, doc + off,
+                              len - off < chunk ? len - off : chunk);
+        if (rc != 0) {
+            return rc;
+        }
+    }
+    return json_stream_finish(&js);
+}
+
+TEST_CASE(test_json_stream_decode)
+{
+    static const char * const names[] = { "id", "name", "list", "sub" };
+    static const char doc[] =
+        "{ \"id\": -12, \"name\": \"a\\u00e9\\\"b\", \"other\": null,\n"
+        "  \"list\": [1.5e3, true, false, {}],\n"
+        "  \"sub\": { \"id\": 7, \"x\": [] } }";
+    static const char expected[] =
+        "-1:{ 0:-12 1:a\xc3\xa9\"b -1:N 2:[ -1:1.5e3 -1:T -1:F -1:{ } ] "
+        "3:{ 0:7 -1:[ ] } } ";
+    struct json_stream_keys keys;
+    uint8_t slots[8];
+    int chunk;
+    int rc;
+
+    rc = json_stream_keys_init(&keys, names, 4, slots, 8);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /* The result must not depend on how the input is split. */
+    for (chunk = 1; chunk <= (int)sizeof(doc); chunk *= 3) {
+        rc = test_stream_parse(&keys, doc, chunk, 16);
+        TEST_ASSERT(rc == 0);
+        TEST_ASSERT(strcmp(test_stream_log, expected) == 0);
+    }
+
+    /* Long strings come in pieces; a surrogate pair is one character. */
+    rc = test_stream_parse(NULL, "[\"0123456789\\ud83d\\ude00\"]", 5, 8);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(strcmp(test_stream_log,
+                       "-1:[ -1:01234567+ -1:89\xf0\x9f\x98\x80 ] ") == 0);
+
+    /* A bare top-level number is only complete at the end of the input. */
+    rc = test_stream_parse(NULL, "42", 1, 8);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(strcmp(test_stream_log, "-1:42 ") == 0);
+
+    rc = test_stream_parse(NULL, "{\"a\": [1, 2}", 4, 8);
+    TEST_ASSERT(rc == JSON_ERR_BADTRAIL);
+    rc = test_stream_parse(NULL, "{\"a\": [1, 2]", 4, 8);
+    TEST_ASSERT(rc == JSON_ERR_INCOMPLETE);
+    rc = test_stream_parse(NULL, "{\"a\": tru}", 4, 8);
+    TEST_ASSERT(rc == JSON_ERR_BADNUM);
+    rc = test_stream_parse(NULL, "{\"longer_than_tok\": 1}", 4, 8);
+    TEST_ASSERT(rc == JSON_ERR_ATTRLEN);
+    rc = test_stream_parse(NULL, "{} {}", 4, 8);
+    TEST_ASSERT(rc == JSON_ERR_BADTRAIL);
+
+    /* Table must be a power of two larger than the key count. */
+    rc = json_stream_keys_init(&keys, names, 4, slots, 4);
+    TEST_ASSERT(rc == JSON_ERR_MISC);
+}
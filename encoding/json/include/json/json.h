@@ -80,10 +80,16 @@ struct json_value {
 typedef int (*json_write_func_t)(void *buf, char *data,
         int len);
 
+/*
+ * Output is collected in je_encode_buf and handed to je_write in one piece
+ * by the time each json_encode_xxx() call returns, so output written directly
+ * through je_write between calls stays in order.
+ */
 struct json_encoder {
     json_write_func_t je_write;
     void *je_arg;
     int je_wr_commas:1;
+    uint8_t je_buf_len;
     char je_encode_buf[64];
 };
 
@@ -223,6 +229,128 @@ int json_read_array(struct json_buffer *, const struct json_array_t *);
 #define JSON_ERR_MISC        20  /* other data conversion error */
 #define JSON_ERR_BADNUM      21  /* error while parsing a numerical argument */
 #define JSON_ERR_NULLPTR     22  /* unexpected null value or attribute pointer */
+#define JSON_ERR_TOODEEP     23  /* nesting deeper than JSON_STREAM_MAX_DEPTH */
+#define JSON_ERR_INCOMPLETE  24  /* input ended inside the document */
+
+/*
+ * Streaming (push) parser.
+ *
+ * Input is fed in chunks of any size, e.g. one mbuf or one socket read at a
+ * time, and the document is reported as a sequence of events.  Nothing but
+ * the token being parsed is ever buffered, so its size is independent of
+ * the size of the document.
+ *
+ * Member names are looked up in a key table hashed once, up front, with
+ * json_stream_keys_init().  Each event is tagged with the index of the
+ * member it belongs to.
+ */
+#define JSON_STREAM_EV_OBJ_START    1
+#define JSON_STREAM_EV_OBJ_END      2
+#define JSON_STREAM_EV_ARR_START    3
+#define JSON_STREAM_EV_ARR_END      4
+#define JSON_STREAM_EV_STRING       5   /* may come in pieces, see jse_more */
+#define JSON_STREAM_EV_NUMBER       6   /* text of the number */
+#define JSON_STREAM_EV_TRUE         7
+#define JSON_STREAM_EV_FALSE        8
+#define JSON_STREAM_EV_NULL         9
+
+#define JSON_STREAM_MAX_DEPTH       32
+
+/* Index of a member not in the key table, or of an array element. */
+#define JSON_STREAM_KEY_NONE        (-1)
+
+struct json_stream_keys {
+    const char * const *jsk_names;
+    uint8_t *jsk_slots;         /* 0 if empty, else index + 1 */
+    uint16_t jsk_nslots;
+};
+
+struct json_stream_event {
+    uint8_t jse_type;
+    uint8_t jse_depth;          /* of the value; 0 for the document itself */
+    uint8_t jse_more:1;         /* string continues in the next event */
+    int jse_key;
+    /* String (unescaped) and number events; valid during the callback. */
+    const char *jse_val;
+    uint16_t jse_len;
+};
+
+struct json_stream;
+
+/* Returns 0 to continue; anything else stops parsing and is returned by
+ * json_stream_feed(). */
+typedef int json_stream_event_fn(struct json_stream *js,
+                                 const struct json_stream_event *ev,
+                                 void *arg);
+
+struct json_stream {
+    const struct json_stream_keys *js_keys;
+    json_stream_event_fn *js_cb;
+    void *js_cb_arg;
+
+    char *js_tok;
+    uint16_t js_tok_size;
+    uint16_t js_tok_len;
+
+    uint32_t js_hash;
+    uint32_t js_uesc;
+    int js_key;
+    uint32_t js_in_obj;         /* bit n set if level n + 1 is an object */
+    uint8_t js_depth;
+    uint8_t js_state;
+    uint8_t js_str_state;
+    uint8_t js_nhex;
+};
+
+/**
+ * Hashes a set of member names for the streaming parser.
+ *
+ * @param keys          The key table to initialize.
+ * @param names         Member names; must stay valid.
+ * @param cnt           Number of names, at most 255.
+ * @param slots         Storage for the hash table.
+ * @param nslots        Number of slots: a power of two greater than cnt.
+ *
+ * @return 0 on success; JSON_ERR_MISC if the table is too small or a name
+ *         occurs twice.
+ */
+int json_stream_keys_init(struct json_stream_keys *keys,
+                          const char * const *names, int cnt,
+                          uint8_t *slots, int nslots);
+
+/**
+ * Prepares a streaming parser for a new document.
+ *
+ * @param js            The parser.
+ * @param keys          Member names to look up; NULL for none.
+ * @param tok           Buffer for the token being parsed: member names and
+ *                          numbers must fit whole, longer strings are
+ *                          reported in pieces.
+ * @param tok_size      Size of tok.
+ * @param cb            Called for each event.
+ * @param arg           Argument passed to cb.
+ */
+void json_stream_init(struct json_stream *js,
+                      const struct json_stream_keys *keys,
+                      char *tok, uint16_t tok_size,
+                      json_stream_event_fn *cb, void *arg);
+
+/**
+ * Parses the next chunk of the document.
+ *
+ * @return 0 on success; JSON_ERR_xxx on malformed input; otherwise the
+ *         non-zero value the callback returned.  The parser can't be used
+ *         after an error until it is initialized again.
+ */
+int json_stream_feed(struct json_stream *js, const char *data, int len);
+
+/**
+ * Signals the end of the input.
+ *
+ * @return 0 if a complete document was parsed; JSON_ERR_INCOMPLETE if the
+ *         input stopped inside it.
+ */
+int json_stream_finish(struct json_stream *js);
 
 /*
  * Use the following macros to declare template initializers for structobject
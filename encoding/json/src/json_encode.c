@@ -22,28 +22,171 @@
 
 #include <json/json.h>
 
-#define JSON_ENCODE_OBJECT_START(__e) \
-    (__e)->je_write((__e)->je_arg, "{", sizeof("{")-1);
+/*
+ * Every json_encode_xxx() call flushes before it returns, so the buffer is
+ * empty on entry.  Callers need not initialise it.
+ */
+static void
+json_encode_begin(struct json_encoder *encoder)
+{
+    encoder->je_buf_len = 0;
+}
 
-#define JSON_ENCODE_OBJECT_END(__e) \
-    (__e)->je_write((__e)->je_arg, "}", sizeof("}")-1);
+static void
+json_encode_flush(struct json_encoder *encoder)
+{
+    if (encoder->je_buf_len != 0) {
+        encoder->je_write(encoder->je_arg, encoder->je_encode_buf,
+                encoder->je_buf_len);
+        encoder->je_buf_len = 0;
+    }
+}
 
-#define JSON_ENCODE_ARRAY_START(__e) \
-    (__e)->je_write((__e)->je_arg, "[", sizeof("[")-1);
+static void
+json_encode_put(struct json_encoder *encoder, const char *data, int len)
+{
+    if (encoder->je_buf_len + len > (int)sizeof(encoder->je_encode_buf)) {
+        json_encode_flush(encoder);
+        if (len > (int)sizeof(encoder->je_encode_buf)) {
+            /* Too big to be worth copying. */
+            encoder->je_write(encoder->je_arg, (char *)data, len);
+            return;
+        }
+    }
+    memcpy(encoder->je_encode_buf + encoder->je_buf_len, data, len);
+    encoder->je_buf_len += len;
+}
 
-#define JSON_ENCODE_ARRAY_END(__e) \
-    (__e)->je_write((__e)->je_arg, "]", sizeof("]")-1);
+#define JSON_ENCODE_PUT_STR(__e, __s) \
+    json_encode_put((__e), (__s), sizeof(__s)-1)
 
+#define JSON_ENCODE_OBJECT_START(__e) JSON_ENCODE_PUT_STR(__e, "{")
+#define JSON_ENCODE_OBJECT_END(__e)   JSON_ENCODE_PUT_STR(__e, "}")
+#define JSON_ENCODE_ARRAY_START(__e)  JSON_ENCODE_PUT_STR(__e, "[")
+#define JSON_ENCODE_ARRAY_END(__e)    JSON_ENCODE_PUT_STR(__e, "]")
 
-int
-json_encode_object_start(struct json_encoder *encoder)
+static void
+json_encode_comma(struct json_encoder *encoder)
 {
     if (encoder->je_wr_commas) {
-        encoder->je_write(encoder->je_arg, ",", sizeof(",")-1);
+        JSON_ENCODE_PUT_STR(encoder, ",");
         encoder->je_wr_commas = 0;
     }
+}
+
+/*
+ * Formats an unsigned number.  64-bit division is a library call on most
+ * of our targets, so it is only used until the value fits in 32 bits.
+ */
+static int
+json_encode_u64(char *buf, uint64_t val)
+{
+    char tmp[20];
+    uint32_t val32;
+    int len;
+    int i;
+
+    len = 0;
+    while (val > UINT32_MAX) {
+        tmp[len++] = '0' + val % 10;
+        val /= 10;
+    }
+    val32 = val;
+    do {
+        tmp[len++] = '0' + val32 % 10;
+        val32 /= 10;
+    } while (val32 != 0);
+
+    for (i = 0; i < len; i++) {
+        buf[i] = tmp[len - 1 - i];
+    }
+    return len;
+}
+
+static void
+json_encode_number(struct json_encoder *encoder, uint64_t val, int is_signed)
+{
+    char buf[21];
+    int len;
+
+    len = 0;
+    if (is_signed && (int64_t)val < 0) {
+        buf[len++] = '-';
+        val = -val;
+    }
+    len += json_encode_u64(buf + len, val);
+    json_encode_put(encoder, buf, len);
+}
+
+static const char *
+json_encode_escape(char c)
+{
+    switch (c) {
+    case '"':
+        return "\\\"";
+    case '/':
+        return "\\/";
+    case '\\':
+        return "\\\\";
+    case '\t':
+        return "\\t";
+    case '\r':
+        return "\\r";
+    case '\n':
+        return "\\n";
+    case '\f':
+        return "\\f";
+    case '\b':
+        return "\\b";
+    default:
+        return NULL;
+    }
+}
+
+/* Characters needing no escape are passed on in runs. */
+static void
+json_encode_string(struct json_encoder *encoder, const char *str, int len)
+{
+    const char *esc;
+    int start;
+    int i;
+
+    JSON_ENCODE_PUT_STR(encoder, "\"");
+    start = 0;
+    for (i = 0; i < len; i++) {
+        esc = json_encode_escape(str[i]);
+        if (esc != NULL) {
+            json_encode_put(encoder, str + start, i - start);
+            json_encode_put(encoder, esc, 2);
+            start = i + 1;
+        }
+    }
+    json_encode_put(encoder, str + start, len - start);
+    JSON_ENCODE_PUT_STR(encoder, "\"");
+}
+
+static void
+json_encode_key(struct json_encoder *encoder, char *key)
+{
+    json_encode_comma(encoder);
+
+    /* Write the key entry */
+    JSON_ENCODE_PUT_STR(encoder, "\"");
+    json_encode_put(encoder, key, strlen(key));
+    JSON_ENCODE_PUT_STR(encoder, "\": ");
+}
+
+static int json_encode_entry(struct json_encoder *encoder, char *key,
+        struct json_value *val);
+
+int
+json_encode_object_start(struct json_encoder *encoder)
+{
+    json_encode_begin(encoder);
+    json_encode_comma(encoder);
     JSON_ENCODE_OBJECT_START(encoder);
     encoder->je_wr_commas = 0;
+    json_encode_flush(encoder);
 
     return (0);
 }
@@ -53,65 +196,23 @@ json_encode_value(struct json_encoder *encoder, struct json_value *jv)
 {
     int rc;
     int i;
-    int len;
 
     switch (jv->jv_type) {
         case JSON_VALUE_TYPE_BOOL:
-            len = sprintf(encoder->je_encode_buf, "%s",
-                    jv->jv_val.u > 0 ? "true" : "false");
-            encoder->je_write(encoder->je_arg, encoder->je_encode_buf, len);
+            if (jv->jv_val.u > 0) {
+                JSON_ENCODE_PUT_STR(encoder, "true");
+            } else {
+                JSON_ENCODE_PUT_STR(encoder, "false");
+            }
             break;
         case JSON_VALUE_TYPE_UINT64:
-            len = sprintf(encoder->je_encode_buf, "%llu",
-                    jv->jv_val.u);
-            encoder->je_write(encoder->je_arg, encoder->je_encode_buf, len);
+            json_encode_number(encoder, jv->jv_val.u, 0);
             break;
         case JSON_VALUE_TYPE_INT64:
-            len = sprintf(encoder->je_encode_buf, "%lld",
-                    jv->jv_val.u);
-            encoder->je_write(encoder->je_arg, encoder->je_encode_buf, len);
+            json_encode_number(encoder, jv->jv_val.u, 1);
             break;
         case JSON_VALUE_TYPE_STRING:
-            encoder->je_write(encoder->je_arg, "\"", sizeof("\"")-1);
-            for (i = 0; i < jv->jv_len; i++) {
-                switch (jv->jv_val.str[i]) {
-                    case '"':
-                    case '/':
-                    case '\\':
-                        encoder->je_write(encoder->je_arg, "\\",
-                                sizeof("\\")-1);
-                        encoder->je_write(encoder->je_arg,
-                                (char *) &jv->jv_val.str[i], 1);
-
-                        break;
-                    case '\t':
-                        encoder->je_write(encoder->je_arg, "\\t",
-                                sizeof("\\t")-1);
-                        break;
-                    case '\r':
-                        encoder->je_write(encoder->je_arg, "\\r",
-                                sizeof("\\r")-1);
-                        break;
-                    case '\n':
-                        encoder->je_write(encoder->je_arg, "\\n",
-                                sizeof("\\n")-1);
-                        break;
-                    case '\f':
-                        encoder->je_write(encoder->je_arg, "\\f",
-                                sizeof("\\f")-1);
-                        break;
-                    case '\b':
-                        encoder->je_write(encoder->je_arg, "\\b",
-                                sizeof("\\b")-1);
-                        break;
-                   default:
-                        encoder->je_write(encoder->je_arg,
-                                (char *) &jv->jv_val.str[i], 1);
-                        break;
-                }
-
-            }
-            encoder->je_write(encoder->je_arg, "\"", sizeof("\"")-1);
+            json_encode_string(encoder, jv->jv_val.str, jv->jv_len);
             break;
         case JSON_VALUE_TYPE_ARRAY:
             JSON_ENCODE_ARRAY_START(encoder);
@@ -121,7 +222,7 @@ json_encode_value(struct json_encoder *encoder, struct json_value *jv)
                     goto err;
                 }
                 if (i != jv->jv_len - 1) {
-                    encoder->je_write(encoder->je_arg, ",", sizeof(",")-1);
+                    JSON_ENCODE_PUT_STR(encoder, ",");
                 }
             }
             JSON_ENCODE_ARRAY_END(encoder);
@@ -129,7 +230,7 @@ json_encode_value(struct json_encoder *encoder, struct json_value *jv)
         case JSON_VALUE_TYPE_OBJECT:
             JSON_ENCODE_OBJECT_START(encoder);
             for (i = 0; i < jv->jv_len; i++) {
-                rc = json_encode_object_entry(encoder,
+                rc = json_encode_entry(encoder,
                         jv->jv_val.composite.keys[i],
                         jv->jv_val.composite.values[i]);
                 if (rc != 0) {
@@ -152,33 +253,20 @@ err:
 int
 json_encode_object_key(struct json_encoder *encoder, char *key)
 {
-    if (encoder->je_wr_commas) {
-        encoder->je_write(encoder->je_arg, ",", sizeof(",")-1);
-        encoder->je_wr_commas = 0;
-    }
-
-    /* Write the key entry */
-    encoder->je_write(encoder->je_arg, "\"", sizeof("\"")-1);
-    encoder->je_write(encoder->je_arg, key, strlen(key));
-    encoder->je_write(encoder->je_arg, "\": ", sizeof("\": ")-1);
+    json_encode_begin(encoder);
+    json_encode_key(encoder, key);
+    json_encode_flush(encoder);
 
     return (0);
 }
 
-int
-json_encode_object_entry(struct json_encoder *encoder, char *key,
+static int
+json_encode_entry(struct json_encoder *encoder, char *key,
         struct json_value *val)
 {
     int rc;
 
-    if (encoder->je_wr_commas) {
-        encoder->je_write(encoder->je_arg, ",", sizeof(",")-1);
-        encoder->je_wr_commas = 0;
-    }
-    /* Write the key entry */
-    encoder->je_write(encoder->je_arg, "\"", sizeof("\"")-1);
-    encoder->je_write(encoder->je_arg, key, strlen(key));
-    encoder->je_write(encoder->je_arg, "\": ", sizeof("\": ")-1);
+    json_encode_key(encoder, key);
 
     rc = json_encode_value(encoder, val);
     if (rc != 0) {
@@ -191,12 +279,27 @@ err:
     return (rc);
 }
 
+int
+json_encode_object_entry(struct json_encoder *encoder, char *key,
+        struct json_value *val)
+{
+    int rc;
+
+    json_encode_begin(encoder);
+    rc = json_encode_entry(encoder, key, val);
+    json_encode_flush(encoder);
+
+    return (rc);
+}
+
 int
 json_encode_object_finish(struct json_encoder *encoder)
 {
+    json_encode_begin(encoder);
     JSON_ENCODE_OBJECT_END(encoder);
     /* Useful in case of nested objects. */
     encoder->je_wr_commas = 1;
+    json_encode_flush(encoder);
 
     return (0);
 }
@@ -210,8 +313,10 @@ json_encode_array_name(struct json_encoder *encoder, char *name)
 int
 json_encode_array_start(struct json_encoder *encoder)
 {
+    json_encode_begin(encoder);
     JSON_ENCODE_ARRAY_START(encoder);
     encoder->je_wr_commas = 0;
+    json_encode_flush(encoder);
 
     return (0);
 }
@@ -221,19 +326,15 @@ json_encode_array_value(struct json_encoder *encoder, struct json_value *jv)
 {
     int rc;
 
-    if (encoder->je_wr_commas) {
-        encoder->je_write(encoder->je_arg, ",", sizeof(",")-1);
-        encoder->je_wr_commas = 0;
-    }
+    json_encode_begin(encoder);
+    json_encode_comma(encoder);
 
     rc = json_encode_value(encoder, jv);
-    if (rc != 0) {
-        goto err;
+    if (rc == 0) {
+        encoder->je_wr_commas = 1;
     }
-    encoder->je_wr_commas = 1;
+    json_encode_flush(encoder);
 
-    return (0);
-err:
     return (rc);
 }
 
@@ -241,8 +342,10 @@ err:
 int
 json_encode_array_finish(struct json_encoder *encoder)
 {
+    json_encode_begin(encoder);
     encoder->je_wr_commas = 1;
     JSON_ENCODE_ARRAY_END(encoder);
+    json_encode_flush(encoder);
 
     return (0);
 }
@@ -0,0 +1,610 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+
+#include "json/json.h"
+
+/* Parser states. */
+#define JS_VALUE            0   /* expecting a value */
+#define JS_ARR_FIRST        1   /* after '[': value or ']' */
+#define JS_OBJ_FIRST        2   /* after '{': member name or '}' */
+#define JS_OBJ_KEY          3   /* after ',' in an object: member name */
+#define JS_KEY              4   /* in a member name */
+#define JS_COLON            5   /* after a member name */
+#define JS_STRING           6   /* in a string value */
+#define JS_TOKEN            7   /* in a number or true / false / null */
+#define JS_AFTER            8   /* after a value: ',' or end of container */
+#define JS_DONE             9   /* after the document */
+#define JS_ERROR            10
+
+/* Position within a string. */
+#define JS_STR_PLAIN        0
+#define JS_STR_ESC          1   /* after '\' */
+#define JS_STR_HEX          2   /* in the digits of a \u escape */
+
+#define JS_FNV_BASIS        2166136261UL
+#define JS_FNV_PRIME        16777619UL
+
+#define JS_UCS_REPLACEMENT  0xfffd
+
+static uint32_t
+json_stream_hash(uint32_t hash, char c)
+{
+    return (hash ^ (uint8_t)c) * JS_FNV_PRIME;
+}
+
+int
+json_stream_keys_init(struct json_stream_keys *keys,
+                      const char * const *names, int cnt,
+                      uint8_t *slots, int nslots)
+{
+    const char *cp;
+    uint32_t hash;
+    int slot;
+    int i;
+
+    if (cnt > UINT8_MAX || nslots <= cnt || (nslots & (nslots - 1)) != 0) {
+        return JSON_ERR_MISC;
+    }
+
+    memset(slots, 0, nslots);
+    for (i = 0; i < cnt; i++) {
+        hash = JS_FNV_BASIS;
+        for (cp = names[i]; *cp != '\0'; cp++) {
+            hash = json_stream_hash(hash, *cp);
+        }
+        slot = hash & (nslots - 1);
+        while (slots[slot] != 0) {
+            if (!strcmp(names[slots[slot] - 1], names[i])) {
+                return JSON_ERR_MISC;
+            }
+            slot = (slot + 1) & (nslots - 1);
+        }
+        slots[slot] = i + 1;
+    }
+
+    keys->jsk_names = names;
+    keys->jsk_slots = slots;
+    keys->jsk_nslots = nslots;
+    return 0;
+}
+
+static int
+json_stream_key_lookup(const struct json_stream *js)
+{
+    const struct json_stream_keys *keys;
+    const char *name;
+    int slot;
+
+    keys = js->js_keys;
+    if (keys == NULL) {
+        return JSON_STREAM_KEY_NONE;
+    }
+    slot = js->js_hash & (keys->jsk_nslots - 1);
+    while (keys->jsk_slots[slot] != 0) {
+        name = keys->jsk_names[keys->jsk_slots[slot] - 1];
+        if (!strncmp(name, js->js_tok, js->js_tok_len) &&
+            name[js->js_tok_len] == '\0') {
+            return keys->jsk_slots[slot] - 1;
+        }
+        slot = (slot + 1) & (keys->jsk_nslots - 1);
+    }
+    return JSON_STREAM_KEY_NONE;
+}
+
+void
+json_stream_init(struct json_stream *js,
+                 const struct json_stream_keys *keys,
+                 char *tok, uint16_t tok_size,
+                 json_stream_event_fn *cb, void *arg)
+{
+    memset(js, 0, sizeof(*js));
+    js->js_keys = keys;
+    js->js_tok = tok;
+    js->js_tok_size = tok_size;
+    js->js_cb = cb;
+    js->js_cb_arg = arg;
+    js->js_key = JSON_STREAM_KEY_NONE;
+    js->js_state = JS_VALUE;
+}
+
+static int
+json_stream_emit(struct json_stream *js, uint8_t type, int more)
+{
+    struct json_stream_event ev;
+
+    ev.jse_type = type;
+    ev.jse_depth = js->js_depth;
+    ev.jse_more = more;
+    ev.jse_key = js->js_key;
+    ev.jse_val = js->js_tok;
+    ev.jse_len = js->js_tok_len;
+
+    return js->js_cb(js, &ev, js->js_cb_arg);
+}
+
+static int
+json_stream_in_obj(const struct json_stream *js)
+{
+    return js->js_depth > 0 && (js->js_in_obj & (1UL << (js->js_depth - 1)));
+}
+
+static void
+json_stream_value_done(struct json_stream *js)
+{
+    js->js_key = JSON_STREAM_KEY_NONE;
+    js->js_state = js->js_depth == 0 ? JS_DONE : JS_AFTER;
+}
+
+static int
+json_stream_open(struct json_stream *js, int obj)
+{
+    int rc;
+
+    if (js->js_depth == JSON_STREAM_MAX_DEPTH) {
+        return JSON_ERR_TOODEEP;
+    }
+    rc = json_stream_emit(js, obj ? JSON_STREAM_EV_OBJ_START :
+                                    JSON_STREAM_EV_ARR_START, 0);
+    if (rc != 0) {
+        return rc;
+    }
+    if (obj) {
+        js->js_in_obj |= 1UL << js->js_depth;
+        js->js_state = JS_OBJ_FIRST;
+    } else {
+        js->js_in_obj &= ~(1UL << js->js_depth);
+        js->js_state = JS_ARR_FIRST;
+    }
+    js->js_depth++;
+    js->js_key = JSON_STREAM_KEY_NONE;
+    return 0;
+}
+
+static int
+json_stream_close(struct json_stream *js, char c)
+{
+    int obj;
+    int rc;
+
+    obj = json_stream_in_obj(js);
+    if (c != (obj ? '}' : ']')) {
+        return JSON_ERR_BADTRAIL;
+    }
+    js->js_depth--;
+    js->js_key = JSON_STREAM_KEY_NONE;
+    js->js_tok_len = 0;
+    rc = json_stream_emit(js, obj ? JSON_STREAM_EV_OBJ_END :
+                                    JSON_STREAM_EV_ARR_END, 0);
+    if (rc != 0) {
+        return rc;
+    }
+    json_stream_value_done(js);
+    return 0;
+}
+
+/*
+ * Appends a byte to the token.  A string value too long for the buffer is
+ * passed on in pieces; anything else has to fit.
+ */
+static int
+json_stream_putc(struct json_stream *js, char c)
+{
+    int rc;
+
+    if (js->js_tok_len == js->js_tok_size) {
+        if (js->js_state == JS_KEY) {
+            return JSON_ERR_ATTRLEN;
+        }
+        rc = json_stream_emit(js, JSON_STREAM_EV_STRING, 1);
+        if (rc != 0) {
+            return rc;
+        }
+        js->js_tok_len = 0;
+    }
+    if (js->js_state == JS_KEY) {
+        js->js_hash = json_stream_hash(js->js_hash, c);
+    }
+    js->js_tok[js->js_tok_len++] = c;
+    return 0;
+}
+
+static int
+json_stream_put_ucs(struct json_stream *js, uint32_t ucs)
+{
+    char buf[4];
+    int cnt;
+    int rc;
+    int i;
+
+    if (ucs < 0x80) {
+        buf[0] = ucs;
+        cnt = 1;
+    } else if (ucs < 0x800) {
+        buf[0] = 0xc0 | (ucs >> 6);
+        buf[1] = 0x80 | (ucs & 0x3f);
+        cnt = 2;
+    } else if (ucs < 0x10000) {
+        buf[0] = 0xe0 | (ucs >> 12);
+        buf[1] = 0x80 | ((ucs >> 6) & 0x3f);
+        buf[2] = 0x80 | (ucs & 0x3f);
+        cnt = 3;
+    } else {
+        buf[0] = 0xf0 | (ucs >> 18);
+        buf[1] = 0x80 | ((ucs >> 12) & 0x3f);
+        buf[2] = 0x80 | ((ucs >> 6) & 0x3f);
+        buf[3] = 0x80 | (ucs & 0x3f);
+        cnt = 4;
+    }
+
+    for (i = 0; i < cnt; i++) {
+        rc = json_stream_putc(js, buf[i]);
+        if (rc != 0) {
+            return rc;
+        }
+    }
+    return 0;
+}
+
+/*
+ * js_uesc holds the \u escape being read in its low half, and a high
+ * surrogate waiting for its pair in the upper half.  Unpaired surrogates
+ * become U+FFFD.
+ */
+static int
+json_stream_flush_surrogate(struct json_stream *js)
+{
+    if (js->js_uesc >> 16) {
+        js->js_uesc = 0;
+        return json_stream_put_ucs(js, JS_UCS_REPLACEMENT);
+    }
+    return 0;
+}
+
+static int
+json_stream_uesc_done(struct json_stream *js)
+{
+    uint32_t high;
+    uint32_t cp;
+    int rc;
+
+    high = js->js_uesc >> 16;
+    cp = js->js_uesc & 0xffff;
+    js->js_uesc = 0;
+
+    if (cp >= 0xd800 && cp < 0xdc00) {
+        if (high) {
+            rc = json_stream_put_ucs(js, JS_UCS_REPLACEMENT);
+            if (rc != 0) {
+                return rc;
+            }
+        }
+        js->js_uesc = cp << 16;
+        return 0;
+    }
+    if (cp >= 0xdc00 && cp < 0xe000) {
+        if (!high) {
+            return json_stream_put_ucs(js, JS_UCS_REPLACEMENT);
+        }
+        cp = 0x10000 + ((high - 0xd800) << 10) + (cp - 0xdc00);
+    } else if (high) {
+        rc = json_stream_put_ucs(js, JS_UCS_REPLACEMENT);
+        if (rc != 0) {
+            return rc;
+        }
+    }
+    return json_stream_put_ucs(js, cp);
+}
+
+static int
+json_stream_str_end(struct json_stream *js)
+{
+    int rc;
+
+    if (js->js_state == JS_KEY) {
+        js->js_key = json_stream_key_lookup(js);
+        js->js_state = JS_COLON;
+        return 0;
+    }
+    rc = json_stream_emit(js, JSON_STREAM_EV_STRING, 0);
+    if (rc != 0) {
+        return rc;
+    }
+    json_stream_value_done(js);
+    return 0;
+}
+
+static int
+json_stream_str_char(struct json_stream *js, char c)
+{
+    int rc;
+
+    switch (js->js_str_state) {
+    case JS_STR_ESC:
+        js->js_str_state = JS_STR_PLAIN;
+        if (c == 'u') {
+            js->js_str_state = JS_STR_HEX;
+            js->js_nhex = 0;
+            return 0;
+        }
+        rc = json_stream_flush_surrogate(js);
+        if (rc != 0) {
+            return rc;
+        }
+        switch (c) {
+        case 'b':
+            c = '\b';
+            break;
+        case 'f':
+            c = '\f';
+            break;
+        case 'n':
+            c = '\n';
+            break;
+        case 'r':
+            c = '\r';
+            break;
+        case 't':
+            c = '\t';
+            break;
+        case '"':
+        case '\\':
+        case '/':
+            break;
+        default:
+            return JSON_ERR_BADSTRING;
+        }
+        return json_stream_putc(js, c);
+
+    case JS_STR_HEX:
+        if (c >= '0' && c <= '9') {
+            c -= '0';
+        } else if (c >= 'a' && c <= 'f') {
+            c -= 'a' - 10;
+        } else if (c >= 'A' && c <= 'F') {
+            c -= 'A' - 10;
+        } else {
+            return JSON_ERR_BADSTRING;
+        }
+        js->js_uesc = (js->js_uesc & 0xffff0000UL) |
+                      ((js->js_uesc << 4) & 0xffff) | c;
+        if (++js->js_nhex < 4) {
+            return 0;
+        }
+        js->js_str_state = JS_STR_PLAIN;
+        return json_stream_uesc_done(js);
+
+    default:
+        if (c == '\\') {
+            js->js_str_state = JS_STR_ESC;
+            return 0;
+        }
+        rc = json_stream_flush_surrogate(js);
+        if (rc != 0) {
+            return rc;
+        }
+        if (c == '"') {
+            return json_stream_str_end(js);
+        }
+        if ((uint8_t)c < 0x20) {
+            return JSON_ERR_BADSTRING;
+        }
+        return json_stream_putc(js, c);
+    }
+}
+
+static int
+json_stream_is_token_char(char c)
+{
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') ||
+           (c >= 'A' && c <= 'Z') || c == '-' || c == '+' || c == '.';
+}
+
+static int
+json_stream_token_is(const struct json_stream *js, const char *lit)
+{
+    return !strncmp(js->js_tok, lit, js->js_tok_len) &&
+           lit[js->js_tok_len] == '\0';
+}
+
+static int
+json_stream_token_end(struct json_stream *js)
+{
+    uint8_t type;
+    char c;
+    int i;
+    int rc;
+
+    if (json_stream_token_is(js, "true")) {
+        type = JSON_STREAM_EV_TRUE;
+    } else if (json_stream_token_is(js, "false")) {
+        type = JSON_STREAM_EV_FALSE;
+    } else if (json_stream_token_is(js, "null")) {
+        type = JSON_STREAM_EV_NULL;
+    } else {
+        /* Only the character set is checked; the receiver converts it. */
+        c = js->js_tok[0];
+        if (c != '-' && (c < '0' || c > '9')) {
+            return JSON_ERR_BADNUM;
+        }
+        for (i = 1; i < js->js_tok_len; i++) {
+            c = js->js_tok[i];
+            if ((c < '0' || c > '9') && c != '.' && c != 'e' && c != 'E' &&
+                c != '+' && c != '-') {
+                return JSON_ERR_BADNUM;
+            }
+        }
+        type = JSON_STREAM_EV_NUMBER;
+    }
+
+    rc = json_stream_emit(js, type, 0);
+    if (rc != 0) {
+        return rc;
+    }
+    json_stream_value_done(js);
+    return 0;
+}
+
+static int
+json_stream_is_ws(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static int
+json_stream_value_start(struct json_stream *js, char c)
+{
+    js->js_tok_len = 0;
+    switch (c) {
+    case '{':
+        return json_stream_open(js, 1);
+    case '[':
+        return json_stream_open(js, 0);
+    case '"':
+        js->js_state = JS_STRING;
+        js->js_str_state = JS_STR_PLAIN;
+        js->js_uesc = 0;
+        return 0;
+    default:
+        if (!json_stream_is_token_char(c)) {
+            return JSON_ERR_MISC;
+        }
+        js->js_state = JS_TOKEN;
+        if (js->js_tok_size == 0) {
+            return JSON_ERR_TOKLONG;
+        }
+        js->js_tok[js->js_tok_len++] = c;
+        return 0;
+    }
+}
+
+static int
+json_stream_char(struct json_stream *js, char c)
+{
+    int rc;
+
+    switch (js->js_state) {
+    case JS_KEY:
+    case JS_STRING:
+        return json_stream_str_char(js, c);
+
+    case JS_TOKEN:
+        if (json_stream_is_token_char(c)) {
+            if (js->js_tok_len == js->js_tok_size) {
+                return JSON_ERR_TOKLONG;
+            }
+            js->js_tok[js->js_tok_len++] = c;
+            return 0;
+        }
+        rc = json_stream_token_end(js);
+        if (rc != 0) {
+            return rc;
+        }
+        /* The delimiter belongs to what follows. */
+        return json_stream_char(js, c);
+
+    default:
+        break;
+    }
+
+    if (json_stream_is_ws(c)) {
+        return 0;
+    }
+
+    switch (js->js_state) {
+    case JS_ARR_FIRST:
+        if (c == ']') {
+            return json_stream_close(js, c);
+        }
+        /* fall through */
+    case JS_VALUE:
+        return json_stream_value_start(js, c);
+
+    case JS_OBJ_FIRST:
+        if (c == '}') {
+            return json_stream_close(js, c);
+        }
+        /* fall through */
+    case JS_OBJ_KEY:
+        if (c != '"') {
+            return JSON_ERR_ATTRSTART;
+        }
+        js->js_state = JS_KEY;
+        js->js_str_state = JS_STR_PLAIN;
+        js->js_uesc = 0;
+        js->js_tok_len = 0;
+        js->js_hash = JS_FNV_BASIS;
+        return 0;
+
+    case JS_COLON:
+        if (c != ':') {
+            return JSON_ERR_BADTRAIL;
+        }
+        js->js_state = JS_VALUE;
+        return 0;
+
+    case JS_AFTER:
+        if (c == ',') {
+            js->js_state = json_stream_in_obj(js) ? JS_OBJ_KEY : JS_VALUE;
+            return 0;
+        }
+        return json_stream_close(js, c);
+
+    default:
+        return JSON_ERR_BADTRAIL;
+    }
+}
+
+int
+json_stream_feed(struct json_stream *js, const char *data, int len)
+{
+    int rc;
+    int i;
+
+    if (js->js_state == JS_ERROR) {
+        return JSON_ERR_MISC;
+    }
+    for (i = 0; i < len; i++) {
+        rc = json_stream_char(js, data[i]);
+        if (rc != 0) {
+            js->js_state = JS_ERROR;
+            return rc;
+        }
+    }
+    return 0;
+}
+
+int
+json_stream_finish(struct json_stream *js)
+{
+    int rc;
+
+    if (js->js_state == JS_TOKEN && js->js_depth == 0) {
+        rc = json_stream_token_end(js);
+        if (rc != 0) {
+            js->js_state = JS_ERROR;
+            return rc;
+        }
+    }
+    if (js->js_state != JS_DONE) {
+        return JSON_ERR_INCOMPLETE;
+    }
+    return 0;
+}
@@ -222,6 +222,11 @@ CBOR_API CborError cbor_encoder_close_container_checked(CborEncoder *encoder, co
 
 /* Parser API */
 
+enum CborParserGlobalFlags
+{
+    CborParserFlag_ValidateUtf8             = 0x01  /* reject bad text strings */
+};
+
 enum CborParserIteratorFlags
 {
     CborIteratorFlag_IntegerValueTooLarge   = 0x01,
@@ -238,6 +243,9 @@ typedef uint32_t (cbor_reader_get32)(struct cbor_decoder_reader *d, int offset);
 typedef uint64_t (cbor_reader_get64)(struct cbor_decoder_reader *d, int offset);
 typedef uintptr_t (cbor_memcmp)(struct cbor_decoder_reader *d, char *buf, int offset, size_t len);
 typedef uintptr_t (cbor_memcpy)(struct cbor_decoder_reader *d, char *buf, int offset, size_t len);
+/* Returns the bytes at offset that are contiguous in memory, and their count
+ * in *len; NULL if there is no direct access to them. */
+typedef const uint8_t *(cbor_reader_span)(struct cbor_decoder_reader *d, int offset, size_t *len);
 
 struct cbor_decoder_reader {
     cbor_reader_get8  *get8;
@@ -246,6 +254,7 @@ struct cbor_decoder_reader {
     cbor_reader_get64 *get64;
     cbor_memcmp       *cmp;
     cbor_memcpy       *cpy;
+    cbor_reader_span  *span;        /* optional, may be NULL */
     size_t             message_size;
 };
 
@@ -425,7 +434,43 @@ CBOR_INLINE_API CborError cbor_value_dup_byte_string(const CborValue *value, uin
     return _cbor_value_dup_string(value, (void **)buffer, buflen, next);
 }
 
-/* ### TBD: partial reading API */
+CBOR_PRIVATE_API CborError _cbor_value_get_string_span(const CborValue *value, const void **data,
+                                                       size_t *len, CborValue *next);
+
+CBOR_INLINE_API CborError cbor_value_get_text_string_span(const CborValue *value, const char **data,
+                                                          size_t *len, CborValue *next)
+{
+    assert(cbor_value_is_text_string(value));
+    return _cbor_value_get_string_span(value, (const void **)data, len, next);
+}
+CBOR_INLINE_API CborError cbor_value_get_byte_string_span(const CborValue *value, const uint8_t **data,
+                                                          size_t *len, CborValue *next)
+{
+    assert(cbor_value_is_byte_string(value));
+    return _cbor_value_get_string_span(value, (const void **)data, len, next);
+}
+
+/* Partial reading API */
+typedef CborError (*CborStringChunkFunction)(void *arg, const void *data, size_t len);
+
+CBOR_PRIVATE_API CborError _cbor_value_stream_string(const CborValue *value, void *buffer,
+                                                    size_t buflen, CborStringChunkFunction func,
+                                                    void *arg, CborValue *next);
+
+CBOR_INLINE_API CborError cbor_value_stream_text_string(const CborValue *value, char *buffer,
+                                                        size_t buflen, CborStringChunkFunction func,
+                                                        void *arg, CborValue *next)
+{
+    assert(cbor_value_is_text_string(value));
+    return _cbor_value_stream_string(value, buffer, buflen, func, arg, next);
+}
+CBOR_INLINE_API CborError cbor_value_stream_byte_string(const CborValue *value, uint8_t *buffer,
+                                                        size_t buflen, CborStringChunkFunction func,
+                                                        void *arg, CborValue *next)
+{
+    assert(cbor_value_is_byte_string(value));
+    return _cbor_value_stream_string(value, buffer, buflen, func, arg, next);
+}
 
 CBOR_API CborError cbor_value_text_string_equals(const CborValue *value, const char *string, bool *result);
 
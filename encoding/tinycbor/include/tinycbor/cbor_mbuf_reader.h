@@ -31,6 +31,7 @@ struct cbor_mbuf_reader {
     struct cbor_decoder_reader r;
     int init_off;                     /* initial offset into the data */
     struct os_mbuf *m;
+    struct os_mbuf_cursor cursor;     /* position of the last access */
 };
 
 void cbor_mbuf_reader_init(struct cbor_mbuf_reader *cb, struct os_mbuf *m,
@@ -66,6 +66,15 @@ cbor_buf_reader_cpy(struct cbor_decoder_reader *d, char *dst, int src_offset,
     return (uintptr_t) memcpy(dst, cb->buffer + src_offset, len);
 }
 
+static const uint8_t *
+cbor_buf_reader_span(struct cbor_decoder_reader *d, int offset, size_t *len)
+{
+    struct cbor_buf_reader *cb = (struct cbor_buf_reader *) d;
+
+    *len = cb->r.message_size - offset;
+    return cb->buffer + offset;
+}
+
 void
 cbor_buf_reader_init(struct cbor_buf_reader *cb, const uint8_t *buffer,
                      size_t data)
@@ -77,5 +86,6 @@ cbor_buf_reader_init(struct cbor_buf_reader *cb, const uint8_t *buffer,
     cb->r.get64 = &cbuf_buf_reader_get64;
     cb->r.cmp = &cbor_buf_reader_cmp;
     cb->r.cpy = &cbor_buf_reader_cpy;
+    cb->r.span = &cbor_buf_reader_span;
     cb->r.message_size = data;
 }
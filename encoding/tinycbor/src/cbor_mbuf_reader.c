@@ -21,13 +21,36 @@
 #include <tinycbor/cbor_mbuf_reader.h>
 #include <tinycbor/compilersupport_p.h>
 
+/*
+ * The decoder reads mostly at increasing offsets, so each access resumes from
+ * the mbuf of the previous one instead of walking the chain from its head.
+ */
+static int
+cbor_mbuf_reader_seek(struct cbor_mbuf_reader *cb, int offset)
+{
+    return os_mbuf_cursor_seek(&cb->cursor, offset + cb->init_off);
+}
+
+static int
+cbor_mbuf_reader_copy(struct cbor_mbuf_reader *cb, int offset, void *dst,
+                      size_t len)
+{
+    int rc;
+
+    rc = cbor_mbuf_reader_seek(cb, offset);
+    if (rc != 0) {
+        return rc;
+    }
+    return os_mbuf_cursor_peek(&cb->cursor, dst, len);
+}
+
 static uint8_t
 cbor_mbuf_reader_get8(struct cbor_decoder_reader *d, int offset)
 {
     uint8_t val;
     struct cbor_mbuf_reader *cb = (struct cbor_mbuf_reader *) d;
 
-    os_mbuf_copydata(cb->m, offset + cb->init_off, sizeof(val), &val);
+    cbor_mbuf_reader_copy(cb, offset, &val, sizeof(val));
     return val;
 }
 
@@ -37,7 +60,7 @@ cbor_mbuf_reader_get16(struct cbor_decoder_reader *d, int offset)
     uint16_t val;
     struct cbor_mbuf_reader *cb = (struct cbor_mbuf_reader *) d;
 
-    os_mbuf_copydata(cb->m, offset + cb->init_off, sizeof(val), &val);
+    cbor_mbuf_reader_copy(cb, offset, &val, sizeof(val));
     return cbor_ntohs(val);
 }
 
@@ -47,7 +70,7 @@ cbor_mbuf_reader_get32(struct cbor_decoder_reader *d, int offset)
     uint32_t val;
     struct cbor_mbuf_reader *cb = (struct cbor_mbuf_reader *) d;
 
-    os_mbuf_copydata(cb->m, offset + cb->init_off, sizeof(val), &val);
+    cbor_mbuf_reader_copy(cb, offset, &val, sizeof(val));
     return cbor_ntohl(val);
 }
 
@@ -57,7 +80,7 @@ cbor_mbuf_reader_get64(struct cbor_decoder_reader *d, int offset)
     uint64_t val;
     struct cbor_mbuf_reader *cb = (struct cbor_mbuf_reader *) d;
 
-    os_mbuf_copydata(cb->m, offset + cb->init_off, sizeof(val), &val);
+    cbor_mbuf_reader_copy(cb, offset, &val, sizeof(val));
     return cbor_ntohll(val);
 }
 
@@ -66,7 +89,11 @@ cbor_mbuf_reader_cmp(struct cbor_decoder_reader *d, char *buf, int offset,
                      size_t len)
 {
     struct cbor_mbuf_reader *cb = (struct cbor_mbuf_reader *) d;
-    return os_mbuf_cmpf(cb->m, offset + cb->init_off, buf, len) == 0;
+
+    if (cbor_mbuf_reader_seek(cb, offset) != 0) {
+        return false;
+    }
+    return os_mbuf_cursor_cmp(&cb->cursor, buf, len) == 0;
 }
 
 static uintptr_t
@@ -76,13 +103,28 @@ cbor_mbuf_reader_cpy(struct cbor_decoder_reader *d, char *dst, int offset,
     int rc;
     struct cbor_mbuf_reader *cb = (struct cbor_mbuf_reader *) d;
 
-    rc = os_mbuf_copydata(cb->m, offset + cb->init_off, len, dst);
+    rc = cbor_mbuf_reader_copy(cb, offset, dst, len);
     if (rc == 0) {
         return true;
     }
     return false;
 }
 
+static const uint8_t *
+cbor_mbuf_reader_span(struct cbor_decoder_reader *d, int offset, size_t *len)
+{
+    const uint8_t *data;
+    uint16_t span_len;
+    struct cbor_mbuf_reader *cb = (struct cbor_mbuf_reader *) d;
+
+    if (cbor_mbuf_reader_seek(cb, offset) != 0) {
+        return NULL;
+    }
+    data = os_mbuf_cursor_span(&cb->cursor, &span_len);
+    *len = data != NULL ? span_len : 0;
+    return data;
+}
+
 void
 cbor_mbuf_reader_init(struct cbor_mbuf_reader *cb, struct os_mbuf *m,
                       int initial_offset)
@@ -95,10 +137,12 @@ cbor_mbuf_reader_init(struct cbor_mbuf_reader *cb, struct os_mbuf *m,
     cb->r.get64 = &cbor_mbuf_reader_get64;
     cb->r.cmp = &cbor_mbuf_reader_cmp;
     cb->r.cpy = &cbor_mbuf_reader_cpy;
+    cb->r.span = &cbor_mbuf_reader_span;
 
     assert(OS_MBUF_IS_PKTHDR(m));
     hdr = OS_MBUF_PKTHDR(m);
     cb->m = m;
     cb->init_off = initial_offset;
     cb->r.message_size = hdr->omp_len - initial_offset;
+    os_mbuf_cursor_init(&cb->cursor, m);
 }
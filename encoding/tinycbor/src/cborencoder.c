@@ -381,6 +381,17 @@ CborError cbor_encode_tag(CborEncoder *encoder, CborTag tag)
 
 static CborError encode_string(CborEncoder *encoder, size_t length, uint8_t shiftedMajorType, const void *string)
 {
+    uint8_t buf[1 + Value8Bit];
+
+    /* Short strings, map keys mostly, go to the writer together with their
+     * one-byte header in a single call. */
+    if (length < Value8Bit) {
+        ++encoder->added;
+        buf[0] = shiftedMajorType + (uint8_t)length;
+        memcpy(buf + 1, string, length);
+        return append_to_buffer(encoder, buf, length + 1);
+    }
+
     CborError err = encode_number(encoder, length, shiftedMajorType);
     if (err && !isOomError(err))
         return err;
@@ -903,6 +903,70 @@ CborError cbor_value_calculate_string_length(const CborValue *value, size_t *len
     return _cbor_value_copy_string(value, NULL, len, NULL);
 }
 
+/* Runs of ASCII, the common case, are checked a word at a time; anything
+ * else is decoded to reject overlong forms, surrogates and values past
+ * U+10FFFF. */
+static bool utf8_is_valid(const uint8_t *p, size_t n)
+{
+    const uintptr_t high_bits = (uintptr_t)-1 / 0xff * 0x80;
+    const uint8_t *end = p + n;
+    uintptr_t w;
+    uint32_t uc;
+    uint32_t min_uc;
+    size_t more;
+
+    while (p < end) {
+        if (((uintptr_t)p & (sizeof(w) - 1)) == 0) {
+            while ((size_t)(end - p) >= sizeof(w)) {
+                memcpy(&w, p, sizeof(w));
+                if (w & high_bits)
+                    break;
+                p += sizeof(w);
+            }
+            if (p == end)
+                break;
+        }
+
+        uc = *p++;
+        if (uc < 0x80)
+            continue;
+        if (uc < 0xc2) {
+            return false;
+        } else if (uc < 0xe0) {
+            more = 1;
+            min_uc = 0x80;
+            uc &= 0x1f;
+        } else if (uc < 0xf0) {
+            more = 2;
+            min_uc = 0x800;
+            uc &= 0x0f;
+        } else if (uc < 0xf5) {
+            more = 3;
+            min_uc = 0x10000;
+            uc &= 0x07;
+        } else {
+            return false;
+        }
+
+        if ((size_t)(end - p) < more)
+            return false;
+        while (more--) {
+            if ((*p & 0xc0) != 0x80)
+                return false;
+            uc = (uc << 6) | (*p++ & 0x3f);
+        }
+        if (uc < min_uc || uc > 0x10ffff || (uc >= 0xd800 && uc <= 0xdfff))
+            return false;
+    }
+    return true;
+}
+
+static bool must_validate_utf8(const CborValue *value)
+{
+    return value->type == CborTextStringType &&
+           (value->parser->flags & CborParserFlag_ValidateUtf8);
+}
+
 /* We return uintptr_t so that we can pass memcpy directly as the iteration
  * function. The choice is to optimize for memcpy, which is used in the base
  * parser API (cbor_value_copy_string), while memcmp is used in convenience API
@@ -1031,7 +1095,7 @@ static CborError iterate_string_chunks(const CborValue *value, char *buffer, siz
  * number of chunks). It requires constant memory (O(1)).
  *
  * \note This function does not perform UTF-8 validation on the incoming text
- * string.
+ * string unless the parser was initialized with \ref CborParserFlag_ValidateUtf8.
  *
  * \sa cbor_value_dup_text_string(), cbor_value_copy_byte_string(), cbor_value_get_string_length(), cbor_value_calculate_string_length()
  */
@@ -1073,8 +1137,198 @@ CborError _cbor_value_copy_string(const CborValue *value, void *buffer,
     bool copied_all;
     CborError err = iterate_string_chunks(value, (char*)buffer, buflen, &copied_all, next,
                                           buffer ? (IterateFunction) value->parser->d->cpy : iterate_noop);
-    return err ? err :
-                 copied_all ? CborNoError : CborErrorOutOfMemory;
+    if (err)
+        return err;
+    if (!copied_all)
+        return CborErrorOutOfMemory;
+    if (buffer && must_validate_utf8(value) && !utf8_is_valid(buffer, *buflen))
+        return CborErrorInvalidUtf8TextString;
+    return CborNoError;
+}
+
+/**
+ * \fn CborError cbor_value_get_byte_string_span(const CborValue *value, const uint8_t **data, size_t *len, CborValue *next)
+ *
+ * Gives direct access to the contents of the definite-length byte string
+ * pointed by \a value, without copying them. The length of the string is
+ * stored in \c{*len}. If the reader holds the whole string in contiguous
+ * memory, \c{*data} points at it; otherwise \c{*data} is set to NULL and the
+ * caller falls back to cbor_value_copy_byte_string().
+ *
+ * Strings of indeterminate length are not supported: this function returns
+ * \ref CborErrorUnknownLength for them.
+ *
+ * The pointer stays valid for as long as the data being parsed does. The \a
+ * next pointer, if not null, is updated to point to the next item after this
+ * string.
+ *
+ * \sa cbor_value_get_text_string_span(), cbor_value_copy_byte_string()
+ */
+
+/**
+ * \fn CborError cbor_value_get_text_string_span(const CborValue *value, const char **data, size_t *len, CborValue *next)
+ *
+ * Same as cbor_value_get_byte_string_span(), for text strings. The string is
+ * not null-terminated. If the parser was initialized with
+ * \ref CborParserFlag_ValidateUtf8, a string handed out this way is checked
+ * first, and \ref CborErrorInvalidUtf8TextString returned if it is not valid.
+ *
+ * \sa cbor_value_get_byte_string_span(), cbor_value_copy_text_string()
+ */
+
+CborError _cbor_value_get_string_span(const CborValue *value, const void **data,
+                                      size_t *len, CborValue *next)
+{
+    struct cbor_decoder_reader *d = value->parser->d;
+    const uint8_t *span;
+    size_t total;
+    size_t avail;
+    CborError err;
+    int offset = value->offset;
+
+    assert(cbor_value_is_byte_string(value) || cbor_value_is_text_string(value));
+
+    if (!cbor_value_is_length_known(value))
+        return CborErrorUnknownLength;
+    err = extract_length(value->parser, &offset, &total);
+    if (err)
+        return err;
+    if (total > (size_t)(value->parser->end - offset))
+        return CborErrorUnexpectedEOF;
+
+    *data = NULL;
+    if (d->span) {
+        span = d->span(d, offset, &avail);
+        if (span && avail >= total) {
+            if (must_validate_utf8(value) && !utf8_is_valid(span, total))
+                return CborErrorInvalidUtf8TextString;
+            *data = span;
+        }
+    }
+    *len = total;
+
+    if (next) {
+        *next = *value;
+        next->offset = offset + total;
+        return preparse_next_value(next);
+    }
+    return CborNoError;
+}
+
+/**
+ * \fn CborError cbor_value_stream_text_string(const CborValue *value, char *buffer, size_t buflen, CborStringChunkFunction func, void *arg, CborValue *next)
+ *
+ * Hands the contents of the text string pointed by \a value to \a func,
+ * piece by piece, without needing memory for the whole string. Where the
+ * reader holds a piece contiguously in memory, \a func gets a pointer into
+ * it; otherwise the piece is copied through \a buffer, \a buflen bytes at a
+ * time. Strings of indeterminate length are handled chunk by chunk.
+ *
+ * If \a func returns an error, streaming stops and that error is returned.
+ * The pieces are not null-terminated and, since a piece may end in the middle
+ * of a UTF-8 sequence, are not validated.
+ *
+ * The \a next pointer, if not null, is updated to point to the next item
+ * after this string.
+ *
+ * \sa cbor_value_stream_byte_string(), cbor_value_copy_text_string()
+ */
+
+/**
+ * \fn CborError cbor_value_stream_byte_string(const CborValue *value, uint8_t *buffer, size_t buflen, CborStringChunkFunction func, void *arg, CborValue *next)
+ *
+ * Same as cbor_value_stream_text_string(), for byte strings.
+ *
+ * \sa cbor_value_stream_text_string(), cbor_value_copy_byte_string()
+ */
+
+static CborError stream_string_piece(const CborValue *value, int offset, size_t len,
+                                     char *buffer, size_t buflen,
+                                     CborStringChunkFunction func, void *arg)
+{
+    struct cbor_decoder_reader *d = value->parser->d;
+    const uint8_t *span;
+    size_t avail;
+    size_t n;
+    CborError err;
+
+    if (len > (size_t)(value->parser->end - offset))
+        return CborErrorUnexpectedEOF;
+    if (len == 0)
+        return CborNoError;
+
+    if (d->span) {
+        span = d->span(d, offset, &avail);
+        if (span && avail >= len)
+            return func(arg, span, len);
+    }
+
+    while (len) {
+        n = len < buflen ? len : buflen;
+        d->cpy(d, buffer, offset, n);
+        err = func(arg, buffer, n);
+        if (err)
+            return err;
+        offset += n;
+        len -= n;
+    }
+    return CborNoError;
+}
+
+CborError _cbor_value_stream_string(const CborValue *value, void *buffer,
+                                    size_t buflen, CborStringChunkFunction func,
+                                    void *arg, CborValue *next)
+{
+    size_t len;
+    CborError err;
+    int offset = value->offset;
+
+    assert(cbor_value_is_byte_string(value) || cbor_value_is_text_string(value));
+    assert(buffer && buflen);
+
+    if (cbor_value_is_length_known(value)) {
+        err = extract_length(value->parser, &offset, &len);
+        if (err)
+            return err;
+        err = stream_string_piece(value, offset, len, (char *)buffer, buflen, func, arg);
+        if (err)
+            return err;
+        offset += len;
+    } else {
+        /* chunked */
+        ++offset;
+        while (true) {
+            uint8_t val;
+
+            if (offset == value->parser->end)
+                return CborErrorUnexpectedEOF;
+
+            val = value->parser->d->get8(value->parser->d, offset);
+            if (val == (uint8_t)BreakByte) {
+                ++offset;
+                break;
+            }
+
+            /* is this the right type? */
+            if ((val & MajorTypeMask) != value->type)
+                return CborErrorIllegalType;
+
+            err = extract_length(value->parser, &offset, &len);
+            if (err)
+                return err;
+            err = stream_string_piece(value, offset, len, (char *)buffer, buflen, func, arg);
+            if (err)
+                return err;
+            offset += len;
+        }
+    }
+
+    if (next) {
+        *next = *value;
+        next->offset = offset;
+        return preparse_next_value(next);
+    }
+    return CborNoError;
 }
 
 /**
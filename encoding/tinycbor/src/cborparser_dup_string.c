@@ -57,7 +57,7 @@
  * malloc'ed block.
  *
  * \note This function does not perform UTF-8 validation on the incoming text
- * string.
+ * string unless the parser was initialized with \ref CborParserFlag_ValidateUtf8.
  *
  * \sa cbor_value_copy_text_string(), cbor_value_dup_byte_string()
  */
@@ -49,6 +49,26 @@ char *disk_fs_for(const char *disk_name);
 char *disk_name_from_path(const char *path);
 char *disk_filepath_from_path(const char *path);
 
+/**
+ * Returns the length of the disk prefix of a path ("disk0:" in
+ * "disk0:/dir/file"), including the colon, or 0 if it has none.
+ */
+size_t disk_prefix_len(const char *path);
+
+/**
+ * Returns the path with the disk prefix skipped.  Unlike
+ * disk_filepath_from_path() this points into the given path and allocates
+ * nothing.
+ */
+const char *disk_path_strip(const char *path);
+
+/**
+ * Returns the name of the file system on the disk that a path's prefix
+ * names, or NULL if it has no prefix or names no registered disk.  The
+ * result is the name given to disk_register(), and stays valid.
+ */
+const char *disk_fs_for_path(const char *path);
+
 #ifdef __cplusplus
 }
 #endif
@@ -26,6 +26,8 @@ struct disk_info {
     const char *disk_name;
     const char *fs_name;
     struct disk_ops *dops;
+    /* Length of disk_name, so lookups by path prefix skip most names */
+    uint8_t disk_name_len;
 
     SLIST_ENTRY(disk_info) sc_next;
 };
@@ -52,6 +54,7 @@ int disk_register(const char *disk_name, const char *fs_name, struct disk_ops *d
     }
 
     info->disk_name = disk_name;
+    info->disk_name_len = strlen(disk_name);
     info->fs_name = fs_name;
     info->dops = dops;
 
@@ -60,6 +63,61 @@ int disk_register(const char *disk_name, const char *fs_name, struct disk_ops *d
     return 0;
 }
 
+size_t
+disk_prefix_len(const char *path)
+{
+    const char *colon;
+
+    colon = strchr(path, ':');
+    if (colon == NULL) {
+        return 0;
+    }
+
+    return colon - path + 1;
+}
+
+const char *
+disk_path_strip(const char *path)
+{
+    return path + disk_prefix_len(path);
+}
+
+/* Finds the disk a path's prefix names, without copying the name out. */
+static struct disk_info *
+disk_info_for_path(const char *path)
+{
+    struct disk_info *sc;
+    size_t len;
+
+    len = disk_prefix_len(path);
+    if (len == 0) {
+        return NULL;
+    }
+    len--;
+
+    SLIST_FOREACH(sc, &disks, sc_next) {
+        if (sc->disk_name_len == len &&
+            memcmp(sc->disk_name, path, len) == 0) {
+            return sc;
+        }
+    }
+
+    return NULL;
+}
+
+const char *
+disk_fs_for_path(const char *path)
+{
+    struct disk_info *sc;
+
+    sc = disk_info_for_path(path);
+    if (sc == NULL) {
+        return NULL;
+    }
+
+    return sc->fs_name;
+}
+
 struct disk_ops *
 disk_ops_for(const char *disk_name)
 {
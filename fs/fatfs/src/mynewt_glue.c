@@ -38,6 +38,8 @@ static int fatfs_close(struct fs_file *fs_file);
 static int fatfs_read(struct fs_file *fs_file, uint32_t len, void *out_data,
   uint32_t *out_len);
 static int fatfs_write(struct fs_file *fs_file, const void *data, int len);
+static int fatfs_readv(struct fs_file *fs_file, const struct fs_iovec *iov,
+  int iovcnt, uint32_t *out_len);
 static int fatfs_seek(struct fs_file *fs_file, uint32_t offset);
 static uint32_t fatfs_getpos(const struct fs_file *fs_file);
 static int fatfs_file_len(const struct fs_file *fs_file, uint32_t *out_len);
@@ -53,9 +55,25 @@ static int fatfs_dirent_is_dir(const struct fs_dirent *fs_dirent);
 
 #define DRIVE_LEN 4
 
+/* NOTE: safe to assume sector size as 512 for now, see ffconf.h */
+#define FATFS_SECTOR_SIZE 512
+
 struct fatfs_file {
     struct fs_ops *fops;
     FIL *file;
+#if MYNEWT_VAL(FATFS_FILE_BUF_SIZE)
+    /*
+     * Small writes are collected here and passed to f_write() at most one
+     * buffer at a time, ending on a multiple of the buffer size in the
+     * file.  The buffer divides the cluster size, so FatFs can write it
+     * straight from here to the disk, and a run of small appends costs one
+     * multi-sector write instead of a write per sector.
+     */
+    uint8_t *buf;
+    uint16_t buf_size;
+    uint16_t buf_len;
+    uint16_t buf_lim;
+#endif
 };
 
 struct fatfs_dir {
@@ -79,6 +97,7 @@ static struct fs_ops fatfs_ops = {
     .f_close = fatfs_close,
     .f_read = fatfs_read,
     .f_write = fatfs_write,
+    .f_readv = fatfs_readv,
 
     .f_seek = fatfs_seek,
     .f_getpos = fatfs_getpos,
@@ -171,43 +190,60 @@ struct mounted_disk {
     char *disk_name;
     int disk_number;
     struct disk_ops *dops;
+    FATFS *fs;
 
     SLIST_ENTRY(mounted_disk) sc_next;
 };
 
 static SLIST_HEAD(, mounted_disk) mounted_disks = SLIST_HEAD_INITIALIZER();
 
+/*
+ * Returns the drive number of the disk a path is on, mounting the disk the
+ * first time.  Mounted disks are matched against the path's prefix in
+ * place; the name is only copied out when a disk is mounted.
+ */
 static int
-drivenumber_from_disk(char *disk_name)
+drivenumber_from_path(const char *file_path)
 {
     struct mounted_disk *sc;
     struct mounted_disk *new_disk;
     int disk_number;
     FATFS *fs;
     char path[DRIVE_LEN];
+    char *disk_name;
+    size_t len;
 
     disk_number = 0;
-    if (disk_name) {
+    disk_name = NULL;
+    len = disk_prefix_len(file_path);
+    if (len > 0) {
+        len--;
         SLIST_FOREACH(sc, &mounted_disks, sc_next) {
-            if (strcmp(sc->disk_name, disk_name) == 0) {
+            if (sc->disk_name &&
+                strncmp(sc->disk_name, file_path, len) == 0 &&
+                sc->disk_name[len] == '\0') {
                 return sc->disk_number;
             }
             disk_number++;
         }
+        disk_name = disk_name_from_path(file_path);
     }
 
     /* XXX: check for errors? */
     fs = malloc(sizeof(FATFS));
-    sprintf(path, "%d:", disk_number);
-    f_mount(fs, path, 1);
 
     /* FIXME */
     new_disk = malloc(sizeof(struct mounted_disk));
-    new_disk->disk_name = strdup(disk_name);
+    new_disk->disk_name = disk_name;
     new_disk->disk_number = disk_number;
     new_disk->dops = disk_ops_for(disk_name);
+    new_disk->fs = fs;
     SLIST_INSERT_HEAD(&mounted_disks, new_disk, sc_next);
 
+    /* Mounting reads the disk, so the disk has to be known first. */
+    sprintf(path, "%d:", disk_number);
+    f_mount(fs, path, 1);
+
     return disk_number;
 }
 
@@ -218,9 +254,7 @@ fatfs_open(const char *path, uint8_t access_flags, struct fs_file **out_fs_file)
     FIL *out_file = NULL;
     BYTE mode;
     struct fatfs_file *file = NULL;
-    char *disk;
     int number;
-    char *filepath;
     char drivepath[255 + DRIVE_LEN];  /* FIXME */
     int rc;
 
@@ -251,11 +285,8 @@ fatfs_open(const char *path, uint8_t access_flags, struct fs_file **out_fs_file)
         mode |= FA_CREATE_ALWAYS;
     }
 
-    disk = disk_name_from_path(path);
-    number = drivenumber_from_disk(disk);
-    filepath = disk_filepath_from_path(path);
-    sprintf(drivepath, "%d:%s", number, filepath);
-    free(filepath);
+    number = drivenumber_from_path(path);
+    sprintf(drivepath, "%d:%s", number, disk_path_strip(path));
 
     res = f_open(out_file, drivepath, mode);
     if (res != FR_OK) {
@@ -265,6 +296,10 @@ fatfs_open(const char *path, uint8_t access_flags, struct fs_file **out_fs_file)
 
     file->file = out_file;
     file->fops = &fatfs_ops;
+#if MYNEWT_VAL(FATFS_FILE_BUF_SIZE)
+    file->buf = NULL;
+    file->buf_len = 0;
+#endif
     *out_fs_file = (struct fs_file *) file;
     rc = FS_EOK;
 
@@ -276,18 +311,79 @@ out:
     return rc;
 }
 
+#if MYNEWT_VAL(FATFS_FILE_BUF_SIZE)
+/* Writes out the buffered data of a file. */
+static int
+fatfs_flush(struct fatfs_file *file)
+{
+    FRESULT res;
+    UINT out_len;
+    UINT len;
+
+    len = file->buf_len;
+    if (len == 0) {
+        return FS_EOK;
+    }
+    file->buf_len = 0;
+
+    res = f_write(file->file, file->buf, len, &out_len);
+    if (res != FR_OK) {
+        return fatfs_to_vfs_error(res);
+    }
+    if (out_len != len) {
+        return FS_EFULL;
+    }
+    return FS_EOK;
+}
+
+/*
+ * Sets up the write buffer of a file: the largest power of two sectors
+ * that fits both a cluster and FATFS_FILE_BUF_SIZE.
+ */
+static void
+fatfs_buf_alloc(struct fatfs_file *file)
+{
+    uint32_t size;
+
+    size = (uint32_t)file->file->obj.fs->csize * FATFS_SECTOR_SIZE;
+    while (size > MYNEWT_VAL(FATFS_FILE_BUF_SIZE)) {
+        size >>= 1;
+    }
+    if (size < FATFS_SECTOR_SIZE) {
+        return;
+    }
+
+    file->buf = malloc(size);
+    if (file->buf != NULL) {
+        file->buf_size = size;
+    }
+}
+#endif
+
 static int
 fatfs_close(struct fs_file *fs_file)
 {
     FRESULT res;
-    FIL *file = ((struct fatfs_file *) fs_file)->file;
+    struct fatfs_file *ff = (struct fatfs_file *) fs_file;
+    FIL *file = ff->file;
+    int rc;
 
     if (file == NULL) {
         return FS_EOK;
     }
 
+    rc = FS_EOK;
+#if MYNEWT_VAL(FATFS_FILE_BUF_SIZE)
+    rc = fatfs_flush(ff);
+    free(ff->buf);
+#endif
+
     res = f_close(file);
     free(file);
+    free(ff);
+    if (rc != FS_EOK) {
+        return rc;
+    }
     return fatfs_to_vfs_error(res);
 }
 
@@ -296,6 +392,14 @@ fatfs_seek(struct fs_file *fs_file, uint32_t offset)
 {
     FRESULT res;
     FIL *file = ((struct fatfs_file *) fs_file)->file;
+#if MYNEWT_VAL(FATFS_FILE_BUF_SIZE)
+    int rc;
+
+    rc = fatfs_flush((struct fatfs_file *) fs_file);
+    if (rc != FS_EOK) {
+        return rc;
+    }
+#endif
 
     res = f_lseek(file, offset);
     return fatfs_to_vfs_error(res);
@@ -308,17 +412,25 @@ fatfs_getpos(const struct fs_file *fs_file)
     FIL *file = ((struct fatfs_file *) fs_file)->file;
 
     offset = (uint32_t) f_tell(file);
+#if MYNEWT_VAL(FATFS_FILE_BUF_SIZE)
+    offset += ((const struct fatfs_file *) fs_file)->buf_len;
+#endif
     return offset;
 }
 
 static int
 fatfs_file_len(const struct fs_file *fs_file, uint32_t *out_len)
 {
-    uint32_t offset;
     FIL *file = ((struct fatfs_file *) fs_file)->file;
 
-    offset = (uint32_t) f_size(file);
-    return offset;
+    *out_len = (uint32_t) f_size(file);
+#if MYNEWT_VAL(FATFS_FILE_BUF_SIZE)
+    /* Buffered data past the end of the file grows it. */
+    if (fatfs_getpos(fs_file) > *out_len) {
+        *out_len = fatfs_getpos(fs_file);
+    }
+#endif
+    return FS_EOK;
 }
 
 static int
@@ -328,18 +440,104 @@ fatfs_read(struct fs_file *fs_file, uint32_t len, void *out_data,
     FRESULT res;
     FIL *file = ((struct fatfs_file *) fs_file)->file;
     UINT uint_len;
+#if MYNEWT_VAL(FATFS_FILE_BUF_SIZE)
+    int rc;
+
+    rc = fatfs_flush((struct fatfs_file *) fs_file);
+    if (rc != FS_EOK) {
+        *out_len = 0;
+        return rc;
+    }
+#endif
 
     res = f_read(file, out_data, len, &uint_len);
     *out_len = uint_len;
     return fatfs_to_vfs_error(res);
 }
 
+/*
+ * Buffered writes are flushed once for all pieces.  Vectored writes need
+ * nothing special: fatfs_write() already collects small pieces in the
+ * write buffer.
+ */
+static int
+fatfs_readv(struct fs_file *fs_file, const struct fs_iovec *iov, int iovcnt,
+            uint32_t *out_len)
+{
+    FRESULT res;
+    FIL *file = ((struct fatfs_file *) fs_file)->file;
+    UINT uint_len;
+    int i;
+#if MYNEWT_VAL(FATFS_FILE_BUF_SIZE)
+    int rc;
+#endif
+
+    *out_len = 0;
+#if MYNEWT_VAL(FATFS_FILE_BUF_SIZE)
+    rc = fatfs_flush((struct fatfs_file *) fs_file);
+    if (rc != FS_EOK) {
+        return rc;
+    }
+#endif
+
+    for (i = 0; i < iovcnt; i++) {
+        res = f_read(file, iov[i].iov_base, iov[i].iov_len, &uint_len);
+        if (res != FR_OK) {
+            return fatfs_to_vfs_error(res);
+        }
+        *out_len += uint_len;
+        if (uint_len < iov[i].iov_len) {
+            break;
+        }
+    }
+    return FS_EOK;
+}
+
 static int
 fatfs_write(struct fs_file *fs_file, const void *data, int len)
 {
     FRESULT res;
     UINT out_len;
     FIL *file = ((struct fatfs_file *) fs_file)->file;
+#if MYNEWT_VAL(FATFS_FILE_BUF_SIZE)
+    struct fatfs_file *ff = (struct fatfs_file *) fs_file;
+    const uint8_t *src;
+    int chunk;
+    int rc;
+
+    if (ff->buf == NULL && len > 0 && (file->flag & FA_WRITE)) {
+        fatfs_buf_alloc(ff);
+    }
+
+    if (ff->buf != NULL && len < ff->buf_size) {
+        src = data;
+        while (len > 0) {
+            if (ff->buf_len == 0) {
+                /* Flushes end on a buffer size boundary in the file. */
+                ff->buf_lim = ff->buf_size - f_tell(file) % ff->buf_size;
+            }
+            chunk = min(len, ff->buf_lim - ff->buf_len);
+            memcpy(ff->buf + ff->buf_len, src, chunk);
+            ff->buf_len += chunk;
+            src += chunk;
+            len -= chunk;
+
+            if (ff->buf_len == ff->buf_lim) {
+                rc = fatfs_flush(ff);
+                if (rc != FS_EOK) {
+                    return rc;
+                }
+            }
+        }
+        return FS_EOK;
+    }
+
+    /* Large writes go straight through, in order after what is buffered. */
+    rc = fatfs_flush(ff);
+    if (rc != FS_EOK) {
+        return rc;
+    }
+#endif
 
     res = f_write(file, data, len, &out_len);
     if (len != out_len) {
@@ -383,9 +581,7 @@ fatfs_opendir(const char *path, struct fs_dir **out_fs_dir)
     FRESULT res;
     FATFS_DIR *out_dir = NULL;
     struct fatfs_dir *dir = NULL;
-    char *disk;
     int number;
-    char *filepath;
     char drivepath[255 + DRIVE_LEN];  /* FIXME */
     int rc;
 
@@ -401,11 +597,8 @@ fatfs_opendir(const char *path, struct fs_dir **out_fs_dir)
         goto out;
     }
 
-    disk = disk_name_from_path(path);
-    number = drivenumber_from_disk(disk);
-    filepath = disk_filepath_from_path(path);
-    sprintf(drivepath, "%d:%s", number, filepath);
-    free(filepath);
+    number = drivenumber_from_path(path);
+    sprintf(drivepath, "%d:%s", number, disk_path_strip(path));
 
     res = f_opendir(out_dir, drivepath);
     if (res != FR_OK) {
@@ -481,9 +674,173 @@ fatfs_dirent_is_dir(const struct fs_dirent *fs_dirent)
     return filinfo->fattrib & AM_DIR;
 }
 
+#if MYNEWT_VAL(FATFS_FAT_CACHE_CNT) || MYNEWT_VAL(FATFS_DIR_CACHE_CNT)
+/*
+ * Sector caches for the metadata FatFs reads through its one sector
+ * window, fs->win: FAT sectors, and directory sectors (everything else
+ * read through the window).  With the window alone, allocating a cluster
+ * while appending to a file swaps the window between FAT and directory
+ * entry, rereading each every time, and every path lookup rescans its
+ * directories from the disk.
+ *
+ * The caches are write-through; every write to the disk updates the copies
+ * it covers.
+ */
+struct fatfs_cache_entry {
+    DWORD sector;
+    uint32_t used;
+    BYTE pdrv;
+    uint8_t valid;
+    BYTE data[FATFS_SECTOR_SIZE];
+};
+
+struct fatfs_cache {
+    struct fatfs_cache_entry *entries;
+    int cnt;
+};
+
+#if MYNEWT_VAL(FATFS_FAT_CACHE_CNT)
+static struct fatfs_cache_entry
+    fatfs_fat_cache_entries[MYNEWT_VAL(FATFS_FAT_CACHE_CNT)];
+#else
+#define fatfs_fat_cache_entries NULL
+#endif
+#if MYNEWT_VAL(FATFS_DIR_CACHE_CNT)
+static struct fatfs_cache_entry
+    fatfs_dir_cache_entries[MYNEWT_VAL(FATFS_DIR_CACHE_CNT)];
+#else
+#define fatfs_dir_cache_entries NULL
+#endif
+
+static struct fatfs_cache fatfs_caches[2] = {
+    { fatfs_fat_cache_entries, MYNEWT_VAL(FATFS_FAT_CACHE_CNT) },
+    { fatfs_dir_cache_entries, MYNEWT_VAL(FATFS_DIR_CACHE_CNT) },
+};
+
+static uint32_t fatfs_cache_clock;
+
+static struct fatfs_cache_entry *
+fatfs_cache_find(struct fatfs_cache *cache, BYTE pdrv, DWORD sector)
+{
+    int i;
+
+    for (i = 0; i < cache->cnt; i++) {
+        if (cache->entries[i].valid && cache->entries[i].pdrv == pdrv &&
+            cache->entries[i].sector == sector) {
+            return &cache->entries[i];
+        }
+    }
+    return NULL;
+}
+
+/* The cache for a window read of the sector, or NULL to read uncached. */
+static struct fatfs_cache *
+fatfs_cache_for(BYTE pdrv, const BYTE *buff, DWORD sector, UINT count)
+{
+    struct mounted_disk *sc;
+    FATFS *fs;
+
+    if (count != 1) {
+        return NULL;
+    }
+
+    SLIST_FOREACH(sc, &mounted_disks, sc_next) {
+        if (sc->disk_number == pdrv) {
+            break;
+        }
+    }
+    if (sc == NULL) {
+        return NULL;
+    }
+
+    /* Not while mounting: the layout is not known yet. */
+    fs = sc->fs;
+    if (buff != fs->win || fs->fs_type == 0) {
+        return NULL;
+    }
+
+    if (sector >= fs->fatbase &&
+        sector < fs->fatbase + fs->fsize * fs->n_fats) {
+        return &fatfs_caches[0];
+    }
+    return &fatfs_caches[1];
+}
+
+static void
+fatfs_cache_insert(struct fatfs_cache *cache, BYTE pdrv, DWORD sector,
+                   const BYTE *data)
+{
+    struct fatfs_cache_entry *entry;
+    int i;
+
+    if (cache->cnt == 0) {
+        return;
+    }
+
+    /* Replaces an empty entry, or the least recently used. */
+    entry = &cache->entries[0];
+    for (i = 0; i < cache->cnt; i++) {
+        if (!cache->entries[i].valid) {
+            entry = &cache->entries[i];
+            break;
+        }
+        if (cache->entries[i].used < entry->used) {
+            entry = &cache->entries[i];
+        }
+    }
+
+    memcpy(entry->data, data, FATFS_SECTOR_SIZE);
+    entry->pdrv = pdrv;
+    entry->sector = sector;
+    entry->used = ++fatfs_cache_clock;
+    entry->valid = 1;
+}
+
+/* Brings cached copies up to date with a write. */
+static void
+fatfs_cache_write(BYTE pdrv, const BYTE *buff, DWORD sector, UINT count)
+{
+    struct fatfs_cache_entry *entry;
+    int c;
+    int i;
+
+    for (c = 0; c < 2; c++) {
+        for (i = 0; i < fatfs_caches[c].cnt; i++) {
+            entry = &fatfs_caches[c].entries[i];
+            if (entry->valid && entry->pdrv == pdrv &&
+                entry->sector >= sector && entry->sector - sector < count) {
+                memcpy(entry->data,
+                       buff + (entry->sector - sector) * FATFS_SECTOR_SIZE,
+                       FATFS_SECTOR_SIZE);
+            }
+        }
+    }
+}
+
+static void
+fatfs_cache_invalidate(BYTE pdrv)
+{
+    int c;
+    int i;
+
+    for (c = 0; c < 2; c++) {
+        for (i = 0; i < fatfs_caches[c].cnt; i++) {
+            if (fatfs_caches[c].entries[i].pdrv == pdrv) {
+                fatfs_caches[c].entries[i].valid = 0;
+            }
+        }
+    }
+}
+#endif
+
 DSTATUS
 disk_initialize(BYTE pdrv)
 {
+#if MYNEWT_VAL(FATFS_FAT_CACHE_CNT) || MYNEWT_VAL(FATFS_DIR_CACHE_CNT)
+    /* (Re)mounting; the medium may have changed. */
+    fatfs_cache_invalidate(pdrv);
+#endif
+
     /* Don't need to do anything while using hal_flash */
     return RES_OK;
 }
@@ -515,10 +872,23 @@ disk_read(BYTE pdrv, BYTE* buff, DWORD sector, UINT count)
     uint32_t address;
     uint32_t num_bytes;
     struct disk_ops *dops;
+#if MYNEWT_VAL(FATFS_FAT_CACHE_CNT) || MYNEWT_VAL(FATFS_DIR_CACHE_CNT)
+    struct fatfs_cache *cache;
+    struct fatfs_cache_entry *entry;
+
+    cache = fatfs_cache_for(pdrv, buff, sector, count);
+    if (cache != NULL) {
+        entry = fatfs_cache_find(cache, pdrv, sector);
+        if (entry != NULL) {
+            memcpy(buff, entry->data, FATFS_SECTOR_SIZE);
+            entry->used = ++fatfs_cache_clock;
+            return RES_OK;
+        }
+    }
+#endif
 
-    /* NOTE: safe to assume sector size as 512 for now, see ffconf.h */
-    address = (uint32_t) sector * 512;
-    num_bytes = (uint32_t) count * 512;
+    address = (uint32_t) sector * FATFS_SECTOR_SIZE;
+    num_bytes = (uint32_t) count * FATFS_SECTOR_SIZE;
 
     dops = dops_from_handle(pdrv);
     if (dops == NULL) {
@@ -530,6 +900,12 @@ disk_read(BYTE pdrv, BYTE* buff, DWORD sector, UINT count)
         return STA_NOINIT;
     }
 
+#if MYNEWT_VAL(FATFS_FAT_CACHE_CNT) || MYNEWT_VAL(FATFS_DIR_CACHE_CNT)
+    if (cache != NULL) {
+        fatfs_cache_insert(cache, pdrv, sector, buff);
+    }
+#endif
+
     return RES_OK;
 }
 
@@ -541,9 +917,8 @@ disk_write(BYTE pdrv, const BYTE* buff, DWORD sector, UINT count)
     uint32_t num_bytes;
     struct disk_ops *dops;
 
-    /* NOTE: safe to assume sector size as 512 for now, see ffconf.h */
-    address = (uint32_t) sector * 512;
-    num_bytes = (uint32_t) count * 512;
+    address = (uint32_t) sector * FATFS_SECTOR_SIZE;
+    num_bytes = (uint32_t) count * FATFS_SECTOR_SIZE;
 
     dops = dops_from_handle(pdrv);
     if (dops == NULL) {
@@ -551,6 +926,14 @@ disk_write(BYTE pdrv, const BYTE* buff, DWORD sector, UINT count)
     }
 
     rc = dops->write(pdrv, address, (const void *) buff, num_bytes);
+#if MYNEWT_VAL(FATFS_FAT_CACHE_CNT) || MYNEWT_VAL(FATFS_DIR_CACHE_CNT)
+    /* Whatever the disk now holds, the old copies are stale. */
+    if (rc < 0) {
+        fatfs_cache_invalidate(pdrv);
+    } else {
+        fatfs_cache_write(pdrv, buff, sector, count);
+    }
+#endif
     if (rc < 0) {
         return STA_NOINIT;
     }
@@ -34,6 +34,7 @@ extern "C" {
 
 #include <syscfg/syscfg.h>
 #include <os/os_mutex.h>
+#include <os/os_eventq.h>
 #include <flash_map/flash_map.h>
 
 #define FCB_MAX_LEN	(CHAR_MAX | CHAR_MAX << 7) /* Max length of element */
@@ -49,6 +50,14 @@ struct fcb_entry {
     uint16_t fe_data_len;	/* size of data area */
 };
 
+struct fcb;
+
+/**
+ * Called by erase-ahead just before it drops the data in the oldest sector,
+ * with the FCB locked; fcb->f_oldest still points at the sector.
+ */
+typedef void fcb_drop_cb(struct fcb *fcb, void *arg);
+
 struct fcb {
     /* Caller of fcb_init fills this in */
     uint32_t f_magic;		/* As placed on the disk */
@@ -63,6 +72,23 @@ struct fcb {
     struct fcb_entry f_active;
     uint16_t f_active_id;
     uint8_t f_align;		/* writes to flash have to aligned to this */
+
+#if MYNEWT_VAL(FCB_ERASE_AHEAD)
+    /* Background erase state; see fcb_erase_ahead_init() */
+    uint8_t f_erase_cnt;	/* Number of sectors to keep erased */
+    struct flash_area *f_erasing; /* Dropped, but not yet erased */
+    struct os_eventq *f_erase_evq;
+    struct os_event f_erase_ev;
+    fcb_drop_cb *f_drop_cb;
+    void *f_drop_arg;
+#endif
+
+#if MYNEWT_VAL(FCB_ELEM_CACHE)
+    /* Offsets of the newest elements in the active sector */
+    struct flash_area *f_ec_area; /* Sector indexed; NULL if not known */
+    uint32_t f_ec_cnt;		/* Elements in the sector */
+    uint32_t f_ec_off[MYNEWT_VAL(FCB_ELEM_CACHE_SIZE)];
+#endif
 };
 
 /**
@@ -107,6 +133,30 @@ int fcb_getnext(struct fcb *, struct fcb_entry *loc);
  */
 int fcb_rotate(struct fcb *);
 
+#if MYNEWT_VAL(FCB_ERASE_AHEAD)
+/**
+ * Keeps cnt sectors erased ahead of the active one, so that fcb_append()
+ * can move to a new sector without waiting for an erase.  When fewer
+ * sectors are free, the data in the oldest sector is dropped and the
+ * sector is erased from an event on evq, which should be served by a low
+ * priority task.  The sector being erased does not count as free.
+ *
+ * Call after fcb_init().  A cnt of 0 turns erase-ahead off again.
+ *
+ * @param fcb                   The FCB.
+ * @param cnt                   Number of erased sectors to keep ready.
+ * @param evq                   Event queue to erase from.
+ * @param drop_cb               Called before a sector's data is dropped;
+ *                                  may be NULL.
+ * @param arg                   Argument passed to drop_cb.
+ *
+ * @return                      0 on success; FCB_ERR_ARGS if cnt would leave
+ *                                  no sector for data.
+ */
+int fcb_erase_ahead_init(struct fcb *fcb, uint8_t cnt, struct os_eventq *evq,
+                         fcb_drop_cb *drop_cb, void *arg);
+#endif
+
 /**
  * Start using the scratch block.
  */
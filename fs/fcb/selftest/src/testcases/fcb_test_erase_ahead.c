@@ -0,0 +1,132 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "fcb_test.h"
+
+#if MYNEWT_VAL(FCB_ERASE_AHEAD)
+static void
+fcb_test_erase_ahead_drop(struct fcb *fcb, void *arg)
+{
+    (*(int *)arg)++;
+}
+
+static void
+fcb_test_erase_ahead_fill(struct fcb *fcb, struct flash_area *until)
+{
+    struct fcb_entry loc;
+    uint8_t test_data[128];
+    int rc;
+
+    memset(test_data, 0xa5, sizeof(test_data));
+    while (fcb->f_active.fe_area != until) {
+        rc = fcb_append(fcb, sizeof(test_data), &loc);
+        TEST_ASSERT_FATAL(rc == 0);
+
+        rc = flash_area_write(loc.fe_area, loc.fe_data_off, test_data,
+          sizeof(test_data));
+        TEST_ASSERT(rc == 0);
+
+        rc = fcb_append_finish(fcb, &loc);
+        TEST_ASSERT(rc == 0);
+    }
+}
+#endif
+
+TEST_CASE_SELF(fcb_test_erase_ahead)
+{
+#if MYNEWT_VAL(FCB_ERASE_AHEAD)
+    static struct os_eventq evq;
+    struct os_event *ev;
+    struct fcb_entry loc;
+    struct fcb *fcb;
+    int drops;
+    int rc;
+    int cnts[4];
+    struct append_arg aa_arg = {
+        .elem_cnts = cnts
+    };
+
+    fcb_tc_pretest(4);
+
+    fcb = &test_fcb;
+    os_eventq_init(&evq);
+    drops = 0;
+
+    rc = fcb_erase_ahead_init(fcb, 4, &evq, NULL, NULL);
+    TEST_ASSERT(rc == FCB_ERR_ARGS);
+
+    rc = fcb_erase_ahead_init(fcb, 2, &evq, fcb_test_erase_ahead_drop,
+                              &drops);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(os_eventq_get_no_wait(&evq) == NULL);
+
+    /*
+     * Moving into sector 2 leaves one free sector; oldest gets erased.
+     */
+    fcb_test_erase_ahead_fill(fcb, &test_fcb_area[2]);
+    TEST_ASSERT(fcb_free_sector_cnt(fcb) == 1);
+    ev = os_eventq_get_no_wait(&evq);
+    TEST_ASSERT_FATAL(ev != NULL);
+    ev->ev_cb(ev);
+
+    TEST_ASSERT(drops == 1);
+    TEST_ASSERT(fcb->f_oldest == &test_fcb_area[1]);
+    TEST_ASSERT(fcb->f_erasing == NULL);
+    TEST_ASSERT(fcb_free_sector_cnt(fcb) == 2);
+
+    memset(cnts, 0, sizeof(cnts));
+    rc = fcb_walk(fcb, NULL, fcb_test_cnt_elems_cb, &aa_arg);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(cnts[0] == 0);
+    TEST_ASSERT(cnts[1] > 0);
+    TEST_ASSERT(cnts[2] == 1);
+
+    /*
+     * Sector 1 failed to erase: it stays out of use until a retry succeeds.
+     */
+    fcb->f_erasing = &test_fcb_area[1];
+    fcb->f_oldest = &test_fcb_area[2];
+    TEST_ASSERT(fcb_free_sector_cnt(fcb) == 2);
+
+    fcb_test_erase_ahead_fill(fcb, &test_fcb_area[0]);
+    while (1) {
+        rc = fcb_append(fcb, sizeof(uint32_t), &loc);
+        if (rc == FCB_ERR_NOSPACE) {
+            break;
+        }
+        TEST_ASSERT_FATAL(rc == 0);
+        TEST_ASSERT(loc.fe_area == &test_fcb_area[0]);
+        rc = fcb_append_finish(fcb, &loc);
+        TEST_ASSERT(rc == 0);
+    }
+
+    ev = os_eventq_get_no_wait(&evq);
+    TEST_ASSERT_FATAL(ev != NULL);
+    ev->ev_cb(ev);
+
+    /* Retried sector 1, then dropped sector 2 to have two ready again. */
+    TEST_ASSERT(drops == 2);
+    TEST_ASSERT(fcb->f_erasing == NULL);
+    TEST_ASSERT(fcb->f_oldest == &test_fcb_area[3]);
+    TEST_ASSERT(fcb_free_sector_cnt(fcb) == 2);
+
+    rc = fcb_append(fcb, sizeof(uint32_t), &loc);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(loc.fe_area == &test_fcb_area[1]);
+#endif
+}
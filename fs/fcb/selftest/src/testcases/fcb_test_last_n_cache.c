@@ -0,0 +1,140 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "fcb_test.h"
+
+#if MYNEWT_VAL(FCB_ELEM_CACHE)
+#define FCB_TEST_EC_MAX 512
+
+static struct fcb_entry fcb_test_ec_locs[FCB_TEST_EC_MAX];
+static int fcb_test_ec_cnt;
+
+static int
+fcb_test_ec_walk_cb(struct fcb_entry *loc, void *arg)
+{
+    TEST_ASSERT_FATAL(fcb_test_ec_cnt < FCB_TEST_EC_MAX);
+    fcb_test_ec_locs[fcb_test_ec_cnt++] = *loc;
+    return 0;
+}
+
+/*
+ * Compares fcb_offset_last_n() against a walk of the whole FCB.
+ */
+static void
+fcb_test_ec_check(struct fcb *fcb)
+{
+    struct fcb_entry loc;
+    struct fcb_entry *exp;
+    int rc;
+    int n;
+
+    fcb_test_ec_cnt = 0;
+    rc = fcb_walk(fcb, NULL, fcb_test_ec_walk_cb, NULL);
+    TEST_ASSERT(rc == 0);
+
+    for (n = 1; n <= 40; n++) {
+        rc = fcb_offset_last_n(fcb, n, &loc);
+        if (fcb_test_ec_cnt == 0) {
+            TEST_ASSERT(rc == FCB_ERR_NOVAR);
+            continue;
+        }
+        TEST_ASSERT_FATAL(rc == 0);
+        exp = &fcb_test_ec_locs[n < fcb_test_ec_cnt ?
+                                fcb_test_ec_cnt - n : 0];
+        TEST_ASSERT(loc.fe_area == exp->fe_area);
+        TEST_ASSERT(loc.fe_elem_off == exp->fe_elem_off);
+        TEST_ASSERT(loc.fe_data_off == exp->fe_data_off);
+        TEST_ASSERT(loc.fe_data_len == exp->fe_data_len);
+    }
+}
+
+static void
+fcb_test_ec_append(struct fcb *fcb, int cnt)
+{
+    struct fcb_entry loc;
+    uint8_t test_data[128];
+    int rc;
+    int i;
+
+    memset(test_data, 0x5a, sizeof(test_data));
+    for (i = 0; i < cnt; i++) {
+        rc = fcb_append(fcb, sizeof(test_data), &loc);
+        if (rc == FCB_ERR_NOSPACE) {
+            rc = fcb_rotate(fcb);
+            TEST_ASSERT_FATAL(rc == 0);
+            rc = fcb_append(fcb, sizeof(test_data), &loc);
+        }
+        TEST_ASSERT_FATAL(rc == 0);
+
+        rc = flash_area_write(loc.fe_area, loc.fe_data_off, test_data,
+          sizeof(test_data));
+        TEST_ASSERT(rc == 0);
+
+        rc = fcb_append_finish(fcb, &loc);
+        TEST_ASSERT(rc == 0);
+    }
+}
+#endif
+
+TEST_CASE_SELF(fcb_test_last_n_cache)
+{
+#if MYNEWT_VAL(FCB_ELEM_CACHE)
+    struct fcb_entry loc[2];
+    struct fcb *fcb;
+    int rc;
+    int i;
+
+    fcb_tc_pretest(4);
+
+    fcb = &test_fcb;
+
+    fcb_test_ec_check(fcb);
+    TEST_ASSERT(fcb->f_ec_area == fcb->f_active.fe_area);
+
+    /* Fewer entries than the cache holds, all in one sector. */
+    fcb_test_ec_append(fcb, 5);
+    fcb_test_ec_check(fcb);
+
+    /* Active sector holds more than the cache; older sectors in use. */
+    fcb_test_ec_append(fcb, 250);
+    TEST_ASSERT(fcb->f_active.fe_area != fcb->f_oldest);
+    fcb_test_ec_check(fcb);
+
+    /* After a restart the index is rebuilt by the first lookup. */
+    rc = fcb_init(fcb);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(fcb->f_ec_area == NULL);
+    fcb_test_ec_check(fcb);
+    TEST_ASSERT(fcb->f_ec_area == fcb->f_active.fe_area);
+
+    /* Wrap around, rotating out the oldest sectors. */
+    fcb_test_ec_append(fcb, 500);
+    fcb_test_ec_check(fcb);
+
+    /* Entries finished out of order. */
+    for (i = 0; i < 2; i++) {
+        rc = fcb_append(fcb, 16, &loc[i]);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+    rc = fcb_append_finish(fcb, &loc[1]);
+    TEST_ASSERT(rc == 0);
+    rc = fcb_append_finish(fcb, &loc[0]);
+    TEST_ASSERT(rc == 0);
+    fcb_test_ec_check(fcb);
+#endif
+}
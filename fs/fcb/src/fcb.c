@@ -82,6 +82,13 @@ fcb_init(struct fcb *fcb)
     fcb->f_active.fe_area = newest_fap;
     fcb->f_active.fe_elem_off = sizeof(struct fcb_disk_area);
     fcb->f_active_id = newest;
+#if MYNEWT_VAL(FCB_ERASE_AHEAD)
+    fcb->f_erase_cnt = 0;
+    fcb->f_erasing = NULL;
+#endif
+#if MYNEWT_VAL(FCB_ELEM_CACHE)
+    fcb->f_ec_area = NULL;
+#endif
 
     /* Require alignment to be a power of two.  Some code depends on this
      * assumption.
@@ -115,6 +122,12 @@ fcb_free_sector_cnt(struct fcb *fcb)
             break;
         }
     }
+#if MYNEWT_VAL(FCB_ERASE_AHEAD)
+    /* The sector being erased is not ready yet. */
+    if (fcb->f_erasing != NULL && i > 0) {
+        i--;
+    }
+#endif
     return i;
 }
 
@@ -218,30 +231,133 @@ fcb_sector_hdr_read(struct fcb *fcb, struct flash_area *fap,
  * @param2 ptr to the fcb_entry to be returned
  * @return 0 on there are any fcbs aviable; FCB_ERR_NOVAR otherwise
  */
+#if MYNEWT_VAL(FCB_ELEM_CACHE)
+#define FCB_EC_SIZE     MYNEWT_VAL(FCB_ELEM_CACHE_SIZE)
+
+/*
+ * Starts indexing a sector which has no elements yet.  Called with the FCB
+ * locked, as are the other fcb_ec functions.
+ */
+void
+fcb_ec_reset(struct fcb *fcb, struct flash_area *fap)
+{
+    fcb->f_ec_area = fap;
+    fcb->f_ec_cnt = 0;
+}
+
+/*
+ * Records a valid element; elements must come in the order they are in
+ * flash.
+ */
+void
+fcb_ec_add(struct fcb *fcb, const struct fcb_entry *loc)
+{
+    if (loc->fe_area != fcb->f_ec_area) {
+        return;
+    }
+    if (fcb->f_ec_cnt > 0 &&
+        loc->fe_elem_off <= fcb->f_ec_off[(fcb->f_ec_cnt - 1) % FCB_EC_SIZE]) {
+        /* Finished out of order; stop trusting the index. */
+        fcb->f_ec_area = NULL;
+        return;
+    }
+    fcb->f_ec_off[fcb->f_ec_cnt % FCB_EC_SIZE] = loc->fe_elem_off;
+    fcb->f_ec_cnt++;
+}
+
+/*
+ * Looks up the entries'th newest element from the index.  Returns 0 if
+ * found, FCB_ERR_NOVAR if the FCB is known to be empty, and 1 if the flash
+ * has to be scanned.
+ */
+static int
+fcb_ec_last_n(struct fcb *fcb, uint8_t entries, struct fcb_entry *loc)
+{
+    uint32_t cnt;
+
+    if (fcb->f_ec_area != fcb->f_active.fe_area) {
+        return 1;
+    }
+
+    cnt = fcb->f_ec_cnt;
+    if (entries > cnt) {
+        if (fcb->f_oldest != fcb->f_active.fe_area) {
+            /* Rest is in older sectors. */
+            return 1;
+        }
+        if (cnt == 0) {
+            return FCB_ERR_NOVAR;
+        }
+        entries = cnt;
+    }
+    if (entries > FCB_EC_SIZE) {
+        return 1;
+    }
+
+    loc->fe_area = fcb->f_ec_area;
+    loc->fe_elem_off = fcb->f_ec_off[(cnt - entries) % FCB_EC_SIZE];
+    if (fcb_elem_info(fcb, loc) != 0) {
+        fcb->f_ec_area = NULL;
+        return 1;
+    }
+    return 0;
+}
+#endif
+
 int
 fcb_offset_last_n(struct fcb *fcb, uint8_t entries,
         struct fcb_entry *last_n_entry)
 {
     struct fcb_entry loc;
     int i;
+    int rc;
 
     /* assure a minimum amount of entries */
     if (!entries) {
         entries = 1;
     }
 
+    rc = os_mutex_pend(&fcb->f_mtx, OS_WAIT_FOREVER);
+    if (rc && rc != OS_NOT_STARTED) {
+        return FCB_ERR_ARGS;
+    }
+
+#if MYNEWT_VAL(FCB_ELEM_CACHE)
+    rc = fcb_ec_last_n(fcb, entries, last_n_entry);
+    if (rc != 1) {
+        os_mutex_release(&fcb->f_mtx);
+        return rc;
+    }
+    /* Index the active sector while scanning through it. */
+    fcb->f_ec_area = NULL;
+#endif
+
     i = 0;
     memset(&loc, 0, sizeof(loc));
-    while (!fcb_getnext(fcb, &loc)) {
+    while (!fcb_getnext_nolock(fcb, &loc)) {
+#if MYNEWT_VAL(FCB_ELEM_CACHE)
+        if (loc.fe_area == fcb->f_active.fe_area) {
+            if (fcb->f_ec_area == NULL) {
+                fcb_ec_reset(fcb, loc.fe_area);
+            }
+            fcb_ec_add(fcb, &loc);
+        }
+#endif
         if (i == 0) {
             /* Start from the beginning of fcb entries */
             *last_n_entry = loc;
         } else if (i > (entries - 1)) {
             /* Update last_n_entry after n entries and keep updating */
-            fcb_getnext(fcb, last_n_entry);
+            fcb_getnext_nolock(fcb, last_n_entry);
         }
         i++;
     }
+#if MYNEWT_VAL(FCB_ELEM_CACHE)
+    if (fcb->f_ec_area == NULL) {
+        fcb_ec_reset(fcb, fcb->f_active.fe_area);
+    }
+#endif
+    os_mutex_release(&fcb->f_mtx);
 
     return (i == 0) ? FCB_ERR_NOVAR : 0;
 }
@@ -39,6 +39,12 @@ fcb_new_area(struct fcb *fcb, int cnt)
         if (fa == fcb->f_oldest) {
             return NULL;
         }
+#if MYNEWT_VAL(FCB_ERASE_AHEAD)
+        /* Directly precedes f_oldest; not erased yet. */
+        if (fa == fcb->f_erasing) {
+            return NULL;
+        }
+#endif
     } while (i++ < cnt);
     return rfa;
 }
@@ -63,6 +69,12 @@ fcb_append_to_scratch(struct fcb *fcb)
     fcb->f_active.fe_area = fa;
     fcb->f_active.fe_elem_off = sizeof(struct fcb_disk_area);
     fcb->f_active_id++;
+#if MYNEWT_VAL(FCB_ERASE_AHEAD)
+    fcb_erase_ahead_kick(fcb);
+#endif
+#if MYNEWT_VAL(FCB_ELEM_CACHE)
+    fcb_ec_reset(fcb, fa);
+#endif
     return FCB_OK;
 }
 
@@ -101,6 +113,12 @@ fcb_append(struct fcb *fcb, uint16_t len, struct fcb_entry *append_loc)
         fcb->f_active.fe_area = fa;
         fcb->f_active.fe_elem_off = sizeof(struct fcb_disk_area);
         fcb->f_active_id++;
+#if MYNEWT_VAL(FCB_ERASE_AHEAD)
+        fcb_erase_ahead_kick(fcb);
+#endif
+#if MYNEWT_VAL(FCB_ELEM_CACHE)
+        fcb_ec_reset(fcb, fa);
+#endif
     }
 
     rc = flash_area_write(active->fe_area, active->fe_elem_off, tmp_str, cnt);
@@ -141,5 +159,10 @@ fcb_append_finish(struct fcb *fcb, struct fcb_entry *loc)
     if (rc) {
         return FCB_ERR_FLASH;
     }
+#if MYNEWT_VAL(FCB_ELEM_CACHE)
+    os_mutex_pend(&fcb->f_mtx, OS_WAIT_FOREVER);
+    fcb_ec_add(fcb, loc);
+    os_mutex_release(&fcb->f_mtx);
+#endif
     return 0;
 }
@@ -30,6 +30,7 @@ int
 fcb_elem_crc8(struct fcb *fcb, struct fcb_entry *loc, uint8_t *c8p)
 {
     uint8_t tmp_str[FCB_TMP_BUF_SZ];
+    const void *data;
     int cnt;
     int blk_sz;
     uint8_t crc8;
@@ -55,6 +56,13 @@ fcb_elem_crc8(struct fcb *fcb, struct fcb_entry *loc, uint8_t *c8p)
     crc8 = crc8_init();
     crc8 = crc8_calc(crc8, tmp_str, cnt);
 
+    /* Memory-mapped flash is checked in place. */
+    if (flash_area_map(loc->fe_area, loc->fe_data_off, len, &data) == 0) {
+        *c8p = crc8_calc(crc8, data, len);
+        flash_area_unmap(loc->fe_area, data);
+        return 0;
+    }
+
     off = loc->fe_data_off;
     end = loc->fe_data_off + len;
     for (; off < end; off += blk_sz) {
@@ -54,6 +54,15 @@ int fcb_getnext_nolock(struct fcb *fcb, struct fcb_entry *loc);
 int fcb_elem_info(struct fcb *, struct fcb_entry *);
 int fcb_elem_crc8(struct fcb *, struct fcb_entry *loc, uint8_t *crc8p);
 
+#if MYNEWT_VAL(FCB_ERASE_AHEAD)
+void fcb_erase_ahead_kick(struct fcb *fcb);
+#endif
+
+#if MYNEWT_VAL(FCB_ELEM_CACHE)
+void fcb_ec_reset(struct fcb *fcb, struct flash_area *fap);
+void fcb_ec_add(struct fcb *fcb, const struct fcb_entry *loc);
+#endif
+
 int fcb_sector_hdr_init(struct fcb *, struct flash_area *fap, uint16_t id);
 int fcb_sector_hdr_read(struct fcb *, struct flash_area *fap,
   struct fcb_disk_area *fdap);
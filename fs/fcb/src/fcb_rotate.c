@@ -31,11 +31,27 @@ fcb_rotate(struct fcb *fcb)
         return FCB_ERR_ARGS;
     }
 
+#if MYNEWT_VAL(FCB_ERASE_AHEAD)
+    /* Let a background erase finish first, so that the sectors between the
+     * active one and f_oldest stay usable in order.
+     */
+    while (fcb->f_erasing != NULL) {
+        os_mutex_release(&fcb->f_mtx);
+        os_time_delay(1);
+        os_mutex_pend(&fcb->f_mtx, OS_WAIT_FOREVER);
+    }
+#endif
+
     rc = flash_area_erase(fcb->f_oldest, 0, fcb->f_oldest->fa_size);
     if (rc) {
         rc = FCB_ERR_FLASH;
         goto out;
     }
+#if MYNEWT_VAL(FCB_ELEM_CACHE)
+    if (fcb->f_ec_area == fcb->f_oldest) {
+        fcb->f_ec_area = NULL;
+    }
+#endif
     if (fcb->f_oldest == fcb->f_active.fe_area) {
         /*
          * Need to create a new active area, as we're wiping the current.
@@ -48,9 +64,92 @@ fcb_rotate(struct fcb *fcb)
         fcb->f_active.fe_area = fap;
         fcb->f_active.fe_elem_off = sizeof(struct fcb_disk_area);
         fcb->f_active_id++;
+#if MYNEWT_VAL(FCB_ELEM_CACHE)
+        fcb_ec_reset(fcb, fap);
+#endif
     }
     fcb->f_oldest = fcb_getnext_area(fcb, fcb->f_oldest);
 out:
     os_mutex_release(&fcb->f_mtx);
     return rc;
 }
+
+#if MYNEWT_VAL(FCB_ERASE_AHEAD)
+/*
+ * Posts the erase event if fewer than the requested number of sectors are
+ * ready, or if an earlier erase failed.  Called with the FCB locked.
+ */
+void
+fcb_erase_ahead_kick(struct fcb *fcb)
+{
+    if (fcb->f_erase_cnt == 0) {
+        return;
+    }
+    if (fcb->f_erasing != NULL || fcb_free_sector_cnt(fcb) < fcb->f_erase_cnt) {
+        os_eventq_put(fcb->f_erase_evq, &fcb->f_erase_ev);
+    }
+}
+
+static void
+fcb_erase_ahead_ev(struct os_event *ev)
+{
+    struct flash_area *fap;
+    struct fcb *fcb;
+    int rc;
+
+    fcb = ev->ev_arg;
+
+    os_mutex_pend(&fcb->f_mtx, OS_WAIT_FOREVER);
+    while (1) {
+        fap = fcb->f_erasing;
+        if (fap == NULL) {
+            if (fcb->f_erase_cnt == 0 ||
+                fcb_free_sector_cnt(fcb) >= fcb->f_erase_cnt ||
+                fcb->f_oldest == fcb->f_active.fe_area) {
+                break;
+            }
+
+            /* Drop the oldest sector; it is unusable until erased. */
+            fap = fcb->f_oldest;
+            if (fcb->f_drop_cb != NULL) {
+                fcb->f_drop_cb(fcb, fcb->f_drop_arg);
+            }
+            fcb->f_oldest = fcb_getnext_area(fcb, fap);
+            fcb->f_erasing = fap;
+        }
+
+        /* Appends may proceed while the sector erases. */
+        os_mutex_release(&fcb->f_mtx);
+        rc = flash_area_erase(fap, 0, fap->fa_size);
+        os_mutex_pend(&fcb->f_mtx, OS_WAIT_FOREVER);
+
+        if (rc != 0) {
+            /* Keep the sector out of use; the next kick retries it. */
+            break;
+        }
+        fcb->f_erasing = NULL;
+    }
+    os_mutex_release(&fcb->f_mtx);
+}
+
+int
+fcb_erase_ahead_init(struct fcb *fcb, uint8_t cnt, struct os_eventq *evq,
+                     fcb_drop_cb *drop_cb, void *arg)
+{
+    if (cnt >= fcb->f_sector_cnt) {
+        return FCB_ERR_ARGS;
+    }
+
+    os_mutex_pend(&fcb->f_mtx, OS_WAIT_FOREVER);
+    fcb->f_erase_evq = evq;
+    fcb->f_erase_ev.ev_cb = fcb_erase_ahead_ev;
+    fcb->f_erase_ev.ev_arg = fcb;
+    fcb->f_drop_cb = drop_cb;
+    fcb->f_drop_arg = arg;
+    fcb->f_erase_cnt = cnt;
+    fcb_erase_ahead_kick(fcb);
+    os_mutex_release(&fcb->f_mtx);
+
+    return 0;
+}
+#endif
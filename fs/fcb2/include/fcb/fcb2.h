@@ -34,6 +34,7 @@ extern "C" {
 
 #include <syscfg/syscfg.h>
 #include <os/os_mutex.h>
+#include <os/os_eventq.h>
 #include <flash_map/flash_map.h>
 
 #define FCB2_MAX_LEN	(CHAR_MAX | CHAR_MAX << 7) /* Max length of element */
@@ -51,12 +52,21 @@ struct fcb2_entry {
     uint16_t fe_data_len;   /* size of data area */
     uint32_t fe_data_off;   /* start of data in sector */
     uint16_t fe_entry_num;  /* entry number in sector */
+#if MYNEWT_VAL(FCB2_WRITE_COMBINE)
+    struct fcb2 *fe_fcb;    /* owner of entries from fcb2_append() */
+#endif
 };
 
 /* Number of bytes needed for fcb_sector_entry on flash */
 #define FCB2_ENTRY_SIZE          6
 #define FCB2_CRC_LEN             2
 
+/**
+ * Called by erase-ahead just before it drops the data in the oldest sector,
+ * with the FCB locked; fcb->f_oldest_sec still indexes the sector.
+ */
+typedef void fcb2_drop_cb(struct fcb2 *fcb, void *arg);
+
 /**
  * State structure for flash circular buffer version2.
  */
@@ -74,6 +84,25 @@ struct fcb2 {
     struct os_mutex f_mtx;	/* Locking for accessing the FCB data */
     struct fcb2_entry f_active;
     uint16_t f_active_id;
+
+#if MYNEWT_VAL(FCB2_ERASE_AHEAD)
+    /* Background erase state; see fcb2_erase_ahead_init() */
+    uint8_t f_erase_cnt;    /* Number of sectors to keep erased */
+    int f_erasing_sec;      /* Dropped, but not yet erased; -1 if none */
+    struct os_eventq *f_erase_evq;
+    struct os_event f_erase_ev;
+    fcb2_drop_cb *f_drop_cb;
+    void *f_drop_arg;
+#endif
+
+#if MYNEWT_VAL(FCB2_WRITE_COMBINE)
+    /* Element data not yet programmed; see fcb2_flush() */
+    uint16_t f_wc_sector;   /* Sector the buffered data belongs to */
+    uint16_t f_wc_len;      /* Bytes of f_wc_buf in use, 0 if none */
+    uint32_t f_wc_off;      /* Offset in sector of f_wc_buf[0] */
+    uint16_t f_wc_open;     /* Buffered elements not yet finished */
+    uint8_t f_wc_buf[MYNEWT_VAL(FCB2_WRITE_COMBINE_SIZE)];
+#endif
 };
 
 /**
@@ -88,6 +117,7 @@ struct fcb2 {
 #define FCB2_ERR_CRC     -6
 #define FCB2_ERR_MAGIC   -7
 #define FCB2_ERR_VERSION -8
+#define FCB2_ERR_BUSY    -9
 
 
 /**
@@ -158,6 +188,25 @@ int fcb2_write(struct fcb2_entry *loc, uint16_t off, const void *buf,
  */
 int fcb2_append_finish(struct fcb2_entry *append_loc);
 
+/**
+ * Programs finished entries still held in the write-combining buffer.
+ *
+ * With FCB2_WRITE_COMBINE, the data and CRC of small entries are collected
+ * in RAM and programmed to flash together, when the buffer fills, when the
+ * FCB is read or rotated, or when this is called.  Entry headers are
+ * written by fcb2_append() as before, so an entry that is lost to a power
+ * failure before it is flushed reads back as corrupt and is skipped, just
+ * like one whose fcb2_append_finish() was never called.
+ *
+ * Without FCB2_WRITE_COMBINE this does nothing.
+ *
+ * @param fcb            FCB to flush
+ *
+ * @return 0 on success, FCB2_ERR_BUSY if a buffered entry has not been
+ *         finished yet. Otherwise one of FCB2_XXX error codes.
+ */
+int fcb2_flush(struct fcb2 *fcb);
+
 /**
  * Callback routine getting called when walking through FCB entries.
  * Entry data can be read by using fcb2_read().
@@ -230,6 +279,29 @@ int fcb2_read(struct fcb2_entry *loc, uint16_t off, void *buf, uint16_t len);
  */
 int fcb2_rotate(struct fcb2 *fcb);
 
+#if MYNEWT_VAL(FCB2_ERASE_AHEAD)
+/**
+ * Keeps cnt sectors erased ahead of the active one, so that fcb2_append()
+ * can move to a new sector without waiting for an erase.  When fewer
+ * sectors are free, the data in the oldest sector is dropped and the
+ * sector is erased from an event on evq, which should be served by a low
+ * priority task.  The sector being erased does not count as free.
+ *
+ * Call after fcb2_init().  A cnt of 0 turns erase-ahead off again.
+ *
+ * @param fcb            FCB to use
+ * @param cnt            Number of erased sectors to keep ready
+ * @param evq            Event queue to erase from
+ * @param drop_cb        Called before a sector's data is dropped; may be NULL
+ * @param arg            Argument passed to drop_cb
+ *
+ * @return 0 on success, FCB2_ERR_ARGS if cnt would leave no sector for data.
+ */
+int fcb2_erase_ahead_init(struct fcb2 *fcb, uint8_t cnt,
+                          struct os_eventq *evq, fcb2_drop_cb *drop_cb,
+                          void *arg);
+#endif
+
 /**
  * Start using the scratch block.
  *
@@ -142,6 +142,8 @@ TEST_CASE_DECL(fcb_test_multiple_scratch)
 TEST_CASE_DECL(fcb_test_last_of_n)
 TEST_CASE_DECL(fcb_test_area_info)
 TEST_CASE_DECL(fcb_test_getprev)
+TEST_CASE_DECL(fcb_test_erase_ahead)
+TEST_CASE_DECL(fcb_test_write_combine)
 
 TEST_SUITE(fcb_test_all)
 {
@@ -156,6 +158,8 @@ TEST_SUITE(fcb_test_all)
     fcb_test_last_of_n();
     fcb_test_area_info();
     fcb_test_getprev();
+    fcb_test_erase_ahead();
+    fcb_test_write_combine();
 }
 
 int
@@ -0,0 +1,128 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "fcb_test.h"
+
+#if MYNEWT_VAL(FCB2_WRITE_COMBINE)
+static int
+fcb_test_wc_data_empty(struct fcb2_entry *loc)
+{
+    uint8_t buf[4];
+    int rc;
+
+    rc = flash_area_read_is_empty(&loc->fe_range->fsr_flash_area,
+                                  loc->fe_data_off, buf, sizeof(buf));
+    TEST_ASSERT(rc >= 0);
+    return rc;
+}
+
+static int
+fcb_test_wc_walk_cb(struct fcb2_entry *loc, void *arg)
+{
+    uint8_t test_data[4];
+    int rc;
+    int i;
+
+    TEST_ASSERT(loc->fe_data_len == sizeof(test_data));
+    rc = fcb2_read(loc, 0, test_data, sizeof(test_data));
+    TEST_ASSERT(rc == 0);
+    for (i = 0; i < sizeof(test_data); i++) {
+        TEST_ASSERT(test_data[i] == fcb_test_append_data(sizeof(test_data), i));
+    }
+    (*(int *)arg)++;
+    return 0;
+}
+#endif
+
+TEST_CASE_SELF(fcb_test_write_combine)
+{
+#if MYNEWT_VAL(FCB2_WRITE_COMBINE)
+    struct fcb2 *fcb;
+    struct fcb2_entry locs[3];
+    struct fcb2_entry loc;
+    uint8_t test_data[4];
+    int var_cnt;
+    int rc;
+    int i;
+
+    fcb_tc_pretest(2);
+
+    fcb = &test_fcb;
+
+    for (i = 0; i < sizeof(test_data); i++) {
+        test_data[i] = fcb_test_append_data(sizeof(test_data), i);
+    }
+
+    for (i = 0; i < 3; i++) {
+        rc = fcb2_append(fcb, sizeof(test_data), &locs[i]);
+        TEST_ASSERT_FATAL(rc == 0);
+        rc = fcb2_write(&locs[i], 0, test_data, sizeof(test_data));
+        TEST_ASSERT(rc == 0);
+        if (i < 2) {
+            rc = fcb2_append_finish(&locs[i]);
+            TEST_ASSERT(rc == 0);
+        }
+    }
+
+    /*
+     * Nothing is programmed while an entry is still being written.
+     */
+    rc = fcb2_flush(fcb);
+    TEST_ASSERT(rc == FCB2_ERR_BUSY);
+    for (i = 0; i < 3; i++) {
+        TEST_ASSERT(fcb_test_wc_data_empty(&locs[i]) == 1);
+    }
+
+    /*
+     * Finished entries are read from the buffer meanwhile; the open one is
+     * skipped.
+     */
+    var_cnt = 0;
+    rc = fcb2_walk(fcb, FCB2_SECTOR_OLDEST, fcb_test_wc_walk_cb, &var_cnt);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(var_cnt == 2);
+    for (i = 0; i < 3; i++) {
+        TEST_ASSERT(fcb_test_wc_data_empty(&locs[i]) == 1);
+    }
+
+    rc = fcb2_append_finish(&locs[2]);
+    TEST_ASSERT(rc == 0);
+    rc = fcb2_flush(fcb);
+    TEST_ASSERT(rc == 0);
+    for (i = 0; i < 3; i++) {
+        TEST_ASSERT(fcb_test_wc_data_empty(&locs[i]) == 0);
+    }
+
+    /*
+     * Readers flush pending entries before they look at flash.
+     */
+    rc = fcb2_append(fcb, sizeof(test_data), &loc);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = fcb2_write(&loc, 0, test_data, sizeof(test_data));
+    TEST_ASSERT(rc == 0);
+    rc = fcb2_append_finish(&loc);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(fcb_test_wc_data_empty(&loc) == 1);
+
+    var_cnt = 0;
+    rc = fcb2_walk(fcb, FCB2_SECTOR_OLDEST, fcb_test_wc_walk_cb, &var_cnt);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(var_cnt == 4);
+    TEST_ASSERT(fcb_test_wc_data_empty(&loc) == 0);
+#endif
+}
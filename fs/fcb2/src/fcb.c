@@ -86,6 +86,15 @@ fcb2_init(struct fcb2 *fcb)
         fcb2_len_in_flash(newest_srp, sizeof(struct fcb2_disk_area));
     fcb->f_active.fe_entry_num = 0;
     fcb->f_active_id = newest;
+#if MYNEWT_VAL(FCB2_ERASE_AHEAD)
+    fcb->f_erase_cnt = 0;
+    fcb->f_erasing_sec = -1;
+#endif
+#if MYNEWT_VAL(FCB2_WRITE_COMBINE)
+    fcb->f_active.fe_fcb = fcb;
+    fcb->f_wc_len = 0;
+    fcb->f_wc_open = 0;
+#endif
 
     while (1) {
         rc = fcb2_getnext_in_area(fcb, &fcb->f_active);
@@ -114,6 +123,12 @@ fcb2_free_sector_cnt(struct fcb2 *fcb)
             break;
         }
     }
+#if MYNEWT_VAL(FCB2_ERASE_AHEAD)
+    /* The sector being erased is not ready yet. */
+    if (fcb->f_erasing_sec >= 0 && i > 0) {
+        i--;
+    }
+#endif
     return i;
 }
 
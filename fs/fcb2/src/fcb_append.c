@@ -38,6 +38,13 @@ fcb2_new_sector(struct fcb2 *fcb, int cnt)
             new_sector = -1;
             break;
         }
+#if MYNEWT_VAL(FCB2_ERASE_AHEAD)
+        /* Directly precedes f_oldest_sec; not erased yet. */
+        if (sector == fcb->f_erasing_sec) {
+            new_sector = -1;
+            break;
+        }
+#endif
     } while (--cnt >= 0);
 
     return new_sector;
@@ -68,6 +75,9 @@ fcb2_append_to_scratch(struct fcb2 *fcb)
         fcb2_len_in_flash(range, sizeof(struct fcb2_disk_area));
     fcb->f_active.fe_entry_num = 1;
     fcb->f_active_id++;
+#if MYNEWT_VAL(FCB2_ERASE_AHEAD)
+    fcb2_erase_ahead_kick(fcb);
+#endif
     return FCB2_OK;
 }
 
@@ -104,10 +114,32 @@ fcb2_read_from_sector(struct fcb2_entry *loc, int off, void *buf, int len)
     if (off + len > loc->fe_range->fsr_sector_size) {
         len = loc->fe_range->fsr_sector_size - off;
     }
+#if MYNEWT_VAL(FCB2_WRITE_COMBINE)
+    if (fcb2_wc_read(loc, off, buf, len)) {
+        return 0;
+    }
+#endif
     return flash_area_read(&loc->fe_range->fsr_flash_area,
         fcb2_sector_flash_offset(loc) + off, buf, len);
 }
 
+int
+fcb2_map_from_sector(struct fcb2_entry *loc, int off, int len,
+                     const void **ptr)
+{
+    if (off + len > loc->fe_range->fsr_sector_size) {
+        return FCB2_ERR_ARGS;
+    }
+#if MYNEWT_VAL(FCB2_WRITE_COMBINE)
+    /* Not on flash yet; read it through the buffer instead. */
+    if (fcb2_wc_read(loc, off, NULL, len)) {
+        return FCB2_ERR_ARGS;
+    }
+#endif
+    return flash_area_map(&loc->fe_range->fsr_flash_area,
+        fcb2_sector_flash_offset(loc) + off, len, ptr);
+}
+
 int
 fcb2_entry_location_in_range(const struct fcb2_entry *loc)
 {
@@ -137,6 +169,11 @@ fcb2_write(struct fcb2_entry *loc, uint16_t off, const void *buf, uint16_t len)
     if (off + len > loc->fe_data_len) {
         len = loc->fe_data_len - off;
     }
+#if MYNEWT_VAL(FCB2_WRITE_COMBINE)
+    if (fcb2_wc_write(loc, pos, buf, len)) {
+        return 0;
+    }
+#endif
     return fcb2_write_to_sector(loc, pos, buf, len);
 }
 
@@ -203,10 +240,21 @@ fcb2_append(struct fcb2 *fcb, uint16_t len, struct fcb2_entry *append_loc)
         fcb->f_active.fe_entry_num = 1;
         fcb->f_active.fe_data_len = 0;
         fcb->f_active_id++;
+#if MYNEWT_VAL(FCB2_ERASE_AHEAD)
+        fcb2_erase_ahead_kick(fcb);
+#endif
     } else {
         range = active->fe_range;
     }
 
+#if MYNEWT_VAL(FCB2_WRITE_COMBINE)
+    /* Must not fail once the entry header is on flash. */
+    rc = fcb2_wc_make_room(fcb, fcb2_element_length_in_flash(active, len));
+    if (rc) {
+        goto err;
+    }
+#endif
+
     /* Write new entry at the end of the sector */
     flash_entry[0] = (uint8_t)(fcb->f_active.fe_data_off >> 16);
     flash_entry[1] = (uint8_t)(fcb->f_active.fe_data_off >> 8);
@@ -225,6 +273,9 @@ fcb2_append(struct fcb2 *fcb, uint16_t len, struct fcb2_entry *append_loc)
     *append_loc = *active;
     /* Active element had everything ready except lenght */
     append_loc->fe_data_len = len;
+#if MYNEWT_VAL(FCB2_WRITE_COMBINE)
+    fcb2_wc_add(fcb, append_loc, fcb2_element_length_in_flash(active, len));
+#endif
 
     /* Prepare active element num and offset for new append */
     active->fe_data_off += fcb2_element_length_in_flash(active, len);
@@ -246,6 +297,12 @@ fcb2_append_finish(struct fcb2_entry *loc)
     uint8_t fl_crc[2];
     uint32_t off;
 
+#if MYNEWT_VAL(FCB2_WRITE_COMBINE)
+    if (fcb2_wc_finish(loc)) {
+        return 0;
+    }
+#endif
+
     rc = fcb2_elem_crc16(loc, &crc);
     if (rc) {
         return rc;
@@ -30,6 +30,7 @@ int
 fcb2_elem_crc16(struct fcb2_entry *loc, uint16_t *c16p)
 {
     uint8_t tmp_str[FCB2_TMP_BUF_SZ];
+    const void *data;
     int blk_sz;
     uint16_t crc16;
     uint32_t off;
@@ -38,6 +39,14 @@ fcb2_elem_crc16(struct fcb2_entry *loc, uint16_t *c16p)
 
     crc16 = 0xFFFF;
 
+    /* Memory-mapped flash is checked in place. */
+    if (fcb2_map_from_sector(loc, loc->fe_data_off, loc->fe_data_len,
+                             &data) == 0) {
+        *c16p = crc16_ccitt(crc16, data, loc->fe_data_len);
+        flash_area_unmap(&loc->fe_range->fsr_flash_area, data);
+        return 0;
+    }
+
     off = loc->fe_data_off;
     end = loc->fe_data_off + loc->fe_data_len;
     for (; off < end; off += blk_sz) {
@@ -57,7 +66,10 @@ fcb2_elem_crc16(struct fcb2_entry *loc, uint16_t *c16p)
     return 0;
 }
 
-static int
+/*
+ * Reads and checks the entry header only, without the data CRC.
+ */
+int
 fcb2_read_entry(struct fcb2_entry *loc)
 {
     uint8_t buf[FCB2_ENTRY_SIZE];
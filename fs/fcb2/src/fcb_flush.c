@@ -0,0 +1,229 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <string.h>
+
+#include <crc/crc16.h>
+
+#include "fcb/fcb2.h"
+#include "fcb_priv.h"
+
+#if MYNEWT_VAL(FCB2_WRITE_COMBINE)
+/*
+ * Element data and CRCs of consecutive entries in one sector are collected
+ * in fcb->f_wc_buf, and programmed with a single write.  The buffer is only
+ * programmed once none of its entries is still being filled, so no part of
+ * flash gets written twice.  Until then, reads through entries that carry
+ * fe_fcb are served from the buffer.
+ */
+
+static int
+fcb2_wc_holds(const struct fcb2 *fcb, const struct fcb2_entry *loc)
+{
+    return fcb->f_wc_len != 0 && loc->fe_sector == fcb->f_wc_sector &&
+           loc->fe_data_off >= fcb->f_wc_off &&
+           loc->fe_data_off < fcb->f_wc_off + fcb->f_wc_len;
+}
+
+/*
+ * Returns 1 if len bytes at off in the sector of loc are buffered, and were
+ * copied from RAM.  With buf NULL, only tells whether they are.
+ */
+int
+fcb2_wc_read(struct fcb2_entry *loc, int off, void *buf, int len)
+{
+    struct fcb2 *fcb;
+    int held;
+
+    fcb = loc->fe_fcb;
+    if (fcb == NULL) {
+        return 0;
+    }
+
+    os_mutex_pend(&fcb->f_mtx, OS_WAIT_FOREVER);
+    held = fcb->f_wc_len != 0 && loc->fe_sector == fcb->f_wc_sector &&
+           off >= fcb->f_wc_off && off + len <= fcb->f_wc_off + fcb->f_wc_len;
+    if (held && buf != NULL) {
+        memcpy(buf, fcb->f_wc_buf + (off - fcb->f_wc_off), len);
+    }
+    os_mutex_release(&fcb->f_mtx);
+
+    return held;
+}
+
+int
+fcb2_wc_flush_nolock(struct fcb2 *fcb)
+{
+    struct fcb2_entry loc;
+    int rc;
+
+    if (fcb->f_wc_len == 0) {
+        return 0;
+    }
+    if (fcb->f_wc_open != 0) {
+        return FCB2_ERR_BUSY;
+    }
+
+    loc.fe_sector = fcb->f_wc_sector;
+    loc.fe_range = fcb2_get_sector_range(fcb, loc.fe_sector);
+    rc = fcb2_write_to_sector(&loc, fcb->f_wc_off, fcb->f_wc_buf,
+                              fcb->f_wc_len);
+    fcb->f_wc_len = 0;
+    if (rc) {
+        return FCB2_ERR_FLASH;
+    }
+    return 0;
+}
+
+/*
+ * Called by fcb2_append() before an entry of elem_len bytes is placed at
+ * the active location.  Flushes the buffer unless the entry extends it.
+ */
+int
+fcb2_wc_make_room(struct fcb2 *fcb, int elem_len)
+{
+    const struct fcb2_entry *active;
+    int rc;
+
+    if (fcb->f_wc_len == 0) {
+        return 0;
+    }
+
+    active = &fcb->f_active;
+    if (active->fe_sector == fcb->f_wc_sector &&
+        active->fe_data_off == fcb->f_wc_off + fcb->f_wc_len &&
+        fcb->f_wc_len + elem_len <= sizeof(fcb->f_wc_buf)) {
+        return 0;
+    }
+
+    rc = fcb2_wc_flush_nolock(fcb);
+    if (rc == FCB2_ERR_BUSY) {
+        /* The new entry is written directly instead. */
+        rc = 0;
+    }
+    return rc;
+}
+
+void
+fcb2_wc_add(struct fcb2 *fcb, const struct fcb2_entry *loc, int elem_len)
+{
+    if (fcb->f_wc_len == 0) {
+        if (elem_len > sizeof(fcb->f_wc_buf)) {
+            return;
+        }
+        fcb->f_wc_sector = loc->fe_sector;
+        fcb->f_wc_off = loc->fe_data_off;
+        memset(fcb->f_wc_buf,
+               flash_area_erased_val(&loc->fe_range->fsr_flash_area),
+               sizeof(fcb->f_wc_buf));
+    } else if (loc->fe_sector != fcb->f_wc_sector ||
+               loc->fe_data_off != fcb->f_wc_off + fcb->f_wc_len ||
+               fcb->f_wc_len + elem_len > sizeof(fcb->f_wc_buf)) {
+        return;
+    }
+    fcb->f_wc_len += elem_len;
+    fcb->f_wc_open++;
+}
+
+/*
+ * Returns 1 if the entry is buffered, and the data was copied to RAM.
+ */
+int
+fcb2_wc_write(struct fcb2_entry *loc, int off, const void *buf, int len)
+{
+    struct fcb2 *fcb;
+    int held;
+
+    fcb = loc->fe_fcb;
+    if (fcb == NULL) {
+        return 0;
+    }
+
+    os_mutex_pend(&fcb->f_mtx, OS_WAIT_FOREVER);
+    held = fcb2_wc_holds(fcb, loc);
+    if (held) {
+        memcpy(fcb->f_wc_buf + (off - fcb->f_wc_off), buf, len);
+    }
+    os_mutex_release(&fcb->f_mtx);
+
+    return held;
+}
+
+/*
+ * Returns 1 if the entry is buffered, and its CRC was added in RAM.
+ */
+int
+fcb2_wc_finish(struct fcb2_entry *loc)
+{
+    struct fcb2 *fcb;
+    uint16_t crc;
+    uint8_t *data;
+    int held;
+
+    fcb = loc->fe_fcb;
+    if (fcb == NULL) {
+        return 0;
+    }
+
+    os_mutex_pend(&fcb->f_mtx, OS_WAIT_FOREVER);
+    held = fcb2_wc_holds(fcb, loc);
+    if (held) {
+        data = fcb->f_wc_buf + (loc->fe_data_off - fcb->f_wc_off);
+        crc = crc16_ccitt(0xFFFF, data, loc->fe_data_len);
+        put_be16(data + fcb2_len_in_flash(loc->fe_range, loc->fe_data_len),
+                 crc);
+        if (fcb->f_wc_open > 0) {
+            fcb->f_wc_open--;
+        }
+    }
+    os_mutex_release(&fcb->f_mtx);
+
+    return held;
+}
+
+/*
+ * Sector is about to be erased; buffered data for it is of no use.
+ */
+void
+fcb2_wc_discard_sector(struct fcb2 *fcb, int sector)
+{
+    if (fcb->f_wc_len != 0 && fcb->f_wc_sector == sector) {
+        fcb->f_wc_len = 0;
+        fcb->f_wc_open = 0;
+    }
+}
+#endif
+
+int
+fcb2_flush(struct fcb2 *fcb)
+{
+#if MYNEWT_VAL(FCB2_WRITE_COMBINE)
+    int rc;
+
+    rc = os_mutex_pend(&fcb->f_mtx, OS_WAIT_FOREVER);
+    if (rc && rc != OS_NOT_STARTED) {
+        return FCB2_ERR_ARGS;
+    }
+    rc = fcb2_wc_flush_nolock(fcb);
+    os_mutex_release(&fcb->f_mtx);
+
+    return rc;
+#else
+    return 0;
+#endif
+}
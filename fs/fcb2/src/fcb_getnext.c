@@ -47,6 +47,15 @@ fcb2_getnext_nolock(struct fcb2 *fcb, struct fcb2_entry *loc)
 {
     int rc;
 
+#if MYNEWT_VAL(FCB2_WRITE_COMBINE)
+    /*
+     * Program finished entries if none is open; otherwise they are read
+     * from the buffer through loc.
+     */
+    (void)fcb2_wc_flush_nolock(fcb);
+    loc->fe_fcb = fcb;
+#endif
+
     if (loc->fe_range == NULL) {
         /*
          * Find the first one we have in flash.
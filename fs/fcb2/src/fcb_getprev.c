@@ -21,39 +21,48 @@
 #include "fcb/fcb2.h"
 #include "fcb_priv.h"
 
+/*
+ * Entry headers are written one after another from the end of the sector,
+ * so the used ones are found with a binary search for the first empty one.
+ * Then step back to the newest entry with valid data.
+ */
 static int
 fcb2_sector_find_last(struct fcb2 *fcb, struct fcb2_entry *loc)
 {
+    const struct flash_sector_range *range = loc->fe_range;
+    int used;
+    int empty;
+    int mid;
     int rc;
-    int last_valid = 0;
 
-    loc->fe_entry_num = 1;
+    used = 0;
+    empty = (range->fsr_sector_size -
+             fcb2_len_in_flash(range, sizeof(struct fcb2_disk_area))) /
+            fcb2_len_in_flash(range, FCB2_ENTRY_SIZE) + 1;
+    while (empty - used > 1) {
+        mid = used + (empty - used) / 2;
+        loc->fe_entry_num = mid;
+        rc = fcb2_read_entry(loc);
+        if (rc == FCB2_ERR_NOVAR) {
+            empty = mid;
+        } else {
+            used = mid;
+        }
+    }
 
-    do {
+    for (; used > 0; used--) {
+        loc->fe_entry_num = used;
         rc = fcb2_elem_info(loc);
         if (rc == 0) {
-            last_valid = loc->fe_entry_num;
-        }
-        if (rc == FCB2_ERR_NOVAR) {
-            /*
-             * Out entries in this sector
-             */
-            if (last_valid == 0) {
-                loc->fe_entry_num = 1;
-                /*
-                 * No valid entries in this sector.
-                 */
-                return FCB2_ERR_NOVAR;
-            } else {
-                loc->fe_entry_num = last_valid;
-                rc = fcb2_elem_info(loc);
-                assert(rc == 0); /* must be; just succeeded a bit earlier */
-                return rc;
-            }
+            return 0;
         }
-        loc->fe_entry_num++;
-    } while (1);
-    return rc;
+    }
+
+    /*
+     * No valid entries in this sector.
+     */
+    loc->fe_entry_num = 1;
+    return FCB2_ERR_NOVAR;
 }
 
 int
@@ -65,12 +74,18 @@ fcb2_getprev(struct fcb2 *fcb, struct fcb2_entry *loc)
     if (rc && rc != OS_NOT_STARTED) {
         return FCB2_ERR_ARGS;
     }
+#if MYNEWT_VAL(FCB2_WRITE_COMBINE)
+    (void)fcb2_wc_flush_nolock(fcb);
+#endif
     if (loc->fe_range == NULL) {
         /*
          * Find the last element.
          */
         *loc = fcb->f_active;
     }
+#if MYNEWT_VAL(FCB2_WRITE_COMBINE)
+    loc->fe_fcb = fcb;
+#endif
      while (1) {
         loc->fe_entry_num--;
         if (loc->fe_entry_num < 1) {
@@ -78,7 +93,8 @@ fcb2_getprev(struct fcb2 *fcb, struct fcb2_entry *loc)
              * Need to get from previous sector.
              */
             if (loc->fe_sector == fcb->f_oldest_sec) {
-                return FCB2_ERR_NOVAR;
+                rc = FCB2_ERR_NOVAR;
+                break;
             }
             if (loc->fe_sector == 0) {
                 loc->fe_sector = fcb->f_sector_cnt - 1;
@@ -63,8 +63,23 @@ fcb2_getnext_sector(struct fcb2 *fcb, int sector)
 int fcb2_getnext_nolock(struct fcb2 *fcb, struct fcb2_entry *loc);
 
 int fcb2_elem_info(struct fcb2_entry *loc);
+int fcb2_read_entry(struct fcb2_entry *loc);
 int fcb2_elem_crc16(struct fcb2_entry *loc, uint16_t *c16p);
 int fcb2_sector_hdr_init(struct fcb2 *fcb, int sector, uint16_t id);
+
+#if MYNEWT_VAL(FCB2_ERASE_AHEAD)
+void fcb2_erase_ahead_kick(struct fcb2 *fcb);
+#endif
+
+#if MYNEWT_VAL(FCB2_WRITE_COMBINE)
+int fcb2_wc_flush_nolock(struct fcb2 *fcb);
+int fcb2_wc_make_room(struct fcb2 *fcb, int elem_len);
+void fcb2_wc_add(struct fcb2 *fcb, const struct fcb2_entry *loc, int elem_len);
+int fcb2_wc_write(struct fcb2_entry *loc, int off, const void *buf, int len);
+int fcb2_wc_read(struct fcb2_entry *loc, int off, void *buf, int len);
+int fcb2_wc_finish(struct fcb2_entry *loc);
+void fcb2_wc_discard_sector(struct fcb2 *fcb, int sector);
+#endif
 int fcb2_entry_location_in_range(const struct fcb2_entry *loc);
 
 struct flash_sector_range *fcb2_get_sector_range(const struct fcb2 *fcb,
@@ -118,6 +133,19 @@ int fcb2_write_to_sector(struct fcb2_entry *loc, int off,
  */
 int fcb2_read_from_sector(struct fcb2_entry *loc, int off, void *buf, int len);
 
+/**
+ * @brief Get direct read access to data in fcb sector.
+ *
+ * @param loc     location of the sector from fcb2_get_sector_loc().
+ * @param off     offset from the beginning of the sector
+ * @param len     number of bytes to access
+ * @param ptr     set to where the data can be read in place
+ *
+ * @return 0 on success, non zero if the flash is not memory-mapped.
+ */
+int fcb2_map_from_sector(struct fcb2_entry *loc, int off, int len,
+                         const void **ptr);
+
 #ifdef __cplusplus
 }
 #endif
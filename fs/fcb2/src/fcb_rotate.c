@@ -32,6 +32,23 @@ fcb2_rotate(struct fcb2 *fcb)
         return FCB2_ERR_ARGS;
     }
 
+#if MYNEWT_VAL(FCB2_ERASE_AHEAD)
+    /* Let a background erase finish first, so that the sectors between the
+     * active one and f_oldest_sec stay usable in order.
+     */
+    while (fcb->f_erasing_sec >= 0) {
+        os_mutex_release(&fcb->f_mtx);
+        os_time_delay(1);
+        os_mutex_pend(&fcb->f_mtx, OS_WAIT_FOREVER);
+    }
+#endif
+
+#if MYNEWT_VAL(FCB2_WRITE_COMBINE)
+    /* Newer entries must be on flash before older ones are erased. */
+    fcb2_wc_discard_sector(fcb, fcb->f_oldest_sec);
+    (void)fcb2_wc_flush_nolock(fcb);
+#endif
+
     rc = fcb2_sector_erase(fcb, fcb->f_oldest_sec);
     if (rc) {
         rc = FCB2_ERR_FLASH;
@@ -61,3 +78,86 @@ out:
     os_mutex_release(&fcb->f_mtx);
     return rc;
 }
+
+#if MYNEWT_VAL(FCB2_ERASE_AHEAD)
+/*
+ * Posts the erase event if fewer than the requested number of sectors are
+ * ready, or if an earlier erase failed.  Called with the FCB locked.
+ */
+void
+fcb2_erase_ahead_kick(struct fcb2 *fcb)
+{
+    if (fcb->f_erase_cnt == 0) {
+        return;
+    }
+    if (fcb->f_erasing_sec >= 0 || fcb2_free_sector_cnt(fcb) < fcb->f_erase_cnt) {
+        os_eventq_put(fcb->f_erase_evq, &fcb->f_erase_ev);
+    }
+}
+
+static void
+fcb2_erase_ahead_ev(struct os_event *ev)
+{
+    struct fcb2 *fcb;
+    int sector;
+    int rc;
+
+    fcb = ev->ev_arg;
+
+    os_mutex_pend(&fcb->f_mtx, OS_WAIT_FOREVER);
+    while (1) {
+        sector = fcb->f_erasing_sec;
+        if (sector < 0) {
+            if (fcb->f_erase_cnt == 0 ||
+                fcb2_free_sector_cnt(fcb) >= fcb->f_erase_cnt ||
+                fcb->f_oldest_sec == fcb->f_active.fe_sector) {
+                break;
+            }
+
+            /* Drop the oldest sector; it is unusable until erased. */
+            sector = fcb->f_oldest_sec;
+            if (fcb->f_drop_cb != NULL) {
+                fcb->f_drop_cb(fcb, fcb->f_drop_arg);
+            }
+            fcb->f_oldest_sec = fcb2_getnext_sector(fcb, sector);
+            fcb->f_erasing_sec = sector;
+#if MYNEWT_VAL(FCB2_WRITE_COMBINE)
+            fcb2_wc_discard_sector(fcb, sector);
+#endif
+        }
+
+        /* Appends may proceed while the sector erases. */
+        os_mutex_release(&fcb->f_mtx);
+        rc = fcb2_sector_erase(fcb, sector);
+        os_mutex_pend(&fcb->f_mtx, OS_WAIT_FOREVER);
+
+        if (rc != 0) {
+            /* Keep the sector out of use; the next kick retries it. */
+            break;
+        }
+        fcb->f_erasing_sec = -1;
+    }
+    os_mutex_release(&fcb->f_mtx);
+}
+
+int
+fcb2_erase_ahead_init(struct fcb2 *fcb, uint8_t cnt, struct os_eventq *evq,
+                      fcb2_drop_cb *drop_cb, void *arg)
+{
+    if (cnt >= fcb->f_sector_cnt) {
+        return FCB2_ERR_ARGS;
+    }
+
+    os_mutex_pend(&fcb->f_mtx, OS_WAIT_FOREVER);
+    fcb->f_erase_evq = evq;
+    fcb->f_erase_ev.ev_cb = fcb2_erase_ahead_ev;
+    fcb->f_erase_ev.ev_arg = fcb;
+    fcb->f_drop_cb = drop_cb;
+    fcb->f_drop_arg = arg;
+    fcb->f_erase_cnt = cnt;
+    fcb2_erase_ahead_kick(fcb);
+    os_mutex_release(&fcb->f_mtx);
+
+    return 0;
+}
+#endif
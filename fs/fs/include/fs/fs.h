@@ -22,6 +22,7 @@
 
 #include <stddef.h>
 #include <inttypes.h>
+#include "os/mynewt.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -34,6 +35,15 @@ struct fs_file;
 struct fs_dir;
 struct fs_dirent;
 
+/*
+ * One piece of a vectored read or write.  Same layout as struct
+ * os_mbuf_iovec.
+ */
+struct fs_iovec {
+    void *iov_base;
+    size_t iov_len;
+};
+
 int fs_open(const char *filename, uint8_t access_flags, struct fs_file **);
 int fs_close(struct fs_file *);
 int fs_read(struct fs_file *, uint32_t len, void *out_data, uint32_t *out_len);
@@ -42,6 +52,46 @@ int fs_seek(struct fs_file *, uint32_t offset);
 uint32_t fs_getpos(const struct fs_file *);
 int fs_filelen(const struct fs_file *, uint32_t *out_len);
 
+/**
+ * Writes the pieces of iov, in order, at the current offset.  File
+ * systems that support it do this in a single operation; the others get
+ * one fs_write() per piece.
+ *
+ * @return 0 on success, FS_E[...] on failure
+ */
+int fs_writev(struct fs_file *, const struct fs_iovec *iov, int iovcnt);
+
+/**
+ * Reads into the pieces of iov, in order, from the current offset.
+ * Stops early at the end of the file.
+ *
+ * @param out_len       Total number of bytes read
+ *
+ * @return 0 on success, FS_E[...] on failure
+ */
+int fs_readv(struct fs_file *, const struct fs_iovec *iov, int iovcnt,
+             uint32_t *out_len);
+
+/**
+ * Writes the contents of an mbuf chain at the current offset, without
+ * first copying it into a flat buffer.
+ *
+ * @return 0 on success, FS_E[...] on failure
+ */
+int fs_write_mbuf(struct fs_file *, const struct os_mbuf *om);
+
+/**
+ * Reads up to len bytes from the current offset, appending them to an
+ * mbuf chain.  Mbufs are added to the chain from its pool as needed.
+ *
+ * @param out_len       Number of bytes appended
+ *
+ * @return 0 on success, FS_ENOMEM if the pool ran out (out_len bytes
+ *         were still appended), other FS_E[...] on failure
+ */
+int fs_read_mbuf(struct fs_file *, uint32_t len, struct os_mbuf *om,
+                 uint32_t *out_len);
+
 int fs_unlink(const char *filename);
 int fs_rename(const char *from, const char *to);
 int fs_mkdir(const char *path);
@@ -79,6 +129,70 @@ int fs_dirent_is_dir(const struct fs_dirent *);
 #define FS_EACCESS      12  /* Operation prohibited by file open mode */
 #define FS_EUNINIT      13  /* File system not initialized */
 
+#if MYNEWT_VAL(FS_ASYNC)
+/**
+ * Asynchronous request types, see struct fs_req.
+ */
+#define FS_REQ_READV        1
+#define FS_REQ_WRITEV       2
+#define FS_REQ_READ_MBUF    3
+#define FS_REQ_WRITE_MBUF   4
+
+/**
+ * @struct fs_req
+ * @brief Asynchronous file operation, see fs_submit()
+ *
+ * @var fs_req::op
+ * FS_REQ_[...]; the operation is the fs_readv(), fs_writev(),
+ * fs_read_mbuf() or fs_write_mbuf() call of the same name
+ *
+ * @var fs_req::iov
+ * Pieces to read into or write for FS_REQ_READV and FS_REQ_WRITEV
+ *
+ * @var fs_req::om
+ * Chain to append to or write for FS_REQ_READ_MBUF and FS_REQ_WRITE_MBUF
+ *
+ * @var fs_req::len
+ * Number of bytes to read for FS_REQ_READ_MBUF
+ *
+ * @var fs_req::rc
+ * Result of the operation, set when the request completes
+ *
+ * @var fs_req::out_len
+ * Number of bytes read, set when a read request completes
+ *
+ * @var fs_req::ev
+ * Completion event, ev_cb must be set by the caller; ev_arg is not used
+ *
+ * @var fs_req::evq
+ * Event queue to post completion event to, or NULL to call ev_cb directly
+ * from the file system task
+ */
+struct fs_req {
+    uint8_t op;
+    struct fs_file *file;
+    const struct fs_iovec *iov;
+    int iovcnt;
+    struct os_mbuf *om;
+    uint32_t len;
+    int rc;
+    uint32_t out_len;
+    struct os_event ev;
+    struct os_eventq *evq;
+    struct fs_req *next;
+};
+
+/**
+ * Queues a file operation and returns immediately.  Requests are run one
+ * after another by the file system task, in order of submission, so
+ * several writes to the same file can be queued back to back.  The file,
+ * buffers and chain must not be touched until the request completes.
+ *
+ * @return 0 on success, FS_EINVAL if the request is not valid
+ */
+int fs_submit(struct fs_req *req);
+#endif
+
 #define FS_MGMT_ID_FILE     0
 
 #define FS_MGMT_MAX_NAME    64
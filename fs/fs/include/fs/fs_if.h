@@ -36,6 +36,11 @@ struct fs_ops {
     int (*f_read)(struct fs_file *file, uint32_t len, void *out_data,
       uint32_t *out_len);
     int (*f_write)(struct fs_file *file, const void *data, int len);
+    /* Optional; fs_readv() and fs_writev() fall back to f_read and f_write */
+    int (*f_readv)(struct fs_file *file, const struct fs_iovec *iov,
+      int iovcnt, uint32_t *out_len);
+    int (*f_writev)(struct fs_file *file, const struct fs_iovec *iov,
+      int iovcnt);
 
     int (*f_seek)(struct fs_file *file, uint32_t offset);
     uint32_t (*f_getpos)(const struct fs_file *file);
@@ -0,0 +1,140 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(FS_ASYNC)
+#include <fs/fs.h>
+
+static struct os_task fs_async_task;
+static struct os_eventq fs_async_evq;
+OS_TASK_STACK_DEFINE(fs_async_stack, MYNEWT_VAL(FS_ASYNC_STACK_SIZE));
+
+static struct fs_req *fs_async_head;
+static struct fs_req *fs_async_tail;
+static struct os_event fs_async_ev;
+
+static void
+fs_async_task_handler(void *arg)
+{
+    while (1) {
+        os_eventq_run(&fs_async_evq);
+    }
+}
+
+/*
+ * Runs the oldest request.  Remaining requests are run from subsequent
+ * events, so that the task's queue stays responsive.
+ */
+static void
+fs_async_run(struct os_event *ev)
+{
+    struct fs_req *req;
+    bool more;
+    int sr;
+
+    OS_ENTER_CRITICAL(sr);
+    req = fs_async_head;
+    if (req) {
+        fs_async_head = req->next;
+        if (!fs_async_head) {
+            fs_async_tail = NULL;
+        }
+    }
+    more = fs_async_head != NULL;
+    OS_EXIT_CRITICAL(sr);
+
+    if (!req) {
+        return;
+    }
+
+    switch (req->op) {
+    case FS_REQ_READV:
+        req->rc = fs_readv(req->file, req->iov, req->iovcnt, &req->out_len);
+        break;
+    case FS_REQ_WRITEV:
+        req->rc = fs_writev(req->file, req->iov, req->iovcnt);
+        break;
+    case FS_REQ_READ_MBUF:
+        req->rc = fs_read_mbuf(req->file, req->len, req->om, &req->out_len);
+        break;
+    default:
+        req->rc = fs_write_mbuf(req->file, req->om);
+        break;
+    }
+
+    if (more) {
+        os_eventq_put(&fs_async_evq, &fs_async_ev);
+    }
+
+    if (req->evq) {
+        os_eventq_put(req->evq, &req->ev);
+    } else {
+        req->ev.ev_cb(&req->ev);
+    }
+}
+
+int
+fs_submit(struct fs_req *req)
+{
+    int sr;
+
+    if (req->op < FS_REQ_READV || req->op > FS_REQ_WRITE_MBUF ||
+        req->file == NULL || req->ev.ev_cb == NULL) {
+        return FS_EINVAL;
+    }
+    if ((req->op == FS_REQ_READ_MBUF || req->op == FS_REQ_WRITE_MBUF) &&
+        req->om == NULL) {
+        return FS_EINVAL;
+    }
+
+    req->next = NULL;
+    req->rc = 0;
+    req->out_len = 0;
+
+    OS_ENTER_CRITICAL(sr);
+    if (fs_async_tail) {
+        fs_async_tail->next = req;
+    } else {
+        fs_async_head = req;
+    }
+    fs_async_tail = req;
+    OS_EXIT_CRITICAL(sr);
+
+    os_eventq_put(&fs_async_evq, &fs_async_ev);
+
+    return 0;
+}
+
+void
+fs_async_pkg_init(void)
+{
+    int rc;
+
+    /* Ensure this function only gets called by sysinit. */
+    SYSINIT_ASSERT_ACTIVE();
+
+    fs_async_ev.ev_cb = fs_async_run;
+    os_eventq_init(&fs_async_evq);
+    rc = os_task_init(&fs_async_task, "fs", fs_async_task_handler, NULL,
+                      MYNEWT_VAL(FS_ASYNC_TASK_PRIO), OS_WAIT_FOREVER,
+                      fs_async_stack, MYNEWT_VAL(FS_ASYNC_STACK_SIZE));
+    SYSINIT_PANIC_ASSERT(rc == 0);
+}
+#endif /* MYNEWT_VAL(FS_ASYNC) */
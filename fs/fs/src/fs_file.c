@@ -19,7 +19,6 @@
 #include <fs/fs.h>
 #include <fs/fs_if.h>
 
-#include <disk/disk.h>
 #include <string.h>
 #include <stdlib.h>
 
@@ -152,25 +151,14 @@ safe_fs_ops_for(const char *fs_name)
 struct fs_ops *
 fops_from_filename(const char *filename)
 {
-    char *disk;
-    char *fs_name = NULL;
-    struct fs_ops *unique;
-
-    disk = disk_name_from_path(filename);
-    if (disk) {
-        fs_name = disk_fs_for(disk);
-        free(disk);
-    } else {
-        /**
-         * special case: if only one fs was ever registered,
-         * return that fs' ops.
-         */
-        if ((unique = fs_ops_try_unique()) != NULL) {
-            return unique;
-        }
+    struct fs_ops *fops;
+
+    fops = fs_ops_for_path(filename);
+    if (fops == NULL) {
+        fops = &not_initialized_ops;
     }
 
-    return safe_fs_ops_for(fs_name);
+    return fops;
 }
 
 static inline struct fs_ops *
@@ -207,6 +195,128 @@ fs_write(struct fs_file *file, const void *data, int len)
     return fops->f_write(file, data, len);
 }
 
+int
+fs_writev(struct fs_file *file, const struct fs_iovec *iov, int iovcnt)
+{
+    struct fs_ops *fops = fops_from_file(file);
+    int rc;
+    int i;
+
+    if (fops->f_writev) {
+        return fops->f_writev(file, iov, iovcnt);
+    }
+
+    for (i = 0; i < iovcnt; i++) {
+        rc = fops->f_write(file, iov[i].iov_base, iov[i].iov_len);
+        if (rc != 0) {
+            return rc;
+        }
+    }
+    return 0;
+}
+
+int
+fs_readv(struct fs_file *file, const struct fs_iovec *iov, int iovcnt,
+         uint32_t *out_len)
+{
+    struct fs_ops *fops = fops_from_file(file);
+    uint32_t len;
+    int rc;
+    int i;
+
+    if (fops->f_readv) {
+        return fops->f_readv(file, iov, iovcnt, out_len);
+    }
+
+    *out_len = 0;
+    for (i = 0; i < iovcnt; i++) {
+        rc = fops->f_read(file, iov[i].iov_len, iov[i].iov_base, &len);
+        if (rc != 0) {
+            return rc;
+        }
+        *out_len += len;
+        if (len < iov[i].iov_len) {
+            break;
+        }
+    }
+    return 0;
+}
+
+/* Pieces of an mbuf chain passed to fs_writev() at a time. */
+#define FS_MBUF_IOV_CNT     8
+
+int
+fs_write_mbuf(struct fs_file *file, const struct os_mbuf *om)
+{
+    struct fs_iovec iov[FS_MBUF_IOV_CNT];
+    int cnt;
+    int rc;
+
+    while (om != NULL) {
+        cnt = 0;
+        while (om != NULL && cnt < FS_MBUF_IOV_CNT) {
+            if (om->om_len > 0) {
+                iov[cnt].iov_base = om->om_data;
+                iov[cnt].iov_len = om->om_len;
+                cnt++;
+            }
+            om = SLIST_NEXT(om, om_next);
+        }
+        if (cnt > 0) {
+            rc = fs_writev(file, iov, cnt);
+            if (rc != 0) {
+                return rc;
+            }
+        }
+    }
+    return 0;
+}
+
+int
+fs_read_mbuf(struct fs_file *file, uint32_t len, struct os_mbuf *om,
+             uint32_t *out_len)
+{
+    struct os_mbuf *last;
+    uint32_t chunk;
+    uint32_t got;
+    void *dst;
+    int rc;
+
+    *out_len = 0;
+    while (len > 0) {
+        last = om;
+        while (SLIST_NEXT(last, om_next) != NULL) {
+            last = SLIST_NEXT(last, om_next);
+        }
+
+        /* Fill the last mbuf, or a new one, directly from the file. */
+        chunk = OS_MBUF_TRAILINGSPACE(last);
+        if (chunk == 0) {
+            chunk = om->om_omp->omp_databuf_len;
+        }
+        chunk = min(chunk, len);
+
+        dst = os_mbuf_extend(om, chunk);
+        if (dst == NULL) {
+            return FS_ENOMEM;
+        }
+
+        rc = fs_read(file, chunk, dst, &got);
+        if (rc != 0) {
+            os_mbuf_adj(om, -(int)chunk);
+            return rc;
+        }
+        *out_len += got;
+        len -= got;
+
+        if (got < chunk) {
+            os_mbuf_adj(om, -(int)(chunk - got));
+            break;
+        }
+    }
+    return 0;
+}
+
 int
 fs_seek(struct fs_file *file, uint32_t offset)
 {
@@ -20,6 +20,7 @@
 #include "fs/fs.h"
 #include "fs/fs_if.h"
 #include "fs_priv.h"
+#include <disk/disk.h>
 #include <string.h>
 
 #if MYNEWT_VAL(FS_MGMT)
@@ -28,6 +29,19 @@
 
 static SLIST_HEAD(, fs_ops) root_fops = SLIST_HEAD_INITIALIZER();
 
+/*
+ * Mount table: the file system of each disk seen so far, keyed by the file
+ * system name that disk_fs_for_path() returns.  That string is the one
+ * stored by disk_register(), so a pointer comparison finds the entry.
+ * File systems are never unregistered, so entries never go stale.
+ */
+#define FS_MOUNT_TABLE_SIZE     4
+
+static struct fs_mount {
+    const char *fm_fs_name;
+    struct fs_ops *fm_fops;
+} fs_mount_table[FS_MOUNT_TABLE_SIZE];
+
 #if MYNEWT_VAL(FS_CLI)
 static uint8_t g_cli_initialized;
 #endif
@@ -96,6 +110,49 @@ fs_ops_for(const char *fs_name)
     return fops;
 }
 
+struct fs_ops *
+fs_ops_for_path(const char *path)
+{
+    struct fs_mount *fm;
+    struct fs_ops *fops;
+    const char *fs_name;
+    int i;
+
+    if (disk_prefix_len(path) == 0) {
+        /**
+         * special case: if only one fs was ever registered,
+         * return that fs' ops.
+         */
+        fops = fs_ops_try_unique();
+        if (fops != NULL) {
+            return fops;
+        }
+    }
+
+    fs_name = disk_fs_for_path(path);
+    if (fs_name == NULL) {
+        return NULL;
+    }
+
+    for (i = 0; i < FS_MOUNT_TABLE_SIZE; i++) {
+        fm = &fs_mount_table[i];
+        if (fm->fm_fs_name == fs_name) {
+            return fm->fm_fops;
+        }
+        if (fm->fm_fs_name == NULL) {
+            break;
+        }
+    }
+
+    fops = fs_ops_for(fs_name);
+    if (fops != NULL && i < FS_MOUNT_TABLE_SIZE) {
+        fm->fm_fops = fops;
+        fm->fm_fs_name = fs_name;
+    }
+
+    return fops;
+}
+
 struct fs_ops not_initialized_ops;
 
 struct fs_ops *
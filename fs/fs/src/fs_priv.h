@@ -28,6 +28,7 @@ extern "C" {
 struct fs_ops;
 struct fs_ops *fs_ops_for(const char *fs_name);
 struct fs_ops *safe_fs_ops_for(const char *fs_name);
+struct fs_ops *fs_ops_for_path(const char *path);
 
 #if MYNEWT_VAL(FS_CLI)
 void fs_cli_init(void);
@@ -22,6 +22,7 @@
 
 #include <stddef.h>
 #include <inttypes.h>
+#include "syscfg/syscfg.h"
 #include "fs/fs.h"
 
 #ifdef __cplusplus
@@ -65,6 +66,16 @@ int nffs_format(const struct nffs_area_desc *area_descs);
 
 int nffs_misc_desc_from_flash_area(int idx, int *cnt, struct nffs_area_desc *nad);
 
+#if MYNEWT_VAL(NFFS_CKPT)
+int nffs_checkpoint_init(const struct nffs_area_desc *ckpt_desc);
+int nffs_checkpoint(void);
+#endif
+
+#if MYNEWT_VAL(NFFS_GC_BG)
+struct os_eventq;
+int nffs_gc_bg_init(uint32_t reserve, struct os_eventq *evq);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
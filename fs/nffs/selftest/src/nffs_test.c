@@ -70,8 +70,17 @@ struct nffs_area_desc *save_area_descs;
 static void
 nffs_testcase_pre(void* arg)
 {
+#if MYNEWT_VAL(NFFS_CKPT)
+    static const struct nffs_area_desc no_ckpt = { 0 };
+#endif
+
     save_area_descs = nffs_current_area_descs;
     nffs_current_area_descs = nffs_selftest_area_descs;
+
+#if MYNEWT_VAL(NFFS_CKPT)
+    /* The sysinit checkpoint region overlaps the test areas. */
+    nffs_checkpoint_init(&no_ckpt);
+#endif
 }
 
 TEST_CASE_DECL(nffs_test_unlink)
@@ -79,6 +88,7 @@ TEST_CASE_DECL(nffs_test_mkdir)
 TEST_CASE_DECL(nffs_test_rename)
 TEST_CASE_DECL(nffs_test_truncate)
 TEST_CASE_DECL(nffs_test_append)
+TEST_CASE_DECL(nffs_test_writev)
 TEST_CASE_DECL(nffs_test_read)
 TEST_CASE_DECL(nffs_test_open)
 TEST_CASE_DECL(nffs_test_overwrite_one)
@@ -100,6 +110,12 @@ TEST_CASE_DECL(nffs_test_readdir)
 TEST_CASE_DECL(nffs_test_split_file)
 TEST_CASE_DECL(nffs_test_gc_on_oom)
 TEST_CASE_DECL(nffs_test_cache_large_file)
+TEST_CASE_DECL(nffs_test_checkpoint)
+TEST_CASE_DECL(nffs_test_hash_grow)
+TEST_CASE_DECL(nffs_test_gc_bg)
+TEST_CASE_DECL(nffs_test_data_cache)
+TEST_CASE_DECL(nffs_test_write_buf)
+TEST_CASE_DECL(nffs_test_path_cache)
 
 static void
 nffs_test_basic_cases(void)
@@ -109,6 +125,7 @@ nffs_test_basic_cases(void)
     nffs_test_rename();
     nffs_test_truncate();
     nffs_test_append();
+    nffs_test_writev();
     nffs_test_read();
     nffs_test_open();
     nffs_test_overwrite_one();
@@ -129,6 +146,12 @@ nffs_test_basic_cases(void)
     nffs_test_readdir();
     nffs_test_split_file();
     nffs_test_gc_on_oom();
+    nffs_test_checkpoint();
+    nffs_test_hash_grow();
+    nffs_test_gc_bg();
+    nffs_test_data_cache();
+    nffs_test_write_buf();
+    nffs_test_path_cache();
 }
 
 TEST_SUITE(nffs_test_suite_1_1)
@@ -0,0 +1,163 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "nffs_test_utils.h"
+
+#if MYNEWT_VAL(NFFS_CKPT)
+static const struct nffs_area_desc nffs_test_ckpt_desc = {
+    0x00080000, 128 * 1024
+};
+
+static void
+nffs_test_ckpt_read_hdr(struct nffs_disk_ckpt *out_hdr)
+{
+    int rc;
+
+    rc = hal_flash_read(nffs_test_ckpt_desc.nad_flash_id,
+                        nffs_test_ckpt_desc.nad_offset, out_hdr,
+                        sizeof *out_hdr);
+    TEST_ASSERT_FATAL(rc == 0);
+}
+
+static void
+nffs_test_ckpt_assert_files(int num_files)
+{
+    struct fs_file *file;
+    char filename[16];
+    int rc;
+    int i;
+
+    nffs_test_util_assert_contents("/b", "bbbbcccc", 8);
+    nffs_test_util_assert_contents("/dir/c", "c", 1);
+
+    rc = fs_open("/dir/a", FS_ACCESS_READ, &file);
+    TEST_ASSERT(rc == FS_ENOENT);
+
+    for (i = 0; i < num_files; i++) {
+        sprintf(filename, "/dir/f%d", i);
+        nffs_test_util_assert_contents(filename, filename, strlen(filename));
+    }
+}
+
+static void
+nffs_test_ckpt_reboot(const struct nffs_area_desc *area_descs)
+{
+    int rc;
+
+    rc = nffs_misc_reset();
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = nffs_detect(area_descs);
+    TEST_ASSERT_FATAL(rc == 0);
+}
+#endif
+
+TEST_CASE_SELF(nffs_test_checkpoint)
+{
+#if MYNEWT_VAL(NFFS_CKPT)
+    static const struct nffs_area_desc area_descs[] = {
+        { 0x00020000, 128 * 1024 },
+        { 0x00040000, 128 * 1024 },
+        { 0x00060000, 128 * 1024 },
+        { 0, 0 },
+    };
+    static const struct nffs_area_desc no_ckpt_desc = { 0, 0 };
+    struct nffs_test_block_desc blocks[2] = { {
+        .data = "bb",
+        .data_len = 2,
+    }, {
+        .data = "bb",
+        .data_len = 2,
+    } };
+    struct nffs_disk_ckpt hdr;
+    char filename[16];
+    uint32_t gen;
+    int rc;
+    int i;
+
+    rc = nffs_checkpoint_init(&nffs_test_ckpt_desc);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /* Formatting discards any previous checkpoint. */
+    rc = nffs_format(area_descs);
+    TEST_ASSERT_FATAL(rc == 0);
+    nffs_test_ckpt_read_hdr(&hdr);
+    TEST_ASSERT(hdr.ndc_magic != NFFS_CKPT_MAGIC);
+
+    rc = fs_mkdir("/dir");
+    TEST_ASSERT(rc == 0);
+    nffs_test_util_create_file("/dir/a", "a", 1);
+    nffs_test_util_create_file_blocks("/b", blocks, 2);
+
+    rc = nffs_checkpoint();
+    TEST_ASSERT_FATAL(rc == 0);
+    nffs_test_ckpt_read_hdr(&hdr);
+    TEST_ASSERT_FATAL(hdr.ndc_magic == NFFS_CKPT_MAGIC);
+    gen = hdr.ndc_gen;
+
+    /* Objects written after the checkpoint are found by scanning from the
+     * checkpointed end of each area.
+     */
+    nffs_test_util_append_file("/b", "cccc", 4);
+    rc = fs_unlink("/dir/a");
+    TEST_ASSERT(rc == 0);
+    nffs_test_util_create_file("/dir/c", "c", 1);
+
+    nffs_test_ckpt_reboot(area_descs);
+    nffs_test_ckpt_assert_files(0);
+
+    /* Too little was scanned to warrant a new checkpoint. */
+    nffs_test_ckpt_read_hdr(&hdr);
+    TEST_ASSERT(hdr.ndc_gen == gen);
+
+    /* Garbage collection rewrites an area; that area is scanned in full. */
+    rc = nffs_gc(NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+    nffs_test_ckpt_reboot(area_descs);
+    nffs_test_ckpt_assert_files(0);
+
+    /* A damaged checkpoint is ignored.  Scanning everything writes a fresh
+     * one, which the next restore uses.
+     */
+    for (i = 0; i < MYNEWT_VAL(NFFS_CKPT_REFRESH_CNT); i++) {
+        sprintf(filename, "/dir/f%d", i);
+        nffs_test_util_create_file(filename, filename, strlen(filename));
+    }
+    rc = hal_flash_erase(nffs_test_ckpt_desc.nad_flash_id,
+                         nffs_test_ckpt_desc.nad_offset,
+                         nffs_test_ckpt_desc.nad_length);
+    TEST_ASSERT_FATAL(rc == 0);
+    hdr.ndc_crc16++;
+    rc = hal_flash_write(nffs_test_ckpt_desc.nad_flash_id,
+                         nffs_test_ckpt_desc.nad_offset, &hdr, sizeof hdr);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    nffs_test_ckpt_reboot(area_descs);
+    nffs_test_ckpt_assert_files(MYNEWT_VAL(NFFS_CKPT_REFRESH_CNT));
+    nffs_test_ckpt_read_hdr(&hdr);
+    TEST_ASSERT(hdr.ndc_magic == NFFS_CKPT_MAGIC);
+    TEST_ASSERT(hdr.ndc_gen == gen + 1);
+
+    nffs_test_ckpt_reboot(area_descs);
+    nffs_test_ckpt_assert_files(MYNEWT_VAL(NFFS_CKPT_REFRESH_CNT));
+
+    /* The region overlaps the areas used by other tests. */
+    rc = nffs_checkpoint_init(&no_ckpt_desc);
+    TEST_ASSERT(rc == 0);
+#endif
+}
@@ -0,0 +1,169 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "nffs_test_utils.h"
+
+#if MYNEWT_VAL(NFFS_DATA_CACHE_PAGES)
+/**
+ * Reads a file in small, unaligned pieces so that most reads are served from
+ * the data cache, and verifies the contents.
+ */
+static void
+nffs_test_data_cache_read_pieces(const char *filename, const char *contents,
+                                 int len)
+{
+    static char buf[4096];
+    struct fs_file *file;
+    uint32_t bytes_read;
+    int off;
+    int rc;
+
+    rc = fs_open(filename, FS_ACCESS_READ, &file);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    for (off = 0; off < len; off += bytes_read) {
+        rc = fs_read(file, 37, buf + off, &bytes_read);
+        TEST_ASSERT_FATAL(rc == 0);
+        TEST_ASSERT_FATAL(bytes_read > 0);
+    }
+    TEST_ASSERT(off == len);
+    TEST_ASSERT(memcmp(buf, contents, len) == 0);
+
+    rc = fs_close(file);
+    TEST_ASSERT(rc == 0);
+}
+#endif
+
+TEST_CASE_SELF(nffs_test_data_cache)
+{
+#if MYNEWT_VAL(NFFS_DATA_CACHE_PAGES)
+    static char data[1024];
+    struct fs_file *file;
+    int rc;
+    int i;
+
+    rc = nffs_format(nffs_current_area_descs);
+    TEST_ASSERT(rc == 0);
+
+    for (i = 0; i < sizeof data; i++) {
+        data[i] = i * 7;
+    }
+    nffs_test_util_create_file("/myfile.txt", data, sizeof data);
+    nffs_test_data_cache_read_pieces("/myfile.txt", data, sizeof data);
+
+    /*** Overwritten data is read from its new location. */
+    memset(data + 300, 'x', 100);
+    rc = fs_open("/myfile.txt", FS_ACCESS_WRITE, &file);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = fs_seek(file, 300);
+    TEST_ASSERT(rc == 0);
+    rc = fs_write(file, data + 300, 100);
+    TEST_ASSERT(rc == 0);
+    rc = fs_close(file);
+    TEST_ASSERT(rc == 0);
+    nffs_test_data_cache_read_pieces("/myfile.txt", data, sizeof data);
+
+    /*** Cached pages do not survive garbage collection of their area. */
+    for (i = 0; i < nffs_num_areas; i++) {
+        rc = nffs_gc(NULL);
+        TEST_ASSERT(rc == 0);
+    }
+    nffs_test_data_cache_read_pieces("/myfile.txt", data, sizeof data);
+
+    /*** Nor a format. */
+    rc = nffs_format(nffs_current_area_descs);
+    TEST_ASSERT(rc == 0);
+    memset(data, 'y', sizeof data);
+    nffs_test_util_create_file("/myfile.txt", data, sizeof data);
+    nffs_test_data_cache_read_pieces("/myfile.txt", data, sizeof data);
+    nffs_test_util_assert_contents("/myfile.txt", data, sizeof data);
+#endif
+}
+
+TEST_CASE_SELF(nffs_test_write_buf)
+{
+#if MYNEWT_VAL(NFFS_WRITE_BUF_SIZE)
+    struct fs_file *file;
+    uint32_t bytes_read;
+    char buf[16];
+    int rc;
+
+    rc = nffs_format(nffs_current_area_descs);
+    TEST_ASSERT(rc == 0);
+
+    /*** Small appends are coalesced into a single block. */
+    rc = fs_open("/myfile.txt", FS_ACCESS_WRITE, &file);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = fs_write(file, "abc", 3);
+    TEST_ASSERT(rc == 0);
+    rc = fs_write(file, "def", 3);
+    TEST_ASSERT(rc == 0);
+    rc = fs_write(file, "ghi", 3);
+    TEST_ASSERT(rc == 0);
+    nffs_test_util_assert_file_len(file, 9);
+    rc = fs_close(file);
+    TEST_ASSERT(rc == 0);
+
+    nffs_test_util_assert_block_count("/myfile.txt", 1);
+    nffs_test_util_assert_contents("/myfile.txt", "abcdefghi", 9);
+
+    /*** Buffered data is visible to readers of the same file. */
+    rc = fs_open("/myfile.txt", FS_ACCESS_WRITE | FS_ACCESS_READ |
+                                FS_ACCESS_APPEND, &file);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = fs_write(file, "jkl", 3);
+    TEST_ASSERT(rc == 0);
+    rc = fs_seek(file, 6);
+    TEST_ASSERT(rc == 0);
+    rc = fs_read(file, sizeof buf, buf, &bytes_read);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(bytes_read == 6);
+    TEST_ASSERT(memcmp(buf, "ghijkl", 6) == 0);
+
+    /*** A write to another file flushes the buffer first. */
+    nffs_test_util_create_file("/other.txt", "zz", 2);
+    nffs_test_util_assert_block_count("/myfile.txt", 2);
+
+    /*** Non-appending writes see the buffered data. */
+    rc = fs_write(file, "mno", 3);
+    TEST_ASSERT(rc == 0);
+    rc = fs_close(file);
+    TEST_ASSERT(rc == 0);
+
+    rc = fs_open("/myfile.txt", FS_ACCESS_WRITE, &file);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = fs_seek(file, 10);
+    TEST_ASSERT(rc == 0);
+    rc = fs_write(file, "KLMN", 4);
+    TEST_ASSERT(rc == 0);
+    rc = fs_close(file);
+    TEST_ASSERT(rc == 0);
+
+    nffs_test_util_assert_contents("/myfile.txt", "abcdefghijKLMNo", 15);
+    nffs_test_util_assert_contents("/other.txt", "zz", 2);
+
+    /*** All of the data made it to flash. */
+    rc = nffs_misc_reset();
+    TEST_ASSERT(rc == 0);
+    rc = nffs_detect(nffs_current_area_descs);
+    TEST_ASSERT(rc == 0);
+
+    nffs_test_util_assert_contents("/myfile.txt", "abcdefghijKLMNo", 15);
+    nffs_test_util_assert_contents("/other.txt", "zz", 2);
+#endif
+}
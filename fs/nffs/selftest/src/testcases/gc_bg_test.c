@@ -0,0 +1,181 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "nffs_test_utils.h"
+
+#if MYNEWT_VAL(NFFS_GC_BG)
+static struct os_eventq nffs_test_gc_bg_evq;
+
+static uint32_t
+nffs_test_gc_bg_free_space(void)
+{
+    uint32_t space;
+    int i;
+
+    space = 0;
+    for (i = 0; i < nffs_num_areas; i++) {
+        if (i != nffs_scratch_area_idx && i != nffs_gc_from_area_idx) {
+            space += nffs_areas[i].na_length - nffs_areas[i].na_cur;
+        }
+    }
+
+    return space;
+}
+
+/**
+ * Runs background gc events until the queue is empty or, if stop_at_copy is
+ * set, until a cycle starts copying objects.
+ */
+static void
+nffs_test_gc_bg_run(int stop_at_copy)
+{
+    struct os_event *ev;
+    int i;
+
+    for (i = 0; i < 100000; i++) {
+        if (stop_at_copy && nffs_gc_from_area_idx != NFFS_AREA_ID_NONE) {
+            return;
+        }
+
+        ev = os_eventq_get_no_wait(&nffs_test_gc_bg_evq);
+        if (ev == NULL) {
+            return;
+        }
+        ev->ev_cb(ev);
+    }
+
+    TEST_ASSERT_FATAL(0);
+}
+
+static void
+nffs_test_gc_bg_make_garbage(const char *filename, char *data, int len)
+{
+    int i;
+
+    for (i = 0; i < 16; i++) {
+        memset(data, 'a' + i, len);
+        nffs_test_util_create_file(filename, data, len);
+    }
+}
+#endif
+
+TEST_CASE_SELF(nffs_test_gc_bg)
+{
+#if MYNEWT_VAL(NFFS_GC_BG)
+    static const struct nffs_area_desc area_descs_three[] = {
+        { 0x00020000, 128 * 1024 },
+        { 0x00040000, 128 * 1024 },
+        { 0x00060000, 128 * 1024 },
+        { 0, 0 },
+    };
+    static char data[4096];
+    struct nffs_inode_entry *inode_entry;
+    unsigned int gc_count;
+    uint32_t area_offset;
+    uint32_t reserve;
+    uint8_t from_area_idx;
+    uint8_t area_idx;
+    int rc;
+
+    rc = nffs_format(area_descs_three);
+    TEST_ASSERT(rc == 0);
+
+    os_eventq_init(&nffs_test_gc_bg_evq);
+
+    nffs_test_util_create_file("/keep", "keep", 4);
+    nffs_test_gc_bg_make_garbage("/a", data, sizeof data);
+
+    /*** Nothing happens while there is enough free space. */
+    gc_count = nffs_gc_count;
+    rc = nffs_gc_bg_init(1024, &nffs_test_gc_bg_evq);
+    TEST_ASSERT(rc == 0);
+    nffs_test_gc_bg_run(0);
+    TEST_ASSERT(nffs_gc_count == gc_count);
+
+    /*** Raising the reserve starts a cycle on the area holding garbage;
+     * foreground writes are kept out of it while it is copied.
+     */
+    reserve = nffs_test_gc_bg_free_space() + 1;
+    rc = nffs_gc_bg_init(reserve, &nffs_test_gc_bg_evq);
+    TEST_ASSERT(rc == 0);
+
+    nffs_test_gc_bg_run(1);
+    from_area_idx = nffs_gc_from_area_idx;
+    TEST_ASSERT_FATAL(from_area_idx != NFFS_AREA_ID_NONE);
+    TEST_ASSERT(nffs_gc_count == gc_count);
+
+    nffs_test_util_create_file("/b", "bbbb", 4);
+    inode_entry = nffs_hash_find_inode(nffs_hash_next_file_id - 1);
+    TEST_ASSERT_FATAL(inode_entry != NULL);
+    nffs_flash_loc_expand(inode_entry->nie_hash_entry.nhe_flash_loc,
+                          &area_idx, &area_offset);
+    TEST_ASSERT(area_idx != from_area_idx);
+    TEST_ASSERT(area_idx != nffs_scratch_area_idx);
+
+    nffs_test_gc_bg_run(0);
+    TEST_ASSERT(nffs_gc_count == gc_count + 1);
+    TEST_ASSERT(nffs_gc_from_area_idx == NFFS_AREA_ID_NONE);
+    TEST_ASSERT(nffs_scratch_area_idx == from_area_idx);
+    TEST_ASSERT(nffs_test_gc_bg_free_space() >= reserve);
+
+    /*** A synchronous gc completes the background cycle in progress. */
+    nffs_test_gc_bg_make_garbage("/a", data, sizeof data);
+    reserve = nffs_test_gc_bg_free_space() + 1;
+    rc = nffs_gc_bg_init(reserve, &nffs_test_gc_bg_evq);
+    TEST_ASSERT(rc == 0);
+
+    gc_count = nffs_gc_count;
+    nffs_test_gc_bg_run(1);
+    from_area_idx = nffs_gc_from_area_idx;
+    TEST_ASSERT_FATAL(from_area_idx != NFFS_AREA_ID_NONE);
+
+    rc = nffs_gc(NULL);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(nffs_gc_count == gc_count + 1);
+    TEST_ASSERT(nffs_gc_from_area_idx == NFFS_AREA_ID_NONE);
+    TEST_ASSERT(nffs_scratch_area_idx == from_area_idx);
+
+    rc = nffs_gc_bg_init(0, NULL);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(os_eventq_get_no_wait(&nffs_test_gc_bg_evq) == NULL);
+
+    struct nffs_test_file_desc *expected_system =
+        (struct nffs_test_file_desc[]) { {
+            .filename = "",
+            .is_dir = 1,
+            .children = (struct nffs_test_file_desc[]) { {
+                .filename = "keep",
+                .contents = "keep",
+                .contents_len = 4,
+            }, {
+                .filename = "a",
+                .contents = data,
+                .contents_len = sizeof data,
+            }, {
+                .filename = "b",
+                .contents = "bbbb",
+                .contents_len = 4,
+            }, {
+                .filename = NULL,
+            } },
+    } };
+
+    nffs_test_assert_system(expected_system, area_descs_three);
+#endif
+}
@@ -0,0 +1,108 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "nffs_test_utils.h"
+
+#define NFFS_TEST_HASH_NUM_FILES    300
+
+static void
+nffs_test_hash_assert_load(void)
+{
+    struct nffs_hash_stats stats;
+
+    nffs_hash_stats(&stats);
+
+    /* Every file has an inode and a data block. */
+    TEST_ASSERT(stats.nhs_num_entries >= NFFS_TEST_HASH_NUM_FILES * 2);
+    TEST_ASSERT(stats.nhs_num_buckets > NFFS_HASH_SIZE);
+    TEST_ASSERT(stats.nhs_num_entries <=
+                stats.nhs_num_buckets * MYNEWT_VAL(NFFS_HASH_MAX_LOAD));
+    TEST_ASSERT(stats.nhs_max_chain <= MYNEWT_VAL(NFFS_HASH_MAX_LOAD) * 2);
+}
+
+static void
+nffs_test_hash_assert_files(void)
+{
+    char filename[32];
+    int i;
+
+    for (i = 0; i < NFFS_TEST_HASH_NUM_FILES; i++) {
+        snprintf(filename, sizeof filename, "/d/f%d", i);
+        nffs_test_util_assert_contents(filename, filename, strlen(filename));
+    }
+}
+
+TEST_CASE_SELF(nffs_test_hash_grow)
+{
+#if MYNEWT_VAL(NFFS_HASH_MAX_LOAD)
+    char filename[32];
+    int rc;
+    int i;
+
+    /*** Setup. */
+    nffs_config.nc_num_inodes = 1024;
+    nffs_config.nc_num_blocks = 1024;
+
+    rc = nffs_init();
+    TEST_ASSERT(rc == 0);
+
+    rc = nffs_format(nffs_current_area_descs);
+    TEST_ASSERT(rc == 0);
+
+    rc = fs_mkdir("/d");
+    TEST_ASSERT(rc == 0);
+
+    /*** Grow the table by inserting objects. */
+    for (i = 0; i < NFFS_TEST_HASH_NUM_FILES; i++) {
+        snprintf(filename, sizeof filename, "/d/f%d", i);
+        nffs_test_util_create_file(filename, filename, strlen(filename));
+    }
+
+    nffs_test_hash_assert_load();
+    nffs_test_hash_assert_files();
+
+    /*** Grow the table while restoring. */
+    rc = nffs_misc_reset();
+    TEST_ASSERT(rc == 0);
+    rc = nffs_detect(nffs_current_area_descs);
+    TEST_ASSERT(rc == 0);
+
+    nffs_test_hash_assert_load();
+    nffs_test_hash_assert_files();
+
+    /*** Ensure the table survives garbage collection. */
+    rc = nffs_gc(NULL);
+    TEST_ASSERT(rc == 0);
+
+    nffs_test_hash_assert_load();
+    nffs_test_hash_assert_files();
+
+    /*** Removed entries are no longer found. */
+    rc = fs_unlink("/d");
+    TEST_ASSERT(rc == 0);
+
+    struct nffs_test_file_desc *expected_system =
+        (struct nffs_test_file_desc[]) { {
+            .filename = "",
+            .is_dir = 1,
+    } };
+
+    nffs_test_assert_system(expected_system, nffs_current_area_descs);
+#endif
+}
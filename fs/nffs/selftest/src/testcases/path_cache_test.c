@@ -0,0 +1,112 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "nffs_test_utils.h"
+
+static struct nffs_inode_entry *
+nffs_test_path_cache_lookup(const char *path)
+{
+    struct nffs_inode_entry *inode_entry;
+    int rc;
+
+    rc = nffs_path_find_inode_entry(path, &inode_entry);
+    if (rc != 0) {
+        TEST_ASSERT(rc == FS_ENOENT);
+        return NULL;
+    }
+
+    return inode_entry;
+}
+
+TEST_CASE_SELF(nffs_test_path_cache)
+{
+    struct nffs_inode_entry *inode_entry;
+    struct fs_file *file;
+    char path[32];
+    int rc;
+    int i;
+
+    rc = nffs_format(nffs_current_area_descs);
+    TEST_ASSERT(rc == 0);
+
+    rc = fs_mkdir("/a");
+    TEST_ASSERT(rc == 0);
+    rc = fs_mkdir("/a/b");
+    TEST_ASSERT(rc == 0);
+    rc = fs_mkdir("/a/b/c");
+    TEST_ASSERT(rc == 0);
+
+    /*** Repeated lookups find the same inode, also after it is evicted. */
+    nffs_test_util_create_file("/a/b/c/f1", "1", 1);
+    inode_entry = nffs_test_path_cache_lookup("/a/b/c/f1");
+    TEST_ASSERT_FATAL(inode_entry != NULL);
+    TEST_ASSERT(nffs_test_path_cache_lookup("/a/b/c/f1") == inode_entry);
+
+    for (i = 0; i < 8; i++) {
+        sprintf(path, "/a/b/c/g%d", i);
+        nffs_test_util_create_file(path, "g", 1);
+        TEST_ASSERT(nffs_test_path_cache_lookup(path) != NULL);
+    }
+    TEST_ASSERT(nffs_test_path_cache_lookup("/a/b/c/f1") == inode_entry);
+
+    /*** Names with the same hash are told apart. */
+    nffs_test_util_create_file("/a/Ab", "Ab", 2);
+    nffs_test_util_create_file("/a/BA", "BA", 2);
+    TEST_ASSERT(nffs_test_path_cache_lookup("/a/Ab") != NULL);
+    TEST_ASSERT(nffs_test_path_cache_lookup("/a/BA") != NULL);
+    TEST_ASSERT(nffs_test_path_cache_lookup("/a/Ab") !=
+                nffs_test_path_cache_lookup("/a/BA"));
+    nffs_test_util_assert_contents("/a/Ab", "Ab", 2);
+    nffs_test_util_assert_contents("/a/BA", "BA", 2);
+
+    /*** A renamed file is only found under its new name. */
+    rc = fs_rename("/a/b/c/f1", "/a/b/c/f2");
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(nffs_test_path_cache_lookup("/a/b/c/f1") == NULL);
+    TEST_ASSERT(nffs_test_path_cache_lookup("/a/b/c/f2") == inode_entry);
+
+    /*** An unlinked file that is still open is no longer found. */
+    rc = fs_open("/a/b/c/f2", FS_ACCESS_READ, &file);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = fs_unlink("/a/b/c/f2");
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(nffs_test_path_cache_lookup("/a/b/c/f2") == NULL);
+    rc = fs_close(file);
+    TEST_ASSERT(rc == 0);
+
+    /*** Moving a directory moves its cached descendants with it. */
+    TEST_ASSERT(nffs_test_path_cache_lookup("/a/b/c/g0") != NULL);
+    rc = fs_rename("/a/b", "/a/x");
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(nffs_test_path_cache_lookup("/a/b/c/g0") == NULL);
+    TEST_ASSERT(nffs_test_path_cache_lookup("/a/x/c/g0") != NULL);
+
+    rc = fs_mkdir("/a/b");
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(nffs_test_path_cache_lookup("/a/b/c") == NULL);
+    TEST_ASSERT(nffs_test_path_cache_lookup("/a/b") != NULL);
+
+    /*** Removing a directory drops the entries below it. */
+    rc = fs_unlink("/a/x");
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(nffs_test_path_cache_lookup("/a/x/c/g0") == NULL);
+    TEST_ASSERT(nffs_test_path_cache_lookup("/a/x") == NULL);
+
+    nffs_test_util_create_file("/a/x", "x", 1);
+    nffs_test_util_assert_contents("/a/x", "x", 1);
+}
@@ -0,0 +1,69 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "nffs_test_utils.h"
+
+TEST_CASE_SELF(nffs_test_writev)
+{
+    struct fs_iovec iov[3];
+    struct fs_file *file;
+    uint32_t len;
+    char buf[3][8];
+    int rc;
+
+    rc = nffs_format(nffs_current_area_descs);
+    TEST_ASSERT(rc == 0);
+
+    rc = fs_open("/myfile.txt", FS_ACCESS_WRITE, &file);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    iov[0].iov_base = "abc";
+    iov[0].iov_len = 3;
+    iov[1].iov_base = "";
+    iov[1].iov_len = 0;
+    iov[2].iov_base = "defghij";
+    iov[2].iov_len = 7;
+    rc = fs_writev(file, iov, 3);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(fs_getpos(file) == 10);
+    rc = fs_close(file);
+    TEST_ASSERT(rc == 0);
+
+    nffs_test_util_assert_contents("/myfile.txt", "abcdefghij", 10);
+
+    /*** Read back in pieces; the last one is cut short by the end of file. */
+    rc = fs_open("/myfile.txt", FS_ACCESS_READ, &file);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    iov[0].iov_base = buf[0];
+    iov[0].iov_len = 4;
+    iov[1].iov_base = buf[1];
+    iov[1].iov_len = 4;
+    iov[2].iov_base = buf[2];
+    iov[2].iov_len = 8;
+    rc = fs_readv(file, iov, 3, &len);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(len == 10);
+    TEST_ASSERT(memcmp(buf[0], "abcd", 4) == 0);
+    TEST_ASSERT(memcmp(buf[1], "efgh", 4) == 0);
+    TEST_ASSERT(memcmp(buf[2], "ij", 2) == 0);
+
+    rc = fs_close(file);
+    TEST_ASSERT(rc == 0);
+}
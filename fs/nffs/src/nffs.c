@@ -63,6 +63,10 @@ static int nffs_close(struct fs_file *fs_file);
 static int nffs_read(struct fs_file *fs_file, uint32_t len, void *out_data,
   uint32_t *out_len);
 static int nffs_write(struct fs_file *fs_file, const void *data, int len);
+static int nffs_readv(struct fs_file *fs_file, const struct fs_iovec *iov,
+  int iovcnt, uint32_t *out_len);
+static int nffs_writev(struct fs_file *fs_file, const struct fs_iovec *iov,
+  int iovcnt);
 static int nffs_seek(struct fs_file *fs_file, uint32_t offset);
 static uint32_t nffs_getpos(const struct fs_file *fs_file);
 static int nffs_file_len(const struct fs_file *fs_file, uint32_t *out_len);
@@ -81,6 +85,8 @@ struct fs_ops nffs_ops = {
     .f_close = nffs_close,
     .f_read = nffs_read,
     .f_write = nffs_write,
+    .f_readv = nffs_readv,
+    .f_writev = nffs_writev,
 
     .f_seek = nffs_seek,
     .f_getpos = nffs_getpos,
@@ -104,6 +110,7 @@ STATS_SECT_DECL(nffs_stats) nffs_stats;
 STATS_NAME_START(nffs_stats)
     STATS_NAME(nffs_stats, nffs_hashcnt_ins)
     STATS_NAME(nffs_stats, nffs_hashcnt_rm)
+    STATS_NAME(nffs_stats, nffs_hashcnt_split)
     STATS_NAME(nffs_stats, nffs_object_count)
     STATS_NAME(nffs_stats, nffs_iocnt_read)
     STATS_NAME(nffs_stats, nffs_iocnt_write)
@@ -121,6 +128,12 @@ STATS_NAME_START(nffs_stats)
     STATS_NAME(nffs_stats, nffs_readcnt_filename)
     STATS_NAME(nffs_stats, nffs_readcnt_object)
     STATS_NAME(nffs_stats, nffs_readcnt_detect)
+    STATS_NAME(nffs_stats, nffs_dcache_hit)
+    STATS_NAME(nffs_stats, nffs_dcache_miss)
+    STATS_NAME(nffs_stats, nffs_dcache_readahead)
+    STATS_NAME(nffs_stats, nffs_wbuf_flush)
+    STATS_NAME(nffs_stats, nffs_pcache_hit)
+    STATS_NAME(nffs_stats, nffs_pcache_miss)
 STATS_NAME_END(nffs_stats)
 
 static void
@@ -188,7 +201,6 @@ nffs_open(const char *path, uint8_t access_flags, struct fs_file **out_fs_file)
 {
     int rc;
     struct nffs_file *out_file;
-    char *filepath = NULL;
 
     nffs_lock();
 
@@ -197,17 +209,18 @@ nffs_open(const char *path, uint8_t access_flags, struct fs_file **out_fs_file)
         goto done;
     }
 
-    filepath = disk_filepath_from_path(path);
+    /* Opening with truncate may delete the buffered file's inode. */
+    rc = nffs_write_buf_flush();
+    if (rc != 0) {
+        goto done;
+    }
 
-    rc = nffs_file_open(&out_file, filepath, access_flags);
+    rc = nffs_file_open(&out_file, disk_path_strip(path), access_flags);
     if (rc != 0) {
         goto done;
     }
     *out_fs_file = (struct fs_file *)out_file;
 done:
-    if (filepath) {
-        free(filepath);
-    }
     nffs_unlock();
     if (rc != 0) {
         *out_fs_file = NULL;
@@ -235,7 +248,18 @@ nffs_close(struct fs_file *fs_file)
     }
 
     nffs_lock();
-    rc = nffs_file_close(file);
+
+    /* Buffered data that cannot be written is dropped when its file is
+     * closed; the error is still reported.
+     */
+    rc = nffs_write_buf_flush();
+    if (rc != 0) {
+        nffs_write_buf_discard(file->nf_inode_entry);
+        nffs_file_close(file);
+    } else {
+        rc = nffs_file_close(file);
+    }
+
     nffs_unlock();
 
     return rc;
@@ -258,7 +282,10 @@ nffs_seek(struct fs_file *fs_file, uint32_t offset)
     struct nffs_file *file = (struct nffs_file *)fs_file;
 
     nffs_lock();
-    rc = nffs_file_seek(file, offset);
+    rc = nffs_write_buf_flush();
+    if (rc == 0) {
+        rc = nffs_file_seek(file, offset);
+    }
     nffs_unlock();
 
     return rc;
@@ -300,7 +327,10 @@ nffs_file_len(const struct fs_file *fs_file, uint32_t *out_len)
     const struct nffs_file *file = (const struct nffs_file *)fs_file;
 
     nffs_lock();
-    rc = nffs_inode_data_len(file->nf_inode_entry, out_len);
+    rc = nffs_write_buf_flush();
+    if (rc == 0) {
+        rc = nffs_inode_data_len(file->nf_inode_entry, out_len);
+    }
     nffs_unlock();
 
     return rc;
@@ -326,7 +356,10 @@ nffs_read(struct fs_file *fs_file, uint32_t len, void *out_data,
     struct nffs_file *file = (struct nffs_file *)fs_file;
 
     nffs_lock();
-    rc = nffs_file_read(file, len, out_data, out_len);
+    rc = nffs_write_buf_flush();
+    if (rc == 0) {
+        rc = nffs_file_read(file, len, out_data, out_len);
+    }
     nffs_unlock();
 
     return rc;
@@ -366,6 +399,80 @@ done:
     return rc;
 }
 
+/**
+ * Reads data into several buffers, in order, from the current offset of the
+ * specified file handle.  Reading stops at the end of the file.
+ *
+ * @param file              The file to read from.
+ * @param iov               The buffers to read into.
+ * @param iovcnt            The number of buffers.
+ * @param out_len           On success, the total number of bytes read gets
+ *                              written here.
+ *
+ * @return                  0 on success; nonzero on failure.
+ */
+static int
+nffs_readv(struct fs_file *fs_file, const struct fs_iovec *iov, int iovcnt,
+           uint32_t *out_len)
+{
+    struct nffs_file *file = (struct nffs_file *)fs_file;
+    uint32_t len;
+    int rc;
+    int i;
+
+    *out_len = 0;
+
+    nffs_lock();
+    rc = nffs_write_buf_flush();
+    for (i = 0; rc == 0 && i < iovcnt; i++) {
+        rc = nffs_file_read(file, iov[i].iov_len, iov[i].iov_base, &len);
+        if (rc == 0) {
+            *out_len += len;
+            if (len < iov[i].iov_len) {
+                break;
+            }
+        }
+    }
+    nffs_unlock();
+
+    return rc;
+}
+
+/**
+ * Writes the contents of several buffers, in order, to the current offset
+ * of the specified file handle.  All of it is written under one lock, so
+ * the pieces are appended to the write buffer back to back.
+ *
+ * @param file              The file to write to.
+ * @param iov               The buffers to write.
+ * @param iovcnt            The number of buffers.
+ *
+ * @return                  0 on success; nonzero on failure.
+ */
+static int
+nffs_writev(struct fs_file *fs_file, const struct fs_iovec *iov, int iovcnt)
+{
+    struct nffs_file *file = (struct nffs_file *)fs_file;
+    int rc;
+    int i;
+
+    nffs_lock();
+
+    if (!nffs_misc_ready()) {
+        rc = FS_EUNINIT;
+        goto done;
+    }
+
+    rc = 0;
+    for (i = 0; rc == 0 && i < iovcnt; i++) {
+        rc = nffs_write_to_file(file, iov[i].iov_base, iov[i].iov_len);
+    }
+
+done:
+    nffs_unlock();
+    return rc;
+}
+
 /**
  * Unlinks the file or directory at the specified path.  If the path refers to
  * a directory, all the directory's descendants are recursively unlinked.  Any
@@ -388,6 +495,11 @@ nffs_unlink(const char *path)
         goto done;
     }
 
+    rc = nffs_write_buf_flush();
+    if (rc != 0) {
+        goto done;
+    }
+
     rc = nffs_path_unlink(path);
     if (rc != 0) {
         goto done;
@@ -428,6 +540,12 @@ nffs_rename(const char *from, const char *to)
         goto done;
     }
 
+    /* The destination may be the buffered file. */
+    rc = nffs_write_buf_flush();
+    if (rc != 0) {
+        goto done;
+    }
+
     rc = nffs_path_rename(from, to);
     if (rc != 0) {
         goto done;
@@ -493,7 +611,6 @@ nffs_opendir(const char *path, struct fs_dir **out_fs_dir)
 {
     int rc;
     struct nffs_dir **out_dir = (struct nffs_dir **)out_fs_dir;
-    char *filepath = NULL;
 
     nffs_lock();
 
@@ -502,14 +619,9 @@ nffs_opendir(const char *path, struct fs_dir **out_fs_dir)
         goto done;
     }
 
-    filepath = disk_filepath_from_path(path);
-
-    rc = nffs_dir_open(filepath, out_dir);
+    rc = nffs_dir_open(disk_path_strip(path), out_dir);
 
 done:
-    if (filepath) {
-        free(filepath);
-    }
     nffs_unlock();
     if (rc != 0) {
         *out_dir = NULL;
@@ -668,6 +780,95 @@ nffs_detect(const struct nffs_area_desc *area_descs)
     return rc;
 }
 
+#if MYNEWT_VAL(NFFS_CKPT)
+/**
+ * Sets the flash region used for checkpoints of the RAM index.  This must be
+ * called before nffs_detect() for a checkpoint to speed up the restore.  The
+ * region must not overlap any of the nffs areas.
+ *
+ * @param ckpt_desc         The region to use; a zero length disables
+ *                              checkpoints.
+ *
+ * @return                  0 on success;
+ *                          nonzero on failure.
+ */
+int
+nffs_checkpoint_init(const struct nffs_area_desc *ckpt_desc)
+{
+    int rc;
+
+    nffs_lock();
+    rc = nffs_ckpt_set_region(ckpt_desc);
+    nffs_unlock();
+
+    return rc;
+}
+
+/**
+ * Saves the RAM index to the checkpoint region, so that the next restore
+ * only has to scan the objects written after this call.
+ *
+ * @return                  0 on success;
+ *                          nonzero on failure.
+ */
+int
+nffs_checkpoint(void)
+{
+    int rc;
+
+    nffs_lock();
+
+    if (!nffs_misc_ready()) {
+        rc = FS_EUNINIT;
+    } else {
+        rc = nffs_ckpt_write();
+    }
+
+    nffs_unlock();
+
+    return rc;
+}
+#endif
+
+#if MYNEWT_VAL(NFFS_GC_BG)
+static void
+nffs_gc_bg_event(struct os_event *ev)
+{
+    nffs_lock();
+    nffs_gc_bg_step();
+    nffs_unlock();
+}
+
+/**
+ * Enables background garbage collection.  Whenever the free space outside
+ * the scratch area drops below the reserve, an area is compacted from an
+ * event on evq in steps of at most NFFS_GC_BG_SLICE_MS, with the file system
+ * unlocked in between.  Foreground writes only fall back to synchronous
+ * garbage collection if they use up the reserve before a cycle completes.
+ *
+ * @param reserve           Free space to maintain, in bytes; 0 disables
+ *                              background garbage collection.
+ * @param evq               The event queue to collect from; this should be
+ *                              served by a low priority task.
+ *
+ * @return                  0 on success;
+ *                          nonzero on failure.
+ */
+int
+nffs_gc_bg_init(uint32_t reserve, struct os_eventq *evq)
+{
+    if (reserve != 0 && evq == NULL) {
+        return FS_EINVAL;
+    }
+
+    nffs_lock();
+    nffs_gc_bg_config(reserve, evq, nffs_gc_bg_event);
+    nffs_unlock();
+
+    return 0;
+}
+#endif
+
 /**
  * Initializes internal nffs memory and data structures.  This must be called
  * before any nffs operations are attempted.
@@ -753,6 +954,10 @@ void
 nffs_pkg_init(void)
 {
     struct nffs_area_desc descs[MYNEWT_VAL(NFFS_NUM_AREAS) + 1];
+#if MYNEWT_VAL(NFFS_CKPT)
+    struct nffs_area_desc ckpt_desc;
+    const struct flash_area *fa;
+#endif
     int cnt;
     int rc;
 
@@ -771,6 +976,19 @@ nffs_pkg_init(void)
         MYNEWT_VAL(NFFS_FLASH_AREA), &cnt, descs);
     SYSINIT_PANIC_ASSERT(rc == 0);
 
+#if MYNEWT_VAL(NFFS_CKPT)
+    rc = flash_area_open(MYNEWT_VAL(NFFS_CKPT_FLASH_AREA), &fa);
+    SYSINIT_PANIC_ASSERT(rc == 0);
+
+    ckpt_desc.nad_flash_id = fa->fa_device_id;
+    ckpt_desc.nad_offset = fa->fa_off;
+    ckpt_desc.nad_length = fa->fa_size;
+    flash_area_close(fa);
+
+    rc = nffs_checkpoint_init(&ckpt_desc);
+    SYSINIT_PANIC_ASSERT(rc == 0);
+#endif
+
     /* Attempt to restore an existing nffs file system from flash. */
     rc = nffs_detect(descs);
     switch (rc) {
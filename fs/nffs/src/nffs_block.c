@@ -441,7 +441,11 @@ nffs_block_read_data(const struct nffs_block *block, uint16_t offset,
     area_offset += offset;
 
     STATS_INC(nffs_stats, nffs_readcnt_data);
+#if MYNEWT_VAL(NFFS_DATA_CACHE_PAGES)
+    rc = nffs_cache_read_data(area_idx, area_offset, dst, length);
+#else
     rc = nffs_flash_read(area_idx, area_offset, dst, length);
+#endif
     if (rc != 0) {
         return rc;
     }
@@ -496,6 +496,228 @@ nffs_cache_seek(struct nffs_cache_inode *cache_inode, uint32_t seek_offset,
     return 0;
 }
 
+#if MYNEWT_VAL(NFFS_DATA_CACHE_PAGES)
+
+#define NFFS_CACHE_NUM_PAGES    MYNEWT_VAL(NFFS_DATA_CACHE_PAGES)
+#define NFFS_CACHE_PAGE_SZ      MYNEWT_VAL(NFFS_DATA_CACHE_PAGE_SIZE)
+
+/** A page of cached flash contents. */
+struct nffs_cache_page {
+    uint32_t ncp_flash_loc;     /* Page-aligned location; NONE if unused. */
+    uint16_t ncp_len;           /* Number of valid bytes. */
+};
+
+static struct nffs_cache_page nffs_cache_pages[NFFS_CACHE_NUM_PAGES];
+static uint8_t nffs_cache_page_data[NFFS_CACHE_NUM_PAGES][NFFS_CACHE_PAGE_SZ];
+
+/** Index of the page to replace next; pages are replaced in FIFO order. */
+static uint16_t nffs_cache_page_next;
+
+/** The last page loaded; a miss on the page after it triggers read-ahead. */
+static uint32_t nffs_cache_page_last;
+
+static int
+nffs_cache_page_find(uint32_t flash_loc)
+{
+    int i;
+
+    for (i = 0; i < NFFS_CACHE_NUM_PAGES; i++) {
+        if (nffs_cache_pages[i].ncp_flash_loc == flash_loc) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * Loads the page at the specified area offset, along with the
+ * NFFS_DATA_CACHE_READAHEAD pages after it if the access is sequential.
+ * Only data below the area's write offset is loaded; that data never changes
+ * until the area is erased.  Consecutive pages are loaded into consecutive
+ * slots, so each run needs a single flash read.
+ *
+ * @param area_idx              The area to read from.
+ * @param page_off              The page-aligned offset to read.
+ * @param out_idx               On success, the slot holding the requested
+ *                                  page gets written here.
+ *
+ * @return                      0 on success; nonzero on failure.
+ */
+static int
+nffs_cache_page_load(uint8_t area_idx, uint32_t page_off, int *out_idx)
+{
+    const struct nffs_area *area;
+    uint32_t flash_loc;
+    uint32_t read_len;
+    uint32_t off;
+    int num_pages;
+    int slot;
+    int run;
+    int dup;
+    int rc;
+    int i;
+    int j;
+
+    area = nffs_areas + area_idx;
+    assert(page_off < area->na_cur);
+
+    num_pages = 1;
+    if (page_off >= NFFS_CACHE_PAGE_SZ &&
+        nffs_cache_page_last ==
+            nffs_flash_loc(area_idx, page_off - NFFS_CACHE_PAGE_SZ)) {
+
+        num_pages += MYNEWT_VAL(NFFS_DATA_CACHE_READAHEAD);
+        if (num_pages > NFFS_CACHE_NUM_PAGES) {
+            num_pages = NFFS_CACHE_NUM_PAGES;
+        }
+    }
+
+    i = 0;
+    while (i < num_pages) {
+        off = page_off + i * NFFS_CACHE_PAGE_SZ;
+        if (off >= area->na_cur) {
+            break;
+        }
+
+        /* Read as many pages as fit before the end of the slot array. */
+        slot = (nffs_cache_page_next + i) % NFFS_CACHE_NUM_PAGES;
+        run = num_pages - i;
+        if (run > NFFS_CACHE_NUM_PAGES - slot) {
+            run = NFFS_CACHE_NUM_PAGES - slot;
+        }
+        read_len = run * NFFS_CACHE_PAGE_SZ;
+        if (read_len > area->na_cur - off) {
+            read_len = area->na_cur - off;
+            run = (read_len + NFFS_CACHE_PAGE_SZ - 1) / NFFS_CACHE_PAGE_SZ;
+        }
+
+        for (j = 0; j < run; j++) {
+            flash_loc = nffs_flash_loc(area_idx,
+                                       off + j * NFFS_CACHE_PAGE_SZ);
+            dup = nffs_cache_page_find(flash_loc);
+            if (dup != -1) {
+                nffs_cache_pages[dup].ncp_flash_loc = NFFS_FLASH_LOC_NONE;
+            }
+            nffs_cache_pages[slot + j].ncp_flash_loc = NFFS_FLASH_LOC_NONE;
+        }
+
+        rc = nffs_flash_read(area_idx, off, nffs_cache_page_data[slot],
+                             read_len);
+        if (rc != 0) {
+            return rc;
+        }
+
+        for (j = 0; j < run; j++) {
+            nffs_cache_pages[slot + j].ncp_flash_loc =
+                nffs_flash_loc(area_idx, off + j * NFFS_CACHE_PAGE_SZ);
+            if (read_len - j * NFFS_CACHE_PAGE_SZ > NFFS_CACHE_PAGE_SZ) {
+                nffs_cache_pages[slot + j].ncp_len = NFFS_CACHE_PAGE_SZ;
+            } else {
+                nffs_cache_pages[slot + j].ncp_len =
+                    read_len - j * NFFS_CACHE_PAGE_SZ;
+            }
+        }
+
+        i += run;
+    }
+
+    STATS_INC(nffs_stats, nffs_dcache_miss);
+    STATS_INCN(nffs_stats, nffs_dcache_readahead, i - 1);
+
+    *out_idx = nffs_cache_page_next;
+    nffs_cache_page_next = (nffs_cache_page_next + i) % NFFS_CACHE_NUM_PAGES;
+    nffs_cache_page_last = nffs_flash_loc(area_idx,
+                                          page_off +
+                                          (i - 1) * NFFS_CACHE_PAGE_SZ);
+
+    return 0;
+}
+
+/**
+ * Reads file data from flash through the data page cache.  Reads of at least
+ * a page are passed straight to flash.
+ *
+ * @param area_idx              The area to read from.
+ * @param area_offset           The offset within the area to read from.
+ * @param dst                   On success, the data gets written here.
+ * @param len                   The number of bytes to read.
+ *
+ * @return                      0 on success; nonzero on failure.
+ */
+int
+nffs_cache_read_data(uint8_t area_idx, uint32_t area_offset, void *dst,
+                     uint32_t len)
+{
+    const struct nffs_cache_page *page;
+    uint32_t page_off;
+    uint32_t chunk;
+    uint16_t in_off;
+    uint8_t *dptr;
+    int idx;
+    int rc;
+
+    if (len >= NFFS_CACHE_PAGE_SZ ||
+        area_offset + len > nffs_areas[area_idx].na_cur) {
+
+        return nffs_flash_read(area_idx, area_offset, dst, len);
+    }
+
+    dptr = dst;
+    while (len > 0) {
+        in_off = area_offset % NFFS_CACHE_PAGE_SZ;
+        page_off = area_offset - in_off;
+        chunk = NFFS_CACHE_PAGE_SZ - in_off;
+        if (chunk > len) {
+            chunk = len;
+        }
+
+        idx = nffs_cache_page_find(nffs_flash_loc(area_idx, page_off));
+        if (idx != -1 && nffs_cache_pages[idx].ncp_len >= in_off + chunk) {
+            STATS_INC(nffs_stats, nffs_dcache_hit);
+        } else {
+            rc = nffs_cache_page_load(area_idx, page_off, &idx);
+            if (rc != 0) {
+                return rc;
+            }
+        }
+
+        page = nffs_cache_pages + idx;
+        assert(page->ncp_len >= in_off + chunk);
+        memcpy(dptr, nffs_cache_page_data[idx] + in_off, chunk);
+
+        dptr += chunk;
+        area_offset += chunk;
+        len -= chunk;
+    }
+
+    return 0;
+}
+
+/**
+ * Drops the cached pages of the specified area, or of all areas if
+ * NFFS_AREA_ID_NONE is specified.  Must be called whenever an area is erased.
+ */
+void
+nffs_cache_data_invalidate(uint8_t area_idx)
+{
+    uint32_t area_offset;
+    uint8_t page_area_idx;
+    int i;
+
+    for (i = 0; i < NFFS_CACHE_NUM_PAGES; i++) {
+        nffs_flash_loc_expand(nffs_cache_pages[i].ncp_flash_loc,
+                              &page_area_idx, &area_offset);
+        if (area_idx == NFFS_AREA_ID_NONE || page_area_idx == area_idx) {
+            nffs_cache_pages[i].ncp_flash_loc = NFFS_FLASH_LOC_NONE;
+        }
+    }
+
+    nffs_cache_page_last = NFFS_FLASH_LOC_NONE;
+}
+
+#endif
+
 /**
  * Frees all cached inodes and blocks.
  */
@@ -508,4 +730,8 @@ nffs_cache_clear(void)
         TAILQ_REMOVE(&nffs_cache_inode_list, entry, nci_link);
         nffs_cache_inode_free(entry);
     }
+
+#if MYNEWT_VAL(NFFS_DATA_CACHE_PAGES)
+    nffs_cache_data_invalidate(NFFS_AREA_ID_NONE);
+#endif
 }
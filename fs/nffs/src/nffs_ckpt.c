@@ -0,0 +1,511 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <assert.h>
+#include <stddef.h>
+#include <string.h>
+#include "os/mynewt.h"
+#include "hal/hal_flash.h"
+#include "crc/crc16.h"
+#include "nffs/nffs.h"
+#include "nffs_priv.h"
+
+#if MYNEWT_VAL(NFFS_CKPT)
+
+/** Where checkpoints are kept; a zero length means none is configured. */
+static struct nffs_area_desc nffs_ckpt_desc;
+
+/** Header of the last checkpoint read or written. */
+static struct nffs_disk_ckpt nffs_ckpt_hdr;
+
+/** Whether nffs_ckpt_hdr describes a usable checkpoint. */
+static uint8_t nffs_ckpt_valid;
+
+static int
+nffs_ckpt_flash_read(uint32_t offset, void *data, uint32_t len)
+{
+    int rc;
+
+    if (offset + len > nffs_ckpt_desc.nad_length) {
+        return FS_EOFFSET;
+    }
+
+    STATS_INC(nffs_stats, nffs_iocnt_read);
+    rc = hal_flash_read(nffs_ckpt_desc.nad_flash_id,
+                        nffs_ckpt_desc.nad_offset + offset, data, len);
+    if (rc != 0) {
+        return FS_EHW;
+    }
+
+    return 0;
+}
+
+static int
+nffs_ckpt_flash_write(uint32_t offset, const void *data, uint32_t len)
+{
+    int rc;
+
+    if (offset + len > nffs_ckpt_desc.nad_length) {
+        return FS_EOFFSET;
+    }
+
+    STATS_INC(nffs_stats, nffs_iocnt_write);
+    rc = hal_flash_write(nffs_ckpt_desc.nad_flash_id,
+                         nffs_ckpt_desc.nad_offset + offset, data, len);
+    if (rc != 0) {
+        return FS_EHW;
+    }
+
+    return 0;
+}
+
+static uint32_t
+nffs_ckpt_area_rec_offset(uint32_t area_idx)
+{
+    return sizeof (struct nffs_disk_ckpt) +
+           area_idx * sizeof (struct nffs_disk_ckpt_area);
+}
+
+static uint32_t
+nffs_ckpt_obj_rec_offset(const struct nffs_disk_ckpt *hdr, uint32_t obj_idx)
+{
+    return nffs_ckpt_area_rec_offset(hdr->ndc_num_areas) +
+           obj_idx * sizeof (struct nffs_disk_ckpt_obj);
+}
+
+/**
+ * Tells whether a RAM hash entry gets recorded in a checkpoint.  Dummy
+ * entries have no disk object; restore recreates them as needed.
+ */
+static int
+nffs_ckpt_includes(struct nffs_hash_entry *entry, uint8_t area_idx)
+{
+    uint32_t area_offset;
+    uint8_t entry_area_idx;
+
+    if (nffs_hash_entry_is_dummy(entry)) {
+        return 0;
+    }
+
+    nffs_flash_loc_expand(entry->nhe_flash_loc, &entry_area_idx,
+                          &area_offset);
+    return entry_area_idx == area_idx;
+}
+
+/**
+ * Continues a CRC over a range of the checkpoint region.
+ */
+static int
+nffs_ckpt_crc_flash(uint16_t *crc, uint32_t offset, uint32_t len)
+{
+    uint32_t chunk_len;
+    int rc;
+
+    while (len > 0) {
+        chunk_len = min(len, sizeof nffs_flash_buf);
+
+        rc = nffs_ckpt_flash_read(offset, nffs_flash_buf, chunk_len);
+        if (rc != 0) {
+            return rc;
+        }
+
+        *crc = crc16_ccitt(*crc, nffs_flash_buf, chunk_len);
+        offset += chunk_len;
+        len -= chunk_len;
+    }
+
+    return 0;
+}
+
+/**
+ * Reads and verifies the checkpoint header and records.  The records are
+ * covered by the CRC in the order they are written: each area's objects,
+ * followed by the area's own record.
+ *
+ * @return                      0 if a usable checkpoint is present;
+ *                              FS_ENOENT if none is configured or written;
+ *                              FS_ECORRUPT if it fails verification;
+ *                              other nonzero on error.
+ */
+int
+nffs_ckpt_load(void)
+{
+    struct nffs_disk_ckpt_area ckpt_area;
+    struct nffs_disk_ckpt hdr;
+    uint32_t num_objs;
+    uint16_t crc;
+    uint32_t i;
+    int rc;
+
+    nffs_ckpt_valid = 0;
+
+    if (nffs_ckpt_desc.nad_length == 0) {
+        return FS_ENOENT;
+    }
+
+    rc = nffs_ckpt_flash_read(0, &hdr, sizeof hdr);
+    if (rc != 0) {
+        return rc;
+    }
+    if (hdr.ndc_magic != NFFS_CKPT_MAGIC) {
+        return FS_ENOENT;
+    }
+    if (hdr.ndc_num_areas > NFFS_MAX_AREAS ||
+        nffs_ckpt_obj_rec_offset(&hdr, hdr.ndc_num_objs) >
+            nffs_ckpt_desc.nad_length) {
+
+        return FS_ECORRUPT;
+    }
+
+    crc = crc16_ccitt(0, &hdr, NFFS_DISK_CKPT_OFFSET_CRC);
+    num_objs = 0;
+    for (i = 0; i < hdr.ndc_num_areas; i++) {
+        rc = nffs_ckpt_flash_read(nffs_ckpt_area_rec_offset(i), &ckpt_area,
+                                  sizeof ckpt_area);
+        if (rc != 0) {
+            return rc;
+        }
+        if (ckpt_area.ndca_first_obj != num_objs ||
+            ckpt_area.ndca_num_objs > hdr.ndc_num_objs - num_objs) {
+
+            return FS_ECORRUPT;
+        }
+
+        rc = nffs_ckpt_crc_flash(&crc,
+                                 nffs_ckpt_obj_rec_offset(&hdr, num_objs),
+                                 ckpt_area.ndca_num_objs *
+                                     sizeof (struct nffs_disk_ckpt_obj));
+        if (rc != 0) {
+            return rc;
+        }
+        crc = crc16_ccitt(crc, &ckpt_area, sizeof ckpt_area);
+
+        num_objs += ckpt_area.ndca_num_objs;
+    }
+
+    if (num_objs != hdr.ndc_num_objs || crc != hdr.ndc_crc16) {
+        return FS_ECORRUPT;
+    }
+
+    nffs_ckpt_hdr = hdr;
+    nffs_ckpt_valid = 1;
+
+    return 0;
+}
+
+/**
+ * Checks whether an area is unchanged since the checkpoint, other than by
+ * objects appended past the checkpointed end.  The area must already be
+ * populated in nffs_areas.
+ *
+ * @param area_idx              The index of the area to check.
+ * @param out_ckpt_area         On success, the area's checkpoint record gets
+ *                                  written here.
+ *
+ * @return                      0 if the checkpoint can be used for the area;
+ *                              FS_ENOENT if the area has to be scanned;
+ *                              other nonzero on error.
+ */
+int
+nffs_ckpt_area_match(uint8_t area_idx,
+                     struct nffs_disk_ckpt_area *out_ckpt_area)
+{
+    struct nffs_disk_ckpt_obj obj;
+    const struct nffs_area *area;
+    union {
+        struct nffs_disk_inode ndi;
+        struct nffs_disk_block ndb;
+    } disk_obj;
+    uint32_t area_offset;
+    uint8_t obj_area_idx;
+    int rc;
+
+    if (!nffs_ckpt_valid || area_idx >= nffs_ckpt_hdr.ndc_num_areas) {
+        return FS_ENOENT;
+    }
+
+    rc = nffs_ckpt_flash_read(nffs_ckpt_area_rec_offset(area_idx),
+                              out_ckpt_area, sizeof *out_ckpt_area);
+    if (rc != 0) {
+        return rc;
+    }
+
+    /* A garbage collection cycle bumps the area's sequence number; a format
+     * erases the checkpoint.
+     */
+    area = nffs_areas + area_idx;
+    if (out_ckpt_area->ndca_offset != area->na_offset ||
+        out_ckpt_area->ndca_length != area->na_length ||
+        out_ckpt_area->ndca_flash_id != area->na_flash_id ||
+        out_ckpt_area->ndca_id != area->na_id ||
+        out_ckpt_area->ndca_gc_seq != area->na_gc_seq ||
+        out_ckpt_area->ndca_cur > area->na_length) {
+
+        return FS_ENOENT;
+    }
+
+    /* Guard against the sequence number having wrapped: the newest object
+     * recorded for the area must still be on disk where it was.
+     */
+    if (out_ckpt_area->ndca_num_objs > 0) {
+        rc = nffs_ckpt_flash_read(
+            nffs_ckpt_obj_rec_offset(&nffs_ckpt_hdr,
+                                     out_ckpt_area->ndca_first_obj +
+                                     out_ckpt_area->ndca_num_objs - 1),
+            &obj, sizeof obj);
+        if (rc != 0) {
+            return rc;
+        }
+
+        nffs_flash_loc_expand(obj.ndco_flash_loc, &obj_area_idx,
+                              &area_offset);
+        if (obj_area_idx != area_idx) {
+            return FS_ECORRUPT;
+        }
+
+        rc = nffs_flash_read(area_idx, area_offset, &disk_obj,
+                             sizeof disk_obj);
+        if (rc != 0) {
+            return rc;
+        }
+        if (memcmp(&disk_obj, &obj.ndco_un_obj, sizeof disk_obj) != 0) {
+            return FS_ENOENT;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Reads one object record from the loaded checkpoint.
+ *
+ * @param idx                   The index of the record to read.
+ * @param out_disk_object       On success, the object gets written here, as
+ *                                  if it had been read from its area.
+ *
+ * @return                      0 on success; nonzero on failure.
+ */
+int
+nffs_ckpt_read_obj(uint32_t idx, struct nffs_disk_object *out_disk_object)
+{
+    struct nffs_disk_ckpt_obj obj;
+    int rc;
+
+    if (!nffs_ckpt_valid || idx >= nffs_ckpt_hdr.ndc_num_objs) {
+        return FS_EINVAL;
+    }
+
+    rc = nffs_ckpt_flash_read(nffs_ckpt_obj_rec_offset(&nffs_ckpt_hdr, idx),
+                              &obj, sizeof obj);
+    if (rc != 0) {
+        return rc;
+    }
+
+    memset(out_disk_object, 0, sizeof *out_disk_object);
+    memcpy(&out_disk_object->ndo_un_obj, &obj.ndco_un_obj,
+           sizeof obj.ndco_un_obj);
+
+    if (nffs_hash_id_is_inode(out_disk_object->ndo_disk_inode.ndi_id)) {
+        out_disk_object->ndo_type = NFFS_OBJECT_TYPE_INODE;
+    } else if (nffs_hash_id_is_block(out_disk_object->ndo_disk_block.ndb_id)) {
+        out_disk_object->ndo_type = NFFS_OBJECT_TYPE_BLOCK;
+    } else {
+        return FS_ECORRUPT;
+    }
+
+    nffs_flash_loc_expand(obj.ndco_flash_loc, &out_disk_object->ndo_area_idx,
+                          &out_disk_object->ndo_offset);
+
+    return 0;
+}
+
+/**
+ * Writes the current RAM index to the checkpoint region.  The header is
+ * written last, so an interrupted checkpoint is simply absent on the next
+ * restore.
+ *
+ * @return                      0 on success;
+ *                              FS_EINVAL if no checkpoint region is
+ *                                  configured;
+ *                              FS_EFULL if the index does not fit in it;
+ *                              other nonzero on error.
+ */
+int
+nffs_ckpt_write(void)
+{
+    struct nffs_disk_ckpt_area ckpt_area;
+    struct nffs_disk_ckpt_obj obj;
+    struct nffs_hash_entry *entry;
+    struct nffs_hash_entry *next;
+    struct nffs_disk_ckpt hdr;
+    uint32_t area_offset;
+    uint8_t area_idx;
+    uint16_t crc;
+    int rc;
+    int i;
+    int j;
+
+    if (nffs_ckpt_desc.nad_length == 0) {
+        return FS_EINVAL;
+    }
+
+#if MYNEWT_VAL(NFFS_GC_BG)
+    /* Areas are only recorded whole; finish a half-collected one first. */
+    rc = nffs_gc_bg_complete(NULL);
+    if (rc != 0) {
+        return rc;
+    }
+#endif
+
+    memset(&hdr, 0, sizeof hdr);
+    hdr.ndc_magic = NFFS_CKPT_MAGIC;
+    hdr.ndc_gen = nffs_ckpt_hdr.ndc_gen + 1;
+    hdr.ndc_num_areas = nffs_num_areas;
+    for (i = 0; i < nffs_num_areas; i++) {
+        NFFS_HASH_FOREACH(entry, j, next) {
+            if (nffs_ckpt_includes(entry, i)) {
+                hdr.ndc_num_objs++;
+            }
+        }
+    }
+
+    if (nffs_ckpt_obj_rec_offset(&hdr, hdr.ndc_num_objs) >
+        nffs_ckpt_desc.nad_length) {
+
+        return FS_EFULL;
+    }
+
+    nffs_ckpt_valid = 0;
+    rc = hal_flash_erase(nffs_ckpt_desc.nad_flash_id,
+                         nffs_ckpt_desc.nad_offset,
+                         nffs_ckpt_desc.nad_length);
+    if (rc != 0) {
+        return FS_EHW;
+    }
+
+    crc = crc16_ccitt(0, &hdr, NFFS_DISK_CKPT_OFFSET_CRC);
+    memset(&ckpt_area, 0, sizeof ckpt_area);
+    for (i = 0; i < nffs_num_areas; i++) {
+        ckpt_area.ndca_first_obj += ckpt_area.ndca_num_objs;
+        ckpt_area.ndca_num_objs = 0;
+
+        NFFS_HASH_FOREACH(entry, j, next) {
+            if (!nffs_ckpt_includes(entry, i)) {
+                continue;
+            }
+
+            nffs_flash_loc_expand(entry->nhe_flash_loc, &area_idx,
+                                  &area_offset);
+            obj.ndco_flash_loc = entry->nhe_flash_loc;
+            rc = nffs_flash_read(area_idx, area_offset, &obj.ndco_un_obj,
+                                 sizeof obj.ndco_un_obj);
+            if (rc != 0) {
+                return rc;
+            }
+
+            rc = nffs_ckpt_flash_write(
+                nffs_ckpt_obj_rec_offset(&hdr, ckpt_area.ndca_first_obj +
+                                               ckpt_area.ndca_num_objs),
+                &obj, sizeof obj);
+            if (rc != 0) {
+                return rc;
+            }
+            crc = crc16_ccitt(crc, &obj, sizeof obj);
+            ckpt_area.ndca_num_objs++;
+        }
+
+        ckpt_area.ndca_offset = nffs_areas[i].na_offset;
+        ckpt_area.ndca_length = nffs_areas[i].na_length;
+        ckpt_area.ndca_cur = nffs_areas[i].na_cur;
+        ckpt_area.ndca_id = nffs_areas[i].na_id;
+        ckpt_area.ndca_gc_seq = nffs_areas[i].na_gc_seq;
+        ckpt_area.ndca_flash_id = nffs_areas[i].na_flash_id;
+
+        rc = nffs_ckpt_flash_write(nffs_ckpt_area_rec_offset(i), &ckpt_area,
+                                   sizeof ckpt_area);
+        if (rc != 0) {
+            return rc;
+        }
+        crc = crc16_ccitt(crc, &ckpt_area, sizeof ckpt_area);
+    }
+
+    hdr.ndc_crc16 = crc;
+    rc = nffs_ckpt_flash_write(0, &hdr, sizeof hdr);
+    if (rc != 0) {
+        return rc;
+    }
+
+    nffs_ckpt_hdr = hdr;
+    nffs_ckpt_valid = 1;
+
+    NFFS_LOG_DEBUG("checkpoint; gen=%u objs=%u\n",
+                   (unsigned int)hdr.ndc_gen, (unsigned int)hdr.ndc_num_objs);
+
+    return 0;
+}
+
+/**
+ * Discards the checkpoint.  Called when the areas it describes are
+ * reformatted, since formatting resets the area sequence numbers.
+ *
+ * @return                      0 on success; nonzero on failure.
+ */
+int
+nffs_ckpt_invalidate(void)
+{
+    int rc;
+
+    nffs_ckpt_valid = 0;
+
+    if (nffs_ckpt_desc.nad_length == 0) {
+        return 0;
+    }
+
+    rc = hal_flash_erase(nffs_ckpt_desc.nad_flash_id,
+                         nffs_ckpt_desc.nad_offset, sizeof nffs_ckpt_hdr);
+    if (rc != 0) {
+        return FS_EHW;
+    }
+
+    return 0;
+}
+
+/**
+ * Sets the flash region used for checkpoints.
+ *
+ * @param ckpt_desc             The region to use; a zero length disables
+ *                                  checkpoints.
+ *
+ * @return                      0 on success; nonzero on failure.
+ */
+int
+nffs_ckpt_set_region(const struct nffs_area_desc *ckpt_desc)
+{
+    if (ckpt_desc->nad_length != 0 &&
+        ckpt_desc->nad_length <= sizeof (struct nffs_disk_ckpt)) {
+        return FS_EINVAL;
+    }
+
+    nffs_ckpt_desc = *ckpt_desc;
+    nffs_ckpt_valid = 0;
+
+    return 0;
+}
+
+#endif
@@ -72,6 +72,10 @@ nffs_format_area(uint8_t area_idx, int is_scratch)
 
     area = nffs_areas + area_idx;
 
+#if MYNEWT_VAL(NFFS_DATA_CACHE_PAGES)
+    nffs_cache_data_invalidate(area_idx);
+#endif
+
     rc = hal_flash_erase(area->na_flash_id, area->na_offset, area->na_length);
     if (rc != 0) {
         return FS_EHW;
@@ -113,6 +117,13 @@ nffs_format_full(const struct nffs_area_desc *area_descs)
     /* Start from a clean state. */
     nffs_misc_reset();
 
+#if MYNEWT_VAL(NFFS_CKPT)
+    rc = nffs_ckpt_invalidate();
+    if (rc != 0) {
+        goto err;
+    }
+#endif
+
     /* Select largest area to be the initial scratch area. */
     nffs_scratch_area_idx = 0;
     for (i = 1; area_descs[i].nad_length != 0; i++) {
@@ -395,6 +395,156 @@ nffs_gc_inode_blocks(struct nffs_inode_entry *inode_entry,
     return 0;
 }
 
+/**
+ * Copies every object in one hash bucket that is resident in the specified
+ * area to the scratch area.  Objects that have already been copied are no
+ * longer resident in the source area, so a bucket can safely be processed
+ * more than once.
+ *
+ * @param from_area_idx     The index of the area being garbage collected.
+ * @param bucket_idx        The index of the hash bucket to process.
+ *
+ * @return                  0 on success; nonzero on error.
+ */
+static int
+nffs_gc_copy_bucket(uint8_t from_area_idx, uint32_t bucket_idx)
+{
+    struct nffs_hash_entry *entry;
+    struct nffs_hash_entry *next;
+    struct nffs_inode_entry *inode_entry;
+    uint32_t area_offset;
+    uint8_t area_idx;
+    int rc;
+
+    entry = SLIST_FIRST(nffs_hash + bucket_idx);
+    while (entry != NULL) {
+        next = SLIST_NEXT(entry, nhe_next);
+
+        if (nffs_hash_id_is_inode(entry->nhe_id)) {
+            /* The inode gets copied if it is in the source area. */
+            nffs_flash_loc_expand(entry->nhe_flash_loc,
+                                  &area_idx, &area_offset);
+            inode_entry = (struct nffs_inode_entry *)entry;
+            if (area_idx == from_area_idx) {
+                rc = nffs_gc_copy_inode(inode_entry, nffs_scratch_area_idx);
+                if (rc != 0) {
+                    return rc;
+                }
+            }
+
+            /* If the inode is a file, all constituent data blocks that are
+             * resident in the source area get copied.
+             */
+            if (nffs_hash_id_is_file(entry->nhe_id)) {
+                rc = nffs_gc_inode_blocks(inode_entry, from_area_idx,
+                                          nffs_scratch_area_idx, &next);
+                if (rc != 0) {
+                    return rc;
+                }
+            }
+        }
+
+        entry = next;
+    }
+
+    return 0;
+}
+
+/**
+ * Copies every object resident in the specified area to the scratch area.
+ *
+ * @param from_area_idx     The index of the area being garbage collected.
+ * @param first_bucket      The hash bucket to start from; buckets before it
+ *                              have already been processed.
+ *
+ * @return                  0 on success; nonzero on error.
+ */
+static int
+nffs_gc_copy_area(uint8_t from_area_idx, uint32_t first_bucket)
+{
+    uint32_t i;
+    int rc;
+
+    /* Collating blocks inserts new entries into the hash table; keep it from
+     * being resized while the buckets are being walked.
+     */
+    nffs_hash_freeze();
+
+    rc = 0;
+    for (i = first_bucket; i < nffs_hash_num_buckets; i++) {
+        rc = nffs_gc_copy_bucket(from_area_idx, i);
+        if (rc != 0) {
+            break;
+        }
+    }
+
+    nffs_hash_thaw();
+
+    return rc;
+}
+
+/**
+ * Starts a garbage collection cycle by giving the scratch area the ID of the
+ * source area.
+ */
+static int
+nffs_gc_begin(uint8_t from_area_idx)
+{
+    return nffs_format_from_scratch_area(nffs_scratch_area_idx,
+                                         nffs_areas[from_area_idx].na_id);
+}
+
+/**
+ * Completes a garbage collection cycle once every object has been copied out
+ * of the source area, turning the source area into the new scratch area.
+ */
+static int
+nffs_gc_finish(uint8_t from_area_idx, uint8_t *out_area_idx)
+{
+    struct nffs_area *from_area;
+    struct nffs_area *to_area;
+    int rc;
+
+    from_area = nffs_areas + from_area_idx;
+    to_area = nffs_areas + nffs_scratch_area_idx;
+
+    /* The amount of written data should never increase as a result of a gc
+     * cycle.
+     */
+    assert(to_area->na_cur <= from_area->na_cur);
+
+    /* Turn the source area into the new scratch area. */
+    from_area->na_gc_seq++;
+    rc = nffs_format_area(from_area_idx, 1);
+    if (rc != 0) {
+        return rc;
+    }
+
+    if (out_area_idx != NULL) {
+        *out_area_idx = nffs_scratch_area_idx;
+    }
+
+    nffs_scratch_area_idx = from_area_idx;
+
+    /* Garbage collection renders the cache invalid:
+     *     o All cached blocks are now invalid; drop them.
+     *     o Flash locations of inodes may have changed; the cached inodes need
+     *       updated to reflect this.
+     */
+    rc = nffs_cache_inode_refresh();
+    if (rc != 0) {
+        return rc;
+    }
+
+    /* Increment the garbage collection counter so that client code knows to
+     * reset its pointers to cached objects.
+     */
+    nffs_gc_count++;
+    STATS_INC(nffs_stats, nffs_gccnt);
+
+    return 0;
+}
+
 /**
  * Triggers a garbage collection cycle.  This is implemented as follows:
  *
@@ -446,96 +596,32 @@ nffs_gc_inode_blocks(struct nffs_inode_entry *inode_entry,
 int
 nffs_gc(uint8_t *out_area_idx)
 {
-    struct nffs_hash_entry *entry;
-    struct nffs_hash_entry *next;
-    struct nffs_area *from_area;
-    struct nffs_area *to_area;
-    struct nffs_inode_entry *inode_entry;
-    uint32_t area_offset;
     uint8_t from_area_idx;
-    uint8_t area_idx;
     int rc;
-    int i;
-
-    from_area_idx = nffs_gc_select_area();
-    from_area = nffs_areas + from_area_idx;
-    to_area = nffs_areas + nffs_scratch_area_idx;
-
-    rc = nffs_format_from_scratch_area(nffs_scratch_area_idx,
-                                       from_area->na_id);
-    if (rc != 0) {
-        return rc;
-    }
-
-    for (i = 0; i < NFFS_HASH_SIZE; i++) {
-        entry = SLIST_FIRST(nffs_hash + i);
-        while (entry != NULL) {
-            next = SLIST_NEXT(entry, nhe_next);
-
-            if (nffs_hash_id_is_inode(entry->nhe_id)) {
-                /* The inode gets copied if it is in the source area. */
-                nffs_flash_loc_expand(entry->nhe_flash_loc,
-                                      &area_idx, &area_offset);
-                inode_entry = (struct nffs_inode_entry *)entry;
-                if (area_idx == from_area_idx) {
-                    rc = nffs_gc_copy_inode(inode_entry,
-                                            nffs_scratch_area_idx);
-                    if (rc != 0) {
-                        return rc;
-                    }
-                }
-
-                /* If the inode is a file, all constituent data blocks that are
-                 * resident in the source area get copied.
-                 */
-                if (nffs_hash_id_is_file(entry->nhe_id)) {
-                    rc = nffs_gc_inode_blocks(inode_entry, from_area_idx,
-                                              nffs_scratch_area_idx, &next);
-                    if (rc != 0) {
-                        return rc;
-                    }
-                }
-            }
 
-            entry = next;
-        }
+#if MYNEWT_VAL(NFFS_GC_BG)
+    /* A cycle that was started in the background has to be completed first;
+     * the scratch area is already in use.
+     */
+    if (nffs_gc_from_area_idx != NFFS_AREA_ID_NONE) {
+        return nffs_gc_bg_complete(out_area_idx);
     }
+    nffs_gc_bg_cancel_scan();
+#endif
 
-    /* The amount of written data should never increase as a result of a gc
-     * cycle.
-     */
-    assert(to_area->na_cur <= from_area->na_cur);
+    from_area_idx = nffs_gc_select_area();
 
-    /* Turn the source area into the new scratch area. */
-    from_area->na_gc_seq++;
-    rc = nffs_format_area(from_area_idx, 1);
+    rc = nffs_gc_begin(from_area_idx);
     if (rc != 0) {
         return rc;
     }
 
-    if (out_area_idx != NULL) {
-        *out_area_idx = nffs_scratch_area_idx;
-    }
-
-    nffs_scratch_area_idx = from_area_idx;
-
-    /* Garbage collection renders the cache invalid:
-     *     o All cached blocks are now invalid; drop them.
-     *     o Flash locations of inodes may have changed; the cached inodes need
-     *       updated to reflect this.
-     */
-    rc = nffs_cache_inode_refresh();
+    rc = nffs_gc_copy_area(from_area_idx, 0);
     if (rc != 0) {
         return rc;
     }
 
-    /* Increment the garbage collection counter so that client code knows to
-     * reset its pointers to cached objects.
-     */
-    nffs_gc_count++;
-    STATS_INC(nffs_stats, nffs_gccnt);
-
-    return 0;
+    return nffs_gc_finish(from_area_idx, out_area_idx);
 }
 
 /**
@@ -572,3 +658,351 @@ nffs_gc_until(uint32_t space, uint8_t *out_area_idx)
 
     return FS_EFULL;
 }
+
+#if MYNEWT_VAL(NFFS_GC_BG)
+
+#define NFFS_GC_BG_PHASE_IDLE       0
+#define NFFS_GC_BG_PHASE_SCAN       1
+#define NFFS_GC_BG_PHASE_COPY       2
+
+/**
+ * The area a background cycle is copying objects out of, or
+ * NFFS_AREA_ID_NONE.  No new objects are written to this area.
+ */
+uint8_t nffs_gc_from_area_idx = NFFS_AREA_ID_NONE;
+
+static uint8_t nffs_gc_bg_phase;
+static uint32_t nffs_gc_bg_bucket;
+static uint32_t *nffs_gc_bg_live;
+static uint32_t nffs_gc_bg_reserve;
+static struct os_eventq *nffs_gc_bg_evq;
+static struct os_event nffs_gc_bg_ev;
+
+/**
+ * Calculates the free space available to new objects, i.e., in all areas
+ * other than the scratch area and the area being garbage collected.
+ */
+static uint32_t
+nffs_gc_bg_free_space(void)
+{
+    uint32_t space;
+    int i;
+
+    space = 0;
+    for (i = 0; i < nffs_num_areas; i++) {
+        if (i != nffs_scratch_area_idx && i != nffs_gc_from_area_idx) {
+            space += nffs_area_free_space(nffs_areas + i);
+        }
+    }
+
+    return space;
+}
+
+/**
+ * Adds the size of each object in one hash bucket to the live byte count of
+ * the area it resides in.  The counts are only used to rank areas, so
+ * objects that cannot be read are skipped.
+ */
+static void
+nffs_gc_bg_scan_bucket(uint32_t bucket_idx)
+{
+    struct nffs_hash_entry *entry;
+    struct nffs_block block;
+    struct nffs_inode inode;
+    uint32_t area_offset;
+    uint16_t size;
+    uint8_t area_idx;
+    int rc;
+
+    SLIST_FOREACH(entry, nffs_hash + bucket_idx, nhe_next) {
+        if (nffs_hash_entry_is_dummy(entry)) {
+            continue;
+        }
+
+        if (nffs_hash_id_is_inode(entry->nhe_id)) {
+            rc = nffs_inode_from_entry(&inode,
+                                       (struct nffs_inode_entry *)entry);
+            size = sizeof (struct nffs_disk_inode) + inode.ni_filename_len;
+        } else {
+            rc = nffs_block_from_hash_entry(&block, entry);
+            size = sizeof (struct nffs_disk_block) + block.nb_data_len;
+        }
+        if (rc != 0) {
+            continue;
+        }
+
+        nffs_flash_loc_expand(entry->nhe_flash_loc, &area_idx, &area_offset);
+        if (area_idx < nffs_num_areas) {
+            nffs_gc_bg_live[area_idx] += size;
+        }
+    }
+}
+
+/**
+ * Selects the area to garbage collect in the background using the
+ * cost-benefit policy.  An area's score is:
+ *
+ *     reclaimable * age / (used + live)
+ *
+ * where reclaimable = used - live is the space freed by collecting it, the
+ * denominator is the cost of reading the area and writing back its live
+ * objects, and the age is the number of gc cycles since the area was last
+ * collected.  Old areas are preferred, so static data still gets moved and
+ * wear stays level.
+ *
+ * @return                  The index of the area to collect;
+ *                          NFFS_AREA_ID_NONE if no area has reclaimable
+ *                              space.
+ */
+static uint8_t
+nffs_gc_bg_select_area(void)
+{
+    const struct nffs_area *area;
+    uint64_t best_score;
+    uint64_t score;
+    uint32_t reclaim;
+    uint32_t used;
+    uint32_t live;
+    uint8_t best_area_idx;
+    uint8_t newest_seq;
+    uint8_t age;
+    int i;
+
+    newest_seq = 0;
+    for (i = 0; i < nffs_num_areas; i++) {
+        if (i != nffs_scratch_area_idx &&
+            (int8_t)(nffs_areas[i].na_gc_seq - newest_seq) > 0) {
+
+            newest_seq = nffs_areas[i].na_gc_seq;
+        }
+    }
+
+    best_area_idx = NFFS_AREA_ID_NONE;
+    best_score = 0;
+    for (i = 0; i < nffs_num_areas; i++) {
+        if (i == nffs_scratch_area_idx) {
+            continue;
+        }
+
+        area = nffs_areas + i;
+        used = area->na_cur - sizeof (struct nffs_disk_area);
+        live = nffs_gc_bg_live[i];
+        if (live > used) {
+            live = used;
+        }
+
+        /* The live objects have to fit in the scratch area. */
+        if (live + sizeof (struct nffs_disk_area) >
+            nffs_areas[nffs_scratch_area_idx].na_length) {
+
+            continue;
+        }
+
+        reclaim = used - live;
+        if (reclaim == 0) {
+            continue;
+        }
+
+        age = newest_seq - area->na_gc_seq + 1;
+        score = (uint64_t)reclaim * age / (used + live);
+        if (best_area_idx == NFFS_AREA_ID_NONE || score > best_score) {
+            best_area_idx = i;
+            best_score = score;
+        }
+    }
+
+    return best_area_idx;
+}
+
+void
+nffs_gc_bg_cancel_scan(void)
+{
+    if (nffs_gc_bg_phase == NFFS_GC_BG_PHASE_SCAN) {
+        free(nffs_gc_bg_live);
+        nffs_gc_bg_live = NULL;
+        nffs_gc_bg_phase = NFFS_GC_BG_PHASE_IDLE;
+    }
+}
+
+/**
+ * Forgets any background cycle in progress.  Called when the RAM
+ * representation is discarded; a partially filled destination area is
+ * detected and erased by the next restore.
+ */
+void
+nffs_gc_bg_reset(void)
+{
+    nffs_gc_bg_cancel_scan();
+    nffs_gc_from_area_idx = NFFS_AREA_ID_NONE;
+    nffs_gc_bg_phase = NFFS_GC_BG_PHASE_IDLE;
+}
+
+/**
+ * Synchronously completes the background cycle in progress, if any.
+ *
+ * @param out_area_idx      On success, the index of the cleaned up area gets
+ *                              written here if a cycle was completed.  Pass
+ *                              null if you do not need this information.
+ *
+ * @return                  0 on success; nonzero on error.
+ */
+int
+nffs_gc_bg_complete(uint8_t *out_area_idx)
+{
+    uint8_t from_area_idx;
+    int rc;
+
+    from_area_idx = nffs_gc_from_area_idx;
+    if (from_area_idx == NFFS_AREA_ID_NONE) {
+        return 0;
+    }
+
+    rc = nffs_gc_copy_area(from_area_idx, nffs_gc_bg_bucket);
+    if (rc != 0) {
+        return rc;
+    }
+
+    nffs_gc_from_area_idx = NFFS_AREA_ID_NONE;
+    nffs_gc_bg_phase = NFFS_GC_BG_PHASE_IDLE;
+
+    return nffs_gc_finish(from_area_idx, out_area_idx);
+}
+
+/**
+ * Performs background garbage collection for up to NFFS_GC_BG_SLICE_MS.  A
+ * cycle first scans the hash table to count the live bytes in each area,
+ * then copies the live objects out of the selected area, one hash bucket at
+ * a time.  If the cycle is not complete when the time slice expires, the
+ * background event is posted again.
+ *
+ * @return                  0 on success; nonzero on error.
+ */
+int
+nffs_gc_bg_step(void)
+{
+    os_time_t start;
+    os_time_t slice;
+    uint8_t from_area_idx;
+    int rc;
+
+    if (nffs_scratch_area_idx == NFFS_AREA_ID_NONE) {
+        /* File system not restored yet. */
+        return 0;
+    }
+
+    if (nffs_gc_bg_phase == NFFS_GC_BG_PHASE_IDLE) {
+        if (nffs_gc_bg_free_space() >= nffs_gc_bg_reserve) {
+            return 0;
+        }
+
+        nffs_gc_bg_live = calloc(nffs_num_areas, sizeof *nffs_gc_bg_live);
+        if (nffs_gc_bg_live == NULL) {
+            return FS_ENOMEM;
+        }
+        nffs_gc_bg_phase = NFFS_GC_BG_PHASE_SCAN;
+        nffs_gc_bg_bucket = 0;
+    }
+
+    start = os_time_get();
+    slice = os_time_ms_to_ticks32(MYNEWT_VAL(NFFS_GC_BG_SLICE_MS));
+
+    do {
+        if (nffs_gc_bg_phase == NFFS_GC_BG_PHASE_SCAN) {
+            if (nffs_gc_bg_bucket < nffs_hash_num_buckets) {
+                nffs_gc_bg_scan_bucket(nffs_gc_bg_bucket++);
+                continue;
+            }
+
+            from_area_idx = nffs_gc_bg_select_area();
+            nffs_gc_bg_cancel_scan();
+            if (from_area_idx == NFFS_AREA_ID_NONE) {
+                /* Nothing to reclaim. */
+                return 0;
+            }
+
+            rc = nffs_gc_begin(from_area_idx);
+            if (rc != 0) {
+                return rc;
+            }
+            nffs_gc_from_area_idx = from_area_idx;
+            nffs_gc_bg_phase = NFFS_GC_BG_PHASE_COPY;
+            nffs_gc_bg_bucket = 0;
+        } else {
+            if (nffs_gc_bg_bucket < nffs_hash_num_buckets) {
+                nffs_hash_freeze();
+                rc = nffs_gc_copy_bucket(nffs_gc_from_area_idx,
+                                         nffs_gc_bg_bucket);
+                nffs_hash_thaw();
+                if (rc != 0) {
+                    return rc;
+                }
+                nffs_gc_bg_bucket++;
+                continue;
+            }
+
+            rc = nffs_gc_bg_complete(NULL);
+            if (rc != 0) {
+                return rc;
+            }
+
+            /* Start another cycle if space is still short. */
+            nffs_gc_bg_kick();
+            return 0;
+        }
+    } while ((os_time_t)(os_time_get() - start) < slice);
+
+    if (nffs_gc_bg_evq != NULL) {
+        os_eventq_put(nffs_gc_bg_evq, &nffs_gc_bg_ev);
+    }
+
+    return 0;
+}
+
+/**
+ * Schedules background garbage collection if the free space has dropped
+ * below the configured reserve.
+ */
+void
+nffs_gc_bg_kick(void)
+{
+    if (nffs_gc_bg_evq == NULL) {
+        return;
+    }
+
+    if (nffs_gc_bg_phase != NFFS_GC_BG_PHASE_IDLE ||
+        nffs_gc_bg_free_space() < nffs_gc_bg_reserve) {
+
+        os_eventq_put(nffs_gc_bg_evq, &nffs_gc_bg_ev);
+    }
+}
+
+/**
+ * Configures background garbage collection.
+ *
+ * @param reserve           Free space, in bytes, below which a background
+ *                              cycle is started; 0 disables background
+ *                              garbage collection.
+ * @param evq               The event queue to collect from.
+ * @param cb                The event callback; it must lock the file system
+ *                              and call nffs_gc_bg_step().
+ */
+void
+nffs_gc_bg_config(uint32_t reserve, struct os_eventq *evq, os_event_fn *cb)
+{
+    if (nffs_gc_bg_evq != NULL) {
+        os_eventq_remove(nffs_gc_bg_evq, &nffs_gc_bg_ev);
+    }
+
+    if (reserve == 0) {
+        evq = NULL;
+    }
+
+    nffs_gc_bg_reserve = reserve;
+    nffs_gc_bg_evq = evq;
+    nffs_gc_bg_ev.ev_cb = cb;
+    nffs_gc_bg_ev.ev_arg = NULL;
+
+    nffs_gc_bg_kick();
+}
+
+#endif
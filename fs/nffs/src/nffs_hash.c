@@ -25,6 +25,20 @@
 
 struct nffs_hash_list *nffs_hash;
 
+/**
+ * Number of buckets currently in use.  The table is grown one bucket at a
+ * time (linear hashing): buckets [0, nffs_hash_split_idx) and
+ * [nffs_hash_round_size, nffs_hash_num_buckets) are addressed with one more
+ * ID bit than the rest.
+ */
+uint32_t nffs_hash_num_buckets;
+
+static uint32_t nffs_hash_round_size;
+static uint32_t nffs_hash_split_idx;
+static uint32_t nffs_hash_capacity;
+static uint32_t nffs_hash_num_entries;
+static uint8_t nffs_hash_freeze_cnt;
+
 uint32_t nffs_hash_next_dir_id;
 uint32_t nffs_hash_next_file_id;
 uint32_t nffs_hash_next_block_id;
@@ -53,10 +67,163 @@ nffs_hash_id_is_block(uint32_t id)
     return id >= NFFS_ID_BLOCK_MIN && id < NFFS_ID_BLOCK_MAX;
 }
 
-static int
+/**
+ * IDs are allocated sequentially within each range, so their low bits
+ * already spread evenly over the buckets.
+ */
+static uint32_t
 nffs_hash_fn(uint32_t id)
 {
-    return id % NFFS_HASH_SIZE;
+    uint32_t idx;
+
+    idx = id & (nffs_hash_round_size - 1);
+    if (idx < nffs_hash_split_idx) {
+        idx = id & ((nffs_hash_round_size << 1) - 1);
+    }
+
+    return idx;
+}
+
+struct nffs_hash_list *
+nffs_hash_bucket(uint32_t id)
+{
+    return nffs_hash + nffs_hash_fn(id);
+}
+
+#if MYNEWT_VAL(NFFS_HASH_MAX_LOAD)
+/**
+ * Splits the next bucket in the current round, moving the entries whose next
+ * ID bit is set into a new bucket at the end of the table.
+ *
+ * @return                  0 on success; FS_ENOMEM if the bucket array could
+ *                              not be enlarged.
+ */
+static int
+nffs_hash_split(void)
+{
+    struct nffs_hash_entry *entry;
+    struct nffs_hash_entry *next;
+    struct nffs_hash_list *list;
+    struct nffs_hash_list *new_list;
+    struct nffs_hash_list *buckets;
+    uint32_t new_idx;
+    uint32_t mask;
+
+    new_idx = nffs_hash_round_size + nffs_hash_split_idx;
+    if (new_idx >= nffs_hash_capacity) {
+        buckets = realloc(nffs_hash,
+                          2 * nffs_hash_capacity * sizeof *nffs_hash);
+        if (buckets == NULL) {
+            return FS_ENOMEM;
+        }
+        nffs_hash = buckets;
+        nffs_hash_capacity *= 2;
+    }
+
+    list = nffs_hash + nffs_hash_split_idx;
+    new_list = nffs_hash + new_idx;
+    mask = (nffs_hash_round_size << 1) - 1;
+
+    entry = SLIST_FIRST(list);
+    SLIST_INIT(list);
+    SLIST_INIT(new_list);
+    while (entry != NULL) {
+        next = SLIST_NEXT(entry, nhe_next);
+        if ((entry->nhe_id & mask) == new_idx) {
+            SLIST_INSERT_HEAD(new_list, entry, nhe_next);
+        } else {
+            SLIST_INSERT_HEAD(list, entry, nhe_next);
+        }
+        entry = next;
+    }
+
+    nffs_hash_split_idx++;
+    if (nffs_hash_split_idx == nffs_hash_round_size) {
+        nffs_hash_round_size <<= 1;
+        nffs_hash_split_idx = 0;
+    }
+    nffs_hash_num_buckets++;
+    STATS_INC(nffs_stats, nffs_hashcnt_split);
+
+    return 0;
+}
+#endif
+
+/**
+ * Splits buckets until the average chain length is back under
+ * NFFS_HASH_MAX_LOAD.  A single insert only ever requires one split, so the
+ * cost of growing the table is spread over the inserts.
+ */
+static void
+nffs_hash_grow(void)
+{
+#if MYNEWT_VAL(NFFS_HASH_MAX_LOAD)
+    int rc;
+
+    if (nffs_hash_freeze_cnt > 0) {
+        return;
+    }
+
+    while (nffs_hash_num_entries >
+           nffs_hash_num_buckets * MYNEWT_VAL(NFFS_HASH_MAX_LOAD)) {
+
+        rc = nffs_hash_split();
+        if (rc != 0) {
+            /* Out of memory; keep using longer chains. */
+            return;
+        }
+    }
+#endif
+}
+
+/**
+ * Prevents the table from being resized.  This must be called before
+ * iterating over the buckets with code that may insert entries, as a split
+ * would move entries into buckets that are yet to be visited.
+ */
+void
+nffs_hash_freeze(void)
+{
+    nffs_hash_freeze_cnt++;
+}
+
+/**
+ * Undoes a prior call to nffs_hash_freeze(), performing any growth that was
+ * deferred while the table was frozen.
+ */
+void
+nffs_hash_thaw(void)
+{
+    assert(nffs_hash_freeze_cnt > 0);
+    nffs_hash_freeze_cnt--;
+
+    nffs_hash_grow();
+}
+
+/**
+ * Reports the size and occupancy of the hash table.  The load factor is
+ * nhs_num_entries / nhs_num_buckets.
+ */
+void
+nffs_hash_stats(struct nffs_hash_stats *out_stats)
+{
+    struct nffs_hash_entry *entry;
+    uint32_t chain_len;
+    uint32_t i;
+
+    out_stats->nhs_num_entries = nffs_hash_num_entries;
+    out_stats->nhs_num_buckets = nffs_hash_num_buckets;
+    out_stats->nhs_max_chain = 0;
+
+    for (i = 0; i < nffs_hash_num_buckets; i++) {
+        chain_len = 0;
+        SLIST_FOREACH(entry, nffs_hash + i, nhe_next) {
+            chain_len++;
+        }
+        if (chain_len > out_stats->nhs_max_chain) {
+            out_stats->nhs_max_chain = chain_len;
+        }
+    }
 }
 
 static struct nffs_hash_entry *
@@ -65,10 +232,8 @@ nffs_hash_find_reorder(uint32_t id)
     struct nffs_hash_entry *entry;
     struct nffs_hash_entry *prev;
     struct nffs_hash_list *list;
-    int idx;
 
-    idx = nffs_hash_fn(id);
-    list = nffs_hash + idx;
+    list = nffs_hash_bucket(id);
 
     prev = NULL;
     SLIST_FOREACH(entry, list, nhe_next) {
@@ -92,10 +257,8 @@ nffs_hash_find(uint32_t id)
 {
     struct nffs_hash_entry *entry;
     struct nffs_hash_list *list;
-    int idx;
 
-    idx = nffs_hash_fn(id);
-    list = nffs_hash + idx;
+    list = nffs_hash_bucket(id);
 
     SLIST_FOREACH(entry, list, nhe_next) {
         if (entry->nhe_id == id) {
@@ -149,13 +312,12 @@ nffs_hash_insert(struct nffs_hash_entry *entry)
 {
     struct nffs_hash_list *list;
     struct nffs_inode_entry *nie;
-    int idx;
 
     assert(nffs_hash_find(entry->nhe_id) == NULL);
-    idx = nffs_hash_fn(entry->nhe_id);
-    list = nffs_hash + idx;
+    list = nffs_hash_bucket(entry->nhe_id);
 
     SLIST_INSERT_HEAD(list, entry, nhe_next);
+    nffs_hash_num_entries++;
     STATS_INC(nffs_stats, nffs_hashcnt_ins);
 
     if (nffs_hash_id_is_inode(entry->nhe_id)) {
@@ -165,6 +327,8 @@ nffs_hash_insert(struct nffs_hash_entry *entry)
     } else {
         assert(nffs_hash_find(entry->nhe_id));
     }
+
+    nffs_hash_grow();
 }
 
 void
@@ -172,7 +336,6 @@ nffs_hash_remove(struct nffs_hash_entry *entry)
 {
     struct nffs_hash_list *list;
     struct nffs_inode_entry *nie = NULL;
-    int idx;
 
     if (nffs_hash_id_is_inode(entry->nhe_id)) {
         nie = nffs_hash_find_inode(entry->nhe_id);
@@ -182,10 +345,10 @@ nffs_hash_remove(struct nffs_hash_entry *entry)
         assert(nffs_hash_find(entry->nhe_id));
     }
 
-    idx = nffs_hash_fn(entry->nhe_id);
-    list = nffs_hash + idx;
+    list = nffs_hash_bucket(entry->nhe_id);
 
     SLIST_REMOVE(list, entry, nffs_hash_entry, nhe_next);
+    nffs_hash_num_entries--;
     STATS_INC(nffs_stats, nffs_hashcnt_rm);
 
     if (nffs_hash_id_is_inode(entry->nhe_id) && nie) {
@@ -210,5 +373,12 @@ nffs_hash_init(void)
         SLIST_INIT(nffs_hash + i);
     }
 
+    nffs_hash_num_buckets = NFFS_HASH_SIZE;
+    nffs_hash_round_size = NFFS_HASH_SIZE;
+    nffs_hash_split_idx = 0;
+    nffs_hash_capacity = NFFS_HASH_SIZE;
+    nffs_hash_num_entries = 0;
+    nffs_hash_freeze_cnt = 0;
+
     return 0;
 }
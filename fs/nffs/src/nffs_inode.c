@@ -55,6 +55,7 @@ nffs_inode_entry_free(struct nffs_inode_entry *inode_entry)
     if (inode_entry != NULL) {
         assert(!nffs_inode_getflags(inode_entry, NFFS_INODE_FLAG_INHASH));
         assert(nffs_hash_id_is_inode(inode_entry->nie_hash_entry.nhe_id));
+        nffs_path_cache_remove(inode_entry);
         os_memblock_put(&nffs_inode_entry_pool, inode_entry);
     }
 }
@@ -569,6 +570,8 @@ nffs_inode_rename(struct nffs_inode_entry *inode_entry,
         return FS_EINVAL;
     }
 
+    nffs_path_cache_remove(inode_entry);
+
     rc = nffs_inode_from_entry(&inode, inode_entry);
     if (rc != 0) {
         return rc;
@@ -835,6 +838,7 @@ nffs_inode_remove_child(struct nffs_inode *child)
     SLIST_REMOVE(&parent->nie_child_list, child->ni_inode_entry,
                  nffs_inode_entry, nie_sibling_next);
     SLIST_NEXT(child->ni_inode_entry, nie_sibling_next) = NULL;
+    nffs_path_cache_remove(child->ni_inode_entry);
     nffs_inode_unsetflags(child->ni_inode_entry, NFFS_INODE_FLAG_INTREE);
 }
 
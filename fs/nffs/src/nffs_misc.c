@@ -194,6 +194,28 @@ nffs_misc_reserve_space_area(uint8_t area_idx, uint16_t space,
     return FS_EFULL;
 }
 
+/**
+ * Determines if new objects can be written to the specified area.
+ */
+static int
+nffs_misc_area_is_writable(uint8_t area_idx)
+{
+    if (area_idx == nffs_scratch_area_idx) {
+        return 0;
+    }
+
+#if MYNEWT_VAL(NFFS_GC_BG)
+    /* The area being garbage collected in the background gets erased once
+     * its objects have been copied.
+     */
+    if (area_idx == nffs_gc_from_area_idx) {
+        return 0;
+    }
+#endif
+
+    return 1;
+}
+
 /**
  * Finds an area that can accommodate an object of the specified size.  If no
  * such area exists, this function performs a garbage collection cycle.
@@ -216,10 +238,13 @@ nffs_misc_reserve_space(uint16_t space,
 
     /* Find the first area with sufficient free space. */
     for (i = 0; i < nffs_num_areas; i++) {
-        if (i != nffs_scratch_area_idx) {
+        if (nffs_misc_area_is_writable(i)) {
             rc = nffs_misc_reserve_space_area(i, space, out_area_offset);
             if (rc == 0) {
                 *out_area_idx = i;
+#if MYNEWT_VAL(NFFS_GC_BG)
+                nffs_gc_bg_kick();
+#endif
                 return 0;
             }
         }
@@ -415,6 +440,13 @@ nffs_misc_reset(void)
         return rc;
     }
 
+#if MYNEWT_VAL(NFFS_GC_BG)
+    nffs_gc_bg_reset();
+#endif
+
+    nffs_write_buf_discard(NULL);
+    nffs_path_cache_clear();
+
     free(nffs_areas);
     nffs_areas = NULL;
     nffs_num_areas = 0;
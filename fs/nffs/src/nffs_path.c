@@ -65,6 +65,144 @@ nffs_path_parser_new(struct nffs_path_parser *parser, const char *path)
     parser->npp_off = 0;
 }
 
+#if MYNEWT_VAL(NFFS_PATH_CACHE_SIZE)
+/**
+ * Maps a (directory, child name) pair to the child's inode entry.  Only
+ * successful lookups are cached, so creating a file or directory never makes
+ * an entry stale; entries are dropped when their child is removed from its
+ * directory, renamed, or freed.
+ */
+struct nffs_path_cache_entry {
+    struct nffs_inode_entry *npce_parent;
+    struct nffs_inode_entry *npce_child;
+    uint32_t npce_name_hash;
+};
+
+/** Most-recently-used first. */
+static struct nffs_path_cache_entry
+    nffs_path_cache[MYNEWT_VAL(NFFS_PATH_CACHE_SIZE)];
+static int nffs_path_cache_cnt;
+
+static uint32_t
+nffs_path_name_hash(const char *name, int name_len)
+{
+    uint32_t hash;
+    int i;
+
+    hash = 5381;
+    for (i = 0; i < name_len; i++) {
+        hash = hash * 33 + (uint8_t)name[i];
+    }
+
+    return hash;
+}
+
+static void
+nffs_path_cache_promote(int idx, const struct nffs_path_cache_entry *entry)
+{
+    memmove(nffs_path_cache + 1, nffs_path_cache,
+            idx * sizeof nffs_path_cache[0]);
+    nffs_path_cache[0] = *entry;
+}
+
+/**
+ * Looks up a child in the path cache.  A matching entry is only a candidate;
+ * its filename is compared to make sure the hash did not collide.
+ *
+ * @return                      0 on a hit; FS_ENOENT on a miss; other nonzero
+ *                                  on failure.
+ */
+static int
+nffs_path_cache_find(struct nffs_inode_entry *parent, const char *name,
+                     int name_len, uint32_t name_hash,
+                     struct nffs_inode_entry **out_inode_entry)
+{
+    struct nffs_path_cache_entry entry;
+    struct nffs_inode inode;
+    int cmp;
+    int rc;
+    int i;
+
+    for (i = 0; i < nffs_path_cache_cnt; i++) {
+        entry = nffs_path_cache[i];
+        if (entry.npce_parent != parent ||
+            entry.npce_name_hash != name_hash) {
+
+            continue;
+        }
+
+        rc = nffs_inode_from_entry(&inode, entry.npce_child);
+        if (rc != 0) {
+            return rc;
+        }
+
+        rc = nffs_inode_filename_cmp_ram(&inode, name, name_len, &cmp);
+        if (rc != 0) {
+            return rc;
+        }
+
+        if (cmp == 0) {
+            nffs_path_cache_promote(i, &entry);
+            STATS_INC(nffs_stats, nffs_pcache_hit);
+            *out_inode_entry = entry.npce_child;
+            return 0;
+        }
+    }
+
+    STATS_INC(nffs_stats, nffs_pcache_miss);
+    return FS_ENOENT;
+}
+
+static void
+nffs_path_cache_insert(struct nffs_inode_entry *parent, uint32_t name_hash,
+                       struct nffs_inode_entry *child)
+{
+    struct nffs_path_cache_entry entry;
+
+    entry.npce_parent = parent;
+    entry.npce_child = child;
+    entry.npce_name_hash = name_hash;
+
+    if (nffs_path_cache_cnt < MYNEWT_VAL(NFFS_PATH_CACHE_SIZE)) {
+        nffs_path_cache_cnt++;
+    }
+    nffs_path_cache_promote(nffs_path_cache_cnt - 1, &entry);
+}
+#endif
+
+/**
+ * Drops every path cache entry that refers to the specified inode entry,
+ * either as a directory or as a child.
+ */
+void
+nffs_path_cache_remove(const struct nffs_inode_entry *inode_entry)
+{
+#if MYNEWT_VAL(NFFS_PATH_CACHE_SIZE)
+    int i;
+
+    i = 0;
+    while (i < nffs_path_cache_cnt) {
+        if (nffs_path_cache[i].npce_parent == inode_entry ||
+            nffs_path_cache[i].npce_child == inode_entry) {
+
+            nffs_path_cache_cnt--;
+            memmove(nffs_path_cache + i, nffs_path_cache + i + 1,
+                    (nffs_path_cache_cnt - i) * sizeof nffs_path_cache[0]);
+        } else {
+            i++;
+        }
+    }
+#endif
+}
+
+void
+nffs_path_cache_clear(void)
+{
+#if MYNEWT_VAL(NFFS_PATH_CACHE_SIZE)
+    nffs_path_cache_cnt = 0;
+#endif
+}
+
 static int
 nffs_path_find_child(struct nffs_inode_entry *parent,
                      const char *name, int name_len,
@@ -72,9 +210,21 @@ nffs_path_find_child(struct nffs_inode_entry *parent,
 {
     struct nffs_inode_entry *cur;
     struct nffs_inode inode;
+#if MYNEWT_VAL(NFFS_PATH_CACHE_SIZE)
+    uint32_t name_hash;
+#endif
     int cmp;
     int rc;
 
+#if MYNEWT_VAL(NFFS_PATH_CACHE_SIZE)
+    name_hash = nffs_path_name_hash(name, name_len);
+    rc = nffs_path_cache_find(parent, name, name_len, name_hash,
+                              out_inode_entry);
+    if (rc != FS_ENOENT) {
+        return rc;
+    }
+#endif
+
     SLIST_FOREACH(cur, &parent->nie_child_list, nie_sibling_next) {
         rc = nffs_inode_from_entry(&inode, cur);
         if (rc != 0) {
@@ -87,6 +237,9 @@ nffs_path_find_child(struct nffs_inode_entry *parent,
         }
 
         if (cmp == 0) {
+#if MYNEWT_VAL(NFFS_PATH_CACHE_SIZE)
+            nffs_path_cache_insert(parent, name_hash, cur);
+#endif
             *out_inode_entry = cur;
             return 0;
         }
@@ -32,6 +32,7 @@
 extern "C" {
 #endif
 
+/** Initial number of hash buckets; must be a power of two. */
 #define NFFS_HASH_SIZE               256
 
 #define NFFS_ID_DIR_MIN              0
@@ -51,6 +52,7 @@ extern "C" {
 #define NFFS_AREA_MAGIC3             0xb185fc8e
 #define NFFS_BLOCK_MAGIC             0x53ba23b9
 #define NFFS_INODE_MAGIC             0x925f8bc0
+#define NFFS_CKPT_MAGIC              0x6a3c1d57
 
 #define NFFS_AREA_ID_NONE            0xff
 #define NFFS_AREA_VER_0                 0
@@ -106,6 +108,43 @@ struct nffs_disk_block {
 
 #define NFFS_DISK_BLOCK_OFFSET_CRC  18
 
+/**
+ * On-disk representation of a checkpoint header.  A checkpoint is a copy of
+ * the RAM index written to its own flash region; it lets a restore skip the
+ * parts of each area that were already indexed when it was taken.
+ */
+struct nffs_disk_ckpt {
+    uint32_t ndc_magic;         /* NFFS_CKPT_MAGIC */
+    uint32_t ndc_gen;           /* Incremented with every checkpoint. */
+    uint32_t ndc_num_objs;      /* Number of object records. */
+    uint16_t ndc_num_areas;     /* Number of area records. */
+    uint16_t ndc_crc16;         /* Covers rest of header and all records. */
+    /* Followed by the area records, then the object records. */
+};
+
+#define NFFS_DISK_CKPT_OFFSET_CRC   14
+
+/** State of one area at the time of a checkpoint. */
+struct nffs_disk_ckpt_area {
+    uint32_t ndca_offset;       /* Must match the area descriptor. */
+    uint32_t ndca_length;
+    uint32_t ndca_cur;          /* End of the objects in this area. */
+    uint32_t ndca_first_obj;    /* Index of this area's first object. */
+    uint32_t ndca_num_objs;     /* Number of objects in this area. */
+    uint16_t ndca_id;           /* Must match the area header. */
+    uint8_t ndca_gc_seq;
+    uint8_t ndca_flash_id;
+};
+
+/** One indexed object: where it lives, and a copy of its header. */
+struct nffs_disk_ckpt_obj {
+    uint32_t ndco_flash_loc;
+    union {
+        struct nffs_disk_inode ndco_disk_inode;
+        struct nffs_disk_block ndco_disk_block;
+    } ndco_un_obj;
+};
+
 /**
  * What gets stored in the hash table.  Each entry represents a data block or
  * an inode.
@@ -118,6 +157,13 @@ struct nffs_hash_entry {
 
 
 SLIST_HEAD(nffs_hash_list, nffs_hash_entry);
+
+/** Occupancy of the object hash table, as reported by nffs_hash_stats(). */
+struct nffs_hash_stats {
+    uint32_t nhs_num_entries;
+    uint32_t nhs_num_buckets;
+    uint32_t nhs_max_chain;     /* Length of the longest bucket chain. */
+};
 SLIST_HEAD(nffs_inode_list, nffs_inode_entry);
 
 /** Each inode hash entry is actually one of these. */
@@ -250,6 +296,7 @@ struct nffs_dir {
 STATS_SECT_START(nffs_stats)
     STATS_SECT_ENTRY(nffs_hashcnt_ins)
     STATS_SECT_ENTRY(nffs_hashcnt_rm)
+    STATS_SECT_ENTRY(nffs_hashcnt_split)
     STATS_SECT_ENTRY(nffs_object_count)
     STATS_SECT_ENTRY(nffs_iocnt_read)
     STATS_SECT_ENTRY(nffs_iocnt_write)
@@ -267,6 +314,12 @@ STATS_SECT_START(nffs_stats)
     STATS_SECT_ENTRY(nffs_readcnt_filename)
     STATS_SECT_ENTRY(nffs_readcnt_object)
     STATS_SECT_ENTRY(nffs_readcnt_detect)
+    STATS_SECT_ENTRY(nffs_dcache_hit)
+    STATS_SECT_ENTRY(nffs_dcache_miss)
+    STATS_SECT_ENTRY(nffs_dcache_readahead)
+    STATS_SECT_ENTRY(nffs_wbuf_flush)
+    STATS_SECT_ENTRY(nffs_pcache_hit)
+    STATS_SECT_ENTRY(nffs_pcache_miss)
 STATS_SECT_END
 extern STATS_SECT_DECL(nffs_stats) nffs_stats;
 
@@ -296,6 +349,7 @@ extern struct nffs_area_desc *nffs_current_area_descs;
 extern uint8_t nffs_flash_buf[NFFS_FLASH_BUF_SZ];
 
 extern struct nffs_hash_list *nffs_hash;
+extern uint32_t nffs_hash_num_buckets;
 extern struct nffs_inode_entry *nffs_root_dir;
 extern struct nffs_inode_entry *nffs_lost_found_dir;
 
@@ -345,6 +399,11 @@ void nffs_cache_inode_range(const struct nffs_cache_inode *cache_inode,
 int nffs_cache_seek(struct nffs_cache_inode *cache_inode, uint32_t to,
                     struct nffs_cache_block **out_cache_block);
 void nffs_cache_clear(void);
+#if MYNEWT_VAL(NFFS_DATA_CACHE_PAGES)
+int nffs_cache_read_data(uint8_t area_idx, uint32_t area_offset, void *dst,
+                         uint32_t len);
+void nffs_cache_data_invalidate(uint8_t area_idx);
+#endif
 
 /* @crc */
 int nffs_crc_flash(uint16_t initial_crc, uint8_t area_idx,
@@ -359,6 +418,15 @@ int nffs_crc_disk_inode_validate(const struct nffs_disk_inode *disk_inode,
 void nffs_crc_disk_inode_fill(struct nffs_disk_inode *disk_inode,
                               const char *filename);
 
+/* @ckpt */
+int nffs_ckpt_load(void);
+int nffs_ckpt_area_match(uint8_t area_idx,
+                         struct nffs_disk_ckpt_area *out_ckpt_area);
+int nffs_ckpt_read_obj(uint32_t idx, struct nffs_disk_object *out_disk_object);
+int nffs_ckpt_write(void);
+int nffs_ckpt_invalidate(void);
+int nffs_ckpt_set_region(const struct nffs_area_desc *ckpt_desc);
+
 /* @config */
 void nffs_config_init(void);
 
@@ -386,6 +454,16 @@ int nffs_format_full(const struct nffs_area_desc *area_descs);
 /* @gc */
 int nffs_gc(uint8_t *out_area_idx);
 int nffs_gc_until(uint32_t space, uint8_t *out_area_idx);
+#if MYNEWT_VAL(NFFS_GC_BG)
+extern uint8_t nffs_gc_from_area_idx;
+int nffs_gc_bg_step(void);
+int nffs_gc_bg_complete(uint8_t *out_area_idx);
+void nffs_gc_bg_cancel_scan(void);
+void nffs_gc_bg_reset(void);
+void nffs_gc_bg_kick(void);
+void nffs_gc_bg_config(uint32_t reserve, struct os_eventq *evq,
+                       os_event_fn *cb);
+#endif
 
 /* @flash */
 struct nffs_area *nffs_flash_find_area(uint16_t logical_id);
@@ -413,6 +491,10 @@ void nffs_hash_remove(struct nffs_hash_entry *entry);
 int nffs_hash_init(void);
 int nffs_hash_entry_is_dummy(struct nffs_hash_entry *he);
 int nffs_hash_id_is_dummy(uint32_t id);
+struct nffs_hash_list *nffs_hash_bucket(uint32_t id);
+void nffs_hash_freeze(void);
+void nffs_hash_thaw(void);
+void nffs_hash_stats(struct nffs_hash_stats *out_stats);
 
 /* @inode */
 struct nffs_inode_entry *nffs_inode_entry_alloc(void);
@@ -494,16 +576,20 @@ int nffs_path_unlink(const char *filename);
 int nffs_path_rename(const char *from, const char *to);
 int nffs_path_new_dir(const char *path,
                       struct nffs_inode_entry **out_inode_entry);
+void nffs_path_cache_remove(const struct nffs_inode_entry *inode_entry);
+void nffs_path_cache_clear(void);
 
 /* @restore */
 int nffs_restore_full(const struct nffs_area_desc *area_descs);
 
 /* @write */
 int nffs_write_to_file(struct nffs_file *file, const void *data, int len);
+int nffs_write_buf_flush(void);
+void nffs_write_buf_discard(const struct nffs_inode_entry *inode_entry);
 
 
 #define NFFS_HASH_FOREACH(entry, i, next)                               \
-    for ((i) = 0; (i) < NFFS_HASH_SIZE; (i)++)                          \
+    for ((i) = 0; (i) < nffs_hash_num_buckets; (i)++)                   \
         for ((entry) = SLIST_FIRST(nffs_hash + (i));                    \
              (entry) && (((next)) = SLIST_NEXT((entry), nhe_next), 1);  \
              (entry) = ((next)))
@@ -32,6 +32,19 @@
  */
 static uint16_t nffs_restore_largest_block_data_len;
 
+#if MYNEWT_VAL(NFFS_CKPT)
+/**
+ * Set while objects are replayed from a checkpoint.  Their CRCs were checked
+ * when they were first restored or written, so they are not read again.
+ */
+static uint8_t nffs_restore_trusted;
+
+/** The number of objects read by scanning areas rather than replayed. */
+static uint32_t nffs_restore_scanned;
+#else
+#define nffs_restore_trusted 0
+#endif
+
 /**
  * Checks that each block a chain of data blocks was properly restored.
  *
@@ -287,7 +300,7 @@ nffs_restore_sweep(void)
     /* Iterate through every object in the hash table, deleting all inodes that
      * should be removed.
      */
-    for (i = 0; i < NFFS_HASH_SIZE; i++) {
+    for (i = 0; i < nffs_hash_num_buckets; i++) {
         list = nffs_hash + i;
 
         entry = SLIST_FIRST(list);
@@ -479,9 +492,11 @@ nffs_restore_inode(const struct nffs_disk_inode *disk_inode, uint8_t area_idx,
     new_inode = 0;
 
     /* Check the inode's CRC.  If the inode is corrupt, discard it. */
-    rc = nffs_crc_disk_inode_validate(disk_inode, area_idx, area_offset);
-    if (rc != 0) {
-        goto err;
+    if (!nffs_restore_trusted) {
+        rc = nffs_crc_disk_inode_validate(disk_inode, area_idx, area_offset);
+        if (rc != 0) {
+            goto err;
+        }
     }
 
     inode_entry = nffs_hash_find_inode(disk_inode->ndi_id);
@@ -800,9 +815,11 @@ nffs_restore_block(const struct nffs_disk_block *disk_block, uint8_t area_idx,
     /* Check the block's CRC.  If the block is corrupt, discard it.  If this
      * block would have superseded another, the old block becomes current.
      */
-    rc = nffs_crc_disk_block_validate(disk_block, area_idx, area_offset);
-    if (rc != 0) {
-        goto err;
+    if (!nffs_restore_trusted) {
+        rc = nffs_crc_disk_block_validate(disk_block, area_idx, area_offset);
+        if (rc != 0) {
+            goto err;
+        }
     }
 
     entry = nffs_hash_find_block(disk_block->ndb_id);
@@ -1030,7 +1047,7 @@ nffs_restore_disk_object_size(const struct nffs_disk_object *disk_object)
 
 /**
  * Reads the specified area from disk and loads its contents into the RAM
- * representation.
+ * representation.  Reading starts at the area's current offset.
  *
  * @param area_idx              The index of the area to read.
  *
@@ -1045,7 +1062,6 @@ nffs_restore_area_contents(int area_idx)
 
     area = nffs_areas + area_idx;
 
-    area->na_cur = sizeof (struct nffs_disk_area);
     while (1) {
         rc = nffs_restore_disk_object(area_idx, area->na_cur,  &disk_object);
         switch (rc) {
@@ -1064,6 +1080,9 @@ nffs_restore_area_contents(int area_idx)
                 area->na_cur++;
             } else {
                 STATS_INC(nffs_stats, nffs_object_count); /* restored objects */
+#if MYNEWT_VAL(NFFS_CKPT)
+                nffs_restore_scanned++;
+#endif
                 area->na_cur += nffs_restore_disk_object_size(&disk_object);
             }
             break;
@@ -1087,6 +1106,57 @@ nffs_restore_area_contents(int area_idx)
     }
 }
 
+#if MYNEWT_VAL(NFFS_CKPT)
+/**
+ * Loads the objects a checkpoint recorded for the specified area into the
+ * RAM representation, and moves the area's current offset to the end of
+ * what was recorded.  If the area changed since the checkpoint, nothing is
+ * loaded and the whole area has to be scanned.
+ *
+ * @param area_idx              The index of the area to load.
+ *
+ * @return                      0 on success; nonzero on failure.
+ */
+static int
+nffs_restore_area_ckpt(uint8_t area_idx)
+{
+    struct nffs_disk_ckpt_area ckpt_area;
+    struct nffs_disk_object disk_object;
+    uint32_t i;
+    int rc;
+
+    rc = nffs_ckpt_area_match(area_idx, &ckpt_area);
+    if (rc == FS_ENOENT) {
+        return 0;
+    }
+    if (rc != 0) {
+        return rc;
+    }
+
+    nffs_restore_trusted = 1;
+    for (i = 0; i < ckpt_area.ndca_num_objs; i++) {
+        rc = nffs_ckpt_read_obj(ckpt_area.ndca_first_obj + i, &disk_object);
+        if (rc == 0 && disk_object.ndo_area_idx != area_idx) {
+            rc = FS_ECORRUPT;
+        }
+        if (rc != 0) {
+            break;
+        }
+
+        nffs_restore_object(&disk_object);
+        STATS_INC(nffs_stats, nffs_object_count);
+    }
+    nffs_restore_trusted = 0;
+
+    if (rc != 0) {
+        return rc;
+    }
+
+    nffs_areas[area_idx].na_cur = ckpt_area.ndca_cur;
+    return 0;
+}
+#endif
+
 /**
  * Reads and parses one area header.  This function does not read the area's
  * contents.
@@ -1159,7 +1229,7 @@ nffs_restore_corrupt_scratch(void)
     }
 
     /* Invalidate all objects resident in the bad area. */
-    for (i = 0; i < NFFS_HASH_SIZE; i++) {
+    for (i = 0; i < nffs_hash_num_buckets; i++) {
         entry = SLIST_FIRST(&nffs_hash[i]);
         while (entry != NULL) {
             next = SLIST_NEXT(entry, nhe_next);
@@ -1185,6 +1255,7 @@ nffs_restore_corrupt_scratch(void)
     /* Now that the objects in the scratch area have been invalidated, reload
      * everything from the good area.
      */
+    nffs_areas[good_idx].na_cur = sizeof (struct nffs_disk_area);
     rc = nffs_restore_area_contents(good_idx);
     if (rc != 0) {
         return rc;
@@ -1274,20 +1345,19 @@ nffs_log_contents(void)
 }
 
 /**
- * Searches for a valid nffs file system among the specified areas.  This
- * function succeeds if a file system is detected among any subset of the
- * supplied areas.  If the area set does not contain a valid file system,
- * a new one can be created via a call to nffs_format().
+ * Performs a single restore attempt; see nffs_restore_full().
  *
  * @param area_descs        The area set to search.  This array must be
  *                              terminated with a 0-length area.
+ * @param use_ckpt          Whether to load unchanged areas from the
+ *                              checkpoint rather than scanning them.
  *
  * @return                  0 on success;
  *                          FS_ECORRUPT if no valid file system was detected;
  *                          other nonzero on error.
  */
-int
-nffs_restore_full(const struct nffs_area_desc *area_descs)
+static int
+nffs_restore_full_once(const struct nffs_area_desc *area_descs, int use_ckpt)
 {
     struct nffs_disk_area disk_area;
     int cur_area_idx;
@@ -1301,6 +1371,9 @@ nffs_restore_full(const struct nffs_area_desc *area_descs)
         return rc;
     }
     nffs_restore_largest_block_data_len = 0;
+#if MYNEWT_VAL(NFFS_CKPT)
+    nffs_restore_scanned = 0;
+#endif
     nffs_current_area_descs = (struct nffs_area_desc*) area_descs;
 
     /* Read each area from flash. */
@@ -1357,6 +1430,14 @@ nffs_restore_full(const struct nffs_area_desc *area_descs)
             } else {
                 nffs_areas[cur_area_idx].na_cur =
                     sizeof (struct nffs_disk_area);
+#if MYNEWT_VAL(NFFS_CKPT)
+                if (use_ckpt) {
+                    rc = nffs_restore_area_ckpt(cur_area_idx);
+                    if (rc != 0) {
+                        goto err;
+                    }
+                }
+#endif
                 nffs_restore_area_contents(cur_area_idx);
             }
         }
@@ -1396,9 +1477,12 @@ nffs_restore_full(const struct nffs_area_desc *area_descs)
     }
 
     /* Delete from RAM any objects that were invalidated when subsequent areas
-     * were restored.
+     * were restored.  The sweep may create the lost+found directory; keep
+     * the hash table from being resized while it iterates over the buckets.
      */
+    nffs_hash_freeze();
     nffs_restore_sweep();
+    nffs_hash_thaw();
 
     /* Set the maximum data block size according to the size of the smallest
      * area.
@@ -1417,3 +1501,52 @@ err:
     nffs_misc_reset();
     return rc;
 }
+
+/**
+ * Searches for a valid nffs file system among the specified areas.  This
+ * function succeeds if a file system is detected among any subset of the
+ * supplied areas.  If the area set does not contain a valid file system,
+ * a new one can be created via a call to nffs_format().
+ *
+ * If a checkpoint is available, areas that only had objects appended since
+ * it was taken are loaded from it and scanned from the checkpointed end on;
+ * if anything about the checkpoint turns out wrong, the restore is redone
+ * with full scans.
+ *
+ * @param area_descs        The area set to search.  This array must be
+ *                              terminated with a 0-length area.
+ *
+ * @return                  0 on success;
+ *                          FS_ECORRUPT if no valid file system was detected;
+ *                          other nonzero on error.
+ */
+int
+nffs_restore_full(const struct nffs_area_desc *area_descs)
+{
+#if MYNEWT_VAL(NFFS_CKPT)
+    int rc;
+
+    if (nffs_ckpt_load() == 0) {
+        rc = nffs_restore_full_once(area_descs, 1);
+        if (rc == 0) {
+            goto done;
+        }
+        NFFS_LOG_DEBUG("checkpoint unusable; rc=%d\n", rc);
+    }
+
+    rc = nffs_restore_full_once(area_descs, 0);
+    if (rc != 0) {
+        return rc;
+    }
+
+done:
+    /* Refresh the checkpoint once enough had to be scanned. */
+    if (nffs_restore_scanned >= MYNEWT_VAL(NFFS_CKPT_REFRESH_CNT)) {
+        nffs_ckpt_write();
+    }
+
+    return 0;
+#else
+    return nffs_restore_full_once(area_descs, 0);
+#endif
+}
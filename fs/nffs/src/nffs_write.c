@@ -373,6 +373,103 @@ nffs_write_chunk(struct nffs_inode_entry *inode_entry, uint32_t file_offset,
     return 0;
 }
 
+#if MYNEWT_VAL(NFFS_WRITE_BUF_SIZE)
+/**
+ * Write-back buffer for appends.  It holds data appended to the end of a
+ * single file that has not been written to flash yet; see
+ * nffs_write_buf_flush().
+ */
+static struct nffs_inode_entry *nffs_write_buf_inode;
+static uint8_t nffs_write_buf[MYNEWT_VAL(NFFS_WRITE_BUF_SIZE)];
+static uint16_t nffs_write_buf_len;
+
+/**
+ * Returns the number of bytes the write-back buffer can hold; a full buffer
+ * is written out as a single data block.
+ */
+static uint16_t
+nffs_write_buf_capacity(void)
+{
+    if (sizeof nffs_write_buf > nffs_block_max_data_sz) {
+        return nffs_block_max_data_sz;
+    }
+    return sizeof nffs_write_buf;
+}
+
+/**
+ * Adds appended data to the write-back buffer.  The caller ensures the data
+ * fits.  The buffer is written out as soon as it fills up.
+ */
+static int
+nffs_write_buf_append(struct nffs_file *file, const uint8_t *data, int len)
+{
+    memcpy(nffs_write_buf + nffs_write_buf_len, data, len);
+    nffs_write_buf_len += len;
+    nffs_write_buf_inode = file->nf_inode_entry;
+    file->nf_offset += len;
+
+    if (nffs_write_buf_len == nffs_write_buf_capacity()) {
+        return nffs_write_buf_flush();
+    }
+
+    return 0;
+}
+#endif
+
+/**
+ * Writes the contents of the write-back buffer to flash as a single block.
+ * This must be called before any operation that reads the buffered file's
+ * contents or length, or that may delete an inode.
+ *
+ * @return                      0 on success; nonzero on failure.  On failure,
+ *                                  the data remains buffered.
+ */
+int
+nffs_write_buf_flush(void)
+{
+#if MYNEWT_VAL(NFFS_WRITE_BUF_SIZE)
+    struct nffs_cache_inode *cache_inode;
+    int rc;
+
+    if (nffs_write_buf_len == 0) {
+        nffs_write_buf_inode = NULL;
+        return 0;
+    }
+
+    rc = nffs_cache_inode_ensure(&cache_inode, nffs_write_buf_inode);
+    if (rc != 0) {
+        return rc;
+    }
+
+    rc = nffs_write_chunk(nffs_write_buf_inode, cache_inode->nci_file_size,
+                          nffs_write_buf, nffs_write_buf_len);
+    if (rc != 0) {
+        return rc;
+    }
+
+    STATS_INC(nffs_stats, nffs_wbuf_flush);
+    nffs_write_buf_inode = NULL;
+    nffs_write_buf_len = 0;
+#endif
+
+    return 0;
+}
+
+/**
+ * Drops the contents of the write-back buffer without writing them.  If an
+ * inode is specified, the buffer is only dropped if it belongs to that inode.
+ */
+void
+nffs_write_buf_discard(const struct nffs_inode_entry *inode_entry)
+{
+#if MYNEWT_VAL(NFFS_WRITE_BUF_SIZE)
+    if (inode_entry == NULL || inode_entry == nffs_write_buf_inode) {
+        nffs_write_buf_inode = NULL;
+        nffs_write_buf_len = 0;
+    }
+#endif
+}
+
 /**
  * Writes a chunk of contiguous data to a file.
  *
@@ -387,6 +484,7 @@ nffs_write_to_file(struct nffs_file *file, const void *data, int len)
 {
     struct nffs_cache_inode *cache_inode;
     const uint8_t *data_ptr;
+    uint32_t file_size;
     uint16_t chunk_size;
     int rc;
 
@@ -398,17 +496,47 @@ nffs_write_to_file(struct nffs_file *file, const void *data, int len)
         return 0;
     }
 
+#if MYNEWT_VAL(NFFS_WRITE_BUF_SIZE)
+    /* The buffer only ever holds data for one file. */
+    if (nffs_write_buf_inode != file->nf_inode_entry) {
+        rc = nffs_write_buf_flush();
+        if (rc != 0) {
+            return rc;
+        }
+    }
+#endif
+
     rc = nffs_cache_inode_ensure(&cache_inode, file->nf_inode_entry);
     if (rc != 0) {
         return rc;
     }
 
+    file_size = cache_inode->nci_file_size;
+#if MYNEWT_VAL(NFFS_WRITE_BUF_SIZE)
+    file_size += nffs_write_buf_len;
+#endif
+
     /* The append flag forces all writes to the end of the file, regardless of
      * seek position.
      */
     if (file->nf_access_flags & FS_ACCESS_APPEND) {
-        file->nf_offset = cache_inode->nci_file_size;
+        file->nf_offset = file_size;
+    }
+
+#if MYNEWT_VAL(NFFS_WRITE_BUF_SIZE)
+    /* Small appends are coalesced in the write-back buffer.  Anything else
+     * requires the buffered data to be written first.
+     */
+    if (file->nf_offset == file_size &&
+        nffs_write_buf_len + len <= nffs_write_buf_capacity()) {
+        return nffs_write_buf_append(file, data, len);
+    }
+
+    rc = nffs_write_buf_flush();
+    if (rc != 0) {
+        return rc;
     }
+#endif
 
     /* Write data as a sequence of blocks. */
     data_ptr = data;
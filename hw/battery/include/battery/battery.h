@@ -124,6 +124,9 @@ struct battery {
     /* Battery last reading time stamp. */
     os_time_t b_last_read_time;
 
+    /* Set by battery_mgr_poll_now(), polls on next manager event. */
+    volatile uint8_t b_poll_now;
+
     /* A list of listeners that are registered to receive data from this
      * battery.
      */
@@ -270,6 +273,17 @@ struct os_dev *battery_mgr_find_by_name(const char *name);
  */
 void battery_mgr_process_event(struct os_event *event);
 
+/**
+ * Read all subscribed properties of a battery as soon as possible,
+ * regardless of poll rate and property poll intervals.  Meant to be
+ * called from a fuel gauge interrupt (alert pin) handler, so that
+ * properties can be polled slowly and still be reported promptly when
+ * the gauge flags a change.  Can be called from interrupt context.
+ *
+ * @param The battery to poll
+ */
+void battery_mgr_poll_now(struct os_dev *battery);
+
 /**
  * Returns number of batteries in the system.
  *
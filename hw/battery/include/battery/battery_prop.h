@@ -230,6 +230,16 @@ struct battery_property {
     /* Value of property is valid */
     uint8_t                   bp_valid:1;
     battery_property_value_t  bp_value;
+#if MYNEWT_VAL(BATTERY_PROP_FILTER)
+    /* Ticks between reads, 0 reads on every battery poll */
+    os_time_t                 bp_poll_itvl;
+    /* Time of next read */
+    os_time_t                 bp_next_poll;
+    /* Smallest change reported to change listeners */
+    battery_property_value_t  bp_change_thresh;
+    /* Value last reported to change listeners */
+    battery_property_value_t  bp_reported;
+#endif
 };
 
 static inline int driver_property(const struct battery_property *prop)
@@ -304,6 +314,38 @@ int battery_prop_poll_subscribe(struct battery_prop_listener *listener,
 int battery_prop_poll_unsubscribe(struct battery_prop_listener *listener,
         struct battery_property *prop);
 
+#if MYNEWT_VAL(BATTERY_PROP_FILTER)
+/**
+ * Set how often a property is read.  The property is then read on the
+ * first battery poll after this interval has passed, rather than on
+ * every battery poll.
+ *
+ * @param The battery property, must be a driver property
+ * @param Read interval in milliseconds, 0 reads on every battery poll
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+int battery_prop_set_poll_interval_ms(struct battery_property *prop,
+        uint32_t itvl_ms);
+
+/**
+ * Set the smallest change of a property that is reported to change
+ * listeners.  Changes are measured against the value of the last
+ * notification, so slow drifts are still reported once they add up.
+ * The threshold is in the property's own unit and field of
+ * battery_property_value_t (e.g. bpv_voltage for voltages,
+ * bpv_temperature for temperatures).  Status, capacity level and
+ * alarm properties report every change.
+ *
+ * @param The battery property
+ * @param Change threshold, zero reports every change
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+int battery_prop_set_change_threshold(struct battery_property *prop,
+        battery_property_value_t thresh);
+#endif
+
 typedef int (*battery_prop_read_t)(struct battery_prop_listener *listener,
         const struct battery_property *prop);
 
@@ -70,13 +70,14 @@ battery_mgr_evq_set(struct os_eventq *evq)
     battery_manager.bm_eventq = evq;
 }
 
-static void battery_mgr_poll_battery(struct battery *battery);
+static void battery_mgr_poll_battery(struct battery *battery, bool force);
 
 static void
 battery_poll_event_cb(struct os_event *ev)
 {
     int i;
     int pflag;
+    bool force;
     os_time_t next_poll = 0;
     os_time_t now = os_time_get();
     struct battery *bat;
@@ -86,11 +87,18 @@ battery_poll_event_cb(struct os_event *ev)
     for (i = 0; i < BATTERY_MAX_COUNT; ++i) {
         bat = battery_manager.bm_batteries[i];
         if (bat) {
-            if (OS_TIME_TICK_GEQ(now, bat->b_next_run)) {
+            force = bat->b_poll_now;
+            if (force || (bat->b_poll_rate &&
+                          OS_TIME_TICK_GEQ(now, bat->b_next_run))) {
+                bat->b_poll_now = 0;
                 bat->b_last_read_time = now;
-                battery_mgr_poll_battery(battery_manager.bm_batteries[i]);
+                battery_mgr_poll_battery(battery_manager.bm_batteries[i],
+                                         force);
                 bat->b_next_run = now + os_time_ms_to_ticks32(bat->b_poll_rate);
             }
+            if (bat->b_poll_rate == 0) {
+                continue;
+            }
             if ((pflag == 0) || OS_TIME_TICK_LT(bat->b_next_run, next_poll)) {
                 pflag = 1;
                 next_poll = bat->b_next_run;
@@ -107,6 +115,15 @@ battery_poll_event_cb(struct os_event *ev)
     }
 }
 
+void
+battery_mgr_poll_now(struct os_dev *battery)
+{
+    struct battery *bat = (struct battery *)battery;
+
+    bat->b_poll_now = 1;
+    os_callout_reset(&battery_manager.bm_poll_callout, 0);
+}
+
 void
 battery_mgr_process_event(struct os_event *event)
 {
@@ -392,17 +409,91 @@ battery_find_property_by_name(struct os_dev *battery, const char *name)
     return NULL;
 }
 
+#if MYNEWT_VAL(BATTERY_PROP_FILTER)
+static uint32_t
+battery_abs_diff_i32(int32_t a, int32_t b)
+{
+    return a > b ? (uint32_t)a - (uint32_t)b : (uint32_t)b - (uint32_t)a;
+}
+
+static uint32_t
+battery_abs_diff_u32(uint32_t a, uint32_t b)
+{
+    return a > b ? a - b : b - a;
+}
+
+/*
+ * Checks if a property moved by at least its change threshold since it
+ * was last reported.  Enumerations and alarm properties have no
+ * magnitude; any change counts.
+ */
+static bool
+battery_prop_change_reportable(const struct battery_property *prop)
+{
+    const battery_property_value_t *val = &prop->bp_value;
+    const battery_property_value_t *rep = &prop->bp_reported;
+    const battery_property_value_t *thr = &prop->bp_change_thresh;
+    uint32_t diff;
+    float fdiff;
+
+    if (prop->bp_flags == BATTERY_PROPERTY_FLAGS_NONE) {
+        switch (prop->bp_type) {
+        case BATTERY_PROP_TEMP_NOW:
+        case BATTERY_PROP_TEMP_AMBIENT:
+            fdiff = val->bpv_temperature - rep->bpv_temperature;
+            if (fdiff < 0) {
+                fdiff = -fdiff;
+            }
+            return fdiff > 0 && fdiff >= thr->bpv_temperature;
+        case BATTERY_PROP_VOLTAGE_MIN:
+        case BATTERY_PROP_VOLTAGE_MAX:
+        case BATTERY_PROP_VOLTAGE_MIN_DESIGN:
+        case BATTERY_PROP_VOLTAGE_MAX_DESIGN:
+        case BATTERY_PROP_VOLTAGE_NOW:
+        case BATTERY_PROP_VOLTAGE_AVG:
+        case BATTERY_PROP_CURRENT_MAX:
+        case BATTERY_PROP_CURRENT_NOW:
+        case BATTERY_PROP_CURRENT_AVG:
+            diff = battery_abs_diff_i32(val->bpv_i32, rep->bpv_i32);
+            return diff > 0 && diff >= (uint32_t)thr->bpv_i32;
+        case BATTERY_PROP_CAPACITY:
+        case BATTERY_PROP_CAPACITY_FULL:
+        case BATTERY_PROP_TIME_TO_EMPTY_NOW:
+        case BATTERY_PROP_TIME_TO_FULL_NOW:
+            diff = battery_abs_diff_u32(val->bpv_u32, rep->bpv_u32);
+            return diff > 0 && diff >= thr->bpv_u32;
+        case BATTERY_PROP_SOC:
+        case BATTERY_PROP_SOH:
+            diff = battery_abs_diff_u32(val->bpv_u8, rep->bpv_u8);
+            return diff > 0 && diff >= thr->bpv_u8;
+        case BATTERY_PROP_CYCLE_COUNT:
+            diff = battery_abs_diff_u32(val->bpv_u16, rep->bpv_u16);
+            return diff > 0 && diff >= thr->bpv_u16;
+        default:
+            break;
+        }
+    }
+
+    return memcmp(val, rep, sizeof(*val)) != 0;
+}
+#endif
+
 static void
 battery_mgr_poll_battery_driver(struct battery *bat,
-        struct battery_driver *drv, uint32_t changed[], uint32_t queried[])
+        struct battery_driver *drv, bool force, os_time_t now,
+        uint32_t changed[], uint32_t queried[])
 {
     int i;
-    battery_property_value_t old_val;
     struct battery_property *prop = &bat->b_properties[drv->bd_first_property];
+#if MYNEWT_VAL(BATTERY_PROP_FILTER)
+    bool was_valid;
+#else
+    battery_property_value_t old_val;
+#endif
 
     /* Read requested properties */
     for (i = 0; i < drv->bd_property_count; ++i, ++prop) {
-        if (!GET_BIT(bat->b_polled_properties, i)) {
+        if (!GET_BIT(bat->b_polled_properties, prop->bp_prop_num)) {
             continue;
         }
 
@@ -410,24 +501,42 @@ battery_mgr_poll_battery_driver(struct battery *bat,
             continue;
         }
 
+#if MYNEWT_VAL(BATTERY_PROP_FILTER)
+        if (!force && prop->bp_poll_itvl &&
+            OS_TIME_TICK_LT(now, prop->bp_next_poll)) {
+            continue;
+        }
+        prop->bp_next_poll = now + prop->bp_poll_itvl;
+        was_valid = prop->bp_valid;
+#else
         old_val = prop->bp_value;
+#endif
+
         if (drv->bd_funcs->bdf_property_get(drv, prop, 100)) {
             prop->bp_valid = 0;
         } else {
             prop->bp_valid = 1;
+#if MYNEWT_VAL(BATTERY_PROP_FILTER)
+            if (!was_valid || battery_prop_change_reportable(prop)) {
+                prop->bp_reported = prop->bp_value;
+                set_bit(changed, prop->bp_prop_num);
+            }
+#else
             if (memcmp(&old_val, &prop->bp_value, sizeof(old_val))) {
                 set_bit(changed, prop->bp_prop_num);
             }
+#endif
             set_bit(queried, prop->bp_prop_num);
         }
     }
 }
 
 static void
-battery_mgr_poll_battery(struct battery *battery)
+battery_mgr_poll_battery(struct battery *battery, bool force)
 {
     uint32_t changed[BATTERY_PROPERTY_MASK_SIZE] = {0};
     uint32_t queried[BATTERY_PROPERTY_MASK_SIZE] = {0};
+    os_time_t now = os_time_get();
     uint32_t masked;
     int first_one;
     struct listener_data *ld;
@@ -439,7 +548,8 @@ battery_mgr_poll_battery(struct battery *battery)
     for(i = 0; i < BATTERY_DRIVERS_MAX; ++i) {
         driver = battery->b_drivers[i];
         if (driver) {
-            battery_mgr_poll_battery_driver(battery, driver, changed, queried);
+            battery_mgr_poll_battery_driver(battery, driver, force, now,
+                                            changed, queried);
         }
     }
 
@@ -482,6 +592,35 @@ battery_mgr_poll_battery(struct battery *battery)
     }
 }
 
+#if MYNEWT_VAL(BATTERY_PROP_FILTER)
+int
+battery_prop_set_poll_interval_ms(struct battery_property *prop,
+        uint32_t itvl_ms)
+{
+    if (prop == NULL || !driver_property(prop)) {
+        return -1;
+    }
+
+    prop->bp_poll_itvl = os_time_ms_to_ticks32(itvl_ms);
+    prop->bp_next_poll = os_time_get();
+
+    return 0;
+}
+
+int
+battery_prop_set_change_threshold(struct battery_property *prop,
+        battery_property_value_t thresh)
+{
+    if (prop == NULL) {
+        return -1;
+    }
+
+    prop->bp_change_thresh = thresh;
+
+    return 0;
+}
+#endif
+
 int
 battery_set_poll_rate_ms(struct os_dev *battery, uint32_t poll_rate)
 {
@@ -561,6 +700,12 @@ battery_add_driver(struct os_dev *battery, struct battery_driver *driver)
         prop->bp_drv_num = drv_num;
         prop->bp_bat_num = bat_num;
         prop->bp_prop_num = j;
+#if MYNEWT_VAL(BATTERY_PROP_FILTER)
+        prop->bp_poll_itvl = 0;
+        prop->bp_next_poll = 0;
+        memset(&prop->bp_change_thresh, 0, sizeof(prop->bp_change_thresh));
+        memset(&prop->bp_reported, 0, sizeof(prop->bp_reported));
+#endif
     }
     bat->b_all_property_count = j;
 
@@ -817,6 +962,7 @@ battery_init(struct os_dev *dev, void *arg)
     battery_manager.bm_batteries[i] = bat;
 
     memset(bat->b_drivers, 0, sizeof(bat->b_drivers));
+    bat->b_poll_now = 0;
 
     return 0;
 }
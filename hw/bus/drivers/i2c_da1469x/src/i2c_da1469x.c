@@ -429,6 +429,15 @@ i2c_da1469x_configure(struct bus_dev *bdev, struct bus_node *bnode)
     BUS_DEBUG_VERIFY_DEV(dev);
     BUS_DEBUG_VERIFY_NODE(node);
 
+    /*
+     * Controller has to be disabled to change target address or speed, so
+     * avoid this if previous node used the same settings.
+     */
+    if (current_node && (current_node->addr == node->addr) &&
+        (current_node->freq == node->freq)) {
+        return 0;
+    }
+
     i2c_regs = da1469x_i2c[dev->cfg.i2c_num].regs;
 
     if (i2c_regs->I2C_ENABLE_REG & I2C_I2C_ENABLE_REG_I2C_EN_Msk) {
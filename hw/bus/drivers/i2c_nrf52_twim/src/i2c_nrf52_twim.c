@@ -18,6 +18,7 @@
  */
 
 #include <assert.h>
+#include <string.h>
 #include "defs/error.h"
 #include "hal/hal_gpio.h"
 #include "bus/bus.h"
@@ -38,6 +39,13 @@
      (GPIO_PIN_CNF_INPUT_Connect << GPIO_PIN_CNF_INPUT_Pos) |   \
      (GPIO_PIN_CNF_DIR_Input << GPIO_PIN_CNF_DIR_Pos))
 
+/* Longest transfer EasyDMA can do in one go */
+#if defined(TWIM0_EASYDMA_MAXCNT_SIZE)
+#define TWIM_MAXCNT_MAX     ((1 << TWIM0_EASYDMA_MAXCNT_SIZE) - 1)
+#else
+#define TWIM_MAXCNT_MAX     255
+#endif
+
 #if MYNEWT_VAL(I2C_NRF52_TWIM_STAT)
 STATS_SECT_START(twim_stats_section)
     STATS_SECT_ENTRY(sda_lo_err)        /* SDA pulled low on r/w */
@@ -81,6 +89,11 @@ struct twim_dev_data {
     uint32_t errorsrc;
     bool suspended;
 
+#if MYNEWT_VAL(I2C_NRF52_TWIM_BOUNCE_BUF_SIZE)
+    /* For data which EasyDMA can't access, i.e. not in data RAM */
+    uint8_t bounce_buf[MYNEWT_VAL(I2C_NRF52_TWIM_BOUNCE_BUF_SIZE)];
+#endif
+
 #if MYNEWT_VAL(I2C_NRF52_TWIM_STAT)
     STATS_SECT_DECL(twim_stats_section) stats;
 #endif
@@ -459,6 +472,10 @@ bus_i2c_nrf52_twim_read(struct bus_dev *bdev, struct bus_node *bnode,
         return SYS_ENOTSUP;
     }
 
+    if (length > TWIM_MAXCNT_MAX) {
+        return SYS_EINVAL;
+    }
+
     nrf_twim = twims[dev->cfg.i2c_num].nrf_twim;
     dd = &twim_devs_data[dev->cfg.i2c_num];
 
@@ -516,11 +533,33 @@ bus_i2c_nrf52_twim_write(struct bus_dev *bdev, struct bus_node *bnode,
     BUS_DEBUG_VERIFY_DEV(dev);
     BUS_DEBUG_VERIFY_NODE(node);
 
+    if (length > TWIM_MAXCNT_MAX) {
+        return SYS_EINVAL;
+    }
+
     last_op = !(flags & BUS_F_NOSTOP);
 
     nrf_twim = twims[dev->cfg.i2c_num].nrf_twim;
     dd = &twim_devs_data[dev->cfg.i2c_num];
 
+    /*
+     * EasyDMA transfers directly from caller buffer, unless it is located
+     * outside data RAM (e.g. const data in flash) where EasyDMA can't access
+     * it. Such data is copied to bounce buffer first.
+     */
+    if (!nrfx_is_in_ram(buf)) {
+#if MYNEWT_VAL(I2C_NRF52_TWIM_BOUNCE_BUF_SIZE)
+        if (length > sizeof(dd->bounce_buf)) {
+            return SYS_EINVAL;
+        }
+
+        memcpy(dd->bounce_buf, buf, length);
+        buf = dd->bounce_buf;
+#else
+        return SYS_EINVAL;
+#endif
+    }
+
     if (!dd->suspended) {
         nrf_twim_fix_sda(nrf_twim, dd);
     }
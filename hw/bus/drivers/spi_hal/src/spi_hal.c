@@ -53,6 +53,34 @@ bus_spi_txrx_cb(void *arg, int len)
 
     os_sem_release(&dev->sem);
 }
+
+/*
+ * On MCUs where SPI HAL uses DMA for non-blocking transfers (e.g. SPIM on
+ * nRF52), data are transferred directly from/to caller buffers.
+ */
+static int
+bus_spi_txrx_noblock(struct bus_spi_hal_dev *dev, uint8_t *txbuf,
+                     uint8_t *rxbuf, uint16_t length, os_time_t timeout)
+{
+    int rc;
+
+    rc = hal_spi_txrx_noblock(dev->spi_dev.cfg.spi_num, txbuf, rxbuf, length);
+    if (rc) {
+        return rc;
+    }
+
+    rc = os_sem_pend(&dev->sem, timeout);
+    if (rc == OS_TIMEOUT) {
+        hal_spi_abort(dev->spi_dev.cfg.spi_num);
+        /* Transfer may have completed just before it was aborted */
+        if (os_sem_get_count(&dev->sem)) {
+            os_sem_pend(&dev->sem, 0);
+        }
+        return SYS_ETIMEOUT;
+    }
+
+    return 0;
+}
 #endif
 
 static int
@@ -132,7 +160,6 @@ bus_spi_read(struct bus_dev *bdev, struct bus_node *bnode, uint8_t *buf,
     struct bus_spi_hal_dev *dev = (struct bus_spi_hal_dev *)bdev;
     struct bus_spi_node *node = (struct bus_spi_node *)bnode;
     int rc;
-    (void)timeout;
 
     BUS_DEBUG_VERIFY_DEV(&dev->spi_dev);
     BUS_DEBUG_VERIFY_NODE(node);
@@ -145,11 +172,9 @@ bus_spi_read(struct bus_dev *bdev, struct bus_node *bnode, uint8_t *buf,
     memset(buf, 0xFF, length);
 
 #if MYNEWT_VAL(SPI_HAL_USE_NOBLOCK)
-    rc = hal_spi_txrx_noblock(dev->spi_dev.cfg.spi_num, buf, buf, length);
-    if (rc == 0) {
-        os_sem_pend(&dev->sem, OS_TIMEOUT_NEVER);
-    }
+    rc = bus_spi_txrx_noblock(dev, buf, buf, length, timeout);
 #else
+    (void)timeout;
     rc = hal_spi_txrx(dev->spi_dev.cfg.spi_num, buf, buf, length);
 #endif
 
@@ -176,10 +201,7 @@ bus_spi_write(struct bus_dev *bdev, struct bus_node *bnode, const uint8_t *buf,
     /* XXX update HAL to accept const instead */
 
 #if MYNEWT_VAL(SPI_HAL_USE_NOBLOCK)
-    rc = hal_spi_txrx_noblock(dev->spi_dev.cfg.spi_num, (uint8_t *)buf, NULL, length);
-    if (rc == 0) {
-        os_sem_pend(&dev->sem, OS_TIMEOUT_NEVER);
-    }
+    rc = bus_spi_txrx_noblock(dev, (uint8_t *)buf, NULL, length, timeout);
 #else
     rc = hal_spi_txrx(dev->spi_dev.cfg.spi_num, (uint8_t *)buf, NULL, length);
 #endif
@@ -24,6 +24,7 @@
 #include "os/os_dev.h"
 #include "os/os_mutex.h"
 #include "os/os_time.h"
+#include "os/queue.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -190,6 +191,85 @@ bus_node_simple_write_read_transact(struct os_dev *node, const void *wbuf,
                                         BUS_F_NONE);
 }
 
+#if MYNEWT_VAL(BUS_TXN_QUEUE)
+/**
+ * Transaction segment types
+ *
+ * A delay segment keeps the bus locked and blocks the default event queue
+ * for its duration, so it is meant for short settling times only.
+ */
+#define BUS_TXN_SEG_WRITE   0
+#define BUS_TXN_SEG_READ    1
+#define BUS_TXN_SEG_DELAY   2
+
+/**
+ * Segment of an asynchronous transaction
+ */
+struct bus_txn_seg {
+    /* BUS_TXN_SEG_xxx */
+    uint8_t type;
+    /* Flags for the read or write, e.g. BUS_F_NOSTOP before a read */
+    uint16_t flags;
+    /* Length of data, or delay in milliseconds for BUS_TXN_SEG_DELAY */
+    uint16_t length;
+    union {
+        const void *wbuf;
+        void *rbuf;
+    };
+};
+
+struct bus_txn;
+
+/**
+ * Completion callback of an asynchronous transaction
+ *
+ * Called from the default event queue after the bus has been unlocked. The
+ * transaction may be resubmitted from the callback.
+ *
+ * @param txn     The transaction
+ * @param status  0 on success, SYS_xxx of the first failed segment on error
+ */
+typedef void (*bus_txn_cb_t)(struct bus_txn *txn, int status);
+
+/**
+ * Asynchronous transaction
+ *
+ * Owned by the bus from bus_node_submit() until its callback is called.
+ */
+struct bus_txn {
+    /* Segments, executed in order */
+    const struct bus_txn_seg *segs;
+    uint8_t seg_count;
+    /* Timeout of each read or write */
+    os_time_t timeout;
+    /* Completion callback and its argument */
+    bus_txn_cb_t cb;
+    void *arg;
+
+    /* Managed by bus driver */
+    struct os_dev *node;
+    int status;
+    STAILQ_ENTRY(bus_txn) next;
+};
+
+/**
+ * Submit an asynchronous transaction
+ *
+ * Queues the transaction on the parent bus of the node and returns without
+ * waiting for the bus.  Transactions of a bus are executed in order from
+ * the default event queue.  With the bus locked once, each runs its segments
+ * back to back and the queued transactions that follow for the same node run
+ * right after it.
+ *
+ * @param node  Node device object
+ * @param txn   Transaction, with segs, seg_count, timeout and cb set
+ *
+ * @return 0 on success, SYS_EINVAL on invalid transaction
+ */
+int
+bus_node_submit(struct os_dev *node, struct bus_txn *txn);
+#endif
+
 /**
  * Get lock object for bus
  *
@@ -216,6 +296,13 @@ bus_dev_get_lock(struct os_dev *bus, struct os_mutex **mutex);
  * APIs) lock bus automatically.
  *
  * After successful locking, bus is configured to be used with given node.
+ * Configuration is skipped if the bus device is already configured for this
+ * node, i.e. the same node was the last one to access the bus.
+ *
+ * Read, write and write-read operations on the same node done while the bus is
+ * locked only nest the lock, so a sequence like register read-modify-write
+ * can be done inside a single lock scope without configuring the bus again or
+ * letting other nodes access it in between.
  *
  * @param node     Node to lock its parent bus
  * @param timeout  Timeout on locking attempt
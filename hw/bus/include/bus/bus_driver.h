@@ -40,6 +40,18 @@ STATS_SECT_START(bus_stats_section)
     STATS_SECT_ENTRY(read_errors)
     STATS_SECT_ENTRY(write_ops)
     STATS_SECT_ENTRY(write_errors)
+    STATS_SECT_ENTRY(read_bytes)
+    STATS_SECT_ENTRY(write_bytes)
+#if MYNEWT_VAL(BUS_STATS_TIMING)
+    /* Total time spent waiting for and holding bus lock */
+    STATS_SECT_ENTRY(lock_wait_us)
+    STATS_SECT_ENTRY(lock_hold_us)
+    /* Histogram of lock wait + hold time, i.e. latency seen by caller */
+    STATS_SECT_ENTRY(lat_100us)
+    STATS_SECT_ENTRY(lat_1ms)
+    STATS_SECT_ENTRY(lat_10ms)
+    STATS_SECT_ENTRY(lat_long)
+#endif
 STATS_SECT_END
 #endif
 
@@ -114,6 +126,16 @@ struct bus_dev {
 #if MYNEWT_VAL(BUS_STATS)
     STATS_SECT_DECL(bus_stats_section) stats;
 #endif
+#if MYNEWT_VAL(BUS_STATS_TIMING)
+    /* cputime when lock was acquired and how long it took, in usecs */
+    uint32_t lock_ts;
+    uint32_t lock_wait_us;
+#endif
+
+#if MYNEWT_VAL(BUS_TXN_QUEUE)
+    STAILQ_HEAD(, bus_txn) txn_q;
+    struct os_event txn_ev;
+#endif
 
     bool enabled;
 
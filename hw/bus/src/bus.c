@@ -20,6 +20,10 @@
 #include <assert.h>
 #include <string.h>
 #include "defs/error.h"
+#include "syscfg/syscfg.h"
+#if !MYNEWT_VAL(OS_SYSVIEW_TRACE_BUS)
+#define OS_TRACE_DISABLE_FILE_API
+#endif
 #include "bus/bus.h"
 #include "bus/bus_debug.h"
 #include "bus/bus_driver.h"
@@ -36,6 +40,16 @@ STATS_NAME_START(bus_stats_section)
     STATS_NAME(bus_stats_section, read_errors)
     STATS_NAME(bus_stats_section, write_ops)
     STATS_NAME(bus_stats_section, write_errors)
+    STATS_NAME(bus_stats_section, read_bytes)
+    STATS_NAME(bus_stats_section, write_bytes)
+#if MYNEWT_VAL(BUS_STATS_TIMING)
+    STATS_NAME(bus_stats_section, lock_wait_us)
+    STATS_NAME(bus_stats_section, lock_hold_us)
+    STATS_NAME(bus_stats_section, lat_100us)
+    STATS_NAME(bus_stats_section, lat_1ms)
+    STATS_NAME(bus_stats_section, lat_10ms)
+    STATS_NAME(bus_stats_section, lat_long)
+#endif
 STATS_NAME_END(bus_stats_section)
 
 #if MYNEWT_VAL(BUS_STATS_PER_NODE)
@@ -44,16 +58,68 @@ STATS_NAME_END(bus_stats_section)
         STATS_INC((_bdev)->stats, _var);    \
         STATS_INC((_bnode)->stats, _var);   \
     } while (0)
+#define BUS_STATS_INCN(_bdev, _bnode, _var, _n) \
+    do {                                        \
+        STATS_INCN((_bdev)->stats, _var, _n);   \
+        STATS_INCN((_bnode)->stats, _var, _n);  \
+    } while (0)
 #else
 #define BUS_STATS_INC(_bdev, _bnode, _var)  \
     do {                                    \
         STATS_INC((_bdev)->stats, _var);    \
     } while (0)
+#define BUS_STATS_INCN(_bdev, _bnode, _var, _n) \
+    do {                                        \
+        STATS_INCN((_bdev)->stats, _var, _n);   \
+    } while (0)
 #endif
 #else
 #define BUS_STATS_INC(_bdev, _bnode, _var)  \
     do {                                    \
     } while (0)
+#define BUS_STATS_INCN(_bdev, _bnode, _var, _n) \
+    do {                                        \
+    } while (0)
+#endif
+
+#if MYNEWT_VAL(BUS_STATS_TIMING)
+/* Called on first lock, wait_start is cputime before locking was attempted */
+static void
+bus_stats_lock_acquired(struct bus_dev *bdev, struct bus_node *bnode,
+                        uint32_t wait_start)
+{
+    uint32_t now;
+
+    now = os_cputime_get32();
+
+    bdev->lock_ts = now;
+    bdev->lock_wait_us = os_cputime_ticks_to_usecs(now - wait_start);
+
+    BUS_STATS_INCN(bdev, bnode, lock_wait_us, bdev->lock_wait_us);
+}
+
+/* Called on last unlock */
+static void
+bus_stats_lock_released(struct bus_dev *bdev, struct bus_node *bnode)
+{
+    uint32_t hold_us;
+    uint32_t lat_us;
+
+    hold_us = os_cputime_ticks_to_usecs(os_cputime_get32() - bdev->lock_ts);
+    lat_us = bdev->lock_wait_us + hold_us;
+
+    BUS_STATS_INCN(bdev, bnode, lock_hold_us, hold_us);
+
+    if (lat_us < 100) {
+        BUS_STATS_INC(bdev, bnode, lat_100us);
+    } else if (lat_us < 1000) {
+        BUS_STATS_INC(bdev, bnode, lat_1ms);
+    } else if (lat_us < 10000) {
+        BUS_STATS_INC(bdev, bnode, lat_10ms);
+    } else {
+        BUS_STATS_INC(bdev, bnode, lat_long);
+    }
+}
 #endif
 
 static inline void
@@ -137,6 +203,147 @@ bus_dev_resume_func(struct os_dev *odev)
     return OS_OK;
 }
 
+#if MYNEWT_VAL(BUS_TXN_QUEUE)
+/* Take the first queued transaction, if node is set only if it is for node */
+static struct bus_txn *
+bus_dev_txn_pop(struct bus_dev *bdev, struct os_dev *node)
+{
+    struct bus_txn *txn;
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    txn = STAILQ_FIRST(&bdev->txn_q);
+    if (txn && (!node || txn->node == node)) {
+        STAILQ_REMOVE_HEAD(&bdev->txn_q, next);
+    } else {
+        txn = NULL;
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    return txn;
+}
+
+/* Run the segments of a transaction, bus is locked for the node */
+static int
+bus_dev_txn_exec(struct bus_dev *bdev, struct bus_node *bnode,
+                 struct bus_txn *txn)
+{
+    const struct bus_txn_seg *seg;
+    int rc;
+    int i;
+
+    if (!bdev->enabled) {
+        return SYS_EIO;
+    }
+
+    for (i = 0; i < txn->seg_count; i++) {
+        seg = &txn->segs[i];
+
+        switch (seg->type) {
+        case BUS_TXN_SEG_WRITE:
+            BUS_STATS_INC(bdev, bnode, write_ops);
+            rc = bdev->dops->write(bdev, bnode, seg->wbuf, seg->length,
+                                   txn->timeout, seg->flags);
+            if (rc) {
+                BUS_STATS_INC(bdev, bnode, write_errors);
+                return rc;
+            }
+            BUS_STATS_INCN(bdev, bnode, write_bytes, seg->length);
+            break;
+        case BUS_TXN_SEG_READ:
+            BUS_STATS_INC(bdev, bnode, read_ops);
+            rc = bdev->dops->read(bdev, bnode, seg->rbuf, seg->length,
+                                  txn->timeout, seg->flags);
+            if (rc) {
+                BUS_STATS_INC(bdev, bnode, read_errors);
+                return rc;
+            }
+            BUS_STATS_INCN(bdev, bnode, read_bytes, seg->length);
+            break;
+        case BUS_TXN_SEG_DELAY:
+            os_time_delay(os_time_ms_to_ticks32(seg->length));
+            break;
+        default:
+            return SYS_EINVAL;
+        }
+    }
+
+    return 0;
+}
+
+static void
+bus_dev_txn_ev_func(struct os_event *ev)
+{
+    struct bus_dev *bdev = (struct bus_dev *)ev->ev_arg;
+    STAILQ_HEAD(, bus_txn) done;
+    struct bus_node *bnode;
+    struct bus_txn *txn;
+    struct os_dev *node;
+    int rc;
+
+    txn = bus_dev_txn_pop(bdev, NULL);
+    while (txn) {
+        node = txn->node;
+        bnode = (struct bus_node *)node;
+        STAILQ_INIT(&done);
+
+        rc = bus_node_lock(node, bus_node_get_lock_timeout(node));
+        if (rc) {
+            txn->status = rc;
+            STAILQ_INSERT_TAIL(&done, txn, next);
+        } else {
+            /* Run everything queued for this node under one lock */
+            do {
+                txn->status = bus_dev_txn_exec(bdev, bnode, txn);
+                STAILQ_INSERT_TAIL(&done, txn, next);
+                txn = bus_dev_txn_pop(bdev, node);
+            } while (txn);
+
+            (void)bus_node_unlock(node);
+        }
+
+        /* Callbacks may resubmit, so take the entry off the list first */
+        while ((txn = STAILQ_FIRST(&done)) != NULL) {
+            STAILQ_REMOVE_HEAD(&done, next);
+            txn->cb(txn, txn->status);
+        }
+
+        txn = bus_dev_txn_pop(bdev, NULL);
+    }
+}
+
+int
+bus_node_submit(struct os_dev *node, struct bus_txn *txn)
+{
+    struct bus_node *bnode = (struct bus_node *)node;
+    struct bus_dev *bdev = bnode->parent_bus;
+    os_sr_t sr;
+
+    BUS_DEBUG_VERIFY_DEV(bdev);
+    BUS_DEBUG_VERIFY_NODE(bnode);
+
+    if (!txn->cb || !txn->segs || !txn->seg_count) {
+        return SYS_EINVAL;
+    }
+
+    if (!bdev->dops->write || !bdev->dops->read) {
+        return SYS_ENOTSUP;
+    }
+
+    txn->node = node;
+    txn->status = 0;
+
+    OS_ENTER_CRITICAL(sr);
+    STAILQ_INSERT_TAIL(&bdev->txn_q, txn, next);
+    OS_EXIT_CRITICAL(sr);
+
+    /* XXX allow custom eventq */
+    os_eventq_put(os_eventq_dflt_get(), &bdev->txn_ev);
+
+    return 0;
+}
+#endif
+
 #if MYNEWT_VAL(BUS_PM)
 static void
 bus_dev_inactivity_tmo_func(struct os_event *ev)
@@ -238,6 +445,16 @@ bus_dev_init_func(struct os_dev *odev, void *arg)
     /* XXX allow custom eventq */
     os_callout_init(&bdev->inactivity_tmo, os_eventq_dflt_get(),
                     bus_dev_inactivity_tmo_func, odev);
+#if MYNEWT_VAL(OS_CALLOUT_SLACK)
+    os_callout_set_slack(&bdev->inactivity_tmo,
+                         MYNEWT_VAL(BUS_PM_INACTIVITY_TMO_SLACK));
+#endif
+#endif
+
+#if MYNEWT_VAL(BUS_TXN_QUEUE)
+    STAILQ_INIT(&bdev->txn_q);
+    bdev->txn_ev.ev_cb = bus_dev_txn_ev_func;
+    bdev->txn_ev.ev_arg = bdev;
 #endif
 
 #if MYNEWT_VAL(BUS_STATS)
@@ -339,9 +556,13 @@ bus_node_read(struct os_dev *node, void *buf, uint16_t length,
     }
 
     BUS_STATS_INC(bdev, bnode, read_ops);
+    os_trace_api_u32x2(OS_TRACE_ID_BUS_READ, (uint32_t)node, length);
     rc = bdev->dops->read(bdev, bnode, buf, length, timeout, flags);
+    os_trace_api_ret_u32(OS_TRACE_ID_BUS_READ, (uint32_t)rc);
     if (rc) {
         BUS_STATS_INC(bdev, bnode, read_errors);
+    } else {
+        BUS_STATS_INCN(bdev, bnode, read_bytes, length);
     }
 
 done:
@@ -376,9 +597,13 @@ bus_node_write(struct os_dev *node, const void *buf, uint16_t length,
     }
 
     BUS_STATS_INC(bdev, bnode, write_ops);
+    os_trace_api_u32x2(OS_TRACE_ID_BUS_WRITE, (uint32_t)node, length);
     rc = bdev->dops->write(bdev, bnode, buf, length, timeout, flags);
+    os_trace_api_ret_u32(OS_TRACE_ID_BUS_WRITE, (uint32_t)rc);
     if (rc) {
         BUS_STATS_INC(bdev, bnode, write_errors);
+    } else {
+        BUS_STATS_INCN(bdev, bnode, write_bytes, length);
     }
 
 done:
@@ -408,6 +633,9 @@ bus_node_write_read_transact(struct os_dev *node, const void *wbuf,
         return rc;
     }
 
+    os_trace_api_u32x3(OS_TRACE_ID_BUS_WRITE_READ, (uint32_t)node, wlength,
+                       rlength);
+
     if (!bdev->enabled) {
         rc = SYS_EIO;
         goto done;
@@ -425,6 +653,7 @@ bus_node_write_read_transact(struct os_dev *node, const void *wbuf,
         BUS_STATS_INC(bdev, bnode, write_errors);
         goto done;
     }
+    BUS_STATS_INCN(bdev, bnode, write_bytes, wlength);
 
     BUS_STATS_INC(bdev, bnode, read_ops);
     rc = bdev->dops->read(bdev, bnode, rbuf, rlength, timeout, flags);
@@ -432,8 +661,10 @@ bus_node_write_read_transact(struct os_dev *node, const void *wbuf,
         BUS_STATS_INC(bdev, bnode, read_errors);
         goto done;
     }
+    BUS_STATS_INCN(bdev, bnode, read_bytes, rlength);
 
 done:
+    os_trace_api_ret_u32(OS_TRACE_ID_BUS_WRITE_READ, (uint32_t)rc);
     (void)bus_node_unlock(node);
 
     return rc;
@@ -445,6 +676,9 @@ bus_node_lock(struct os_dev *node, os_time_t timeout)
 {
     struct bus_node *bnode = (struct bus_node *)node;
     struct bus_dev *bdev = bnode->parent_bus;
+#if MYNEWT_VAL(BUS_STATS_TIMING)
+    uint32_t wait_start;
+#endif
     os_error_t err;
     int rc;
 
@@ -455,7 +689,13 @@ bus_node_lock(struct os_dev *node, os_time_t timeout)
         timeout = g_bus_node_lock_timeout;
     }
 
+#if MYNEWT_VAL(BUS_STATS_TIMING)
+    wait_start = os_cputime_get32();
+#endif
+
+    os_trace_api_u32x2(OS_TRACE_ID_BUS_LOCK, (uint32_t)node, timeout);
     err = os_mutex_pend(&bdev->lock, timeout);
+    os_trace_api_ret_u32(OS_TRACE_ID_BUS_LOCK, (uint32_t)err);
     if (err == OS_TIMEOUT) {
         BUS_STATS_INC(bdev, bnode, lock_timeouts);
         return SYS_ETIMEOUT;
@@ -463,6 +703,12 @@ bus_node_lock(struct os_dev *node, os_time_t timeout)
 
     assert(err == OS_OK || err == OS_NOT_STARTED);
 
+#if MYNEWT_VAL(BUS_STATS_TIMING)
+    if (os_mutex_get_level(&bdev->lock) == 1) {
+        bus_stats_lock_acquired(bdev, bnode, wait_start);
+    }
+#endif
+
 #if MYNEWT_VAL(BUS_PM)
     /* In auto PM we need to enable bus device on first lock */
     if ((bdev->pm_mode == BUS_PM_MODE_AUTO) &&
@@ -472,7 +718,11 @@ bus_node_lock(struct os_dev *node, os_time_t timeout)
     }
 #endif
 
-    /* No need to configure if already configured for the same node */
+    /*
+     * No need to configure if already configured for the same node. This is
+     * also the only check done on nested lock, so operations done inside a
+     * bus_node_lock() scope do not touch the bus configuration at all.
+     */
     if (bdev->configured_for == bnode) {
         return 0;
     }
@@ -508,11 +758,17 @@ bus_node_unlock(struct os_dev *node)
     BUS_DEBUG_VERIFY_DEV(bdev);
     BUS_DEBUG_VERIFY_NODE(bnode);
 
+#if MYNEWT_VAL(BUS_STATS_TIMING)
+    if (os_mutex_get_level(&bdev->lock) == 1) {
+        bus_stats_lock_released(bdev, bnode);
+    }
+#endif
+
 #if MYNEWT_VAL(BUS_PM)
     /* In auto PM we should disable bus device on last unlock */
     if ((bdev->pm_mode == BUS_PM_MODE_AUTO) &&
         (os_mutex_get_level(&bdev->lock) == 1)) {
-        if (bdev->pm_opts.pm_mode_auto.disable_tmo) {
+        if (bdev->pm_opts.pm_mode_auto.disable_tmo == 0) {
             bus_dev_disable(bdev);
         } else {
             os_callout_reset(&bdev->inactivity_tmo,
@@ -521,6 +777,7 @@ bus_node_unlock(struct os_dev *node)
     }
 #endif
 
+    os_trace_api_u32(OS_TRACE_ID_BUS_UNLOCK, (uint32_t)node);
     err = os_mutex_release(&bdev->lock);
 
     /*
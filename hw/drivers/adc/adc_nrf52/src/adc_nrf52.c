@@ -30,6 +30,23 @@
 
 #include "adc_nrf52/adc_nrf52.h"
 
+#if MYNEWT_VAL(ADC_NRF52_STREAM_TIMER) >= 0
+#if MYNEWT_VAL(ADC_NRF52_STREAM_TIMER) == 1
+#define NRF52_ADC_STREAM_TIMER  NRF_TIMER1
+#elif MYNEWT_VAL(ADC_NRF52_STREAM_TIMER) == 2
+#define NRF52_ADC_STREAM_TIMER  NRF_TIMER2
+#elif MYNEWT_VAL(ADC_NRF52_STREAM_TIMER) == 3
+#define NRF52_ADC_STREAM_TIMER  NRF_TIMER3
+#elif MYNEWT_VAL(ADC_NRF52_STREAM_TIMER) == 4
+#define NRF52_ADC_STREAM_TIMER  NRF_TIMER4
+#else
+#error "Unsupported ADC_NRF52_STREAM_TIMER"
+#endif
+#define NRF52_ADC_STREAM_PPI_CH MYNEWT_VAL(ADC_NRF52_STREAM_PPI_CH)
+/* SAADC can't do more than 200 ksps */
+#define NRF52_ADC_STREAM_MAX_HZ 200000
+#endif
+
 struct nrf52_saadc_stats {
     uint16_t saadc_events;
     uint16_t saadc_events_failed;
@@ -42,6 +59,12 @@ static struct nrf52_adc_dev_cfg *init_adc_config;
 
 static uint8_t nrf52_adc_chans[NRF_SAADC_CHANNEL_COUNT * sizeof(struct adc_chan_config)];
 
+#if MYNEWT_VAL(ADC_NRF52_STREAM_TIMER) >= 0
+/* Number of buffers owned by nrfx driver, 0 means sampling has stalled */
+static uint8_t nrf52_adc_stream_bufs;
+static uint8_t nrf52_adc_streaming;
+#endif
+
 static void
 nrf52_saadc_event_handler(const nrfx_saadc_evt_t *event)
 {
@@ -58,6 +81,15 @@ nrf52_saadc_event_handler(const nrfx_saadc_evt_t *event)
     switch (event->type) {
         case NRFX_SAADC_EVT_DONE:
             done_ev = (nrfx_saadc_done_evt_t * const) &event->data.done;
+#if MYNEWT_VAL(ADC_NRF52_STREAM_TIMER) >= 0
+            if (nrf52_adc_stream_bufs > 0) {
+                --nrf52_adc_stream_bufs;
+            }
+            if (nrf52_adc_streaming && nrf52_adc_stream_bufs == 0) {
+                /* No next buffer, samples are lost until one is released */
+                ++global_adc_dev->ad_stream_overruns;
+            }
+#endif
 
             rc = global_adc_dev->ad_event_handler_func(global_adc_dev,
                                        global_adc_dev->ad_event_handler_arg,
@@ -290,6 +322,9 @@ nrf52_adc_set_buffer(struct adc_dev *dev, void *buf1, void *buf2,
     if (rc != NRFX_SUCCESS) {
         goto err;
     }
+#if MYNEWT_VAL(ADC_NRF52_STREAM_TIMER) >= 0
+    ++nrf52_adc_stream_bufs;
+#endif
 
     if (buf2) {
         rc = nrfx_saadc_buffer_convert((nrf_saadc_value_t *) buf2,
@@ -297,6 +332,9 @@ nrf52_adc_set_buffer(struct adc_dev *dev, void *buf1, void *buf2,
         if (rc != NRFX_SUCCESS) {
             goto err;
         }
+#if MYNEWT_VAL(ADC_NRF52_STREAM_TIMER) >= 0
+        ++nrf52_adc_stream_bufs;
+#endif
     }
     return (0);
 err:
@@ -314,12 +352,71 @@ nrf52_adc_release_buffer(struct adc_dev *dev, void *buf, int buf_len)
     if (rc != NRFX_SUCCESS) {
         goto err;
     }
+#if MYNEWT_VAL(ADC_NRF52_STREAM_TIMER) >= 0
+    ++nrf52_adc_stream_bufs;
+#endif
 
     return (0);
 err:
     return (rc);
 }
 
+#if MYNEWT_VAL(ADC_NRF52_STREAM_TIMER) >= 0
+/**
+ * Start continuous sampling. Timer compare event triggers SAMPLE task via
+ * PPI, nrfx driver switches between buffers set with adc_buf_set().
+ */
+static int
+nrf52_adc_stream_start(struct adc_dev *dev, uint32_t rate_hz)
+{
+    NRF_TIMER_Type *timer = NRF52_ADC_STREAM_TIMER;
+
+    if (rate_hz > NRF52_ADC_STREAM_MAX_HZ) {
+        return (SYS_EINVAL);
+    }
+    if (nrf52_adc_stream_bufs == 0) {
+        /* adc_buf_set() shall be called first */
+        return (SYS_EINVAL);
+    }
+
+    timer->TASKS_STOP = 1;
+    timer->TASKS_CLEAR = 1;
+    timer->MODE = TIMER_MODE_MODE_Timer;
+    timer->BITMODE = TIMER_BITMODE_BITMODE_32Bit;
+    timer->PRESCALER = 0;
+    timer->CC[0] = 16000000 / rate_hz;
+    timer->SHORTS = TIMER_SHORTS_COMPARE0_CLEAR_Msk;
+    timer->EVENTS_COMPARE[0] = 0;
+
+    NRF_PPI->CH[NRF52_ADC_STREAM_PPI_CH].EEP =
+        (uint32_t)&timer->EVENTS_COMPARE[0];
+    NRF_PPI->CH[NRF52_ADC_STREAM_PPI_CH].TEP =
+        (uint32_t)&NRF_SAADC->TASKS_SAMPLE;
+    NRF_PPI->CHENSET = 1 << NRF52_ADC_STREAM_PPI_CH;
+
+    nrf52_adc_streaming = 1;
+    timer->TASKS_START = 1;
+
+    return (0);
+}
+
+static int
+nrf52_adc_stream_stop(struct adc_dev *dev)
+{
+    NRF_TIMER_Type *timer = NRF52_ADC_STREAM_TIMER;
+
+    timer->TASKS_STOP = 1;
+    NRF_PPI->CHENCLR = 1 << NRF52_ADC_STREAM_PPI_CH;
+    nrf52_adc_streaming = 0;
+
+    /* Buffers not reported are given back to user */
+    nrfx_saadc_abort();
+    nrf52_adc_stream_bufs = 0;
+
+    return (0);
+}
+#endif
+
 /**
  * Trigger an ADC sample.
  */
@@ -406,6 +503,10 @@ static const struct adc_driver_funcs nrf52_adc_funcs = {
         .af_release_buffer = nrf52_adc_release_buffer,
         .af_read_buffer = nrf52_adc_read_buffer,
         .af_size_buffer = nrf52_adc_size_buffer,
+#if MYNEWT_VAL(ADC_NRF52_STREAM_TIMER) >= 0
+        .af_stream_start = nrf52_adc_stream_start,
+        .af_stream_stop = nrf52_adc_stream_stop,
+#endif
 };
 
 /**
@@ -137,6 +137,26 @@ typedef int (*adc_buf_read_func_t)(struct adc_dev *, void *, int, int, int *);
  */
 typedef int (*adc_buf_size_func_t)(struct adc_dev *, int, int);
 
+/**
+ * Start continuous sampling of configured channels at given rate.  This is
+ * implemented by the HW specific drivers which support streaming.
+ *
+ * @param The ADC device to start sampling on
+ * @param Sampling rate in Hz
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+typedef int (*adc_stream_start_func_t)(struct adc_dev *, uint32_t);
+
+/**
+ * Stop continuous sampling.
+ *
+ * @param The ADC device to stop sampling on
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+typedef int (*adc_stream_stop_func_t)(struct adc_dev *);
+
 struct adc_driver_funcs {
     adc_configure_channel_func_t af_configure_channel;
     adc_sample_func_t af_sample;
@@ -145,6 +165,9 @@ struct adc_driver_funcs {
     adc_buf_release_func_t af_release_buffer;
     adc_buf_read_func_t af_read_buffer;
     adc_buf_size_func_t af_size_buffer;
+    /* Optional, NULL if streaming is not supported */
+    adc_stream_start_func_t af_stream_start;
+    adc_stream_stop_func_t af_stream_stop;
 };
 
 struct adc_chan_config {
@@ -164,12 +187,16 @@ struct adc_dev {
     uint8_t ad_ref_cnt;
     adc_event_handler_func_t ad_event_handler_func;
     void *ad_event_handler_arg;
+    /* Number of times sampling stalled in streaming mode due to no buffer */
+    uint32_t ad_stream_overruns;
 };
 
 int adc_chan_config(struct adc_dev *, uint8_t, void *);
 int adc_chan_read(struct adc_dev *, uint8_t, int *);
 int adc_event_handler_set(struct adc_dev *, adc_event_handler_func_t,
         void *);
+int adc_stream_start(struct adc_dev *, uint32_t);
+int adc_stream_stop(struct adc_dev *);
 
 /**
  * Sample the device specified by dev.  This is used in non-blocking mode
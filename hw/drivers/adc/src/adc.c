@@ -87,3 +87,49 @@ adc_event_handler_set(struct adc_dev *dev, adc_event_handler_func_t func,
     return (0);
 }
 
+/**
+ * Start continuous sampling of all configured channels.  Samples are
+ * written into buffers set with adc_buf_set(); one ADC_EVENT_RESULT event is
+ * reported for each filled buffer, which should be given back to the driver
+ * with adc_buf_release() once processed.  Sampling continues into the other
+ * buffer meanwhile; if no buffer is available when one fills up, samples
+ * are lost until a buffer is released and ad_stream_overruns is incremented.
+ *
+ * @param dev The ADC device to start sampling on
+ * @param rate_hz Sampling rate in Hz, each sample covers all channels
+ *
+ * @return 0 on success, SYS_ENOTSUP if driver does not support streaming,
+ *         other non-zero error code on failure.
+ */
+int
+adc_stream_start(struct adc_dev *dev, uint32_t rate_hz)
+{
+    if (dev->ad_funcs->af_stream_start == NULL) {
+        return (SYS_ENOTSUP);
+    }
+
+    if (rate_hz == 0) {
+        return (EINVAL);
+    }
+
+    return (dev->ad_funcs->af_stream_start(dev, rate_hz));
+}
+
+/**
+ * Stop continuous sampling.  Buffers which were not reported yet are
+ * returned to user and can be set again with adc_buf_set().
+ *
+ * @param dev The ADC device to stop sampling on
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+int
+adc_stream_stop(struct adc_dev *dev)
+{
+    if (dev->ad_funcs->af_stream_stop == NULL) {
+        return (SYS_ENOTSUP);
+    }
+
+    return (dev->ad_funcs->af_stream_stop(dev));
+}
+
@@ -0,0 +1,150 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * util/crc backend for the STM32 CRC unit.
+ *
+ * Only units with a programmable polynomial and input bit reversal (F0x2,
+ * F0x8, F3, F7, L0, L4, WB) can do the CRCs util/crc offers; elsewhere
+ * crc_hw_calc() always declines and the tables are used.
+ *
+ * The unit is shared, so it is set up again for each chunk of
+ * CRC_STM32_CHUNK bytes, which it runs through with interrupts disabled.
+ */
+
+#include <stddef.h>
+#include "os/mynewt.h"
+#include "mcu/stm32_hal.h"
+#include "crc/crc_hw.h"
+
+#if defined(CRC_POL_POL) && defined(CRC_CR_REV_IN)
+
+struct crc_stm32_cfg {
+    uint32_t poly;
+    uint32_t cr;
+    uint32_t mask;
+    uint8_t reflect;
+};
+
+static const struct crc_stm32_cfg crc_stm32_cfgs[] = {
+    [CRC_HW_CRC8] = {
+        .poly = 0x07,
+        .cr = CRC_CR_POLYSIZE_1,
+        .mask = 0xff,
+    },
+    [CRC_HW_CRC16] = {
+        .poly = 0x1021,
+        .cr = CRC_CR_POLYSIZE_0,
+        .mask = 0xffff,
+    },
+    [CRC_HW_CRC32] = {
+        .poly = 0x04c11db7,
+        .cr = CRC_CR_REV_IN_0,
+        .mask = 0xffffffff,
+        .reflect = 1,
+    },
+    [CRC_HW_CRC32C] = {
+        .poly = 0x1edc6f41,
+        .cr = CRC_CR_REV_IN_0,
+        .mask = 0xffffffff,
+        .reflect = 1,
+    },
+};
+
+static uint8_t crc_stm32_clk_on;
+
+/*
+ * Words are written byte swapped, as the unit takes the most significant
+ * byte first.  For the reflected CRCs, REV_IN then reverses the bits of
+ * each byte, and the register is kept bit reversed.
+ */
+static uint32_t
+crc_stm32_run(const struct crc_stm32_cfg *cfg, uint32_t crc,
+              const uint8_t *p, size_t len)
+{
+    CRC->CR = cfg->cr;
+    CRC->POL = cfg->poly;
+    CRC->INIT = cfg->reflect ? __RBIT(crc) : crc;
+    CRC->CR = cfg->cr | CRC_CR_RESET;
+
+    while (len > 0 && ((uintptr_t)p & 3) != 0) {
+        *(volatile uint8_t *)&CRC->DR = *p++;
+        len--;
+    }
+    while (len >= 4) {
+        CRC->DR = __REV(*(const uint32_t *)p);
+        p += 4;
+        len -= 4;
+    }
+    while (len > 0) {
+        *(volatile uint8_t *)&CRC->DR = *p++;
+        len--;
+    }
+
+    crc = CRC->DR;
+    if (cfg->reflect) {
+        crc = __RBIT(crc);
+    }
+    return crc & cfg->mask;
+}
+
+int
+crc_hw_calc(int type, uint32_t *crc, const void *buf, size_t len)
+{
+    const struct crc_stm32_cfg *cfg;
+    const uint8_t *p;
+    uint32_t val;
+    size_t chunk;
+    os_sr_t sr;
+
+    if (type < 0 || (unsigned)type >= ARRAY_SIZE(crc_stm32_cfgs)) {
+        return SYS_ENOTSUP;
+    }
+    cfg = &crc_stm32_cfgs[type];
+
+    val = *crc;
+    p = buf;
+    while (len > 0) {
+        chunk = min(len, MYNEWT_VAL(CRC_STM32_CHUNK));
+
+        OS_ENTER_CRITICAL(sr);
+        if (!crc_stm32_clk_on) {
+            __HAL_RCC_CRC_CLK_ENABLE();
+            crc_stm32_clk_on = 1;
+        }
+        val = crc_stm32_run(cfg, val, p, chunk);
+        OS_EXIT_CRITICAL(sr);
+
+        p += chunk;
+        len -= chunk;
+    }
+    *crc = val;
+
+    return 0;
+}
+
+#else
+
+int
+crc_hw_calc(int type, uint32_t *crc, const void *buf, size_t len)
+{
+    return SYS_ENOTSUP;
+}
+
+#endif
@@ -53,6 +53,12 @@ CRYP_KEYSIZE_FROM_KEYLEN(uint16_t keylen)
     (((x) == 128) || ((x) == 256))
 #endif
 
+#if defined(CRYP_AES_GCM)
+#define STM32_CRYP_AES_GCM CRYP_AES_GCM
+#elif defined(CRYP_AES_GCM_GMAC)
+#define STM32_CRYP_AES_GCM CRYP_AES_GCM_GMAC
+#endif
+
 static bool
 stm32_has_support(struct crypto_dev *crypto, uint8_t op, uint16_t algo,
         uint16_t mode, uint16_t keylen)
@@ -68,6 +74,10 @@ stm32_has_support(struct crypto_dev *crypto, uint8_t op, uint16_t algo,
     case CRYPTO_MODE_CBC: /* fallthrough */
     case CRYPTO_MODE_CTR:
         return true;
+#ifdef STM32_CRYP_AES_GCM
+    case CRYPTO_MODE_GCM:
+        return true;
+#endif
     }
 
     return false;
@@ -114,6 +124,8 @@ stm32_crypto_op(struct crypto_dev *crypto, uint8_t op, uint16_t algo,
         conf.Algorithm = CRYP_AES_CTR;
         conf.pInitVect = iv32;
         break;
+    default:
+        return 0;
     }
 
     if (conf.pInitVect != NULL) {
@@ -207,6 +219,100 @@ stm32_crypto_decrypt(struct crypto_dev *crypto, uint16_t algo, uint16_t mode,
             iv, inbuf, outbuf, len);
 }
 
+#ifdef STM32_CRYP_AES_GCM
+/*
+ * Only 96-bit nonces and word-aligned AAD sizes are handled by HW, other
+ * requests fall back to the software implementation.
+ */
+static int
+stm32_crypto_aead(struct crypto_dev *crypto, uint8_t op, uint16_t algo,
+        uint16_t mode, const uint8_t *key, uint16_t keylen,
+        const uint8_t *nonce, uint16_t noncelen, const uint8_t *aad,
+        uint32_t aadlen, const uint8_t *inbuf, uint8_t *outbuf, uint32_t len,
+        uint8_t *tag, uint16_t taglen)
+{
+    HAL_StatusTypeDef status;
+    CRYP_ConfigTypeDef conf;
+    uint32_t key32[AES_MAX_KEY_LEN / sizeof(uint32_t)];
+    uint32_t iv32[AES_BLOCK_LEN / sizeof(uint32_t)];
+    uint32_t tag32[AES_BLOCK_LEN / sizeof(uint32_t)];
+    uint8_t diff;
+    uint8_t i;
+    int rc;
+
+    if (mode != CRYPTO_MODE_GCM || noncelen != 12 || (aadlen & 3) ||
+        !stm32_has_support(crypto, op, algo, mode, keylen)) {
+        return SYS_ENOTSUP;
+    }
+
+    if (taglen < 4 || taglen > AES_BLOCK_LEN) {
+        return SYS_EINVAL;
+    }
+
+    for (i = 0; i < keylen / (8 * sizeof(uint32_t)); i++) {
+        key32[i] = os_bswap_32(((uint32_t *)key)[i]);
+    }
+
+    /* J0 + 1, first counter used for payload */
+    for (i = 0; i < 3; i++) {
+        iv32[i] = os_bswap_32(((uint32_t *)nonce)[i]);
+    }
+    iv32[3] = 2;
+
+    conf.DataType = CRYP_DATATYPE_8B;
+    conf.KeySize = CRYP_KEYSIZE_FROM_KEYLEN(keylen);
+    conf.pKey = key32;
+    conf.pInitVect = iv32;
+    conf.Algorithm = STM32_CRYP_AES_GCM;
+    conf.Header = (uint32_t *)aad;
+    conf.HeaderSize = aadlen / sizeof(uint32_t);
+    conf.DataWidthUnit = CRYP_DATAWIDTHUNIT_BYTE;
+
+    os_mutex_pend(&gmtx, OS_TIMEOUT_NEVER);
+
+    rc = SYS_EIO;
+    status = HAL_CRYP_SetConfig(&g_hcryp, &conf);
+    if (status != HAL_OK) {
+        goto out;
+    }
+
+    if (op == CRYPTO_OP_ENCRYPT) {
+        status = HAL_CRYP_Encrypt(&g_hcryp, (uint32_t *)inbuf, len,
+                (uint32_t *)outbuf, HAL_MAX_DELAY);
+    } else {
+        status = HAL_CRYP_Decrypt(&g_hcryp, (uint32_t *)inbuf, len,
+                (uint32_t *)outbuf, HAL_MAX_DELAY);
+    }
+    if (status == HAL_OK) {
+        status = HAL_CRYPEx_AESGCM_GenerateAuthTAG(&g_hcryp, tag32,
+                HAL_MAX_DELAY);
+    }
+    if (status != HAL_OK) {
+        goto out;
+    }
+
+    rc = 0;
+    if (op == CRYPTO_OP_ENCRYPT) {
+        memcpy(tag, tag32, taglen);
+    } else {
+        diff = 0;
+        for (i = 0; i < taglen; i++) {
+            diff |= tag[i] ^ ((uint8_t *)tag32)[i];
+        }
+        if (diff) {
+            rc = SYS_EACCES;
+        }
+    }
+
+out:
+    os_mutex_release(&gmtx);
+    if (rc != 0 && op == CRYPTO_OP_DECRYPT) {
+        memset(outbuf, 0, len);
+    }
+    return rc;
+}
+#endif
+
 static int
 stm32_crypto_dev_open(struct os_dev *dev, uint32_t wait, void *arg)
 {
@@ -249,6 +355,9 @@ stm32_crypto_dev_init(struct os_dev *dev, void *arg)
     crypto->interface.encrypt = stm32_crypto_encrypt;
     crypto->interface.decrypt = stm32_crypto_decrypt;
     crypto->interface.has_support = stm32_has_support;
+#ifdef STM32_CRYP_AES_GCM
+    crypto->interface.aead = stm32_crypto_aead;
+#endif
 
     return 0;
 }
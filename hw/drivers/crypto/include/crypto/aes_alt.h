@@ -30,19 +30,54 @@ extern "C" {
 
 #include <crypto/crypto.h>
 
+/*
+ * AES context for mbedTLS with MBEDTLS_AES_ALT: the key is kept as is and
+ * every operation is handed to the "crypto" device.
+ */
 typedef struct mbedtls_aes_context
 {
     struct crypto_dev *crypto;
     uint8_t key[AES_MAX_KEY_LEN];
-    uint8_t keylen;
+    /* Key length in bits */
+    uint16_t keylen;
 } mbedtls_aes_context;
 
 void mbedtls_aes_init(mbedtls_aes_context *ctx);
 void mbedtls_aes_free(mbedtls_aes_context *ctx);
 int mbedtls_aes_setkey_enc(mbedtls_aes_context *ctx, const unsigned char *key,
         unsigned int keybits);
+int mbedtls_aes_setkey_dec(mbedtls_aes_context *ctx, const unsigned char *key,
+        unsigned int keybits);
 int mbedtls_aes_crypt_ecb(mbedtls_aes_context *ctx, int mode,
         const unsigned char input[16], unsigned char output[16]);
+int mbedtls_internal_aes_encrypt(mbedtls_aes_context *ctx,
+        const unsigned char input[16], unsigned char output[16]);
+int mbedtls_internal_aes_decrypt(mbedtls_aes_context *ctx,
+        const unsigned char input[16], unsigned char output[16]);
+#if MYNEWT_VAL(MBEDTLS_CIPHER_MODE_CBC)
+int mbedtls_aes_crypt_cbc(mbedtls_aes_context *ctx, int mode, size_t length,
+        unsigned char iv[16], const unsigned char *input,
+        unsigned char *output);
+#endif
+#if MYNEWT_VAL(MBEDTLS_CIPHER_MODE_CFB)
+int mbedtls_aes_crypt_cfb128(mbedtls_aes_context *ctx, int mode,
+        size_t length, size_t *iv_off, unsigned char iv[16],
+        const unsigned char *input, unsigned char *output);
+int mbedtls_aes_crypt_cfb8(mbedtls_aes_context *ctx, int mode, size_t length,
+        unsigned char iv[16], const unsigned char *input,
+        unsigned char *output);
+#endif
+#if MYNEWT_VAL(MBEDTLS_CIPHER_MODE_OFB)
+int mbedtls_aes_crypt_ofb(mbedtls_aes_context *ctx, size_t length,
+        size_t *iv_off, unsigned char iv[16], const unsigned char *input,
+        unsigned char *output);
+#endif
+#if MYNEWT_VAL(MBEDTLS_CIPHER_MODE_CTR)
+int mbedtls_aes_crypt_ctr(mbedtls_aes_context *ctx, size_t length,
+        size_t *nc_off, unsigned char nonce_counter[16],
+        unsigned char stream_block[16], const unsigned char *input,
+        unsigned char *output);
+#endif
 
 #ifdef __cplusplus
 }
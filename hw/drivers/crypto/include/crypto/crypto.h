@@ -67,6 +67,16 @@ typedef uint32_t (* crypto_op_func_t)(struct crypto_dev *crypto, uint16_t algo,
         const uint8_t *inbuf, uint8_t *outbuf, uint32_t len);
 typedef bool (* crypto_support_func_t)(struct crypto_dev *crypto, uint8_t op,
         uint16_t algo, uint16_t mode, uint16_t keylen);
+/*
+ * Returns 0 on success, SYS_EACCES if tag did not match on decryption or
+ * SYS_ENOTSUP if parameters are not supported by HW, in which case the
+ * software implementation is used.
+ */
+typedef int (* crypto_aead_func_t)(struct crypto_dev *crypto, uint8_t op,
+        uint16_t algo, uint16_t mode, const uint8_t *key, uint16_t keylen,
+        const uint8_t *nonce, uint16_t noncelen, const uint8_t *aad,
+        uint32_t aadlen, const uint8_t *inbuf, uint8_t *outbuf, uint32_t len,
+        uint8_t *tag, uint16_t taglen);
 
 /**
  * @struct crypto_interface
@@ -81,18 +91,74 @@ typedef bool (* crypto_support_func_t)(struct crypto_dev *crypto, uint8_t op,
  * @var crypto_interface::has_support
  * has_support is used to inquire about which algos/modes are natively
  * supported
+ *
+ * @var crypto_interface::aead
+ * aead is an optional crypto_aead_func_t pointer to the authenticated
+ * encryption routine (CRYPTO_MODE_CCM, CRYPTO_MODE_GCM)
  */
 struct crypto_interface {
     crypto_op_func_t encrypt;
     crypto_op_func_t decrypt;
     crypto_support_func_t has_support;
+    crypto_aead_func_t aead;
 };
 
+struct crypto_job;
+
 struct crypto_dev {
     struct os_dev dev;
     struct crypto_interface interface;
+#if MYNEWT_VAL(CRYPTO_ASYNC)
+    /* Jobs submitted with crypto_submit(), processed in order */
+    struct crypto_job *jobs_head;
+    struct crypto_job *jobs_tail;
+    struct os_event jobs_ev;
+#endif
 };
 
+#if MYNEWT_VAL(CRYPTO_ASYNC)
+/**
+ * @struct crypto_job
+ * @brief Asynchronous crypto operation, see crypto_submit()
+ *
+ * Parameters have the same meaning as for crypto_encrypt_custom() and
+ * crypto_decrypt_custom(), and all buffers must stay valid until the job
+ * completes.
+ *
+ * @var crypto_job::op
+ * CRYPTO_OP_ENCRYPT or CRYPTO_OP_DECRYPT
+ *
+ * @var crypto_job::result
+ * Number of bytes processed, set when the job completes
+ *
+ * @var crypto_job::ev
+ * Completion event, ev_cb must be set by the caller; ev_arg is not used
+ *
+ * @var crypto_job::evq
+ * Event queue to post completion event to, or NULL to call ev_cb directly
+ * from the crypto task
+ */
+struct crypto_job {
+    uint8_t op;
+    uint16_t algo;
+    uint16_t mode;
+    const void *key;
+    uint16_t keylen;
+    void *iv;
+    const void *inbuf;
+    void *outbuf;
+    uint32_t len;
+    uint32_t result;
+    struct os_event ev;
+    struct os_eventq *evq;
+    struct crypto_job *next;
+};
+#endif
+
+/*
+ * Same layout as struct os_mbuf_iovec: an array filled in by
+ * os_mbuf_to_iovec() may be cast and passed to the iovec functions below.
+ */
 struct crypto_iovec {
     void *iov_base;
     size_t iov_len;
@@ -184,6 +250,57 @@ uint32_t crypto_decryptv_custom(struct crypto_dev *crypto, uint16_t algo,
         uint16_t mode, const void *key, uint16_t keylen, void *iv,
         struct crypto_iovec *iov, uint32_t iovlen);
 
+/**
+ * Encrypt part of an mbuf chain in place using custom parameters
+ *
+ * Segments are walked directly; blocks that straddle a segment boundary
+ * are gathered into a bounce buffer, and shared or external data is
+ * copied before being overwritten.  Only CTR mode accepts a length that
+ * is not a multiple of AES_BLOCK_LEN.
+ *
+ * @note iv receives the initial vector and returns the final vector
+ *       after running on the block, so subsequent calls can use this value
+ *
+ * @param crypto   OS device
+ * @param algo     Algorithm to use (see CRYPTO_ALGO_*)
+ * @param mode     Mode to use (see CRYPTO_MODE_*)
+ * @param key      The key
+ * @param keylen   Length of the key in bits
+ * @param iv       NULL or initial value or nonce
+ * @param om       The mbuf chain to be in-place encrypted
+ * @param off      Offset into the chain of the first byte to encrypt
+ * @param len      Number of bytes to encrypt
+ *
+ * @return Number of bytes encrypted
+ */
+uint32_t crypto_encrypt_mbuf_custom(struct crypto_dev *crypto, uint16_t algo,
+        uint16_t mode, const void *key, uint16_t keylen, void *iv,
+        struct os_mbuf *om, int off, uint32_t len);
+
+/**
+ * Decrypt part of an mbuf chain in place using custom parameters
+ *
+ * See crypto_encrypt_mbuf_custom() for how the chain is processed.
+ *
+ * @note iv receives the initial vector and returns the final vector
+ *       after running on the block, so subsequent calls can use this value
+ *
+ * @param crypto   OS device
+ * @param algo     Algorithm to use (see CRYPTO_ALGO_*)
+ * @param mode     Mode to use (see CRYPTO_MODE_*)
+ * @param key      The key
+ * @param keylen   Length of the key in bits
+ * @param iv       NULL or initial value or nonce
+ * @param om       The mbuf chain to be in-place decrypted
+ * @param off      Offset into the chain of the first byte to decrypt
+ * @param len      Number of bytes to decrypt
+ *
+ * @return Number of bytes decrypted
+ */
+uint32_t crypto_decrypt_mbuf_custom(struct crypto_dev *crypto, uint16_t algo,
+        uint16_t mode, const void *key, uint16_t keylen, void *iv,
+        struct os_mbuf *om, int off, uint32_t len);
+
 /*
  * Query Crypto HW capabilities
  *
@@ -198,6 +315,22 @@ uint32_t crypto_decryptv_custom(struct crypto_dev *crypto, uint16_t algo,
 bool crypto_has_support(struct crypto_dev *crypto, uint8_t op, uint16_t algo,
         uint16_t mode, uint16_t keylen);
 
+#if MYNEWT_VAL(CRYPTO_ASYNC)
+/**
+ * Queue a crypto operation on the device and return immediately
+ *
+ * Jobs are run one after another by the crypto task, in order of
+ * submission per device, so jobs chaining the same iv or nonce can be
+ * queued back to back. Completion is reported with job->ev.
+ *
+ * @param crypto   OS device
+ * @param job      Job to run, must not be modified until it completes
+ *
+ * @return 0 on success, SYS_EINVAL if the job is not valid
+ */
+int crypto_submit(struct crypto_dev *crypto, struct crypto_job *job);
+#endif
+
 /*
  * AES helpers
  */
@@ -260,6 +393,38 @@ uint32_t crypto_decrypt_aes_ecb(struct crypto_dev *crypto, const void *key,
 uint32_t crypto_decryptv_aes_ecb(struct crypto_dev *crypto, const void *key,
         uint16_t keylen, struct crypto_iovec *iov, uint32_t iovlen);
 
+/**
+ * Encrypt part of an mbuf chain in place using AES-ECB
+ *
+ * @param crypto   OS device
+ * @param key      Key
+ * @param keylen   Key length should 128, 192 or 256 (AES size)
+ * @param om       The mbuf chain to be in-place encrypted
+ * @param off      Offset into the chain of the first byte
+ * @param len      Number of bytes to process
+ *
+ * @return Number of bytes encrypted
+ */
+uint32_t crypto_encrypt_mbuf_aes_ecb(struct crypto_dev *crypto,
+        const void *key, uint16_t keylen,
+        struct os_mbuf *om, int off, uint32_t len);
+
+/**
+ * Decrypt part of an mbuf chain in place using AES-ECB
+ *
+ * @param crypto   OS device
+ * @param key      Key
+ * @param keylen   Key length should 128, 192 or 256 (AES size)
+ * @param om       The mbuf chain to be in-place decrypted
+ * @param off      Offset into the chain of the first byte
+ * @param len      Number of bytes to process
+ *
+ * @return Number of bytes decrypted
+ */
+uint32_t crypto_decrypt_mbuf_aes_ecb(struct crypto_dev *crypto,
+        const void *key, uint16_t keylen,
+        struct os_mbuf *om, int off, uint32_t len);
+
 /**
  * Encrypt buffer using AES-CBC
  *
@@ -331,6 +496,44 @@ uint32_t crypto_decrypt_aes_cbc(struct crypto_dev *crypto, const void *key,
 uint32_t crypto_decryptv_aes_cbc(struct crypto_dev *crypto, const void *key,
         uint16_t keylen, void *iv, struct crypto_iovec *iov,  uint32_t iovlen);
 
+/**
+ * Encrypt part of an mbuf chain in place using AES-CBC
+ *
+ * @note Updated iv is written after function finishes
+ *
+ * @param crypto   OS device
+ * @param key      Key
+ * @param keylen   Key length should 128, 192 or 256 (AES size)
+ * @param iv       Initial vector
+ * @param om       The mbuf chain to be in-place encrypted
+ * @param off      Offset into the chain of the first byte
+ * @param len      Number of bytes to process
+ *
+ * @return Number of bytes encrypted
+ */
+uint32_t crypto_encrypt_mbuf_aes_cbc(struct crypto_dev *crypto,
+        const void *key, uint16_t keylen, void *iv,
+        struct os_mbuf *om, int off, uint32_t len);
+
+/**
+ * Decrypt part of an mbuf chain in place using AES-CBC
+ *
+ * @note Updated iv is written after function finishes
+ *
+ * @param crypto   OS device
+ * @param key      Key
+ * @param keylen   Key length should 128, 192 or 256 (AES size)
+ * @param iv       Initial vector
+ * @param om       The mbuf chain to be in-place decrypted
+ * @param off      Offset into the chain of the first byte
+ * @param len      Number of bytes to process
+ *
+ * @return Number of bytes decrypted
+ */
+uint32_t crypto_decrypt_mbuf_aes_cbc(struct crypto_dev *crypto,
+        const void *key, uint16_t keylen, void *iv,
+        struct os_mbuf *om, int off, uint32_t len);
+
 /**
  * Encrypt buffer using AES-CTR
  *
@@ -403,6 +606,149 @@ uint32_t crypto_decrypt_aes_ctr(struct crypto_dev *crypto, const void *key,
 uint32_t crypto_decryptv_aes_ctr(struct crypto_dev *crypto, const void *key,
         uint16_t keylen, void *nonce, struct crypto_iovec *iov, uint32_t iovlen);
 
+/**
+ * Encrypt part of an mbuf chain in place using AES-CTR
+ *
+ * @note Updated nonce is written after function finishes
+ *
+ * @param crypto   OS device
+ * @param key      Key
+ * @param keylen   Key length should 128, 192 or 256 (AES size)
+ * @param nonce    Nonce
+ * @param om       The mbuf chain to be in-place encrypted
+ * @param off      Offset into the chain of the first byte
+ * @param len      Number of bytes to process
+ *
+ * @return Number of bytes encrypted
+ */
+uint32_t crypto_encrypt_mbuf_aes_ctr(struct crypto_dev *crypto,
+        const void *key, uint16_t keylen, void *nonce,
+        struct os_mbuf *om, int off, uint32_t len);
+
+/**
+ * Decrypt part of an mbuf chain in place using AES-CTR
+ *
+ * @note Updated nonce is written after function finishes
+ *
+ * @param crypto   OS device
+ * @param key      Key
+ * @param keylen   Key length should 128, 192 or 256 (AES size)
+ * @param nonce    Nonce
+ * @param om       The mbuf chain to be in-place decrypted
+ * @param off      Offset into the chain of the first byte
+ * @param len      Number of bytes to process
+ *
+ * @return Number of bytes decrypted
+ */
+uint32_t crypto_decrypt_mbuf_aes_ctr(struct crypto_dev *crypto,
+        const void *key, uint16_t keylen, void *nonce,
+        struct os_mbuf *om, int off, uint32_t len);
+
+/*
+ * AEAD helpers
+ *
+ * HW support is used when available, otherwise modes are implemented on top
+ * of AES-ECB and AES-CTR (see CRYPTO_NEED_CCM and CRYPTO_NEED_GCM).
+ */
+
+/**
+ * Encrypt and authenticate buffer using AES-GCM
+ *
+ * @param crypto   OS device
+ * @param key      Key
+ * @param keylen   Key length should 128, 192 or 256 (AES size)
+ * @param nonce    Nonce (IV)
+ * @param noncelen Length of the nonce, only 12 is supported
+ * @param aad      Additional data which is authenticated, but not encrypted
+ * @param aadlen   Length of the additional data
+ * @param inbuf    Input buffer
+ * @param outbuf   Output buffer
+ * @param len      Length of the buffers
+ * @param tag      Resulting authentication tag
+ * @param taglen   Length of the tag, 4 to 16
+ *
+ * @return 0 on success, non-zero error code on failure
+ */
+int crypto_encrypt_aes_gcm(struct crypto_dev *crypto, const void *key,
+        uint16_t keylen, const void *nonce, uint16_t noncelen,
+        const void *aad, uint32_t aadlen, const void *inbuf, void *outbuf,
+        uint32_t len, void *tag, uint16_t taglen);
+
+/**
+ * Decrypt and verify buffer using AES-GCM
+ *
+ * @note outbuf is cleared if the tag does not match
+ *
+ * @param crypto   OS device
+ * @param key      Key
+ * @param keylen   Key length should 128, 192 or 256 (AES size)
+ * @param nonce    Nonce (IV)
+ * @param noncelen Length of the nonce, only 12 is supported
+ * @param aad      Additional data which is authenticated, but not encrypted
+ * @param aadlen   Length of the additional data
+ * @param inbuf    Input buffer
+ * @param outbuf   Output buffer
+ * @param len      Length of the buffers
+ * @param tag      Authentication tag to verify
+ * @param taglen   Length of the tag, 4 to 16
+ *
+ * @return 0 on success, SYS_EACCES if the tag does not match, other
+ *         non-zero error code on failure
+ */
+int crypto_decrypt_aes_gcm(struct crypto_dev *crypto, const void *key,
+        uint16_t keylen, const void *nonce, uint16_t noncelen,
+        const void *aad, uint32_t aadlen, const void *inbuf, void *outbuf,
+        uint32_t len, const void *tag, uint16_t taglen);
+
+/**
+ * Encrypt and authenticate buffer using AES-CCM
+ *
+ * @param crypto   OS device
+ * @param key      Key
+ * @param keylen   Key length should 128, 192 or 256 (AES size)
+ * @param nonce    Nonce
+ * @param noncelen Length of the nonce, 7 to 13
+ * @param aad      Additional data which is authenticated, but not encrypted
+ * @param aadlen   Length of the additional data
+ * @param inbuf    Input buffer
+ * @param outbuf   Output buffer
+ * @param len      Length of the buffers
+ * @param tag      Resulting authentication tag
+ * @param taglen   Length of the tag, 4 to 16 and even
+ *
+ * @return 0 on success, non-zero error code on failure
+ */
+int crypto_encrypt_aes_ccm(struct crypto_dev *crypto, const void *key,
+        uint16_t keylen, const void *nonce, uint16_t noncelen,
+        const void *aad, uint32_t aadlen, const void *inbuf, void *outbuf,
+        uint32_t len, void *tag, uint16_t taglen);
+
+/**
+ * Decrypt and verify buffer using AES-CCM
+ *
+ * @note outbuf is cleared if the tag does not match
+ *
+ * @param crypto   OS device
+ * @param key      Key
+ * @param keylen   Key length should 128, 192 or 256 (AES size)
+ * @param nonce    Nonce
+ * @param noncelen Length of the nonce, 7 to 13
+ * @param aad      Additional data which is authenticated, but not encrypted
+ * @param aadlen   Length of the additional data
+ * @param inbuf    Input buffer
+ * @param outbuf   Output buffer
+ * @param len      Length of the buffers
+ * @param tag      Authentication tag to verify
+ * @param taglen   Length of the tag, 4 to 16 and even
+ *
+ * @return 0 on success, SYS_EACCES if the tag does not match, other
+ *         non-zero error code on failure
+ */
+int crypto_decrypt_aes_ccm(struct crypto_dev *crypto, const void *key,
+        uint16_t keylen, const void *nonce, uint16_t noncelen,
+        const void *aad, uint32_t aadlen, const void *inbuf, void *outbuf,
+        uint32_t len, const void *tag, uint16_t taglen);
+
 #ifdef __cplusplus
 }
 #endif
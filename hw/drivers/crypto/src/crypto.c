@@ -17,8 +17,19 @@
  * under the License.
  */
 
+#include <assert.h>
 #include "crypto/crypto.h"
 
+/* os_mbuf_to_iovec() output is passed to the iovec API as-is. */
+static_assert(sizeof(struct crypto_iovec) == sizeof(struct os_mbuf_iovec),
+              "crypto_iovec and os_mbuf_iovec must have the same layout");
+static_assert(offsetof(struct crypto_iovec, iov_base) ==
+              offsetof(struct os_mbuf_iovec, iov_base),
+              "crypto_iovec and os_mbuf_iovec must have the same layout");
+static_assert(offsetof(struct crypto_iovec, iov_len) ==
+              offsetof(struct os_mbuf_iovec, iov_len),
+              "crypto_iovec and os_mbuf_iovec must have the same layout");
+
 /*
  * Implement modes using ECB for non-available HW support
  */
@@ -164,6 +175,410 @@ crypto_do_cbc(struct crypto_dev *crypto, uint8_t op, const void *key,
 }
 #endif /* MYNEWT_VAL(CRYPTO_NEED_CBC) && !MYNEWT_VAL(CRYPTO_HW_AES_CBC) */
 
+#if MYNEWT_VAL(CRYPTO_NEED_CCM) || MYNEWT_VAL(CRYPTO_NEED_GCM)
+static int
+crypto_aes_block(struct crypto_dev *crypto, const void *key, uint16_t keylen,
+        const uint8_t *inbuf, uint8_t *outbuf)
+{
+    uint32_t sz;
+
+    sz = crypto_encrypt_custom(crypto, CRYPTO_ALGO_AES, CRYPTO_MODE_ECB, key,
+            keylen, NULL, inbuf, outbuf, AES_BLOCK_LEN);
+
+    return sz == AES_BLOCK_LEN ? 0 : SYS_EIO;
+}
+
+static int
+crypto_aes_ctr(struct crypto_dev *crypto, const void *key, uint16_t keylen,
+        uint8_t *ctr, const uint8_t *inbuf, uint8_t *outbuf, uint32_t len)
+{
+    uint32_t sz;
+
+    if (len == 0) {
+        return 0;
+    }
+
+    sz = crypto_encrypt_custom(crypto, CRYPTO_ALGO_AES, CRYPTO_MODE_CTR, key,
+            keylen, ctr, inbuf, outbuf, len);
+
+    return sz == len ? 0 : SYS_EIO;
+}
+
+/*
+ * Compares tags in constant time.
+ */
+static int
+crypto_tag_cmp(const uint8_t *a, const uint8_t *b, const uint8_t *mask,
+        uint16_t len)
+{
+    uint8_t diff;
+    uint16_t i;
+
+    diff = 0;
+    for (i = 0; i < len; i++) {
+        diff |= a[i] ^ b[i] ^ mask[i];
+    }
+
+    return diff;
+}
+#endif
+
+#if MYNEWT_VAL(CRYPTO_NEED_CCM)
+/*
+ * CBC-MAC over data fed in arbitrary chunks.
+ */
+struct crypto_cbc_mac {
+    uint8_t x[AES_BLOCK_LEN];
+    uint8_t pos;
+};
+
+static int
+crypto_cbc_mac_block(struct crypto_dev *crypto, const void *key,
+        uint16_t keylen, struct crypto_cbc_mac *mac)
+{
+    uint8_t tmp[AES_BLOCK_LEN];
+
+    memcpy(tmp, mac->x, AES_BLOCK_LEN);
+    mac->pos = 0;
+
+    return crypto_aes_block(crypto, key, keylen, tmp, mac->x);
+}
+
+static int
+crypto_cbc_mac_update(struct crypto_dev *crypto, const void *key,
+        uint16_t keylen, struct crypto_cbc_mac *mac, const uint8_t *data,
+        uint32_t len)
+{
+    int rc;
+
+    while (len--) {
+        mac->x[mac->pos++] ^= *data++;
+        if (mac->pos == AES_BLOCK_LEN) {
+            rc = crypto_cbc_mac_block(crypto, key, keylen, mac);
+            if (rc) {
+                return rc;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Completes a zero padded block.
+ */
+static int
+crypto_cbc_mac_pad(struct crypto_dev *crypto, const void *key,
+        uint16_t keylen, struct crypto_cbc_mac *mac)
+{
+    if (mac->pos == 0) {
+        return 0;
+    }
+
+    return crypto_cbc_mac_block(crypto, key, keylen, mac);
+}
+
+/*
+ * AES-CCM as in NIST SP 800-38C / RFC 3610.
+ */
+static int
+crypto_do_ccm(struct crypto_dev *crypto, uint8_t op, const void *key,
+        uint16_t keylen, const uint8_t *nonce, uint16_t noncelen,
+        const uint8_t *aad, uint32_t aadlen, const uint8_t *inbuf,
+        uint8_t *outbuf, uint32_t len, uint8_t *tag, uint16_t taglen)
+{
+    struct crypto_cbc_mac mac;
+    uint8_t ctr[AES_BLOCK_LEN];
+    uint8_t s0[AES_BLOCK_LEN];
+    uint8_t hdr[6];
+    uint32_t v;
+    uint8_t l;
+    int hdrlen;
+    int rc;
+    int i;
+
+    if (noncelen < 7 || noncelen > 13 || taglen < 4 || taglen > 16 ||
+        (taglen & 1)) {
+        return SYS_EINVAL;
+    }
+
+    /* Size of length field */
+    l = 15 - noncelen;
+    if (l < 4 && (len >> (8 * l)) != 0) {
+        return SYS_EINVAL;
+    }
+
+    /* B0 block */
+    memset(&mac, 0, sizeof(mac));
+    mac.x[0] = (aadlen ? 0x40 : 0) | (((taglen - 2) / 2) << 3) | (l - 1);
+    memcpy(&mac.x[1], nonce, noncelen);
+    v = len;
+    for (i = 0; i < l; i++) {
+        mac.x[AES_BLOCK_LEN - 1 - i] = v & 0xff;
+        v >>= 8;
+    }
+    rc = crypto_cbc_mac_block(crypto, key, keylen, &mac);
+    if (rc) {
+        return rc;
+    }
+
+    if (aadlen) {
+        if (aadlen < 0xff00) {
+            hdr[0] = aadlen >> 8;
+            hdr[1] = aadlen;
+            hdrlen = 2;
+        } else {
+            hdr[0] = 0xff;
+            hdr[1] = 0xfe;
+            put_be32(&hdr[2], aadlen);
+            hdrlen = 6;
+        }
+        rc = crypto_cbc_mac_update(crypto, key, keylen, &mac, hdr, hdrlen);
+        if (rc == 0) {
+            rc = crypto_cbc_mac_update(crypto, key, keylen, &mac, aad, aadlen);
+        }
+        if (rc == 0) {
+            rc = crypto_cbc_mac_pad(crypto, key, keylen, &mac);
+        }
+        if (rc) {
+            return rc;
+        }
+    }
+
+    /* A0 block encrypts the tag, payload starts with A1 */
+    memset(ctr, 0, sizeof(ctr));
+    ctr[0] = l - 1;
+    memcpy(&ctr[1], nonce, noncelen);
+    rc = crypto_aes_block(crypto, key, keylen, ctr, s0);
+    if (rc) {
+        return rc;
+    }
+    ctr[AES_BLOCK_LEN - 1] = 1;
+
+    if (op == CRYPTO_OP_ENCRYPT) {
+        rc = crypto_cbc_mac_update(crypto, key, keylen, &mac, inbuf, len);
+        if (rc == 0) {
+            rc = crypto_cbc_mac_pad(crypto, key, keylen, &mac);
+        }
+        if (rc == 0) {
+            rc = crypto_aes_ctr(crypto, key, keylen, ctr, inbuf, outbuf, len);
+        }
+        if (rc) {
+            return rc;
+        }
+        for (i = 0; i < taglen; i++) {
+            tag[i] = mac.x[i] ^ s0[i];
+        }
+    } else {
+        rc = crypto_aes_ctr(crypto, key, keylen, ctr, inbuf, outbuf, len);
+        if (rc == 0) {
+            rc = crypto_cbc_mac_update(crypto, key, keylen, &mac, outbuf, len);
+        }
+        if (rc == 0) {
+            rc = crypto_cbc_mac_pad(crypto, key, keylen, &mac);
+        }
+        if (rc == 0 && crypto_tag_cmp(tag, mac.x, s0, taglen)) {
+            rc = SYS_EACCES;
+        }
+        if (rc) {
+            memset(outbuf, 0, len);
+            return rc;
+        }
+    }
+
+    return 0;
+}
+#endif /* MYNEWT_VAL(CRYPTO_NEED_CCM) */
+
+#if MYNEWT_VAL(CRYPTO_NEED_GCM)
+/*
+ * GHASH using 4-bit tables (Shoup's method), multiples of H are stored as
+ * high and low 64-bit halves.
+ */
+struct crypto_ghash {
+    uint64_t hh[16];
+    uint64_t hl[16];
+    uint8_t y[AES_BLOCK_LEN];
+};
+
+static const uint16_t crypto_ghash_last4[16] = {
+    0x0000, 0x1c20, 0x3840, 0x2460, 0x7080, 0x6ca0, 0x48c0, 0x54e0,
+    0xe100, 0xfd20, 0xd940, 0xc560, 0x9180, 0x8da0, 0xa9c0, 0xb5e0
+};
+
+static void
+crypto_ghash_init(struct crypto_ghash *g, const uint8_t *h)
+{
+    uint64_t vh;
+    uint64_t vl;
+    uint32_t t;
+    int i;
+    int j;
+
+    vh = ((uint64_t)get_be32(&h[0]) << 32) | get_be32(&h[4]);
+    vl = ((uint64_t)get_be32(&h[8]) << 32) | get_be32(&h[12]);
+
+    g->hh[0] = 0;
+    g->hl[0] = 0;
+    g->hh[8] = vh;
+    g->hl[8] = vl;
+
+    for (i = 4; i > 0; i >>= 1) {
+        t = (vl & 1) * 0xe1000000U;
+        vl = (vh << 63) | (vl >> 1);
+        vh = (vh >> 1) ^ ((uint64_t)t << 32);
+        g->hh[i] = vh;
+        g->hl[i] = vl;
+    }
+
+    for (i = 2; i <= 8; i *= 2) {
+        vh = g->hh[i];
+        vl = g->hl[i];
+        for (j = 1; j < i; j++) {
+            g->hh[i + j] = vh ^ g->hh[j];
+            g->hl[i + j] = vl ^ g->hl[j];
+        }
+    }
+
+    memset(g->y, 0, sizeof(g->y));
+}
+
+/*
+ * y = y * H
+ */
+static void
+crypto_ghash_mult(struct crypto_ghash *g)
+{
+    uint64_t zh;
+    uint64_t zl;
+    uint8_t rem;
+    uint8_t lo;
+    uint8_t hi;
+    int i;
+
+    lo = g->y[15] & 0x0f;
+    zh = g->hh[lo];
+    zl = g->hl[lo];
+
+    for (i = 15; i >= 0; i--) {
+        lo = g->y[i] & 0x0f;
+        hi = g->y[i] >> 4;
+
+        if (i != 15) {
+            rem = zl & 0x0f;
+            zl = (zh << 60) | (zl >> 4);
+            zh = (zh >> 4) ^ ((uint64_t)crypto_ghash_last4[rem] << 48);
+            zh ^= g->hh[lo];
+            zl ^= g->hl[lo];
+        }
+
+        rem = zl & 0x0f;
+        zl = (zh << 60) | (zl >> 4);
+        zh = (zh >> 4) ^ ((uint64_t)crypto_ghash_last4[rem] << 48);
+        zh ^= g->hh[hi];
+        zl ^= g->hl[hi];
+    }
+
+    put_be32(&g->y[0], zh >> 32);
+    put_be32(&g->y[4], zh);
+    put_be32(&g->y[8], zl >> 32);
+    put_be32(&g->y[12], zl);
+}
+
+/*
+ * Hashes data, last partial block is zero padded.
+ */
+static void
+crypto_ghash_update(struct crypto_ghash *g, const uint8_t *data, uint32_t len)
+{
+    uint32_t n;
+    uint32_t i;
+
+    while (len) {
+        n = min(len, AES_BLOCK_LEN);
+        for (i = 0; i < n; i++) {
+            g->y[i] ^= data[i];
+        }
+        crypto_ghash_mult(g);
+        data += n;
+        len -= n;
+    }
+}
+
+/*
+ * AES-GCM as in NIST SP 800-38D, for 96-bit IV.
+ */
+static int
+crypto_do_gcm(struct crypto_dev *crypto, uint8_t op, const void *key,
+        uint16_t keylen, const uint8_t *nonce, uint16_t noncelen,
+        const uint8_t *aad, uint32_t aadlen, const uint8_t *inbuf,
+        uint8_t *outbuf, uint32_t len, uint8_t *tag, uint16_t taglen)
+{
+    struct crypto_ghash g;
+    uint8_t ctr[AES_BLOCK_LEN];
+    uint8_t ek0[AES_BLOCK_LEN];
+    uint8_t lens[AES_BLOCK_LEN];
+    int rc;
+    int i;
+
+    if (noncelen != 12 || taglen < 4 || taglen > 16) {
+        return SYS_EINVAL;
+    }
+
+    /* H = E(K, 0) */
+    memset(ctr, 0, sizeof(ctr));
+    rc = crypto_aes_block(crypto, key, keylen, ctr, ek0);
+    if (rc) {
+        return rc;
+    }
+    crypto_ghash_init(&g, ek0);
+
+    /* J0 = IV || 1 encrypts the tag, payload starts with J0 + 1 */
+    memcpy(ctr, nonce, noncelen);
+    put_be32(&ctr[12], 1);
+    rc = crypto_aes_block(crypto, key, keylen, ctr, ek0);
+    if (rc) {
+        return rc;
+    }
+    put_be32(&ctr[12], 2);
+
+    crypto_ghash_update(&g, aad, aadlen);
+
+    if (op == CRYPTO_OP_ENCRYPT) {
+        rc = crypto_aes_ctr(crypto, key, keylen, ctr, inbuf, outbuf, len);
+        if (rc) {
+            return rc;
+        }
+        crypto_ghash_update(&g, outbuf, len);
+    } else {
+        /* Hash ciphertext first, decryption can be in-place */
+        crypto_ghash_update(&g, inbuf, len);
+        rc = crypto_aes_ctr(crypto, key, keylen, ctr, inbuf, outbuf, len);
+        if (rc) {
+            memset(outbuf, 0, len);
+            return rc;
+        }
+    }
+
+    put_be32(&lens[0], aadlen >> 29);
+    put_be32(&lens[4], aadlen << 3);
+    put_be32(&lens[8], len >> 29);
+    put_be32(&lens[12], len << 3);
+    crypto_ghash_update(&g, lens, sizeof(lens));
+
+    if (op == CRYPTO_OP_ENCRYPT) {
+        for (i = 0; i < taglen; i++) {
+            tag[i] = g.y[i] ^ ek0[i];
+        }
+    } else if (crypto_tag_cmp(tag, g.y, ek0, taglen)) {
+        memset(outbuf, 0, len);
+        return SYS_EACCES;
+    }
+
+    return 0;
+}
+#endif /* MYNEWT_VAL(CRYPTO_NEED_GCM) */
+
 /*
  * Custom (low-level) functions
  */
@@ -291,6 +706,103 @@ crypto_decryptv_custom(struct crypto_dev *crypto, uint16_t algo, uint16_t mode,
     return total;
 }
 
+typedef uint32_t (* crypto_mbuf_op_func_t)(struct crypto_dev *crypto,
+        uint16_t algo, uint16_t mode, const void *key, uint16_t keylen,
+        void *iv, const void *inbuf, void *outbuf, uint32_t len);
+
+/*
+ * Walks an mbuf chain transforming it in place.  Whole blocks lying in a
+ * writable segment are handed to the driver directly; blocks straddling a
+ * segment boundary, and data that is shared or external, go through a
+ * single block bounce buffer and are written back by os_mbuf_copyinto(),
+ * which takes a private copy of non-writable data.
+ */
+static uint32_t
+crypto_mbuf_process(crypto_mbuf_op_func_t op, struct crypto_dev *crypto,
+        uint16_t algo, uint16_t mode, const void *key, uint16_t keylen,
+        void *iv, struct os_mbuf *om, int off, uint32_t len)
+{
+    uint8_t blk[AES_BLOCK_LEN];
+    struct os_mbuf *cur;
+    uint16_t cur_off;
+    uint32_t total;
+    uint32_t avail;
+    uint32_t chunk;
+    uint32_t done;
+    uint8_t *data;
+
+    if (crypto->interface.encrypt == NULL) {
+        return 0;
+    }
+
+    /* Only CTR can finish on a partial block. */
+    if (mode != CRYPTO_MODE_CTR && (len % AES_BLOCK_LEN) != 0) {
+        return 0;
+    }
+
+    total = 0;
+    cur = os_mbuf_off(om, off, &cur_off);
+    while (cur != NULL && len > 0) {
+        if (cur_off >= cur->om_len) {
+            cur = SLIST_NEXT(cur, om_next);
+            cur_off = 0;
+            continue;
+        }
+
+        avail = cur->om_len - cur_off;
+        if (len <= avail && mode == CRYPTO_MODE_CTR) {
+            chunk = len;
+        } else {
+            chunk = min(avail, len) & ~(AES_BLOCK_LEN - 1);
+        }
+
+        if (chunk > 0 && os_mbuf_writable(cur)) {
+            data = cur->om_data + cur_off;
+            done = op(crypto, algo, mode, key, keylen, iv, data, data, chunk);
+            total += done;
+            if (done != chunk) {
+                break;
+            }
+            cur_off += chunk;
+        } else {
+            chunk = min(len, AES_BLOCK_LEN);
+            if (os_mbuf_copydata(om, off + total, chunk, blk) != 0) {
+                break;
+            }
+            done = op(crypto, algo, mode, key, keylen, iv, blk, blk, chunk);
+            if (done != chunk ||
+                os_mbuf_copyinto(om, off + total, blk, chunk) != 0) {
+                break;
+            }
+            total += chunk;
+            /* The block may span segments and cur may have been unshared. */
+            cur = os_mbuf_off(om, off + total, &cur_off);
+        }
+
+        len -= chunk;
+    }
+
+    return total;
+}
+
+uint32_t
+crypto_encrypt_mbuf_custom(struct crypto_dev *crypto, uint16_t algo,
+        uint16_t mode, const void *key, uint16_t keylen, void *iv,
+        struct os_mbuf *om, int off, uint32_t len)
+{
+    return crypto_mbuf_process(crypto_encrypt_custom, crypto, algo, mode,
+            key, keylen, iv, om, off, len);
+}
+
+uint32_t
+crypto_decrypt_mbuf_custom(struct crypto_dev *crypto, uint16_t algo,
+        uint16_t mode, const void *key, uint16_t keylen, void *iv,
+        struct os_mbuf *om, int off, uint32_t len)
+{
+    return crypto_mbuf_process(crypto_decrypt_custom, crypto, algo, mode,
+            key, keylen, iv, om, off, len);
+}
+
 /*
  * AES-ECB helpers
  */
@@ -327,6 +839,22 @@ crypto_decryptv_aes_ecb(struct crypto_dev *crypto, const void *key,
             key, keylen, NULL, iov, iovlen);
 }
 
+uint32_t
+crypto_encrypt_mbuf_aes_ecb(struct crypto_dev *crypto, const void *key,
+        uint16_t keylen, struct os_mbuf *om, int off, uint32_t len)
+{
+    return crypto_encrypt_mbuf_custom(crypto, CRYPTO_ALGO_AES, CRYPTO_MODE_ECB,
+            key, keylen, NULL, om, off, len);
+}
+
+uint32_t
+crypto_decrypt_mbuf_aes_ecb(struct crypto_dev *crypto, const void *key,
+        uint16_t keylen, struct os_mbuf *om, int off, uint32_t len)
+{
+    return crypto_decrypt_mbuf_custom(crypto, CRYPTO_ALGO_AES, CRYPTO_MODE_ECB,
+            key, keylen, NULL, om, off, len);
+}
+
 /*
  * AES-CBC helpers
  */
@@ -365,6 +893,22 @@ crypto_decryptv_aes_cbc(struct crypto_dev *crypto, const void *key,
             key, keylen, iv, iov, iovlen);
 }
 
+uint32_t
+crypto_encrypt_mbuf_aes_cbc(struct crypto_dev *crypto, const void *key,
+        uint16_t keylen, void *iv, struct os_mbuf *om, int off, uint32_t len)
+{
+    return crypto_encrypt_mbuf_custom(crypto, CRYPTO_ALGO_AES, CRYPTO_MODE_CBC,
+            key, keylen, iv, om, off, len);
+}
+
+uint32_t
+crypto_decrypt_mbuf_aes_cbc(struct crypto_dev *crypto, const void *key,
+        uint16_t keylen, void *iv, struct os_mbuf *om, int off, uint32_t len)
+{
+    return crypto_decrypt_mbuf_custom(crypto, CRYPTO_ALGO_AES, CRYPTO_MODE_CBC,
+            key, keylen, iv, om, off, len);
+}
+
 /*
  * AES-CTR helpers
  */
@@ -403,6 +947,22 @@ crypto_decryptv_aes_ctr(struct crypto_dev *crypto, const void *key,
             key, keylen, nonce, iov, iovlen);
 }
 
+uint32_t
+crypto_encrypt_mbuf_aes_ctr(struct crypto_dev *crypto, const void *key,
+        uint16_t keylen, void *nonce, struct os_mbuf *om, int off, uint32_t len)
+{
+    return crypto_encrypt_mbuf_custom(crypto, CRYPTO_ALGO_AES, CRYPTO_MODE_CTR,
+            key, keylen, nonce, om, off, len);
+}
+
+uint32_t
+crypto_decrypt_mbuf_aes_ctr(struct crypto_dev *crypto, const void *key,
+        uint16_t keylen, void *nonce, struct os_mbuf *om, int off, uint32_t len)
+{
+    return crypto_decrypt_mbuf_custom(crypto, CRYPTO_ALGO_AES, CRYPTO_MODE_CTR,
+            key, keylen, nonce, om, off, len);
+}
+
 /*
  * More driver interface
  */
@@ -414,3 +974,90 @@ crypto_has_support(struct crypto_dev *crypto, uint8_t op, uint16_t algo,
     assert(crypto->interface.has_support);
     return crypto->interface.has_support(crypto, op, algo, mode, keylen);
 }
+
+/*
+ * AEAD helpers
+ */
+
+static int
+crypto_aead(struct crypto_dev *crypto, uint8_t op, uint16_t mode,
+        const void *key, uint16_t keylen, const void *nonce, uint16_t noncelen,
+        const void *aad, uint32_t aadlen, const void *inbuf, void *outbuf,
+        uint32_t len, void *tag, uint16_t taglen)
+{
+    int rc;
+
+    rc = SYS_ENOTSUP;
+    if (crypto->interface.aead &&
+        crypto_has_support(crypto, op, CRYPTO_ALGO_AES, mode, keylen)) {
+        rc = crypto->interface.aead(crypto, op, CRYPTO_ALGO_AES, mode,
+                (const uint8_t *)key, keylen, (const uint8_t *)nonce, noncelen,
+                (const uint8_t *)aad, aadlen, (const uint8_t *)inbuf,
+                (uint8_t *)outbuf, len, (uint8_t *)tag, taglen);
+    }
+
+    if (rc != SYS_ENOTSUP ||
+        !crypto_has_support(crypto, CRYPTO_OP_ENCRYPT, CRYPTO_ALGO_AES,
+                            CRYPTO_MODE_ECB, keylen)) {
+        return rc;
+    }
+
+    switch (mode) {
+#if MYNEWT_VAL(CRYPTO_NEED_CCM)
+    case CRYPTO_MODE_CCM:
+        return crypto_do_ccm(crypto, op, key, keylen, nonce, noncelen, aad,
+                aadlen, inbuf, outbuf, len, tag, taglen);
+#endif
+#if MYNEWT_VAL(CRYPTO_NEED_GCM)
+    case CRYPTO_MODE_GCM:
+        return crypto_do_gcm(crypto, op, key, keylen, nonce, noncelen, aad,
+                aadlen, inbuf, outbuf, len, tag, taglen);
+#endif
+    default:
+        return SYS_ENOTSUP;
+    }
+}
+
+int
+crypto_encrypt_aes_gcm(struct crypto_dev *crypto, const void *key,
+        uint16_t keylen, const void *nonce, uint16_t noncelen,
+        const void *aad, uint32_t aadlen, const void *inbuf, void *outbuf,
+        uint32_t len, void *tag, uint16_t taglen)
+{
+    return crypto_aead(crypto, CRYPTO_OP_ENCRYPT, CRYPTO_MODE_GCM, key,
+            keylen, nonce, noncelen, aad, aadlen, inbuf, outbuf, len, tag,
+            taglen);
+}
+
+int
+crypto_decrypt_aes_gcm(struct crypto_dev *crypto, const void *key,
+        uint16_t keylen, const void *nonce, uint16_t noncelen,
+        const void *aad, uint32_t aadlen, const void *inbuf, void *outbuf,
+        uint32_t len, const void *tag, uint16_t taglen)
+{
+    return crypto_aead(crypto, CRYPTO_OP_DECRYPT, CRYPTO_MODE_GCM, key,
+            keylen, nonce, noncelen, aad, aadlen, inbuf, outbuf, len,
+            (void *)tag, taglen);
+}
+
+int
+crypto_encrypt_aes_ccm(struct crypto_dev *crypto, const void *key,
+        uint16_t keylen, const void *nonce, uint16_t noncelen,
+        const void *aad, uint32_t aadlen, const void *inbuf, void *outbuf,
+        uint32_t len, void *tag, uint16_t taglen)
+{
+    return crypto_aead(crypto, CRYPTO_OP_ENCRYPT, CRYPTO_MODE_CCM, key,
+            keylen, nonce, noncelen, aad, aadlen, inbuf, outbuf, len, tag,
+            taglen);
+}
+
+int
+crypto_decrypt_aes_ccm(struct crypto_dev *crypto, const void *key,
+        uint16_t keylen, const void *nonce, uint16_t noncelen,
+        const void *aad, uint32_t aadlen, const void *inbuf, void *outbuf,
+        uint32_t len, const void *tag, uint16_t taglen)
+{
+    return crypto_aead(crypto, CRYPTO_OP_DECRYPT, CRYPTO_MODE_CCM, key,
+            keylen, nonce, noncelen, aad, aadlen, inbuf, outbuf, len,
+            (void *)tag, taglen);
+}
@@ -0,0 +1,131 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(CRYPTO_ASYNC)
+#include <assert.h>
+#include "crypto/crypto.h"
+
+static struct os_task crypto_async_task;
+static struct os_eventq crypto_async_evq;
+OS_TASK_STACK_DEFINE(crypto_async_stack, MYNEWT_VAL(CRYPTO_ASYNC_STACK_SIZE));
+
+static void
+crypto_async_task_handler(void *arg)
+{
+    while (1) {
+        os_eventq_run(&crypto_async_evq);
+    }
+}
+
+/*
+ * Runs the oldest job of a device. Remaining jobs are run from subsequent
+ * events so that devices sharing the task get their turn.
+ */
+static void
+crypto_async_run(struct os_event *ev)
+{
+    struct crypto_dev *crypto = ev->ev_arg;
+    struct crypto_job *job;
+    bool more;
+    int sr;
+
+    OS_ENTER_CRITICAL(sr);
+    job = crypto->jobs_head;
+    if (job) {
+        crypto->jobs_head = job->next;
+        if (!crypto->jobs_head) {
+            crypto->jobs_tail = NULL;
+        }
+    }
+    more = crypto->jobs_head != NULL;
+    OS_EXIT_CRITICAL(sr);
+
+    if (!job) {
+        return;
+    }
+
+    if (job->op == CRYPTO_OP_ENCRYPT) {
+        job->result = crypto_encrypt_custom(crypto, job->algo, job->mode,
+                job->key, job->keylen, job->iv, job->inbuf, job->outbuf,
+                job->len);
+    } else {
+        job->result = crypto_decrypt_custom(crypto, job->algo, job->mode,
+                job->key, job->keylen, job->iv, job->inbuf, job->outbuf,
+                job->len);
+    }
+
+    if (more) {
+        os_eventq_put(&crypto_async_evq, &crypto->jobs_ev);
+    }
+
+    if (job->evq) {
+        os_eventq_put(job->evq, &job->ev);
+    } else {
+        job->ev.ev_cb(&job->ev);
+    }
+}
+
+int
+crypto_submit(struct crypto_dev *crypto, struct crypto_job *job)
+{
+    int sr;
+
+    if (!CRYPTO_VALID_OP(job->op) || job->ev.ev_cb == NULL) {
+        return SYS_EINVAL;
+    }
+
+    job->next = NULL;
+    job->result = 0;
+
+    OS_ENTER_CRITICAL(sr);
+    if (crypto->jobs_ev.ev_cb == NULL) {
+        crypto->jobs_ev.ev_cb = crypto_async_run;
+        crypto->jobs_ev.ev_arg = crypto;
+    }
+    if (crypto->jobs_tail) {
+        crypto->jobs_tail->next = job;
+    } else {
+        crypto->jobs_head = job;
+    }
+    crypto->jobs_tail = job;
+    OS_EXIT_CRITICAL(sr);
+
+    os_eventq_put(&crypto_async_evq, &crypto->jobs_ev);
+
+    return 0;
+}
+
+void
+crypto_async_pkg_init(void)
+{
+    int rc;
+
+    /* Ensure this function only gets called by sysinit. */
+    SYSINIT_ASSERT_ACTIVE();
+
+    os_eventq_init(&crypto_async_evq);
+    rc = os_task_init(&crypto_async_task, "crypto", crypto_async_task_handler,
+                      NULL, MYNEWT_VAL(CRYPTO_ASYNC_TASK_PRIO),
+                      OS_WAIT_FOREVER, crypto_async_stack,
+                      MYNEWT_VAL(CRYPTO_ASYNC_STACK_SIZE));
+    SYSINIT_PANIC_ASSERT(rc == 0);
+}
+#endif /* MYNEWT_VAL(CRYPTO_ASYNC) */
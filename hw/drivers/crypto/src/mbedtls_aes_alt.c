@@ -21,9 +21,20 @@
 
 #if MYNEWT_VAL(MBEDTLS_AES_ALT)
 
+#include <string.h>
 #include "crypto/crypto.h"
 #include "crypto/aes_alt.h"
 
+/*
+ * Values from mbedtls/aes.h, which cannot be included here: it only sees
+ * the Mynewt mbedTLS configuration when built inside crypto/mbedtls.
+ */
+#define AES_ALT_ENCRYPT                 1
+#define AES_ALT_ERR_INVALID_KEY_LENGTH  (-0x0020)
+#define AES_ALT_ERR_INVALID_INPUT_LEN   (-0x0022)
+#define AES_ALT_ERR_FEATURE_UNAVAIL     (-0x0023)
+#define AES_ALT_ERR_HW_ACCEL_FAILED     (-0x0025)
+
 void
 mbedtls_aes_init(mbedtls_aes_context *ctx)
 {
@@ -36,32 +47,272 @@ mbedtls_aes_init(mbedtls_aes_context *ctx)
 void
 mbedtls_aes_free(mbedtls_aes_context *ctx)
 {
-    os_dev_close((struct os_dev *)ctx->crypto);
+    if (ctx->crypto) {
+        os_dev_close((struct os_dev *)ctx->crypto);
+    }
     memset(ctx, 0, sizeof(*ctx));
 }
 
+static int
+mbedtls_aes_alt_setkey(mbedtls_aes_context *ctx, uint8_t op,
+        const unsigned char *key, unsigned int keybits)
+{
+    if (!CRYPTO_VALID_AES_KEYLEN(keybits)) {
+        return AES_ALT_ERR_INVALID_KEY_LENGTH;
+    }
+    if (!crypto_has_support(ctx->crypto, op, CRYPTO_ALGO_AES,
+                            CRYPTO_MODE_ECB, keybits)) {
+        return AES_ALT_ERR_FEATURE_UNAVAIL;
+    }
+
+    memcpy(ctx->key, key, keybits / 8);
+    ctx->keylen = keybits;
+
+    return 0;
+}
+
 int
 mbedtls_aes_setkey_enc(mbedtls_aes_context *ctx, const unsigned char *key,
         unsigned int keybits)
 {
-    switch (keybits) {
-    case AES_128_KEY_LEN * 8:
-    case AES_192_KEY_LEN * 8:
-    case AES_256_KEY_LEN * 8:
-        memcpy(ctx->key, key, keybits / 8);
-        ctx->keylen = keybits;
-        return 0;
-    }
+    return mbedtls_aes_alt_setkey(ctx, CRYPTO_OP_ENCRYPT, key, keybits);
+}
+
+int
+mbedtls_aes_setkey_dec(mbedtls_aes_context *ctx, const unsigned char *key,
+        unsigned int keybits)
+{
+    return mbedtls_aes_alt_setkey(ctx, CRYPTO_OP_DECRYPT, key, keybits);
+}
+
+int
+mbedtls_internal_aes_encrypt(mbedtls_aes_context *ctx,
+        const unsigned char input[16], unsigned char output[16])
+{
+    uint32_t len;
+
+    len = crypto_encrypt_aes_ecb(ctx->crypto, ctx->key, ctx->keylen,
+            input, output, AES_BLOCK_LEN);
 
-    return -1;
+    return len == AES_BLOCK_LEN ? 0 : AES_ALT_ERR_HW_ACCEL_FAILED;
+}
+
+int
+mbedtls_internal_aes_decrypt(mbedtls_aes_context *ctx,
+        const unsigned char input[16], unsigned char output[16])
+{
+    uint32_t len;
+
+    len = crypto_decrypt_aes_ecb(ctx->crypto, ctx->key, ctx->keylen,
+            input, output, AES_BLOCK_LEN);
+
+    return len == AES_BLOCK_LEN ? 0 : AES_ALT_ERR_HW_ACCEL_FAILED;
 }
 
 int
 mbedtls_aes_crypt_ecb(mbedtls_aes_context *ctx, int mode,
         const unsigned char input[16], unsigned char output[16])
 {
-    return crypto_encrypt_aes_ecb(ctx->crypto, ctx->key, ctx->keylen,
-            (const uint8_t *)input, (uint8_t *)output, AES_BLOCK_LEN);
+    if (mode == AES_ALT_ENCRYPT) {
+        return mbedtls_internal_aes_encrypt(ctx, input, output);
+    }
+
+    return mbedtls_internal_aes_decrypt(ctx, input, output);
+}
+
+#if MYNEWT_VAL(MBEDTLS_CIPHER_MODE_CBC)
+/*
+ * The whole buffer goes to the device in one call.  The IV is updated
+ * here rather than relying on the driver, and also works in place.
+ */
+int
+mbedtls_aes_crypt_cbc(mbedtls_aes_context *ctx, int mode, size_t length,
+        unsigned char iv[16], const unsigned char *input,
+        unsigned char *output)
+{
+    uint8_t next_iv[AES_BLOCK_LEN];
+    uint8_t cur_iv[AES_BLOCK_LEN];
+    uint32_t len;
+
+    if (length % AES_BLOCK_LEN) {
+        return AES_ALT_ERR_INVALID_INPUT_LEN;
+    }
+    if (length == 0) {
+        return 0;
+    }
+
+    memcpy(cur_iv, iv, AES_BLOCK_LEN);
+    if (mode == AES_ALT_ENCRYPT) {
+        len = crypto_encrypt_aes_cbc(ctx->crypto, ctx->key, ctx->keylen,
+                cur_iv, input, output, length);
+        memcpy(next_iv, output + length - AES_BLOCK_LEN, AES_BLOCK_LEN);
+    } else {
+        memcpy(next_iv, input + length - AES_BLOCK_LEN, AES_BLOCK_LEN);
+        len = crypto_decrypt_aes_cbc(ctx->crypto, ctx->key, ctx->keylen,
+                cur_iv, input, output, length);
+    }
+    if (len != length) {
+        return AES_ALT_ERR_HW_ACCEL_FAILED;
+    }
+
+    memcpy(iv, next_iv, AES_BLOCK_LEN);
+
+    return 0;
+}
+#endif
+
+#if MYNEWT_VAL(MBEDTLS_CIPHER_MODE_CFB)
+int
+mbedtls_aes_crypt_cfb128(mbedtls_aes_context *ctx, int mode, size_t length,
+        size_t *iv_off, unsigned char iv[16], const unsigned char *input,
+        unsigned char *output)
+{
+    size_t n;
+    int rc;
+    uint8_t c;
+
+    n = *iv_off;
+    if (n >= AES_BLOCK_LEN) {
+        return AES_ALT_ERR_INVALID_INPUT_LEN;
+    }
+
+    while (length--) {
+        if (n == 0) {
+            rc = mbedtls_internal_aes_encrypt(ctx, iv, iv);
+            if (rc) {
+                return rc;
+            }
+        }
+        if (mode == AES_ALT_ENCRYPT) {
+            iv[n] = *output++ = *input++ ^ iv[n];
+        } else {
+            c = *input++;
+            *output++ = c ^ iv[n];
+            iv[n] = c;
+        }
+        n = (n + 1) % AES_BLOCK_LEN;
+    }
+    *iv_off = n;
+
+    return 0;
+}
+
+int
+mbedtls_aes_crypt_cfb8(mbedtls_aes_context *ctx, int mode, size_t length,
+        unsigned char iv[16], const unsigned char *input,
+        unsigned char *output)
+{
+    uint8_t ov[AES_BLOCK_LEN + 1];
+    uint8_t c;
+    int rc;
+
+    while (length--) {
+        memcpy(ov, iv, AES_BLOCK_LEN);
+        rc = mbedtls_internal_aes_encrypt(ctx, iv, iv);
+        if (rc) {
+            return rc;
+        }
+        if (mode != AES_ALT_ENCRYPT) {
+            ov[AES_BLOCK_LEN] = *input;
+        }
+        c = *output++ = iv[0] ^ *input++;
+        if (mode == AES_ALT_ENCRYPT) {
+            ov[AES_BLOCK_LEN] = c;
+        }
+        memcpy(iv, ov + 1, AES_BLOCK_LEN);
+    }
+
+    return 0;
+}
+#endif
+
+#if MYNEWT_VAL(MBEDTLS_CIPHER_MODE_OFB)
+int
+mbedtls_aes_crypt_ofb(mbedtls_aes_context *ctx, size_t length,
+        size_t *iv_off, unsigned char iv[16], const unsigned char *input,
+        unsigned char *output)
+{
+    size_t n;
+    int rc;
+
+    n = *iv_off;
+    if (n >= AES_BLOCK_LEN) {
+        return AES_ALT_ERR_INVALID_INPUT_LEN;
+    }
+
+    while (length--) {
+        if (n == 0) {
+            rc = mbedtls_internal_aes_encrypt(ctx, iv, iv);
+            if (rc) {
+                return rc;
+            }
+        }
+        *output++ = *input++ ^ iv[n];
+        n = (n + 1) % AES_BLOCK_LEN;
+    }
+    *iv_off = n;
+
+    return 0;
+}
+#endif
+
+#if MYNEWT_VAL(MBEDTLS_CIPHER_MODE_CTR)
+/*
+ * Whole blocks go to the device in one call; the key stream of a partial
+ * block at either end is kept in stream_block, as mbedTLS does.
+ */
+int
+mbedtls_aes_crypt_ctr(mbedtls_aes_context *ctx, size_t length,
+        size_t *nc_off, unsigned char nonce_counter[16],
+        unsigned char stream_block[16], const unsigned char *input,
+        unsigned char *output)
+{
+    uint32_t blocks;
+    size_t n;
+    int rc;
+    int i;
+
+    n = *nc_off;
+    if (n >= AES_BLOCK_LEN) {
+        return AES_ALT_ERR_INVALID_INPUT_LEN;
+    }
+
+    /* Rest of the key stream of the previous call */
+    while (length > 0 && n != 0) {
+        *output++ = *input++ ^ stream_block[n];
+        n = (n + 1) % AES_BLOCK_LEN;
+        length--;
+    }
+
+    blocks = length & ~(size_t)(AES_BLOCK_LEN - 1);
+    if (blocks > 0) {
+        if (crypto_encrypt_aes_ctr(ctx->crypto, ctx->key, ctx->keylen,
+                    nonce_counter, input, output, blocks) != blocks) {
+            return AES_ALT_ERR_HW_ACCEL_FAILED;
+        }
+        input += blocks;
+        output += blocks;
+        length -= blocks;
+    }
+
+    if (length > 0) {
+        rc = mbedtls_internal_aes_encrypt(ctx, nonce_counter, stream_block);
+        if (rc) {
+            return rc;
+        }
+        for (i = AES_BLOCK_LEN; i > 0; i--) {
+            if (++nonce_counter[i - 1] != 0) {
+                break;
+            }
+        }
+        for (n = 0; n < length; n++) {
+            output[n] = input[n] ^ stream_block[n];
+        }
+    }
+    *nc_off = n;
+
+    return 0;
 }
+#endif
 
 #endif /* MYNEWT_VAL(MBEDTLS_AES_ALT) */
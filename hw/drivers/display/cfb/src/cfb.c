@@ -62,10 +62,52 @@ struct char_framebuffer {
 
 	/** Inverted */
 	bool inverted;
+
+	/** Changed area not written to display yet, in columns and tiles */
+	uint16_t dirty_x0;
+	uint16_t dirty_x1;
+	uint8_t dirty_t0;
+	uint8_t dirty_t1;
 };
 
 static struct char_framebuffer char_fb;
 
+/*
+ * Extend the area to be written to display by a window given in columns
+ * and tiles, end exclusive.
+ */
+static void cfb_mark_dirty(struct char_framebuffer *fb,
+			   uint16_t x0, uint16_t x1, uint8_t t0, uint8_t t1)
+{
+	if (x1 > fb->x_res) {
+		x1 = fb->x_res;
+	}
+	if (t1 > fb->y_res / fb->ppt) {
+		t1 = fb->y_res / fb->ppt;
+	}
+	if (x0 >= x1 || t0 >= t1) {
+		return;
+	}
+
+	if (fb->dirty_x0 >= fb->dirty_x1) {
+		fb->dirty_x0 = x0;
+		fb->dirty_x1 = x1;
+		fb->dirty_t0 = t0;
+		fb->dirty_t1 = t1;
+		return;
+	}
+
+	fb->dirty_x0 = min(fb->dirty_x0, x0);
+	fb->dirty_x1 = max(fb->dirty_x1, x1);
+	fb->dirty_t0 = min(fb->dirty_t0, t0);
+	fb->dirty_t1 = max(fb->dirty_t1, t1);
+}
+
+static void cfb_mark_all_dirty(struct char_framebuffer *fb)
+{
+	cfb_mark_dirty(fb, 0, fb->x_res, 0, fb->y_res / fb->ppt);
+}
+
 static inline uint8_t *get_glyph_ptr(const struct cfb_font *fptr, char c)
 {
 	if (fptr->caps & CFB_FONT_MONO_VPACKED) {
@@ -81,7 +123,7 @@ static inline uint8_t *get_glyph_ptr(const struct cfb_font *fptr, char c)
  * Draw the monochrome character in the monochrome tiled framebuffer,
  * a byte is interpreted as 8 pixels ordered vertically among each other.
  */
-static uint8_t draw_char_vtmono(const struct char_framebuffer *fb,
+static uint8_t draw_char_vtmono(struct char_framebuffer *fb,
 			     char c, uint16_t x, uint16_t y)
 {
 	const struct cfb_font *fptr = &(fb->fonts[fb->font_idx]);
@@ -96,6 +138,9 @@ static uint8_t draw_char_vtmono(const struct char_framebuffer *fb,
 		return 0;
 	}
 
+	cfb_mark_dirty(fb, x, x + fptr->width,
+		       y / 8, y / 8 + fptr->height / 8);
+
 	for (size_t g_x = 0; g_x < fptr->width; g_x++) {
 		uint32_t y_segment = y / 8;
 
@@ -116,7 +161,7 @@ static uint8_t draw_char_vtmono(const struct char_framebuffer *fb,
 
 int cfb_print(struct os_dev *dev, char *str, uint16_t x, uint16_t y)
 {
-	const struct char_framebuffer *fb = &char_fb;
+	struct char_framebuffer *fb = &char_fb;
 	const struct cfb_font *fptr = &(fb->fonts[fb->font_idx]);
 
 	if (!fb->fonts || !fb->buf) {
@@ -143,20 +188,26 @@ int cfb_print(struct os_dev *dev, char *str, uint16_t x, uint16_t y)
 	return -1;
 }
 
+/*
+ * Both transformations below are their own inverse, they are applied on
+ * the dirty area before it is written to display and undone afterwards.
+ */
 static int cfb_reverse_bytes(const struct char_framebuffer *fb)
 {
+	uint8_t *p;
+
 	if (!(fb->screen_info & SCREEN_INFO_MONO_VTILED)) {
 		DFLT_LOG_ERROR("Unsupported framebuffer configuration");
 		return -1;
 	}
 
-	for (size_t i = 0; i < fb->x_res * fb->y_res / 8; i++) {
-		fb->buf[i] = (fb->buf[i] & 0xf0) >> 4 |
-			      (fb->buf[i] & 0x0f) << 4;
-		fb->buf[i] = (fb->buf[i] & 0xcc) >> 2 |
-			      (fb->buf[i] & 0x33) << 2;
-		fb->buf[i] = (fb->buf[i] & 0xaa) >> 1 |
-			      (fb->buf[i] & 0x55) << 1;
+	for (size_t t = fb->dirty_t0; t < fb->dirty_t1; t++) {
+		for (size_t i = fb->dirty_x0; i < fb->dirty_x1; i++) {
+			p = &fb->buf[t * fb->x_res + i];
+			*p = (*p & 0xf0) >> 4 | (*p & 0x0f) << 4;
+			*p = (*p & 0xcc) >> 2 | (*p & 0x33) << 2;
+			*p = (*p & 0xaa) >> 1 | (*p & 0x55) << 1;
+		}
 	}
 
 	return 0;
@@ -164,8 +215,11 @@ static int cfb_reverse_bytes(const struct char_framebuffer *fb)
 
 static int cfb_invert(const struct char_framebuffer *fb)
 {
-	for (size_t i = 0; i < fb->x_res * fb->y_res / 8; i++) {
-		fb->buf[i] = ~fb->buf[i];
+	for (size_t t = fb->dirty_t0; t < fb->dirty_t1; t++) {
+		for (size_t i = fb->dirty_x0; i < fb->dirty_x1; i++) {
+			fb->buf[t * fb->x_res + i] =
+				~fb->buf[t * fb->x_res + i];
+		}
 	}
 
 	return 0;
@@ -174,7 +228,7 @@ static int cfb_invert(const struct char_framebuffer *fb)
 int cfb_framebuffer_clear(struct os_dev *dev, bool clear_display)
 {
 	const struct display_driver_api *api = dev->od_init_arg;
-	const struct char_framebuffer *fb = &char_fb;
+	struct char_framebuffer *fb = &char_fb;
 	struct display_buffer_descriptor desc;
 	int rc;
 
@@ -187,6 +241,7 @@ int cfb_framebuffer_clear(struct os_dev *dev, bool clear_display)
 	desc.height = 0;
 	desc.pitch = 0;
 	memset(fb->buf, 0, fb->size);
+	cfb_mark_all_dirty(fb);
 
 	if (clear_display && (fb->screen_info & SCREEN_INFO_EPD)) {
 		rc = api->set_contrast(dev, 1);
@@ -211,28 +266,71 @@ int cfb_framebuffer_clear(struct os_dev *dev, bool clear_display)
 int cfb_framebuffer_finalize(struct os_dev *dev)
 {
 	const struct display_driver_api *api = dev->od_init_arg;
-	const struct char_framebuffer *fb = &char_fb;
+	struct char_framebuffer *fb = &char_fb;
 	struct display_buffer_descriptor desc;
+	uint8_t *buf;
+	uint16_t x;
+	uint16_t y;
+	bool invert;
+	bool reverse;
 	int rc;
 
 	if (!fb || !fb->buf) {
 		return -1;
 	}
 
-	desc.buf_size = fb->size;
-	desc.width = 0;
-	desc.height = 0;
-	desc.pitch = 0;
+	if (fb->dirty_x0 >= fb->dirty_x1) {
+		/* Nothing changed since last write */
+		return 0;
+	}
 
-	if (!(fb->pixel_format & PIXEL_FORMAT_MONO10) != !(fb->inverted)) {
+	if (fb->dirty_x0 == 0 && fb->dirty_x1 == fb->x_res &&
+	    fb->dirty_t0 == 0 && fb->dirty_t1 == fb->y_res / fb->ppt) {
+		/* Whole framebuffer */
+		desc.buf_size = fb->size;
+		desc.width = 0;
+		desc.height = 0;
+		desc.pitch = 0;
+		buf = fb->buf;
+		x = 0;
+		y = 0;
+	} else {
+		/* Window within framebuffer, rows are tiles of ppt pixels */
+		x = fb->dirty_x0;
+		y = fb->dirty_t0 * fb->ppt;
+		buf = &fb->buf[fb->dirty_t0 * fb->x_res + x];
+		desc.buf_size = fb->size - (buf - fb->buf);
+		desc.width = fb->dirty_x1 - fb->dirty_x0;
+		desc.height = (fb->dirty_t1 - fb->dirty_t0) * fb->ppt;
+		desc.pitch = fb->x_res;
+	}
+
+	invert = !(fb->pixel_format & PIXEL_FORMAT_MONO10) != !(fb->inverted);
+	reverse = fb->screen_info & SCREEN_INFO_MONO_MSB_FIRST;
+
+	if (invert) {
 		cfb_invert(fb);
 	}
 
-	if (fb->screen_info & SCREEN_INFO_MONO_MSB_FIRST) {
+	if (reverse) {
+		cfb_reverse_bytes(fb);
+	}
+
+	rc = api->write(dev, x, y, &desc, buf);
+
+	if (reverse) {
 		cfb_reverse_bytes(fb);
 	}
 
-	rc = api->write(dev, 0, 0, &desc, fb->buf);
+	if (invert) {
+		cfb_invert(fb);
+	}
+
+	if (rc == 0) {
+		fb->dirty_x0 = 0;
+		fb->dirty_x1 = 0;
+	}
+
 	return rc;
 }
 
@@ -330,6 +428,7 @@ int cfb_framebuffer_init(struct os_dev *dev)
 	}
 
 	memset(fb->buf, 0, fb->size);
+	cfb_mark_all_dirty(fb);
 
 	return 0;
 }
@@ -244,6 +244,104 @@ static int ssd1673_update_display(const struct os_dev *dev, bool initial)
 	return 0;
 }
 
+/*
+ * Write a window of the panel. Window rows are pages of 8 pixels, RAM
+ * address counter wraps within the window so each page row is sent as is
+ * from the buffer, skipping the pitch.
+ */
+static int ssd1673_write_window(struct ssd1673_data *driver,
+				const uint16_t x, const uint16_t y,
+				const struct display_buffer_descriptor *desc,
+				const uint8_t *buf)
+{
+	uint8_t cmd = SSD1673_CMD_WRITE_RAM;
+	uint8_t first_page;
+	uint8_t last_page;
+	uint8_t last_col;
+
+	if ((y % EPD_PANEL_NUMOF_ROWS_PER_PAGE) ||
+	    (desc->height % EPD_PANEL_NUMOF_ROWS_PER_PAGE) ||
+	    desc->height == 0 ||
+	    x + desc->width > EPD_PANEL_NUMOF_COLUMS ||
+	    y + desc->height > EPD_PANEL_HEIGHT) {
+		DFLT_LOG_ERROR("Unsupported window");
+		return -1;
+	}
+
+	first_page = y / EPD_PANEL_NUMOF_ROWS_PER_PAGE;
+	last_page = first_page +
+		    desc->height / EPD_PANEL_NUMOF_ROWS_PER_PAGE - 1;
+	last_col = x + desc->width - 1;
+
+	if ((uint32_t)desc->pitch * (last_page - first_page) + desc->width >
+	    desc->buf_size) {
+		DFLT_LOG_ERROR("Display buffer is too small");
+		return -1;
+	}
+
+	switch (driver->scan_mode) {
+	case SSD1673_DATA_ENTRY_XIYDY:
+		if (ssd1673_set_ram_param(driver, first_page, last_page,
+					  SSD1673_PANEL_LAST_GATE - x,
+					  SSD1673_PANEL_LAST_GATE - last_col)) {
+			return -1;
+		}
+
+		if (ssd1673_set_ram_ptr(driver, first_page,
+					SSD1673_PANEL_LAST_GATE - x)) {
+			return -1;
+		}
+
+		break;
+
+	case SSD1673_DATA_ENTRY_XDYIY:
+		if (ssd1673_set_ram_param(driver,
+					  SSD1673_PANEL_LAST_PAGE - first_page,
+					  SSD1673_PANEL_LAST_PAGE - last_page,
+					  x, last_col)) {
+			return -1;
+		}
+
+		if (ssd1673_set_ram_ptr(driver,
+					SSD1673_PANEL_LAST_PAGE - first_page,
+					x)) {
+			return -1;
+		}
+
+		break;
+	default:
+		return -1;
+	}
+
+	if (ssd1673_write_cmd(driver, SSD1673_CMD_ENTRY_MODE,
+			      &driver->scan_mode, sizeof(driver->scan_mode))) {
+		return -1;
+	}
+
+	hal_gpio_write(CONFIG_SSD1673_DC_PIN, 0);
+	hal_gpio_write(CONFIG_SSD1673_CS_PIN, 0);
+
+	if (hal_spi_txrx(CONFIG_SSD1673_SPI_DEV, &cmd, NULL, sizeof(cmd))) {
+		hal_gpio_write(CONFIG_SSD1673_CS_PIN, 1);
+		return -1;
+	}
+
+	hal_gpio_write(CONFIG_SSD1673_DC_PIN, 1);
+
+	for (int page = first_page; page <= last_page; page++) {
+		if (hal_spi_txrx(CONFIG_SSD1673_SPI_DEV, (uint8_t *)buf,
+				 NULL, desc->width)) {
+			hal_gpio_write(CONFIG_SSD1673_CS_PIN, 1);
+			return -1;
+		}
+		buf += desc->pitch;
+	}
+
+	hal_gpio_write(CONFIG_SSD1673_CS_PIN, 1);
+
+	return 0;
+}
+
 static int ssd1673_write(const struct os_dev *dev, const uint16_t x,
 			 const uint16_t y,
 			 const struct display_buffer_descriptor *desc,
@@ -264,6 +362,20 @@ static int ssd1673_write(const struct os_dev *dev, const uint16_t x,
 		return -1;
 	}
 
+	if (desc->width) {
+		/* Partial update, rest of display RAM is kept */
+		ssd1673_busy_wait(driver);
+
+		if (ssd1673_write_window(driver, x, y, desc, buf)) {
+			return -1;
+		}
+
+		if (driver->contrast) {
+			return ssd1673_update_display(dev, true);
+		}
+		return ssd1673_update_display(dev, false);
+	}
+
 	if (desc->pitch > desc->width) {
 		DFLT_LOG_ERROR("Unsupported mode");
 		return -1;
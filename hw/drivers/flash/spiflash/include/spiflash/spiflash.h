@@ -79,6 +79,12 @@ struct spiflash_dev {
 #endif
     bool pd_active;                 /* Power down active */
 #endif
+#if MYNEWT_VAL(SPIFLASH_ERASE_SUSPEND)
+    struct os_task *erase_task;     /* Task waiting for erase, lock released */
+    uint32_t resume_time;           /* os_cputime of last erase resume */
+    uint32_t suspend_time;          /* os_cputime of last erase suspend */
+    uint32_t suspended_ticks;       /* Total cputime erase was suspended */
+#endif
 #if MYNEWT_VAL(SPIFLASH_CACHE_SIZE)
     uint32_t cached_addr;
     uint8_t cache[MYNEWT_VAL(SPIFLASH_CACHE_SIZE)];
@@ -141,6 +147,8 @@ void spiflash_release_power_down(struct spiflash_dev *dev);
 
 int spiflash_auto_power_down_set(struct spiflash_dev *dev, uint32_t timeout_ms);
 
+bool spiflash_device_ready(struct spiflash_dev *dev);
+
 int spiflash_sector_erase(struct spiflash_dev *dev, uint32_t addr);
 #if MYNEWT_VAL(SPIFLASH_BLOCK_ERASE_32BK)
 int spiflash_block_32k_erase(struct spiflash_dev *dev, uint32_t addr);
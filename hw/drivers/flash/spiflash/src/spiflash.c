@@ -45,6 +45,10 @@
 #error SPIFLASH_SECTOR_SIZE must be set to the correct value in bsp syscfg.yml
 #endif
 
+#if MYNEWT_VAL(SPIFLASH_SECTOR_SIZE) & (MYNEWT_VAL(SPIFLASH_SECTOR_SIZE) - 1)
+#error SPIFLASH_SECTOR_SIZE must be a power of two
+#endif
+
 #if MYNEWT_VAL(SPIFLASH_PAGE_SIZE) == 0
 #error SPIFLASH_PAGE_SIZE must be set to the correct value in bsp syscfg.yml
 #endif
@@ -53,6 +57,10 @@
 #error SPIFLASH_BAUDRATE must be set to the correct value in bsp syscfg.yml
 #endif
 
+#if MYNEWT_VAL(SPIFLASH_ERASE_SUSPEND) && !MYNEWT_VAL(OS_SCHEDULING)
+#error SPIFLASH_ERASE_SUSPEND requires OS_SCHEDULING
+#endif
+
 static void spiflash_release_power_down_macronix(struct spiflash_dev *dev) __attribute__((unused));
 static void spiflash_release_power_down_generic(struct spiflash_dev *dev) __attribute__((unused));
 
@@ -580,6 +588,11 @@ static int hal_spiflash_sector_info(const struct hal_flash *hal_flash_dev, int i
 static int hal_spiflash_init(const struct hal_flash *dev);
 static int hal_spiflash_erase(const struct hal_flash *hal_flash_dev,
         uint32_t address, uint32_t sz);
+static int hal_spiflash_write_start(const struct hal_flash *hal_flash_dev,
+        uint32_t addr, const void *buf, uint32_t len);
+static int hal_spiflash_erase_sector_start(const struct hal_flash *hal_flash_dev,
+        uint32_t sector_address);
+static int hal_spiflash_is_busy(const struct hal_flash *hal_flash_dev);
 
 static const struct hal_flash_funcs spiflash_flash_funcs = {
     .hff_read         = hal_spiflash_read,
@@ -588,6 +601,9 @@ static const struct hal_flash_funcs spiflash_flash_funcs = {
     .hff_sector_info  = hal_spiflash_sector_info,
     .hff_init         = hal_spiflash_init,
     .hff_erase        = hal_spiflash_erase,
+    .hff_write_start  = hal_spiflash_write_start,
+    .hff_erase_sector_start = hal_spiflash_erase_sector_start,
+    .hff_is_busy      = hal_spiflash_is_busy,
 };
 
 static const struct spiflash_characteristics spiflash_characteristics = {
@@ -663,11 +679,36 @@ static inline void spiflash_unlock_no_apd(struct spiflash_dev *dev)
 #endif
 }
 
-static inline void spiflash_lock(struct spiflash_dev *dev)
+#if MYNEWT_VAL(SPIFLASH_ERASE_SUSPEND)
+/*
+ * While a suspendable erase is running the erasing task does not hold the
+ * lock, so that reads can get in and suspend it.  Anything else waits here
+ * for the erase to finish, as it would have waited for the lock before.
+ */
+static inline void
+spiflash_wait_erase_done(struct spiflash_dev *dev)
+{
+    while (dev->erase_task != NULL &&
+           dev->erase_task != os_sched_get_current_task() &&
+           os_mutex_get_level(&dev->lock) == 1) {
+        os_mutex_release(&dev->lock);
+        os_time_delay(1);
+        os_mutex_pend(&dev->lock, OS_TIMEOUT_NEVER);
+    }
+}
+#endif
+
+static inline void spiflash_lock_common(struct spiflash_dev *dev,
+                                        bool wait_erase)
 {
 #if MYNEWT_VAL(OS_SCHEDULING)
     os_mutex_pend(&dev->lock, OS_TIMEOUT_NEVER);
 #endif
+#if MYNEWT_VAL(SPIFLASH_ERASE_SUSPEND)
+    if (wait_erase) {
+        spiflash_wait_erase_done(dev);
+    }
+#endif
 
 #if MYNEWT_VAL(SPIFLASH_AUTO_POWER_DOWN)
     if (dev->pd_active) {
@@ -682,6 +723,11 @@ static inline void spiflash_lock(struct spiflash_dev *dev)
 #endif
 }
 
+static inline void spiflash_lock(struct spiflash_dev *dev)
+{
+    spiflash_lock_common(dev, true);
+}
+
 static inline void spiflash_unlock(struct spiflash_dev *dev)
 {
 #if MYNEWT_VAL(OS_SCHEDULING)
@@ -825,7 +871,12 @@ spiflash_apd_tmo_func(struct os_event *ev)
     spiflash_lock_no_apd(dev);
 
     if (dev->apd_tmo && !dev->pd_active) {
-        spiflash_power_down(dev);
+        if (!dev->ready && !spiflash_device_ready(dev)) {
+            /* Program or erase started asynchronously still in progress */
+            os_callout_reset(&dev->apd_tmo_co, dev->apd_tmo);
+        } else {
+            spiflash_power_down(dev);
+        }
     }
 
     spiflash_unlock_no_apd(dev);
@@ -982,25 +1033,93 @@ spiflash_write_enable(struct spiflash_dev *dev)
     return 0;
 }
 
+#if MYNEWT_VAL(SPIFLASH_ERASE_SUSPEND)
+static void
+spiflash_send_cmd(struct spiflash_dev *dev, uint8_t cmd)
+{
+#if MYNEWT_VAL(BUS_DRIVER_PRESENT)
+    bus_node_simple_write((struct os_dev *)&dev->dev, &cmd, 1);
+#else
+    spiflash_cs_activate(dev);
+
+    hal_spi_tx_val(dev->spi_num, cmd);
+
+    spiflash_cs_deactivate(dev);
+#endif
+}
+
+/*
+ * Suspends erase started by another task.  Caller holds the lock.
+ */
+static int
+spiflash_erase_suspend(struct spiflash_dev *dev)
+{
+    uint32_t since_resume;
+
+    since_resume = os_cputime_ticks_to_usecs(os_cputime_get32() -
+                                             dev->resume_time);
+    if (since_resume < MYNEWT_VAL(SPIFLASH_TRS_MINIMUM)) {
+        os_cputime_delay_usecs(MYNEWT_VAL(SPIFLASH_TRS_MINIMUM) -
+                               since_resume);
+    }
+
+    spiflash_send_cmd(dev, MYNEWT_VAL(SPIFLASH_ERASE_SUSPEND_CMD));
+    dev->suspend_time = os_cputime_get32();
+    dev->ready = false;
+
+    return spiflash_wait_ready_till(dev, MYNEWT_VAL(SPIFLASH_TSUS_MAXIMUM), 0);
+}
+
+static void
+spiflash_erase_resume(struct spiflash_dev *dev)
+{
+    spiflash_send_cmd(dev, MYNEWT_VAL(SPIFLASH_ERASE_RESUME_CMD));
+    dev->resume_time = os_cputime_get32();
+    dev->suspended_ticks += dev->resume_time - dev->suspend_time;
+    dev->ready = false;
+}
+#endif
+
 static int
 hal_spiflash_read(const struct hal_flash *hal_flash_dev, uint32_t addr, void *buf,
                   uint32_t len)
 {
     int err = 0;
+#if MYNEWT_VAL(SPIFLASH_ERASE_SUSPEND)
+    bool suspended = false;
+#endif
 #if MYNEWT_VAL(SPIFLASH_CACHE_SIZE)
     uint32_t cached_size;
     uint8_t *user_buf;
     uint32_t left;
 #endif
+#if MYNEWT_VAL(SPIFLASH_FAST_READ)
+    /* Fast read takes one dummy byte after the address */
+    uint8_t cmd[] = { SPIFLASH_FAST_READ,
+        (uint8_t)(addr >> 16), (uint8_t)(addr >> 8), (uint8_t)(addr), 0 };
+#else
     uint8_t cmd[] = { SPIFLASH_READ,
         (uint8_t)(addr >> 16), (uint8_t)(addr >> 8), (uint8_t)(addr) };
+#endif
     struct spiflash_dev *dev;
 
     dev = (struct spiflash_dev *)hal_flash_dev;
 
+#if MYNEWT_VAL(SPIFLASH_ERASE_SUSPEND)
+    spiflash_lock_common(dev, false);
+
+    if (dev->erase_task != NULL &&
+        dev->erase_task != os_sched_get_current_task()) {
+        err = spiflash_erase_suspend(dev);
+        suspended = true;
+    } else {
+        err = spiflash_wait_ready(dev, 100);
+    }
+#else
     spiflash_lock(dev);
 
     err = spiflash_wait_ready(dev, 100);
+#endif
     if (!err) {
 #if MYNEWT_VAL(SPIFLASH_CACHE_SIZE)
         if ((dev->cached_addr <= addr) &&
@@ -1038,7 +1157,7 @@ hal_spiflash_read(const struct hal_flash *hal_flash_dev, uint32_t addr, void *bu
         if (len > 0) {
 #if MYNEWT_VAL(BUS_DRIVER_PRESENT)
             bus_node_simple_write_read_transact((struct os_dev *)&dev->dev,
-                &cmd, 4, buf, len);
+                &cmd, sizeof cmd, buf, len);
 #else
             spiflash_cs_activate(dev);
 
@@ -1067,19 +1186,68 @@ hal_spiflash_read(const struct hal_flash *hal_flash_dev, uint32_t addr, void *bu
         }
     }
 
+#if MYNEWT_VAL(SPIFLASH_ERASE_SUSPEND)
+    if (suspended) {
+        spiflash_erase_resume(dev);
+    }
+#endif
+
     spiflash_unlock(dev);
 
     return 0;
 }
 
+/*
+ * Sends a page program command for as much of the buffer as fits in the page
+ * containing addr, without waiting for it to complete.  Caller holds the lock
+ * and has checked that the device is ready.  Returns number of bytes sent.
+ */
+static uint32_t
+spiflash_page_program(struct spiflash_dev *dev, uint32_t addr,
+                      const uint8_t *u8buf, uint32_t len)
+{
+    uint8_t cmd[4] = { SPIFLASH_PAGE_PROGRAM };
+    uint32_t page_limit;
+    uint32_t to_write;
+
+#if MYNEWT_VAL(SPIFLASH_CACHE_SIZE)
+    dev->cached_addr = 0xFFFFFFFF;
+#endif
+
+    spiflash_write_enable(dev);
+
+    cmd[1] = (uint8_t)(addr >> 16);
+    cmd[2] = (uint8_t)(addr >> 8);
+    cmd[3] = (uint8_t)(addr);
+
+    page_limit = (addr & ~(dev->page_size - 1)) + dev->page_size;
+    to_write = page_limit - addr > len ? len :  page_limit - addr;
+
+#if MYNEWT_VAL(BUS_DRIVER_PRESENT)
+    bus_node_lock((struct os_dev *)&dev->dev,
+        BUS_NODE_LOCK_DEFAULT_TIMEOUT);
+    bus_node_write((struct os_dev *)&dev->dev,
+        cmd, 4, BUS_NODE_LOCK_DEFAULT_TIMEOUT, BUS_F_NOSTOP);
+    bus_node_simple_write((struct os_dev *)&dev->dev, u8buf, to_write);
+    bus_node_unlock((struct os_dev *)&dev->dev);
+#else
+    spiflash_cs_activate(dev);
+    hal_spi_txrx(dev->spi_num, cmd, NULL, sizeof cmd);
+    hal_spi_txrx(dev->spi_num, (void *)u8buf, NULL, to_write);
+    spiflash_cs_deactivate(dev);
+#endif
+    /* Now we know that device is not ready */
+    dev->ready = false;
+
+    return to_write;
+}
+
 static int
 hal_spiflash_write(const struct hal_flash *hal_flash_dev, uint32_t addr,
         const void *buf, uint32_t len)
 {
-    uint8_t cmd[4] = { SPIFLASH_PAGE_PROGRAM };
     const uint8_t *u8buf = buf;
     struct spiflash_dev *dev = (struct spiflash_dev *)hal_flash_dev;
-    uint32_t page_limit;
     uint32_t to_write;
     uint32_t pp_time_typical;
     uint32_t pp_time_maximum;
@@ -1094,10 +1262,6 @@ hal_spiflash_write(const struct hal_flash *hal_flash_dev, uint32_t addr,
         goto err;
     }
 
-#if MYNEWT_VAL(SPIFLASH_CACHE_SIZE)
-    dev->cached_addr = 0xFFFFFFFF;
-#endif
-
     pp_time_typical = dev->characteristics->tbp1.typical;
     pp_time_maximum = dev->characteristics->tpp.maximum;
     if (pp_time_maximum < pp_time_typical) {
@@ -1105,30 +1269,8 @@ hal_spiflash_write(const struct hal_flash *hal_flash_dev, uint32_t addr,
     }
 
     while (len) {
-        spiflash_write_enable(dev);
-
-        cmd[1] = (uint8_t)(addr >> 16);
-        cmd[2] = (uint8_t)(addr >> 8);
-        cmd[3] = (uint8_t)(addr);
-
-        page_limit = (addr & ~(dev->page_size - 1)) + dev->page_size;
-        to_write = page_limit - addr > len ? len :  page_limit - addr;
+        to_write = spiflash_page_program(dev, addr, u8buf, len);
 
-#if MYNEWT_VAL(BUS_DRIVER_PRESENT)
-        bus_node_lock((struct os_dev *)&dev->dev,
-            BUS_NODE_LOCK_DEFAULT_TIMEOUT);
-        bus_node_write((struct os_dev *)&dev->dev,
-            cmd, 4, BUS_NODE_LOCK_DEFAULT_TIMEOUT, BUS_F_NOSTOP);
-        bus_node_simple_write((struct os_dev *)&dev->dev, u8buf, to_write);
-        bus_node_unlock((struct os_dev *)&dev->dev);
-#else
-        spiflash_cs_activate(dev);
-        hal_spi_txrx(dev->spi_num, cmd, NULL, sizeof cmd);
-        hal_spi_txrx(dev->spi_num, (void *)u8buf, NULL, to_write);
-        spiflash_cs_deactivate(dev);
-#endif
-        /* Now we know that device is not ready */
-        dev->ready = false;
         spiflash_delay_us(pp_time_typical);
         rc = spiflash_wait_ready_till(dev, pp_time_maximum - pp_time_typical,
             (pp_time_maximum - pp_time_typical) / 10);
@@ -1163,26 +1305,18 @@ hal_spiflash_erase(const struct hal_flash *hal_flash_dev,
     return spiflash_erase(dev, address, size);
 }
 
-static int
-spiflash_execute_erase(struct spiflash_dev *dev, const uint8_t *buf,
-                       uint32_t size,
-                       const struct spiflash_time_spec *delay_spec)
+/*
+ * Sends an erase command without waiting for it to complete.  Caller holds
+ * the lock and has checked that the device is ready.
+ */
+static void
+spiflash_erase_start(struct spiflash_dev *dev, const uint8_t *buf,
+                     uint32_t size)
 {
-    int rc = 0;
-    uint32_t wait_time_us;
-    uint32_t start_time;
-
-    spiflash_lock(dev);
-
 #if MYNEWT_VAL(SPIFLASH_CACHE_SIZE)
     dev->cached_addr = 0xFFFFFFFF;
 #endif
 
-    if (spiflash_wait_ready(dev, 100) != 0) {
-        rc = -1;
-        goto err;
-    }
-
     spiflash_write_enable(dev);
 
     spiflash_read_status(dev);
@@ -1198,8 +1332,85 @@ spiflash_execute_erase(struct spiflash_dev *dev, const uint8_t *buf,
 #endif
     /* Now we know that device is not ready */
     dev->ready = false;
+}
+
+#if MYNEWT_VAL(SPIFLASH_ERASE_SUSPEND)
+/*
+ * Waits for erase to complete without holding the lock between status polls.
+ * Time spent suspended by readers does not count against the maximum erase
+ * time.  Called and returns with the lock held.
+ */
+static int
+spiflash_erase_wait_suspendable(struct spiflash_dev *dev,
+                                const struct spiflash_time_spec *delay_spec,
+                                uint32_t start_time)
+{
+    uint32_t step_us;
+    uint32_t elapsed_us;
+    int rc;
+
+    step_us = delay_spec->maximum / 50;
+    if (step_us < MYNEWT_VAL(SPIFLASH_READ_STATUS_INTERVAL)) {
+        step_us = MYNEWT_VAL(SPIFLASH_READ_STATUS_INTERVAL);
+    }
+
+    dev->erase_task = os_sched_get_current_task();
+    dev->resume_time = start_time;
+    dev->suspended_ticks = 0;
+    spiflash_unlock(dev);
+
+    spiflash_delay_us(delay_spec->typical);
+
+    while (1) {
+        spiflash_lock(dev);
+        if (spiflash_device_ready(dev)) {
+            rc = 0;
+            break;
+        }
+        elapsed_us = os_cputime_ticks_to_usecs(os_cputime_get32() -
+                                               start_time -
+                                               dev->suspended_ticks);
+        if (elapsed_us > delay_spec->maximum) {
+            rc = -1;
+            break;
+        }
+        spiflash_unlock(dev);
+
+        spiflash_delay_us(step_us);
+    }
+
+    dev->erase_task = NULL;
+
+    return rc;
+}
+#endif
+
+static int
+spiflash_execute_erase(struct spiflash_dev *dev, const uint8_t *buf,
+                       uint32_t size,
+                       const struct spiflash_time_spec *delay_spec)
+{
+    int rc = 0;
+    uint32_t wait_time_us;
+    uint32_t start_time;
+
+    spiflash_lock(dev);
+
+    if (spiflash_wait_ready(dev, 100) != 0) {
+        rc = -1;
+        goto err;
+    }
+
+    spiflash_erase_start(dev, buf, size);
 
     start_time = os_cputime_get32();
+#if MYNEWT_VAL(SPIFLASH_ERASE_SUSPEND)
+    /* Lock can only be handed over to readers if it is not nested */
+    if (os_mutex_get_level(&dev->lock) == 1) {
+        rc = spiflash_erase_wait_suspendable(dev, delay_spec, start_time);
+        goto err;
+    }
+#endif
     /* Wait typical erase time before starting polling for ready */
     spiflash_delay_us(delay_spec->typical);
 
@@ -1229,6 +1440,65 @@ hal_spiflash_sector_info(const struct hal_flash *hal_flash_dev, int idx,
     return 0;
 }
 
+static int
+hal_spiflash_write_start(const struct hal_flash *hal_flash_dev, uint32_t addr,
+        const void *buf, uint32_t len)
+{
+    struct spiflash_dev *dev = (struct spiflash_dev *)hal_flash_dev;
+    int rc;
+
+    spiflash_lock(dev);
+
+    if (!dev->ready && !spiflash_device_ready(dev)) {
+        rc = -1;
+    } else {
+        rc = spiflash_page_program(dev, addr, buf, len);
+    }
+
+    spiflash_unlock(dev);
+
+    return rc;
+}
+
+static int
+hal_spiflash_erase_sector_start(const struct hal_flash *hal_flash_dev,
+        uint32_t addr)
+{
+    struct spiflash_dev *dev = (struct spiflash_dev *)hal_flash_dev;
+    uint8_t buf[4] = { SPIFLASH_SECTOR_ERASE, (uint8_t)(addr >> 16U),
+                       (uint8_t)(addr >> 8U), (uint8_t)addr };
+    int rc = 0;
+
+    spiflash_lock(dev);
+
+    if (!dev->ready && !spiflash_device_ready(dev)) {
+        rc = -1;
+    } else {
+        spiflash_erase_start(dev, buf, sizeof(buf));
+    }
+
+    spiflash_unlock(dev);
+
+    return rc;
+}
+
+static int
+hal_spiflash_is_busy(const struct hal_flash *hal_flash_dev)
+{
+    struct spiflash_dev *dev = (struct spiflash_dev *)hal_flash_dev;
+    int rc;
+
+    if (dev->ready) {
+        return 0;
+    }
+
+    spiflash_lock(dev);
+    rc = !spiflash_device_ready(dev);
+    spiflash_unlock(dev);
+
+    return rc;
+}
+
 static int
 spiflash_erase_cmd(struct spiflash_dev *dev, uint8_t cmd, uint32_t addr,
                    const struct spiflash_time_spec *time_spec)
@@ -1278,10 +1548,16 @@ spiflash_erase(struct spiflash_dev *dev, uint32_t address, uint32_t size)
 {
     int rc = 0;
 
-    if (address == 0 && size == dev->hal.hf_size) {
+    if (address == 0 && size >= dev->hal.hf_size) {
         return spiflash_chip_erase(dev);
     }
-    address &= ~0xFFFU;
+    /*
+     * Round start down to a sector boundary, growing size so that the end of
+     * the range is still covered.  Each step then uses the largest erase
+     * whose alignment and length fit in what is left.
+     */
+    size += address & (MYNEWT_VAL(SPIFLASH_SECTOR_SIZE) - 1);
+    address &= ~(MYNEWT_VAL(SPIFLASH_SECTOR_SIZE) - 1);
     while (size) {
 #if MYNEWT_VAL(SPIFLASH_BLOCK_ERASE_64BK)
         if ((address & 0xFFFFU) == 0 && (size >= 0x10000)) {
@@ -146,6 +146,27 @@ int hash_custom_start(struct hash_dev *hash, void *ctx, uint16_t algo);
 int hash_custom_update(struct hash_dev *hash, void *ctx, uint16_t algo,
         const void *inbuf, uint32_t inlen);
 
+/**
+ * Update the current hash operation with part of an mbuf chain.
+ *
+ * Segments are fed to the driver directly in whole blocks; data straddling
+ * a segment boundary is gathered into a block sized buffer first.  Any
+ * trailing partial block is passed in one final update, so unless len is a
+ * multiple of the block length this must be the last update before
+ * _finish().
+ *
+ * @param hash     OS device
+ * @param ctx      A context struct for the chosen algo
+ * @param algo     Algorithm to use (see HASH_ALGO_*)
+ * @param om       The mbuf chain holding the data
+ * @param off      Offset into the chain of the first byte to hash
+ * @param len      Number of bytes to hash
+ *
+ * @return 0 if succesfull; -1 otherwise
+ */
+int hash_custom_update_mbuf(struct hash_dev *hash, void *ctx, uint16_t algo,
+        const struct os_mbuf *om, int off, uint32_t len);
+
 /**
  * Finish a stream hash operation and return the final digest.
  *
@@ -211,6 +232,20 @@ int hash_sha256_start(struct hash_sha256_context *ctx, struct hash_dev *hash);
 int hash_sha256_update(struct hash_sha256_context *ctx, const void *inbuf,
         uint32_t inlen);
 
+/*
+ * Update the sha256 operation with part of an mbuf chain; see
+ * hash_custom_update_mbuf().
+ *
+ * @param ctx      A hash_sha256_context struct
+ * @param om       The mbuf chain holding the data
+ * @param off      Offset into the chain of the first byte to hash
+ * @param len      Number of bytes to hash
+ *
+ * @return 0 if successfull, -1 on error
+ */
+int hash_sha256_update_mbuf(struct hash_sha256_context *ctx,
+        const struct os_mbuf *om, int off, uint32_t len);
+
 /*
  * Finish the sha256 operation and return the final digest.
  *
@@ -32,7 +32,12 @@ extern "C" {
 
 typedef struct mbedtls_sha256_context {
     struct hash_dev *hash;
-    struct hash_sha256_context sha256ctx;
+    struct hash_generic_context hashctx;
+    /* HASH_ALGO_SHA224 or HASH_ALGO_SHA256 */
+    uint16_t algo;
+    /* Input not yet passed to the driver; it only gets whole blocks */
+    uint8_t buflen;
+    uint8_t buf[SHA256_BLOCK_LEN];
 } mbedtls_sha256_context;
 
 void mbedtls_sha256_init(mbedtls_sha256_context *ctx);
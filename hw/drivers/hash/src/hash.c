@@ -17,6 +17,7 @@
  * under the License.
  */
 
+#include <string.h>
 #include "hash/hash.h"
 
 int
@@ -61,6 +62,71 @@ hash_custom_update(struct hash_dev *hash, void *ctx, uint16_t algo,
     return hash->interface.update(hash, ctx, algo, inbuf, inlen);
 }
 
+int
+hash_custom_update_mbuf(struct hash_dev *hash, void *ctx, uint16_t algo,
+        const struct os_mbuf *om, int off, uint32_t len)
+{
+    uint8_t blk[HASH_MAX_BLOCK_LEN];
+    const uint8_t *data;
+    uint32_t fill;
+    uint32_t chunk;
+    uint32_t n;
+    uint16_t cur_off;
+    int rc;
+
+    om = os_mbuf_off(om, off, &cur_off);
+    fill = 0;
+
+    while (om != NULL && len > 0) {
+        data = om->om_data + cur_off;
+        n = min(om->om_len - cur_off, len);
+        len -= n;
+        om = SLIST_NEXT(om, om_next);
+        cur_off = 0;
+
+        /* Complete a block left over from previous segments. */
+        if (fill > 0) {
+            chunk = min(n, sizeof blk - fill);
+            memcpy(blk + fill, data, chunk);
+            fill += chunk;
+            data += chunk;
+            n -= chunk;
+            if (fill < sizeof blk) {
+                continue;
+            }
+            rc = hash->interface.update(hash, ctx, algo, blk, fill);
+            if (rc) {
+                return -1;
+            }
+            fill = 0;
+        }
+
+        chunk = n & ~(sizeof blk - 1);
+        if (chunk > 0) {
+            rc = hash->interface.update(hash, ctx, algo, data, chunk);
+            if (rc) {
+                return -1;
+            }
+        }
+
+        fill = n - chunk;
+        memcpy(blk, data + chunk, fill);
+    }
+
+    if (len > 0) {
+        return -1;
+    }
+
+    if (fill > 0) {
+        rc = hash->interface.update(hash, ctx, algo, blk, fill);
+        if (rc) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
 int
 hash_custom_finish(struct hash_dev *hash, void *ctx, uint16_t algo,
         void *outbuf)
@@ -94,6 +160,15 @@ hash_sha256_update(struct hash_sha256_context *ctx, const void *inbuf,
     return hash_custom_update(ctx->dev, ctx, HASH_ALGO_SHA256, inbuf, inlen);
 }
 
+int
+hash_sha256_update_mbuf(struct hash_sha256_context *ctx,
+        const struct os_mbuf *om, int off, uint32_t len)
+{
+    assert(ctx->dev);
+    return hash_custom_update_mbuf(ctx->dev, ctx, HASH_ALGO_SHA256, om, off,
+            len);
+}
+
 int
 hash_sha256_finish(struct hash_sha256_context *ctx, void *outbuf)
 {
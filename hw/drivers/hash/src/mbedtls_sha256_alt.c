@@ -21,22 +21,34 @@
 
 #if MYNEWT_VAL(MBEDTLS_SHA256_ALT)
 
+#include <string.h>
 #include "hash/hash.h"
 #include "hash/sha256_alt.h"
 
+/* From mbedtls/sha256.h, which only builds inside crypto/mbedtls */
+#define SHA256_ALT_ERR_HW_ACCEL_FAILED  (-0x0037)
+
+/*
+ * The hash devices accept a single open, so all contexts share it; the
+ * drivers serialize between start and finish.
+ */
+static struct hash_dev *g_sha256_alt_hash;
+
 void
 mbedtls_sha256_init(mbedtls_sha256_context *ctx)
 {
     memset(ctx, 0, sizeof(*ctx));
-    ctx->hash = (struct hash_dev *) os_dev_open("hash", OS_TIMEOUT_NEVER,
-            NULL);
-    assert(ctx->hash);
+    if (!g_sha256_alt_hash) {
+        g_sha256_alt_hash = (struct hash_dev *) os_dev_open("hash",
+                OS_TIMEOUT_NEVER, NULL);
+        assert(g_sha256_alt_hash);
+    }
+    ctx->hash = g_sha256_alt_hash;
 }
 
 void
 mbedtls_sha256_free(mbedtls_sha256_context *ctx)
 {
-    os_dev_close((struct os_dev *)ctx->hash);
     memset(ctx, 0, sizeof(*ctx));
 }
 
@@ -50,23 +62,81 @@ mbedtls_sha256_clone(mbedtls_sha256_context *dst,
 int
 mbedtls_sha256_starts_ret(mbedtls_sha256_context *ctx, int is224)
 {
-    /* SHA-224 not supported */
-    if (is224) {
-        return -1;
+    ctx->algo = is224 ? HASH_ALGO_SHA224 : HASH_ALGO_SHA256;
+    if (!hash_has_support(ctx->hash, ctx->algo)) {
+        return SHA256_ALT_ERR_HW_ACCEL_FAILED;
+    }
+    ctx->buflen = 0;
+
+    if (hash_custom_start(ctx->hash, &ctx->hashctx, ctx->algo)) {
+        return SHA256_ALT_ERR_HW_ACCEL_FAILED;
     }
-    return hash_sha256_start(&ctx->sha256ctx, ctx->hash);
+
+    return 0;
 }
 
-int mbedtls_sha256_update_ret(mbedtls_sha256_context *ctx,
+/*
+ * Input is handed to the driver in whole blocks only, the remainder is
+ * kept until more data or finish(); some drivers can only take a partial
+ * word as the very last update.
+ */
+int
+mbedtls_sha256_update_ret(mbedtls_sha256_context *ctx,
         const unsigned char *input, size_t ilen)
 {
-    return hash_sha256_update(&ctx->sha256ctx, input, ilen);
+    size_t fill;
+    size_t bulk;
+
+    if (ctx->buflen > 0) {
+        fill = SHA256_BLOCK_LEN - ctx->buflen;
+        if (ilen < fill) {
+            memcpy(&ctx->buf[ctx->buflen], input, ilen);
+            ctx->buflen += ilen;
+            return 0;
+        }
+        memcpy(&ctx->buf[ctx->buflen], input, fill);
+        if (hash_custom_update(ctx->hash, &ctx->hashctx, ctx->algo,
+                               ctx->buf, SHA256_BLOCK_LEN)) {
+            return SHA256_ALT_ERR_HW_ACCEL_FAILED;
+        }
+        ctx->buflen = 0;
+        input += fill;
+        ilen -= fill;
+    }
+
+    bulk = ilen & ~(size_t)(SHA256_BLOCK_LEN - 1);
+    if (bulk > 0) {
+        if (hash_custom_update(ctx->hash, &ctx->hashctx, ctx->algo,
+                               input, bulk)) {
+            return SHA256_ALT_ERR_HW_ACCEL_FAILED;
+        }
+        input += bulk;
+        ilen -= bulk;
+    }
+
+    memcpy(ctx->buf, input, ilen);
+    ctx->buflen = ilen;
+
+    return 0;
 }
 
-int mbedtls_sha256_finish_ret(mbedtls_sha256_context *ctx,
+int
+mbedtls_sha256_finish_ret(mbedtls_sha256_context *ctx,
         unsigned char output[32])
 {
-    return hash_sha256_finish(&ctx->sha256ctx, output);
+    if (ctx->buflen > 0) {
+        if (hash_custom_update(ctx->hash, &ctx->hashctx, ctx->algo,
+                               ctx->buf, ctx->buflen)) {
+            return SHA256_ALT_ERR_HW_ACCEL_FAILED;
+        }
+        ctx->buflen = 0;
+    }
+
+    if (hash_custom_finish(ctx->hash, &ctx->hashctx, ctx->algo, output)) {
+        return SHA256_ALT_ERR_HW_ACCEL_FAILED;
+    }
+
+    return 0;
 }
 
 /*
@@ -76,23 +146,21 @@ int mbedtls_sha256_finish_ret(mbedtls_sha256_context *ctx,
 void
 mbedtls_sha256_starts(mbedtls_sha256_context *ctx, int is224)
 {
-    /* SHA-224 not supported */
-    if (is224) {
-        return;
-    }
-    (void)hash_sha256_start(&ctx->sha256ctx, ctx->hash);
+    (void)mbedtls_sha256_starts_ret(ctx, is224);
 }
 
-void mbedtls_sha256_update(mbedtls_sha256_context *ctx,
+void
+mbedtls_sha256_update(mbedtls_sha256_context *ctx,
         const unsigned char *input, size_t ilen)
 {
-    (void)hash_sha256_update(&ctx->sha256ctx, input, ilen);
+    (void)mbedtls_sha256_update_ret(ctx, input, ilen);
 }
 
-void mbedtls_sha256_finish(mbedtls_sha256_context *ctx,
+void
+mbedtls_sha256_finish(mbedtls_sha256_context *ctx,
         unsigned char output[32])
 {
-    (void)hash_sha256_finish(&ctx->sha256ctx, output);
+    (void)mbedtls_sha256_finish_ret(ctx, output);
 }
 
 #endif /* MYNEWT_VAL(MBEDTLS_SHA256_ALT) */
@@ -79,6 +79,13 @@ void SX1272SetTx(uint32_t timeout);
  */
 void SX1272WriteFifo(uint8_t *buffer, uint8_t size);
 
+/*!
+ * \brief Waits for the mode requested last to be entered
+ *
+ * \param [IN] maxUsecs Longest time the mode switch is allowed to take
+ */
+static void SX1272WaitModeReady(uint32_t maxUsecs);
+
 /*!
  * \brief Reads the contents of the SX1272 FIFO
  *
@@ -727,7 +734,7 @@ SX1272Send(uint8_t *buffer, uint8_t size)
         // FIFO operations can not take place in Sleep mode
         if ((SX1272Read(REG_OPMODE) & ~RF_OPMODE_MASK) == RF_OPMODE_SLEEP) {
             SX1272SetStby();
-            os_cputime_delay_usecs(1000);
+            SX1272WaitModeReady(1000);
         }
 
         // Write payload buffer
@@ -752,6 +759,24 @@ SX1272SetSleep(void)
     SX1272.Settings.State = RF_IDLE;
 }
 
+static void
+SX1272WaitModeReady(uint32_t maxUsecs)
+{
+#if MYNEWT_VAL(SX1272_DIO5_PIN) >= 0
+    uint32_t start;
+
+    // DIO5 is mapped to ModeReady in both modems
+    start = os_cputime_get32();
+    while (hal_gpio_read(SX1272_DIO5) == 0) {
+        if (os_cputime_ticks_to_usecs(os_cputime_get32() - start) >= maxUsecs) {
+            break;
+        }
+    }
+#else
+    os_cputime_delay_usecs(maxUsecs);
+#endif
+}
+
 void
 SX1272SetStby(void)
 {
@@ -1073,12 +1098,10 @@ SX1272WriteBuffer(uint16_t addr, uint8_t *buffer, uint8_t size)
     bsp_spi_write_buf(addr | 0x80, buffer, size);
     hal_gpio_write(RADIO_NSS, 1);
 #else
-    uint8_t i;
-
     hal_gpio_write(RADIO_NSS, 0);
     hal_spi_tx_val(RADIO_SPI_IDX, addr | 0x80);
-    for(i = 0; i < size; i++) {
-        hal_spi_tx_val(RADIO_SPI_IDX, buffer[i]);
+    if (size != 0) {
+        hal_spi_txrx(RADIO_SPI_IDX, buffer, NULL, size);
     }
     hal_gpio_write(RADIO_NSS, 1);
 #endif
@@ -1092,12 +1115,11 @@ SX1272ReadBuffer(uint16_t addr, uint8_t *buffer, uint8_t size)
     bsp_spi_read_buf(addr & 0x7f, buffer, size);
     hal_gpio_write(RADIO_NSS, 1);
 #else
-    uint8_t i;
-
+    /* The radio ignores MOSI while reading; clock out the buffer itself */
     hal_gpio_write(RADIO_NSS, 0);
     hal_spi_tx_val(RADIO_SPI_IDX, addr & 0x7f);
-    for(i = 0; i < size; i++) {
-        buffer[i] = hal_spi_tx_val(RADIO_SPI_IDX, 0);
+    if (size != 0) {
+        hal_spi_txrx(RADIO_SPI_IDX, buffer, buffer, size);
     }
     hal_gpio_write(RADIO_NSS, 1);
 #endif
@@ -1222,9 +1244,13 @@ SX1272OnTimeoutIrq(void *unused)
     }
 }
 
+/* LoRa registers read in one burst on RxDone, REG_LR_FIFORXCURRENTADDR on */
+#define RX_REG(reg) (rxRegs[(reg) - REG_LR_FIFORXCURRENTADDR])
+
 void
 SX1272OnDio0Irq(void *unused)
 {
+    uint8_t rxRegs[REG_LR_PKTRSSIVALUE - REG_LR_FIFORXCURRENTADDR + 1];
     volatile uint8_t irqFlags = 0;
     int16_t rssi;
     int8_t snr;
@@ -1307,7 +1333,9 @@ SX1272OnDio0Irq(void *unused)
                 // Clear Irq
                 SX1272Write(REG_LR_IRQFLAGS, RFLR_IRQFLAGS_RXDONE);
 
-                irqFlags = SX1272Read(REG_LR_IRQFLAGS);
+                // Flags, length, FIFO address, SNR and RSSI in one burst
+                SX1272ReadBuffer(REG_LR_FIFORXCURRENTADDR, rxRegs, sizeof(rxRegs));
+                irqFlags = RX_REG(REG_LR_IRQFLAGS);
                 if ((irqFlags & RFLR_IRQFLAGS_PAYLOADCRCERROR_MASK) == RFLR_IRQFLAGS_PAYLOADCRCERROR){
                     // Clear Irq
                     SX1272Write(REG_LR_IRQFLAGS, RFLR_IRQFLAGS_PAYLOADCRCERROR);
@@ -1323,7 +1351,7 @@ SX1272OnDio0Irq(void *unused)
                     break;
                 }
 
-                SX1272.Settings.LoRaPacketHandler.SnrValue = SX1272Read(REG_LR_PKTSNRVALUE);
+                SX1272.Settings.LoRaPacketHandler.SnrValue = RX_REG(REG_LR_PKTSNRVALUE);
                 if (SX1272.Settings.LoRaPacketHandler.SnrValue & 0x80) {
                     // The SNR sign bit is 1
                     // Invert and divide by 4
@@ -1334,7 +1362,7 @@ SX1272OnDio0Irq(void *unused)
                     snr = (SX1272.Settings.LoRaPacketHandler.SnrValue & 0xFF) >> 2;
                 }
 
-                rssi = SX1272Read(REG_LR_PKTRSSIVALUE);
+                rssi = RX_REG(REG_LR_PKTRSSIVALUE);
                 if (snr < 0) {
                     SX1272.Settings.LoRaPacketHandler.RssiValue = RSSI_OFFSET + rssi + (rssi >> 4) +
                                                                   snr;
@@ -1342,8 +1370,8 @@ SX1272OnDio0Irq(void *unused)
                     SX1272.Settings.LoRaPacketHandler.RssiValue = RSSI_OFFSET + rssi + (rssi >> 4);
                 }
 
-                SX1272.Settings.LoRaPacketHandler.Size = SX1272Read(REG_LR_RXNBBYTES);
-                SX1272Write(REG_LR_FIFOADDRPTR, SX1272Read(REG_LR_FIFORXCURRENTADDR));
+                SX1272.Settings.LoRaPacketHandler.Size = RX_REG(REG_LR_RXNBBYTES);
+                SX1272Write(REG_LR_FIFOADDRPTR, RX_REG(REG_LR_FIFORXCURRENTADDR));
                 SX1272ReadFifo(g_rxtx_buffer, SX1272.Settings.LoRaPacketHandler.Size);
 
                 if (SX1272.Settings.LoRa.RxContinuous == false) {
@@ -73,6 +73,11 @@ SX1276IoInit(void)
     rc = hal_gpio_init_out(RADIO_NSS, 1);
     assert(rc == 0);
 
+#if MYNEWT_VAL(SX1276_DIO5_MODE_READY)
+    rc = hal_gpio_init_in(SX1276_DIO5, HAL_GPIO_PULL_NONE);
+    assert(rc == 0);
+#endif
+
     hal_spi_disable(RADIO_SPI_IDX);
 
     spi_settings.data_order = HAL_SPI_MSB_FIRST;
@@ -79,6 +79,13 @@ void SX1276SetTx(uint32_t timeout);
  */
 void SX1276WriteFifo(uint8_t *buffer, uint8_t size);
 
+/*!
+ * \brief Waits for the mode requested last to be entered
+ *
+ * \param [IN] maxUsecs Longest time the mode switch is allowed to take
+ */
+static void SX1276WaitModeReady(uint32_t maxUsecs);
+
 /*!
  * \brief Reads the contents of the SX1276 FIFO
  *
@@ -893,7 +900,7 @@ SX1276Send(uint8_t *buffer, uint8_t size)
         // FIFO operations can not take place in Sleep mode
         if ((SX1276Read(REG_OPMODE) & ~RF_OPMODE_MASK) == RF_OPMODE_SLEEP) {
             SX1276SetStby();
-            os_cputime_delay_usecs(1000);
+            SX1276WaitModeReady(1000);
         }
         // Write payload buffer
         SX1276WriteFifo(buffer, size);
@@ -914,6 +921,24 @@ SX1276SetSleep(void)
     SX1276.Settings.State = RF_IDLE;
 }
 
+static void
+SX1276WaitModeReady(uint32_t maxUsecs)
+{
+#if MYNEWT_VAL(SX1276_DIO5_MODE_READY)
+    uint32_t start;
+
+    // DIO5 is mapped to ModeReady in both modems
+    start = os_cputime_get32();
+    while (hal_gpio_read(SX1276_DIO5) == 0) {
+        if (os_cputime_ticks_to_usecs(os_cputime_get32() - start) >= maxUsecs) {
+            break;
+        }
+    }
+#else
+    os_cputime_delay_usecs(maxUsecs);
+#endif
+}
+
 void
 SX1276SetStby(void)
 {
@@ -1256,16 +1281,18 @@ SX1276Read(uint16_t addr)
     return data;
 }
 
+/*
+ * Registers auto-increment, and the FIFO does not, so a whole buffer goes in
+ * one chip select and a single SPI transfer after the address byte.
+ */
 void
 SX1276WriteBuffer(uint16_t addr, uint8_t *buffer, uint8_t size)
 {
-    uint8_t i;
-
     hal_gpio_write(RADIO_NSS, 0);
 
     hal_spi_tx_val(RADIO_SPI_IDX, addr | 0x80);
-    for(i = 0; i < size; i++) {
-        hal_spi_tx_val(RADIO_SPI_IDX, buffer[i]);
+    if (size != 0) {
+        hal_spi_txrx(RADIO_SPI_IDX, buffer, NULL, size);
     }
 
     hal_gpio_write(RADIO_NSS, 1);
@@ -1274,13 +1301,12 @@ SX1276WriteBuffer(uint16_t addr, uint8_t *buffer, uint8_t size)
 void
 SX1276ReadBuffer(uint16_t addr, uint8_t *buffer, uint8_t size)
 {
-    uint8_t i;
-
     hal_gpio_write(RADIO_NSS, 0);
 
+    /* The radio ignores MOSI while reading; clock out the buffer itself */
     hal_spi_tx_val(RADIO_SPI_IDX, addr & 0x7f);
-    for (i = 0; i < size; i++) {
-        buffer[i] = hal_spi_tx_val(RADIO_SPI_IDX, 0);
+    if (size != 0) {
+        hal_spi_txrx(RADIO_SPI_IDX, buffer, buffer, size);
     }
 
     hal_gpio_write(RADIO_NSS, 1);
@@ -1374,9 +1400,13 @@ SX1276OnTimeoutIrq(void *unused)
     }
 }
 
+/* LoRa registers read in one burst on RxDone, REG_LR_FIFORXCURRENTADDR on */
+#define RX_REG(reg) (rxRegs[(reg) - REG_LR_FIFORXCURRENTADDR])
+
 void
 SX1276OnDio0Irq(void *unused)
 {
+    uint8_t rxRegs[REG_LR_PKTRSSIVALUE - REG_LR_FIFORXCURRENTADDR + 1];
     int8_t snr;
     int16_t rssi;
     volatile uint8_t irqFlags = 0;
@@ -1455,7 +1485,9 @@ SX1276OnDio0Irq(void *unused)
             // Clear Irq
             SX1276Write(REG_LR_IRQFLAGS, RFLR_IRQFLAGS_RXDONE);
 
-            irqFlags = SX1276Read(REG_LR_IRQFLAGS);
+            // Flags, length, FIFO address, SNR and RSSI in one burst
+            SX1276ReadBuffer(REG_LR_FIFORXCURRENTADDR, rxRegs, sizeof(rxRegs));
+            irqFlags = RX_REG(REG_LR_IRQFLAGS);
             if ((irqFlags & RFLR_IRQFLAGS_PAYLOADCRCERROR_MASK) == RFLR_IRQFLAGS_PAYLOADCRCERROR) {
                 // Clear Irq
                 SX1276Write(REG_LR_IRQFLAGS, RFLR_IRQFLAGS_PAYLOADCRCERROR);
@@ -1470,7 +1502,7 @@ SX1276OnDio0Irq(void *unused)
             }
 
             // The SNR sign bit is 1
-            SX1276.Settings.LoRaPacketHandler.SnrValue = SX1276Read(REG_LR_PKTSNRVALUE);
+            SX1276.Settings.LoRaPacketHandler.SnrValue = RX_REG(REG_LR_PKTSNRVALUE);
             if (SX1276.Settings.LoRaPacketHandler.SnrValue & 0x80) {
                 // Invert and divide by 4
                 snr = ((~SX1276.Settings.LoRaPacketHandler.SnrValue + 1) & 0xFF) >> 2;
@@ -1480,7 +1512,7 @@ SX1276OnDio0Irq(void *unused)
                 snr = (SX1276.Settings.LoRaPacketHandler.SnrValue & 0xFF) >> 2;
             }
 
-            rssi = SX1276Read(REG_LR_PKTRSSIVALUE);
+            rssi = RX_REG(REG_LR_PKTRSSIVALUE);
             if (snr < 0) {
                 if (SX1276.Settings.Channel > RF_MID_BAND_THRESH) {
                     SX1276.Settings.LoRaPacketHandler.RssiValue =
@@ -1499,8 +1531,8 @@ SX1276OnDio0Irq(void *unused)
                 }
             }
 
-            SX1276.Settings.LoRaPacketHandler.Size = SX1276Read(REG_LR_RXNBBYTES);
-            SX1276Write(REG_LR_FIFOADDRPTR, SX1276Read(REG_LR_FIFORXCURRENTADDR));
+            SX1276.Settings.LoRaPacketHandler.Size = RX_REG(REG_LR_RXNBBYTES);
+            SX1276Write(REG_LR_FIFOADDRPTR, RX_REG(REG_LR_FIFORXCURRENTADDR));
             SX1276ReadFifo(RxTxBuffer, SX1276.Settings.LoRaPacketHandler.Size);
 
             if (SX1276.Settings.LoRa.RxContinuous == false) {
@@ -59,9 +59,26 @@
 #define SMSC_8710_ISR_AUTO_DONE 0x40
 #define SMSC_8710_ISR_LINK_DOWN 0x10
 
-#define STM32_ETH_RX_DESC_SZ 3
-#define STM32_ETH_TX_DESC_SZ 4
+#define STM32_ETH_RX_DESC_SZ MYNEWT_VAL(STM32_ETH_RX_DESC_CNT)
+#define STM32_ETH_TX_DESC_SZ MYNEWT_VAL(STM32_ETH_TX_DESC_CNT)
 
+/*
+ * How soon to retry filling the RX ring when the pbuf pool ran dry.
+ */
+#define STM32_RX_REFILL_FREQ os_cputime_usecs_to_ticks(2000)
+
+/*
+ * Checksums inserted by the MAC on transmit.
+ */
+#define STM32_ETH_CSUM_GEN (NETIF_CHECKSUM_GEN_IP | NETIF_CHECKSUM_GEN_UDP | \
+                            NETIF_CHECKSUM_GEN_TCP | NETIF_CHECKSUM_GEN_ICMP)
+
+/*
+ * Descriptors are chained, and point straight at pbuf payloads; data is
+ * never copied. RX descriptors each own a pool pbuf, replaced as frames are
+ * handed up. A transmitted frame's pbuf chain is referenced from the
+ * descriptor of its last segment and released once the DMA is done with it.
+ */
 struct stm32_eth_desc {
     volatile ETH_DMADescTypeDef desc;
     struct pbuf *p;
@@ -76,7 +93,10 @@ struct stm32_eth_state {
     uint8_t st_rx_tail;
     uint8_t st_tx_head;
     uint8_t st_tx_tail;
+    uint8_t st_tx_cnt;
+    uint8_t st_rx_refill;
     struct hal_timer st_phy_tmr;
+    struct hal_timer st_rx_tmr;
     const struct stm32_eth_cfg *cfg;
 };
 
@@ -86,6 +106,7 @@ struct stm32_eth_stats {
     uint32_t oerr;
     uint32_t iframe;
     uint32_t imem;
+    uint32_t ierr;
 } stm32_eth_stats;
 
 static struct stm32_eth_state stm32_eth_state;
@@ -108,6 +129,16 @@ stm32_eth_fill_rx(struct stm32_eth_state *ses)
 {
     struct stm32_eth_desc *sed;
     struct pbuf *p;
+    uint32_t ctrl;
+
+    ctrl = ETH_DMARXDESC_RCH | ETH_MAX_PACKET_SIZE;
+#if MYNEWT_VAL(STM32_ETH_RX_INT_WDT)
+    /*
+     * Leave RX interrupts to the receive watchdog, which fires once the
+     * line has been quiet for a while, so a burst is handled at once.
+     */
+    ctrl |= ETH_DMARXDESC_DIC;
+#endif
 
     while (1) {
         sed = &ses->st_rx_descs[ses->st_rx_tail];
@@ -117,11 +148,16 @@ stm32_eth_fill_rx(struct stm32_eth_state *ses)
         p = pbuf_alloc(PBUF_RAW, ETH_MAX_PACKET_SIZE, PBUF_POOL);
         if (!p) {
             ++stm32_eth_stats.imem;
+            if (!ses->st_rx_refill) {
+                ses->st_rx_refill = 1;
+                os_cputime_timer_relative(&ses->st_rx_tmr,
+                                          STM32_RX_REFILL_FREQ);
+            }
             break;
         }
         sed->p = p;
         sed->desc.Status = 0;
-        sed->desc.ControlBufferSize = ETH_DMARXDESC_RCH | ETH_MAX_PACKET_SIZE;
+        sed->desc.ControlBufferSize = ctrl;
         sed->desc.Buffer1Addr = (uint32_t)p->payload;
         sed->desc.Status = ETH_DMARXDESC_OWN;
 
@@ -138,6 +174,7 @@ stm32_eth_input(struct stm32_eth_state *ses)
     struct stm32_eth_desc *sed;
     struct pbuf *p;
     struct netif *nif;
+    uint32_t status;
 
     nif = &ses->st_nif;
 
@@ -146,24 +183,40 @@ stm32_eth_input(struct stm32_eth_state *ses)
         if (!sed->p) {
             break;
         }
-        if (sed->desc.Status & ETH_DMARXDESC_OWN) {
+        status = sed->desc.Status;
+        if (status & ETH_DMARXDESC_OWN) {
             break;
         }
         p = sed->p;
         sed->p = NULL;
-        if (!(sed->desc.Status & ETH_DMARXDESC_LS)) {
+        ses->st_rx_head++;
+        if (ses->st_rx_head >= STM32_ETH_RX_DESC_SZ) {
+            ses->st_rx_head = 0;
+        }
+        if ((status & (ETH_DMARXDESC_FS | ETH_DMARXDESC_LS)) !=
+            (ETH_DMARXDESC_FS | ETH_DMARXDESC_LS)) {
             /*
-             * Incoming data spans multiple pbufs. XXX support later
+             * Incoming data spans multiple pbufs. Buffers are sized for
+             * the largest frame, so this is not expected.
              */
+            ++stm32_eth_stats.ierr;
             pbuf_free(p);
             continue;
         }
-        p->len = p->tot_len = (sed->desc.Status & ETH_DMARXDESC_FL) >> 16;
+        if (status & ETH_DMARXDESC_ES) {
+            /*
+             * CRC, overrun or, with checksum offload, IP header checksum
+             * error.
+             */
+            ++stm32_eth_stats.ierr;
+            pbuf_free(p);
+            continue;
+        }
+        p->len = p->tot_len = (status & ETH_DMARXDESC_FL) >> 16;
         ++stm32_eth_stats.iframe;
-        nif->input(p, nif);
-        ses->st_rx_head++;
-        if (ses->st_rx_head >= STM32_ETH_RX_DESC_SZ) {
-            ses->st_rx_head = 0;
+        if (nif->input(p, nif) != ERR_OK) {
+            ++stm32_eth_stats.imem;
+            pbuf_free(p);
         }
     }
 
@@ -178,10 +231,33 @@ stm32_eth_input(struct stm32_eth_state *ses)
     }
 }
 
+static void
+stm32_eth_rx_refill(void *arg)
+{
+    struct stm32_eth_state *ses = (void *)arg;
+    os_sr_t sr;
+
+    /*
+     * Frames may have arrived while the ring was short: without a free
+     * descriptor the DMA stalls, and no RX interrupt follows.
+     */
+    OS_ENTER_CRITICAL(sr);
+    ses->st_rx_refill = 0;
+    stm32_eth_input(ses);
+    OS_EXIT_CRITICAL(sr);
+}
+
 void
 HAL_ETH_RxCpltCallback(ETH_HandleTypeDef *heth)
 {
+    os_sr_t sr;
+
+    /*
+     * The refill timer may run at a different interrupt priority.
+     */
+    OS_ENTER_CRITICAL(sr);
     stm32_eth_input(&stm32_eth_state);
+    OS_EXIT_CRITICAL(sr);
 }
 
 /*
@@ -220,24 +296,27 @@ stm32_eth_output_done(struct stm32_eth_state *ses)
 {
     struct stm32_eth_desc *sed;
 
-    while (1) {
+    while (ses->st_tx_cnt) {
         sed = &ses->st_tx_descs[ses->st_tx_tail];
-        if (!sed->p) {
-            break;
-        }
         if (sed->desc.Status & ETH_DMATXDESC_OWN) {
             /*
              * Belongs to board
              */
             break;
         }
-        if (sed->desc.Status & ETH_DMATXDESC_ES) {
-            ++stm32_eth_stats.oerr;
-        } else {
-            ++stm32_eth_stats.odone;
+        if (sed->p) {
+            /*
+             * Last segment of a frame.
+             */
+            if (sed->desc.Status & ETH_DMATXDESC_ES) {
+                ++stm32_eth_stats.oerr;
+            } else {
+                ++stm32_eth_stats.odone;
+            }
+            pbuf_free(sed->p);
+            sed->p = NULL;
         }
-        pbuf_free(sed->p);
-        sed->p = NULL;
+        ses->st_tx_cnt--;
         ses->st_tx_tail++;
         if (ses->st_tx_tail >= STM32_ETH_TX_DESC_SZ) {
             ses->st_tx_tail = 0;
@@ -249,53 +328,68 @@ static err_t
 stm32_eth_output(struct netif *nif, struct pbuf *p)
 {
     struct stm32_eth_state *ses = (struct stm32_eth_state *)nif;
+    struct stm32_eth_desc *first;
     struct stm32_eth_desc *sed;
     uint32_t reg;
     struct pbuf *q;
-    err_t errval;
+    int cnt;
 
     stm32_eth_output_done(ses);
 
     ++stm32_eth_stats.oframe;
-    sed = &ses->st_tx_descs[ses->st_tx_head];
+    cnt = 0;
     for (q = p; q; q = q->next) {
-        if (!q->len) {
-            continue;
+        if (q->len) {
+            cnt++;
         }
-        if (sed->desc.Status & ETH_DMATXDESC_OWN) {
-            /*
-             * Not enough space.
-             */
-            errval = ERR_MEM;
-            goto error;
-        }
-        sed = (struct stm32_eth_desc *)sed->desc.Buffer2NextDescAddr;
+    }
+    if (cnt == 0) {
+        return ERR_OK;
+    }
+    if (cnt > STM32_ETH_TX_DESC_SZ - ses->st_tx_cnt) {
+        /*
+         * Not enough space.
+         */
+        ++stm32_eth_stats.oerr;
+        return ERR_MEM;
     }
 
+    /*
+     * Hand the first descriptor to the DMA last, once the rest of the
+     * frame is in place.
+     */
+    first = &ses->st_tx_descs[ses->st_tx_head];
+    sed = NULL;
     for (q = p; q; q = q->next) {
         if (!q->len) {
             continue;
         }
         sed = &ses->st_tx_descs[ses->st_tx_head];
-        if (q == p) {
-            reg = ETH_DMATXDESC_FS | ETH_DMATXDESC_TCH;
-        } else {
-            reg = ETH_DMATXDESC_TCH;
+        reg = ETH_DMATXDESC_TCH;
+        if (sed == first) {
+            reg |= ETH_DMATXDESC_FS;
+#if LWIP_CHECKSUM_CTRL_PER_NETIF
+            reg |= ETH_DMATXDESC_CIC_TCPUDPICMP_FULL;
+#endif
         }
-        if (q->next == NULL) {
+        if (--cnt == 0) {
             reg |= ETH_DMATXDESC_LS;
         }
         sed->desc.Status = reg;
-        sed->desc.ControlBufferSize = p->len;
-        sed->desc.Buffer1Addr = (uint32_t)p->payload;
-        sed->p = p;
-        pbuf_ref(p);
-        sed->desc.Status = reg | ETH_DMATXDESC_OWN;
+        sed->desc.ControlBufferSize = q->len;
+        sed->desc.Buffer1Addr = (uint32_t)q->payload;
+        if (sed != first) {
+            sed->desc.Status = reg | ETH_DMATXDESC_OWN;
+        }
+        ses->st_tx_cnt++;
         ses->st_tx_head++;
         if (ses->st_tx_head >= STM32_ETH_TX_DESC_SZ) {
             ses->st_tx_head = 0;
         }
     }
+    pbuf_ref(p);
+    sed->p = p;
+    first->desc.Status |= ETH_DMATXDESC_OWN;
 
     if (ses->st_eth.Instance->DMASR & ETH_DMASR_TBUS) {
         /*
@@ -306,9 +400,6 @@ stm32_eth_output(struct netif *nif, struct pbuf *p)
     }
 
     return ERR_OK;
-error:
-    ++stm32_eth_stats.oerr;
-    return errval;
 }
 
 static void
@@ -368,6 +459,15 @@ stm32_lwip_init(struct netif *nif)
     nif->mtu = 1500;
     nif->hwaddr_len = ETHARP_HWADDR_LEN;
     nif->flags = NETIF_FLAG_BROADCAST | NETIF_FLAG_ETHARP;
+#if LWIP_CHECKSUM_CTRL_PER_NETIF
+    /*
+     * The MAC inserts IPv4 header and TCP/UDP/ICMP checksums. Received
+     * frames with bad IPv4 header checksums are dropped here, everything
+     * else is still checked by the stack: the MAC skips fragments.
+     */
+    NETIF_SET_CHECKSUM_CTRL(nif, NETIF_CHECKSUM_ENABLE_ALL &
+                            ~STM32_ETH_CSUM_GEN);
+#endif
 
 #if LWIP_IGMP
     nif->flags |= NETIF_FLAG_IGMP;
@@ -414,6 +514,9 @@ stm32_lwip_init(struct netif *nif)
     ses->st_rx_tail = 0;
     ses->st_tx_head = 0;
     ses->st_tx_tail = 0;
+    ses->st_tx_cnt = 0;
+    ses->st_rx_refill = 0;
+    os_cputime_timer_init(&ses->st_rx_tmr, stm32_eth_rx_refill, ses);
 
     stm32_eth_setup_descs(ses->st_rx_descs, STM32_ETH_RX_DESC_SZ);
     stm32_eth_setup_descs(ses->st_tx_descs, STM32_ETH_TX_DESC_SZ);
@@ -429,6 +532,10 @@ stm32_lwip_init(struct netif *nif)
     ses->st_eth.Instance->MACFFR |= ETH_MULTICASTFRAMESFILTER_NONE;
     ses->st_eth.Instance->DMATDLAR = (uint32_t)ses->st_tx_descs;
     ses->st_eth.Instance->DMARDLAR = (uint32_t)ses->st_rx_descs;
+#if MYNEWT_VAL(STM32_ETH_RX_INT_WDT)
+    __HAL_ETH_SET_RECEIVE_WATCHDOG_TIMER(&ses->st_eth,
+                                         MYNEWT_VAL(STM32_ETH_RX_INT_WDT));
+#endif
 
     /*
      * Generate an interrupt when link state changes
@@ -17,6 +17,7 @@
  * under the License.
  */
 
+#include <string.h>
 #include <hal/hal_spi.h>
 #include <hal/hal_gpio.h>
 #include <disk/disk.h>
@@ -63,14 +64,15 @@
 
 #define BLOCK_LEN           (512)
 
+/* MMC initialization accepts clocks in the range 100-400KHz */
+#define INIT_BAUDRATE       (100)
+
 static uint8_t g_block_buf[BLOCK_LEN];
 
 static struct hal_spi_settings mmc_settings = {
     .data_order = HAL_SPI_MSB_FIRST,
     .data_mode  = HAL_SPI_MODE0,
-    /* XXX: MMC initialization accepts clocks in the range 100-400KHz */
-    /* TODO: switch to high-speed aka 25MHz after initialization. */
-    .baudrate   = 100,
+    .baudrate   = INIT_BAUDRATE,
     .word_size  = HAL_SPI_WORD_SIZE_8BIT,
 };
 
@@ -80,6 +82,9 @@ static struct mmc_cfg {
     int                      ss_pin;
     void                     *spi_cfg;
     struct hal_spi_settings  *settings;
+#if MYNEWT_VAL(MMC_SPI_DMA)
+    struct os_sem            xfer_sem;
+#endif
 } g_mmc_cfg;
 
 static int
@@ -120,6 +125,48 @@ mmc_cfg_dev(uint8_t id)
     return &g_mmc_cfg;
 }
 
+#if MYNEWT_VAL(MMC_SPI_DMA)
+static void
+mmc_spi_txrx_cb(void *arg, int len)
+{
+    struct mmc_cfg *mmc;
+
+    mmc = arg;
+    os_sem_release(&mmc->xfer_sem);
+}
+#endif
+
+/**
+ * Clocks a buffer out to the card, storing the bytes it sends back in rxbuf
+ * if that is not NULL.  txbuf and rxbuf may be the same buffer.
+ */
+static int
+mmc_spi_xfer(struct mmc_cfg *mmc, void *txbuf, void *rxbuf, int len)
+{
+#if MYNEWT_VAL(MMC_SPI_DMA)
+    int rc;
+
+    rc = hal_spi_txrx_noblock(mmc->spi_num, txbuf, rxbuf, len);
+    if (rc) {
+        return MMC_DEVICE_ERROR;
+    }
+
+    rc = os_sem_pend(&mmc->xfer_sem, OS_TICKS_PER_SEC);
+    if (rc) {
+        hal_spi_abort(mmc->spi_num);
+        return MMC_TIMEOUT;
+    }
+
+    return MMC_OK;
+#else
+    if (hal_spi_txrx(mmc->spi_num, txbuf, rxbuf, len)) {
+        return MMC_DEVICE_ERROR;
+    }
+
+    return MMC_OK;
+#endif
+}
+
 static uint8_t
 send_mmc_cmd(struct mmc_cfg *mmc, uint8_t cmd, uint32_t payload)
 {
@@ -193,6 +240,7 @@ mmc_init(int spi_num, void *spi_cfg, int ss_pin)
     mmc->ss_pin = ss_pin;
     mmc->spi_cfg = spi_cfg;
     mmc->settings = &mmc_settings;
+    mmc->settings->baudrate = INIT_BAUDRATE;
 
     hal_gpio_init_out(mmc->ss_pin, 1);
 
@@ -206,7 +254,12 @@ mmc_init(int spi_num, void *spi_cfg, int ss_pin)
         return (rc);
     }
 
+#if MYNEWT_VAL(MMC_SPI_DMA)
+    os_sem_init(&mmc->xfer_sem, 0);
+    hal_spi_set_txrx_cb(mmc->spi_num, mmc_spi_txrx_cb, mmc);
+#else
     hal_spi_set_txrx_cb(mmc->spi_num, NULL, NULL);
+#endif
     hal_spi_enable(mmc->spi_num);
 
     /**
@@ -332,6 +385,15 @@ mmc_init(int spi_num, void *spi_cfg, int ss_pin)
 
 out:
     hal_gpio_write(mmc->ss_pin, 1);
+
+    /* Initialization is done; switch to the data transfer clock. */
+    if (rc == MMC_OK && MYNEWT_VAL(MMC_SPI_BAUDRATE) != INIT_BAUDRATE) {
+        hal_spi_disable(mmc->spi_num);
+        mmc->settings->baudrate = MYNEWT_VAL(MMC_SPI_BAUDRATE);
+        rc = hal_spi_config(mmc->spi_num, mmc->settings);
+        hal_spi_enable(mmc->spi_num);
+    }
+
     return rc;
 }
 
@@ -356,6 +418,49 @@ wait_busy(struct mmc_cfg *mmc)
     return res;
 }
 
+/**
+ * Receives one data block following a read command.
+ *
+ * @return 0 on success, non-zero on failure
+ */
+static int
+mmc_read_block(struct mmc_cfg *mmc, uint8_t *dst)
+{
+    os_time_t timeout;
+    uint8_t res;
+    int rc;
+
+    /**
+     * 7.3.3 Control tokens
+     *   Wait up to 200ms for control token.  The card usually answers well
+     *   within a millisecond, so poll without sleeping.
+     */
+    timeout = os_time_get() + OS_TICKS_PER_SEC / 5;
+    do {
+        res = hal_spi_tx_val(mmc->spi_num, 0xff);
+        if (res != 0xFF) break;
+    } while (os_time_get() < timeout);
+
+    /**
+     * 7.3.3.2 Start Block Tokens and Stop Tran Token
+     */
+    if (res != START_BLOCK) {
+        return MMC_TIMEOUT;
+    }
+
+    memset(dst, 0xff, BLOCK_LEN);
+    rc = mmc_spi_xfer(mmc, dst, dst, BLOCK_LEN);
+    if (rc) {
+        return rc;
+    }
+
+    /* TODO: CRC-16 not used here but would be cool to have */
+    hal_spi_tx_val(mmc->spi_num, 0xff);
+    hal_spi_tx_val(mmc->spi_num, 0xff);
+
+    return MMC_OK;
+}
+
 /**
  * @return 0 on success, non-zero on failure
  */
@@ -365,14 +470,12 @@ mmc_read(uint8_t mmc_id, uint32_t addr, void *buf, uint32_t len)
     uint8_t cmd;
     uint8_t res;
     int rc;
-    uint32_t n;
-    size_t block_len;
     size_t block_count;
-    os_time_t timeout;
     uint32_t block_addr;
     size_t offset;
     size_t index;
     size_t amount;
+    uint8_t *dst;
     struct mmc_cfg *mmc;
 
     mmc = mmc_cfg_dev(mmc_id);
@@ -382,10 +485,9 @@ mmc_read(uint8_t mmc_id, uint32_t addr, void *buf, uint32_t len)
 
     rc = MMC_OK;
 
-    block_len = (len + BLOCK_LEN - 1) & ~(BLOCK_LEN - 1);
-    block_count = block_len / BLOCK_LEN;
     block_addr = addr / BLOCK_LEN;
     offset = addr - (block_addr * BLOCK_LEN);
+    block_count = (offset + len + BLOCK_LEN - 1) / BLOCK_LEN;
 
     hal_gpio_write(mmc->ss_pin, 0);
 
@@ -396,38 +498,25 @@ mmc_read(uint8_t mmc_id, uint32_t addr, void *buf, uint32_t len)
         goto out;
     }
 
-    /**
-     * 7.3.3 Control tokens
-     *   Wait up to 200ms for control token.
-     */
-    timeout = os_time_get() + OS_TICKS_PER_SEC / 5;
-    do {
-        res = hal_spi_tx_val(mmc->spi_num, 0xff);
-        if (res != 0xFF) break;
-        os_time_delay(OS_TICKS_PER_SEC / 20);
-    } while (os_time_get() < timeout);
-
-    /**
-     * 7.3.3.2 Start Block Tokens and Stop Tran Token
-     */
-    if (res != START_BLOCK) {
-        rc = MMC_TIMEOUT;
-        goto out;
-    }
-
     index = 0;
     while (block_count--) {
-        for (n = 0; n < BLOCK_LEN; n++) {
-            g_block_buf[n] = hal_spi_tx_val(mmc->spi_num, 0xff);
-        }
+        amount = MIN(BLOCK_LEN - offset, len);
 
-        /* TODO: CRC-16 not used here but would be cool to have */
-        hal_spi_tx_val(mmc->spi_num, 0xff);
-        hal_spi_tx_val(mmc->spi_num, 0xff);
+        /* Whole blocks go straight to the caller's buffer. */
+        if (amount == BLOCK_LEN) {
+            dst = (uint8_t *)buf + index;
+        } else {
+            dst = g_block_buf;
+        }
 
-        amount = MIN(BLOCK_LEN - offset, len);
+        rc = mmc_read_block(mmc, dst);
+        if (rc) {
+            break;
+        }
 
-        memcpy(((uint8_t *)buf + index), &g_block_buf[offset], amount);
+        if (dst == g_block_buf) {
+            memcpy(((uint8_t *)buf + index), &g_block_buf[offset], amount);
+        }
 
         offset = 0;
         len -= amount;
@@ -452,14 +541,12 @@ mmc_write(uint8_t mmc_id, uint32_t addr, const void *buf, uint32_t len)
 {
     uint8_t cmd;
     uint8_t res;
-    uint32_t n;
-    size_t block_len;
     size_t block_count;
-    os_time_t timeout;
     uint32_t block_addr;
     size_t offset;
     size_t index;
     size_t amount;
+    uint8_t *src;
     int rc;
     struct mmc_cfg *mmc;
 
@@ -468,10 +555,9 @@ mmc_write(uint8_t mmc_id, uint32_t addr, const void *buf, uint32_t len)
         return (MMC_DEVICE_ERROR);
     }
 
-    block_len = (len + BLOCK_LEN - 1) & ~(BLOCK_LEN - 1);
-    block_count = block_len / BLOCK_LEN;
     block_addr = addr / BLOCK_LEN;
     offset = addr - (block_addr * BLOCK_LEN);
+    block_count = (offset + len + BLOCK_LEN - 1) / BLOCK_LEN;
 
     hal_gpio_write(mmc->ss_pin, 0);
 
@@ -490,24 +576,10 @@ mmc_write(uint8_t mmc_id, uint32_t addr, const void *buf, uint32_t len)
             goto out;
         }
 
-        timeout = os_time_get() + OS_TICKS_PER_SEC / 5;
-        do {
-            res = hal_spi_tx_val(mmc->spi_num, 0xff);
-            if (res != 0xff) break;
-            os_time_delay(OS_TICKS_PER_SEC / 20);
-        } while (os_time_get() < timeout);
-
-        if (res != START_BLOCK) {
+        if (mmc_read_block(mmc, g_block_buf)) {
             rc = MMC_CARD_ERROR;
             goto out;
         }
-
-        for (n = 0; n < BLOCK_LEN; n++) {
-            g_block_buf[n] = hal_spi_tx_val(mmc->spi_num, 0xff);
-        }
-
-        hal_spi_tx_val(mmc->spi_num, 0xff);
-        hal_spi_tx_val(mmc->spi_num, 0xff);
     }
 
     /* now start write */
@@ -531,10 +603,18 @@ mmc_write(uint8_t mmc_id, uint32_t addr, const void *buf, uint32_t len)
         }
 
         amount = MIN(BLOCK_LEN - offset, len);
-        memcpy(&g_block_buf[offset], ((uint8_t *)buf + index), amount);
 
-        for (n = 0; n < BLOCK_LEN; n++) {
-            hal_spi_tx_val(mmc->spi_num, g_block_buf[n]);
+        /* Whole blocks are sent straight from the caller's buffer. */
+        if (amount == BLOCK_LEN) {
+            src = (uint8_t *)buf + index;
+        } else {
+            memcpy(&g_block_buf[offset], ((uint8_t *)buf + index), amount);
+            src = g_block_buf;
+        }
+
+        if (mmc_spi_xfer(mmc, src, NULL, BLOCK_LEN)) {
+            res = 0;
+            break;
         }
 
         /* CRC */
@@ -51,24 +51,88 @@ struct soft_pwm_dev {
     void* seq_end_data;
     struct hal_timer cycle_timer;
     struct soft_pwm_channel chans[CHAN_COUNT];
+#if MYNEWT_VAL(SOFT_PWM_EDGE_CHAIN)
+    /* Start of the current cycle, edges are relative to it */
+    uint32_t cycle_start;
+    uint8_t n_edges;
+    uint8_t next_edge;
+    /* Running channels sorted by their fraction at cycle start */
+    uint8_t edge_chan[CHAN_COUNT];
+    uint16_t edge_frac[CHAN_COUNT];
+#endif
 };
 
 static struct soft_pwm_dev instances[DEV_COUNT];
 static struct pwm_dev os_dev_spwm[DEV_COUNT];
 
+#if MYNEWT_VAL(SOFT_PWM_EDGE_CHAIN)
 /**
- * Cycle start callback
+ * Arms the cycle timer for the next channel edge, or for the end of the
+ * cycle once all edges are done.
+ */
+static void
+soft_pwm_chain_arm(struct soft_pwm_dev *instance)
+{
+    uint32_t at;
+
+    if (instance->next_edge < instance->n_edges) {
+        at = instance->edge_frac[instance->next_edge];
+    } else {
+        at = instance->top_value;
+    }
+    os_cputime_timer_start(&instance->cycle_timer, instance->cycle_start + at);
+}
+
+/**
+ * Sets every running channel to its active level and sorts the channels
+ * by fraction, so one timer can walk through all edges of the cycle.
+ */
+static void
+soft_pwm_chain_start(struct soft_pwm_dev *instance)
+{
+    struct soft_pwm_channel *chans = instance->chans;
+    uint16_t frac;
+    int cnum;
+    int i;
+
+    instance->n_edges = 0;
+    for (cnum = 0; cnum < CHAN_COUNT; cnum++) {
+        if (!chans[cnum].running) {
+            continue;
+        }
+        hal_gpio_write(chans[cnum].pin, (chans[cnum].inverted) ? 0 : 1);
+
+        frac = chans[cnum].fraction;
+        for (i = instance->n_edges; i > 0 && instance->edge_frac[i - 1] > frac;
+             i--) {
+            instance->edge_frac[i] = instance->edge_frac[i - 1];
+            instance->edge_chan[i] = instance->edge_chan[i - 1];
+        }
+        instance->edge_frac[i] = frac;
+        instance->edge_chan[i] = cnum;
+        instance->n_edges++;
+    }
+    instance->next_edge = 0;
+
+    soft_pwm_chain_arm(instance);
+}
+#endif
+
+/**
+ * Cycle start
  *
  * Initializes every channel's output to high (or low accrding to its polarity).
- * Schedules toggle_cb for every channel.
+ * Schedules toggle_cb for every channel, or with SOFT_PWM_EDGE_CHAIN the
+ * first edge of the chain.
  */
-static void cycle_cb(void* arg)
+static void
+soft_pwm_cycle(struct soft_pwm_dev *instance, uint32_t now)
 {
+#if !MYNEWT_VAL(SOFT_PWM_EDGE_CHAIN)
     int cnum;
     bool inverted;
-    struct soft_pwm_dev* instance = (struct soft_pwm_dev *) arg;
     struct soft_pwm_channel* chans = instance->chans;
-    uint32_t now = os_cputime_get32();
+#endif
 
     if (instance->n_cycles) {
         instance->cycle_cnt++;
@@ -76,6 +140,10 @@ static void cycle_cb(void* arg)
     }
 
     if (instance->playing) {
+#if MYNEWT_VAL(SOFT_PWM_EDGE_CHAIN)
+        instance->cycle_start = now;
+        soft_pwm_chain_start(instance);
+#else
         for (cnum = 0; cnum < CHAN_COUNT; cnum++) {
             if (chans[cnum].running) {
                 inverted = chans[cnum].inverted;
@@ -87,6 +155,7 @@ static void cycle_cb(void* arg)
         }
         os_cputime_timer_start(&instance->cycle_timer,
                                now + instance->top_value);
+#endif
 
         if (instance->cycle_handler) {
             instance->cycle_handler(instance->cycle_data);
@@ -97,6 +166,50 @@ static void cycle_cb(void* arg)
     }
 }
 
+/**
+ * Cycle start callback
+ */
+static void cycle_cb(void* arg)
+{
+    soft_pwm_cycle((struct soft_pwm_dev *) arg, os_cputime_get32());
+}
+
+#if MYNEWT_VAL(SOFT_PWM_EDGE_CHAIN)
+/**
+ * Edge chain callback
+ *
+ * Ends the pulse of every channel whose edge is due, or within
+ * SOFT_PWM_EDGE_MERGE_TICKS of it, then arms the timer for the next edge.
+ * After the last edge, starts the next cycle where this one ends, not
+ * when the callback happened to run.
+ */
+static void chain_cb(void* arg)
+{
+    struct soft_pwm_dev *instance = (struct soft_pwm_dev *) arg;
+    struct soft_pwm_channel *chan;
+    uint32_t limit;
+
+    if (instance->next_edge >= instance->n_edges) {
+        soft_pwm_cycle(instance, instance->cycle_start + instance->top_value);
+        return;
+    }
+
+    limit = os_cputime_get32() - instance->cycle_start +
+            MYNEWT_VAL(SOFT_PWM_EDGE_MERGE_TICKS);
+    do {
+        chan = &instance->chans[instance->edge_chan[instance->next_edge]];
+        /* Channels stopped during the cycle have been set already */
+        if (chan->running) {
+            hal_gpio_write(chan->pin, (chan->inverted) ? 1 : 0);
+        }
+        instance->next_edge++;
+    } while (instance->next_edge < instance->n_edges &&
+             instance->edge_frac[instance->next_edge] <= limit);
+
+    soft_pwm_chain_arm(instance);
+}
+#endif
+
 /**
  * Channel output toggle callback
  *
@@ -144,7 +257,11 @@ soft_pwm_open(struct os_dev *odev, uint32_t wait, void *arg)
     instance->frequency = 100;
     instance->top_value = BASE_FREQ / 100;
     os_cputime_timer_init(&instance->cycle_timer,
+#if MYNEWT_VAL(SOFT_PWM_EDGE_CHAIN)
+                          chain_cb,
+#else
                           cycle_cb,
+#endif
                           &instances[dev->pwm_instance_id]);
 
     instance->playing = false;
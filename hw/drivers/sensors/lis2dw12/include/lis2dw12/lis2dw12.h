@@ -287,6 +287,10 @@ struct lis2dw12 {
 #if MYNEWT_VAL(BUS_DRIVER_PRESENT)
     bool node_is_spi;
 #endif
+#if MYNEWT_VAL(SENSOR_REG_SHADOW)
+    /* Copy of the configuration registers, CTRL1 to CTRL7 */
+    struct sensor_reg_shadow shadow;
+#endif
 };
 
 /**
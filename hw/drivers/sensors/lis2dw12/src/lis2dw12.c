@@ -46,6 +46,31 @@
 
 #define LIS2DW12_ST_NUM_READINGS 5
 
+#if MYNEWT_VAL(SENSOR_REG_SHADOW)
+/* Registers of the shadow window that are not cached */
+#define LIS2DW12_SHADOW_BIT(reg)    (1UL << ((reg) - LIS2DW12_REG_CTRL_REG1))
+#define LIS2DW12_SHADOW_VOLATILE                                \
+    (LIS2DW12_SHADOW_BIT(LIS2DW12_REG_CTRL_REG2) |              \
+     LIS2DW12_SHADOW_BIT(LIS2DW12_REG_CTRL_REG3) |              \
+     LIS2DW12_SHADOW_BIT(LIS2DW12_REG_TEMP_OUT) |               \
+     LIS2DW12_SHADOW_BIT(LIS2DW12_REG_STATUS_REG) |             \
+     LIS2DW12_SHADOW_BIT(LIS2DW12_REG_OUT_X_L) |                \
+     LIS2DW12_SHADOW_BIT(LIS2DW12_REG_OUT_X_H) |                \
+     LIS2DW12_SHADOW_BIT(LIS2DW12_REG_OUT_Y_L) |                \
+     LIS2DW12_SHADOW_BIT(LIS2DW12_REG_OUT_Y_H) |                \
+     LIS2DW12_SHADOW_BIT(LIS2DW12_REG_OUT_Z_L) |                \
+     LIS2DW12_SHADOW_BIT(LIS2DW12_REG_OUT_Z_H) |                \
+     LIS2DW12_SHADOW_BIT(LIS2DW12_REG_FIFO_SAMPLES) |           \
+     LIS2DW12_SHADOW_BIT(LIS2DW12_REG_STATUS_DUP) |             \
+     LIS2DW12_SHADOW_BIT(LIS2DW12_REG_WAKE_UP_SRC) |            \
+     LIS2DW12_SHADOW_BIT(LIS2DW12_REG_TAP_SRC) |                \
+     LIS2DW12_SHADOW_BIT(LIS2DW12_REG_SIXD_SRC) |               \
+     LIS2DW12_SHADOW_BIT(LIS2DW12_REG_INT_SRC))
+
+/* Longest write lis2dw12_writelen() accepts */
+#define LIS2DW12_SHADOW_MAX_BURST   19
+#endif
+
 static const struct lis2dw12_notif_cfg dflt_notif_cfg[] = {
     {
       .event     = SENSOR_EVENT_TYPE_SINGLE_TAP,
@@ -193,6 +218,8 @@ static int lis2dw12_sensor_unset_notification(struct sensor *,
                                               sensor_event_type_t);
 static int lis2dw12_sensor_handle_interrupt(struct sensor *);
 static int lis2dw12_sensor_set_config(struct sensor *, void *);
+static int lis2dw12_sensor_read_batch(struct sensor *, sensor_type_t, void *,
+        uint16_t, uint16_t *, uint32_t *);
 
 static const struct sensor_driver g_lis2dw12_sensor_driver = {
     .sd_read               = lis2dw12_sensor_read,
@@ -200,8 +227,8 @@ static const struct sensor_driver g_lis2dw12_sensor_driver = {
     .sd_get_config         = lis2dw12_sensor_get_config,
     .sd_set_notification   = lis2dw12_sensor_set_notification,
     .sd_unset_notification = lis2dw12_sensor_unset_notification,
-    .sd_handle_interrupt   = lis2dw12_sensor_handle_interrupt
-
+    .sd_handle_interrupt   = lis2dw12_sensor_handle_interrupt,
+    .sd_read_batch         = lis2dw12_sensor_read_batch,
 };
 
 #if !MYNEWT_VAL(BUS_DRIVER_PRESENT)
@@ -270,12 +297,10 @@ lis2dw12_spi_writelen(struct sensor_itf *itf, uint8_t addr, uint8_t *payload,
     int rc;
 
     /*
-     * Auto register address increment is needed if the length
-     * requested is moret than 1
+     * The register address auto-increments on multi-byte accesses
+     * (CTRL2 IF_ADD_INC); bit 7 of the address selects a read, not
+     * auto-increment as on other ST parts.
      */
-    if (len > 1) {
-        addr |= LIS2DW12_SPI_READ_CMD_BIT;
-    }
 
     /* Select the device */
     hal_gpio_write(itf->si_cs_pin, 0);
@@ -363,6 +388,12 @@ lis2dw12_writelen(struct sensor_itf *itf, uint8_t addr, uint8_t *payload,
     sensor_itf_unlock(itf);
 #endif
 
+#if MYNEWT_VAL(SENSOR_REG_SHADOW)
+    if (!rc) {
+        sensor_reg_shadow_written(itf, addr, payload, len);
+    }
+#endif
+
     return rc;
 }
 
@@ -479,6 +510,12 @@ err:
 int
 lis2dw12_write8(struct sensor_itf *itf, uint8_t reg, uint8_t value)
 {
+#if MYNEWT_VAL(SENSOR_REG_SHADOW)
+    if (itf->si_shadow) {
+        return sensor_reg_shadow_write(itf, reg, value);
+    }
+#endif
+
     return lis2dw12_writelen(itf, reg, &value, 1);
 }
 
@@ -494,6 +531,12 @@ lis2dw12_write8(struct sensor_itf *itf, uint8_t reg, uint8_t value)
 int
 lis2dw12_read8(struct sensor_itf *itf, uint8_t reg, uint8_t *value)
 {
+#if MYNEWT_VAL(SENSOR_REG_SHADOW)
+    if (itf->si_shadow) {
+        return sensor_reg_shadow_read(itf, reg, value);
+    }
+#endif
+
     return lis2dw12_readlen(itf, reg, value, 1);
 }
 
@@ -539,6 +582,51 @@ lis2dw12_readlen(struct sensor_itf *itf, uint8_t reg, uint8_t *buffer,
     return rc;
 }
 
+/**
+ * Read-modify-write a register with interface locked for both accesses
+ *
+ * @param The sensor interface
+ * @param The register address to modify
+ * @param Mask of bits to modify
+ * @param New value of bits in mask
+ *
+ * @return 0 on success, non-zero on failure
+ */
+int
+lis2dw12_modify8(struct sensor_itf *itf, uint8_t reg, uint8_t mask,
+                 uint8_t value)
+{
+    int rc;
+    uint8_t rval;
+
+#if MYNEWT_VAL(BUS_DRIVER_PRESENT)
+    rc = bus_node_lock(itf->si_dev, BUS_NODE_LOCK_DEFAULT_TIMEOUT);
+#else
+    rc = sensor_itf_lock(itf, MYNEWT_VAL(LIS2DW12_ITF_LOCK_TMO));
+#endif
+    if (rc) {
+        return rc;
+    }
+
+    rc = lis2dw12_read8(itf, reg, &rval);
+    if (rc) {
+        goto done;
+    }
+
+    rval = (rval & ~mask) | (value & mask);
+
+    rc = lis2dw12_write8(itf, reg, rval);
+
+done:
+#if MYNEWT_VAL(BUS_DRIVER_PRESENT)
+    (void)bus_node_unlock(itf->si_dev);
+#else
+    sensor_itf_unlock(itf);
+#endif
+
+    return rc;
+}
+
 /**
  * Calculates the acceleration in m/s^2 from mg
  *
@@ -589,6 +677,11 @@ lis2dw12_reset(struct sensor_itf *itf)
 
     os_time_delay((OS_TICKS_PER_SEC * 6/1000) + 1);
 
+#if MYNEWT_VAL(SENSOR_REG_SHADOW)
+    /* Registers are back to their defaults */
+    sensor_reg_shadow_invalidate(itf);
+#endif
+
 err:
     return rc;
 }
@@ -628,31 +721,13 @@ err:
 int
 lis2dw12_set_full_scale(struct sensor_itf *itf, uint8_t fs)
 {
-    int rc;
-    uint8_t reg;
-
     if (fs > LIS2DW12_FS_16G) {
         LIS2DW12_LOG_ERROR("Invalid full scale value\n");
-        rc = SYS_EINVAL;
-        goto err;
-    }
-
-    rc = lis2dw12_read8(itf, LIS2DW12_REG_CTRL_REG6, &reg);
-    if (rc) {
-        goto err;
-    }
-
-    reg &= ~LIS2DW12_CTRL_REG6_FS;
-    reg |= (fs & LIS2DW12_CTRL_REG6_FS);
-
-    rc = lis2dw12_write8(itf, LIS2DW12_REG_CTRL_REG6, reg);
-    if (rc) {
-        goto err;
+        return SYS_EINVAL;
     }
 
-    return 0;
-err:
-    return rc;
+    return lis2dw12_modify8(itf, LIS2DW12_REG_CTRL_REG6, LIS2DW12_CTRL_REG6_FS,
+                            fs);
 }
 
 /**
@@ -692,31 +767,13 @@ err:
 int
 lis2dw12_set_rate(struct sensor_itf *itf, uint8_t rate)
 {
-    int rc;
-    uint8_t reg;
-
     if (rate > LIS2DW12_DATA_RATE_1600HZ) {
         LIS2DW12_LOG_ERROR("Invalid rate value\n");
-        rc = SYS_EINVAL;
-        goto err;
-    }
-
-    rc = lis2dw12_read8(itf, LIS2DW12_REG_CTRL_REG1, &reg);
-    if (rc) {
-        goto err;
-    }
-
-    reg &= ~LIS2DW12_CTRL_REG1_ODR;
-    reg |= (rate & LIS2DW12_CTRL_REG1_ODR);
-
-    rc = lis2dw12_write8(itf, LIS2DW12_REG_CTRL_REG1, reg);
-    if (rc) {
-        goto err;
+        return SYS_EINVAL;
     }
 
-    return 0;
-err:
-    return rc;
+    return lis2dw12_modify8(itf, LIS2DW12_REG_CTRL_REG1, LIS2DW12_CTRL_REG1_ODR,
+                            rate);
 }
 
 /**
@@ -755,28 +812,9 @@ err:
 int
 lis2dw12_set_low_noise(struct sensor_itf *itf, uint8_t en)
 {
-    int rc;
-    uint8_t reg;
-
-    rc = lis2dw12_read8(itf, LIS2DW12_REG_CTRL_REG6, &reg);
-    if (rc) {
-        goto err;
-    }
-
-    if (en) {
-        reg |= LIS2DW12_CTRL_REG6_LOW_NOISE;
-    } else {
-        reg &= ~LIS2DW12_CTRL_REG6_LOW_NOISE;
-    }
-
-    rc = lis2dw12_write8(itf, LIS2DW12_REG_CTRL_REG6, reg);
-    if (rc) {
-        goto err;
-    }
-
-    return 0;
-err:
-    return rc;
+    return lis2dw12_modify8(itf, LIS2DW12_REG_CTRL_REG6,
+                            LIS2DW12_CTRL_REG6_LOW_NOISE,
+                            en ? LIS2DW12_CTRL_REG6_LOW_NOISE : 0);
 }
 
 /**
@@ -816,26 +854,9 @@ err:
 int
 lis2dw12_set_power_mode(struct sensor_itf *itf, uint8_t mode)
 {
-    int rc;
-    uint8_t reg;
-
-    rc = lis2dw12_read8(itf, LIS2DW12_REG_CTRL_REG1, &reg);
-    if (rc) {
-        goto err;
-    }
-
-    reg &= ~LIS2DW12_CTRL_REG1_MODE;
-    reg &= ~LIS2DW12_CTRL_REG1_LP_MODE;
-    reg |= mode;
-
-    rc = lis2dw12_write8(itf, LIS2DW12_REG_CTRL_REG1, reg);
-    if (rc) {
-        goto err;
-    }
-
-    return 0;
-err:
-    return rc;
+    return lis2dw12_modify8(itf, LIS2DW12_REG_CTRL_REG1,
+                            LIS2DW12_CTRL_REG1_MODE | LIS2DW12_CTRL_REG1_LP_MODE,
+                            mode);
 }
 
 /**
@@ -875,25 +896,8 @@ err:
 int
 lis2dw12_set_self_test(struct sensor_itf *itf, uint8_t mode)
 {
-    int rc;
-    uint8_t reg;
-
-    rc = lis2dw12_read8(itf, LIS2DW12_REG_CTRL_REG3, &reg);
-    if (rc) {
-        goto err;
-    }
-
-    reg &= ~LIS2DW12_CTRL_REG3_ST_MODE;
-    reg |= (mode & LIS2DW12_CTRL_REG3_ST_MODE);
-
-    rc = lis2dw12_write8(itf, LIS2DW12_REG_CTRL_REG3, reg);
-    if (rc) {
-        goto err;
-    }
-
-    return 0;
-err:
-    return rc;
+    return lis2dw12_modify8(itf, LIS2DW12_REG_CTRL_REG3,
+                            LIS2DW12_CTRL_REG3_ST_MODE, mode);
 }
 
 /**
@@ -933,18 +937,8 @@ err:
 int
 lis2dw12_set_int_pp_od(struct sensor_itf *itf, uint8_t mode)
 {
-    int rc;
-    uint8_t reg;
-
-    rc = lis2dw12_read8(itf, LIS2DW12_REG_CTRL_REG3, &reg);
-    if (rc) {
-        return rc;
-    }
-
-    reg &= ~LIS2DW12_CTRL_REG3_PP_OD;
-    reg |= mode ? LIS2DW12_CTRL_REG3_PP_OD : 0;
-
-    return lis2dw12_write8(itf, LIS2DW12_REG_CTRL_REG3, reg);
+    return lis2dw12_modify8(itf, LIS2DW12_REG_CTRL_REG3, LIS2DW12_CTRL_REG3_PP_OD,
+                            mode ? LIS2DW12_CTRL_REG3_PP_OD : 0);
 }
 
 /**
@@ -982,19 +976,8 @@ lis2dw12_get_int_pp_od(struct sensor_itf *itf, uint8_t *mode)
 int
 lis2dw12_set_latched_int(struct sensor_itf *itf, uint8_t en)
 {
-    int rc;
-    uint8_t reg;
-
-    rc = lis2dw12_read8(itf, LIS2DW12_REG_CTRL_REG3, &reg);
-    if (rc) {
-        return rc;
-    }
-
-    reg &= ~LIS2DW12_CTRL_REG3_LIR;
-    reg |= en ? LIS2DW12_CTRL_REG3_LIR : 0;
-
-    return lis2dw12_write8(itf, LIS2DW12_REG_CTRL_REG3, reg);
-
+    return lis2dw12_modify8(itf, LIS2DW12_REG_CTRL_REG3, LIS2DW12_CTRL_REG3_LIR,
+                            en ? LIS2DW12_CTRL_REG3_LIR : 0);
 }
 
 /**
@@ -1032,19 +1015,8 @@ lis2dw12_get_latched_int(struct sensor_itf *itf, uint8_t *en)
 int
 lis2dw12_set_int_active_low(struct sensor_itf *itf, uint8_t low)
 {
-    int rc;
-    uint8_t reg;
-
-    rc = lis2dw12_read8(itf, LIS2DW12_REG_CTRL_REG3, &reg);
-    if (rc) {
-        return rc;
-    }
-
-    reg &= ~LIS2DW12_CTRL_REG3_H_LACTIVE;
-    reg |= low ? LIS2DW12_CTRL_REG3_H_LACTIVE : 0;
-
-    return lis2dw12_write8(itf, LIS2DW12_REG_CTRL_REG3, reg);
-
+    return lis2dw12_modify8(itf, LIS2DW12_REG_CTRL_REG3, LIS2DW12_CTRL_REG3_H_LACTIVE,
+                            low ? LIS2DW12_CTRL_REG3_H_LACTIVE : 0);
 }
 
 /**
@@ -1083,18 +1055,8 @@ lis2dw12_get_int_active_low(struct sensor_itf *itf, uint8_t *low)
 int
 lis2dw12_set_slp_mode(struct sensor_itf *itf, uint8_t mode)
 {
-    int rc;
-    uint8_t reg;
-
-    rc = lis2dw12_read8(itf, LIS2DW12_REG_CTRL_REG3, &reg);
-    if (rc) {
-        return rc;
-    }
-
-    reg &= ~LIS2DW12_CTRL_REG3_SLP_MODE_SEL;
-    reg |= mode ? LIS2DW12_CTRL_REG3_SLP_MODE_SEL : 0;
-
-    return lis2dw12_write8(itf, LIS2DW12_REG_CTRL_REG3, reg);
+    return lis2dw12_modify8(itf, LIS2DW12_REG_CTRL_REG3, LIS2DW12_CTRL_REG3_SLP_MODE_SEL,
+                            mode ? LIS2DW12_CTRL_REG3_SLP_MODE_SEL : 0);
 }
 
 /**
@@ -1538,22 +1500,7 @@ int lis2dw12_get_fifo_samples(struct sensor_itf *itf, uint8_t *samples)
 int
 lis2dw12_clear_int1_pin_cfg(struct sensor_itf *itf, uint8_t cfg)
 {
-    int rc;
-    uint8_t reg;
-
-    reg = 0;
-
-    rc = lis2dw12_read8(itf, LIS2DW12_REG_CTRL_REG4, &reg);
-    if (rc) {
-        goto err;
-    }
-
-    reg &= ~cfg;
-
-    rc = lis2dw12_write8(itf, LIS2DW12_REG_CTRL_REG4, reg);
-
-err:
-    return rc;
+    return lis2dw12_modify8(itf, LIS2DW12_REG_CTRL_REG4, cfg, 0);
 }
 
 /**
@@ -1566,22 +1513,7 @@ err:
 int
 lis2dw12_clear_int2_pin_cfg(struct sensor_itf *itf, uint8_t cfg)
 {
-    int rc;
-    uint8_t reg;
-
-    reg = 0;
-
-    rc = lis2dw12_read8(itf, LIS2DW12_REG_CTRL_REG5, &reg);
-    if (rc) {
-        goto err;
-    }
-
-    reg &= ~cfg;
-
-    rc = lis2dw12_write8(itf, LIS2DW12_REG_CTRL_REG5, reg);
-
-err:
-    return rc;
+    return lis2dw12_modify8(itf, LIS2DW12_REG_CTRL_REG5, cfg, 0);
 }
 
 
@@ -1596,22 +1528,7 @@ err:
 int
 lis2dw12_set_int1_pin_cfg(struct sensor_itf *itf, uint8_t cfg)
 {
-    int rc;
-    uint8_t reg;
-
-    reg = 0;
-
-    rc = lis2dw12_read8(itf, LIS2DW12_REG_CTRL_REG4, &reg);
-    if (rc) {
-        goto err;
-    }
-
-    reg |= cfg;
-
-    rc = lis2dw12_write8(itf, LIS2DW12_REG_CTRL_REG4, reg);
-
-err:
-    return rc;
+    return lis2dw12_modify8(itf, LIS2DW12_REG_CTRL_REG4, cfg, cfg);
 }
 
 /**
@@ -1624,22 +1541,7 @@ err:
 int
 lis2dw12_set_int2_pin_cfg(struct sensor_itf *itf, uint8_t cfg)
 {
-    int rc;
-    uint8_t reg;
-
-    reg = 0;
-
-    rc = lis2dw12_read8(itf, LIS2DW12_REG_CTRL_REG5, &reg);
-    if (rc) {
-       goto err;
-    }
-
-    reg |= cfg;
-
-    rc = lis2dw12_write8(itf, LIS2DW12_REG_CTRL_REG5, reg);
-
-err:
-    return rc;
+    return lis2dw12_modify8(itf, LIS2DW12_REG_CTRL_REG5, cfg, cfg);
 }
 
 /**
@@ -2542,6 +2444,40 @@ err:
     return rc;
 }
 
+#if MYNEWT_VAL(SENSOR_RAW_DATA)
+/*
+ * Report the sample in counts, leaving the conversion to the sensor
+ * framework.  Full scale is +/-(fs)g over the 16 bit range, as in
+ * lis2dw12_get_data().
+ */
+static int lis2dw12_do_read(struct sensor *sensor, sensor_data_func_t data_func,
+                            void * data_arg, uint8_t fs)
+{
+    struct sensor_accel_raw_data sard;
+    struct sensor_itf *itf;
+    uint8_t payload[6];
+    int rc;
+
+    itf = SENSOR_GET_ITF(sensor);
+
+    rc = lis2dw12_readlen(itf, LIS2DW12_REG_OUT_X_L, payload, 6);
+    if (rc) {
+        return rc;
+    }
+
+    sard.sard_x = payload[0] | (payload[1] << 8);
+    sard.sard_y = payload[2] | (payload[3] << 8);
+    sard.sard_z = payload[4] | (payload[5] << 8);
+    sard.sard_scale = (fs * 2 * (int32_t)(STANDARD_ACCEL_GRAVITY * 1000000)) /
+                      UINT16_MAX;
+
+    sard.sard_x_is_valid = 1;
+    sard.sard_y_is_valid = 1;
+    sard.sard_z_is_valid = 1;
+
+    return data_func(sensor, data_arg, &sard, SENSOR_TYPE_ACCELEROMETER);
+}
+#else
 static int lis2dw12_do_read(struct sensor *sensor, sensor_data_func_t data_func,
                             void * data_arg, uint8_t fs)
 {
@@ -2583,6 +2519,7 @@ static int lis2dw12_do_read(struct sensor *sensor, sensor_data_func_t data_func,
 err:
     return rc;
 }
+#endif
 
 /**
  * Do accelerometer polling reads
@@ -2798,6 +2735,137 @@ err:
     }
 }
 
+/* Max samples per FIFO burst; the length of a register read is 8 bits */
+#define LIS2DW12_FIFO_BURST_SAMPLES     (255 / 6)
+
+/**
+ * Sample interval in microseconds for a CTRL_REG1 ODR setting.
+ */
+static uint32_t
+lis2dw12_rate_to_interval_us(uint8_t rate)
+{
+    switch (rate) {
+    case LIS2DW12_DATA_RATE_1_6HZ:
+        return 625000;
+    case LIS2DW12_DATA_RATE_12_5HZ:
+        return 80000;
+    case LIS2DW12_DATA_RATE_25HZ:
+        return 40000;
+    case LIS2DW12_DATA_RATE_50HZ:
+        return 20000;
+    case LIS2DW12_DATA_RATE_100HZ:
+        return 10000;
+    case LIS2DW12_DATA_RATE_200HZ:
+        return 5000;
+    case LIS2DW12_DATA_RATE_400HZ:
+        return 2500;
+    case LIS2DW12_DATA_RATE_800HZ:
+        return 1250;
+    case LIS2DW12_DATA_RATE_1600HZ:
+        return 625;
+    default:
+        return 0;
+    }
+}
+
+/**
+ * Drain the accelerometer FIFO.  With the FIFO enabled the register address
+ * wraps from OUT_Z_H back to OUT_X_L, so a single burst read returns
+ * consecutive samples and the FIFO is emptied with one bus transaction per
+ * LIS2DW12_FIFO_BURST_SAMPLES samples instead of one per sample.
+ */
+static int
+lis2dw12_sensor_read_batch(struct sensor *sensor, sensor_type_t type,
+                           void *buf, uint16_t max_count, uint16_t *count,
+                           uint32_t *interval_us)
+{
+    struct sensor_accel_data *sad;
+    struct lis2dw12 *lis2dw12;
+    struct sensor_itf *itf;
+    uint8_t payload[LIS2DW12_FIFO_BURST_SAMPLES * 6];
+    uint8_t fifo_samples;
+    uint8_t burst;
+    uint8_t rate;
+    uint8_t fs;
+    int16_t x, y, z;
+    float fx, fy, fz;
+    int rc;
+    int i;
+
+    *count = 0;
+    *interval_us = 0;
+
+    if (type != SENSOR_TYPE_ACCELEROMETER) {
+        return SYS_EINVAL;
+    }
+
+    lis2dw12 = (struct lis2dw12 *)SENSOR_GET_DEVICE(sensor);
+    itf = SENSOR_GET_ITF(sensor);
+
+    if (lis2dw12->cfg.fifo_mode == LIS2DW12_FIFO_M_BYPASS) {
+        return SYS_ENOTSUP;
+    }
+
+    rc = lis2dw12_get_fs(itf, &fs);
+    if (rc) {
+        return rc;
+    }
+
+    rc = lis2dw12_get_rate(itf, &rate);
+    if (rc) {
+        return rc;
+    }
+    *interval_us = lis2dw12_rate_to_interval_us(rate);
+
+    rc = lis2dw12_get_fifo_samples(itf, &fifo_samples);
+    if (rc) {
+        return rc;
+    }
+    if (fifo_samples > max_count) {
+        fifo_samples = max_count;
+    }
+
+    sad = buf;
+    while (fifo_samples > 0) {
+        burst = min(fifo_samples, LIS2DW12_FIFO_BURST_SAMPLES);
+
+        rc = lis2dw12_readlen(itf, LIS2DW12_REG_OUT_X_L, payload, burst * 6);
+        if (rc) {
+            return rc;
+        }
+
+        for (i = 0; i < burst; i++) {
+            x = payload[i * 6 + 0] | (payload[i * 6 + 1] << 8);
+            y = payload[i * 6 + 2] | (payload[i * 6 + 3] << 8);
+            z = payload[i * 6 + 4] | (payload[i * 6 + 5] << 8);
+
+            /* Same scaling as lis2dw12_get_data() */
+            x = (fs * 2 * 1000 * x)/UINT16_MAX;
+            y = (fs * 2 * 1000 * y)/UINT16_MAX;
+            z = (fs * 2 * 1000 * z)/UINT16_MAX;
+
+            lis2dw12_calc_acc_ms2(x, &fx);
+            lis2dw12_calc_acc_ms2(y, &fy);
+            lis2dw12_calc_acc_ms2(z, &fz);
+
+            sad->sad_x = fx;
+            sad->sad_y = fy;
+            sad->sad_z = fz;
+
+            sad->sad_x_is_valid = 1;
+            sad->sad_y_is_valid = 1;
+            sad->sad_z_is_valid = 1;
+
+            sad++;
+        }
+
+        *count += burst;
+        fifo_samples -= burst;
+    }
+
+    return 0;
+}
+
 static struct lis2dw12_notif_cfg *
 lis2dw12_find_notif_cfg_by_event(sensor_event_type_t event,
                                  struct lis2dw12_cfg *cfg)
@@ -3155,12 +3223,32 @@ lis2dw12_init(struct os_dev *dev, void *arg)
         goto err;
     }
 
+#if MYNEWT_VAL(SENSOR_RAW_DATA)
+    rc = sensor_set_raw_type_mask(sensor, SENSOR_TYPE_ACCELEROMETER);
+    if (rc) {
+        goto err;
+    }
+#endif
+
     /* Set the interface */
     rc = sensor_set_interface(sensor, arg);
     if (rc) {
         goto err;
     }
 
+#if MYNEWT_VAL(SENSOR_REG_SHADOW)
+    rc = sensor_reg_shadow_init(&lis2dw12->shadow, lis2dw12_readlen,
+                                lis2dw12_writelen, LIS2DW12_REG_CTRL_REG1,
+                                LIS2DW12_REG_CTRL_REG7 -
+                                LIS2DW12_REG_CTRL_REG1 + 1,
+                                LIS2DW12_SHADOW_MAX_BURST,
+                                LIS2DW12_SHADOW_VOLATILE);
+    if (rc) {
+        goto err;
+    }
+    sensor->s_itf.si_shadow = &lis2dw12->shadow;
+#endif
+
     rc = sensor_mgr_register(sensor);
     if (rc) {
         goto err;
@@ -3267,6 +3355,18 @@ lis2dw12_config(struct lis2dw12 *lis2dw12, struct lis2dw12_cfg *cfg)
         goto err;
     }
 
+#if MYNEWT_VAL(SENSOR_REG_SHADOW)
+    /*
+     * Read the configuration registers once, and write them back in a few
+     * bursts once all settings are applied.
+     */
+    rc = sensor_reg_shadow_load(itf);
+    if (rc) {
+        goto err;
+    }
+    sensor_reg_shadow_defer(itf);
+#endif
+
     rc = lis2dw12_set_int_pp_od(itf, cfg->int_pp_od);
     if (rc) {
         goto err;
@@ -3431,6 +3531,13 @@ lis2dw12_config(struct lis2dw12 *lis2dw12, struct lis2dw12_cfg *cfg)
     }
     lis2dw12->cfg.map_int2_to_int1 = cfg->map_int2_to_int1;
 
+#if MYNEWT_VAL(SENSOR_REG_SHADOW)
+    rc = sensor_reg_shadow_flush(itf);
+    if (rc) {
+        goto err;
+    }
+#endif
+
     rc = sensor_set_type_mask(&(lis2dw12->sensor), cfg->mask);
     if (rc) {
         goto err;
@@ -3452,6 +3559,10 @@ lis2dw12_config(struct lis2dw12 *lis2dw12, struct lis2dw12_cfg *cfg)
 
     return 0;
 err:
+#if MYNEWT_VAL(SENSOR_REG_SHADOW)
+    /* Apply the settings made before the failure, as without a shadow */
+    (void)sensor_reg_shadow_flush(itf);
+#endif
     return rc;
 }
 
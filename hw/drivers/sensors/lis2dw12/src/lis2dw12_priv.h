@@ -119,6 +119,8 @@ extern "C" {
 #define LIS2DW12_FREEFALL_DUR         (0x1F << 3)
 #define LIS2DW12_FREEFALL_THS          (0x7 << 0)
 
+#define LIS2DW12_REG_STATUS_DUP              0x37
+
 #define LIS2DW12_REG_WAKE_UP_SRC             0x38
 #define LIS2DW12_REG_TAP_SRC                 0x39
 #define LIS2DW12_REG_SIXD_SRC                0x3A
@@ -151,6 +153,7 @@ int lis2dw12_spi_readlen(struct sensor_itf *itf, uint8_t reg, uint8_t *buffer, u
 int lis2dw12_write8(struct sensor_itf *itf, uint8_t reg, uint8_t value);
 int lis2dw12_read8(struct sensor_itf *itf, uint8_t reg, uint8_t *value);
 int lis2dw12_readlen(struct sensor_itf *itf, uint8_t reg, uint8_t *buffer, uint8_t len);
+int lis2dw12_modify8(struct sensor_itf *itf, uint8_t reg, uint8_t mask, uint8_t value);
 
 void lis2dw12_calc_acc_ms2(int16_t raw_acc, float *facc);
 void lis2dw12_calc_acc_mg(float acc_ms2, int16_t *acc_mg);
@@ -23,6 +23,10 @@
 #include <inttypes.h>
 #include <stddef.h>
 #include "os/mynewt.h"
+#if MYNEWT_VAL(TRNG_PRNG)
+#include "tinycrypt/constants.h"
+#include "tinycrypt/ctr_prng.h"
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -39,9 +43,38 @@ struct trng_interface {
     trng_read_func_t read;
 };
 
+#if MYNEWT_VAL(TRNG_POOL_SIZE) > 0
+/*
+ * Entropy pool, refilled from the driver in the background so requests
+ * can be served without waiting for the TRNG.
+ */
+struct trng_pool {
+    uint8_t buf[MYNEWT_VAL(TRNG_POOL_SIZE)];
+    uint16_t head;
+    uint16_t len;
+    uint8_t started;
+    struct os_callout refill;
+};
+#endif
+
+#if MYNEWT_VAL(TRNG_PRNG)
+struct trng_prng {
+    TCCtrPrng_t ctx;
+    struct os_mutex mtx;
+    uint8_t mtx_init;
+    uint8_t seeded;
+};
+#endif
+
 struct trng_dev {
     struct os_dev dev;
     struct trng_interface interface;
+#if MYNEWT_VAL(TRNG_POOL_SIZE) > 0
+    struct trng_pool pool;
+#endif
+#if MYNEWT_VAL(TRNG_PRNG)
+    struct trng_prng prng;
+#endif
 };
 
 /**
@@ -69,6 +102,24 @@ uint32_t trng_get_u32(struct trng_dev *trng);
  */
 size_t trng_read(struct trng_dev *trng, void *ptr, size_t size);
 
+#if MYNEWT_VAL(TRNG_PRNG)
+/**
+ * Fill buffer with pseudo-random values
+ *
+ * Values come from a CTR-DRBG seeded (and reseeded when required) from
+ * TRNG. This is much faster than reading TRNG directly and should be used
+ * for randomness that does not need to come straight from the entropy
+ * source. Blocks only while the DRBG is being seeded.
+ *
+ * @param trng  OS device used for seeding
+ * @param ptr   target buffer pointer
+ * @param size  target buffer size (in bytes)
+ *
+ * @return  0 on success, SYS_EIO on DRBG failure
+ */
+int trng_prng_read(struct trng_dev *trng, void *ptr, size_t size);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -17,20 +17,217 @@
  * under the License.
  */
 
+#include <string.h>
 #include "trng/trng.h"
 
+#if MYNEWT_VAL(TRNG_POOL_SIZE) > 0
+#define TRNG_POOL_SIZE  MYNEWT_VAL(TRNG_POOL_SIZE)
+
+/*
+ * Moves data from driver to pool until pool is full or driver has nothing
+ * more to give; in the latter case tries again later. Pool is written only
+ * from here, readers take data from the other end under critical section.
+ */
+static void
+trng_pool_refill(struct os_event *ev)
+{
+    struct trng_dev *trng;
+    struct trng_pool *pool;
+    uint16_t space;
+    uint16_t head;
+    size_t num;
+    os_sr_t sr;
+
+    trng = ev->ev_arg;
+    pool = &trng->pool;
+
+    while (1) {
+        OS_ENTER_CRITICAL(sr);
+        head = pool->head;
+        space = TRNG_POOL_SIZE - pool->len;
+        OS_EXIT_CRITICAL(sr);
+
+        if (space == 0) {
+            return;
+        }
+
+        /* Only fill up to end of buffer, next iteration wraps around */
+        space = min(space, TRNG_POOL_SIZE - head);
+        num = trng->interface.read(trng, &pool->buf[head], space);
+        if (num == 0) {
+            break;
+        }
+
+        OS_ENTER_CRITICAL(sr);
+        pool->head = (head + num) % TRNG_POOL_SIZE;
+        pool->len += num;
+        OS_EXIT_CRITICAL(sr);
+    }
+
+    os_callout_reset(&pool->refill, MYNEWT_VAL(TRNG_POOL_REFILL_TICKS));
+}
+
+static void
+trng_pool_kick(struct trng_dev *trng)
+{
+    struct trng_pool *pool;
+    os_sr_t sr;
+
+    pool = &trng->pool;
+
+    OS_ENTER_CRITICAL(sr);
+    if (!pool->started) {
+        os_callout_init(&pool->refill, os_eventq_dflt_get(), trng_pool_refill,
+                        trng);
+        pool->started = 1;
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    if (!os_callout_queued(&pool->refill)) {
+        os_callout_reset(&pool->refill, 0);
+    }
+}
+
+static size_t
+trng_pool_read(struct trng_dev *trng, uint8_t *ptr, size_t size)
+{
+    struct trng_pool *pool;
+    uint16_t tail;
+    size_t num;
+    size_t n;
+    os_sr_t sr;
+
+    pool = &trng->pool;
+
+    OS_ENTER_CRITICAL(sr);
+
+    num = min(size, pool->len);
+    tail = (pool->head + TRNG_POOL_SIZE - pool->len) % TRNG_POOL_SIZE;
+    n = min(num, TRNG_POOL_SIZE - tail);
+    memcpy(ptr, &pool->buf[tail], n);
+    memcpy(ptr + n, pool->buf, num - n);
+    pool->len -= num;
+
+    OS_EXIT_CRITICAL(sr);
+
+    trng_pool_kick(trng);
+
+    return num;
+}
+#endif
+
 uint32_t
 trng_get_u32(struct trng_dev *trng)
 {
+#if MYNEWT_VAL(TRNG_POOL_SIZE) > 0
+    uint32_t val;
+    size_t num;
+#endif
+
     assert(trng->interface.get_u32);
 
+#if MYNEWT_VAL(TRNG_POOL_SIZE) > 0
+    num = trng_pool_read(trng, (uint8_t *)&val, sizeof(val));
+    if (num == sizeof(val)) {
+        return val;
+    }
+#endif
+
     return trng->interface.get_u32(trng);
 }
 
 size_t
 trng_read(struct trng_dev *trng, void *ptr, size_t size)
 {
+#if MYNEWT_VAL(TRNG_POOL_SIZE) > 0
+    size_t num;
+#endif
+
     assert(trng->interface.read);
 
+#if MYNEWT_VAL(TRNG_POOL_SIZE) > 0
+    num = trng_pool_read(trng, ptr, size);
+    if (num == size) {
+        return num;
+    }
+
+    return num + trng->interface.read(trng, (uint8_t *)ptr + num, size - num);
+#else
     return trng->interface.read(trng, ptr, size);
+#endif
+}
+
+#if MYNEWT_VAL(TRNG_PRNG)
+#define TRNG_PRNG_SEED_LEN  (TC_AES_KEY_SIZE + TC_AES_BLOCK_SIZE)
+
+static void
+trng_prng_entropy(struct trng_dev *trng, uint8_t *seed)
+{
+    uint32_t val;
+    int i;
+
+    for (i = 0; i < TRNG_PRNG_SEED_LEN; i += sizeof(val)) {
+        val = trng_get_u32(trng);
+        memcpy(&seed[i], &val, sizeof(val));
+    }
+}
+
+int
+trng_prng_read(struct trng_dev *trng, void *ptr, size_t size)
+{
+    struct trng_prng *prng;
+    uint8_t seed[TRNG_PRNG_SEED_LEN];
+    size_t num;
+    os_sr_t sr;
+    int rc;
+
+    prng = &trng->prng;
+
+    OS_ENTER_CRITICAL(sr);
+    if (!prng->mtx_init) {
+        os_mutex_init(&prng->mtx);
+        prng->mtx_init = 1;
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    os_mutex_pend(&prng->mtx, OS_TIMEOUT_NEVER);
+
+    if (!prng->seeded) {
+        trng_prng_entropy(trng, seed);
+        rc = tc_ctr_prng_init(&prng->ctx, seed, sizeof(seed), NULL, 0);
+        if (rc != TC_CRYPTO_SUCCESS) {
+            rc = SYS_EIO;
+            goto out;
+        }
+        prng->seeded = 1;
+    }
+
+    rc = 0;
+    while (size > 0) {
+        /* tinycrypt limits size of a single request */
+        num = min(size, 0x8000);
+        rc = tc_ctr_prng_generate(&prng->ctx, NULL, 0, ptr, num);
+        if (rc == TC_CTR_PRNG_RESEED_REQ) {
+            trng_prng_entropy(trng, seed);
+            rc = tc_ctr_prng_reseed(&prng->ctx, seed, sizeof(seed), NULL, 0);
+            if (rc != TC_CRYPTO_SUCCESS) {
+                rc = SYS_EIO;
+                break;
+            }
+            continue;
+        }
+        if (rc != TC_CRYPTO_SUCCESS) {
+            rc = SYS_EIO;
+            break;
+        }
+        rc = 0;
+        ptr = (uint8_t *)ptr + num;
+        size -= num;
+    }
+
+out:
+    memset(seed, 0, sizeof(seed));
+    os_mutex_release(&prng->mtx);
+    return rc;
 }
+#endif
@@ -66,6 +66,40 @@ typedef void (*uart_tx_done)(void *arg);
  */
 typedef int (*uart_rx_char)(void *arg, uint8_t byte);
 
+/*
+ * Function prototype for UART driver to ask for next block of data to send.
+ * Used instead of uart_tx_char by drivers which support block mode.
+ * Driver transmits directly from returned location (e.g. by DMA), so data
+ * shall be in RAM and stay valid until this is called again, i.e. calling
+ * this also means that previously returned block was sent.
+ * Driver must call this with interrupts disabled.
+ *
+ * @param arg		This is uc_cb_arg passed in uart_conf in
+ *			os_dev_open().
+ * @param data		Set to start of data to send
+ * @param max		Maximum number of bytes driver can take
+ *
+ * @return		Number of bytes at data, 0 if no more data to send.
+ */
+typedef int (*uart_tx_block)(void *arg, const uint8_t **data, int max);
+
+/*
+ * Function prototype for UART driver to report block of incoming data.
+ * Used instead of uart_rx_char by drivers which support block mode.
+ * Driver must call this with interrupts disabled.
+ *
+ * @param arg		This is uc_cb_arg passed in uart_conf in
+ *			os_dev_open().
+ * @param data		Received data
+ * @param len		Number of bytes received
+ *
+ * @return		Number of bytes consumed. If less than len, this
+ *			triggers flow control (if configured), and user must
+ *			call uart_start_rx() to get remaining data and
+ *			receive more.
+ */
+typedef int (*uart_rx_block)(void *arg, const uint8_t *data, int len);
+
 struct uart_driver_funcs {
     void (*uf_start_tx)(struct uart_dev *);
     void (*uf_start_rx)(struct uart_dev *);
@@ -104,6 +138,12 @@ struct uart_conf {
     uart_rx_char uc_rx_char;
     uart_tx_done uc_tx_done;
     void *uc_cb_arg;
+    /*
+     * Optional block mode callbacks. Drivers which support block mode use
+     * these instead of uc_tx_char/uc_rx_char if set, others ignore them.
+     */
+    uart_tx_block uc_tx_block;
+    uart_rx_block uc_rx_block;
 };
 
 struct uart_dev {
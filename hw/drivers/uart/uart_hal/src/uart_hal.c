@@ -95,6 +95,14 @@ uart_hal_open(struct os_dev *odev, uint32_t wait, void *arg)
         return OS_EINVAL;
     }
 
+#if MYNEWT_VAL(UART_HAL_BLOCK)
+    if (uc->uc_tx_block || uc->uc_rx_block) {
+        /* Per-byte callbacks are used if HAL can't do block mode */
+        (void)hal_uart_init_block_cbs(uart_hal_dev_get_id(dev),
+                                      uc->uc_tx_block, uc->uc_rx_block);
+    }
+#endif
+
     rc = hal_uart_config(uart_hal_dev_get_id(dev), uc->uc_speed, uc->uc_databits,
       uc->uc_stopbits, (enum hal_uart_parity)uc->uc_parity, (enum hal_uart_flow_ctl)uc->uc_flow_ctl);
     if (rc) {
@@ -101,6 +101,79 @@ int hal_flash_erase_sector(uint8_t flash_id, uint32_t sector_address);
  */
 int hal_flash_erase(uint8_t flash_id, uint32_t address, uint32_t num_bytes);
 
+/**
+ * @brief Starts writing data to flash without waiting for it to complete.
+ *
+ * The driver may accept fewer bytes than requested (typically up to the end
+ * of a page); the caller starts the remainder once hal_flash_is_busy()
+ * reports the device idle.  The source buffer must remain valid until then.
+ *
+ * @param flash_id              The ID of the flash device to write to.
+ * @param address               The address to start writing at.
+ * @param src                   A buffer containing the data to be written.
+ * @param num_bytes             The number of bytes to write.
+ *
+ * @return                      The number of bytes being written on success;
+ *                              SYS_ENOTSUP if the driver only supports
+ *                                  blocking writes;
+ *                              SYS_EINVAL on bad argument error;
+ *                              SYS_EACCES if flash region is write protected;
+ *                              SYS_EIO on flash driver error.
+ */
+int hal_flash_write_start(uint8_t flash_id, uint32_t address,
+  const void *src, uint32_t num_bytes);
+
+/**
+ * @brief Starts erasing a single flash sector without waiting for it to
+ * complete.
+ *
+ * @param flash_id              The ID of the flash device to erase.
+ * @param sector_address        The start address of the sector to erase.
+ *
+ * @return                      0 on success;
+ *                              SYS_ENOTSUP if the driver only supports
+ *                                  blocking erases;
+ *                              SYS_EINVAL on bad argument error;
+ *                              SYS_EACCES if flash region is write protected;
+ *                              SYS_EIO on flash driver error.
+ */
+int hal_flash_erase_sector_start(uint8_t flash_id, uint32_t sector_address);
+
+/**
+ * @brief Gives a pointer through which a range of flash can be read
+ * directly, without copying it out with hal_flash_read().
+ *
+ * Only devices the CPU can read from memory-mapped support this.  The
+ * pointer remains valid until the range is written or erased.
+ *
+ * @param flash_id              The ID of the flash device to map.
+ * @param address               The address of the range to map.
+ * @param num_bytes             The length of the range to map.
+ * @param ptr                   On success, where the range can be read.
+ *
+ * @return                      0 on success;
+ *                              SYS_ENOTSUP if the device is not
+ *                                  memory-mapped;
+ *                              SYS_EINVAL on bad argument error;
+ *                              SYS_EIO on flash driver error.
+ */
+int hal_flash_map(uint8_t flash_id, uint32_t address, uint32_t num_bytes,
+  const void **ptr);
+
+/**
+ * @brief Reports whether a write or erase started with
+ * hal_flash_write_start() or hal_flash_erase_sector_start() is still running.
+ *
+ * @param flash_id              The ID of the flash device to query.
+ *
+ * @return                      1 if the device is busy;
+ *                              0 if it is idle or only supports blocking
+ *                                  operations;
+ *                              SYS_EINVAL on bad argument error;
+ *                              SYS_EIO on flash driver error.
+ */
+int hal_flash_is_busy(uint8_t flash_id);
+
 /**
  * @brief Determines if the specified region of flash is completely unwritten.
  *
@@ -45,6 +45,23 @@ struct hal_flash_funcs {
     int (*hff_init)(const struct hal_flash *dev);
     int (*hff_erase)(const struct hal_flash *dev, uint32_t address,
             uint32_t num_bytes);
+    /*
+     * Optional non-blocking interface.  hff_write_start() returns the number
+     * of bytes it started programming; hff_is_busy() returns 1 while an
+     * operation is in progress.
+     */
+    int (*hff_write_start)(const struct hal_flash *dev, uint32_t address,
+            const void *src, uint32_t num_bytes);
+    int (*hff_erase_sector_start)(const struct hal_flash *dev,
+            uint32_t sector_address);
+    int (*hff_is_busy)(const struct hal_flash *dev);
+    /*
+     * Optional.  For flash the CPU can read directly (internal flash, an
+     * execute-in-place window), sets *ptr to where the given range can be
+     * read.
+     */
+    int (*hff_map)(const struct hal_flash *dev, uint32_t address,
+            uint32_t num_bytes, const void **ptr);
 };
 
 struct hal_flash {
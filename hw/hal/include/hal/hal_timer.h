@@ -30,6 +30,7 @@
 
 #include <inttypes.h>
 #include "os/queue.h"
+#include "syscfg/syscfg.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -58,6 +59,10 @@ struct hal_timer {
     /** Tick at which timer should expire */
     uint32_t            expiry;
     TAILQ_ENTRY(hal_timer) link;    /* Queue linked list structure */
+#if MYNEWT_VAL(HAL_TIMER_HEAP)
+    /** Position in the hal_timer_queue heap */
+    uint16_t            heap_idx;
+#endif
 };
 
 /**
@@ -0,0 +1,115 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef H_HAL_TIMER_QUEUE_
+#define H_HAL_TIMER_QUEUE_
+
+#include <inttypes.h>
+#include "syscfg/syscfg.h"
+#include "hal/hal_timer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Queue of armed timers for one hardware timer, for use by MCU hal_timer
+ * implementations.
+ *
+ * With HAL_TIMER_HEAP, the queue is a binary min-heap ordered by expiry:
+ * arming, stopping and expiring a timer are O(log n) regardless of how
+ * many are armed.  Otherwise it is the sorted list the ports have always
+ * kept, with O(n) arming.
+ *
+ * All functions must be called with interrupts disabled.
+ */
+struct hal_timer_queue {
+#if MYNEWT_VAL(HAL_TIMER_HEAP)
+    struct hal_timer *htq_heap[MYNEWT_VAL(HAL_TIMER_HEAP_SIZE)];
+    uint16_t htq_cnt;
+#else
+    TAILQ_HEAD(, hal_timer) htq_list;
+#endif
+};
+
+/** Reads the hardware timer's counter; see hal_timer_queue_run(). */
+typedef uint32_t hal_timer_queue_now_fn(void *arg);
+
+/**
+ * Empties a queue.  A zero-filled queue is also empty.
+ */
+void hal_timer_queue_init(struct hal_timer_queue *q);
+
+/**
+ * Marks a timer as not armed.  Called from hal_timer_set_cb().
+ */
+void hal_timer_queue_timer_init(struct hal_timer *tmr);
+
+/**
+ * Whether a timer is armed, in any queue.
+ */
+int hal_timer_queue_armed(const struct hal_timer *tmr);
+
+/**
+ * Arms a timer, with tmr->expiry already set.
+ *
+ * @return 0 on success; EINVAL if the timer is already armed; ENOMEM if
+ *         HAL_TIMER_HEAP_SIZE timers are already armed.
+ */
+int hal_timer_queue_insert(struct hal_timer_queue *q, struct hal_timer *tmr);
+
+/**
+ * Disarms a timer.  Does nothing if it is not armed.
+ */
+void hal_timer_queue_remove(struct hal_timer_queue *q, struct hal_timer *tmr);
+
+/**
+ * Returns the armed timer that expires first, or NULL if none is.
+ */
+struct hal_timer *hal_timer_queue_first(const struct hal_timer_queue *q);
+
+/**
+ * Disarms expired timers and calls their callbacks; called from the
+ * compare interrupt.
+ *
+ * Everything due at one reading of the counter is run as a batch, then
+ * the counter is read again to pick up timers that came due meanwhile.
+ * This stops when a reading finds nothing due, or after
+ * HAL_TIMER_EXPIRE_MAX callbacks if that is set.  In that case the first
+ * timer is already due, and the caller must make the interrupt fire
+ * again when it programs the compare for it.
+ *
+ * @param q         The queue.
+ * @param now_fn    Reads the timer's counter.
+ * @param arg       Argument for now_fn.
+ * @param early     Timers expiring up to this many ticks after the
+ *                  counter are also due, for hardware that cannot compare
+ *                  that close to the counter.
+ *
+ * @return The number of callbacks made.
+ */
+int hal_timer_queue_run(struct hal_timer_queue *q,
+                        hal_timer_queue_now_fn *now_fn, void *arg,
+                        uint32_t early);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* H_HAL_TIMER_QUEUE_ */
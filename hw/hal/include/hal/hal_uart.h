@@ -64,6 +64,37 @@ typedef int (*hal_uart_rx_char)(void *arg, uint8_t byte);
 int hal_uart_init_cbs(int uart, hal_uart_tx_char tx_func,
   hal_uart_tx_done tx_done, hal_uart_rx_char rx_func, void *arg);
 
+/**
+ * Function prototype for UART driver to ask for next block of data to send.
+ * Data is transmitted directly from given location (e.g. by DMA) so it shall
+ * stay valid until this function is called again, which also means that
+ * previously returned block was sent.
+ * Returns number of bytes available at *data (at most max), 0 if no more data
+ * is available for TX.
+ * Driver must call this with interrupts disabled.
+ */
+typedef int (*hal_uart_tx_block)(void *arg, const uint8_t **data, int max);
+
+/**
+ * Function prototype for UART driver to report block of incoming data.
+ * Returns number of bytes consumed. If this is less than len, reception is
+ * stalled and remaining data is reported again after hal_uart_start_rx().
+ * Driver must call this with interrupts disabled.
+ */
+typedef int (*hal_uart_rx_block)(void *arg, const uint8_t *data, int len);
+
+/**
+ * Sets block mode callbacks for given uart, to be used instead of
+ * tx_func/rx_func set with hal_uart_init_cbs(). Either can be NULL to keep
+ * using per-byte callback. Shall be called after hal_uart_init_cbs(), which
+ * clears block mode callbacks, and before hal_uart_config().
+ *
+ * This is optional and only available on some MCUs. Returns non-zero if block
+ * mode is not supported.
+ */
+int hal_uart_init_block_cbs(int uart, hal_uart_tx_block tx_func,
+  hal_uart_rx_block rx_func);
+
 enum hal_uart_parity {
     /** No Parity */
     HAL_UART_PARITY_NONE = 0,
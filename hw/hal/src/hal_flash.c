@@ -21,6 +21,10 @@
 #include <assert.h>
 #include <string.h>
 
+#include "syscfg/syscfg.h"
+#if !MYNEWT_VAL(OS_SYSVIEW_TRACE_FLASH)
+#define OS_TRACE_DISABLE_FILE_API
+#endif
 #include "os/mynewt.h"
 #include "hal/hal_bsp.h"
 #include "hal/hal_flash.h"
@@ -179,7 +183,9 @@ hal_flash_write(uint8_t id, uint32_t address, const void *src,
         return SYS_EACCES;
     }
 
+    os_trace_api_u32x3(OS_TRACE_ID_FLASH_WRITE, id, address, num_bytes);
     rc = hf->hf_itf->hff_write(hf, address, src, num_bytes);
+    os_trace_api_ret_u32(OS_TRACE_ID_FLASH_WRITE, (uint32_t)rc);
     if (rc != 0) {
         return SYS_EIO;
     }
@@ -216,7 +222,9 @@ hal_flash_erase_sector(uint8_t id, uint32_t sector_address)
         return SYS_EACCES;
     }
 
+    os_trace_api_u32x2(OS_TRACE_ID_FLASH_ERASE_SECTOR, id, sector_address);
     rc = hf->hf_itf->hff_erase_sector(hf, sector_address);
+    os_trace_api_ret_u32(OS_TRACE_ID_FLASH_ERASE_SECTOR, (uint32_t)rc);
     if (rc != 0) {
         return SYS_EIO;
     }
@@ -268,8 +276,12 @@ hal_flash_erase(uint8_t id, uint32_t address, uint32_t num_bytes)
         return SYS_EINVAL;
     }
 
+    os_trace_api_u32x3(OS_TRACE_ID_FLASH_ERASE, id, address, num_bytes);
     if (hf->hf_itf->hff_erase) {
-        hf->hf_itf->hff_erase(hf, address, num_bytes);
+        if (hf->hf_itf->hff_erase(hf, address, num_bytes)) {
+            rc = SYS_EIO;
+            goto done;
+        }
 #if MYNEWT_VAL(HAL_FLASH_VERIFY_ERASES)
         assert(hal_flash_isempty_no_buf(id, address, num_bytes) == 1);
 #endif
@@ -284,7 +296,8 @@ hal_flash_erase(uint8_t id, uint32_t address, uint32_t num_bytes)
                  * erase the sector.
                  */
                 if (hf->hf_itf->hff_erase_sector(hf, start)) {
-                    return SYS_EIO;
+                    rc = SYS_EIO;
+                    goto done;
                 }
 
 #if MYNEWT_VAL(HAL_FLASH_VERIFY_ERASES)
@@ -293,9 +306,127 @@ hal_flash_erase(uint8_t id, uint32_t address, uint32_t num_bytes)
             }
         }
     }
+    rc = 0;
+
+done:
+    os_trace_api_ret_u32(OS_TRACE_ID_FLASH_ERASE, (uint32_t)rc);
+    return rc;
+}
+
+int
+hal_flash_write_start(uint8_t id, uint32_t address, const void *src,
+  uint32_t num_bytes)
+{
+    const struct hal_flash *hf;
+    int rc;
+
+    hf = hal_bsp_flash_dev(id);
+    if (!hf) {
+        return SYS_EINVAL;
+    }
+    if (!hf->hf_itf->hff_write_start) {
+        return SYS_ENOTSUP;
+    }
+    if (num_bytes == 0 || hal_flash_check_addr(hf, address) ||
+      hal_flash_check_addr(hf, address + num_bytes)) {
+        return SYS_EINVAL;
+    }
+
+    if (protected_flash[id / 8] & (1 << (id & 7))) {
+        return SYS_EACCES;
+    }
+
+    os_trace_api_u32x3(OS_TRACE_ID_FLASH_WRITE_START, id, address, num_bytes);
+    rc = hf->hf_itf->hff_write_start(hf, address, src, num_bytes);
+    os_trace_api_ret_u32(OS_TRACE_ID_FLASH_WRITE_START, (uint32_t)rc);
+    if (rc <= 0) {
+        return SYS_EIO;
+    }
+
+    return rc;
+}
+
+int
+hal_flash_erase_sector_start(uint8_t id, uint32_t sector_address)
+{
+    const struct hal_flash *hf;
+    int rc;
+
+    hf = hal_bsp_flash_dev(id);
+    if (!hf) {
+        return SYS_EINVAL;
+    }
+    if (!hf->hf_itf->hff_erase_sector_start) {
+        return SYS_ENOTSUP;
+    }
+    if (hal_flash_check_addr(hf, sector_address)) {
+        return SYS_EINVAL;
+    }
+
+    if (protected_flash[id / 8] & (1 << (id & 7))) {
+        return SYS_EACCES;
+    }
+
+    os_trace_api_u32x2(OS_TRACE_ID_FLASH_ERASE_SECTOR_START, id,
+                       sector_address);
+    rc = hf->hf_itf->hff_erase_sector_start(hf, sector_address);
+    os_trace_api_ret_u32(OS_TRACE_ID_FLASH_ERASE_SECTOR_START, (uint32_t)rc);
+    if (rc != 0) {
+        return SYS_EIO;
+    }
+
+    return 0;
+}
+
+int
+hal_flash_map(uint8_t id, uint32_t address, uint32_t num_bytes,
+  const void **ptr)
+{
+    const struct hal_flash *hf;
+    int rc;
+
+    hf = hal_bsp_flash_dev(id);
+    if (!hf) {
+        return SYS_EINVAL;
+    }
+    if (!hf->hf_itf->hff_map) {
+        return SYS_ENOTSUP;
+    }
+    if (hal_flash_check_addr(hf, address) ||
+      hal_flash_check_addr(hf, address + num_bytes)) {
+        return SYS_EINVAL;
+    }
+
+    rc = hf->hf_itf->hff_map(hf, address, num_bytes, ptr);
+    if (rc != 0) {
+        return rc == SYS_ENOTSUP ? SYS_ENOTSUP : SYS_EIO;
+    }
+
     return 0;
 }
 
+int
+hal_flash_is_busy(uint8_t id)
+{
+    const struct hal_flash *hf;
+    int rc;
+
+    hf = hal_bsp_flash_dev(id);
+    if (!hf) {
+        return SYS_EINVAL;
+    }
+    if (!hf->hf_itf->hff_is_busy) {
+        return 0;
+    }
+
+    rc = hf->hf_itf->hff_is_busy(hf);
+    if (rc < 0) {
+        return SYS_EIO;
+    }
+
+    return rc != 0;
+}
+
 int
 hal_flash_is_erased(const struct hal_flash *hf, uint32_t address, void *dst,
         uint32_t num_bytes)
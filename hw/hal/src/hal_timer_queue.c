@@ -0,0 +1,249 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <errno.h>
+#include <stddef.h>
+#include "hal/hal_timer_queue.h"
+
+/* Whether timer a expires before timer b. */
+#define HAL_TIMER_LT(a, b)  ((int32_t)((a)->expiry - (b)->expiry) < 0)
+
+#if MYNEWT_VAL(HAL_TIMER_HEAP)
+
+#define HAL_TIMER_HEAP_SIZE     MYNEWT_VAL(HAL_TIMER_HEAP_SIZE)
+
+#if HAL_TIMER_HEAP_SIZE > 0xffff
+#error "HAL_TIMER_HEAP_SIZE must be at most 65535"
+#endif
+
+/*
+ * heap_idx holds the position in the heap plus one, so that 0, as in a
+ * zero-filled timer, means not armed.
+ */
+static void
+hal_timer_heap_set(struct hal_timer_queue *q, int idx, struct hal_timer *tmr)
+{
+    q->htq_heap[idx] = tmr;
+    tmr->heap_idx = idx + 1;
+}
+
+static int
+hal_timer_heap_up(struct hal_timer_queue *q, int idx)
+{
+    struct hal_timer *tmr;
+    int parent;
+
+    tmr = q->htq_heap[idx];
+    while (idx > 0) {
+        parent = (idx - 1) / 2;
+        if (!HAL_TIMER_LT(tmr, q->htq_heap[parent])) {
+            break;
+        }
+        hal_timer_heap_set(q, idx, q->htq_heap[parent]);
+        idx = parent;
+    }
+    hal_timer_heap_set(q, idx, tmr);
+
+    return idx;
+}
+
+static void
+hal_timer_heap_down(struct hal_timer_queue *q, int idx)
+{
+    struct hal_timer *tmr;
+    int child;
+
+    tmr = q->htq_heap[idx];
+    while (1) {
+        child = 2 * idx + 1;
+        if (child >= q->htq_cnt) {
+            break;
+        }
+        if (child + 1 < q->htq_cnt &&
+            HAL_TIMER_LT(q->htq_heap[child + 1], q->htq_heap[child])) {
+            child++;
+        }
+        if (!HAL_TIMER_LT(q->htq_heap[child], tmr)) {
+            break;
+        }
+        hal_timer_heap_set(q, idx, q->htq_heap[child]);
+        idx = child;
+    }
+    hal_timer_heap_set(q, idx, tmr);
+}
+
+void
+hal_timer_queue_init(struct hal_timer_queue *q)
+{
+    q->htq_cnt = 0;
+}
+
+void
+hal_timer_queue_timer_init(struct hal_timer *tmr)
+{
+    tmr->heap_idx = 0;
+}
+
+int
+hal_timer_queue_armed(const struct hal_timer *tmr)
+{
+    return tmr->heap_idx != 0;
+}
+
+int
+hal_timer_queue_insert(struct hal_timer_queue *q, struct hal_timer *tmr)
+{
+    if (hal_timer_queue_armed(tmr)) {
+        return EINVAL;
+    }
+    if (q->htq_cnt >= HAL_TIMER_HEAP_SIZE) {
+        return ENOMEM;
+    }
+
+    q->htq_heap[q->htq_cnt] = tmr;
+    hal_timer_heap_up(q, q->htq_cnt++);
+
+    return 0;
+}
+
+void
+hal_timer_queue_remove(struct hal_timer_queue *q, struct hal_timer *tmr)
+{
+    struct hal_timer *last;
+    int idx;
+
+    if (!hal_timer_queue_armed(tmr)) {
+        return;
+    }
+
+    idx = tmr->heap_idx - 1;
+    tmr->heap_idx = 0;
+
+    /* Fill the hole with the last element and restore the heap property. */
+    last = q->htq_heap[--q->htq_cnt];
+    if (last != tmr) {
+        q->htq_heap[idx] = last;
+        hal_timer_heap_down(q, hal_timer_heap_up(q, idx));
+    }
+}
+
+struct hal_timer *
+hal_timer_queue_first(const struct hal_timer_queue *q)
+{
+    if (q->htq_cnt == 0) {
+        return NULL;
+    }
+    return q->htq_heap[0];
+}
+
+#else
+
+void
+hal_timer_queue_init(struct hal_timer_queue *q)
+{
+    TAILQ_INIT(&q->htq_list);
+}
+
+void
+hal_timer_queue_timer_init(struct hal_timer *tmr)
+{
+    tmr->link.tqe_prev = NULL;
+}
+
+int
+hal_timer_queue_armed(const struct hal_timer *tmr)
+{
+    return tmr->link.tqe_prev != NULL;
+}
+
+int
+hal_timer_queue_insert(struct hal_timer_queue *q, struct hal_timer *tmr)
+{
+    struct hal_timer *entry;
+
+    if (hal_timer_queue_armed(tmr)) {
+        return EINVAL;
+    }
+
+    /* The head may be zero-filled rather than initialized. */
+    if (TAILQ_EMPTY(&q->htq_list)) {
+        TAILQ_INSERT_HEAD(&q->htq_list, tmr, link);
+        return 0;
+    }
+
+    TAILQ_FOREACH(entry, &q->htq_list, link) {
+        if (HAL_TIMER_LT(tmr, entry)) {
+            TAILQ_INSERT_BEFORE(entry, tmr, link);
+            return 0;
+        }
+    }
+    TAILQ_INSERT_TAIL(&q->htq_list, tmr, link);
+
+    return 0;
+}
+
+void
+hal_timer_queue_remove(struct hal_timer_queue *q, struct hal_timer *tmr)
+{
+    if (!hal_timer_queue_armed(tmr)) {
+        return;
+    }
+
+    TAILQ_REMOVE(&q->htq_list, tmr, link);
+    tmr->link.tqe_prev = NULL;
+}
+
+struct hal_timer *
+hal_timer_queue_first(const struct hal_timer_queue *q)
+{
+    return TAILQ_FIRST(&q->htq_list);
+}
+
+#endif
+
+int
+hal_timer_queue_run(struct hal_timer_queue *q,
+                    hal_timer_queue_now_fn *now_fn, void *arg,
+                    uint32_t early)
+{
+    struct hal_timer *tmr;
+    uint32_t due;
+    int batch;
+    int ran;
+
+    ran = 0;
+    do {
+        due = now_fn(arg) + early;
+        batch = 0;
+        while ((tmr = hal_timer_queue_first(q)) != NULL &&
+               (int32_t)(due - tmr->expiry) >= 0) {
+#if MYNEWT_VAL(HAL_TIMER_EXPIRE_MAX)
+            if (ran == MYNEWT_VAL(HAL_TIMER_EXPIRE_MAX)) {
+                return ran;
+            }
+#endif
+            hal_timer_queue_remove(q, tmr);
+            tmr->cb_func(tmr->cb_arg);
+            batch++;
+            ran++;
+        }
+    } while (batch > 0);
+
+    return ran;
+}
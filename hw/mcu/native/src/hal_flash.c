@@ -43,13 +43,16 @@ static int native_flash_erase_sector(const struct hal_flash *dev,
         uint32_t sector_address);
 static int native_flash_sector_info(const struct hal_flash *dev, int idx,
         uint32_t *address, uint32_t *size);
+static int native_flash_map(const struct hal_flash *dev, uint32_t address,
+        uint32_t length, const void **ptr);
 
 static const struct hal_flash_funcs native_flash_funcs = {
     .hff_read = native_flash_read,
     .hff_write = native_flash_write,
     .hff_erase_sector = native_flash_erase_sector,
     .hff_sector_info = native_flash_sector_info,
-    .hff_init = native_flash_init
+    .hff_init = native_flash_init,
+    .hff_map = native_flash_map
 };
 
 #if MYNEWT_VAL(MCU_FLASH_STYLE_ST)
@@ -217,6 +220,16 @@ native_flash_read(const struct hal_flash *dev, uint32_t address, void *dst,
     return 0;
 }
 
+static int
+native_flash_map(const struct hal_flash *dev, uint32_t address,
+        uint32_t length, const void **ptr)
+{
+    flash_native_ensure_file_open();
+    *ptr = (char *)file_loc + address;
+
+    return 0;
+}
+
 static int
 find_area(uint32_t address)
 {
@@ -36,13 +36,16 @@ static int nrf51_flash_erase_sector(const struct hal_flash *dev,
 static int nrf51_flash_sector_info(const struct hal_flash *dev, int idx,
         uint32_t *address, uint32_t *sz);
 static int nrf51_flash_init(const struct hal_flash *dev);
+static int nrf51_flash_map(const struct hal_flash *dev, uint32_t address,
+        uint32_t num_bytes, const void **ptr);
 
 static const struct hal_flash_funcs nrf51_flash_funcs = {
     .hff_read = nrf51_flash_read,
     .hff_write = nrf51_flash_write,
     .hff_erase_sector = nrf51_flash_erase_sector,
     .hff_sector_info = nrf51_flash_sector_info,
-    .hff_init = nrf51_flash_init
+    .hff_init = nrf51_flash_init,
+    .hff_map = nrf51_flash_map
 };
 
 const struct hal_flash nrf51_flash_dev = {
@@ -77,6 +80,14 @@ nrf51_flash_read(const struct hal_flash *dev, uint32_t address, void *dst,
     return 0;
 }
 
+static int
+nrf51_flash_map(const struct hal_flash *dev, uint32_t address,
+        uint32_t num_bytes, const void **ptr)
+{
+    *ptr = (const void *)address;
+    return 0;
+}
+
 /*
  * Flash write is done by writing 4 bytes at a time at a word boundary.
  */
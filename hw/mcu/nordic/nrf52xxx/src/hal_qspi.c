@@ -78,13 +78,21 @@ nrf52k_qspi_sector_info(const struct hal_flash *dev, int idx,
         uint32_t *address, uint32_t *sz);
 static int
 nrf52k_qspi_init(const struct hal_flash *dev);
+#if MYNEWT_VAL(QSPI_XIP)
+static int
+nrf52k_qspi_map(const struct hal_flash *dev, uint32_t address,
+        uint32_t num_bytes, const void **ptr);
+#endif
 
 static const struct hal_flash_funcs nrf52k_qspi_funcs = {
     .hff_read = nrf52k_qspi_read,
     .hff_write = nrf52k_qspi_write,
     .hff_erase_sector = nrf52k_qspi_erase_sector,
     .hff_sector_info = nrf52k_qspi_sector_info,
-    .hff_init = nrf52k_qspi_init
+    .hff_init = nrf52k_qspi_init,
+#if MYNEWT_VAL(QSPI_XIP)
+    .hff_map = nrf52k_qspi_map,
+#endif
 };
 
 const struct hal_flash nrf52k_qspi_dev = {
@@ -249,6 +257,31 @@ nrf52k_qspi_sector_info(const struct hal_flash *dev, int idx,
     return 0;
 }
 
+#if MYNEWT_VAL(QSPI_XIP)
+/*
+ * The external flash appears at NRF52K_QSPI_XIP_BASE, from flash address 0
+ * up to the end of the window.
+ */
+#define NRF52K_QSPI_XIP_BASE    0x12000000
+#define NRF52K_QSPI_XIP_SIZE    0x08000000
+
+static int
+nrf52k_qspi_map(const struct hal_flash *dev, uint32_t address,
+        uint32_t num_bytes, const void **ptr)
+{
+    if (address + num_bytes > NRF52K_QSPI_XIP_SIZE) {
+        return SYS_ENOTSUP;
+    }
+
+    /* Let a running write or erase finish before reading through XIP. */
+    while ((NRF_QSPI->STATUS & QSPI_STATUS_READY_Msk) == 0)
+        ;
+
+    *ptr = (const void *)(NRF52K_QSPI_XIP_BASE + address);
+    return 0;
+}
+#endif
+
 static int
 nrf52k_qspi_init(const struct hal_flash *dev)
 {
@@ -277,7 +310,11 @@ nrf52k_qspi_init(const struct hal_flash *dev)
     nrf_qspi_ifconfig0_set(NRF_QSPI, &config0);
     nrf_qspi_ifconfig1_set(NRF_QSPI, &config1);
 
+#if MYNEWT_VAL(QSPI_XIP)
+    NRF_QSPI->XIPOFFSET = 0;
+#else
     NRF_QSPI->XIPOFFSET = 0x12000000;
+#endif
 
     NRF_QSPI->ENABLE = 1;
     NRF_QSPI->TASKS_ACTIVATE = 1;
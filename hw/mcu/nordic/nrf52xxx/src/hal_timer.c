@@ -24,6 +24,7 @@
 #include "os/mynewt.h"
 #include "mcu/cmsis_nvic.h"
 #include "hal/hal_timer.h"
+#include "hal/hal_timer_queue.h"
 #include "nrf.h"
 #include "mcu/nrf52_hal.h"
 
@@ -52,7 +53,7 @@ struct nrf52_hal_timer {
     uint32_t timer_isrs;
     uint32_t tmr_freq;
     void *tmr_reg;
-    TAILQ_HEAD(hal_timer_qhead, hal_timer) hal_timer_q;
+    struct hal_timer_queue hal_timer_q;
 };
 
 #if MYNEWT_VAL(TIMER_0)
@@ -249,39 +250,40 @@ hal_timer_read_bsptimer(struct nrf52_hal_timer *bsptimer)
  *
  * @param bsptimer
  */
+static uint32_t
+hal_timer_chk_now(void *arg)
+{
+    struct nrf52_hal_timer *bsptimer;
+
+    bsptimer = arg;
+    if (bsptimer->tmr_rtc) {
+        return hal_timer_read_bsptimer(bsptimer);
+    } else {
+        return nrf_read_timer_cntr(bsptimer->tmr_reg);
+    }
+}
+
 static void
 hal_timer_chk_queue(struct nrf52_hal_timer *bsptimer)
 {
-    int32_t delta;
-    uint32_t tcntr;
     uint32_t ctx;
     struct hal_timer *timer;
 
     /* disable interrupts */
     __HAL_DISABLE_INTERRUPTS(ctx);
-    while ((timer = TAILQ_FIRST(&bsptimer->hal_timer_q)) != NULL) {
-        if (bsptimer->tmr_rtc) {
-            tcntr = hal_timer_read_bsptimer(bsptimer);
-            /*
-             * If we are within 3 ticks of RTC, we wont be able to set compare.
-             * Thus, we have to service this timer early.
-             */
-            delta = -3;
-        } else {
-            tcntr = nrf_read_timer_cntr(bsptimer->tmr_reg);
-            delta = 0;
-        }
-        if ((int32_t)(tcntr - timer->expiry) >= delta) {
-            TAILQ_REMOVE(&bsptimer->hal_timer_q, timer, link);
-            timer->link.tqe_prev = NULL;
-            timer->cb_func(timer->cb_arg);
-        } else {
-            break;
-        }
-    }
 
-    /* Any timers left on queue? If so, we need to set OCMP */
-    timer = TAILQ_FIRST(&bsptimer->hal_timer_q);
+    /*
+     * If we are within 3 ticks of RTC, we wont be able to set compare.
+     * Thus, we have to service this timer early.
+     */
+    hal_timer_queue_run(&bsptimer->hal_timer_q, hal_timer_chk_now, bsptimer,
+                        bsptimer->tmr_rtc ? 3 : 0);
+
+    /*
+     * Any timers left on queue? If so, we need to set OCMP.  One that is
+     * already due makes the interrupt pend again.
+     */
+    timer = hal_timer_queue_first(&bsptimer->hal_timer_q);
     if (timer) {
         nrf_timer_set_ocmp(bsptimer, timer->expiry);
     } else {
@@ -816,7 +818,7 @@ hal_timer_set_cb(int timer_num, struct hal_timer *timer, hal_timer_cb cb_func,
 
     timer->cb_func = cb_func;
     timer->cb_arg = arg;
-    timer->link.tqe_prev = NULL;
+    hal_timer_queue_timer_init(timer);
     timer->bsp_timer = bsptimer;
 
     rc = 0;
@@ -847,40 +849,32 @@ int
 hal_timer_start_at(struct hal_timer *timer, uint32_t tick)
 {
     uint32_t ctx;
-    struct hal_timer *entry;
     struct nrf52_hal_timer *bsptimer;
+    int rc;
 
-    if ((timer == NULL) || (timer->link.tqe_prev != NULL) ||
-        (timer->cb_func == NULL)) {
+    if ((timer == NULL) || (timer->cb_func == NULL)) {
         return EINVAL;
     }
     bsptimer = (struct nrf52_hal_timer *)timer->bsp_timer;
-    timer->expiry = tick;
 
     __HAL_DISABLE_INTERRUPTS(ctx);
 
-    if (TAILQ_EMPTY(&bsptimer->hal_timer_q)) {
-        TAILQ_INSERT_HEAD(&bsptimer->hal_timer_q, timer, link);
-    } else {
-        TAILQ_FOREACH(entry, &bsptimer->hal_timer_q, link) {
-            if ((int32_t)(timer->expiry - entry->expiry) < 0) {
-                TAILQ_INSERT_BEFORE(entry, timer, link);
-                break;
-            }
-        }
-        if (!entry) {
-            TAILQ_INSERT_TAIL(&bsptimer->hal_timer_q, timer, link);
-        }
+    if (hal_timer_queue_armed(timer)) {
+        __HAL_ENABLE_INTERRUPTS(ctx);
+        return EINVAL;
     }
+    timer->expiry = tick;
+
+    rc = hal_timer_queue_insert(&bsptimer->hal_timer_q, timer);
 
     /* If this is the head, we need to set new OCMP */
-    if (timer == TAILQ_FIRST(&bsptimer->hal_timer_q)) {
+    if (rc == 0 && timer == hal_timer_queue_first(&bsptimer->hal_timer_q)) {
         nrf_timer_set_ocmp(bsptimer, timer->expiry);
     }
 
     __HAL_ENABLE_INTERRUPTS(ctx);
 
-    return 0;
+    return rc;
 }
 
 /**
@@ -908,16 +902,12 @@ hal_timer_stop(struct hal_timer *timer)
 
     __HAL_DISABLE_INTERRUPTS(ctx);
 
-    if (timer->link.tqe_prev != NULL) {
-        reset_ocmp = 0;
-        if (timer == TAILQ_FIRST(&bsptimer->hal_timer_q)) {
-            /* If first on queue, we will need to reset OCMP */
-            entry = TAILQ_NEXT(timer, link);
-            reset_ocmp = 1;
-        }
-        TAILQ_REMOVE(&bsptimer->hal_timer_q, timer, link);
-        timer->link.tqe_prev = NULL;
+    if (hal_timer_queue_armed(timer)) {
+        /* If first on queue, we will need to reset OCMP */
+        reset_ocmp = (timer == hal_timer_queue_first(&bsptimer->hal_timer_q));
+        hal_timer_queue_remove(&bsptimer->hal_timer_q, timer);
         if (reset_ocmp) {
+            entry = hal_timer_queue_first(&bsptimer->hal_timer_q);
             if (entry) {
                 nrf_timer_set_ocmp((struct nrf52_hal_timer *)entry->bsp_timer,
                                    entry->expiry);
@@ -21,6 +21,7 @@
 
 #include "os/mynewt.h"
 #include "hal/hal_uart.h"
+#include "hal/hal_timer.h"
 #include "mcu/cmsis_nvic.h"
 #include "bsp/bsp.h"
 
@@ -35,6 +36,20 @@
 #define UARTE_ENABLE		UARTE_ENABLE_ENABLE_Enabled
 #define UARTE_DISABLE       UARTE_ENABLE_ENABLE_Disabled
 
+/* Longest transfer EasyDMA can do in one go */
+#if defined(UARTE0_EASYDMA_MAXCNT_SIZE)
+#define UARTE_MAXCNT_MAX    ((1 << UARTE0_EASYDMA_MAXCNT_SIZE) - 1)
+#else
+#define UARTE_MAXCNT_MAX    255
+#endif
+
+#if MYNEWT_VAL(UART_BLOCK_RX_BUF_SIZE)
+#if (MYNEWT_VAL(UART_BLOCK_RX_BUF_SIZE) < 4) || \
+    (MYNEWT_VAL(UART_BLOCK_RX_BUF_SIZE) > UARTE_MAXCNT_MAX)
+#error "UART_BLOCK_RX_BUF_SIZE shall be at least 4 and fit in EasyDMA MAXCNT"
+#endif
+#endif
+
 /*
  * Only one UART on NRF 52832.
  */
@@ -42,12 +57,27 @@ struct hal_uart {
     uint8_t u_open:1;
     uint8_t u_rx_stall:1;
     uint8_t u_tx_started:1;
+#if MYNEWT_VAL(UART_BLOCK_RX_BUF_SIZE)
+    uint8_t u_rx_stopped:1;
+    /* RX buffer which is being received into */
+    uint8_t u_rx_cur;
+#endif
     uint8_t u_rx_buf;
     uint8_t u_tx_buf[8];
     hal_uart_rx_char u_rx_func;
     hal_uart_tx_char u_tx_func;
     hal_uart_tx_done u_tx_done;
     void *u_func_arg;
+#if MYNEWT_VAL(UART_BLOCK_RX_BUF_SIZE)
+    hal_uart_tx_block u_tx_block;
+    hal_uart_rx_block u_rx_block;
+    NRF_UARTE_Type *u_nrf_uart;
+    struct hal_timer u_rx_idle_timer;
+    /* Data not yet consumed by user, in each RX buffer */
+    uint16_t u_rx_off[2];
+    uint16_t u_rx_len[2];
+    uint8_t u_rx_blk[2][MYNEWT_VAL(UART_BLOCK_RX_BUF_SIZE)];
+#endif
 };
 
 #if defined(NRF52840_XXAA)
@@ -85,6 +115,10 @@ hal_uart_init_cbs(int port, hal_uart_tx_char tx_func, hal_uart_tx_done tx_done,
     u->u_tx_func = tx_func;
     u->u_tx_done = tx_done;
     u->u_func_arg = arg;
+#if MYNEWT_VAL(UART_BLOCK_RX_BUF_SIZE)
+    u->u_tx_block = NULL;
+    u->u_rx_block = NULL;
+#endif
     return 0;
 }
 
@@ -104,6 +138,230 @@ hal_uart_tx_fill_buf(struct hal_uart *u)
     return i;
 }
 
+/*
+ * Starts transmission of next chunk of data, returns its length.
+ */
+static int
+hal_uart_tx_next(NRF_UARTE_Type *nrf_uart, struct hal_uart *u)
+{
+    const uint8_t *data;
+    int len;
+
+#if MYNEWT_VAL(UART_BLOCK_RX_BUF_SIZE)
+    if (u->u_tx_block) {
+        /* Transmit directly from user buffer */
+        len = u->u_tx_block(u->u_func_arg, &data, UARTE_MAXCNT_MAX);
+    } else {
+        len = hal_uart_tx_fill_buf(u);
+        data = u->u_tx_buf;
+    }
+#else
+    len = hal_uart_tx_fill_buf(u);
+    data = u->u_tx_buf;
+#endif
+
+    if (len > 0) {
+        nrf_uart->TXD.PTR = (uint32_t)data;
+        nrf_uart->TXD.MAXCNT = len;
+        nrf_uart->TASKS_STARTTX = 1;
+    }
+    return len;
+}
+
+#if MYNEWT_VAL(UART_BLOCK_RX_BUF_SIZE)
+/*
+ * Block mode RX uses two buffers: while one is received into, the other one
+ * is set up as next and reception continues there using ENDRX_STARTRX short.
+ * As there's no idle line detection in UARTE, RXDRDY event is polled using
+ * timer while data is coming and once line is idle, receiver is stopped to
+ * get data received so far.
+ */
+
+/*
+ * Passes data not yet consumed in given RX buffer to user, returns 0 if all
+ * data was consumed.
+ */
+static int
+hal_uart_rx_block_deliver(struct hal_uart *u, int idx)
+{
+    int rc;
+
+    if (u->u_rx_len[idx] == 0) {
+        return 0;
+    }
+
+    rc = u->u_rx_block(u->u_func_arg, &u->u_rx_blk[idx][u->u_rx_off[idx]],
+                       u->u_rx_len[idx]);
+    if (rc > u->u_rx_len[idx]) {
+        rc = u->u_rx_len[idx];
+    }
+    if (rc > 0) {
+        u->u_rx_off[idx] += rc;
+        u->u_rx_len[idx] -= rc;
+    }
+
+    return u->u_rx_len[idx] ? -1 : 0;
+}
+
+static void
+hal_uart_rx_block_start(NRF_UARTE_Type *nrf_uart, struct hal_uart *u)
+{
+    u->u_rx_stopped = 0;
+
+    nrf_uart->RXD.PTR = (uint32_t)u->u_rx_blk[u->u_rx_cur];
+    nrf_uart->RXD.MAXCNT = sizeof(u->u_rx_blk[0]);
+    nrf_uart->SHORTS = UARTE_SHORTS_ENDRX_STARTRX_Msk;
+
+    /* Start watching for idle line on 1st received byte */
+    nrf_uart->EVENTS_RXDRDY = 0;
+    nrf_uart->INTENSET = UARTE_INTEN_RXDRDY_Msk;
+
+    nrf_uart->TASKS_STARTRX = 1;
+}
+
+/*
+ * Called when receiver is stopped. Passes data kept due to stall to user
+ * (if any), then data left in RX FIFO and restarts reception.
+ */
+static void
+hal_uart_rx_block_resume(NRF_UARTE_Type *nrf_uart, struct hal_uart *u)
+{
+    int idx;
+
+    if (u->u_rx_stall) {
+        if (hal_uart_rx_block_deliver(u, u->u_rx_cur) ||
+            hal_uart_rx_block_deliver(u, u->u_rx_cur ^ 1)) {
+            return;
+        }
+        u->u_rx_stall = 0;
+    }
+
+    /* Up to 4 bytes can be left in RX FIFO after receiver was stopped */
+    idx = u->u_rx_cur;
+    nrf_uart->RXD.PTR = (uint32_t)u->u_rx_blk[idx];
+    nrf_uart->RXD.MAXCNT = sizeof(u->u_rx_blk[0]);
+    nrf_uart->EVENTS_ENDRX = 0;
+    nrf_uart->TASKS_FLUSHRX = 1;
+    while (nrf_uart->EVENTS_ENDRX == 0) {
+        /* Wait until FIFO is moved to RAM */
+    }
+    nrf_uart->EVENTS_ENDRX = 0;
+
+    u->u_rx_off[idx] = 0;
+    u->u_rx_len[idx] = nrf_uart->RXD.AMOUNT;
+    if (hal_uart_rx_block_deliver(u, idx)) {
+        u->u_rx_stall = 1;
+        return;
+    }
+
+    hal_uart_rx_block_start(nrf_uart, u);
+}
+
+static void
+hal_uart_rx_block_irq(NRF_UARTE_Type *nrf_uart, struct hal_uart *u)
+{
+    int idx;
+
+    if (nrf_uart->EVENTS_ENDRX) {
+        nrf_uart->EVENTS_ENDRX = 0;
+
+        idx = u->u_rx_cur;
+        u->u_rx_cur ^= 1;
+        u->u_rx_off[idx] = 0;
+        u->u_rx_len[idx] = nrf_uart->RXD.AMOUNT;
+
+        if (!u->u_rx_stall && hal_uart_rx_block_deliver(u, idx)) {
+            /*
+             * User can't take more data, stop receiver and keep data until
+             * hal_uart_start_rx() is called.
+             */
+            u->u_rx_stall = 1;
+            nrf_uart->SHORTS = 0;
+            nrf_uart->TASKS_STOPRX = 1;
+        }
+    }
+
+    if (nrf_uart->EVENTS_RXSTARTED) {
+        nrf_uart->EVENTS_RXSTARTED = 0;
+        /* Reception continues to the other buffer once this one is full */
+        nrf_uart->RXD.PTR = (uint32_t)u->u_rx_blk[u->u_rx_cur ^ 1];
+    }
+
+    if (nrf_uart->EVENTS_RXTO) {
+        nrf_uart->EVENTS_RXTO = 0;
+        u->u_rx_stopped = 1;
+        hal_uart_rx_block_resume(nrf_uart, u);
+    }
+
+    if ((nrf_uart->INTEN & UARTE_INTEN_RXDRDY_Msk) && nrf_uart->EVENTS_RXDRDY) {
+        nrf_uart->INTENCLR = UARTE_INTEN_RXDRDY_Msk;
+        nrf_uart->EVENTS_RXDRDY = 0;
+        os_cputime_timer_relative(&u->u_rx_idle_timer,
+                                  MYNEWT_VAL(UART_BLOCK_RX_IDLE_TMO_US));
+    }
+}
+
+static void
+hal_uart_rx_idle_tmo(void *arg)
+{
+    struct hal_uart *u = arg;
+    NRF_UARTE_Type *nrf_uart = u->u_nrf_uart;
+    int sr;
+
+    __HAL_DISABLE_INTERRUPTS(sr);
+    if (!u->u_rx_stopped && !u->u_rx_stall) {
+        if (nrf_uart->EVENTS_RXDRDY) {
+            /* Still receiving, check again later */
+            nrf_uart->EVENTS_RXDRDY = 0;
+            os_cputime_timer_relative(&u->u_rx_idle_timer,
+                                      MYNEWT_VAL(UART_BLOCK_RX_IDLE_TMO_US));
+        } else {
+            /*
+             * Line is idle, stop receiver to flush data received so far.
+             * This generates ENDRX and then RXTO, which restarts reception.
+             */
+            nrf_uart->SHORTS = 0;
+            nrf_uart->TASKS_STOPRX = 1;
+        }
+    }
+    __HAL_ENABLE_INTERRUPTS(sr);
+}
+#endif
+
+int
+hal_uart_init_block_cbs(int port, hal_uart_tx_block tx_func,
+  hal_uart_rx_block rx_func)
+{
+#if MYNEWT_VAL(UART_BLOCK_RX_BUF_SIZE)
+    struct hal_uart *u;
+
+#if defined(NRF52840_XXAA)
+    if (port == 0) {
+        u = &uart0;
+    } else if (port == 1) {
+        u = &uart1;
+    } else {
+        return -1;
+    }
+#else
+    if (port != 0) {
+        return -1;
+    }
+    u = &uart0;
+#endif
+
+    if (u->u_open) {
+        return -1;
+    }
+    u->u_tx_block = tx_func;
+    u->u_rx_block = rx_func;
+    os_cputime_timer_init(&u->u_rx_idle_timer, hal_uart_rx_idle_tmo, u);
+    return 0;
+#else
+    return -1;
+#endif
+}
+
 void
 hal_uart_start_tx(int port)
 {
@@ -132,12 +390,9 @@ hal_uart_start_tx(int port)
 
     __HAL_DISABLE_INTERRUPTS(sr);
     if (u->u_tx_started == 0) {
-        rc = hal_uart_tx_fill_buf(u);
+        rc = hal_uart_tx_next(nrf_uart, u);
         if (rc > 0) {
             nrf_uart->INTENSET = UARTE_INT_ENDTX;
-            nrf_uart->TXD.PTR = (uint32_t)&u->u_tx_buf;
-            nrf_uart->TXD.MAXCNT = rc;
-            nrf_uart->TASKS_STARTTX = 1;
             u->u_tx_started = 1;
         }
     }
@@ -170,6 +425,18 @@ hal_uart_start_rx(int port)
     u = &uart0;
 #endif
 
+#if MYNEWT_VAL(UART_BLOCK_RX_BUF_SIZE)
+    if (u->u_rx_block) {
+        __HAL_DISABLE_INTERRUPTS(sr);
+        /* If receiver is not stopped yet, this is done on RXTO */
+        if (u->u_rx_stall && u->u_rx_stopped) {
+            hal_uart_rx_block_resume(nrf_uart, u);
+        }
+        __HAL_ENABLE_INTERRUPTS(sr);
+        return;
+    }
+#endif
+
     if (u->u_rx_stall) {
         __HAL_DISABLE_INTERRUPTS(sr);
         rc = u->u_rx_func(u->u_func_arg, u->u_rx_buf);
@@ -239,12 +506,8 @@ uart_irq_handler(NRF_UARTE_Type *nrf_uart, struct hal_uart *u)
 
     if (nrf_uart->EVENTS_ENDTX) {
         nrf_uart->EVENTS_ENDTX = 0;
-        rc = hal_uart_tx_fill_buf(u);
-        if (rc > 0) {
-            nrf_uart->TXD.PTR = (uint32_t)&u->u_tx_buf;
-            nrf_uart->TXD.MAXCNT = rc;
-            nrf_uart->TASKS_STARTTX = 1;
-        } else {
+        rc = hal_uart_tx_next(nrf_uart, u);
+        if (rc <= 0) {
             if (u->u_tx_done) {
                 u->u_tx_done(u->u_func_arg);
             }
@@ -253,6 +516,13 @@ uart_irq_handler(NRF_UARTE_Type *nrf_uart, struct hal_uart *u)
             u->u_tx_started = 0;
         }
     }
+#if MYNEWT_VAL(UART_BLOCK_RX_BUF_SIZE)
+    if (u->u_rx_block) {
+        hal_uart_rx_block_irq(nrf_uart, u);
+        os_trace_isr_exit();
+        return;
+    }
+#endif
     if (nrf_uart->EVENTS_ENDRX) {
         nrf_uart->EVENTS_ENDRX = 0;
         rc = u->u_rx_func(u->u_func_arg, u->u_rx_buf);
@@ -443,12 +713,30 @@ hal_uart_config(int port, int32_t baudrate, uint8_t databits, uint8_t stopbits,
 
     nrf_uart->ENABLE = UARTE_ENABLE;
 
+    u->u_rx_stall = 0;
+
+#if MYNEWT_VAL(UART_BLOCK_RX_BUF_SIZE)
+    if (u->u_rx_block) {
+        u->u_nrf_uart = nrf_uart;
+        u->u_rx_cur = 0;
+        u->u_rx_len[0] = 0;
+        u->u_rx_len[1] = 0;
+        nrf_uart->INTENSET = UARTE_INT_ENDRX | UARTE_INTEN_RXSTARTED_Msk |
+                             UARTE_INTEN_RXTO_Msk;
+        hal_uart_rx_block_start(nrf_uart, u);
+    } else {
+        nrf_uart->INTENSET = UARTE_INT_ENDRX;
+        nrf_uart->RXD.PTR = (uint32_t)&u->u_rx_buf;
+        nrf_uart->RXD.MAXCNT = sizeof(u->u_rx_buf);
+        nrf_uart->TASKS_STARTRX = 1;
+    }
+#else
     nrf_uart->INTENSET = UARTE_INT_ENDRX;
     nrf_uart->RXD.PTR = (uint32_t)&u->u_rx_buf;
     nrf_uart->RXD.MAXCNT = sizeof(u->u_rx_buf);
     nrf_uart->TASKS_STARTRX = 1;
+#endif
 
-    u->u_rx_stall = 0;
     u->u_tx_started = 0;
     u->u_open = 1;
 
@@ -485,5 +773,11 @@ hal_uart_close(int port)
     }
     nrf_uart->ENABLE = 0;
     nrf_uart->INTENCLR = 0xffffffff;
+#if MYNEWT_VAL(UART_BLOCK_RX_BUF_SIZE)
+    nrf_uart->SHORTS = 0;
+    if (u->u_rx_block) {
+        os_cputime_timer_stop(&u->u_rx_idle_timer);
+    }
+#endif
     return 0;
 }
@@ -46,13 +46,16 @@ static int stm32_flash_erase_sector(const struct hal_flash *dev,
 static int stm32_flash_sector_info(const struct hal_flash *dev, int idx,
         uint32_t *address, uint32_t *sz);
 static int stm32_flash_init(const struct hal_flash *dev);
+static int stm32_flash_map(const struct hal_flash *dev, uint32_t address,
+        uint32_t num_bytes, const void **ptr);
 
 const struct hal_flash_funcs stm32_flash_funcs = {
     .hff_read = stm32_flash_read,
     .hff_write = stm32_flash_write,
     .hff_erase_sector = stm32_flash_erase_sector,
     .hff_sector_info = stm32_flash_sector_info,
-    .hff_init = stm32_flash_init
+    .hff_init = stm32_flash_init,
+    .hff_map = stm32_flash_map
 };
 
 #if !FLASH_IS_LINEAR
@@ -79,6 +82,14 @@ stm32_flash_read(const struct hal_flash *dev, uint32_t address, void *dst,
     return 0;
 }
 
+static int
+stm32_flash_map(const struct hal_flash *dev, uint32_t address,
+        uint32_t num_bytes, const void **ptr)
+{
+    *ptr = (const void *)address;
+    return 0;
+}
+
 #if FLASH_IS_LINEAR
 static int
 stm32_flash_write_linear(const struct hal_flash *dev, uint32_t address,
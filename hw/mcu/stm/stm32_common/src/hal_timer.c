@@ -17,6 +17,7 @@
  * under the License.
  */
 
+#include <errno.h>
 #include <string.h>
 #include <inttypes.h>
 #include <assert.h>
@@ -25,6 +26,7 @@
 
 #include <mcu/cmsis_nvic.h>
 #include <hal/hal_timer.h>
+#include <hal/hal_timer_queue.h>
 #include "mcu/stm32_hal.h"
 #include "stm32_common/stm32_hal.h"
 
@@ -39,7 +41,7 @@ void TIM_CCxChannelCmd(TIM_TypeDef *TIMx, uint32_t Channel, uint32_t ChannelStat
 struct stm32_hal_tmr {
     TIM_TypeDef *sht_regs;   /* Pointer to timer registers */
     uint32_t sht_oflow;      /* 16 bits of overflow to make timer 32bits */
-    TAILQ_HEAD(hal_timer_qhead, hal_timer) sht_timers;
+    struct hal_timer_queue sht_timers;
 };
 
 #if MYNEWT_VAL(TIMER_0)
@@ -73,31 +75,34 @@ static struct stm32_hal_tmr *stm32_tmr_devs[STM32_HAL_TIMER_MAX] = {
 static uint32_t hal_timer_cnt(struct stm32_hal_tmr *tmr);
 
 #if (MYNEWT_VAL(TIMER_0) || MYNEWT_VAL(TIMER_1) || MYNEWT_VAL(TIMER_2))
+static uint32_t
+stm32_tmr_now(void *arg)
+{
+    return hal_timer_cnt(arg);
+}
+
 /*
  * Call expired timer callbacks, and reprogram timer with new expiry time.
  */
 static void
 stm32_tmr_cbs(struct stm32_hal_tmr *tmr)
 {
-    uint32_t cnt;
     struct hal_timer *ht;
+    int sr;
 
-    while ((ht = TAILQ_FIRST(&tmr->sht_timers)) != NULL) {
-        cnt = hal_timer_cnt(tmr);
-        if (((int32_t)(cnt - ht->expiry)) >= 0) {
-            TAILQ_REMOVE(&tmr->sht_timers, ht, link);
-            ht->link.tqe_prev = NULL;
-            ht->cb_func(ht->cb_arg);
-        } else {
-            break;
-        }
-    }
-    ht = TAILQ_FIRST(&tmr->sht_timers);
+    __HAL_DISABLE_INTERRUPTS(sr);
+    hal_timer_queue_run(&tmr->sht_timers, stm32_tmr_now, tmr, 0);
+    ht = hal_timer_queue_first(&tmr->sht_timers);
     if (ht) {
         tmr->sht_regs->CCR1 = ht->expiry & 0xFFFFU;
+        if ((int32_t)(ht->expiry - hal_timer_cnt(tmr)) <= 0) {
+            /* Left due by HAL_TIMER_EXPIRE_MAX; come straight back. */
+            tmr->sht_regs->EGR |= TIM_EGR_CC1G;
+        }
     } else {
         tmr->sht_regs->DIER &= ~TIM_DIER_CC1IE;
     }
+    __HAL_ENABLE_INTERRUPTS(sr);
 }
 
 /*
@@ -666,7 +671,7 @@ hal_timer_set_cb(int num, struct hal_timer *timer, hal_timer_cb cb_func,
     timer->cb_func = cb_func;
     timer->cb_arg = arg;
     timer->bsp_timer = tmr;
-    timer->link.tqe_prev = NULL;
+    hal_timer_queue_timer_init(timer);
 
     return 0;
 }
@@ -707,27 +712,23 @@ int
 hal_timer_start_at(struct hal_timer *timer, uint32_t tick)
 {
     struct stm32_hal_tmr *tmr;
-    struct hal_timer *ht;
     int sr;
+    int rc;
 
     tmr = (struct stm32_hal_tmr *)timer->bsp_timer;
 
-    timer->expiry = tick;
-
     __HAL_DISABLE_INTERRUPTS(sr);
 
-    if (TAILQ_EMPTY(&tmr->sht_timers)) {
-        TAILQ_INSERT_HEAD(&tmr->sht_timers, timer, link);
-    } else {
-        TAILQ_FOREACH(ht, &tmr->sht_timers, link) {
-            if ((int32_t)(timer->expiry - ht->expiry) < 0) {
-                TAILQ_INSERT_BEFORE(ht, timer, link);
-                break;
-            }
-        }
-        if (!ht) {
-            TAILQ_INSERT_TAIL(&tmr->sht_timers, timer, link);
-        }
+    if (hal_timer_queue_armed(timer)) {
+        __HAL_ENABLE_INTERRUPTS(sr);
+        return EINVAL;
+    }
+    timer->expiry = tick;
+
+    rc = hal_timer_queue_insert(&tmr->sht_timers, timer);
+    if (rc != 0) {
+        __HAL_ENABLE_INTERRUPTS(sr);
+        return rc;
     }
 
     if ((int32_t)(tick - hal_timer_cnt(tmr)) <= 0) {
@@ -737,7 +738,7 @@ hal_timer_start_at(struct hal_timer *timer, uint32_t tick)
         tmr->sht_regs->EGR |= TIM_EGR_CC1G;
         tmr->sht_regs->DIER |= TIM_DIER_CC1IE;
     } else {
-        if (timer == TAILQ_FIRST(&tmr->sht_timers)) {
+        if (timer == hal_timer_queue_first(&tmr->sht_timers)) {
             tmr->sht_regs->CCR1 = timer->expiry & 0xFFFFU;
             tmr->sht_regs->DIER |= TIM_DIER_CC1IE;
         }
@@ -767,16 +768,12 @@ hal_timer_stop(struct hal_timer *timer)
     __HAL_DISABLE_INTERRUPTS(sr);
 
     tmr = (struct stm32_hal_tmr *)timer->bsp_timer;
-    if (timer->link.tqe_prev != NULL) {
-        reset_ocmp = 0;
-        if (timer == TAILQ_FIRST(&tmr->sht_timers)) {
-            /* If first on queue, we will need to reset OCMP */
-            ht = TAILQ_NEXT(timer, link);
-            reset_ocmp = 1;
-        }
-        TAILQ_REMOVE(&tmr->sht_timers, timer, link);
-        timer->link.tqe_prev = NULL;
+    if (hal_timer_queue_armed(timer)) {
+        /* If first on queue, we will need to reset OCMP */
+        reset_ocmp = (timer == hal_timer_queue_first(&tmr->sht_timers));
+        hal_timer_queue_remove(&tmr->sht_timers, timer);
         if (reset_ocmp) {
+            ht = hal_timer_queue_first(&tmr->sht_timers);
             if (ht) {
                 tmr->sht_regs->CCR1 = ht->expiry & 0xFFFFU;
             } else {
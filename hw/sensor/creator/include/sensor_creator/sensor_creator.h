@@ -0,0 +1,52 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef __SENSOR_CREATOR_H__
+#define __SENSOR_CREATOR_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Create and configure one of the sensors enabled in syscfg, if it has not
+ * been created yet.  With SENSOR_CREATOR_LAZY or SENSOR_CREATOR_ASYNC this
+ * is done on demand by sensor manager lookups by device name; code opening
+ * the device directly with os_dev_open() should call this first.
+ *
+ * @param devname The device name, e.g. "lis2dw12_0"
+ *
+ * @return 0 if the sensor exists, SYS_ENOENT if the creator does not know
+ *         the device, other non-zero error code if creation failed.
+ */
+int sensor_creator_create(const char *devname);
+
+/**
+ * Create and configure all sensors enabled in syscfg that have not been
+ * created yet.
+ *
+ * @return 0 on success, error code of the first failure otherwise.
+ */
+int sensor_creator_create_all(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SENSOR_CREATOR_H__ */
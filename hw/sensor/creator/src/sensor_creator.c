@@ -20,6 +20,8 @@
 #include <assert.h>
 #include <string.h>
 #include "os/mynewt.h"
+#include "sensor/sensor.h"
+#include "sensor_creator/sensor_creator.h"
 
 #if MYNEWT_VAL(DRV2605_OFB)
 #include "hal/hal_gpio.h"
@@ -1723,25 +1725,43 @@ config_icp10114_sensor(void)
 #endif
 
 /* Sensor device creation */
-void
-sensor_dev_create(void)
+struct sensor_creator_dev {
+    const char *scd_name;
+    int (*scd_create)(void);
+    uint8_t scd_state;
+};
+
+#define SENSOR_CREATOR_STATE_NONE       0
+#define SENSOR_CREATOR_STATE_CREATED    1
+#define SENSOR_CREATOR_STATE_FAILED     2
+
+#if MYNEWT_VAL(DRV2605_OFB)
+static int
+sensor_create_drv2605(void)
 {
     int rc;
 
-    (void)rc;
-#if MYNEWT_VAL(DRV2605_OFB)
     rc = hal_gpio_init_out(MYNEWT_VAL(DRV2605_EN_PIN), 1);
-    assert(rc == 0);
+    if (rc) {
+        return rc;
+    }
 
     rc = os_dev_create((struct os_dev *) &drv2605, "drv2605_0",
       OS_DEV_INIT_PRIMARY, 0, drv2605_init, (void *)&i2c_0_itf_drv);
-    assert(rc == 0);
+    if (rc) {
+        return rc;
+    }
 
-    rc = config_drv2605_actuator();
-    assert(rc == 0);
+    return config_drv2605_actuator();
+}
 #endif
 
 #if MYNEWT_VAL(LSM303DLHC_OFB)
+static int
+sensor_create_lsm303dlhc(void)
+{
+    int rc;
+
     /* Since this sensor has multiple I2C addreses,
      * 0x1E for accelerometer and 0x19 for magnetometer,
      * they are made part of the config. Not setting the address in the sensor
@@ -1750,13 +1770,20 @@ sensor_dev_create(void)
      */
     rc = os_dev_create((struct os_dev *) &lsm303dlhc, "lsm303dlhc_0",
       OS_DEV_INIT_PRIMARY, 0, lsm303dlhc_init, (void *)&i2c_0_itf_lsm);
-    assert(rc == 0);
+    if (rc) {
+        return rc;
+    }
 
-    rc = config_lsm303dlhc_sensor();
-    assert(rc == 0);
+    return config_lsm303dlhc_sensor();
+}
 #endif
 
 #if MYNEWT_VAL(LSM6DSO_OFB)
+static int
+sensor_create_lsm6dso(void)
+{
+    int rc;
+
 #if MYNEWT_VAL(BUS_DRIVER_PRESENT)
     rc = lsm6dso_create_i2c_sensor_dev(&lsm6dso.i2c_node, "lsm6dso_0",
                                        &lsm6dso_node_cfg, &lsm6dso_i2c_itf);
@@ -1764,13 +1791,20 @@ sensor_dev_create(void)
     rc = os_dev_create((struct os_dev *)&lsm6dso, "lsm6dso_0",
       OS_DEV_INIT_PRIMARY, 0, lsm6dso_init, (void *)&lsm6dso_i2c_itf);
 #endif
-    assert(rc == 0);
+    if (rc) {
+        return rc;
+    }
 
-    rc = config_lsm6dso_sensor();
-    assert(rc == 0);
+    return config_lsm6dso_sensor();
+}
 #endif
 
 #if MYNEWT_VAL(MPU6050_OFB)
+static int
+sensor_create_mpu6050(void)
+{
+    int rc;
+
 #if MYNEWT_VAL(BUS_DRIVER_PRESENT)
     rc = mpu6050_create_i2c_sensor_dev(&mpu6050.i2c_node, "mpu6050_0",
                                        &mpu6050_node_cfg, &mpu6050_i2c_itf);
@@ -1778,88 +1812,148 @@ sensor_dev_create(void)
     rc = os_dev_create((struct os_dev *) &mpu6050, "mpu6050_0",
       OS_DEV_INIT_PRIMARY, 0, mpu6050_init, (void *)&mpu6050_i2c_itf);
 #endif
-    assert(rc == 0);
+    if (rc) {
+        return rc;
+    }
 
-    rc = config_mpu6050_sensor();
-    assert(rc == 0);
+    return config_mpu6050_sensor();
+}
 #endif
 
 #if MYNEWT_VAL(BNO055_OFB)
+static int
+sensor_create_bno055(void)
+{
+    int rc;
+
 #if MYNEWT_VAL(BUS_DRIVER_PRESENT)
     rc = bno055_create_sensor_dev(&bno055, "bno055_0", &bno055_i2c_cfg,
                                   &bno055_i2c_itf);
-    assert(rc == 0);
+    if (rc) {
+        return rc;
+    }
 #else
     rc = os_dev_create((struct os_dev *) &bno055, "bno055_0",
       OS_DEV_INIT_PRIMARY, 0, bno055_init, (void *)&bno055_i2c_itf);
-    assert(rc == 0);
+    if (rc) {
+        return rc;
+    }
 #endif
 
-    rc = config_bno055_sensor();
-    assert(rc == 0);
+    return config_bno055_sensor();
+}
 #endif
 
 #if MYNEWT_VAL(TSL2561_OFB)
+static int
+sensor_create_tsl2561(void)
+{
+    int rc;
+
     rc = os_dev_create((struct os_dev *) &tsl2561, "tsl2561_0",
       OS_DEV_INIT_PRIMARY, 0, tsl2561_init, (void *)&i2c_0_itf_tsl);
-    assert(rc == 0);
+    if (rc) {
+        return rc;
+    }
 
-    rc = config_tsl2561_sensor();
-    assert(rc == 0);
+    return config_tsl2561_sensor();
+}
 #endif
 
 #if MYNEWT_VAL(TSL2591_OFB)
+static int
+sensor_create_tsl2591(void)
+{
+    int rc;
+
     rc = os_dev_create((struct os_dev *) &tsl2591, "tsl2591_0",
       OS_DEV_INIT_PRIMARY, 0, tsl2591_init, (void *)&i2c_0_itf_tsl2591);
-    assert(rc == 0);
+    if (rc) {
+        return rc;
+    }
 
-    rc = config_tsl2591_sensor();
-    assert(rc == 0);
+    return config_tsl2591_sensor();
+}
 #endif
 
 #if MYNEWT_VAL(TCS34725_OFB)
+static int
+sensor_create_tcs34725(void)
+{
+    int rc;
+
     rc = os_dev_create((struct os_dev *) &tcs34725, "tcs34725_0",
       OS_DEV_INIT_PRIMARY, 0, tcs34725_init, (void *)&i2c_0_itf_tcs);
-    assert(rc == 0);
+    if (rc) {
+        return rc;
+    }
 
-    rc = config_tcs34725_sensor();
-    assert(rc == 0);
+    return config_tcs34725_sensor();
+}
 #endif
 
 #if MYNEWT_VAL(BME280_OFB)
+static int
+sensor_create_bme280(void)
+{
+    int rc;
+
 #if MYNEWT_VAL(BUS_DRIVER_PRESENT)
     rc = bme280_create_spi_sensor_dev(&bme280.spi_node, "bme280_0",
                                       &bme280_spi_cfg, &bme280_itf);
-    assert(rc == 0);
+    if (rc) {
+        return rc;
+    }
 #else
     rc = os_dev_create((struct os_dev *) &bme280, "bme280_0",
       OS_DEV_INIT_PRIMARY, 0, bme280_init, (void *)&spi_0_itf_bme);
-    assert(rc == 0);
+    if (rc) {
+        return rc;
+    }
 #endif
 
-    rc = config_bme280_sensor();
-    assert(rc == 0);
+    return config_bme280_sensor();
+}
 #endif
 
 #if MYNEWT_VAL(MS5837_OFB)
+static int
+sensor_create_ms5837(void)
+{
+    int rc;
+
     rc = os_dev_create((struct os_dev *) &ms5837, "ms5837_0",
       OS_DEV_INIT_PRIMARY, 0, ms5837_init, (void *)&i2c_0_itf_ms37);
-    assert(rc == 0);
+    if (rc) {
+        return rc;
+    }
 
-    rc = config_ms5837_sensor();
-    assert(rc == 0);
+    return config_ms5837_sensor();
+}
 #endif
 
 #if MYNEWT_VAL(MS5840_OFB)
+static int
+sensor_create_ms5840(void)
+{
+    int rc;
+
     rc = os_dev_create((struct os_dev *) &ms5840, "ms5840_0",
       OS_DEV_INIT_PRIMARY, 0, ms5840_init, (void *)&i2c_0_itf_ms40);
-    assert(rc == 0);
+    if (rc) {
+        return rc;
+    }
 
-    rc = config_ms5840_sensor();
-    assert(rc == 0);
+    return config_ms5840_sensor();
+}
 #endif
 
 #if MYNEWT_VAL(BMP280_OFB)
+static int
+sensor_create_bmp280(void)
+{
+    int rc;
+
 #if MYNEWT_VAL(BUS_DRIVER_PRESENT)
 #if MYNEWT_VAL(BMP280_OFB_I2C_NUM) >= 0
     rc = bmp280_create_i2c_sensor_dev(&bmp280.i2c_node, "bmp280_0",
@@ -1868,40 +1962,66 @@ sensor_dev_create(void)
     rc = bmp280_create_spi_sensor_dev(&bmp280.spi_node, "bmp280_0",
                                       &bmp280_node_cfg, &bmp280_itf);
 #endif
+    if (rc) {
+        return rc;
+    }
 #else
     rc = os_dev_create((struct os_dev *) &bmp280, "bmp280_0",
       OS_DEV_INIT_PRIMARY, 0, bmp280_init, (void *)&i2c_0_itf_bmp);
-    assert(rc == 0);
+    if (rc) {
+        return rc;
+    }
 #endif
-    rc = config_bmp280_sensor();
-    assert(rc == 0);
+    return config_bmp280_sensor();
+}
 #endif
 
 #if MYNEWT_VAL(BMA253_OFB)
+static int
+sensor_create_bma253(void)
+{
+    int rc;
+
 #if MYNEWT_VAL(BUS_DRIVER_PRESENT)
     rc = bma253_create_i2c_sensor_dev(&bma253.node, "bma253_0",
                                       &bma253_i2c_cfg, &spi2c_0_itf_bma253);
-    assert(rc == 0);
+    if (rc) {
+        return rc;
+    }
 #else
     rc = os_dev_create((struct os_dev *)&bma253, "bma253_0",
       OS_DEV_INIT_PRIMARY, 0, bma253_init, &spi2c_0_itf_bma253);
-    assert(rc == 0);
+    if (rc) {
+        return rc;
+    }
 #endif
 
-    rc = config_bma253_sensor();
-    assert(rc == 0);
+    return config_bma253_sensor();
+}
 #endif
 
 #if MYNEWT_VAL(BMA2XX_OFB)
+static int
+sensor_create_bma2xx(void)
+{
+    int rc;
+
     rc = os_dev_create((struct os_dev *)&bma2xx, "bma2xx_0",
       OS_DEV_INIT_PRIMARY, 0, bma2xx_init, &spi2c_0_itf_bma2xx);
-    assert(rc == 0);
+    if (rc) {
+        return rc;
+    }
 
-    rc = config_bma2xx_sensor();
-    assert(rc == 0);
+    return config_bma2xx_sensor();
+}
 #endif
 
 #if MYNEWT_VAL(BMP388_OFB)
+static int
+sensor_create_bmp388(void)
+{
+    int rc;
+
 #if MYNEWT_VAL(BUS_DRIVER_PRESENT)
 #if MYNEWT_VAL(BMP388_OFB_I2C_NUM) >= 0
     rc = bmp388_create_i2c_sensor_dev(&bmp388.i2c_node, "bmp388_0",
@@ -1910,19 +2030,27 @@ sensor_dev_create(void)
     rc = bmp388_create_spi_sensor_dev(&bmp388.spi_node, "bmp388_0",
                                       &bmp388_node_cfg, &bmp388_itf);
 #endif
-    assert(rc == 0);
+    if (rc) {
+        return rc;
+    }
 #else
     rc = os_dev_create((struct os_dev *)&bmp388, "bmp388_0",
       OS_DEV_INIT_PRIMARY, 0, bmp388_init, &spi2c_0_itf_bmp388);
-    assert(rc == 0);
+    if (rc) {
+        return rc;
+    }
 
 #endif
-    rc = config_bmp388_sensor();
-    assert(rc == 0);
+    return config_bmp388_sensor();
+}
 #endif
 
-
 #if MYNEWT_VAL(ADXL345_OFB)
+static int
+sensor_create_adxl345(void)
+{
+    int rc;
+
 #if MYNEWT_VAL(BUS_DRIVER_PRESENT)
 #if MYNEWT_VAL(ADXL345_OFB_I2C_NUM) >= 0
     rc = adxl345_create_i2c_sensor_dev(&adxl345.i2c_node, "adxl345_0",
@@ -1935,107 +2063,388 @@ sensor_dev_create(void)
     rc = os_dev_create((struct os_dev *) &adxl345, "adxl345_0",
       OS_DEV_INIT_PRIMARY, 0, adxl345_init, (void *)&adxl_itf);
 #endif
-    assert(rc == 0);
+    if (rc) {
+        return rc;
+    }
 
-    rc = config_adxl345_sensor();
-    assert(rc == 0);
+    return config_adxl345_sensor();
+}
 #endif
 
 #if MYNEWT_VAL(LPS33HW_OFB)
+static int
+sensor_create_lps33hw(void)
+{
+    int rc;
+
     rc = os_dev_create((struct os_dev *) &lps33hw, "lps33hw_0",
       OS_DEV_INIT_PRIMARY, 0, lps33hw_init, (void *)&i2c_0_itf_lps);
-    assert(rc == 0);
+    if (rc) {
+        return rc;
+    }
 
-    rc = config_lps33hw_sensor();
-    assert(rc == 0);
+    return config_lps33hw_sensor();
+}
 #endif
 
 #if MYNEWT_VAL(LPS33THW_OFB)
+static int
+sensor_create_lps33thw(void)
+{
+    int rc;
+
     rc = os_dev_create((struct os_dev *) &lps33thw, "lps33thw_0",
       OS_DEV_INIT_PRIMARY, 0, lps33thw_init, (void *)&i2c_0_itf_lpst);
-    assert(rc == 0);
+    if (rc) {
+        return rc;
+    }
 
-    rc = config_lps33thw_sensor();
-    assert(rc == 0);
+    return config_lps33thw_sensor();
+}
 #endif
 
 #if MYNEWT_VAL(LIS2DW12_OFB)
+static int
+sensor_create_lis2dw12(void)
+{
+    int rc;
+
     rc = os_dev_create((struct os_dev *) &lis2dw12, "lis2dw12_0",
       OS_DEV_INIT_PRIMARY, 0, lis2dw12_init, (void *)&i2c_0_itf_lis2dw12);
-    assert(rc == 0);
+    if (rc) {
+        return rc;
+    }
 
-    rc = config_lis2dw12_sensor();
-    assert(rc == 0);
+    return config_lis2dw12_sensor();
+}
 #endif
 
 #if MYNEWT_VAL(LIS2DH12_OFB)
+static int
+sensor_create_lis2dh12(void)
+{
+    int rc;
+
+    (void)rc;
 #if MYNEWT_VAL(BUS_DRIVER_PRESENT)
 #if MYNEWT_VAL(LIS2DH12_OFB_I2C_NUM) >= 0
     rc = lis2dh12_create_i2c_sensor_dev(&lis2dh12.i2c_node, "lis2dh12_0",
                                         &lis2dh12_node_cfg, &lis2dh12_itf);
-    assert(rc == 0);
+    if (rc) {
+        return rc;
+    }
 #endif
 #else
     rc = os_dev_create((struct os_dev *)&lis2dh12, "lis2dh12_0",
       OS_DEV_INIT_PRIMARY, 0, lis2dh12_init, &lis2dh12_itf);
-    assert(rc == 0);
+    if (rc) {
+        return rc;
+    }
 #endif
 
-    rc = config_lis2dh12_sensor();
-    assert(rc == 0);
+    return config_lis2dh12_sensor();
+}
 #endif
 
 #if MYNEWT_VAL(LIS2DS12_OFB)
+static int
+sensor_create_lis2ds12(void)
+{
+    int rc;
+
     rc = os_dev_create((struct os_dev *) &lis2ds12, "lis2ds12_0",
       OS_DEV_INIT_PRIMARY, 0, lis2ds12_init, (void *)&i2c_0_itf_lis2ds12);
-    assert(rc == 0);
+    if (rc) {
+        return rc;
+    }
 
-    rc = config_lis2ds12_sensor();
-    assert(rc == 0);
+    return config_lis2ds12_sensor();
+}
 #endif
 
 #if MYNEWT_VAL(BME680_OFB)
+static int
+sensor_create_bme680(void)
+{
+    int rc;
+
     rc = os_dev_create((struct os_dev *) &bme680, "bme680_0",
       OS_DEV_INIT_PRIMARY, 0, bme680_init, (void *)&i2c_0_itf_bme680);
-    assert(rc == 0);
+    if (rc) {
+        return rc;
+    }
 
-    rc = config_bme680_sensor();
-    assert(rc == 0);
+    return config_bme680_sensor();
+}
 #endif
 
 #if MYNEWT_VAL(KXTJ3_OFB)
+static int
+sensor_create_kxtj3(void)
+{
+    int rc;
+
     rc = os_dev_create((struct os_dev *) &kxtj3, "kxtj3_0",
       OS_DEV_INIT_PRIMARY, 0, kxtj3_init, (void *)&i2c_0_itf_kxtj3);
-    assert(rc == 0);
+    if (rc) {
+        return rc;
+    }
 
-    rc = config_kxtj3_sensor();
-    assert(rc == 0);
+    return config_kxtj3_sensor();
+}
 #endif
 
 #if MYNEWT_VAL(DPS368_OFB)
+static int
+sensor_create_dps368(void)
+{
+    int rc;
+
     rc = os_dev_create((struct os_dev *) &dps368, "dps368_0",
       OS_DEV_INIT_PRIMARY, 0, dps368_init, (void *)&i2c_0_itf_dps368);
-    assert(rc == 0);
+    if (rc) {
+        return rc;
+    }
 
-    rc = config_dps368_sensor();
-    assert(rc == 0);
+    return config_dps368_sensor();
+}
 #endif
 
 #if MYNEWT_VAL(ICP101XX_OFB)
+static int
+sensor_create_icp101xx(void)
+{
+    int rc;
+
     rc = os_dev_create((struct os_dev *) &icp101xx, "icp101xx_0",
       OS_DEV_INIT_PRIMARY, 0, icp101xx_init, (void *)&i2c_0_itf_icp101xx);
-    assert(rc == 0);
+    if (rc) {
+        return rc;
+    }
 
-    rc = config_icp101xx_sensor();
-    assert(rc == 0);
+    return config_icp101xx_sensor();
+}
 #endif
 
 #if MYNEWT_VAL(ICP10114_OFB)
+static int
+sensor_create_icp10114(void)
+{
+    int rc;
+
     rc = os_dev_create((struct os_dev *) &icp10114, "icp10114_0",
       OS_DEV_INIT_PRIMARY, 0, icp101xx_init, (void *)&i2c_0_itf_icp10114);
-    assert(rc == 0);
+    if (rc) {
+        return rc;
+    }
 
-    rc = config_icp10114_sensor();
-    assert(rc == 0);
+    return config_icp10114_sensor();
+}
+#endif
+
+static struct sensor_creator_dev sensor_creator_devs[] = {
+#if MYNEWT_VAL(DRV2605_OFB)
+    { "drv2605_0", sensor_create_drv2605 },
+#endif
+#if MYNEWT_VAL(LSM303DLHC_OFB)
+    { "lsm303dlhc_0", sensor_create_lsm303dlhc },
+#endif
+#if MYNEWT_VAL(LSM6DSO_OFB)
+    { "lsm6dso_0", sensor_create_lsm6dso },
+#endif
+#if MYNEWT_VAL(MPU6050_OFB)
+    { "mpu6050_0", sensor_create_mpu6050 },
+#endif
+#if MYNEWT_VAL(BNO055_OFB)
+    { "bno055_0", sensor_create_bno055 },
+#endif
+#if MYNEWT_VAL(TSL2561_OFB)
+    { "tsl2561_0", sensor_create_tsl2561 },
+#endif
+#if MYNEWT_VAL(TSL2591_OFB)
+    { "tsl2591_0", sensor_create_tsl2591 },
+#endif
+#if MYNEWT_VAL(TCS34725_OFB)
+    { "tcs34725_0", sensor_create_tcs34725 },
+#endif
+#if MYNEWT_VAL(BME280_OFB)
+    { "bme280_0", sensor_create_bme280 },
+#endif
+#if MYNEWT_VAL(MS5837_OFB)
+    { "ms5837_0", sensor_create_ms5837 },
+#endif
+#if MYNEWT_VAL(MS5840_OFB)
+    { "ms5840_0", sensor_create_ms5840 },
+#endif
+#if MYNEWT_VAL(BMP280_OFB)
+    { "bmp280_0", sensor_create_bmp280 },
+#endif
+#if MYNEWT_VAL(BMA253_OFB)
+    { "bma253_0", sensor_create_bma253 },
+#endif
+#if MYNEWT_VAL(BMA2XX_OFB)
+    { "bma2xx_0", sensor_create_bma2xx },
+#endif
+#if MYNEWT_VAL(BMP388_OFB)
+    { "bmp388_0", sensor_create_bmp388 },
+#endif
+#if MYNEWT_VAL(ADXL345_OFB)
+    { "adxl345_0", sensor_create_adxl345 },
+#endif
+#if MYNEWT_VAL(LPS33HW_OFB)
+    { "lps33hw_0", sensor_create_lps33hw },
+#endif
+#if MYNEWT_VAL(LPS33THW_OFB)
+    { "lps33thw_0", sensor_create_lps33thw },
+#endif
+#if MYNEWT_VAL(LIS2DW12_OFB)
+    { "lis2dw12_0", sensor_create_lis2dw12 },
+#endif
+#if MYNEWT_VAL(LIS2DH12_OFB)
+    { "lis2dh12_0", sensor_create_lis2dh12 },
+#endif
+#if MYNEWT_VAL(LIS2DS12_OFB)
+    { "lis2ds12_0", sensor_create_lis2ds12 },
+#endif
+#if MYNEWT_VAL(BME680_OFB)
+    { "bme680_0", sensor_create_bme680 },
+#endif
+#if MYNEWT_VAL(KXTJ3_OFB)
+    { "kxtj3_0", sensor_create_kxtj3 },
+#endif
+#if MYNEWT_VAL(DPS368_OFB)
+    { "dps368_0", sensor_create_dps368 },
+#endif
+#if MYNEWT_VAL(ICP101XX_OFB)
+    { "icp101xx_0", sensor_create_icp101xx },
+#endif
+#if MYNEWT_VAL(ICP10114_OFB)
+    { "icp10114_0", sensor_create_icp10114 },
+#endif
+    { NULL, NULL }
+};
+
+#if MYNEWT_VAL(SENSOR_CREATOR_LAZY) || MYNEWT_VAL(SENSOR_CREATOR_ASYNC)
+static struct os_mutex sensor_creator_mtx;
+#endif
+
+#if MYNEWT_VAL(SENSOR_CREATOR_ASYNC)
+static void sensor_creator_event_cb(struct os_event *ev);
+
+static struct os_event sensor_creator_ev = {
+    .ev_cb = sensor_creator_event_cb,
+};
+#endif
+
+static void
+sensor_creator_lock(void)
+{
+#if MYNEWT_VAL(SENSOR_CREATOR_LAZY) || MYNEWT_VAL(SENSOR_CREATOR_ASYNC)
+    os_mutex_pend(&sensor_creator_mtx, OS_TIMEOUT_NEVER);
+#endif
+}
+
+static void
+sensor_creator_unlock(void)
+{
+#if MYNEWT_VAL(SENSOR_CREATOR_LAZY) || MYNEWT_VAL(SENSOR_CREATOR_ASYNC)
+    os_mutex_release(&sensor_creator_mtx);
+#endif
+}
+
+/*
+ * Creates a device once.  A device that failed is not probed again, so a
+ * missing sensor costs a single bus timeout rather than one per lookup.
+ */
+static int
+sensor_creator_create_dev(struct sensor_creator_dev *scd)
+{
+    int rc;
+
+    sensor_creator_lock();
+
+    switch (scd->scd_state) {
+    case SENSOR_CREATOR_STATE_CREATED:
+        rc = 0;
+        break;
+    case SENSOR_CREATOR_STATE_FAILED:
+        rc = SYS_ENODEV;
+        break;
+    default:
+        rc = scd->scd_create();
+        scd->scd_state = rc ? SENSOR_CREATOR_STATE_FAILED :
+                              SENSOR_CREATOR_STATE_CREATED;
+        break;
+    }
+
+    sensor_creator_unlock();
+
+    return rc;
+}
+
+int
+sensor_creator_create(const char *devname)
+{
+    struct sensor_creator_dev *scd;
+
+    for (scd = sensor_creator_devs; scd->scd_name; scd++) {
+        if (!strcmp(scd->scd_name, devname)) {
+            return sensor_creator_create_dev(scd);
+        }
+    }
+
+    return SYS_ENOENT;
+}
+
+int
+sensor_creator_create_all(void)
+{
+    struct sensor_creator_dev *scd;
+    int first_rc;
+    int rc;
+
+    first_rc = 0;
+    for (scd = sensor_creator_devs; scd->scd_name; scd++) {
+        rc = sensor_creator_create_dev(scd);
+        if (rc && !first_rc) {
+            first_rc = rc;
+        }
+    }
+
+    return first_rc;
+}
+
+#if MYNEWT_VAL(SENSOR_CREATOR_ASYNC)
+static void
+sensor_creator_event_cb(struct os_event *ev)
+{
+    (void)sensor_creator_create_all();
+}
+#endif
+
+void
+sensor_dev_create(void)
+{
+#if MYNEWT_VAL(SENSOR_CREATOR_LAZY) || MYNEWT_VAL(SENSOR_CREATOR_ASYNC)
+    int rc;
+
+    rc = os_mutex_init(&sensor_creator_mtx);
+    SYSINIT_PANIC_ASSERT(rc == 0);
+
+    sensor_mgr_set_create_func(sensor_creator_create);
+
+#if MYNEWT_VAL(SENSOR_CREATOR_ASYNC)
+    /* Probe after boot on the sensor manager task */
+    os_eventq_put(sensor_mgr_evq_get(), &sensor_creator_ev);
+#endif
+#else
+    struct sensor_creator_dev *scd;
+    int rc;
+
+    for (scd = sensor_creator_devs; scd->scd_name; scd++) {
+        rc = scd->scd_create();
+        assert(rc == 0);
+        scd->scd_state = SENSOR_CREATOR_STATE_CREATED;
+    }
 #endif
 }
@@ -41,6 +41,45 @@ struct sensor_accel_data {
     uint8_t sad_z_is_valid:1;
 } __attribute__((packed));
 
+/* Data representing a singular read from an accelerometer, in sensor
+ * counts.  The acceleration in micro MS^2 is the count times sard_scale.
+ */
+struct sensor_accel_raw_data {
+    int16_t sard_x;
+    int16_t sard_y;
+    int16_t sard_z;
+
+    /* Micro MS^2 per count */
+    int32_t sard_scale;
+
+    /* Validity */
+    uint8_t sard_x_is_valid:1;
+    uint8_t sard_y_is_valid:1;
+    uint8_t sard_z_is_valid:1;
+} __attribute__((packed));
+
+/**
+ * Convert a raw accelerometer sample to MS^2.
+ *
+ * @param sard The raw sample
+ * @param sad Filled with the sample in MS^2
+ */
+static inline void
+sensor_accel_raw_to_data(const struct sensor_accel_raw_data *sard,
+                         struct sensor_accel_data *sad)
+{
+    float scale;
+
+    scale = sard->sard_scale / 1000000.0f;
+
+    sad->sad_x = sard->sard_x * scale;
+    sad->sad_y = sard->sard_y * scale;
+    sad->sad_z = sard->sard_z * scale;
+    sad->sad_x_is_valid = sard->sard_x_is_valid;
+    sad->sad_y_is_valid = sard->sard_y_is_valid;
+    sad->sad_z_is_valid = sard->sard_z_is_valid;
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -48,6 +48,8 @@ void sensor_pkg_init(void);
 
 /* Forward declare sensor structure defined below. */
 struct sensor;
+struct sensor_oic_res;
+struct sensor_reg_shadow;
 
 typedef enum {
  /* No sensor type, used for queries */
@@ -228,6 +230,21 @@ typedef union {
 typedef int (*sensor_data_func_t)(struct sensor *, void *, void *,
              sensor_type_t);
 
+struct sensor_batch;
+
+/**
+ * Callback for handling a batch of sensor samples.
+ *
+ * @param sensor The sensor for which data is being returned
+ * @param arg The argument provided to sensor_read_batch() or the listener
+ * @param batch The samples read
+ * @param type The sensor type of the samples
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+typedef int (*sensor_batch_func_t)(struct sensor *, void *,
+             const struct sensor_batch *, sensor_type_t);
+
 /**
  * Callback for sending trigger notification.
  *
@@ -288,6 +305,19 @@ struct sensor_listener {
     /* Argument for the sensor listener */
     void *sl_arg;
 
+    /* Optional handler for batches from sensor_read_batch().  If NULL,
+     * sl_func is called for each sample of a batch.
+     */
+    sensor_batch_func_t sl_batch_func;
+
+#if MYNEWT_VAL(SENSOR_RAW_DATA)
+    /* Optional handler for samples the driver reports raw (e.g.
+     * struct sensor_accel_raw_data).  If NULL, sl_func is called with the
+     * sample converted to the type's float data structure.
+     */
+    sensor_data_func_t sl_raw_func;
+#endif
+
     /* Next item in the sensor listener list.  The head of this list is
      * contained within the sensor object.
      */
@@ -356,9 +386,23 @@ struct sensor_type_traits {
     /* function ptr for setting comparison algo */
     sensor_trigger_cmp_func_t stt_trigger_cmp_algo;
 
+#if MYNEWT_VAL(SENSOR_RAW_DATA)
+    /* Thresholds in integer micro units for raw samples, x/y/z, set from
+     * stt_low_thresh and stt_high_thresh by sensor_set_thresh()
+     */
+    int32_t stt_raw_low[3];
+    int32_t stt_raw_high[3];
+    /* Bit n set if axis n of the threshold is valid */
+    uint8_t stt_raw_low_valid;
+    uint8_t stt_raw_high_valid;
+#endif
+
 #if MYNEWT_VAL(SENSOR_OIC)
     /* Sensor OIC resource */
     oc_resource_t *stt_oic_res;
+
+    /* Recent samples served by the OIC resource */
+    struct sensor_oic_res *stt_oic_state;
 #endif
 
     struct sensor *stt_sensor;
@@ -403,6 +447,24 @@ struct sensor_notify_os_ev {
 typedef int (*sensor_read_func_t)(struct sensor *, sensor_type_t,
         sensor_data_func_t, void *, uint32_t);
 
+/**
+ * Drain samples of one sensor type from the sensor's hardware FIFO, using as
+ * few bus transactions as the sensor allows.
+ *
+ * @param sensor The sensor to read from
+ * @param type The single sensor type to read
+ * @param buf Array of the type's data structure to fill, oldest sample first
+ * @param max_count Number of samples buf can hold
+ * @param count Filled with the number of samples read
+ * @param interval_us Filled with the nominal sample interval in
+ *        microseconds, 0 if unknown
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+typedef int (*sensor_read_batch_func_t)(struct sensor *, sensor_type_t,
+        void *buf, uint16_t max_count, uint16_t *count,
+        uint32_t *interval_us);
+
 /**
  * Get the configuration of the sensor for the sensor type.  This includes
  * the value type of the sensor.
@@ -505,6 +567,7 @@ struct sensor_driver {
     sensor_unset_notification_t sd_unset_notification;
     sensor_handle_interrupt_t sd_handle_interrupt;
     sensor_reset_t sd_reset;
+    sensor_read_batch_func_t sd_read_batch;
 };
 
 struct sensor_timestamp {
@@ -513,6 +576,181 @@ struct sensor_timestamp {
     uint32_t st_cputime;
 };
 
+/**
+ * A batch of samples drained from a sensor FIFO by sensor_read_batch().
+ */
+struct sensor_batch {
+    /* Array of samples, oldest first.  Each sample is the data structure
+     * of the sensor type, e.g. struct sensor_accel_data.
+     */
+    void *sb_data;
+    /* Number of samples in sb_data */
+    uint16_t sb_count;
+    /* Nominal time between samples in microseconds, 0 if unknown */
+    uint32_t sb_interval_us;
+    /* Time of the read; the newest sample was taken just before */
+    struct sensor_timestamp sb_ts;
+};
+
+#if MYNEWT_VAL(SENSOR_RING)
+/**
+ * Callback for handling a sample from a sensor ring.
+ *
+ * @param sensor The sensor the sample was read from
+ * @param arg The ring listener's srl_arg
+ * @param data The sample, the data structure of the sensor type
+ * @param type The sensor type of the sample
+ * @param ts The time the sample was read
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+typedef int (*sensor_ring_func_t)(struct sensor *, void *, void *,
+             sensor_type_t, const struct sensor_timestamp *);
+
+/**
+ * Header of a sample in a sensor ring, followed by the sample data.
+ */
+struct sensor_ring_slot {
+    /* Index of the sample in the slot, changed before the slot is reused */
+    uint32_t srs_seq;
+    sensor_type_t srs_type;
+    struct sensor_timestamp srs_ts;
+};
+
+/**
+ * Size of one slot of a ring holding samples of up to max_data_size bytes
+ */
+#define SENSOR_RING_SLOT_SIZE(max_data_size)                            \
+    OS_ALIGN(sizeof(struct sensor_ring_slot) + (max_data_size),         \
+             sizeof(os_membuf_t))
+
+/**
+ * Number of os_membuf_t elements for the buffer of a ring of count slots
+ */
+#define SENSOR_RING_BUF_SIZE(count, max_data_size)                      \
+    ((count) * SENSOR_RING_SLOT_SIZE(max_data_size) / sizeof(os_membuf_t))
+
+/**
+ * A ring of the most recent samples of a sensor.  Samples are added by
+ * sensor_read() and read by ring listeners, each with its own cursor.
+ * There is a single writer, so no lock is taken on either side.
+ */
+struct sensor_ring {
+    /* Slot storage */
+    uint8_t *sr_buf;
+    /* Number of slots */
+    uint16_t sr_count;
+    /* Size of each slot, header included */
+    uint16_t sr_slot_size;
+    /* Number of samples ever written */
+    uint32_t sr_head;
+    /* Listeners consuming from this ring */
+    SLIST_HEAD(, sensor_ring_listener) sr_listeners;
+};
+
+/**
+ * A consumer of a sensor ring.
+ */
+struct sensor_ring_listener {
+    /* Sensor types to receive, interpreted as a mask */
+    sensor_type_t srl_sensor_type;
+
+    /* Sample handler function */
+    sensor_ring_func_t srl_func;
+
+    /* Argument for the sample handler */
+    void *srl_arg;
+
+    /* Event queue the handler runs from, NULL for the sensor manager's */
+    struct os_eventq *srl_evq;
+
+    /* Samples lost because this listener fell behind; read-only */
+    uint32_t srl_drops;
+
+    /* Managed by the sensor framework */
+    struct os_event srl_ev;
+    struct sensor *srl_sensor;
+    uint32_t srl_cursor;
+    SLIST_ENTRY(sensor_ring_listener) srl_next;
+};
+#endif
+
+#if MYNEWT_VAL(SENSOR_FILTER)
+/**
+ * Configuration of a sensor filter stage.  The blocks run in order FIR,
+ * IIR, decimation, RMS; each one is skipped when not configured.
+ */
+struct sensor_filter_cfg {
+    /* Sensor type filtered: one of the three axis types, i.e.
+     * accelerometer, linear acceleration, gravity, gyroscope or magnetic
+     * field.
+     */
+    sensor_type_t sfc_type;
+
+    /* FIR coefficients b[0]..b[n-1], applied as
+     * y[n] = b[0] * x[n] + b[1] * x[n-1] + ...
+     */
+    const float *sfc_fir_coeffs;
+    uint16_t sfc_fir_taps;
+
+    /* Biquad cascade, five coefficients per stage {b0, b1, b2, a1, a2},
+     * applied in direct form I as
+     * y[n] = b0 * x[n] + b1 * x[n-1] + b2 * x[n-2] + a1 * y[n-1] + a2 * y[n-2]
+     * (the CMSIS-DSP convention: a1 and a2 have the opposite sign of the
+     * usual denominator coefficients).
+     */
+    const float *sfc_iir_coeffs;
+    uint8_t sfc_iir_stages;
+
+    /* Keep one sample out of sfc_decim, 0 or 1 to keep all */
+    uint16_t sfc_decim;
+
+    /* If non-zero, output the RMS of each axis over this many samples
+     * (after decimation) instead of the samples themselves.
+     */
+    uint16_t sfc_rms_len;
+};
+
+/**
+ * Number of floats of state for a filter with the given number of FIR taps
+ * and IIR stages.
+ */
+#define SENSOR_FILTER_STATE_SIZE(fir_taps, iir_stages)  \
+    (3 * ((fir_taps) + 4 * (iir_stages)))
+
+/**
+ * A filter stage between a sensor and some of its listeners.  The filter
+ * is itself a listener of the sensor, and calls its own listeners with the
+ * filtered, reduced stream.  Batches from sensor_read_batch() are filtered
+ * in one pass.
+ */
+struct sensor_filter {
+    struct sensor_filter_cfg sf_cfg;
+
+    /* Per axis FIR delay lines and biquad states, in the caller's buffer */
+    float *sf_fir_state;
+    float *sf_iir_state;
+    uint16_t sf_fir_pos;
+
+    /* Input samples until the next kept one */
+    uint16_t sf_decim_cnt;
+
+    /* RMS accumulators */
+    uint16_t sf_rms_cnt;
+    float sf_rms_acc[3];
+
+    /* Axes valid in all samples contributing to the next output */
+    uint8_t sf_valid;
+
+    /* Registration on the sensor, NULL when detached */
+    struct sensor *sf_sensor;
+    struct sensor_listener sf_listener;
+
+    /* Listeners of the filtered stream */
+    SLIST_HEAD(, sensor_listener) sf_listeners;
+};
+#endif
+
 struct sensor_int {
     int8_t host_pin;
     uint8_t device_pin;
@@ -551,7 +789,63 @@ struct sensor_itf {
     /* XXX We should probably remove low/high pins and replace it with those
      */
     struct sensor_int si_ints[MYNEWT_VAL(SENSOR_MAX_INTERRUPTS_PINS)];
+
+#if MYNEWT_VAL(SENSOR_REG_SHADOW)
+    /* Cache of the device's configuration registers, NULL if none */
+    struct sensor_reg_shadow *si_shadow;
+#endif
+};
+
+#if MYNEWT_VAL(SENSOR_REG_SHADOW)
+/**
+ * Reads or writes len consecutive registers starting at reg in one bus
+ * transaction, without going through the register shadow.
+ */
+typedef int (*sensor_reg_access_func_t)(struct sensor_itf *itf, uint8_t reg,
+                                       uint8_t *buf, uint8_t len);
+
+/* Maximum number of registers covered by a register shadow */
+#define SENSOR_REG_SHADOW_MAX   32
+
+/**
+ * Copy of a window of a device's registers, kept by the driver so that
+ * read-modify-write of configuration registers needs no bus read, and so
+ * that a batch of configuration changes goes out as a few burst writes.
+ * Status, data and self-clearing registers are marked volatile and always
+ * accessed on the bus.
+ *
+ * The device must auto-increment the register address on multi-byte
+ * writes.  Callers serialize shadow accesses as they do bus accesses.
+ */
+struct sensor_reg_shadow {
+    /* Bus access functions of the driver */
+    sensor_reg_access_func_t srs_read;
+    sensor_reg_access_func_t srs_write;
+
+    /* First register of the window */
+    uint8_t srs_base;
+
+    /* Number of registers in the window */
+    uint8_t srs_count;
+
+    /* Most registers written in one transaction */
+    uint8_t srs_max_burst;
+
+    /* Writes are held in the shadow until sensor_reg_shadow_flush() */
+    uint8_t srs_deferred;
+
+    /* Bit n set if register srs_base + n is never cached */
+    uint32_t srs_volatile;
+
+    /* Bit n set if the cached value of register srs_base + n is known */
+    uint32_t srs_valid;
+
+    /* Bit n set if register srs_base + n still has to be written */
+    uint32_t srs_dirty;
+
+    uint8_t srs_val[SENSOR_REG_SHADOW_MAX];
 };
+#endif
 
 /*
  * Return the OS device structure corresponding to this sensor
@@ -595,6 +889,11 @@ struct sensor {
 
     /* Sensor mask */
     sensor_type_t s_mask;
+
+#if MYNEWT_VAL(SENSOR_RAW_DATA)
+    /* Types the driver reports as raw samples */
+    sensor_type_t s_raw_types;
+#endif
     /**
      * Poll rate in MS for this sensor.
      */
@@ -603,6 +902,11 @@ struct sensor {
     /* The next time at which we want to poll data from this sensor */
     os_time_t s_next_run;
 
+#if MYNEWT_VAL(SENSOR_MGR_POLL_HEAP_SIZE)
+    /* Position + 1 in the sensor manager's poll heap, 0 if not polled */
+    uint16_t s_poll_idx;
+#endif
+
     /* Sensor driver specific functions, created by the device registering the
      * sensor.
      */
@@ -634,6 +938,11 @@ struct sensor {
     /* A list of sensor thresholds that are registered */
     SLIST_HEAD(, sensor_type_traits) s_type_traits_list;
 
+#if MYNEWT_VAL(SENSOR_RING)
+    /* Ring of recent samples for ring listeners, NULL if none */
+    struct sensor_ring *s_ring;
+#endif
+
     /* The next sensor in the global sensor list. */
     SLIST_ENTRY(sensor) s_next;
 };
@@ -797,6 +1106,257 @@ int sensor_read(struct sensor *sensor, sensor_type_t type,
                 sensor_data_func_t data_func, void *arg,
                 uint32_t timeout);
 
+/**
+ * Read all samples of one sensor type buffered in the sensor's hardware
+ * FIFO and deliver them as one batch.  Listeners with an sl_batch_func get
+ * the whole batch; other listeners get one sl_func call per sample.
+ *
+ * @param sensor The sensor to read data from
+ * @param type The single sensor type to read (e.g.
+ *        SENSOR_TYPE_ACCELEROMETER)
+ * @param buf Array of the type's data structure to read samples into
+ * @param max_count Number of samples buf can hold
+ * @param batch_func The callback to call with the batch, may be NULL
+ * @param arg The argument to pass to this callback.
+ *
+ * @return 0 on success, SYS_ENOTSUP if the sensor driver cannot read
+ *         batches, other non-zero on failure.
+ */
+int sensor_read_batch(struct sensor *sensor, sensor_type_t type, void *buf,
+                      uint16_t max_count, sensor_batch_func_t batch_func,
+                      void *arg);
+
+#if MYNEWT_VAL(SENSOR_RING)
+/**
+ * Initialize a sensor ring.
+ *
+ * @param ring The ring to initialize
+ * @param buf Slot storage, SENSOR_RING_BUF_SIZE(count, max_data_size)
+ *        os_membuf_t elements
+ * @param count Number of slots
+ * @param max_data_size Size of the largest sample data structure the ring
+ *        holds, e.g. sizeof(struct sensor_accel_data).  Samples of larger
+ *        types are not queued.
+ *
+ * @return 0 on success, SYS_EINVAL on invalid arguments.
+ */
+int sensor_ring_init(struct sensor_ring *ring, os_membuf_t *buf,
+                     uint16_t count, uint16_t max_data_size);
+
+/**
+ * Attach a ring to a sensor.  From then on every sample read from the
+ * sensor is added to the ring, as long as it has listeners.
+ *
+ * @param sensor The sensor
+ * @param ring The initialized ring, NULL to detach
+ *
+ * @return 0 on success, non-zero on failure.
+ */
+int sensor_set_ring(struct sensor *sensor, struct sensor_ring *ring);
+
+/**
+ * Register a ring listener.  The listener receives the samples read after
+ * registration, from its event queue.
+ *
+ * @param sensor The sensor, with a ring attached
+ * @param srl The listener, with srl_sensor_type, srl_func, srl_arg and
+ *        srl_evq set
+ *
+ * @return 0 on success, SYS_EINVAL if the sensor has no ring.
+ */
+int sensor_register_ring_listener(struct sensor *sensor,
+                                  struct sensor_ring_listener *srl);
+
+/**
+ * Unregister a ring listener.
+ *
+ * @param sensor The sensor
+ * @param srl The listener
+ *
+ * @return 0 on success, SYS_EINVAL if the listener is not registered.
+ */
+int sensor_unregister_ring_listener(struct sensor *sensor,
+                                    struct sensor_ring_listener *srl);
+#endif
+
+#if MYNEWT_VAL(SENSOR_FILTER)
+/**
+ * Initialize a filter stage.
+ *
+ * @param sf The filter to initialize
+ * @param cfg The configuration, copied; the coefficient arrays are not
+ *        and must stay valid
+ * @param state SENSOR_FILTER_STATE_SIZE(taps, stages) floats of state, may
+ *        be NULL if neither FIR nor IIR is used
+ *
+ * @return 0 on success, SYS_EINVAL on invalid configuration.
+ */
+int sensor_filter_init(struct sensor_filter *sf,
+                       const struct sensor_filter_cfg *cfg, float *state);
+
+/**
+ * Clear the state of a filter, as if no sample had been seen.
+ *
+ * @param sf The filter
+ */
+void sensor_filter_reset(struct sensor_filter *sf);
+
+/**
+ * Start filtering the samples of a sensor.
+ *
+ * @param sensor The sensor
+ * @param sf The initialized filter, not attached to any sensor
+ *
+ * @return 0 on success, non-zero on failure.
+ */
+int sensor_filter_attach(struct sensor *sensor, struct sensor_filter *sf);
+
+/**
+ * Stop filtering the samples of a sensor.
+ *
+ * @param sf The filter
+ *
+ * @return 0 on success, non-zero on failure.
+ */
+int sensor_filter_detach(struct sensor_filter *sf);
+
+/**
+ * Register a listener of the filtered stream.  Its sl_func is called for
+ * each filtered sample, with the data structure of the filter's type.
+ *
+ * @param sf The filter
+ * @param listener The listener
+ *
+ * @return 0 on success, non-zero on failure.
+ */
+int sensor_filter_register_listener(struct sensor_filter *sf,
+                                    struct sensor_listener *listener);
+
+/**
+ * Unregister a listener of the filtered stream.
+ *
+ * @param sf The filter
+ * @param listener The listener
+ *
+ * @return 0 on success, non-zero on failure.
+ */
+int sensor_filter_unregister_listener(struct sensor_filter *sf,
+                                      struct sensor_listener *listener);
+#endif
+
+#if MYNEWT_VAL(SENSOR_REG_SHADOW)
+/**
+ * Initialize a register shadow, with nothing cached.  Attach it to the
+ * sensor's interface (si_shadow) for the sensor_reg_shadow_*() calls on
+ * that interface to use it.
+ *
+ * @param srs The register shadow
+ * @param read Function reading registers from the device
+ * @param write Function writing registers to the device
+ * @param base First register of the window
+ * @param count Number of registers in the window, at most
+ *        SENSOR_REG_SHADOW_MAX
+ * @param max_burst Most registers the write function accepts at once
+ * @param volatile_mask Bit n set if register base + n must not be cached
+ *
+ * @return 0 on success, SYS_EINVAL on invalid arguments.
+ */
+int sensor_reg_shadow_init(struct sensor_reg_shadow *srs,
+                           sensor_reg_access_func_t read,
+                           sensor_reg_access_func_t write,
+                           uint8_t base, uint8_t count, uint8_t max_burst,
+                           uint32_t volatile_mask);
+
+/**
+ * Read all non-volatile registers of the window into the shadow, in as
+ * few bus reads as possible.
+ *
+ * @param itf The sensor interface, with a shadow attached
+ *
+ * @return 0 on success, non-zero on failure.
+ */
+int sensor_reg_shadow_load(struct sensor_itf *itf);
+
+/**
+ * Forget the cached values, e.g. after a device reset.  Pending writes
+ * are dropped.
+ *
+ * @param itf The sensor interface
+ */
+void sensor_reg_shadow_invalidate(struct sensor_itf *itf);
+
+/**
+ * Read a register, from the shadow if its value is known.
+ *
+ * @param itf The sensor interface, with a shadow attached
+ * @param reg The register
+ * @param val Filled with the register value
+ *
+ * @return 0 on success, non-zero on failure.
+ */
+int sensor_reg_shadow_read(struct sensor_itf *itf, uint8_t reg,
+                           uint8_t *val);
+
+/**
+ * Write a register.  The bus write is skipped if the register is known to
+ * hold the value already, and is held until sensor_reg_shadow_flush()
+ * while writes are deferred.
+ *
+ * @param itf The sensor interface, with a shadow attached
+ * @param reg The register
+ * @param val The value to write
+ *
+ * @return 0 on success, non-zero on failure.
+ */
+int sensor_reg_shadow_write(struct sensor_itf *itf, uint8_t reg,
+                            uint8_t val);
+
+/**
+ * Change the bits in mask of a register to those of val, reading the
+ * register from the bus only if its value is not known.
+ *
+ * @param itf The sensor interface, with a shadow attached
+ * @param reg The register
+ * @param mask The bits to change
+ * @param val The new value of those bits
+ *
+ * @return 0 on success, non-zero on failure.
+ */
+int sensor_reg_shadow_modify(struct sensor_itf *itf, uint8_t reg,
+                             uint8_t mask, uint8_t val);
+
+/**
+ * Record registers written around the shadow, e.g. with a driver's own
+ * burst write.
+ *
+ * @param itf The sensor interface
+ * @param reg The first register written
+ * @param buf The values written
+ * @param len The number of registers written
+ */
+void sensor_reg_shadow_written(struct sensor_itf *itf, uint8_t reg,
+                               const uint8_t *buf, uint8_t len);
+
+/**
+ * Hold register writes in the shadow until sensor_reg_shadow_flush().
+ * Reads of held registers return the held value.
+ *
+ * @param itf The sensor interface
+ */
+void sensor_reg_shadow_defer(struct sensor_itf *itf);
+
+/**
+ * Write out the held registers, one burst per run of consecutive
+ * registers, in ascending register order, and stop deferring writes.
+ *
+ * @param itf The sensor interface
+ *
+ * @return 0 on success, non-zero on failure; registers that could not be
+ *         written stay held.
+ */
+int sensor_reg_shadow_flush(struct sensor_itf *itf);
+#endif
+
 /**
  * Set the driver functions for this sensor, along with the type of sensor
  * data available for the given sensor.
@@ -833,6 +1393,37 @@ sensor_set_type_mask(struct sensor *sensor, sensor_type_t mask)
     return (0);
 }
 
+/**
+ * Sensor types that can be reported as raw samples
+ */
+#define SENSOR_RAW_TYPES    (SENSOR_TYPE_ACCELEROMETER |                \
+                             SENSOR_TYPE_LINEAR_ACCEL |                 \
+                             SENSOR_TYPE_GRAVITY)
+
+#if MYNEWT_VAL(SENSOR_RAW_DATA)
+/**
+ * Called by a driver to tell the sensor framework which sensor types it
+ * reports as raw samples (struct sensor_accel_raw_data) to the data
+ * function of its read function.
+ *
+ * @param sensor The sensor to set the raw types for
+ * @param mask The raw types, a subset of SENSOR_RAW_TYPES
+ *
+ * @return 0 on success, SYS_EINVAL if a type cannot be reported raw
+ */
+static inline int
+sensor_set_raw_type_mask(struct sensor *sensor, sensor_type_t mask)
+{
+    if (mask & ~SENSOR_RAW_TYPES) {
+        return (SYS_EINVAL);
+    }
+
+    sensor->s_raw_types = mask;
+
+    return (0);
+}
+#endif
+
 /**
  * Check if sensor type is supported by the sensor device
  *
@@ -973,6 +1564,19 @@ struct sensor *sensor_mgr_find_next_bytype(sensor_type_t type, struct sensor *se
 struct sensor *sensor_mgr_find_next_bydevname(const char *devname,
                                               struct sensor *prev_cursor);
 
+/* Function creating a sensor device on demand */
+typedef int (*sensor_mgr_create_func_t)(const char *devname);
+
+/**
+ * Set the function called when a lookup by device name finds no sensor.
+ * If the function returns 0, the lookup is retried.  Used to create
+ * sensor devices on first use rather than at boot.  The function is called
+ * without the sensor manager lock held.
+ *
+ * @param func The create function, or NULL to disable on-demand creation
+ */
+void sensor_mgr_set_create_func(sensor_mgr_create_func_t func);
+
 /**
  * Check if sensor type matches
  *
@@ -23,6 +23,11 @@
 TEST_SUITE(sensor_test_suite_poll)
 {
     sensor_test_case_poll_err();
+    sensor_test_case_read_batch();
+    sensor_test_case_raw();
+    sensor_test_case_ring();
+    sensor_test_case_reg_shadow();
+    sensor_test_case_filter();
 }
 
 int
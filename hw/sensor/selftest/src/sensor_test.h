@@ -25,5 +25,10 @@
 
 TEST_SUITE_DECL(sensor_test_suite_poll);
 TEST_CASE_DECL(sensor_test_case_poll_err);
+TEST_CASE_DECL(sensor_test_case_read_batch);
+TEST_CASE_DECL(sensor_test_case_raw);
+TEST_CASE_DECL(sensor_test_case_ring);
+TEST_CASE_DECL(sensor_test_case_reg_shadow);
+TEST_CASE_DECL(sensor_test_case_filter);
 
 #endif
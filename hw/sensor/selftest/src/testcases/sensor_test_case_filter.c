@@ -0,0 +1,211 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "os/mynewt.h"
+#include "sensor/sensor.h"
+#include "sensor/accel.h"
+#include "sensor_test.h"
+
+#define STCF_FIFO_SAMPLES       8
+
+/* Value of sad_x in the next sample; 0 for a constant 1 */
+static int stcf_next_x;
+static struct sensor_accel_data stcf_out[STCF_FIFO_SAMPLES];
+static int stcf_num_out;
+
+static int
+stcf_sensor_read_batch(struct sensor *sensor, sensor_type_t type, void *buf,
+                       uint16_t max_count, uint16_t *count,
+                       uint32_t *interval_us)
+{
+    struct sensor_accel_data *sad;
+    uint16_t i;
+
+    sad = buf;
+    for (i = 0; i < STCF_FIFO_SAMPLES && i < max_count; i++) {
+        memset(&sad[i], 0, sizeof sad[i]);
+        sad[i].sad_x = stcf_next_x ? stcf_next_x++ : 1;
+        sad[i].sad_y = 2;
+        sad[i].sad_z = -2;
+        sad[i].sad_x_is_valid = 1;
+        sad[i].sad_y_is_valid = 1;
+        sad[i].sad_z_is_valid = 1;
+    }
+
+    *count = i;
+    *interval_us = 1000;
+
+    return 0;
+}
+
+static int
+stcf_sensor_read(struct sensor *sensor, sensor_type_t type,
+                 sensor_data_func_t data_func, void *arg, uint32_t timeout)
+{
+    return 0;
+}
+
+static int
+stcf_listener_func(struct sensor *sensor, void *arg, void *data,
+                   sensor_type_t type)
+{
+    TEST_ASSERT(type == SENSOR_TYPE_ACCELEROMETER);
+    TEST_ASSERT_FATAL(stcf_num_out < STCF_FIFO_SAMPLES);
+    memcpy(&stcf_out[stcf_num_out++], data, sizeof stcf_out[0]);
+
+    return 0;
+}
+
+static bool
+stcf_close(float a, float b)
+{
+    float d;
+
+    d = a - b;
+    return d < 0.001f && d > -0.001f;
+}
+
+TEST_CASE_SELF(sensor_test_case_filter)
+{
+    static struct sensor_driver driver = {
+        .sd_read = stcf_sensor_read,
+        .sd_read_batch = stcf_sensor_read_batch,
+    };
+    static struct sensor_listener listener = {
+        .sl_sensor_type = SENSOR_TYPE_ACCELEROMETER,
+        .sl_func = stcf_listener_func,
+    };
+    static const float fir[2] = { 0.5f, 0.5f };
+    static const float iir[5] = { 0.5f, 0.0f, 0.0f, 0.5f, 0.0f };
+    static float state[SENSOR_FILTER_STATE_SIZE(2, 1)];
+    static struct sensor_accel_data buf[STCF_FIFO_SAMPLES];
+    struct sensor_filter_cfg cfg;
+    static struct sensor_filter sf;
+    static struct sensor sn;
+    int rc;
+
+    rc = sensor_init(&sn, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = sensor_set_driver(&sn, SENSOR_TYPE_ACCELEROMETER, &driver);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    sensor_set_type_mask(&sn, SENSOR_TYPE_ALL);
+
+    /*** Invalid configurations. */
+
+    memset(&cfg, 0, sizeof cfg);
+    cfg.sfc_type = SENSOR_TYPE_LIGHT;
+    rc = sensor_filter_init(&sf, &cfg, NULL);
+    TEST_ASSERT(rc == SYS_EINVAL);
+
+    cfg.sfc_type = SENSOR_TYPE_ACCELEROMETER | SENSOR_TYPE_GYROSCOPE;
+    rc = sensor_filter_init(&sf, &cfg, NULL);
+    TEST_ASSERT(rc == SYS_EINVAL);
+
+    cfg.sfc_type = SENSOR_TYPE_ACCELEROMETER;
+    cfg.sfc_fir_coeffs = fir;
+    cfg.sfc_fir_taps = 2;
+    rc = sensor_filter_init(&sf, &cfg, NULL);
+    TEST_ASSERT(rc == SYS_EINVAL);
+
+    /*** Moving average of two samples, decimated by two. */
+
+    cfg.sfc_decim = 2;
+    rc = sensor_filter_init(&sf, &cfg, state);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = sensor_filter_register_listener(&sf, &listener);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = sensor_filter_attach(&sn, &sf);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    stcf_next_x = 1;
+    rc = sensor_read_batch(&sn, SENSOR_TYPE_ACCELEROMETER, buf,
+                           STCF_FIFO_SAMPLES, NULL, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT_FATAL(stcf_num_out == 4);
+    TEST_ASSERT(stcf_close(stcf_out[0].sad_x, 1.5f));
+    TEST_ASSERT(stcf_close(stcf_out[1].sad_x, 3.5f));
+    TEST_ASSERT(stcf_close(stcf_out[3].sad_x, 7.5f));
+    TEST_ASSERT(stcf_close(stcf_out[3].sad_y, 2.0f));
+    TEST_ASSERT(stcf_out[3].sad_z_is_valid);
+
+    rc = sensor_filter_detach(&sf);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /* Detached: no output */
+    stcf_num_out = 0;
+    rc = sensor_read_batch(&sn, SENSOR_TYPE_ACCELEROMETER, buf,
+                           STCF_FIFO_SAMPLES, NULL, NULL);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(stcf_num_out == 0);
+
+    /*** One pole low pass on a step, one output per batch. */
+
+    memset(&cfg, 0, sizeof cfg);
+    cfg.sfc_type = SENSOR_TYPE_ACCELEROMETER;
+    cfg.sfc_iir_coeffs = iir;
+    cfg.sfc_iir_stages = 1;
+    cfg.sfc_decim = STCF_FIFO_SAMPLES;
+    rc = sensor_filter_init(&sf, &cfg, state);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = sensor_filter_register_listener(&sf, &listener);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = sensor_filter_attach(&sn, &sf);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    stcf_next_x = 0;
+    rc = sensor_read_batch(&sn, SENSOR_TYPE_ACCELEROMETER, buf,
+                           STCF_FIFO_SAMPLES, NULL, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT_FATAL(stcf_num_out == 1);
+    TEST_ASSERT(stcf_close(stcf_out[0].sad_x, 1.0f - 1.0f / 256));
+
+    rc = sensor_filter_detach(&sf);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /*** RMS over four samples. */
+
+    memset(&cfg, 0, sizeof cfg);
+    cfg.sfc_type = SENSOR_TYPE_ACCELEROMETER;
+    cfg.sfc_rms_len = 4;
+    rc = sensor_filter_init(&sf, &cfg, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = sensor_filter_register_listener(&sf, &listener);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = sensor_filter_attach(&sn, &sf);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    stcf_num_out = 0;
+    stcf_next_x = 1;
+    rc = sensor_read_batch(&sn, SENSOR_TYPE_ACCELEROMETER, buf,
+                           STCF_FIFO_SAMPLES, NULL, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT_FATAL(stcf_num_out == 2);
+    /* sqrt((1 + 4 + 9 + 16) / 4) */
+    TEST_ASSERT(stcf_close(stcf_out[0].sad_x, 2.7386f));
+    TEST_ASSERT(stcf_close(stcf_out[0].sad_y, 2.0f));
+    TEST_ASSERT(stcf_close(stcf_out[0].sad_z, 2.0f));
+
+    rc = sensor_filter_unregister_listener(&sf, &listener);
+    TEST_ASSERT(rc == 0);
+    rc = sensor_filter_detach(&sf);
+    TEST_ASSERT(rc == 0);
+}
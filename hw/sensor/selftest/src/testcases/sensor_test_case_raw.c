@@ -0,0 +1,141 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "sensor/sensor.h"
+#include "sensor/accel.h"
+#include "sensor_test.h"
+
+static int stcr_num_float;
+static int stcr_num_raw;
+static int stcr_num_user;
+
+/**
+ * Driver read function reporting one raw sample of 1000 counts at
+ * 500 micro MS^2 per count on x, with y and z invalid.
+ */
+static int
+stcr_sensor_read(struct sensor *sensor, sensor_type_t type,
+                 sensor_data_func_t data_func, void *arg, uint32_t timeout)
+{
+    struct sensor_accel_raw_data sard = {
+        .sard_x = 1000,
+        .sard_scale = 500,
+        .sard_x_is_valid = 1,
+    };
+
+    return data_func(sensor, arg, &sard, SENSOR_TYPE_ACCELEROMETER);
+}
+
+static void
+stcr_check_float(void *data)
+{
+    struct sensor_accel_data *sad;
+
+    sad = data;
+    TEST_ASSERT(sad->sad_x_is_valid);
+    TEST_ASSERT(!sad->sad_y_is_valid);
+    TEST_ASSERT(!sad->sad_z_is_valid);
+    TEST_ASSERT(sad->sad_x > 0.4999f && sad->sad_x < 0.5001f);
+}
+
+static int
+stcr_float_func(struct sensor *sensor, void *arg, void *data,
+                sensor_type_t type)
+{
+    stcr_check_float(data);
+    stcr_num_float++;
+
+    return 0;
+}
+
+static int
+stcr_raw_func(struct sensor *sensor, void *arg, void *data,
+              sensor_type_t type)
+{
+    struct sensor_accel_raw_data *sard;
+
+    sard = data;
+    TEST_ASSERT(sard->sard_x == 1000);
+    TEST_ASSERT(sard->sard_scale == 500);
+    stcr_num_raw++;
+
+    return 0;
+}
+
+static int
+stcr_user_func(struct sensor *sensor, void *arg, void *data,
+               sensor_type_t type)
+{
+    stcr_check_float(data);
+    stcr_num_user++;
+
+    return 0;
+}
+
+TEST_CASE_SELF(sensor_test_case_raw)
+{
+    static struct sensor_driver driver = {
+        .sd_read = stcr_sensor_read,
+    };
+    static struct sensor_listener float_listener = {
+        .sl_sensor_type = SENSOR_TYPE_ACCELEROMETER,
+        .sl_func = stcr_float_func,
+    };
+    static struct sensor_listener raw_listener = {
+        .sl_sensor_type = SENSOR_TYPE_ACCELEROMETER,
+        .sl_func = stcr_float_func,
+        .sl_raw_func = stcr_raw_func,
+    };
+    static struct sensor sn;
+    int rc;
+
+    rc = sensor_init(&sn, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = sensor_set_driver(&sn, SENSOR_TYPE_ACCELEROMETER, &driver);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    sensor_set_type_mask(&sn, SENSOR_TYPE_ALL);
+
+    /*** Only accelerometer types can be raw. */
+
+    rc = sensor_set_raw_type_mask(&sn, SENSOR_TYPE_LIGHT);
+    TEST_ASSERT(rc == SYS_EINVAL);
+
+    rc = sensor_set_raw_type_mask(&sn, SENSOR_TYPE_ACCELEROMETER);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = sensor_register_listener(&sn, &float_listener);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = sensor_register_listener(&sn, &raw_listener);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /***
+     * The raw listener gets the sample as is, the other listener and the
+     * read callback get it converted.
+     */
+
+    rc = sensor_read(&sn, SENSOR_TYPE_ACCELEROMETER, stcr_user_func, NULL,
+                     OS_TIMEOUT_NEVER);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(stcr_num_raw == 1);
+    TEST_ASSERT(stcr_num_float == 1);
+    TEST_ASSERT(stcr_num_user == 1);
+}
@@ -0,0 +1,159 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "sensor/sensor.h"
+#include "sensor/accel.h"
+#include "sensor_test.h"
+
+#define STCRB_FIFO_SAMPLES      5
+
+static int stcrb_num_samples;
+static int stcrb_num_batches;
+static uint16_t stcrb_batch_count;
+
+/**
+ * Batch read function.  Reports STCRB_FIFO_SAMPLES samples with sad_x set to
+ * the sample index, or fewer if the buffer is smaller.
+ */
+static int
+stcrb_sensor_read_batch(struct sensor *sensor, sensor_type_t type, void *buf,
+                        uint16_t max_count, uint16_t *count,
+                        uint32_t *interval_us)
+{
+    struct sensor_accel_data *sad;
+    uint16_t i;
+
+    sad = buf;
+    for (i = 0; i < STCRB_FIFO_SAMPLES && i < max_count; i++) {
+        memset(&sad[i], 0, sizeof sad[i]);
+        sad[i].sad_x = i;
+        sad[i].sad_x_is_valid = 1;
+    }
+
+    *count = i;
+    *interval_us = 10000;
+
+    return 0;
+}
+
+static int
+stcrb_sensor_read(struct sensor *sensor, sensor_type_t type,
+                  sensor_data_func_t data_func, void *arg, uint32_t timeout)
+{
+    return 0;
+}
+
+/**
+ * Per-sample listener; the samples must arrive oldest first.
+ */
+static int
+stcrb_listener_func(struct sensor *sensor, void *arg, void *data,
+                    sensor_type_t type)
+{
+    struct sensor_accel_data *sad;
+
+    sad = data;
+    TEST_ASSERT(type == SENSOR_TYPE_ACCELEROMETER);
+    TEST_ASSERT(sad->sad_x == stcrb_num_samples);
+    stcrb_num_samples++;
+
+    return 0;
+}
+
+static int
+stcrb_batch_func(struct sensor *sensor, void *arg,
+                 const struct sensor_batch *batch, sensor_type_t type)
+{
+    TEST_ASSERT(type == SENSOR_TYPE_ACCELEROMETER);
+    TEST_ASSERT(batch->sb_interval_us == 10000);
+    stcrb_batch_count = batch->sb_count;
+    stcrb_num_batches++;
+
+    return 0;
+}
+
+TEST_CASE_SELF(sensor_test_case_read_batch)
+{
+    static struct sensor_driver driver = {
+        .sd_read = stcrb_sensor_read,
+        .sd_read_batch = stcrb_sensor_read_batch,
+    };
+    static struct sensor_driver driver_nobatch = {
+        .sd_read = stcrb_sensor_read,
+    };
+    static struct sensor_listener listener = {
+        .sl_sensor_type = SENSOR_TYPE_ACCELEROMETER,
+        .sl_func = stcrb_listener_func,
+    };
+    static struct sensor_accel_data buf[STCRB_FIFO_SAMPLES];
+    static struct sensor sn;
+    int rc;
+
+    rc = sensor_init(&sn, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = sensor_set_driver(&sn, SENSOR_TYPE_ACCELEROMETER, &driver);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    sensor_set_type_mask(&sn, SENSOR_TYPE_ALL);
+
+    rc = sensor_register_listener(&sn, &listener);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /*** Whole FIFO; listener gets each sample, callback the batch. */
+
+    rc = sensor_read_batch(&sn, SENSOR_TYPE_ACCELEROMETER, buf,
+                           STCRB_FIFO_SAMPLES, stcrb_batch_func, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(stcrb_num_samples == STCRB_FIFO_SAMPLES);
+    TEST_ASSERT(stcrb_num_batches == 1);
+    TEST_ASSERT(stcrb_batch_count == STCRB_FIFO_SAMPLES);
+
+    /*** Buffer smaller than the FIFO; batch is truncated. */
+
+    stcrb_num_samples = 0;
+    rc = sensor_read_batch(&sn, SENSOR_TYPE_ACCELEROMETER, buf, 2,
+                           stcrb_batch_func, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(stcrb_num_samples == 2);
+    TEST_ASSERT(stcrb_num_batches == 2);
+    TEST_ASSERT(stcrb_batch_count == 2);
+
+    /*** Invalid requests. */
+
+    rc = sensor_read_batch(&sn, SENSOR_TYPE_LIGHT, buf, STCRB_FIFO_SAMPLES,
+                           stcrb_batch_func, NULL);
+    TEST_ASSERT(rc != 0);
+
+    rc = sensor_read_batch(&sn, SENSOR_TYPE_ACCELEROMETER |
+                                SENSOR_TYPE_GYROSCOPE,
+                           buf, STCRB_FIFO_SAMPLES, stcrb_batch_func, NULL);
+    TEST_ASSERT(rc == SYS_EINVAL);
+
+    /*** Driver without batch support. */
+
+    rc = sensor_set_driver(&sn, SENSOR_TYPE_ACCELEROMETER, &driver_nobatch);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = sensor_read_batch(&sn, SENSOR_TYPE_ACCELEROMETER, buf,
+                           STCRB_FIFO_SAMPLES, stcrb_batch_func, NULL);
+    TEST_ASSERT(rc == SYS_ENOTSUP);
+    TEST_ASSERT(stcrb_num_batches == 2);
+}
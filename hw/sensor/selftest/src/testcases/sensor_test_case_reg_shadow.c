@@ -0,0 +1,140 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "os/mynewt.h"
+#include "sensor/sensor.h"
+#include "sensor_test.h"
+
+/* Window 0x20..0x27, with 0x23 a status register */
+#define STCRS_BASE          0x20
+#define STCRS_COUNT         8
+#define STCRS_STATUS        0x23
+
+static uint8_t stcrs_regs[256];
+static int stcrs_num_reads;
+static int stcrs_num_writes;
+static uint8_t stcrs_last_write_reg;
+static uint8_t stcrs_last_write_len;
+
+static int
+stcrs_read(struct sensor_itf *itf, uint8_t reg, uint8_t *buf, uint8_t len)
+{
+    memcpy(buf, &stcrs_regs[reg], len);
+    stcrs_num_reads++;
+
+    return 0;
+}
+
+static int
+stcrs_write(struct sensor_itf *itf, uint8_t reg, uint8_t *buf, uint8_t len)
+{
+    memcpy(&stcrs_regs[reg], buf, len);
+    stcrs_num_writes++;
+    stcrs_last_write_reg = reg;
+    stcrs_last_write_len = len;
+
+    return 0;
+}
+
+TEST_CASE_SELF(sensor_test_case_reg_shadow)
+{
+    struct sensor_reg_shadow srs;
+    struct sensor_itf itf;
+    uint8_t val;
+    int rc;
+    int i;
+
+    for (i = 0; i < STCRS_COUNT; i++) {
+        stcrs_regs[STCRS_BASE + i] = i;
+    }
+
+    memset(&itf, 0, sizeof(itf));
+    rc = sensor_reg_shadow_init(&srs, stcrs_read, stcrs_write, STCRS_BASE,
+                                STCRS_COUNT, 4,
+                                1UL << (STCRS_STATUS - STCRS_BASE));
+    TEST_ASSERT_FATAL(rc == 0);
+    itf.si_shadow = &srs;
+
+    /* Loading skips the status register: two reads */
+    rc = sensor_reg_shadow_load(&itf);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(stcrs_num_reads == 2);
+
+    /* Cached registers are read and modified without bus reads */
+    stcrs_num_reads = 0;
+    rc = sensor_reg_shadow_read(&itf, 0x21, &val);
+    TEST_ASSERT(rc == 0 && val == 1);
+    rc = sensor_reg_shadow_modify(&itf, 0x22, 0xf0, 0x50);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(stcrs_num_reads == 0);
+    TEST_ASSERT(stcrs_num_writes == 1);
+    TEST_ASSERT(stcrs_regs[0x22] == 0x52);
+
+    /* Writing the value a register holds is a no-op */
+    rc = sensor_reg_shadow_write(&itf, 0x22, 0x52);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(stcrs_num_writes == 1);
+
+    /* The status register always goes to the bus */
+    stcrs_regs[STCRS_STATUS] = 0xaa;
+    rc = sensor_reg_shadow_read(&itf, STCRS_STATUS, &val);
+    TEST_ASSERT(rc == 0 && val == 0xaa);
+    TEST_ASSERT(stcrs_num_reads == 1);
+
+    /* Deferred writes go out as bursts of consecutive registers */
+    stcrs_num_writes = 0;
+    sensor_reg_shadow_defer(&itf);
+    rc = sensor_reg_shadow_write(&itf, 0x24, 0x14);
+    TEST_ASSERT(rc == 0);
+    rc = sensor_reg_shadow_modify(&itf, 0x25, 0xff, 0x15);
+    TEST_ASSERT(rc == 0);
+    rc = sensor_reg_shadow_write(&itf, 0x20, 0x10);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(stcrs_num_writes == 0);
+    TEST_ASSERT(stcrs_regs[0x24] == 4);
+
+    rc = sensor_reg_shadow_read(&itf, 0x24, &val);
+    TEST_ASSERT(rc == 0 && val == 0x14);
+
+    rc = sensor_reg_shadow_flush(&itf);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(stcrs_num_writes == 2);
+    TEST_ASSERT(stcrs_last_write_reg == 0x24);
+    TEST_ASSERT(stcrs_last_write_len == 2);
+    TEST_ASSERT(stcrs_regs[0x20] == 0x10);
+    TEST_ASSERT(stcrs_regs[0x24] == 0x14);
+    TEST_ASSERT(stcrs_regs[0x25] == 0x15);
+
+    /* Writes around the shadow are recorded */
+    val = 0x77;
+    stcrs_write(&itf, 0x26, &val, 1);
+    sensor_reg_shadow_written(&itf, 0x26, &val, 1);
+    stcrs_num_reads = 0;
+    rc = sensor_reg_shadow_read(&itf, 0x26, &val);
+    TEST_ASSERT(rc == 0 && val == 0x77);
+    TEST_ASSERT(stcrs_num_reads == 0);
+
+    /* After invalidation, registers are read again */
+    stcrs_regs[0x21] = 0x99;
+    sensor_reg_shadow_invalidate(&itf);
+    rc = sensor_reg_shadow_read(&itf, 0x21, &val);
+    TEST_ASSERT(rc == 0 && val == 0x99);
+    TEST_ASSERT(stcrs_num_reads == 1);
+}
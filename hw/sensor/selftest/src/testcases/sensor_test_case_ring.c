@@ -0,0 +1,152 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "sensor/sensor.h"
+#include "sensor/accel.h"
+#include "sensor_test.h"
+
+#define STCRI_RING_COUNT        4
+
+static float stcri_next_x;
+static int stcri_num_samples;
+static float stcri_last_x;
+
+/**
+ * Sensor read function.  Reports one sample, sad_x counting up.
+ */
+static int
+stcri_sensor_read(struct sensor *sensor, sensor_type_t type,
+                  sensor_data_func_t data_func, void *arg, uint32_t timeout)
+{
+    struct sensor_accel_data sad = {
+        .sad_x = ++stcri_next_x,
+        .sad_x_is_valid = 1,
+    };
+
+    return data_func(sensor, arg, &sad, SENSOR_TYPE_ACCELEROMETER);
+}
+
+static int
+stcri_ring_func(struct sensor *sensor, void *arg, void *data,
+                sensor_type_t type, const struct sensor_timestamp *ts)
+{
+    struct sensor_accel_data *sad;
+
+    sad = data;
+    TEST_ASSERT(type == SENSOR_TYPE_ACCELEROMETER);
+    TEST_ASSERT(sad->sad_x > stcri_last_x);
+    stcri_last_x = sad->sad_x;
+    stcri_num_samples++;
+
+    return 0;
+}
+
+static void
+stcri_drain(struct os_eventq *evq)
+{
+    struct os_event *ev;
+
+    while ((ev = os_eventq_get_no_wait(evq)) != NULL) {
+        ev->ev_cb(ev);
+    }
+}
+
+static void
+stcri_read(struct sensor *sn, int cnt)
+{
+    int rc;
+
+    while (cnt--) {
+        rc = sensor_read(sn, SENSOR_TYPE_ACCELEROMETER, NULL, NULL,
+                         OS_TIMEOUT_NEVER);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+}
+
+TEST_CASE_SELF(sensor_test_case_ring)
+{
+    static struct sensor_driver driver = {
+        .sd_read = stcri_sensor_read,
+    };
+    static os_membuf_t ring_buf[
+        SENSOR_RING_BUF_SIZE(STCRI_RING_COUNT,
+                             sizeof(struct sensor_accel_data))];
+    static struct sensor_ring_listener srl = {
+        .srl_sensor_type = SENSOR_TYPE_ACCELEROMETER,
+        .srl_func = stcri_ring_func,
+    };
+    static struct sensor_ring ring;
+    static struct os_eventq evq;
+    static struct sensor sn;
+    int rc;
+
+    os_eventq_init(&evq);
+
+    rc = sensor_init(&sn, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = sensor_set_driver(&sn, SENSOR_TYPE_ACCELEROMETER, &driver);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    sensor_set_type_mask(&sn, SENSOR_TYPE_ALL);
+
+    srl.srl_evq = &evq;
+
+    /*** No ring attached. */
+
+    rc = sensor_register_ring_listener(&sn, &srl);
+    TEST_ASSERT(rc == SYS_EINVAL);
+
+    rc = sensor_ring_init(&ring, ring_buf, STCRI_RING_COUNT,
+                          sizeof(struct sensor_accel_data));
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = sensor_set_ring(&sn, &ring);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = sensor_register_ring_listener(&sn, &srl);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /*** Samples are delivered from the listener's queue, not the read. */
+
+    stcri_read(&sn, 3);
+    TEST_ASSERT(stcri_num_samples == 0);
+
+    stcri_drain(&evq);
+    TEST_ASSERT(stcri_num_samples == 3);
+    TEST_ASSERT(srl.srl_drops == 0);
+
+    /*** A listener that falls behind keeps the newest samples. */
+
+    stcri_read(&sn, STCRI_RING_COUNT + 2);
+    stcri_drain(&evq);
+    TEST_ASSERT(stcri_num_samples == 3 + STCRI_RING_COUNT);
+    TEST_ASSERT(srl.srl_drops == 2);
+    TEST_ASSERT(stcri_last_x == stcri_next_x);
+
+    /*** No delivery after unregistering. */
+
+    rc = sensor_unregister_ring_listener(&sn, &srl);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    stcri_read(&sn, 1);
+    stcri_drain(&evq);
+    TEST_ASSERT(stcri_num_samples == 3 + STCRI_RING_COUNT);
+}
@@ -63,10 +63,20 @@ struct {
     struct os_eventq *mgr_eventq;
 
     SLIST_HEAD(, sensor) mgr_sensor_list;
+
+#if MYNEWT_VAL(SENSOR_MGR_POLL_HEAP_SIZE)
+    /* Polled sensors, a min-heap on s_next_run */
+    struct sensor *mgr_poll_heap[MYNEWT_VAL(SENSOR_MGR_POLL_HEAP_SIZE)];
+    uint16_t mgr_poll_cnt;
+#endif
 } sensor_mgr;
 
 struct sensor_timestamp sensor_base_ts;
 struct os_callout st_up_osco;
+#if MYNEWT_VAL(OS_TIMESTAMP)
+/* os_timestamp64() when sensor_base_ts was taken */
+static int64_t sensor_base_ts64;
+#endif
 
 static void sensor_notify_ev_cb(struct os_event * ev);
 static void sensor_read_ev_cb(struct os_event *ev);
@@ -84,6 +94,9 @@ static struct os_event sensor_read_event = {
 static struct os_mempool sensor_notify_evt_pool;
 static os_membuf_t sensor_notify_evt_area[SENSOR_NOTIFY_EVT_MEMPOOL_SIZE];
 
+/* Creates sensors that are looked up before they exist, if set */
+static sensor_mgr_create_func_t sensor_mgr_create_func;
+
 /**
  * Lock sensor manager to access the list of sensors
  */
@@ -114,13 +127,198 @@ sensor_mgr_remove(struct sensor *sensor)
     SLIST_REMOVE(&sensor_mgr.mgr_sensor_list, sensor, sensor, s_next);
 }
 
+#if MYNEWT_VAL(SENSOR_MGR_POLL_HEAP_SIZE)
+/**
+ * Key identifying the bus a sensor sits on, for grouping polls.  Bus driver
+ * nodes don't expose their bus, so all of them count as one bus.
+ */
+static uint16_t
+sensor_itf_bus_key(const struct sensor_itf *itf)
+{
+#if MYNEWT_VAL(BUS_DRIVER_PRESENT)
+    return 0;
+#else
+    return (itf->si_type << 8) | itf->si_num;
+#endif
+}
+
+/**
+ * Heap order: earliest next run first, sensors due at the same tick grouped
+ * by bus.
+ */
+static bool
+sensor_mgr_poll_before(const struct sensor *a, const struct sensor *b)
+{
+    if (a->s_next_run != b->s_next_run) {
+        return OS_TIME_TICK_LT(a->s_next_run, b->s_next_run);
+    }
+
+    return sensor_itf_bus_key(&a->s_itf) < sensor_itf_bus_key(&b->s_itf);
+}
+
+static void
+sensor_mgr_poll_heap_set(int idx, struct sensor *sensor)
+{
+    sensor_mgr.mgr_poll_heap[idx] = sensor;
+    sensor->s_poll_idx = idx + 1;
+}
+
+static void
+sensor_mgr_poll_heap_up(int idx)
+{
+    struct sensor *sensor;
+    struct sensor *parent;
+
+    sensor = sensor_mgr.mgr_poll_heap[idx];
+    while (idx > 0) {
+        parent = sensor_mgr.mgr_poll_heap[(idx - 1) / 2];
+        if (!sensor_mgr_poll_before(sensor, parent)) {
+            break;
+        }
+        sensor_mgr_poll_heap_set(idx, parent);
+        idx = (idx - 1) / 2;
+    }
+    sensor_mgr_poll_heap_set(idx, sensor);
+}
+
+static void
+sensor_mgr_poll_heap_down(int idx)
+{
+    struct sensor *sensor;
+    struct sensor *child;
+    int cnt;
+    int c;
+
+    cnt = sensor_mgr.mgr_poll_cnt;
+    sensor = sensor_mgr.mgr_poll_heap[idx];
+    while ((c = 2 * idx + 1) < cnt) {
+        child = sensor_mgr.mgr_poll_heap[c];
+        if (c + 1 < cnt &&
+            sensor_mgr_poll_before(sensor_mgr.mgr_poll_heap[c + 1], child)) {
+            child = sensor_mgr.mgr_poll_heap[++c];
+        }
+        if (!sensor_mgr_poll_before(child, sensor)) {
+            break;
+        }
+        sensor_mgr_poll_heap_set(idx, child);
+        idx = c;
+    }
+    sensor_mgr_poll_heap_set(idx, sensor);
+}
+
+/**
+ * Restore heap order after a change of the sensor's s_next_run.
+ */
+static void
+sensor_mgr_poll_heap_update(struct sensor *sensor)
+{
+    sensor_mgr_poll_heap_up(sensor->s_poll_idx - 1);
+    sensor_mgr_poll_heap_down(sensor->s_poll_idx - 1);
+}
+
+static int
+sensor_mgr_poll_heap_insert(struct sensor *sensor)
+{
+    if (sensor_mgr.mgr_poll_cnt >= MYNEWT_VAL(SENSOR_MGR_POLL_HEAP_SIZE)) {
+        return SYS_ENOMEM;
+    }
+
+    sensor_mgr_poll_heap_set(sensor_mgr.mgr_poll_cnt++, sensor);
+    sensor_mgr_poll_heap_up(sensor->s_poll_idx - 1);
+
+    return 0;
+}
+
+static void
+sensor_mgr_poll_heap_remove(struct sensor *sensor)
+{
+    struct sensor *last;
+    int idx;
+
+    idx = sensor->s_poll_idx - 1;
+    sensor->s_poll_idx = 0;
+
+    last = sensor_mgr.mgr_poll_heap[--sensor_mgr.mgr_poll_cnt];
+    if (last != sensor) {
+        sensor_mgr_poll_heap_set(idx, last);
+        sensor_mgr_poll_heap_update(last);
+    }
+}
+
+/**
+ * Find a polled sensor with the same poll rate on the same bus, whose
+ * schedule a newly polled sensor can share.
+ */
+static struct sensor *
+sensor_mgr_poll_peer(const struct sensor *sensor)
+{
+    struct sensor *cursor;
+    int i;
+
+    for (i = 0; i < sensor_mgr.mgr_poll_cnt; i++) {
+        cursor = sensor_mgr.mgr_poll_heap[i];
+        if (cursor != sensor &&
+            cursor->s_poll_rate == sensor->s_poll_rate &&
+            sensor_itf_bus_key(&cursor->s_itf) ==
+                sensor_itf_bus_key(&sensor->s_itf)) {
+            return cursor;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Schedule a sensor whose poll rate has changed.  A newly polled sensor
+ * takes the next run of a peer with the same rate and bus, so that from
+ * then on both are read in the same manager wakeup.
+ */
+static int
+sensor_mgr_poll_sched(struct sensor *sensor, os_time_t now)
+{
+    struct sensor *peer;
+    os_time_t sensor_ticks;
+    int rc;
+
+    if (!sensor->s_poll_rate) {
+        if (sensor->s_poll_idx) {
+            sensor_mgr_poll_heap_remove(sensor);
+        }
+        return 0;
+    }
+
+    os_time_ms_to_ticks(sensor->s_poll_rate, &sensor_ticks);
+
+    peer = sensor_mgr_poll_peer(sensor);
+    if (peer != NULL) {
+        sensor->s_next_run = peer->s_next_run;
+    } else {
+        sensor->s_next_run = sensor_ticks + now;
+    }
+
+    if (sensor->s_poll_idx) {
+        sensor_mgr_poll_heap_update(sensor);
+        return 0;
+    }
+
+    rc = sensor_mgr_poll_heap_insert(sensor);
+    if (rc) {
+        /* Not scheduled, don't claim to be polled */
+        sensor->s_poll_rate = 0;
+    }
+
+    return rc;
+}
+#endif
+
 static void
 sensor_mgr_insert(struct sensor *sensor)
 {
     struct sensor *cursor, *prev;
 
     prev = cursor = NULL;
-    if (!sensor->s_poll_rate) {
+    /* With the poll heap the list is not sorted, just appended to */
+    if (!sensor->s_poll_rate || MYNEWT_VAL(SENSOR_MGR_POLL_HEAP_SIZE)) {
         SLIST_FOREACH(cursor, &sensor_mgr.mgr_sensor_list, s_next) {
             prev = cursor;
         }
@@ -337,7 +535,15 @@ sensor_find_min_nextrun_sensor(os_time_t now, os_time_t *min_nextrun)
 
     sensor_mgr_lock();
 
+#if MYNEWT_VAL(SENSOR_MGR_POLL_HEAP_SIZE)
+    if (sensor_mgr.mgr_poll_cnt == 0) {
+        sensor_mgr_unlock();
+        return NULL;
+    }
+    head = sensor_mgr.mgr_poll_heap[0];
+#else
     head = SLIST_FIRST(&sensor_mgr.mgr_sensor_list);
+#endif
 
     *min_nextrun = sensor_calc_nextrun_delta(head, now);
 
@@ -356,6 +562,10 @@ sensor_update_nextrun(struct sensor *sensor, os_time_t now)
 
     sensor_lock(sensor);
 
+#if MYNEWT_VAL(SENSOR_MGR_POLL_HEAP_SIZE)
+    sensor->s_next_run = sensor_ticks + now;
+    sensor_mgr_poll_heap_update(sensor);
+#else
     /* Remove the sensor from the sensor list for insert. */
     sensor_mgr_remove(sensor);
 
@@ -366,6 +576,7 @@ sensor_update_nextrun(struct sensor *sensor, os_time_t now)
 
     /* Re-insert the sensor manager, with the new wakeup time. */
     sensor_mgr_insert(sensor);
+#endif
 
     sensor_unlock(sensor);
 }
@@ -400,15 +611,22 @@ sensor_set_poll_rate_ms(const char *devname, uint32_t poll_rate)
 
     sensor_update_poll_rate(sensor, poll_rate);
 
+#if MYNEWT_VAL(SENSOR_MGR_POLL_HEAP_SIZE)
+    sensor_mgr_lock();
+    rc = sensor_mgr_poll_sched(sensor, now);
+    sensor_mgr_unlock();
+#else
     sensor_update_nextrun(sensor, now);
+    rc = 0;
+#endif
 
     sensor_unlock(sensor);
 
     sensor = sensor_find_min_nextrun_sensor(now, &next_wakeup);
+    if (sensor != NULL) {
+        os_callout_reset(&sensor_mgr.mgr_wakeup_callout, next_wakeup);
+    }
 
-    os_callout_reset(&sensor_mgr.mgr_wakeup_callout, next_wakeup);
-
-    return 0;
 err:
     return rc;
 }
@@ -549,6 +767,10 @@ sensor_mgr_wakeup_event(struct os_event *ev)
     while (1) {
 
         cursor = sensor_find_min_nextrun_sensor(now, &next_wakeup);
+        if (cursor == NULL) {
+            sensor_mgr_unlock();
+            return;
+        }
 
         sensor_lock(cursor);
         /* Sensors that are not periodic are inserted at the end of the sensor
@@ -622,6 +844,9 @@ sensor_base_ts_update_event(struct os_event *ev)
     sensor_base_ts.st_ostv = ostv;
     sensor_base_ts.st_ostz = ostz;
     sensor_base_ts.st_cputime = os_cputime_get32();
+#if MYNEWT_VAL(OS_TIMESTAMP)
+    sensor_base_ts64 = os_timestamp64();
+#endif
 
 done:
     os_callout_reset(&st_up_osco, ticks);
@@ -678,6 +903,9 @@ sensor_mgr_init(void)
     sensor_base_ts.st_ostv = ostv;
     sensor_base_ts.st_ostz = ostz;
     sensor_base_ts.st_cputime = os_cputime_get32();
+#if MYNEWT_VAL(OS_TIMESTAMP)
+    sensor_base_ts64 = os_timestamp64();
+#endif
 
     os_callout_init(&st_up_osco, sensor_mgr_evq_get(),
             sensor_base_ts_update_event, NULL);
@@ -784,6 +1012,13 @@ sensor_mgr_find_next_bytype(sensor_type_t type, struct sensor *prev_cursor)
                 prev_cursor));
 }
 
+#if MYNEWT_VAL(OS_DEV_HASH_SIZE)
+static int
+sensor_mgr_match_bydev(struct sensor *sensor, void *arg)
+{
+    return sensor->s_dev == arg;
+}
+#else
 static int
 sensor_mgr_match_bydevname(struct sensor *sensor, void *arg)
 {
@@ -797,6 +1032,7 @@ sensor_mgr_match_bydevname(struct sensor *sensor, void *arg)
 
     return (0);
 }
+#endif
 
 /**
  * Search the sensor thresh list for specific type of sensor
@@ -836,11 +1072,48 @@ sensor_get_type_traits_bytype(sensor_type_t type, struct sensor *sensor)
  *
  * @return 0 on success, non-zero error code on failure
  */
-struct sensor *
-sensor_mgr_find_next_bydevname(const char *devname, struct sensor *prev_cursor)
+static struct sensor *
+sensor_mgr_find_next_bydevname_nocreate(const char *devname,
+                                        struct sensor *prev_cursor)
 {
+#if MYNEWT_VAL(OS_DEV_HASH_SIZE)
+    struct os_dev *dev;
+
+    /* One hashed device lookup, then pointer compares along the list. */
+    dev = os_dev_lookup(devname);
+    if (dev == NULL) {
+        return (NULL);
+    }
+
+    return (sensor_mgr_find_next(sensor_mgr_match_bydev, dev, prev_cursor));
+#else
     return (sensor_mgr_find_next(sensor_mgr_match_bydevname, (char *)devname,
             prev_cursor));
+#endif
+}
+
+struct sensor *
+sensor_mgr_find_next_bydevname(const char *devname, struct sensor *prev_cursor)
+{
+    struct sensor *sensor;
+
+    sensor = sensor_mgr_find_next_bydevname_nocreate(devname, prev_cursor);
+
+    /* Give a deferred creator the chance to bring up the device, then look
+     * again.  Only done for a fresh lookup, not while iterating.
+     */
+    if (sensor == NULL && prev_cursor == NULL && sensor_mgr_create_func &&
+        sensor_mgr_create_func(devname) == 0) {
+        sensor = sensor_mgr_find_next_bydevname_nocreate(devname, NULL);
+    }
+
+    return (sensor);
+}
+
+void
+sensor_mgr_set_create_func(sensor_mgr_create_func_t func)
+{
+    sensor_mgr_create_func = func;
 }
 
 /**
@@ -1164,6 +1437,50 @@ done:
     return (rc);
 }
 
+#if MYNEWT_VAL(SENSOR_RAW_DATA)
+/**
+ * Deliver a raw sample.  Listeners with an sl_raw_func get it as is; the
+ * sample is converted to float once, and only if some listener or the
+ * caller of sensor_read() needs it.
+ */
+static int
+sensor_read_raw_data_func(struct sensor *sensor, struct sensor_read_ctx *ctx,
+                          void *data, sensor_type_t type)
+{
+    struct sensor_listener *listener;
+    struct sensor_accel_data sad;
+    bool converted;
+
+    converted = false;
+
+    if ((uint8_t)(uintptr_t)(ctx->user_arg) != SENSOR_IGN_LISTENER) {
+        SLIST_FOREACH(listener, &sensor->s_listener_list, sl_next) {
+            if (!(listener->sl_sensor_type & type)) {
+                continue;
+            }
+            if (listener->sl_raw_func != NULL) {
+                listener->sl_raw_func(sensor, listener->sl_arg, data, type);
+                continue;
+            }
+            if (!converted) {
+                sensor_accel_raw_to_data(data, &sad);
+                converted = true;
+            }
+            listener->sl_func(sensor, listener->sl_arg, &sad, type);
+        }
+    }
+
+    if (ctx->user_func != NULL) {
+        if (!converted) {
+            sensor_accel_raw_to_data(data, &sad);
+        }
+        return (ctx->user_func(sensor, ctx->user_arg, &sad, type));
+    }
+
+    return (0);
+}
+#endif
+
 static int
 sensor_read_data_func(struct sensor *sensor, void *arg, void *data,
                       sensor_type_t type)
@@ -1173,6 +1490,18 @@ sensor_read_data_func(struct sensor *sensor, void *arg, void *data,
 
     ctx = (struct sensor_read_ctx *) arg;
 
+#if MYNEWT_VAL(SENSOR_RING)
+    if ((uint8_t)(uintptr_t)(ctx->user_arg) != SENSOR_IGN_LISTENER) {
+        sensor_ring_put(sensor, data, type);
+    }
+#endif
+
+#if MYNEWT_VAL(SENSOR_RAW_DATA)
+    if (type & sensor->s_raw_types) {
+        return (sensor_read_raw_data_func(sensor, ctx, data, type));
+    }
+#endif
+
     if ((uint8_t)(uintptr_t)(ctx->user_arg) != SENSOR_IGN_LISTENER) {
         /* Notify all listeners first */
         SLIST_FOREACH(listener, &sensor->s_listener_list, sl_next) {
@@ -1290,6 +1619,25 @@ sensor_read_ev_cb(struct os_event *ev)
     assert(rc == 0);
 }
 
+#if MYNEWT_VAL(OS_TIMESTAMP)
+/*
+ * The base timestamp is left alone; the sensor's timestamp is the base
+ * plus the 64-bit time since it was taken, which does not wrap.
+ */
+static void
+sensor_up_timestamp(struct sensor *sensor)
+{
+    int64_t usecs;
+
+    usecs = os_timestamp64() - sensor_base_ts64 +
+            sensor_base_ts.st_ostv.tv_usec;
+
+    sensor->s_sts.st_cputime = os_cputime_get32();
+    sensor->s_sts.st_ostv.tv_sec = sensor_base_ts.st_ostv.tv_sec +
+                                   usecs / 1000000;
+    sensor->s_sts.st_ostv.tv_usec = usecs % 1000000;
+}
+#else
 static void
 sensor_up_timestamp(struct sensor *sensor)
 {
@@ -1315,6 +1663,7 @@ sensor_up_timestamp(struct sensor *sensor)
     sensor->s_sts.st_ostv.tv_usec = sensor_base_ts.st_ostv.tv_usec;
 
 }
+#endif
 
 /**
  * Get the type traits for a sensor
@@ -1938,6 +2287,130 @@ sensor_watermark_cmp(sensor_type_t type, sensor_data_t *low, sensor_data_t *high
     return trigger;
 }
 
+#if MYNEWT_VAL(SENSOR_RAW_DATA)
+/**
+ * Convert a float threshold to integer micro units.
+ *
+ * @return bit n set if axis n of the threshold is valid
+ */
+static uint8_t
+sensor_raw_thresh_from_data(const struct sensor_accel_data *sad,
+                            int32_t *raw)
+{
+    if (sad == NULL) {
+        return 0;
+    }
+
+    raw[0] = sad->sad_x * 1000000.0f;
+    raw[1] = sad->sad_y * 1000000.0f;
+    raw[2] = sad->sad_z * 1000000.0f;
+
+    return sad->sad_x_is_valid |
+           sad->sad_y_is_valid << 1 |
+           sad->sad_z_is_valid << 2;
+}
+
+/**
+ * Convert the float thresholds of a raw type to integer micro units, so
+ * that raw samples are checked without float math.
+ */
+static void
+sensor_set_raw_thresh(struct sensor_type_traits *stt)
+{
+    stt->stt_raw_low_valid =
+        sensor_raw_thresh_from_data(stt->stt_low_thresh.sad,
+                                    stt->stt_raw_low);
+    stt->stt_raw_high_valid =
+        sensor_raw_thresh_from_data(stt->stt_high_thresh.sad,
+                                    stt->stt_raw_high);
+}
+
+/**
+ * Window or watermark check of a raw sample against the integer
+ * thresholds.  Same semantics as the float checks: an axis is only
+ * compared if it is valid in both the sample and the threshold.
+ */
+static uint8_t
+sensor_raw_thresh_cmp(const struct sensor_type_traits *stt,
+                      const struct sensor_accel_raw_data *sard)
+{
+    int32_t val[3];
+    uint8_t valid;
+    uint8_t lt_high;
+    uint8_t gt_low;
+    uint8_t lt_low;
+    uint8_t gt_high;
+    uint8_t trigger;
+    int i;
+
+    val[0] = sard->sard_x * sard->sard_scale;
+    val[1] = sard->sard_y * sard->sard_scale;
+    val[2] = sard->sard_z * sard->sard_scale;
+    valid = sard->sard_x_is_valid |
+            sard->sard_y_is_valid << 1 |
+            sard->sard_z_is_valid << 2;
+
+    trigger = 0;
+    for (i = 0; i < 3; i++) {
+        if (!(valid & (1 << i))) {
+            continue;
+        }
+
+        lt_low = (stt->stt_raw_low_valid & (1 << i)) &&
+                 val[i] < stt->stt_raw_low[i];
+        gt_low = (stt->stt_raw_low_valid & (1 << i)) &&
+                 val[i] > stt->stt_raw_low[i];
+        lt_high = (stt->stt_raw_high_valid & (1 << i)) &&
+                  val[i] < stt->stt_raw_high[i];
+        gt_high = (stt->stt_raw_high_valid & (1 << i)) &&
+                  val[i] > stt->stt_raw_high[i];
+
+        if (stt->stt_algo == SENSOR_THRESH_ALGO_WINDOW) {
+            trigger |= lt_high && gt_low;
+        } else {
+            trigger |= lt_low || gt_high;
+        }
+    }
+
+    return trigger;
+}
+
+static int
+sensor_generate_trig_raw(struct sensor *sensor, void *arg, void *data,
+                         sensor_type_t type)
+{
+    struct sensor_type_traits *stt;
+    struct sensor_accel_data sad;
+    sensor_trigger_notify_func_t notify;
+    uint8_t tx_trigger;
+
+    if (!arg) {
+        return SYS_EINVAL;
+    }
+
+    notify = arg;
+    stt = sensor_get_type_traits_bytype(type, sensor);
+
+    sad = (struct sensor_accel_data) { 0 };
+    tx_trigger = 0;
+
+    if (stt->stt_algo == SENSOR_THRESH_ALGO_WINDOW ||
+        stt->stt_algo == SENSOR_THRESH_ALGO_WATERMARK) {
+        tx_trigger = sensor_raw_thresh_cmp(stt, data);
+        if (tx_trigger) {
+            sensor_accel_raw_to_data(data, &sad);
+        }
+    } else if (stt->stt_trigger_cmp_algo) {
+        /* User defined algorithms work on the float data */
+        sensor_accel_raw_to_data(data, &sad);
+        tx_trigger = stt->stt_trigger_cmp_algo(type, &stt->stt_low_thresh,
+                                               &stt->stt_high_thresh, &sad);
+    }
+
+    return tx_trigger ? notify(sensor, &sad, type) : 0;
+}
+#endif
+
 static void
 sensor_set_trigger_cmp_algo(struct sensor *sensor, struct sensor_type_traits *stt)
 {
@@ -1952,6 +2425,11 @@ sensor_set_trigger_cmp_algo(struct sensor *sensor, struct sensor_type_traits *st
         /* select user defined comparison algo if any */
         stt->stt_trigger_cmp_algo = stt->stt_trigger_cmp_algo;
     }
+#if MYNEWT_VAL(SENSOR_RAW_DATA)
+    if (stt->stt_sensor_type & SENSOR_RAW_TYPES) {
+        sensor_set_raw_thresh(stt);
+    }
+#endif
     sensor_unlock(sensor);
 }
 
@@ -2149,7 +2627,11 @@ sensor_trigger_init(struct sensor *sensor, sensor_type_t type,
     sensor_trig_lner = malloc(sizeof(struct sensor_listener));
     assert(sensor_trig_lner != NULL);
 
+    memset(sensor_trig_lner, 0, sizeof(*sensor_trig_lner));
     sensor_trig_lner->sl_func = sensor_generate_trig;
+#if MYNEWT_VAL(SENSOR_RAW_DATA)
+    sensor_trig_lner->sl_raw_func = sensor_generate_trig_raw;
+#endif
     sensor_trig_lner->sl_sensor_type = type;
     sensor_trig_lner->sl_arg = (void *)notify;
 
@@ -2207,6 +2689,116 @@ err:
     return (rc);
 }
 
+/**
+ * Size of the data structure a sensor type's samples are reported in, or 0
+ * if the type is not a single known type.
+ */
+size_t
+sensor_type_data_size(sensor_type_t type)
+{
+    switch (type) {
+    case SENSOR_TYPE_ACCELEROMETER:
+    case SENSOR_TYPE_LINEAR_ACCEL:
+    case SENSOR_TYPE_GRAVITY:
+        return sizeof(struct sensor_accel_data);
+    case SENSOR_TYPE_MAGNETIC_FIELD:
+        return sizeof(struct sensor_mag_data);
+    case SENSOR_TYPE_GYROSCOPE:
+        return sizeof(struct sensor_gyro_data);
+    case SENSOR_TYPE_LIGHT:
+        return sizeof(struct sensor_light_data);
+    case SENSOR_TYPE_TEMPERATURE:
+    case SENSOR_TYPE_AMBIENT_TEMPERATURE:
+        return sizeof(struct sensor_temp_data);
+    case SENSOR_TYPE_PRESSURE:
+        return sizeof(struct sensor_press_data);
+    case SENSOR_TYPE_RELATIVE_HUMIDITY:
+        return sizeof(struct sensor_humid_data);
+    case SENSOR_TYPE_ROTATION_VECTOR:
+        return sizeof(struct sensor_quat_data);
+    case SENSOR_TYPE_EULER:
+        return sizeof(struct sensor_euler_data);
+    case SENSOR_TYPE_COLOR:
+        return sizeof(struct sensor_color_data);
+    default:
+        return 0;
+    }
+}
+
+int
+sensor_read_batch(struct sensor *sensor, sensor_type_t type, void *buf,
+                  uint16_t max_count, sensor_batch_func_t batch_func,
+                  void *arg)
+{
+    struct sensor_listener *listener;
+    struct sensor_batch batch;
+    size_t size;
+    uint16_t i;
+    int rc;
+
+    size = sensor_type_data_size(type);
+    if (size == 0) {
+        return SYS_EINVAL;
+    }
+
+    rc = sensor_lock(sensor);
+    if (rc) {
+        goto err;
+    }
+
+    if (sensor->s_funcs->sd_read_batch == NULL) {
+        rc = SYS_ENOTSUP;
+        goto err;
+    }
+
+    if (!sensor_mgr_match_bytype(sensor, (void *)&type)) {
+        rc = SYS_ENOENT;
+        goto err;
+    }
+
+    sensor_up_timestamp(sensor);
+
+    batch.sb_data = buf;
+    batch.sb_count = 0;
+    batch.sb_interval_us = 0;
+    rc = sensor->s_funcs->sd_read_batch(sensor, type, buf, max_count,
+                                        &batch.sb_count,
+                                        &batch.sb_interval_us);
+    if (rc) {
+        if (sensor->s_err_fn != NULL) {
+            sensor->s_err_fn(sensor, sensor->s_err_arg, rc);
+        }
+        goto err;
+    }
+    batch.sb_ts = sensor->s_sts;
+
+    if (batch.sb_count == 0) {
+        goto err;
+    }
+
+    SLIST_FOREACH(listener, &sensor->s_listener_list, sl_next) {
+        if (!(listener->sl_sensor_type & type)) {
+            continue;
+        }
+        if (listener->sl_batch_func != NULL) {
+            listener->sl_batch_func(sensor, listener->sl_arg, &batch, type);
+        } else {
+            for (i = 0; i < batch.sb_count; i++) {
+                listener->sl_func(sensor, listener->sl_arg,
+                                  (uint8_t *)buf + i * size, type);
+            }
+        }
+    }
+
+    if (batch_func != NULL) {
+        rc = batch_func(sensor, arg, &batch, type);
+    }
+
+err:
+    sensor_unlock(sensor);
+    return (rc);
+}
+
 /**
  * Reset sensor
  *
@@ -2234,3 +2826,4 @@ sensor_reset(struct sensor *sensor)
     sensor_unlock(sensor);
     return rc;
 }
+
@@ -0,0 +1,381 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(SENSOR_FILTER)
+
+#if MYNEWT_VAL(MATHLIB_SUPPORT)
+#include <math.h>
+#endif
+#include "sensor/sensor.h"
+#include "sensor/accel.h"
+
+#define SENSOR_FILTER_AXES          3
+#define SENSOR_FILTER_VALID_ALL     0x07
+
+/* Three axis types; all share the layout of struct sensor_accel_data */
+#define SENSOR_FILTER_TYPES                                             \
+    (SENSOR_TYPE_ACCELEROMETER | SENSOR_TYPE_LINEAR_ACCEL |             \
+     SENSOR_TYPE_GRAVITY | SENSOR_TYPE_GYROSCOPE |                      \
+     SENSOR_TYPE_MAGNETIC_FIELD)
+
+static float
+sensor_filter_sqrtf(float x)
+{
+#if MYNEWT_VAL(MATHLIB_SUPPORT)
+    return sqrtf(x);
+#else
+    float r;
+    int i;
+
+    if (x <= 0.0f) {
+        return 0.0f;
+    }
+
+    /* Newton's method from a start above the root */
+    r = x > 1.0f ? x : 1.0f;
+    for (i = 0; i < 20; i++) {
+        r = 0.5f * (r + x / r);
+    }
+
+    return r;
+#endif
+}
+
+/*
+ * Pushes a sample into an axis' FIR delay line and, if output is set,
+ * computes the filtered value.  Outputs dropped by decimation are not
+ * computed at all.
+ */
+static float
+sensor_filter_fir(struct sensor_filter *sf, int axis, float x, bool output)
+{
+    const float *coeffs;
+    float *line;
+    uint16_t taps;
+    uint16_t idx;
+    uint16_t k;
+    float acc;
+
+    taps = sf->sf_cfg.sfc_fir_taps;
+    coeffs = sf->sf_cfg.sfc_fir_coeffs;
+    line = &sf->sf_fir_state[axis * taps];
+
+    line[sf->sf_fir_pos] = x;
+    if (!output) {
+        return 0.0f;
+    }
+
+    acc = 0.0f;
+    idx = sf->sf_fir_pos;
+    for (k = 0; k < taps; k++) {
+        acc += coeffs[k] * line[idx];
+        idx = idx ? idx - 1 : taps - 1;
+    }
+
+    return acc;
+}
+
+static float
+sensor_filter_iir(struct sensor_filter *sf, int axis, float x)
+{
+    const float *c;
+    float *st;
+    float y;
+    int i;
+
+    c = sf->sf_cfg.sfc_iir_coeffs;
+    st = &sf->sf_iir_state[axis * 4 * sf->sf_cfg.sfc_iir_stages];
+
+    /* st: x[n-1], x[n-2], y[n-1], y[n-2] of each stage */
+    for (i = 0; i < sf->sf_cfg.sfc_iir_stages; i++) {
+        y = c[0] * x + c[1] * st[0] + c[2] * st[1] + c[3] * st[2] +
+            c[4] * st[3];
+        st[1] = st[0];
+        st[0] = x;
+        st[3] = st[2];
+        st[2] = y;
+
+        x = y;
+        c += 5;
+        st += 4;
+    }
+
+    return x;
+}
+
+static void
+sensor_filter_output(struct sensor_filter *sf, struct sensor *sensor,
+                     const float *v)
+{
+    struct sensor_listener *listener;
+    struct sensor_accel_data out;
+
+    out.sad_x = v[0];
+    out.sad_y = v[1];
+    out.sad_z = v[2];
+    out.sad_x_is_valid = !!(sf->sf_valid & 0x01);
+    out.sad_y_is_valid = !!(sf->sf_valid & 0x02);
+    out.sad_z_is_valid = !!(sf->sf_valid & 0x04);
+    sf->sf_valid = SENSOR_FILTER_VALID_ALL;
+
+    SLIST_FOREACH(listener, &sf->sf_listeners, sl_next) {
+        if (listener->sl_sensor_type & sf->sf_cfg.sfc_type) {
+            listener->sl_func(sensor, listener->sl_arg, &out,
+                              sf->sf_cfg.sfc_type);
+        }
+    }
+}
+
+static void
+sensor_filter_sample(struct sensor_filter *sf, struct sensor *sensor,
+                     const struct sensor_accel_data *sad)
+{
+    float v[SENSOR_FILTER_AXES];
+    bool keep;
+    int i;
+
+    v[0] = sad->sad_x;
+    v[1] = sad->sad_y;
+    v[2] = sad->sad_z;
+    sf->sf_valid &= sad->sad_x_is_valid | (sad->sad_y_is_valid << 1) |
+                    (sad->sad_z_is_valid << 2);
+
+    if (sf->sf_decim_cnt == 0) {
+        sf->sf_decim_cnt = sf->sf_cfg.sfc_decim;
+    }
+    sf->sf_decim_cnt--;
+    keep = sf->sf_decim_cnt == 0;
+
+    for (i = 0; i < SENSOR_FILTER_AXES; i++) {
+        if (sf->sf_cfg.sfc_fir_taps) {
+            v[i] = sensor_filter_fir(sf, i, v[i],
+                                     keep || sf->sf_cfg.sfc_iir_stages);
+        }
+        if (sf->sf_cfg.sfc_iir_stages) {
+            v[i] = sensor_filter_iir(sf, i, v[i]);
+        }
+    }
+
+    if (sf->sf_cfg.sfc_fir_taps) {
+        sf->sf_fir_pos++;
+        if (sf->sf_fir_pos == sf->sf_cfg.sfc_fir_taps) {
+            sf->sf_fir_pos = 0;
+        }
+    }
+
+    if (!keep) {
+        return;
+    }
+
+    if (sf->sf_cfg.sfc_rms_len == 0) {
+        sensor_filter_output(sf, sensor, v);
+        return;
+    }
+
+    for (i = 0; i < SENSOR_FILTER_AXES; i++) {
+        sf->sf_rms_acc[i] += v[i] * v[i];
+    }
+    sf->sf_rms_cnt++;
+    if (sf->sf_rms_cnt < sf->sf_cfg.sfc_rms_len) {
+        return;
+    }
+
+    for (i = 0; i < SENSOR_FILTER_AXES; i++) {
+        v[i] = sensor_filter_sqrtf(sf->sf_rms_acc[i] / sf->sf_rms_cnt);
+        sf->sf_rms_acc[i] = 0.0f;
+    }
+    sf->sf_rms_cnt = 0;
+
+    sensor_filter_output(sf, sensor, v);
+}
+
+static int
+sensor_filter_data_func(struct sensor *sensor, void *arg, void *data,
+                        sensor_type_t type)
+{
+    sensor_filter_sample(arg, sensor, data);
+
+    return 0;
+}
+
+static int
+sensor_filter_batch_func(struct sensor *sensor, void *arg,
+                         const struct sensor_batch *batch, sensor_type_t type)
+{
+    const struct sensor_accel_data *sad;
+    uint16_t i;
+
+    sad = batch->sb_data;
+    for (i = 0; i < batch->sb_count; i++) {
+        sensor_filter_sample(arg, sensor, &sad[i]);
+    }
+
+    return 0;
+}
+
+int
+sensor_filter_init(struct sensor_filter *sf,
+                   const struct sensor_filter_cfg *cfg, float *state)
+{
+    /* Exactly one of the three axis types */
+    if (!(cfg->sfc_type & SENSOR_FILTER_TYPES) ||
+        (cfg->sfc_type & (cfg->sfc_type - 1))) {
+        return SYS_EINVAL;
+    }
+    if ((cfg->sfc_fir_taps && !cfg->sfc_fir_coeffs) ||
+        (cfg->sfc_iir_stages && !cfg->sfc_iir_coeffs)) {
+        return SYS_EINVAL;
+    }
+    if ((cfg->sfc_fir_taps || cfg->sfc_iir_stages) && !state) {
+        return SYS_EINVAL;
+    }
+
+    memset(sf, 0, sizeof(*sf));
+    sf->sf_cfg = *cfg;
+    if (sf->sf_cfg.sfc_decim == 0) {
+        sf->sf_cfg.sfc_decim = 1;
+    }
+    sf->sf_fir_state = state;
+    sf->sf_iir_state = state + SENSOR_FILTER_AXES * cfg->sfc_fir_taps;
+    SLIST_INIT(&sf->sf_listeners);
+
+    sf->sf_listener.sl_sensor_type = cfg->sfc_type;
+    sf->sf_listener.sl_func = sensor_filter_data_func;
+    sf->sf_listener.sl_batch_func = sensor_filter_batch_func;
+    sf->sf_listener.sl_arg = sf;
+
+    sensor_filter_reset(sf);
+
+    return 0;
+}
+
+void
+sensor_filter_reset(struct sensor_filter *sf)
+{
+    if (sf->sf_fir_state) {
+        memset(sf->sf_fir_state, 0,
+               SENSOR_FILTER_STATE_SIZE(sf->sf_cfg.sfc_fir_taps,
+                                        sf->sf_cfg.sfc_iir_stages) *
+               sizeof(float));
+    }
+    sf->sf_fir_pos = 0;
+    sf->sf_decim_cnt = 0;
+    sf->sf_rms_cnt = 0;
+    memset(sf->sf_rms_acc, 0, sizeof(sf->sf_rms_acc));
+    sf->sf_valid = SENSOR_FILTER_VALID_ALL;
+}
+
+int
+sensor_filter_attach(struct sensor *sensor, struct sensor_filter *sf)
+{
+    int rc;
+
+    if (sf->sf_sensor) {
+        return SYS_EALREADY;
+    }
+
+    rc = sensor_register_listener(sensor, &sf->sf_listener);
+    if (rc) {
+        return rc;
+    }
+    sf->sf_sensor = sensor;
+
+    return 0;
+}
+
+int
+sensor_filter_detach(struct sensor_filter *sf)
+{
+    int rc;
+
+    if (!sf->sf_sensor) {
+        return SYS_EINVAL;
+    }
+
+    rc = sensor_unregister_listener(sf->sf_sensor, &sf->sf_listener);
+    if (rc) {
+        return rc;
+    }
+    sf->sf_sensor = NULL;
+
+    return 0;
+}
+
+int
+sensor_filter_register_listener(struct sensor_filter *sf,
+                                struct sensor_listener *listener)
+{
+    struct sensor *sensor;
+    int rc;
+
+    /* Filtering runs with the sensor locked */
+    sensor = sf->sf_sensor;
+    if (sensor) {
+        rc = sensor_lock(sensor);
+        if (rc) {
+            return rc;
+        }
+    }
+
+    SLIST_INSERT_HEAD(&sf->sf_listeners, listener, sl_next);
+
+    if (sensor) {
+        sensor_unlock(sensor);
+    }
+
+    return 0;
+}
+
+int
+sensor_filter_unregister_listener(struct sensor_filter *sf,
+                                  struct sensor_listener *listener)
+{
+    struct sensor_listener *tmp;
+    struct sensor *sensor;
+    int rc;
+
+    sensor = sf->sf_sensor;
+    if (sensor) {
+        rc = sensor_lock(sensor);
+        if (rc) {
+            return rc;
+        }
+    }
+
+    rc = SYS_EINVAL;
+    SLIST_FOREACH(tmp, &sf->sf_listeners, sl_next) {
+        if (tmp == listener) {
+            SLIST_REMOVE(&sf->sf_listeners, listener, sensor_listener,
+                         sl_next);
+            rc = 0;
+            break;
+        }
+    }
+
+    if (sensor) {
+        sensor_unlock(sensor);
+    }
+
+    return rc;
+}
+
+#endif
@@ -37,6 +37,7 @@
 #include "sensor/pressure.h"
 #include "sensor/humidity.h"
 #include "sensor/gyro.h"
+#include "sensor_priv.h"
 
 /* OIC */
 #include <oic/oc_rep.h>
@@ -44,36 +45,94 @@
 #include <oic/oc_ri_const.h>
 #include <oic/oc_api.h>
 #include <oic/messaging/coap/observe.h>
+#include <oic/port/mynewt/adaptor.h>
 
 static const char g_s_oic_dn[] = "x.mynewt.snsr.";
 
+#define SENSOR_OIC_HIST_CNT     MYNEWT_VAL(SENSOR_OIC_HIST_CNT)
+#define SENSOR_OIC_OBS_BATCH    MYNEWT_VAL(SENSOR_OIC_OBS_BATCH)
+
+#if SENSOR_OIC_OBS_BATCH < 1 || SENSOR_OIC_OBS_BATCH > SENSOR_OIC_HIST_CNT
+#error "SENSOR_OIC_OBS_BATCH must be between 1 and SENSOR_OIC_HIST_CNT"
+#endif
+
+/* A sample kept for the OIC resource of a sensor type */
+struct sensor_oic_sample {
+    /* Time of the reading, in microseconds */
+    int64_t sos_ts;
+    uint32_t sos_cputime;
+    union {
+        struct sensor_accel_data sad;
+        struct sensor_mag_data smd;
+        struct sensor_light_data sld;
+        struct sensor_quat_data sqd;
+        struct sensor_euler_data sed;
+        struct sensor_color_data scd;
+        struct sensor_temp_data std;
+        struct sensor_press_data spd;
+        struct sensor_humid_data shd;
+        struct sensor_gyro_data sgd;
+    } sos_data;
+};
+
+/* OIC state of a sensor, shared by the resources of its types */
+struct sensor_oic_dev {
+    struct sensor *sod_sensor;
+    struct sensor_listener sod_listener;
+    /* Notifies observers of new samples, from the OIC task */
+    struct os_event sod_ev;
+    /* Poll rate to restore once the last observer is gone */
+    uint32_t sod_poll_rate;
+    uint8_t sod_observed;
+    uint8_t sod_poll_set;
+};
+
+/* OIC state of a sensor type: the most recent samples, oldest first */
+struct sensor_oic_res {
+    struct sensor_oic_dev *sor_dev;
+    sensor_type_t sor_type;
+    /* Slot the next sample goes to */
+    uint16_t sor_head;
+    /* Number of valid samples */
+    uint16_t sor_cnt;
+    /* Samples not yet sent to observers */
+    uint16_t sor_pending;
+    struct sensor_oic_sample sor_hist[SENSOR_OIC_HIST_CNT];
+};
+
+/*
+ * Encodes the fields of a sample into map; the encoder is copied to a local
+ * so the oc_rep_set_*() macros can be used on it.
+ */
 static int
-sensor_oic_encode(struct sensor* sensor, void *arg, void *databuf,
-                  sensor_type_t type)
+sensor_oic_encode_sample(CborEncoder *map, void *databuf, sensor_type_t type)
 {
+    CborEncoder sample_map;
 
     if (!databuf) {
         return SYS_EINVAL;
     }
 
+    sample_map = *map;
+
     switch(type) {
         /* Gyroscope supported */
         case SENSOR_TYPE_GYROSCOPE:
 
             if (((struct sensor_gyro_data *)(databuf))->sgd_x_is_valid) {
-                oc_rep_set_double(root, x,
+                oc_rep_set_double(sample, x,
                     ((struct sensor_gyro_data *)(databuf))->sgd_x);
             } else {
                 goto err;
             }
             if (((struct sensor_gyro_data *)(databuf))->sgd_y_is_valid) {
-                oc_rep_set_double(root, y,
+                oc_rep_set_double(sample, y,
                     ((struct sensor_gyro_data *)(databuf))->sgd_y);
             } else {
                 goto err;
             }
             if (((struct sensor_gyro_data *)(databuf))->sgd_z_is_valid) {
-                oc_rep_set_double(root, z,
+                oc_rep_set_double(sample, z,
                     ((struct sensor_gyro_data *)(databuf))->sgd_z);
             } else {
                 goto err;
@@ -88,19 +147,19 @@ sensor_oic_encode(struct sensor* sensor, void *arg, void *databuf,
         case SENSOR_TYPE_GRAVITY:
 
             if (((struct sensor_accel_data *)(databuf))->sad_x_is_valid) {
-                oc_rep_set_double(root, x,
+                oc_rep_set_double(sample, x,
                     ((struct sensor_accel_data *)(databuf))->sad_x);
             } else {
                 goto err;
             }
             if (((struct sensor_accel_data *)(databuf))->sad_y_is_valid) {
-                oc_rep_set_double(root, y,
+                oc_rep_set_double(sample, y,
                     ((struct sensor_accel_data *)(databuf))->sad_y);
             } else {
                 goto err;
             }
             if (((struct sensor_accel_data *)(databuf))->sad_z_is_valid) {
-                oc_rep_set_double(root, z,
+                oc_rep_set_double(sample, z,
                     ((struct sensor_accel_data *)(databuf))->sad_z);
             } else {
                 goto err;
@@ -110,19 +169,19 @@ sensor_oic_encode(struct sensor* sensor, void *arg, void *databuf,
         /* Magnetic field supported */
         case SENSOR_TYPE_MAGNETIC_FIELD:
             if (((struct sensor_mag_data *)(databuf))->smd_x_is_valid) {
-                oc_rep_set_double(root, x,
+                oc_rep_set_double(sample, x,
                     ((struct sensor_mag_data *)(databuf))->smd_x);
             } else {
                 goto err;
             }
             if (((struct sensor_mag_data *)(databuf))->smd_y_is_valid) {
-                oc_rep_set_double(root, y,
+                oc_rep_set_double(sample, y,
                     ((struct sensor_mag_data *)(databuf))->smd_y);
             } else {
                 goto err;
             }
             if (((struct sensor_mag_data *)(databuf))->smd_z_is_valid) {
-                oc_rep_set_double(root, z,
+                oc_rep_set_double(sample, z,
                     ((struct sensor_mag_data *)(databuf))->smd_z);
             } else {
                 goto err;
@@ -131,19 +190,19 @@ sensor_oic_encode(struct sensor* sensor, void *arg, void *databuf,
         /* Light supported */
         case SENSOR_TYPE_LIGHT:
             if (((struct sensor_light_data *)(databuf))->sld_ir_is_valid) {
-                oc_rep_set_double(root, ir,
+                oc_rep_set_double(sample, ir,
                     ((struct sensor_light_data *)(databuf))->sld_ir);
             } else {
                 goto err;
             }
             if (((struct sensor_light_data *)(databuf))->sld_full_is_valid) {
-                oc_rep_set_double(root, full,
+                oc_rep_set_double(sample, full,
                     ((struct sensor_light_data *)(databuf))->sld_full);
             } else {
                 goto err;
             }
             if (((struct sensor_light_data *)(databuf))->sld_lux_is_valid) {
-                oc_rep_set_double(root, lux,
+                oc_rep_set_double(sample, lux,
                     ((struct sensor_light_data *)(databuf))->sld_lux);
             } else {
                 goto err;
@@ -153,7 +212,7 @@ sensor_oic_encode(struct sensor* sensor, void *arg, void *databuf,
         /* Temperature supported */
         case SENSOR_TYPE_TEMPERATURE:
             if (((struct sensor_temp_data *)(databuf))->std_temp_is_valid) {
-                oc_rep_set_double(root, temp,
+                oc_rep_set_double(sample, temp,
                     ((struct sensor_temp_data *)(databuf))->std_temp);
             }
             break;
@@ -161,7 +220,7 @@ sensor_oic_encode(struct sensor* sensor, void *arg, void *databuf,
         /* Ambient temperature supported */
         case SENSOR_TYPE_AMBIENT_TEMPERATURE:
             if (((struct sensor_temp_data *)(databuf))->std_temp_is_valid) {
-                oc_rep_set_double(root, temp,
+                oc_rep_set_double(sample, temp,
                     ((struct sensor_temp_data *)(databuf))->std_temp);
             }
             break;
@@ -169,7 +228,7 @@ sensor_oic_encode(struct sensor* sensor, void *arg, void *databuf,
         /* Pressure sensor supported */
         case SENSOR_TYPE_PRESSURE:
             if (((struct sensor_press_data *)(databuf))->spd_press_is_valid) {
-                oc_rep_set_double(root, press,
+                oc_rep_set_double(sample, press,
                     ((struct sensor_press_data *)(databuf))->spd_press);
             }
             break;
@@ -177,7 +236,7 @@ sensor_oic_encode(struct sensor* sensor, void *arg, void *databuf,
         /* Relative humidity supported */
         case SENSOR_TYPE_RELATIVE_HUMIDITY:
             if (((struct sensor_humid_data *)(databuf))->shd_humid_is_valid) {
-                oc_rep_set_double(root, humid,
+                oc_rep_set_double(sample, humid,
                     ((struct sensor_humid_data *)(databuf))->shd_humid);
             }
             break;
@@ -185,25 +244,25 @@ sensor_oic_encode(struct sensor* sensor, void *arg, void *databuf,
         /* Rotation vector (quaternion) supported */
         case SENSOR_TYPE_ROTATION_VECTOR:
             if (((struct sensor_quat_data *)(databuf))->sqd_x_is_valid) {
-                oc_rep_set_double(root, x,
+                oc_rep_set_double(sample, x,
                     ((struct sensor_quat_data *)(databuf))->sqd_x);
             } else {
                 goto err;
             }
             if (((struct sensor_quat_data *)(databuf))->sqd_y_is_valid) {
-                oc_rep_set_double(root, y,
+                oc_rep_set_double(sample, y,
                     ((struct sensor_quat_data *)(databuf))->sqd_y);
             } else {
                 goto err;
             }
             if (((struct sensor_quat_data *)(databuf))->sqd_z_is_valid) {
-                oc_rep_set_double(root, z,
+                oc_rep_set_double(sample, z,
                     ((struct sensor_quat_data *)(databuf))->sqd_z);
             } else {
                 goto err;
             }
             if (((struct sensor_quat_data *)(databuf))->sqd_w_is_valid) {
-                oc_rep_set_double(root, w,
+                oc_rep_set_double(sample, w,
                     ((struct sensor_quat_data *)(databuf))->sqd_w);
             } else {
                 goto err;
@@ -213,19 +272,19 @@ sensor_oic_encode(struct sensor* sensor, void *arg, void *databuf,
         /* Euler Orientation Sensor */
         case SENSOR_TYPE_EULER:
             if (((struct sensor_euler_data *)(databuf))->sed_h_is_valid) {
-                oc_rep_set_double(root, h,
+                oc_rep_set_double(sample, h,
                     ((struct sensor_euler_data *)(databuf))->sed_h);
             } else {
                 goto err;
             }
             if (((struct sensor_euler_data *)(databuf))->sed_r_is_valid) {
-                oc_rep_set_double(root, r,
+                oc_rep_set_double(sample, r,
                     ((struct sensor_euler_data *)(databuf))->sed_r);
             } else {
                 goto err;
             }
             if (((struct sensor_euler_data *)(databuf))->sed_p_is_valid) {
-                oc_rep_set_double(root, p,
+                oc_rep_set_double(sample, p,
                     ((struct sensor_euler_data *)(databuf))->sed_p);
             } else {
                 goto err;
@@ -235,67 +294,67 @@ sensor_oic_encode(struct sensor* sensor, void *arg, void *databuf,
         /* Color Sensor */
         case SENSOR_TYPE_COLOR:
             if (((struct sensor_color_data *)(databuf))->scd_r_is_valid) {
-                oc_rep_set_uint(root, r,
+                oc_rep_set_uint(sample, r,
                     ((struct sensor_color_data *)(databuf))->scd_r);
             } else {
                 goto err;
             }
             if (((struct sensor_color_data *)(databuf))->scd_g_is_valid) {
-                oc_rep_set_uint(root, g,
+                oc_rep_set_uint(sample, g,
                     ((struct sensor_color_data *)(databuf))->scd_g);
             } else {
                 goto err;
             }
             if (((struct sensor_color_data *)(databuf))->scd_b_is_valid) {
-                oc_rep_set_uint(root, b,
+                oc_rep_set_uint(sample, b,
                     ((struct sensor_color_data *)(databuf))->scd_b);
             } else {
                 goto err;
             }
             if (((struct sensor_color_data *)(databuf))->scd_lux_is_valid) {
-                oc_rep_set_uint(root, lux,
+                oc_rep_set_uint(sample, lux,
                     ((struct sensor_color_data *)(databuf))->scd_lux);
             } else {
                 goto err;
             }
             if (((struct sensor_color_data *)(databuf))->scd_colortemp_is_valid) {
-                oc_rep_set_uint(root, colortemp,
+                oc_rep_set_uint(sample, colortemp,
                     ((struct sensor_color_data *)(databuf))->scd_colortemp);
             } else {
                 goto err;
             }
             if (((struct sensor_color_data *)(databuf))->scd_saturation_is_valid) {
-                oc_rep_set_uint(root, saturation,
+                oc_rep_set_uint(sample, saturation,
                     ((struct sensor_color_data *)(databuf))->scd_saturation);
             } else {
                 goto err;
             }
             if (((struct sensor_color_data *)(databuf))->scd_saturation75_is_valid) {
-                oc_rep_set_uint(root, saturation75,
+                oc_rep_set_uint(sample, saturation75,
                     ((struct sensor_color_data *)(databuf))->scd_saturation75);
             } else {
                 goto err;
             }
             if (((struct sensor_color_data *)(databuf))->scd_is_sat_is_valid) {
-                oc_rep_set_uint(root, is_sat,
+                oc_rep_set_uint(sample, is_sat,
                     ((struct sensor_color_data *)(databuf))->scd_is_sat);
             } else {
                 goto err;
             }
             if (((struct sensor_color_data *)(databuf))->scd_cratio_is_valid) {
-                oc_rep_set_double(root, cratio,
+                oc_rep_set_double(sample, cratio,
                     ((struct sensor_color_data *)(databuf))->scd_cratio);
             } else {
                 goto err;
             }
             if (((struct sensor_color_data *)(databuf))->scd_maxlux_is_valid) {
-                oc_rep_set_uint(root, maxlux,
+                oc_rep_set_uint(sample, maxlux,
                     ((struct sensor_color_data *)(databuf))->scd_maxlux);
             } else {
                 goto err;
             }
             if (((struct sensor_color_data *)(databuf))->scd_ir_is_valid) {
-                oc_rep_set_uint(root, ir,
+                oc_rep_set_uint(sample, ir,
                     ((struct sensor_color_data *)(databuf))->scd_ir);
             } else {
                 goto err;
@@ -331,13 +390,107 @@ sensor_oic_encode(struct sensor* sensor, void *arg, void *databuf,
             goto err;
     }
 
+    *map = sample_map;
+    return 0;
+err:
+    *map = sample_map;
+    return SYS_EINVAL;
+}
+
+static int
+sensor_oic_encode(struct sensor* sensor, void *arg, void *databuf,
+                  sensor_type_t type)
+{
+    int rc;
+
+    rc = sensor_oic_encode_sample(&root_map, databuf, type);
+    if (rc) {
+        return rc;
+    }
+
     oc_rep_set_uint(root, ts_secs, (long int)sensor->s_sts.st_ostv.tv_sec);
     oc_rep_set_int(root, ts_usecs, (int)sensor->s_sts.st_ostv.tv_usec);
     oc_rep_set_uint(root, ts_cputime, (unsigned int)sensor->s_sts.st_cputime);
 
     return 0;
-err:
-    return SYS_EINVAL;
+}
+
+static struct sensor_oic_sample *
+sensor_oic_hist_sample(struct sensor_oic_res *sor, int idx)
+{
+    /* idx counts back from the most recent sample, 0 being the latest */
+    return &sor->sor_hist[(sor->sor_head + SENSOR_OIC_HIST_CNT - 1 - idx) %
+                          SENSOR_OIC_HIST_CNT];
+}
+
+/*
+ * Encodes the most recent cached sample, in the same representation as a
+ * sample read on demand.  Called with the sensor locked.
+ */
+static int
+sensor_oic_encode_last(struct sensor_oic_res *sor)
+{
+    struct sensor_oic_sample *sos;
+    int rc;
+
+    sos = sensor_oic_hist_sample(sor, 0);
+    rc = sensor_oic_encode_sample(&root_map, &sos->sos_data, sor->sor_type);
+    if (rc) {
+        return rc;
+    }
+
+    oc_rep_set_uint(root, ts_secs, sos->sos_ts / 1000000);
+    oc_rep_set_int(root, ts_usecs, sos->sos_ts % 1000000);
+    oc_rep_set_uint(root, ts_cputime, sos->sos_cputime);
+
+    return 0;
+}
+
+/*
+ * Encodes the cnt most recent cached samples as a batch: the timestamp of
+ * the oldest one, the offsets of each sample from it in microseconds ("dt")
+ * and the samples themselves ("smp"), oldest first.  Called with the sensor
+ * locked.
+ */
+static int
+sensor_oic_encode_hist(struct sensor_oic_res *sor, int cnt)
+{
+    struct sensor_oic_sample *sos;
+    int64_t base;
+    int rc;
+    int i;
+
+    if (cnt <= 0 || cnt > sor->sor_cnt) {
+        cnt = sor->sor_cnt;
+    }
+    if (!cnt) {
+        return SYS_ENOENT;
+    }
+
+    base = sensor_oic_hist_sample(sor, cnt - 1)->sos_ts;
+    oc_rep_set_uint(root, ts_secs, base / 1000000);
+    oc_rep_set_int(root, ts_usecs, base % 1000000);
+    oc_rep_set_uint(root, n, cnt);
+
+    oc_rep_set_array(root, dt);
+    for (i = cnt - 1; i >= 0; i--) {
+        sos = sensor_oic_hist_sample(sor, i);
+        g_err |= cbor_encode_int(&dt_array, sos->sos_ts - base);
+    }
+    oc_rep_close_array(root, dt);
+
+    rc = 0;
+    oc_rep_set_array(root, smp);
+    for (i = cnt - 1; i >= 0; i--) {
+        sos = sensor_oic_hist_sample(sor, i);
+        oc_rep_object_array_start_item(smp);
+        rc |= sensor_oic_encode_sample(&smp_map, &sos->sos_data,
+                                       sor->sor_type);
+        oc_rep_object_array_end_item(smp);
+    }
+    oc_rep_close_array(root, smp);
+
+    return rc ? SYS_EINVAL : 0;
 }
 
 static int
@@ -526,34 +679,91 @@ err:
     return SYS_EINVAL;
 }
 
-static void
-sensor_oic_get_data(oc_request_t *request, oc_interface_mask_t interface)
+/*
+ * Finds the sensor and sensor type an OIC resource was created for, from its
+ * URI ("/<devname>/<typename>") and resource type.
+ */
+static int
+sensor_oic_lookup(oc_resource_t *res, struct sensor **sensorp,
+                  sensor_type_t *typep)
 {
-    int rc;
     struct sensor *sensor;
     char *devname;
     char *typename;
-    sensor_type_t type;
     char tmpstr[COAP_MAX_URI] = {0};
     const char s[2] = "/";
+    int rc;
 
-    memcpy(tmpstr, (char *)&(request->resource->uri.os_str[1]),
-           request->resource->uri.os_sz - 1);
+    memcpy(tmpstr, (char *)&(res->uri.os_str[1]), res->uri.os_sz - 1);
 
     /* Parse the sensor device name from the uri  */
     devname = strtok(tmpstr, s);
 
-    typename = strtok(NULL, s);
-
     /* Look up sensor by name */
     sensor = sensor_mgr_find_next_bydevname(devname, NULL);
     if (!sensor) {
-        rc = SYS_EINVAL;
-        goto err;
+        return SYS_EINVAL;
     }
 
-    if (memcmp(g_s_oic_dn, request->resource->types.oa_arr.s,
-               sizeof(g_s_oic_dn) - 1)) {
+    if (memcmp(g_s_oic_dn, res->types.oa_arr.s, sizeof(g_s_oic_dn) - 1)) {
+        return SYS_EINVAL;
+    }
+
+    typename = &(res->types.oa_arr.s[sizeof(g_s_oic_dn) - 1]);
+    rc = sensor_typename_to_type(typename, typep, sensor);
+    if (rc) {
+        /* Type either not supported by sensor or not found */
+        return rc;
+    }
+
+    *sensorp = sensor;
+    return 0;
+}
+
+/*
+ * Number of samples asked for with a "hist[=<n>]" query: 0 for all cached
+ * samples, -1 if the request is for the latest sample only.
+ */
+static int
+sensor_oic_query_hist(oc_request_t *request)
+{
+    char *val;
+    int len;
+    int cnt;
+
+    len = oc_get_query_value(request, "hist", &val);
+    if (len < 0) {
+        return -1;
+    }
+
+    cnt = 0;
+    while (len-- > 0 && *val >= '0' && *val <= '9' &&
+           cnt < SENSOR_OIC_HIST_CNT) {
+        cnt = cnt * 10 + (*val++ - '0');
+    }
+
+    return cnt;
+}
+
+/*
+ * GETs are answered from the samples cached by the sensor's OIC listener
+ * while the sensor is polled, and by reading the sensor otherwise.  A
+ * "hist" query returns the cached samples as a batch (see
+ * sensor_oic_encode_hist()).
+ */
+static void
+sensor_oic_get_data(oc_request_t *request, oc_interface_mask_t interface)
+{
+    struct sensor_type_traits *stt;
+    struct sensor_oic_res *sor;
+    struct sensor *sensor;
+    sensor_type_t type;
+    bool cached;
+    int hist;
+    int rc;
+
+    rc = sensor_oic_lookup(request->resource, &sensor, &type);
+    if (rc) {
         goto err;
     }
 
@@ -563,18 +773,26 @@ sensor_oic_get_data(oc_request_t *request, oc_interface_mask_t interface)
     case OC_IF_BASELINE:
         oc_process_baseline_interface(request->resource);
     case OC_IF_R:
+        stt = sensor_get_type_traits_bytype(type, sensor);
+        sor = stt ? stt->stt_oic_state : NULL;
+        hist = sensor_oic_query_hist(request);
 
-        typename =
-            &(request->resource->types.oa_arr.s[sizeof(g_s_oic_dn) - 1]);
-        rc = sensor_typename_to_type(typename, &type, sensor);
-        if (rc) {
-            /* Type either not supported by sensor or not found */
-            goto err;
+        sensor_lock(sensor);
+        cached = sor && sor->sor_cnt && (hist >= 0 || sensor->s_poll_rate);
+        if (cached) {
+            if (hist >= 0) {
+                rc = sensor_oic_encode_hist(sor, hist);
+            } else {
+                rc = sensor_oic_encode_last(sor);
+            }
         }
+        sensor_unlock(sensor);
 
-        rc = sensor_read(sensor, type, sensor_oic_encode,
-                         (uintptr_t *)SENSOR_IGN_LISTENER,
-                         OS_TIMEOUT_NEVER);
+        if (!cached) {
+            rc = sensor_read(sensor, type, sensor_oic_encode,
+                             (uintptr_t *)SENSOR_IGN_LISTENER,
+                             OS_TIMEOUT_NEVER);
+        }
         if (rc) {
             goto err;
         }
@@ -591,6 +809,169 @@ err:
     oc_send_response(request, OC_STATUS_NOT_FOUND);
 }
 
+#if MYNEWT_VAL(SENSOR_OIC_OBS_POLL)
+/*
+ * Polls a sensor at SENSOR_OIC_OBS_RATE while any of its resources is
+ * observed, unless it is already polled at least that fast, and restores
+ * the previous poll rate when the last observer goes away.
+ */
+static void
+sensor_oic_observe(oc_resource_t *res)
+{
+    struct sensor_type_traits *stt;
+    struct sensor_oic_dev *sod;
+    struct sensor *sensor;
+    sensor_type_t type;
+    int observers;
+
+    if (sensor_oic_lookup(res, &sensor, &type)) {
+        return;
+    }
+
+    stt = sensor_get_type_traits_bytype(type, sensor);
+    if (!stt || !stt->stt_oic_state) {
+        return;
+    }
+    sod = stt->stt_oic_state->sor_dev;
+
+    observers = 0;
+    sensor_lock(sensor);
+    SLIST_FOREACH(stt, &sensor->s_type_traits_list, stt_next) {
+        if (stt->stt_oic_res) {
+            observers += stt->stt_oic_res->num_observers;
+        }
+    }
+    sensor_unlock(sensor);
+
+    if (observers && !sod->sod_observed) {
+        sod->sod_observed = 1;
+        sod->sod_poll_rate = sensor->s_poll_rate;
+        if (!sensor->s_poll_rate ||
+            sensor->s_poll_rate > MYNEWT_VAL(SENSOR_OIC_OBS_RATE)) {
+            sod->sod_poll_set =
+                !sensor_set_poll_rate_ms(sensor->s_dev->od_name,
+                                         MYNEWT_VAL(SENSOR_OIC_OBS_RATE));
+        }
+    } else if (!observers && sod->sod_observed) {
+        sod->sod_observed = 0;
+        if (sod->sod_poll_set) {
+            sod->sod_poll_set = 0;
+            sensor_set_poll_rate_ms(sensor->s_dev->od_name,
+                                    sod->sod_poll_rate);
+        }
+    }
+}
+#endif
+
+/*
+ * Sends the samples of a sensor type not yet seen by its observers: the
+ * latest one, or all of them as a batch if SENSOR_OIC_OBS_BATCH > 1.
+ */
+static void
+sensor_oic_notify(struct sensor *sensor, struct sensor_type_traits *stt)
+{
+    oc_request_t request = {};
+    oc_response_t response = {};
+    oc_response_buffer_t response_buffer;
+    struct sensor_oic_res *sor;
+    struct os_mbuf *m;
+    int rc;
+
+    sor = stt->stt_oic_state;
+
+    m = os_msys_get_pkthdr(0, 0);
+    if (!m) {
+        return;
+    }
+
+    memset(&response_buffer, 0, sizeof(response_buffer));
+    response_buffer.buffer = m;
+    response.response_buffer = &response_buffer;
+    request.resource = stt->stt_oic_res;
+    request.response = &response;
+    oc_rep_new(m);
+    oc_rep_start_root_object();
+
+    sensor_lock(sensor);
+    if (SENSOR_OIC_OBS_BATCH > 1) {
+        rc = sensor_oic_encode_hist(sor, sor->sor_pending);
+    } else {
+        rc = sensor_oic_encode_last(sor);
+    }
+    sor->sor_pending = 0;
+    sensor_unlock(sensor);
+
+    if (!rc) {
+        oc_rep_end_root_object();
+        oc_send_response(&request, OC_STATUS_OK);
+        coap_notify_observers(stt->stt_oic_res, &response_buffer, NULL);
+    }
+    os_mbuf_free_chain(m);
+}
+
+static void
+sensor_oic_notify_ev(struct os_event *ev)
+{
+    struct sensor_type_traits *stt;
+    struct sensor_oic_dev *sod;
+
+    sod = ev->ev_arg;
+    SLIST_FOREACH(stt, &sod->sod_sensor->s_type_traits_list, stt_next) {
+        if (stt->stt_oic_state && stt->stt_oic_res->num_observers &&
+            stt->stt_oic_state->sor_pending >= SENSOR_OIC_OBS_BATCH) {
+            sensor_oic_notify(sod->sod_sensor, stt);
+        }
+    }
+}
+
+/*
+ * Sensor listener caching the samples of a sensor for its OIC resources.
+ * Called from sensor_read(), with the sensor locked.
+ */
+static int
+sensor_oic_listener(struct sensor *sensor, void *arg, void *data,
+                    sensor_type_t type)
+{
+    struct sensor_type_traits *stt;
+    struct sensor_oic_sample *sos;
+    struct sensor_oic_res *sor;
+    size_t size;
+
+    stt = sensor_get_type_traits_bytype(type, sensor);
+    if (!stt || !stt->stt_oic_state) {
+        return 0;
+    }
+    sor = stt->stt_oic_state;
+
+    size = sensor_type_data_size(type);
+    if (!size || size > sizeof(sos->sos_data)) {
+        return 0;
+    }
+
+    sos = &sor->sor_hist[sor->sor_head];
+    memcpy(&sos->sos_data, data, size);
+    sos->sos_ts = sensor->s_sts.st_ostv.tv_sec * 1000000 +
+                  sensor->s_sts.st_ostv.tv_usec;
+    sos->sos_cputime = sensor->s_sts.st_cputime;
+
+    sor->sor_head = (sor->sor_head + 1) % SENSOR_OIC_HIST_CNT;
+    if (sor->sor_cnt < SENSOR_OIC_HIST_CNT) {
+        sor->sor_cnt++;
+    }
+    if (sor->sor_pending < SENSOR_OIC_HIST_CNT) {
+        sor->sor_pending++;
+    }
+
+#if !MYNEWT_VAL(SENSOR_OIC_PERIODIC)
+    if (stt->stt_oic_res->num_observers &&
+        sor->sor_pending >= SENSOR_OIC_OBS_BATCH) {
+        os_eventq_put(oc_evq_get(), &((struct sensor_oic_dev *)arg)->sod_ev);
+    }
+#endif
+
+    return 0;
+}
+
 /**
  * Transmit OIC trigger
  *
@@ -646,11 +1027,13 @@ err:
 }
 
 static int
-sensor_oic_add_resource(struct sensor *sensor, sensor_type_t type)
+sensor_oic_add_resource(struct sensor *sensor, sensor_type_t type,
+                        struct sensor_oic_dev *sod)
 {
     char *typename;
     char tmpstr[COAP_MAX_URI];
     struct sensor_type_traits *stt;
+    struct sensor_oic_res *sor;
     int rc;
 
     stt = sensor_get_type_traits_bytype(type, sensor);
@@ -669,6 +1052,14 @@ sensor_oic_add_resource(struct sensor *sensor, sensor_type_t type)
         return rc;
     }
 
+    sor = malloc(sizeof(*sor));
+    if (!sor) {
+        return SYS_ENOMEM;
+    }
+    memset(sor, 0, sizeof(*sor));
+    sor->sor_dev = sod;
+    sor->sor_type = type;
+
     memset(tmpstr, 0, sizeof(tmpstr));
     snprintf(tmpstr, sizeof(tmpstr), "/%s/%s",
              sensor->s_dev->od_name, typename);
@@ -676,6 +1067,7 @@ sensor_oic_add_resource(struct sensor *sensor, sensor_type_t type)
     sensor_lock(sensor);
 
     stt->stt_sensor_type = type;
+    stt->stt_oic_state = sor;
 
     stt->stt_oic_res = oc_new_resource(tmpstr, 1, 0);
 
@@ -695,6 +1087,9 @@ sensor_oic_add_resource(struct sensor *sensor, sensor_type_t type)
 #endif
     oc_resource_set_request_handler(stt->stt_oic_res, OC_GET,
                                     sensor_oic_get_data);
+#if MYNEWT_VAL(SENSOR_OIC_OBS_POLL)
+    oc_resource_set_observe_handler(stt->stt_oic_res, sensor_oic_observe);
+#endif
 
     oc_add_resource(stt->stt_oic_res);
 
@@ -710,6 +1105,7 @@ sensor_oic_add_resource(struct sensor *sensor, sensor_type_t type)
 void
 sensor_oic_init(void)
 {
+    struct sensor_oic_dev *sod;
     struct sensor *sensor;
     sensor_type_t type;
     int i;
@@ -730,13 +1126,22 @@ sensor_oic_init(void)
             break;
         }
 
+        sod = malloc(sizeof(*sod));
+        if (!sod) {
+            break;
+        }
+        memset(sod, 0, sizeof(*sod));
+        sod->sod_sensor = sensor;
+        sod->sod_ev.ev_cb = sensor_oic_notify_ev;
+        sod->sod_ev.ev_arg = sod;
+
         i = 0;
 
         /* Iterate through N types of sensors */
         while (i < 32) {
             type = (1 << i);
             if (sensor_mgr_match_bytype(sensor, &type)) {
-                rc = sensor_oic_add_resource(sensor, type);
+                rc = sensor_oic_add_resource(sensor, type, sod);
                 if (rc) {
                     break;
                 }
@@ -744,6 +1149,11 @@ sensor_oic_init(void)
             }
             i++;
         }
+
+        sod->sod_listener.sl_sensor_type = SENSOR_TYPE_ALL;
+        sod->sod_listener.sl_func = sensor_oic_listener;
+        sod->sod_listener.sl_arg = sod;
+        sensor_register_listener(sensor, &sod->sod_listener);
     }
 }
 
@@ -21,9 +21,16 @@
 #define __SENSOR_PRIV_H__
 
 #include "os/mynewt.h"
+#include "sensor/sensor.h"
 
 #if MYNEWT_VAL(SENSOR_CLI)
 int sensor_shell_register(void);
 #endif
 
+size_t sensor_type_data_size(sensor_type_t type);
+
+#if MYNEWT_VAL(SENSOR_RING)
+void sensor_ring_put(struct sensor *sensor, void *data, sensor_type_t type);
+#endif
+
 #endif /* __SENSOR_PRIV_H__ */
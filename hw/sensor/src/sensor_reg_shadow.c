@@ -0,0 +1,294 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(SENSOR_REG_SHADOW)
+
+#include "sensor/sensor.h"
+
+/* Bits idx to idx + len - 1 */
+#define SENSOR_REG_SHADOW_BITS(idx, len) \
+    ((uint32_t)((((uint64_t)1 << (len)) - 1) << (idx)))
+
+/*
+ * Index of a register in the shadow, or -1 if the register is not cached.
+ */
+static int
+sensor_reg_shadow_idx(const struct sensor_reg_shadow *srs, uint8_t reg)
+{
+    int idx;
+
+    if (reg < srs->srs_base) {
+        return -1;
+    }
+
+    idx = reg - srs->srs_base;
+    if (idx >= srs->srs_count || (srs->srs_volatile & (1UL << idx))) {
+        return -1;
+    }
+
+    return idx;
+}
+
+/*
+ * Writes the dirty registers, one burst per run of consecutive registers.
+ */
+static int
+sensor_reg_shadow_flush_dirty(struct sensor_itf *itf,
+                              struct sensor_reg_shadow *srs)
+{
+    int idx;
+    int len;
+    int rc;
+
+    idx = 0;
+    while (idx < srs->srs_count) {
+        if (!(srs->srs_dirty & (1UL << idx))) {
+            idx++;
+            continue;
+        }
+
+        len = 1;
+        while (idx + len < srs->srs_count && len < srs->srs_max_burst &&
+               (srs->srs_dirty & (1UL << (idx + len)))) {
+            len++;
+        }
+
+        rc = srs->srs_write(itf, srs->srs_base + idx, &srs->srs_val[idx],
+                            len);
+        if (rc) {
+            return rc;
+        }
+        srs->srs_dirty &= ~SENSOR_REG_SHADOW_BITS(idx, len);
+
+        idx += len;
+    }
+
+    return 0;
+}
+
+int
+sensor_reg_shadow_init(struct sensor_reg_shadow *srs,
+                       sensor_reg_access_func_t read,
+                       sensor_reg_access_func_t write,
+                       uint8_t base, uint8_t count, uint8_t max_burst,
+                       uint32_t volatile_mask)
+{
+    if (!read || !write || !count || count > SENSOR_REG_SHADOW_MAX ||
+        !max_burst) {
+        return SYS_EINVAL;
+    }
+
+    memset(srs, 0, sizeof(*srs));
+    srs->srs_read = read;
+    srs->srs_write = write;
+    srs->srs_base = base;
+    srs->srs_count = count;
+    srs->srs_max_burst = max_burst;
+    srs->srs_volatile = volatile_mask;
+
+    return 0;
+}
+
+int
+sensor_reg_shadow_load(struct sensor_itf *itf)
+{
+    struct sensor_reg_shadow *srs;
+    uint8_t buf[SENSOR_REG_SHADOW_MAX];
+    int idx;
+    int len;
+    int rc;
+    int i;
+
+    srs = itf->si_shadow;
+    if (!srs) {
+        return SYS_EINVAL;
+    }
+
+    idx = 0;
+    while (idx < srs->srs_count) {
+        if (srs->srs_volatile & (1UL << idx)) {
+            idx++;
+            continue;
+        }
+
+        len = 1;
+        while (idx + len < srs->srs_count &&
+               !(srs->srs_volatile & (1UL << (idx + len)))) {
+            len++;
+        }
+
+        rc = srs->srs_read(itf, srs->srs_base + idx, buf, len);
+        if (rc) {
+            return rc;
+        }
+
+        /* Registers still to be written keep their new value */
+        for (i = 0; i < len; i++) {
+            if (!(srs->srs_dirty & (1UL << (idx + i)))) {
+                srs->srs_val[idx + i] = buf[i];
+            }
+        }
+        srs->srs_valid |= SENSOR_REG_SHADOW_BITS(idx, len);
+
+        idx += len;
+    }
+
+    return 0;
+}
+
+void
+sensor_reg_shadow_invalidate(struct sensor_itf *itf)
+{
+    struct sensor_reg_shadow *srs;
+
+    srs = itf->si_shadow;
+    if (srs) {
+        srs->srs_valid = 0;
+        srs->srs_dirty = 0;
+    }
+}
+
+int
+sensor_reg_shadow_read(struct sensor_itf *itf, uint8_t reg, uint8_t *val)
+{
+    struct sensor_reg_shadow *srs;
+    int idx;
+    int rc;
+
+    srs = itf->si_shadow;
+    if (!srs) {
+        return SYS_EINVAL;
+    }
+
+    idx = sensor_reg_shadow_idx(srs, reg);
+    if (idx < 0) {
+        return srs->srs_read(itf, reg, val, 1);
+    }
+
+    if (!(srs->srs_valid & (1UL << idx))) {
+        rc = srs->srs_read(itf, reg, &srs->srs_val[idx], 1);
+        if (rc) {
+            return rc;
+        }
+        srs->srs_valid |= 1UL << idx;
+    }
+
+    *val = srs->srs_val[idx];
+
+    return 0;
+}
+
+int
+sensor_reg_shadow_write(struct sensor_itf *itf, uint8_t reg, uint8_t val)
+{
+    struct sensor_reg_shadow *srs;
+    uint32_t bit;
+    int idx;
+
+    srs = itf->si_shadow;
+    if (!srs) {
+        return SYS_EINVAL;
+    }
+
+    idx = sensor_reg_shadow_idx(srs, reg);
+    if (idx < 0) {
+        return srs->srs_write(itf, reg, &val, 1);
+    }
+
+    bit = 1UL << idx;
+    if ((srs->srs_valid & bit) && srs->srs_val[idx] == val) {
+        return 0;
+    }
+
+    srs->srs_val[idx] = val;
+    srs->srs_valid |= bit;
+    srs->srs_dirty |= bit;
+
+    if (srs->srs_deferred) {
+        return 0;
+    }
+
+    return sensor_reg_shadow_flush_dirty(itf, srs);
+}
+
+int
+sensor_reg_shadow_modify(struct sensor_itf *itf, uint8_t reg, uint8_t mask,
+                         uint8_t val)
+{
+    uint8_t cur;
+    int rc;
+
+    rc = sensor_reg_shadow_read(itf, reg, &cur);
+    if (rc) {
+        return rc;
+    }
+
+    return sensor_reg_shadow_write(itf, reg, (cur & ~mask) | (val & mask));
+}
+
+void
+sensor_reg_shadow_written(struct sensor_itf *itf, uint8_t reg,
+                          const uint8_t *buf, uint8_t len)
+{
+    struct sensor_reg_shadow *srs;
+    int idx;
+    int i;
+
+    srs = itf->si_shadow;
+    if (!srs) {
+        return;
+    }
+
+    for (i = 0; i < len; i++) {
+        idx = sensor_reg_shadow_idx(srs, reg + i);
+        if (idx >= 0) {
+            srs->srs_val[idx] = buf[i];
+            srs->srs_valid |= 1UL << idx;
+            srs->srs_dirty &= ~(1UL << idx);
+        }
+    }
+}
+
+void
+sensor_reg_shadow_defer(struct sensor_itf *itf)
+{
+    if (itf->si_shadow) {
+        itf->si_shadow->srs_deferred = 1;
+    }
+}
+
+int
+sensor_reg_shadow_flush(struct sensor_itf *itf)
+{
+    struct sensor_reg_shadow *srs;
+
+    srs = itf->si_shadow;
+    if (!srs) {
+        return 0;
+    }
+
+    srs->srs_deferred = 0;
+
+    return sensor_reg_shadow_flush_dirty(itf, srs);
+}
+
+#endif
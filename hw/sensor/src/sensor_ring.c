@@ -0,0 +1,296 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(SENSOR_RING)
+
+#include "sensor/sensor.h"
+#include "sensor/accel.h"
+#include "sensor/mag.h"
+#include "sensor/light.h"
+#include "sensor/quat.h"
+#include "sensor/euler.h"
+#include "sensor/color.h"
+#include "sensor/temperature.h"
+#include "sensor/pressure.h"
+#include "sensor/humidity.h"
+#include "sensor/gyro.h"
+#include "sensor_priv.h"
+
+/* Room for a sample of any type, when copying it out of a ring */
+union sensor_ring_sample {
+    struct sensor_accel_data sad;
+#if MYNEWT_VAL(SENSOR_RAW_DATA)
+    struct sensor_accel_raw_data sard;
+#endif
+    struct sensor_mag_data smd;
+    struct sensor_light_data sld;
+    struct sensor_quat_data sqd;
+    struct sensor_euler_data sed;
+    struct sensor_color_data scd;
+    struct sensor_temp_data std;
+    struct sensor_press_data spd;
+    struct sensor_humid_data shd;
+    struct sensor_gyro_data sgd;
+};
+
+static struct sensor_ring_slot *
+sensor_ring_slot(const struct sensor_ring *ring, uint32_t idx)
+{
+    return (struct sensor_ring_slot *)
+        (ring->sr_buf + (idx % ring->sr_count) * ring->sr_slot_size);
+}
+
+static void *
+sensor_ring_slot_data(struct sensor_ring_slot *slot)
+{
+    return slot + 1;
+}
+
+/**
+ * Size of a sample as the sensor's driver reports it.
+ */
+static size_t
+sensor_ring_data_size(const struct sensor *sensor, sensor_type_t type)
+{
+#if MYNEWT_VAL(SENSOR_RAW_DATA)
+    if (type & sensor->s_raw_types) {
+        return sizeof(struct sensor_accel_raw_data);
+    }
+#endif
+
+    return sensor_type_data_size(type);
+}
+
+int
+sensor_ring_init(struct sensor_ring *ring, os_membuf_t *buf, uint16_t count,
+                 uint16_t max_data_size)
+{
+    if (buf == NULL || count == 0 ||
+        SENSOR_RING_SLOT_SIZE(max_data_size) > UINT16_MAX) {
+        return SYS_EINVAL;
+    }
+
+    memset(ring, 0, sizeof(*ring));
+    ring->sr_buf = (uint8_t *)buf;
+    ring->sr_count = count;
+    ring->sr_slot_size = SENSOR_RING_SLOT_SIZE(max_data_size);
+    SLIST_INIT(&ring->sr_listeners);
+
+    return 0;
+}
+
+int
+sensor_set_ring(struct sensor *sensor, struct sensor_ring *ring)
+{
+    int rc;
+
+    rc = sensor_lock(sensor);
+    if (rc) {
+        return rc;
+    }
+
+    sensor->s_ring = ring;
+
+    sensor_unlock(sensor);
+
+    return 0;
+}
+
+/**
+ * Add a sample to the sensor's ring and wake up the listeners that want
+ * it.  Called with the sensor locked, which makes this the only writer.
+ */
+void
+sensor_ring_put(struct sensor *sensor, void *data, sensor_type_t type)
+{
+    struct sensor_ring_listener *srl;
+    struct sensor_ring_slot *slot;
+    struct sensor_ring *ring;
+    uint32_t head;
+    size_t size;
+
+    ring = sensor->s_ring;
+    if (ring == NULL || SLIST_EMPTY(&ring->sr_listeners)) {
+        return;
+    }
+
+    size = sensor_ring_data_size(sensor, type);
+    if (size == 0 || size > ring->sr_slot_size - sizeof(*slot)) {
+        return;
+    }
+
+    head = ring->sr_head;
+    slot = sensor_ring_slot(ring, head);
+
+    /* Invalidate the old sample before overwriting it */
+    __atomic_store_n(&slot->srs_seq, head, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    slot->srs_type = type;
+    slot->srs_ts = sensor->s_sts;
+    memcpy(sensor_ring_slot_data(slot), data, size);
+
+    /* Publish the slot only once it is complete */
+    __atomic_store_n(&ring->sr_head, head + 1, __ATOMIC_RELEASE);
+
+    SLIST_FOREACH(srl, &ring->sr_listeners, srl_next) {
+        if (srl->srl_sensor_type & type) {
+            os_eventq_put(srl->srl_evq, &srl->srl_ev);
+        }
+    }
+}
+
+/**
+ * Drain a ring listener's backlog, from its own event queue.
+ */
+static void
+sensor_ring_ev_cb(struct os_event *ev)
+{
+    struct sensor_ring_listener *srl;
+    union sensor_ring_sample sample;
+    struct sensor_ring_slot *slot;
+    struct sensor_timestamp ts;
+    struct sensor_ring *ring;
+    struct sensor *sensor;
+    sensor_type_t type;
+#if MYNEWT_VAL(SENSOR_RAW_DATA)
+    struct sensor_accel_raw_data sard;
+#endif
+    uint32_t head;
+    uint32_t seq;
+    size_t size;
+
+    srl = ev->ev_arg;
+    sensor = srl->srl_sensor;
+    ring = sensor->s_ring;
+    if (ring == NULL) {
+        return;
+    }
+
+    while (1) {
+        head = __atomic_load_n(&ring->sr_head, __ATOMIC_ACQUIRE);
+        if (srl->srl_cursor == head) {
+            break;
+        }
+
+        /* Skip what has been overwritten since the last drain */
+        if (head - srl->srl_cursor > ring->sr_count) {
+            srl->srl_drops += head - srl->srl_cursor - ring->sr_count;
+            srl->srl_cursor = head - ring->sr_count;
+        }
+
+        slot = sensor_ring_slot(ring, srl->srl_cursor);
+        seq = __atomic_load_n(&slot->srs_seq, __ATOMIC_ACQUIRE);
+        type = slot->srs_type;
+        ts = slot->srs_ts;
+        size = min(sensor_ring_data_size(sensor, type), sizeof(sample));
+        memcpy(&sample, sensor_ring_slot_data(slot), size);
+
+        /* The writer may have reused the slot before or while copying */
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (seq != srl->srl_cursor ||
+            __atomic_load_n(&slot->srs_seq, __ATOMIC_RELAXED) != seq) {
+            srl->srl_cursor++;
+            srl->srl_drops++;
+            continue;
+        }
+        srl->srl_cursor++;
+
+        if (!(type & srl->srl_sensor_type) || size == 0) {
+            continue;
+        }
+
+#if MYNEWT_VAL(SENSOR_RAW_DATA)
+        if (type & sensor->s_raw_types) {
+            sard = sample.sard;
+            sensor_accel_raw_to_data(&sard, &sample.sad);
+        }
+#endif
+
+        srl->srl_func(sensor, srl->srl_arg, &sample, type, &ts);
+    }
+}
+
+int
+sensor_register_ring_listener(struct sensor *sensor,
+                              struct sensor_ring_listener *srl)
+{
+    int rc;
+
+    rc = sensor_lock(sensor);
+    if (rc) {
+        return rc;
+    }
+
+    if (sensor->s_ring == NULL) {
+        sensor_unlock(sensor);
+        return SYS_EINVAL;
+    }
+
+    if (srl->srl_evq == NULL) {
+        srl->srl_evq = sensor_mgr_evq_get();
+    }
+    memset(&srl->srl_ev, 0, sizeof(srl->srl_ev));
+    srl->srl_ev.ev_cb = sensor_ring_ev_cb;
+    srl->srl_ev.ev_arg = srl;
+    srl->srl_sensor = sensor;
+    srl->srl_cursor = sensor->s_ring->sr_head;
+    srl->srl_drops = 0;
+
+    SLIST_INSERT_HEAD(&sensor->s_ring->sr_listeners, srl, srl_next);
+
+    sensor_unlock(sensor);
+
+    return 0;
+}
+
+int
+sensor_unregister_ring_listener(struct sensor *sensor,
+                                struct sensor_ring_listener *srl)
+{
+    struct sensor_ring_listener *cursor;
+    int rc;
+
+    rc = sensor_lock(sensor);
+    if (rc) {
+        return rc;
+    }
+
+    rc = SYS_EINVAL;
+    if (sensor->s_ring != NULL) {
+        SLIST_FOREACH(cursor, &sensor->s_ring->sr_listeners, srl_next) {
+            if (cursor == srl) {
+                SLIST_REMOVE(&sensor->s_ring->sr_listeners, srl,
+                             sensor_ring_listener, srl_next);
+                os_eventq_remove(srl->srl_evq, &srl->srl_ev);
+                rc = 0;
+                break;
+            }
+        }
+    }
+
+    sensor_unlock(sensor);
+
+    return rc;
+}
+
+#endif
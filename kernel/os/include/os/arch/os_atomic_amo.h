@@ -0,0 +1,92 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef H_OS_ATOMIC_AMO_
+#define H_OS_ATOMIC_AMO_
+
+/*
+ * RISC-V "A" extension backend for os_atomic.h.  Arithmetic and bitwise
+ * operations map to single AMO instructions; compare-and-swap uses an
+ * LR / SC loop.
+ */
+
+#define OS_ATOMIC_AMO_OP(insn, p, val) do {                                 \
+    uint32_t __old;                                                         \
+                                                                            \
+    __asm__ volatile (insn " %0, %2, %1"                                    \
+                      : "=r" (__old), "+A" (*(p))                           \
+                      : "r" (val)                                           \
+                      : "memory");                                          \
+                                                                            \
+    return __old;                                                           \
+} while (0)
+
+static inline uint32_t
+os_atomic_fetch_add_u32(volatile uint32_t *p, uint32_t val)
+{
+    OS_ATOMIC_AMO_OP("amoadd.w", p, val);
+}
+
+static inline uint32_t
+os_atomic_fetch_sub_u32(volatile uint32_t *p, uint32_t val)
+{
+    OS_ATOMIC_AMO_OP("amoadd.w", p, -val);
+}
+
+static inline uint32_t
+os_atomic_fetch_or_u32(volatile uint32_t *p, uint32_t val)
+{
+    OS_ATOMIC_AMO_OP("amoor.w", p, val);
+}
+
+static inline uint32_t
+os_atomic_fetch_and_u32(volatile uint32_t *p, uint32_t val)
+{
+    OS_ATOMIC_AMO_OP("amoand.w", p, val);
+}
+
+static inline uint32_t
+os_atomic_xchg_u32(volatile uint32_t *p, uint32_t val)
+{
+    OS_ATOMIC_AMO_OP("amoswap.w", p, val);
+}
+
+static inline bool
+os_atomic_cas_u32(volatile uint32_t *p, uint32_t expected, uint32_t desired)
+{
+    uint32_t old;
+    uint32_t fail;
+
+    do {
+        __asm__ volatile ("lr.w %0, %1" : "=r" (old) : "A" (*p) : "memory");
+        if (old != expected) {
+            return false;
+        }
+        __asm__ volatile ("sc.w %0, %2, %1"
+                          : "=&r" (fail), "+A" (*p)
+                          : "r" (desired)
+                          : "memory");
+    } while (fail);
+
+    return true;
+}
+
+#undef OS_ATOMIC_AMO_OP
+
+#endif
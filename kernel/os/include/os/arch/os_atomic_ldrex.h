@@ -0,0 +1,100 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef H_OS_ATOMIC_LDREX_
+#define H_OS_ATOMIC_LDREX_
+
+/*
+ * ARMv7-M / ARMv8-M mainline backend for os_atomic.h.
+ *
+ * Each operation retries an LDREX / STREX pair until the store succeeds.
+ * Exception entry and return clear the local exclusive monitor, so an
+ * interrupt that lands between the two instructions simply forces a retry.
+ */
+
+#define OS_ATOMIC_LDREX_OP(p, newval) do {                                  \
+    uint32_t __old;                                                         \
+    uint32_t __fail;                                                        \
+                                                                            \
+    do {                                                                    \
+        __asm__ volatile ("ldrex %0, %1" : "=r" (__old) : "Q" (*(p))        \
+                          : "memory");                                      \
+        __asm__ volatile ("strex %0, %2, %1"                                \
+                          : "=&r" (__fail), "=Q" (*(p))                     \
+                          : "r" (newval)                                    \
+                          : "memory");                                      \
+    } while (__fail);                                                       \
+                                                                            \
+    return __old;                                                           \
+} while (0)
+
+static inline uint32_t
+os_atomic_fetch_add_u32(volatile uint32_t *p, uint32_t val)
+{
+    OS_ATOMIC_LDREX_OP(p, __old + val);
+}
+
+static inline uint32_t
+os_atomic_fetch_sub_u32(volatile uint32_t *p, uint32_t val)
+{
+    OS_ATOMIC_LDREX_OP(p, __old - val);
+}
+
+static inline uint32_t
+os_atomic_fetch_or_u32(volatile uint32_t *p, uint32_t val)
+{
+    OS_ATOMIC_LDREX_OP(p, __old | val);
+}
+
+static inline uint32_t
+os_atomic_fetch_and_u32(volatile uint32_t *p, uint32_t val)
+{
+    OS_ATOMIC_LDREX_OP(p, __old & val);
+}
+
+static inline uint32_t
+os_atomic_xchg_u32(volatile uint32_t *p, uint32_t val)
+{
+    OS_ATOMIC_LDREX_OP(p, val);
+}
+
+static inline bool
+os_atomic_cas_u32(volatile uint32_t *p, uint32_t expected, uint32_t desired)
+{
+    uint32_t old;
+    uint32_t fail;
+
+    do {
+        __asm__ volatile ("ldrex %0, %1" : "=r" (old) : "Q" (*p) : "memory");
+        if (old != expected) {
+            __asm__ volatile ("clrex" ::: "memory");
+            return false;
+        }
+        __asm__ volatile ("strex %0, %2, %1"
+                          : "=&r" (fail), "=Q" (*p)
+                          : "r" (desired)
+                          : "memory");
+    } while (fail);
+
+    return true;
+}
+
+#undef OS_ATOMIC_LDREX_OP
+
+#endif
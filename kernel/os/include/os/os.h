@@ -119,6 +119,7 @@ void os_reboot(int reason);
 void os_system_reset(void);
 
 #include "os/endian.h"
+#include "os/os_atomic.h"
 #include "os/os_callout.h"
 #include "os/os_cfg.h"
 #include "os/os_cputime.h"
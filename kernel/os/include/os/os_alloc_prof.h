@@ -0,0 +1,91 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef H_OS_ALLOC_PROF_
+#define H_OS_ALLOC_PROF_
+
+#include <stdint.h>
+#include "syscfg/syscfg.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Allocation made with os_malloc() / os_realloc(). */
+#define OS_ALLOC_PROF_HEAP          0
+/** Block taken from an os_mempool with os_memblock_get(). */
+#define OS_ALLOC_PROF_MEMBLOCK      1
+/** Mbuf taken from an os_mbuf_pool (including msys). */
+#define OS_ALLOC_PROF_MBUF          2
+#define OS_ALLOC_PROF_NUM_TYPES     3
+
+#if MYNEWT_VAL(OS_ALLOC_PROF)
+
+/**
+ * Address the allocation is attributed to: the return address of the
+ * public allocator entry point that expands this macro.
+ */
+#define OS_ALLOC_PROF_CALLER()      __builtin_return_address(0)
+
+/**
+ * Reports a successful allocation to the profiler.  Implemented by
+ * sys/allocprof.  May be called from any context, including interrupts.
+ *
+ * @param type                  One of the OS_ALLOC_PROF_[...] types.
+ * @param pool                  The pool the object came from; NULL for the
+ *                                  heap.
+ * @param ptr                   The allocated object.
+ * @param size                  Size of the object, in bytes.
+ * @param caller                Call site the allocation is attributed to.
+ */
+void os_alloc_prof_alloc(uint8_t type, const void *pool, const void *ptr,
+                         uint32_t size, const void *caller);
+
+/**
+ * Reports that an object previously passed to os_alloc_prof_alloc() has
+ * been released.  Objects the profiler is not tracking are counted and
+ * otherwise ignored.
+ *
+ * @param type                  One of the OS_ALLOC_PROF_[...] types.
+ * @param ptr                   The object being freed.
+ */
+void os_alloc_prof_free(uint8_t type, const void *ptr);
+
+#else
+
+#define OS_ALLOC_PROF_CALLER()      NULL
+
+static inline void
+os_alloc_prof_alloc(uint8_t type, const void *pool, const void *ptr,
+                    uint32_t size, const void *caller)
+{
+}
+
+static inline void
+os_alloc_prof_free(uint8_t type, const void *ptr)
+{
+}
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,232 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef H_OS_ATOMIC_
+#define H_OS_ATOMIC_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "os/os_arch.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup OSKernel
+ * @{
+ *   @defgroup OSAtomic Atomic Operations
+ *   @{
+ */
+
+/*
+ * Atomic read-modify-write operations on 32-bit words.
+ *
+ * On architectures with exclusive load / store (Cortex-M3/M4/M7/M33) or the
+ * RISC-V "A" extension these compile to a short instruction sequence and
+ * never disable interrupts.  Other architectures fall back to a critical
+ * section around the plain operation.
+ *
+ * All operations act as compiler barriers.  They are atomic with respect to
+ * tasks and interrupt handlers on the local CPU; no SMP ordering is
+ * provided.
+ */
+
+/**
+ * Atomically reads a word.
+ *
+ * @param p                     The word to read.
+ *
+ * @return                      The value of the word.
+ */
+static inline uint32_t
+os_atomic_load_u32(const volatile uint32_t *p)
+{
+    uint32_t val;
+
+    __asm__ volatile ("" ::: "memory");
+    val = *p;
+    __asm__ volatile ("" ::: "memory");
+
+    return val;
+}
+
+/**
+ * Atomically writes a word.
+ *
+ * @param p                     The word to write.
+ * @param val                   The value to write.
+ */
+static inline void
+os_atomic_store_u32(volatile uint32_t *p, uint32_t val)
+{
+    __asm__ volatile ("" ::: "memory");
+    *p = val;
+    __asm__ volatile ("" ::: "memory");
+}
+
+/**
+ * Atomically adds a value to a word.
+ *
+ * @param p                     The word to modify.
+ * @param val                   The value to add.
+ *
+ * @return                      The value of the word prior to the addition.
+ */
+static inline uint32_t os_atomic_fetch_add_u32(volatile uint32_t *p,
+                                               uint32_t val);
+
+/**
+ * Atomically subtracts a value from a word.
+ *
+ * @param p                     The word to modify.
+ * @param val                   The value to subtract.
+ *
+ * @return                      The value of the word prior to the
+ *                                  subtraction.
+ */
+static inline uint32_t os_atomic_fetch_sub_u32(volatile uint32_t *p,
+                                               uint32_t val);
+
+/**
+ * Atomically ORs a value into a word.
+ *
+ * @param p                     The word to modify.
+ * @param val                   The bits to set.
+ *
+ * @return                      The value of the word prior to the operation.
+ */
+static inline uint32_t os_atomic_fetch_or_u32(volatile uint32_t *p,
+                                              uint32_t val);
+
+/**
+ * Atomically ANDs a value into a word.
+ *
+ * @param p                     The word to modify.
+ * @param val                   The mask to apply.
+ *
+ * @return                      The value of the word prior to the operation.
+ */
+static inline uint32_t os_atomic_fetch_and_u32(volatile uint32_t *p,
+                                               uint32_t val);
+
+/**
+ * Atomically replaces a word.
+ *
+ * @param p                     The word to modify.
+ * @param val                   The new value.
+ *
+ * @return                      The value of the word prior to the exchange.
+ */
+static inline uint32_t os_atomic_xchg_u32(volatile uint32_t *p,
+                                          uint32_t val);
+
+/**
+ * Atomically replaces a word if it contains the expected value.
+ *
+ * @param p                     The word to modify.
+ * @param expected              The value the word must contain.
+ * @param desired               The value to write.
+ *
+ * @return                      true if the word was replaced;
+ *                              false if the word did not contain
+ *                                  the expected value.
+ */
+static inline bool os_atomic_cas_u32(volatile uint32_t *p,
+                                     uint32_t expected, uint32_t desired);
+
+#if defined(ARCH_cortex_m3) || defined(ARCH_cortex_m4) || \
+    defined(ARCH_cortex_m7) || defined(ARCH_cortex_m33)
+#include "os/arch/os_atomic_ldrex.h"
+#elif defined(ARCH_rv32imac)
+#include "os/arch/os_atomic_amo.h"
+#else
+
+#define OS_ATOMIC_CRIT_OP(p, newval) do {                                   \
+    uint32_t __old;                                                         \
+    os_sr_t __sr;                                                           \
+                                                                            \
+    OS_ENTER_CRITICAL(__sr);                                                \
+    __old = *(p);                                                           \
+    *(p) = (newval);                                                        \
+    OS_EXIT_CRITICAL(__sr);                                                 \
+                                                                            \
+    return __old;                                                           \
+} while (0)
+
+static inline uint32_t
+os_atomic_fetch_add_u32(volatile uint32_t *p, uint32_t val)
+{
+    OS_ATOMIC_CRIT_OP(p, __old + val);
+}
+
+static inline uint32_t
+os_atomic_fetch_sub_u32(volatile uint32_t *p, uint32_t val)
+{
+    OS_ATOMIC_CRIT_OP(p, __old - val);
+}
+
+static inline uint32_t
+os_atomic_fetch_or_u32(volatile uint32_t *p, uint32_t val)
+{
+    OS_ATOMIC_CRIT_OP(p, __old | val);
+}
+
+static inline uint32_t
+os_atomic_fetch_and_u32(volatile uint32_t *p, uint32_t val)
+{
+    OS_ATOMIC_CRIT_OP(p, __old & val);
+}
+
+static inline uint32_t
+os_atomic_xchg_u32(volatile uint32_t *p, uint32_t val)
+{
+    OS_ATOMIC_CRIT_OP(p, val);
+}
+
+static inline bool
+os_atomic_cas_u32(volatile uint32_t *p, uint32_t expected, uint32_t desired)
+{
+    os_sr_t sr;
+    bool ok;
+
+    OS_ENTER_CRITICAL(sr);
+    ok = *p == expected;
+    if (ok) {
+        *p = desired;
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    return ok;
+}
+
+#undef OS_ATOMIC_CRIT_OP
+
+#endif
+
+/**
+ *   @} OSAtomic
+ * @} OSKernel
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
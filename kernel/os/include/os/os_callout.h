@@ -45,6 +45,10 @@ struct os_callout {
     struct os_eventq *c_evq;
     /** Number of ticks in the future to expire the callout */
     os_time_t c_ticks;
+#if MYNEWT_VAL(OS_CALLOUT_SLACK)
+    /** Number of ticks the callout may run late to share a wakeup */
+    os_time_t c_slack;
+#endif
 
 
     TAILQ_ENTRY(os_callout) c_next;
@@ -109,6 +113,21 @@ int os_callout_reset(struct os_callout *, os_time_t);
  */
 os_time_t os_callout_remaining_ticks(struct os_callout *, os_time_t);
 
+#if MYNEWT_VAL(OS_CALLOUT_SLACK)
+/**
+ * Sets the timer slack of a callout: the number of ticks by which it may
+ * be delayed past its expiry.  When the system is in tickless idle, the
+ * wakeup for a callout with slack is postponed as long as possible so that
+ * it runs together with later callouts, instead of waking up separately.
+ * A callout never runs before it expires.  The slack is kept across
+ * os_callout_reset() calls.
+ *
+ * @param c The callout to set the slack of
+ * @param slack The tolerance in OS ticks
+ */
+void os_callout_set_slack(struct os_callout *c, os_time_t slack);
+#endif
+
 /**
  * Returns whether the callout is pending or not.
  *
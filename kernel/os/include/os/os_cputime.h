@@ -166,6 +166,19 @@ uint32_t os_cputime_usecs_to_ticks(uint32_t usecs);
 uint32_t os_cputime_ticks_to_usecs(uint32_t ticks);
 #endif
 
+#if MYNEWT_VAL(OS_TIMESTAMP)
+/**
+ * Returns the time since os cputime was initialized, in microseconds.
+ *
+ * Extends os_cputime_get32() to 64 bits with an epoch that is advanced
+ * periodically, see OS_TIMESTAMP_UPDATE_MS.  Never takes a critical
+ * section and can be called from interrupt handlers.
+ *
+ * @return int64_t Microseconds since os_cputime_init()
+ */
+int64_t os_timestamp64(void);
+#endif
+
 /**
  * Wait until the number of ticks has elapsed. This is a blocking delay.
  *
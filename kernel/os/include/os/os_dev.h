@@ -140,6 +140,10 @@ struct os_dev {
     /** Device name */
     const char *od_name;
     STAILQ_ENTRY(os_dev) od_next;
+#if MYNEWT_VAL(OS_DEV_HASH_SIZE)
+    /** Next device in the same name index bucket */
+    SLIST_ENTRY(os_dev) od_hnext;
+#endif
 };
 
 #define OS_DEV_SETHANDLERS(__dev, __open, __close)          \
@@ -236,6 +240,19 @@ int os_dev_resume_all(void);
  */
 struct os_dev *os_dev_open(const char *devname, uint32_t timo, void *arg);
 
+/**
+ * Open a device already looked up with os_dev_lookup().  Callers that
+ * open the same device repeatedly can look it up once and skip the name
+ * match on every open.
+ *
+ * @param dev The device to open
+ * @param timo The timeout to open the device, if not specified.
+ * @param arg The argument to the device open() call.
+ *
+ * @return dev on success, NULL on failure.
+ */
+struct os_dev *os_dev_open_dev(struct os_dev *dev, uint32_t timo, void *arg);
+
 /**
  * Close a device.
  *
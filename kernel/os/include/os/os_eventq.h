@@ -39,6 +39,9 @@ extern "C" {
 
 struct os_event;
 typedef void os_event_fn(struct os_event *ev);
+#if MYNEWT_VAL(OS_EVENTQ_STATS)
+struct stats_os_eventq;
+#endif
 
 /**
  * Structure representing an OS event.  OS events get placed onto the
@@ -57,6 +60,10 @@ struct os_event {
     void *ev_arg;
 
     STAILQ_ENTRY(os_event) ev_next;
+#if MYNEWT_VAL(OS_EVENTQ_PROF)
+    /** os_cputime when the event was last queued. */
+    uint32_t ev_put_time;
+#endif
 };
 
 /** Return whether or not the given event is queued. */
@@ -78,6 +85,27 @@ struct os_eventq_mon {
 };
 #endif
 
+#if MYNEWT_VAL(OS_EVENTQ_WAITSET)
+struct os_eventq;
+
+/**
+ * A persistent set of event queues that a single task waits on.  Each member
+ * queue flags itself as ready in the set when an event is put on it, so
+ * waiting on the set costs time proportional to the number of ready queues
+ * rather than the number of member queues.
+ */
+struct os_eventq_waitset {
+    /** Task sleeping on this set, or NULL. */
+    struct os_task *ews_task;
+    /** Bit n is set when member queue n may have events. */
+    uint32_t ews_ready;
+    /** Bit n is set when slot n holds a member queue. */
+    uint32_t ews_used;
+    /** Member queues, indexed by their ready bit. */
+    struct os_eventq *ews_evqs[MYNEWT_VAL(OS_EVENTQ_WAITSET_MAX_QUEUES)];
+};
+#endif
+
 struct os_eventq {
     /** Pointer to task that "owns" this event queue. */
     struct os_task *evq_owner;
@@ -88,6 +116,10 @@ struct os_eventq {
     struct os_task *evq_task;
 
     STAILQ_HEAD(, os_event) evq_list;
+#if MYNEWT_VAL(OS_EVENTQ_PRIO)
+    /** Last event of the urgent lane at the head of evq_list, or NULL. */
+    struct os_event *evq_urgent_last;
+#endif
 
 #if MYNEWT_VAL(OS_EVENTQ_DEBUG)
     /** Most recently processed event. */
@@ -97,6 +129,16 @@ struct os_eventq {
     struct os_eventq_mon *evq_mon;
     int evq_mon_elems;
 #endif
+#if MYNEWT_VAL(OS_EVENTQ_STATS)
+    /** Batch dispatch statistics, or NULL if not registered. */
+    struct stats_os_eventq *evq_stats;
+#endif
+#if MYNEWT_VAL(OS_EVENTQ_WAITSET)
+    /** Wait set this queue is a member of, or NULL. */
+    struct os_eventq_waitset *evq_ws;
+    /** Index of this queue in its wait set. */
+    uint8_t evq_ws_idx;
+#endif
 };
 
 /**
@@ -121,6 +163,18 @@ int os_eventq_inited(const struct os_eventq *evq);
  */
 void os_eventq_put(struct os_eventq *, struct os_event *);
 
+#if MYNEWT_VAL(OS_EVENTQ_PRIO)
+/**
+ * Put an event on the urgent lane of the event queue.  Urgent events are
+ * dispatched in FIFO order among themselves, but ahead of any event queued
+ * with os_eventq_put().
+ *
+ * @param evq The event queue to put an event on
+ * @param ev The event to put on the queue
+ */
+void os_eventq_put_prio(struct os_eventq *evq, struct os_event *ev);
+#endif
+
 /**
  * Poll an event from the event queue and return it immediately.
  * If no event is available, don't block, just return NULL.
@@ -147,6 +201,22 @@ struct os_event *os_eventq_get(struct os_eventq *);
  */
 void os_eventq_run(struct os_eventq *evq);
 
+/**
+ * Pull events off the event queue and call their callbacks, blocking until
+ * at least one event is available.  Further events are dispatched without
+ * blocking until the queue is empty, max_events events have been handled,
+ * or max_ticks OS ticks have elapsed since the first event was dispatched.
+ * The time budget keeps an event flood from starving lower priority tasks.
+ *
+ * @param evq The event queue to pull the items off.
+ * @param max_events Maximum number of events to dispatch; must be > 0.
+ * @param max_ticks Time budget in OS ticks, or OS_TIMEOUT_NEVER for none.
+ *
+ * @return The number of events dispatched.
+ */
+int os_eventq_run_batch(struct os_eventq *evq, int max_events,
+                        os_time_t max_ticks);
+
 
 /**
  * Poll the list of event queues specified by the evq parameter
@@ -162,6 +232,57 @@ void os_eventq_run(struct os_eventq *evq);
  */
 struct os_event *os_eventq_poll(struct os_eventq **, int, os_time_t);
 
+#if MYNEWT_VAL(OS_EVENTQ_WAITSET)
+/**
+ * Initialize an empty event queue wait set.
+ *
+ * @param ws The wait set to initialize
+ */
+void os_eventq_waitset_init(struct os_eventq_waitset *ws);
+
+/**
+ * Add an event queue to a wait set.  A queue can be a member of at most one
+ * wait set.  Queues are polled in the order they were added, lowest free
+ * slot first.
+ *
+ * @param ws The wait set to add the queue to
+ * @param evq The event queue to add
+ *
+ * @return 0 on success;
+ *         OS_EINVAL if the queue already belongs to a wait set;
+ *         OS_ENOMEM if the wait set is full.
+ */
+int os_eventq_waitset_add(struct os_eventq_waitset *ws,
+                          struct os_eventq *evq);
+
+/**
+ * Remove an event queue from the wait set it belongs to.
+ *
+ * @param ws The wait set to remove the queue from
+ * @param evq The event queue to remove
+ *
+ * @return 0 on success; OS_EINVAL if the queue is not a member of the set.
+ */
+int os_eventq_waitset_remove(struct os_eventq_waitset *ws,
+                             struct os_eventq *evq);
+
+/**
+ * Wait for an event on any member queue of a wait set, and return the first
+ * event of the ready queue that was added to the set first.  Only the
+ * calling task may be waiting on the set.
+ *
+ * @param ws The wait set to wait on
+ * @param timo Timeout, forever if OS_WAIT_FOREVER is passed; 0 to not block.
+ * @param out_evq On success, the queue the event was taken from is written
+ *                here.  Pass NULL if not required.
+ *
+ * @return An event, or NULL if no events available
+ */
+struct os_event *os_eventq_waitset_poll(struct os_eventq_waitset *ws,
+                                        os_time_t timo,
+                                        struct os_eventq **out_evq);
+#endif
+
 /**
  * Remove an event from the queue.
  *
@@ -0,0 +1,60 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef H_OS_EVENTQ_PROF_
+#define H_OS_EVENTQ_PROF_
+
+#include <stdint.h>
+#include "syscfg/syscfg.h"
+#include "os/os_eventq.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if MYNEWT_VAL(OS_EVENTQ_PROF)
+
+/**
+ * Reports one dispatched event to the profiler.  Implemented by
+ * sys/evqprof.  Called from the task running the queue.
+ *
+ * @param evq                   The queue the event was taken from.
+ * @param cb                    The event's callback.
+ * @param wait                  os_cputime ticks from os_eventq_put() to
+ *                                  the start of the callback.
+ * @param run                   os_cputime ticks the callback ran for.
+ */
+void os_eventq_prof_record(const struct os_eventq *evq, os_event_fn *cb,
+                           uint32_t wait, uint32_t run);
+
+#else
+
+static inline void
+os_eventq_prof_record(const struct os_eventq *evq, os_event_fn *cb,
+                      uint32_t wait, uint32_t run)
+{
+}
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
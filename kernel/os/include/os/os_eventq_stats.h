@@ -0,0 +1,67 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef _OS_EVENTQ_STATS_H
+#define _OS_EVENTQ_STATS_H
+
+#include "os/os_eventq.h"
+#include "stats/stats.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Statistics collected by os_eventq_run_batch() for an event queue.  Times
+ * are in os_cputime ticks.
+ */
+STATS_SECT_START(os_eventq)
+    /** Number of os_eventq_run_batch() passes */
+    STATS_SECT_ENTRY(batches)
+    /** Number of events dispatched in batches */
+    STATS_SECT_ENTRY(events)
+    /** Largest number of events dispatched in a single pass */
+    STATS_SECT_ENTRY(batch_max)
+    /** Number of passes cut short by the time budget */
+    STATS_SECT_ENTRY(budget_hits)
+    /** Cumulative time spent dispatching */
+    STATS_SECT_ENTRY(dispatch_time)
+    /** Longest time spent in a single pass */
+    STATS_SECT_ENTRY(dispatch_max)
+STATS_SECT_END
+
+/**
+ * Register a statistics group for batch dispatch on an event queue.
+ *
+ * @param evq The event queue to collect statistics for
+ * @param stats Storage for the statistics; must stay valid while the queue
+ *              is in use.
+ * @param name Name of the statistics group
+ *
+ * @return 0 on success, non-zero on failure
+ */
+int os_eventq_stats_register(struct os_eventq *evq,
+                             struct stats_os_eventq *stats,
+                             const char *name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _OS_EVENTQ_STATS_H */
@@ -30,6 +30,7 @@
 #define H_OS_HEAP_
 
 #include <stddef.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -70,6 +71,34 @@ void os_free(void *mem);
  */
 void *os_realloc(void *ptr, size_t size);
 
+/**
+ * Usage information for the os_malloc() heap.
+ */
+struct os_heap_info {
+    /** Total number of bytes available for allocation. */
+    size_t ohi_total;
+    /** Number of bytes currently free. */
+    size_t ohi_free;
+    /** Size of the largest free contiguous region, in bytes. */
+    size_t ohi_largest_free;
+    /**
+     * External fragmentation of the large-block heap in percent: how much of
+     * its free memory is not part of the largest free region.
+     */
+    uint8_t ohi_frag_pct;
+};
+
+/**
+ * Retrieves usage information for the os_malloc() heap.
+ *
+ * @param ohi                   Filled in with heap information on success.
+ *
+ * @return                      0 on success;
+ *                              OS_ENOENT if the heap is not managed by the
+ *                                  OS (OS_HEAP_SLAB disabled).
+ */
+int os_heap_info_get(struct os_heap_info *ohi);
+
 #ifdef __cplusplus
 }
 #endif
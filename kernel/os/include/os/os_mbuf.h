@@ -102,12 +102,89 @@ struct os_mbuf {
 
     SLIST_ENTRY(os_mbuf) om_next;
 
+#if MYNEWT_VAL(OS_MBUF_SHARED)
+    /**
+     * The mbuf whose data buffer om_data points into, if it is not this
+     * mbuf's own (see os_mbuf_dup()).  NULL otherwise.
+     */
+    struct os_mbuf *om_owner;
+    /**
+     * References to this mbuf's memory block: one for the mbuf header
+     * itself, plus one for each mbuf whose om_owner is this mbuf.
+     */
+    volatile uint32_t om_refcnt;
+#endif
+
+#if MYNEWT_VAL(MSYS_QUOTA)
+    /**
+     * The msys consumer charged for this mbuf (see os_msys_consumer_get()),
+     * or NULL.
+     */
+    struct os_msys_consumer *om_consumer;
+#endif
+
     /**
      * Pointer to the beginning of the data, after this buffer
      */
     uint8_t om_databuf[0];
 };
 
+/**
+ * A scatter-gather entry describing one contiguous piece of an mbuf chain;
+ * see os_mbuf_to_iovec().  The layout matches struct crypto_iovec, so an
+ * array of these can be handed directly to the crypto driver.
+ */
+struct os_mbuf_iovec {
+    void *iov_base;
+    size_t iov_len;
+};
+
+/**
+ * A read position within an mbuf chain.  Cursor operations resume from the
+ * mbuf holding the current position instead of rewalking the chain from its
+ * head, so consuming a chain front to back takes linear time.  A cursor is
+ * only valid while the chain is neither modified nor freed.
+ */
+struct os_mbuf_cursor {
+    /** First mbuf in the chain */
+    const struct os_mbuf *omc_head;
+    /** Mbuf containing the current position */
+    const struct os_mbuf *omc_om;
+    /** Offset of the current position within omc_om */
+    uint16_t omc_off;
+    /** Offset of the current position within the chain */
+    int omc_pos;
+};
+
+#if MYNEWT_VAL(OS_MBUF_EXT)
+struct os_mbuf_ext;
+
+/**
+ * Called when the last mbuf referring to a piece of external storage is
+ * freed.  May run in any context that frees mbufs, including interrupts.
+ *
+ * @param ext                   The external storage that is now unused.
+ * @param arg                   The argument given to os_mbuf_ext_init().
+ */
+typedef void os_mbuf_ext_free_fn(struct os_mbuf_ext *ext, void *arg);
+
+/**
+ * Memory that is not owned by an mbuf pool (e.g. a static or flash-mapped
+ * buffer) but can be referenced by mbufs without copying.  The data is
+ * treated as read-only: mbufs referring to it report no leading or trailing
+ * space, and os_mbuf_copyinto() will not write to it (with OS_MBUF_SHARED
+ * it writes to a private copy instead).
+ */
+struct os_mbuf_ext {
+    uint8_t *ome_buf;
+    uint16_t ome_len;
+    /** Number of mbufs referring to this storage. */
+    volatile uint32_t ome_refcnt;
+    os_mbuf_ext_free_fn *ome_free_cb;
+    void *ome_arg;
+};
+#endif
+
 /**
  * Structure representing a queue of mbufs.
  */
@@ -117,6 +194,45 @@ struct os_mqueue {
     struct os_event mq_ev;
 };
 
+#if MYNEWT_VAL(MSYS_QUOTA)
+struct os_msys_consumer;
+
+/**
+ * Back-pressure callback; see os_msys_consumer_set_bp().  Called with
+ * congested set to 1 when the consumer's usage reaches its high watermark
+ * and 0 when it drops back to its low watermark.  It runs in the context
+ * that allocated or freed the mbuf, possibly an interrupt, and must not
+ * block.
+ */
+typedef void os_msys_bp_fn(struct os_msys_consumer *c, int congested,
+                           void *arg);
+
+/**
+ * A subsystem allocating from msys under a reservation and a limit.
+ * Counts are in mbufs, across all msys pools.
+ */
+struct os_msys_consumer {
+    /** Name, for diagnostics. */
+    const char *omsc_name;
+    /** Mbufs set aside for this consumer that nobody else may take. */
+    uint16_t omsc_reserved;
+    /** Maximum mbufs held at once; 0 for no limit. */
+    uint16_t omsc_limit;
+    /** Mbufs currently held. */
+    uint16_t omsc_in_use;
+    /** Highest value omsc_in_use has reached. */
+    uint16_t omsc_in_use_max;
+    /** Allocations refused by the quota or by an empty pool. */
+    uint32_t omsc_fails;
+
+    uint16_t omsc_high_wm;
+    uint16_t omsc_low_wm;
+    uint8_t omsc_congested;
+    os_msys_bp_fn *omsc_bp_cb;
+    void *omsc_bp_arg;
+};
+#endif
+
 /*
  * Given a flag number, provide the mask for it
  *
@@ -124,6 +240,22 @@ struct os_mqueue {
  */
 #define OS_MBUF_F_MASK(__n) (1 << (__n))
 
+/**
+ * Set in om_flags when the mbuf's data lives in external storage (see
+ * os_mbuf_get_ext()).  Other om_flags bits are available to the user.
+ */
+#define OS_MBUF_F_EXT       OS_MBUF_F_MASK(7)
+
+#if MYNEWT_VAL(OS_MBUF_EXT)
+/** Checks whether an mbuf refers to external storage. */
+#define OS_MBUF_IS_EXT(__om) (((__om)->om_flags & OS_MBUF_F_EXT) != 0)
+
+/** The external storage an OS_MBUF_IS_EXT() mbuf refers to. */
+#define OS_MBUF_EXT(__om) (*(struct os_mbuf_ext **)&(__om)->om_databuf[0])
+#else
+#define OS_MBUF_IS_EXT(__om) (0)
+#endif
+
 /*
  * Checks whether a given mbuf is a packet header mbuf
  *
@@ -173,6 +305,48 @@ struct os_mqueue {
     ((om)->om_pkthdr_len - sizeof (struct os_mbuf_pkthdr))
 
 
+/** @cond INTERNAL_HIDDEN */
+
+/* The mbuf whose data buffer holds the given mbuf's data. */
+static inline struct os_mbuf *
+_os_mbuf_data_block(struct os_mbuf *om)
+{
+#if MYNEWT_VAL(OS_MBUF_SHARED)
+    if (om->om_owner != NULL) {
+        return om->om_owner;
+    }
+#endif
+
+    return om;
+}
+
+/** @endcond */
+
+/**
+ * Indicates whether an mbuf's data may be modified in place: it is neither
+ * external storage nor shared with another mbuf.  Functions such as
+ * os_mbuf_copyinto() take a private copy of data that is not writable.
+ *
+ * @param om                    The mbuf to check.
+ *
+ * @return                      1 if the mbuf's data is writable; 0 if not.
+ */
+static inline int
+os_mbuf_writable(struct os_mbuf *om)
+{
+    if (OS_MBUF_IS_EXT(om)) {
+        return 0;
+    }
+
+#if MYNEWT_VAL(OS_MBUF_SHARED)
+    if (_os_mbuf_data_block(om)->om_refcnt != 1) {
+        return 0;
+    }
+#endif
+
+    return 1;
+}
+
 /** @cond INTERNAL_HIDDEN */
 
 /*
@@ -181,16 +355,23 @@ struct os_mqueue {
 static inline uint16_t
 _os_mbuf_leadingspace(struct os_mbuf *om)
 {
+    struct os_mbuf *blk;
     uint16_t startoff;
     uint16_t leadingspace;
 
+    if (!os_mbuf_writable(om)) {
+        return 0;
+    }
+
+    blk = _os_mbuf_data_block(om);
+
     startoff = 0;
-    if (OS_MBUF_IS_PKTHDR(om)) {
-        startoff = om->om_pkthdr_len;
+    if (OS_MBUF_IS_PKTHDR(blk)) {
+        startoff = blk->om_pkthdr_len;
     }
 
     leadingspace = (uint16_t) (OS_MBUF_DATA(om, uint8_t *) -
-        ((uint8_t *) &om->om_databuf[0] + startoff));
+        ((uint8_t *) &blk->om_databuf[0] + startoff));
 
     return (leadingspace);
 }
@@ -217,10 +398,16 @@ static inline uint16_t
 _os_mbuf_trailingspace(struct os_mbuf *om)
 {
     struct os_mbuf_pool *omp;
+    struct os_mbuf *blk;
+
+    if (!os_mbuf_writable(om)) {
+        return 0;
+    }
 
-    omp = om->om_omp;
+    blk = _os_mbuf_data_block(om);
+    omp = blk->om_omp;
 
-    return (&om->om_databuf[0] + omp->omp_databuf_len) -
+    return (&blk->om_databuf[0] + omp->omp_databuf_len) -
       (om->om_data + om->om_len);
 }
 
@@ -285,7 +472,8 @@ int os_mqueue_put(struct os_mqueue *, struct os_eventq *, struct os_mbuf *);
  *
  * Mbuf pools are created in the system initialization code, and then when
  * a mbuf is allocated out of msys, it will try and find the best fit based
- * upon estimated mbuf size.
+ * upon estimated mbuf size.  If the best fitting pool is exhausted, the next
+ * larger pool is used.
  *
  * os_msys_register() registers a mbuf pool with MSYS, and allows MSYS to
  * allocate mbufs out of it.
@@ -337,6 +525,82 @@ int os_msys_count(void);
  */
 int os_msys_num_free(void);
 
+#if MYNEWT_VAL(MSYS_QUOTA)
+/**
+ * Registers an msys consumer.  Mbufs reserved for a consumer are withheld
+ * from every other msys allocation, including plain os_msys_get() calls,
+ * until the consumer holds at least that many.
+ *
+ * Mbufs allocated through os_msys_consumer_get() and
+ * os_msys_consumer_get_pkthdr() are charged to the consumer, and so are the
+ * mbufs that os_mbuf_append() and the other chain-growing functions add
+ * after them; growth fails once the consumer's limit is reached.  Chains
+ * started with plain os_msys_get() grow without a reservation check.
+ *
+ * @param c                     The consumer to register.
+ * @param name                  Name of the consumer.
+ * @param reserved              Number of mbufs to reserve.
+ * @param limit                 Maximum number of mbufs the consumer may hold
+ *                                  at once; 0 for no limit.
+ *
+ * @return                      0 on success;
+ *                              SYS_EINVAL if limit is below reserved;
+ *                              SYS_ENOMEM if msys cannot cover the
+ *                                  reservation along with those of other
+ *                                  consumers.
+ */
+int os_msys_consumer_register(struct os_msys_consumer *c, const char *name,
+                              uint16_t reserved, uint16_t limit);
+
+/**
+ * Configures back-pressure notification for an msys consumer.  The callback
+ * fires once when the consumer comes to hold high_wm mbufs, and once more
+ * when usage falls back to low_wm, letting the consumer throttle its
+ * producer before allocations start to fail.
+ *
+ * @param c                     The consumer to configure.
+ * @param high_wm               Usage at which the consumer is congested;
+ *                                  0 disables notification.
+ * @param low_wm                Usage at which congestion clears; must be
+ *                                  below high_wm.
+ * @param cb                    The callback to invoke.
+ * @param arg                   Argument passed to the callback.
+ */
+void os_msys_consumer_set_bp(struct os_msys_consumer *c, uint16_t high_wm,
+                             uint16_t low_wm, os_msys_bp_fn *cb, void *arg);
+
+/**
+ * Allocates an mbuf from msys on behalf of a consumer; the consumer is
+ * charged until the mbuf is freed.  See os_msys_get().
+ *
+ * @param c                     The consumer to charge.
+ * @param dsize                 The estimated size of the data being stored.
+ * @param leadingspace          The amount of leadingspace to allocate.
+ *
+ * @return                      A freshly allocated mbuf on success;
+ *                              NULL if the consumer's quota is exhausted or
+ *                                  no mbuf is available.
+ */
+struct os_mbuf *os_msys_consumer_get(struct os_msys_consumer *c,
+                                     uint16_t dsize, uint16_t leadingspace);
+
+/**
+ * Allocates a packet header mbuf from msys on behalf of a consumer; the
+ * consumer is charged until the mbuf is freed.  See os_msys_get_pkthdr().
+ *
+ * @param c                     The consumer to charge.
+ * @param dsize                 The estimated size of the data being stored.
+ * @param user_hdr_len          The length of the user packet header.
+ *
+ * @return                      A freshly allocated mbuf on success;
+ *                              NULL if the consumer's quota is exhausted or
+ *                                  no mbuf is available.
+ */
+struct os_mbuf *os_msys_consumer_get_pkthdr(struct os_msys_consumer *c,
+                                            uint16_t dsize,
+                                            uint16_t user_hdr_len);
+#endif
+
 /**
  * Initialize a pool of mbufs.
  *
@@ -376,6 +640,11 @@ struct os_mbuf *os_mbuf_get_pkthdr(struct os_mbuf_pool *omp,
 /**
  * Duplicate a chain of mbufs.  Return the start of the duplicated chain.
  *
+ * With OS_MBUF_SHARED enabled, the duplicate refers to the original data,
+ * which is copied only when either chain writes to it.  Each duplicate
+ * mbuf still takes a full block from the pool, and the original blocks stay
+ * allocated until the last reference to them is freed.
+ *
  * @param omp The mbuf pool to duplicate out of
  * @param om  The mbuf chain to duplicate
  *
@@ -570,7 +839,16 @@ struct os_mbuf *os_mbuf_prepend_pullup(struct os_mbuf *om, uint16_t len);
  * @param src                   The source buffer to copy from.
  * @param len                   The number of bytes to copy.
  *
- * @return                      0 on success; nonzero on failure.
+ * Data shared with other mbufs (see os_mbuf_dup()) is copied before it is
+ * written, so other chains are unaffected.
+ *
+ * @return                      0 on success;
+ *                              SYS_EACCES if the range overlaps external
+ *                                  storage and OS_MBUF_SHARED is disabled;
+ *                              SYS_ENOMEM if a private copy of shared or
+ *                                  external data could not be made;
+ *                              other nonzero on failure.
+ *                              Nothing is written on failure.
  */
 int os_mbuf_copyinto(struct os_mbuf *om, int off, const void *src, int len);
 
@@ -644,6 +922,168 @@ struct os_mbuf *os_mbuf_trim_front(struct os_mbuf *om);
  */
 int os_mbuf_widen(struct os_mbuf *om, uint16_t off, uint16_t len);
 
+/**
+ * Describes a range of an mbuf chain as a list of contiguous pieces, without
+ * copying.  The result can be used as a crypto_iovec array or to program
+ * scatter-gather DMA.  The entries are only valid while the chain is neither
+ * modified nor freed.
+ *
+ * @param om                    The mbuf chain to describe.
+ * @param off                   Offset within the chain of the first byte.
+ * @param len                   Number of bytes to describe.
+ * @param iov                   Filled in with the pieces, in order.
+ * @param max_iov               Number of entries available in iov.
+ *
+ * @return                      The number of entries filled in on success;
+ *                              SYS_EINVAL if the range extends past the end
+ *                                  of the chain;
+ *                              SYS_ENOMEM if more than max_iov entries are
+ *                                  needed.
+ */
+int os_mbuf_to_iovec(struct os_mbuf *om, int off, int len,
+                     struct os_mbuf_iovec *iov, int max_iov);
+
+/**
+ * Initializes a cursor at the start of an mbuf chain.
+ *
+ * @param omc                   The cursor to initialize.
+ * @param om                    The chain to read.
+ */
+void os_mbuf_cursor_init(struct os_mbuf_cursor *omc,
+                         const struct os_mbuf *om);
+
+/**
+ * Moves a cursor to an absolute offset within its chain.  Seeking forward,
+ * or backward within the current mbuf, continues from the current position;
+ * seeking further back restarts from the head of the chain.
+ *
+ * @param omc                   The cursor to move.
+ * @param off                   The new offset; may equal the chain length.
+ *
+ * @return                      0 on success;
+ *                              SYS_EINVAL if the offset is past the end of
+ *                                  the chain.  The cursor is unchanged.
+ */
+int os_mbuf_cursor_seek(struct os_mbuf_cursor *omc, int off);
+
+/**
+ * Advances a cursor by the specified number of bytes.
+ *
+ * @param omc                   The cursor to advance.
+ * @param len                   The number of bytes to skip.
+ *
+ * @return                      0 on success;
+ *                              SYS_EINVAL if fewer than len bytes remain.
+ *                                  The cursor is unchanged.
+ */
+int os_mbuf_cursor_skip(struct os_mbuf_cursor *omc, int len);
+
+/**
+ * Retrieves the contiguous run of bytes starting at a cursor, i.e., the rest
+ * of the current mbuf.  The cursor is not moved.
+ *
+ * @param omc                   The cursor to read at.
+ * @param out_len               On success, the length of the run.
+ *
+ * @return                      A pointer to the run;
+ *                              NULL if the cursor is at the end of the chain.
+ */
+const uint8_t *os_mbuf_cursor_span(const struct os_mbuf_cursor *omc,
+                                   uint16_t *out_len);
+
+/**
+ * Copies data from a cursor's position into a flat buffer without moving
+ * the cursor.
+ *
+ * @param omc                   The cursor to read at.
+ * @param dst                   The buffer to copy into.
+ * @param len                   The number of bytes to copy.
+ *
+ * @return                      0 on success;
+ *                              SYS_EINVAL if fewer than len bytes remain.
+ */
+int os_mbuf_cursor_peek(const struct os_mbuf_cursor *omc, void *dst,
+                        int len);
+
+/**
+ * Copies data from a cursor's position into a flat buffer and advances the
+ * cursor past it.
+ *
+ * @param omc                   The cursor to read from.
+ * @param dst                   The buffer to copy into.
+ * @param len                   The number of bytes to copy.
+ *
+ * @return                      0 on success;
+ *                              SYS_EINVAL if fewer than len bytes remain.
+ *                                  The cursor is unchanged.
+ */
+int os_mbuf_cursor_read(struct os_mbuf_cursor *omc, void *dst, int len);
+
+/**
+ * Compares the data at a cursor's position against a flat buffer without
+ * moving the cursor.
+ *
+ * @param omc                   The cursor to compare at.
+ * @param data                  The flat buffer to compare.
+ * @param len                   The length of the flat buffer.
+ *
+ * @return                      0 if both memory regions are identical;
+ *                              A memcmp return code if there is a mismatch;
+ *                              INT_MAX if the chain is too short.
+ */
+int os_mbuf_cursor_cmp(const struct os_mbuf_cursor *omc, const void *data,
+                       int len);
+
+#if MYNEWT_VAL(OS_MBUF_EXT)
+/**
+ * Initializes a piece of external storage so that it can be attached to
+ * mbufs.  The storage must remain valid until its free callback runs.
+ *
+ * @param ext                   The external storage descriptor.
+ * @param buf                   The data.
+ * @param len                   Size of the data, in bytes.
+ * @param free_cb               Called when the last mbuf referring to the
+ *                                  storage is freed; may be NULL.
+ * @param arg                   Argument passed to free_cb.
+ */
+void os_mbuf_ext_init(struct os_mbuf_ext *ext, void *buf, uint16_t len,
+                      os_mbuf_ext_free_fn *free_cb, void *arg);
+
+/**
+ * Allocates an mbuf whose data is a range of external storage rather than
+ * its own data buffer.  Only the mbuf header is taken from the pool; the
+ * storage gains a reference that is dropped when the mbuf is freed.
+ *
+ * @param omp                   The mbuf pool to allocate the header from.
+ * @param ext                   The external storage to refer to.
+ * @param off                   Offset of the range within the storage.
+ * @param len                   Length of the range.
+ *
+ * @return                      The new mbuf on success;
+ *                              NULL if the range is invalid or the pool is
+ *                                  exhausted.
+ */
+struct os_mbuf *os_mbuf_get_ext(struct os_mbuf_pool *omp,
+                                struct os_mbuf_ext *ext, uint16_t off,
+                                uint16_t len);
+
+/**
+ * Appends a range of external storage to the end of an mbuf chain without
+ * copying it.  If the chain has a packet header, its length is updated.
+ *
+ * @param om                    The mbuf chain to append to.
+ * @param ext                   The external storage to refer to.
+ * @param off                   Offset of the range within the storage.
+ * @param len                   Length of the range.
+ *
+ * @return                      0 on success;
+ *                              SYS_EINVAL if the range is invalid;
+ *                              SYS_ENOMEM if no mbuf is available.
+ */
+int os_mbuf_append_ext(struct os_mbuf *om, struct os_mbuf_ext *ext,
+                       uint16_t off, uint16_t len);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -68,6 +68,17 @@ struct os_mempool {
     uint32_t mp_membuf_addr;
     STAILQ_ENTRY(os_mempool) mp_list;
     SLIST_HEAD(,os_memblock);
+#if MYNEWT_VAL(OS_MEMPOOL_LOCKFREE)
+    /**
+     * Lock-free free list head.  The low 16 bits hold the index of the first
+     * free block plus one (0 if the pool is empty), the high 16 bits a tag
+     * that changes on every update.  Replaces the SLIST head above, which is
+     * only valid right after initialization.
+     */
+    uint32_t mp_lf_head;
+    /** The number of blocks currently allocated. */
+    uint32_t mp_lf_used;
+#endif
     /** Name for memory block */
     char *name;
 };
@@ -109,6 +120,20 @@ struct os_mempool_ext {
     void *mpe_put_arg;
 };
 
+/**
+ * A small cache of blocks owned by a single context (a task or an interrupt
+ * handler).  Blocks are taken from and returned to the magazine without any
+ * synchronization; the magazine exchanges blocks with its pool in batches.
+ * A magazine must never be used from more than one context.
+ *
+ * All fields should be considered private.
+ */
+struct os_mempool_mag {
+    struct os_mempool *mm_pool;
+    uint8_t mm_count;
+    void *mm_blocks[MYNEWT_VAL(OS_MEMPOOL_MAG_SIZE)];
+};
+
 #define OS_MEMPOOL_INFO_NAME_LEN (32)
 
 /**
@@ -273,6 +298,43 @@ os_error_t os_memblock_put_from_cb(struct os_mempool *mp, void *block_addr);
  */
 os_error_t os_memblock_put(struct os_mempool *mp, void *block_addr);
 
+/**
+ * Initializes a per-context block magazine for the specified pool.
+ *
+ * @param mag                   The magazine to initialize.
+ * @param mp                    The pool that backs the magazine.
+ */
+void os_mempool_mag_init(struct os_mempool_mag *mag, struct os_mempool *mp);
+
+/**
+ * Gets a block from a magazine, refilling the magazine from its pool if it is
+ * empty.
+ *
+ * @param mag                   The magazine to get a block from.
+ *
+ * @return                      Pointer to block if available; NULL otherwise.
+ */
+void *os_mempool_mag_get(struct os_mempool_mag *mag);
+
+/**
+ * Puts a block into a magazine, returning blocks to the pool if the magazine
+ * is full.  Blocks of an extended pool with a put callback bypass the
+ * magazine so the callback always runs.
+ *
+ * @param mag                   The magazine to put the block into.
+ * @param block_addr            The block to free.
+ *
+ * @return                      0 on success; nonzero on failure.
+ */
+os_error_t os_mempool_mag_put(struct os_mempool_mag *mag, void *block_addr);
+
+/**
+ * Returns all blocks cached in a magazine to its pool.
+ *
+ * @param mag                   The magazine to flush.
+ */
+void os_mempool_mag_flush(struct os_mempool_mag *mag);
+
 #ifdef __cplusplus
 }
 #endif
@@ -46,8 +46,19 @@ struct os_mutex {
     uint16_t    mu_level;
     /** Task that owns the mutex */
     struct os_task *mu_owner;
+#if MYNEWT_VAL(OS_MUTEX_PRIO_CHAIN)
+    /** Priority ceiling, valid if OS_MUTEX_F_CEILING is set */
+    uint8_t     mu_ceiling;
+    /** Mutex flags, bitmask */
+    uint8_t     mu_flags;
+    /** Entry in the owner's list of held mutexes */
+    SLIST_ENTRY(os_mutex) mu_next;
+#endif
 };
 
+/** Mutex raises its owner to mu_ceiling while held */
+#define OS_MUTEX_F_CEILING          (0x01U)
+
 /*
   XXX: NOTES
     -> Should we add a magic number or flag to the mutex structure so
@@ -74,6 +85,24 @@ os_mutex_inspect();
  */
 os_error_t os_mutex_init(struct os_mutex *mu);
 
+#if MYNEWT_VAL(OS_MUTEX_PRIO_CHAIN)
+/**
+ * Create a priority ceiling mutex.  The owner of the mutex runs at the
+ * ceiling priority (or higher, if inherited) for as long as it holds the
+ * mutex.  Acquiring an uncontended ceiling mutex does not need to walk any
+ * wait list.  The ceiling should be the priority of the highest priority
+ * task that locks the mutex.
+ *
+ * @param mu Pointer to mutex
+ * @param ceiling Ceiling priority
+ *
+ * @return os_error_t
+ *      OS_INVALID_PARM     Mutex passed in was NULL.
+ *      OS_OK               no error.
+ */
+os_error_t os_mutex_init_ceiling(struct os_mutex *mu, uint8_t ceiling);
+#endif
+
 /**
  * Release a mutex.
  *
@@ -62,6 +62,13 @@ struct os_sanity_check {
 /** @cond INTERNAL_HIDDEN */
 int os_sanity_init(void);
 void os_sanity_run(void);
+
+/*
+ * Performs the sanity checks as of the given time.  Returns the first check
+ * that failed or missed its deadline, or NULL if all passed.  os_sanity_run()
+ * asserts on a failure; this lets the checks be exercised without one.
+ */
+struct os_sanity_check *os_sanity_run_at(os_time_t now);
 /** @endcond */
 
 struct os_task;
@@ -95,7 +102,8 @@ int os_sanity_check_register(struct os_sanity_check *);
 
 /**
  * Reset the os sanity check, so that it doesn't trip up the
- * sanity timer.
+ * sanity timer.  This does not lock, so tasks can check in as often as
+ * they like.
  *
  * @param sc The sanity check to reset
  *
@@ -40,13 +40,39 @@ struct os_task;
 TAILQ_HEAD(os_task_list, os_task);
 
 extern struct os_task *g_current_task;
+#if MYNEWT_VAL(OS_SCHED_PRIO_BITMAP)
+extern struct os_task *g_os_run_top;
+#else
 extern struct os_task_list g_os_run_list;
+#endif
 extern struct os_task_list g_os_sleep_list;
 
 void os_sched_ctx_sw_hook(struct os_task *);
 
 /** @endcond */
 
+#if MYNEWT_VAL(OS_TASK_CPU_STATS)
+/**
+ * System wide CPU time statistics, in os_cputime ticks.
+ */
+struct os_cpu_stats {
+    /** Time spent in interrupt handlers */
+    uint64_t ocs_isr_time;
+    /** Time spent in the idle task */
+    uint64_t ocs_idle_time;
+    /** Number of interrupt handler invocations */
+    uint32_t ocs_isr_cnt;
+};
+
+/**
+ * Retrieves system wide CPU time statistics.  Per task times are reported
+ * through os_task_info_get_next().
+ *
+ * @param ocs The structure to fill in
+ */
+void os_cpu_stats_get(struct os_cpu_stats *ocs);
+#endif
+
 /**
  * Returns the currently running task. Note that this task may or may not be
  * the highest priority task ready to run.
@@ -92,6 +118,7 @@ struct os_task *os_sched_next_task(void);
 void os_sched(struct os_task *);
 
 /** @cond INTERNAL_HIDDEN */
+void os_sched_init(void);
 void os_sched_os_timer_exp(void);
 os_error_t os_sched_insert(struct os_task *);
 int os_sched_sleep(struct os_task *, os_time_t nticks);
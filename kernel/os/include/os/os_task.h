@@ -78,6 +78,8 @@ typedef enum os_task_state {
 
 typedef void (*os_task_func_t)(void *);
 
+struct os_mutex;
+
 #define OS_TASK_MAX_NAME_LEN (32)
 
 /**
@@ -127,6 +129,29 @@ struct os_task {
     STAILQ_ENTRY(os_task) t_os_task_list;
     TAILQ_ENTRY(os_task) t_os_list;
     SLIST_ENTRY(os_task) t_obj_list;
+
+#if MYNEWT_VAL(OS_SCHED_PRIO_BITMAP)
+    /** Priority level of the ready list this task is queued on */
+    uint8_t t_rdy_prio;
+#endif
+#if MYNEWT_VAL(OS_SCHED_SLEEP_HEAP)
+    /** Position of this task in the sleep heap */
+    uint8_t t_sleep_idx;
+#endif
+#if MYNEWT_VAL(OS_TASK_CPU_STATS)
+    /** Total task run time in os_cputime ticks, excluding interrupts */
+    uint64_t t_cpu_time;
+#endif
+#if MYNEWT_VAL(OS_MUTEX_PRIO_CHAIN)
+    /** Priority the task was created with, before any inheritance */
+    uint8_t t_base_prio;
+    /** Mutexes currently owned by this task */
+    SLIST_HEAD(, os_mutex) t_mutex_list;
+#endif
+#if MYNEWT_VAL(OS_CTX_SW_STACK_SAMPLE)
+    /** Lowest stack pointer saved at a context switch */
+    os_stack_t *t_stack_low;
+#endif
 };
 
 /** @cond INTERNAL_HIDDEN */
@@ -191,6 +216,10 @@ struct os_task_info {
     uint32_t oti_cswcnt;
     /** Task runtime */
     uint32_t oti_runtime;
+#if MYNEWT_VAL(OS_TASK_CPU_STATS)
+    /** Task runtime in os_cputime ticks, excluding interrupts */
+    uint64_t oti_cputime;
+#endif
     /** Last time this task checked in with sanity */
     os_time_t oti_last_checkin;
     /** Next time this task is scheduled to check-in with sanity */
@@ -22,9 +22,15 @@
 
 #ifdef __ASSEMBLER__
 
+#if MYNEWT_VAL(OS_TRACE_RING)
+#define os_trace_isr_enter              tracering_isr_enter
+#define os_trace_isr_exit               tracering_isr_exit
+#define os_trace_task_start_exec        tracering_task_start_exec
+#else
 #define os_trace_isr_enter              SEGGER_SYSVIEW_RecordEnterISR
 #define os_trace_isr_exit               SEGGER_SYSVIEW_RecordExitISR
 #define os_trace_task_start_exec        SEGGER_SYSVIEW_OnTaskStartExec
+#endif
 
 #else
 
@@ -34,6 +40,9 @@
 #if MYNEWT_VAL(OS_SYSVIEW)
 #include "sysview/vendor/SEGGER_SYSVIEW.h"
 #endif
+#if MYNEWT_VAL(OS_TRACE_RING)
+#include "tracering/tracering.h"
+#endif
 #include "os/os.h"
 
 #define OS_TRACE_ID_EVENTQ_PUT                  (40)
@@ -42,6 +51,7 @@
 #define OS_TRACE_ID_EVENTQ_REMOVE               (43)
 #define OS_TRACE_ID_EVENTQ_POLL_0TIMO           (44)
 #define OS_TRACE_ID_EVENTQ_POLL                 (45)
+#define OS_TRACE_ID_EVENTQ_WAITSET_POLL         (46)
 #define OS_TRACE_ID_MUTEX_INIT                  (50)
 #define OS_TRACE_ID_MUTEX_RELEASE               (51)
 #define OS_TRACE_ID_MUTEX_PEND                  (52)
@@ -59,6 +69,21 @@
 #define OS_TRACE_ID_MBUF_GET_PKTHDR             (91)
 #define OS_TRACE_ID_MBUF_FREE                   (92)
 #define OS_TRACE_ID_MBUF_FREE_CHAIN             (93)
+#define OS_TRACE_ID_BUS_READ                    (100)
+#define OS_TRACE_ID_BUS_WRITE                   (101)
+#define OS_TRACE_ID_BUS_WRITE_READ              (102)
+#define OS_TRACE_ID_BUS_LOCK                    (103)
+#define OS_TRACE_ID_BUS_UNLOCK                  (104)
+#define OS_TRACE_ID_FLASH_WRITE                 (110)
+#define OS_TRACE_ID_FLASH_ERASE_SECTOR          (111)
+#define OS_TRACE_ID_FLASH_ERASE                 (112)
+#define OS_TRACE_ID_FLASH_WRITE_START           (113)
+#define OS_TRACE_ID_FLASH_ERASE_SECTOR_START    (114)
+
+#if MYNEWT_VAL(OS_TASK_CPU_STATS)
+void os_sched_isr_enter(void);
+void os_sched_isr_exit(void);
+#endif
 
 #if MYNEWT_VAL(OS_SYSVIEW)
 
@@ -91,6 +116,9 @@ os_trace_module_desc(const os_trace_module_t *m, const char *desc)
 static inline void
 os_trace_isr_enter(void)
 {
+#if MYNEWT_VAL(OS_TASK_CPU_STATS)
+    os_sched_isr_enter();
+#endif
     SEGGER_SYSVIEW_RecordEnterISR();
 }
 
@@ -98,6 +126,9 @@ static inline void
 os_trace_isr_exit(void)
 {
     SEGGER_SYSVIEW_RecordExitISR();
+#if MYNEWT_VAL(OS_TASK_CPU_STATS)
+    os_sched_isr_exit();
+#endif
 }
 
 static inline void
@@ -204,16 +235,137 @@ os_trace_api_ret_u32(unsigned id, uint32_t ret)
 
 #endif /* MYNEWT_VAL(OS_SYSVIEW) && !defined(OS_TRACE_DISABLE_FILE_API) */
 
-#if !MYNEWT_VAL(OS_SYSVIEW)
+#if MYNEWT_VAL(OS_TRACE_RING)
 
 static inline void
 os_trace_isr_enter(void)
 {
+#if MYNEWT_VAL(OS_TASK_CPU_STATS)
+    os_sched_isr_enter();
+#endif
+    tracering_isr_enter();
 }
 
 static inline void
 os_trace_isr_exit(void)
 {
+    tracering_isr_exit();
+#if MYNEWT_VAL(OS_TASK_CPU_STATS)
+    os_sched_isr_exit();
+#endif
+}
+
+static inline void
+os_trace_task_info(const struct os_task *t)
+{
+}
+
+static inline void
+os_trace_task_create(const struct os_task *t)
+{
+    tracering_rec(TRACERING_EV_TASK_CREATE, 0, 1, (uintptr_t)t, 0, 0);
+}
+
+static inline void
+os_trace_task_start_exec(const struct os_task *t)
+{
+    tracering_task_start_exec(t);
+}
+
+static inline void
+os_trace_task_stop_exec(void)
+{
+    tracering_rec(TRACERING_EV_TASK_STOP_EXEC, 0, 0, 0, 0, 0);
+}
+
+static inline void
+os_trace_task_start_ready(const struct os_task *t)
+{
+    tracering_rec(TRACERING_EV_TASK_READY, 0, 1, (uintptr_t)t, 0, 0);
+}
+
+static inline void
+os_trace_task_stop_ready(const struct os_task *t, unsigned reason)
+{
+    tracering_rec(TRACERING_EV_TASK_BLOCK, 0, 2, (uintptr_t)t, reason, 0);
+}
+
+static inline void
+os_trace_idle(void)
+{
+    tracering_rec(TRACERING_EV_IDLE, 0, 0, 0, 0, 0);
+}
+
+static inline void
+os_trace_user_start(unsigned id)
+{
+    tracering_rec(TRACERING_EV_USER_START, 0, 1, id, 0, 0);
+}
+
+static inline void
+os_trace_user_stop(unsigned id)
+{
+    tracering_rec(TRACERING_EV_USER_STOP, 0, 1, id, 0, 0);
+}
+
+#endif /* MYNEWT_VAL(OS_TRACE_RING) */
+
+#if MYNEWT_VAL(OS_TRACE_RING) && !defined(OS_TRACE_DISABLE_FILE_API)
+
+static inline void
+os_trace_api_void(unsigned id)
+{
+    tracering_rec(TRACERING_EV_API, id, 0, 0, 0, 0);
+}
+
+static inline void
+os_trace_api_u32(unsigned id, uint32_t p0)
+{
+    tracering_rec(TRACERING_EV_API, id, 1, p0, 0, 0);
+}
+
+static inline void
+os_trace_api_u32x2(unsigned id, uint32_t p0, uint32_t p1)
+{
+    tracering_rec(TRACERING_EV_API, id, 2, p0, p1, 0);
+}
+
+static inline void
+os_trace_api_u32x3(unsigned id, uint32_t p0, uint32_t p1, uint32_t p2)
+{
+    tracering_rec(TRACERING_EV_API, id, 3, p0, p1, p2);
+}
+
+static inline void
+os_trace_api_ret(unsigned id)
+{
+    tracering_rec(TRACERING_EV_API_RET, id, 0, 0, 0, 0);
+}
+
+static inline void
+os_trace_api_ret_u32(unsigned id, uint32_t ret)
+{
+    tracering_rec(TRACERING_EV_API_RET, id, 1, ret, 0, 0);
+}
+
+#endif /* MYNEWT_VAL(OS_TRACE_RING) && !defined(OS_TRACE_DISABLE_FILE_API) */
+
+#if !MYNEWT_VAL(OS_SYSVIEW) && !MYNEWT_VAL(OS_TRACE_RING)
+
+static inline void
+os_trace_isr_enter(void)
+{
+#if MYNEWT_VAL(OS_TASK_CPU_STATS)
+    os_sched_isr_enter();
+#endif
+}
+
+static inline void
+os_trace_isr_exit(void)
+{
+#if MYNEWT_VAL(OS_TASK_CPU_STATS)
+    os_sched_isr_exit();
+#endif
 }
 
 static inline void
@@ -261,9 +413,10 @@ os_trace_user_stop(unsigned id)
 {
 }
 
-#endif /* !MYNEWT_VAL(OS_SYSVIEW) */
+#endif /* !MYNEWT_VAL(OS_SYSVIEW) && !MYNEWT_VAL(OS_TRACE_RING) */
 
-#if !MYNEWT_VAL(OS_SYSVIEW) || defined(OS_TRACE_DISABLE_FILE_API)
+#if (!MYNEWT_VAL(OS_SYSVIEW) && !MYNEWT_VAL(OS_TRACE_RING)) || \
+    defined(OS_TRACE_DISABLE_FILE_API)
 
 static inline void
 os_trace_api_void(unsigned id)
@@ -295,7 +448,8 @@ os_trace_api_ret_u32(unsigned id, uint32_t return_value)
 {
 }
 
-#endif /* !MYNEWT_VAL(OS_SYSVIEW) || defined(OS_TRACE_DISABLE_FILE_API) */
+#endif /* (!MYNEWT_VAL(OS_SYSVIEW) && !MYNEWT_VAL(OS_TRACE_RING)) ||
+        * defined(OS_TRACE_DISABLE_FILE_API) */
 
 #endif /* __ASSEMBLER__ */
 
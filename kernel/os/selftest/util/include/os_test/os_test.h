@@ -31,10 +31,23 @@ TEST_SUITE_DECL(os_sem_test_suite);
 TEST_SUITE_DECL(os_mempool_test_suite);
 TEST_SUITE_DECL(os_time_test_suite);
 TEST_SUITE_DECL(os_mbuf_test_suite);
+TEST_SUITE_DECL(os_msys_test_suite);
 TEST_SUITE_DECL(os_eventq_test_suite);
 TEST_SUITE_DECL(os_callout_test_suite);
+TEST_SUITE_DECL(os_sched_test_suite);
+TEST_SUITE_DECL(os_atomic_test_suite);
+TEST_SUITE_DECL(os_dev_test_suite);
+TEST_SUITE_DECL(os_heap_test_suite);
+TEST_SUITE_DECL(os_sanity_test_suite);
 
 TEST_CASE_DECL(os_time_test_change);
+#if MYNEWT_VAL(OS_TIMESTAMP)
+TEST_CASE_DECL(os_time_test_timestamp);
+#endif
+TEST_CASE_DECL(os_atomic_test_ops);
+TEST_CASE_DECL(os_dev_test_lookup);
+TEST_CASE_DECL(os_sanity_test_rekey);
+TEST_CASE_DECL(os_sanity_test_missed);
 
 int os_test_all(void);
 
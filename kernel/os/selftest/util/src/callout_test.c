@@ -228,10 +228,18 @@ callout_task_stop_listen(void *arg)
 TEST_CASE_DECL(callout_test_speak)
 TEST_CASE_DECL(callout_test_stop)
 TEST_CASE_DECL(callout_test)
+TEST_CASE_DECL(callout_test_order)
+#if MYNEWT_VAL(OS_CALLOUT_SLACK)
+TEST_CASE_DECL(callout_test_slack)
+#endif
 
 TEST_SUITE(os_callout_test_suite)
 {
     callout_test();
     callout_test_stop();
     callout_test_speak();
+    callout_test_order();
+#if MYNEWT_VAL(OS_CALLOUT_SLACK)
+    callout_test_slack();
+#endif
 }
@@ -76,6 +76,13 @@ TEST_CASE_DECL(event_test_poll_sr)
 TEST_CASE_DECL(event_test_poll_timeout_sr)
 TEST_CASE_DECL(event_test_poll_single_sr)
 TEST_CASE_DECL(event_test_poll_0timo)
+#if MYNEWT_VAL(OS_EVENTQ_WAITSET)
+TEST_CASE_DECL(event_test_waitset)
+#endif
+TEST_CASE_DECL(event_test_run_batch)
+#if MYNEWT_VAL(OS_EVENTQ_PRIO)
+TEST_CASE_DECL(event_test_put_prio)
+#endif
 
 /* This is the task function  to send data */
 void
@@ -259,4 +266,11 @@ TEST_SUITE(os_eventq_test_suite)
     event_test_poll_timeout_sr();
     event_test_poll_single_sr();
     event_test_poll_0timo();
+#if MYNEWT_VAL(OS_EVENTQ_WAITSET)
+    event_test_waitset();
+#endif
+    event_test_run_batch();
+#if MYNEWT_VAL(OS_EVENTQ_PRIO)
+    event_test_put_prio();
+#endif
 }
@@ -0,0 +1,78 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+#include "os_test_priv.h"
+
+/**
+ * Looks up the os_malloc() slab of the specified block size in the list of
+ * registered mempools.
+ */
+struct os_mempool *
+heap_test_slab_pool(int size)
+{
+    struct os_mempool_info omi;
+    struct os_mempool *mp;
+    char name[sizeof omi.omi_name];
+
+    snprintf(name, sizeof name, "os_heap_%d", size);
+
+    mp = NULL;
+    while (1) {
+        mp = os_mempool_info_get_next(mp, &omi);
+        if (mp == NULL || strcmp(omi.omi_name, name) == 0) {
+            return mp;
+        }
+    }
+}
+
+/**
+ * Retrieves heap usage information and checks that it is consistent.
+ */
+void
+heap_test_info_assert(struct os_heap_info *ohi)
+{
+    int rc;
+
+    rc = os_heap_info_get(ohi);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(ohi->ohi_free <= ohi->ohi_total);
+    TEST_ASSERT(ohi->ohi_largest_free <= ohi->ohi_free);
+    TEST_ASSERT(ohi->ohi_frag_pct <= 100);
+}
+
+TEST_CASE_DECL(os_heap_test_info)
+#if MYNEWT_VAL(OS_HEAP_SLAB)
+TEST_CASE_DECL(os_heap_test_slab)
+TEST_CASE_DECL(os_heap_test_tlsf)
+TEST_CASE_DECL(os_heap_test_realloc)
+#endif
+
+TEST_SUITE(os_heap_test_suite)
+{
+    os_heap_test_info();
+#if MYNEWT_VAL(OS_HEAP_SLAB)
+    os_heap_test_slab();
+    os_heap_test_tlsf();
+    os_heap_test_realloc();
+#endif
+}
@@ -31,7 +31,7 @@
 
 #define MBUF_TEST_DATA_LEN          (1024)
 
-os_membuf_t os_mbuf_membuf[OS_MEMPOOL_SIZE(MBUF_TEST_POOL_BUF_SIZE,
+os_membuf_t os_mbuf_membuf[OS_MEMPOOL_SIZE(MBUF_TEST_POOL_BLOCK_SIZE,
         MBUF_TEST_POOL_BUF_COUNT)];
 
 struct os_mbuf_pool os_mbuf_pool;
@@ -45,11 +45,11 @@ os_mbuf_test_setup(void)
     int i;
 
     rc = os_mempool_init(&os_mbuf_mempool, MBUF_TEST_POOL_BUF_COUNT,
-            MBUF_TEST_POOL_BUF_SIZE, &os_mbuf_membuf[0], "mbuf_pool");
+            MBUF_TEST_POOL_BLOCK_SIZE, &os_mbuf_membuf[0], "mbuf_pool");
     TEST_ASSERT_FATAL(rc == 0, "Error creating memory pool %d", rc);
 
     rc = os_mbuf_pool_init(&os_mbuf_pool, &os_mbuf_mempool,
-            MBUF_TEST_POOL_BUF_SIZE, MBUF_TEST_POOL_BUF_COUNT);
+            MBUF_TEST_POOL_BLOCK_SIZE, MBUF_TEST_POOL_BUF_COUNT);
     TEST_ASSERT_FATAL(rc == 0, "Error creating mbuf pool %d", rc);
 
     for (i = 0; i < sizeof os_mbuf_test_data; i++) {
@@ -61,6 +61,7 @@ void
 os_mbuf_test_misc_assert_sane(struct os_mbuf *om, void *data,
                               int buflen, int pktlen, int pkthdr_len)
 {
+    struct os_mbuf *blk;
     uint8_t *data_min;
     uint8_t *data_max;
     int totlen;
@@ -79,8 +80,11 @@ os_mbuf_test_misc_assert_sane(struct os_mbuf *om, void *data,
             TEST_ASSERT(om->om_pkthdr_len == pkthdr_len);
         }
 
-        data_min = om->om_databuf + om->om_pkthdr_len;
-        data_max = om->om_databuf + om->om_omp->omp_databuf_len - om->om_len;
+        /* Shared mbufs point into another mbuf's data buffer. */
+        blk = _os_mbuf_data_block(om);
+        data_min = blk->om_databuf + blk->om_pkthdr_len;
+        data_max = blk->om_databuf + blk->om_omp->omp_databuf_len -
+                   om->om_len;
         TEST_ASSERT(om->om_data >= data_min && om->om_data <= data_max);
 
         if (data != NULL) {
@@ -102,6 +106,14 @@ TEST_CASE_DECL(os_mbuf_test_extend)
 TEST_CASE_DECL(os_mbuf_test_adj)
 TEST_CASE_DECL(os_mbuf_test_get_pkthdr)
 TEST_CASE_DECL(os_mbuf_test_widen)
+TEST_CASE_DECL(os_mbuf_test_iovec)
+TEST_CASE_DECL(os_mbuf_test_cursor)
+#if MYNEWT_VAL(OS_MBUF_EXT)
+TEST_CASE_DECL(os_mbuf_test_ext)
+#endif
+#if MYNEWT_VAL(OS_MBUF_SHARED)
+TEST_CASE_DECL(os_mbuf_test_shared)
+#endif
 
 TEST_SUITE(os_mbuf_test_suite)
 {
@@ -113,4 +125,12 @@ TEST_SUITE(os_mbuf_test_suite)
     os_mbuf_test_adj();
     os_mbuf_test_get_pkthdr();
     os_mbuf_test_widen();
+    os_mbuf_test_iovec();
+    os_mbuf_test_cursor();
+#if MYNEWT_VAL(OS_MBUF_EXT)
+    os_mbuf_test_ext();
+#endif
+#if MYNEWT_VAL(OS_MBUF_SHARED)
+    os_mbuf_test_shared();
+#endif
 }
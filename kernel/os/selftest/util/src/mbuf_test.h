@@ -19,6 +19,7 @@
 #ifndef _MBUF_TEST_H
 #define _MBUF_TEST_H
 
+#include <stddef.h>
 #include <string.h>
 #include "os/mynewt.h"
 #include "testutil/testutil.h"
@@ -35,9 +36,20 @@ extern "C" {
 #define MBUF_TEST_POOL_BUF_SIZE     (256)
 #define MBUF_TEST_POOL_BUF_COUNT    (10)
 
+/*
+ * Optional mbuf header fields (OS_MBUF_SHARED, MSYS_QUOTA) follow om_next;
+ * grow the pool blocks by their size so the data buffer keeps the length
+ * the tests expect.
+ */
+#define MBUF_TEST_HDR_EXTRA         (sizeof(struct os_mbuf) - \
+                                     offsetof(struct os_mbuf, om_next) - \
+                                     sizeof(struct os_mbuf *))
+#define MBUF_TEST_POOL_BLOCK_SIZE   (MBUF_TEST_POOL_BUF_SIZE + \
+                                     MBUF_TEST_HDR_EXTRA)
+
 #define MBUF_TEST_DATA_LEN          (1024)
 
-extern os_membuf_t os_mbuf_membuf[OS_MEMPOOL_SIZE(MBUF_TEST_POOL_BUF_SIZE,
+extern os_membuf_t os_mbuf_membuf[OS_MEMPOOL_SIZE(MBUF_TEST_POOL_BLOCK_SIZE,
         MBUF_TEST_POOL_BUF_COUNT)];
 
 extern struct os_mbuf_pool os_mbuf_pool;
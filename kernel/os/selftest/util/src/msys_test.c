@@ -0,0 +1,54 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+#include "os_test_priv.h"
+
+/**
+ * Replaces the system msys pools with the mbuf test pool, so that the
+ * tests know exactly how many mbufs msys holds.
+ */
+void
+msys_test_setup(void)
+{
+    int rc;
+
+    os_mbuf_test_setup();
+
+    os_msys_reset();
+    rc = os_msys_register(&os_mbuf_pool);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT_FATAL(os_msys_num_free() == MBUF_TEST_POOL_BUF_COUNT);
+}
+
+#if MYNEWT_VAL(MSYS_QUOTA)
+TEST_CASE_DECL(os_msys_test_quota_reserve)
+TEST_CASE_DECL(os_msys_test_quota_limit)
+TEST_CASE_DECL(os_msys_test_quota_bp)
+#endif
+
+TEST_SUITE(os_msys_test_suite)
+{
+#if MYNEWT_VAL(MSYS_QUOTA)
+    os_msys_test_quota_reserve();
+    os_msys_test_quota_limit();
+    os_msys_test_quota_bp();
+#endif
+}
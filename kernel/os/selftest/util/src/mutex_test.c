@@ -282,10 +282,18 @@ mutex_task4_handler(void *arg)
 TEST_CASE_DECL(os_mutex_test_basic)
 TEST_CASE_DECL(os_mutex_test_case_1)
 TEST_CASE_DECL(os_mutex_test_case_2)
+#if MYNEWT_VAL(OS_MUTEX_PRIO_CHAIN)
+TEST_CASE_DECL(os_mutex_test_chain)
+TEST_CASE_DECL(os_mutex_test_ceiling)
+#endif
 
 TEST_SUITE(os_mutex_test_suite)
 {
     os_mutex_test_basic();
     os_mutex_test_case_1();
     os_mutex_test_case_2();
+#if MYNEWT_VAL(OS_MUTEX_PRIO_CHAIN)
+    os_mutex_test_chain();
+    os_mutex_test_ceiling();
+#endif
 }
@@ -67,16 +67,15 @@ os_test_all(void)
     os_mutex_test_suite();
     os_sem_test_suite();
     os_mbuf_test_suite();
+    os_msys_test_suite();
     os_eventq_test_suite();
     os_callout_test_suite();
     os_time_test_suite();
+    os_sched_test_suite();
+    os_atomic_test_suite();
+    os_dev_test_suite();
+    os_heap_test_suite();
+    os_sanity_test_suite();
 
     return tu_case_failed;
 }
-
-int
-main(int argc, char **argv)
-{
-    os_test_all();
-    return tu_any_failed;
-}
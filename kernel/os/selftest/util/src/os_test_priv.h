@@ -28,9 +28,12 @@
 #include "callout_test.h"
 
 #include "eventq_test.h"
+#include "heap_test.h"
 #include "mbuf_test.h"
 #include "mempool_test.h"
+#include "msys_test.h"
 #include "mutex_test.h"
+#include "sched_test.h"
 #include "sem_test.h"
 
 #ifdef __cplusplus
@@ -0,0 +1,89 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+#include "os_test_priv.h"
+
+volatile uint8_t sched_test_run_prios[SCHED_TEST_MAX_RUNS];
+volatile int sched_test_num_runs;
+struct os_sem sched_test_sem;
+
+/**
+ * Records the priority of the calling task.  Used to verify the order in
+ * which the scheduler dispatches ready tasks.
+ */
+void
+sched_test_record_handler(void *arg)
+{
+    struct os_task *t;
+
+    t = os_sched_get_current_task();
+
+    TEST_ASSERT_FATAL(sched_test_num_runs < SCHED_TEST_MAX_RUNS);
+    sched_test_run_prios[sched_test_num_runs++] = t->t_prio;
+}
+
+/**
+ * Sleeps for a duration derived from the calling task's priority, then
+ * records the priority.  Lower priority tasks sleep for less time.
+ */
+void
+sched_test_sleep_handler(void *arg)
+{
+    struct os_task *t;
+
+    t = os_sched_get_current_task();
+
+    os_time_delay((TASK4_PRIO + 1 - t->t_prio) * 10);
+    sched_test_record_handler(arg);
+}
+
+/**
+ * Pends on sched_test_sem with a timeout derived from the calling task's
+ * priority, then records the priority.  Lower priority tasks time out
+ * sooner.
+ */
+void
+sched_test_sem_handler(void *arg)
+{
+    struct os_task *t;
+
+    t = os_sched_get_current_task();
+
+    os_sem_pend(&sched_test_sem, (TASK4_PRIO + 1 - t->t_prio) * 10);
+    sched_test_record_handler(arg);
+}
+
+TEST_CASE_DECL(os_sched_test_prio)
+TEST_CASE_DECL(os_sched_test_sleep)
+TEST_CASE_DECL(os_sched_test_sleep_wake)
+#if MYNEWT_VAL(OS_TASK_CPU_STATS)
+TEST_CASE_DECL(os_sched_test_cpu_stats)
+#endif
+
+TEST_SUITE(os_sched_test_suite)
+{
+    os_sched_test_prio();
+    os_sched_test_sleep();
+    os_sched_test_sleep_wake();
+#if MYNEWT_VAL(OS_TASK_CPU_STATS)
+    os_sched_test_cpu_stats();
+#endif
+}
@@ -0,0 +1,44 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef _SCHED_TEST_H
+#define _SCHED_TEST_H
+
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+#include "os_test_priv.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SCHED_TEST_MAX_RUNS     4
+
+extern volatile uint8_t sched_test_run_prios[SCHED_TEST_MAX_RUNS];
+extern volatile int sched_test_num_runs;
+extern struct os_sem sched_test_sem;
+
+void sched_test_record_handler(void *arg);
+void sched_test_sleep_handler(void *arg);
+void sched_test_sem_handler(void *arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _SCHED_TEST_H */
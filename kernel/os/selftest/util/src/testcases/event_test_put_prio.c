@@ -0,0 +1,60 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "os_test_priv.h"
+
+#if MYNEWT_VAL(OS_EVENTQ_PRIO)
+static struct os_event event_test_prio_evs[6];
+
+/**
+ * Tests that urgent events are dispatched ahead of normal events, in FIFO
+ * order among themselves, and that removing an urgent event keeps the
+ * lane intact.
+ */
+TEST_CASE_SELF(event_test_put_prio)
+{
+    struct os_event *evs;
+    struct os_eventq evq;
+
+    evs = event_test_prio_evs;
+    memset(evs, 0, sizeof event_test_prio_evs);
+    os_eventq_init(&evq);
+
+    os_eventq_put(&evq, &evs[0]);
+    os_eventq_put(&evq, &evs[1]);
+    os_eventq_put_prio(&evq, &evs[2]);
+    os_eventq_put_prio(&evq, &evs[3]);
+    os_eventq_put_prio(&evq, &evs[4]);
+
+    /* Removing the last urgent event moves the lane tail back. */
+    os_eventq_remove(&evq, &evs[4]);
+    os_eventq_put_prio(&evq, &evs[5]);
+
+    TEST_ASSERT(os_eventq_get_no_wait(&evq) == &evs[2]);
+    TEST_ASSERT(os_eventq_get_no_wait(&evq) == &evs[3]);
+    TEST_ASSERT(os_eventq_get_no_wait(&evq) == &evs[5]);
+
+    /* Lane is empty again; a new urgent event goes to the head. */
+    os_eventq_put_prio(&evq, &evs[4]);
+
+    TEST_ASSERT(os_eventq_get_no_wait(&evq) == &evs[4]);
+    TEST_ASSERT(os_eventq_get_no_wait(&evq) == &evs[0]);
+    TEST_ASSERT(os_eventq_get_no_wait(&evq) == &evs[1]);
+    TEST_ASSERT(os_eventq_get_no_wait(&evq) == NULL);
+}
+#endif
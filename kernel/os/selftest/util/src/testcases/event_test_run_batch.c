@@ -0,0 +1,61 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "os_test_priv.h"
+
+#define EVENT_TEST_BATCH_NUM    5
+
+static int event_test_batch_cnt;
+
+static void
+event_test_batch_cb(struct os_event *ev)
+{
+    event_test_batch_cnt++;
+}
+
+/**
+ * Tests that os_eventq_run_batch() stops after max_events events and leaves
+ * the rest queued, then drains the remaining events without blocking.
+ */
+TEST_CASE_SELF(event_test_run_batch)
+{
+    struct os_event evs[EVENT_TEST_BATCH_NUM];
+    struct os_eventq evq;
+    int rc;
+    int i;
+
+    os_eventq_init(&evq);
+    event_test_batch_cnt = 0;
+
+    memset(evs, 0, sizeof evs);
+    for (i = 0; i < EVENT_TEST_BATCH_NUM; i++) {
+        evs[i].ev_cb = event_test_batch_cb;
+        os_eventq_put(&evq, &evs[i]);
+    }
+
+    rc = os_eventq_run_batch(&evq, 3, OS_TIMEOUT_NEVER);
+    TEST_ASSERT(rc == 3);
+    TEST_ASSERT(event_test_batch_cnt == 3);
+    TEST_ASSERT(!evs[2].ev_queued);
+    TEST_ASSERT(evs[3].ev_queued);
+
+    rc = os_eventq_run_batch(&evq, EVENT_TEST_BATCH_NUM, OS_TIMEOUT_NEVER);
+    TEST_ASSERT(rc == EVENT_TEST_BATCH_NUM - 3);
+    TEST_ASSERT(event_test_batch_cnt == EVENT_TEST_BATCH_NUM);
+    TEST_ASSERT(os_eventq_get_no_wait(&evq) == NULL);
+}
@@ -0,0 +1,99 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "taskpool/taskpool.h"
+#include "os_test_priv.h"
+
+#if MYNEWT_VAL(OS_EVENTQ_WAITSET)
+static struct os_eventq_waitset event_test_ws;
+static struct os_event event_test_ws_ev;
+
+static void
+event_test_waitset_put_handler(void *arg)
+{
+    os_eventq_put(&multi_eventq[2], &event_test_ws_ev);
+}
+
+/**
+ * Tests waiting on a set of event queues, both without blocking and with a
+ * producer task waking up the waiter.
+ */
+TEST_CASE_TASK(event_test_waitset)
+{
+    struct os_eventq *evq;
+    struct os_event *evp;
+    struct os_event ev;
+    int rc;
+    int i;
+
+    os_eventq_waitset_init(&event_test_ws);
+    for (i = 0; i < SIZE_MULTI_EVENT; i++) {
+        os_eventq_init(&multi_eventq[i]);
+        rc = os_eventq_waitset_add(&event_test_ws, &multi_eventq[i]);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+
+    /* A queue can only belong to one set. */
+    rc = os_eventq_waitset_add(&event_test_ws, &multi_eventq[0]);
+    TEST_ASSERT(rc == OS_EINVAL);
+
+    evp = os_eventq_waitset_poll(&event_test_ws, 0, NULL);
+    TEST_ASSERT(evp == NULL);
+
+    evp = os_eventq_waitset_poll(&event_test_ws, 2, NULL);
+    TEST_ASSERT(evp == NULL);
+
+    /* Queues are polled in the order they were added. */
+    memset(&ev, 0, sizeof ev);
+    memset(&event_test_ws_ev, 0, sizeof event_test_ws_ev);
+    os_eventq_put(&multi_eventq[3], &ev);
+    os_eventq_put(&multi_eventq[1], &event_test_ws_ev);
+
+    evp = os_eventq_waitset_poll(&event_test_ws, 0, &evq);
+    TEST_ASSERT(evp == &event_test_ws_ev);
+    TEST_ASSERT(evq == &multi_eventq[1]);
+
+    evp = os_eventq_waitset_poll(&event_test_ws, 0, &evq);
+    TEST_ASSERT(evp == &ev);
+    TEST_ASSERT(evq == &multi_eventq[3]);
+
+    /* Events pulled directly from a member queue are not reported. */
+    os_eventq_put(&multi_eventq[0], &ev);
+    TEST_ASSERT(os_eventq_get_no_wait(&multi_eventq[0]) == &ev);
+    evp = os_eventq_waitset_poll(&event_test_ws, 0, NULL);
+    TEST_ASSERT(evp == NULL);
+    TEST_ASSERT(event_test_ws.ews_ready == 0);
+
+    /* A lower priority task wakes us up. */
+    taskpool_alloc_assert(event_test_waitset_put_handler, TASK2_PRIO);
+    evp = os_eventq_waitset_poll(&event_test_ws, OS_WAIT_FOREVER, &evq);
+    TEST_ASSERT(evp == &event_test_ws_ev);
+    TEST_ASSERT(evq == &multi_eventq[2]);
+    taskpool_wait_assert(OS_TICKS_PER_SEC);
+
+    /* Removed queues no longer wake up the set. */
+    rc = os_eventq_waitset_remove(&event_test_ws, &multi_eventq[3]);
+    TEST_ASSERT(rc == 0);
+    rc = os_eventq_waitset_remove(&event_test_ws, &multi_eventq[3]);
+    TEST_ASSERT(rc == OS_EINVAL);
+    os_eventq_put(&multi_eventq[3], &ev);
+    evp = os_eventq_waitset_poll(&event_test_ws, 0, NULL);
+    TEST_ASSERT(evp == NULL);
+    os_eventq_remove(&multi_eventq[3], &ev);
+}
+#endif
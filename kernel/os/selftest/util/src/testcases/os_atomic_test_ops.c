@@ -0,0 +1,55 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os_test_priv.h"
+
+TEST_CASE_SELF(os_atomic_test_ops)
+{
+    uint32_t val;
+    uint32_t old;
+
+    os_atomic_store_u32(&val, 10);
+    TEST_ASSERT(os_atomic_load_u32(&val) == 10);
+
+    old = os_atomic_fetch_add_u32(&val, 5);
+    TEST_ASSERT(old == 10);
+    TEST_ASSERT(val == 15);
+
+    old = os_atomic_fetch_sub_u32(&val, 20);
+    TEST_ASSERT(old == 15);
+    TEST_ASSERT(val == 0xfffffffb);
+
+    old = os_atomic_fetch_and_u32(&val, 0x0000ff0f);
+    TEST_ASSERT(old == 0xfffffffb);
+    TEST_ASSERT(val == 0x0000ff0b);
+
+    old = os_atomic_fetch_or_u32(&val, 0x80000004);
+    TEST_ASSERT(old == 0x0000ff0b);
+    TEST_ASSERT(val == 0x8000ff0f);
+
+    old = os_atomic_xchg_u32(&val, 7);
+    TEST_ASSERT(old == 0x8000ff0f);
+    TEST_ASSERT(val == 7);
+
+    /* Compare-and-swap only succeeds with the current value. */
+    TEST_ASSERT(!os_atomic_cas_u32(&val, 6, 100));
+    TEST_ASSERT(val == 7);
+    TEST_ASSERT(os_atomic_cas_u32(&val, 7, 100));
+    TEST_ASSERT(val == 100);
+}
@@ -0,0 +1,77 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "os_test_priv.h"
+
+#define CALLOUT_ORDER_NUM   4
+
+static struct os_eventq callout_order_evq;
+static struct os_callout callout_order[CALLOUT_ORDER_NUM];
+
+static void
+callout_order_cb(struct os_event *ev)
+{
+}
+
+/* Callouts must expire in tick order, including ones that share a slot. */
+TEST_CASE_TASK(callout_test_order)
+{
+    static const os_time_t ticks[CALLOUT_ORDER_NUM] = { 3, 6, 70, 134 };
+    struct os_event *ev;
+    os_time_t now;
+    os_sr_t sr;
+    int rc;
+    int i;
+
+    os_eventq_init(&callout_order_evq);
+    for (i = 0; i < CALLOUT_ORDER_NUM; i++) {
+        os_callout_init(&callout_order[i], &callout_order_evq,
+                        callout_order_cb, (void *)(uintptr_t)i);
+    }
+
+    OS_ENTER_CRITICAL(sr);
+    now = os_time_get();
+    for (i = CALLOUT_ORDER_NUM - 1; i >= 0; i--) {
+        rc = os_callout_reset(&callout_order[i], ticks[i]);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+    TEST_ASSERT(os_callout_wakeup_ticks(now) == ticks[0]);
+
+    os_callout_stop(&callout_order[0]);
+    TEST_ASSERT(!os_callout_queued(&callout_order[0]));
+    TEST_ASSERT(os_callout_wakeup_ticks(now) == ticks[1]);
+
+    os_callout_stop(&callout_order[1]);
+    TEST_ASSERT(os_callout_wakeup_ticks(now) == ticks[2]);
+
+    rc = os_callout_reset(&callout_order[1], ticks[1]);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(os_callout_wakeup_ticks(now) == ticks[1]);
+    OS_EXIT_CRITICAL(sr);
+
+    for (i = 1; i < CALLOUT_ORDER_NUM; i++) {
+        ev = os_eventq_get(&callout_order_evq);
+        TEST_ASSERT_FATAL(ev->ev_arg == (void *)(uintptr_t)i);
+        TEST_ASSERT(OS_TIME_TICK_GEQ(os_time_get(), now + ticks[i]));
+        TEST_ASSERT(!os_callout_queued(&callout_order[i]));
+    }
+
+    OS_ENTER_CRITICAL(sr);
+    TEST_ASSERT(os_callout_wakeup_ticks(os_time_get()) == OS_TIMEOUT_NEVER);
+    OS_EXIT_CRITICAL(sr);
+}
@@ -0,0 +1,68 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "os_test_priv.h"
+
+#if MYNEWT_VAL(OS_CALLOUT_SLACK)
+static struct os_eventq callout_slack_evq;
+static struct os_callout callout_slack[3];
+
+static void
+callout_slack_cb(struct os_event *ev)
+{
+}
+
+/* The idle wakeup is the earliest expiry plus slack of any callout. */
+TEST_CASE_TASK(callout_test_slack)
+{
+    os_time_t now;
+    os_sr_t sr;
+    int i;
+
+    os_eventq_init(&callout_slack_evq);
+    for (i = 0; i < 3; i++) {
+        os_callout_init(&callout_slack[i], &callout_slack_evq,
+                        callout_slack_cb, NULL);
+    }
+    os_callout_set_slack(&callout_slack[0], 20);
+    os_callout_set_slack(&callout_slack[2], 5);
+
+    OS_ENTER_CRITICAL(sr);
+    now = os_time_get();
+
+    /* Expires at 10 but may wait for the one expiring at 25. */
+    os_callout_reset(&callout_slack[0], 10);
+    os_callout_reset(&callout_slack[1], 25);
+    TEST_ASSERT(os_callout_wakeup_ticks(now) == 25);
+
+    /* On its own it can be postponed by the full slack. */
+    os_callout_stop(&callout_slack[1]);
+    TEST_ASSERT(os_callout_wakeup_ticks(now) == 30);
+
+    /* A callout beyond the deadline does not extend it. */
+    os_callout_reset(&callout_slack[2], 40);
+    TEST_ASSERT(os_callout_wakeup_ticks(now) == 30);
+
+    /* Slack is kept across resets. */
+    os_callout_stop(&callout_slack[0]);
+    TEST_ASSERT(os_callout_wakeup_ticks(now) == 45);
+
+    os_callout_stop(&callout_slack[2]);
+    OS_EXIT_CRITICAL(sr);
+}
+#endif
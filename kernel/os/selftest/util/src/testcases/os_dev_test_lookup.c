@@ -0,0 +1,87 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "os_test_priv.h"
+
+#define ODTL_NUM_DEVS   20
+
+static struct os_dev odtl_devs[ODTL_NUM_DEVS];
+static char odtl_names[ODTL_NUM_DEVS][8];
+static int odtl_opens;
+
+static int
+odtl_open(struct os_dev *dev, uint32_t timo, void *arg)
+{
+    odtl_opens++;
+    return 0;
+}
+
+static int
+odtl_init(struct os_dev *dev, void *arg)
+{
+    OS_DEV_SETHANDLERS(dev, odtl_open, NULL);
+    return 0;
+}
+
+/*
+ * More devices than index buckets, so some share one; every name must
+ * still find its own device, whichever way lookups are done.
+ */
+TEST_CASE_SELF(os_dev_test_lookup)
+{
+    struct os_dev *dev;
+    int rc;
+    int i;
+
+    for (i = 0; i < ODTL_NUM_DEVS; i++) {
+        snprintf(odtl_names[i], sizeof(odtl_names[i]), "odtl%d", i);
+        rc = os_dev_create(&odtl_devs[i], odtl_names[i],
+                           OS_DEV_INIT_PRIMARY, i % 3, odtl_init, NULL);
+        TEST_ASSERT_FATAL(rc == 0);
+        if (!g_os_started) {
+            odtl_init(&odtl_devs[i], NULL);
+            odtl_devs[i].od_flags |= OS_DEV_F_STATUS_READY;
+        }
+    }
+
+    for (i = 0; i < ODTL_NUM_DEVS; i++) {
+        TEST_ASSERT(os_dev_lookup(odtl_names[i]) == &odtl_devs[i]);
+    }
+    TEST_ASSERT(os_dev_lookup("odtl") == NULL);
+    TEST_ASSERT(os_dev_lookup("odtl99") == NULL);
+    TEST_ASSERT(os_dev_lookup("") == NULL);
+
+    /* Opening by name and by the looked up device do the same. */
+    odtl_opens = 0;
+    dev = os_dev_open("odtl7", 0, NULL);
+    TEST_ASSERT_FATAL(dev == &odtl_devs[7]);
+    dev = os_dev_open_dev(dev, 0, NULL);
+    TEST_ASSERT_FATAL(dev == &odtl_devs[7]);
+    TEST_ASSERT(odtl_opens == 2);
+    TEST_ASSERT(dev->od_open_ref == 2);
+    TEST_ASSERT(dev->od_flags & OS_DEV_F_STATUS_OPEN);
+
+    TEST_ASSERT(os_dev_open("odtl99", 0, NULL) == NULL);
+
+    os_dev_close(dev);
+    os_dev_close(dev);
+    TEST_ASSERT(!(dev->od_flags & OS_DEV_F_STATUS_OPEN));
+}
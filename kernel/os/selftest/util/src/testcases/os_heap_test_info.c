@@ -0,0 +1,51 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "os_test_priv.h"
+
+TEST_CASE_SELF(os_heap_test_info)
+{
+    struct os_heap_info info;
+#if MYNEWT_VAL(OS_HEAP_SLAB)
+    struct os_heap_info before;
+    void *ptr;
+
+    heap_test_info_assert(&before);
+    TEST_ASSERT(before.ohi_total > 0);
+
+    /* The slab pools are registered even if os_malloc() was first called
+     * before sysinit.
+     */
+    TEST_ASSERT(heap_test_slab_pool(16) != NULL);
+    TEST_ASSERT(heap_test_slab_pool(256) != NULL);
+
+    ptr = os_malloc(1024);
+    TEST_ASSERT_FATAL(ptr != NULL);
+    heap_test_info_assert(&info);
+    TEST_ASSERT(info.ohi_total == before.ohi_total);
+    TEST_ASSERT(info.ohi_free + 1024 <= before.ohi_free);
+
+    os_free(ptr);
+    heap_test_info_assert(&info);
+    TEST_ASSERT(info.ohi_free == before.ohi_free);
+    TEST_ASSERT(info.ohi_largest_free == before.ohi_largest_free);
+#else
+    /* The heap is libc's; there is nothing to report. */
+    TEST_ASSERT(os_heap_info_get(&info) == OS_ENOENT);
+#endif
+}
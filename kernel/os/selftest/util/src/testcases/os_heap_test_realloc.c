@@ -0,0 +1,80 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "os_test_priv.h"
+
+#if MYNEWT_VAL(OS_HEAP_SLAB)
+#define OHTR_LEN    10
+
+static void
+os_heap_test_realloc_assert(const uint8_t *ptr)
+{
+    int i;
+
+    for (i = 0; i < OHTR_LEN; i++) {
+        TEST_ASSERT(ptr[i] == i);
+    }
+}
+
+TEST_CASE_SELF(os_heap_test_realloc)
+{
+    struct os_heap_info before;
+    struct os_heap_info info;
+    uint8_t *ptr;
+    uint8_t *p2;
+    int i;
+
+    heap_test_info_assert(&before);
+
+    ptr = os_realloc(NULL, OHTR_LEN);
+    TEST_ASSERT_FATAL(ptr != NULL);
+    for (i = 0; i < OHTR_LEN; i++) {
+        ptr[i] = i;
+    }
+
+    /*** Growing within the usable size keeps the block. */
+    p2 = os_realloc(ptr, 16);
+    TEST_ASSERT(p2 == ptr);
+
+    /*** Growing beyond it moves the contents to a larger slab... */
+    p2 = os_realloc(ptr, 200);
+    TEST_ASSERT_FATAL(p2 != NULL);
+    TEST_ASSERT(p2 != ptr);
+    os_heap_test_realloc_assert(p2);
+    ptr = p2;
+
+    /*** ...or to the TLSF heap. */
+    p2 = os_realloc(ptr, 1000);
+    TEST_ASSERT_FATAL(p2 != NULL);
+    TEST_ASSERT(p2 != ptr);
+    os_heap_test_realloc_assert(p2);
+    ptr = p2;
+
+    /*** Shrinking keeps the block. */
+    p2 = os_realloc(ptr, 500);
+    TEST_ASSERT(p2 == ptr);
+    os_heap_test_realloc_assert(p2);
+
+    /*** A size of zero frees it. */
+    p2 = os_realloc(ptr, 0);
+    TEST_ASSERT(p2 == NULL);
+
+    heap_test_info_assert(&info);
+    TEST_ASSERT(info.ohi_free == before.ohi_free);
+}
+#endif
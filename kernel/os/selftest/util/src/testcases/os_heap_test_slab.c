@@ -0,0 +1,90 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "os_test_priv.h"
+
+#if MYNEWT_VAL(OS_HEAP_SLAB)
+#define OHTS_MAX_PTRS   (MYNEWT_VAL(OS_HEAP_SLAB_128_BLOCKS) + \
+                         MYNEWT_VAL(OS_HEAP_SLAB_256_BLOCKS) + 1)
+#define OHTS_SIZE       100
+
+TEST_CASE_SELF(os_heap_test_slab)
+{
+    void *ptrs[OHTS_MAX_PTRS];
+    struct os_heap_info exhausted;
+    struct os_heap_info before;
+    struct os_heap_info info;
+    struct os_mempool *pool128;
+    struct os_mempool *pool256;
+    int free128;
+    int free256;
+    int num;
+    int i;
+
+    pool128 = heap_test_slab_pool(128);
+    pool256 = heap_test_slab_pool(256);
+    TEST_ASSERT_FATAL(pool128 != NULL);
+    TEST_ASSERT_FATAL(pool256 != NULL);
+
+    heap_test_info_assert(&before);
+    free128 = pool128->mp_num_free;
+    free256 = pool256->mp_num_free;
+
+    /*** Requests are served from the smallest class that fits. */
+    num = 0;
+    while (pool128->mp_num_free > 0) {
+        TEST_ASSERT_FATAL(num < OHTS_MAX_PTRS);
+        ptrs[num] = os_malloc(OHTS_SIZE);
+        TEST_ASSERT_FATAL(ptrs[num] != NULL);
+        TEST_ASSERT(os_memblock_from(pool128, ptrs[num]));
+        num++;
+    }
+    TEST_ASSERT(pool256->mp_num_free == free256);
+
+    /*** Once that class is exhausted, the next larger one takes over. */
+    while (pool256->mp_num_free > 0) {
+        TEST_ASSERT_FATAL(num < OHTS_MAX_PTRS);
+        ptrs[num] = os_malloc(OHTS_SIZE);
+        TEST_ASSERT_FATAL(ptrs[num] != NULL);
+        TEST_ASSERT(os_memblock_from(pool256, ptrs[num]));
+        num++;
+    }
+
+    /*** With every large enough class exhausted, the TLSF heap does. */
+    heap_test_info_assert(&exhausted);
+    TEST_ASSERT_FATAL(num < OHTS_MAX_PTRS);
+    ptrs[num] = os_malloc(OHTS_SIZE);
+    TEST_ASSERT_FATAL(ptrs[num] != NULL);
+    TEST_ASSERT(!os_memblock_from(pool128, ptrs[num]));
+    TEST_ASSERT(!os_memblock_from(pool256, ptrs[num]));
+    num++;
+
+    heap_test_info_assert(&info);
+    TEST_ASSERT(info.ohi_free + OHTS_SIZE <= exhausted.ohi_free);
+
+    /*** Every block returns to where it came from. */
+    for (i = 0; i < num; i++) {
+        os_free(ptrs[i]);
+    }
+    TEST_ASSERT(pool128->mp_num_free == free128);
+    TEST_ASSERT(pool256->mp_num_free == free256);
+
+    heap_test_info_assert(&info);
+    TEST_ASSERT(info.ohi_free == before.ohi_free);
+}
+#endif
@@ -0,0 +1,68 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "os_test_priv.h"
+
+#if MYNEWT_VAL(OS_HEAP_SLAB)
+/* Larger than any slab class. */
+#define OHTT_SIZE   512
+
+TEST_CASE_SELF(os_heap_test_tlsf)
+{
+    struct os_heap_info before;
+    struct os_heap_info info;
+    uint8_t *a;
+    uint8_t *b;
+    uint8_t *c;
+    uint8_t *d;
+
+    heap_test_info_assert(&before);
+
+    /*** Allocations are split off the front of the free region. */
+    a = os_malloc(OHTT_SIZE);
+    b = os_malloc(OHTT_SIZE);
+    c = os_malloc(OHTT_SIZE);
+    TEST_ASSERT_FATAL(a != NULL && b != NULL && c != NULL);
+    TEST_ASSERT_FATAL(b > a && b - a >= OHTT_SIZE);
+    TEST_ASSERT(c - b == b - a);
+
+    heap_test_info_assert(&info);
+    TEST_ASSERT(info.ohi_free + 3 * (b - a) == before.ohi_free);
+
+    /*** Freeing the middle block leaves a hole. */
+    os_free(b);
+    heap_test_info_assert(&info);
+    TEST_ASSERT(info.ohi_free + 2 * (b - a) == before.ohi_free);
+    TEST_ASSERT(info.ohi_frag_pct > before.ohi_frag_pct);
+
+    /*** Freeing its neighbour coalesces the two; the merged block is
+     * reused for a request that neither could satisfy alone.
+     */
+    os_free(a);
+    d = os_malloc(2 * OHTT_SIZE);
+    TEST_ASSERT(d == a);
+
+    /*** Freeing everything restores a single free region. */
+    os_free(c);
+    os_free(d);
+    heap_test_info_assert(&info);
+    TEST_ASSERT(info.ohi_free == before.ohi_free);
+    TEST_ASSERT(info.ohi_largest_free == before.ohi_largest_free);
+    TEST_ASSERT(info.ohi_frag_pct == before.ohi_frag_pct);
+}
+#endif
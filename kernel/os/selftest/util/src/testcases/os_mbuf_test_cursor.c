@@ -0,0 +1,101 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <limits.h>
+#include "os_test_priv.h"
+
+TEST_CASE_SELF(os_mbuf_test_cursor)
+{
+    struct os_mbuf_cursor omc;
+    const uint8_t *span;
+    struct os_mbuf *om;
+    uint16_t span_len;
+    uint8_t buf[16];
+    int rc;
+
+    os_mbuf_test_setup();
+
+    om = os_mbuf_get_pkthdr(&os_mbuf_pool, 0);
+    TEST_ASSERT_FATAL(om != NULL);
+
+    /* 600 bytes span three mbufs. */
+    rc = os_mbuf_append(om, os_mbuf_test_data, 600);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    os_mbuf_cursor_init(&omc, om);
+    TEST_ASSERT(omc.omc_pos == 0);
+
+    /*** Contiguous span covers the rest of the current mbuf. */
+    span = os_mbuf_cursor_span(&omc, &span_len);
+    TEST_ASSERT(span == om->om_data);
+    TEST_ASSERT(span_len == om->om_len);
+
+    /*** Read across the boundary between the first two mbufs. */
+    rc = os_mbuf_cursor_seek(&omc, om->om_len - 4);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = os_mbuf_cursor_read(&omc, buf, 8);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(memcmp(buf, os_mbuf_test_data + om->om_len - 4, 8) == 0);
+    TEST_ASSERT(omc.omc_pos == om->om_len + 4);
+    TEST_ASSERT(omc.omc_om == SLIST_NEXT(om, om_next));
+
+    /*** Peek and compare do not move the cursor. */
+    rc = os_mbuf_cursor_peek(&omc, buf, sizeof buf);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(os_mbuf_cursor_cmp(&omc, buf, sizeof buf) == 0);
+    TEST_ASSERT(omc.omc_pos == om->om_len + 4);
+    TEST_ASSERT(memcmp(buf, os_mbuf_test_data + om->om_len + 4,
+                       sizeof buf) == 0);
+    buf[0]++;
+    TEST_ASSERT(os_mbuf_cursor_cmp(&omc, buf, sizeof buf) != 0);
+
+    /*** A cursor at the end of an mbuf settles on the next one. */
+    rc = os_mbuf_cursor_seek(&omc, om->om_len);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(omc.omc_om == SLIST_NEXT(om, om_next));
+    TEST_ASSERT(omc.omc_off == 0);
+
+    /*** Seeking backward restarts from the head. */
+    rc = os_mbuf_cursor_seek(&omc, 3);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(omc.omc_om == om);
+    rc = os_mbuf_cursor_read(&omc, buf, 1);
+    TEST_ASSERT(rc == 0 && buf[0] == os_mbuf_test_data[3]);
+
+    /*** Skip to the end of the chain. */
+    rc = os_mbuf_cursor_skip(&omc, 596);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(omc.omc_pos == 600);
+    span = os_mbuf_cursor_span(&omc, &span_len);
+    TEST_ASSERT(span == NULL && span_len == 0);
+    TEST_ASSERT(os_mbuf_cursor_cmp(&omc, buf, 1) == INT_MAX);
+
+    /*** Out-of-range operations leave the cursor in place. */
+    rc = os_mbuf_cursor_skip(&omc, 1);
+    TEST_ASSERT(rc == SYS_EINVAL);
+    rc = os_mbuf_cursor_seek(&omc, 596);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = os_mbuf_cursor_read(&omc, buf, 5);
+    TEST_ASSERT(rc == SYS_EINVAL);
+    TEST_ASSERT(omc.omc_pos == 596);
+    rc = os_mbuf_cursor_seek(&omc, 601);
+    TEST_ASSERT(rc == SYS_EINVAL);
+    TEST_ASSERT(omc.omc_pos == 596);
+
+    os_mbuf_free_chain(om);
+}
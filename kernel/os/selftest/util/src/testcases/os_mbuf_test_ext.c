@@ -0,0 +1,119 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "os_test_priv.h"
+
+#if MYNEWT_VAL(OS_MBUF_EXT)
+static int os_mbuf_test_ext_freed;
+
+static void
+os_mbuf_test_ext_free(struct os_mbuf_ext *ext, void *arg)
+{
+    TEST_ASSERT(arg == &os_mbuf_test_ext_freed);
+    os_mbuf_test_ext_freed++;
+}
+
+TEST_CASE_SELF(os_mbuf_test_ext)
+{
+    struct os_mbuf_iovec iov[4];
+    struct os_mbuf_ext ext;
+    struct os_mbuf *dup;
+    struct os_mbuf *om;
+    uint8_t buf[8];
+    int rc;
+
+    os_mbuf_test_setup();
+    os_mbuf_test_ext_freed = 0;
+
+    os_mbuf_ext_init(&ext, os_mbuf_test_data, 512, os_mbuf_test_ext_free,
+                     &os_mbuf_test_ext_freed);
+
+    /*** Range must lie within the storage. */
+    om = os_mbuf_get_ext(&os_mbuf_pool, &ext, 500, 13);
+    TEST_ASSERT(om == NULL);
+
+    /*** Attach storage to a chain; the data is not copied. */
+    om = os_mbuf_get_pkthdr(&os_mbuf_pool, 0);
+    TEST_ASSERT_FATAL(om != NULL);
+    rc = os_mbuf_append(om, os_mbuf_test_data, 10);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = os_mbuf_append_ext(om, &ext, 10, 200);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(OS_MBUF_PKTLEN(om) == 210);
+    TEST_ASSERT(ext.ome_refcnt == 1);
+    TEST_ASSERT(OS_MBUF_IS_EXT(SLIST_NEXT(om, om_next)));
+    TEST_ASSERT(SLIST_NEXT(om, om_next)->om_data == os_mbuf_test_data + 10);
+    TEST_ASSERT(os_mbuf_cmpf(om, 0, os_mbuf_test_data, 210) == 0);
+
+    rc = os_mbuf_to_iovec(om, 5, 100, iov, 4);
+    TEST_ASSERT_FATAL(rc == 2);
+    TEST_ASSERT(iov[1].iov_base == os_mbuf_test_data + 10);
+    TEST_ASSERT(iov[1].iov_len == 95);
+
+    /*** Appending after external data allocates a new mbuf. */
+    rc = os_mbuf_append(om, os_mbuf_test_data + 210, 20);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(OS_MBUF_PKTLEN(om) == 230);
+    TEST_ASSERT(!OS_MBUF_IS_EXT(SLIST_NEXT(SLIST_NEXT(om, om_next),
+                                           om_next)));
+    TEST_ASSERT(os_mbuf_cmpf(om, 0, os_mbuf_test_data, 230) == 0);
+
+    /*** External data is never written. */
+    memset(buf, 0xff, sizeof buf);
+    rc = os_mbuf_copyinto(om, 220, buf, sizeof buf);
+    TEST_ASSERT(rc == 0);
+    rc = os_mbuf_copyinto(om, 5, buf, sizeof buf);
+#if MYNEWT_VAL(OS_MBUF_SHARED)
+    /* Written to a private copy instead. */
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(os_mbuf_cmpf(om, 5, buf, sizeof buf) == 0);
+    TEST_ASSERT(os_mbuf_cmpf(om, 13, os_mbuf_test_data + 13, 197) == 0);
+    TEST_ASSERT(os_mbuf_test_data[10] == 10);
+    TEST_ASSERT(ext.ome_refcnt == 0);
+    TEST_ASSERT(os_mbuf_test_ext_freed == 1);
+
+    /* Reattach for the duplication test below. */
+    os_mbuf_test_ext_freed = 0;
+    os_mbuf_free_chain(om);
+    om = os_mbuf_get(&os_mbuf_pool, 0);
+    TEST_ASSERT_FATAL(om != NULL);
+    rc = os_mbuf_append_ext(om, &ext, 10, 200);
+    TEST_ASSERT_FATAL(rc == 0);
+#else
+    TEST_ASSERT(rc == SYS_EACCES);
+    TEST_ASSERT(os_mbuf_cmpf(om, 0, os_mbuf_test_data, 220) == 0);
+#endif
+
+    /*** Duplicates share the storage. */
+    dup = os_mbuf_dup(om);
+    TEST_ASSERT_FATAL(dup != NULL);
+    TEST_ASSERT(ext.ome_refcnt == 2);
+    TEST_ASSERT(SLIST_NEXT(dup, om_next)->om_data == os_mbuf_test_data + 10);
+    TEST_ASSERT(os_mbuf_cmpm(om, 0, dup, 0, os_mbuf_len(om)) == 0);
+
+    os_mbuf_free_chain(om);
+    TEST_ASSERT(ext.ome_refcnt == 1);
+    TEST_ASSERT(os_mbuf_test_ext_freed == 0);
+
+    os_mbuf_free_chain(dup);
+    TEST_ASSERT(ext.ome_refcnt == 0);
+    TEST_ASSERT(os_mbuf_test_ext_freed == 1);
+    TEST_ASSERT(os_mbuf_mempool.mp_num_free == MBUF_TEST_POOL_BUF_COUNT);
+}
+#endif
@@ -0,0 +1,68 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "os_test_priv.h"
+
+TEST_CASE_SELF(os_mbuf_test_iovec)
+{
+    struct os_mbuf_iovec iov[4];
+    struct os_mbuf *om;
+    int rc;
+
+    os_mbuf_test_setup();
+
+    om = os_mbuf_get_pkthdr(&os_mbuf_pool, 0);
+    TEST_ASSERT_FATAL(om != NULL);
+
+    /* 600 bytes span three mbufs. */
+    rc = os_mbuf_append(om, os_mbuf_test_data, 600);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /*** Whole chain. */
+    rc = os_mbuf_to_iovec(om, 0, 600, iov, 4);
+    TEST_ASSERT_FATAL(rc == 3);
+    TEST_ASSERT(iov[0].iov_base == om->om_data);
+    TEST_ASSERT(iov[0].iov_len == om->om_len);
+    TEST_ASSERT(iov[0].iov_len + iov[1].iov_len + iov[2].iov_len == 600);
+    TEST_ASSERT(memcmp(iov[2].iov_base,
+                       os_mbuf_test_data + 600 - iov[2].iov_len,
+                       iov[2].iov_len) == 0);
+
+    /*** Range inside the second mbuf. */
+    rc = os_mbuf_to_iovec(om, om->om_len + 1, 10, iov, 4);
+    TEST_ASSERT_FATAL(rc == 1);
+    TEST_ASSERT(iov[0].iov_len == 10);
+    TEST_ASSERT(memcmp(iov[0].iov_base, os_mbuf_test_data + om->om_len + 1,
+                       10) == 0);
+
+    /*** Zero length. */
+    rc = os_mbuf_to_iovec(om, 600, 0, iov, 4);
+    TEST_ASSERT(rc == 0);
+
+    /*** Not enough entries. */
+    rc = os_mbuf_to_iovec(om, 0, 600, iov, 2);
+    TEST_ASSERT(rc == SYS_ENOMEM);
+
+    /*** Past the end of the chain. */
+    rc = os_mbuf_to_iovec(om, 590, 11, iov, 4);
+    TEST_ASSERT(rc == SYS_EINVAL);
+    rc = os_mbuf_to_iovec(om, 601, 0, iov, 4);
+    TEST_ASSERT(rc == SYS_EINVAL);
+
+    os_mbuf_free_chain(om);
+}
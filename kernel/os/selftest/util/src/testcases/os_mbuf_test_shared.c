@@ -0,0 +1,92 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "os_test_priv.h"
+
+#if MYNEWT_VAL(OS_MBUF_SHARED)
+TEST_CASE_SELF(os_mbuf_test_shared)
+{
+    uint8_t buf[16];
+    struct os_mbuf *dup2;
+    struct os_mbuf *dup;
+    struct os_mbuf *om;
+    int num_free;
+    int rc;
+
+    os_mbuf_test_setup();
+
+    om = os_mbuf_get_pkthdr(&os_mbuf_pool, 0);
+    TEST_ASSERT_FATAL(om != NULL);
+    rc = os_mbuf_append(om, os_mbuf_test_data, 300);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(os_mbuf_writable(om));
+
+    /*** Duplicating allocates headers only and shares the data. */
+    num_free = os_mbuf_mempool.mp_num_free;
+    dup = os_mbuf_dup(om);
+    TEST_ASSERT_FATAL(dup != NULL);
+    TEST_ASSERT(os_mbuf_mempool.mp_num_free == num_free - 2);
+    TEST_ASSERT(dup->om_data == om->om_data);
+    TEST_ASSERT(OS_MBUF_PKTLEN(dup) == 300);
+    os_mbuf_test_misc_assert_sane(dup, os_mbuf_test_data, om->om_len, 300,
+                                  om->om_pkthdr_len);
+
+    /* Neither copy may be written in place, or extended into. */
+    TEST_ASSERT(!os_mbuf_writable(om));
+    TEST_ASSERT(!os_mbuf_writable(dup));
+    TEST_ASSERT(OS_MBUF_TRAILINGSPACE(SLIST_NEXT(om, om_next)) == 0);
+
+    /* A duplicate of a duplicate refers to the same data. */
+    dup2 = os_mbuf_dup(dup);
+    TEST_ASSERT_FATAL(dup2 != NULL);
+    TEST_ASSERT(dup2->om_data == om->om_data);
+    TEST_ASSERT(om->om_refcnt == 3);
+
+    /*** Copy on write. */
+    memset(buf, 0xaa, sizeof buf);
+    rc = os_mbuf_copyinto(dup, om->om_len - 8, buf, sizeof buf);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(os_mbuf_cmpf(dup, om->om_len - 8, buf, sizeof buf) == 0);
+    TEST_ASSERT(os_mbuf_cmpf(om, 0, os_mbuf_test_data, 300) == 0);
+    TEST_ASSERT(os_mbuf_cmpf(dup2, 0, os_mbuf_test_data, 300) == 0);
+    TEST_ASSERT(dup->om_data != om->om_data);
+    TEST_ASSERT(os_mbuf_writable(dup));
+    TEST_ASSERT(om->om_refcnt == 2);
+
+    /* Appending to the original does not touch the shared data. */
+    rc = os_mbuf_append(om, os_mbuf_test_data + 300, 10);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(OS_MBUF_PKTLEN(dup2) == 300);
+    TEST_ASSERT(os_mbuf_cmpf(dup2, 0, os_mbuf_test_data, 300) == 0);
+    TEST_ASSERT(os_mbuf_cmpf(om, 0, os_mbuf_test_data, 310) == 0);
+
+    /*** Data outlives the mbuf it was allocated with. */
+    os_mbuf_free_chain(om);
+    TEST_ASSERT(os_mbuf_cmpf(dup2, 0, os_mbuf_test_data, 300) == 0);
+
+    /* Sole remaining reference; writable again. */
+    TEST_ASSERT(os_mbuf_writable(dup2));
+    rc = os_mbuf_copyinto(dup2, 0, buf, sizeof buf);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(os_mbuf_cmpf(dup2, 0, buf, sizeof buf) == 0);
+
+    os_mbuf_free_chain(dup);
+    os_mbuf_free_chain(dup2);
+    TEST_ASSERT(os_mbuf_mempool.mp_num_free == MBUF_TEST_POOL_BUF_COUNT);
+}
+#endif
@@ -0,0 +1,88 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os_test_priv.h"
+
+#define OMTM_NUM_BLOCKS     8
+
+static struct os_mempool omtm_pool;
+
+TEST_CASE_SELF(os_mempool_test_mag)
+{
+    os_membuf_t buf[OS_MEMPOOL_SIZE(OMTM_NUM_BLOCKS, 16)];
+    void *blocks[OMTM_NUM_BLOCKS];
+    struct os_mempool_mag mag;
+    void *block;
+    int rc;
+    int i;
+
+    /* Attempt to unregister the pool in case this test has already run. */
+    os_mempool_unregister(&omtm_pool);
+
+    rc = os_mempool_init(&omtm_pool, OMTM_NUM_BLOCKS, 16, buf, "test_mag");
+    TEST_ASSERT_FATAL(rc == 0);
+
+    os_mempool_mag_init(&mag, &omtm_pool);
+
+    /* Empty magazine refills from the pool in a batch. */
+    blocks[0] = os_mempool_mag_get(&mag);
+    TEST_ASSERT_FATAL(blocks[0] != NULL);
+    TEST_ASSERT(os_memblock_from(&omtm_pool, blocks[0]));
+    TEST_ASSERT(omtm_pool.mp_num_free ==
+                OMTM_NUM_BLOCKS - 1 - MYNEWT_VAL(OS_MEMPOOL_MAG_SIZE) / 2);
+
+    /* Drain the pool entirely through the magazine. */
+    for (i = 1; i < OMTM_NUM_BLOCKS; i++) {
+        blocks[i] = os_mempool_mag_get(&mag);
+        TEST_ASSERT_FATAL(blocks[i] != NULL);
+    }
+    TEST_ASSERT(omtm_pool.mp_num_free == 0);
+    TEST_ASSERT(os_mempool_mag_get(&mag) == NULL);
+
+    /* Freed blocks are cached until the magazine fills up. */
+    for (i = 0; i < MYNEWT_VAL(OS_MEMPOOL_MAG_SIZE); i++) {
+        rc = os_mempool_mag_put(&mag, blocks[i]);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+    TEST_ASSERT(omtm_pool.mp_num_free == 0);
+
+    /* A put into a full magazine returns a batch to the pool. */
+    rc = os_mempool_mag_put(&mag, blocks[i]);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(omtm_pool.mp_num_free ==
+                MYNEWT_VAL(OS_MEMPOOL_MAG_SIZE) -
+                MYNEWT_VAL(OS_MEMPOOL_MAG_SIZE) / 2);
+
+    /* Most recently freed block comes back first. */
+    block = os_mempool_mag_get(&mag);
+    TEST_ASSERT(block == blocks[i]);
+    rc = os_mempool_mag_put(&mag, block);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    for (i++; i < OMTM_NUM_BLOCKS; i++) {
+        rc = os_mempool_mag_put(&mag, blocks[i]);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+
+    os_mempool_mag_flush(&mag);
+    TEST_ASSERT(omtm_pool.mp_num_free == OMTM_NUM_BLOCKS);
+    TEST_ASSERT(os_mempool_is_sane(&omtm_pool));
+
+    os_mempool_unregister(&omtm_pool);
+}
@@ -0,0 +1,91 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "os_test_priv.h"
+
+#if MYNEWT_VAL(MSYS_QUOTA)
+static int omtqb_calls;
+static int omtqb_congested;
+
+static void
+omtqb_cb(struct os_msys_consumer *c, int congested, void *arg)
+{
+    TEST_ASSERT(arg == &omtqb_calls);
+
+    omtqb_calls++;
+    omtqb_congested = congested;
+}
+
+TEST_CASE_SELF(os_msys_test_quota_bp)
+{
+    struct os_msys_consumer c;
+    struct os_mbuf *om1;
+    struct os_mbuf *om2;
+    struct os_mbuf *om3;
+    int rc;
+
+    msys_test_setup();
+    omtqb_calls = 0;
+
+    rc = os_msys_consumer_register(&c, "c", 0, 0);
+    TEST_ASSERT_FATAL(rc == 0);
+    os_msys_consumer_set_bp(&c, 3, 1, omtqb_cb, &omtqb_calls);
+    TEST_ASSERT(omtqb_calls == 0);
+
+    om1 = os_msys_consumer_get(&c, 0, 0);
+    om2 = os_msys_consumer_get(&c, 0, 0);
+    TEST_ASSERT_FATAL(om1 != NULL && om2 != NULL);
+    TEST_ASSERT(omtqb_calls == 0);
+
+    /*** Reaching the high watermark by growing a chain reports
+     * congestion.
+     */
+    rc = os_mbuf_append(om1, os_mbuf_test_data,
+                        OS_MBUF_TRAILINGSPACE(om1) + 1);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(c.omsc_in_use == 3);
+    TEST_ASSERT(omtqb_calls == 1);
+    TEST_ASSERT(omtqb_congested == 1);
+
+    /* Further allocations do not report it again. */
+    om3 = os_msys_consumer_get(&c, 0, 0);
+    TEST_ASSERT_FATAL(om3 != NULL);
+    os_mbuf_free(om3);
+    TEST_ASSERT(omtqb_calls == 1);
+
+    /*** Dropping to the low watermark clears it. */
+    os_mbuf_free_chain(om1);
+    TEST_ASSERT(c.omsc_in_use == 1);
+    TEST_ASSERT(omtqb_calls == 2);
+    TEST_ASSERT(omtqb_congested == 0);
+
+    os_mbuf_free(om2);
+    TEST_ASSERT(omtqb_calls == 2);
+
+    /*** Lowering the watermark below current usage reports right away. */
+    om1 = os_msys_consumer_get(&c, 0, 0);
+    TEST_ASSERT_FATAL(om1 != NULL);
+    os_msys_consumer_set_bp(&c, 1, 0, omtqb_cb, &omtqb_calls);
+    TEST_ASSERT(omtqb_calls == 3);
+    TEST_ASSERT(omtqb_congested == 1);
+
+    os_mbuf_free(om1);
+    TEST_ASSERT(omtqb_calls == 4);
+    TEST_ASSERT(omtqb_congested == 0);
+}
+#endif
@@ -0,0 +1,71 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "os_test_priv.h"
+
+#if MYNEWT_VAL(MSYS_QUOTA)
+#define OMTQL_LIMIT     3
+
+TEST_CASE_SELF(os_msys_test_quota_limit)
+{
+    struct os_msys_consumer c;
+    struct os_mbuf *om;
+    int len;
+    int rc;
+
+    msys_test_setup();
+
+    rc = os_msys_consumer_register(&c, "c", 2, 1);
+    TEST_ASSERT(rc == SYS_EINVAL);
+
+    rc = os_msys_consumer_register(&c, "c", 0, OMTQL_LIMIT);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    om = os_msys_consumer_get_pkthdr(&c, 0, 0);
+    TEST_ASSERT_FATAL(om != NULL);
+    TEST_ASSERT(c.omsc_in_use == 1);
+
+    /*** Mbufs added to grow the chain are charged too. */
+    len = OS_MBUF_TRAILINGSPACE(om) +
+          (OMTQL_LIMIT - 1) * os_mbuf_pool.omp_databuf_len;
+    TEST_ASSERT_FATAL(len <= MBUF_TEST_DATA_LEN);
+    rc = os_mbuf_append(om, os_mbuf_test_data, len);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(c.omsc_in_use == OMTQL_LIMIT);
+    TEST_ASSERT(SLIST_NEXT(om, om_next)->om_consumer == &c);
+
+    /*** Once the limit is reached, neither growth nor allocation is
+     * allowed, although msys still has free mbufs.
+     */
+    TEST_ASSERT(os_msys_num_free() > 0);
+    rc = os_mbuf_append(om, os_mbuf_test_data, 1);
+    TEST_ASSERT(rc == OS_ENOMEM);
+    TEST_ASSERT(os_mbuf_extend(om, 1) == NULL);
+    TEST_ASSERT(os_msys_consumer_get(&c, 0, 0) == NULL);
+    TEST_ASSERT(c.omsc_in_use == OMTQL_LIMIT);
+    TEST_ASSERT(c.omsc_fails == 3);
+    os_mbuf_test_misc_assert_sane(om, os_mbuf_test_data,
+                                  om->om_len, len, om->om_pkthdr_len);
+
+    /*** Freeing the chain uncharges every mbuf in it. */
+    rc = os_mbuf_free_chain(om);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(c.omsc_in_use == 0);
+    TEST_ASSERT(os_msys_num_free() == MBUF_TEST_POOL_BUF_COUNT);
+}
+#endif
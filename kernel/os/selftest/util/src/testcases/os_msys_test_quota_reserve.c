@@ -0,0 +1,84 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "os_test_priv.h"
+
+#if MYNEWT_VAL(MSYS_QUOTA)
+#define OMTQR_RESERVED  4
+
+TEST_CASE_SELF(os_msys_test_quota_reserve)
+{
+    struct os_msys_consumer other;
+    struct os_msys_consumer c;
+    struct os_mbuf *oms[MBUF_TEST_POOL_BUF_COUNT];
+    int num;
+    int rc;
+    int i;
+
+    msys_test_setup();
+
+    rc = os_msys_consumer_register(&c, "c", OMTQR_RESERVED, 0);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /* Reservations cannot add up to more than msys holds. */
+    rc = os_msys_consumer_register(&other, "other",
+                                   MBUF_TEST_POOL_BUF_COUNT -
+                                   OMTQR_RESERVED + 1, 0);
+    TEST_ASSERT(rc == SYS_ENOMEM);
+
+    /*** Plain allocations cannot take the reserved mbufs. */
+    num = 0;
+    while (num < MBUF_TEST_POOL_BUF_COUNT - OMTQR_RESERVED) {
+        oms[num] = os_msys_get(0, 0);
+        TEST_ASSERT_FATAL(oms[num] != NULL);
+        num++;
+    }
+    TEST_ASSERT(os_msys_get(0, 0) == NULL);
+    TEST_ASSERT(os_msys_get_pkthdr(0, 0) == NULL);
+    TEST_ASSERT(os_msys_num_free() == OMTQR_RESERVED);
+
+    /*** The consumer can. */
+    while (num < MBUF_TEST_POOL_BUF_COUNT) {
+        oms[num] = os_msys_consumer_get(&c, 0, 0);
+        TEST_ASSERT_FATAL(oms[num] != NULL);
+        TEST_ASSERT(oms[num]->om_consumer == &c);
+        num++;
+    }
+    TEST_ASSERT(c.omsc_in_use == OMTQR_RESERVED);
+    TEST_ASSERT(c.omsc_fails == 0);
+
+    /*** An empty pool is a failure, and is not charged. */
+    TEST_ASSERT(os_msys_consumer_get(&c, 0, 0) == NULL);
+    TEST_ASSERT(c.omsc_in_use == OMTQR_RESERVED);
+    TEST_ASSERT(c.omsc_fails == 1);
+
+    /*** Freeing uncharges the consumer and restores its reservation. */
+    for (i = 0; i < num; i++) {
+        rc = os_mbuf_free(oms[i]);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+    TEST_ASSERT(c.omsc_in_use == 0);
+    TEST_ASSERT(c.omsc_in_use_max == OMTQR_RESERVED);
+    TEST_ASSERT(os_msys_num_free() == MBUF_TEST_POOL_BUF_COUNT);
+
+    oms[0] = os_msys_get(0, 0);
+    TEST_ASSERT_FATAL(oms[0] != NULL);
+    TEST_ASSERT(os_msys_num_free() == MBUF_TEST_POOL_BUF_COUNT - 1);
+    os_mbuf_free(oms[0]);
+}
+#endif
@@ -0,0 +1,150 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "taskpool/taskpool.h"
+#include "os_test_priv.h"
+
+#if MYNEWT_VAL(OS_MUTEX_PRIO_CHAIN)
+static struct os_sem mutex_chain_sem;
+
+/* Holds g_mutex2 until the test task lets it go. */
+static void
+mutex_chain_low_handler(void *arg)
+{
+    os_error_t err;
+
+    err = os_mutex_pend(&g_mutex2, OS_TIMEOUT_NEVER);
+    TEST_ASSERT(err == OS_OK);
+
+    err = os_sem_pend(&mutex_chain_sem, OS_TIMEOUT_NEVER);
+    TEST_ASSERT(err == OS_OK);
+
+    err = os_mutex_release(&g_mutex2);
+    TEST_ASSERT(err == OS_OK);
+}
+
+/* Holds g_mutex1 while blocked on g_mutex2. */
+static void
+mutex_chain_mid_handler(void *arg)
+{
+    os_error_t err;
+
+    err = os_mutex_pend(&g_mutex1, OS_TIMEOUT_NEVER);
+    TEST_ASSERT(err == OS_OK);
+    err = os_mutex_pend(&g_mutex2, OS_TIMEOUT_NEVER);
+    TEST_ASSERT(err == OS_OK);
+
+    err = os_mutex_release(&g_mutex2);
+    TEST_ASSERT(err == OS_OK);
+    err = os_mutex_release(&g_mutex1);
+    TEST_ASSERT(err == OS_OK);
+}
+
+static void
+mutex_chain_high_handler(void *arg)
+{
+    os_error_t err;
+
+    err = os_mutex_pend(&g_mutex1, OS_TIMEOUT_NEVER);
+    TEST_ASSERT(err == OS_OK);
+    err = os_mutex_release(&g_mutex1);
+    TEST_ASSERT(err == OS_OK);
+}
+
+/**
+ * high waits on g_mutex1, held by mid, which waits on g_mutex2, held by
+ * low.  Both mid and low must inherit high's priority, and drop it again
+ * once the chain unwinds.
+ */
+TEST_CASE_TASK(os_mutex_test_chain)
+{
+    struct os_task *low;
+    struct os_task *mid;
+    int rc;
+
+    rc = os_mutex_init(&g_mutex1);
+    TEST_ASSERT(rc == 0);
+    rc = os_mutex_init(&g_mutex2);
+    TEST_ASSERT(rc == 0);
+    rc = os_sem_init(&mutex_chain_sem, 0);
+    TEST_ASSERT(rc == 0);
+
+    low = taskpool_alloc_assert(mutex_chain_low_handler, TASK4_PRIO);
+    os_time_delay(2);
+
+    mid = taskpool_alloc_assert(mutex_chain_mid_handler, TASK3_PRIO);
+    os_time_delay(2);
+    TEST_ASSERT(low->t_prio == TASK3_PRIO);
+
+    taskpool_alloc_assert(mutex_chain_high_handler, TASK2_PRIO);
+    os_time_delay(2);
+    TEST_ASSERT(mid->t_prio == TASK2_PRIO);
+    TEST_ASSERT(low->t_prio == TASK2_PRIO);
+
+    os_sem_release(&mutex_chain_sem);
+    os_time_delay(2);
+    TEST_ASSERT(low->t_prio == TASK4_PRIO);
+    TEST_ASSERT(mid->t_prio == TASK3_PRIO);
+    TEST_ASSERT(g_mutex1.mu_owner == NULL);
+    TEST_ASSERT(g_mutex2.mu_owner == NULL);
+
+    taskpool_wait_assert(OS_TICKS_PER_SEC);
+}
+
+static volatile uint8_t mutex_ceiling_held_prio;
+static volatile uint8_t mutex_ceiling_rel_prio;
+
+static void
+mutex_ceiling_handler(void *arg)
+{
+    struct os_task *t;
+    os_error_t err;
+
+    t = os_sched_get_current_task();
+
+    err = os_mutex_pend(&g_mutex1, OS_TIMEOUT_NEVER);
+    TEST_ASSERT(err == OS_OK);
+    mutex_ceiling_held_prio = t->t_prio;
+
+    err = os_mutex_release(&g_mutex1);
+    TEST_ASSERT(err == OS_OK);
+    mutex_ceiling_rel_prio = t->t_prio;
+}
+
+/**
+ * A task locking a ceiling mutex runs at the ceiling priority until it
+ * releases the mutex.
+ */
+TEST_CASE_TASK(os_mutex_test_ceiling)
+{
+    int rc;
+
+    TEST_ASSERT(os_mutex_init_ceiling(NULL, TASK2_PRIO) == OS_INVALID_PARM);
+
+    rc = os_mutex_init_ceiling(&g_mutex1, TASK2_PRIO);
+    TEST_ASSERT(rc == 0);
+
+    taskpool_alloc_assert(mutex_ceiling_handler, TASK4_PRIO);
+    taskpool_wait_assert(OS_TICKS_PER_SEC);
+
+    TEST_ASSERT(mutex_ceiling_held_prio == TASK2_PRIO);
+    TEST_ASSERT(mutex_ceiling_rel_prio == TASK4_PRIO);
+}
+#endif
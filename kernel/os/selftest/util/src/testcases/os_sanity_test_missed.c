@@ -0,0 +1,62 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "os_test_priv.h"
+
+static struct os_sanity_check ostm_short;
+static struct os_sanity_check ostm_long;
+
+/*
+ * A check that never checks in is reported once its deadline has passed,
+ * and keeps being reported until it checks in again.
+ */
+TEST_CASE_SELF(os_sanity_test_missed)
+{
+    os_time_t start;
+    int rc;
+
+    start = os_time_get();
+
+    os_sanity_check_init(&ostm_long);
+    ostm_long.sc_checkin_itvl = 100;
+    os_sanity_check_reset(&ostm_long);
+    rc = os_sanity_check_register(&ostm_long);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    os_sanity_check_init(&ostm_short);
+    ostm_short.sc_checkin_itvl = 10;
+    os_sanity_check_reset(&ostm_short);
+    rc = os_sanity_check_register(&ostm_short);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /* The deadline itself is still in time. */
+    TEST_ASSERT(os_sanity_run_at(start + 10) == NULL);
+    TEST_ASSERT(os_sanity_run_at(start + 11) == &ostm_short);
+    TEST_ASSERT(os_sanity_run_at(start + 12) == &ostm_short);
+
+    os_time_advance(12);
+    os_sanity_check_reset(&ostm_short);
+    TEST_ASSERT(os_sanity_run_at(start + 12) == NULL);
+    TEST_ASSERT(os_sanity_run_at(start + 22) == NULL);
+
+    /* Both have now missed; the earlier deadline is reported first. */
+    TEST_ASSERT(os_sanity_run_at(start + 101) == &ostm_short);
+    os_time_advance(89);
+    os_sanity_check_reset(&ostm_short);
+    TEST_ASSERT(os_sanity_run_at(start + 101) == &ostm_long);
+}
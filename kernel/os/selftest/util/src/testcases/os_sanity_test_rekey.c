@@ -0,0 +1,70 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "os_test_priv.h"
+
+/* One more than the features target's SANITY_DEADLINE_HEAP_SIZE. */
+#define OSTR_NUM_CHECKS     5
+
+static struct os_sanity_check ostr_checks[OSTR_NUM_CHECKS];
+
+/*
+ * A check that checked in is not reported after its first deadline passes;
+ * it is looked at again against its new deadline.  A check past the heap
+ * size goes on the list and is still checked.
+ */
+TEST_CASE_SELF(os_sanity_test_rekey)
+{
+    os_time_t start;
+    int rc;
+    int i;
+
+    start = os_time_get();
+
+    /* Deadlines start + 10, + 20, ..., + 50. */
+    for (i = 0; i < OSTR_NUM_CHECKS; i++) {
+        os_sanity_check_init(&ostr_checks[i]);
+        ostr_checks[i].sc_checkin_itvl = 10 * (i + 1);
+        os_sanity_check_reset(&ostr_checks[i]);
+
+        rc = os_sanity_check_register(&ostr_checks[i]);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+
+    TEST_ASSERT(os_sanity_run_at(start + 5) == NULL);
+
+    /* Every check checks in at start + 8; deadlines move out by 8. */
+    os_time_advance(8);
+    for (i = 0; i < OSTR_NUM_CHECKS; i++) {
+        os_sanity_check_reset(&ostr_checks[i]);
+    }
+
+    /* Past the first original deadline, not the new one. */
+    TEST_ASSERT(os_sanity_run_at(start + 15) == NULL);
+    TEST_ASSERT(os_sanity_run_at(start + 18) == NULL);
+
+    /*
+     * The first check checks in again at start + 25; the second passes its
+     * original deadline and is re-keyed to start + 28, which it then misses.
+     */
+    os_time_advance(17);
+    os_sanity_check_reset(&ostr_checks[0]);
+    TEST_ASSERT(os_sanity_run_at(start + 25) == NULL);
+    TEST_ASSERT(os_sanity_run_at(start + 28) == NULL);
+    TEST_ASSERT(os_sanity_run_at(start + 29) == &ostr_checks[1]);
+}
@@ -0,0 +1,55 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "os_test_priv.h"
+
+#if MYNEWT_VAL(OS_TASK_CPU_STATS)
+/**
+ * Checks that interrupt handlers are counted once per outermost entry and
+ * that a task's CPU time only grows across context switches.
+ */
+TEST_CASE_TASK(os_sched_test_cpu_stats)
+{
+    struct os_cpu_stats before;
+    struct os_cpu_stats after;
+    struct os_task *t;
+    uint64_t cputime;
+
+    t = os_sched_get_current_task();
+
+    os_cpu_stats_get(&before);
+
+    /* Nested entries count as separate invocations. */
+    os_trace_isr_enter();
+    os_trace_isr_enter();
+    os_trace_isr_exit();
+    os_trace_isr_exit();
+
+    os_cpu_stats_get(&after);
+    TEST_ASSERT(after.ocs_isr_cnt == before.ocs_isr_cnt + 2);
+    TEST_ASSERT(after.ocs_isr_time >= before.ocs_isr_time);
+
+    /* Sleeping switches to the idle task and back. */
+    cputime = t->t_cpu_time;
+    os_time_delay(2);
+    TEST_ASSERT(t->t_cpu_time >= cputime);
+
+    os_cpu_stats_get(&after);
+    TEST_ASSERT(after.ocs_idle_time >= before.ocs_idle_time);
+}
+#endif
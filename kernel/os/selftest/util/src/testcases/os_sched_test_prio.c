@@ -0,0 +1,57 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "taskpool/taskpool.h"
+#include "os_test_priv.h"
+
+TEST_CASE_TASK(os_sched_test_prio)
+{
+    struct os_task *cur;
+    struct os_task *t;
+    os_sr_t sr;
+    int i;
+
+    sched_test_num_runs = 0;
+
+    cur = os_sched_get_current_task();
+
+    /* Create lower priority tasks out of order; none of them may run yet. */
+    taskpool_alloc_assert(sched_test_record_handler, TASK4_PRIO);
+    taskpool_alloc_assert(sched_test_record_handler, TASK3_PRIO);
+    t = taskpool_alloc_assert(sched_test_record_handler, TASK4_PRIO + 1);
+    TEST_ASSERT(sched_test_num_runs == 0);
+
+    OS_ENTER_CRITICAL(sr);
+    TEST_ASSERT(os_sched_next_task() == cur);
+
+    /* Move the last task ahead of its siblings while it is ready. */
+    t->t_prio = TASK2_PRIO;
+    os_sched_resort(t);
+    TEST_ASSERT(os_sched_next_task() == cur);
+    OS_EXIT_CRITICAL(sr);
+
+    taskpool_wait_assert(OS_TICKS_PER_SEC);
+
+    /* Tasks must have been dispatched in priority order. */
+    TEST_ASSERT_FATAL(sched_test_num_runs == 3);
+    TEST_ASSERT(sched_test_run_prios[0] == TASK2_PRIO);
+    for (i = 1; i < sched_test_num_runs; i++) {
+        TEST_ASSERT(sched_test_run_prios[i - 1] < sched_test_run_prios[i]);
+    }
+}
@@ -0,0 +1,51 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "taskpool/taskpool.h"
+#include "os_test_priv.h"
+
+TEST_CASE_TASK(os_sched_test_sleep)
+{
+    os_time_t start;
+    os_time_t wakeup;
+    os_sr_t sr;
+
+    sched_test_num_runs = 0;
+
+    taskpool_alloc_assert(sched_test_sleep_handler, TASK2_PRIO);
+    taskpool_alloc_assert(sched_test_sleep_handler, TASK3_PRIO);
+    taskpool_alloc_assert(sched_test_sleep_handler, TASK4_PRIO);
+
+    /* Let all three tasks go to sleep. */
+    start = os_time_get();
+    os_time_delay(1);
+
+    OS_ENTER_CRITICAL(sr);
+    wakeup = os_sched_wakeup_ticks(start);
+    OS_EXIT_CRITICAL(sr);
+    TEST_ASSERT(wakeup != OS_TIMEOUT_NEVER && wakeup <= 10);
+
+    taskpool_wait_assert(OS_TICKS_PER_SEC);
+
+    /* Tasks must wake up in order of their wakeup time, not priority. */
+    TEST_ASSERT_FATAL(sched_test_num_runs == 3);
+    TEST_ASSERT(sched_test_run_prios[0] == TASK4_PRIO);
+    TEST_ASSERT(sched_test_run_prios[1] == TASK3_PRIO);
+    TEST_ASSERT(sched_test_run_prios[2] == TASK2_PRIO);
+}
@@ -0,0 +1,64 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "taskpool/taskpool.h"
+#include "os_test_priv.h"
+
+/*
+ * Wakes a sleeping task that is not the next to time out, so that it has to
+ * be removed from the middle of the sleep queue.
+ */
+TEST_CASE_TASK(os_sched_test_sleep_wake)
+{
+    os_time_t start;
+    os_time_t wakeup;
+    os_sr_t sr;
+    int rc;
+
+    sched_test_num_runs = 0;
+
+    rc = os_sem_init(&sched_test_sem, 0);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    taskpool_alloc_assert(sched_test_sem_handler, TASK2_PRIO);
+    taskpool_alloc_assert(sched_test_sem_handler, TASK3_PRIO);
+    taskpool_alloc_assert(sched_test_sem_handler, TASK4_PRIO);
+
+    /* Let all three tasks pend on the semaphore. */
+    start = os_time_get();
+    os_time_delay(1);
+    TEST_ASSERT_FATAL(sched_test_num_runs == 0);
+
+    /* Wakes the highest priority waiter, which has the latest timeout. */
+    rc = os_sem_release(&sched_test_sem);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    OS_ENTER_CRITICAL(sr);
+    wakeup = os_sched_wakeup_ticks(start);
+    OS_EXIT_CRITICAL(sr);
+    TEST_ASSERT(wakeup != OS_TIMEOUT_NEVER && wakeup <= 10);
+
+    taskpool_wait_assert(OS_TICKS_PER_SEC);
+
+    /* The released task runs first; the others time out in order. */
+    TEST_ASSERT_FATAL(sched_test_num_runs == 3);
+    TEST_ASSERT(sched_test_run_prios[0] == TASK2_PRIO);
+    TEST_ASSERT(sched_test_run_prios[1] == TASK4_PRIO);
+    TEST_ASSERT(sched_test_run_prios[2] == TASK3_PRIO);
+}
@@ -0,0 +1,96 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "os_test_priv.h"
+
+#if MYNEWT_VAL(OS_TIMESTAMP)
+
+/* Each step lets the epoch update callout run at least once. */
+#define OTTT_STEP_TICKS     \
+    ((MYNEWT_VAL(OS_TIMESTAMP_UPDATE_MS) + 1000) * OS_TICKS_PER_SEC / 1000)
+
+/* Allows for a real sim tick landing between two paired reads. */
+#define OTTT_SLACK_USECS    (2 * 1000000 / OS_TICKS_PER_SEC)
+
+#define OTTT_MAX_STEPS      1000
+
+/*
+ * Advances os time by one step and checks that the timestamp moved forward
+ * by the elapsed cputime.  Returns true if cputime wrapped during the step.
+ */
+static bool
+ottt_step(void)
+{
+    uint32_t cputime0;
+    uint32_t cputime1;
+    int64_t expected;
+    int64_t delta;
+    int64_t ts0;
+    int64_t ts1;
+
+    cputime0 = os_cputime_get32();
+    ts0 = os_timestamp64();
+
+    os_time_advance(OTTT_STEP_TICKS);
+
+    cputime1 = os_cputime_get32();
+    ts1 = os_timestamp64();
+
+    TEST_ASSERT_FATAL(ts1 > ts0);
+
+    delta = ts1 - ts0;
+    expected = os_cputime_ticks_to_usecs(cputime1 - cputime0);
+    TEST_ASSERT(delta >= expected - OTTT_SLACK_USECS &&
+                delta <= expected + OTTT_SLACK_USECS,
+                "delta=%lld expected=%lld",
+                (long long)delta, (long long)expected);
+
+    return cputime1 < cputime0;
+}
+
+TEST_CASE_TASK(os_time_test_timestamp)
+{
+    int64_t prev;
+    int64_t ts;
+    int i;
+
+    /* Back to back reads never go backwards. */
+    prev = os_timestamp64();
+    for (i = 0; i < 100; i++) {
+        ts = os_timestamp64();
+        TEST_ASSERT_FATAL(ts >= prev);
+        prev = ts;
+    }
+
+    /* Across epoch advances. */
+    for (i = 0; i < 4; i++) {
+        ottt_step();
+    }
+
+    /* Up to and across a 32-bit cputime wrap, and one epoch beyond it. */
+    for (i = 0; i < OTTT_MAX_STEPS; i++) {
+        if (ottt_step()) {
+            break;
+        }
+    }
+    TEST_ASSERT_FATAL(i < OTTT_MAX_STEPS, "cputime did not wrap");
+
+    ottt_step();
+}
+
+#endif
@@ -24,4 +24,7 @@
 TEST_SUITE(os_time_test_suite)
 {
     os_time_test_change();
+#if MYNEWT_VAL(OS_TIMESTAMP)
+    os_time_test_timestamp();
+#endif
 }
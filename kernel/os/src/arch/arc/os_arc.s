@@ -19,6 +19,7 @@
 
 #include "inc/arc/arc.h"
 #include "inc/arc/arc_asm_common.h"
+#include "syscfg/syscfg.h"
 
     .file "os_arc.s"
 
@@ -107,7 +108,11 @@ irq_hint_handled:
     st      r0, [r1]
 
     /* Check if we should be running a different task */
+#if MYNEWT_VAL(OS_SCHED_PRIO_BITMAP)
+    mov     r3, g_os_run_top
+#else
     mov     r3, g_os_run_list
+#endif
     ld      r2, [r3]
     mov     r3, g_current_task
     ld      r1, [r3]
@@ -224,7 +229,11 @@ ret_exc:
     st      r0, [r1]
 
     /* Check if we should be running a different task */
+#if MYNEWT_VAL(OS_SCHED_PRIO_BITMAP)
+    mov     r3, g_os_run_top
+#else
     mov     r3, g_os_run_list
+#endif
     ld      r2, [r3]
     mov     r3, g_current_task
     ld      r1, [r3]
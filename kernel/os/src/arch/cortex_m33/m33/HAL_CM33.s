@@ -98,7 +98,7 @@ SVC_Handler:
         .fnstart
         .cantunwind
 
-#if MYNEWT_VAL(OS_SYSVIEW)
+#if MYNEWT_VAL(OS_SYSVIEW) || MYNEWT_VAL(OS_TRACE_RING)
         PUSH    {R4,LR}
         BL      os_trace_isr_enter
         POP     {R4,LR}
@@ -117,7 +117,7 @@ SVC_Handler:
         MRS     R12,PSP                 /* Read PSP */
         STM     R12,{R0-R2}             /* Store return values */
 
-#if MYNEWT_VAL(OS_SYSVIEW)
+#if MYNEWT_VAL(OS_SYSVIEW) || MYNEWT_VAL(OS_TRACE_RING)
         PUSH    {R4,LR}
         BL      os_trace_isr_exit
         POP     {R4,LR}
@@ -142,7 +142,7 @@ SVC_User:
         MRS     R12,PSP
         STM     R12,{R0-R3}             /* Function return values */
 SVC_Done:
-#if MYNEWT_VAL(OS_SYSVIEW)
+#if MYNEWT_VAL(OS_SYSVIEW) || MYNEWT_VAL(OS_TRACE_RING)
         BL      os_trace_isr_exit
 #endif
         POP     {R4,LR}                 /* Restore EXC_RETURN */
@@ -163,7 +163,11 @@ PendSV_Handler:
         .fnstart
         .cantunwind
 
+#if MYNEWT_VAL(OS_SCHED_PRIO_BITMAP)
+        LDR     R3,=g_os_run_top        /* Get highest priority task ready to run */
+#else
         LDR     R3,=g_os_run_list       /* Get highest priority task ready to run */
+#endif
         LDR     R2,[R3]                 /* Store in R2 */
         LDR     R3,=g_current_task      /* Get current task */
         LDR     R1,[R3]                 /* Current task in R1 */
@@ -193,10 +197,16 @@ PendSV_Handler:
         MVNNE   LR,#~0xFFFFFFFD         /* BX treats is as basic frame */
 #else
         LDMIA   R12!,{R4-R11}           /* Restore New Context */
+#endif
+#if MYNEWT_VAL(OS_CTX_SW_STACK_LIMIT)
+        LDR     R0,[R2,#4]              /* Stack top of task we will start */
+        LDRH    R1,[R2,#8]              /* Stack size, in words */
+        SUB     R0,R0,R1,LSL #2         /* Bottom of its stack */
+        MSR     PSPLIM,R0               /* Fault if PSP goes below it */
 #endif
         MSR     PSP,R12                 /* Write PSP */
 
-#if MYNEWT_VAL(OS_SYSVIEW)
+#if MYNEWT_VAL(OS_SYSVIEW) || MYNEWT_VAL(OS_TRACE_RING)
         PUSH    {R4,LR}
         MOV     R0, R2
         BL      os_trace_task_start_exec
@@ -220,11 +230,11 @@ SysTick_Handler:
         .cantunwind
 
         PUSH    {R4,LR}                 /* Save EXC_RETURN */
-#if MYNEWT_VAL(OS_SYSVIEW)
+#if MYNEWT_VAL(OS_SYSVIEW) || MYNEWT_VAL(OS_TRACE_RING)
         BL      os_trace_isr_enter
 #endif
         BL      timer_handler
-#if MYNEWT_VAL(OS_SYSVIEW)
+#if MYNEWT_VAL(OS_SYSVIEW) || MYNEWT_VAL(OS_TRACE_RING)
         BL      os_trace_isr_exit
 #endif
         POP     {R4,LR}                 /* Restore EXC_RETURN */
@@ -241,7 +251,7 @@ os_default_irq_asm:
         .fnstart
         .cantunwind
 
-#if MYNEWT_VAL(OS_SYSVIEW)
+#if MYNEWT_VAL(OS_SYSVIEW) || MYNEWT_VAL(OS_TRACE_RING)
         PUSH    {R4,LR}
         BL      os_trace_isr_enter
         POP     {R4,LR}
@@ -260,7 +270,7 @@ os_default_irq_asm:
         BL      os_default_irq
         POP     {R3-R11,LR}                 /* Restore EXC_RETURN */
 
-#if MYNEWT_VAL(OS_SYSVIEW)
+#if MYNEWT_VAL(OS_SYSVIEW) || MYNEWT_VAL(OS_TRACE_RING)
         PUSH    {R4,LR}
         BL      os_trace_isr_exit
         POP     {R4,LR}
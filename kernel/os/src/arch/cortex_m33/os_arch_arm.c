@@ -270,6 +270,10 @@ os_arch_start(void)
 
     /* Adjust PSP so it looks like this task just took an exception */
     __set_PSP((uint32_t)t->t_stackptr + offsetof(struct stack_frame, r0));
+#if MYNEWT_VAL(OS_CTX_SW_STACK_LIMIT)
+    /* PendSV sets the limit on later switches; this task starts in place. */
+    __set_PSPLIM((uint32_t)(t->t_stacktop - t->t_stacksize));
+#endif
 
     /* Intitialize and start system clock timer */
     os_tick_init(OS_TICKS_PER_SEC, OS_TICK_PRIO);
@@ -147,7 +147,11 @@ PendSV_Handler:
         .fnstart
         .cantunwind
 
+#if MYNEWT_VAL(OS_SCHED_PRIO_BITMAP)
+        LDR     R3,=g_os_run_top        /* Get highest priority task ready to run */
+#else
         LDR     R3,=g_os_run_list       /* Get highest priority task ready to run */
+#endif
         LDR     R2,[R3]                 /* Store in R2 */
         LDR     R3,=g_current_task      /* Get current task */
         LDR     R1,[R3]                 /* Current task in R1 */
@@ -180,7 +184,7 @@ PendSV_Handler:
 #endif
         MSR     PSP,R12                 /* Write PSP */
 
-#if MYNEWT_VAL(OS_SYSVIEW)
+#if MYNEWT_VAL(OS_SYSVIEW) || MYNEWT_VAL(OS_TRACE_RING)
         PUSH    {R4,LR}
         MOV     R0, R2
         BL      os_trace_task_start_exec
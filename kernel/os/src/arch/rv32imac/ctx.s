@@ -20,6 +20,7 @@
 #include <env/encoding.h>
 #include <env/freedom-e300-hifive1/platform.h>
 #include <bits.h>
+#include <syscfg/syscfg.h>
 
     /* SP Offset in task */
     sp_offset = 0x00
@@ -125,7 +126,11 @@ fast_finish_context_switch:
 
 context_switch:
     /* Do context switch only if highest priority task changed */
+#if MYNEWT_VAL(OS_SCHED_PRIO_BITMAP)
+    lw t2, g_os_run_top      /* Get highest priority task ready to run */
+#else
     lw t2, g_os_run_list     /* Get highest priority task ready to run */
+#endif
     la t1, g_current_task    /* Get current task address */
     lw t0, (t1)              /* Get current task */
     beq t0, t2, fast_finish_context_switch  /* No context switch needed */
@@ -222,7 +222,7 @@ os_init(int (*main_fn)(int argc, char **arg))
     SEGGER_RTT_Init();
 #endif
 
-    TAILQ_INIT(&g_callout_list);
+    os_callout_module_init();
     STAILQ_INIT(&g_os_task_list);
     os_eventq_init(os_eventq_dflt_get());
 
@@ -295,6 +295,7 @@ os_pkg_init(void)
     assert(err == OS_OK);
 
     os_mempool_module_init();
+    os_heap_module_init();
     os_msys_init();
 }
 
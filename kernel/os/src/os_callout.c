@@ -26,8 +26,148 @@
 #include "os/mynewt.h"
 #include "os_priv.h"
 
+#if MYNEWT_VAL(OS_CALLOUT_WHEEL)
+/*
+ * Hashed timing wheel.  A callout lives in the slot selected by the low bits
+ * of its expiry tick; slots are unsorted so arming and cancelling is
+ * constant-time.  The earliest callout of every slot is cached and a bitmap
+ * tracks the non-empty slots, which keeps os_callout_wakeup_ticks() bounded
+ * by the number of slots rather than the number of callouts.
+ */
+#define OS_CALLOUT_WHEEL_SLOTS      MYNEWT_VAL(OS_CALLOUT_WHEEL_SLOTS)
+#define OS_CALLOUT_WHEEL_MASK       (OS_CALLOUT_WHEEL_SLOTS - 1)
+#define OS_CALLOUT_WHEEL_MAP_WORDS  ((OS_CALLOUT_WHEEL_SLOTS + 31) / 32)
+
+#if (OS_CALLOUT_WHEEL_SLOTS & OS_CALLOUT_WHEEL_MASK) != 0
+#error "OS_CALLOUT_WHEEL_SLOTS must be a power of two"
+#endif
+
+struct os_callout_list g_callout_wheel[OS_CALLOUT_WHEEL_SLOTS];
+static struct os_callout *os_callout_wheel_first[OS_CALLOUT_WHEEL_SLOTS];
+static uint32_t os_callout_wheel_map[OS_CALLOUT_WHEEL_MAP_WORDS];
+
+/* Last tick for which expired callouts have been processed */
+static os_time_t os_callout_wheel_last;
+
+static void
+os_callout_insert(struct os_callout *c)
+{
+    struct os_callout *first;
+    int slot;
+
+    slot = c->c_ticks & OS_CALLOUT_WHEEL_MASK;
+
+    TAILQ_INSERT_TAIL(&g_callout_wheel[slot], c, c_next);
+
+    first = os_callout_wheel_first[slot];
+    if (first == NULL || OS_TIME_TICK_LT(c->c_ticks, first->c_ticks)) {
+        os_callout_wheel_first[slot] = c;
+    }
+    os_callout_wheel_map[slot / 32] |= 1UL << (slot % 32);
+}
+
+static void
+os_callout_remove(struct os_callout *c)
+{
+    struct os_callout *entry;
+    struct os_callout *first;
+    int slot;
+
+    slot = c->c_ticks & OS_CALLOUT_WHEEL_MASK;
+
+    TAILQ_REMOVE(&g_callout_wheel[slot], c, c_next);
+    c->c_next.tqe_prev = NULL;
+
+    if (os_callout_wheel_first[slot] != c) {
+        return;
+    }
+
+    first = NULL;
+    TAILQ_FOREACH(entry, &g_callout_wheel[slot], c_next) {
+        if (first == NULL || OS_TIME_TICK_LT(entry->c_ticks, first->c_ticks)) {
+            first = entry;
+        }
+    }
+    os_callout_wheel_first[slot] = first;
+    if (first == NULL) {
+        os_callout_wheel_map[slot / 32] &= ~(1UL << (slot % 32));
+    }
+}
+
+void
+os_callout_module_init(void)
+{
+    int i;
+
+    for (i = 0; i < OS_CALLOUT_WHEEL_SLOTS; i++) {
+        TAILQ_INIT(&g_callout_wheel[i]);
+        os_callout_wheel_first[i] = NULL;
+    }
+    memset(os_callout_wheel_map, 0, sizeof os_callout_wheel_map);
+    os_callout_wheel_last = os_time_get();
+}
+
+#else
+
 struct os_callout_list g_callout_list;
 
+static void
+os_callout_insert(struct os_callout *c)
+{
+    struct os_callout *entry;
+
+    TAILQ_FOREACH(entry, &g_callout_list, c_next) {
+        if (OS_TIME_TICK_LT(c->c_ticks, entry->c_ticks)) {
+            break;
+        }
+    }
+
+    if (entry) {
+        TAILQ_INSERT_BEFORE(entry, c, c_next);
+    } else {
+        TAILQ_INSERT_TAIL(&g_callout_list, c, c_next);
+    }
+}
+
+static void
+os_callout_remove(struct os_callout *c)
+{
+    TAILQ_REMOVE(&g_callout_list, c, c_next);
+    c->c_next.tqe_prev = NULL;
+}
+
+void
+os_callout_module_init(void)
+{
+    TAILQ_INIT(&g_callout_list);
+}
+
+#endif
+
+/**
+ * Returns the number of ticks from now until the given time, or 0 if it is
+ * in the past.
+ */
+static os_time_t
+os_callout_ticks_until(os_time_t when, os_time_t now)
+{
+    if (OS_TIME_TICK_GEQ(when, now)) {
+        return when - now;
+    } else {
+        return 0;
+    }
+}
+
+static void
+os_callout_fire(struct os_callout *c)
+{
+    if (c->c_evq) {
+        os_eventq_put(c->c_evq, &c->c_ev);
+    } else {
+        c->c_ev.ev_cb(&c->c_ev);
+    }
+}
+
 void os_callout_init(struct os_callout *c, struct os_eventq *evq,
                      os_event_fn *ev_cb, void *ev_arg)
 {
@@ -51,8 +191,7 @@ os_callout_stop(struct os_callout *c)
     OS_ENTER_CRITICAL(sr);
 
     if (os_callout_queued(c)) {
-        TAILQ_REMOVE(&g_callout_list, c, c_next);
-        c->c_next.tqe_prev = NULL;
+        os_callout_remove(c);
     }
 
     if (c->c_evq) {
@@ -64,10 +203,19 @@ os_callout_stop(struct os_callout *c)
     os_trace_api_ret(OS_TRACE_ID_CALLOUT_STOP);
 }
 
+#if MYNEWT_VAL(OS_CALLOUT_SLACK)
+void
+os_callout_set_slack(struct os_callout *c, os_time_t slack)
+{
+    assert(slack <= INT32_MAX / 2);
+
+    c->c_slack = slack;
+}
+#endif
+
 int
 os_callout_reset(struct os_callout *c, os_time_t ticks)
 {
-    struct os_callout *entry;
     os_sr_t sr;
     int ret;
 
@@ -90,19 +238,7 @@ os_callout_reset(struct os_callout *c, os_time_t ticks)
     }
 
     c->c_ticks = os_time_get() + ticks;
-
-    entry = NULL;
-    TAILQ_FOREACH(entry, &g_callout_list, c_next) {
-        if (OS_TIME_TICK_LT(c->c_ticks, entry->c_ticks)) {
-            break;
-        }
-    }
-
-    if (entry) {
-        TAILQ_INSERT_BEFORE(entry, c, c_next);
-    } else {
-        TAILQ_INSERT_TAIL(&g_callout_list, c, c_next);
-    }
+    os_callout_insert(c);
 
     OS_EXIT_CRITICAL(sr);
 
@@ -114,6 +250,122 @@ err:
 }
 
 
+#if MYNEWT_VAL(OS_CALLOUT_WHEEL)
+
+/**
+ * This function is called by the OS in the time tick.  It visits the wheel
+ * slots of every tick that elapsed since the previous call, and posts an
+ * event for each callout in those slots that is ready to run, to the event
+ * queue provided to os_callout_init().
+ */
+void
+os_callout_tick(void)
+{
+    os_sr_t sr;
+    struct os_callout *c;
+    os_time_t elapsed;
+    os_time_t tick;
+    uint32_t now;
+    int slot;
+
+    os_trace_api_void(OS_TRACE_ID_CALLOUT_TICK);
+
+    now = os_time_get();
+
+    OS_ENTER_CRITICAL(sr);
+    tick = os_callout_wheel_last;
+    elapsed = now - tick;
+    os_callout_wheel_last = now;
+    OS_EXIT_CRITICAL(sr);
+
+    /* Once a full rotation has elapsed every slot needs to be visited. */
+    if (elapsed > OS_CALLOUT_WHEEL_SLOTS) {
+        elapsed = OS_CALLOUT_WHEEL_SLOTS;
+    }
+
+    while (elapsed--) {
+        tick++;
+        slot = tick & OS_CALLOUT_WHEEL_MASK;
+
+        while (1) {
+            OS_ENTER_CRITICAL(sr);
+            c = os_callout_wheel_first[slot];
+            if (c) {
+                if (OS_TIME_TICK_GEQ(now, c->c_ticks)) {
+                    os_callout_remove(c);
+                } else {
+                    c = NULL;
+                }
+            }
+            OS_EXIT_CRITICAL(sr);
+
+            if (c) {
+                os_callout_fire(c);
+            } else {
+                break;
+            }
+        }
+    }
+
+    os_trace_api_ret(OS_TRACE_ID_CALLOUT_TICK);
+}
+
+/*
+ * Returns the number of ticks to the first pending callout. If there are no
+ * pending callouts then return OS_TIMEOUT_NEVER instead.  With
+ * OS_CALLOUT_SLACK, this is the earliest expiry plus slack of any callout,
+ * which lets the idle task sleep until several callouts are due.
+ *
+ * @param now The time now
+ *
+ * @return Number of ticks to first pending callout
+ */
+os_time_t
+os_callout_wakeup_ticks(os_time_t now)
+{
+    os_time_t rt;
+    os_time_t ticks;
+    struct os_callout *c;
+    uint32_t map;
+    int slot;
+    int i;
+
+    OS_ASSERT_CRITICAL();
+
+    rt = OS_TIMEOUT_NEVER;
+
+    for (i = 0; i < OS_CALLOUT_WHEEL_MAP_WORDS; i++) {
+        map = os_callout_wheel_map[i];
+        while (map) {
+            slot = i * 32 + __builtin_ctz(map);
+            map &= map - 1;
+
+            c = os_callout_wheel_first[slot];
+            ticks = os_callout_ticks_until(c->c_ticks, now);
+#if MYNEWT_VAL(OS_CALLOUT_SLACK)
+            /* Nothing in this slot expires before the current deadline. */
+            if (ticks >= rt) {
+                continue;
+            }
+            TAILQ_FOREACH(c, &g_callout_wheel[slot], c_next) {
+                ticks = os_callout_ticks_until(c->c_ticks + c->c_slack, now);
+                if (ticks < rt) {
+                    rt = ticks;
+                }
+            }
+#else
+            if (ticks < rt) {
+                rt = ticks;
+            }
+#endif
+        }
+    }
+
+    return (rt);
+}
+
+#else
+
 /**
  * This function is called by the OS in the time tick.  It searches the list
  * of callouts, and sees if any of them are ready to run.  If they are ready
@@ -136,8 +388,7 @@ os_callout_tick(void)
         c = TAILQ_FIRST(&g_callout_list);
         if (c) {
             if (OS_TIME_TICK_GEQ(now, c->c_ticks)) {
-                TAILQ_REMOVE(&g_callout_list, c, c_next);
-                c->c_next.tqe_prev = NULL;
+                os_callout_remove(c);
             } else {
                 c = NULL;
             }
@@ -145,11 +396,7 @@ os_callout_tick(void)
         OS_EXIT_CRITICAL(sr);
 
         if (c) {
-            if (c->c_evq) {
-                os_eventq_put(c->c_evq, &c->c_ev);
-            } else {
-                c->c_ev.ev_cb(&c->c_ev);
-            }
+            os_callout_fire(c);
         } else {
             break;
         }
@@ -160,7 +407,9 @@ os_callout_tick(void)
 
 /*
  * Returns the number of ticks to the first pending callout. If there are no
- * pending callouts then return OS_TIMEOUT_NEVER instead.
+ * pending callouts then return OS_TIMEOUT_NEVER instead.  With
+ * OS_CALLOUT_SLACK, this is the earliest expiry plus slack of any callout,
+ * which lets the idle task sleep until several callouts are due.
  *
  * @param now The time now
  *
@@ -170,24 +419,44 @@ os_time_t
 os_callout_wakeup_ticks(os_time_t now)
 {
     os_time_t rt;
+#if MYNEWT_VAL(OS_CALLOUT_SLACK)
+    os_time_t ticks;
+#endif
     struct os_callout *c;
 
     OS_ASSERT_CRITICAL();
 
+#if MYNEWT_VAL(OS_CALLOUT_SLACK)
+    rt = OS_TIMEOUT_NEVER;
+
+    /*
+     * Wake up for the earliest deadline (expiry plus slack).  The list is
+     * sorted by expiry, so once a callout expires after the deadline found
+     * so far, no later callout can move it earlier.
+     */
+    TAILQ_FOREACH(c, &g_callout_list, c_next) {
+        if (os_callout_ticks_until(c->c_ticks, now) >= rt) {
+            break;
+        }
+        ticks = os_callout_ticks_until(c->c_ticks + c->c_slack, now);
+        if (ticks < rt) {
+            rt = ticks;
+        }
+    }
+#else
     c = TAILQ_FIRST(&g_callout_list);
     if (c != NULL) {
-        if (OS_TIME_TICK_GEQ(c->c_ticks, now)) {
-            rt = c->c_ticks - now;
-        } else {
-            rt = 0;     /* callout time is in the past */
-        }
+        rt = os_callout_ticks_until(c->c_ticks, now);
     } else {
         rt = OS_TIMEOUT_NEVER;
     }
+#endif
 
     return (rt);
 }
 
+#endif
+
 
 os_time_t
 os_callout_remaining_ticks(struct os_callout *c, os_time_t now)
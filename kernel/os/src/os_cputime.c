@@ -26,6 +26,106 @@
 struct os_cputime_data g_os_cputime;
 #endif
 
+#if MYNEWT_VAL(OS_TIMESTAMP)
+
+static_assert((uint64_t)MYNEWT_VAL(OS_TIMESTAMP_UPDATE_MS) *
+              MYNEWT_VAL(OS_CPUTIME_FREQ) / 1000 < (1ULL << 31),
+              "OS_TIMESTAMP_UPDATE_MS too long for OS_CPUTIME_FREQ");
+
+/*
+ * The epoch is advanced in whole steps of OS_TIMESTAMP_STEP_TICKS, each
+ * worth an exact number of microseconds, so no rounding error builds up.
+ * For power of 2 frequencies 15625 us is 2^(log2(freq) - 6) ticks.
+ */
+#if defined(OS_CPUTIME_FREQ_1MHZ)
+#define OS_TIMESTAMP_STEP_TICKS     1
+#define OS_TIMESTAMP_STEP_USECS     1
+#define OS_TIMESTAMP_USECS(ticks)   (ticks)
+#elif defined(OS_CPUTIME_FREQ_PWR2)
+#define OS_TIMESTAMP_SHIFT          \
+    (__builtin_popcount(MYNEWT_VAL(OS_CPUTIME_FREQ) - 1) - 6)
+#define OS_TIMESTAMP_STEP_TICKS     (1U << OS_TIMESTAMP_SHIFT)
+#define OS_TIMESTAMP_STEP_USECS     15625
+#define OS_TIMESTAMP_USECS(ticks)   \
+    (((uint64_t)(ticks) * 15625) >> OS_TIMESTAMP_SHIFT)
+#else
+#define OS_TIMESTAMP_STEP_TICKS     g_os_cputime.ticks_per_usec
+#define OS_TIMESTAMP_STEP_USECS     1
+#define OS_TIMESTAMP_USECS(ticks)   ((ticks) / g_os_cputime.ticks_per_usec)
+#endif
+
+struct os_timestamp_epoch {
+    uint32_t cputime;
+    uint64_t usecs;
+};
+
+/*
+ * Two epochs; the low bit of the sequence number selects the current one.
+ * The updater only writes the other one and then publishes it by bumping
+ * the sequence number, so a reader interrupting it still sees a
+ * consistent epoch.  A reader retries if an epoch was published while it
+ * was reading.
+ */
+static struct os_timestamp_epoch os_timestamp_epochs[2];
+static volatile uint32_t os_timestamp_seq;
+static struct os_callout os_timestamp_callout;
+
+int64_t
+os_timestamp64(void)
+{
+    const struct os_timestamp_epoch *epoch;
+    uint32_t cputime;
+    uint64_t usecs;
+    uint32_t seq;
+
+    do {
+        seq = os_atomic_load_u32(&os_timestamp_seq);
+        epoch = &os_timestamp_epochs[seq & 1];
+        usecs = epoch->usecs;
+        cputime = os_cputime_get32() - epoch->cputime;
+    } while (os_atomic_load_u32(&os_timestamp_seq) != seq);
+
+    return usecs + OS_TIMESTAMP_USECS(cputime);
+}
+
+static void
+os_timestamp_update(struct os_event *ev)
+{
+    const struct os_timestamp_epoch *cur;
+    struct os_timestamp_epoch *next;
+    uint32_t steps;
+    uint32_t seq;
+
+    seq = os_timestamp_seq;
+    cur = &os_timestamp_epochs[seq & 1];
+    next = &os_timestamp_epochs[(seq + 1) & 1];
+
+    steps = (os_cputime_get32() - cur->cputime) / OS_TIMESTAMP_STEP_TICKS;
+    next->cputime = cur->cputime + steps * OS_TIMESTAMP_STEP_TICKS;
+    next->usecs = cur->usecs + (uint64_t)steps * OS_TIMESTAMP_STEP_USECS;
+    os_atomic_store_u32(&os_timestamp_seq, seq + 1);
+
+    os_callout_reset(&os_timestamp_callout,
+                     MYNEWT_VAL(OS_TIMESTAMP_UPDATE_MS) * OS_TICKS_PER_SEC /
+                     1000);
+}
+
+static void
+os_timestamp_init(void)
+{
+    if (os_timestamp_callout.c_ev.ev_cb != NULL) {
+        return;
+    }
+
+    os_timestamp_epochs[os_timestamp_seq & 1].cputime = os_cputime_get32();
+    os_callout_init(&os_timestamp_callout, os_eventq_dflt_get(),
+                    os_timestamp_update, NULL);
+    os_callout_reset(&os_timestamp_callout,
+                     MYNEWT_VAL(OS_TIMESTAMP_UPDATE_MS) * OS_TICKS_PER_SEC /
+                     1000);
+}
+#endif
+
 int
 os_cputime_init(uint32_t clock_freq)
 {
@@ -36,6 +136,11 @@ os_cputime_init(uint32_t clock_freq)
     g_os_cputime.ticks_per_usec = clock_freq / 1000000U;
 #endif
     rc = hal_timer_config(MYNEWT_VAL(OS_CPUTIME_TIMER_NUM), clock_freq);
+#if MYNEWT_VAL(OS_TIMESTAMP)
+    if (rc == 0) {
+        os_timestamp_init();
+    }
+#endif
     return rc;
 }
 
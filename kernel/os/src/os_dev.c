@@ -17,11 +17,40 @@
  * under the License.
  */
 
+#include <assert.h>
 #include <string.h>
 #include "os/mynewt.h"
 
 static STAILQ_HEAD(, os_dev) g_os_dev_list;
 
+#define OS_DEV_HASH_SIZE MYNEWT_VAL(OS_DEV_HASH_SIZE)
+
+#if OS_DEV_HASH_SIZE
+static_assert((OS_DEV_HASH_SIZE & (OS_DEV_HASH_SIZE - 1)) == 0,
+              "OS_DEV_HASH_SIZE must be a power of two");
+
+/* Devices indexed by a hash of their name. */
+static SLIST_HEAD(os_dev_bucket, os_dev) g_os_dev_hash[OS_DEV_HASH_SIZE];
+
+/*
+ * Returns the bucket of g_os_dev_hash for a device name.  The bucket is
+ * picked by an FNV-1a hash of the name.
+ */
+static struct os_dev_bucket *
+os_dev_bucket(const char *name)
+{
+    uint32_t hash;
+
+    hash = 2166136261u;
+    while (*name != '\0') {
+        hash ^= (uint8_t)*name++;
+        hash *= 16777619u;
+    }
+
+    return &g_os_dev_hash[hash & (OS_DEV_HASH_SIZE - 1)];
+}
+#endif
+
 static int
 os_dev_init(struct os_dev *dev, const char *name, uint8_t stage,
         uint8_t priority, os_dev_init_func_t od_init, void *arg)
@@ -52,6 +81,10 @@ os_dev_add(struct os_dev *dev)
     struct os_dev *cur_dev;
     struct os_dev *prev_dev;
 
+#if OS_DEV_HASH_SIZE
+    SLIST_INSERT_HEAD(os_dev_bucket(dev->od_name), dev, od_hnext);
+#endif
+
     /* If no devices present, insert into head */
     if (STAILQ_FIRST(&g_os_dev_list) == NULL) {
         STAILQ_INSERT_HEAD(&g_os_dev_list, dev, od_next);
@@ -138,7 +171,7 @@ os_dev_initialize_all(uint8_t stage)
 
     STAILQ_FOREACH(dev, &g_os_dev_list, od_next) {
         if (dev->od_stage == stage) {
-            rc = os_dev_initialize(dev);
+            SYSINIT_PROF_CALL(dev->od_name, rc = os_dev_initialize(dev));
             if (rc) {
                 break;
             }
@@ -190,11 +223,19 @@ os_dev_lookup(const char *name)
     struct os_dev *dev;
 
     dev = NULL;
+#if OS_DEV_HASH_SIZE
+    SLIST_FOREACH(dev, os_dev_bucket(name), od_hnext) {
+        if (!strcmp(dev->od_name, name)) {
+            break;
+        }
+    }
+#else
     STAILQ_FOREACH(dev, &g_os_dev_list, od_next) {
         if (!strcmp(dev->od_name, name)) {
             break;
         }
     }
+#endif
     return (dev);
 }
 
@@ -202,14 +243,21 @@ struct os_dev *
 os_dev_open(const char *devname, uint32_t timo, void *arg)
 {
     struct os_dev *dev;
-    os_sr_t sr;
-    int rc;
 
     dev = os_dev_lookup(devname);
     if (dev == NULL) {
         return (NULL);
     }
 
+    return os_dev_open_dev(dev, timo, arg);
+}
+
+struct os_dev *
+os_dev_open_dev(struct os_dev *dev, uint32_t timo, void *arg)
+{
+    os_sr_t sr;
+    int rc;
+
     /* Device is not ready to be opened. */
     if ((dev->od_flags & OS_DEV_F_STATUS_READY) == 0) {
         return (NULL);
@@ -322,6 +370,14 @@ os_dev_resume(struct os_dev *dev)
 void
 os_dev_reset(void)
 {
+#if OS_DEV_HASH_SIZE
+    int i;
+
+    for (i = 0; i < OS_DEV_HASH_SIZE; i++) {
+        SLIST_INIT(&g_os_dev_hash[i]);
+    }
+#endif
+
     STAILQ_INIT(&g_os_dev_list);
 }
 
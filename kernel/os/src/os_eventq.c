@@ -24,9 +24,52 @@
 #define OS_TRACE_DISABLE_FILE_API
 #endif
 #include "os/mynewt.h"
+#if MYNEWT_VAL(OS_EVENTQ_STATS)
+#include "os/os_eventq_stats.h"
+/* The stats stub keeps no counters; only registration is built with it. */
+#ifdef STATS_SET
+#define OS_EVENTQ_STATS_COUNT   1
+#endif
+#endif
+#include "os/os_eventq_prof.h"
 
 static struct os_eventq os_eventq_main;
 
+#if MYNEWT_VAL(OS_EVENTQ_WAITSET)
+#if MYNEWT_VAL(OS_EVENTQ_WAITSET_MAX_QUEUES) > 32
+#error "OS_EVENTQ_WAITSET_MAX_QUEUES must not exceed 32"
+#endif
+
+/*
+ * Marks the queue as ready in its wait set and wakes up the task waiting on
+ * the set, if any.  Must be called with interrupts disabled.
+ *
+ * @return 1 if a task was woken up, 0 otherwise.
+ */
+static int
+os_eventq_waitset_signal(struct os_eventq *evq)
+{
+    struct os_eventq_waitset *ws;
+    struct os_task *t;
+
+    ws = evq->evq_ws;
+    ws->ews_ready |= 1UL << evq->evq_ws_idx;
+
+    t = ws->ews_task;
+    if (t == NULL) {
+        return 0;
+    }
+
+    ws->ews_task = NULL;
+    if (t->t_state == OS_TASK_SLEEP) {
+        os_sched_wakeup(t);
+        return 1;
+    }
+
+    return 0;
+}
+#endif
+
 void
 os_eventq_init(struct os_eventq *evq)
 {
@@ -40,8 +83,34 @@ os_eventq_inited(const struct os_eventq *evq)
     return evq->evq_list.stqh_last != NULL;
 }
 
-void
-os_eventq_put(struct os_eventq *evq, struct os_event *ev)
+/**
+ * Unlinks an event from an event queue.  Must be called with interrupts
+ * disabled.
+ */
+static void
+os_eventq_unlink(struct os_eventq *evq, struct os_event *ev)
+{
+#if MYNEWT_VAL(OS_EVENTQ_PRIO)
+    struct os_event *prev;
+
+    /* Urgent events form a prefix of the list; keep the tail pointer valid. */
+    if (evq->evq_urgent_last == ev) {
+        prev = NULL;
+        if (STAILQ_FIRST(&evq->evq_list) != ev) {
+            STAILQ_FOREACH(prev, &evq->evq_list, ev_next) {
+                if (STAILQ_NEXT(prev, ev_next) == ev) {
+                    break;
+                }
+            }
+        }
+        evq->evq_urgent_last = prev;
+    }
+#endif
+    STAILQ_REMOVE(&evq->evq_list, ev, os_event, ev_next);
+}
+
+static void
+os_eventq_put_lane(struct os_eventq *evq, struct os_event *ev, int urgent)
 {
     int resched;
     os_sr_t sr;
@@ -61,9 +130,33 @@ os_eventq_put(struct os_eventq *evq, struct os_event *ev)
 
     /* Queue the event */
     ev->ev_queued = 1;
+#if MYNEWT_VAL(OS_EVENTQ_PROF)
+    ev->ev_put_time = os_cputime_get32();
+#endif
+#if MYNEWT_VAL(OS_EVENTQ_PRIO)
+    if (urgent) {
+        /* Behind other urgent events, ahead of all normal ones. */
+        if (evq->evq_urgent_last == NULL) {
+            STAILQ_INSERT_HEAD(&evq->evq_list, ev, ev_next);
+        } else {
+            STAILQ_INSERT_AFTER(&evq->evq_list, evq->evq_urgent_last, ev,
+                                ev_next);
+        }
+        evq->evq_urgent_last = ev;
+    } else {
+        STAILQ_INSERT_TAIL(&evq->evq_list, ev, ev_next);
+    }
+#else
+    (void)urgent;
     STAILQ_INSERT_TAIL(&evq->evq_list, ev, ev_next);
+#endif
 
     resched = 0;
+#if MYNEWT_VAL(OS_EVENTQ_WAITSET)
+    if (evq->evq_ws) {
+        resched = os_eventq_waitset_signal(evq);
+    }
+#endif
     if (evq->evq_task) {
         /* If task waiting on event, wake it up.
          * Check if task is sleeping, because another event
@@ -88,6 +181,20 @@ os_eventq_put(struct os_eventq *evq, struct os_event *ev)
     os_trace_api_ret(OS_TRACE_ID_EVENTQ_PUT);
 }
 
+void
+os_eventq_put(struct os_eventq *evq, struct os_event *ev)
+{
+    os_eventq_put_lane(evq, ev, 0);
+}
+
+#if MYNEWT_VAL(OS_EVENTQ_PRIO)
+void
+os_eventq_put_prio(struct os_eventq *evq, struct os_event *ev)
+{
+    os_eventq_put_lane(evq, ev, 1);
+}
+#endif
+
 struct os_event *
 os_eventq_get_no_wait(struct os_eventq *evq)
 {
@@ -97,7 +204,7 @@ os_eventq_get_no_wait(struct os_eventq *evq)
 
     ev = STAILQ_FIRST(&evq->evq_list);
     if (ev) {
-        STAILQ_REMOVE(&evq->evq_list, ev, os_event, ev_next);
+        os_eventq_unlink(evq, ev);
         ev->ev_queued = 0;
     }
 
@@ -131,7 +238,7 @@ os_eventq_get(struct os_eventq *evq)
 pull_one:
     ev = STAILQ_FIRST(&evq->evq_list);
     if (ev) {
-        STAILQ_REMOVE(&evq->evq_list, ev, os_event, ev_next);
+        os_eventq_unlink(evq, ev);
         ev->ev_queued = 0;
         t->t_flags &= ~OS_TASK_FLAG_EVQ_WAIT;
     } else {
@@ -179,21 +286,33 @@ os_eventq_mon_find(struct os_eventq *evq, struct os_event *ev)
 }
 #endif
 
-void
-os_eventq_run(struct os_eventq *evq)
+static void
+os_eventq_dispatch(struct os_eventq *evq, struct os_event *ev)
 {
-    struct os_event *ev;
 #if MYNEWT_VAL(OS_EVENTQ_MONITOR)
     struct os_eventq_mon *mon;
     uint32_t ticks;
 #endif
+#if MYNEWT_VAL(OS_EVENTQ_PROF)
+    os_event_fn *cb;
+    uint32_t start;
+    uint32_t wait;
+#endif
 
-    ev = os_eventq_get(evq);
     assert(ev->ev_cb != NULL);
 #if MYNEWT_VAL(OS_EVENTQ_MONITOR)
     ticks = os_cputime_get32();
 #endif
+#if MYNEWT_VAL(OS_EVENTQ_PROF)
+    /* The callback may free or requeue the event; keep what we need. */
+    cb = ev->ev_cb;
+    start = os_cputime_get32();
+    wait = start - ev->ev_put_time;
     ev->ev_cb(ev);
+    os_eventq_prof_record(evq, cb, wait, os_cputime_get32() - start);
+#else
+    ev->ev_cb(ev);
+#endif
 #if MYNEWT_VAL(OS_EVENTQ_MONITOR)
     mon = os_eventq_mon_find(evq, ev);
     if (mon) {
@@ -215,6 +334,121 @@ os_eventq_run(struct os_eventq *evq)
 #endif
 }
 
+void
+os_eventq_run(struct os_eventq *evq)
+{
+    struct os_event *ev;
+
+    ev = os_eventq_get(evq);
+    os_eventq_dispatch(evq, ev);
+}
+
+int
+os_eventq_run_batch(struct os_eventq *evq, int max_events, os_time_t max_ticks)
+{
+    struct os_event *ev;
+    os_time_t start;
+    os_sr_t sr;
+    int budget_hit;
+    int cnt;
+#ifdef OS_EVENTQ_STATS_COUNT
+    struct stats_os_eventq *st;
+    uint32_t cputime;
+#endif
+
+    assert(max_events > 0);
+
+    ev = os_eventq_get(evq);
+
+    start = os_time_get();
+#ifdef OS_EVENTQ_STATS_COUNT
+    cputime = os_cputime_get32();
+#endif
+    budget_hit = 0;
+    cnt = 0;
+
+    while (1) {
+        os_eventq_dispatch(evq, ev);
+        cnt++;
+
+        if (cnt >= max_events) {
+            break;
+        }
+        if (max_ticks != OS_TIMEOUT_NEVER &&
+            OS_TIME_TICK_GEQ(os_time_get(), start + max_ticks)) {
+            budget_hit = 1;
+            break;
+        }
+
+        OS_ENTER_CRITICAL(sr);
+        ev = STAILQ_FIRST(&evq->evq_list);
+        if (ev) {
+            os_eventq_unlink(evq, ev);
+            ev->ev_queued = 0;
+        }
+        OS_EXIT_CRITICAL(sr);
+
+        if (ev == NULL) {
+            break;
+        }
+#if MYNEWT_VAL(OS_EVENTQ_DEBUG)
+        evq->evq_prev = ev;
+#endif
+    }
+
+#ifdef OS_EVENTQ_STATS_COUNT
+    st = evq->evq_stats;
+    if (st != NULL) {
+        cputime = os_cputime_get32() - cputime;
+
+        STATS_INC((*st), batches);
+        STATS_INCN((*st), events, cnt);
+        if (budget_hit) {
+            STATS_INC((*st), budget_hits);
+        }
+        if (cnt > STATS_GET((*st), batch_max)) {
+            STATS_SET((*st), batch_max, cnt);
+        }
+        STATS_INCN((*st), dispatch_time, cputime);
+        if (cputime > STATS_GET((*st), dispatch_max)) {
+            STATS_SET((*st), dispatch_max, cputime);
+        }
+    }
+#else
+    (void)budget_hit;
+#endif
+
+    return cnt;
+}
+
+#if MYNEWT_VAL(OS_EVENTQ_STATS)
+STATS_NAME_START(os_eventq)
+    STATS_NAME(os_eventq, batches)
+    STATS_NAME(os_eventq, events)
+    STATS_NAME(os_eventq, batch_max)
+    STATS_NAME(os_eventq, budget_hits)
+    STATS_NAME(os_eventq, dispatch_time)
+    STATS_NAME(os_eventq, dispatch_max)
+STATS_NAME_END(os_eventq)
+
+int
+os_eventq_stats_register(struct os_eventq *evq, struct stats_os_eventq *stats,
+                         const char *name)
+{
+    int rc;
+
+    rc = stats_init_and_reg(STATS_HDR(*stats),
+                            STATS_SIZE_INIT_PARMS((*stats), STATS_SIZE_32),
+                            STATS_NAME_INIT_PARMS(os_eventq), name);
+    if (rc != 0) {
+        return rc;
+    }
+
+    evq->evq_stats = stats;
+    return 0;
+}
+#endif
+
 static struct os_event *
 os_eventq_poll_0timo(struct os_eventq **evq, int nevqs)
 {
@@ -231,7 +465,7 @@ os_eventq_poll_0timo(struct os_eventq **evq, int nevqs)
     for (i = 0; i < nevqs; i++) {
         ev = STAILQ_FIRST(&evq[i]->evq_list);
         if (ev) {
-            STAILQ_REMOVE(&evq[i]->evq_list, ev, os_event, ev_next);
+            os_eventq_unlink(evq[i], ev);
             ev->ev_queued = 0;
             break;
         }
@@ -269,7 +503,7 @@ os_eventq_poll(struct os_eventq **evq, int nevqs, os_time_t timo)
     for (i = 0; i < nevqs; i++) {
         ev = STAILQ_FIRST(&evq[i]->evq_list);
         if (ev) {
-            STAILQ_REMOVE(&evq[i]->evq_list, ev, os_event, ev_next);
+            os_eventq_unlink(evq[i], ev);
             ev->ev_queued = 0;
             /* Reset the items that already have an evq task set. */
             for (j = 0; j < i; j++) {
@@ -300,7 +534,7 @@ os_eventq_poll(struct os_eventq **evq, int nevqs, os_time_t timo)
         if (!ev) {
             ev = STAILQ_FIRST(&evq[i]->evq_list);
             if (ev) {
-                STAILQ_REMOVE(&evq[i]->evq_list, ev, os_event, ev_next);
+                os_eventq_unlink(evq[i], ev);
                 ev->ev_queued = 0;
             }
         }
@@ -314,6 +548,158 @@ has_event:
     return (ev);
 }
 
+#if MYNEWT_VAL(OS_EVENTQ_WAITSET)
+
+void
+os_eventq_waitset_init(struct os_eventq_waitset *ws)
+{
+    memset(ws, 0, sizeof(*ws));
+}
+
+int
+os_eventq_waitset_add(struct os_eventq_waitset *ws, struct os_eventq *evq)
+{
+    uint32_t avail;
+    os_sr_t sr;
+    int idx;
+
+    OS_ENTER_CRITICAL(sr);
+
+    if (evq->evq_ws != NULL) {
+        OS_EXIT_CRITICAL(sr);
+        return OS_EINVAL;
+    }
+
+    avail = ~ws->ews_used;
+#if MYNEWT_VAL(OS_EVENTQ_WAITSET_MAX_QUEUES) < 32
+    avail &= (1UL << MYNEWT_VAL(OS_EVENTQ_WAITSET_MAX_QUEUES)) - 1;
+#endif
+    if (avail == 0) {
+        OS_EXIT_CRITICAL(sr);
+        return OS_ENOMEM;
+    }
+
+    idx = __builtin_ctz(avail);
+    ws->ews_evqs[idx] = evq;
+    ws->ews_used |= 1UL << idx;
+    evq->evq_ws = ws;
+    evq->evq_ws_idx = idx;
+
+    /* Events may already be pending on the queue. */
+    if (!STAILQ_EMPTY(&evq->evq_list)) {
+        ws->ews_ready |= 1UL << idx;
+    }
+
+    OS_EXIT_CRITICAL(sr);
+
+    return 0;
+}
+
+int
+os_eventq_waitset_remove(struct os_eventq_waitset *ws, struct os_eventq *evq)
+{
+    os_sr_t sr;
+    int idx;
+
+    OS_ENTER_CRITICAL(sr);
+
+    if (evq->evq_ws != ws) {
+        OS_EXIT_CRITICAL(sr);
+        return OS_EINVAL;
+    }
+
+    idx = evq->evq_ws_idx;
+    ws->ews_evqs[idx] = NULL;
+    ws->ews_used &= ~(1UL << idx);
+    ws->ews_ready &= ~(1UL << idx);
+    evq->evq_ws = NULL;
+
+    OS_EXIT_CRITICAL(sr);
+
+    return 0;
+}
+
+/*
+ * Takes the first event from the first ready member queue.  Ready bits are
+ * only hints: events may have been pulled from a member queue directly, so
+ * bits of queues found empty are cleared.  Must be called with interrupts
+ * disabled.
+ */
+static struct os_event *
+os_eventq_waitset_pull(struct os_eventq_waitset *ws,
+                       struct os_eventq **out_evq)
+{
+    struct os_eventq *evq;
+    struct os_event *ev;
+    int idx;
+
+    while (ws->ews_ready) {
+        idx = __builtin_ctz(ws->ews_ready);
+        evq = ws->ews_evqs[idx];
+
+        ev = STAILQ_FIRST(&evq->evq_list);
+        if (ev) {
+            os_eventq_unlink(evq, ev);
+            ev->ev_queued = 0;
+        }
+        if (STAILQ_EMPTY(&evq->evq_list)) {
+            ws->ews_ready &= ~(1UL << idx);
+        }
+
+        if (ev) {
+            if (out_evq) {
+                *out_evq = evq;
+            }
+            return ev;
+        }
+    }
+
+    return NULL;
+}
+
+struct os_event *
+os_eventq_waitset_poll(struct os_eventq_waitset *ws, os_time_t timo,
+                       struct os_eventq **out_evq)
+{
+    struct os_event *ev;
+    struct os_task *cur_t;
+    os_sr_t sr;
+
+    os_trace_api_u32x2(OS_TRACE_ID_EVENTQ_WAITSET_POLL, (uint32_t)ws,
+                       (uint32_t)timo);
+
+    OS_ENTER_CRITICAL(sr);
+
+    ev = os_eventq_waitset_pull(ws, out_evq);
+    if (ev || timo == 0) {
+        OS_EXIT_CRITICAL(sr);
+        goto done;
+    }
+
+    cur_t = os_sched_get_current_task();
+    assert(ws->ews_task == NULL || ws->ews_task == cur_t);
+    ws->ews_task = cur_t;
+    cur_t->t_flags |= OS_TASK_FLAG_EVQ_WAIT;
+
+    os_sched_sleep(cur_t, timo);
+    OS_EXIT_CRITICAL(sr);
+
+    os_sched(NULL);
+
+    OS_ENTER_CRITICAL(sr);
+    cur_t->t_flags &= ~OS_TASK_FLAG_EVQ_WAIT;
+    ws->ews_task = NULL;
+    ev = os_eventq_waitset_pull(ws, out_evq);
+    OS_EXIT_CRITICAL(sr);
+
+done:
+    os_trace_api_ret_u32(OS_TRACE_ID_EVENTQ_WAITSET_POLL, (uint32_t)ev);
+
+    return ev;
+}
+
+#endif
+
 void
 os_eventq_remove(struct os_eventq *evq, struct os_event *ev)
 {
@@ -323,7 +709,7 @@ os_eventq_remove(struct os_eventq *evq, struct os_event *ev)
 
     OS_ENTER_CRITICAL(sr);
     if (OS_EVENT_QUEUED(ev)) {
-        STAILQ_REMOVE(&evq->evq_list, ev, os_event, ev_next);
+        os_eventq_unlink(evq, ev);
     }
     ev->ev_queued = 0;
     OS_EXIT_CRITICAL(sr);
@@ -18,7 +18,11 @@
  */
 
 #include <assert.h>
+#include <stddef.h>
+#include <string.h>
 #include "os/mynewt.h"
+#include "os/os_alloc_prof.h"
+#include "os_priv.h"
 
 #if MYNEWT_VAL(OS_SCHEDULING)
 static struct os_mutex os_malloc_mutex;
@@ -50,35 +54,621 @@ os_malloc_unlock(void)
 #endif
 }
 
-void *
-os_malloc(size_t size)
+#if MYNEWT_VAL(OS_HEAP_SLAB)
+
+/*
+ * Small requests are served from one mempool per size class; a request that
+ * does not fit any class, or whose classes are exhausted, falls back to a
+ * TLSF (two-level segregated fit) heap.  Both paths run in bounded time.
+ * Only the TLSF path takes os_malloc_mutex.
+ */
+
+struct os_heap_slab {
+    struct os_mempool ohs_pool;
+    os_membuf_t *ohs_buf;
+    const char *ohs_name;
+    uint16_t ohs_blocks;
+    uint16_t ohs_size;
+};
+
+#define OS_HEAP_SLAB_BUF(sz)                                                \
+    static os_membuf_t os_heap_slab_buf_##sz[                               \
+        OS_MEMPOOL_SIZE(MYNEWT_VAL(OS_HEAP_SLAB_##sz##_BLOCKS), (sz))]
+
+#define OS_HEAP_SLAB_ENTRY(sz) {                                            \
+    .ohs_buf = os_heap_slab_buf_##sz,                                       \
+    .ohs_name = "os_heap_" #sz,                                             \
+    .ohs_blocks = MYNEWT_VAL(OS_HEAP_SLAB_##sz##_BLOCKS),                   \
+    .ohs_size = (sz),                                                       \
+}
+
+OS_HEAP_SLAB_BUF(16);
+OS_HEAP_SLAB_BUF(32);
+OS_HEAP_SLAB_BUF(64);
+OS_HEAP_SLAB_BUF(128);
+OS_HEAP_SLAB_BUF(256);
+
+/* Sorted by increasing block size. */
+static struct os_heap_slab os_heap_slabs[] = {
+    OS_HEAP_SLAB_ENTRY(16),
+    OS_HEAP_SLAB_ENTRY(32),
+    OS_HEAP_SLAB_ENTRY(64),
+    OS_HEAP_SLAB_ENTRY(128),
+    OS_HEAP_SLAB_ENTRY(256),
+};
+
+#define OS_HEAP_SLAB_NUM    \
+    (int)(sizeof os_heap_slabs / sizeof os_heap_slabs[0])
+
+/*
+ * TLSF heap.  Free blocks are kept in OS_HEAP_TLSF_FL_COUNT first-level
+ * lists (powers of two), each split into OS_HEAP_TLSF_SL_COUNT second-level
+ * lists (linear subranges).  Two bitmaps locate a large enough free block
+ * with a couple of bit scans, so allocation and free are O(1).
+ */
+
+#define OS_HEAP_TLSF_ALIGN_LOG2     3
+#define OS_HEAP_TLSF_ALIGN          (1 << OS_HEAP_TLSF_ALIGN_LOG2)
+#define OS_HEAP_TLSF_SL_LOG2        3
+#define OS_HEAP_TLSF_SL_COUNT       (1 << OS_HEAP_TLSF_SL_LOG2)
+#define OS_HEAP_TLSF_FL_SHIFT       (OS_HEAP_TLSF_SL_LOG2 + \
+                                     OS_HEAP_TLSF_ALIGN_LOG2)
+#define OS_HEAP_TLSF_SMALL          (1 << OS_HEAP_TLSF_FL_SHIFT)
+#define OS_HEAP_TLSF_MAX_LOG2       20
+#define OS_HEAP_TLSF_FL_COUNT       (OS_HEAP_TLSF_MAX_LOG2 - \
+                                     OS_HEAP_TLSF_FL_SHIFT + 1)
+
+/* Flags kept in the low bits of tb_size. */
+#define OS_HEAP_TLSF_F_FREE         0x1
+#define OS_HEAP_TLSF_F_PREV_FREE    0x2
+#define OS_HEAP_TLSF_F_MASK         0x3
+
+struct os_heap_tlsf_block {
+    /** Previous physical block; only valid if that block is free. */
+    struct os_heap_tlsf_block *tb_prev_phys;
+    /** Payload size in bytes, ORed with OS_HEAP_TLSF_F_[...] flags. */
+    size_t tb_size;
+    /* Free list links; these overlap the payload of an allocated block. */
+    struct os_heap_tlsf_block *tb_next_free;
+    struct os_heap_tlsf_block *tb_prev_free;
+};
+
+#define OS_HEAP_TLSF_HDR_SZ \
+    offsetof(struct os_heap_tlsf_block, tb_next_free)
+#define OS_HEAP_TLSF_MIN_SZ \
+    (sizeof(struct os_heap_tlsf_block) - OS_HEAP_TLSF_HDR_SZ)
+
+static uint64_t os_heap_tlsf_buf[MYNEWT_VAL(OS_HEAP_TLSF_SIZE) / 8];
+
+static_assert(sizeof os_heap_tlsf_buf >=
+              2 * OS_HEAP_TLSF_HDR_SZ + OS_HEAP_TLSF_MIN_SZ,
+              "OS_HEAP_TLSF_SIZE is too small");
+static_assert(sizeof os_heap_tlsf_buf < (1 << OS_HEAP_TLSF_MAX_LOG2),
+              "OS_HEAP_TLSF_SIZE is too large");
+
+static uint32_t os_heap_tlsf_fl_map;
+static uint32_t os_heap_tlsf_sl_map[OS_HEAP_TLSF_FL_COUNT];
+static struct os_heap_tlsf_block *
+    os_heap_tlsf_lists[OS_HEAP_TLSF_FL_COUNT][OS_HEAP_TLSF_SL_COUNT];
+
+/** Sum of the payload sizes of all free TLSF blocks. */
+static size_t os_heap_tlsf_free_bytes;
+
+static bool os_heap_ready;
+
+static size_t
+os_heap_tlsf_size(const struct os_heap_tlsf_block *block)
+{
+    return block->tb_size & ~(size_t)OS_HEAP_TLSF_F_MASK;
+}
+
+static struct os_heap_tlsf_block *
+os_heap_tlsf_next(const struct os_heap_tlsf_block *block)
+{
+    return (struct os_heap_tlsf_block *)((uint8_t *)block +
+                                         OS_HEAP_TLSF_HDR_SZ +
+                                         os_heap_tlsf_size(block));
+}
+
+static int
+os_heap_tlsf_log2(size_t size)
+{
+    return 31 - __builtin_clz((uint32_t)size);
+}
+
+/**
+ * Maps a block size to the free list that holds blocks of that size.
+ */
+static void
+os_heap_tlsf_mapping(size_t size, int *fl, int *sl)
+{
+    int f;
+
+    if (size < OS_HEAP_TLSF_SMALL) {
+        *fl = 0;
+        *sl = size >> OS_HEAP_TLSF_ALIGN_LOG2;
+    } else {
+        f = os_heap_tlsf_log2(size);
+        *fl = f - OS_HEAP_TLSF_FL_SHIFT + 1;
+        *sl = (size >> (f - OS_HEAP_TLSF_SL_LOG2)) - OS_HEAP_TLSF_SL_COUNT;
+    }
+}
+
+static void
+os_heap_tlsf_insert(struct os_heap_tlsf_block *block)
+{
+    struct os_heap_tlsf_block **head;
+    int fl;
+    int sl;
+
+    os_heap_tlsf_mapping(os_heap_tlsf_size(block), &fl, &sl);
+    head = &os_heap_tlsf_lists[fl][sl];
+
+    block->tb_prev_free = NULL;
+    block->tb_next_free = *head;
+    if (*head != NULL) {
+        (*head)->tb_prev_free = block;
+    }
+    *head = block;
+
+    os_heap_tlsf_fl_map |= 1U << fl;
+    os_heap_tlsf_sl_map[fl] |= 1U << sl;
+}
+
+static void
+os_heap_tlsf_remove(struct os_heap_tlsf_block *block)
+{
+    int fl;
+    int sl;
+
+    os_heap_tlsf_mapping(os_heap_tlsf_size(block), &fl, &sl);
+
+    if (block->tb_next_free != NULL) {
+        block->tb_next_free->tb_prev_free = block->tb_prev_free;
+    }
+
+    if (block->tb_prev_free != NULL) {
+        block->tb_prev_free->tb_next_free = block->tb_next_free;
+    } else {
+        os_heap_tlsf_lists[fl][sl] = block->tb_next_free;
+        if (block->tb_next_free == NULL) {
+            os_heap_tlsf_sl_map[fl] &= ~(1U << sl);
+            if (os_heap_tlsf_sl_map[fl] == 0) {
+                os_heap_tlsf_fl_map &= ~(1U << fl);
+            }
+        }
+    }
+}
+
+/**
+ * Finds a free block of at least the specified size.
+ */
+static struct os_heap_tlsf_block *
+os_heap_tlsf_find(size_t size)
+{
+    uint32_t map;
+    int fl;
+    int sl;
+
+    /* Round up to the next list boundary so that every block in the list
+     * found is large enough.
+     */
+    if (size >= OS_HEAP_TLSF_SMALL) {
+        size += ((size_t)1 << (os_heap_tlsf_log2(size) -
+                               OS_HEAP_TLSF_SL_LOG2)) - 1;
+    }
+
+    os_heap_tlsf_mapping(size, &fl, &sl);
+    if (fl >= OS_HEAP_TLSF_FL_COUNT) {
+        return NULL;
+    }
+
+    map = os_heap_tlsf_sl_map[fl] & (~0U << sl);
+    if (map == 0) {
+        map = os_heap_tlsf_fl_map & (~0U << (fl + 1));
+        if (map == 0) {
+            return NULL;
+        }
+
+        fl = __builtin_ctz(map);
+        map = os_heap_tlsf_sl_map[fl];
+    }
+    sl = __builtin_ctz(map);
+
+    return os_heap_tlsf_lists[fl][sl];
+}
+
+static void *
+os_heap_tlsf_alloc(size_t size)
+{
+    struct os_heap_tlsf_block *block;
+    struct os_heap_tlsf_block *next;
+    struct os_heap_tlsf_block *rem;
+    size_t bsize;
+
+    if (size >= sizeof os_heap_tlsf_buf) {
+        return NULL;
+    }
+    if (size < OS_HEAP_TLSF_MIN_SZ) {
+        size = OS_HEAP_TLSF_MIN_SZ;
+    }
+    size = OS_ALIGN(size, OS_HEAP_TLSF_ALIGN);
+
+    block = os_heap_tlsf_find(size);
+    if (block == NULL) {
+        return NULL;
+    }
+    os_heap_tlsf_remove(block);
+
+    bsize = os_heap_tlsf_size(block);
+    next = os_heap_tlsf_next(block);
+
+    if (bsize >= size + OS_HEAP_TLSF_HDR_SZ + OS_HEAP_TLSF_MIN_SZ) {
+        /* Split off the tail and return it to the free lists. */
+        rem = (struct os_heap_tlsf_block *)((uint8_t *)block +
+                                            OS_HEAP_TLSF_HDR_SZ + size);
+        rem->tb_size = (bsize - size - OS_HEAP_TLSF_HDR_SZ) |
+                       OS_HEAP_TLSF_F_FREE;
+        next->tb_prev_phys = rem;
+        os_heap_tlsf_insert(rem);
+
+        block->tb_size = size | (block->tb_size & OS_HEAP_TLSF_F_PREV_FREE);
+        os_heap_tlsf_free_bytes -= size + OS_HEAP_TLSF_HDR_SZ;
+    } else {
+        block->tb_size &= ~(size_t)OS_HEAP_TLSF_F_FREE;
+        next->tb_size &= ~(size_t)OS_HEAP_TLSF_F_PREV_FREE;
+        os_heap_tlsf_free_bytes -= bsize;
+    }
+
+    return (uint8_t *)block + OS_HEAP_TLSF_HDR_SZ;
+}
+
+static struct os_heap_tlsf_block *
+os_heap_tlsf_block(void *ptr)
+{
+    return (struct os_heap_tlsf_block *)((uint8_t *)ptr -
+                                         OS_HEAP_TLSF_HDR_SZ);
+}
+
+static void
+os_heap_tlsf_free(void *ptr)
+{
+    struct os_heap_tlsf_block *block;
+    struct os_heap_tlsf_block *prev;
+    struct os_heap_tlsf_block *next;
+
+    block = os_heap_tlsf_block(ptr);
+    assert(!(block->tb_size & OS_HEAP_TLSF_F_FREE));
+
+    block->tb_size |= OS_HEAP_TLSF_F_FREE;
+    os_heap_tlsf_free_bytes += os_heap_tlsf_size(block);
+
+    /* Coalesce with free physical neighbours. */
+    if (block->tb_size & OS_HEAP_TLSF_F_PREV_FREE) {
+        prev = block->tb_prev_phys;
+        os_heap_tlsf_remove(prev);
+        prev->tb_size += OS_HEAP_TLSF_HDR_SZ + os_heap_tlsf_size(block);
+        os_heap_tlsf_free_bytes += OS_HEAP_TLSF_HDR_SZ;
+        block = prev;
+    }
+
+    next = os_heap_tlsf_next(block);
+    if (next->tb_size & OS_HEAP_TLSF_F_FREE) {
+        os_heap_tlsf_remove(next);
+        block->tb_size += OS_HEAP_TLSF_HDR_SZ + os_heap_tlsf_size(next);
+        os_heap_tlsf_free_bytes += OS_HEAP_TLSF_HDR_SZ;
+        next = os_heap_tlsf_next(block);
+    }
+
+    next->tb_prev_phys = block;
+    next->tb_size |= OS_HEAP_TLSF_F_PREV_FREE;
+    os_heap_tlsf_insert(block);
+}
+
+static bool
+os_heap_tlsf_owns(const void *ptr)
+{
+    return (const uint8_t *)ptr >= (const uint8_t *)os_heap_tlsf_buf &&
+           (const uint8_t *)ptr < (const uint8_t *)os_heap_tlsf_buf +
+                                  sizeof os_heap_tlsf_buf;
+}
+
+/**
+ * Retrieves the size of the largest free TLSF block.  The caller must hold
+ * the heap lock.
+ */
+static size_t
+os_heap_tlsf_largest(void)
+{
+    const struct os_heap_tlsf_block *block;
+    size_t largest;
+    int fl;
+    int sl;
+
+    if (os_heap_tlsf_fl_map == 0) {
+        return 0;
+    }
+
+    fl = 31 - __builtin_clz(os_heap_tlsf_fl_map);
+    sl = 31 - __builtin_clz(os_heap_tlsf_sl_map[fl]);
+
+    /* Blocks within a list differ in size; only this list needs a scan. */
+    largest = 0;
+    for (block = os_heap_tlsf_lists[fl][sl];
+         block != NULL;
+         block = block->tb_next_free) {
+
+        if (os_heap_tlsf_size(block) > largest) {
+            largest = os_heap_tlsf_size(block);
+        }
+    }
+
+    return largest;
+}
+
+static void
+os_heap_tlsf_init(void)
+{
+    struct os_heap_tlsf_block *sentinel;
+    struct os_heap_tlsf_block *block;
+
+    /* One free block spanning the region, followed by a zero-sized
+     * allocated sentinel that stops coalescing at the end.
+     */
+    block = (struct os_heap_tlsf_block *)os_heap_tlsf_buf;
+    block->tb_prev_phys = NULL;
+    block->tb_size = (sizeof os_heap_tlsf_buf - 2 * OS_HEAP_TLSF_HDR_SZ) |
+                     OS_HEAP_TLSF_F_FREE;
+
+    sentinel = os_heap_tlsf_next(block);
+    sentinel->tb_prev_phys = block;
+    sentinel->tb_size = OS_HEAP_TLSF_F_PREV_FREE;
+
+    os_heap_tlsf_free_bytes = os_heap_tlsf_size(block);
+    os_heap_tlsf_insert(block);
+}
+
+static struct os_heap_slab *
+os_heap_slab_find(const void *ptr)
+{
+    int i;
+
+    for (i = 0; i < OS_HEAP_SLAB_NUM; i++) {
+        if (os_memblock_from(&os_heap_slabs[i].ohs_pool, ptr)) {
+            return &os_heap_slabs[i];
+        }
+    }
+
+    return NULL;
+}
+
+static void *
+os_heap_slab_alloc(size_t size)
+{
+    void *ptr;
+    int i;
+
+    for (i = 0; i < OS_HEAP_SLAB_NUM; i++) {
+        if (os_heap_slabs[i].ohs_size >= size) {
+            ptr = os_memblock_get_noprof(&os_heap_slabs[i].ohs_pool);
+            if (ptr != NULL) {
+                return ptr;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Retrieves the number of bytes usable in an allocated block.
+ */
+static size_t
+os_heap_usable_size(void *ptr)
+{
+    struct os_heap_slab *slab;
+
+    slab = os_heap_slab_find(ptr);
+    if (slab != NULL) {
+        return slab->ohs_size;
+    }
+
+    return os_heap_tlsf_size(os_heap_tlsf_block(ptr));
+}
+
+#endif
+
+void
+os_heap_module_init(void)
+{
+#if MYNEWT_VAL(OS_HEAP_SLAB)
+    struct os_heap_slab *slab;
+    int rc;
+    int i;
+
+    /* May already have been initialized by an allocation that preceded
+     * sysinit.  The pools are live, but os_mempool_module_init() has since
+     * emptied the mempool list; put them back on it.
+     */
+    if (os_heap_ready) {
+        for (i = 0; i < OS_HEAP_SLAB_NUM; i++) {
+            os_mempool_register(&os_heap_slabs[i].ohs_pool);
+        }
+        return;
+    }
+
+    for (i = 0; i < OS_HEAP_SLAB_NUM; i++) {
+        slab = &os_heap_slabs[i];
+        rc = os_mempool_init(&slab->ohs_pool, slab->ohs_blocks, slab->ohs_size,
+                             slab->ohs_buf, (char *)slab->ohs_name);
+        assert(rc == 0);
+    }
+
+    os_heap_tlsf_init();
+    os_heap_ready = true;
+#endif
+}
+
+static void *
+os_heap_alloc(size_t size)
 {
     void *ptr;
 
+#if MYNEWT_VAL(OS_HEAP_SLAB)
+    if (!os_heap_ready) {
+        os_heap_module_init();
+    }
+
+    ptr = os_heap_slab_alloc(size);
+    if (ptr != NULL) {
+        return ptr;
+    }
+
+    os_malloc_lock();
+    ptr = os_heap_tlsf_alloc(size);
+    os_malloc_unlock();
+#else
     os_malloc_lock();
     ptr = malloc(size);
     os_malloc_unlock();
+#endif
 
     return ptr;
 }
 
-void
-os_free(void *mem)
+static void
+os_heap_free(void *mem)
 {
+#if MYNEWT_VAL(OS_HEAP_SLAB)
+    struct os_heap_slab *slab;
+
+    slab = os_heap_slab_find(mem);
+    if (slab != NULL) {
+        os_memblock_put_noprof(&slab->ohs_pool, mem);
+        return;
+    }
+
+    assert(os_heap_tlsf_owns(mem));
+
+    os_malloc_lock();
+    os_heap_tlsf_free(mem);
+    os_malloc_unlock();
+#else
     os_malloc_lock();
     free(mem);
     os_malloc_unlock();
+#endif
+}
+
+void *
+os_malloc(size_t size)
+{
+    void *ptr;
+
+    ptr = os_heap_alloc(size);
+    if (ptr != NULL) {
+        os_alloc_prof_alloc(OS_ALLOC_PROF_HEAP, NULL, ptr, size,
+                            OS_ALLOC_PROF_CALLER());
+    }
+
+    return ptr;
+}
+
+void
+os_free(void *mem)
+{
+    if (mem == NULL) {
+        return;
+    }
+
+    os_alloc_prof_free(OS_ALLOC_PROF_HEAP, mem);
+    os_heap_free(mem);
 }
 
 void *
 os_realloc(void *ptr, size_t size)
 {
     void *new_ptr;
+#if MYNEWT_VAL(OS_HEAP_SLAB)
+    size_t usable;
 
+    if (ptr == NULL) {
+        new_ptr = os_heap_alloc(size);
+    } else if (size == 0) {
+        os_alloc_prof_free(OS_ALLOC_PROF_HEAP, ptr);
+        os_heap_free(ptr);
+        new_ptr = NULL;
+    } else {
+        usable = os_heap_usable_size(ptr);
+        if (size <= usable) {
+            return ptr;
+        }
+
+        new_ptr = os_heap_alloc(size);
+        if (new_ptr != NULL) {
+            memcpy(new_ptr, ptr, usable);
+            os_alloc_prof_free(OS_ALLOC_PROF_HEAP, ptr);
+            os_heap_free(ptr);
+        }
+    }
+#else
     os_malloc_lock();
     new_ptr = realloc(ptr, size);
     os_malloc_unlock();
 
+    if (ptr != NULL && (new_ptr != NULL || size == 0)) {
+        os_alloc_prof_free(OS_ALLOC_PROF_HEAP, ptr);
+    }
+#endif
+
+    if (new_ptr != NULL) {
+        os_alloc_prof_alloc(OS_ALLOC_PROF_HEAP, NULL, new_ptr, size,
+                            OS_ALLOC_PROF_CALLER());
+    }
+
     return new_ptr;
 }
 
+int
+os_heap_info_get(struct os_heap_info *ohi)
+{
+#if MYNEWT_VAL(OS_HEAP_SLAB)
+    const struct os_heap_slab *slab;
+    size_t tlsf_largest;
+    size_t tlsf_free;
+    int i;
+
+    if (!os_heap_ready) {
+        os_heap_module_init();
+    }
+
+    memset(ohi, 0, sizeof *ohi);
+
+    for (i = 0; i < OS_HEAP_SLAB_NUM; i++) {
+        slab = &os_heap_slabs[i];
+        ohi->ohi_total += (size_t)slab->ohs_blocks * slab->ohs_size;
+        ohi->ohi_free += (size_t)slab->ohs_pool.mp_num_free * slab->ohs_size;
+        if (slab->ohs_pool.mp_num_free > 0) {
+            ohi->ohi_largest_free = slab->ohs_size;
+        }
+    }
+
+    os_malloc_lock();
+    tlsf_free = os_heap_tlsf_free_bytes;
+    tlsf_largest = os_heap_tlsf_largest();
+    os_malloc_unlock();
+
+    ohi->ohi_total += sizeof os_heap_tlsf_buf - 2 * OS_HEAP_TLSF_HDR_SZ;
+    ohi->ohi_free += tlsf_free;
+    if (tlsf_largest > ohi->ohi_largest_free) {
+        ohi->ohi_largest_free = tlsf_largest;
+    }
+    if (tlsf_free > 0) {
+        ohi->ohi_frag_pct = 100 - tlsf_largest * 100 / tlsf_free;
+    }
+
+    return 0;
+#else
+    return OS_ENOENT;
+#endif
+}
@@ -41,6 +41,8 @@
 #define OS_TRACE_DISABLE_FILE_API
 #endif
 #include "os/mynewt.h"
+#include "os/os_alloc_prof.h"
+#include "os_priv.h"
 
 int
 os_mqueue_init(struct os_mqueue *mq, os_event_fn *ev_cb, void *arg)
@@ -120,7 +122,8 @@ os_mbuf_pool_init(struct os_mbuf_pool *omp, struct os_mempool *mp,
 }
 
 struct os_mbuf *
-os_mbuf_get(struct os_mbuf_pool *omp, uint16_t leadingspace)
+os_mbuf_get_from(struct os_mbuf_pool *omp, uint16_t leadingspace,
+                 const void *caller)
 {
     struct os_mbuf *om;
 
@@ -132,7 +135,7 @@ os_mbuf_get(struct os_mbuf_pool *omp, uint16_t leadingspace)
         goto done;
     }
 
-    om = os_memblock_get(omp->omp_pool);
+    om = os_memblock_get_noprof(omp->omp_pool);
     if (!om) {
         goto done;
     }
@@ -143,6 +146,16 @@ os_mbuf_get(struct os_mbuf_pool *omp, uint16_t leadingspace)
     om->om_len = 0;
     om->om_data = (&om->om_databuf[0] + leadingspace);
     om->om_omp = omp;
+#if MYNEWT_VAL(OS_MBUF_SHARED)
+    om->om_owner = NULL;
+    om->om_refcnt = 1;
+#endif
+#if MYNEWT_VAL(MSYS_QUOTA)
+    om->om_consumer = NULL;
+#endif
+
+    os_alloc_prof_alloc(OS_ALLOC_PROF_MBUF, omp, om, omp->omp_databuf_len,
+                        caller);
 
 done:
     os_trace_api_ret_u32(OS_TRACE_ID_MBUF_GET, (uint32_t)om);
@@ -150,7 +163,14 @@ done:
 }
 
 struct os_mbuf *
-os_mbuf_get_pkthdr(struct os_mbuf_pool *omp, uint8_t user_pkthdr_len)
+os_mbuf_get(struct os_mbuf_pool *omp, uint16_t leadingspace)
+{
+    return os_mbuf_get_from(omp, leadingspace, OS_ALLOC_PROF_CALLER());
+}
+
+struct os_mbuf *
+os_mbuf_get_pkthdr_from(struct os_mbuf_pool *omp, uint8_t user_pkthdr_len,
+                        const void *caller)
 {
     uint16_t pkthdr_len;
     struct os_mbuf_pkthdr *pkthdr;
@@ -166,7 +186,7 @@ os_mbuf_get_pkthdr(struct os_mbuf_pool *omp, uint8_t user_pkthdr_len)
         goto done;
     }
 
-    om = os_mbuf_get(omp, 0);
+    om = os_mbuf_get_from(omp, 0, caller);
     if (om) {
         om->om_pkthdr_len = pkthdr_len;
         om->om_data += pkthdr_len;
@@ -182,18 +202,267 @@ done:
     return om;
 }
 
+struct os_mbuf *
+os_mbuf_get_pkthdr(struct os_mbuf_pool *omp, uint8_t user_pkthdr_len)
+{
+    return os_mbuf_get_pkthdr_from(omp, user_pkthdr_len,
+                                   OS_ALLOC_PROF_CALLER());
+}
+
+/*
+ * Allocates an mbuf from om's pool to grow om's chain; with pkthdr, the new
+ * mbuf has room for om's packet header.  With MSYS_QUOTA, the new mbuf is
+ * charged to the msys consumer om is charged to, if any, so that a consumer
+ * cannot exceed its quota by appending to a chain.
+ */
+static struct os_mbuf *
+os_mbuf_get_chained(const struct os_mbuf *om, bool pkthdr,
+                    const void *caller)
+{
+    struct os_mbuf *new;
+#if MYNEWT_VAL(MSYS_QUOTA)
+    struct os_msys_consumer *c;
+
+    c = om->om_consumer;
+    if (c != NULL && os_msys_charge(c) != 0) {
+        return NULL;
+    }
+#endif
+
+    if (pkthdr) {
+        new = os_mbuf_get_pkthdr_from(om->om_omp,
+                                      om->om_pkthdr_len -
+                                      sizeof(struct os_mbuf_pkthdr),
+                                      caller);
+    } else {
+        new = os_mbuf_get_from(om->om_omp, 0, caller);
+    }
+
+#if MYNEWT_VAL(MSYS_QUOTA)
+    if (c != NULL) {
+        new = os_msys_consumer_settle(c, new);
+    }
+#endif
+
+    return new;
+}
+
+#if MYNEWT_VAL(OS_MBUF_EXT)
+static void
+os_mbuf_ext_release(struct os_mbuf_ext *ext)
+{
+    if (os_atomic_fetch_sub_u32(&ext->ome_refcnt, 1) == 1 &&
+        ext->ome_free_cb != NULL) {
+
+        ext->ome_free_cb(ext, ext->ome_arg);
+    }
+}
+
+void
+os_mbuf_ext_init(struct os_mbuf_ext *ext, void *buf, uint16_t len,
+                 os_mbuf_ext_free_fn *free_cb, void *arg)
+{
+    ext->ome_buf = buf;
+    ext->ome_len = len;
+    ext->ome_refcnt = 0;
+    ext->ome_free_cb = free_cb;
+    ext->ome_arg = arg;
+}
+
+static void
+os_mbuf_ext_attach(struct os_mbuf *om, struct os_mbuf_ext *ext,
+                   uint8_t *data, uint16_t len)
+{
+    os_atomic_fetch_add_u32(&ext->ome_refcnt, 1);
+
+    om->om_flags |= OS_MBUF_F_EXT;
+    OS_MBUF_EXT(om) = ext;
+    om->om_data = data;
+    om->om_len = len;
+}
+
+struct os_mbuf *
+os_mbuf_get_ext(struct os_mbuf_pool *omp, struct os_mbuf_ext *ext,
+                uint16_t off, uint16_t len)
+{
+    struct os_mbuf *om;
+
+    /* The header mbuf must be able to hold the storage pointer. */
+    assert(omp->omp_databuf_len >= sizeof(struct os_mbuf_ext *));
+
+    if ((uint32_t)off + len > ext->ome_len) {
+        return NULL;
+    }
+
+    om = os_mbuf_get_from(omp, 0, OS_ALLOC_PROF_CALLER());
+    if (om == NULL) {
+        return NULL;
+    }
+
+    os_mbuf_ext_attach(om, ext, ext->ome_buf + off, len);
+
+    return om;
+}
+
+int
+os_mbuf_append_ext(struct os_mbuf *om, struct os_mbuf_ext *ext,
+                   uint16_t off, uint16_t len)
+{
+    struct os_mbuf *last;
+    struct os_mbuf *new;
+
+    if ((uint32_t)off + len > ext->ome_len) {
+        return SYS_EINVAL;
+    }
+
+    new = os_mbuf_get_chained(om, false, OS_ALLOC_PROF_CALLER());
+    if (new == NULL) {
+        return SYS_ENOMEM;
+    }
+
+    os_mbuf_ext_attach(new, ext, ext->ome_buf + off, len);
+
+    last = om;
+    while (SLIST_NEXT(last, om_next) != NULL) {
+        last = SLIST_NEXT(last, om_next);
+    }
+    SLIST_NEXT(last, om_next) = new;
+
+    if (OS_MBUF_IS_PKTHDR(om)) {
+        OS_MBUF_PKTHDR(om)->omp_len += len;
+    }
+
+    return 0;
+}
+#endif
+
+#if MYNEWT_VAL(OS_MBUF_SHARED)
+/*
+ * Drops one reference to an mbuf's memory block, returning the block to its
+ * pool when no references remain.
+ */
+static int
+os_mbuf_block_release(struct os_mbuf *blk)
+{
+    if (os_atomic_fetch_sub_u32(&blk->om_refcnt, 1) != 1) {
+        return 0;
+    }
+
+    return os_memblock_put_noprof(blk->om_omp->omp_pool, blk);
+}
+
+/*
+ * Gives an mbuf a private copy of its data, so that it can be written
+ * without affecting other mbufs.  The mbuf header stays in place; its data
+ * moves to a newly allocated block.
+ */
+static int
+os_mbuf_unshare(struct os_mbuf *om)
+{
+    struct os_mbuf_pool *omp;
+    struct os_mbuf *copy;
+
+    omp = _os_mbuf_data_block(om)->om_omp;
+    if (om->om_len > omp->omp_databuf_len) {
+        return SYS_ENOMEM;
+    }
+
+    copy = os_mbuf_get(omp, 0);
+    if (copy == NULL) {
+        return SYS_ENOMEM;
+    }
+    memcpy(copy->om_data, om->om_data, om->om_len);
+
+#if MYNEWT_VAL(OS_MBUF_EXT)
+    if (OS_MBUF_IS_EXT(om)) {
+        os_mbuf_ext_release(OS_MBUF_EXT(om));
+        om->om_flags &= ~OS_MBUF_F_EXT;
+    }
+#endif
+    if (om->om_owner != NULL) {
+        os_mbuf_block_release(om->om_owner);
+    }
+
+    /* The copy's header is never used; its reference now belongs to om. */
+    os_alloc_prof_free(OS_ALLOC_PROF_MBUF, copy);
+    om->om_owner = copy;
+    om->om_data = copy->om_data;
+
+    return 0;
+}
+#endif
+
+#if MYNEWT_VAL(OS_MBUF_EXT) || MYNEWT_VAL(OS_MBUF_SHARED)
+/*
+ * Ensures every mbuf holding part of the given range can be written in
+ * place, copying shared data as needed.
+ */
+static int
+os_mbuf_make_writable(struct os_mbuf *om, uint16_t off, int len)
+{
+#if MYNEWT_VAL(OS_MBUF_SHARED)
+    int rc;
+#endif
+
+    for (; om != NULL && len > 0; om = SLIST_NEXT(om, om_next)) {
+        if (om->om_len > off && !os_mbuf_writable(om)) {
+#if MYNEWT_VAL(OS_MBUF_SHARED)
+            rc = os_mbuf_unshare(om);
+            if (rc != 0) {
+                return rc;
+            }
+#else
+            return SYS_EACCES;
+#endif
+        }
+
+        len -= om->om_len - off;
+        off = 0;
+    }
+
+    return 0;
+}
+#endif
+
 int
 os_mbuf_free(struct os_mbuf *om)
 {
+#if MYNEWT_VAL(MSYS_QUOTA)
+    struct os_msys_consumer *consumer;
+#endif
     int rc;
 
     os_trace_api_u32(OS_TRACE_ID_MBUF_FREE, (uint32_t)om);
 
     if (om->om_omp != NULL) {
-        rc = os_memblock_put(om->om_omp->omp_pool, om);
+#if MYNEWT_VAL(MSYS_QUOTA)
+        consumer = om->om_consumer;
+#endif
+#if MYNEWT_VAL(OS_MBUF_EXT)
+        if (OS_MBUF_IS_EXT(om)) {
+            os_mbuf_ext_release(OS_MBUF_EXT(om));
+        }
+#endif
+        os_alloc_prof_free(OS_ALLOC_PROF_MBUF, om);
+#if MYNEWT_VAL(OS_MBUF_SHARED)
+        if (om->om_owner != NULL) {
+            rc = os_mbuf_block_release(om->om_owner);
+            if (rc != 0) {
+                goto done;
+            }
+        }
+        rc = os_mbuf_block_release(om);
+#else
+        rc = os_memblock_put_noprof(om->om_omp->omp_pool, om);
+#endif
         if (rc != 0) {
             goto done;
         }
+#if MYNEWT_VAL(MSYS_QUOTA)
+        if (consumer != NULL) {
+            os_msys_consumer_release(consumer);
+        }
+#endif
     }
 
     rc = 0;
@@ -306,7 +575,7 @@ os_mbuf_append(struct os_mbuf *om, const void *data,  uint16_t len)
      * data into it, until data is exhausted.
      */
     while (remainder > 0) {
-        new = os_mbuf_get(omp, 0);
+        new = os_mbuf_get_chained(om, false, OS_ALLOC_PROF_CALLER());
         if (!new) {
             break;
         }
@@ -397,6 +666,24 @@ os_mbuf_dup(struct os_mbuf *om)
             }
             copy = head;
         }
+#if MYNEWT_VAL(OS_MBUF_EXT)
+        if (OS_MBUF_IS_EXT(om)) {
+            /* Share the external storage instead of copying it. */
+            copy->om_flags = om->om_flags & ~OS_MBUF_F_EXT;
+            os_mbuf_ext_attach(copy, OS_MBUF_EXT(om), om->om_data,
+                               om->om_len);
+            continue;
+        }
+#endif
+#if MYNEWT_VAL(OS_MBUF_SHARED)
+        /* Refer to the original data block instead of copying it. */
+        copy->om_flags = om->om_flags;
+        copy->om_len = om->om_len;
+        copy->om_data = om->om_data;
+        copy->om_owner = _os_mbuf_data_block(om);
+        os_atomic_fetch_add_u32(&copy->om_owner->om_refcnt, 1);
+        continue;
+#endif
         copy->om_flags = om->om_flags;
         copy->om_len = om->om_len;
         memcpy(OS_MBUF_DATA(copy, uint8_t *), OS_MBUF_DATA(om, uint8_t *),
@@ -664,12 +951,8 @@ os_mbuf_prepend(struct os_mbuf *om, int len)
         }
 
         /* The current head didn't have enough space; allocate a new head. */
-        if (OS_MBUF_IS_PKTHDR(om)) {
-            p = os_mbuf_get_pkthdr(om->om_omp,
-                om->om_pkthdr_len - sizeof (struct os_mbuf_pkthdr));
-        } else {
-            p = os_mbuf_get(om->om_omp, 0);
-        }
+        p = os_mbuf_get_chained(om, OS_MBUF_IS_PKTHDR(om),
+                                OS_ALLOC_PROF_CALLER());
         if (p == NULL) {
             os_mbuf_free_chain(om);
             om = NULL;
@@ -725,6 +1008,16 @@ os_mbuf_copyinto(struct os_mbuf *om, int off, const void *src, int len)
         return -1;
     }
 
+#if MYNEWT_VAL(OS_MBUF_EXT) || MYNEWT_VAL(OS_MBUF_SHARED)
+    /* Shared or external data must not be written in place; deal with it
+     * before writing anything.
+     */
+    rc = os_mbuf_make_writable(cur, cur_off, len);
+    if (rc != 0) {
+        return rc;
+    }
+#endif
+
     /* Overwrite existing data until we reach the end of the chain. */
     sptr = src;
     while (1) {
@@ -820,7 +1113,7 @@ os_mbuf_extend(struct os_mbuf *om, uint16_t len)
     }
 
     if (OS_MBUF_TRAILINGSPACE(last) < len) {
-        newm = os_mbuf_get(om->om_omp, 0);
+        newm = os_mbuf_get_chained(om, false, OS_ALLOC_PROF_CALLER());
         if (newm == NULL) {
             return NULL;
         }
@@ -869,7 +1162,7 @@ os_mbuf_pullup(struct os_mbuf *om, uint16_t len)
             goto bad;
         }
 
-        om2 = os_mbuf_get(omp, 0);
+        om2 = os_mbuf_get_chained(om, false, OS_ALLOC_PROF_CALLER());
         if (om2 == NULL) {
             goto bad;
         }
@@ -935,9 +1228,12 @@ os_mbuf_trim_front(struct os_mbuf *om)
     }
 
     /* Try to remove the first mbuf in the chain.  If this buffer contains a
-     * packet header, make sure the second buffer can accommodate it.
+     * packet header, make sure the second buffer can accommodate it.  The
+     * header goes in the second buffer's own data area, so that buffer must
+     * hold its own data.
      */
-    if (OS_MBUF_LEADINGSPACE(cur) >= om->om_pkthdr_len) {
+    if (_os_mbuf_data_block(cur) == cur &&
+        OS_MBUF_LEADINGSPACE(cur) >= om->om_pkthdr_len) {
         /* Second buffer has room; copy packet header. */
         cur->om_pkthdr_len = om->om_pkthdr_len;
         memcpy(OS_MBUF_PKTHDR(cur), OS_MBUF_PKTHDR(om), om->om_pkthdr_len);
@@ -990,7 +1286,7 @@ os_mbuf_widen(struct os_mbuf *om, uint16_t off, uint16_t len)
     first_new = NULL;
     prev = NULL;
     while (rem_len > 0) {
-        cur = os_mbuf_get(om->om_omp, 0);
+        cur = os_mbuf_get_chained(om, false, OS_ALLOC_PROF_CALLER());
         if (cur == NULL) {
             /* Free only the mbufs that this function allocated. */
             os_mbuf_free_chain(first_new);
@@ -1036,3 +1332,216 @@ os_mbuf_widen(struct os_mbuf *om, uint16_t off, uint16_t len)
 
     return 0;
 }
+
+int
+os_mbuf_to_iovec(struct os_mbuf *om, int off, int len,
+                 struct os_mbuf_iovec *iov, int max_iov)
+{
+    struct os_mbuf *cur;
+    uint16_t cur_off;
+    int chunk;
+    int count;
+
+    if (off < 0 || len < 0) {
+        return SYS_EINVAL;
+    }
+
+    cur = os_mbuf_off(om, off, &cur_off);
+    if (cur == NULL) {
+        return SYS_EINVAL;
+    }
+
+    count = 0;
+    while (len > 0) {
+        if (cur == NULL) {
+            return SYS_EINVAL;
+        }
+
+        chunk = min(cur->om_len - cur_off, len);
+        if (chunk > 0) {
+            if (count >= max_iov) {
+                return SYS_ENOMEM;
+            }
+
+            iov[count].iov_base = cur->om_data + cur_off;
+            iov[count].iov_len = chunk;
+            count++;
+            len -= chunk;
+        }
+
+        cur = SLIST_NEXT(cur, om_next);
+        cur_off = 0;
+    }
+
+    return count;
+}
+
+/*
+ * Moves the cursor past any mbufs it has fully consumed, so that omc_om
+ * refers to the mbuf containing the next unread byte whenever one exists.
+ */
+static void
+os_mbuf_cursor_settle(struct os_mbuf_cursor *omc)
+{
+    const struct os_mbuf *next;
+
+    while (omc->omc_off >= omc->omc_om->om_len) {
+        next = SLIST_NEXT(omc->omc_om, om_next);
+        if (next == NULL) {
+            break;
+        }
+        omc->omc_off -= omc->omc_om->om_len;
+        omc->omc_om = next;
+    }
+}
+
+void
+os_mbuf_cursor_init(struct os_mbuf_cursor *omc, const struct os_mbuf *om)
+{
+    omc->omc_head = om;
+    omc->omc_om = om;
+    omc->omc_off = 0;
+    omc->omc_pos = 0;
+
+    os_mbuf_cursor_settle(omc);
+}
+
+int
+os_mbuf_cursor_seek(struct os_mbuf_cursor *omc, int off)
+{
+    const struct os_mbuf *cur;
+    int cur_off;
+
+    if (off < 0) {
+        return SYS_EINVAL;
+    }
+
+    /* Resume from the current mbuf unless the target lies before it. */
+    cur_off = off - (omc->omc_pos - omc->omc_off);
+    if (cur_off >= 0) {
+        cur = omc->omc_om;
+    } else {
+        cur = omc->omc_head;
+        cur_off = off;
+    }
+
+    while (cur_off > cur->om_len) {
+        cur_off -= cur->om_len;
+        cur = SLIST_NEXT(cur, om_next);
+        if (cur == NULL) {
+            return SYS_EINVAL;
+        }
+    }
+
+    omc->omc_om = cur;
+    omc->omc_off = cur_off;
+    omc->omc_pos = off;
+    os_mbuf_cursor_settle(omc);
+
+    return 0;
+}
+
+int
+os_mbuf_cursor_skip(struct os_mbuf_cursor *omc, int len)
+{
+    if (len < 0) {
+        return SYS_EINVAL;
+    }
+
+    return os_mbuf_cursor_seek(omc, omc->omc_pos + len);
+}
+
+const uint8_t *
+os_mbuf_cursor_span(const struct os_mbuf_cursor *omc, uint16_t *out_len)
+{
+    const struct os_mbuf *om;
+
+    om = omc->omc_om;
+    if (omc->omc_off >= om->om_len) {
+        *out_len = 0;
+        return NULL;
+    }
+
+    *out_len = om->om_len - omc->omc_off;
+    return om->om_data + omc->omc_off;
+}
+
+int
+os_mbuf_cursor_peek(const struct os_mbuf_cursor *omc, void *dst, int len)
+{
+    const struct os_mbuf *om;
+    uint8_t *udst;
+    int om_off;
+    int chunk;
+
+    if (len < 0) {
+        return SYS_EINVAL;
+    }
+
+    udst = dst;
+    om = omc->omc_om;
+    om_off = omc->omc_off;
+    while (len > 0) {
+        if (om == NULL) {
+            return SYS_EINVAL;
+        }
+
+        chunk = min(om->om_len - om_off, len);
+        memcpy(udst, om->om_data + om_off, chunk);
+        udst += chunk;
+        len -= chunk;
+
+        om = SLIST_NEXT(om, om_next);
+        om_off = 0;
+    }
+
+    return 0;
+}
+
+int
+os_mbuf_cursor_read(struct os_mbuf_cursor *omc, void *dst, int len)
+{
+    int rc;
+
+    rc = os_mbuf_cursor_peek(omc, dst, len);
+    if (rc != 0) {
+        return rc;
+    }
+
+    return os_mbuf_cursor_skip(omc, len);
+}
+
+int
+os_mbuf_cursor_cmp(const struct os_mbuf_cursor *omc, const void *data,
+                   int len)
+{
+    const struct os_mbuf *om;
+    const uint8_t *udata;
+    int om_off;
+    int chunk;
+    int rc;
+
+    udata = data;
+    om = omc->omc_om;
+    om_off = omc->omc_off;
+    while (len > 0) {
+        if (om == NULL) {
+            return INT_MAX;
+        }
+
+        chunk = min(om->om_len - om_off, len);
+        if (chunk > 0) {
+            rc = memcmp(om->om_data + om_off, udata, chunk);
+            if (rc != 0) {
+                return rc;
+            }
+        }
+        udata += chunk;
+        len -= chunk;
+
+        om = SLIST_NEXT(om, om_next);
+        om_off = 0;
+    }
+
+    return 0;
+}
@@ -25,6 +25,8 @@
 #define OS_TRACE_DISABLE_FILE_API
 #endif
 #include "os/mynewt.h"
+#include "os/os_alloc_prof.h"
+#include "os_priv.h"
 
 #define OS_MEM_TRUE_BLOCK_SIZE(bsize)   OS_ALIGN(bsize, OS_ALIGNMENT)
 #if MYNEWT_VAL(OS_MEMPOOL_GUARD)
@@ -36,7 +38,8 @@
 #define OS_MEMPOOL_TRUE_BLOCK_SIZE(mp) OS_MEM_TRUE_BLOCK_SIZE(mp->mp_block_size)
 #endif
 
-STAILQ_HEAD(, os_mempool) g_os_mempool_list;
+STAILQ_HEAD(, os_mempool) g_os_mempool_list =
+    STAILQ_HEAD_INITIALIZER(g_os_mempool_list);
 
 #if MYNEWT_VAL(OS_MEMPOOL_POISON)
 static uint32_t os_mem_poison = 0xde7ec7ed;
@@ -114,6 +117,133 @@ os_mempool_guard_check(const struct os_mempool *mp, void *start)
 #define os_mempool_guard_check(mp, start)
 #endif
 
+#if MYNEWT_VAL(OS_MEMPOOL_LOCKFREE)
+#define OS_MEMPOOL_LF_IDX_MASK  0x0000ffff
+#define OS_MEMPOOL_LF_TAG_INC   0x00010000
+
+/**
+ * Computes a new lock-free list head from the previous one, bumping the tag
+ * so that a concurrent compare-and-swap based on the old head fails even if
+ * the same block ends up on top again (ABA).
+ */
+#define OS_MEMPOOL_LF_HEAD(prev, idx)                                   \
+    ((((prev) + OS_MEMPOOL_LF_TAG_INC) & ~OS_MEMPOOL_LF_IDX_MASK) | (idx))
+
+static struct os_memblock *
+os_mempool_lf_block(const struct os_mempool *mp, uint32_t head)
+{
+    uint32_t idx;
+
+    idx = head & OS_MEMPOOL_LF_IDX_MASK;
+    if (idx == 0) {
+        return NULL;
+    }
+
+    return (struct os_memblock *)(mp->mp_membuf_addr +
+                                  (idx - 1) * OS_MEMPOOL_TRUE_BLOCK_SIZE(mp));
+}
+
+static uint32_t
+os_mempool_lf_index(const struct os_mempool *mp,
+                    const struct os_memblock *block)
+{
+    uint32_t idx;
+
+    if (block == NULL) {
+        return 0;
+    }
+
+    /* The block may be stale (popped concurrently and overwritten); mask the
+     * result so it cannot spill into the tag.  The compare-and-swap fails in
+     * that case anyway.
+     */
+    idx = ((uint32_t)block - mp->mp_membuf_addr) /
+          OS_MEMPOOL_TRUE_BLOCK_SIZE(mp) + 1;
+
+    return idx & OS_MEMPOOL_LF_IDX_MASK;
+}
+
+static void
+os_mempool_lf_reset(struct os_mempool *mp)
+{
+    mp->mp_lf_head = OS_MEMPOOL_LF_HEAD(mp->mp_lf_head,
+                                        mp->mp_num_blocks > 0 ? 1 : 0);
+    mp->mp_lf_used = 0;
+}
+
+/**
+ * Updates the free counts after a lock-free get or put.  The counts are
+ * written without synchronization, so they can lag a concurrent operation;
+ * they are statistics only.
+ */
+static void
+os_mempool_lf_account(struct os_mempool *mp, uint32_t used)
+{
+    uint16_t num_free;
+
+    num_free = mp->mp_num_blocks - used;
+    mp->mp_num_free = num_free;
+    if (mp->mp_min_free > num_free) {
+        mp->mp_min_free = num_free;
+    }
+}
+
+static struct os_memblock *
+os_mempool_lf_pop(struct os_mempool *mp)
+{
+    struct os_memblock *block;
+    uint32_t head;
+    uint32_t next;
+    uint32_t idx;
+
+    do {
+        head = os_atomic_load_u32(&mp->mp_lf_head);
+        block = os_mempool_lf_block(mp, head);
+        if (block == NULL) {
+            return NULL;
+        }
+
+        idx = os_mempool_lf_index(mp, SLIST_NEXT(block, mb_next));
+        next = OS_MEMPOOL_LF_HEAD(head, idx);
+    } while (!os_atomic_cas_u32(&mp->mp_lf_head, head, next));
+
+    os_mempool_lf_account(mp, os_atomic_fetch_add_u32(&mp->mp_lf_used, 1) + 1);
+
+    return block;
+}
+
+static void
+os_mempool_lf_push(struct os_mempool *mp, struct os_memblock *block)
+{
+    uint32_t head;
+    uint32_t idx;
+
+    idx = os_mempool_lf_index(mp, block);
+
+    do {
+        head = os_atomic_load_u32(&mp->mp_lf_head);
+        SLIST_NEXT(block, mb_next) = os_mempool_lf_block(mp, head);
+    } while (!os_atomic_cas_u32(&mp->mp_lf_head, head,
+                                OS_MEMPOOL_LF_HEAD(head, idx)));
+
+    os_mempool_lf_account(mp, os_atomic_fetch_sub_u32(&mp->mp_lf_used, 1) - 1);
+}
+#endif
+
+/**
+ * Retrieves the first block on the free list.  The list is only stable while
+ * nothing else gets or puts blocks.
+ */
+static struct os_memblock *
+os_mempool_first_free(const struct os_mempool *mp)
+{
+#if MYNEWT_VAL(OS_MEMPOOL_LOCKFREE)
+    return os_mempool_lf_block(mp, os_atomic_load_u32(&mp->mp_lf_head));
+#else
+    return SLIST_FIRST(mp);
+#endif
+}
+
 static os_error_t
 os_mempool_init_internal(struct os_mempool *mp, uint16_t blocks,
                          uint32_t block_size, void *membuf, char *name,
@@ -171,8 +301,11 @@ os_mempool_init_internal(struct os_mempool *mp, uint16_t blocks,
         /* Last one in the list should be NULL */
         SLIST_NEXT(block_ptr, mb_next) = NULL;
     }
+#if MYNEWT_VAL(OS_MEMPOOL_LOCKFREE)
+    os_mempool_lf_reset(mp);
+#endif
 
-    STAILQ_INSERT_TAIL(&g_os_mempool_list, mp, mp_list);
+    os_mempool_register(mp);
 
     return OS_OK;
 }
@@ -202,6 +335,12 @@ os_mempool_ext_init(struct os_mempool_ext *mpe, uint16_t blocks,
     return 0;
 }
 
+void
+os_mempool_register(struct os_mempool *mp)
+{
+    STAILQ_INSERT_TAIL(&g_os_mempool_list, mp, mp_list);
+}
+
 os_error_t
 os_mempool_unregister(struct os_mempool *mp)
 {
@@ -277,6 +416,9 @@ os_mempool_clear(struct os_mempool *mp)
 
     /* Last one in the list should be NULL */
     SLIST_NEXT(block_ptr, mb_next) = NULL;
+#if MYNEWT_VAL(OS_MEMPOOL_LOCKFREE)
+    os_mempool_lf_reset(mp);
+#endif
 
     return OS_OK;
 }
@@ -287,7 +429,9 @@ os_mempool_is_sane(const struct os_mempool *mp)
     struct os_memblock *block;
 
     /* Verify that each block in the free list belongs to the mempool. */
-    SLIST_FOREACH(block, mp, mb_next) {
+    for (block = os_mempool_first_free(mp);
+         block != NULL;
+         block = SLIST_NEXT(block, mb_next)) {
         if (!os_memblock_from(mp, block)) {
             return false;
         }
@@ -326,9 +470,11 @@ os_memblock_from(const struct os_mempool *mp, const void *block_addr)
 }
 
 void *
-os_memblock_get(struct os_mempool *mp)
+os_memblock_get_noprof(struct os_mempool *mp)
 {
+#if !MYNEWT_VAL(OS_MEMPOOL_LOCKFREE)
     os_sr_t sr;
+#endif
     struct os_memblock *block;
 
     os_trace_api_u32(OS_TRACE_ID_MEMBLOCK_GET, (uint32_t)mp);
@@ -336,6 +482,9 @@ os_memblock_get(struct os_mempool *mp)
     /* Check to make sure they passed in a memory pool (or something) */
     block = NULL;
     if (mp) {
+#if MYNEWT_VAL(OS_MEMPOOL_LOCKFREE)
+        block = os_mempool_lf_pop(mp);
+#else
         OS_ENTER_CRITICAL(sr);
         /* Check for any free */
         if (mp->mp_num_free) {
@@ -352,6 +501,7 @@ os_memblock_get(struct os_mempool *mp)
             }
         }
         OS_EXIT_CRITICAL(sr);
+#endif
 
         if (block) {
             os_mempool_poison_check(mp, block);
@@ -364,10 +514,26 @@ os_memblock_get(struct os_mempool *mp)
     return (void *)block;
 }
 
+void *
+os_memblock_get(struct os_mempool *mp)
+{
+    void *block;
+
+    block = os_memblock_get_noprof(mp);
+    if (block) {
+        os_alloc_prof_alloc(OS_ALLOC_PROF_MEMBLOCK, mp, block,
+                            mp->mp_block_size, OS_ALLOC_PROF_CALLER());
+    }
+
+    return block;
+}
+
 os_error_t
 os_memblock_put_from_cb(struct os_mempool *mp, void *block_addr)
 {
+#if !MYNEWT_VAL(OS_MEMPOOL_LOCKFREE)
     os_sr_t sr;
+#endif
     struct os_memblock *block;
 
     os_trace_api_u32x2(OS_TRACE_ID_MEMBLOCK_PUT_FROM_CB, (uint32_t)mp,
@@ -377,6 +543,9 @@ os_memblock_put_from_cb(struct os_mempool *mp, void *block_addr)
     os_mempool_poison(mp, block_addr);
 
     block = (struct os_memblock *)block_addr;
+#if MYNEWT_VAL(OS_MEMPOOL_LOCKFREE)
+    os_mempool_lf_push(mp, block);
+#else
     OS_ENTER_CRITICAL(sr);
 
     /* Chain current free list pointer to this block; make this block head */
@@ -388,6 +557,7 @@ os_memblock_put_from_cb(struct os_mempool *mp, void *block_addr)
     mp->mp_num_free++;
 
     OS_EXIT_CRITICAL(sr);
+#endif
 
     os_trace_api_ret_u32(OS_TRACE_ID_MEMBLOCK_PUT_FROM_CB, (uint32_t)OS_OK);
 
@@ -395,7 +565,7 @@ os_memblock_put_from_cb(struct os_mempool *mp, void *block_addr)
 }
 
 os_error_t
-os_memblock_put(struct os_mempool *mp, void *block_addr)
+os_memblock_put_noprof(struct os_mempool *mp, void *block_addr)
 {
     struct os_mempool_ext *mpe;
     os_error_t ret;
@@ -419,7 +589,9 @@ os_memblock_put(struct os_mempool *mp, void *block_addr)
     /*
      * Check for duplicate free.
      */
-    SLIST_FOREACH(block, mp, mb_next) {
+    for (block = os_mempool_first_free(mp);
+         block != NULL;
+         block = SLIST_NEXT(block, mb_next)) {
         assert(block != (struct os_memblock *)block_addr);
     }
 #endif
@@ -442,6 +614,100 @@ done:
     return ret;
 }
 
+os_error_t
+os_memblock_put(struct os_mempool *mp, void *block_addr)
+{
+    /* Reported before the block can be handed out again. */
+    if (mp != NULL && block_addr != NULL) {
+        os_alloc_prof_free(OS_ALLOC_PROF_MEMBLOCK, block_addr);
+    }
+
+    return os_memblock_put_noprof(mp, block_addr);
+}
+
+void
+os_mempool_mag_init(struct os_mempool_mag *mag, struct os_mempool *mp)
+{
+    mag->mm_pool = mp;
+    mag->mm_count = 0;
+}
+
+void *
+os_mempool_mag_get(struct os_mempool_mag *mag)
+{
+    void *block;
+    void *extra;
+
+    if (mag->mm_count > 0) {
+        block = mag->mm_blocks[--mag->mm_count];
+    } else {
+        /* Empty; take a batch from the pool and hand out one of them. */
+        block = os_memblock_get_noprof(mag->mm_pool);
+        if (block != NULL) {
+            while (mag->mm_count < MYNEWT_VAL(OS_MEMPOOL_MAG_SIZE) / 2) {
+                extra = os_memblock_get_noprof(mag->mm_pool);
+                if (extra == NULL) {
+                    break;
+                }
+                mag->mm_blocks[mag->mm_count++] = extra;
+            }
+        }
+    }
+
+    if (block != NULL) {
+        os_alloc_prof_alloc(OS_ALLOC_PROF_MEMBLOCK, mag->mm_pool, block,
+                            mag->mm_pool->mp_block_size,
+                            OS_ALLOC_PROF_CALLER());
+    }
+
+    return block;
+}
+
+os_error_t
+os_mempool_mag_put(struct os_mempool_mag *mag, void *block_addr)
+{
+    struct os_mempool_ext *mpe;
+    struct os_mempool *mp;
+
+    mp = mag->mm_pool;
+
+    if (block_addr == NULL) {
+        return OS_INVALID_PARM;
+    }
+
+#if MYNEWT_VAL(OS_MEMPOOL_CHECK)
+    assert(os_memblock_from(mp, block_addr));
+#endif
+
+    os_alloc_prof_free(OS_ALLOC_PROF_MEMBLOCK, block_addr);
+
+    if (mp->mp_flags & OS_MEMPOOL_F_EXT) {
+        mpe = (struct os_mempool_ext *)mp;
+        if (mpe->mpe_put_cb != NULL) {
+            return os_memblock_put_noprof(mp, block_addr);
+        }
+    }
+
+    /* Full; return half of the cached blocks to the pool. */
+    if (mag->mm_count == MYNEWT_VAL(OS_MEMPOOL_MAG_SIZE)) {
+        while (mag->mm_count > MYNEWT_VAL(OS_MEMPOOL_MAG_SIZE) / 2) {
+            os_memblock_put_from_cb(mp, mag->mm_blocks[--mag->mm_count]);
+        }
+    }
+
+    mag->mm_blocks[mag->mm_count++] = block_addr;
+
+    return OS_OK;
+}
+
+void
+os_mempool_mag_flush(struct os_mempool_mag *mag)
+{
+    while (mag->mm_count > 0) {
+        os_memblock_put_from_cb(mag->mm_pool, mag->mm_blocks[--mag->mm_count]);
+    }
+}
+
 struct os_mempool *
 os_mempool_info_get_next(struct os_mempool *mp, struct os_mempool_info *omi)
 {
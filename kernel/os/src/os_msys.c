@@ -18,8 +18,10 @@
  */
 
 #include <assert.h>
+#include <string.h>
 #include "os/mynewt.h"
 #include "mem/mem.h"
+#include "os/os_alloc_prof.h"
 #include "os_priv.h"
 
 static STAILQ_HEAD(, os_mbuf_pool) g_msys_pool_list =
@@ -55,6 +57,14 @@ static struct os_mempool os_msys_2_mempool;
 static struct os_sanity_check os_msys_sc;
 #endif
 
+#if MYNEWT_VAL(MSYS_QUOTA)
+/* Sum of all consumer reservations. */
+static int g_msys_reserved;
+
+/* Reserved mbufs that their consumers have not yet taken. */
+static int g_msys_reserve_avail;
+#endif
+
 int
 os_msys_register(struct os_mbuf_pool *new_pool)
 {
@@ -84,6 +94,10 @@ void
 os_msys_reset(void)
 {
     STAILQ_INIT(&g_msys_pool_list);
+#if MYNEWT_VAL(MSYS_QUOTA)
+    g_msys_reserved = 0;
+    g_msys_reserve_avail = 0;
+#endif
 }
 
 static struct os_mbuf_pool *
@@ -97,24 +111,168 @@ static struct os_mbuf_pool *
 os_msys_find_pool(uint16_t dsize)
 {
     struct os_mbuf_pool *pool;
+    struct os_mbuf_pool *fit;
 
-    pool = NULL;
+    /*
+     * Take the smallest pool that fits and still has free blocks.  If every
+     * pool that fits is exhausted, return the smallest of them anyway so the
+     * allocation fails there.
+     */
+    fit = NULL;
     STAILQ_FOREACH(pool, &g_msys_pool_list, omp_next) {
         if (dsize <= pool->omp_databuf_len) {
-            break;
+            if (pool->omp_pool->mp_num_free > 0) {
+                return (pool);
+            }
+            if (!fit) {
+                fit = pool;
+            }
         }
     }
 
-    if (!pool) {
-        pool = STAILQ_LAST(&g_msys_pool_list, os_mbuf_pool, omp_next);
+    if (!fit) {
+        fit = STAILQ_LAST(&g_msys_pool_list, os_mbuf_pool, omp_next);
     }
 
-    return (pool);
+    return (fit);
 }
 
+#if MYNEWT_VAL(MSYS_QUOTA)
+/**
+ * Charges an allocation against a consumer's quota and checks that it does
+ * not eat into other consumers' reservations.
+ *
+ * @param c                     The consumer to charge; NULL for an
+ *                                  allocation made outside any consumer.
+ *
+ * @return                      0 if the allocation may proceed;
+ *                              SYS_ENOMEM otherwise.
+ */
+int
+os_msys_charge(struct os_msys_consumer *c)
+{
+    os_sr_t sr;
+    int rc;
 
+    OS_ENTER_CRITICAL(sr);
+
+    if (c != NULL && c->omsc_in_use < c->omsc_reserved) {
+        /* The consumer draws on its own reservation. */
+        g_msys_reserve_avail--;
+        rc = 0;
+    } else if (c != NULL && c->omsc_limit != 0 &&
+               c->omsc_in_use >= c->omsc_limit) {
+        rc = SYS_ENOMEM;
+    } else if (g_msys_reserve_avail > 0 &&
+               os_msys_num_free() <= g_msys_reserve_avail) {
+        /* Everything left is reserved for other consumers. */
+        rc = SYS_ENOMEM;
+    } else {
+        rc = 0;
+    }
+
+    if (c != NULL) {
+        if (rc == 0) {
+            c->omsc_in_use++;
+        } else {
+            c->omsc_fails++;
+        }
+    }
+
+    OS_EXIT_CRITICAL(sr);
+
+    return rc;
+}
+
+static void
+os_msys_uncharge(struct os_msys_consumer *c)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+
+    assert(c->omsc_in_use > 0);
+    c->omsc_in_use--;
+    if (c->omsc_in_use < c->omsc_reserved) {
+        g_msys_reserve_avail++;
+    }
+
+    OS_EXIT_CRITICAL(sr);
+}
+
+/**
+ * Invokes a consumer's back-pressure callback if its usage has crossed a
+ * watermark since the last notification.
+ */
+static void
+os_msys_notify(struct os_msys_consumer *c)
+{
+    os_sr_t sr;
+    int congested;
+    int changed;
+
+    changed = 0;
+
+    OS_ENTER_CRITICAL(sr);
+
+    if (c->omsc_high_wm != 0) {
+        if (!c->omsc_congested && c->omsc_in_use >= c->omsc_high_wm) {
+            c->omsc_congested = 1;
+            changed = 1;
+        } else if (c->omsc_congested && c->omsc_in_use <= c->omsc_low_wm) {
+            c->omsc_congested = 0;
+            changed = 1;
+        }
+    }
+    congested = c->omsc_congested;
+
+    OS_EXIT_CRITICAL(sr);
+
+    if (changed && c->omsc_bp_cb != NULL) {
+        c->omsc_bp_cb(c, congested, c->omsc_bp_arg);
+    }
+}
+
+/**
+ * Completes a consumer allocation: the mbuf is tagged with the consumer, or
+ * the charge is undone if the pool was empty.
+ */
 struct os_mbuf *
-os_msys_get(uint16_t dsize, uint16_t leadingspace)
+os_msys_consumer_settle(struct os_msys_consumer *c, struct os_mbuf *m)
+{
+    os_sr_t sr;
+
+    if (m != NULL) {
+        m->om_consumer = c;
+
+        OS_ENTER_CRITICAL(sr);
+        if (c->omsc_in_use > c->omsc_in_use_max) {
+            c->omsc_in_use_max = c->omsc_in_use;
+        }
+        OS_EXIT_CRITICAL(sr);
+    } else {
+        os_msys_uncharge(c);
+
+        OS_ENTER_CRITICAL(sr);
+        c->omsc_fails++;
+        OS_EXIT_CRITICAL(sr);
+    }
+
+    os_msys_notify(c);
+
+    return m;
+}
+
+void
+os_msys_consumer_release(struct os_msys_consumer *c)
+{
+    os_msys_uncharge(c);
+    os_msys_notify(c);
+}
+#endif
+
+static struct os_mbuf *
+os_msys_get_from(uint16_t dsize, uint16_t leadingspace, const void *caller)
 {
     struct os_mbuf *m;
     struct os_mbuf_pool *pool;
@@ -132,14 +290,15 @@ os_msys_get(uint16_t dsize, uint16_t leadingspace)
         goto err;
     }
 
-    m = os_mbuf_get(pool, leadingspace);
+    m = os_mbuf_get_from(pool, leadingspace, caller);
     return (m);
 err:
     return (NULL);
 }
 
-struct os_mbuf *
-os_msys_get_pkthdr(uint16_t dsize, uint16_t user_hdr_len)
+static struct os_mbuf *
+os_msys_get_pkthdr_from(uint16_t dsize, uint16_t user_hdr_len,
+                        const void *caller)
 {
     uint16_t total_pkthdr_len;
     struct os_mbuf *m;
@@ -160,12 +319,117 @@ os_msys_get_pkthdr(uint16_t dsize, uint16_t user_hdr_len)
         goto err;
     }
 
-    m = os_mbuf_get_pkthdr(pool, user_hdr_len);
+    m = os_mbuf_get_pkthdr_from(pool, user_hdr_len, caller);
     return (m);
 err:
     return (NULL);
 }
 
+struct os_mbuf *
+os_msys_get(uint16_t dsize, uint16_t leadingspace)
+{
+#if MYNEWT_VAL(MSYS_QUOTA)
+    if (os_msys_charge(NULL) != 0) {
+        return (NULL);
+    }
+#endif
+
+    return os_msys_get_from(dsize, leadingspace, OS_ALLOC_PROF_CALLER());
+}
+
+struct os_mbuf *
+os_msys_get_pkthdr(uint16_t dsize, uint16_t user_hdr_len)
+{
+#if MYNEWT_VAL(MSYS_QUOTA)
+    if (os_msys_charge(NULL) != 0) {
+        return (NULL);
+    }
+#endif
+
+    return os_msys_get_pkthdr_from(dsize, user_hdr_len,
+                                   OS_ALLOC_PROF_CALLER());
+}
+
+#if MYNEWT_VAL(MSYS_QUOTA)
+int
+os_msys_consumer_register(struct os_msys_consumer *c, const char *name,
+                          uint16_t reserved, uint16_t limit)
+{
+    os_sr_t sr;
+
+    if (limit != 0 && limit < reserved) {
+        return SYS_EINVAL;
+    }
+
+    OS_ENTER_CRITICAL(sr);
+
+    if (g_msys_reserved + reserved > os_msys_count()) {
+        OS_EXIT_CRITICAL(sr);
+        return SYS_ENOMEM;
+    }
+
+    memset(c, 0, sizeof *c);
+    c->omsc_name = name;
+    c->omsc_reserved = reserved;
+    c->omsc_limit = limit;
+
+    g_msys_reserved += reserved;
+    g_msys_reserve_avail += reserved;
+
+    OS_EXIT_CRITICAL(sr);
+
+    return 0;
+}
+
+void
+os_msys_consumer_set_bp(struct os_msys_consumer *c, uint16_t high_wm,
+                        uint16_t low_wm, os_msys_bp_fn *cb, void *arg)
+{
+    os_sr_t sr;
+
+    assert(high_wm == 0 || low_wm < high_wm);
+
+    OS_ENTER_CRITICAL(sr);
+    c->omsc_high_wm = high_wm;
+    c->omsc_low_wm = low_wm;
+    c->omsc_bp_cb = cb;
+    c->omsc_bp_arg = arg;
+    OS_EXIT_CRITICAL(sr);
+
+    /* Report right away if usage is already past the new watermark. */
+    os_msys_notify(c);
+}
+
+struct os_mbuf *
+os_msys_consumer_get(struct os_msys_consumer *c, uint16_t dsize,
+                     uint16_t leadingspace)
+{
+    struct os_mbuf *m;
+
+    if (os_msys_charge(c) != 0) {
+        return (NULL);
+    }
+
+    m = os_msys_get_from(dsize, leadingspace, OS_ALLOC_PROF_CALLER());
+    return os_msys_consumer_settle(c, m);
+}
+
+struct os_mbuf *
+os_msys_consumer_get_pkthdr(struct os_msys_consumer *c, uint16_t dsize,
+                            uint16_t user_hdr_len)
+{
+    struct os_mbuf *m;
+
+    if (os_msys_charge(c) != 0) {
+        return (NULL);
+    }
+
+    m = os_msys_get_pkthdr_from(dsize, user_hdr_len,
+                                OS_ALLOC_PROF_CALLER());
+    return os_msys_consumer_settle(c, m);
+}
+#endif
+
 int
 os_msys_count(void)
 {
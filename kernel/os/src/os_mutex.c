@@ -24,6 +24,92 @@
 #endif
 #include "os/mynewt.h"
 
+/**
+ * Links a task into the list of tasks waiting for a mutex, in priority
+ * order.
+ */
+static void
+os_mutex_waiter_insert(struct os_mutex *mu, struct os_task *t)
+{
+    struct os_task *entry;
+    struct os_task *last;
+
+    last = NULL;
+    SLIST_FOREACH(entry, &mu->mu_head, t_obj_list) {
+        if (t->t_prio < entry->t_prio) {
+            break;
+        }
+        last = entry;
+    }
+
+    if (last) {
+        SLIST_INSERT_AFTER(last, t, t_obj_list);
+    } else {
+        SLIST_INSERT_HEAD(&mu->mu_head, t, t_obj_list);
+    }
+}
+
+#if MYNEWT_VAL(OS_MUTEX_PRIO_CHAIN)
+/**
+ * Returns the priority a task should run at: its base priority, raised to
+ * the ceiling of any ceiling mutex it owns and to the priority of the
+ * highest priority task waiting on any mutex it owns.
+ */
+static uint8_t
+os_mutex_task_prio(struct os_task *t)
+{
+    struct os_mutex *mu;
+    struct os_task *waiter;
+    uint8_t prio;
+
+    prio = t->t_base_prio;
+    SLIST_FOREACH(mu, &t->t_mutex_list, mu_next) {
+        if ((mu->mu_flags & OS_MUTEX_F_CEILING) && mu->mu_ceiling < prio) {
+            prio = mu->mu_ceiling;
+        }
+        /* Waiters are sorted, the first one has the highest priority. */
+        waiter = SLIST_FIRST(&mu->mu_head);
+        if (waiter && waiter->t_prio < prio) {
+            prio = waiter->t_prio;
+        }
+    }
+
+    return prio;
+}
+
+/**
+ * Recomputes the priority of a task after the set of mutexes it owns, or
+ * their waiters, changed.  If the task is itself blocked on a mutex, the
+ * change is propagated to that mutex's owner, and so on down the chain.
+ * Must be called with interrupts disabled.
+ */
+static void
+os_mutex_prio_update(struct os_task *t)
+{
+    struct os_mutex *mu;
+    uint8_t prio;
+
+    while (t != NULL) {
+        prio = os_mutex_task_prio(t);
+        if (prio == t->t_prio) {
+            break;
+        }
+        t->t_prio = prio;
+        os_sched_resort(t);
+
+        if (!(t->t_flags & OS_TASK_FLAG_MUTEX_WAIT) || t->t_obj == NULL) {
+            break;
+        }
+
+        /* Keep the wait list of the mutex we are blocked on sorted. */
+        mu = t->t_obj;
+        SLIST_REMOVE(&mu->mu_head, t, os_task, t_obj_list);
+        os_mutex_waiter_insert(mu, t);
+        t = mu->mu_owner;
+    }
+}
+#endif
+
 os_error_t
 os_mutex_init(struct os_mutex *mu)
 {
@@ -41,6 +127,10 @@ os_mutex_init(struct os_mutex *mu)
     mu->mu_level = 0;
     mu->mu_owner = NULL;
     SLIST_FIRST(&mu->mu_head) = NULL;
+#if MYNEWT_VAL(OS_MUTEX_PRIO_CHAIN)
+    mu->mu_ceiling = 0;
+    mu->mu_flags = 0;
+#endif
 
     ret = OS_OK;
 
@@ -49,6 +139,24 @@ done:
     return ret;
 }
 
+#if MYNEWT_VAL(OS_MUTEX_PRIO_CHAIN)
+os_error_t
+os_mutex_init_ceiling(struct os_mutex *mu, uint8_t ceiling)
+{
+    os_error_t ret;
+
+    ret = os_mutex_init(mu);
+    if (ret != OS_OK) {
+        return ret;
+    }
+
+    mu->mu_ceiling = ceiling;
+    mu->mu_flags |= OS_MUTEX_F_CEILING;
+
+    return OS_OK;
+}
+#endif
+
 os_error_t
 os_mutex_release(struct os_mutex *mu)
 {
@@ -91,11 +199,15 @@ os_mutex_release(struct os_mutex *mu)
     /* Decrement nesting level (this effectively sets nesting level to 0) */
     --mu->mu_level;
 
+#if MYNEWT_VAL(OS_MUTEX_PRIO_CHAIN)
+    SLIST_REMOVE(&current->t_mutex_list, mu, os_mutex, mu_next);
+#else
     /* Restore owner task's priority; resort list if different  */
     if (current->t_prio != mu->mu_prio) {
         current->t_prio = mu->mu_prio;
         os_sched_resort(current);
     }
+#endif
 
     /* Check if tasks are waiting for the mutex */
     rdy = SLIST_FIRST(&mu->mu_head);
@@ -116,6 +228,18 @@ os_mutex_release(struct os_mutex *mu)
     }
     --current->t_lockcnt;
 
+#if MYNEWT_VAL(OS_MUTEX_PRIO_CHAIN)
+    /*
+     * The new owner inherits from the remaining waiters; we drop whatever
+     * this mutex was lending us, but keep boosts from other mutexes held.
+     */
+    if (rdy) {
+        SLIST_INSERT_HEAD(&rdy->t_mutex_list, mu, mu_next);
+        os_mutex_prio_update(rdy);
+    }
+    os_mutex_prio_update(current);
+#endif
+
     /* Do we need to re-schedule? */
     resched = 0;
     rdy = os_sched_next_task();
@@ -142,8 +266,6 @@ os_mutex_pend(struct os_mutex *mu, os_time_t timeout)
     os_sr_t sr;
     os_error_t ret;
     struct os_task *current;
-    struct os_task *entry;
-    struct os_task *last;
 
     os_trace_api_u32x2(OS_TRACE_ID_MUTEX_PEND, (uint32_t)mu, (uint32_t)timeout);
 
@@ -168,6 +290,14 @@ os_mutex_pend(struct os_mutex *mu, os_time_t timeout)
         mu->mu_prio  = current->t_prio;
         current->t_lockcnt++;
         mu->mu_level = 1;
+#if MYNEWT_VAL(OS_MUTEX_PRIO_CHAIN)
+        SLIST_INSERT_HEAD(&current->t_mutex_list, mu, mu_next);
+        if ((mu->mu_flags & OS_MUTEX_F_CEILING) &&
+            mu->mu_ceiling < current->t_prio) {
+            current->t_prio = mu->mu_ceiling;
+            os_sched_resort(current);
+        }
+#endif
         OS_EXIT_CRITICAL(sr);
         ret = OS_OK;
         goto done;
@@ -188,33 +318,24 @@ os_mutex_pend(struct os_mutex *mu, os_time_t timeout)
         goto done;
     }
 
+#if !MYNEWT_VAL(OS_MUTEX_PRIO_CHAIN)
     /* Change priority of owner if needed */
     if (mu->mu_owner->t_prio > current->t_prio) {
         mu->mu_owner->t_prio = current->t_prio;
         os_sched_resort(mu->mu_owner);
     }
+#endif
 
     /* Link current task to tasks waiting for mutex */
-    last = NULL;
-    if (!SLIST_EMPTY(&mu->mu_head)) {
-        /* Insert in priority order */
-        SLIST_FOREACH(entry, &mu->mu_head, t_obj_list) {
-            if (current->t_prio < entry->t_prio) {
-                break;
-            }
-            last = entry;
-        }
-    }
-
-    if (last) {
-        SLIST_INSERT_AFTER(last, current, t_obj_list);
-    } else {
-        SLIST_INSERT_HEAD(&mu->mu_head, current, t_obj_list);
-    }
+    os_mutex_waiter_insert(mu, current);
 
     /* Set mutex pointer in task */
     current->t_obj = mu;
     current->t_flags |= OS_TASK_FLAG_MUTEX_WAIT;
+#if MYNEWT_VAL(OS_MUTEX_PRIO_CHAIN)
+    /* Boost the owner, and whatever it is blocked on in turn. */
+    os_mutex_prio_update(mu->mu_owner);
+#endif
     os_sched_sleep(current, timeout);
     OS_EXIT_CRITICAL(sr);
 
@@ -222,14 +343,18 @@ os_mutex_pend(struct os_mutex *mu, os_time_t timeout)
 
     OS_ENTER_CRITICAL(sr);
     current->t_flags &= ~OS_TASK_FLAG_MUTEX_WAIT;
-    OS_EXIT_CRITICAL(sr);
 
     /* If we are owner we did not time out. */
     if (mu->mu_owner == current) {
         ret = OS_OK;
     } else {
         ret = OS_TIMEOUT;
+#if MYNEWT_VAL(OS_MUTEX_PRIO_CHAIN)
+        /* We are no longer waiting; take back what we lent the owner. */
+        os_mutex_prio_update(mu->mu_owner);
+#endif
     }
+    OS_EXIT_CRITICAL(sr);
 
 done:
     os_trace_api_ret_u32(OS_TRACE_ID_MUTEX_PEND, (uint32_t)ret);
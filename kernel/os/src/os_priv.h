@@ -32,14 +32,56 @@ extern "C" {
 #define OS_RUN_UNPRIV       (1)
 
 extern struct os_task g_idle_task;
+#if !MYNEWT_VAL(OS_SCHED_PRIO_BITMAP)
 extern struct os_task_list g_os_run_list;
+#endif
 extern struct os_task_list g_os_sleep_list;
 extern struct os_task_stailq g_os_task_list;
+#if MYNEWT_VAL(OS_CALLOUT_WHEEL)
+extern struct os_callout_list g_callout_wheel[];
+#else
 extern struct os_callout_list g_callout_list;
+#endif
 
+void os_callout_module_init(void);
 void os_mempool_module_init(void);
+
+/* Adds an initialized mempool to the list reported by os_mempool_info. */
+void os_mempool_register(struct os_mempool *mp);
+
+/*
+ * os_memblock_get() and os_memblock_put() without allocation profiling, for
+ * allocators built on mempools that report their own objects.
+ */
+void *os_memblock_get_noprof(struct os_mempool *mp);
+os_error_t os_memblock_put_noprof(struct os_mempool *mp, void *block_addr);
+void os_heap_module_init(void);
 void os_msys_init(void);
 
+/*
+ * os_mbuf_get() and os_mbuf_get_pkthdr() with an explicit call site for the
+ * allocation profiler, so msys allocations are attributed to the caller of
+ * os_msys_get() rather than to os_msys.c.
+ */
+struct os_mbuf *os_mbuf_get_from(struct os_mbuf_pool *omp,
+                                 uint16_t leadingspace, const void *caller);
+struct os_mbuf *os_mbuf_get_pkthdr_from(struct os_mbuf_pool *omp,
+                                        uint8_t user_pkthdr_len,
+                                        const void *caller);
+
+#if MYNEWT_VAL(MSYS_QUOTA)
+/*
+ * Charges a consumer for an mbuf about to be allocated, and then tags the
+ * mbuf with the consumer or undoes the charge if the allocation failed.
+ */
+int os_msys_charge(struct os_msys_consumer *c);
+struct os_mbuf *os_msys_consumer_settle(struct os_msys_consumer *c,
+                                        struct os_mbuf *m);
+
+/* Uncharges a consumer for an mbuf that has been freed. */
+void os_msys_consumer_release(struct os_msys_consumer *c);
+#endif
+
 /**
  * Prints information about a crash to the console.  This functionality is
  * defined as a macro rather than a function to ensure that it gets inlined,
@@ -26,6 +26,92 @@ SLIST_HEAD(, os_sanity_check) g_os_sanity_check_list =
 
 struct os_mutex g_os_sanity_check_mu;
 
+#if MYNEWT_VAL(SANITY_DEADLINE_HEAP_SIZE) > 0
+/*
+ * Checks without a sanity function only need looking at once their
+ * deadline has passed, so they are kept in a min-heap on deadline
+ * instead of on the list.  A heap key is the deadline as of the last
+ * time the sanity task looked; checkins only ever move the real deadline
+ * later, so a stale key is just an early look.
+ */
+struct os_sanity_heap_entry {
+    os_time_t she_deadline;
+    struct os_sanity_check *she_sc;
+};
+
+static struct os_sanity_heap_entry
+    os_sanity_heap[MYNEWT_VAL(SANITY_DEADLINE_HEAP_SIZE)];
+static int os_sanity_heap_cnt;
+
+static void
+os_sanity_heap_sift_up(int idx)
+{
+    struct os_sanity_heap_entry tmp;
+    int parent;
+
+    tmp = os_sanity_heap[idx];
+    while (idx > 0) {
+        parent = (idx - 1) / 2;
+        if (!OS_TIME_TICK_LT(tmp.she_deadline,
+                             os_sanity_heap[parent].she_deadline)) {
+            break;
+        }
+        os_sanity_heap[idx] = os_sanity_heap[parent];
+        idx = parent;
+    }
+    os_sanity_heap[idx] = tmp;
+}
+
+static void
+os_sanity_heap_sift_down(int idx)
+{
+    struct os_sanity_heap_entry tmp;
+    int child;
+
+    tmp = os_sanity_heap[idx];
+    while ((child = 2 * idx + 1) < os_sanity_heap_cnt) {
+        if (child + 1 < os_sanity_heap_cnt &&
+            OS_TIME_TICK_LT(os_sanity_heap[child + 1].she_deadline,
+                            os_sanity_heap[child].she_deadline)) {
+            child++;
+        }
+        if (!OS_TIME_TICK_LT(os_sanity_heap[child].she_deadline,
+                             tmp.she_deadline)) {
+            break;
+        }
+        os_sanity_heap[idx] = os_sanity_heap[child];
+        idx = child;
+    }
+    os_sanity_heap[idx] = tmp;
+}
+
+/*
+ * Looks at the checks whose deadline has passed, earliest first.  Ones
+ * that checked in since are re-keyed; the first one that has not is
+ * returned, and stays at the top of the heap.
+ */
+static struct os_sanity_check *
+os_sanity_heap_run(os_time_t now)
+{
+    struct os_sanity_check *sc;
+    os_time_t deadline;
+
+    while (os_sanity_heap_cnt > 0 &&
+           OS_TIME_TICK_GT(now, os_sanity_heap[0].she_deadline)) {
+        sc = os_sanity_heap[0].she_sc;
+        deadline = sc->sc_checkin_last + sc->sc_checkin_itvl;
+        if (OS_TIME_TICK_GT(now, deadline)) {
+            return sc;
+        }
+
+        os_sanity_heap[0].she_deadline = deadline;
+        os_sanity_heap_sift_down(0);
+    }
+
+    return NULL;
+}
+#endif
+
 int
 os_sanity_check_init(struct os_sanity_check *sc)
 {
@@ -112,7 +198,18 @@ os_sanity_check_register(struct os_sanity_check *sc)
         goto err;
     }
 
-    SLIST_INSERT_HEAD(&g_os_sanity_check_list, sc, sc_next);
+#if MYNEWT_VAL(SANITY_DEADLINE_HEAP_SIZE) > 0
+    if (sc->sc_func == NULL &&
+        os_sanity_heap_cnt < MYNEWT_VAL(SANITY_DEADLINE_HEAP_SIZE)) {
+        os_sanity_heap[os_sanity_heap_cnt].she_sc = sc;
+        os_sanity_heap[os_sanity_heap_cnt].she_deadline =
+            sc->sc_checkin_last + sc->sc_checkin_itvl;
+        os_sanity_heap_sift_up(os_sanity_heap_cnt++);
+    } else
+#endif
+    {
+        SLIST_INSERT_HEAD(&g_os_sanity_check_list, sc, sc_next);
+    }
 
     rc = os_sanity_check_list_unlock();
     if (rc != OS_OK) {
@@ -125,37 +222,22 @@ err:
 }
 
 
+/*
+ * Checkins do not take the list lock: the timestamp is a single aligned
+ * word, and the sanity task only ever reads it.
+ */
 int
 os_sanity_check_reset(struct os_sanity_check *sc)
 {
-    int rc;
-
-    rc = os_sanity_check_list_lock();
-    if (rc != OS_OK) {
-        goto err;
-    }
-
     sc->sc_checkin_last = os_time_get();
 
-    rc = os_sanity_check_list_unlock();
-    if (rc != OS_OK) {
-        goto err;
-    }
-
     return (0);
-err:
-    return (rc);
 }
 
-/*
- * Called from the IDLE task context, every MYNEWT_VAL(SANITY_INTERVAL) msecs.
- *
- * Goes through the sanity check list, and performs sanity checks.  If any of
- * these checks failed, or tasks have not checked in, it resets the processor.
- */
-void
-os_sanity_run(void)
+struct os_sanity_check *
+os_sanity_run_at(os_time_t now)
 {
+    struct os_sanity_check *failed;
     struct os_sanity_check *sc;
     int rc;
 
@@ -164,27 +246,51 @@ os_sanity_run(void)
         assert(0);
     }
 
+    failed = NULL;
     SLIST_FOREACH(sc, &g_os_sanity_check_list, sc_next) {
         rc = OS_OK;
 
         if (sc->sc_func) {
             rc = sc->sc_func(sc, sc->sc_arg);
             if (rc == OS_OK) {
-                sc->sc_checkin_last = os_time_get();
+                sc->sc_checkin_last = now;
                 continue;
             }
         }
 
-        if (OS_TIME_TICK_GT(os_time_get(),
-                    sc->sc_checkin_last + sc->sc_checkin_itvl)) {
-            assert(0);
+        if (OS_TIME_TICK_GT(now, sc->sc_checkin_last + sc->sc_checkin_itvl)) {
+            failed = sc;
+            break;
         }
     }
 
+#if MYNEWT_VAL(SANITY_DEADLINE_HEAP_SIZE) > 0
+    if (failed == NULL) {
+        failed = os_sanity_heap_run(now);
+    }
+#endif
+
     rc = os_sanity_check_list_unlock();
     if (rc != 0) {
         assert(0);
     }
+
+    return failed;
+}
+
+/*
+ * Called from the IDLE task context, every MYNEWT_VAL(SANITY_INTERVAL) msecs.
+ *
+ * Goes through the sanity check list, and performs sanity checks.  If any of
+ * these checks failed, or tasks have not checked in, it resets the processor.
+ * Checks on the deadline heap are only looked at once their deadline passed.
+ */
+void
+os_sanity_run(void)
+{
+    if (os_sanity_run_at(os_time_get()) != NULL) {
+        assert(0);
+    }
 }
 
 int
@@ -192,6 +298,11 @@ os_sanity_init(void)
 {
     int rc;
 
+    SLIST_INIT(&g_os_sanity_check_list);
+#if MYNEWT_VAL(SANITY_DEADLINE_HEAP_SIZE) > 0
+    os_sanity_heap_cnt = 0;
+#endif
+
     rc = os_mutex_init(&g_os_sanity_check_mu);
     if (rc != 0) {
         goto err;
@@ -18,17 +18,315 @@
  */
 
 #include <assert.h>
+#include <string.h>
 #include "os/mynewt.h"
 #include "os_priv.h"
 
+#if MYNEWT_VAL(OS_SCHED_PRIO_BITMAP)
+/*
+ * Ready tasks are kept in one FIFO per priority level.  A bit is set in
+ * os_sched_prio_map for every non-empty level, and a bit in os_sched_prio_grp
+ * for every non-empty word of os_sched_prio_map.  Bits are stored MSB first
+ * so that the highest priority level can be located with two CLZ operations.
+ */
+#define OS_SCHED_PRIO_LEVELS    (OS_TASK_PRI_LOWEST + 1)
+#define OS_SCHED_PRIO_WORDS     (OS_SCHED_PRIO_LEVELS / 32)
+#define OS_SCHED_PRIO_BIT(idx)  (0x80000000UL >> ((idx) & 31))
+
+static struct os_task_list os_sched_prio_lists[OS_SCHED_PRIO_LEVELS];
+static uint32_t os_sched_prio_map[OS_SCHED_PRIO_WORDS];
+static uint32_t os_sched_prio_grp;
+
+/* Highest priority ready task; read by the arch context switch code. */
+struct os_task *g_os_run_top;
+#else
 struct os_task_list g_os_run_list = TAILQ_HEAD_INITIALIZER(g_os_run_list);
+#endif
 struct os_task_list g_os_sleep_list = TAILQ_HEAD_INITIALIZER(g_os_sleep_list);
 
+#if MYNEWT_VAL(OS_SCHED_SLEEP_HEAP)
+/*
+ * Sleeping tasks with a timeout are additionally kept in a binary min-heap
+ * ordered by wakeup time.  g_os_sleep_list holds every sleeping task in no
+ * particular order.
+ */
+#define OS_SCHED_SLEEP_HEAP_SIZE    MYNEWT_VAL(OS_SCHED_SLEEP_HEAP_SIZE)
+#define OS_SCHED_SLEEP_IDX_NONE     (0xff)
+
+#if OS_SCHED_SLEEP_HEAP_SIZE >= OS_SCHED_SLEEP_IDX_NONE
+#error "OS_SCHED_SLEEP_HEAP_SIZE must be less than 255"
+#endif
+
+static struct os_task *os_sched_sleep_heap[OS_SCHED_SLEEP_HEAP_SIZE];
+static uint8_t os_sched_sleep_heap_cnt;
+#endif
+
 struct os_task *g_current_task;
 
 extern os_time_t g_os_time;
 os_time_t g_os_last_ctx_sw_time;
 
+#if MYNEWT_VAL(OS_SCHED_PRIO_BITMAP)
+
+static struct os_task *
+os_sched_rdy_top(void)
+{
+    uint32_t word;
+    uint8_t prio;
+
+    if (os_sched_prio_grp == 0) {
+        return NULL;
+    }
+
+    word = __builtin_clz(os_sched_prio_grp);
+    prio = (word << 5) + __builtin_clz(os_sched_prio_map[word]);
+
+    return TAILQ_FIRST(&os_sched_prio_lists[prio]);
+}
+
+static void
+os_sched_rdy_insert(struct os_task *t)
+{
+    struct os_task_list *head;
+    uint8_t prio;
+
+    prio = t->t_prio;
+    head = &os_sched_prio_lists[prio];
+
+    if (!(os_sched_prio_map[prio >> 5] & OS_SCHED_PRIO_BIT(prio))) {
+        TAILQ_INIT(head);
+        os_sched_prio_map[prio >> 5] |= OS_SCHED_PRIO_BIT(prio);
+        os_sched_prio_grp |= OS_SCHED_PRIO_BIT(prio >> 5);
+    }
+    TAILQ_INSERT_TAIL(head, t, t_os_list);
+    t->t_rdy_prio = prio;
+
+    if (g_os_run_top == NULL || prio < g_os_run_top->t_rdy_prio) {
+        g_os_run_top = t;
+    }
+}
+
+static void
+os_sched_rdy_remove(struct os_task *t)
+{
+    struct os_task_list *head;
+    uint8_t prio;
+
+    /* The task is queued under the priority it had when it was inserted. */
+    prio = t->t_rdy_prio;
+    head = &os_sched_prio_lists[prio];
+
+    TAILQ_REMOVE(head, t, t_os_list);
+    if (TAILQ_EMPTY(head)) {
+        os_sched_prio_map[prio >> 5] &= ~OS_SCHED_PRIO_BIT(prio);
+        if (os_sched_prio_map[prio >> 5] == 0) {
+            os_sched_prio_grp &= ~OS_SCHED_PRIO_BIT(prio >> 5);
+        }
+    }
+
+    if (g_os_run_top == t) {
+        g_os_run_top = os_sched_rdy_top();
+    }
+}
+
+#else
+
+static void
+os_sched_rdy_insert(struct os_task *t)
+{
+    struct os_task *entry;
+
+    TAILQ_FOREACH(entry, &g_os_run_list, t_os_list) {
+        if (t->t_prio < entry->t_prio) {
+            break;
+        }
+    }
+    if (entry) {
+        TAILQ_INSERT_BEFORE(entry, (struct os_task *) t, t_os_list);
+    } else {
+        TAILQ_INSERT_TAIL(&g_os_run_list, (struct os_task *) t, t_os_list);
+    }
+}
+
+static void
+os_sched_rdy_remove(struct os_task *t)
+{
+    TAILQ_REMOVE(&g_os_run_list, t, t_os_list);
+}
+
+#endif
+
+#if MYNEWT_VAL(OS_SCHED_SLEEP_HEAP)
+
+static void
+os_sched_sleep_heap_set(int idx, struct os_task *t)
+{
+    os_sched_sleep_heap[idx] = t;
+    t->t_sleep_idx = idx;
+}
+
+static int
+os_sched_sleep_heap_up(int idx)
+{
+    struct os_task *t;
+    int parent;
+
+    t = os_sched_sleep_heap[idx];
+    while (idx > 0) {
+        parent = (idx - 1) / 2;
+        if (!OS_TIME_TICK_LT(t->t_next_wakeup,
+                             os_sched_sleep_heap[parent]->t_next_wakeup)) {
+            break;
+        }
+        os_sched_sleep_heap_set(idx, os_sched_sleep_heap[parent]);
+        idx = parent;
+    }
+    os_sched_sleep_heap_set(idx, t);
+
+    return idx;
+}
+
+static void
+os_sched_sleep_heap_down(int idx)
+{
+    struct os_task *t;
+    int child;
+
+    t = os_sched_sleep_heap[idx];
+    while (1) {
+        child = 2 * idx + 1;
+        if (child >= os_sched_sleep_heap_cnt) {
+            break;
+        }
+        if (child + 1 < os_sched_sleep_heap_cnt &&
+            OS_TIME_TICK_LT(os_sched_sleep_heap[child + 1]->t_next_wakeup,
+                            os_sched_sleep_heap[child]->t_next_wakeup)) {
+            child++;
+        }
+        if (!OS_TIME_TICK_LT(os_sched_sleep_heap[child]->t_next_wakeup,
+                             t->t_next_wakeup)) {
+            break;
+        }
+        os_sched_sleep_heap_set(idx, os_sched_sleep_heap[child]);
+        idx = child;
+    }
+    os_sched_sleep_heap_set(idx, t);
+}
+
+static void
+os_sched_slp_insert(struct os_task *t)
+{
+    TAILQ_INSERT_TAIL(&g_os_sleep_list, t, t_os_list);
+
+    if (t->t_flags & OS_TASK_FLAG_NO_TIMEOUT) {
+        t->t_sleep_idx = OS_SCHED_SLEEP_IDX_NONE;
+    } else {
+        assert(os_sched_sleep_heap_cnt < OS_SCHED_SLEEP_HEAP_SIZE);
+        os_sched_sleep_heap[os_sched_sleep_heap_cnt] = t;
+        os_sched_sleep_heap_up(os_sched_sleep_heap_cnt++);
+    }
+}
+
+static void
+os_sched_slp_remove(struct os_task *t)
+{
+    struct os_task *last;
+    int idx;
+
+    TAILQ_REMOVE(&g_os_sleep_list, t, t_os_list);
+
+    idx = t->t_sleep_idx;
+    if (idx == OS_SCHED_SLEEP_IDX_NONE) {
+        return;
+    }
+    t->t_sleep_idx = OS_SCHED_SLEEP_IDX_NONE;
+
+    /* Fill the hole with the last element and restore the heap property. */
+    last = os_sched_sleep_heap[--os_sched_sleep_heap_cnt];
+    if (last != t) {
+        os_sched_sleep_heap[idx] = last;
+        os_sched_sleep_heap_down(os_sched_sleep_heap_up(idx));
+    }
+}
+
+/* Returns the sleeping task that has the earliest wakeup time, if any. */
+static struct os_task *
+os_sched_slp_first(void)
+{
+    if (os_sched_sleep_heap_cnt == 0) {
+        return NULL;
+    }
+    return os_sched_sleep_heap[0];
+}
+
+#else
+
+static void
+os_sched_slp_insert(struct os_task *t)
+{
+    struct os_task *entry;
+
+    if (t->t_flags & OS_TASK_FLAG_NO_TIMEOUT) {
+        TAILQ_INSERT_TAIL(&g_os_sleep_list, t, t_os_list);
+        return;
+    }
+
+    TAILQ_FOREACH(entry, &g_os_sleep_list, t_os_list) {
+        if ((entry->t_flags & OS_TASK_FLAG_NO_TIMEOUT) ||
+                OS_TIME_TICK_GT(entry->t_next_wakeup, t->t_next_wakeup)) {
+            break;
+        }
+    }
+    if (entry) {
+        TAILQ_INSERT_BEFORE(entry, t, t_os_list);
+    } else {
+        TAILQ_INSERT_TAIL(&g_os_sleep_list, t, t_os_list);
+    }
+}
+
+static void
+os_sched_slp_remove(struct os_task *t)
+{
+    TAILQ_REMOVE(&g_os_sleep_list, t, t_os_list);
+}
+
+/* Returns the sleeping task that has the earliest wakeup time, if any. */
+static struct os_task *
+os_sched_slp_first(void)
+{
+    struct os_task *t;
+
+    t = TAILQ_FIRST(&g_os_sleep_list);
+    if (t == NULL || (t->t_flags & OS_TASK_FLAG_NO_TIMEOUT)) {
+        return NULL;
+    }
+    return t;
+}
+
+#endif
+
+/**
+ * os sched init
+ *
+ * Empties the run and sleep lists.  Only needed when the OS is restarted
+ * (e.g. by the sim environment); the lists are statically initialized.
+ */
+void
+os_sched_init(void)
+{
+#if MYNEWT_VAL(OS_SCHED_PRIO_BITMAP)
+    memset(os_sched_prio_map, 0, sizeof os_sched_prio_map);
+    os_sched_prio_grp = 0;
+    g_os_run_top = NULL;
+#else
+    TAILQ_INIT(&g_os_run_list);
+#endif
+    TAILQ_INIT(&g_os_sleep_list);
+#if MYNEWT_VAL(OS_SCHED_SLEEP_HEAP)
+    os_sched_sleep_heap_cnt = 0;
+#endif
+}
+
 /**
  * os sched insert
  *
@@ -43,7 +341,6 @@ os_time_t g_os_last_ctx_sw_time;
 os_error_t
 os_sched_insert(struct os_task *t)
 {
-    struct os_task *entry;
     os_sr_t sr;
     os_error_t rc;
 
@@ -52,18 +349,8 @@ os_sched_insert(struct os_task *t)
         goto err;
     }
 
-    entry = NULL;
     OS_ENTER_CRITICAL(sr);
-    TAILQ_FOREACH(entry, &g_os_run_list, t_os_list) {
-        if (t->t_prio < entry->t_prio) {
-            break;
-        }
-    }
-    if (entry) {
-        TAILQ_INSERT_BEFORE(entry, (struct os_task *) t, t_os_list);
-    } else {
-        TAILQ_INSERT_TAIL(&g_os_run_list, (struct os_task *) t, t_os_list);
-    }
+    os_sched_rdy_insert(t);
     OS_EXIT_CRITICAL(sr);
 
     return (0);
@@ -71,9 +358,77 @@ err:
     return (rc);
 }
 
+#if MYNEWT_VAL(OS_TASK_CPU_STATS)
+/** os_cputime at the last context switch. */
+static uint32_t os_sched_cpu_last;
+/** Interrupt time accumulated since the last context switch. */
+static uint32_t os_sched_isr_slice;
+/** os_cputime at which the outermost running interrupt started. */
+static uint32_t os_sched_isr_start;
+static uint8_t os_sched_isr_nest;
+static uint64_t os_sched_isr_time;
+static uint32_t os_sched_isr_cnt;
+
+/**
+ * Closes the interrupt interval that is in progress up to the given
+ * time.  Must be called with interrupts disabled.
+ */
+static void
+os_sched_isr_account(uint32_t now)
+{
+    uint32_t delta;
+
+    delta = now - os_sched_isr_start;
+    os_sched_isr_slice += delta;
+    os_sched_isr_time += delta;
+    os_sched_isr_start = now;
+}
+
+void
+os_sched_isr_enter(void)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    if (os_sched_isr_nest++ == 0) {
+        os_sched_isr_start = os_cputime_get32();
+    }
+    os_sched_isr_cnt++;
+    OS_EXIT_CRITICAL(sr);
+}
+
+void
+os_sched_isr_exit(void)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    if (os_sched_isr_nest > 0 && --os_sched_isr_nest == 0) {
+        os_sched_isr_account(os_cputime_get32());
+    }
+    OS_EXIT_CRITICAL(sr);
+}
+
+void
+os_cpu_stats_get(struct os_cpu_stats *ocs)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    ocs->ocs_isr_time = os_sched_isr_time;
+    ocs->ocs_idle_time = g_idle_task.t_cpu_time;
+    ocs->ocs_isr_cnt = os_sched_isr_cnt;
+    OS_EXIT_CRITICAL(sr);
+}
+#endif
+
 void
 os_sched_ctx_sw_hook(struct os_task *next_t)
 {
+#if MYNEWT_VAL(OS_TASK_CPU_STATS)
+    uint32_t now;
+    os_sr_t sr;
+#endif
 #if MYNEWT_VAL(OS_CTX_SW_STACK_CHECK)
     os_stack_t *top;
     int i;
@@ -82,10 +437,30 @@ os_sched_ctx_sw_hook(struct os_task *next_t)
     for (i = 0; i < MYNEWT_VAL(OS_CTX_SW_STACK_GUARD); i++) {
         assert(top[i] == OS_STACK_PATTERN);
     }
+#endif
+#if MYNEWT_VAL(OS_CTX_SW_STACK_SAMPLE)
+    /* The stack pointer saved when next_t was last switched out. */
+    if (next_t->t_stackptr < next_t->t_stack_low) {
+        next_t->t_stack_low = next_t->t_stackptr;
+    }
 #endif
     next_t->t_ctx_sw_cnt++;
     g_current_task->t_run_time += g_os_time - g_os_last_ctx_sw_time;
     g_os_last_ctx_sw_time = g_os_time;
+
+#if MYNEWT_VAL(OS_TASK_CPU_STATS)
+    OS_ENTER_CRITICAL(sr);
+    now = os_cputime_get32();
+    if (os_sched_isr_nest > 0) {
+        /* Switching from within an interrupt; charge it up to now. */
+        os_sched_isr_account(now);
+    }
+    g_current_task->t_cpu_time += (now - os_sched_cpu_last) -
+                                  os_sched_isr_slice;
+    os_sched_isr_slice = 0;
+    os_sched_cpu_last = now;
+    OS_EXIT_CRITICAL(sr);
+#endif
 }
 
 struct os_task *
@@ -141,29 +516,13 @@ os_sched(struct os_task *next_t)
 int
 os_sched_sleep(struct os_task *t, os_time_t nticks)
 {
-    struct os_task *entry;
-
-    entry = NULL;
-
-    TAILQ_REMOVE(&g_os_run_list, t, t_os_list);
+    os_sched_rdy_remove(t);
     t->t_state = OS_TASK_SLEEP;
     t->t_next_wakeup = os_time_get() + nticks;
     if (nticks == OS_TIMEOUT_NEVER) {
         t->t_flags |= OS_TASK_FLAG_NO_TIMEOUT;
-        TAILQ_INSERT_TAIL(&g_os_sleep_list, t, t_os_list);
-    } else {
-        TAILQ_FOREACH(entry, &g_os_sleep_list, t_os_list) {
-            if ((entry->t_flags & OS_TASK_FLAG_NO_TIMEOUT) ||
-                    OS_TIME_TICK_GT(entry->t_next_wakeup, t->t_next_wakeup)) {
-                break;
-            }
-        }
-        if (entry) {
-            TAILQ_INSERT_BEFORE(entry, t, t_os_list);
-        } else {
-            TAILQ_INSERT_TAIL(&g_os_sleep_list, t, t_os_list);
-        }
     }
+    os_sched_slp_insert(t);
 
     os_trace_task_stop_ready(t, OS_TASK_SLEEP);
     return (0);
@@ -187,9 +546,9 @@ os_sched_remove(struct os_task *t)
 {
 
     if (t->t_state == OS_TASK_SLEEP) {
-        TAILQ_REMOVE(&g_os_sleep_list, t, t_os_list);
+        os_sched_slp_remove(t);
     } else if (t->t_state == OS_TASK_READY) {
-        TAILQ_REMOVE(&g_os_run_list, t, t_os_list);
+        os_sched_rdy_remove(t);
     }
     t->t_next_wakeup = 0;
     t->t_flags |= OS_TASK_FLAG_NO_TIMEOUT;
@@ -229,10 +588,10 @@ os_sched_wakeup(struct os_task *t)
     }
 
     /* Remove task from sleep list */
+    os_sched_slp_remove(t);
     t->t_state = OS_TASK_READY;
     t->t_next_wakeup = 0;
     t->t_flags &= ~OS_TASK_FLAG_NO_TIMEOUT;
-    TAILQ_REMOVE(&g_os_sleep_list, t, t_os_list);
     os_sched_insert(t);
 
     os_trace_task_start_ready(t);
@@ -253,7 +612,6 @@ void
 os_sched_os_timer_exp(void)
 {
     struct os_task *t;
-    struct os_task *next;
     os_time_t now;
     os_sr_t sr;
 
@@ -264,19 +622,12 @@ os_sched_os_timer_exp(void)
     /*
      * Wakeup any tasks that have their sleep timer expired
      */
-    t = TAILQ_FIRST(&g_os_sleep_list);
-    while (t) {
-        /* If task waiting forever, do not check next wakeup time */
-        if (t->t_flags & OS_TASK_FLAG_NO_TIMEOUT) {
-            break;
-        }
-        next = TAILQ_NEXT(t, t_os_list);
+    while ((t = os_sched_slp_first()) != NULL) {
         if (OS_TIME_TICK_GEQ(now, t->t_next_wakeup)) {
             os_sched_wakeup(t);
         } else {
             break;
         }
-        t = next;
     }
 
     OS_EXIT_CRITICAL(sr);
@@ -294,8 +645,8 @@ os_sched_wakeup_ticks(os_time_t now)
 
     OS_ASSERT_CRITICAL();
 
-    t = TAILQ_FIRST(&g_os_sleep_list);
-    if (t == NULL || (t->t_flags & OS_TASK_FLAG_NO_TIMEOUT)) {
+    t = os_sched_slp_first();
+    if (t == NULL) {
         rt = OS_TIMEOUT_NEVER;
     } else if (OS_TIME_TICK_GEQ(t->t_next_wakeup, now)) {
         rt = t->t_next_wakeup - now;
@@ -319,7 +670,11 @@ os_sched_wakeup_ticks(os_time_t now)
 struct os_task *
 os_sched_next_task(void)
 {
+#if MYNEWT_VAL(OS_SCHED_PRIO_BITMAP)
+    return (g_os_run_top);
+#else
     return (TAILQ_FIRST(&g_os_run_list));
+#endif
 }
 
 /**
@@ -339,7 +694,7 @@ void
 os_sched_resort(struct os_task *t)
 {
     if (t->t_state == OS_TASK_READY) {
-        TAILQ_REMOVE(&g_os_run_list, t, t_os_list);
-        os_sched_insert(t);
+        os_sched_rdy_remove(t);
+        os_sched_rdy_insert(t);
     }
 }
@@ -72,6 +72,9 @@ os_task_init(struct os_task *t, const char *name, os_task_func_t func,
 
     t->t_taskid = os_task_next_id();
     t->t_prio = prio;
+#if MYNEWT_VAL(OS_MUTEX_PRIO_CHAIN)
+    t->t_base_prio = prio;
+#endif
 
     t->t_state = OS_TASK_READY;
     t->t_name = name;
@@ -97,6 +100,9 @@ os_task_init(struct os_task *t, const char *name, os_task_func_t func,
     t->t_stacksize = stack_size;
     t->t_stackptr = os_arch_task_stack_init(t, t->t_stacktop,
             t->t_stacksize);
+#if MYNEWT_VAL(OS_CTX_SW_STACK_SAMPLE)
+    t->t_stack_low = t->t_stackptr;
+#endif
 
     STAILQ_FOREACH(task, &g_os_task_list, t_os_task_list) {
         assert(t->t_prio != task->t_prio);
@@ -173,7 +179,9 @@ struct os_task *
 os_task_info_get_next(const struct os_task *prev, struct os_task_info *oti)
 {
     struct os_task *next;
+#if !MYNEWT_VAL(OS_CTX_SW_STACK_SAMPLE)
     os_stack_t *top;
+#endif
     os_stack_t *bottom;
 
     if (prev != NULL) {
@@ -193,6 +201,9 @@ os_task_info_get_next(const struct os_task *prev, struct os_task_info *oti)
     oti->oti_taskid = next->t_taskid;
     oti->oti_state = next->t_state;
 
+#if MYNEWT_VAL(OS_CTX_SW_STACK_SAMPLE)
+    bottom = next->t_stack_low;
+#else
     top = next->t_stacktop;
     bottom = next->t_stacktop - next->t_stacksize;
     while (bottom < top) {
@@ -201,11 +212,15 @@ os_task_info_get_next(const struct os_task *prev, struct os_task_info *oti)
         }
         ++bottom;
     }
+#endif
 
     oti->oti_stkusage = (uint16_t) (next->t_stacktop - bottom);
     oti->oti_stksize = next->t_stacksize;
     oti->oti_cswcnt = next->t_ctx_sw_cnt;
     oti->oti_runtime = next->t_run_time;
+#if MYNEWT_VAL(OS_TASK_CPU_STATS)
+    oti->oti_cputime = next->t_cpu_time;
+#endif
     oti->oti_last_checkin = next->t_sanity_check.sc_checkin_last;
     oti->oti_next_checkin = next->t_sanity_check.sc_checkin_last +
         next->t_sanity_check.sc_checkin_itvl;
@@ -48,6 +48,19 @@ void sim_restore_sr(os_sr_t osr);
 int sim_in_critical(void);
 void sim_tick_idle(os_time_t ticks);
 
+/**
+ * Sets the function that runs, in interrupt context, after a host thread
+ * calls sim_io_signal().  This lets drivers block on host file descriptors
+ * in a pthread of their own instead of polling from a task.
+ */
+void sim_io_handler_set(void (*handler)(void));
+
+/**
+ * Raises a simulated I/O interrupt.  Safe to call from any host thread; the
+ * thread must keep all signals blocked.
+ */
+void sim_io_signal(void);
+
 /**
  * Prints information about a crash to stdout.  This functionality is defined
  * as a macro rather than a function to ensure that it gets inlined, enforcing
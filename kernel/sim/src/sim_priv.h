@@ -31,6 +31,7 @@ extern "C" {
 
 void sim_switch_tasks(void);
 void sim_tick(void);
+void sim_io(void);
 void sim_signals_init(void);
 void sim_signals_cleanup(void);
 
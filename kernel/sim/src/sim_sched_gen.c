@@ -45,6 +45,8 @@
 
 pid_t sim_pid;
 
+static void (*sim_io_handler)(void);
+
 void
 sim_switch_tasks(void)
 {
@@ -81,6 +83,16 @@ sim_switch_tasks(void)
     sim_longjmp(sf->sf_jb, 1);
 }
 
+#if MYNEWT_VAL(MCU_NATIVE_TIME_FAST_FORWARD)
+void
+sim_tick(void)
+{
+    OS_ASSERT_CRITICAL();
+
+    /* Host time does not count; each timer signal is one tick. */
+    os_time_advance(1);
+}
+#else
 void
 sim_tick(void)
 {
@@ -120,7 +132,31 @@ sim_tick(void)
         os_time_advance(ticks);
     }
 }
+#endif
+
+void
+sim_io_handler_set(void (*handler)(void))
+{
+    sim_io_handler = handler;
+}
+
+void
+sim_io_signal(void)
+{
+    kill(sim_pid, SIGIO);
+}
+
+void
+sim_io(void)
+{
+    OS_ASSERT_CRITICAL();
+
+    if (sim_io_handler) {
+        sim_io_handler();
+    }
+}
 
+#if !MYNEWT_VAL(MCU_NATIVE_VIRTUAL_TIME)
 static void
 sim_start_timer(void)
 {
@@ -148,6 +184,7 @@ sim_stop_timer(void)
     rc = setitimer(ITIMER_REAL, &it, NULL);
     assert(rc == 0);
 }
+#endif
 
 /*
  * Called from 'os_arch_frame_init()' when setjmp returns indirectly via
@@ -202,8 +239,10 @@ sim_os_start(void)
     OS_ENTER_CRITICAL(sr);
     assert(sr == 0);
 
+#if !MYNEWT_VAL(MCU_NATIVE_VIRTUAL_TIME)
     /* Enable the interrupt sources */
     sim_start_timer();
+#endif
 
     t = os_sched_next_task();
     os_sched_set_current_task(t);
@@ -223,7 +262,9 @@ sim_os_start(void)
 void
 sim_os_stop(void)
 {
+#if !MYNEWT_VAL(MCU_NATIVE_VIRTUAL_TIME)
     sim_stop_timer();
+#endif
     sim_signals_cleanup();
     g_os_started = 0;
 }
@@ -235,8 +276,7 @@ sim_os_init(void)
     g_current_task = NULL;
 
     STAILQ_INIT(&g_os_task_list);
-    TAILQ_INIT(&g_os_run_list);
-    TAILQ_INIT(&g_os_sleep_list);
+    os_sched_init();
 
     sim_signals_init();
 
@@ -28,6 +28,11 @@
  *
  * To use this version of sim, disable the MCU_NATIVE_USE_SIGNALS syscfg
  * setting.
+ *
+ * With MCU_NATIVE_VIRTUAL_TIME, there is no tick timer at all: OS time only
+ * moves when the idle task sleeps, by the number of ticks slept.  With
+ * MCU_NATIVE_TIME_FAST_FORWARD as well, the idle task does not sleep but
+ * jumps OS time to its deadline.
  */
 
 #include "os/mynewt.h"
@@ -46,6 +51,8 @@
 #include <setjmp.h>
 #include <signal.h>
 #include <sys/time.h>
+#include <sys/select.h>
+#include <time.h>
 #include <assert.h>
 #include "sim_priv.h"
 
@@ -55,6 +62,12 @@ static sigset_t suspsigs;   /* signals delivered in sigsuspend() */
 static int ctx_sw_pending;
 static int interrupts_enabled = 1;
 
+#if MYNEWT_VAL(MCU_NATIVE_VIRTUAL_TIME) && \
+    !MYNEWT_VAL(MCU_NATIVE_TIME_FAST_FORWARD)
+/* Microseconds slept beyond the last whole tick. */
+static uint32_t idle_usecs;
+#endif
+
 void
 sim_ctx_sw(struct os_task *next_t)
 {
@@ -112,8 +125,10 @@ sim_in_critical(void)
     return !interrupts_enabled;
 }
 
+#if !MYNEWT_VAL(MCU_NATIVE_VIRTUAL_TIME)
 /**
- * Unblocks the SIGALRM signal that is delivered by the OS tick timer.
+ * Unblocks the SIGALRM signal that is delivered by the OS tick timer, and
+ * the SIGIO raised by sim_io_signal().
  */
 static void
 unblock_timer(void)
@@ -123,13 +138,16 @@ unblock_timer(void)
 
     sigemptyset(&sigs);
     sigaddset(&sigs, SIGALRM);
+    sigaddset(&sigs, SIGIO);
 
     rc = sigprocmask(SIG_UNBLOCK, &sigs, NULL);
     assert(rc == 0);
 }
+#endif
 
 /**
- * Blocks the SIGALRM signal that is delivered by the OS tick timer.
+ * Blocks the SIGALRM signal that is delivered by the OS tick timer, and
+ * SIGIO.
  */
 static void
 block_timer(void)
@@ -139,6 +157,7 @@ block_timer(void)
 
     sigemptyset(&sigs);
     sigaddset(&sigs, SIGALRM);
+    sigaddset(&sigs, SIGIO);
 
     rc = sigprocmask(SIG_BLOCK, &sigs, NULL);
     assert(rc == 0);
@@ -151,6 +170,79 @@ sig_handler_alrm(int sig)
     sigaddset(&suspsigs, sig);
 }
 
+#if MYNEWT_VAL(MCU_NATIVE_VIRTUAL_TIME) && \
+    MYNEWT_VAL(MCU_NATIVE_TIME_FAST_FORWARD)
+void
+sim_tick_idle(os_time_t ticks)
+{
+    struct timespec ts;
+
+    OS_ASSERT_CRITICAL();
+
+    if (ticks == 0) {
+        ticks = 1;
+    }
+
+    /* Takes any pending host I/O, then jumps to the deadline. */
+    memset(&ts, 0, sizeof(ts));
+    sigemptyset(&suspsigs);
+    pselect(0, NULL, NULL, NULL, &ts, &nosigs);
+
+    os_time_advance(ticks);
+
+    if (sigismember(&suspsigs, SIGIO)) {
+        sim_io();
+    }
+}
+#elif MYNEWT_VAL(MCU_NATIVE_VIRTUAL_TIME)
+static uint64_t
+sim_host_usecs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+void
+sim_tick_idle(os_time_t ticks)
+{
+    struct timespec ts;
+    uint64_t start;
+    uint64_t slept;
+    uint64_t usecs;
+    int rc;
+
+    OS_ASSERT_CRITICAL();
+
+    if (ticks == 0) {
+        /* The next deadline is too close to sleep for; wait one tick. */
+        ticks = 1;
+    }
+
+    usecs = (uint64_t)ticks * OS_USEC_PER_TICK - idle_usecs;
+    ts.tv_sec = usecs / 1000000;
+    ts.tv_nsec = (usecs % 1000000) * 1000;
+
+    /* Sleeps with SIGIO unblocked, so host I/O can cut the sleep short. */
+    sigemptyset(&suspsigs);
+    start = sim_host_usecs();
+    rc = pselect(0, NULL, NULL, NULL, &ts, &nosigs);
+    if (rc == 0) {
+        slept = usecs;
+    } else {
+        slept = min(sim_host_usecs() - start, usecs);
+    }
+
+    slept += idle_usecs;
+    idle_usecs = slept % OS_USEC_PER_TICK;
+    os_time_advance(slept / OS_USEC_PER_TICK);
+
+    if (sigismember(&suspsigs, SIGIO)) {
+        sim_io();
+    }
+}
+#else
 void
 sim_tick_idle(os_time_t ticks)
 {
@@ -187,6 +279,9 @@ sim_tick_idle(os_time_t ticks)
     if (sigismember(&suspsigs, SIGALRM)) {
         sim_tick();
     }
+    if (sigismember(&suspsigs, SIGIO)) {
+        sim_io();
+    }
 
     if (ticks > 0) {
         /*
@@ -200,6 +295,7 @@ sim_tick_idle(os_time_t ticks)
         assert(rc == 0);
     }
 }
+#endif
 
 void
 sim_signals_init(void)
@@ -214,6 +310,7 @@ sim_signals_init(void)
 
     sigemptyset(&sigset_alrm);
     sigaddset(&sigset_alrm, SIGALRM);
+    sigaddset(&sigset_alrm, SIGIO);
 
     memset(&sa, 0, sizeof sa);
     sa.sa_handler = sig_handler_alrm;
@@ -221,6 +318,8 @@ sim_signals_init(void)
     sa.sa_flags = SA_RESTART;
     error = sigaction(SIGALRM, &sa, NULL);
     assert(error == 0);
+    error = sigaction(SIGIO, &sa, NULL);
+    assert(error == 0);
 }
 
 void
@@ -233,6 +332,8 @@ sim_signals_cleanup(void)
     sa.sa_handler = SIG_DFL;
     error = sigaction(SIGALRM, &sa, NULL);
     assert(error == 0);
+    error = sigaction(SIGIO, &sa, NULL);
+    assert(error == 0);
 }
 
 #endif /* !MYNEWT_VAL(MCU_NATIVE_USE_SIGNALS) */
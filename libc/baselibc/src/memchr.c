@@ -4,11 +4,29 @@
 
 #include <stddef.h>
 #include <string.h>
+#include "swar.h"
 
 void *memchr(const void *s, int c, size_t n)
 {
 	const unsigned char *sp = s;
+	const swar_word_t *w;
+	swar_word_t cc = SWAR_REPEAT(c);
 
+	while (n && !SWAR_ALIGNED(sp)) {
+		if (*sp == (unsigned char)c)
+			return (void *)sp;
+		sp++;
+		n--;
+	}
+
+	/* Skip whole words that do not contain c. */
+	w = (const swar_word_t *)sp;
+	while (n >= SWAR_WSIZE && !SWAR_HAS_ZERO(*w ^ cc)) {
+		w++;
+		n -= SWAR_WSIZE;
+	}
+
+	sp = (const unsigned char *)w;
 	while (n--) {
 		if (*sp == (unsigned char)c)
 			return (void *)sp;
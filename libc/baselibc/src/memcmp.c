@@ -3,6 +3,13 @@
  */
 
 #include <string.h>
+#include <stdint.h>
+
+/* Machine word, allowed to alias the caller's buffers. */
+typedef uintptr_t __attribute__((__may_alias__)) memcmp_word_t;
+
+#define WSIZE   sizeof(memcmp_word_t)
+#define WMASK   (WSIZE - 1)
 
 int memcmp(const void *s1, const void *s2, size_t n)
 {
@@ -44,6 +51,25 @@ int memcmp(const void *s1, const void *s2, size_t n)
 #else
 	const unsigned char *c1 = s1, *c2 = s2;
 
+	/*
+	 * Skip equal words while both sides are word aligned; the bytes of
+	 * the first word that differs are then compared one by one below.
+	 */
+	if ((((uintptr_t)c1 ^ (uintptr_t)c2) & WMASK) == 0) {
+		while (n && ((uintptr_t)c1 & WMASK)) {
+			d = (int)*c1++ - (int)*c2++;
+			if (d)
+				return d;
+			n--;
+		}
+		while (n >= WSIZE &&
+		       *(const memcmp_word_t *)c1 == *(const memcmp_word_t *)c2) {
+			c1 += WSIZE;
+			c2 += WSIZE;
+			n -= WSIZE;
+		}
+	}
+
 	while (n--) {
 		d = (int)*c1++ - (int)*c2++;
 		if (d)
@@ -5,6 +5,12 @@
 #include <string.h>
 #include <stdint.h>
 
+/* Machine word, allowed to alias the caller's buffers. */
+typedef uintptr_t __attribute__((__may_alias__)) memcpy_word_t;
+
+#define WSIZE   sizeof(memcpy_word_t)
+#define WMASK   (WSIZE - 1)
+
 void *memcpy(void *dst, const void *src, size_t n)
 {
 	const char *p = src;
@@ -19,14 +25,14 @@ void *memcpy(void *dst, const void *src, size_t n)
 	asm volatile ("cld ; rep ; movsq ; movl %3,%%ecx ; rep ; movsb":"+c"
 		      (nq), "+S"(p), "+D"(q)
 		      :"r"((uint32_t) (n & 7)));
-#elif defined(__arm__)
+#elif defined(__arm__) && defined(__ARM_FEATURE_UNALIGNED)
         (void)p;
         (void)q;
 
-#if defined(__ARM_FEATURE_UNALIGNED)
         /*
          * We can speed up a bit by moving 32-bit words if unaligned access is
-         * supported (e.g. Cortex-M3/4/7/33).
+         * supported (e.g. Cortex-M3/4/7/33).  Cores without it (Cortex-M0/M0+)
+         * use the aligned word copy below.
          */
         asm (".syntax unified           \n"
              "       b    test1         \n"
@@ -36,7 +42,6 @@ void *memcpy(void *dst, const void *src, size_t n)
              "       bpl  loop1         \n"
              "       add  r2, #4        \n"
             );
-#endif
 
         asm (".syntax unified           \n"
              "       b    test2         \n"
@@ -46,6 +51,35 @@ void *memcpy(void *dst, const void *src, size_t n)
              "       bpl  loop2         \n"
             );
 #else
+	/*
+	 * Words can only be moved if source and destination line up on the
+	 * same word boundary; copy bytes up to it, then four words per
+	 * round.
+	 */
+	if ((((uintptr_t)p ^ (uintptr_t)q) & WMASK) == 0) {
+		while (n && ((uintptr_t)q & WMASK)) {
+			*q++ = *p++;
+			n--;
+		}
+		while (n >= 4 * WSIZE) {
+			const memcpy_word_t *ws = (const memcpy_word_t *)p;
+			memcpy_word_t *wd = (memcpy_word_t *)q;
+
+			wd[0] = ws[0];
+			wd[1] = ws[1];
+			wd[2] = ws[2];
+			wd[3] = ws[3];
+			p += 4 * WSIZE;
+			q += 4 * WSIZE;
+			n -= 4 * WSIZE;
+		}
+		while (n >= WSIZE) {
+			*(memcpy_word_t *)q = *(const memcpy_word_t *)p;
+			p += WSIZE;
+			q += WSIZE;
+			n -= WSIZE;
+		}
+	}
 	while (n--) {
 		*q++ = *p++;
 	}
@@ -9,6 +9,12 @@
 #include <mcu/cmsis_nvic.h>
 #endif
 
+/* Machine word, allowed to alias the caller's buffer. */
+typedef uintptr_t __attribute__((__may_alias__)) memset_word_t;
+
+#define WSIZE   sizeof(memset_word_t)
+#define WMASK   (WSIZE - 1)
+
 void *memset(void *dst, int c, size_t n)
 {
 	char *q = dst;
@@ -67,6 +73,28 @@ void *memset(void *dst, int c, size_t n)
                   : "r3", "r4", "memory"
                  );
 #else
+	/* The byte in every lane of a word: 0x01010101 * c. */
+	memset_word_t w = (UINTPTR_MAX / 0xff) * (unsigned char)c;
+
+	while (n && ((uintptr_t)q & WMASK)) {
+		*q++ = c;
+		n--;
+	}
+	while (n >= 4 * WSIZE) {
+		memset_word_t *wd = (memset_word_t *)q;
+
+		wd[0] = w;
+		wd[1] = w;
+		wd[2] = w;
+		wd[3] = w;
+		q += 4 * WSIZE;
+		n -= 4 * WSIZE;
+	}
+	while (n >= WSIZE) {
+		*(memset_word_t *)q = w;
+		q += WSIZE;
+		n -= WSIZE;
+	}
 	while (n--) {
 		*q++ = c;
 	}
@@ -1,46 +1,136 @@
 /*
  * qsort.c
  *
- * This is actually combsort.  It's an O(n log n) algorithm with
- * simplicity/small code size being its main virtue.
+ * Introsort: median-of-three quicksort that falls back to heapsort when
+ * the recursion gets too deep, and leaves short ranges to insertion
+ * sort.  O(n log n) in the worst case, with the stack bounded by
+ * recursing into the smaller partition only.
  */
 
 #include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
 
-static inline size_t newgap(size_t gap)
+/* Ranges this short are finished by insertion sort. */
+#define QSORT_INSERTION_MAX	8
+
+typedef int (*qsort_cmp_t)(const void *, const void *);
+
+static void qsort_insertion(char *base, size_t nmemb, size_t size,
+			    qsort_cmp_t compar)
 {
-	gap = (gap * 10) / 13;
-	if (gap == 9 || gap == 10)
-		gap = 11;
+	char *p1, *p2;
+	size_t i;
 
-	if (gap < 1)
-		gap = 1;
-	return gap;
+	for (i = 1; i < nmemb; i++) {
+		for (p1 = base + i * size; p1 > base; p1 = p2) {
+			p2 = p1 - size;
+			if (compar(p2, p1) <= 0)
+				break;
+			memswap(p1, p2, size);
+		}
+	}
 }
 
-void qsort(void *base, size_t nmemb, size_t size,
-	   int (*compar) (const void *, const void *))
+static void qsort_sift(char *base, size_t root, size_t nmemb, size_t size,
+		       qsort_cmp_t compar)
 {
-	size_t gap = nmemb;
-	size_t i, j;
-	char *p1, *p2;
-	int swapped;
+	size_t child;
+
+	while ((child = 2 * root + 1) < nmemb) {
+		if (child + 1 < nmemb &&
+		    compar(base + child * size, base + (child + 1) * size) < 0)
+			child++;
+		if (compar(base + root * size, base + child * size) >= 0)
+			break;
+		memswap(base + root * size, base + child * size, size);
+		root = child;
+	}
+}
+
+static void qsort_heap(char *base, size_t nmemb, size_t size,
+		       qsort_cmp_t compar)
+{
+	size_t i;
+
+	for (i = nmemb / 2; i > 0; i--)
+		qsort_sift(base, i - 1, nmemb, size, compar);
+
+	for (i = nmemb - 1; i > 0; i--) {
+		memswap(base, base + i * size, size);
+		qsort_sift(base, 0, i, size, compar);
+	}
+}
 
-	if (!nmemb)
-		return;
+static void qsort_intro(char *base, size_t nmemb, size_t size,
+			qsort_cmp_t compar, int depth)
+{
+	char *lo, *mid, *hi, *pi, *pj;
+
+	while (nmemb > QSORT_INSERTION_MAX) {
+		if (depth-- == 0) {
+			qsort_heap(base, nmemb, size, compar);
+			return;
+		}
 
-	do {
-		gap = newgap(gap);
-		swapped = 0;
+		/*
+		 * Order the first, middle and last elements, then move the
+		 * median to the front as the pivot.  The last element is now
+		 * no smaller than the pivot, and the pivot itself no larger,
+		 * so both scans below stop without bounds checks.
+		 */
+		lo = base;
+		mid = base + (nmemb / 2) * size;
+		hi = base + (nmemb - 1) * size;
+		if (compar(mid, lo) < 0)
+			memswap(mid, lo, size);
+		if (compar(hi, mid) < 0) {
+			memswap(hi, mid, size);
+			if (compar(mid, lo) < 0)
+				memswap(mid, lo, size);
+		}
+		memswap(lo, mid, size);
 
-		for (i = 0, p1 = base; i < nmemb - gap; i++, p1 += size) {
-			j = i + gap;
-			if (compar(p1, p2 = (char *)base + j * size) > 0) {
-				memswap(p1, p2, size);
-				swapped = 1;
-			}
+		pi = lo + size;
+		pj = hi;
+		while (1) {
+			while (compar(pi, lo) < 0)
+				pi += size;
+			while (compar(lo, pj) < 0)
+				pj -= size;
+			if (pi >= pj)
+				break;
+			memswap(pi, pj, size);
+			pi += size;
+			pj -= size;
 		}
-	} while (gap > 1 || swapped);
+		memswap(lo, pj, size);
+
+		/* Sort the smaller side first; loop on the larger one. */
+		if (pj - base < hi - pj) {
+			qsort_intro(base, (pj - base) / size, size, compar,
+				    depth);
+			nmemb -= (pj - base) / size + 1;
+			base = pj + size;
+		} else {
+			qsort_intro(pj + size, (hi - pj) / size, size, compar,
+				    depth);
+			nmemb = (pj - base) / size;
+		}
+	}
+
+	qsort_insertion(base, nmemb, size, compar);
+}
+
+void qsort(void *base, size_t nmemb, size_t size,
+	   int (*compar) (const void *, const void *))
+{
+	size_t n;
+	int depth = 0;
+
+	/* Heapsort takes over below 2 * log2(nmemb) levels. */
+	for (n = nmemb; n > 1; n >>= 1)
+		depth += 2;
+
+	qsort_intro(base, nmemb, size, compar, depth);
 }
@@ -3,9 +3,27 @@
  */
 
 #include <string.h>
+#include "swar.h"
 
 char *strchr(const char *s, int c)
 {
+	const swar_word_t *w;
+	swar_word_t cc = SWAR_REPEAT(c);
+
+	while (!SWAR_ALIGNED(s)) {
+		if (*s == (char)c)
+			return (char *)s;
+		if (!*s)
+			return NULL;
+		s++;
+	}
+
+	/* Skip whole words holding neither c nor the terminator. */
+	w = (const swar_word_t *)s;
+	while (!SWAR_HAS_ZERO(*w) && !SWAR_HAS_ZERO(*w ^ cc))
+		w++;
+
+	s = (const char *)w;
 	while (*s != (char)c) {
 		if (!*s)
 			return NULL;
@@ -3,14 +3,38 @@
  */
 
 #include <string.h>
+#include "swar.h"
 
 int strcmp(const char *s1, const char *s2)
 {
 	const unsigned char *c1 = (const unsigned char *)s1;
 	const unsigned char *c2 = (const unsigned char *)s2;
+	const swar_word_t *w1, *w2;
 	unsigned char ch;
 	int d = 0;
 
+	/*
+	 * When both strings share an alignment, skip words that are equal
+	 * and hold no terminator; the byte loop then finds the difference
+	 * or the end within the next word.
+	 */
+	if ((((uintptr_t)c1 ^ (uintptr_t)c2) & SWAR_WMASK) == 0) {
+		while (!SWAR_ALIGNED(c1)) {
+			d = (int)(ch = *c1++) - (int)*c2++;
+			if (d || !ch)
+				return d;
+		}
+
+		w1 = (const swar_word_t *)c1;
+		w2 = (const swar_word_t *)c2;
+		while (*w1 == *w2 && !SWAR_HAS_ZERO(*w1)) {
+			w1++;
+			w2++;
+		}
+		c1 = (const unsigned char *)w1;
+		c2 = (const unsigned char *)w2;
+	}
+
 	while (1) {
 		d = (int)(ch = *c1++) - (int)*c2++;
 		if (d || !ch)
@@ -3,10 +3,25 @@
  */
 
 #include <string.h>
+#include "swar.h"
 
 size_t strlen(const char *s)
 {
 	const char *ss = s;
+	const swar_word_t *w;
+
+	while (!SWAR_ALIGNED(ss)) {
+		if (!*ss)
+			return ss - s;
+		ss++;
+	}
+
+	/* Skip whole words until one contains the terminator. */
+	w = (const swar_word_t *)ss;
+	while (!SWAR_HAS_ZERO(*w))
+		w++;
+
+	ss = (const char *)w;
 	while (*ss)
 		ss++;
 	return ss - s;
@@ -0,0 +1,37 @@
+/*
+ * swar.h
+ *
+ * Word-at-a-time helpers for the string functions
+ */
+
+#ifndef SWAR_H
+#define SWAR_H
+
+#include <stdint.h>
+
+/*
+ * A machine word, allowed to alias the character data it is read from.
+ * Reads are always word aligned, so they never cross into the next
+ * word (or page, or MPU region) past the end of a string.
+ */
+typedef uintptr_t __attribute__((__may_alias__)) swar_word_t;
+
+#define SWAR_WSIZE	sizeof(swar_word_t)
+#define SWAR_WMASK	(SWAR_WSIZE - 1)
+
+/* 0x01 and 0x80 in every byte of a word. */
+#define SWAR_ONES	(UINTPTR_MAX / 0xff)
+#define SWAR_HIGHS	(SWAR_ONES << 7)
+
+/* The byte c repeated in every byte of a word. */
+#define SWAR_REPEAT(c)	(SWAR_ONES * (unsigned char)(c))
+
+/*
+ * Nonzero if any byte of w is zero.  Exact for the "any" question; only
+ * which byte it was needs a byte loop afterwards.
+ */
+#define SWAR_HAS_ZERO(w)	(((w) - SWAR_ONES) & ~(w) & SWAR_HIGHS)
+
+#define SWAR_ALIGNED(p)	(((uintptr_t)(p) & SWAR_WMASK) == 0)
+
+#endif
@@ -65,6 +65,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <stdio.h>
 #include <inttypes.h>
 #include <limits.h>
+#include <string.h>
 
 #include "os/mynewt.h"
 
@@ -79,23 +80,66 @@ struct param {
     char *bf;           /**<  Buffer to output */
 };
 
+/* "00" to "99", for converting two decimal digits per division. */
+static const char digit_pairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
 static void ui2a(unsigned long long int num, struct param *p)
 {
-    int n = 0;
-    unsigned long long int d = 1;
-    char *bf = p->bf;
-    while (num / d >= p->base)
-        d *= p->base;
-    while (d != 0) {
-        unsigned long long  dgt = num / d;
-        num %= d;
-        d /= p->base;
-        if (n || dgt > 0 || d == 0) {
-            *bf++ = dgt + (dgt < 10 ? '0' : (p->uc ? 'A' : 'a') - 10);
-            ++n;
+    const char *digits;
+    char tmp[22];   /* 64 bits in octal */
+    char *end = tmp + sizeof(tmp);
+    char *q = end;
+    unsigned long n32;
+    unsigned int r;
+    int shift;
+
+    if (p->base == 10) {
+        /*
+         * Digits are produced from the right, two at a time.  Every
+         * argument is widened to long long, but 64-bit division is only
+         * needed while the value does not fit in 32 bits.
+         */
+        while (num > UINT32_MAX) {
+            r = num % 100;
+            num /= 100;
+            q -= 2;
+            memcpy(q, &digit_pairs[2 * r], 2);
+        }
+        n32 = num;
+        while (n32 >= 100) {
+            r = n32 % 100;
+            n32 /= 100;
+            q -= 2;
+            memcpy(q, &digit_pairs[2 * r], 2);
         }
+        if (n32 >= 10) {
+            q -= 2;
+            memcpy(q, &digit_pairs[2 * n32], 2);
+        } else {
+            *--q = '0' + n32;
+        }
+    } else {
+        /* Power of two bases need no division at all. */
+        digits = p->uc ? "0123456789ABCDEF" : "0123456789abcdef";
+        shift = p->base == 16 ? 4 : 3;
+        do {
+            *--q = digits[num & (p->base - 1)];
+            num >>= shift;
+        } while (num != 0);
     }
-    *bf = 0;
+
+    memcpy(p->bf, q, end - q);
+    p->bf[end - q] = 0;
 }
 
 static void i2a(long long int num, struct param *p)
@@ -143,16 +187,39 @@ static int putf(FILE *putp, char c)
         return 1;
 }
 
+/* Hands a whole run of characters to the stream in one write. */
+static unsigned putspan(FILE *putp, const char *s, size_t len)
+{
+    if (len == 0)
+        return 0;
+    return fwrite(s, 1, len, putp);
+}
+
+static unsigned putpad(FILE *putp, char c, int n)
+{
+    static const char spaces[] = "        ";
+    static const char zeros[] = "00000000";
+    const char *pad = c == '0' ? zeros : spaces;
+    unsigned written = 0;
+    int chunk;
+
+    while (n > 0) {
+        chunk = n < (int)sizeof(spaces) - 1 ? n : (int)sizeof(spaces) - 1;
+        written += putspan(putp, pad, chunk);
+        n -= chunk;
+    }
+
+    return written;
+}
+
 static unsigned putchw(FILE *putp, struct param *p)
 {
     unsigned written = 0;
-    char ch;
+    size_t len = strlen(p->bf);
     int n = p->width;
-    char *bf = p->bf;
 
     /* Number of filling characters */
-    while (*bf++ && n > 0)
-        n--;
+    n -= len < (size_t)n ? (int)len : n;
     if (p->sign)
         n--;
     if (p->alt && p->base == 16)
@@ -162,8 +229,8 @@ static unsigned putchw(FILE *putp, struct param *p)
 
     /* Unless left-aligned, fill with space, before alternate or sign */
     if (!p->lz && !p->left) {
-        while (n-- > 0)
-            written += putf(putp, ' ');
+        written += putpad(putp, ' ', n);
+        n = 0;
     }
 
     /* print sign */
@@ -172,27 +239,23 @@ static unsigned putchw(FILE *putp, struct param *p)
 
     /* Alternate */
     if (p->alt && p->base == 16) {
-        written += putf(putp, '0');
-        written += putf(putp, (p->uc ? 'X' : 'x'));
+        written += putspan(putp, p->uc ? "0X" : "0x", 2);
     } else if (p->alt && p->base == 8) {
         written += putf(putp, '0');
     }
 
     /* Fill with zeros, after alternate or sign */
     if (p->lz) {
-        while (n-- > 0)
-            written += putf(putp, '0');
+        written += putpad(putp, '0', n);
+        n = 0;
     }
 
     /* Put actual buffer */
-    bf = p->bf;
-    while ((ch = *bf++))
-        written += putf(putp, ch);
+    written += putspan(putp, p->bf, len);
 
     /* If left-aligned, pad the end with spaces. */
     if (p->left) {
-        while (n-- > 0)
-            written += putf(putp, ' ');
+        written += putpad(putp, ' ', n);
     }
     
     return written;
@@ -237,6 +300,7 @@ size_t tfp_format(FILE *putp, const char *fmt, va_list va)
 {
     size_t written = 0;
     struct param p;
+    const char *span;
     char bf[23];
     char ch;
     char lng;
@@ -251,7 +315,11 @@ size_t tfp_format(FILE *putp, const char *fmt, va_list va)
 
     while ((ch = *(fmt++))) {
         if (ch != '%') {
-            written += putf(putp, ch);
+            /* Everything up to the next conversion goes out in one write. */
+            span = fmt - 1;
+            while (*fmt && *fmt != '%')
+                fmt++;
+            written += putspan(putp, span, fmt - span);
         } else {
             /* Init parameter struct */
             p.lz = 0;
@@ -341,8 +409,7 @@ size_t tfp_format(FILE *putp, const char *fmt, va_list va)
                 ui2a((uintptr_t)v, &p);
                 p.width = 2 * sizeof(void*);
                 p.lz = 1;
-                written += putf(putp, '0');
-                written += putf(putp, 'x');
+                written += putspan(putp, "0x", 2);
                 written += putchw(putp, &p);
                 break;
             case 'c':
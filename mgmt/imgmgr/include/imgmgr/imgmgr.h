@@ -33,6 +33,7 @@ extern "C" {
 #define IMGMGR_NMGR_ID_CORELOAD     4
 #define IMGMGR_NMGR_ID_ERASE	    5
 #define IMGMGR_NMGR_ID_ERASE_STATE  6
+#define IMGMGR_NMGR_ID_UPLOAD_WIN   7
 
 #define IMGMGR_NMGR_MAX_NAME		64
 #define IMGMGR_NMGR_MAX_VER         25  /* 255.255.65535.4294967295\0 */
@@ -81,6 +82,29 @@ int imgr_get_current_hash(uint8_t *hash, uint16_t hashlen);
 
 int imgmgr_find_best_area_id(void);
 
+/**
+ * Computes SHA256 over image header and body in slot, using the HW hash
+ * engine if one is available (IMGMGR_HASH_HW).
+ *
+ * @param slot Slot to hash
+ * @param hash Buffer of IMGMGR_HASH_LEN bytes for the result
+ *
+ * @return 0 on success, SYS_ENOENT if slot has no image, other SYS_E*
+ *         error on failure
+ */
+int imgr_hash_slot(int slot, uint8_t *hash);
+
+/**
+ * Validates image in slot by comparing computed SHA256 against the one
+ * stored in the image TLVs.
+ *
+ * @param slot Slot to validate
+ *
+ * @return 0 if hash matches, SYS_EACCES if it does not, SYS_ENOENT if
+ *         slot has no image or no hash TLV, other SYS_E* error on failure
+ */
+int imgr_validate_slot(int slot);
+
 /**
  * Reads image information
  *
@@ -97,6 +121,15 @@ int imgmgr_find_best_area_id(void);
 int imgr_read_info(int image_slot, struct image_version *ver, uint8_t *hash,
                uint32_t *flags);
 
+/**
+ * Drops what is cached of a slot's image information (IMGMGR_INFO_CACHE).
+ * Writes and erases done by imgmgr and img_mgmt uploads do this already;
+ * anything else modifying an image slot must call it afterwards.
+ *
+ * @param slot Slot written, -1 for all slots
+ */
+void imgr_info_invalidate(int slot);
+
 /**
  * Get state flags from the requested image
  *
@@ -32,8 +32,8 @@
 #include "img_mgmt/img_mgmt.h"
 #include "imgmgr_priv.h"
 
-static imgr_upload_fn *imgr_upload_cb;
-static void *imgr_upload_arg;
+imgr_upload_fn *imgr_upload_cb;
+void *imgr_upload_arg;
 
 void
 imgr_set_upload_cb(imgr_upload_fn *cb, void *arg)
@@ -63,10 +63,152 @@ void imgmgr_dfu_confirmed(void)
     img_mgmt_dfu_confirmed();
 }
 
+#if MYNEWT_VAL(IMGMGR_INFO_CACHE)
+
+/*
+ * What img_mgmt_read_info() returned for a slot.  iic_gen is bumped on
+ * every invalidation, so a result read from flash while the slot was being
+ * written is not stored.
+ */
+struct imgr_info_cache {
+    uint8_t iic_valid;
+    uint8_t iic_gen;
+    int8_t iic_rc;
+    uint32_t iic_flags;
+    struct image_version iic_ver;
+    uint8_t iic_hash[IMGMGR_HASH_LEN];
+};
+
+static struct imgr_info_cache imgr_info_cache[2];
+static const imgmgr_dfu_callbacks_t *imgr_dfu_app_cbs;
+
+static int
+imgr_info_get(int slot, struct image_version *ver, uint8_t *hash,
+              uint32_t *flags)
+{
+    struct imgr_info_cache *iic;
+    struct imgr_info_cache tmp;
+    os_sr_t sr;
+    int rc;
+
+    if (slot < 0 || slot >= 2) {
+        return img_mgmt_read_info(slot, ver, hash, flags);
+    }
+    iic = &imgr_info_cache[slot];
+
+    OS_ENTER_CRITICAL(sr);
+    tmp = *iic;
+    OS_EXIT_CRITICAL(sr);
+
+    if (!tmp.iic_valid) {
+        rc = img_mgmt_read_info(slot, &tmp.iic_ver, tmp.iic_hash,
+                                &tmp.iic_flags);
+        if (rc < 0) {
+            /* Not cached, the area may be readable next time */
+            return rc;
+        }
+        tmp.iic_rc = rc;
+        tmp.iic_valid = 1;
+
+        OS_ENTER_CRITICAL(sr);
+        if (iic->iic_gen == tmp.iic_gen) {
+            *iic = tmp;
+        }
+        OS_EXIT_CRITICAL(sr);
+    }
+
+    if (ver) {
+        *ver = tmp.iic_ver;
+    }
+    if (hash) {
+        memcpy(hash, tmp.iic_hash, IMGMGR_HASH_LEN);
+    }
+    if (flags) {
+        *flags = tmp.iic_flags;
+    }
+    return tmp.iic_rc;
+}
+
+/* img_mgmt uploads only report to the DFU callbacks; pass them on */
+static void
+imgr_dfu_started_cb(void)
+{
+    imgr_info_invalidate(-1);
+    if (imgr_dfu_app_cbs && imgr_dfu_app_cbs->dfu_started_cb) {
+        imgr_dfu_app_cbs->dfu_started_cb();
+    }
+}
+
+static void
+imgr_dfu_stopped_cb(void)
+{
+    imgr_info_invalidate(-1);
+    if (imgr_dfu_app_cbs && imgr_dfu_app_cbs->dfu_stopped_cb) {
+        imgr_dfu_app_cbs->dfu_stopped_cb();
+    }
+}
+
+static void
+imgr_dfu_pending_cb(void)
+{
+    imgr_info_invalidate(-1);
+    if (imgr_dfu_app_cbs && imgr_dfu_app_cbs->dfu_pending_cb) {
+        imgr_dfu_app_cbs->dfu_pending_cb();
+    }
+}
+
+static void
+imgr_dfu_confirmed_cb(void)
+{
+    if (imgr_dfu_app_cbs && imgr_dfu_app_cbs->dfu_confirmed_cb) {
+        imgr_dfu_app_cbs->dfu_confirmed_cb();
+    }
+}
+
+static const img_mgmt_dfu_callbacks_t imgr_dfu_cbs = {
+    .dfu_started_cb = imgr_dfu_started_cb,
+    .dfu_stopped_cb = imgr_dfu_stopped_cb,
+    .dfu_pending_cb = imgr_dfu_pending_cb,
+    .dfu_confirmed_cb = imgr_dfu_confirmed_cb,
+};
+
+#else
+
+static int
+imgr_info_get(int slot, struct image_version *ver, uint8_t *hash,
+              uint32_t *flags)
+{
+    return img_mgmt_read_info(slot, ver, hash, flags);
+}
+
+#endif
+
+void
+imgr_info_invalidate(int slot)
+{
+#if MYNEWT_VAL(IMGMGR_INFO_CACHE)
+    os_sr_t sr;
+    int i;
+
+    OS_ENTER_CRITICAL(sr);
+    for (i = 0; i < 2; i++) {
+        if (slot < 0 || slot == i) {
+            imgr_info_cache[i].iic_valid = 0;
+            imgr_info_cache[i].iic_gen++;
+        }
+    }
+    OS_EXIT_CRITICAL(sr);
+#endif
+}
+
 void
 imgmgr_register_callbacks(const imgmgr_dfu_callbacks_t *cb_struct)
 {
+#if MYNEWT_VAL(IMGMGR_INFO_CACHE)
+    imgr_dfu_app_cbs = cb_struct;
+#else
     img_mgmt_register_callbacks((const img_mgmt_dfu_callbacks_t *)cb_struct);
+#endif
 }
 
 uint8_t
@@ -79,7 +221,7 @@ int
 imgr_read_info(int image_slot, struct image_version *ver, uint8_t *hash,
                uint32_t *flags)
 {
-    return img_mgmt_read_info(image_slot, ver, hash, flags);
+    return imgr_info_get(image_slot, ver, hash, flags);
 }
 
 static int
@@ -108,6 +250,12 @@ static const struct mgmt_handler imgr_mgmt_handlers[] = {
         .mh_read = NULL,
         .mh_write = imgr_erase_state,
     },
+#if MYNEWT_VAL(IMGMGR_UPLOAD_WIN)
+    [IMGMGR_NMGR_ID_UPLOAD_WIN] = {
+        .mh_read = NULL,
+        .mh_write = imgr_upload_win,
+    },
+#endif
 };
 
 #define IMGR_HANDLER_CNT                                                \
@@ -141,7 +289,7 @@ imgr_get_current_hash(uint8_t *hash, uint16_t hashlen)
         return -2;
     }
 
-    rc = img_mgmt_read_info(0, NULL, imghash, NULL);
+    rc = imgr_info_get(0, NULL, imghash, NULL);
     if (rc) {
         return rc;
     }
@@ -154,7 +302,7 @@ imgr_get_current_hash(uint8_t *hash, uint16_t hashlen)
 int
 imgr_my_version(struct image_version *ver)
 {
-    return img_mgmt_read_info(boot_current_slot, ver, NULL, NULL);
+    return imgr_info_get(boot_current_slot, ver, NULL, NULL);
 }
 
 /*
@@ -168,7 +316,7 @@ imgr_find_by_ver(struct image_version *find, uint8_t *hash)
     struct image_version ver;
 
     for (i = 0; i < 2; i++) {
-        if (img_mgmt_read_info(i, &ver, hash, NULL) != 0) {
+        if (imgr_info_get(i, &ver, hash, NULL) != 0) {
             continue;
         }
         if (!memcmp(find, &ver, sizeof(ver))) {
@@ -189,7 +337,7 @@ imgr_find_by_hash(uint8_t *find, struct image_version *ver)
     uint8_t hash[IMGMGR_HASH_LEN];
 
     for (i = 0; i < 2; i++) {
-        if (img_mgmt_read_info(i, ver, hash, NULL) != 0) {
+        if (imgr_info_get(i, ver, hash, NULL) != 0) {
             continue;
         }
         if (!memcmp(hash, find, IMGMGR_HASH_LEN)) {
@@ -208,7 +356,7 @@ imgmgr_find_best_area_id(void)
     int rc;
 
     for (i = 0; i < 2; i++) {
-        rc = img_mgmt_read_info(i, &ver, NULL, NULL);
+        rc = imgr_info_get(i, &ver, NULL, NULL);
         if (rc < 0) {
             continue;
         }
@@ -252,6 +400,7 @@ imgr_erase_state(struct mgmt_ctxt *ctxt)
         }
 
         rc = flash_area_erase(fa, 0, sizeof(struct image_header));
+        imgr_info_invalidate(flash_area_id_to_image_slot(area_id));
         if (rc) {
             return img_mgmt_error_rsp(ctxt, MGMT_ERR_EINVAL,
                                       img_mgmt_err_str_flash_erase_failed);
@@ -281,6 +430,13 @@ imgmgr_module_init(void)
     SYSINIT_ASSERT_ACTIVE();
 
     mgmt_register_group(&imgr_mgmt_group);
+    imgr_hash_init();
+#if MYNEWT_VAL(IMGMGR_INFO_CACHE)
+    img_mgmt_register_callbacks(&imgr_dfu_cbs);
+#endif
+#if MYNEWT_VAL(IMGMGR_UPLOAD_WIN)
+    imgr_upload_win_init();
+#endif
 
 #if MYNEWT_VAL(IMGMGR_CLI)
     rc = imgr_cli_register();
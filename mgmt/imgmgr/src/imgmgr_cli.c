@@ -48,7 +48,8 @@ static const struct shell_cmd_help imgr_cli_help = {
    .usage = "\n"
             "    imgr list\n"
             "    imgr test <slot | hash>\n"
-            "    imgr confirm [slot | hash]"
+            "    imgr confirm [slot | hash]\n"
+            "    imgr verify <slot | hash>"
 };
 #endif
 
@@ -107,7 +108,7 @@ imgr_cli_show_slot(int slot)
     uint32_t flags;
     uint8_t state_flags;
 
-    if (img_mgmt_read_info(slot, &ver, hash, &flags)) {
+    if (imgr_read_info(slot, &ver, hash, &flags)) {
         return;
     }
 
@@ -191,6 +192,31 @@ imgr_cli_set_pending(char *arg, int permanent)
     }
 }
 
+static void
+imgr_cli_verify(char *arg)
+{
+    int slot;
+    int rc;
+
+    rc = imgr_cli_slot_or_hash_parse(arg, &slot);
+    if (rc != 0) {
+        return;
+    }
+
+    rc = imgr_validate_slot(slot);
+    switch (rc) {
+    case 0:
+        console_printf("Slot %d hash ok\n", slot);
+        break;
+    case SYS_EACCES:
+        console_printf("Slot %d hash mismatch\n", slot);
+        break;
+    default:
+        console_printf("Error validating slot %d; rc=%d\n", slot, rc);
+        break;
+    }
+}
+
 static void
 imgr_cli_confirm(void)
 {
@@ -219,6 +245,7 @@ imgr_cli_erase(void)
         }
         rc = flash_area_erase(fa, 0, fa->fa_size);
         flash_area_close(fa);
+        imgr_info_invalidate(flash_area_id_to_image_slot(area_id));
         if (rc) {
             console_printf("Error erasing area rc=%d\n", rc);
         }
@@ -256,6 +283,13 @@ imgr_cli_cmd(int argc, char **argv)
         } else {
             imgr_cli_set_pending(argv[2], 1);
         }
+    } else if (!strcmp(argv[1], "verify")) {
+        if (argc < 3) {
+            imgr_cli_too_few_args();
+            return 0;
+        } else {
+            imgr_cli_verify(argv[2]);
+        }
     } else if (!strcmp(argv[1], "erase")) {
         imgr_cli_erase();
     } else {
@@ -157,6 +157,8 @@ imgr_core_erase(struct mgmt_ctxt *ctxt)
     if (rc == 0 &&
       (hdr.ch_magic == COREDUMP_MAGIC || hdr.ch_magic == 0xffffffff)) {
         rc = flash_area_erase(fa, 0, fa->fa_size);
+        /* The coredump area may double as an image slot */
+        imgr_info_invalidate(-1);
         if (rc != 0) {
             return MGMT_ERR_EINVAL;
         }
@@ -0,0 +1,301 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(IMGMGR_DELTA)
+
+#include <string.h>
+
+#include "flash_map/flash_map.h"
+#include "imgmgr/imgmgr.h"
+#include "imgmgr_priv.h"
+
+/*
+ * Delta image patches.
+ *
+ * A patch turns the image in one slot (the "from" image) into a new one,
+ * written out sequentially.  It is a header followed by records:
+ *
+ * Header, integers little endian:
+ *      uint32_t magic              IMGR_DELTA_MAGIC
+ *      uint32_t to_size            size of the new image
+ *      uint8_t from_hash[32]       SHA256 TLV of the from image
+ *      uint8_t to_hash[32]         SHA256 TLV of the new image
+ *
+ * Record, as in bsdiff:
+ *      varint diff_len
+ *      varint extra_len
+ *      svarint adjust
+ *      diff_len bytes              added to from image bytes, the new bytes
+ *      extra_len bytes             copied as is
+ *
+ * Varints are LEB128, svarints zigzag encoded LEB128.  The from image is
+ * read starting at offset 0; it advances as diff bytes are consumed, and
+ * by adjust after each record.  The patch ends when to_size bytes have
+ * been produced.
+ */
+
+#define IMGR_DELTA_MAGIC        0x4c444d49  /* "IMDL" */
+
+#define IMGR_DELTA_HDR_SIZE     (8 + 2 * IMGMGR_HASH_LEN)
+
+#if MYNEWT_VAL(IMGMGR_DELTA_BUF_SIZE) < IMGR_DELTA_HDR_SIZE
+#error "IMGMGR_DELTA_BUF_SIZE must have room for the patch header"
+#endif
+
+#define IMGR_DELTA_S_HDR        0
+#define IMGR_DELTA_S_DIFF_LEN   1
+#define IMGR_DELTA_S_EXTRA_LEN  2
+#define IMGR_DELTA_S_ADJUST     3
+#define IMGR_DELTA_S_DIFF       4
+#define IMGR_DELTA_S_EXTRA      5
+#define IMGR_DELTA_S_DONE       6
+
+static uint32_t
+imgr_delta_get32(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static int
+imgr_delta_flush(struct imgr_delta *d)
+{
+    int rc;
+
+    if (d->id_out_len == 0) {
+        return 0;
+    }
+    rc = d->id_write(d->id_out_off - d->id_out_len, d->id_out_buf,
+                     d->id_out_len, d->id_arg);
+    d->id_out_len = 0;
+    return rc;
+}
+
+/*
+ * Accumulates one LEB128 digit.  Returns 1 when the number is complete,
+ * 0 if more digits follow, and SYS_EINVAL if it does not fit 32 bits.
+ */
+static int
+imgr_delta_varint(struct imgr_delta *d, uint8_t byte)
+{
+    if (d->id_var_shift > 28 ||
+        (d->id_var_shift == 28 && (byte & 0x70) != 0)) {
+        return SYS_EINVAL;
+    }
+    d->id_var |= (uint32_t)(byte & 0x7f) << d->id_var_shift;
+    if (byte & 0x80) {
+        d->id_var_shift += 7;
+        return 0;
+    }
+    d->id_var_shift = 0;
+    return 1;
+}
+
+static int
+imgr_delta_hdr(struct imgr_delta *d)
+{
+    const uint8_t *hdr;
+
+    hdr = d->id_out_buf;
+    if (imgr_delta_get32(hdr) != IMGR_DELTA_MAGIC) {
+        return SYS_EINVAL;
+    }
+    if (memcmp(hdr + 8, d->id_from_hash, IMGMGR_HASH_LEN) != 0) {
+        /* Made for some other image than the one we have. */
+        return SYS_EACCES;
+    }
+    d->id_to_size = imgr_delta_get32(hdr + 4);
+    memcpy(d->id_to_hash, hdr + 8 + IMGMGR_HASH_LEN, IMGMGR_HASH_LEN);
+    d->id_out_len = 0;
+
+    return 0;
+}
+
+/*
+ * Moves to the next state once a record's runs are through, applying the
+ * record's adjustment at its end.
+ */
+static int
+imgr_delta_next(struct imgr_delta *d)
+{
+    if (d->id_state == IMGR_DELTA_S_DIFF && d->id_diff_left == 0) {
+        d->id_state = IMGR_DELTA_S_EXTRA;
+    }
+    if (d->id_state == IMGR_DELTA_S_EXTRA && d->id_extra_left == 0) {
+        if (d->id_adjust < 0 &&
+            (uint32_t)0 - (uint32_t)d->id_adjust > d->id_from_off) {
+            return SYS_EINVAL;
+        }
+        d->id_from_off += d->id_adjust;
+        d->id_state = d->id_out_off == d->id_to_size ?
+                      IMGR_DELTA_S_DONE : IMGR_DELTA_S_DIFF_LEN;
+    }
+    return 0;
+}
+
+void
+imgr_delta_init(struct imgr_delta *d, const struct flash_area *from,
+                const uint8_t *from_hash, imgr_delta_write_fn *write,
+                void *arg)
+{
+    memset(d, 0, sizeof(*d));
+    d->id_from = from;
+    memcpy(d->id_from_hash, from_hash, IMGMGR_HASH_LEN);
+    d->id_write = write;
+    d->id_arg = arg;
+}
+
+int
+imgr_delta_apply(struct imgr_delta *d, const uint8_t *data, uint32_t len)
+{
+    uint32_t room;
+    uint32_t n;
+    uint32_t i;
+    uint8_t *out;
+    int rc;
+
+    while (len > 0) {
+        switch (d->id_state) {
+        case IMGR_DELTA_S_HDR:
+            /* Collected in the output buffer; nothing is written before. */
+            n = min(len, IMGR_DELTA_HDR_SIZE - d->id_out_len);
+            memcpy(d->id_out_buf + d->id_out_len, data, n);
+            d->id_out_len += n;
+            if (d->id_out_len == IMGR_DELTA_HDR_SIZE) {
+                rc = imgr_delta_hdr(d);
+                if (rc != 0) {
+                    return rc;
+                }
+                d->id_state = d->id_to_size == 0 ?
+                              IMGR_DELTA_S_DONE : IMGR_DELTA_S_DIFF_LEN;
+            }
+            break;
+
+        case IMGR_DELTA_S_DIFF_LEN:
+        case IMGR_DELTA_S_EXTRA_LEN:
+        case IMGR_DELTA_S_ADJUST:
+            n = 1;
+            rc = imgr_delta_varint(d, *data);
+            if (rc < 0) {
+                return rc;
+            }
+            if (rc == 0) {
+                break;
+            }
+            if (d->id_state == IMGR_DELTA_S_DIFF_LEN) {
+                d->id_diff_left = d->id_var;
+                d->id_state = IMGR_DELTA_S_EXTRA_LEN;
+            } else if (d->id_state == IMGR_DELTA_S_EXTRA_LEN) {
+                d->id_extra_left = d->id_var;
+                if ((uint64_t)d->id_out_off + d->id_diff_left +
+                    d->id_extra_left > d->id_to_size) {
+                    return SYS_EINVAL;
+                }
+                d->id_state = IMGR_DELTA_S_ADJUST;
+            } else {
+                /* Zigzag; applied once the extra bytes are through. */
+                d->id_adjust = (int32_t)(d->id_var >> 1) ^
+                               -(int32_t)(d->id_var & 1);
+                d->id_state = IMGR_DELTA_S_DIFF;
+                rc = imgr_delta_next(d);
+                if (rc != 0) {
+                    return rc;
+                }
+            }
+            d->id_var = 0;
+            break;
+
+        case IMGR_DELTA_S_DIFF:
+        case IMGR_DELTA_S_EXTRA:
+            room = sizeof(d->id_out_buf) - d->id_out_len;
+            out = d->id_out_buf + d->id_out_len;
+            if (d->id_state == IMGR_DELTA_S_DIFF) {
+                n = min(min(len, d->id_diff_left), room);
+                if ((uint64_t)d->id_from_off + n > d->id_from->fa_size) {
+                    return SYS_EINVAL;
+                }
+                rc = flash_area_read(d->id_from, d->id_from_off, out, n);
+                if (rc != 0) {
+                    return SYS_EIO;
+                }
+                for (i = 0; i < n; i++) {
+                    out[i] += data[i];
+                }
+                d->id_from_off += n;
+                d->id_diff_left -= n;
+            } else {
+                n = min(min(len, d->id_extra_left), room);
+                memcpy(out, data, n);
+                d->id_extra_left -= n;
+            }
+            d->id_out_len += n;
+            d->id_out_off += n;
+            if (d->id_out_len == sizeof(d->id_out_buf)) {
+                rc = imgr_delta_flush(d);
+                if (rc != 0) {
+                    return rc;
+                }
+            }
+            rc = imgr_delta_next(d);
+            if (rc != 0) {
+                return rc;
+            }
+            break;
+
+        default:
+            /* Trailing garbage. */
+            return SYS_EINVAL;
+        }
+
+        data += n;
+        len -= n;
+    }
+
+    return 0;
+}
+
+int
+imgr_delta_finish(struct imgr_delta *d, int slot)
+{
+    uint8_t hash[IMGMGR_HASH_LEN];
+    int rc;
+
+    if (d->id_state != IMGR_DELTA_S_DONE) {
+        return SYS_EINVAL;
+    }
+    rc = imgr_delta_flush(d);
+    if (rc != 0) {
+        return rc;
+    }
+
+    /* The image must be intact, and the one the patch said it would be. */
+    rc = imgr_validate_slot(slot);
+    if (rc != 0) {
+        return rc;
+    }
+    if (imgr_read_info(slot, NULL, hash, NULL) != 0 ||
+        memcmp(hash, d->id_to_hash, IMGMGR_HASH_LEN) != 0) {
+        return SYS_EACCES;
+    }
+
+    return 0;
+}
+
+#endif
@@ -0,0 +1,271 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+
+#include "os/mynewt.h"
+#include "flash_map/flash_map.h"
+#include "bootutil/image.h"
+#include "imgmgr/imgmgr.h"
+#include "imgmgr_priv.h"
+
+#if MYNEWT_VAL(IMGMGR_HASH_HW)
+#include "hash/hash.h"
+#endif
+#include "tinycrypt/constants.h"
+#include "tinycrypt/sha256.h"
+
+/*
+ * Image is hashed in chunks of this size. Buffer is word aligned, and all
+ * chunks but the last one are a multiple of a word, as required by some
+ * of the HW hash engines.
+ */
+#define IMGR_HASH_CHUNK_WORDS \
+    ((MYNEWT_VAL(IMGMGR_HASH_CHUNK_SIZE) + 3) / 4)
+
+static uint32_t imgr_hash_buf[IMGR_HASH_CHUNK_WORDS];
+static struct os_mutex imgr_hash_mtx;
+
+struct imgr_sha256 {
+#if MYNEWT_VAL(IMGMGR_HASH_HW)
+    struct hash_dev *hash;
+    struct hash_sha256_context hw;
+#endif
+    struct tc_sha256_state_struct sw;
+};
+
+static int
+imgr_sha256_start(struct imgr_sha256 *ctx)
+{
+#if MYNEWT_VAL(IMGMGR_HASH_HW)
+    ctx->hash = (struct hash_dev *)os_dev_open(MYNEWT_VAL(IMGMGR_HASH_DEV),
+            OS_TIMEOUT_NEVER, NULL);
+    if (ctx->hash && !hash_has_support(ctx->hash, HASH_ALGO_SHA256)) {
+        os_dev_close(&ctx->hash->dev);
+        ctx->hash = NULL;
+    }
+    if (ctx->hash) {
+        if (hash_sha256_start(&ctx->hw, ctx->hash)) {
+            os_dev_close(&ctx->hash->dev);
+            return SYS_EIO;
+        }
+        return 0;
+    }
+#endif
+
+    if (tc_sha256_init(&ctx->sw) != TC_CRYPTO_SUCCESS) {
+        return SYS_EIO;
+    }
+
+    return 0;
+}
+
+static int
+imgr_sha256_update(struct imgr_sha256 *ctx, const void *data, uint32_t len)
+{
+#if MYNEWT_VAL(IMGMGR_HASH_HW)
+    if (ctx->hash) {
+        return hash_sha256_update(&ctx->hw, data, len) ? SYS_EIO : 0;
+    }
+#endif
+
+    if (tc_sha256_update(&ctx->sw, data, len) != TC_CRYPTO_SUCCESS) {
+        return SYS_EIO;
+    }
+
+    return 0;
+}
+
+static int
+imgr_sha256_finish(struct imgr_sha256 *ctx, uint8_t *hash)
+{
+    int rc;
+
+#if MYNEWT_VAL(IMGMGR_HASH_HW)
+    if (ctx->hash) {
+        rc = hash_sha256_finish(&ctx->hw, hash) ? SYS_EIO : 0;
+        os_dev_close(&ctx->hash->dev);
+        ctx->hash = NULL;
+        return rc;
+    }
+#endif
+
+    rc = tc_sha256_final(hash, &ctx->sw);
+
+    return rc == TC_CRYPTO_SUCCESS ? 0 : SYS_EIO;
+}
+
+static int
+imgr_hash_area(const struct flash_area *fa, const struct image_header *hdr,
+               uint8_t *hash)
+{
+    struct imgr_sha256 ctx;
+    const void *data;
+    uint32_t size;
+    uint32_t off;
+    uint32_t len;
+    int rc;
+    int rc2;
+
+    size = hdr->ih_hdr_size + hdr->ih_img_size;
+    if (size > fa->fa_size) {
+        return SYS_EINVAL;
+    }
+
+    rc = imgr_sha256_start(&ctx);
+    if (rc) {
+        return rc;
+    }
+
+    /* Memory-mapped flash is hashed in place, without the copy. */
+    if (flash_area_map(fa, 0, size, &data) == 0) {
+        rc = imgr_sha256_update(&ctx, data, size);
+        flash_area_unmap(fa, data);
+        size = 0;
+    }
+
+    for (off = 0; off < size && rc == 0; off += len) {
+        len = min(size - off, sizeof(imgr_hash_buf));
+        rc = flash_area_read(fa, off, imgr_hash_buf, len);
+        if (rc) {
+            rc = SYS_EIO;
+            break;
+        }
+        rc = imgr_sha256_update(&ctx, imgr_hash_buf, len);
+    }
+
+    /* Always finish, HW engine needs to be released */
+    rc2 = imgr_sha256_finish(&ctx, hash);
+
+    return rc ? rc : rc2;
+}
+
+/*
+ * Finds IMAGE_TLV_SHA256 from the TLV area following the image.
+ */
+static int
+imgr_hash_tlv_read(const struct flash_area *fa, const struct image_header *hdr,
+                   uint8_t *hash)
+{
+    struct image_tlv_info info;
+    struct image_tlv tlv;
+    uint32_t off;
+    uint32_t end;
+
+    off = hdr->ih_hdr_size + hdr->ih_img_size;
+    if (flash_area_read(fa, off, &info, sizeof(info))) {
+        return SYS_EIO;
+    }
+    if (info.it_magic != IMAGE_TLV_INFO_MAGIC) {
+        return SYS_ENOENT;
+    }
+
+    end = off + info.it_tlv_tot;
+    for (off += sizeof(info); off + sizeof(tlv) <= end;
+         off += sizeof(tlv) + tlv.it_len) {
+        if (flash_area_read(fa, off, &tlv, sizeof(tlv))) {
+            return SYS_EIO;
+        }
+        if (tlv.it_type == IMAGE_TLV_SHA256) {
+            if (tlv.it_len != IMGMGR_HASH_LEN) {
+                return SYS_EINVAL;
+            }
+            if (flash_area_read(fa, off + sizeof(tlv), hash, IMGMGR_HASH_LEN)) {
+                return SYS_EIO;
+            }
+            return 0;
+        }
+    }
+
+    return SYS_ENOENT;
+}
+
+static int
+imgr_hash_slot_op(int slot, uint8_t *hash, int validate)
+{
+    const struct flash_area *fa;
+    struct image_header hdr;
+    uint8_t stored[IMGMGR_HASH_LEN];
+    uint8_t computed[IMGMGR_HASH_LEN];
+    int area_id;
+    int rc;
+
+    area_id = flash_area_id_from_image_slot(slot);
+    if (flash_area_open(area_id, &fa)) {
+        return SYS_EINVAL;
+    }
+
+    rc = flash_area_read(fa, 0, &hdr, sizeof(hdr));
+    if (rc) {
+        rc = SYS_EIO;
+        goto out;
+    }
+    if (hdr.ih_magic != IMAGE_MAGIC) {
+        rc = SYS_ENOENT;
+        goto out;
+    }
+
+    if (validate) {
+        rc = imgr_hash_tlv_read(fa, &hdr, stored);
+        if (rc) {
+            goto out;
+        }
+    }
+
+    os_mutex_pend(&imgr_hash_mtx, OS_TIMEOUT_NEVER);
+    rc = imgr_hash_area(fa, &hdr, computed);
+    os_mutex_release(&imgr_hash_mtx);
+    if (rc) {
+        goto out;
+    }
+
+    if (validate && memcmp(stored, computed, IMGMGR_HASH_LEN)) {
+        rc = SYS_EACCES;
+        goto out;
+    }
+
+    if (hash) {
+        memcpy(hash, computed, IMGMGR_HASH_LEN);
+    }
+
+out:
+    flash_area_close(fa);
+    return rc;
+}
+
+int
+imgr_hash_slot(int slot, uint8_t *hash)
+{
+    return imgr_hash_slot_op(slot, hash, 0);
+}
+
+int
+imgr_validate_slot(int slot)
+{
+    return imgr_hash_slot_op(slot, NULL, 1);
+}
+
+void
+imgr_hash_init(void)
+{
+    int rc;
+
+    rc = os_mutex_init(&imgr_hash_mtx);
+    SYSINIT_PANIC_ASSERT(rc == 0);
+}
@@ -23,6 +23,7 @@
 #include <stdint.h>
 #include "os/mynewt.h"
 #include "mgmt/mgmt.h"
+#include "imgmgr/imgmgr.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -81,6 +82,37 @@ struct imgmgr_upload_cmd {
  */
 
 struct mgmt_cbuf;
+struct flash_area;
+
+/*
+ * Output sink of a delta patch; data goes at offset off of the new image.
+ * Returns 0 on success.
+ */
+typedef int imgr_delta_write_fn(uint32_t off, const void *data, uint32_t len,
+                                void *arg);
+
+/* Applies a delta patch as it streams in; see imgmgr_delta.c. */
+struct imgr_delta {
+    const struct flash_area *id_from;
+    uint32_t id_from_off;
+    uint32_t id_out_off;        /* bytes of the new image produced */
+    uint32_t id_to_size;
+    uint32_t id_diff_left;
+    uint32_t id_extra_left;
+    int32_t id_adjust;
+    uint32_t id_var;
+    uint8_t id_var_shift;
+    uint8_t id_state;
+    uint16_t id_out_len;
+    imgr_delta_write_fn *id_write;
+    void *id_arg;
+    uint8_t id_from_hash[IMGMGR_HASH_LEN];
+    uint8_t id_to_hash[IMGMGR_HASH_LEN];
+    uint8_t id_out_buf[MYNEWT_VAL(IMGMGR_DELTA_BUF_SIZE)];
+};
+
+extern imgr_upload_fn *imgr_upload_cb;
+extern void *imgr_upload_arg;
 
 int imgr_core_list(struct mgmt_ctxt *);
 int imgr_core_load(struct mgmt_ctxt *);
@@ -88,6 +120,14 @@ int imgr_core_erase(struct mgmt_ctxt *);
 int imgr_find_by_ver(struct image_version *find, uint8_t *hash);
 int imgr_find_by_hash(uint8_t *find, struct image_version *ver);
 int imgr_cli_register(void);
+void imgr_hash_init(void);
+int imgr_upload_win(struct mgmt_ctxt *);
+void imgr_upload_win_init(void);
+void imgr_delta_init(struct imgr_delta *d, const struct flash_area *from,
+                     const uint8_t *from_hash, imgr_delta_write_fn *write,
+                     void *arg);
+int imgr_delta_apply(struct imgr_delta *d, const uint8_t *data, uint32_t len);
+int imgr_delta_finish(struct imgr_delta *d, int slot);
 
 #ifdef __cplusplus
 }
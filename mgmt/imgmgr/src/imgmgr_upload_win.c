@@ -0,0 +1,576 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(IMGMGR_UPLOAD_WIN)
+
+#include <assert.h>
+#include <string.h>
+
+#include "flash_map/flash_map.h"
+#include "mgmt/mgmt.h"
+#include "mgmt/mgmt_decode.h"
+#include "imgmgr/imgmgr.h"
+#include "imgmgr_priv.h"
+
+/*
+ * Windowed image upload.
+ *
+ * A chunk is acknowledged as soon as it has been copied into one of
+ * IMGMGR_UPLOAD_WIN_CHUNKS buffers; a writer task programs it into flash
+ * while the next ones are in transit.  The host may have that many chunks
+ * outstanding.  Every response carries the cumulative state: "off", the
+ * offset up to which data has been received, and "woff", the offset up to
+ * which it is in flash.  A chunk at any other offset than "off" is not
+ * taken, and the host resumes from "off".
+ *
+ * Request:
+ * {
+ *      "off":<offset>,
+ *      "len":<img_size>        inspected when off = 0
+ *      "delta":<bool>          inspected when off = 0
+ *      "data":<binary>
+ * }
+ *
+ * Response:
+ * {
+ *      "rc":<status>,
+ *      "off":<received>,
+ *      "woff":<written>
+ * }
+ *
+ * The response to the last chunk is held back until the image is all in
+ * flash, or IMGMGR_UPLOAD_WIN_TIMEOUT_MS has passed.
+ *
+ * The slot is erased a sector at a time by the writer: whenever a chunk
+ * needs it, and otherwise, unless IMGMGR_LAZY_ERASE is set, ahead of the
+ * data while the writer has nothing else to do.  No request waits for the
+ * whole slot to be erased.  With IMGMGR_UPLOAD_WIN_PREERASE, the slot is
+ * erased in the background after boot once the running image is confirmed,
+ * so that the next upload finds it ready.
+ *
+ * With "delta" set, the data is a patch against the running image (see
+ * imgmgr_delta.c) and "len" its size; offsets are in the patch.  The writer
+ * applies it as it comes, and the final response is only a success once
+ * the image it produced has been verified.
+ */
+
+#define IMGR_WIN_TIMEOUT \
+    os_time_ms_to_ticks32(MYNEWT_VAL(IMGMGR_UPLOAD_WIN_TIMEOUT_MS))
+
+struct imgr_win_chunk {
+    STAILQ_ENTRY(imgr_win_chunk) iwc_next;
+
+    /* Decoded straight from the request. */
+    uint64_t iwc_off;
+    uint64_t iwc_len;
+    bool iwc_delta;
+    size_t iwc_data_len;
+    uint8_t iwc_data[MYNEWT_VAL(IMGMGR_MAX_CHUNK_SIZE)];
+};
+
+STAILQ_HEAD(imgr_win_chunk_list, imgr_win_chunk);
+
+static struct {
+    const struct flash_area *fa;
+    uint32_t size;
+    uint32_t rx_off;
+    uint8_t complete:1;
+
+    /* Shared with the writer task; changed with lock held. */
+    struct os_mutex lock;
+    uint32_t erase_end;         /* erase ahead of the data up to here */
+    uint32_t erased_to;
+    uint8_t clean:1;            /* nothing written since the slot was erased */
+    volatile uint32_t wr_off;
+    volatile int wr_err;
+#if MYNEWT_VAL(IMGMGR_DELTA)
+    uint8_t delta:1;
+    const struct flash_area *from;
+    struct imgr_delta dlt;
+#endif
+
+    struct imgr_win_chunk_list free;
+    struct imgr_win_chunk_list pend;
+    struct os_sem free_sem;
+    struct os_sem done_sem;
+} imgr_win;
+
+static struct imgr_win_chunk imgr_win_chunks[MYNEWT_VAL(IMGMGR_UPLOAD_WIN_CHUNKS)];
+
+static struct os_task imgr_win_task;
+static struct os_eventq imgr_win_evq;
+static os_stack_t imgr_win_stack[MYNEWT_VAL(IMGMGR_UPLOAD_WIN_STACK_SIZE)];
+
+static void imgr_win_write_ev_cb(struct os_event *ev);
+
+static struct os_event imgr_win_write_ev = {
+    .ev_cb = imgr_win_write_ev_cb,
+};
+
+static const struct mgmt_field imgr_win_fields[] = {
+    MGMT_FIELD_UINT(struct imgr_win_chunk, "off", iwc_off),
+    MGMT_FIELD_UINT(struct imgr_win_chunk, "len", iwc_len),
+    MGMT_FIELD_BOOL(struct imgr_win_chunk, "delta", iwc_delta),
+    MGMT_FIELD_BSTR(struct imgr_win_chunk, "data", iwc_data, iwc_data_len),
+};
+
+static struct imgr_win_chunk *
+imgr_win_chunk_take(struct imgr_win_chunk_list *list)
+{
+    struct imgr_win_chunk *chunk;
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    chunk = STAILQ_FIRST(list);
+    if (chunk != NULL) {
+        STAILQ_REMOVE_HEAD(list, iwc_next);
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    return chunk;
+}
+
+static void
+imgr_win_chunk_put(struct imgr_win_chunk_list *list,
+                   struct imgr_win_chunk *chunk)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    STAILQ_INSERT_TAIL(list, chunk, iwc_next);
+    OS_EXIT_CRITICAL(sr);
+}
+
+static void
+imgr_win_chunk_free(struct imgr_win_chunk *chunk)
+{
+    imgr_win_chunk_put(&imgr_win.free, chunk);
+    os_sem_release(&imgr_win.free_sem);
+}
+
+/* Erases whole sectors until at least end bytes of the slot are blank. */
+static int
+imgr_win_erase_to(uint32_t end)
+{
+    struct flash_area sector;
+    uint32_t off;
+    int rc;
+
+    while (imgr_win.erased_to < end) {
+        rc = flash_area_sector_from_off(imgr_win.fa, imgr_win.erased_to,
+                                        &sector);
+        if (rc != 0) {
+            return rc;
+        }
+        off = sector.fa_off - imgr_win.fa->fa_off;
+        rc = flash_area_erase(imgr_win.fa, off, sector.fa_size);
+        imgr_info_invalidate(flash_area_id_to_image_slot(imgr_win.fa->fa_id));
+        if (rc != 0) {
+            return rc;
+        }
+        imgr_win.erased_to = off + sector.fa_size;
+    }
+    return 0;
+}
+
+static int
+imgr_win_write(uint32_t off, const void *data, uint32_t len)
+{
+    int rc;
+
+    rc = imgr_win_erase_to(off + len);
+    if (rc != 0) {
+        return rc;
+    }
+    imgr_win.clean = 0;
+    rc = flash_area_write(imgr_win.fa, off, data, len);
+    imgr_info_invalidate(flash_area_id_to_image_slot(imgr_win.fa->fa_id));
+    return rc;
+}
+
+#if MYNEWT_VAL(IMGMGR_DELTA)
+static int
+imgr_win_delta_write(uint32_t off, const void *data, uint32_t len, void *arg)
+{
+    return imgr_win_write(off, data, len);
+}
+
+/* Feeds a chunk of patch; the last one also verifies the result. */
+static int
+imgr_win_delta_apply(struct imgr_win_chunk *chunk)
+{
+    int rc;
+
+    rc = imgr_delta_apply(&imgr_win.dlt, chunk->iwc_data, chunk->iwc_data_len);
+    if (rc != 0) {
+        return rc;
+    }
+#if !MYNEWT_VAL(IMGMGR_LAZY_ERASE)
+    /* The new image's size is known once the header is in. */
+    imgr_win.erase_end = min(imgr_win.dlt.id_to_size, imgr_win.fa->fa_size);
+#endif
+    if (chunk->iwc_off + chunk->iwc_data_len == imgr_win.size) {
+        rc = imgr_delta_finish(&imgr_win.dlt,
+                               flash_area_id_to_image_slot(imgr_win.fa->fa_id));
+    }
+    return rc;
+}
+#endif
+
+/*
+ * Writer task: programs chunks in the order they were accepted, erasing
+ * the sectors they land in first, then erases one more sector ahead if
+ * there is nothing to write.
+ */
+static void
+imgr_win_write_ev_cb(struct os_event *ev)
+{
+    struct imgr_win_chunk *chunk;
+    uint32_t end;
+    int rc;
+
+    os_mutex_pend(&imgr_win.lock, OS_TIMEOUT_NEVER);
+
+    while ((chunk = imgr_win_chunk_take(&imgr_win.pend)) != NULL) {
+        if (imgr_win.wr_err == 0) {
+            end = chunk->iwc_off + chunk->iwc_data_len;
+#if MYNEWT_VAL(IMGMGR_DELTA)
+            if (imgr_win.delta) {
+                rc = imgr_win_delta_apply(chunk);
+            } else
+#endif
+            {
+                rc = imgr_win_write(chunk->iwc_off, chunk->iwc_data,
+                                    chunk->iwc_data_len);
+            }
+            if (rc != 0) {
+                imgr_win.wr_err = rc;
+            } else {
+                imgr_win.wr_off = end;
+            }
+        }
+        imgr_win_chunk_free(chunk);
+
+        if (imgr_win.wr_err != 0 || imgr_win.wr_off == imgr_win.size) {
+            os_sem_release(&imgr_win.done_sem);
+        }
+    }
+
+    if (imgr_win.wr_err == 0 && imgr_win.erased_to < imgr_win.erase_end) {
+        rc = imgr_win_erase_to(imgr_win.erased_to + 1);
+        if (rc != 0) {
+            imgr_win.wr_err = rc;
+        } else if (imgr_win.erased_to < imgr_win.erase_end) {
+            /* Chunks that arrived meanwhile go first. */
+            os_eventq_put(&imgr_win_evq, &imgr_win_write_ev);
+        }
+    }
+
+    os_mutex_release(&imgr_win.lock);
+}
+
+static void
+imgr_win_task_handler(void *arg)
+{
+    while (1) {
+        os_eventq_run(&imgr_win_evq);
+    }
+}
+
+static int
+imgr_win_idle(void)
+{
+    /* The caller holds one chunk. */
+    return os_sem_get_count(&imgr_win.free_sem) ==
+           MYNEWT_VAL(IMGMGR_UPLOAD_WIN_CHUNKS) - 1;
+}
+
+#if MYNEWT_VAL(IMGMGR_DELTA)
+/* Sets up applying a patch against the running image; lock held. */
+static int
+imgr_win_delta_start(void)
+{
+    uint8_t hash[IMGMGR_HASH_LEN];
+    int rc;
+
+    if (imgr_win.from != NULL) {
+        flash_area_close(imgr_win.from);
+        imgr_win.from = NULL;
+    }
+    if (imgr_read_info(boot_current_slot, NULL, hash, NULL) != 0) {
+        return MGMT_ERR_EBADSTATE;
+    }
+    rc = flash_area_open(flash_area_id_from_image_slot(boot_current_slot),
+                         &imgr_win.from);
+    if (rc != 0) {
+        return MGMT_ERR_EUNKNOWN;
+    }
+    imgr_delta_init(&imgr_win.dlt, imgr_win.from, hash,
+                    imgr_win_delta_write, NULL);
+    return 0;
+}
+#endif
+
+static int
+imgr_win_start(struct imgr_win_chunk *chunk)
+{
+    const struct flash_area *fa;
+    int area_id;
+    int rc;
+
+    if (!imgr_win_idle()) {
+        return MGMT_ERR_EBADSTATE;
+    }
+#if !MYNEWT_VAL(IMGMGR_DELTA)
+    if (chunk->iwc_delta) {
+        return MGMT_ERR_ENOTSUP;
+    }
+#endif
+
+    area_id = imgmgr_find_best_area_id();
+    if (area_id < 0) {
+        return MGMT_ERR_ENOMEM;
+    }
+    rc = flash_area_open(area_id, &fa);
+    if (rc != 0) {
+        return MGMT_ERR_EUNKNOWN;
+    }
+    if (chunk->iwc_len == 0 || chunk->iwc_len > fa->fa_size) {
+        flash_area_close(fa);
+        return MGMT_ERR_EINVAL;
+    }
+
+    os_mutex_pend(&imgr_win.lock, OS_TIMEOUT_NEVER);
+
+    /* Keep what a pre-erase of this slot has done so far. */
+    if (imgr_win.fa == NULL || !imgr_win.clean ||
+        imgr_win.fa->fa_id != fa->fa_id) {
+        imgr_win.erased_to = 0;
+        imgr_win.clean = 0;
+    }
+    if (imgr_win.fa != NULL) {
+        flash_area_close(imgr_win.fa);
+    }
+    imgr_win.fa = fa;
+    imgr_win.size = chunk->iwc_len;
+    imgr_win.rx_off = 0;
+    imgr_win.wr_off = 0;
+    imgr_win.wr_err = 0;
+    imgr_win.complete = 0;
+    os_sem_init(&imgr_win.done_sem, 0);
+#if MYNEWT_VAL(IMGMGR_LAZY_ERASE)
+    imgr_win.erase_end = 0;
+#else
+    imgr_win.erase_end = imgr_win.size;
+#endif
+    rc = 0;
+
+#if MYNEWT_VAL(IMGMGR_DELTA)
+    imgr_win.delta = chunk->iwc_delta;
+    if (imgr_win.delta) {
+        /* How much to erase ahead is up to the patch. */
+        imgr_win.erase_end = 0;
+        rc = imgr_win_delta_start();
+        if (rc != 0) {
+            flash_area_close(imgr_win.fa);
+            imgr_win.fa = NULL;
+        }
+    }
+#endif
+
+    os_mutex_release(&imgr_win.lock);
+    if (rc != 0) {
+        return rc;
+    }
+
+    os_eventq_put(&imgr_win_evq, &imgr_win_write_ev);
+
+    imgmgr_dfu_started();
+    return 0;
+}
+
+static int
+imgr_win_rsp(struct mgmt_ctxt *ctxt)
+{
+    CborError g_err = CborNoError;
+
+    g_err |= cbor_encode_text_stringz(&ctxt->encoder, "rc");
+    g_err |= cbor_encode_int(&ctxt->encoder, MGMT_ERR_EOK);
+    g_err |= cbor_encode_text_stringz(&ctxt->encoder, "off");
+    g_err |= cbor_encode_uint(&ctxt->encoder, imgr_win.rx_off);
+    g_err |= cbor_encode_text_stringz(&ctxt->encoder, "woff");
+    g_err |= cbor_encode_uint(&ctxt->encoder, imgr_win.wr_off);
+
+    if (g_err) {
+        return MGMT_ERR_ENOMEM;
+    }
+    return 0;
+}
+
+int
+imgr_upload_win(struct mgmt_ctxt *ctxt)
+{
+    struct imgr_win_chunk *chunk;
+    int wait_done;
+    int rc;
+
+    if (os_sem_pend(&imgr_win.free_sem, IMGR_WIN_TIMEOUT) != OS_OK) {
+        /* Window full; not taken, the host tries again from "off". */
+        return imgr_win_rsp(ctxt);
+    }
+    chunk = imgr_win_chunk_take(&imgr_win.free);
+    assert(chunk != NULL);
+
+    chunk->iwc_off = UINT64_MAX;
+    chunk->iwc_len = 0;
+    chunk->iwc_delta = false;
+    chunk->iwc_data_len = 0;
+    rc = mgmt_decode_map(&ctxt->it, imgr_win_fields,
+                         MGMT_FIELD_CNT(imgr_win_fields), chunk, NULL);
+    if (rc != 0 || chunk->iwc_off == UINT64_MAX) {
+        rc = MGMT_ERR_EINVAL;
+        goto err;
+    }
+
+    if (chunk->iwc_off == 0) {
+        rc = imgr_win_start(chunk);
+        if (rc != 0) {
+            goto err;
+        }
+    } else if (imgr_win.fa == NULL) {
+        rc = MGMT_ERR_EBADSTATE;
+        goto err;
+    }
+
+    if (imgr_win.wr_err != 0) {
+        imgmgr_dfu_stopped();
+        os_mutex_pend(&imgr_win.lock, OS_TIMEOUT_NEVER);
+        flash_area_close(imgr_win.fa);
+        imgr_win.fa = NULL;
+        os_mutex_release(&imgr_win.lock);
+        rc = MGMT_ERR_EUNKNOWN;
+        goto err;
+    }
+
+    wait_done = 0;
+    if (chunk->iwc_off != imgr_win.rx_off ||
+        chunk->iwc_off + chunk->iwc_data_len > imgr_win.size ||
+        (chunk->iwc_data_len == 0 && imgr_win.rx_off != imgr_win.size)) {
+        /*
+         * Retransmission, gap or overrun; just report where we are.  A
+         * repeated last chunk waits for the writer like the original.
+         */
+        wait_done = imgr_win.rx_off == imgr_win.size;
+        imgr_win_chunk_free(chunk);
+    } else {
+        if (imgr_upload_cb != NULL) {
+            rc = imgr_upload_cb(chunk->iwc_off, imgr_win.size,
+                                imgr_upload_arg);
+            if (rc != 0) {
+                goto err;
+            }
+        }
+
+        imgr_win.rx_off += chunk->iwc_data_len;
+        wait_done = imgr_win.rx_off == imgr_win.size;
+        if (chunk->iwc_data_len != 0) {
+            imgr_win_chunk_put(&imgr_win.pend, chunk);
+            os_eventq_put(&imgr_win_evq, &imgr_win_write_ev);
+        } else {
+            imgr_win_chunk_free(chunk);
+        }
+    }
+
+    if (wait_done) {
+        if (imgr_win.wr_off != imgr_win.size) {
+            os_sem_pend(&imgr_win.done_sem, IMGR_WIN_TIMEOUT);
+        }
+        if (imgr_win.wr_err != 0) {
+            return MGMT_ERR_EUNKNOWN;
+        }
+        if (imgr_win.wr_off == imgr_win.size && !imgr_win.complete) {
+            imgr_win.complete = 1;
+            imgmgr_dfu_stopped();
+        }
+    }
+
+    return imgr_win_rsp(ctxt);
+
+err:
+    imgr_win_chunk_free(chunk);
+    return rc;
+}
+
+#if MYNEWT_VAL(IMGMGR_UPLOAD_WIN_PREERASE)
+/*
+ * Once the running image is confirmed, whatever the other slot holds is
+ * never going to be booted; start the next upload's erase now.
+ */
+static void
+imgr_win_preerase(void)
+{
+    const struct flash_area *fa;
+    int area_id;
+
+    if (!(imgmgr_state_flags(boot_current_slot) & IMGMGR_STATE_F_CONFIRMED)) {
+        return;
+    }
+    area_id = imgmgr_find_best_area_id();
+    if (area_id < 0 || flash_area_open(area_id, &fa) != 0) {
+        return;
+    }
+
+    imgr_win.fa = fa;
+    imgr_win.erased_to = 0;
+    imgr_win.erase_end = fa->fa_size;
+    imgr_win.clean = 1;
+    os_eventq_put(&imgr_win_evq, &imgr_win_write_ev);
+}
+#endif
+
+void
+imgr_upload_win_init(void)
+{
+    int rc;
+    int i;
+
+    STAILQ_INIT(&imgr_win.free);
+    STAILQ_INIT(&imgr_win.pend);
+    for (i = 0; i < MYNEWT_VAL(IMGMGR_UPLOAD_WIN_CHUNKS); i++) {
+        STAILQ_INSERT_TAIL(&imgr_win.free, &imgr_win_chunks[i], iwc_next);
+    }
+    os_sem_init(&imgr_win.free_sem, MYNEWT_VAL(IMGMGR_UPLOAD_WIN_CHUNKS));
+    os_sem_init(&imgr_win.done_sem, 0);
+    os_mutex_init(&imgr_win.lock);
+
+    os_eventq_init(&imgr_win_evq);
+    rc = os_task_init(&imgr_win_task, "imgr_win", imgr_win_task_handler, NULL,
+                      MYNEWT_VAL(IMGMGR_UPLOAD_WIN_TASK_PRIO),
+                      OS_WAIT_FOREVER, imgr_win_stack,
+                      MYNEWT_VAL(IMGMGR_UPLOAD_WIN_STACK_SIZE));
+    SYSINIT_PANIC_ASSERT(rc == 0);
+
+#if MYNEWT_VAL(IMGMGR_UPLOAD_WIN_PREERASE)
+    imgr_win_preerase();
+#endif
+}
+
+#endif
@@ -0,0 +1,106 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef _MGMT_DECODE_H_
+#define _MGMT_DECODE_H_
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <tinycbor/cbor.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Decoding of a management request map straight into a struct.  A command
+ * handler describes the request with a constant table of MGMT_FIELD_xxx()
+ * entries, which carry the key length and the offset and size of the
+ * struct member worked out at compile time; mgmt_decode_map() then fills
+ * the struct in a single pass over the map.  Keys are compared in place,
+ * and only against fields of the same length.
+ */
+#define MGMT_FIELD_T_INT        1   /* int64_t */
+#define MGMT_FIELD_T_UINT       2   /* uint64_t */
+#define MGMT_FIELD_T_BOOL       3   /* bool */
+#define MGMT_FIELD_T_TSTR       4   /* char[], NUL terminated */
+#define MGMT_FIELD_T_BSTR       5   /* uint8_t[], with a size_t length */
+
+struct mgmt_field {
+    const char *mf_key;
+    uint8_t mf_key_len;
+    uint8_t mf_type;
+    uint16_t mf_off;            /* member offset */
+    uint16_t mf_size;           /* member size */
+    uint16_t mf_len_off;        /* MGMT_FIELD_T_BSTR: offset of the length */
+};
+
+#define MGMT_FIELD_MEMBER_SIZE(st, m)   sizeof(((st *)0)->m)
+
+#define MGMT_FIELD(st, key, type, m)                                    \
+    {                                                                   \
+        .mf_key = (key),                                                \
+        .mf_key_len = sizeof(key) - 1,                                  \
+        .mf_type = (type),                                              \
+        .mf_off = offsetof(st, m),                                      \
+        .mf_size = MGMT_FIELD_MEMBER_SIZE(st, m),                       \
+    }
+
+#define MGMT_FIELD_INT(st, key, m)  MGMT_FIELD(st, key, MGMT_FIELD_T_INT, m)
+#define MGMT_FIELD_UINT(st, key, m) MGMT_FIELD(st, key, MGMT_FIELD_T_UINT, m)
+#define MGMT_FIELD_BOOL(st, key, m) MGMT_FIELD(st, key, MGMT_FIELD_T_BOOL, m)
+#define MGMT_FIELD_TSTR(st, key, m) MGMT_FIELD(st, key, MGMT_FIELD_T_TSTR, m)
+#define MGMT_FIELD_BSTR(st, key, m, len)                                \
+    {                                                                   \
+        .mf_key = (key),                                                \
+        .mf_key_len = sizeof(key) - 1,                                  \
+        .mf_type = MGMT_FIELD_T_BSTR,                                   \
+        .mf_off = offsetof(st, m),                                      \
+        .mf_size = MGMT_FIELD_MEMBER_SIZE(st, m),                       \
+        .mf_len_off = offsetof(st, len),                                \
+    }
+
+#define MGMT_FIELD_CNT(fields)  (sizeof(fields) / sizeof((fields)[0]))
+
+/**
+ * Decodes the map at it into dst.  Members whose key is not in the map
+ * are left alone, so defaults can be set beforehand; keys not in the table
+ * are skipped.
+ *
+ * @param it                    Iterator pointing at the request map.
+ * @param fields                Field table.
+ * @param cnt                   Number of entries in fields; at most 32.
+ * @param dst                   Struct to fill.
+ * @param found                 If not NULL, filled with a bit per field,
+ *                                  set if the key was present.
+ *
+ * @return                      0 on success;
+ *                              MGMT_ERR_EINVAL if the map is malformed, a
+ *                                  value has the wrong type or a string does
+ *                                  not fit its member.
+ */
+int mgmt_decode_map(CborValue *it, const struct mgmt_field *fields, int cnt,
+                    void *dst, uint32_t *found);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _MGMT_DECODE_H_ */
@@ -0,0 +1,158 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <assert.h>
+#include <string.h>
+#include "os/mynewt.h"
+#include "mgmt/mgmt.h"
+#include "tinycbor/cbor.h"
+#include "mgmt/mgmt_decode.h"
+
+/*
+ * Returns the index of the field whose key the iterator points at, or -1.
+ */
+static int
+mgmt_decode_lookup(const CborValue *key, const struct mgmt_field *fields,
+                   int cnt)
+{
+    size_t len;
+    bool eq;
+    int i;
+
+    if (!cbor_value_is_text_string(key)) {
+        return -1;
+    }
+    if (cbor_value_is_length_known(key)) {
+        if (cbor_value_get_string_length(key, &len)) {
+            return -1;
+        }
+    } else if (cbor_value_calculate_string_length(key, &len)) {
+        return -1;
+    }
+
+    for (i = 0; i < cnt; i++) {
+        if (fields[i].mf_key_len != len) {
+            continue;
+        }
+        if (!cbor_value_text_string_equals(key, fields[i].mf_key, &eq) && eq) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static int
+mgmt_decode_value(const CborValue *val, const struct mgmt_field *f,
+                  uint8_t *dst)
+{
+    uint8_t *p;
+    int64_t i64;
+    uint64_t u64;
+    size_t len;
+    bool b;
+
+    p = dst + f->mf_off;
+    switch (f->mf_type) {
+    case MGMT_FIELD_T_INT:
+        assert(f->mf_size == sizeof(i64));
+        if (!cbor_value_is_integer(val) ||
+          cbor_value_get_int64_checked(val, &i64)) {
+            return MGMT_ERR_EINVAL;
+        }
+        memcpy(p, &i64, sizeof(i64));
+        break;
+    case MGMT_FIELD_T_UINT:
+        assert(f->mf_size == sizeof(u64));
+        if (!cbor_value_is_unsigned_integer(val) ||
+          cbor_value_get_uint64(val, &u64)) {
+            return MGMT_ERR_EINVAL;
+        }
+        memcpy(p, &u64, sizeof(u64));
+        break;
+    case MGMT_FIELD_T_BOOL:
+        assert(f->mf_size == sizeof(b));
+        if (!cbor_value_is_boolean(val) || cbor_value_get_boolean(val, &b)) {
+            return MGMT_ERR_EINVAL;
+        }
+        memcpy(p, &b, sizeof(b));
+        break;
+    case MGMT_FIELD_T_TSTR:
+        len = f->mf_size - 1;
+        if (!cbor_value_is_text_string(val) ||
+          cbor_value_copy_text_string(val, (char *)p, &len, NULL)) {
+            return MGMT_ERR_EINVAL;
+        }
+        p[len] = '\0';
+        break;
+    case MGMT_FIELD_T_BSTR:
+        len = f->mf_size;
+        if (!cbor_value_is_byte_string(val) ||
+          cbor_value_copy_byte_string(val, p, &len, NULL)) {
+            return MGMT_ERR_EINVAL;
+        }
+        memcpy(dst + f->mf_len_off, &len, sizeof(len));
+        break;
+    default:
+        assert(0);
+        return MGMT_ERR_EINVAL;
+    }
+    return 0;
+}
+
+int
+mgmt_decode_map(CborValue *it, const struct mgmt_field *fields, int cnt,
+                void *dst, uint32_t *found)
+{
+    CborValue map;
+    uint32_t seen;
+    int idx;
+    int rc;
+
+    assert(cnt <= 32);
+
+    if (!cbor_value_is_map(it) || cbor_value_enter_container(it, &map)) {
+        return MGMT_ERR_EINVAL;
+    }
+
+    seen = 0;
+    while (!cbor_value_at_end(&map)) {
+        idx = mgmt_decode_lookup(&map, fields, cnt);
+        if (cbor_value_advance(&map) || cbor_value_at_end(&map)) {
+            return MGMT_ERR_EINVAL;
+        }
+        if (idx >= 0) {
+            rc = mgmt_decode_value(&map, &fields[idx], dst);
+            if (rc) {
+                return rc;
+            }
+            seen |= 1UL << idx;
+        }
+        if (cbor_value_advance(&map)) {
+            return MGMT_ERR_EINVAL;
+        }
+    }
+    if (cbor_value_leave_container(it, &map)) {
+        return MGMT_ERR_EINVAL;
+    }
+
+    if (found) {
+        *found = seen;
+    }
+    return 0;
+}
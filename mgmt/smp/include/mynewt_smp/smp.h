@@ -28,6 +28,7 @@
 #include <tinycbor/cbor.h>
 #include <inttypes.h>
 #include "os/mynewt.h"
+#include "arena/arena.h"
 #include "smp/smp.h"
 
 #ifdef __cplusplus
@@ -60,6 +61,14 @@ struct smp_transport {
     struct os_mqueue st_imq;
     smp_transport_out_func_t st_output;
     smp_transport_get_mtu_func_t st_get_mtu;
+
+    /** Scratch arena for the request currently being processed. */
+    struct arena st_arena;
+
+#if MYNEWT_VAL(SMP_WORKERS) > 0
+    /** Index of the worker task processing this transport's requests. */
+    uint8_t st_worker;
+#endif
 };
 
 void smp_event_put(struct os_event *ev);
@@ -67,6 +76,31 @@ int smp_transport_init(struct smp_transport *st,
         smp_transport_out_func_t output_func,
         smp_transport_get_mtu_func_t get_mtu_func);
 int smp_rx_req(struct smp_transport *st, struct os_mbuf *req);
+
+#if MYNEWT_VAL(SMP_WORKERS) > 0
+/**
+ * Selects the worker task that processes a transport's requests.
+ * Transports are assigned to workers in turn as they are initialized;
+ * requests from one transport are always processed in order.
+ *
+ * @param st                    The transport.
+ * @param worker                Worker index, less than SMP_WORKERS.
+ *
+ * @return                      0 on success; SYS_EINVAL if there is no
+ *                              such worker.
+ */
+int smp_transport_set_worker(struct smp_transport *st, int worker);
+#endif
+
+/**
+ * Returns the scratch arena of the request currently being processed.
+ * Command handlers may allocate temporary storage from it; everything
+ * allocated is released in one step once the handler returns.
+ *
+ * @return                      The request arena;
+ *                              NULL if called outside of request processing.
+ */
+struct arena *smp_req_arena(void);
 struct os_eventq *mgmt_evq_get(void);
 
 #ifdef __cplusplus
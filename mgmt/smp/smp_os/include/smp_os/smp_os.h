@@ -33,6 +33,9 @@ extern "C" {
 #define SMP_ID_MPSTATS         3
 #define SMP_ID_DATETIME_STR    4
 #define SMP_ID_RESET           5
+#define SMP_ID_CPUSTATS        6
+#define SMP_ID_ALLOCPROF       7
+#define SMP_ID_EVQPROF         8
 
 void smp_os_groups_register(void);
 
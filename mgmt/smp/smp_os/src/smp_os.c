@@ -34,15 +34,32 @@
 #include <timepersist/timepersist.h>
 #endif
 
+#if MYNEWT_VAL(OS_ALLOC_PROF)
+#include <allocprof/allocprof.h>
+#endif
+
+#if MYNEWT_VAL(OS_EVENTQ_PROF)
+#include <evqprof/evqprof.h>
+#endif
+
 #include "smp_os/smp_os.h"
 
 #include <tinycbor/cbor.h>
-#include <cborattr/cborattr.h>
+#include <mgmt/mgmt_decode.h>
 
 static int smp_def_console_echo(struct mgmt_ctxt *cb);
 static int smp_def_mpstat_read(struct mgmt_ctxt *cb);
 static int smp_datetime_get(struct mgmt_ctxt *cb);
 static int smp_datetime_set(struct mgmt_ctxt *cb);
+#if MYNEWT_VAL(OS_TASK_CPU_STATS)
+static int smp_def_cpustat_read(struct mgmt_ctxt *cb);
+#endif
+#if MYNEWT_VAL(OS_ALLOC_PROF)
+static int smp_def_allocprof_read(struct mgmt_ctxt *cb);
+#endif
+#if MYNEWT_VAL(OS_EVENTQ_PROF)
+static int smp_def_evqprof_read(struct mgmt_ctxt *cb);
+#endif
 
 static const struct mgmt_handler smp_def_group_handlers[] = {
     [SMP_ID_CONS_ECHO_CTRL] = {
@@ -54,6 +71,21 @@ static const struct mgmt_handler smp_def_group_handlers[] = {
     [SMP_ID_DATETIME_STR] = {
         smp_datetime_get, smp_datetime_set
     },
+#if MYNEWT_VAL(OS_TASK_CPU_STATS)
+    [SMP_ID_CPUSTATS] = {
+        smp_def_cpustat_read, NULL
+    },
+#endif
+#if MYNEWT_VAL(OS_ALLOC_PROF)
+    [SMP_ID_ALLOCPROF] = {
+        smp_def_allocprof_read, NULL
+    },
+#endif
+#if MYNEWT_VAL(OS_EVENTQ_PROF)
+    [SMP_ID_EVQPROF] = {
+        smp_def_evqprof_read, NULL
+    },
+#endif
 };
 
 #define SMP_DEF_GROUP_SZ                                               \
@@ -65,27 +97,27 @@ static struct mgmt_group smp_def_group = {
     .mg_group_id = MGMT_GROUP_ID_OS
 };
 
+struct smp_echo_req {
+    int64_t echo;
+};
+
+static const struct mgmt_field smp_echo_fields[] = {
+    MGMT_FIELD_INT(struct smp_echo_req, "echo", echo),
+};
+
 static int
 smp_def_console_echo(struct mgmt_ctxt *cb)
 {
-    long long int echo_on = 1;
+    struct smp_echo_req req = { .echo = 1 };
     int rc;
-    struct cbor_attr_t attrs[2] = {
-        [0] = {
-            .attribute = "echo",
-            .type = CborAttrIntegerType,
-            .addr.integer = &echo_on,
-            .nodefault = 1
-        },
-        [1] = { 0 },
-    };
-
-    rc = cbor_read_object(&cb->it, attrs);
+
+    rc = mgmt_decode_map(&cb->it, smp_echo_fields,
+                         MGMT_FIELD_CNT(smp_echo_fields), &req, NULL);
     if (rc) {
         return MGMT_ERR_EINVAL;
     }
 
-    if (echo_on) {
+    if (req.echo) {
         console_echo(1);
     } else {
         console_echo(0);
@@ -136,6 +168,207 @@ smp_def_mpstat_read(struct mgmt_ctxt *cb)
     return (0);
 }
 
+#if MYNEWT_VAL(OS_TASK_CPU_STATS)
+static int
+smp_def_cpustat_read(struct mgmt_ctxt *cb)
+{
+    struct os_task *prev_task;
+    struct os_task_info oti;
+    struct os_cpu_stats ocs;
+    CborError g_err = CborNoError;
+    CborEncoder tasks;
+    CborEncoder task;
+
+    os_cpu_stats_get(&ocs);
+
+    g_err |= cbor_encode_text_stringz(&cb->encoder, "rc");
+    g_err |= cbor_encode_int(&cb->encoder, MGMT_ERR_EOK);
+    g_err |= cbor_encode_text_stringz(&cb->encoder, "idle");
+    g_err |= cbor_encode_uint(&cb->encoder, ocs.ocs_idle_time);
+    g_err |= cbor_encode_text_stringz(&cb->encoder, "isr");
+    g_err |= cbor_encode_uint(&cb->encoder, ocs.ocs_isr_time);
+    g_err |= cbor_encode_text_stringz(&cb->encoder, "isrcnt");
+    g_err |= cbor_encode_uint(&cb->encoder, ocs.ocs_isr_cnt);
+    g_err |= cbor_encode_text_stringz(&cb->encoder, "tasks");
+    g_err |= cbor_encoder_create_map(&cb->encoder, &tasks,
+                                     CborIndefiniteLength);
+
+    prev_task = NULL;
+    while (1) {
+        prev_task = os_task_info_get_next(prev_task, &oti);
+        if (prev_task == NULL) {
+            break;
+        }
+
+        g_err |= cbor_encode_text_stringz(&tasks, oti.oti_name);
+        g_err |= cbor_encoder_create_map(&tasks, &task, CborIndefiniteLength);
+        g_err |= cbor_encode_text_stringz(&task, "prio");
+        g_err |= cbor_encode_uint(&task, oti.oti_prio);
+        g_err |= cbor_encode_text_stringz(&task, "cputime");
+        g_err |= cbor_encode_uint(&task, oti.oti_cputime);
+        g_err |= cbor_encode_text_stringz(&task, "cswcnt");
+        g_err |= cbor_encode_uint(&task, oti.oti_cswcnt);
+        g_err |= cbor_encoder_close_container(&tasks, &task);
+    }
+
+    g_err |= cbor_encoder_close_container(&cb->encoder, &tasks);
+
+    if (g_err) {
+        return MGMT_ERR_ENOMEM;
+    }
+    return (0);
+}
+#endif
+
+#if MYNEWT_VAL(OS_ALLOC_PROF)
+static int
+smp_def_allocprof_read(struct mgmt_ctxt *cb)
+{
+    struct allocprof_site site;
+    struct allocprof_info info;
+    CborError g_err = CborNoError;
+    CborEncoder types;
+    CborEncoder sites;
+    CborEncoder map;
+    int i;
+
+    allocprof_info_get(&info);
+
+    g_err |= cbor_encode_text_stringz(&cb->encoder, "rc");
+    g_err |= cbor_encode_int(&cb->encoder, MGMT_ERR_EOK);
+    g_err |= cbor_encode_text_stringz(&cb->encoder, "untracked");
+    g_err |= cbor_encode_uint(&cb->encoder, info.api_untracked_frees);
+    g_err |= cbor_encode_text_stringz(&cb->encoder, "dropped");
+    g_err |= cbor_encode_uint(&cb->encoder,
+                              info.api_live_dropped + info.api_site_dropped);
+
+    g_err |= cbor_encode_text_stringz(&cb->encoder, "types");
+    g_err |= cbor_encoder_create_map(&cb->encoder, &types,
+                                     CborIndefiniteLength);
+    for (i = 0; i < OS_ALLOC_PROF_NUM_TYPES; i++) {
+        g_err |= cbor_encode_text_stringz(&types, allocprof_type_name(i));
+        g_err |= cbor_encoder_create_map(&types, &map, CborIndefiniteLength);
+        g_err |= cbor_encode_text_stringz(&map, "live");
+        g_err |= cbor_encode_uint(&map, info.api_types[i].apt_live);
+        g_err |= cbor_encode_text_stringz(&map, "max");
+        g_err |= cbor_encode_uint(&map, info.api_types[i].apt_live_max);
+        g_err |= cbor_encode_text_stringz(&map, "bytes");
+        g_err |= cbor_encode_uint(&map, info.api_types[i].apt_live_bytes);
+        g_err |= cbor_encode_text_stringz(&map, "maxbytes");
+        g_err |= cbor_encode_uint(&map, info.api_types[i].apt_live_bytes_max);
+        g_err |= cbor_encoder_close_container(&types, &map);
+    }
+    g_err |= cbor_encoder_close_container(&cb->encoder, &types);
+
+    g_err |= cbor_encode_text_stringz(&cb->encoder, "sites");
+    g_err |= cbor_encoder_create_array(&cb->encoder, &sites,
+                                       CborIndefiniteLength);
+    for (i = allocprof_site_get_next(0, &site);
+         i >= 0;
+         i = allocprof_site_get_next(i + 1, &site)) {
+
+        g_err |= cbor_encoder_create_map(&sites, &map, CborIndefiniteLength);
+        g_err |= cbor_encode_text_stringz(&map, "type");
+        g_err |= cbor_encode_text_stringz(&map,
+                                          allocprof_type_name(site.aps_type));
+        g_err |= cbor_encode_text_stringz(&map, "caller");
+        g_err |= cbor_encode_uint(&map, (uintptr_t)site.aps_caller);
+        g_err |= cbor_encode_text_stringz(&map, "pool");
+        g_err |= cbor_encode_uint(&map, (uintptr_t)site.aps_pool);
+        g_err |= cbor_encode_text_stringz(&map, "allocs");
+        g_err |= cbor_encode_uint(&map, site.aps_allocs);
+        g_err |= cbor_encode_text_stringz(&map, "frees");
+        g_err |= cbor_encode_uint(&map, site.aps_frees);
+        g_err |= cbor_encode_text_stringz(&map, "live");
+        g_err |= cbor_encode_uint(&map, site.aps_live);
+        g_err |= cbor_encode_text_stringz(&map, "max");
+        g_err |= cbor_encode_uint(&map, site.aps_live_max);
+        g_err |= cbor_encode_text_stringz(&map, "peak");
+        g_err |= cbor_encode_uint(&map, site.aps_peak_live);
+        g_err |= cbor_encode_text_stringz(&map, "maxbytes");
+        g_err |= cbor_encode_uint(&map, site.aps_live_bytes_max);
+        g_err |= cbor_encode_text_stringz(&map, "lifemax");
+        g_err |= cbor_encode_uint(&map, site.aps_lifetime_max);
+        g_err |= cbor_encode_text_stringz(&map, "lifesum");
+        g_err |= cbor_encode_uint(&map, site.aps_lifetime_sum);
+        g_err |= cbor_encoder_close_container(&sites, &map);
+    }
+    g_err |= cbor_encoder_close_container(&cb->encoder, &sites);
+
+    if (g_err) {
+        return MGMT_ERR_ENOMEM;
+    }
+    return (0);
+}
+#endif
+
+#if MYNEWT_VAL(OS_EVENTQ_PROF)
+static CborError
+smp_def_evqprof_hist(CborEncoder *map, const char *name, const uint32_t *hist)
+{
+    CborError g_err = CborNoError;
+    CborEncoder arr;
+    int i;
+
+    g_err |= cbor_encode_text_stringz(map, name);
+    g_err |= cbor_encoder_create_array(map, &arr, EVQPROF_BUCKETS);
+    for (i = 0; i < EVQPROF_BUCKETS; i++) {
+        g_err |= cbor_encode_uint(&arr, hist[i]);
+    }
+    g_err |= cbor_encoder_close_container(map, &arr);
+
+    return g_err;
+}
+
+static int
+smp_def_evqprof_read(struct mgmt_ctxt *cb)
+{
+    struct evqprof_cb c;
+    CborError g_err = CborNoError;
+    CborEncoder cbs;
+    CborEncoder map;
+    int i;
+
+    g_err |= cbor_encode_text_stringz(&cb->encoder, "rc");
+    g_err |= cbor_encode_int(&cb->encoder, MGMT_ERR_EOK);
+    g_err |= cbor_encode_text_stringz(&cb->encoder, "dropped");
+    g_err |= cbor_encode_uint(&cb->encoder, evqprof_dropped_get());
+
+    g_err |= cbor_encode_text_stringz(&cb->encoder, "cbs");
+    g_err |= cbor_encoder_create_array(&cb->encoder, &cbs,
+                                       CborIndefiniteLength);
+    for (i = evqprof_cb_get_next(0, &c);
+         i >= 0;
+         i = evqprof_cb_get_next(i + 1, &c)) {
+
+        g_err |= cbor_encoder_create_map(&cbs, &map, CborIndefiniteLength);
+        g_err |= cbor_encode_text_stringz(&map, "evq");
+        g_err |= cbor_encode_uint(&map, (uintptr_t)c.epc_evq);
+        g_err |= cbor_encode_text_stringz(&map, "cb");
+        g_err |= cbor_encode_uint(&map, (uintptr_t)c.epc_cb);
+        g_err |= cbor_encode_text_stringz(&map, "cnt");
+        g_err |= cbor_encode_uint(&map, c.epc_cnt);
+        g_err |= cbor_encode_text_stringz(&map, "waitmax");
+        g_err |= cbor_encode_uint(&map, c.epc_wait_max);
+        g_err |= cbor_encode_text_stringz(&map, "waitsum");
+        g_err |= cbor_encode_uint(&map, c.epc_wait_sum);
+        g_err |= cbor_encode_text_stringz(&map, "runmax");
+        g_err |= cbor_encode_uint(&map, c.epc_run_max);
+        g_err |= cbor_encode_text_stringz(&map, "runsum");
+        g_err |= cbor_encode_uint(&map, c.epc_run_sum);
+        g_err |= smp_def_evqprof_hist(&map, "wait", c.epc_wait_hist);
+        g_err |= smp_def_evqprof_hist(&map, "run", c.epc_run_hist);
+        g_err |= cbor_encoder_close_container(&cbs, &map);
+    }
+    g_err |= cbor_encoder_close_container(&cb->encoder, &cbs);
+
+    if (g_err) {
+        return MGMT_ERR_ENOMEM;
+    }
+    return (0);
+}
+#endif
+
 static int
 smp_datetime_get(struct mgmt_ctxt *cb)
 {
@@ -168,30 +401,31 @@ err:
     return (rc);
 }
 
+struct smp_datetime_req {
+    char datetime[DATETIME_BUFSIZE];
+};
+
+static const struct mgmt_field smp_datetime_fields[] = {
+    MGMT_FIELD_TSTR(struct smp_datetime_req, "datetime", datetime),
+};
+
 static int
 smp_datetime_set(struct mgmt_ctxt *mc)
 {
     struct os_timeval tv;
     struct os_timezone tz;
-    char buf[DATETIME_BUFSIZE];
+    struct smp_datetime_req req;
     int rc = 0;
-    const struct cbor_attr_t datetime_write_attr[] = {
-        [0] = {
-            .attribute = "datetime",
-            .type = CborAttrTextStringType,
-            .addr.string = buf,
-            .len = sizeof(buf),
-        },
-        { 0 },
-    };
-
-    rc = cbor_read_object(&mc->it, datetime_write_attr);
+
+    req.datetime[0] = '\0';
+    rc = mgmt_decode_map(&mc->it, smp_datetime_fields,
+                         MGMT_FIELD_CNT(smp_datetime_fields), &req, NULL);
     if (rc) {
         return MGMT_ERR_EINVAL;
     }
 
     /* Set the current datetime */
-    rc = datetime_parse(buf, &tv, &tz);
+    rc = datetime_parse(req.datetime, &tv, &tz);
     if (!rc) {
         rc = os_settimeofday(&tv, &tz);
         if (rc) {
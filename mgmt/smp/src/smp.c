@@ -20,7 +20,6 @@
 #include <assert.h>
 #include <string.h>
 #include "os/mynewt.h"
-#include "mem/mem.h"
 #include "mgmt/mgmt.h"
 #include "os_mgmt/os_mgmt.h"
 #include "mynewt_smp/smp.h"
@@ -31,6 +30,26 @@
 /* Shared queue that SMP uses for work items. */
 struct os_eventq *g_smp_evq;
 
+/* Arena of the request currently being processed, if any. */
+static struct arena *smp_cur_arena;
+
+#if MYNEWT_VAL(SMP_WORKERS) > 0
+/*
+ * Requests from each transport are processed, in order, by the worker the
+ * transport was assigned; transports on different workers don't wait for
+ * each other.
+ */
+struct smp_worker {
+    struct os_task sw_task;
+    struct os_eventq sw_evq;
+    struct arena *sw_cur_arena;
+    os_stack_t sw_stack[MYNEWT_VAL(SMP_WORKER_STACK_SIZE)];
+};
+
+static struct smp_worker smp_workers[MYNEWT_VAL(SMP_WORKERS)];
+static uint8_t smp_next_worker;
+#endif
+
 static mgmt_alloc_rsp_fn smp_alloc_rsp;
 static mgmt_trim_front_fn smp_trim_front;
 static mgmt_reset_buf_fn smp_reset_buf;
@@ -61,6 +80,25 @@ mgmt_evq_get(void)
     return g_smp_evq;
 }
 
+/* Where the current task keeps the arena of the request it processes. */
+static struct arena **
+smp_cur_arena_ptr(void)
+{
+#if MYNEWT_VAL(SMP_WORKERS) > 0
+    struct os_task *task;
+    int i;
+
+    task = os_sched_get_current_task();
+    for (i = 0; i < MYNEWT_VAL(SMP_WORKERS); i++) {
+        if (task == &smp_workers[i].sw_task) {
+            return &smp_workers[i].sw_cur_arena;
+        }
+    }
+#endif
+
+    return &smp_cur_arena;
+}
+
 static void *
 smp_alloc_rsp(const void *req, void *arg)
 {
@@ -175,26 +213,72 @@ smp_init_writer(struct cbor_encoder_writer *writer, void *m,
 }
 
 /**
- * Allocates an mbuf to costain an outgoing response fragment.
+ * Splits the first frag_size bytes off a response, without copying them.
+ * The response's own mbufs become the fragment; the remainder is moved to
+ * a new packet header mbuf, with a copy of the user header (where
+ * transport-specific information is stored).  Only the part of the mbuf
+ * straddling the split point that goes with the remainder is copied.
+ *
+ * @param om                    The response; set to the remainder, or to
+ *                                  NULL if it fits in one fragment.
+ *
+ * @return                      The fragment; NULL if out of mbufs.
  */
 static struct os_mbuf *
-smp_rsp_frag_alloc(uint16_t frag_size, void *arg)
+smp_split_frag(struct os_mbuf **om, uint16_t frag_size)
 {
-    struct os_mbuf *src_rsp;
     struct os_mbuf *frag;
+    struct os_mbuf *rest;
+    struct os_mbuf *last;
+    struct os_mbuf *cur;
+    uint16_t keep;
+    uint32_t len;
+    int rc;
 
-    /* We need to duplicate the user header from the source response, as that
-     * is where transport-specific information is stored.
-     */
-    src_rsp = arg;
+    frag = *om;
+    len = OS_MBUF_PKTLEN(frag);
+    if (len <= frag_size) {
+        *om = NULL;
+        return frag;
+    }
 
-    frag = os_msys_get_pkthdr(frag_size, OS_MBUF_USRHDR_LEN(src_rsp));
-    if (frag != NULL) {
-        /* Copy the user header from the response into the fragmest mbuf. */
-        memcpy(OS_MBUF_USRHDR(frag), OS_MBUF_USRHDR(src_rsp),
-               OS_MBUF_USRHDR_LEN(src_rsp));
+    rest = os_msys_get_pkthdr(0, OS_MBUF_USRHDR_LEN(frag));
+    if (rest == NULL) {
+        return NULL;
+    }
+    memcpy(OS_MBUF_USRHDR(rest), OS_MBUF_USRHDR(frag),
+           OS_MBUF_USRHDR_LEN(frag));
+
+    /* Find the mbuf holding the first byte past the fragment. */
+    keep = frag_size;
+    for (cur = frag; keep >= cur->om_len; cur = SLIST_NEXT(cur, om_next)) {
+        keep -= cur->om_len;
+        last = cur;
     }
 
+    if (keep == 0) {
+        SLIST_NEXT(last, om_next) = NULL;
+    } else {
+        rc = os_mbuf_append(rest, cur->om_data + keep, cur->om_len - keep);
+        if (rc != 0) {
+            os_mbuf_free_chain(rest);
+            return NULL;
+        }
+        cur->om_len = keep;
+        last = cur;
+        cur = SLIST_NEXT(cur, om_next);
+        SLIST_NEXT(last, om_next) = NULL;
+    }
+
+    for (last = rest; SLIST_NEXT(last, om_next) != NULL;
+         last = SLIST_NEXT(last, om_next)) {
+    }
+    SLIST_NEXT(last, om_next) = cur;
+
+    OS_MBUF_PKTHDR(frag)->omp_len = frag_size;
+    OS_MBUF_PKTHDR(rest)->omp_len = len - frag_size;
+    *om = rest;
+
     return frag;
 }
 
@@ -216,19 +300,30 @@ smp_tx_rsp(struct smp_streamer *ns, void *rsp, void *arg)
         return MGMT_ERR_EUNKNOWN;
     }
 
+    /*
+     * Each fragment is handed to the transport as soon as it is split off,
+     * so its mbufs are on their way back to msys before the next is cut.
+     */
     while (m != NULL) {
-        frag = mem_split_frag(&m, mtu, smp_rsp_frag_alloc, rsp);
+        frag = smp_split_frag(&m, mtu);
         if (frag == NULL) {
-            return MGMT_ERR_ENOMEM;
+            rc = MGMT_ERR_ENOMEM;
+            goto err;
         }
 
         rc = st->st_output(frag);
         if (rc != 0) {
-            return MGMT_ERR_EUNKNOWN;
+            rc = MGMT_ERR_EUNKNOWN;
+            goto err;
         }
     }
 
     return 0;
+
+err:
+    /* The response is consumed either way. */
+    os_mbuf_free_chain(m);
+    return rc;
 }
 
 /**
@@ -262,7 +357,10 @@ smp_process_packet(struct smp_transport *st)
             break;
         }
 
+        *smp_cur_arena_ptr() = &st->st_arena;
         rc = smp_process_request_packet(&st->st_streamer, m);
+        *smp_cur_arena_ptr() = NULL;
+        arena_reset(&st->st_arena);
         if (rc) {
             return rc;
         }
@@ -274,9 +372,16 @@ smp_process_packet(struct smp_transport *st)
 int
 smp_rx_req(struct smp_transport *st, struct os_mbuf *req)
 {
+    struct os_eventq *evq;
     int rc;
-    
-    rc = os_mqueue_put(&st->st_imq, os_eventq_dflt_get(), req);
+
+#if MYNEWT_VAL(SMP_WORKERS) > 0
+    evq = &smp_workers[st->st_worker].sw_evq;
+#else
+    evq = os_eventq_dflt_get();
+#endif
+
+    rc = os_mqueue_put(&st->st_imq, evq, req);
     if (rc) {
         goto err;
     }
@@ -287,6 +392,12 @@ err:
     return rc;
 }
 
+struct arena *
+smp_req_arena(void)
+{
+    return *smp_cur_arena_ptr();
+}
+
 static void
 smp_event_data_in(struct os_event *ev)
 {
@@ -302,6 +413,11 @@ smp_transport_init(struct smp_transport *st,
 
     st->st_output = output_func;
     st->st_get_mtu = get_mtu_func;
+    arena_init_mbuf(&st->st_arena, NULL);
+#if MYNEWT_VAL(SMP_WORKERS) > 0
+    st->st_worker = smp_next_worker;
+    smp_next_worker = (smp_next_worker + 1) % MYNEWT_VAL(SMP_WORKERS);
+#endif
 
     rc = os_mqueue_init(&st->st_imq, smp_event_data_in, st);
     if (rc != 0) {
@@ -313,11 +429,52 @@ err:
     return rc;
 }
 
+#if MYNEWT_VAL(SMP_WORKERS) > 0
+static void
+smp_worker_handler(void *arg)
+{
+    struct smp_worker *sw;
+
+    sw = arg;
+    while (1) {
+        os_eventq_run(&sw->sw_evq);
+    }
+}
+
+int
+smp_transport_set_worker(struct smp_transport *st, int worker)
+{
+    if (worker < 0 || worker >= MYNEWT_VAL(SMP_WORKERS)) {
+        return SYS_EINVAL;
+    }
+
+    st->st_worker = worker;
+    return 0;
+}
+#endif
+
 void
 smp_pkg_init(void)
 {
+#if MYNEWT_VAL(SMP_WORKERS) > 0
+    struct smp_worker *sw;
+    int rc;
+    int i;
+#endif
+
     /* Ensure this function only gets called by sysinit. */
     SYSINIT_ASSERT_ACTIVE();
 
     mgmt_evq_set(os_eventq_dflt_get());
+
+#if MYNEWT_VAL(SMP_WORKERS) > 0
+    for (i = 0; i < MYNEWT_VAL(SMP_WORKERS); i++) {
+        sw = &smp_workers[i];
+        os_eventq_init(&sw->sw_evq);
+        rc = os_task_init(&sw->sw_task, "smp", smp_worker_handler, sw,
+                          MYNEWT_VAL(SMP_WORKER_PRIO) + i, OS_WAIT_FOREVER,
+                          sw->sw_stack, MYNEWT_VAL(SMP_WORKER_STACK_SIZE));
+        SYSINIT_PANIC_ASSERT(rc == 0);
+    }
+#endif
 }
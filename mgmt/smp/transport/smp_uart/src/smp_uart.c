@@ -18,6 +18,7 @@
  */
 #include <inttypes.h>
 #include <assert.h>
+#include <string.h>
 
 #include "os/mynewt.h"
 #include <bsp/bsp.h>
@@ -53,6 +54,9 @@ struct smp_uart_state {
     struct uart_dev *sus_dev;
     struct os_mbuf *sus_tx;
     int sus_tx_off;
+#if MYNEWT_VAL(SMP_UART_BLOCK)
+    int sus_tx_span;        /* length of block being sent by driver */
+#endif
     struct os_mbuf_pkthdr *sus_rx_pkt;
     struct os_mbuf_pkthdr *sus_rx_q;
     struct os_mbuf_pkthdr *sus_rx;
@@ -225,6 +229,46 @@ smp_uart_tx_char(void *arg)
     return ch;
 }
 
+#if MYNEWT_VAL(SMP_UART_BLOCK)
+/**
+ * Called by UART driver to get next block to send. Driver sends data
+ * directly from mbuf, so it is released only on the next call.
+ */
+static int
+smp_uart_tx_block(void *arg, const uint8_t **data, int max)
+{
+    struct smp_uart_state *sus = (struct smp_uart_state *)arg;
+    struct os_mbuf *m;
+    int len;
+
+    sus->sus_tx_off += sus->sus_tx_span;
+    sus->sus_tx_span = 0;
+
+    if (!sus->sus_tx) {
+        return 0;
+    }
+    while (sus->sus_tx->om_len == sus->sus_tx_off) {
+        m = SLIST_NEXT(sus->sus_tx, om_next);
+        os_mbuf_free(sus->sus_tx);
+        sus->sus_tx = m;
+
+        sus->sus_tx_off = 0;
+        if (!sus->sus_tx) {
+            return 0;
+        }
+    }
+
+    len = sus->sus_tx->om_len - sus->sus_tx_off;
+    if (len > max) {
+        len = max;
+    }
+    *data = sus->sus_tx->om_data + sus->sus_tx_off;
+    sus->sus_tx_span = len;
+
+    return len;
+}
+#endif
+
 /**
  * Check for full packet. If frame is not right, free the mbuf.
  */
@@ -318,19 +362,17 @@ smp_uart_rx_frame(struct os_event *ev)
 }
 
 /**
- * Receive a character from UART.
+ * Returns mbuf for line being received, allocates one if needed.
  */
-static int
-smp_uart_rx_char(void *arg, uint8_t data)
+static struct os_mbuf *
+smp_uart_rx_mbuf(struct smp_uart_state *sus)
 {
-    struct smp_uart_state *sus = (struct smp_uart_state *)arg;
     struct os_mbuf *m;
-    int rc;
 
     if (!sus->sus_rx) {
         m = os_msys_get_pkthdr(MGMT_NLIP_MAX_FRAME, 0);
         if (!m) {
-            return 0;
+            return NULL;
         }
         sus->sus_rx = OS_MBUF_PKTHDR(m);
         if (OS_MBUF_TRAILINGSPACE(m) < MGMT_NLIP_MAX_FRAME) {
@@ -339,34 +381,102 @@ smp_uart_rx_char(void *arg, uint8_t data)
              */
             os_mbuf_free_chain(m);
             sus->sus_rx = NULL;
-            return 0;
+            return NULL;
         }
     }
 
-    m = OS_MBUF_PKTHDR_TO_MBUF(sus->sus_rx);
-    if (data == '\n') {
-        /*
-         * Full line of input. Process it outside interrupt context.
-         */
-        assert(!sus->sus_rx_q);
-        sus->sus_rx_q = sus->sus_rx;
-        sus->sus_rx = NULL;
-        os_eventq_put(mgmt_evq_get(), &sus->sus_cb_ev);
-        return 0;
-    } else {
-        rc = os_mbuf_append(m, &data, 1);
-        if (rc == 0) {
-            return 0;
-        }
+    return OS_MBUF_PKTHDR_TO_MBUF(sus->sus_rx);
+}
+
+/**
+ * Full line of input. Process it outside interrupt context.
+ */
+static void
+smp_uart_rx_line(struct smp_uart_state *sus)
+{
+    if (!smp_uart_rx_mbuf(sus)) {
+        return;
+    }
+
+    assert(!sus->sus_rx_q);
+    sus->sus_rx_q = sus->sus_rx;
+    sus->sus_rx = NULL;
+    os_eventq_put(mgmt_evq_get(), &sus->sus_cb_ev);
+}
+
+/**
+ * Appends received data to the line.
+ */
+static void
+smp_uart_rx_append(struct smp_uart_state *sus, const uint8_t *data, int len)
+{
+    struct os_mbuf *m;
+    int rc;
+
+    m = smp_uart_rx_mbuf(sus);
+    if (!m) {
+        return;
+    }
+
+    rc = os_mbuf_append(m, data, len);
+    if (rc == 0) {
+        return;
     }
     /* failed */
     sus->sus_rx->omp_len = 0;
     m->om_len = 0;
     os_mbuf_free_chain(SLIST_NEXT(m, om_next));
     SLIST_NEXT(m, om_next) = NULL;
+}
+
+/**
+ * Receive a character from UART.
+ */
+static int
+smp_uart_rx_char(void *arg, uint8_t data)
+{
+    struct smp_uart_state *sus = (struct smp_uart_state *)arg;
+
+    if (data == '\n') {
+        smp_uart_rx_line(sus);
+    } else {
+        smp_uart_rx_append(sus, &data, 1);
+    }
     return 0;
 }
 
+#if MYNEWT_VAL(SMP_UART_BLOCK)
+/**
+ * Receive a block of data from UART. Runs between newlines are appended to
+ * the line at once.
+ */
+static int
+smp_uart_rx_block(void *arg, const uint8_t *data, int len)
+{
+    struct smp_uart_state *sus = (struct smp_uart_state *)arg;
+    const uint8_t *nl;
+    int off;
+    int cnt;
+
+    for (off = 0; off < len; off += cnt) {
+        nl = memchr(data + off, '\n', len - off);
+        if (nl) {
+            cnt = nl - (data + off);
+        } else {
+            cnt = len - off;
+        }
+        if (cnt > 0) {
+            smp_uart_rx_append(sus, data + off, cnt);
+        }
+        if (nl) {
+            smp_uart_rx_line(sus);
+            cnt++;
+        }
+    }
+    return len;
+}
+#endif
+
 void
 smp_uart_pkg_init(void)
 {
@@ -380,6 +490,10 @@ smp_uart_pkg_init(void)
         .uc_flow_ctl = UART_FLOW_CTL_NONE,
         .uc_tx_char = smp_uart_tx_char,
         .uc_rx_char = smp_uart_rx_char,
+#if MYNEWT_VAL(SMP_UART_BLOCK)
+        .uc_tx_block = smp_uart_tx_block,
+        .uc_rx_block = smp_uart_rx_block,
+#endif
         .uc_cb_arg = sus
     };
 
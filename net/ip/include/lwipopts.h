@@ -19,12 +19,27 @@
 #ifndef __LWIP_LWIPOPTS_H__
 #define __LWIP_LWIPOPTS_H__
 
+#include <stddef.h>
+#include "syscfg/syscfg.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 #define MEM_LIBC_MALLOC			1	/* use platform malloc */
+
+#if MYNEWT_VAL(LWIP_MEM_MSYS)
+/* Heap and pools come out of msys; see net/ip/src/lwip_mem.c */
+#define MEMP_MEM_MALLOC                 1
+#define mem_clib_malloc                 lwip_msys_malloc
+#define mem_clib_calloc                 lwip_msys_calloc
+#define mem_clib_free                   lwip_msys_free
+void *lwip_msys_malloc(size_t size);
+void *lwip_msys_calloc(size_t count, size_t size);
+void lwip_msys_free(void *p);
+#endif
 #define LWIP_NETIF_TX_SINGLE_PBUF 	1
+#define LWIP_SUPPORT_CUSTOM_PBUF	1	/* zero-copy TX in lwip_socket.c */
 #define LWIP_NETIF_LOOPBACK		1	/* yes loopback interface */
 
 #define TCPIP_THREAD_PRIO		5
@@ -118,6 +133,10 @@ extern "C" {
    link level header. */
 #define PBUF_LINK_HLEN                  16
 
+/* ---------- Checksum options ---------- */
+/* Let drivers for MACs with checksum offload turn off software checksums */
+#define LWIP_CHECKSUM_CTRL_PER_NETIF    1
+
 /* ---------- TCP options ---------- */
 #define LWIP_TCP                        1
 #define TCP_TTL                         255
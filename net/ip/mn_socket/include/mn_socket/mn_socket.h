@@ -21,6 +21,8 @@
 
 #include <inttypes.h>
 
+#include "os/mynewt.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -68,6 +70,7 @@ extern "C" {
 
 struct mn_socket;
 struct mn_socket_ops;
+struct mn_socket_set;
 struct mn_sock_cb;
 struct os_mbuf;
 
@@ -75,6 +78,13 @@ struct mn_socket {
     const union mn_socket_cb *ms_cbs;          /* filled in by user */
     void *ms_cb_arg;                           /* filled in by user */
     const struct mn_socket_ops *ms_ops;        /* filled in by mn_socket */
+
+    /* filled in by mn_socket_set_add() */
+    struct mn_socket_set *ms_set;
+    STAILQ_ENTRY(mn_socket) ms_ready_next;
+    uint8_t ms_set_events;
+    uint8_t ms_ready;
+    uint8_t ms_ready_err;
 };
 
 /*
@@ -141,6 +151,7 @@ struct mn_mreq {
 #define MN_MCAST_LEAVE_GROUP            2
 #define MN_MCAST_IF                     3
 #define MN_REUSEADDR                    4
+#define MN_SO_CORK                      5  /* TCP; int, 0 flushes */
 
 /*
  * Socket calls.
@@ -168,6 +179,27 @@ int mn_recvfrom(struct mn_socket *, struct os_mbuf **,
   struct mn_sockaddr *from);
 int mn_sendto(struct mn_socket *, struct os_mbuf *, struct mn_sockaddr *to);
 
+/*
+ * Batched mn_recvfrom()/mn_sendto().
+ *
+ * mn_recvmmsg() fills in up to cnt entries, stopping when the socket has
+ * no more data; mm_addr, if not NULL, must have room for a
+ * struct mn_sockaddr_in6. Returns 0 if at least one datagram was received.
+ *
+ * mn_sendmmsg() sends the entries in order, stopping at the first one that
+ * fails, and returns that error. Ownership of the mbufs of the entries
+ * that were sent passes to the socket; the rest stay with the caller.
+ *
+ * Both report the number of entries processed in *done.
+ */
+struct mn_mmsg {
+    struct os_mbuf *mm_m;
+    struct mn_sockaddr *mm_addr;
+};
+
+int mn_recvmmsg(struct mn_socket *, struct mn_mmsg *msgs, int cnt, int *done);
+int mn_sendmmsg(struct mn_socket *, struct mn_mmsg *msgs, int cnt, int *done);
+
 int mn_getsockopt(struct mn_socket *, uint8_t level, uint8_t optname,
   void *optval);
 int mn_setsockopt(struct mn_socket *, uint8_t level, uint8_t optname,
@@ -184,6 +216,33 @@ int mn_close(struct mn_socket *);
         (sock)->ms_cb_arg = (cb_arg);                                   \
     } while (0)
 
+/*
+ * Readiness sets.
+ *
+ * Instead of getting callbacks, sockets added to a set are queued on it
+ * when they become readable/writable, and the set's event is posted to its
+ * event queue. The event handler then calls mn_socket_set_next() until it
+ * returns NULL, and services each socket returned; as with the callbacks,
+ * a readable socket should be drained with mn_recvfrom()/mn_recvmmsg().
+ * Events not selected when the socket was added still go to its callbacks.
+ */
+#define MN_SOCK_EV_READABLE     0x01
+#define MN_SOCK_EV_WRITABLE     0x02
+
+struct mn_socket_set {
+    STAILQ_HEAD(, mn_socket) mss_ready;
+    struct os_eventq *mss_evq;
+    struct os_event mss_ev;
+};
+
+void mn_socket_set_init(struct mn_socket_set *, struct os_eventq *evq,
+  os_event_fn *fn, void *arg);
+int mn_socket_set_add(struct mn_socket_set *, struct mn_socket *,
+  uint8_t events);
+int mn_socket_set_remove(struct mn_socket *);
+struct mn_socket *mn_socket_set_next(struct mn_socket_set *, uint8_t *events,
+  int *err);
+
 /*
  * Address conversion
  */
@@ -46,6 +46,12 @@ struct mn_socket_ops {
     int (*mso_recvfrom)(struct mn_socket *, struct os_mbuf **,
       struct mn_sockaddr *from);
 
+    /* optional, mn_socket loops over mso_sendto/mso_recvfrom if NULL */
+    int (*mso_sendmmsg)(struct mn_socket *, struct mn_mmsg *, int cnt,
+      int *done);
+    int (*mso_recvmmsg)(struct mn_socket *, struct mn_mmsg *, int cnt,
+      int *done);
+
     int (*mso_getsockopt)(struct mn_socket *, uint8_t level, uint8_t name,
       void *val);
     int (*mso_setsockopt)(struct mn_socket *, uint8_t level, uint8_t name,
@@ -60,9 +66,18 @@ struct mn_socket_ops {
 
 int mn_socket_ops_reg(const struct mn_socket_ops *ops);
 
+/*
+ * Queues the socket on its readiness set, if it has one which selected
+ * this event. Returns 0 if it did.
+ */
+int mn_socket_set_ready(struct mn_socket *s, uint8_t event, int error);
+
 static inline void
 mn_socket_writable(struct mn_socket *s, int error)
 {
+    if (s->ms_set && !mn_socket_set_ready(s, MN_SOCK_EV_WRITABLE, error)) {
+        return;
+    }
     if (s->ms_cbs && s->ms_cbs->socket.writable) {
         s->ms_cbs->socket.writable(s->ms_cb_arg, error);
     }
@@ -71,6 +86,9 @@ mn_socket_writable(struct mn_socket *s, int error)
 static inline void
 mn_socket_readable(struct mn_socket *s, int error)
 {
+    if (s->ms_set && !mn_socket_set_ready(s, MN_SOCK_EV_READABLE, error)) {
+        return;
+    }
     if (s->ms_cbs && s->ms_cbs->socket.readable) {
         s->ms_cbs->socket.readable(s->ms_cb_arg, error);
     }
@@ -79,6 +97,7 @@ mn_socket_readable(struct mn_socket *s, int error)
 static inline int
 mn_socket_newconn(struct mn_socket *s, struct mn_socket *new)
 {
+    new->ms_set = NULL;
     if (s->ms_cbs && s->ms_cbs->listen.newconn) {
         return s->ms_cbs->listen.newconn(s->ms_cb_arg, new);
     } else {
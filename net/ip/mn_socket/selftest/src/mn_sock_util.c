@@ -277,6 +277,112 @@ sock_udp_data(void)
     mn_close(sock2);
 }
 
+static void
+sub_set_ev(struct os_event *ev)
+{
+}
+
+void
+sock_udp_batch(void)
+{
+    struct mn_socket *sock1;
+    struct mn_socket *sock2;
+    struct mn_socket *s;
+    struct mn_socket_set set;
+    struct os_eventq evq;
+    struct os_eventq *evqp;
+    struct mn_sockaddr_in msin;
+    struct mn_sockaddr_in6 from[4];
+    struct mn_mmsg msgs[4];
+    struct os_mbuf *m;
+    char data[] = "1234567890";
+    uint8_t events;
+    int err;
+    int cnt;
+    int done;
+    int rc;
+    int i;
+
+    os_eventq_init(&evq);
+    evqp = &evq;
+    mn_socket_set_init(&set, &evq, sub_set_ev, NULL);
+
+    rc = mn_socket(&sock1, MN_PF_INET, MN_SOCK_DGRAM, 0);
+    TEST_ASSERT(rc == 0);
+    rc = mn_socket_set_add(&set, sock1, MN_SOCK_EV_READABLE);
+    TEST_ASSERT(rc == 0);
+    rc = mn_socket_set_add(&set, sock1, MN_SOCK_EV_READABLE);
+    TEST_ASSERT(rc == MN_EINVAL);
+
+    rc = mn_socket(&sock2, MN_PF_INET, MN_SOCK_DGRAM, 0);
+    TEST_ASSERT(rc == 0);
+
+    msin.msin_family = MN_PF_INET;
+    msin.msin_len = sizeof(msin);
+    msin.msin_port = htons(12446);
+    mn_inet_pton(MN_PF_INET, "127.0.0.1", &msin.msin_addr);
+
+    rc = mn_bind(sock1, (struct mn_sockaddr *)&msin);
+    TEST_ASSERT(rc == 0);
+
+    for (i = 0; i < 3; i++) {
+        m = os_msys_get(sizeof(data), 0);
+        TEST_ASSERT(m);
+        rc = os_mbuf_copyinto(m, 0, data, sizeof(data));
+        TEST_ASSERT(rc == 0);
+        msgs[i].mm_m = m;
+        msgs[i].mm_addr = (struct mn_sockaddr *)&msin;
+    }
+    rc = mn_sendmmsg(sock2, msgs, 3, &done);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(done == 3);
+
+    /*
+     * Datagrams can arrive one by one; keep servicing the set until all
+     * three are in.
+     */
+    cnt = 0;
+    while (cnt < 3) {
+        if (!os_eventq_poll(&evqp, 1, OS_TICKS_PER_SEC)) {
+            break;
+        }
+        while ((s = mn_socket_set_next(&set, &events, &err))) {
+            TEST_ASSERT(s == sock1);
+            TEST_ASSERT(events == MN_SOCK_EV_READABLE);
+            TEST_ASSERT(err == 0);
+            for (i = 0; i < 4; i++) {
+                msgs[i].mm_m = NULL;
+                msgs[i].mm_addr = (struct mn_sockaddr *)&from[i];
+            }
+            rc = mn_recvmmsg(s, msgs, 4, &done);
+            if (rc == MN_EAGAIN) {
+                continue;
+            }
+            TEST_ASSERT(rc == 0);
+            for (i = 0; i < done; i++) {
+                m = msgs[i].mm_m;
+                TEST_ASSERT(OS_MBUF_PKTLEN(m) == sizeof(data));
+                TEST_ASSERT(from[i].msin6_family == MN_AF_INET);
+                os_mbuf_free_chain(m);
+            }
+            cnt += done;
+        }
+    }
+    TEST_ASSERT(cnt == 3);
+
+    rc = mn_recvmmsg(sock1, msgs, 4, &done);
+    TEST_ASSERT(rc == MN_EAGAIN);
+    TEST_ASSERT(done == 0);
+
+    rc = mn_socket_set_remove(sock1);
+    TEST_ASSERT(rc == 0);
+    rc = mn_socket_set_remove(sock1);
+    TEST_ASSERT(rc == MN_EINVAL);
+
+    mn_close(sock1);
+    mn_close(sock2);
+}
+
 void
 std_writable(void *cb_arg, int err)
 {
@@ -799,6 +905,7 @@ mn_socket_test_handler(void *arg)
     sock_listen();
     sock_tcp_connect();
     sock_udp_data();
+    sock_udp_batch();
     sock_tcp_data();
     sock_itf_list();
     sock_udp_ll();
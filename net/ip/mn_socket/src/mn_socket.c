@@ -62,6 +62,7 @@ mn_socket(struct mn_socket **sp, uint8_t domain, uint8_t type, uint8_t proto)
     rc = mn_sock_tgt->mso_create(sp, domain, type, proto);
     if (*sp) {
         (*sp)->ms_ops = mn_sock_tgt;
+        (*sp)->ms_set = NULL;
     }
     return rc;
 }
@@ -96,6 +97,46 @@ mn_sendto(struct mn_socket *s, struct os_mbuf *m, struct mn_sockaddr *to)
     return s->ms_ops->mso_sendto(s, m, to);
 }
 
+int
+mn_recvmmsg(struct mn_socket *s, struct mn_mmsg *msgs, int cnt, int *done)
+{
+    int rc;
+    int i;
+
+    if (s->ms_ops->mso_recvmmsg) {
+        return s->ms_ops->mso_recvmmsg(s, msgs, cnt, done);
+    }
+    rc = 0;
+    for (i = 0; i < cnt; i++) {
+        rc = s->ms_ops->mso_recvfrom(s, &msgs[i].mm_m, msgs[i].mm_addr);
+        if (rc) {
+            break;
+        }
+    }
+    *done = i;
+    return i ? 0 : rc;
+}
+
+int
+mn_sendmmsg(struct mn_socket *s, struct mn_mmsg *msgs, int cnt, int *done)
+{
+    int rc;
+    int i;
+
+    if (s->ms_ops->mso_sendmmsg) {
+        return s->ms_ops->mso_sendmmsg(s, msgs, cnt, done);
+    }
+    rc = 0;
+    for (i = 0; i < cnt; i++) {
+        rc = s->ms_ops->mso_sendto(s, msgs[i].mm_m, msgs[i].mm_addr);
+        if (rc) {
+            break;
+        }
+    }
+    *done = i;
+    return rc;
+}
+
 int
 mn_getsockopt(struct mn_socket *s, uint8_t level, uint8_t name, void *val)
 {
@@ -123,9 +164,104 @@ mn_getpeername(struct mn_socket *s, struct mn_sockaddr *addr)
 int
 mn_close(struct mn_socket *s)
 {
+    if (s->ms_set) {
+        mn_socket_set_remove(s);
+    }
     return s->ms_ops->mso_close(s);
 }
 
+void
+mn_socket_set_init(struct mn_socket_set *set, struct os_eventq *evq,
+  os_event_fn *fn, void *arg)
+{
+    STAILQ_INIT(&set->mss_ready);
+    set->mss_evq = evq;
+    memset(&set->mss_ev, 0, sizeof(set->mss_ev));
+    set->mss_ev.ev_cb = fn;
+    set->mss_ev.ev_arg = arg;
+}
+
+int
+mn_socket_set_add(struct mn_socket_set *set, struct mn_socket *s,
+  uint8_t events)
+{
+    os_sr_t sr;
+
+    if (s->ms_set) {
+        return MN_EINVAL;
+    }
+    OS_ENTER_CRITICAL(sr);
+    s->ms_set_events = events;
+    s->ms_ready = 0;
+    s->ms_ready_err = 0;
+    s->ms_set = set;
+    OS_EXIT_CRITICAL(sr);
+    return 0;
+}
+
+int
+mn_socket_set_remove(struct mn_socket *s)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    if (!s->ms_set) {
+        OS_EXIT_CRITICAL(sr);
+        return MN_EINVAL;
+    }
+    if (s->ms_ready) {
+        STAILQ_REMOVE(&s->ms_set->mss_ready, s, mn_socket, ms_ready_next);
+        s->ms_ready = 0;
+    }
+    s->ms_set = NULL;
+    OS_EXIT_CRITICAL(sr);
+    return 0;
+}
+
+struct mn_socket *
+mn_socket_set_next(struct mn_socket_set *set, uint8_t *events, int *err)
+{
+    struct mn_socket *s;
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    s = STAILQ_FIRST(&set->mss_ready);
+    if (s) {
+        STAILQ_REMOVE_HEAD(&set->mss_ready, ms_ready_next);
+        *events = s->ms_ready;
+        *err = s->ms_ready_err;
+        s->ms_ready = 0;
+        s->ms_ready_err = 0;
+    }
+    OS_EXIT_CRITICAL(sr);
+    return s;
+}
+
+int
+mn_socket_set_ready(struct mn_socket *s, uint8_t event, int error)
+{
+    struct mn_socket_set *set;
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    set = s->ms_set;
+    if (!set || !(s->ms_set_events & event)) {
+        OS_EXIT_CRITICAL(sr);
+        return -1;
+    }
+    if (!s->ms_ready) {
+        STAILQ_INSERT_TAIL(&set->mss_ready, s, ms_ready_next);
+    }
+    s->ms_ready |= event;
+    if (error) {
+        s->ms_ready_err = error;
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    os_eventq_put(set->mss_evq, &set->mss_ev);
+    return 0;
+}
+
 int
 mn_itf_getnext(struct mn_itf *mi)
 {
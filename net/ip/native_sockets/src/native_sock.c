@@ -21,27 +21,50 @@
 #include <unistd.h>
 #include <errno.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <string.h>
-#include <poll.h>
 #include <assert.h>
 #include <fcntl.h>
+#include <signal.h>
+#include <pthread.h>
 #include <sys/ioctl.h>
 #include <sys/un.h>
 #include <stdio.h>
+#ifdef __linux__
+#include <sys/epoll.h>
+#else
+#include <sys/event.h>
+#include <sys/time.h>
+#endif
 
 #include "os/mynewt.h"
+#include "sim/sim.h"
 #include "mn_socket/mn_socket.h"
 #include "mn_socket/mn_socket_ops.h"
 #include "native_sockets/native_sock.h"
 
 #include "native_sock_priv.h"
 
+/*
+ * Host readiness is waited for with epoll (kqueue on BSD/macOS) by a
+ * pthread which blocks all signals.  When something becomes ready, it
+ * raises a sim I/O interrupt and waits until the socket task has collected
+ * the events and written a byte to io_ack.  Nothing runs while all the
+ * sockets are idle.
+ */
+#define NATIVE_SOCK_EV_RD       0x01
+#define NATIVE_SOCK_EV_WR       0x02
+#define NATIVE_SOCK_EV_MAX      (MYNEWT_VAL(NATIVE_SOCKETS_MAX) * 2)
+
 static struct native_sock {
     struct mn_socket ns_sock;
     int ns_fd;
     unsigned int ns_connect:1;  /* Non-blocking connect in progress. */
     unsigned int ns_poll:1;
     unsigned int ns_listen:1;
+    unsigned int ns_rd_armed:1; /* Report readability; cleared when
+                                   reported, set again by recvfrom. */
+    uint8_t ns_events;          /* NATIVE_SOCK_EV_xxx waited for */
     uint8_t ns_type;
     uint8_t ns_pf;
     struct os_sem ns_sem;
@@ -49,9 +72,17 @@ static struct native_sock {
     struct os_mbuf *ns_tx;
 } native_socks[MYNEWT_VAL(NATIVE_SOCKETS_MAX)];
 
+struct native_sock_ev {
+    struct native_sock *nse_sock;
+    uint8_t nse_events;
+};
+
 static struct native_sock_state {
-    struct pollfd poll_fds[MYNEWT_VAL(NATIVE_SOCKETS_MAX)];
-    int poll_fd_cnt;
+    int io_fd;                  /* epoll/kqueue descriptor */
+    int io_ack[2];
+    pthread_t io_thread;
+    struct os_eventq evq;
+    struct os_event io_ev;
     struct os_mutex mtx;
     struct os_task task;
 } native_sock_state;
@@ -88,48 +119,138 @@ native_get_sock(void)
             ns = &native_socks[i];
             ns->ns_poll = 0;
             ns->ns_listen = 0;
+            ns->ns_rd_armed = 1;
+            ns->ns_events = 0;
             return ns;
         }
     }
     return NULL;
 }
 
-static struct native_sock *
-native_find_sock(int fd)
+/*
+ * Brings the events waited for on the host in line with the socket state.
+ * Called with the state mutex held.
+ */
+static void
+native_sock_poll_update(struct native_sock_state *nss, struct native_sock *ns)
 {
-    int i;
+    uint8_t events;
+    int rc;
+#ifdef __linux__
+    struct epoll_event ev;
+    int op;
+#else
+    struct kevent kev[2];
+    int n;
+#endif
 
-    for (i = 0; i < MYNEWT_VAL(NATIVE_SOCKETS_MAX); i++) {
-        if (native_socks[i].ns_fd == fd) {
-            return &native_socks[i];
+    events = 0;
+    if (ns->ns_fd >= 0 && ns->ns_poll) {
+        if (ns->ns_listen || ns->ns_rd_armed) {
+            events |= NATIVE_SOCK_EV_RD;
+        }
+        if (ns->ns_connect || ns->ns_tx) {
+            events |= NATIVE_SOCK_EV_WR;
         }
     }
-    return NULL;
+    if (events == ns->ns_events) {
+        return;
+    }
+
+#ifdef __linux__
+    memset(&ev, 0, sizeof(ev));
+    if (events & NATIVE_SOCK_EV_RD) {
+        ev.events |= EPOLLIN;
+    }
+    if (events & NATIVE_SOCK_EV_WR) {
+        ev.events |= EPOLLOUT;
+    }
+    ev.data.ptr = ns;
+    if (ns->ns_events == 0) {
+        op = EPOLL_CTL_ADD;
+    } else if (events == 0) {
+        op = EPOLL_CTL_DEL;
+    } else {
+        op = EPOLL_CTL_MOD;
+    }
+    rc = epoll_ctl(nss->io_fd, op, ns->ns_fd, &ev);
+#else
+    n = 0;
+    if ((events ^ ns->ns_events) & NATIVE_SOCK_EV_RD) {
+        EV_SET(&kev[n++], ns->ns_fd, EVFILT_READ,
+               (events & NATIVE_SOCK_EV_RD) ? EV_ADD : EV_DELETE, 0, 0, ns);
+    }
+    if ((events ^ ns->ns_events) & NATIVE_SOCK_EV_WR) {
+        EV_SET(&kev[n++], ns->ns_fd, EVFILT_WRITE,
+               (events & NATIVE_SOCK_EV_WR) ? EV_ADD : EV_DELETE, 0, 0, ns);
+    }
+    rc = kevent(nss->io_fd, kev, n, NULL, 0, NULL);
+#endif
+    assert(rc == 0);
+    ns->ns_events = events;
 }
 
-static void
-native_sock_poll_rebuild(struct native_sock_state *nss)
+/*
+ * Collects ready sockets, waiting for one if block is set.
+ */
+static int
+native_sock_io_wait(int fd, struct native_sock_ev *evs, int max, int block)
 {
-    struct native_sock *ns;
+    int cnt;
     int i;
-    int j;
+#ifdef __linux__
+    struct epoll_event ev[NATIVE_SOCK_EV_MAX];
+
+    cnt = epoll_wait(fd, ev, max, block ? -1 : 0);
+    for (i = 0; i < cnt; i++) {
+        evs[i].nse_sock = ev[i].data.ptr;
+        evs[i].nse_events = 0;
+        if (ev[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+            evs[i].nse_events |= NATIVE_SOCK_EV_RD;
+        }
+        if (ev[i].events & (EPOLLOUT | EPOLLERR)) {
+            evs[i].nse_events |= NATIVE_SOCK_EV_WR;
+        }
+    }
+#else
+    struct kevent ev[NATIVE_SOCK_EV_MAX];
+    struct timespec ts = { 0, 0 };
+
+    cnt = kevent(fd, NULL, 0, ev, max, block ? NULL : &ts);
+    for (i = 0; i < cnt; i++) {
+        evs[i].nse_sock = ev[i].udata;
+        if (ev[i].filter == EVFILT_READ) {
+            evs[i].nse_events = NATIVE_SOCK_EV_RD;
+        } else {
+            evs[i].nse_events = NATIVE_SOCK_EV_WR;
+        }
+    }
+#endif
+    return cnt;
+}
 
-    os_mutex_pend(&nss->mtx, OS_WAIT_FOREVER);
-    for (i = 0, j = 0; i < MYNEWT_VAL(NATIVE_SOCKETS_MAX); i++) {
-        ns = &native_socks[i];
-        if (ns->ns_fd < 0) {
+static void *
+native_sock_io_thread(void *arg)
+{
+    struct native_sock_state *nss = arg;
+    struct native_sock_ev ev;
+    char c;
+
+    while (1) {
+        if (native_sock_io_wait(nss->io_fd, &ev, 1, 1) <= 0) {
             continue;
         }
-        if (!ns->ns_poll) {
-            continue;
+        sim_io_signal();
+        while (read(nss->io_ack[0], &c, 1) < 0 && errno == EINTR) {
         }
-        nss->poll_fds[j].fd = ns->ns_fd;
-        nss->poll_fds[j].events = POLLIN | POLLOUT;
-        nss->poll_fds[j].revents = 0;
-        j++;
     }
-    nss->poll_fd_cnt = j;
-    os_mutex_release(&nss->mtx);
+    return NULL;
+}
+
+static void
+native_sock_io_isr(void)
+{
+    os_eventq_put(&native_sock_state.evq, &native_sock_state.io_ev);
 }
 
 int
@@ -316,8 +437,11 @@ native_sock_close(struct mn_socket *s)
     struct os_mbuf_pkthdr *m;
 
     os_mutex_pend(&nss->mtx, OS_WAIT_FOREVER);
+    /* Closing the descriptor drops it from the epoll/kqueue set. */
     close(ns->ns_fd);
     ns->ns_fd = -1;
+    ns->ns_poll = 0;
+    ns->ns_events = 0;
 
     /*
      * When socket is closed, we must free all mbufs which might be
@@ -328,7 +452,7 @@ native_sock_close(struct mn_socket *s)
         os_mbuf_free_chain(OS_MBUF_PKTHDR_TO_MBUF(m));
     }
     os_mbuf_free_chain(ns->ns_tx);
-    native_sock_poll_rebuild(nss);
+    ns->ns_tx = NULL;
     os_mutex_release(&nss->mtx);
     return 0;
 }
@@ -362,7 +486,7 @@ native_sock_connect(struct mn_socket *s, struct mn_sockaddr *addr)
         }
     }
     ns->ns_poll = 1;
-    native_sock_poll_rebuild(nss);
+    native_sock_poll_update(nss, ns);
     os_mutex_release(&nss->mtx);
 
     /* Indicate writability if connection fully established. */
@@ -406,7 +530,7 @@ native_sock_bind(struct mn_socket *s, struct mn_sockaddr *addr)
     }
     if (ns->ns_type == SOCK_DGRAM) {
         ns->ns_poll = 1;
-        native_sock_poll_rebuild(nss);
+        native_sock_poll_update(nss, ns);
     }
     os_mutex_release(&nss->mtx);
     return 0;
@@ -431,7 +555,7 @@ native_sock_listen(struct mn_socket *s, uint8_t qlen)
     }
     ns->ns_poll = 1;
     ns->ns_listen = 1;
-    native_sock_poll_rebuild(nss);
+    native_sock_poll_update(nss, ns);
     os_mutex_release(&nss->mtx);
     return 0;
 }
@@ -466,7 +590,7 @@ native_sock_stream_tx(struct native_sock *ns, int notify)
             rc = 0;
         } else if (rc != -1) {
             /* Partial write. */
-            os_mbuf_adj(m, m->om_len - rc);
+            os_mbuf_adj(m, rc);
             rc = 0;
         } else {
             /* Error. */
@@ -484,6 +608,8 @@ native_sock_stream_tx(struct native_sock *ns, int notify)
             break;
         }
     }
+    /* Wait for room if anything is left over. */
+    native_sock_poll_update(nss, ns);
     os_mutex_release(&nss->mtx);
     if (notify) {
         mn_socket_writable(&ns->ns_sock, rc);
@@ -556,6 +682,7 @@ int
 native_sock_recvfrom(struct mn_socket *s, struct os_mbuf **mp,
   struct mn_sockaddr *addr)
 {
+    struct native_sock_state *nss = &native_sock_state;
     struct native_sock *ns = (struct native_sock *)s;
     struct sockaddr_storage ss;
     struct sockaddr *sa = (struct sockaddr *)&ss;
@@ -564,6 +691,15 @@ native_sock_recvfrom(struct mn_socket *s, struct os_mbuf **mp,
     socklen_t slen;
     int rc;
 
+    /*
+     * The application is reading again; report the socket the next time
+     * there is data that it did not pick up.
+     */
+    os_mutex_pend(&nss->mtx, OS_WAIT_FOREVER);
+    ns->ns_rd_armed = 1;
+    native_sock_poll_update(nss, ns);
+    os_mutex_release(&nss->mtx);
+
     slen = sizeof(ss);
     if (ns->ns_type == SOCK_DGRAM) {
         rc = recvfrom(ns->ns_fd, tmpbuf, sizeof(tmpbuf), 0, sa, &slen);
@@ -578,8 +714,10 @@ native_sock_recvfrom(struct mn_socket *s, struct os_mbuf **mp,
     }
     if (ns->ns_type == SOCK_STREAM && rc == 0) {
         mn_socket_readable(&ns->ns_sock, MN_ECONNABORTED);
+        os_mutex_pend(&nss->mtx, OS_WAIT_FOREVER);
         ns->ns_poll = 0;
-        native_sock_poll_rebuild(&native_sock_state);
+        native_sock_poll_update(nss, ns);
+        os_mutex_release(&nss->mtx);
         return MN_ECONNABORTED;
     }
 
@@ -682,6 +820,17 @@ native_sock_setsockopt(struct mn_socket *s, uint8_t level, uint8_t name,
                 return native_sock_err_to_mn_err(errno);
             }
             return 0;
+
+#ifdef TCP_CORK
+        case MN_SO_CORK:
+            val32 = *(int *)val;
+            rc = setsockopt(ns->ns_fd, IPPROTO_TCP, TCP_CORK, &val32,
+                            sizeof(val32));
+            if (rc) {
+                return native_sock_err_to_mn_err(errno);
+            }
+            return 0;
+#endif
         }
     }
     return MN_EPROTONOSUPPORT;
@@ -730,94 +879,99 @@ native_sock_getpeername(struct mn_socket *s, struct mn_sockaddr *addr)
 }
 
 /*
- * XXX should do this task with SIGIO as well.
+ * Handles the sockets which the I/O thread found ready, then lets it
+ * wait for more.
  */
 static void
-socket_task(void *arg)
+native_sock_io_event(struct os_event *ev)
 {
-    struct native_sock_state *nss = arg;
+    struct native_sock_state *nss = ev->ev_arg;
+    struct native_sock_ev evs[NATIVE_SOCK_EV_MAX];
     struct native_sock *ns, *new_ns;
     struct sockaddr_storage ss;
     struct sockaddr *sa = (struct sockaddr *)&ss;
-    int revents;
+    int events;
+    int cnt;
     int i;
     socklen_t slen;
     int sock_err;
     int rc;
 
     os_mutex_pend(&nss->mtx, OS_WAIT_FOREVER);
-    while (1) {
-        os_mutex_release(&nss->mtx);
-        os_time_delay(MYNEWT_VAL(NATIVE_SOCKETS_POLL_ITVL));
-        os_mutex_pend(&nss->mtx, OS_WAIT_FOREVER);
-        if (nss->poll_fd_cnt) {
-            rc = poll(nss->poll_fds, nss->poll_fd_cnt, 0);
-        } else {
-            rc = 0;
-        }
-        if (rc == 0) {
+    cnt = native_sock_io_wait(nss->io_fd, evs, NATIVE_SOCK_EV_MAX, 0);
+    for (i = 0; i < cnt; i++) {
+        ns = evs[i].nse_sock;
+        events = evs[i].nse_events & ns->ns_events;
+        if (ns->ns_fd < 0 || events == 0) {
+            /* Closed or no longer of interest since the event was queued. */
             continue;
         }
-        for (i = 0; i < nss->poll_fd_cnt; i++) {
-            if (nss->poll_fds[i].revents == 0) {
-                continue;
-            }
 
-            revents = nss->poll_fds[i].revents;
-            nss->poll_fds[i].revents = 0;
-
-            ns = native_find_sock(nss->poll_fds[i].fd);
-            assert(ns);
-
-            if (revents & POLLIN) {
-                if (ns->ns_listen) {
-                    new_ns = native_get_sock();
-                    if (!new_ns) {
-                        continue;
-                    }
-                    slen = sizeof(ss);
-                    new_ns->ns_fd = accept(ns->ns_fd, sa, &slen);
-                    if (new_ns->ns_fd < 0) {
-                        continue;
-                    }
-                    new_ns->ns_type = ns->ns_type;
-                    new_ns->ns_sock.ms_ops = &native_sock_ops;
-                    os_mutex_release(&nss->mtx);
-                    if (mn_socket_newconn(&ns->ns_sock, &new_ns->ns_sock)) {
-                        /*
-                         * should close
-                         */
-                    }
-                    os_mutex_pend(&nss->mtx, OS_WAIT_FOREVER);
-                    new_ns->ns_poll = 1;
-                    native_sock_poll_rebuild(nss);
-                } else {
-                    mn_socket_readable(&ns->ns_sock, 0);
+        if (events & NATIVE_SOCK_EV_RD) {
+            if (ns->ns_listen) {
+                new_ns = native_get_sock();
+                if (!new_ns) {
+                    continue;
                 }
-            }
-
-            if (revents & POLLOUT) {
-                if (ns->ns_connect) {
+                slen = sizeof(ss);
+                new_ns->ns_fd = accept(ns->ns_fd, sa, &slen);
+                if (new_ns->ns_fd < 0) {
+                    continue;
+                }
+                new_ns->ns_type = ns->ns_type;
+                new_ns->ns_sock.ms_ops = &native_sock_ops;
+                os_mutex_release(&nss->mtx);
+                if (mn_socket_newconn(&ns->ns_sock, &new_ns->ns_sock)) {
                     /*
-                     * The connection attempt has completed.  Report whether it
-                     * succeeded.
+                     * should close
                      */
-                    ns->ns_connect = 0;
-
-                    slen = sizeof(sock_err);
-                    rc = getsockopt(ns->ns_fd, SOL_SOCKET, SO_ERROR,
-                                    &sock_err, &slen);
-                    if (rc != 0) {
-                        rc = native_sock_err_to_mn_err(errno);
-                    } else if (sock_err != 0) {
-                        rc = native_sock_err_to_mn_err(sock_err);
-                    }
-                    mn_socket_writable(&ns->ns_sock, rc);
-                } else if (ns->ns_type == SOCK_STREAM && ns->ns_tx) {
-                    native_sock_stream_tx(ns, 1);
                 }
+                os_mutex_pend(&nss->mtx, OS_WAIT_FOREVER);
+                new_ns->ns_poll = 1;
+                native_sock_poll_update(nss, new_ns);
+            } else {
+                ns->ns_rd_armed = 0;
+                native_sock_poll_update(nss, ns);
+                mn_socket_readable(&ns->ns_sock, 0);
             }
         }
+
+        if (events & NATIVE_SOCK_EV_WR) {
+            if (ns->ns_connect) {
+                /*
+                 * The connection attempt has completed.  Report whether it
+                 * succeeded.
+                 */
+                ns->ns_connect = 0;
+                native_sock_poll_update(nss, ns);
+
+                slen = sizeof(sock_err);
+                rc = getsockopt(ns->ns_fd, SOL_SOCKET, SO_ERROR,
+                                &sock_err, &slen);
+                if (rc != 0) {
+                    rc = native_sock_err_to_mn_err(errno);
+                } else if (sock_err != 0) {
+                    rc = native_sock_err_to_mn_err(sock_err);
+                }
+                mn_socket_writable(&ns->ns_sock, rc);
+            } else if (ns->ns_type == SOCK_STREAM && ns->ns_tx) {
+                native_sock_stream_tx(ns, 1);
+            }
+        }
+    }
+    os_mutex_release(&nss->mtx);
+
+    rc = write(nss->io_ack[1], "", 1);
+    assert(rc == 1);
+}
+
+static void
+socket_task(void *arg)
+{
+    struct native_sock_state *nss = arg;
+
+    while (1) {
+        os_eventq_run(&nss->evq);
     }
 }
 
@@ -825,6 +979,8 @@ int
 native_sock_init(void)
 {
     struct native_sock_state *nss = &native_sock_state;
+    sigset_t sigs;
+    sigset_t osigs;
     int i;
     os_stack_t *sp;
 
@@ -835,11 +991,36 @@ native_sock_init(void)
         native_socks[i].ns_fd = -1;
         STAILQ_INIT(&native_socks[i].ns_rx);
     }
+#ifdef __linux__
+    nss->io_fd = epoll_create1(EPOLL_CLOEXEC);
+#else
+    nss->io_fd = kqueue();
+#endif
+    if (nss->io_fd < 0) {
+        return -1;
+    }
+    if (pipe(nss->io_ack)) {
+        return -1;
+    }
     sp = malloc(sizeof(os_stack_t) * MYNEWT_VAL(NATIVE_SOCKETS_STACK_SZ));
     if (!sp) {
         return -1;
     }
     os_mutex_init(&nss->mtx);
+    os_eventq_init(&nss->evq);
+    nss->io_ev.ev_cb = native_sock_io_event;
+    nss->io_ev.ev_arg = nss;
+    sim_io_handler_set(native_sock_io_isr);
+
+    /* The I/O thread inherits a mask with everything blocked. */
+    sigfillset(&sigs);
+    pthread_sigmask(SIG_SETMASK, &sigs, &osigs);
+    i = pthread_create(&nss->io_thread, NULL, native_sock_io_thread, nss);
+    pthread_sigmask(SIG_SETMASK, &osigs, NULL);
+    if (i) {
+        return -1;
+    }
+
     i = os_task_init(&nss->task, "socket", socket_task, &native_sock_state,
       MYNEWT_VAL(NATIVE_SOCKETS_PRIO), OS_WAIT_FOREVER, sp,
       MYNEWT_VAL(NATIVE_SOCKETS_STACK_SZ));
@@ -0,0 +1,105 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "ip_test.h"
+
+int ip_test_pbuf_frees[IP_TEST_PBUF_MAX];
+
+static struct pbuf_custom ip_test_pbufs[IP_TEST_PBUF_MAX];
+static uint8_t ip_test_data[IP_TEST_PBUF_MAX * IP_TEST_PBUF_LEN];
+
+static void
+ip_test_pbuf_free(struct pbuf *p)
+{
+    ip_test_pbuf_frees[(struct pbuf_custom *)p - ip_test_pbufs]++;
+}
+
+struct pbuf *
+ip_test_pbuf_chain(int cnt)
+{
+    struct pbuf *head;
+    struct pbuf *p;
+    int i;
+
+    TEST_ASSERT_FATAL(cnt > 0 && cnt <= IP_TEST_PBUF_MAX);
+
+    head = NULL;
+    for (i = 0; i < cnt; i++) {
+        ip_test_pbuf_frees[i] = 0;
+        ip_test_pbufs[i].custom_free_function = ip_test_pbuf_free;
+        p = pbuf_alloced_custom(PBUF_RAW, IP_TEST_PBUF_LEN, PBUF_REF,
+                                &ip_test_pbufs[i],
+                                &ip_test_data[i * IP_TEST_PBUF_LEN],
+                                IP_TEST_PBUF_LEN);
+        TEST_ASSERT_FATAL(p != NULL);
+        if (head) {
+            pbuf_cat(head, p);
+        } else {
+            head = p;
+        }
+    }
+
+    return head;
+}
+
+void
+ip_test_check_data(struct os_mbuf *m, int cnt)
+{
+    uint8_t buf[IP_TEST_PBUF_MAX * IP_TEST_PBUF_LEN];
+    int len;
+    int rc;
+
+    len = cnt * IP_TEST_PBUF_LEN;
+    TEST_ASSERT_FATAL(OS_MBUF_PKTLEN(m) == len);
+    rc = os_mbuf_copydata(m, 0, len, buf);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(memcmp(buf, ip_test_data, len) == 0);
+}
+
+void
+ip_test_check_frees(int cnt, int frees)
+{
+    int i;
+
+    for (i = 0; i < cnt; i++) {
+        TEST_ASSERT(ip_test_pbuf_frees[i] == frees, "pbuf %d freed %d times",
+                    i, ip_test_pbuf_frees[i]);
+    }
+}
+
+TEST_SUITE(ip_test_suite)
+{
+    int i;
+
+    for (i = 0; i < sizeof(ip_test_data); i++) {
+        ip_test_data[i] = i * 7;
+    }
+
+    lwip_sock_rx_ref_test();
+    lwip_sock_rx_copy_test();
+    lwip_sock_rx_msys_test();
+}
+
+int
+main(int argc, char **argv)
+{
+    ip_test_suite();
+
+    return tu_any_failed;
+}
@@ -0,0 +1,62 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef H_IP_TEST_
+#define H_IP_TEST_
+
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+#include "lwip/pbuf.h"
+#include "ip_priv.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Longest pbuf chain built by ip_test_pbuf_chain(). */
+#define IP_TEST_PBUF_MAX        8
+
+/* Length of each pbuf in a test chain. */
+#define IP_TEST_PBUF_LEN        32
+
+/* How many times each pbuf of the last test chain has been freed. */
+extern int ip_test_pbuf_frees[IP_TEST_PBUF_MAX];
+
+/*
+ * Builds a chain of cnt custom pbufs over a known byte pattern, and
+ * clears ip_test_pbuf_frees.
+ */
+struct pbuf *ip_test_pbuf_chain(int cnt);
+
+/* Checks that m holds the data of a cnt pbuf test chain. */
+void ip_test_check_data(struct os_mbuf *m, int cnt);
+
+/* Checks that each pbuf of a cnt pbuf test chain was freed frees times. */
+void ip_test_check_frees(int cnt, int frees);
+
+TEST_CASE_DECL(lwip_sock_rx_ref_test);
+TEST_CASE_DECL(lwip_sock_rx_copy_test);
+TEST_CASE_DECL(lwip_sock_rx_msys_test);
+TEST_SUITE_DECL(ip_test_suite);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,63 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "ip_test.h"
+
+TEST_CASE_SELF(lwip_sock_rx_msys_test)
+{
+    struct os_mbuf *held;
+    struct os_mbuf *om;
+    struct os_mbuf *m;
+    struct pbuf *p;
+    int i;
+
+    /*
+     * Take every msys mbuf, then give two back: one for the packet header
+     * and one for the first pbuf.  The chain runs out of mbufs on its
+     * second pbuf, after it has been handed over to the mbuf code.
+     */
+    held = NULL;
+    while ((om = os_msys_get(0, 0)) != NULL) {
+        SLIST_NEXT(om, om_next) = held;
+        held = om;
+    }
+    for (i = 0; i < 2; i++) {
+        om = held;
+        TEST_ASSERT_FATAL(om != NULL);
+        held = SLIST_NEXT(om, om_next);
+        os_mbuf_free(om);
+    }
+
+    p = ip_test_pbuf_chain(3);
+    m = lwip_sock_pbuf_to_mbuf(p, 0);
+    TEST_ASSERT(m == NULL);
+
+    /* Every pbuf is released exactly once, and nothing else is touched. */
+    ip_test_check_frees(3, 1);
+
+    os_mbuf_free_chain(held);
+
+    /* The descriptors were all returned. */
+    p = ip_test_pbuf_chain(MYNEWT_VAL(LWIP_SOCK_ZERO_COPY_RX_BUFS));
+    m = lwip_sock_pbuf_to_mbuf(p, 0);
+    TEST_ASSERT_FATAL(m != NULL);
+    ip_test_check_frees(MYNEWT_VAL(LWIP_SOCK_ZERO_COPY_RX_BUFS), 0);
+    os_mbuf_free_chain(m);
+    ip_test_check_frees(MYNEWT_VAL(LWIP_SOCK_ZERO_COPY_RX_BUFS), 1);
+}
@@ -0,0 +1,39 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "ip_test.h"
+
+TEST_CASE_SELF(lwip_sock_rx_ref_test)
+{
+    struct os_mbuf *m;
+    struct pbuf *p;
+
+    /*
+     * Enough descriptors and mbufs: the pbufs are referenced, not copied,
+     * and stay allocated until the mbuf is freed.
+     */
+    p = ip_test_pbuf_chain(3);
+    m = lwip_sock_pbuf_to_mbuf(p, 0);
+    TEST_ASSERT_FATAL(m != NULL);
+    ip_test_check_data(m, 3);
+    ip_test_check_frees(3, 0);
+
+    os_mbuf_free_chain(m);
+    ip_test_check_frees(3, 1);
+}
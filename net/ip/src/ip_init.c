@@ -24,6 +24,11 @@
 
 int ip_init(void)
 {
+#if MYNEWT_VAL(LWIP_MEM_MSYS)
+    if (lwip_msys_init()) {
+        return -1;
+    }
+#endif
     if (lwip_socket_init()) {
         return -1;
     }
@@ -34,6 +34,13 @@ void lwip_cli_init(void);
 
 int lwip_err_to_mn_err(int rc);
 
+struct pbuf;
+struct os_mbuf *lwip_sock_pbuf_to_mbuf(struct pbuf *p, int hdr_len);
+
+#if MYNEWT_VAL(LWIP_MEM_MSYS)
+int lwip_msys_init(void);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
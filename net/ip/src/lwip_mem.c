@@ -0,0 +1,118 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(LWIP_MEM_MSYS)
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ip_priv.h"
+
+/*
+ * lwIP's heap, and with MEMP_MEM_MALLOC its pools, allocate here.  Each
+ * block is the data buffer of an msys mbuf, so lwIP draws from the same
+ * memory as the rest of the system and shows up in the msys mempools.
+ * The block starts with a pointer to its mbuf; NULL marks the rare block
+ * too big for any msys pool, which comes from the heap instead.
+ */
+#define LWIP_MSYS_HDR_SIZE  OS_ALIGN(sizeof(struct os_mbuf *), OS_ALIGNMENT)
+
+#if MYNEWT_VAL(MSYS_QUOTA)
+static struct os_msys_consumer lwip_msys_consumer;
+#endif
+
+void *
+lwip_msys_malloc(size_t size)
+{
+    struct os_mbuf *m;
+    size_t total;
+    uint8_t *blk;
+
+    total = size + LWIP_MSYS_HDR_SIZE;
+    if (total > UINT16_MAX) {
+        return NULL;
+    }
+
+#if MYNEWT_VAL(MSYS_QUOTA)
+    m = os_msys_consumer_get(&lwip_msys_consumer, total, 0);
+#else
+    m = os_msys_get(total, 0);
+#endif
+    if (m == NULL) {
+        return NULL;
+    }
+
+    if (OS_MBUF_TRAILINGSPACE(m) < total) {
+        /* Larger than the biggest msys block */
+        os_mbuf_free(m);
+        m = NULL;
+        blk = malloc(total);
+        if (blk == NULL) {
+            return NULL;
+        }
+    } else {
+        blk = m->om_data;
+    }
+
+    memcpy(blk, &m, sizeof(m));
+    return blk + LWIP_MSYS_HDR_SIZE;
+}
+
+void *
+lwip_msys_calloc(size_t count, size_t size)
+{
+    void *p;
+
+    p = lwip_msys_malloc(count * size);
+    if (p != NULL) {
+        memset(p, 0, count * size);
+    }
+    return p;
+}
+
+void
+lwip_msys_free(void *p)
+{
+    struct os_mbuf *m;
+    uint8_t *blk;
+
+    blk = (uint8_t *)p - LWIP_MSYS_HDR_SIZE;
+    memcpy(&m, blk, sizeof(m));
+    if (m == NULL) {
+        free(blk);
+    } else {
+        os_mbuf_free(m);
+    }
+}
+
+int
+lwip_msys_init(void)
+{
+#if MYNEWT_VAL(MSYS_QUOTA)
+    return os_msys_consumer_register(&lwip_msys_consumer, "lwip",
+                                     MYNEWT_VAL(LWIP_MEM_MSYS_RESERVED),
+                                     MYNEWT_VAL(LWIP_MEM_MSYS_LIMIT));
+#else
+    return 0;
+#endif
+}
+
+#endif
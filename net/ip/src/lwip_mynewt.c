@@ -20,45 +20,60 @@
 #include <lwip/sys.h>
 #include <ip/os_queue.h>
 
-u32_t
-sys_arch_sem_wait(sys_sem_t *sem, u32_t timo)
+/*
+ * Converts an lwIP timeout to OS ticks.  lwIP's 0 means forever.  Other
+ * timeouts are rounded up, so that the task never wakes before the lwIP
+ * deadline it is sleeping for; rounding down made the tcpip thread wake
+ * early, find no expired timer, and poll with a 0 tick timeout until
+ * sys_now() caught up.
+ */
+static os_time_t
+sys_arch_timeout_ticks(u32_t timo)
 {
-    u32_t now;
+    uint64_t ticks;
 
     if (timo == 0) {
-        timo = OS_WAIT_FOREVER;
-    } else {
-        if (os_time_ms_to_ticks(timo, &timo)) {
-            timo = OS_WAIT_FOREVER - 1;
-        }
+        return OS_WAIT_FOREVER;
+    }
+
+    ticks = ((uint64_t)timo * OS_TICKS_PER_SEC + 999) / 1000;
+    if (ticks >= OS_WAIT_FOREVER) {
+        return OS_WAIT_FOREVER - 1;
     }
-    now = os_time_get();
-    if (os_sem_pend(sem, timo) == OS_TIMEOUT) {
+
+    return ticks;
+}
+
+static u32_t
+sys_arch_elapsed_ms(os_time_t start)
+{
+    return (uint64_t)(os_time_get() - start) * 1000 / OS_TICKS_PER_SEC;
+}
+
+u32_t
+sys_arch_sem_wait(sys_sem_t *sem, u32_t timo)
+{
+    os_time_t start;
+
+    start = os_time_get();
+    if (os_sem_pend(sem, sys_arch_timeout_ticks(timo)) == OS_TIMEOUT) {
         return SYS_ARCH_TIMEOUT;
     }
-    return (now - os_time_get()) * 1000 / OS_TICKS_PER_SEC;
+    return sys_arch_elapsed_ms(start);
 }
 
 u32_t
 sys_arch_mbox_fetch(sys_mbox_t *mbox, void **msg, uint32_t timo)
 {
-    u32_t now;
+    os_time_t start;
     void *val;
 
-    if (timo == 0) {
-        timo = OS_WAIT_FOREVER;
-    } else {
-        if (os_time_ms_to_ticks(timo, &timo)) {
-            timo = OS_WAIT_FOREVER - 1;
-        }
-    }
-    now = os_time_get();
-    if (os_queue_get(mbox, &val, timo)) {
+    start = os_time_get();
+    if (os_queue_get(mbox, &val, sys_arch_timeout_ticks(timo))) {
         return SYS_ARCH_TIMEOUT;
     }
     if (msg != NULL) {
         *msg = val;
     }
-    return (now - os_time_get()) * 1000 / OS_TICKS_PER_SEC;
+    return sys_arch_elapsed_ms(start);
 }
-
@@ -40,6 +40,8 @@ static int lwip_sendto(struct mn_socket *, struct os_mbuf *,
   struct mn_sockaddr *);
 static int lwip_recvfrom(struct mn_socket *, struct os_mbuf **,
   struct mn_sockaddr *);
+static int lwip_recvmmsg(struct mn_socket *, struct mn_mmsg *, int cnt,
+  int *done);
 static int lwip_getsockopt(struct mn_socket *, uint8_t level,
   uint8_t name, void *val);
 static int lwip_setsockopt(struct mn_socket *, uint8_t level,
@@ -57,6 +59,7 @@ static const struct mn_socket_ops lwip_sock_ops = {
 
     .mso_sendto = lwip_sendto,
     .mso_recvfrom = lwip_recvfrom,
+    .mso_recvmmsg = lwip_recvmmsg,
 
     .mso_getsockopt = lwip_getsockopt,
     .mso_setsockopt = lwip_setsockopt,
@@ -78,11 +81,49 @@ struct lwip_sock {
     } ls_pcb;
     STAILQ_HEAD(, os_mbuf_pkthdr) ls_rx;
     struct os_mbuf *ls_tx;
+#if LWIP_TCP
+    uint8_t ls_cork;
+    struct os_callout ls_cork_timer;
+#endif
 };
 
 static struct os_mempool lwip_sockets;
 
-static int lwip_stream_tx(struct lwip_sock *s, int notify);
+#if MYNEWT_VAL(LWIP_SOCK_ZERO_COPY_RX)
+/*
+ * A received pbuf, attached to an mbuf as external storage.
+ */
+struct lwip_sock_rx_ext {
+    struct os_mbuf_ext lsre_ext;
+    struct pbuf *lsre_p;
+};
+
+static struct os_mempool lwip_sock_rx_exts;
+static os_membuf_t lwip_sock_rx_ext_mem[
+    OS_MEMPOOL_SIZE(MYNEWT_VAL(LWIP_SOCK_ZERO_COPY_RX_BUFS),
+                    sizeof(struct lwip_sock_rx_ext))];
+#endif
+
+#if MYNEWT_VAL(LWIP_SOCK_ZERO_COPY_TX)
+/*
+ * pbuf referring to the data of an outgoing mbuf.  It is placed in the
+ * leading space of that mbuf, followed by room for the protocol headers,
+ * so that lwIP can treat it like a PBUF_RAM pbuf and prepend headers in
+ * place.
+ */
+struct lwip_sock_tx_pbuf {
+    struct pbuf_custom lstp_pc;
+    struct os_mbuf *lstp_om;
+};
+
+#define LWIP_SOCK_TX_HEADROOM                                           \
+    (PBUF_LINK_ENCAPSULATION_HLEN + PBUF_LINK_HLEN + PBUF_IP_HLEN + UDP_HLEN)
+#endif
+
+#if LWIP_TCP
+static int lwip_stream_tx(struct lwip_sock *s, int notify, int flush);
+static void lwip_sock_cork_tmo(struct os_event *ev);
+#endif
 
 static int
 lwip_mn_addr_to_addr(struct mn_sockaddr *ms, ip_addr_t *addr, uint16_t *port)
@@ -177,6 +218,105 @@ lwip_err_to_mn_err(int rc)
     }
 }
 
+#if MYNEWT_VAL(LWIP_SOCK_ZERO_COPY_RX)
+static void
+lwip_sock_rx_ext_free(struct os_mbuf_ext *ext, void *arg)
+{
+    struct lwip_sock_rx_ext *re = (struct lwip_sock_rx_ext *)arg;
+
+    pbuf_free(re->lsre_p);
+    os_memblock_put(&lwip_sock_rx_exts, re);
+}
+
+/*
+ * lwip_sock_rx_ref() return value when p has been consumed, but m could
+ * not be extended to hold all of it.  Positive, so that it cannot be
+ * mistaken for -1 (SYS_ENOMEM).
+ */
+#define LWIP_SOCK_RX_REF_PARTIAL    1
+
+/*
+ * Appends the pbuf chain p to m without copying, one mbuf per pbuf.
+ * Returns -1 with p untouched if there are not enough descriptors.
+ * Otherwise p is consumed, and the return value is 0 on success or
+ * LWIP_SOCK_RX_REF_PARTIAL if m could not be extended; the pbufs
+ * already attached to m are then released when m is freed.
+ */
+static int
+lwip_sock_rx_ref(struct os_mbuf *m, struct pbuf *p)
+{
+    struct lwip_sock_rx_ext *re;
+    struct pbuf *next;
+    int rc;
+
+    /* Descriptors are only taken here, so this cannot change under us. */
+    if (lwip_sock_rx_exts.mp_num_free < pbuf_clen(p)) {
+        return -1;
+    }
+    rc = 0;
+    for (; p; p = next) {
+        next = p->next;
+        if (next) {
+            /* Keep the tail once it is no longer referenced through p. */
+            pbuf_ref(next);
+            pbuf_dechain(p);
+        }
+        re = os_memblock_get(&lwip_sock_rx_exts);
+        assert(re);
+        re->lsre_p = p;
+        os_mbuf_ext_init(&re->lsre_ext, p->payload, p->len,
+                         lwip_sock_rx_ext_free, re);
+        if (!rc && os_mbuf_append_ext(m, &re->lsre_ext, 0, p->len)) {
+            rc = LWIP_SOCK_RX_REF_PARTIAL;
+        }
+        if (rc) {
+            lwip_sock_rx_ext_free(&re->lsre_ext, re);
+        }
+    }
+    return rc;
+}
+#endif
+
+/*
+ * Moves the data of a received pbuf chain into a packet mbuf with a user
+ * header of hdr_len bytes.  Consumes p.
+ */
+struct os_mbuf *
+lwip_sock_pbuf_to_mbuf(struct pbuf *p, int hdr_len)
+{
+    struct os_mbuf *m;
+    struct pbuf *q;
+#if MYNEWT_VAL(LWIP_SOCK_ZERO_COPY_RX)
+    int rc;
+
+    m = os_msys_get_pkthdr(0, hdr_len);
+    if (m) {
+        rc = lwip_sock_rx_ref(m, p);
+        if (rc == 0) {
+            return m;
+        } else if (rc == LWIP_SOCK_RX_REF_PARTIAL) {
+            /* p is gone; frees the pbufs that made it into m. */
+            os_mbuf_free_chain(m);
+            return NULL;
+        }
+        /* Out of descriptors; copy instead. */
+    }
+#else
+    m = os_msys_get_pkthdr(p->tot_len, hdr_len);
+#endif
+    if (m) {
+        for (q = p; q; q = q->next) {
+            if (os_mbuf_append(m, q->payload, q->len)) {
+                os_mbuf_free_chain(m);
+                m = NULL;
+                break;
+            }
+        }
+    }
+    pbuf_free(p);
+    return m;
+}
+
 #if LWIP_UDP
 static void
 lwip_sock_udp_rx(void *arg, struct udp_pcb *pcb, struct pbuf *p,
@@ -184,21 +324,13 @@ lwip_sock_udp_rx(void *arg, struct udp_pcb *pcb, struct pbuf *p,
 {
     struct lwip_sock *s = (struct lwip_sock *)arg;
     struct os_mbuf *m;
-    struct pbuf *q;
-    int off;
 
-    m = os_msys_get_pkthdr(p->tot_len, sizeof(struct mn_sockaddr_in6));
+    m = lwip_sock_pbuf_to_mbuf(p, sizeof(struct mn_sockaddr_in6));
     if (!m) {
-        pbuf_free(p);
         return;
     }
     lwip_addr_to_mn_addr((struct mn_sockaddr *)OS_MBUF_USRHDR(m),
       addr, port);
-    off = 0;
-    for (q = p; q; q = q->next) {
-        os_mbuf_copyinto(m, off, q->payload, p->len);
-    }
-    pbuf_free(p);
     STAILQ_INSERT_TAIL(&s->ls_rx, OS_MBUF_PKTHDR(m), omp_next);
     mn_socket_readable(&s->ls_sock, 0);
 }
@@ -210,8 +342,6 @@ lwip_sock_tcp_rx(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err)
 {
     struct lwip_sock *s = (struct lwip_sock *)arg;
     struct os_mbuf *m;
-    struct pbuf *q;
-    int off;
 
     if (!p) {
         /*
@@ -220,14 +350,8 @@ lwip_sock_tcp_rx(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err)
         mn_socket_readable(&s->ls_sock, MN_ECONNABORTED);
         return ERR_OK;
     }
-    m = os_msys_get_pkthdr(p->tot_len, 0);
+    m = lwip_sock_pbuf_to_mbuf(p, 0);
     assert(m);
-    /* XXX fix this */
-    off = 0;
-    for (q = p; q; q = q->next) {
-        os_mbuf_copyinto(m, off, q->payload, p->len);
-    }
-    pbuf_free(p);
     STAILQ_INSERT_TAIL(&s->ls_rx, OS_MBUF_PKTHDR(m), omp_next);
     mn_socket_readable(&s->ls_sock, 0);
 
@@ -239,7 +363,7 @@ lwip_sock_tcp_sent(void *arg, struct tcp_pcb *pcb, uint16_t len)
 {
     struct lwip_sock *s = (struct lwip_sock *)arg;
 
-    lwip_stream_tx(s, 1);
+    lwip_stream_tx(s, 1, 0);
     return ERR_OK;
 }
 
@@ -257,6 +381,9 @@ lwip_sock_tcp_err(void *arg, err_t err)
 {
     struct lwip_sock *s = (struct lwip_sock *)arg;
 
+    /* lwIP has already freed the pcb. */
+    s->ls_pcb.tcp = NULL;
+    os_callout_stop(&s->ls_cork_timer);
     mn_socket_writable(&s->ls_sock, lwip_err_to_mn_err(err));
 }
 
@@ -282,6 +409,9 @@ lwip_sock_accept(void *arg, struct tcp_pcb *new, err_t err)
     tcp_err(new, lwip_sock_tcp_err);
     STAILQ_INIT(&new_s->ls_rx);
     new_s->ls_tx = NULL;
+    new_s->ls_cork = 0;
+    os_callout_init(&new_s->ls_cork_timer, os_eventq_dflt_get(),
+      lwip_sock_cork_tmo, new_s);
     if (mn_socket_newconn(&s->ls_sock, &new_s->ls_sock)) {
         /* XXX close connection */
     }
@@ -314,6 +444,9 @@ lwip_sock_create(struct mn_socket **sp, uint8_t domain, uint8_t type,
 #endif
 #if LWIP_TCP
     case MN_SOCK_STREAM:
+        s->ls_cork = 0;
+        os_callout_init(&s->ls_cork_timer, os_eventq_dflt_get(),
+          lwip_sock_cork_tmo, s);
         s->ls_pcb.tcp = tcp_new();
         tcp_arg(s->ls_pcb.tcp, s);
         tcp_recv(s->ls_pcb.tcp, lwip_sock_tcp_rx);
@@ -349,10 +482,13 @@ lwip_close(struct mn_socket *ms)
 #endif
 #if LWIP_TCP
     case MN_SOCK_STREAM:
-        tcp_recv(s->ls_pcb.tcp, NULL);
-        tcp_sent(s->ls_pcb.tcp, NULL);
-        tcp_err(s->ls_pcb.tcp, NULL);
-        tcp_close(s->ls_pcb.tcp);
+        os_callout_stop(&s->ls_cork_timer);
+        if (s->ls_pcb.tcp) {
+            tcp_recv(s->ls_pcb.tcp, NULL);
+            tcp_sent(s->ls_pcb.tcp, NULL);
+            tcp_err(s->ls_pcb.tcp, NULL);
+            tcp_close(s->ls_pcb.tcp);
+        }
         break;
     }
 #endif
@@ -459,22 +595,76 @@ lwip_listen(struct mn_socket *ms, uint8_t qlen)
     return MN_EINVAL;
 }
 
+#if LWIP_TCP
+/*
+ * Moves queued data into the TCP send buffer, as much as fits in one go,
+ * and then has lwIP send it.  A corked socket only writes whole segments
+ * unless flush is set; the remainder waits for more data, uncorking or
+ * the cork timer.  Called with the TCPIP core locked.
+ */
 static int
-lwip_stream_tx(struct lwip_sock *s, int notify)
+lwip_stream_tx(struct lwip_sock *s, int notify, int flush)
 {
-    int rc;
+    struct tcp_pcb *pcb = s->ls_pcb.tcp;
     struct os_mbuf *m;
-    struct os_mbuf *n;
+    uint32_t avail;
+    uint16_t len;
+    uint8_t flags;
+    int written;
+    int held;
+    int rc;
+
+    if (!pcb) {
+        /* Reset or aborted; queued data is dropped on close. */
+        return MN_ENOTCONN;
+    }
+
+    avail = UINT32_MAX;
+    if (s->ls_cork && !flush && s->ls_tx) {
+        avail = os_mbuf_len(s->ls_tx);
+        avail -= avail % tcp_mss(pcb);
+    }
 
     rc = 0;
-    while (s->ls_tx && rc == 0) {
+    written = 0;
+    while (s->ls_tx && avail) {
         m = s->ls_tx;
-        n = SLIST_NEXT(m, om_next);
-        rc = tcp_write(s->ls_pcb.tcp, m->om_data, m->om_len, 0);
-        if (rc == 0) {
-            s->ls_tx = n;
+        if (m->om_len == 0) {
+            s->ls_tx = SLIST_NEXT(m, om_next);
             os_mbuf_free(m);
+            continue;
+        }
+        len = min(min(m->om_len, avail), tcp_sndbuf(pcb));
+        if (len == 0) {
+            rc = ERR_MEM;
+            break;
+        }
+        flags = TCP_WRITE_FLAG_COPY;
+        if (len < avail && (len < m->om_len || SLIST_NEXT(m, om_next))) {
+            /* more follows right away, don't push */
+            flags |= TCP_WRITE_FLAG_MORE;
         }
+        rc = tcp_write(pcb, m->om_data, len, flags);
+        if (rc) {
+            break;
+        }
+        written = 1;
+        avail -= len;
+        if (len == m->om_len) {
+            s->ls_tx = SLIST_NEXT(m, om_next);
+            os_mbuf_free(m);
+        } else {
+            os_mbuf_adj(m, len);
+        }
+    }
+    if (written) {
+        tcp_output(pcb);
+    }
+    held = (s->ls_tx && rc == 0);
+    if (held && !os_callout_queued(&s->ls_cork_timer)) {
+        /* corked remainder; send it anyway if nothing follows soon */
+        os_callout_reset(&s->ls_cork_timer,
+          os_time_ms_to_ticks32(MYNEWT_VAL(LWIP_SOCK_CORK_TMO)));
     }
     if (rc) {
         if (rc == ERR_MEM) {
@@ -484,7 +674,7 @@ lwip_stream_tx(struct lwip_sock *s, int notify)
         }
     }
     if (notify) {
-        if (s->ls_tx == NULL) {
+        if (s->ls_tx == NULL || held) {
             mn_socket_writable(&s->ls_sock, 0);
         } else if (rc) {
             mn_socket_writable(&s->ls_sock, rc);
@@ -493,6 +683,56 @@ lwip_stream_tx(struct lwip_sock *s, int notify)
     return rc;
 }
 
+static void
+lwip_sock_cork_tmo(struct os_event *ev)
+{
+    struct lwip_sock *s = (struct lwip_sock *)ev->ev_arg;
+
+    LOCK_TCPIP_CORE();
+    lwip_stream_tx(s, 1, 1);
+    UNLOCK_TCPIP_CORE();
+}
+#endif
+
+#if MYNEWT_VAL(LWIP_SOCK_ZERO_COPY_TX)
+static void
+lwip_sock_tx_pbuf_free(struct pbuf *p)
+{
+    struct lwip_sock_tx_pbuf *tp = (struct lwip_sock_tx_pbuf *)p;
+
+    /* tp lives inside the mbuf; NULL if the sender kept it. */
+    if (tp->lstp_om) {
+        os_mbuf_free_chain(tp->lstp_om);
+    }
+}
+
+/*
+ * Wraps a datagram in a pbuf without copying it, if it is held in one
+ * writable mbuf with enough leading space.
+ */
+static struct pbuf *
+lwip_sock_tx_ref(struct os_mbuf *m)
+{
+    struct lwip_sock_tx_pbuf *tp;
+    struct pbuf *p;
+
+    if (SLIST_NEXT(m, om_next) || !OS_MBUF_LEADINGSPACE(m)) {
+        return NULL;
+    }
+    tp = LWIP_MEM_ALIGN(m->om_data - OS_MBUF_LEADINGSPACE(m));
+    if ((uint8_t *)(tp + 1) + LWIP_SOCK_TX_HEADROOM > m->om_data) {
+        return NULL;
+    }
+    p = pbuf_alloced_custom(PBUF_RAW, m->om_len, PBUF_RAM, &tp->lstp_pc,
+      m->om_data, m->om_len);
+    if (p) {
+        tp->lstp_pc.custom_free_function = lwip_sock_tx_pbuf_free;
+        tp->lstp_om = m;
+    }
+    return p;
+}
+#endif
+
 static int
 lwip_sendto(struct mn_socket *ms, struct os_mbuf *m,
   struct mn_sockaddr *addr)
@@ -502,6 +742,7 @@ lwip_sendto(struct mn_socket *ms, struct os_mbuf *m,
     struct os_mbuf *n;
     ip_addr_t ip_addr;
     uint16_t port;
+    int zero_copy;
     int off;
     int rc;
 
@@ -515,43 +756,73 @@ lwip_sendto(struct mn_socket *ms, struct os_mbuf *m,
         if (rc) {
             return rc;
         }
-        off = 0;
-        for (n = m; n; n = SLIST_NEXT(n, om_next)) {
-            off += n->om_len;
-        }
-        p = pbuf_alloc(PBUF_TRANSPORT, off, PBUF_RAM);
+        p = NULL;
+#if MYNEWT_VAL(LWIP_SOCK_ZERO_COPY_TX)
+        p = lwip_sock_tx_ref(m);
+#endif
+        zero_copy = (p != NULL);
         if (!p) {
-            return MN_ENOBUFS;
-        }
+            off = 0;
+            for (n = m; n; n = SLIST_NEXT(n, om_next)) {
+                off += n->om_len;
+            }
+            p = pbuf_alloc(PBUF_TRANSPORT, off, PBUF_RAM);
+            if (!p) {
+                return MN_ENOBUFS;
+            }
 
-        off = 0;
-        for (n = m; n; n = SLIST_NEXT(n, om_next)) {
-            pbuf_take_at(p, n->om_data, n->om_len, off);
-            off += n->om_len;
+            off = 0;
+            for (n = m; n; n = SLIST_NEXT(n, om_next)) {
+                pbuf_take_at(p, n->om_data, n->om_len, off);
+                off += n->om_len;
+            }
         }
         LOCK_TCPIP_CORE();
         rc = udp_sendto(s->ls_pcb.udp, p, &ip_addr, port);
         UNLOCK_TCPIP_CORE();
         if (rc) {
             rc = lwip_err_to_mn_err(rc);
+#if MYNEWT_VAL(LWIP_SOCK_ZERO_COPY_TX)
+            if (zero_copy) {
+                /* The caller keeps the mbuf. */
+                ((struct lwip_sock_tx_pbuf *)p)->lstp_om = NULL;
+            }
+#endif
             pbuf_free(p);
             return rc;
         }
-        os_mbuf_free_chain(m);
+        if (!zero_copy) {
+            os_mbuf_free_chain(m);
+        }
+        /* A zero-copy mbuf is freed once lwIP lets go of the pbuf. */
         pbuf_free(p);
         return 0;
 #endif
 #if LWIP_TCP
     case MN_SOCK_STREAM:
-        if (s->ls_tx) {
-            return MN_EAGAIN;
-        }
         if (addr) {
             return MN_EINVAL;
         }
         LOCK_TCPIP_CORE();
-        s->ls_tx = m;
-        rc = lwip_stream_tx(s, 0);
+        if (!s->ls_pcb.tcp) {
+            UNLOCK_TCPIP_CORE();
+            return MN_ENOTCONN;
+        }
+        if (s->ls_tx) {
+            /*
+             * Only a corked socket holds on to data it could send; it can
+             * keep adding to it up to a send buffer's worth.
+             */
+            if (!s->ls_cork ||
+              os_mbuf_len(s->ls_tx) + OS_MBUF_PKTLEN(m) > TCP_SND_BUF) {
+                UNLOCK_TCPIP_CORE();
+                return MN_EAGAIN;
+            }
+            os_mbuf_concat(s->ls_tx, m);
+        } else {
+            s->ls_tx = m;
+        }
+        rc = lwip_stream_tx(s, 0, 0);
         UNLOCK_TCPIP_CORE();
         return rc;
 #endif
@@ -560,16 +831,18 @@ lwip_sendto(struct mn_socket *ms, struct os_mbuf *m,
     }
 }
 
+/*
+ * Takes the next packet off the receive queue. Called with the TCPIP core
+ * locked.
+ */
 static int
-lwip_recvfrom(struct mn_socket *ms, struct os_mbuf **mp,
+lwip_recvfrom_locked(struct lwip_sock *s, struct os_mbuf **mp,
   struct mn_sockaddr *addr)
 {
-    struct lwip_sock *s = (struct lwip_sock *)ms;
     struct mn_sockaddr *ms_a;
     struct os_mbuf_pkthdr *m;
     int slen;
 
-    LOCK_TCPIP_CORE();
     m = STAILQ_FIRST(&s->ls_rx);
     if (m) {
         STAILQ_REMOVE_HEAD(&s->ls_rx, omp_next);
@@ -593,15 +866,45 @@ lwip_recvfrom(struct mn_socket *ms, struct os_mbuf **mp,
 #endif
             }
         }
-        UNLOCK_TCPIP_CORE();
         return 0;
     } else {
-        UNLOCK_TCPIP_CORE();
         *mp = NULL;
         return MN_EAGAIN;
     }
 }
 
+static int
+lwip_recvfrom(struct mn_socket *ms, struct os_mbuf **mp,
+  struct mn_sockaddr *addr)
+{
+    int rc;
+
+    LOCK_TCPIP_CORE();
+    rc = lwip_recvfrom_locked((struct lwip_sock *)ms, mp, addr);
+    UNLOCK_TCPIP_CORE();
+    return rc;
+}
+
+static int
+lwip_recvmmsg(struct mn_socket *ms, struct mn_mmsg *msgs, int cnt, int *done)
+{
+    int rc;
+    int i;
+
+    rc = 0;
+    LOCK_TCPIP_CORE();
+    for (i = 0; i < cnt; i++) {
+        rc = lwip_recvfrom_locked((struct lwip_sock *)ms, &msgs[i].mm_m,
+                                  msgs[i].mm_addr);
+        if (rc) {
+            break;
+        }
+    }
+    UNLOCK_TCPIP_CORE();
+    *done = i;
+    return i ? 0 : rc;
+}
+
 static int
 lwip_getsockopt(struct mn_socket *s, uint8_t level,
   uint8_t name, void *val)
@@ -625,6 +928,7 @@ lwip_nif_from_idx(int idx)
 static int
 lwip_setsockopt(struct mn_socket *ms, uint8_t level, uint8_t name, void *val)
 {
+    struct lwip_sock *s;
     struct netif *nif;
     struct mn_mreq *mreq;
     int rc = MN_EPROTONOSUPPORT;
@@ -660,6 +964,24 @@ lwip_setsockopt(struct mn_socket *ms, uint8_t level, uint8_t name, void *val)
             }
             UNLOCK_TCPIP_CORE();
             return lwip_err_to_mn_err(rc);
+#if LWIP_TCP
+        case MN_SO_CORK:
+            s = (struct lwip_sock *)ms;
+            if (s->ls_type != MN_SOCK_STREAM) {
+                break;
+            }
+            LOCK_TCPIP_CORE();
+            s->ls_cork = (*(int *)val != 0);
+            rc = 0;
+            if (!s->ls_cork) {
+                os_callout_stop(&s->ls_cork_timer);
+                if (s->ls_pcb.tcp) {
+                    rc = lwip_stream_tx(s, 0, 1);
+                }
+            }
+            UNLOCK_TCPIP_CORE();
+            return rc;
+#endif
         case MN_MCAST_IF:
         default:
             break;
@@ -737,6 +1059,15 @@ lwip_socket_init(void)
         return -1;
     }
     os_mempool_init(&lwip_sockets, cnt, sizeof(struct lwip_sock), mem, "sock");
+#if MYNEWT_VAL(LWIP_SOCK_ZERO_COPY_RX)
+    rc = os_mempool_init(&lwip_sock_rx_exts,
+                         MYNEWT_VAL(LWIP_SOCK_ZERO_COPY_RX_BUFS),
+                         sizeof(struct lwip_sock_rx_ext),
+                         lwip_sock_rx_ext_mem, "sock_rx_ext");
+    if (rc) {
+        return -1;
+    }
+#endif
 
     rc = mn_socket_ops_reg(&lwip_sock_ops);
     if (rc) {
@@ -45,6 +45,8 @@ STATS_SECT_START(lora_mac_stats)
     STATS_SECT_ENTRY(rx_invalid)
     STATS_SECT_ENTRY(no_bufs)
     STATS_SECT_ENTRY(already_joined)
+    STATS_SECT_ENTRY(tx_dc_deferred)
+    STATS_SECT_ENTRY(tx_aggregated)
 STATS_SECT_END
 extern STATS_SECT_DECL(lora_mac_stats) lora_mac_stats;
 
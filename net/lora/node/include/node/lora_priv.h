@@ -143,10 +143,17 @@ struct lora_mac_obj
     int16_t lm_rssi_avg;
     int16_t lm_snr_avg;
 
-    /* TODO: this is temporary until we figure out a better way to deal */
-    /* Transmit queue timer */
+    /*
+     * Transmit queue timer. Runs the transmit queue again once the duty
+     * cycle allows it.
+     */
     struct os_callout lm_txq_timer;
 
+#if MYNEWT_VAL(LORA_NODE_TX_AGGREGATE)
+    /* Queued frames being sent together as the current uplink */
+    STAILQ_HEAD(, os_mbuf_pkthdr) lm_txagg;
+#endif
+
     /*
      * Pointer to the lora packet information of the packet being currently
      * transmitted.
@@ -209,6 +216,7 @@ void lora_app_init(void);
 struct os_mbuf;
 void lora_app_mcps_indicate(struct os_mbuf *om);
 void lora_app_mcps_confirm(struct os_mbuf *om);
+void lora_node_mcps_confirm(struct os_mbuf *om);
 void lora_app_join_confirm(LoRaMacEventInfoStatus_t status, uint8_t attempts);
 void lora_app_link_chk_confirm(LoRaMacEventInfoStatus_t status, uint8_t num_gw,
                                uint8_t demod_margin);
@@ -223,6 +231,7 @@ void lora_node_chk_txq(void);
 bool lora_node_txq_empty(void);
 bool lora_mac_srv_ack_requested(void);
 uint8_t lora_mac_cmd_buffer_len(void);
+uint32_t lora_mac_tx_time_off(void);
 void lora_node_qual_sample(int16_t rssi, int16_t snr);
 
 /* Lora debug log */
@@ -45,6 +45,8 @@ STATS_NAME_START(lora_mac_stats)
     STATS_NAME(lora_mac_stats, rx_invalid)
     STATS_NAME(lora_mac_stats, no_bufs)
     STATS_NAME(lora_mac_stats, already_joined)
+    STATS_NAME(lora_mac_stats, tx_dc_deferred)
+    STATS_NAME(lora_mac_stats, tx_aggregated)
 STATS_NAME_END(lora_mac_stats)
 
 /* Device EUI */
@@ -156,12 +158,40 @@ lora_node_mtu(void)
     return -1;
 }
 
+/**
+ * Hands a transmitted frame back to the application. A frame the transmit
+ * queue aggregated is split back into the frames that made it up, each of
+ * which gets the transmit status and info of the uplink.
+ *
+ * @param om Pointer to transmitted packet
+ */
+void
+lora_node_mcps_confirm(struct os_mbuf *om)
+{
+#if MYNEWT_VAL(LORA_NODE_TX_AGGREGATE)
+    struct lora_pkt_info *lpkt;
+    struct os_mbuf_pkthdr *mp;
+
+    if (!STAILQ_EMPTY(&g_lora_mac_data.lm_txagg)) {
+        lpkt = LORA_PKT_INFO_PTR(om);
+        while ((mp = STAILQ_FIRST(&g_lora_mac_data.lm_txagg)) != NULL) {
+            STAILQ_REMOVE_HEAD(&g_lora_mac_data.lm_txagg, omp_next);
+            memcpy(LORA_PKT_INFO_PTR(OS_MBUF_PKTHDR_TO_MBUF(mp)), lpkt,
+                   sizeof(struct lora_pkt_info));
+            lora_app_mcps_confirm(OS_MBUF_PKTHDR_TO_MBUF(mp));
+        }
+        os_mbuf_free_chain(om);
+        return;
+    }
+#endif
+    lora_app_mcps_confirm(om);
+}
+
 #if !MYNEWT_VAL(LORA_NODE_CLI)
 static void
-lora_node_reset_txq_timer(void)
+lora_node_reset_txq_timer(os_time_t ticks)
 {
-    /* XXX: For now, just reset timer to fire off in one second */
-    os_callout_reset(&g_lora_mac_data.lm_txq_timer, OS_TICKS_PER_SEC);
+    os_callout_reset(&g_lora_mac_data.lm_txq_timer, ticks);
 }
 
 /**
@@ -231,6 +261,113 @@ lora_node_mac_mcps_indicate(void)
     }
 }
 
+#if MYNEWT_VAL(LORA_NODE_TX_AGGREGATE)
+/**
+ * Gathers the unconfirmed frames queued right behind om for the same port
+ * into one uplink of at most max_len bytes. Payloads are concatenated as
+ * they are; the application must be able to split them. The frames are
+ * kept on lm_txagg until the uplink is confirmed.
+ *
+ * @param om        Frame just taken off the transmit queue
+ * @param max_len   Largest payload the next uplink can carry
+ *
+ * @return struct os_mbuf* The frame to send; om if nothing was added.
+ */
+static struct os_mbuf *
+lora_node_txq_aggregate(struct os_mbuf *om, uint8_t max_len)
+{
+    struct lora_pkt_info *lpkt;
+    struct lora_pkt_info *next;
+    struct os_mbuf_pkthdr *mp;
+    struct os_mbuf *agg;
+    uint16_t len;
+
+    assert(STAILQ_EMPTY(&g_lora_mac_data.lm_txagg));
+
+    lpkt = LORA_PKT_INFO_PTR(om);
+    if (lpkt->pkt_type != MCPS_UNCONFIRMED) {
+        return om;
+    }
+
+    agg = NULL;
+    len = OS_MBUF_PKTLEN(om);
+    while (1) {
+        mp = STAILQ_FIRST(&g_lora_mac_data.lm_txq.mq_head);
+        if (mp == NULL) {
+            break;
+        }
+        next = LORA_PKT_INFO_PTR(OS_MBUF_PKTHDR_TO_MBUF(mp));
+        if ((next->port != lpkt->port) ||
+            (next->pkt_type != MCPS_UNCONFIRMED) ||
+            ((len + mp->omp_len) > max_len)) {
+            break;
+        }
+
+        if (agg == NULL) {
+            agg = lora_pkt_alloc();
+            if (agg == NULL) {
+                STATS_INC(lora_mac_stats, no_bufs);
+                break;
+            }
+            memcpy(LORA_PKT_INFO_PTR(agg), lpkt, sizeof(struct lora_pkt_info));
+            if (os_mbuf_appendfrom(agg, om, 0, len)) {
+                os_mbuf_free_chain(agg);
+                agg = NULL;
+                break;
+            }
+            STAILQ_INSERT_TAIL(&g_lora_mac_data.lm_txagg, OS_MBUF_PKTHDR(om),
+                               omp_next);
+        }
+
+        if (os_mbuf_appendfrom(agg, OS_MBUF_PKTHDR_TO_MBUF(mp), 0,
+                               mp->omp_len)) {
+            /* Drop whatever part of this frame made it in */
+            os_mbuf_adj(agg, len - OS_MBUF_PKTLEN(agg));
+            break;
+        }
+        len += mp->omp_len;
+
+        om = os_mqueue_get(&g_lora_mac_data.lm_txq);
+        assert(om == OS_MBUF_PKTHDR_TO_MBUF(mp));
+        STAILQ_INSERT_TAIL(&g_lora_mac_data.lm_txagg, mp, omp_next);
+        STATS_INC(lora_mac_stats, tx_aggregated);
+    }
+
+    if (agg == NULL) {
+        return om;
+    }
+    return agg;
+}
+#endif
+
+/**
+ * Checks whether the duty cycle allows a transmission now and, if not,
+ * when it will. Frames stay on the transmit queue meanwhile, where
+ * later ones can still be aggregated with them.
+ *
+ * @return int 1 if the transmit queue timer was set; 0 otherwise.
+ */
+static int
+lora_node_txq_defer(void)
+{
+    uint32_t time_off;
+
+    if (lora_node_txq_empty() && !lora_mac_srv_ack_requested() &&
+        (lora_mac_cmd_buffer_len() == 0)) {
+        return 0;
+    }
+
+    time_off = lora_mac_tx_time_off();
+    if (time_off == 0) {
+        return 0;
+    }
+
+    STATS_INC(lora_mac_stats, tx_dc_deferred);
+    lora_node_log(LORA_NODE_LOG_TX_DELAY, 0, 0, time_off);
+    lora_node_reset_txq_timer(os_time_ms_to_ticks32(time_off / 1000 + 1));
+    return 1;
+}
+
 static uint8_t
 lora_node_get_batt_status(void)
 {
@@ -260,7 +397,12 @@ lora_mac_proc_tx_q_event(struct os_event *ev)
     /* If busy just leave */
     if (lora_mac_tx_state() == LORAMAC_STATUS_BUSY) {
         /* XXX: this should not be needed */
-        lora_node_reset_txq_timer();
+        lora_node_reset_txq_timer(OS_TICKS_PER_SEC);
+        return;
+    }
+
+    /* Wait for the next transmit window rather than have the MAC delay */
+    if (lora_node_txq_defer()) {
         return;
     }
 
@@ -316,6 +458,11 @@ send_empty_msg:
 send_from_txq:
             om = os_mqueue_get(&g_lora_mac_data.lm_txq);
             assert(om != NULL);
+#if MYNEWT_VAL(LORA_NODE_TX_AGGREGATE)
+            if (rc == LORAMAC_STATUS_OK) {
+                om = lora_node_txq_aggregate(om, txinfo.MaxPossiblePayload);
+            }
+#endif
             lpkt = LORA_PKT_INFO_PTR(om);
             g_lora_mac_data.curtx = lpkt;
             g_lora_node_last_tx_mac_cmd = 0;
@@ -382,7 +529,7 @@ send_from_txq:
          */
 proc_txq_om_done:
         lpkt->status = evstatus;
-        lora_app_mcps_confirm(om);
+        lora_node_mcps_confirm(om);
     }
 }
 
@@ -658,6 +805,9 @@ lora_node_init(void)
 
     /* Set up transmit done queue and event */
     os_mqueue_init(&g_lora_mac_data.lm_txq, lora_mac_proc_tx_q_event, NULL);
+#if MYNEWT_VAL(LORA_NODE_TX_AGGREGATE)
+    STAILQ_INIT(&g_lora_mac_data.lm_txagg);
+#endif
 
     /* Create the mac task */
     os_task_init(&g_lora_mac_task, "loramac", lora_mac_task, NULL,
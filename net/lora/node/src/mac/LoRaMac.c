@@ -535,7 +535,7 @@ lora_mac_send_mcps_confirm(LoRaMacEventInfoStatus_t status)
         assert(g_lora_mac_data.curtx != NULL);
         g_lora_mac_data.curtx->status = status;
         if (g_lora_mac_data.cur_tx_mbuf) {
-            lora_app_mcps_confirm(g_lora_mac_data.cur_tx_mbuf);
+            lora_node_mcps_confirm(g_lora_mac_data.cur_tx_mbuf);
         }
         LM_F_IS_MCPS_REQ() = 0;
     }
@@ -3254,6 +3254,49 @@ lora_mac_cmd_buffer_len(void)
     return MacCommandsBufferIndex + MacCommandsBufferToRepeatIndex;
 }
 
+/**
+ * Returns how long the duty cycle keeps the device off the air. This runs
+ * the same band and aggregated time-off bookkeeping as ScheduleTx() but
+ * does not select the transmit channel.
+ *
+ * @return uint32_t Time, in usecs, until a transmission can start. 0 if a
+ *                  frame can be sent now or if the MAC would not send it
+ *                  for some other reason.
+ */
+uint32_t
+lora_mac_tx_time_off(void)
+{
+    uint8_t chan;
+    TimerTime_t time_off;
+    LoRaMacStatus_t status;
+    NextChanParams_t nextChan;
+
+    if (!LM_F_IS_JOINED() || (g_lora_mac_data.max_dc == 255)) {
+        return 0;
+    }
+
+    if (g_lora_mac_data.max_dc == 0) {
+        g_lora_mac_data.aggr_time_off = 0;
+    }
+
+    CalculateBackOff(g_lora_mac_data.last_tx_chan);
+
+    nextChan.AggrTimeOff = g_lora_mac_data.aggr_time_off;
+    nextChan.Datarate = LoRaMacParams.ChannelsDatarate;
+    nextChan.DutyCycleEnabled = DutyCycleOn;
+    nextChan.Joined = true;
+    nextChan.LastAggrTx = g_lora_mac_data.aggr_last_tx_done_time;
+
+    time_off = 0;
+    status = RegionNextChannel(LoRaMacRegion, &nextChan, &chan, &time_off,
+                               &g_lora_mac_data.aggr_time_off);
+    if (status != LORAMAC_STATUS_DUTYCYCLE_RESTRICTED) {
+        return 0;
+    }
+
+    return time_off;
+}
+
 /* Extract only the mac commands that will fit */
 static uint8_t
 lora_mac_extract_mac_cmds(uint8_t max_cmd_bytes, uint8_t *buf)
@@ -20,6 +20,7 @@ Maintainer: Miguel Luis ( Semtech ), Gregory Cristian ( Semtech ) and Daniel Jä
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
+#include "os/mynewt.h"
 #include "node/utilities.h"
 
 #include "aes.h"
@@ -27,6 +28,10 @@ Maintainer: Miguel Luis ( Semtech ), Gregory Cristian ( Semtech ) and Daniel Jä
 
 #include "node/mac/LoRaMacCrypto.h"
 
+#if MYNEWT_VAL(LORA_NODE_CRYPTO)
+#include "crypto/crypto.h"
+#endif
+
 /*!
  * CMAC/AES Message Integrity Code (MIC) Block B0 size
  */
@@ -66,6 +71,178 @@ static aes_context AesContext;
  */
 static AES_CMAC_CTX AesCmacCtx[1];
 
+#if MYNEWT_VAL(LORA_NODE_CRYPTO)
+/*
+ * AES is done by the crypto device when it can do AES-128 ECB encryption,
+ * which is all LoRaWAN needs: CTR and CBC are used as well if the device
+ * has them. Anything the device fails to do falls back to software.
+ */
+#define LORA_CRYPTO_UNKNOWN     (0)
+#define LORA_CRYPTO_SW          (1)
+#define LORA_CRYPTO_HW          (2)
+
+static struct crypto_dev *lora_crypto_dev;
+static uint8_t lora_crypto_state;
+static uint8_t lora_crypto_has_ctr;
+static uint8_t lora_crypto_has_cbc;
+
+/* CMAC subkeys of the last key used */
+static uint8_t lora_cmac_key[16];
+static uint8_t lora_cmac_k1[16];
+static uint8_t lora_cmac_k2[16];
+static uint8_t lora_cmac_valid;
+
+static struct crypto_dev *
+lora_crypto_get(void)
+{
+    if (lora_crypto_state == LORA_CRYPTO_UNKNOWN) {
+        lora_crypto_state = LORA_CRYPTO_SW;
+        lora_crypto_dev = (struct crypto_dev *)
+            os_dev_open(MYNEWT_VAL(LORA_NODE_CRYPTO_DEV_NAME),
+                        OS_TIMEOUT_NEVER, NULL);
+        if (lora_crypto_dev != NULL &&
+            crypto_has_support(lora_crypto_dev, CRYPTO_OP_ENCRYPT,
+                               CRYPTO_ALGO_AES, CRYPTO_MODE_ECB, 128)) {
+            lora_crypto_has_ctr =
+                crypto_has_support(lora_crypto_dev, CRYPTO_OP_ENCRYPT,
+                                   CRYPTO_ALGO_AES, CRYPTO_MODE_CTR, 128);
+            lora_crypto_has_cbc =
+                crypto_has_support(lora_crypto_dev, CRYPTO_OP_ENCRYPT,
+                                   CRYPTO_ALGO_AES, CRYPTO_MODE_CBC, 128);
+            lora_crypto_state = LORA_CRYPTO_HW;
+        }
+    }
+
+    if (lora_crypto_state == LORA_CRYPTO_HW) {
+        return lora_crypto_dev;
+    }
+    return NULL;
+}
+
+/* Encrypts len bytes, a multiple of 16, with AES-128 ECB */
+static void
+lora_crypto_ecb(const uint8_t *key, const uint8_t *in, uint8_t *out,
+                uint16_t len)
+{
+    struct crypto_dev *crypto;
+    uint16_t off;
+
+    crypto = lora_crypto_get();
+    if (crypto != NULL &&
+        crypto_encrypt_aes_ecb(crypto, key, 128, in, out, len) == len) {
+        return;
+    }
+
+    memset(AesContext.ksch, '\0', 240);
+    aes_set_key(key, 16, &AesContext);
+    for (off = 0; off < len; off += 16) {
+        aes_encrypt(in + off, out + off, &AesContext);
+    }
+}
+
+/* Runs CBC-MAC over nblocks blocks of in, chaining through iv */
+static void
+lora_crypto_cbc_mac(const uint8_t *key, uint8_t *iv, const uint8_t *in,
+                    uint16_t nblocks)
+{
+    uint8_t scratch[64];
+    uint8_t chain[16];
+    uint16_t len;
+    int i;
+
+    while (lora_crypto_has_cbc && nblocks != 0) {
+        len = min(nblocks * 16, sizeof(scratch));
+        memcpy(chain, iv, sizeof(chain));
+        if (crypto_encrypt_aes_cbc(lora_crypto_dev, key, 128, chain, in,
+                                   scratch, len) != len) {
+            lora_crypto_has_cbc = 0;
+            break;
+        }
+        memcpy(iv, scratch + len - 16, 16);
+        in += len;
+        nblocks -= len / 16;
+    }
+
+    while (nblocks != 0) {
+        for (i = 0; i < 16; i++) {
+            iv[i] ^= in[i];
+        }
+        lora_crypto_ecb(key, iv, iv, 16);
+        in += 16;
+        nblocks--;
+    }
+}
+
+static void
+lora_cmac_shift(const uint8_t *in, uint8_t *out)
+{
+    uint8_t msb;
+    int i;
+
+    msb = in[0] & 0x80;
+    for (i = 0; i < 15; i++) {
+        out[i] = (in[i] << 1) | (in[i + 1] >> 7);
+    }
+    out[15] = in[15] << 1;
+    if (msb) {
+        out[15] ^= 0x87;
+    }
+}
+
+/**
+ * AES-CMAC (RFC 4493) over hdr, if not NULL, followed by len bytes of buf.
+ * hdr is a single 16 byte block.
+ */
+static void
+lora_crypto_cmac(const uint8_t *key, const uint8_t *hdr, const uint8_t *buf,
+                 uint16_t len, uint8_t *mac)
+{
+    uint8_t last[16];
+    uint16_t nblocks;
+    const uint8_t *subkey;
+    int i;
+
+    if (!lora_cmac_valid || memcmp(lora_cmac_key, key, 16) != 0) {
+        memset(last, 0, sizeof(last));
+        lora_crypto_ecb(key, last, last, 16);
+        lora_cmac_shift(last, lora_cmac_k1);
+        lora_cmac_shift(lora_cmac_k1, lora_cmac_k2);
+        memcpy(lora_cmac_key, key, 16);
+        lora_cmac_valid = 1;
+    }
+
+    if (hdr != NULL && len == 0) {
+        buf = hdr;
+        len = 16;
+        hdr = NULL;
+    }
+
+    memset(mac, 0, 16);
+    if (hdr != NULL) {
+        lora_crypto_cbc_mac(key, mac, hdr, 1);
+    }
+
+    /* All but the last block, which may be partial */
+    nblocks = (len == 0) ? 0 : (len - 1) / 16;
+    lora_crypto_cbc_mac(key, mac, buf, nblocks);
+    buf += nblocks * 16;
+    len -= nblocks * 16;
+
+    memset(last, 0, sizeof(last));
+    memcpy(last, buf, len);
+    if (len == 16) {
+        subkey = lora_cmac_k1;
+    } else {
+        last[len] = 0x80;
+        subkey = lora_cmac_k2;
+    }
+    for (i = 0; i < 16; i++) {
+        mac[i] ^= last[i] ^ subkey[i];
+    }
+    lora_crypto_ecb(key, mac, mac, 16);
+}
+#endif
+
 /*!
  * \brief Computes the LoRaMAC frame MIC field
  *
@@ -93,6 +270,15 @@ void LoRaMacComputeMic( const uint8_t *buffer, uint16_t size, const uint8_t *key
 
     MicBlockB0[15] = size & 0xFF;
 
+#if MYNEWT_VAL(LORA_NODE_CRYPTO)
+    if( lora_crypto_get( ) != NULL )
+    {
+        lora_crypto_cmac( key, MicBlockB0, buffer, size & 0xFF, Mic );
+        *mic = ( uint32_t )( ( uint32_t )Mic[3] << 24 | ( uint32_t )Mic[2] << 16 | ( uint32_t )Mic[1] << 8 | ( uint32_t )Mic[0] );
+        return;
+    }
+#endif
+
     AES_CMAC_Init( AesCmacCtx );
 
     AES_CMAC_SetKey( AesCmacCtx, key );
@@ -112,9 +298,6 @@ void LoRaMacPayloadEncrypt( const uint8_t *buffer, uint16_t size, const uint8_t
     uint8_t bufferIndex = 0;
     uint16_t ctr = 1;
 
-    memset( AesContext.ksch, '\0', 240 );
-    aes_set_key( key, 16, &AesContext );
-
     aBlock[5] = dir;
 
     aBlock[6] = ( address ) & 0xFF;
@@ -127,6 +310,39 @@ void LoRaMacPayloadEncrypt( const uint8_t *buffer, uint16_t size, const uint8_t
     aBlock[12] = ( sequenceCounter >> 16 ) & 0xFF;
     aBlock[13] = ( sequenceCounter >> 24 ) & 0xFF;
 
+#if MYNEWT_VAL(LORA_NODE_CRYPTO)
+    if( lora_crypto_get( ) != NULL )
+    {
+        // The A blocks are a big endian counter starting at 1; 16 blocks
+        // at most, so the counter never carries out of the last byte
+        aBlock[15] = 1;
+        if( lora_crypto_has_ctr )
+        {
+            memcpy( sBlock, aBlock, sizeof( sBlock ) );
+            if( crypto_encrypt_aes_ctr( lora_crypto_dev, key, 128, sBlock, buffer, encBuffer, size ) == size )
+            {
+                return;
+            }
+            lora_crypto_has_ctr = 0;
+        }
+        while( size > 0 )
+        {
+            lora_crypto_ecb( key, aBlock, sBlock, 16 );
+            for( i = 0; i < MIN( size, 16 ); i++ )
+            {
+                encBuffer[bufferIndex + i] = buffer[bufferIndex + i] ^ sBlock[i];
+            }
+            bufferIndex += i;
+            size -= i;
+            aBlock[15] = ( ( ++ctr ) & 0xFF );
+        }
+        return;
+    }
+#endif
+
+    memset( AesContext.ksch, '\0', 240 );
+    aes_set_key( key, 16, &AesContext );
+
     while( size >= 16 )
     {
         aBlock[15] = ( ( ctr ) & 0xFF );
@@ -158,6 +374,15 @@ void LoRaMacPayloadDecrypt( const uint8_t *buffer, uint16_t size, const uint8_t
 
 void LoRaMacJoinComputeMic( const uint8_t *buffer, uint16_t size, const uint8_t *key, uint32_t *mic )
 {
+#if MYNEWT_VAL(LORA_NODE_CRYPTO)
+    if( lora_crypto_get( ) != NULL )
+    {
+        lora_crypto_cmac( key, NULL, buffer, size & 0xFF, Mic );
+        *mic = ( uint32_t )( ( uint32_t )Mic[3] << 24 | ( uint32_t )Mic[2] << 16 | ( uint32_t )Mic[1] << 8 | ( uint32_t )Mic[0] );
+        return;
+    }
+#endif
+
     AES_CMAC_Init( AesCmacCtx );
 
     AES_CMAC_SetKey( AesCmacCtx, key );
@@ -171,6 +396,15 @@ void LoRaMacJoinComputeMic( const uint8_t *buffer, uint16_t size, const uint8_t
 
 void LoRaMacJoinDecrypt( const uint8_t *buffer, uint16_t size, const uint8_t *key, uint8_t *decBuffer )
 {
+#if MYNEWT_VAL(LORA_NODE_CRYPTO)
+    // The join accept is decrypted with an AES encrypt operation
+    if( lora_crypto_get( ) != NULL )
+    {
+        lora_crypto_ecb( key, buffer, decBuffer, ( size >= 16 ) ? 32 : 16 );
+        return;
+    }
+#endif
+
     memset( AesContext.ksch, '\0', 240 );
     aes_set_key( key, 16, &AesContext );
     aes_encrypt( buffer, decBuffer, &AesContext );
@@ -186,6 +420,21 @@ void LoRaMacJoinComputeSKeys( const uint8_t *key, const uint8_t *appNonce, uint1
     uint8_t nonce[16];
     uint8_t *pDevNonce = ( uint8_t * )&devNonce;
 
+#if MYNEWT_VAL(LORA_NODE_CRYPTO)
+    if( lora_crypto_get( ) != NULL )
+    {
+        memset( nonce, 0, sizeof( nonce ) );
+        nonce[0] = 0x01;
+        memcpy( nonce + 1, appNonce, 6 );
+        memcpy( nonce + 7, pDevNonce, 2 );
+        lora_crypto_ecb( key, nonce, nwkSKey, 16 );
+
+        nonce[0] = 0x02;
+        lora_crypto_ecb( key, nonce, appSKey, 16 );
+        return;
+    }
+#endif
+
     memset( AesContext.ksch, '\0', 240 );
     aes_set_key( key, 16, &AesContext );
 
@@ -0,0 +1,188 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef __MQTT_CLIENT_H__
+#define __MQTT_CLIENT_H__
+
+/**
+ * Non-blocking MQTT 3.1.1 client.
+ *
+ * The client runs from an event queue: socket activity and the keepalive
+ * timer are handled there, and the application hears about results through
+ * a single callback.  API calls never block; a publish is serialized into
+ * an mbuf and queued, and several can be on the wire, and waiting for
+ * acknowledgement, at once.
+ */
+
+#include "os/mynewt.h"
+#include "mn_socket/mn_socket.h"
+#include "mqtt/MQTTPacket.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MQTT_CLIENT_EV_CONNECTED        1   /* status: CONNACK return code */
+#define MQTT_CLIENT_EV_DISCONNECTED     2   /* status: SYS_Exxx, 0 if asked */
+#define MQTT_CLIENT_EV_PUBLISH          3   /* message received */
+#define MQTT_CLIENT_EV_PUB_DONE         4   /* QoS 1/2 publish acknowledged */
+#define MQTT_CLIENT_EV_SUBACK           5   /* status: granted QoS or 0x80 */
+#define MQTT_CLIENT_EV_UNSUBACK         6
+
+struct mqtt_client_event {
+    uint8_t type;
+    int status;
+    uint16_t packet_id;
+    /*
+     * MQTT_CLIENT_EV_PUBLISH only; valid during the callback.  The payload
+     * is data_len bytes at offset off in om, which the client keeps.  data
+     * also points at it when the whole packet fit in the receive buffer,
+     * and is NULL otherwise.
+     */
+    struct {
+        const char *topic;
+        uint16_t topic_len;
+        struct os_mbuf *om;
+        uint16_t off;
+        const uint8_t *data;
+        uint16_t data_len;
+        uint8_t qos;
+        uint8_t retained:1;
+        uint8_t dup:1;
+    } pub;
+};
+
+typedef void mqtt_client_event_fn(struct mqtt_client_event *ev, void *arg);
+
+struct mqtt_client_inflight {
+    uint16_t mci_packet_id;
+    uint8_t mci_state;
+    struct os_mbuf *mci_om;     /* PUBLISH kept for resending */
+};
+
+struct mqtt_client {
+    struct os_mutex mc_lock;
+    struct os_eventq *mc_evq;
+    mqtt_client_event_fn *mc_cb;
+    void *mc_cb_arg;
+
+    struct mn_socket *mc_sock;
+    uint8_t mc_state;
+    uint8_t mc_ping_out:1;
+    uint8_t mc_closing:1;
+    int mc_sock_err;
+    uint16_t mc_keepalive;      /* seconds */
+    uint16_t mc_next_pid;
+
+    struct os_event mc_rx_ev;
+    struct os_event mc_tx_ev;
+    struct os_callout mc_ping_timer;
+
+    struct os_mbuf *mc_rxq;     /* received, not yet parsed */
+    struct os_mbuf *mc_txq;     /* queued, not yet taken by the socket */
+    struct mqtt_client_inflight mc_inflight[MYNEWT_VAL(MQTT_CLIENT_INFLIGHT)];
+    uint8_t mc_rxbuf[MYNEWT_VAL(MQTT_CLIENT_RX_BUF_SZ)];
+};
+
+/**
+ * Initializes a client.
+ *
+ * @param c             The client to initialize.
+ * @param evq           Event queue the client runs from; NULL for the
+ *                          default event queue.
+ * @param cb            Called, with the client lock held, for each
+ *                          MQTT_CLIENT_EV_xxx.
+ * @param cb_arg        Argument passed to cb.
+ */
+void mqtt_client_init(struct mqtt_client *c, struct os_eventq *evq,
+                      mqtt_client_event_fn *cb, void *cb_arg);
+
+/**
+ * Opens a TCP connection to a broker and sends CONNECT.  Completion is
+ * reported with MQTT_CLIENT_EV_CONNECTED, or MQTT_CLIENT_EV_DISCONNECTED
+ * if the connection can't be made.
+ *
+ * QoS 1 and 2 publishes not yet acknowledged from a previous connection
+ * are sent again, with the DUP flag set, once the broker accepts.
+ *
+ * @param c             The client.
+ * @param addr          Broker address.
+ * @param opts          CONNECT options; serialized before returning.
+ *
+ * @return 0 on success; SYS_EALREADY if connected or connecting;
+ *         SYS_ENOMEM or SYS_EIO on failure.
+ */
+int mqtt_client_connect(struct mqtt_client *c, struct mn_sockaddr *addr,
+                        MQTTPacket_connectData *opts);
+
+/**
+ * Sends DISCONNECT and closes the connection once queued data has gone.
+ */
+int mqtt_client_disconnect(struct mqtt_client *c);
+
+/**
+ * Queues a message for publishing.
+ *
+ * @param c             The client.
+ * @param topic         Topic name.
+ * @param data          Payload; copied.
+ * @param len           Payload length.
+ * @param qos           0, 1 or 2.
+ * @param retain        Whether the broker should retain the message.
+ * @param packet_id     If not NULL, filled with the packet ID reported in
+ *                          MQTT_CLIENT_EV_PUB_DONE; 0 for QoS 0.
+ *
+ * @return 0 on success; SYS_ENODEV if not connected; SYS_EAGAIN if the
+ *         QoS window or transmit queue is full; SYS_ENOMEM if out of mbufs.
+ */
+int mqtt_client_publish(struct mqtt_client *c, const char *topic,
+                        const void *data, uint16_t len, uint8_t qos,
+                        uint8_t retain, uint16_t *packet_id);
+
+/**
+ * Queues a message whose payload is already in an mbuf chain.  The
+ * payload is not copied: the packet header goes in its leading space if
+ * there is room, or in an mbuf chained in front of it.
+ *
+ * @param om            Payload, a packet header chain; consumed on success.
+ *
+ * Other parameters and return codes are as for mqtt_client_publish().
+ */
+int mqtt_client_publish_mbuf(struct mqtt_client *c, const char *topic,
+                             struct os_mbuf *om, uint8_t qos, uint8_t retain,
+                             uint16_t *packet_id);
+
+/**
+ * Subscribes to a topic filter.  The broker's answer comes with
+ * MQTT_CLIENT_EV_SUBACK.
+ */
+int mqtt_client_subscribe(struct mqtt_client *c, const char *filter,
+                          uint8_t qos, uint16_t *packet_id);
+
+/**
+ * Unsubscribes from a topic filter; acknowledged with
+ * MQTT_CLIENT_EV_UNSUBACK.
+ */
+int mqtt_client_unsubscribe(struct mqtt_client *c, const char *filter,
+                            uint16_t *packet_id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MQTT_CLIENT_H__ */
@@ -0,0 +1,852 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+
+#include "os/mynewt.h"
+#include "mn_socket/mn_socket.h"
+#include "mqtt/MQTTPacket.h"
+#include "mqtt/MQTTMbuf.h"
+#include "mqtt_client/mqtt_client.h"
+
+#define MQTT_CLIENT_ST_IDLE             0
+#define MQTT_CLIENT_ST_TCP              1   /* TCP connect in progress */
+#define MQTT_CLIENT_ST_CONNACK          2   /* CONNECT sent */
+#define MQTT_CLIENT_ST_UP               3
+
+#define MQTT_CLIENT_MCI_FREE            0
+#define MQTT_CLIENT_MCI_PUBACK          1   /* QoS 1, PUBLISH sent */
+#define MQTT_CLIENT_MCI_PUBREC          2   /* QoS 2, PUBLISH sent */
+#define MQTT_CLIENT_MCI_PUBCOMP         3   /* QoS 2, PUBREL sent */
+
+#define MQTT_CLIENT_DUP_FLAG            0x08
+
+static void mqtt_client_readable(void *arg, int err);
+static void mqtt_client_writable(void *arg, int err);
+
+static const union mn_socket_cb mqtt_client_sock_cbs = {
+    .socket.readable = mqtt_client_readable,
+    .socket.writable = mqtt_client_writable,
+};
+
+static void
+mqtt_client_event(struct mqtt_client *c, struct mqtt_client_event *ev)
+{
+    if (c->mc_cb) {
+        c->mc_cb(ev, c->mc_cb_arg);
+    }
+}
+
+/*
+ * Allocates a packet of at most len bytes in a single mbuf, so that the
+ * Paho serializers can write straight into it.
+ */
+static struct os_mbuf *
+mqtt_client_pkt(int len)
+{
+    struct os_mbuf *m;
+
+    m = os_msys_get_pkthdr(len, 0);
+    if (!m) {
+        return NULL;
+    }
+    if (OS_MBUF_TRAILINGSPACE(m) < len) {
+        os_mbuf_free_chain(m);
+        return NULL;
+    }
+    return m;
+}
+
+static void
+mqtt_client_drop(struct mqtt_client *c, int status)
+{
+    struct mqtt_client_event ev = {
+        .type = MQTT_CLIENT_EV_DISCONNECTED,
+        .status = status,
+    };
+
+    if (c->mc_sock) {
+        mn_close(c->mc_sock);
+        c->mc_sock = NULL;
+    }
+    os_mbuf_free_chain(c->mc_rxq);
+    c->mc_rxq = NULL;
+    os_mbuf_free_chain(c->mc_txq);
+    c->mc_txq = NULL;
+    os_callout_stop(&c->mc_ping_timer);
+    c->mc_state = MQTT_CLIENT_ST_IDLE;
+    c->mc_closing = 0;
+    c->mc_ping_out = 0;
+
+    /* Unacknowledged publishes are kept; they go again on reconnect. */
+    mqtt_client_event(c, &ev);
+}
+
+/*
+ * Hands everything queued to the socket in one go.  If it is busy, the
+ * queue keeps growing until the next writable notification.
+ */
+static void
+mqtt_client_flush(struct mqtt_client *c)
+{
+    int rc;
+
+    if (!c->mc_sock || c->mc_state < MQTT_CLIENT_ST_CONNACK || !c->mc_txq) {
+        return;
+    }
+    rc = mn_sendto(c->mc_sock, c->mc_txq, NULL);
+    if (rc == 0) {
+        c->mc_txq = NULL;
+    } else if (rc != MN_EAGAIN) {
+        mqtt_client_drop(c, SYS_EIO);
+    }
+}
+
+static void
+mqtt_client_queue(struct mqtt_client *c, struct os_mbuf *m)
+{
+    if (c->mc_txq) {
+        os_mbuf_concat(c->mc_txq, m);
+    } else {
+        c->mc_txq = m;
+    }
+    mqtt_client_flush(c);
+}
+
+static int
+mqtt_client_send_ack(struct mqtt_client *c, uint8_t type, uint16_t packet_id)
+{
+    struct os_mbuf *m;
+    int rc;
+
+    m = mqtt_client_pkt(4);
+    if (!m) {
+        return SYS_ENOMEM;
+    }
+    rc = MQTTSerialize_ack(m->om_data, 4, type, 0, packet_id);
+    os_mbuf_extend(m, rc);
+    mqtt_client_queue(c, m);
+    return 0;
+}
+
+static uint16_t
+mqtt_client_next_pid(struct mqtt_client *c)
+{
+    uint16_t pid;
+    int i;
+
+again:
+    pid = ++c->mc_next_pid;
+    if (pid == 0) {
+        goto again;
+    }
+    for (i = 0; i < MYNEWT_VAL(MQTT_CLIENT_INFLIGHT); i++) {
+        if (c->mc_inflight[i].mci_state != MQTT_CLIENT_MCI_FREE &&
+            c->mc_inflight[i].mci_packet_id == pid) {
+            goto again;
+        }
+    }
+    return pid;
+}
+
+static struct mqtt_client_inflight *
+mqtt_client_inflight_find(struct mqtt_client *c, uint16_t pid, uint8_t state)
+{
+    struct mqtt_client_inflight *mci;
+    int i;
+
+    for (i = 0; i < MYNEWT_VAL(MQTT_CLIENT_INFLIGHT); i++) {
+        mci = &c->mc_inflight[i];
+        if (mci->mci_state == state && mci->mci_packet_id == pid) {
+            return mci;
+        }
+    }
+    return NULL;
+}
+
+static void
+mqtt_client_inflight_free(struct mqtt_client_inflight *mci)
+{
+    os_mbuf_free_chain(mci->mci_om);
+    mci->mci_om = NULL;
+    mci->mci_packet_id = 0;
+    mci->mci_state = MQTT_CLIENT_MCI_FREE;
+}
+
+/*
+ * Sends the unacknowledged part of the previous session again.
+ */
+static void
+mqtt_client_resend(struct mqtt_client *c)
+{
+    struct mqtt_client_inflight *mci;
+    struct os_mbuf *m;
+    uint8_t hdr;
+    int i;
+
+    for (i = 0; i < MYNEWT_VAL(MQTT_CLIENT_INFLIGHT); i++) {
+        mci = &c->mc_inflight[i];
+        switch (mci->mci_state) {
+        case MQTT_CLIENT_MCI_PUBACK:
+        case MQTT_CLIENT_MCI_PUBREC:
+            m = os_mbuf_dup(mci->mci_om);
+            if (!m) {
+                return;
+            }
+            os_mbuf_copydata(m, 0, 1, &hdr);
+            hdr |= MQTT_CLIENT_DUP_FLAG;
+            if (os_mbuf_copyinto(m, 0, &hdr, 1)) {
+                os_mbuf_free_chain(m);
+                return;
+            }
+            mqtt_client_queue(c, m);
+            break;
+        case MQTT_CLIENT_MCI_PUBCOMP:
+            mqtt_client_send_ack(c, PUBREL, mci->mci_packet_id);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+static void
+mqtt_client_pub_done(struct mqtt_client *c, struct mqtt_client_inflight *mci)
+{
+    struct mqtt_client_event ev = {
+        .type = MQTT_CLIENT_EV_PUB_DONE,
+        .packet_id = mci->mci_packet_id,
+    };
+
+    mqtt_client_inflight_free(mci);
+    mqtt_client_event(c, &ev);
+}
+
+/*
+ * Handles the PUBLISH, total bytes long, at the head of mc_rxq.  Only its
+ * header needs to fit in mc_rxbuf.
+ */
+static void
+mqtt_client_rx_publish(struct mqtt_client *c, int total)
+{
+    struct mqtt_client_event ev = { 0 };
+    MQTTString topic;
+    unsigned char dup;
+    unsigned char retained;
+    unsigned short pid = 0;
+    int off;
+    int len;
+    int qos;
+
+    if (MQTTDeserialize_publishMbuf(&dup, &qos, &retained, &pid, &topic,
+                                    &off, &len, c->mc_rxq, c->mc_rxbuf,
+                                    sizeof(c->mc_rxbuf)) != 1 ||
+        off + len != total) {
+        mqtt_client_drop(c, SYS_EREMOTEIO);
+        return;
+    }
+    ev.type = MQTT_CLIENT_EV_PUBLISH;
+    ev.packet_id = pid;
+    ev.pub.topic = topic.lenstring.data;
+    ev.pub.topic_len = topic.lenstring.len;
+    ev.pub.om = c->mc_rxq;
+    ev.pub.off = off;
+    if (total <= sizeof(c->mc_rxbuf)) {
+        ev.pub.data = c->mc_rxbuf + off;
+    }
+    ev.pub.data_len = len;
+    ev.pub.qos = qos;
+    ev.pub.retained = retained;
+    ev.pub.dup = dup;
+    mqtt_client_event(c, &ev);
+    if (qos == 1) {
+        mqtt_client_send_ack(c, PUBACK, pid);
+    } else if (qos == 2) {
+        mqtt_client_send_ack(c, PUBREC, pid);
+    }
+}
+
+/*
+ * Handles one complete packet other than PUBLISH, which is in mc_rxbuf.
+ */
+static void
+mqtt_client_rx_pkt(struct mqtt_client *c, int len)
+{
+    struct mqtt_client_event ev = { 0 };
+    struct mqtt_client_inflight *mci;
+    unsigned char *buf = c->mc_rxbuf;
+    MQTTHeader header;
+    unsigned char type;
+    unsigned char dup;
+    unsigned char session;
+    unsigned char connack_rc;
+    unsigned short pid;
+    int granted;
+    int count;
+
+    header.byte = buf[0];
+    switch (header.bits.type) {
+    case CONNACK:
+        if (c->mc_state != MQTT_CLIENT_ST_CONNACK ||
+            MQTTDeserialize_connack(&session, &connack_rc, buf, len) != 1) {
+            break;
+        }
+        ev.type = MQTT_CLIENT_EV_CONNECTED;
+        ev.status = connack_rc;
+        if (connack_rc == 0) {
+            c->mc_state = MQTT_CLIENT_ST_UP;
+            if (c->mc_keepalive) {
+                os_callout_reset(&c->mc_ping_timer,
+                                 c->mc_keepalive * OS_TICKS_PER_SEC);
+            }
+            mqtt_client_resend(c);
+        }
+        mqtt_client_event(c, &ev);
+        if (connack_rc != 0) {
+            mqtt_client_drop(c, SYS_EACCES);
+        }
+        return;
+    case PUBACK:
+    case PUBREC:
+    case PUBREL:
+    case PUBCOMP:
+        if (MQTTDeserialize_ack(&type, &dup, &pid, buf, len) != 1) {
+            break;
+        }
+        if (type == PUBACK) {
+            mci = mqtt_client_inflight_find(c, pid, MQTT_CLIENT_MCI_PUBACK);
+            if (mci) {
+                mqtt_client_pub_done(c, mci);
+            }
+        } else if (type == PUBREC) {
+            mci = mqtt_client_inflight_find(c, pid, MQTT_CLIENT_MCI_PUBREC);
+            if (mci) {
+                /* The broker has it; only PUBREL can need resending. */
+                os_mbuf_free_chain(mci->mci_om);
+                mci->mci_om = NULL;
+                mci->mci_state = MQTT_CLIENT_MCI_PUBCOMP;
+            }
+            mqtt_client_send_ack(c, PUBREL, pid);
+        } else if (type == PUBREL) {
+            mqtt_client_send_ack(c, PUBCOMP, pid);
+        } else {
+            mci = mqtt_client_inflight_find(c, pid, MQTT_CLIENT_MCI_PUBCOMP);
+            if (mci) {
+                mqtt_client_pub_done(c, mci);
+            }
+        }
+        return;
+    case SUBACK:
+        if (MQTTDeserialize_suback(&pid, 1, &count, &granted, buf, len) != 1) {
+            break;
+        }
+        ev.type = MQTT_CLIENT_EV_SUBACK;
+        ev.packet_id = pid;
+        ev.status = granted;
+        mqtt_client_event(c, &ev);
+        return;
+    case UNSUBACK:
+        if (MQTTDeserialize_unsuback(&pid, buf, len) != 1) {
+            break;
+        }
+        ev.type = MQTT_CLIENT_EV_UNSUBACK;
+        ev.packet_id = pid;
+        mqtt_client_event(c, &ev);
+        return;
+    case PINGRESP:
+        c->mc_ping_out = 0;
+        return;
+    default:
+        break;
+    }
+    mqtt_client_drop(c, SYS_EREMOTEIO);
+}
+
+/*
+ * Returns 1 and the total length of the packet at the head of om, 0 if
+ * more data is needed to tell, or -1 if the length is malformed.
+ */
+static int
+mqtt_client_pkt_len(struct os_mbuf *om, int *total)
+{
+    int mult = 1;
+    int val = 0;
+    int len;
+    int i;
+    uint8_t b;
+
+    len = OS_MBUF_PKTLEN(om);
+    for (i = 1; i <= 4; i++) {
+        if (i >= len) {
+            return 0;
+        }
+        os_mbuf_copydata(om, i, 1, &b);
+        val += (b & 127) * mult;
+        mult *= 128;
+        if (!(b & 128)) {
+            *total = 1 + i + val;
+            return 1;
+        }
+    }
+    return -1;
+}
+
+static void
+mqtt_client_rx_parse(struct mqtt_client *c)
+{
+    MQTTHeader header;
+    int total;
+    int done;
+    int rc;
+
+    while (c->mc_rxq && c->mc_sock) {
+        rc = mqtt_client_pkt_len(c->mc_rxq, &total);
+        if (rc == 0 || (rc > 0 && OS_MBUF_PKTLEN(c->mc_rxq) < total)) {
+            return;
+        }
+        if (rc < 0) {
+            mqtt_client_drop(c, SYS_EREMOTEIO);
+            return;
+        }
+        done = 0;
+        os_mbuf_copydata(c->mc_rxq, 0, 1, &header.byte);
+        if (header.bits.type == PUBLISH) {
+            mqtt_client_rx_publish(c, total);
+            if (!c->mc_rxq) {
+                return;
+            }
+            done = 1;
+        } else if (total <= sizeof(c->mc_rxbuf)) {
+            os_mbuf_copydata(c->mc_rxq, 0, total, c->mc_rxbuf);
+        } else {
+            /* Too big to look at; nothing but PUBLISH should be. */
+            done = 1;
+        }
+        os_mbuf_adj(c->mc_rxq, total);
+        if (OS_MBUF_PKTLEN(c->mc_rxq) == 0) {
+            os_mbuf_free_chain(c->mc_rxq);
+            c->mc_rxq = NULL;
+        } else {
+            c->mc_rxq = os_mbuf_trim_front(c->mc_rxq);
+        }
+        if (!done) {
+            mqtt_client_rx_pkt(c, total);
+        }
+    }
+}
+
+static void
+mqtt_client_rx_event(struct os_event *ev)
+{
+    struct mqtt_client *c = ev->ev_arg;
+    struct os_mbuf *m;
+    int rc;
+
+    os_mutex_pend(&c->mc_lock, OS_TIMEOUT_NEVER);
+    while (c->mc_sock) {
+        rc = mn_recvfrom(c->mc_sock, &m, NULL);
+        if (rc) {
+            if (rc != MN_EAGAIN) {
+                c->mc_sock_err = rc;
+            }
+            break;
+        }
+        if (c->mc_rxq) {
+            os_mbuf_concat(c->mc_rxq, m);
+        } else {
+            c->mc_rxq = m;
+        }
+    }
+    mqtt_client_rx_parse(c);
+    if (c->mc_sock && c->mc_sock_err) {
+        mqtt_client_drop(c, c->mc_sock_err == MN_ETIMEDOUT ?
+                            SYS_ETIMEOUT : SYS_EIO);
+    }
+    os_mutex_release(&c->mc_lock);
+}
+
+static void
+mqtt_client_tx_event(struct os_event *ev)
+{
+    struct mqtt_client *c = ev->ev_arg;
+
+    os_mutex_pend(&c->mc_lock, OS_TIMEOUT_NEVER);
+    if (!c->mc_sock) {
+        goto out;
+    }
+    if (c->mc_sock_err) {
+        mqtt_client_drop(c, c->mc_sock_err == MN_ETIMEDOUT ?
+                            SYS_ETIMEOUT : SYS_EIO);
+        goto out;
+    }
+    if (c->mc_state == MQTT_CLIENT_ST_TCP) {
+        /* Connected; CONNECT is waiting in the queue. */
+        c->mc_state = MQTT_CLIENT_ST_CONNACK;
+    }
+    mqtt_client_flush(c);
+    if (c->mc_sock && c->mc_closing && !c->mc_txq) {
+        mqtt_client_drop(c, 0);
+    }
+out:
+    os_mutex_release(&c->mc_lock);
+}
+
+static void
+mqtt_client_ping_tmo(struct os_event *ev)
+{
+    struct mqtt_client *c = ev->ev_arg;
+    struct os_mbuf *m;
+
+    os_mutex_pend(&c->mc_lock, OS_TIMEOUT_NEVER);
+    if (c->mc_state != MQTT_CLIENT_ST_UP) {
+        goto out;
+    }
+    if (c->mc_ping_out) {
+        mqtt_client_drop(c, SYS_ETIMEOUT);
+        goto out;
+    }
+    m = mqtt_client_pkt(2);
+    if (m) {
+        os_mbuf_extend(m, MQTTSerialize_pingreq(m->om_data, 2));
+        c->mc_ping_out = 1;
+        mqtt_client_queue(c, m);
+    }
+    if (c->mc_state == MQTT_CLIENT_ST_UP) {
+        os_callout_reset(&c->mc_ping_timer,
+                         c->mc_keepalive * OS_TICKS_PER_SEC);
+    }
+out:
+    os_mutex_release(&c->mc_lock);
+}
+
+static void
+mqtt_client_readable(void *arg, int err)
+{
+    struct mqtt_client *c = arg;
+
+    if (err) {
+        c->mc_sock_err = err;
+    }
+    os_eventq_put(c->mc_evq, &c->mc_rx_ev);
+}
+
+static void
+mqtt_client_writable(void *arg, int err)
+{
+    struct mqtt_client *c = arg;
+
+    if (err) {
+        c->mc_sock_err = err;
+    }
+    os_eventq_put(c->mc_evq, &c->mc_tx_ev);
+}
+
+void
+mqtt_client_init(struct mqtt_client *c, struct os_eventq *evq,
+                 mqtt_client_event_fn *cb, void *cb_arg)
+{
+    memset(c, 0, sizeof(*c));
+    os_mutex_init(&c->mc_lock);
+    c->mc_evq = evq ? evq : os_eventq_dflt_get();
+    c->mc_cb = cb;
+    c->mc_cb_arg = cb_arg;
+    c->mc_rx_ev.ev_cb = mqtt_client_rx_event;
+    c->mc_rx_ev.ev_arg = c;
+    c->mc_tx_ev.ev_cb = mqtt_client_tx_event;
+    c->mc_tx_ev.ev_arg = c;
+    os_callout_init(&c->mc_ping_timer, c->mc_evq, mqtt_client_ping_tmo, c);
+}
+
+int
+mqtt_client_connect(struct mqtt_client *c, struct mn_sockaddr *addr,
+                    MQTTPacket_connectData *opts)
+{
+    struct os_mbuf *m;
+    int len;
+    int rc;
+    int i;
+
+    os_mutex_pend(&c->mc_lock, OS_TIMEOUT_NEVER);
+    if (c->mc_sock) {
+        rc = SYS_EALREADY;
+        goto out;
+    }
+
+    len = MQTTPacket_len(MQTTSerialize_connectLength(opts));
+    m = mqtt_client_pkt(len);
+    if (!m) {
+        rc = SYS_ENOMEM;
+        goto out;
+    }
+    rc = MQTTSerialize_connect(m->om_data, len, opts);
+    if (rc <= 0) {
+        os_mbuf_free_chain(m);
+        rc = SYS_EINVAL;
+        goto out;
+    }
+    os_mbuf_extend(m, rc);
+
+    if (opts->cleansession) {
+        for (i = 0; i < MYNEWT_VAL(MQTT_CLIENT_INFLIGHT); i++) {
+            mqtt_client_inflight_free(&c->mc_inflight[i]);
+        }
+    }
+
+    if (mn_socket(&c->mc_sock, addr->msa_family, MN_SOCK_STREAM, 0)) {
+        c->mc_sock = NULL;
+        os_mbuf_free_chain(m);
+        rc = SYS_EIO;
+        goto out;
+    }
+    mn_socket_set_cbs(c->mc_sock, c, &mqtt_client_sock_cbs);
+    c->mc_txq = m;
+    c->mc_keepalive = opts->keepAliveInterval;
+    c->mc_sock_err = 0;
+    c->mc_state = MQTT_CLIENT_ST_TCP;
+    if (mn_connect(c->mc_sock, addr)) {
+        mn_close(c->mc_sock);
+        c->mc_sock = NULL;
+        os_mbuf_free_chain(c->mc_txq);
+        c->mc_txq = NULL;
+        c->mc_state = MQTT_CLIENT_ST_IDLE;
+        rc = SYS_EIO;
+        goto out;
+    }
+    rc = 0;
+out:
+    os_mutex_release(&c->mc_lock);
+    return rc;
+}
+
+int
+mqtt_client_disconnect(struct mqtt_client *c)
+{
+    struct os_mbuf *m;
+    int rc;
+
+    os_mutex_pend(&c->mc_lock, OS_TIMEOUT_NEVER);
+    if (!c->mc_sock) {
+        rc = SYS_EALREADY;
+        goto out;
+    }
+    rc = 0;
+    if (c->mc_state < MQTT_CLIENT_ST_CONNACK) {
+        mqtt_client_drop(c, 0);
+        goto out;
+    }
+    m = mqtt_client_pkt(2);
+    if (m) {
+        os_mbuf_extend(m, MQTTSerialize_disconnect(m->om_data, 2));
+        mqtt_client_queue(c, m);
+    }
+    c->mc_closing = 1;
+    if (c->mc_sock && !c->mc_txq) {
+        mqtt_client_drop(c, 0);
+    }
+out:
+    os_mutex_release(&c->mc_lock);
+    return rc;
+}
+
+int
+mqtt_client_publish_mbuf(struct mqtt_client *c, const char *topic,
+                         struct os_mbuf *om, uint8_t qos, uint8_t retain,
+                         uint16_t *packet_id)
+{
+    MQTTString t = MQTTString_initializer;
+    struct mqtt_client_inflight *mci;
+    struct os_mbuf *m;
+    uint16_t pid;
+    int len;
+    int rc;
+
+    if (qos > 2) {
+        return SYS_EINVAL;
+    }
+    t.cstring = (char *)topic;
+    len = OS_MBUF_PKTLEN(om);
+
+    os_mutex_pend(&c->mc_lock, OS_TIMEOUT_NEVER);
+    if (c->mc_state != MQTT_CLIENT_ST_UP || c->mc_closing) {
+        rc = SYS_ENODEV;
+        goto out;
+    }
+    if (c->mc_txq &&
+        OS_MBUF_PKTLEN(c->mc_txq) >= MYNEWT_VAL(MQTT_CLIENT_TXQ_MAX)) {
+        rc = SYS_EAGAIN;
+        goto out;
+    }
+    mci = NULL;
+    pid = 0;
+    if (qos > 0) {
+        mci = mqtt_client_inflight_find(c, 0, MQTT_CLIENT_MCI_FREE);
+        if (!mci) {
+            rc = SYS_EAGAIN;
+            goto out;
+        }
+        pid = mqtt_client_next_pid(c);
+    }
+
+    m = MQTTSerialize_publishMbuf(0, qos, retain, pid, t, om);
+    if (!m) {
+        rc = SYS_ENOMEM;
+        goto out;
+    }
+    if (mci) {
+        /* A reference to resend from if the connection drops first. */
+        mci->mci_om = os_mbuf_dup(m);
+        if (!mci->mci_om) {
+            /* Hand the payload back the way it came. */
+            if (m == om) {
+                os_mbuf_adj(om, OS_MBUF_PKTLEN(m) - len);
+            } else {
+                SLIST_NEXT(m, om_next) = NULL;
+                os_mbuf_free_chain(m);
+            }
+            rc = SYS_ENOMEM;
+            goto out;
+        }
+        mci->mci_packet_id = pid;
+        mci->mci_state = qos == 1 ? MQTT_CLIENT_MCI_PUBACK :
+                                    MQTT_CLIENT_MCI_PUBREC;
+    }
+    mqtt_client_queue(c, m);
+    if (packet_id) {
+        *packet_id = pid;
+    }
+    rc = 0;
+out:
+    os_mutex_release(&c->mc_lock);
+    return rc;
+}
+
+int
+mqtt_client_publish(struct mqtt_client *c, const char *topic,
+                    const void *data, uint16_t len, uint8_t qos,
+                    uint8_t retain, uint16_t *packet_id)
+{
+    MQTTString t = MQTTString_initializer;
+    struct os_mbuf *m;
+    int hdr_len;
+    int rc;
+
+    t.cstring = (char *)topic;
+    hdr_len = MQTTPacket_len(MQTTSerialize_publishLength(qos, t, len)) - len;
+
+    /* Leave room for the header so that it goes in the same mbuf. */
+    m = os_msys_get_pkthdr(hdr_len + len, 0);
+    if (!m) {
+        return SYS_ENOMEM;
+    }
+    if (OS_MBUF_TRAILINGSPACE(m) >= hdr_len) {
+        m->om_data += hdr_len;
+    }
+    if (os_mbuf_append(m, data, len)) {
+        os_mbuf_free_chain(m);
+        return SYS_ENOMEM;
+    }
+    rc = mqtt_client_publish_mbuf(c, topic, m, qos, retain, packet_id);
+    if (rc) {
+        os_mbuf_free_chain(m);
+    }
+    return rc;
+}
+
+int
+mqtt_client_subscribe(struct mqtt_client *c, const char *filter,
+                      uint8_t qos, uint16_t *packet_id)
+{
+    MQTTString t = MQTTString_initializer;
+    struct os_mbuf *m;
+    uint16_t pid;
+    int req_qos = qos;
+    int len;
+    int rc;
+
+    t.cstring = (char *)filter;
+
+    os_mutex_pend(&c->mc_lock, OS_TIMEOUT_NEVER);
+    if (c->mc_state != MQTT_CLIENT_ST_UP || c->mc_closing) {
+        rc = SYS_ENODEV;
+        goto out;
+    }
+    len = MQTTPacket_len(MQTTSerialize_subscribeLength(1, &t));
+    m = mqtt_client_pkt(len);
+    if (!m) {
+        rc = SYS_ENOMEM;
+        goto out;
+    }
+    pid = mqtt_client_next_pid(c);
+    rc = MQTTSerialize_subscribe(m->om_data, len, 0, pid, 1, &t, &req_qos);
+    if (rc <= 0) {
+        os_mbuf_free_chain(m);
+        rc = SYS_EINVAL;
+        goto out;
+    }
+    os_mbuf_extend(m, rc);
+    mqtt_client_queue(c, m);
+    if (packet_id) {
+        *packet_id = pid;
+    }
+    rc = 0;
+out:
+    os_mutex_release(&c->mc_lock);
+    return rc;
+}
+
+int
+mqtt_client_unsubscribe(struct mqtt_client *c, const char *filter,
+                        uint16_t *packet_id)
+{
+    MQTTString t = MQTTString_initializer;
+    struct os_mbuf *m;
+    uint16_t pid;
+    int len;
+    int rc;
+
+    t.cstring = (char *)filter;
+
+    os_mutex_pend(&c->mc_lock, OS_TIMEOUT_NEVER);
+    if (c->mc_state != MQTT_CLIENT_ST_UP || c->mc_closing) {
+        rc = SYS_ENODEV;
+        goto out;
+    }
+    len = MQTTPacket_len(MQTTSerialize_unsubscribeLength(1, &t));
+    m = mqtt_client_pkt(len);
+    if (!m) {
+        rc = SYS_ENOMEM;
+        goto out;
+    }
+    pid = mqtt_client_next_pid(c);
+    rc = MQTTSerialize_unsubscribe(m->om_data, len, 0, pid, 1, &t);
+    if (rc <= 0) {
+        os_mbuf_free_chain(m);
+        rc = SYS_EINVAL;
+        goto out;
+    }
+    os_mbuf_extend(m, rc);
+    mqtt_client_queue(c, m);
+    if (packet_id) {
+        *packet_id = pid;
+    }
+    rc = 0;
+out:
+    os_mutex_release(&c->mc_lock);
+    return rc;
+}
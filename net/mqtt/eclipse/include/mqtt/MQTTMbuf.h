@@ -0,0 +1,76 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef MQTTMBUF_H_
+#define MQTTMBUF_H_
+
+/*
+ * os_mbuf front ends to the publish codecs.  The payload is never copied:
+ * it is chained behind the serialized header on the way out, and reported
+ * as an offset into the received chain on the way in.
+ */
+
+#include "os/mynewt.h"
+#include "MQTTPacket.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Puts the PUBLISH fixed header, topic name and packet ID in front of a
+ * payload.  They go in the payload's leading space when it has room,
+ * otherwise in a new msys mbuf that the payload is chained behind.
+ *
+ * @param payload       Payload, a packet header chain; consumed on
+ *                          success.
+ *
+ * @return The complete packet, or NULL if out of mbufs; payload is then
+ *         left alone.
+ */
+struct os_mbuf *MQTTSerialize_publishMbuf(unsigned char dup, int qos,
+                                          unsigned char retained,
+                                          unsigned short packetid,
+                                          MQTTString topicName,
+                                          struct os_mbuf *payload);
+
+/**
+ * Decodes the start of a PUBLISH held at the front of an mbuf chain.
+ * buf receives a copy of up to buflen bytes of it, and topicName points
+ * into buf.
+ *
+ * @param payloadoff    Returned offset of the payload within om.
+ * @param payloadlen    Returned payload length.
+ * @param om            Chain starting with a complete packet.
+ *
+ * @return 1 on success; 0 if the header doesn't fit in buf or the packet
+ *         is malformed or incomplete.
+ */
+int MQTTDeserialize_publishMbuf(unsigned char *dup, int *qos,
+                                unsigned char *retained,
+                                unsigned short *packetid,
+                                MQTTString *topicName, int *payloadoff,
+                                int *payloadlen, struct os_mbuf *om,
+                                unsigned char *buf, int buflen);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MQTTMBUF_H_ */
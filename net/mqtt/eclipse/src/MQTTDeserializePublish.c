@@ -70,6 +70,70 @@ exit:
 
 
 
+/**
+  * Deserializes the start of a publish packet, up to and including the packet identifier.
+  * The payload is returned as a position within the packet, so buf need not hold it.
+  * @param dup returned integer - the MQTT dup flag
+  * @param qos returned integer - the MQTT QoS value
+  * @param retained returned integer - the MQTT retained flag
+  * @param packetid returned integer - the MQTT packet identifier
+  * @param topicName returned MQTTString - the MQTT topic in the publish, pointing into buf
+  * @param payloadoff returned integer - the offset of the payload from the start of the packet
+  * @param payloadlen returned integer - the length of the MQTT payload
+  * @param buf the first buflen bytes of the packet
+  * @param buflen the length in bytes of the data in the supplied buffer
+  * @return error code.  1 is success, 0 if buf is too short or the packet is malformed
+  */
+int MQTTDeserialize_publishHeader(unsigned char* dup, int* qos, unsigned char* retained, unsigned short* packetid, MQTTString* topicName,
+		int* payloadoff, int* payloadlen, unsigned char* buf, int buflen)
+{
+	MQTTHeader header = {0};
+	unsigned char* curdata = buf;
+	unsigned char* enddata = NULL;
+	unsigned char* endbuf = buf + buflen;
+	int rc = 0;
+	int mylen = 0;
+	int i;
+
+	FUNC_ENTRY;
+	if (buflen < 2)
+		goto exit;
+	header.byte = readChar(&curdata);
+	if (header.bits.type != PUBLISH)
+		goto exit;
+	*dup = header.bits.dup;
+	*qos = header.bits.qos;
+	*retained = header.bits.retain;
+
+	for (i = 0; i < 4 && curdata + i < endbuf && (curdata[i] & 128); i++)
+		;
+	if (i == 4 || curdata + i >= endbuf) /* remaining length not all there */
+		goto exit;
+	curdata += MQTTPacket_decodeBuf(curdata, &mylen); /* read remaining length */
+	enddata = curdata + mylen;
+	if (endbuf > enddata)
+		endbuf = enddata;
+
+	if (!readMQTTLenString(topicName, &curdata, endbuf))
+		goto exit;
+
+	if (*qos > 0)
+	{
+		if (endbuf - curdata < 2)
+			goto exit;
+		*packetid = readInt(&curdata);
+	}
+
+	*payloadlen = enddata - curdata;
+	*payloadoff = curdata - buf;
+	rc = 1;
+exit:
+	FUNC_EXIT_RC(rc);
+	return rc;
+}
+
+
+
 /**
   * Deserializes the supplied (wire) buffer into an ack
   * @param packettype returned integer - the MQTT packet type
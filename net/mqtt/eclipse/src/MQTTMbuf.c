@@ -0,0 +1,82 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "MQTTPacket.h"
+#include "MQTTMbuf.h"
+
+struct os_mbuf *
+MQTTSerialize_publishMbuf(unsigned char dup, int qos, unsigned char retained,
+                          unsigned short packetid, MQTTString topicName,
+                          struct os_mbuf *payload)
+{
+    struct os_mbuf *m;
+    int payloadlen;
+    int hdr_len;
+
+    payloadlen = OS_MBUF_PKTLEN(payload);
+    hdr_len = MQTTPacket_len(MQTTSerialize_publishLength(qos, topicName,
+                                                         payloadlen)) -
+              payloadlen;
+
+    if (OS_MBUF_LEADINGSPACE(payload) >= hdr_len) {
+        m = os_mbuf_prepend(payload, hdr_len);
+        assert(m == payload);
+    } else {
+        m = os_msys_get_pkthdr(hdr_len, 0);
+        if (!m) {
+            return NULL;
+        }
+        if (OS_MBUF_TRAILINGSPACE(m) < hdr_len) {
+            os_mbuf_free_chain(m);
+            return NULL;
+        }
+        os_mbuf_extend(m, hdr_len);
+        os_mbuf_concat(m, payload);
+    }
+    MQTTSerialize_publishHeader(m->om_data, hdr_len, dup, qos, retained,
+                                packetid, topicName, payloadlen);
+    return m;
+}
+
+int
+MQTTDeserialize_publishMbuf(unsigned char *dup, int *qos,
+                            unsigned char *retained, unsigned short *packetid,
+                            MQTTString *topicName, int *payloadoff,
+                            int *payloadlen, struct os_mbuf *om,
+                            unsigned char *buf, int buflen)
+{
+    int len;
+
+    len = OS_MBUF_PKTLEN(om);
+    if (len > buflen) {
+        len = buflen;
+    }
+    if (os_mbuf_copydata(om, 0, len, buf)) {
+        return 0;
+    }
+    if (MQTTDeserialize_publishHeader(dup, qos, retained, packetid, topicName,
+                                      payloadoff, payloadlen, buf, len) != 1) {
+        return 0;
+    }
+    if (*payloadoff + *payloadlen > OS_MBUF_PKTLEN(om)) {
+        return 0;
+    }
+    return 1;
+}
@@ -97,6 +97,14 @@ enum
 #define IS_OPTION(packet, opt)                                                 \
   ((packet)->options[opt / OPTION_MAP_SIZE] & (1 << (opt % OPTION_MAP_SIZE)))
 
+/*
+ * Location of one option value within a received mbuf chain.
+ */
+struct coap_opt_seg {
+    uint16_t off;
+    uint16_t len;
+};
+
 /*
  * For COAP RX, structure stores the offsets and lengths of option fields
  * within the mbuf chain.
@@ -138,7 +146,7 @@ struct coap_packet_rx {
 #endif
     uint16_t uri_port;
     uint16_t uri_path_len;
-    uint16_t uri_path_off;
+    uint8_t uri_path_nseg;
     uint16_t accept;
     int32_t observe;
 #if 0
@@ -156,7 +164,10 @@ struct coap_packet_rx {
     uint32_t size2;
     uint32_t size1;
     uint16_t uri_query_len;
-    uint16_t uri_query_off;
+    uint8_t uri_query_nseg;
+    /* Where each Uri-Path/Uri-Query value sits in the mbuf */
+    struct coap_opt_seg uri_path_seg[COAP_MAX_URI_SEGMENTS];
+    struct coap_opt_seg uri_query_seg[COAP_MAX_URI_SEGMENTS];
     uint8_t if_none_match;
 
     uint16_t payload_off;
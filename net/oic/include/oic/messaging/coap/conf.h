@@ -50,6 +50,19 @@ extern "C" {
 #define COAP_MAX_OPEN_TRANSACTIONS (MAX_NUM_CONCURRENT_REQUESTS)
 #endif /* COAP_MAX_OPEN_TRANSACTIONS */
 
+/* Buckets in the transaction MID and token lookup tables (power of 2) */
+#ifndef COAP_TRANSACTION_HASH_SIZE
+#define COAP_TRANSACTION_HASH_SIZE 16
+#endif /* COAP_TRANSACTION_HASH_SIZE */
+
+/* Slots in the retransmission timer wheel (power of 2), and ticks per slot */
+#ifndef COAP_TRANSACTION_WHEEL_SLOTS
+#define COAP_TRANSACTION_WHEEL_SLOTS 32
+#endif /* COAP_TRANSACTION_WHEEL_SLOTS */
+#ifndef COAP_TRANSACTION_WHEEL_TICKS
+#define COAP_TRANSACTION_WHEEL_TICKS ((OS_TICKS_PER_SEC + 7) / 8)
+#endif /* COAP_TRANSACTION_WHEEL_TICKS */
+
 /* Maximum number of failed request attempts before action */
 #ifndef COAP_MAX_ATTEMPTS
 #define COAP_MAX_ATTEMPTS 2
@@ -68,6 +81,11 @@ extern "C" {
 #define COAP_MAX_OBSERVERS (MAX_APP_RESOURCES + MAX_NUM_CONCURRENT_REQUESTS)
 #endif /* COAP_MAX_OBSERVERS */
 
+/* Uri-Path and Uri-Query segments indexed per received packet */
+#ifndef COAP_MAX_URI_SEGMENTS
+#define COAP_MAX_URI_SEGMENTS 8
+#endif /* COAP_MAX_URI_SEGMENTS */
+
 /* Interval in notifies in which NON notifies are changed to CON notifies to
  * check client. */
 #define COAP_OBSERVE_REFRESH_INTERVAL 20
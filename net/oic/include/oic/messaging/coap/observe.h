@@ -48,6 +48,8 @@ extern "C" {
 
 typedef struct coap_observer {
   SLIST_ENTRY(coap_observer) next;
+  /* Link in the observed resource's list of observers. */
+  SLIST_ENTRY(coap_observer) res_next;
 
   oc_resource_t *resource;
 
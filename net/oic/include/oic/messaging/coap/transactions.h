@@ -55,13 +55,19 @@ extern "C" {
 
 /* container for transactions with message buffer and retransmission info */
 typedef struct coap_transaction {
-    SLIST_ENTRY(coap_transaction) next;
+    SLIST_ENTRY(coap_transaction) next;         /* MID hash bucket */
+    SLIST_ENTRY(coap_transaction) tok_next;     /* token hash bucket */
+    SLIST_ENTRY(coap_transaction) wheel_next;   /* retransmit wheel slot */
 
     uint16_t mid;
     uint8_t retrans_counter;
+    uint8_t retrans_armed:1;
+    uint8_t retrans_slot;
+    uint8_t token_len;
+    uint8_t token[COAP_TOKEN_LEN];
     coap_message_type_t type;
     uint32_t retrans_tmo;
-    struct os_callout retrans_timer;
+    os_time_t retrans_at;
     struct os_mbuf *m;
 } coap_transaction_t;
 
@@ -70,9 +76,24 @@ void coap_register_as_transaction_handler(void);
 coap_transaction_t *coap_new_transaction(uint16_t mid, oc_endpoint_t *);
 
 void coap_send_transaction(coap_transaction_t *t);
+
+/*
+ * Sends a non-confirmable transaction after ticks, e.g. a response to a
+ * multicast request within the leisure period.
+ */
+void coap_send_transaction_delayed(coap_transaction_t *t, uint32_t ticks);
 void coap_clear_transaction(coap_transaction_t *t);
 coap_transaction_t *coap_get_transaction_by_mid(uint16_t mid);
 
+/*
+ * Records the token of the request carried by t, so that a separate
+ * response can close the transaction with coap_get_transaction_by_token().
+ */
+void coap_transaction_set_token(coap_transaction_t *t, const uint8_t *token,
+                                uint8_t token_len);
+coap_transaction_t *coap_get_transaction_by_token(const uint8_t *token,
+                                                  uint8_t token_len);
+
 void coap_check_transactions(void);
 
 void coap_transaction_init(void);
@@ -94,9 +94,23 @@ void oc_resource_set_periodic_observable(oc_resource_t *resource,
                                          uint16_t seconds);
 void oc_resource_set_periodic_observable_ms(oc_resource_t *resource,
                                             uint32_t mseconds);
+void oc_resource_set_observe_handler(oc_resource_t *resource,
+                                     oc_observe_handler_t handler);
 void oc_resource_set_request_handler(oc_resource_t *resource,
                                      oc_method_t method,
                                      oc_request_handler_t handler);
+#if MYNEWT_VAL(OC_BLOCKWISE)
+/**
+ * Sets streaming handlers for blockwise transfers (RFC 7959).  When set,
+ * get_handler serves GET requests in place of the GET request handler, and
+ * put_handler receives the body of PUT and POST requests in place of those
+ * request handlers.  Either may be NULL.  Observe notifications still use
+ * the GET request handler.
+ */
+void oc_resource_set_block_handlers(oc_resource_t *resource,
+                                    oc_block2_handler_t get_handler,
+                                    oc_block1_handler_t put_handler);
+#endif
 bool oc_add_resource(oc_resource_t *resource);
 void oc_delete_resource(oc_resource_t *resource);
 void oc_deactivate_resource(oc_resource_t *resource);
@@ -119,6 +133,25 @@ void oc_send_separate_response(oc_separate_response_t *handle,
 
 int oc_notify_observers(oc_resource_t *resource);
 
+#if MYNEWT_VAL(OC_RESPONSE_CACHE)
+/**
+ * Keeps the response of a successful GET and answers further GETs for the
+ * same interface from it for max_age seconds, without calling the GET
+ * handler.  Responses carry an ETag and Max-Age, and a GET with the current
+ * ETag is answered with 2.03 Valid and no payload.  GETs with a query other
+ * than an interface selection are not cached.  The cached response is
+ * dropped by oc_notify_observers(), after a successful PUT or POST, and by
+ * oc_resource_cache_invalidate().  A max_age of 0 turns caching off.
+ */
+void oc_resource_set_cache(oc_resource_t *resource, uint32_t max_age);
+
+/**
+ * Drops the cached GET response of a resource, for changes of its state
+ * that are not reported with oc_notify_observers().
+ */
+void oc_resource_cache_invalidate(oc_resource_t *resource);
+#endif
+
 #ifdef OC_CLIENT
 /** Client side */
 #include "oc_client_state.h"
@@ -130,6 +163,20 @@ bool oc_do_ip_discovery(const char *rt, oc_discovery_cb_t handler);
 bool oc_do_get(const char *uri, oc_server_handle_t *server, const char *query,
                oc_response_handler_t handler, oc_qos_t qos);
 
+#if MYNEWT_VAL(OC_BLOCKWISE)
+/**
+ * Fetches a resource with a blockwise (RFC 7959) GET.  The first block is
+ * requested alone to agree on the block size; after that up to window
+ * block requests are kept in flight.  handler is called once per block
+ * received; blocks may arrive out of order, so use
+ * coap_get_header_block2() on the response packet to find each block's
+ * offset.
+ */
+bool oc_do_get_blockwise(const char *uri, oc_server_handle_t *server,
+                         const char *query, oc_response_handler_t handler,
+                         oc_qos_t qos, uint8_t window);
+#endif
+
 bool oc_do_delete(const char *uri, oc_server_handle_t *server,
                   oc_response_handler_t handler, oc_qos_t qos);
 
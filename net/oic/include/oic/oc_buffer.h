@@ -25,7 +25,7 @@ struct os_mbuf;
 struct oc_endpoint;
 struct os_mbuf *oc_allocate_mbuf(struct oc_endpoint *oe);
 
-void oc_send_message(struct os_mbuf *m);
+int oc_send_message(struct os_mbuf *m);
 
 #ifdef __cplusplus
 }
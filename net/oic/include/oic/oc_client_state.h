@@ -70,6 +70,15 @@ typedef struct oc_client_cb {
     oc_clock_time_t timestamp;
     oc_qos_t qos;
     oc_method_t method;
+#if MYNEWT_VAL(OC_BLOCKWISE)
+    /* Blockwise GET state; block_window is 0 for other requests. */
+    oc_string_t query;
+    uint32_t block_next;
+    uint32_t block_last;
+    uint16_t block_size;
+    uint8_t block_window;
+    uint8_t block_pending;
+#endif
 } oc_client_cb_t;
 
 bool oc_ri_invoke_client_cb(struct coap_packet_rx *response,
@@ -23,6 +23,12 @@ extern "C" {
 
 void oc_create_discovery_resource(void);
 
+/*
+ * Drops the cached discovery responses. Called when resources are added
+ * or removed.
+ */
+void oc_discovery_cache_clear(void);
+
 #ifdef __cplusplus
 }
 #endif
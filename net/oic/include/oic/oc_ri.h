@@ -17,6 +17,7 @@
 #ifndef OC_RI_H
 #define OC_RI_H
 
+#include "arena/arena.h"
 #include "oic/port/mynewt/config.h"
 #include "oic/port/oc_connectivity.h"
 #include "oic/oc_rep.h"
@@ -43,12 +44,63 @@ typedef struct oc_request {
     int query_len;
     oc_response_t *response;
     struct coap_packet_rx *packet;
+    /** Scratch arena; released once the request handler returns. */
+    struct arena *arena;
 } oc_request_t;
 
 typedef void (*oc_request_handler_t)(oc_request_t *, oc_interface_mask_t);
 
+#if MYNEWT_VAL(OC_BLOCKWISE)
+/**
+ * Produces one block of a GET response, so that large representations
+ * need not be built in full.  Called for every Block2 request, and for
+ * a GET without one.
+ *
+ * @param request               The request being handled.
+ * @param offset                Offset of the block in the representation.
+ * @param len                   Block size; at most len bytes are appended.
+ * @param om                    The mbuf to append the block to.
+ *
+ * @return                      1 if more blocks follow; 0 if this is the
+ *                              last block; -1 on error.
+ */
+typedef int (*oc_block2_handler_t)(oc_request_t *request, uint32_t offset,
+                                   uint16_t len, struct os_mbuf *om);
+
+/**
+ * Consumes one block of a PUT or POST request body as it arrives.  A
+ * request without a Block1 option is passed as a single, final block.
+ * After the final block, the handler sends the response with
+ * oc_send_response() just like a request handler.
+ *
+ * @param request               The request being handled.
+ * @param offset                Offset of the block in the request body.
+ * @param om                    The mbuf holding the block.
+ * @param off                   Offset of the block within om.
+ * @param len                   Length of the block.
+ * @param more                  Whether more blocks follow.
+ *
+ * @return                      0 to accept the block; nonzero to abort the
+ *                              transfer with 4.13 Request Entity Too Large.
+ */
+typedef int (*oc_block1_handler_t)(oc_request_t *request, uint32_t offset,
+                                   struct os_mbuf *om, uint16_t off,
+                                   uint16_t len, bool more);
+#endif
+
+struct coap_observer;
+struct oc_resource;
+
+/**
+ * Called after an observer has been added to or removed from a resource;
+ * the current count is in the resource's num_observers.
+ */
+typedef void (*oc_observe_handler_t)(struct oc_resource *resource);
+
 typedef struct oc_resource {
   SLIST_ENTRY(oc_resource) next;
+  /** Link in the URI hash bucket of an application resource. */
+  SLIST_ENTRY(oc_resource) hash_next;
   int device;
   oc_string_t uri;
   oc_string_array_t types;
@@ -59,9 +111,24 @@ typedef struct oc_resource {
   oc_request_handler_t put_handler;
   oc_request_handler_t post_handler;
   oc_request_handler_t delete_handler;
+#if MYNEWT_VAL(OC_BLOCKWISE)
+  oc_block2_handler_t block2_handler;
+  oc_block1_handler_t block1_handler;
+#endif
   struct os_callout callout;
   uint32_t observe_period_mseconds;
   uint8_t num_observers;
+  oc_observe_handler_t observe_handler;
+  /** Observers of this resource. */
+  SLIST_HEAD(, coap_observer) observers;
+#if MYNEWT_VAL(OC_RESPONSE_CACHE)
+  /** Cached GET response, see oc_resource_set_cache(). */
+  struct os_mbuf *cache_m;
+  uint32_t cache_max_age;
+  os_time_t cache_expires;
+  uint32_t cache_etag;
+  oc_interface_mask_t cache_interface;
+#endif
 } oc_resource_t;
 
 void oc_ri_init(void);
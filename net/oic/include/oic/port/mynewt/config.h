@@ -67,6 +67,12 @@ typedef os_time_t oc_clock_time_t;
 /* Max inactivity timeout before tearing down DTLS connection */
 //#define DTLS_INACTIVITY_TIMEOUT (10)
 
+/* Buckets in the ACL subject index; a power of two */
+//#define OC_ACL_HASH_SIZE (4)
+
+/* Access decisions remembered per DTLS session */
+//#define OC_ACL_CACHE_SIZE (4)
+
 #ifdef __cplusplus
 }
 #endif
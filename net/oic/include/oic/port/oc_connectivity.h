@@ -38,6 +38,7 @@ struct oc_ep_hdr {
 
 #define OC_ENDPOINT_MULTICAST   (1 << 0)
 #define OC_ENDPOINT_SECURED     (1 << 1)
+#define OC_ENDPOINT_RX_MULTICAST (1 << 2)   /* request was multicast */
 
 /*
  * Use this when reserving memory for oc_endpoint of unknown type.
@@ -126,6 +127,7 @@ int oc_connectivity_init(void);
 void oc_connectivity_shutdown(void);
 
 void oc_send_buffer(struct os_mbuf *);
+void oc_send_flush(void);
 void oc_send_multicast_message(struct os_mbuf *);
 
 void oc_recv_message(struct os_mbuf *m);
@@ -0,0 +1,235 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include <oic/oc_api.h>
+#include "test_oic.h"
+
+#if MYNEWT_VAL(OC_BLOCKWISE)
+
+/*
+ * Block2 representation; the last block is a partial one.
+ */
+#define TEST_BLOCK2_LEN                                                 \
+    (2 * COAP_MAX_BLOCK_SIZE + COAP_MAX_BLOCK_SIZE / 2)
+
+/*
+ * Block1 request body, sent in TEST_BLOCK1_SZ byte blocks.
+ */
+#define TEST_BLOCK1_SZ          32
+#define TEST_BLOCK1_LEN         (2 * TEST_BLOCK1_SZ + TEST_BLOCK1_SZ / 2)
+#define TEST_BLOCK1_CNT                                                 \
+    ((TEST_BLOCK1_LEN + TEST_BLOCK1_SZ - 1) / TEST_BLOCK1_SZ)
+
+static int test_block_state;
+static volatile int test_block_done;
+static struct oc_resource *test_res_block;
+static uint32_t test_block2_rx;
+static uint32_t test_block2_seen;
+static uint32_t test_block1_rx;
+static int test_block1_last;
+
+static void test_block_next_step(struct os_event *);
+static struct os_event test_block_next_ev = {
+    .ev_cb = test_block_next_step
+};
+
+static uint8_t
+test_block_byte(uint32_t off)
+{
+    return (uint8_t)(off * 7 + (off >> 8));
+}
+
+static void
+test_block_check_data(struct os_mbuf *m, uint16_t off, uint16_t len,
+                      uint32_t offset)
+{
+    uint8_t b;
+    int i;
+
+    for (i = 0; i < len; i++) {
+        TEST_ASSERT_FATAL(os_mbuf_copydata(m, off + i, 1, &b) == 0);
+        TEST_ASSERT_FATAL(b == test_block_byte(offset + i));
+    }
+}
+
+static int
+test_block_get(struct oc_request *request, uint32_t offset, uint16_t len,
+               struct os_mbuf *om)
+{
+    uint32_t i;
+    uint8_t b;
+
+    for (i = offset; i < offset + len && i < TEST_BLOCK2_LEN; i++) {
+        b = test_block_byte(i);
+        if (os_mbuf_append(om, &b, 1)) {
+            return -1;
+        }
+    }
+    return offset + len < TEST_BLOCK2_LEN;
+}
+
+static int
+test_block_put(struct oc_request *request, uint32_t offset,
+               struct os_mbuf *om, uint16_t off, uint16_t len, bool more)
+{
+    /*
+     * Blocks arrive in order, and only the last one is short.
+     */
+    TEST_ASSERT(offset == test_block1_rx);
+    TEST_ASSERT(more == (offset + len < TEST_BLOCK1_LEN));
+    TEST_ASSERT(more ? len == TEST_BLOCK1_SZ : len <= TEST_BLOCK1_SZ);
+    test_block_check_data(om, off, len, offset);
+    test_block1_rx += len;
+
+    if (!more) {
+        TEST_ASSERT(test_block1_rx == TEST_BLOCK1_LEN);
+        oc_send_response(request, OC_STATUS_CHANGED);
+    }
+    return 0;
+}
+
+static void
+test_block_get_rsp(struct oc_client_response *rsp)
+{
+    struct os_mbuf *m;
+    uint32_t num;
+    uint32_t offset;
+    uint16_t size;
+    uint16_t off;
+    uint8_t more;
+    int len;
+
+    TEST_ASSERT_FATAL(rsp->code == OC_STATUS_OK);
+    TEST_ASSERT_FATAL(rsp->packet);
+    TEST_ASSERT_FATAL(coap_get_header_block2(rsp->packet, &num, &more, &size,
+                                             &offset));
+    TEST_ASSERT(size == COAP_MAX_BLOCK_SIZE);
+    TEST_ASSERT((test_block2_seen & (1 << num)) == 0);
+    test_block2_seen |= 1 << num;
+
+    len = coap_get_payload(rsp->packet, &m, &off);
+    TEST_ASSERT(len == min(size, TEST_BLOCK2_LEN - offset));
+    TEST_ASSERT(more == (offset + len < TEST_BLOCK2_LEN));
+    test_block_check_data(m, off, len, offset);
+
+    test_block2_rx += len;
+    if (test_block2_rx == TEST_BLOCK2_LEN) {
+        os_eventq_put(os_eventq_dflt_get(), &test_block_next_ev);
+    }
+}
+
+static void
+test_block_put_fill(coap_packet_t *pkt, void *arg)
+{
+    struct os_mbuf *m;
+    uint32_t num = *(int *)arg;
+    uint32_t offset = num * TEST_BLOCK1_SZ;
+    uint32_t i;
+    uint8_t b;
+
+    m = os_msys_get_pkthdr(0, 0);
+    TEST_ASSERT_FATAL(m);
+    for (i = offset; i < offset + TEST_BLOCK1_SZ && i < TEST_BLOCK1_LEN; i++) {
+        b = test_block_byte(i);
+        TEST_ASSERT_FATAL(os_mbuf_append(m, &b, 1) == 0);
+    }
+    coap_set_header_block1(pkt, num, i < TEST_BLOCK1_LEN, TEST_BLOCK1_SZ);
+    pkt->payload_m = m;
+    pkt->payload_len = OS_MBUF_PKTLEN(m);
+}
+
+static void
+test_block_put_rsp(struct oc_client_response *rsp)
+{
+    /*
+     * Blocks other than the last are answered with 2.31 Continue, which
+     * has no oc_status_t.
+     */
+    if (test_block1_last == TEST_BLOCK1_CNT - 1) {
+        TEST_ASSERT(rsp->code == OC_STATUS_CHANGED);
+    }
+    os_eventq_put(os_eventq_dflt_get(), &test_block_next_ev);
+}
+
+static void
+test_block_next_step(struct os_event *ev)
+{
+    bool b_rc;
+    struct oc_server_handle server;
+
+    test_block_state++;
+    switch (test_block_state) {
+    case 1:
+        test_res_block = oc_new_resource("/block", 1, 0);
+        TEST_ASSERT_FATAL(test_res_block);
+
+        oc_resource_bind_resource_interface(test_res_block, OC_IF_RW);
+        oc_resource_set_default_interface(test_res_block, OC_IF_RW);
+        oc_resource_set_block_handlers(test_res_block, test_block_get,
+                                       test_block_put);
+        b_rc = oc_add_resource(test_res_block);
+        TEST_ASSERT(b_rc == true);
+
+        /*
+         * Blockwise GET, two block requests in flight.
+         */
+        oic_test_get_endpoint(&server);
+        b_rc = oc_do_get_blockwise("/block", &server, NULL, test_block_get_rsp,
+                                   LOW_QOS, 2);
+        TEST_ASSERT_FATAL(b_rc == true);
+
+        oic_test_reset_tmo("block1");
+        break;
+    case 2:
+        TEST_ASSERT(test_block2_seen ==
+                    (1 << (TEST_BLOCK2_LEN / COAP_MAX_BLOCK_SIZE + 1)) - 1);
+        /* fall-through */
+    case 3:
+    case 4:
+        /*
+         * Blockwise PUT, one block at a time.
+         */
+        test_block1_last = test_block_state - 2;
+        b_rc = oic_test_request(OC_PUT, "/block", test_block_put_rsp,
+                                test_block_put_fill, &test_block1_last);
+        TEST_ASSERT_FATAL(b_rc == true);
+
+        oic_test_reset_tmo("block2-4");
+        break;
+    case 5:
+        test_block_done = 1;
+        break;
+    default:
+        TEST_ASSERT_FATAL(0);
+        break;
+    }
+}
+
+void
+test_blockwise(void)
+{
+    os_eventq_put(os_eventq_dflt_get(), &test_block_next_ev);
+    while (!test_block_done)
+        ;
+
+    oc_delete_resource(test_res_block);
+}
+
+#endif
@@ -0,0 +1,260 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include <oic/oc_api.h>
+#include "test_oic.h"
+
+#if MYNEWT_VAL(OC_RESPONSE_CACHE)
+
+#define TEST_CACHE_MAX_AGE      60
+
+static int test_cache_state;
+static volatile int test_cache_done;
+static struct oc_resource *test_res_cache;
+static int test_cache_get_cnt;
+
+/*
+ * What the last response carried.
+ */
+static oc_status_t test_cache_code;
+static long long test_cache_value;
+static uint32_t test_cache_etag;
+static uint32_t test_cache_old_etag;
+static uint32_t test_cache_new_etag;
+
+static void test_cache_next_step(struct os_event *);
+static struct os_event test_cache_next_ev = {
+    .ev_cb = test_cache_next_step
+};
+
+static void
+test_cache_get(struct oc_request *request, oc_interface_mask_t interface)
+{
+    test_cache_get_cnt++;
+
+    oc_rep_start_root_object();
+    oc_rep_set_int(root, value, test_cache_get_cnt);
+    oc_rep_end_root_object();
+    oc_send_response(request, OC_STATUS_OK);
+}
+
+static void
+test_cache_put(struct oc_request *request, oc_interface_mask_t interface)
+{
+    oc_send_response(request, OC_STATUS_CHANGED);
+}
+
+static void
+test_cache_rsp(struct oc_client_response *rsp)
+{
+    const uint8_t *etag;
+    uint32_t age;
+
+    test_cache_code = rsp->code;
+    test_cache_value = -1;
+    test_cache_etag = 0;
+    if (rsp->packet) {
+        TEST_ASSERT(oic_test_rsp_value(rsp, &test_cache_value) == 0);
+        if (coap_get_header_etag(rsp->packet, &etag) ==
+            sizeof(test_cache_etag)) {
+            memcpy(&test_cache_etag, etag, sizeof(test_cache_etag));
+
+            TEST_ASSERT(coap_get_header_max_age(rsp->packet, &age));
+            TEST_ASSERT(age > 0 && age <= TEST_CACHE_MAX_AGE);
+        }
+    }
+    os_eventq_put(os_eventq_dflt_get(), &test_cache_next_ev);
+}
+
+static void
+test_cache_etag_fill(coap_packet_t *pkt, void *arg)
+{
+    coap_set_header_etag(pkt, arg, sizeof(uint32_t));
+}
+
+static void
+test_cache_check(oc_status_t code, long long value, int get_cnt)
+{
+    TEST_ASSERT(test_cache_code == code);
+    TEST_ASSERT(test_cache_value == value);
+    TEST_ASSERT(test_cache_get_cnt == get_cnt);
+}
+
+static void
+test_cache_next_step(struct os_event *ev)
+{
+    struct oc_server_handle server;
+    uint32_t etag;
+    bool b_rc;
+
+    oic_test_get_endpoint(&server);
+
+    /*
+     * Check the response to the previous step.
+     */
+    switch (test_cache_state) {
+    case 1:
+        /* miss */
+        test_cache_check(OC_STATUS_OK, 1, 1);
+        TEST_ASSERT(test_cache_etag != 0);
+        test_cache_old_etag = test_cache_etag;
+        break;
+    case 2:
+        /* hit */
+        test_cache_check(OC_STATUS_OK, 1, 1);
+        TEST_ASSERT(test_cache_etag == test_cache_old_etag);
+        break;
+    case 3:
+        /* revalidated */
+        test_cache_check(OC_STATUS_NOT_MODIFIED, -1, 1);
+        break;
+    case 4:
+        /* stale ETag, answered from the cache */
+        test_cache_check(OC_STATUS_OK, 1, 1);
+        TEST_ASSERT(test_cache_etag == test_cache_old_etag);
+        break;
+    case 5:
+    case 8:
+        test_cache_check(OC_STATUS_CHANGED, -1, test_cache_state == 5 ? 1 : 2);
+        break;
+    case 6:
+        /* PUT dropped the cached response */
+        test_cache_check(OC_STATUS_OK, 2, 2);
+        TEST_ASSERT(test_cache_etag != 0);
+        TEST_ASSERT(test_cache_etag != test_cache_old_etag);
+        test_cache_new_etag = test_cache_etag;
+        break;
+    case 7:
+        /* old ETag no longer valid */
+        test_cache_check(OC_STATUS_OK, 2, 2);
+        TEST_ASSERT(test_cache_etag == test_cache_new_etag);
+        break;
+    case 9:
+        /* POST dropped the cached response */
+        test_cache_check(OC_STATUS_OK, 3, 3);
+        break;
+    case 10:
+        test_cache_check(OC_STATUS_OK, 4, 4);
+        break;
+    case 11:
+    case 12:
+        /* queries other than interface selection are not cached */
+        test_cache_check(OC_STATUS_OK, test_cache_state - 6,
+                         test_cache_state - 6);
+        TEST_ASSERT(test_cache_etag == 0);
+        break;
+    case 13:
+        /* and leave the cached response alone */
+        test_cache_check(OC_STATUS_OK, 4, 6);
+        break;
+    default:
+        break;
+    }
+
+    test_cache_state++;
+    switch (test_cache_state) {
+    case 1:
+        test_res_cache = oc_new_resource("/cache", 1, 0);
+        TEST_ASSERT_FATAL(test_res_cache);
+
+        oc_resource_bind_resource_interface(test_res_cache, OC_IF_RW);
+        oc_resource_set_default_interface(test_res_cache, OC_IF_RW);
+        oc_resource_set_request_handler(test_res_cache, OC_GET,
+                                        test_cache_get);
+        oc_resource_set_request_handler(test_res_cache, OC_PUT,
+                                        test_cache_put);
+        oc_resource_set_request_handler(test_res_cache, OC_POST,
+                                        test_cache_put);
+        b_rc = oc_add_resource(test_res_cache);
+        TEST_ASSERT(b_rc == true);
+        oc_resource_set_cache(test_res_cache, TEST_CACHE_MAX_AGE);
+        /* fall-through */
+    case 2:
+    case 6:
+    case 9:
+    case 13:
+        b_rc = oc_do_get("/cache", &server, NULL, test_cache_rsp, LOW_QOS);
+        TEST_ASSERT_FATAL(b_rc == true);
+        break;
+    case 3:
+        b_rc = oic_test_request(OC_GET, "/cache", test_cache_rsp,
+                                test_cache_etag_fill, &test_cache_old_etag);
+        TEST_ASSERT_FATAL(b_rc == true);
+        break;
+    case 4:
+        etag = test_cache_old_etag + 1;
+        b_rc = oic_test_request(OC_GET, "/cache", test_cache_rsp,
+                                test_cache_etag_fill, &etag);
+        TEST_ASSERT_FATAL(b_rc == true);
+        break;
+    case 5:
+        b_rc = oc_init_put("/cache", &server, NULL, test_cache_rsp, LOW_QOS);
+        TEST_ASSERT_FATAL(b_rc == true);
+        oc_rep_start_root_object();
+        oc_rep_set_int(root, value, 1);
+        oc_rep_end_root_object();
+        b_rc = oc_do_put();
+        TEST_ASSERT_FATAL(b_rc == true);
+        break;
+    case 7:
+        b_rc = oic_test_request(OC_GET, "/cache", test_cache_rsp,
+                                test_cache_etag_fill, &test_cache_old_etag);
+        TEST_ASSERT_FATAL(b_rc == true);
+        break;
+    case 8:
+        b_rc = oc_init_post("/cache", &server, NULL, test_cache_rsp, LOW_QOS);
+        TEST_ASSERT_FATAL(b_rc == true);
+        oc_rep_start_root_object();
+        oc_rep_set_int(root, value, 2);
+        oc_rep_end_root_object();
+        b_rc = oc_do_post();
+        TEST_ASSERT_FATAL(b_rc == true);
+        break;
+    case 10:
+        oc_resource_cache_invalidate(test_res_cache);
+        b_rc = oc_do_get("/cache", &server, NULL, test_cache_rsp, LOW_QOS);
+        TEST_ASSERT_FATAL(b_rc == true);
+        break;
+    case 11:
+    case 12:
+        b_rc = oc_do_get("/cache", &server, "x=1", test_cache_rsp, LOW_QOS);
+        TEST_ASSERT_FATAL(b_rc == true);
+        break;
+    case 14:
+        test_cache_done = 1;
+        return;
+    default:
+        TEST_ASSERT_FATAL(0);
+        break;
+    }
+    oic_test_reset_tmo("cache");
+}
+
+void
+test_cache(void)
+{
+    os_eventq_put(os_eventq_dflt_get(), &test_cache_next_ev);
+    while (!test_cache_done)
+        ;
+
+    oc_delete_resource(test_res_cache);
+}
+
+#endif
@@ -0,0 +1,211 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdio.h>
+#include "os/mynewt.h"
+#include <oic/oc_api.h>
+#include "test_oic.h"
+
+/*
+ * More resources than OC_APP_RESOURCE_HASH_SIZE buckets, so that some of
+ * them share a bucket.
+ */
+#define TEST_DISPATCH_CNT       4
+
+static int test_dispatch_state;
+static volatile int test_dispatch_done;
+static struct oc_resource *test_res_dispatch[TEST_DISPATCH_CNT];
+
+static void test_dispatch_next_step(struct os_event *);
+static struct os_event test_dispatch_next_ev = {
+    .ev_cb = test_dispatch_next_step
+};
+
+static void
+test_dispatch_get(struct oc_request *request, oc_interface_mask_t interface)
+{
+    int i;
+
+    for (i = 0; i < TEST_DISPATCH_CNT; i++) {
+        if (request->resource == test_res_dispatch[i]) {
+            break;
+        }
+    }
+    TEST_ASSERT(i < TEST_DISPATCH_CNT);
+
+    oc_rep_start_root_object();
+    oc_rep_set_int(root, value, i);
+    oc_rep_end_root_object();
+    oc_send_response(request, OC_STATUS_OK);
+}
+
+static void
+test_dispatch_rsp(struct oc_client_response *rsp)
+{
+    long long value;
+
+    switch (test_dispatch_state) {
+    case 1:
+    case 2:
+    case 3:
+    case 4:
+        TEST_ASSERT(rsp->code == OC_STATUS_OK);
+        TEST_ASSERT(oic_test_rsp_value(rsp, &value) == 0);
+        TEST_ASSERT(value == test_dispatch_state - 1);
+        break;
+    case 5:
+    case 6:
+        TEST_ASSERT(rsp->code == OC_STATUS_NOT_FOUND);
+        break;
+    case 7:
+        TEST_ASSERT(rsp->code == OC_STATUS_OK);
+        TEST_ASSERT(oic_test_rsp_value(rsp, &value) == 0);
+        TEST_ASSERT(value == 3);
+        break;
+    case 8:
+    case 9:
+    case 10:
+        /* observe registration, notification, deregistration */
+        TEST_ASSERT(rsp->code == OC_STATUS_OK);
+        TEST_ASSERT(oic_test_rsp_value(rsp, &value) == 0);
+        TEST_ASSERT(value == 0);
+        break;
+    default:
+        break;
+    }
+    os_eventq_put(os_eventq_dflt_get(), &test_dispatch_next_ev);
+}
+
+static void
+test_dispatch_next_step(struct os_event *ev)
+{
+    char uri[16];
+    struct oc_server_handle server;
+    bool b_rc;
+    int rc;
+    int i;
+
+    oic_test_get_endpoint(&server);
+
+    test_dispatch_state++;
+    switch (test_dispatch_state) {
+    case 1:
+        for (i = 0; i < TEST_DISPATCH_CNT; i++) {
+            snprintf(uri, sizeof(uri), "/dispatch/%d", i);
+            test_res_dispatch[i] = oc_new_resource(uri, 1, 0);
+            TEST_ASSERT_FATAL(test_res_dispatch[i]);
+
+            oc_resource_bind_resource_interface(test_res_dispatch[i], OC_IF_R);
+            oc_resource_set_default_interface(test_res_dispatch[i], OC_IF_R);
+            oc_resource_set_observable(test_res_dispatch[i]);
+            oc_resource_set_request_handler(test_res_dispatch[i], OC_GET,
+                                            test_dispatch_get);
+            b_rc = oc_add_resource(test_res_dispatch[i]);
+            TEST_ASSERT(b_rc == true);
+        }
+        /* fall-through */
+    case 2:
+    case 3:
+    case 4:
+        /*
+         * Each URI reaches its own resource.
+         */
+        snprintf(uri, sizeof(uri), "/dispatch/%d", test_dispatch_state - 1);
+        b_rc = oc_do_get(uri, &server, NULL, test_dispatch_rsp, LOW_QOS);
+        TEST_ASSERT_FATAL(b_rc == true);
+
+        oic_test_reset_tmo("dispatch1-4");
+        break;
+    case 5:
+        b_rc = oc_do_get("/dispatch/9", &server, NULL, test_dispatch_rsp,
+                         LOW_QOS);
+        TEST_ASSERT_FATAL(b_rc == true);
+
+        oic_test_reset_tmo("dispatch5");
+        break;
+    case 6:
+        /*
+         * A deleted resource is gone from its bucket; the others stay.
+         */
+        oc_delete_resource(test_res_dispatch[1]);
+        test_res_dispatch[1] = NULL;
+
+        b_rc = oc_do_get("/dispatch/1", &server, NULL, test_dispatch_rsp,
+                         LOW_QOS);
+        TEST_ASSERT_FATAL(b_rc == true);
+
+        oic_test_reset_tmo("dispatch6");
+        break;
+    case 7:
+        b_rc = oc_do_get("/dispatch/3", &server, NULL, test_dispatch_rsp,
+                         LOW_QOS);
+        TEST_ASSERT_FATAL(b_rc == true);
+
+        oic_test_reset_tmo("dispatch7");
+        break;
+    case 8:
+        b_rc = oc_do_observe("/dispatch/0", &server, NULL, test_dispatch_rsp,
+                             LOW_QOS);
+        TEST_ASSERT_FATAL(b_rc == true);
+
+        oic_test_reset_tmo("dispatch8");
+        break;
+    case 9:
+        /*
+         * Only the observed resource has an observer to notify.
+         */
+        rc = oc_notify_observers(test_res_dispatch[2]);
+        TEST_ASSERT(rc == 0);
+        rc = oc_notify_observers(test_res_dispatch[0]);
+        TEST_ASSERT(rc == 1);
+
+        oic_test_reset_tmo("dispatch9");
+        break;
+    case 10:
+        b_rc = oc_stop_observe("/dispatch/0", &server);
+        TEST_ASSERT_FATAL(b_rc == true);
+
+        oic_test_reset_tmo("dispatch10");
+        break;
+    case 11:
+        rc = oc_notify_observers(test_res_dispatch[0]);
+        TEST_ASSERT(rc == 0);
+        test_dispatch_done = 1;
+        break;
+    default:
+        TEST_ASSERT_FATAL(0);
+        break;
+    }
+}
+
+void
+test_dispatch(void)
+{
+    int i;
+
+    os_eventq_put(os_eventq_dflt_get(), &test_dispatch_next_ev);
+    while (!test_dispatch_done)
+        ;
+
+    for (i = 0; i < TEST_DISPATCH_CNT; i++) {
+        if (test_res_dispatch[i]) {
+            oc_delete_resource(test_res_dispatch[i]);
+        }
+    }
+}
@@ -22,6 +22,8 @@
 #include <assert.h>
 #include <string.h>
 #include "testutil/testutil.h"
+#include <oic/oc_api.h>
+#include <oic/messaging/coap/coap.h>
 #include "test_oic.h"
 
 #ifdef __cplusplus
@@ -40,9 +42,29 @@ struct oc_server_handle;
 void oic_test_set_endpoint(struct oc_server_handle *);
 void oic_test_get_endpoint(struct oc_server_handle *);
 
+/*
+ * Sends a NON request with options the client API does not set, such as
+ * an ETag or Block1.  fill, if not NULL, adds them to the packet.
+ */
+typedef void oic_test_fill_fn(coap_packet_t *pkt, void *arg);
+bool oic_test_request(oc_method_t method, const char *uri,
+                      oc_response_handler_t handler, oic_test_fill_fn *fill,
+                      void *arg);
+
+/* Reads the integer attribute "value" from a response payload. */
+int oic_test_rsp_value(struct oc_client_response *rsp, long long *value);
+
 void test_discovery(void);
 void test_getset(void);
 void test_observe(void);
+void test_dispatch(void);
+void test_transactions(void);
+#if MYNEWT_VAL(OC_BLOCKWISE)
+void test_blockwise(void);
+#endif
+#if MYNEWT_VAL(OC_RESPONSE_CACHE)
+void test_cache(void);
+#endif
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,180 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include <oic/oc_api.h>
+#include <oic/messaging/coap/transactions.h>
+#include "test_oic.h"
+
+/*
+ * MIDs that differ by a multiple of the hash size share a bucket.
+ */
+#define TEST_TRANS_CNT          3
+#define TEST_TRANS_MID(i)       (0x7000 + (i) * COAP_TRANSACTION_HASH_SIZE)
+
+static int test_trans_state;
+static volatile int test_trans_done;
+static int test_trans_get_cnt;
+static struct oc_resource *test_res_trans;
+
+static void test_trans_next_step(struct os_event *);
+static struct os_event test_trans_next_ev = {
+    .ev_cb = test_trans_next_step
+};
+
+static void
+test_trans_lookup(void)
+{
+    struct oc_server_handle server;
+    coap_transaction_t *t[TEST_TRANS_CNT];
+    uint8_t token[TEST_TRANS_CNT][2];
+    uint8_t new_token[2] = { 0xaa, 0x55 };
+    int i;
+
+    oic_test_get_endpoint(&server);
+
+    for (i = 0; i < TEST_TRANS_CNT; i++) {
+        t[i] = coap_new_transaction(TEST_TRANS_MID(i), &server.endpoint);
+        TEST_ASSERT_FATAL(t[i]);
+        token[i][0] = 0x5a;
+        token[i][1] = i;
+        coap_transaction_set_token(t[i], token[i], sizeof(token[i]));
+    }
+    for (i = 0; i < TEST_TRANS_CNT; i++) {
+        TEST_ASSERT(coap_get_transaction_by_mid(TEST_TRANS_MID(i)) == t[i]);
+        TEST_ASSERT(coap_get_transaction_by_token(token[i],
+                                                  sizeof(token[i])) == t[i]);
+    }
+    TEST_ASSERT(coap_get_transaction_by_mid(TEST_TRANS_MID(TEST_TRANS_CNT)) ==
+                NULL);
+    TEST_ASSERT(coap_get_transaction_by_token(token[0], 1) == NULL);
+    TEST_ASSERT(coap_get_transaction_by_token(token[0], 0) == NULL);
+
+    /*
+     * A new token replaces the old one in the token index.
+     */
+    coap_transaction_set_token(t[0], new_token, sizeof(new_token));
+    TEST_ASSERT(coap_get_transaction_by_token(token[0],
+                                              sizeof(token[0])) == NULL);
+    TEST_ASSERT(coap_get_transaction_by_token(new_token,
+                                              sizeof(new_token)) == t[0]);
+    memcpy(token[0], new_token, sizeof(token[0]));
+
+    /*
+     * Clearing one leaves the others of its buckets in place.
+     */
+    coap_clear_transaction(t[1]);
+    TEST_ASSERT(coap_get_transaction_by_mid(TEST_TRANS_MID(1)) == NULL);
+    TEST_ASSERT(coap_get_transaction_by_token(token[1],
+                                              sizeof(token[1])) == NULL);
+    for (i = 0; i < TEST_TRANS_CNT; i += 2) {
+        TEST_ASSERT(coap_get_transaction_by_mid(TEST_TRANS_MID(i)) == t[i]);
+        TEST_ASSERT(coap_get_transaction_by_token(token[i],
+                                                  sizeof(token[i])) == t[i]);
+    }
+
+    coap_clear_transaction(t[0]);
+    coap_clear_transaction(t[2]);
+    for (i = 0; i < TEST_TRANS_CNT; i++) {
+        TEST_ASSERT(coap_get_transaction_by_mid(TEST_TRANS_MID(i)) == NULL);
+    }
+}
+
+static void
+test_trans_get(struct oc_request *request, oc_interface_mask_t interface)
+{
+    /*
+     * Drop the first request, so that the client has to retransmit it.
+     */
+    if (++test_trans_get_cnt == 1) {
+        oc_ignore_request(request);
+        return;
+    }
+    oc_rep_start_root_object();
+    oc_rep_set_int(root, value, test_trans_get_cnt);
+    oc_rep_end_root_object();
+    oc_send_response(request, OC_STATUS_OK);
+}
+
+static void
+test_trans_rsp(struct oc_client_response *rsp)
+{
+    long long value;
+
+    switch (test_trans_state) {
+    case 1:
+        TEST_ASSERT(rsp->code == OC_STATUS_OK);
+        TEST_ASSERT(oic_test_rsp_value(rsp, &value) == 0);
+        TEST_ASSERT(value == 2);
+        TEST_ASSERT(test_trans_get_cnt == 2);
+        break;
+    default:
+        break;
+    }
+    os_eventq_put(os_eventq_dflt_get(), &test_trans_next_ev);
+}
+
+static void
+test_trans_next_step(struct os_event *ev)
+{
+    bool b_rc;
+    struct oc_server_handle server;
+
+    test_trans_state++;
+    switch (test_trans_state) {
+    case 1:
+        test_trans_lookup();
+
+        test_res_trans = oc_new_resource("/trans", 1, 0);
+        TEST_ASSERT_FATAL(test_res_trans);
+
+        oc_resource_bind_resource_interface(test_res_trans, OC_IF_R);
+        oc_resource_set_default_interface(test_res_trans, OC_IF_R);
+        oc_resource_set_request_handler(test_res_trans, OC_GET,
+                                        test_trans_get);
+        b_rc = oc_add_resource(test_res_trans);
+        TEST_ASSERT(b_rc == true);
+
+        /*
+         * Confirmable request; answered after its first retransmission.
+         */
+        oic_test_get_endpoint(&server);
+        b_rc = oc_do_get("/trans", &server, NULL, test_trans_rsp, HIGH_QOS);
+        TEST_ASSERT_FATAL(b_rc == true);
+
+        oic_test_reset_tmo("trans1");
+        break;
+    case 2:
+        test_trans_done = 1;
+        break;
+    default:
+        TEST_ASSERT_FATAL(0);
+        break;
+    }
+}
+
+void
+test_transactions(void)
+{
+    os_eventq_put(os_eventq_dflt_get(), &test_trans_next_ev);
+    while (!test_trans_done)
+        ;
+
+    oc_delete_resource(test_res_trans);
+}
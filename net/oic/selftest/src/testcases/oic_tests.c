@@ -19,7 +19,9 @@
 
 #include "os/mynewt.h"
 #include <oic/oc_api.h>
+#include <oic/oc_buffer.h>
 #include <mn_socket/mn_socket.h>
+#include <cborattr/cborattr.h>
 #include "test_oic.h"
 
 /*
@@ -73,6 +75,69 @@ oic_test_get_endpoint(struct oc_server_handle *ose)
     memcpy(ose, &oic_tgt, sizeof(*ose));
 }
 
+bool
+oic_test_request(oc_method_t method, const char *uri,
+                 oc_response_handler_t handler, oic_test_fill_fn *fill,
+                 void *arg)
+{
+    coap_packet_t pkt[1];
+    oc_client_cb_t *cb;
+    struct os_mbuf *m;
+
+    cb = oc_ri_alloc_client_cb(uri, &oic_tgt, method, handler, LOW_QOS);
+    if (!cb) {
+        return false;
+    }
+    m = oc_allocate_mbuf(&cb->server.endpoint);
+    if (!m) {
+        oc_ri_remove_client_cb_by_mid(cb->mid);
+        return false;
+    }
+
+    coap_init_message(pkt, COAP_TYPE_NON, method, cb->mid);
+    coap_set_header_accept(pkt, APPLICATION_CBOR);
+    coap_set_token(pkt, cb->token, cb->token_len);
+    coap_set_header_uri_path(pkt, uri);
+    if (fill) {
+        fill(pkt, arg);
+    }
+
+    if (coap_serialize_message(pkt, m)) {
+        os_mbuf_free_chain(m);
+        oc_ri_remove_client_cb_by_mid(cb->mid);
+        return false;
+    }
+    os_callout_reset(&cb->callout,
+                     MYNEWT_VAL(OC_COAP_RESPONSE_TIMEOUT) * OS_TICKS_PER_SEC);
+    coap_send_message(m, 0);
+
+    return true;
+}
+
+int
+oic_test_rsp_value(struct oc_client_response *rsp, long long *value)
+{
+    struct cbor_attr_t attrs[] = {
+        [0] = {
+            .attribute = "value",
+            .type = CborAttrIntegerType,
+            .addr.integer = value,
+            .dflt.integer = -1
+        },
+        [1] = {
+        }
+    };
+    struct os_mbuf *m;
+    uint16_t data_off;
+    int len;
+
+    if (!rsp->packet) {
+        return -1;
+    }
+    len = coap_get_payload(rsp->packet, &m, &data_off);
+    return cbor_read_mbuf_attrs(m, data_off, len, attrs);
+}
+
 TEST_CASE_TASK(oic_tests)
 {
     os_callout_init(&oic_test_timer, os_eventq_dflt_get(), oic_test_timer_cb, NULL);
@@ -82,5 +147,13 @@ TEST_CASE_TASK(oic_tests)
     test_discovery();
     test_getset();
     test_observe();
+    test_dispatch();
+    test_transactions();
+#if MYNEWT_VAL(OC_BLOCKWISE)
+    test_blockwise();
+#endif
+#if MYNEWT_VAL(OC_RESPONSE_CACHE)
+    test_cache();
+#endif
     oc_main_shutdown();
 }
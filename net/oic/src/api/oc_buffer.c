@@ -32,6 +32,9 @@
 
 static struct os_mqueue oc_inq;
 static struct os_mqueue oc_outq;
+#if MYNEWT_VAL(OC_TX_QUEUE_MAX)
+static uint16_t oc_outq_cnt;
+#endif
 
 struct os_mbuf *
 oc_allocate_mbuf(struct oc_endpoint *oe)
@@ -59,13 +62,30 @@ oc_recv_message(struct os_mbuf *m)
     assert(rc == 0);
 }
 
-void
+/*
+ * Queues a message for the transports. Returns -1, having freed the
+ * message, if OC_TX_QUEUE_MAX messages are already waiting.
+ */
+int
 oc_send_message(struct os_mbuf *m)
 {
     int rc;
 
+#if MYNEWT_VAL(OC_TX_QUEUE_MAX)
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    if (oc_outq_cnt >= MYNEWT_VAL(OC_TX_QUEUE_MAX)) {
+        OS_EXIT_CRITICAL(sr);
+        os_mbuf_free_chain(m);
+        return -1;
+    }
+    oc_outq_cnt++;
+    OS_EXIT_CRITICAL(sr);
+#endif
     rc = os_mqueue_put(&oc_outq, oc_evq_get(), m);
     assert(rc == 0);
+    return 0;
 }
 
 static void
@@ -74,6 +94,13 @@ oc_buffer_tx(struct os_event *ev)
     struct os_mbuf *m;
 
     while ((m = os_mqueue_get(&oc_outq)) != NULL) {
+#if MYNEWT_VAL(OC_TX_QUEUE_MAX)
+        os_sr_t sr;
+
+        OS_ENTER_CRITICAL(sr);
+        oc_outq_cnt--;
+        OS_EXIT_CRITICAL(sr);
+#endif
         STAILQ_NEXT(OS_MBUF_PKTHDR(m), omp_next) = NULL;
         OC_LOG_DEBUG("oc_buffer_tx: ");
         OC_LOG_ENDPOINT(LOG_LEVEL_DEBUG, OC_MBUF_ENDPOINT(m));
@@ -103,6 +130,7 @@ oc_buffer_tx(struct os_event *ev)
         }
 #endif
     }
+    oc_send_flush();
 }
 
 static void
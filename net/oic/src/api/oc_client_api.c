@@ -21,6 +21,7 @@
 #include "oic/messaging/coap/transactions.h"
 #include "oic/oc_api.h"
 #include "oic/oc_buffer.h"
+#include "api/oc_priv.h"
 #if MYNEWT_VAL(OC_TRANSPORT_IPV6) || MYNEWT_VAL(OC_TRANSPORT_IPV4)
 #include "oic/port/mynewt/ip.h"
 #endif
@@ -84,6 +85,7 @@ prepare_coap_request(oc_client_cb_t *cb, oc_string_t *query)
         if (!oc_c_transaction) {
             goto free_rsp;
         }
+        coap_transaction_set_token(oc_c_transaction, cb->token, cb->token_len);
     } else {
         oc_c_message = oc_allocate_mbuf(&cb->server.endpoint);
         if (!oc_c_message) {
@@ -114,6 +116,51 @@ free_rsp:
     return false;
 }
 
+#if MYNEWT_VAL(OC_BLOCKWISE)
+bool
+oc_client_send_block_request(oc_client_cb_t *cb)
+{
+    /* Every block goes in its own message; the token stays the same. */
+    cb->mid = coap_get_mid();
+    if (!prepare_coap_request(cb, &cb->query)) {
+        return false;
+    }
+    coap_set_header_block2(oc_c_request, cb->block_next, 0, cb->block_size);
+    if (!dispatch_coap_request()) {
+        return false;
+    }
+    cb->block_next++;
+    cb->block_pending++;
+
+    return true;
+}
+
+bool
+oc_do_get_blockwise(const char *uri, oc_server_handle_t *server,
+                    const char *query, oc_response_handler_t handler,
+                    oc_qos_t qos, uint8_t window)
+{
+    oc_client_cb_t *cb;
+
+    cb = oc_ri_alloc_client_cb(uri, server, OC_GET, handler, qos);
+    if (!cb) {
+        return false;
+    }
+
+    if (query && strlen(query)) {
+        oc_concat_strings(&cb->query, "?", query);
+    }
+    cb->block_next = 0;
+    cb->block_last = UINT32_MAX;
+    cb->block_size = COAP_MAX_BLOCK_SIZE;
+    cb->block_window = window ? window : 1;
+    cb->block_pending = 0;
+
+    /* Block 0 goes alone; it settles the block size for the rest. */
+    return oc_client_send_block_request(cb);
+}
+#endif
+
 bool
 oc_do_delete(const char *uri, oc_server_handle_t *server,
              oc_response_handler_t handler, oc_qos_t qos)
@@ -18,6 +18,7 @@
 
 #include "oic/port/mynewt/config.h"
 #include "oic/oc_core_res.h"
+#include "oic/oc_discovery.h"
 #include "oic/messaging/coap/oc_coap.h"
 #include "oic/oc_rep.h"
 #include "oic/oc_ri.h"
@@ -142,6 +143,7 @@ oc_core_add_new_device(const char *uri, const char *rt, const char *name,
 #endif
 
     ocf_d = NUM_OC_CORE_RESOURCES - 1 - device_count;
+    oc_discovery_cache_clear();
 
     /* Construct device resource */
     oc_core_populate_resource(ocf_d, uri, rt, OC_IF_R | OC_IF_BASELINE,
@@ -24,8 +24,32 @@
 #include "oic/messaging/coap/oc_coap.h"
 #include "oic/oc_api.h"
 #include "oic/oc_core_res.h"
+#include "oic/oc_discovery.h"
 #include "oic/port/mynewt/ip.h"
 
+#if MYNEWT_VAL(OC_DISCOVERY_CACHE)
+/*
+ * Unfiltered discovery responses as last encoded, for OC_IF_LL and
+ * OC_IF_BASELINE.
+ */
+static struct os_mbuf *oc_discovery_cache[2];
+#endif
+
+void
+oc_discovery_cache_clear(void)
+{
+#if MYNEWT_VAL(OC_DISCOVERY_CACHE)
+    int i;
+
+    for (i = 0; i < 2; i++) {
+        if (oc_discovery_cache[i]) {
+            os_mbuf_free_chain(oc_discovery_cache[i]);
+            oc_discovery_cache[i] = NULL;
+        }
+    }
+#endif
+}
+
 static bool
 filter_resource(oc_resource_t *resource, const char *rt, int rt_len,
                 CborEncoder *links)
@@ -136,9 +160,36 @@ oc_core_discovery_handler(oc_request_t *req, oc_interface_mask_t interface)
     char *rt = NULL;
     int rt_len = 0, matches = 0;
     char uuid[37];
+#if MYNEWT_VAL(OC_DISCOVERY_CACHE)
+    struct os_mbuf *m;
+    int idx = -1;
+#endif
 
     rt_len = oc_ri_get_query_value(req->query, req->query_len, "rt", &rt);
 
+#if MYNEWT_VAL(OC_DISCOVERY_CACHE)
+    m = req->response->response_buffer->buffer;
+    if (rt_len <= 0) {
+        if (interface == OC_IF_LL) {
+            idx = 0;
+        } else if (interface == OC_IF_BASELINE) {
+            idx = 1;
+        }
+    }
+    if (idx >= 0 && oc_discovery_cache[idx]) {
+        if (!os_mbuf_appendfrom(m, oc_discovery_cache[idx], 0,
+                                OS_MBUF_PKTLEN(oc_discovery_cache[idx]))) {
+            oc_rep_reset();
+            req->response->response_buffer->response_length =
+              OS_MBUF_PKTLEN(m);
+            req->response->response_buffer->code =
+              oc_status_code(OC_STATUS_OK);
+            return;
+        }
+        os_mbuf_adj(m, -OS_MBUF_PKTLEN(m));
+    }
+#endif
+
     oc_uuid_to_str(oc_core_get_device_id(0), uuid, sizeof(uuid));
 
     switch (interface) {
@@ -164,6 +215,11 @@ oc_core_discovery_handler(oc_request_t *req, oc_interface_mask_t interface)
     if (matches && response_length > 0) {
         req->response->response_buffer->response_length = response_length;
         req->response->response_buffer->code = oc_status_code(OC_STATUS_OK);
+#if MYNEWT_VAL(OC_DISCOVERY_CACHE)
+        if (idx >= 0 && !oc_discovery_cache[idx]) {
+            oc_discovery_cache[idx] = os_mbuf_dup(m);
+        }
+#endif
     } else {
         /* There were rt/if selections and there were no matches, so ignore */
         req->response->response_buffer->code = OC_IGNORE;
@@ -23,4 +23,9 @@ void oc_rep_init(void);
 void oc_buffer_init(void);
 void oc_ri_mem_init(void);
 
+#if defined(OC_CLIENT) && MYNEWT_VAL(OC_BLOCKWISE)
+struct oc_client_cb;
+bool oc_client_send_block_request(struct oc_client_cb *cb);
+#endif
+
 #endif /* __OC_OC_PRIV_H__ */
@@ -34,16 +34,61 @@ static uint8_t oc_rep_objects_area[OS_MEMPOOL_BYTES(EST_NUM_REP_OBJECTS,
 #endif
 
 static struct os_mbuf *g_outm;
+static struct os_mbuf *g_outm_last;
 CborEncoder g_encoder, root_map, links_array;
 CborError g_err;
 struct cbor_mbuf_writer g_buf_writer;
 
+/*
+ * Appends encoded data to the response mbuf chain. The last mbuf in the
+ * chain is remembered, so the chain is not walked for each CBOR item, and
+ * new mbufs come from the msys pool which best fits what is left to write.
+ */
+static int
+oc_rep_mbuf_write(struct cbor_encoder_writer *arg, const char *data, int len)
+{
+    struct os_mbuf *last;
+    struct os_mbuf *om;
+    int space;
+    int left;
+    int cnt;
+
+    last = g_outm_last;
+    while (SLIST_NEXT(last, om_next)) {
+        last = SLIST_NEXT(last, om_next);
+    }
+    space = OS_MBUF_TRAILINGSPACE(last);
+    for (left = len; left > 0; left -= cnt) {
+        if (space == 0) {
+            om = os_msys_get(left, 0);
+            if (!om) {
+                break;
+            }
+            SLIST_NEXT(last, om_next) = om;
+            last = om;
+            space = OS_MBUF_TRAILINGSPACE(om);
+        }
+        cnt = min(space, left);
+        memcpy(last->om_data + last->om_len, data, cnt);
+        last->om_len += cnt;
+        data += cnt;
+        space -= cnt;
+    }
+    g_outm_last = last;
+    OS_MBUF_PKTHDR(g_outm)->omp_len += len - left;
+    arg->bytes_written += len - left;
+
+    return left ? CborErrorOutOfMemory : CborNoError;
+}
+
 void
 oc_rep_new(struct os_mbuf *m)
 {
     g_err = CborNoError;
     g_outm = m;
+    g_outm_last = m;
     cbor_mbuf_writer_init(&g_buf_writer, m);
+    g_buf_writer.enc.write = oc_rep_mbuf_write;
     cbor_encoder_init(&g_encoder, &g_buf_writer.enc, 0);
 }
 
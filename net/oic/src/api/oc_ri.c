@@ -33,6 +33,7 @@
 #include "oic/oc_buffer.h"
 #include "oic/oc_core_res.h"
 #include "oic/oc_discovery.h"
+#include "oic/oc_api.h"
 #include "oic/oc_ri.h"
 #include "oic/oc_uuid.h"
 #include "oic/oc_ri_const.h"
@@ -43,6 +44,9 @@
 #include "security/oc_dtls.h"
 #endif /* OC_SECURITY */
 
+/* Scratch storage for the request being handled; reset after each one. */
+static struct arena oc_req_arena;
+
 #ifdef OC_SERVER
 static SLIST_HEAD(, oc_resource) oc_app_resources =
     SLIST_HEAD_INITIALIZER(&oc_app_resources);
@@ -50,6 +54,15 @@ static struct os_mempool oc_resource_pool;
 static uint8_t oc_resource_area[OS_MEMPOOL_BYTES(MAX_APP_RESOURCES,
       sizeof(oc_resource_t))];
 
+#define OC_RES_HASH_SIZE MYNEWT_VAL(OC_APP_RESOURCE_HASH_SIZE)
+
+static_assert((OC_RES_HASH_SIZE & (OC_RES_HASH_SIZE - 1)) == 0,
+              "OC_APP_RESOURCE_HASH_SIZE must be a power of two");
+
+/* Application resources indexed by a hash of their URI path. */
+static SLIST_HEAD(oc_app_res_bucket, oc_resource)
+    oc_app_res_hash[OC_RES_HASH_SIZE];
+
 static void periodic_observe_handler(struct os_event *ev);
 #endif /* OC_SERVER */
 
@@ -191,12 +204,59 @@ stop_processes(void)
 }
 
 #ifdef OC_SERVER
+/*
+ * Returns the bucket of oc_app_res_hash for a URI path given without the
+ * leading '/'.  The bucket is picked by an FNV-1a hash of the path.
+ */
+static struct oc_app_res_bucket *
+oc_ri_path_bucket(const char *path, int path_len)
+{
+    uint32_t hash;
+    int i;
+
+    hash = 2166136261u;
+    for (i = 0; i < path_len; i++) {
+        hash ^= (uint8_t)path[i];
+        hash *= 16777619u;
+    }
+
+    return &oc_app_res_hash[hash & (OC_RES_HASH_SIZE - 1)];
+}
+
+static struct oc_app_res_bucket *
+oc_ri_res_bucket(const char *uri)
+{
+    if (*uri == '/') {
+        uri++;
+    }
+    return oc_ri_path_bucket(uri, strlen(uri));
+}
+
+/*
+ * Looks up an application resource by URI path, given without the leading
+ * '/' as carried in the CoAP Uri-Path options.
+ */
+static oc_resource_t *
+oc_ri_find_app_resource(const char *path, int path_len)
+{
+    oc_resource_t *res;
+
+    SLIST_FOREACH(res, oc_ri_path_bucket(path, path_len), hash_next) {
+        if (oc_string_len(res->uri) == path_len + 1 &&
+          strncmp(oc_string(res->uri) + 1, path, path_len) == 0) {
+            return res;
+        }
+    }
+
+    return NULL;
+}
+
 oc_resource_t *
 oc_ri_get_app_resource_by_uri(const char *uri)
 {
     oc_resource_t *res;
 
-    SLIST_FOREACH(res, &oc_app_resources, next) {
+    SLIST_FOREACH(res, oc_ri_res_bucket(uri), hash_next) {
         if (oc_string_len(res->uri) == strlen(uri) &&
           strncmp(uri, oc_string(res->uri), strlen(uri)) == 0)
             return res;
@@ -228,6 +288,7 @@ oc_ri_init(void)
     SLIST_INIT(&oc_client_cbs);
 #endif
 
+    arena_init_mbuf(&oc_req_arena, NULL);
     start_processes();
     oc_create_discovery_resource();
 }
@@ -249,6 +310,11 @@ oc_ri_alloc_resource(void)
     if (resource) {
         os_callout_init(&resource->callout, oc_evq_get(),
           periodic_observe_handler, resource);
+        SLIST_INIT(&resource->observers);
+#if MYNEWT_VAL(OC_RESPONSE_CACHE)
+        resource->cache_m = NULL;
+        resource->cache_max_age = 0;
+#endif
     }
     return resource;
 }
@@ -261,9 +327,15 @@ oc_ri_delete_resource(oc_resource_t *resource)
     SLIST_FOREACH(tmp, &oc_app_resources, next) {
         if (tmp == resource) {
             SLIST_REMOVE(&oc_app_resources, tmp, oc_resource, next);
+            SLIST_REMOVE(oc_ri_res_bucket(oc_string(resource->uri)),
+                         resource, oc_resource, hash_next);
+            oc_discovery_cache_clear();
             break;
         }
     }
+#if MYNEWT_VAL(OC_RESPONSE_CACHE)
+    oc_resource_cache_invalidate(resource);
+#endif
     os_memblock_put(&oc_resource_pool, resource);
 }
 
@@ -273,7 +345,11 @@ oc_ri_add_resource(oc_resource_t *resource)
     bool valid = true;
 
     if (!resource->get_handler && !resource->put_handler &&
-      !resource->post_handler && !resource->delete_handler) {
+      !resource->post_handler && !resource->delete_handler
+#if MYNEWT_VAL(OC_BLOCKWISE)
+      && !resource->block2_handler && !resource->block1_handler
+#endif
+      ) {
         valid = false;
     }
     if (resource->properties & OC_PERIODIC &&
@@ -282,6 +358,9 @@ oc_ri_add_resource(oc_resource_t *resource)
     }
     if (valid) {
         SLIST_INSERT_HEAD(&oc_app_resources, resource, next);
+        SLIST_INSERT_HEAD(oc_ri_res_bucket(oc_string(resource->uri)),
+                          resource, hash_next);
+        oc_discovery_cache_clear();
     }
 
     return valid;
@@ -389,6 +468,197 @@ oc_ri_check_trans_security(const oc_endpoint_t *oe,
   return true;
 }
 
+#if defined(OC_SERVER) && MYNEWT_VAL(OC_BLOCKWISE)
+/*
+ * Serves a GET from the resource's Block2 handler.  The next block offset,
+ * or -1 after the last block, is handed back through block_offset so that
+ * the engine sets the Block2 option of the response.
+ */
+static void
+oc_ri_invoke_block2_handler(struct coap_packet_rx *request,
+                            oc_request_t *request_obj,
+                            oc_resource_t *resource,
+                            oc_response_buffer_t *response_buffer)
+{
+  uint32_t offset = 0;
+  uint16_t size = COAP_MAX_BLOCK_SIZE;
+  int rc;
+
+  if (IS_OPTION(request, COAP_OPTION_BLOCK2)) {
+    offset = request->block2_offset;
+    size = MIN(request->block2_size, COAP_MAX_BLOCK_SIZE);
+  }
+
+  rc = resource->block2_handler(request_obj, offset, size,
+                                response_buffer->buffer);
+  if (rc < 0) {
+    response_buffer->code =
+      oc_status_code(OC_STATUS_INTERNAL_SERVER_ERROR);
+    return;
+  }
+
+  response_buffer->response_length = OS_MBUF_PKTLEN(response_buffer->buffer);
+  response_buffer->code = oc_status_code(OC_STATUS_OK);
+  *response_buffer->block_offset = rc ? offset + size : -1;
+}
+
+/*
+ * Hands one block of a PUT/POST body to the resource's Block1 handler.
+ * Blocks other than the last are acknowledged with 2.31 Continue.
+ */
+static void
+oc_ri_invoke_block1_handler(struct coap_packet_rx *request,
+                            coap_packet_t *response,
+                            oc_request_t *request_obj,
+                            oc_resource_t *resource,
+                            oc_response_buffer_t *response_buffer)
+{
+  struct os_mbuf *m;
+  uint32_t offset = 0;
+  uint16_t off;
+  uint16_t len;
+  bool more = false;
+
+  if (IS_OPTION(request, COAP_OPTION_BLOCK1)) {
+    offset = request->block1_offset;
+    more = request->block1_more;
+    coap_set_header_block1(response, request->block1_num, more,
+                           request->block1_size);
+  }
+
+  len = coap_get_payload(request, &m, &off);
+  if (resource->block1_handler(request_obj, offset, m, off, len, more)) {
+    response_buffer->response_length = 0;
+    response_buffer->code =
+      oc_status_code(OC_STATUS_REQUEST_ENTITY_TOO_LARGE);
+  } else if (more) {
+    response_buffer->response_length = 0;
+    response_buffer->code = CONTINUE_2_31;
+  }
+}
+#endif
+
+#if MYNEWT_VAL(OC_RESPONSE_CACHE)
+/* Tags cached responses; bumped whenever a response is cached. */
+static uint32_t oc_ri_cache_etag;
+
+void
+oc_resource_cache_invalidate(oc_resource_t *resource)
+{
+  if (resource->cache_m) {
+    os_mbuf_free_chain(resource->cache_m);
+    resource->cache_m = NULL;
+  }
+}
+
+void
+oc_resource_set_cache(oc_resource_t *resource, uint32_t max_age)
+{
+  oc_resource_cache_invalidate(resource);
+  resource->cache_max_age = max_age;
+}
+
+/* Plain GETs, and ones that only select an interface, can use the cache. */
+static bool
+oc_ri_cache_usable(const oc_resource_t *resource, const char *query,
+                   int query_len)
+{
+  if (resource->cache_max_age == 0) {
+    return false;
+  }
+#if MYNEWT_VAL(OC_BLOCKWISE)
+  if (resource->block2_handler) {
+    return false;
+  }
+#endif
+  if (query_len == 0) {
+    return true;
+  }
+  return query_len > 3 && strncmp(query, "if=", 3) == 0 &&
+         memchr(query, '&', query_len) == NULL;
+}
+
+static void
+oc_ri_cache_set_options(coap_packet_t *response,
+                        const oc_resource_t *resource)
+{
+  os_stime_t left;
+
+  left = resource->cache_expires - os_time_get();
+  if (left < 0) {
+    left = 0;
+  }
+  coap_set_header_etag(response, (const uint8_t *)&resource->cache_etag,
+                       sizeof(resource->cache_etag));
+  coap_set_header_max_age(response, left / OS_TICKS_PER_SEC);
+}
+
+/*
+ * Answers a GET from the resource's cached response: with its payload, or
+ * with 2.03 Valid if the request carries its ETag.  Returns false if
+ * there is nothing usable cached.
+ */
+static bool
+oc_ri_cache_get(struct coap_packet_rx *request, coap_packet_t *response,
+                oc_resource_t *resource, oc_interface_mask_t interface,
+                oc_response_buffer_t *response_buffer)
+{
+  struct os_mbuf *m = response_buffer->buffer;
+  const uint8_t *etag;
+  int etag_len;
+
+  if (!resource->cache_m || resource->cache_interface != interface) {
+    return false;
+  }
+  if (OS_TIME_TICK_GEQ(os_time_get(), resource->cache_expires)) {
+    oc_resource_cache_invalidate(resource);
+    return false;
+  }
+
+  etag_len = coap_get_header_etag(request, &etag);
+  if (etag_len == sizeof(resource->cache_etag) &&
+      memcmp(etag, &resource->cache_etag, etag_len) == 0) {
+    response_buffer->response_length = 0;
+    response_buffer->code = VALID_2_03;
+  } else {
+    if (os_mbuf_appendfrom(m, resource->cache_m, 0,
+                           OS_MBUF_PKTLEN(resource->cache_m))) {
+      os_mbuf_adj(m, -OS_MBUF_PKTLEN(m));
+      return false;
+    }
+    response_buffer->response_length = OS_MBUF_PKTLEN(m);
+    response_buffer->code = oc_status_code(OC_STATUS_OK);
+  }
+  oc_rep_reset();
+  oc_ri_cache_set_options(response, resource);
+
+  return true;
+}
+
+/* Keeps the response of a successful GET for the resource's Max-Age. */
+static void
+oc_ri_cache_put(coap_packet_t *response, oc_resource_t *resource,
+                oc_interface_mask_t interface,
+                const oc_response_buffer_t *response_buffer)
+{
+  if (response_buffer->code != oc_status_code(OC_STATUS_OK) ||
+      response_buffer->response_length == 0) {
+    return;
+  }
+
+  oc_resource_cache_invalidate(resource);
+  resource->cache_m = os_mbuf_dup(response_buffer->buffer);
+  if (!resource->cache_m) {
+    return;
+  }
+  resource->cache_interface = interface;
+  resource->cache_etag = ++oc_ri_cache_etag;
+  resource->cache_expires = os_time_get() +
+                            resource->cache_max_age * OS_TICKS_PER_SEC;
+  oc_ri_cache_set_options(response, resource);
+}
+#endif
+
 bool
 oc_ri_invoke_coap_entity_handler(struct coap_packet_rx *request,
                                  coap_packet_t *response, int32_t *offset,
@@ -413,6 +683,9 @@ oc_ri_invoke_coap_entity_handler(struct coap_packet_rx *request,
 #ifdef OC_SERVER
   int rc;
 #endif
+#if MYNEWT_VAL(OC_RESPONSE_CACHE)
+  bool cacheable;
+#endif
 
   response_buffer.buffer = NULL;
   response_buffer.block_offset = offset;
@@ -427,6 +700,7 @@ oc_ri_invoke_coap_entity_handler(struct coap_packet_rx *request,
   request_obj.resource = 0;
   request_obj.origin = endpoint;
   request_obj.packet = request;
+  request_obj.arena = &oc_req_arena;
 
   /* Initialize OCF interface selector. */
   oc_interface_mask_t interface = 0;
@@ -477,14 +751,8 @@ oc_ri_invoke_coap_entity_handler(struct coap_packet_rx *request,
   /* Check against list of declared application resources.
    */
   if (!cur_resource && !bad_request) {
-      SLIST_FOREACH(resource, &oc_app_resources, next) {
-          if (oc_string_len(resource->uri) == (uri_path_len + 1) &&
-            strncmp((const char *)oc_string(resource->uri) + 1, uri_path,
-              uri_path_len) == 0) {
-              request_obj.resource = cur_resource = resource;
-              break;
-          }
-      }
+      request_obj.resource = cur_resource =
+        oc_ri_find_app_resource(uri_path, uri_path_len);
   }
 #endif
 
@@ -539,8 +807,31 @@ oc_ri_invoke_coap_entity_handler(struct coap_packet_rx *request,
              * based on the request method. If the resource has not
              * implemented that method, then return a 4.05 response.
              */
+#if MYNEWT_VAL(OC_BLOCKWISE)
+      if (method == OC_GET && cur_resource->block2_handler) {
+        oc_ri_invoke_block2_handler(request, &request_obj, cur_resource,
+                                    &response_buffer);
+      } else if ((method == OC_PUT || method == OC_POST) &&
+                 cur_resource->block1_handler) {
+        oc_ri_invoke_block1_handler(request, response, &request_obj,
+                                    cur_resource, &response_buffer);
+      } else
+#endif
       if (method == OC_GET && cur_resource->get_handler) {
+#if MYNEWT_VAL(OC_RESPONSE_CACHE)
+        cacheable = oc_ri_cache_usable(cur_resource, uri_query, uri_query_len);
+        if (!cacheable ||
+            !oc_ri_cache_get(request, response, cur_resource, interface,
+                             &response_buffer)) {
+          cur_resource->get_handler(&request_obj, interface);
+          if (cacheable) {
+            oc_ri_cache_put(response, cur_resource, interface,
+                            &response_buffer);
+          }
+        }
+#else
         cur_resource->get_handler(&request_obj, interface);
+#endif
       } else if (method == OC_POST && cur_resource->post_handler) {
         cur_resource->post_handler(&request_obj, interface);
       } else if (method == OC_PUT && cur_resource->put_handler) {
@@ -669,7 +960,8 @@ oc_ri_invoke_coap_entity_handler(struct coap_packet_rx *request,
      * of that resource with the change.
      */
     if ((method == OC_PUT || method == OC_POST) &&
-        response_buffer.code < oc_status_code(OC_STATUS_BAD_REQUEST)) {
+        response_buffer.code < oc_status_code(OC_STATUS_BAD_REQUEST) &&
+        response_buffer.code != CONTINUE_2_31) {
         coap_notify_observers(cur_resource, NULL, NULL);
     }
 #endif
@@ -687,6 +979,7 @@ oc_ri_invoke_coap_entity_handler(struct coap_packet_rx *request,
   if (response_buffer.buffer) {
       os_mbuf_free_chain(response_buffer.buffer);
   }
+  arena_reset(&oc_req_arena);
   return success;
 }
 
@@ -696,6 +989,9 @@ free_client_cb(oc_client_cb_t *cb)
 {
     os_callout_stop(&cb->callout);
     oc_free_string(&cb->uri);
+#if MYNEWT_VAL(OC_BLOCKWISE)
+    oc_free_string(&cb->query);
+#endif
     SLIST_REMOVE(&oc_client_cbs, cb, oc_client_cb, next);
     os_memblock_put(&oc_client_cb_pool, cb);
 }
@@ -737,6 +1033,66 @@ oc_ri_send_rst(oc_endpoint_t *endpoint, uint8_t *token, uint8_t token_len,
     return false;
 }
 
+#if MYNEWT_VAL(OC_BLOCKWISE)
+/*
+ * Handles a response to a blockwise GET started by oc_do_get_blockwise().
+ * Every block received is passed to the handler, and the window of block
+ * requests in flight is refilled until the last block has been seen.  The
+ * client callback is freed once nothing is outstanding.
+ */
+static void
+oc_ri_client_block_response(oc_client_cb_t *cb, struct coap_packet_rx *rsp,
+                            oc_client_response_t *client_response)
+{
+    oc_response_handler_t handler;
+    uint32_t num;
+    uint16_t size;
+    uint8_t more;
+
+    if (rsp->type == COAP_TYPE_ACK && rsp->code == 0) {
+        /* Empty ACK; a separate response is on its way. */
+        return;
+    }
+    if (cb->block_pending > 0) {
+        cb->block_pending--;
+    }
+
+    handler = (oc_response_handler_t)cb->handler;
+    if (!coap_get_header_block2(rsp, &num, &more, &size, NULL)) {
+        /*
+         * Either the representation fit in one response, or this is an
+         * error.  Once the end is known, errors are answers to requests
+         * past the last block and are dropped.
+         */
+        if (cb->block_last == UINT32_MAX) {
+            handler(client_response);
+            cb->block_last = 0;
+        }
+    } else {
+        if (num == 0 && size < cb->block_size) {
+            /* Server asked for smaller blocks. */
+            cb->block_size = size;
+        }
+        if (num <= cb->block_last) {
+            handler(client_response);
+        }
+        if (!more && num < cb->block_last) {
+            cb->block_last = num;
+        }
+    }
+
+    while (cb->block_last == UINT32_MAX &&
+           cb->block_pending < cb->block_window) {
+        if (!oc_client_send_block_request(cb)) {
+            break;
+        }
+    }
+    if (cb->block_pending == 0) {
+        free_client_cb(cb);
+    }
+}
+#endif
+
 bool
 oc_ri_invoke_client_cb(struct coap_packet_rx *rsp, oc_endpoint_t *endpoint)
 {
@@ -790,6 +1146,15 @@ oc_ri_invoke_client_cb(struct coap_packet_rx *rsp, oc_endpoint_t *endpoint)
         }
         coap_get_header_observe(rsp, &client_response.observe_option);
 
+#if MYNEWT_VAL(OC_BLOCKWISE)
+        if (cb->block_window) {
+            client_response.packet = rsp;
+            client_response.origin = endpoint;
+            oc_ri_client_block_response(cb, rsp, &client_response);
+            break;
+        }
+#endif
+
         bool separate = false;
         /*
           if payload exists, process payload and save in client response
@@ -896,6 +1261,10 @@ oc_ri_alloc_client_cb(const char *uri, oc_server_handle_t *server,
     cb->discovery = false;
     cb->timestamp = oc_clock_time();
     cb->observe_seq = -1;
+#if MYNEWT_VAL(OC_BLOCKWISE)
+    memset(&cb->query, 0, sizeof(cb->query));
+    cb->block_window = 0;
+#endif
     memcpy(&cb->server, server, sizeof(oc_server_handle_t));
 
     os_callout_init(&cb->callout, oc_evq_get(), oc_ri_remove_cb, cb);
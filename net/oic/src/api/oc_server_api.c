@@ -113,7 +113,12 @@ oc_new_resource(const char *uri, uint8_t num_resource_types, int device)
   resource->observe_period_mseconds = 0;
   resource->properties = OC_ACTIVE;
   resource->num_observers = 0;
+  resource->observe_handler = NULL;
   resource->device = device;
+#if MYNEWT_VAL(OC_BLOCKWISE)
+  resource->block2_handler = NULL;
+  resource->block1_handler = NULL;
+#endif
   return resource;
 }
 
@@ -183,6 +188,13 @@ oc_resource_set_observable(oc_resource_t *resource)
   resource->properties |= OC_OBSERVABLE;
 }
 
+void
+oc_resource_set_observe_handler(oc_resource_t *resource,
+                                oc_observe_handler_t handler)
+{
+  resource->observe_handler = handler;
+}
+
 void
 oc_resource_set_periodic_observable_ms(oc_resource_t *resource, uint32_t mseconds)
 {
@@ -225,6 +237,17 @@ oc_resource_set_request_handler(oc_resource_t *resource, oc_method_t method,
   }
 }
 
+#if MYNEWT_VAL(OC_BLOCKWISE)
+void
+oc_resource_set_block_handlers(oc_resource_t *resource,
+                               oc_block2_handler_t get_handler,
+                               oc_block1_handler_t put_handler)
+{
+  resource->block2_handler = get_handler;
+  resource->block1_handler = put_handler;
+}
+#endif
+
 bool
 oc_add_resource(oc_resource_t *resource)
 {
@@ -81,7 +81,7 @@ coap_log_2(uint16_t value)
 }
 /*---------------------------------------------------------------------------*/
 static uint32_t
-coap_parse_int_option(struct os_mbuf *m, uint16_t off, size_t length)
+coap_parse_int_option(const struct os_mbuf_cursor *cur, size_t length)
 {
     uint8_t bytes[4];
     uint32_t var = 0;
@@ -90,7 +90,7 @@ coap_parse_int_option(struct os_mbuf *m, uint16_t off, size_t length)
     if (length >= 4) {
         return -1;
     }
-    if (os_mbuf_copydata(m, off, length, bytes)) {
+    if (os_mbuf_cursor_peek(cur, bytes, length)) {
         return -1;
     }
     while (i < length) {
@@ -237,32 +237,55 @@ coap_append_array_opt(struct os_mbuf *m,
 }
 /*---------------------------------------------------------------------------*/
 
-static void
-coap_merge_multi_option(struct os_mbuf *m, uint16_t *off1, uint16_t *len1,
-                        uint16_t off2, uint16_t len2, char separator)
+/*
+ * Records where one value of a repeatable option sits; the values are only
+ * joined when read back.  len is the length of the joined string.
+ */
+static int
+coap_index_multi_option(struct coap_opt_seg *seg, uint8_t *nseg,
+                        uint16_t *len, uint16_t off, uint16_t opt_len)
 {
-    uint8_t tmp[4];
-    int i;
-    int blk;
+    if (*nseg >= COAP_MAX_URI_SEGMENTS) {
+        return -1;
+    }
+    seg[*nseg].off = off;
+    seg[*nseg].len = opt_len;
+    if (*nseg > 0) {
+        *len += 1;
+    }
+    *len += opt_len;
+    (*nseg)++;
 
-    /* merge multiple options */
-    if (*len1 > 0) {
-        /* dst already contains an option: concatenate */
-        os_mbuf_copyinto(m, *off1 + *len1, &separator, 1);
-        *len1 += 1;
+    return 0;
+}
 
-        for (i = 0; i < len2; i += blk) {
-            blk = min(sizeof(tmp), len2 - i);
-            os_mbuf_copydata(m, off2 + i, blk, tmp);
-            os_mbuf_copyinto(m, *off1 + *len1 + i, tmp, blk);
-        }
+/*
+ * Joins the indexed option values with separator into buf.  Values in the
+ * leading, contiguous part of the packet are copied straight from it.
+ */
+static int
+coap_get_multi_option(struct os_mbuf *m, const struct coap_opt_seg *seg,
+                      int nseg, char separator, char *buf, int maxlen)
+{
+    int len;
+    int blk;
+    int i;
 
-        *len1 += len2;
-    } else {
-        /* off1 is empty: set to off2 */
-        *off1 = off2;
-        *len1 = len2;
+    len = 0;
+    for (i = 0; i < nseg && len < maxlen; i++) {
+        if (i > 0) {
+            buf[len++] = separator;
+        }
+        blk = min(seg[i].len, maxlen - len);
+        if (seg[i].off + blk <= m->om_len) {
+            memcpy(buf + len, m->om_data + seg[i].off, blk);
+        } else {
+            os_mbuf_copydata(m, seg[i].off, blk, buf + len);
+        }
+        len += blk;
     }
+
+    return len;
 }
 
 /*---------------------------------------------------------------------------*/
@@ -475,8 +498,10 @@ coap_serialize_message(coap_packet_t *pkt, struct os_mbuf *m)
     if (pkt->payload_m) {
         assert(pkt->payload_len <= OS_MBUF_PKTLEN(pkt->payload_m));
         if (pkt->payload_len < OS_MBUF_PKTLEN(pkt->payload_m)) {
+            /* Drop the tail beyond payload_len. */
             os_mbuf_adj(pkt->payload_m,
-                        OS_MBUF_PKTLEN(pkt->payload_m) - pkt->payload_len);
+                        (int)pkt->payload_len -
+                          (int)OS_MBUF_PKTLEN(pkt->payload_m));
         }
         os_mbuf_concat(m, pkt->payload_m);
     }
@@ -508,7 +533,9 @@ coap_send_message(struct os_mbuf *m, int dup)
             return;
         }
     }
-    oc_send_message(m);
+    if (oc_send_message(m)) {
+        STATS_INC(coap_stats, oerr);
+    }
 }
 
 /*
@@ -560,12 +587,14 @@ coap_parse_message(struct coap_packet_rx *pkt, struct os_mbuf **mp)
         struct coap_tcp_hdr16 c16;
         struct coap_tcp_hdr32 c32;
     } cth;
+    struct os_mbuf_cursor cur;
     uint8_t tmp[4];
     uint16_t cur_opt;
     unsigned int opt_num = 0;
     unsigned int opt_delta = 0;
     size_t opt_len = 0;
     uint8_t data_len;
+    uint16_t hdr_len;
     int rc;
 
     m = *mp;
@@ -663,7 +692,13 @@ err_short:
         return BAD_REQUEST_4_00;
     }
 
-    if (os_mbuf_copydata(m, cur_opt, pkt->token_len, pkt->token)) {
+    /*
+     * Options are read sequentially through a cursor rather than by offset,
+     * which would rewalk the mbuf chain for every field.
+     */
+    os_mbuf_cursor_init(&cur, m);
+    if (os_mbuf_cursor_seek(&cur, cur_opt) ||
+        os_mbuf_cursor_read(&cur, pkt->token, pkt->token_len)) {
         goto err_short;
     }
     cur_opt += pkt->token_len;
@@ -677,7 +712,7 @@ err_short:
     while (cur_opt < OS_MBUF_PKTLEN(m)) {
         /* payload marker 0xFF, currently only checking for 0xF* because rest is
          * reserved */
-        if (os_mbuf_copydata(m, cur_opt, 1, tmp)) {
+        if (os_mbuf_cursor_read(&cur, tmp, 1)) {
             goto err_short;
         }
         if ((tmp[0] & 0xF0) == 0xF0) {
@@ -696,13 +731,13 @@ err_short:
         ++cur_opt;
 
         if (opt_delta == 13) {
-            if (os_mbuf_copydata(m, cur_opt, 1, tmp)) {
+            if (os_mbuf_cursor_read(&cur, tmp, 1)) {
                 goto err_short;
             }
             opt_delta += tmp[0];
             ++cur_opt;
         } else if (opt_delta == 14) {
-            if (os_mbuf_copydata(m, cur_opt, 2, tmp)) {
+            if (os_mbuf_cursor_read(&cur, tmp, 2)) {
                 goto err_short;
             }
             opt_delta += (255 + (tmp[0] << 8) + tmp[1]);
@@ -710,13 +745,13 @@ err_short:
         }
 
         if (opt_len == 13) {
-            if (os_mbuf_copydata(m, cur_opt, 1, tmp)) {
+            if (os_mbuf_cursor_read(&cur, tmp, 1)) {
                 goto err_short;
             }
             opt_len += tmp[0];
             ++cur_opt;
         } else if (opt_len == 14) {
-            if (os_mbuf_copydata(m, cur_opt, 2, tmp)) {
+            if (os_mbuf_cursor_read(&cur, tmp, 2)) {
                 goto err_short;
             }
             opt_len += (255 + (tmp[0] << 8) + tmp[1]);
@@ -733,11 +768,11 @@ err_short:
 
         switch (opt_num) {
         case COAP_OPTION_CONTENT_FORMAT:
-            pkt->content_format = coap_parse_int_option(m, cur_opt, opt_len);
+            pkt->content_format = coap_parse_int_option(&cur, opt_len);
             OC_LOG_DEBUG("Content-Format [%u]\n", pkt->content_format);
             break;
         case COAP_OPTION_MAX_AGE:
-            pkt->max_age = coap_parse_int_option(m, cur_opt, opt_len);
+            pkt->max_age = coap_parse_int_option(&cur, opt_len);
             OC_LOG_DEBUG("Max-Age [%lu]\n", (unsigned long)pkt->max_age);
             break;
 #if 0
@@ -751,7 +786,7 @@ err_short:
             break;
 #endif
         case COAP_OPTION_ACCEPT:
-            pkt->accept = coap_parse_int_option(m, cur_opt, opt_len);
+            pkt->accept = coap_parse_int_option(&cur, opt_len);
             OC_LOG_DEBUG("Accept [%u]\n", pkt->accept);
             break;
 #if 0
@@ -801,25 +836,27 @@ err_short:
                             pkt->uri_host_len);
             break;
         case COAP_OPTION_URI_PORT:
-            pkt->uri_port = coap_parse_int_option(m, cur_opt, opt_len);
+            pkt->uri_port = coap_parse_int_option(&cur, opt_len);
             OC_LOG_DEBUG("Uri-Port [%u]\n", pkt->uri_port);
             break;
 #endif
         case COAP_OPTION_URI_PATH:
-            /* coap_merge_multi_option() operates in-place on the buf */
-            coap_merge_multi_option(m, &pkt->uri_path_off, &pkt->uri_path_len,
-                                    cur_opt, opt_len, '/');
+            if (coap_index_multi_option(pkt->uri_path_seg, &pkt->uri_path_nseg,
+                                        &pkt->uri_path_len, cur_opt, opt_len)) {
+                goto err_segs;
+            }
             OC_LOG_DEBUG("Uri-Path ");
-            OC_LOG_STR_MBUF(LOG_LEVEL_DEBUG, m, pkt->uri_path_off,
-                            pkt->uri_path_len);
+            OC_LOG_STR_MBUF(LOG_LEVEL_DEBUG, m, cur_opt, opt_len);
             break;
         case COAP_OPTION_URI_QUERY:
-            /* coap_merge_multi_option() operates in-place on the mbuf */
-            coap_merge_multi_option(m, &pkt->uri_query_off, &pkt->uri_query_len,
-                                    cur_opt, opt_len, '&');
+            if (coap_index_multi_option(pkt->uri_query_seg,
+                                        &pkt->uri_query_nseg,
+                                        &pkt->uri_query_len, cur_opt,
+                                        opt_len)) {
+                goto err_segs;
+            }
             OC_LOG_DEBUG("Uri-Query ");
-            OC_LOG_STR_MBUF(LOG_LEVEL_DEBUG, m, pkt->uri_query_off,
-                            pkt->uri_query_len);
+            OC_LOG_STR_MBUF(LOG_LEVEL_DEBUG, m, cur_opt, opt_len);
             break;
 #if 0
         case COAP_OPTION_LOCATION_PATH:
@@ -840,11 +877,11 @@ err_short:
             break;
 #endif
         case COAP_OPTION_OBSERVE:
-            pkt->observe = coap_parse_int_option(m, cur_opt, opt_len);
+            pkt->observe = coap_parse_int_option(&cur, opt_len);
             OC_LOG_DEBUG("Observe [%lu]\n", (unsigned long)pkt->observe);
             break;
         case COAP_OPTION_BLOCK2:
-            pkt->block2_num = coap_parse_int_option(m, cur_opt, opt_len);
+            pkt->block2_num = coap_parse_int_option(&cur, opt_len);
             pkt->block2_more = (pkt->block2_num & 0x08) >> 3;
             pkt->block2_size = 16 << (pkt->block2_num & 0x07);
             pkt->block2_offset =
@@ -855,7 +892,7 @@ err_short:
                          pkt->block2_more ? "+" : "", pkt->block2_size);
             break;
         case COAP_OPTION_BLOCK1:
-            pkt->block1_num = coap_parse_int_option(m, cur_opt, opt_len);
+            pkt->block1_num = coap_parse_int_option(&cur, opt_len);
             pkt->block1_more = (pkt->block1_num & 0x08) >> 3;
             pkt->block1_size = 16 << (pkt->block1_num & 0x07);
             pkt->block1_offset =
@@ -866,11 +903,11 @@ err_short:
                          pkt->block1_more ? "+" : "", pkt->block1_size);
             break;
         case COAP_OPTION_SIZE2:
-            pkt->size2 = coap_parse_int_option(m, cur_opt, opt_len);
+            pkt->size2 = coap_parse_int_option(&cur, opt_len);
             OC_LOG_DEBUG("Size2 [%lu]\n", (unsigned long)pkt->size2);
             break;
         case COAP_OPTION_SIZE1:
-            pkt->size1 = coap_parse_int_option(m, cur_opt, opt_len);
+            pkt->size1 = coap_parse_int_option(&cur, opt_len);
             OC_LOG_DEBUG("Size1 [%lu]\n", (unsigned long)pkt->size1);
             break;
         default:
@@ -882,10 +919,29 @@ err_short:
                 return BAD_OPTION_4_02;
             }
         }
+        /* An option running past the end of the packet ends the loop. */
+        os_mbuf_cursor_skip(&cur, opt_len);
         cur_opt += opt_len;
     } /* for */
 
+    /*
+     * Make the header and options contiguous when the first mbuf has room
+     * for them, so that the option accessors can read them directly.  This
+     * never needs an allocation, so cannot fail.
+     */
+    hdr_len = min(cur_opt, OS_MBUF_PKTLEN(m));
+    if (m->om_len < hdr_len &&
+        m->om_len + OS_MBUF_TRAILINGSPACE(m) >= hdr_len) {
+        m = os_mbuf_pullup(m, hdr_len);
+        assert(m == pkt->m);
+    }
+
     return NO_ERROR;
+
+err_segs:
+    coap_error_message = "Too many Uri segments";
+    STATS_INC(coap_stats, ierr);
+    return BAD_OPTION_4_02;
 }
 
 #if 0
@@ -1099,9 +1155,8 @@ coap_get_header_uri_path(struct coap_packet_rx *pkt, char *path, int maxlen)
     if (!IS_OPTION(pkt, COAP_OPTION_URI_PATH)) {
         return 0;
     }
-    maxlen = min(maxlen, pkt->uri_path_len);
-    os_mbuf_copydata(pkt->m, pkt->uri_path_off, maxlen, path);
-    return maxlen;
+    return coap_get_multi_option(pkt->m, pkt->uri_path_seg, pkt->uri_path_nseg,
+                                 '/', path, maxlen);
 }
 #ifdef OC_CLIENT
 int
@@ -1124,9 +1179,8 @@ coap_get_header_uri_query(struct coap_packet_rx *pkt, char *query, int maxlen)
     if (!IS_OPTION(pkt, COAP_OPTION_URI_QUERY)) {
         return 0;
     }
-    maxlen = min(maxlen, pkt->uri_query_len);
-    os_mbuf_copydata(pkt->m, pkt->uri_query_off, maxlen, query);
-    return maxlen;
+    return coap_get_multi_option(pkt->m, pkt->uri_query_seg,
+                                 pkt->uri_query_nseg, '&', query, maxlen);
 }
 #ifdef OC_CLIENT
 int
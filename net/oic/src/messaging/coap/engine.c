@@ -41,6 +41,7 @@
 /* OIC Stack headers */
 #include "oic/oc_buffer.h"
 #include "oic/oc_ri.h"
+#include "oic/port/oc_random.h"
 #include "messaging/coap/engine.h"
 
 #ifdef OC_CLIENT
@@ -114,6 +115,25 @@ coap_receive(struct os_mbuf **mp)
 
         OC_LOG_DEBUG("  Payload: %d bytes\n", message->payload_len);
 
+#if MYNEWT_VAL(OC_MCAST_LEISURE)
+        if (endpoint.ep.oe_flags & OC_ENDPOINT_RX_MULTICAST) {
+            /*
+             * Drop a repeated multicast request which is still waiting
+             * for its delayed response.
+             */
+            transaction = coap_get_transaction_by_mid(message->mid);
+            if (transaction &&
+              !memcmp(OC_MBUF_ENDPOINT(transaction->m), &endpoint,
+                      oc_endpoint_size(&endpoint))) {
+                OC_LOG_DEBUG("  Duplicate multicast request\n");
+                transaction = NULL;
+                erbium_status_code = CLEAR_TRANSACTION;
+                goto out;
+            }
+            transaction = NULL;
+        }
+#endif
+
         /* use transaction buffer for response to confirmable request */
         transaction = coap_new_transaction(message->mid, OC_MBUF_ENDPOINT(m));
         if (!transaction) {
@@ -189,6 +209,8 @@ coap_receive(struct os_mbuf **mp)
                             /* a const char str[] and sizeof(str)
                                produces larger code size */
                         } else {
+                            /* Skip the blocks before the requested one. */
+                            os_mbuf_adj(response->payload_m, block_offset);
                             coap_set_header_block2(response, block_num,
                                          response->payload_len - block_offset >
                                            block_size, block_size);
@@ -247,6 +269,11 @@ coap_receive(struct os_mbuf **mp)
         /* Open transaction now cleared for ACK since mid matches */
         if ((transaction = coap_get_transaction_by_mid(message->mid))) {
             coap_clear_transaction(transaction);
+        } else if (message->code &&
+          (transaction = coap_get_transaction_by_token(message->token,
+                                                       message->token_len))) {
+            /* separate response; our request got through */
+            coap_clear_transaction(transaction);
         }
         /* if(ACKed transaction) */
         transaction = NULL;
@@ -265,6 +292,18 @@ out:
     /* if(parsed correctly) */
     if (erbium_status_code == NO_ERROR) {
         if (transaction) { // Server transactions sent from here
+#if MYNEWT_VAL(OC_MCAST_LEISURE)
+            /*
+             * Spread responses to multicast requests over the leisure
+             * period (RFC 7252, section 8.2).
+             */
+            if ((endpoint.ep.oe_flags & OC_ENDPOINT_RX_MULTICAST) &&
+              transaction->type == COAP_TYPE_NON) {
+                coap_send_transaction_delayed(transaction,
+                  (((uint32_t)oc_random_rand() << 16) | oc_random_rand()) %
+                  os_time_ms_to_ticks32(MYNEWT_VAL(OC_MCAST_LEISURE)));
+            } else
+#endif
             coap_send_transaction(transaction);
         }
     } else if (erbium_status_code == CLEAR_TRANSACTION) {
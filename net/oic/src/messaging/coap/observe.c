@@ -43,6 +43,7 @@
 #include "oic/messaging/coap/observe.h"
 #include "oic/messaging/coap/oc_coap.h"
 #include "oic/oc_rep.h"
+#include "oic/oc_api.h"
 #include "oic/oc_ri.h"
 
 /*-------------------*/
@@ -57,13 +58,50 @@ static uint8_t coap_observer_area[OS_MEMPOOL_BYTES(COAP_MAX_OBSERVERS,
 /*---------------------------------------------------------------------------*/
 /*- Internal API ------------------------------------------------------------*/
 /*---------------------------------------------------------------------------*/
+static void
+unlink_observer(coap_observer_t *o)
+{
+    OC_LOG_DEBUG("Removing observer for /%s [0x%02X%02X]\n",
+                 o->url, o->token[0], o->token[1]);
+    o->resource->num_observers--;
+    SLIST_REMOVE(&oc_observers, o, coap_observer, next);
+    SLIST_REMOVE(&o->resource->observers, o, coap_observer, res_next);
+    os_memblock_put(&coap_observer_pool, o);
+}
+
+static void
+observers_changed(oc_resource_t *resource)
+{
+    if (resource->observe_handler) {
+        resource->observe_handler(resource);
+    }
+}
+
+static int
+remove_observer_by_resource(oc_endpoint_t *endpoint, oc_resource_t *resource)
+{
+    int removed = 0;
+    coap_observer_t *obs, *next;
+
+    obs = SLIST_FIRST(&resource->observers);
+    while (obs) {
+        next = SLIST_NEXT(obs, res_next);
+        if (memcmp(&obs->endpoint, endpoint, oc_endpoint_size(endpoint)) == 0) {
+            unlink_observer(obs);
+            removed++;
+        }
+        obs = next;
+    }
+    return removed;
+}
+
 static int
 add_observer(oc_resource_t *resource, oc_endpoint_t *endpoint,
              const uint8_t *token, size_t token_len, const char *uri,
              int uri_len)
 {
     /* Remove existing observe relationship, if any. */
-    int dup = coap_remove_observer_by_uri(endpoint, uri);
+    int dup = remove_observer_by_resource(endpoint, resource);
 
     coap_observer_t *o = os_memblock_get(&coap_observer_pool);
 
@@ -85,8 +123,13 @@ add_observer(oc_resource_t *resource, oc_endpoint_t *endpoint,
           coap_observer_pool.mp_num_blocks - coap_observer_pool.mp_num_free,
           coap_observer_pool.mp_num_blocks, o->url, o->token[0], o->token[1]);
         SLIST_INSERT_HEAD(&oc_observers, o, next);
+        SLIST_INSERT_HEAD(&resource->observers, o, res_next);
+        observers_changed(resource);
         return dup;
     }
+    if (dup) {
+        observers_changed(resource);
+    }
     return -1;
 }
 /*---------------------------------------------------------------------------*/
@@ -95,10 +138,10 @@ add_observer(oc_resource_t *resource, oc_endpoint_t *endpoint,
 void
 coap_remove_observer(coap_observer_t *o)
 {
-    OC_LOG_DEBUG("Removing observer for /%s [0x%02X%02X]\n",
-                 o->url, o->token[0], o->token[1]);
-    SLIST_REMOVE(&oc_observers, o, coap_observer, next);
-    os_memblock_put(&coap_observer_pool, o);
+    oc_resource_t *resource = o->resource;
+
+    unlink_observer(o);
+    observers_changed(resource);
 }
 /*---------------------------------------------------------------------------*/
 int
@@ -111,7 +154,6 @@ coap_remove_observer_by_client(oc_endpoint_t *endpoint)
     while (obs) {
         next = SLIST_NEXT(obs, next);
         if (memcmp(&obs->endpoint, endpoint, oc_endpoint_size(endpoint)) == 0) {
-            obs->resource->num_observers--;
             coap_remove_observer(obs);
             removed++;
         }
@@ -133,7 +175,6 @@ coap_remove_observer_by_token(oc_endpoint_t *endpoint, uint8_t *token,
         if (memcmp(&obs->endpoint, endpoint, oc_endpoint_size(endpoint)) == 0 &&
           obs->token_len == token_len &&
           memcmp(obs->token, token, token_len) == 0) {
-            obs->resource->num_observers--;
             coap_remove_observer(obs);
             removed++;
             break;
@@ -155,7 +196,6 @@ coap_remove_observer_by_uri(oc_endpoint_t *endpoint, const char *uri)
         if (((memcmp(&obs->endpoint, endpoint,
                      oc_endpoint_size(endpoint)) == 0)) &&
           (obs->url == uri || memcmp(obs->url, uri, strlen(obs->url)) == 0)) {
-            obs->resource->num_observers--;
             coap_remove_observer(obs);
             removed++;
         }
@@ -175,7 +215,6 @@ coap_remove_observer_by_mid(oc_endpoint_t *endpoint, uint16_t mid)
         next = SLIST_NEXT(obs, next);
         if (memcmp(&obs->endpoint, endpoint, oc_endpoint_size(endpoint)) == 0 &&
           obs->last_mid == mid) {
-            obs->resource->num_observers--;
             coap_remove_observer(obs);
             removed++;
             break;
@@ -223,18 +262,29 @@ coap_notify_observers(oc_resource_t *resource,
     struct os_mbuf *m = NULL;
 
     if (resource) {
+#if MYNEWT_VAL(OC_RESPONSE_CACHE)
+        /* Notifications are sent because the resource changed. */
+        oc_resource_cache_invalidate(resource);
+#endif
         if (!resource->num_observers) {
             OC_LOG_DEBUG("coap_notify_observers: no observers left\n");
             return 0;
         }
+        if (!response_buf && !resource->get_handler) {
+            /* Resource only has a streaming Block2 handler. */
+            return 0;
+        }
         response_buffer.block_offset = NULL;
         response.response_buffer = &response_buffer;
         request.resource = resource;
         request.response = &response;
     }
 
-    /* iterate over observers */
-    for (obs = SLIST_FIRST(&oc_observers); obs; obs = SLIST_NEXT(obs, next)) {
+    /* iterate over observers; only those of the resource, if one is given */
+    for (obs = resource ? SLIST_FIRST(&resource->observers) :
+                          SLIST_FIRST(&oc_observers);
+         obs;
+         obs = resource ? SLIST_NEXT(obs, res_next) : SLIST_NEXT(obs, next)) {
         /* skip if neither resource nor endpoint match */
         if ((resource && resource != obs->resource) ||
             (endpoint && memcmp(&obs->endpoint, endpoint,
@@ -242,11 +292,15 @@ coap_notify_observers(oc_resource_t *resource,
             continue;
         }
 
-        response.separate_response = 0;
         num_observers = obs->resource->num_observers;
         if (!response_buf && resource) {
+            /*
+             * Perform a single GET on the resource for the whole round; its
+             * representation is shared by every notification sent below,
+             * which only differ in their CoAP header.
+             */
             OC_LOG_DEBUG("coap_notify_observers: GET request to resource\n");
-            /* performing GET on the resource */
+            response.separate_response = 0;
             m = os_msys_get_pkthdr(0, 0);
             if (!m) {
                 return num_observers;
@@ -303,6 +357,9 @@ coap_notify_observers(oc_resource_t *resource,
                                  "notification to check for client liveness\n");
                     notification->type = COAP_TYPE_CON;
                 }
+                /* Refers to the shared payload rather than copying it when
+                 * OS_MBUF_SHARED is enabled.
+                 */
                 coap_set_payload(notification, response_buf->buffer,
                                  OS_MBUF_PKTLEN(response_buf->buffer));
                 coap_set_status_code(notification, response_buf->code);
@@ -322,14 +379,6 @@ coap_notify_observers(oc_resource_t *resource,
                 } else {
                     coap_clear_transaction(transaction);
                 }
-                if (response_buf == &response_buffer) {
-                    /*
-                     * We allocated mbuf, and it's still valid.
-                     */
-                    os_mbuf_free_chain(m);
-                    m = NULL;
-                    response_buf = NULL;
-                }
             } else if (response_buf) {
                 /*
                  * Failed to alloc transaction.
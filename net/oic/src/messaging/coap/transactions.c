@@ -50,19 +50,192 @@
 #endif
 
 #include "port/mynewt/adaptor.h"
-
 static struct os_mempool oc_transaction_memb;
 static uint8_t oc_transaction_area[OS_MEMPOOL_BYTES(COAP_MAX_OPEN_TRANSACTIONS,
       sizeof(coap_transaction_t))];
-static SLIST_HEAD(, coap_transaction) oc_transaction_list;
 
-static void coap_transaction_retrans(struct os_event *ev);
+SLIST_HEAD(coap_transaction_list, coap_transaction);
+
+/*
+ * Open transactions, hashed by MID and by token of the request.
+ */
+static struct coap_transaction_list
+    oc_transaction_mid_hash[COAP_TRANSACTION_HASH_SIZE];
+static struct coap_transaction_list
+    oc_transaction_tok_hash[COAP_TRANSACTION_HASH_SIZE];
+
+/*
+ * Retransmission timer wheel.  Slot oc_wheel_pos covers the ticks up to
+ * and including oc_wheel_end, each following slot the next
+ * COAP_TRANSACTION_WHEEL_TICKS.  Timeouts longer than one rotation stay
+ * in their slot until the rotation in which they expire.  A single
+ * callout is armed for the first non-empty slot.
+ */
+static struct coap_transaction_list oc_wheel[COAP_TRANSACTION_WHEEL_SLOTS];
+static struct os_callout oc_wheel_timer;
+static os_time_t oc_wheel_end;
+static uint16_t oc_wheel_pos;
+static uint16_t oc_wheel_cnt;
+
+#define COAP_TRANSACTION_HASH_MASK  (COAP_TRANSACTION_HASH_SIZE - 1)
+#define COAP_TRANSACTION_WHEEL_MASK (COAP_TRANSACTION_WHEEL_SLOTS - 1)
+
+static void coap_transaction_wheel_run(struct os_event *ev);
 
 void
 coap_transaction_init(void)
 {
+    int i;
+
     os_mempool_init(&oc_transaction_memb, COAP_MAX_OPEN_TRANSACTIONS,
       sizeof(coap_transaction_t), oc_transaction_area, "coap_tran");
+    for (i = 0; i < COAP_TRANSACTION_HASH_SIZE; i++) {
+        SLIST_INIT(&oc_transaction_mid_hash[i]);
+        SLIST_INIT(&oc_transaction_tok_hash[i]);
+    }
+    for (i = 0; i < COAP_TRANSACTION_WHEEL_SLOTS; i++) {
+        SLIST_INIT(&oc_wheel[i]);
+    }
+    oc_wheel_cnt = 0;
+    os_callout_init(&oc_wheel_timer, oc_evq_get(),
+      coap_transaction_wheel_run, NULL);
+}
+
+static struct coap_transaction_list *
+coap_transaction_mid_bucket(uint16_t mid)
+{
+    return &oc_transaction_mid_hash[mid & COAP_TRANSACTION_HASH_MASK];
+}
+
+static struct coap_transaction_list *
+coap_transaction_tok_bucket(const uint8_t *token, uint8_t token_len)
+{
+    uint32_t h;
+    int i;
+
+    h = 0;
+    for (i = 0; i < token_len; i++) {
+        h = h * 31 + token[i];
+    }
+    return &oc_transaction_tok_hash[h & COAP_TRANSACTION_HASH_MASK];
+}
+
+/*
+ * Arms the wheel callout for the first slot that has something in it.
+ */
+static void
+coap_transaction_wheel_arm(void)
+{
+    os_time_t now;
+    os_time_t at;
+    int i;
+
+    for (i = 0; i < COAP_TRANSACTION_WHEEL_SLOTS; i++) {
+        if (!SLIST_EMPTY(&oc_wheel[(oc_wheel_pos + i) &
+                                   COAP_TRANSACTION_WHEEL_MASK])) {
+            break;
+        }
+    }
+    now = os_time_get();
+    at = oc_wheel_end + i * COAP_TRANSACTION_WHEEL_TICKS;
+    os_callout_reset(&oc_wheel_timer,
+      OS_TIME_TICK_GT(at, now) ? at - now : 0);
+}
+
+static void
+coap_transaction_wheel_add(coap_transaction_t *t, uint32_t tmo)
+{
+    os_stime_t delta;
+    uint32_t slot;
+    os_time_t now;
+
+    now = os_time_get();
+    if (oc_wheel_cnt == 0) {
+        oc_wheel_end = now + COAP_TRANSACTION_WHEEL_TICKS;
+    }
+    t->retrans_at = now + tmo;
+
+    delta = (os_stime_t)(t->retrans_at - oc_wheel_end);
+    slot = 0;
+    if (delta > 0) {
+        slot = (delta + COAP_TRANSACTION_WHEEL_TICKS - 1) /
+          COAP_TRANSACTION_WHEEL_TICKS;
+    }
+    t->retrans_slot = (oc_wheel_pos + slot) & COAP_TRANSACTION_WHEEL_MASK;
+    SLIST_INSERT_HEAD(&oc_wheel[t->retrans_slot], t, wheel_next);
+    t->retrans_armed = 1;
+    oc_wheel_cnt++;
+
+    coap_transaction_wheel_arm();
+}
+
+static void
+coap_transaction_wheel_remove(coap_transaction_t *t)
+{
+    if (!t->retrans_armed) {
+        return;
+    }
+    SLIST_REMOVE(&oc_wheel[t->retrans_slot], t, coap_transaction, wheel_next);
+    t->retrans_armed = 0;
+    if (--oc_wheel_cnt == 0) {
+        os_callout_stop(&oc_wheel_timer);
+    }
+}
+
+/*
+ * Retransmits the first transaction in the slot which is due, if any.
+ * Returns 1 if one was found; the slot may have changed underneath, so
+ * the caller restarts the scan.
+ */
+static int
+coap_transaction_wheel_fire(struct coap_transaction_list *slot, os_time_t now)
+{
+    coap_transaction_t *t;
+
+    SLIST_FOREACH(t, slot, wheel_next) {
+        if (OS_TIME_TICK_GEQ(now, t->retrans_at)) {
+            coap_transaction_wheel_remove(t);
+            ++(t->retrans_counter);
+            OC_LOG_DEBUG("Retransmitting %u (%u)\n", t->mid,
+                         t->retrans_counter);
+            coap_send_transaction(t);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void
+coap_transaction_wheel_run(struct os_event *ev)
+{
+    os_time_t now;
+    int i;
+
+    now = os_time_get();
+    for (i = 0; i < COAP_TRANSACTION_WHEEL_SLOTS; i++) {
+        if (oc_wheel_cnt == 0 || OS_TIME_TICK_LT(now, oc_wheel_end)) {
+            break;
+        }
+        while (coap_transaction_wheel_fire(&oc_wheel[oc_wheel_pos], now)) {
+        }
+        oc_wheel_pos = (oc_wheel_pos + 1) & COAP_TRANSACTION_WHEEL_MASK;
+        oc_wheel_end += COAP_TRANSACTION_WHEEL_TICKS;
+    }
+    if (oc_wheel_cnt == 0) {
+        return;
+    }
+    if (i == COAP_TRANSACTION_WHEEL_SLOTS) {
+        /*
+         * More than a rotation behind; every slot has been checked against
+         * now.  Resynchronise, what is left is at worst one rotation late.
+         */
+        for (i = 0; i < COAP_TRANSACTION_WHEEL_SLOTS; i++) {
+            while (coap_transaction_wheel_fire(&oc_wheel[i], now)) {
+            }
+        }
+        oc_wheel_end = now + COAP_TRANSACTION_WHEEL_TICKS;
+    }
+    coap_transaction_wheel_arm();
 }
 
 coap_transaction_t *
@@ -77,12 +250,11 @@ coap_new_transaction(uint16_t mid, oc_endpoint_t *endpoint)
         if (m) {
             t->mid = mid;
             t->retrans_counter = 0;
+            t->retrans_armed = 0;
+            t->token_len = 0;
             t->m = m;
 
-            os_callout_init(&t->retrans_timer, oc_evq_get(),
-              coap_transaction_retrans, t);
-            /* list itself makes sure same element is not added twice */
-            SLIST_INSERT_HEAD(&oc_transaction_list, t, next);
+            SLIST_INSERT_HEAD(coap_transaction_mid_bucket(mid), t, next);
         } else {
             os_memblock_put(&oc_transaction_memb, t);
             t = NULL;
@@ -92,6 +264,21 @@ coap_new_transaction(uint16_t mid, oc_endpoint_t *endpoint)
     return t;
 }
 
+void
+coap_transaction_set_token(coap_transaction_t *t, const uint8_t *token,
+                           uint8_t token_len)
+{
+    if (t->token_len) {
+        SLIST_REMOVE(coap_transaction_tok_bucket(t->token, t->token_len), t,
+                     coap_transaction, tok_next);
+    }
+    t->token_len = min(token_len, sizeof(t->token));
+    memcpy(t->token, token, t->token_len);
+    if (t->token_len) {
+        SLIST_INSERT_HEAD(coap_transaction_tok_bucket(t->token, t->token_len),
+                          t, tok_next);
+    }
+}
 /*---------------------------------------------------------------------------*/
 void
 coap_send_transaction(coap_transaction_t *t)
@@ -117,7 +304,8 @@ coap_send_transaction(coap_transaction_t *t)
                 OC_LOG_DEBUG("Doubled " OC_CLK_FMT "\n", t->retrans_tmo);
             }
 
-            os_callout_reset(&t->retrans_timer, t->retrans_tmo);
+            coap_transaction_wheel_remove(t);
+            coap_transaction_wheel_add(t, t->retrans_tmo);
 
             coap_send_message(t->m, 1);
 
@@ -150,24 +338,26 @@ coap_send_transaction(coap_transaction_t *t)
         coap_clear_transaction(t);
     }
 }
+
+void
+coap_send_transaction_delayed(coap_transaction_t *t, uint32_t ticks)
+{
+    coap_transaction_wheel_remove(t);
+    coap_transaction_wheel_add(t, ticks);
+}
 /*---------------------------------------------------------------------------*/
 void
 coap_clear_transaction(coap_transaction_t *t)
 {
-    struct coap_transaction *tmp;
-
     if (t) {
-        os_callout_stop(&t->retrans_timer);
+        coap_transaction_wheel_remove(t);
         os_mbuf_free_chain(t->m);
 
-        /*
-         * Transaction might not be in the list yet.
-         */
-        SLIST_FOREACH(tmp, &oc_transaction_list, next) {
-            if (t == tmp) {
-                SLIST_REMOVE(&oc_transaction_list, t, coap_transaction, next);
-                break;
-            }
+        SLIST_REMOVE(coap_transaction_mid_bucket(t->mid), t, coap_transaction,
+                     next);
+        if (t->token_len) {
+            SLIST_REMOVE(coap_transaction_tok_bucket(t->token, t->token_len),
+                         t, coap_transaction, tok_next);
         }
         os_memblock_put(&oc_transaction_memb, t);
   }
@@ -178,7 +368,7 @@ coap_get_transaction_by_mid(uint16_t mid)
 {
     coap_transaction_t *t;
 
-    SLIST_FOREACH(t, &oc_transaction_list, next) {
+    SLIST_FOREACH(t, coap_transaction_mid_bucket(mid), next) {
         if (t->mid == mid) {
             return t;
         }
@@ -186,12 +376,20 @@ coap_get_transaction_by_mid(uint16_t mid)
     return NULL;
 }
 
-static void
-coap_transaction_retrans(struct os_event *ev)
+coap_transaction_t *
+coap_get_transaction_by_token(const uint8_t *token, uint8_t token_len)
 {
-    coap_transaction_t *t = ev->ev_arg;
-    ++(t->retrans_counter);
-    OC_LOG_DEBUG("Retransmitting %u (%u)\n", t->mid, t->retrans_counter);
-    coap_send_transaction(t);
+    coap_transaction_t *t;
+
+    if (token_len == 0) {
+        return NULL;
+    }
+    SLIST_FOREACH(t, coap_transaction_tok_bucket(token, token_len), tok_next) {
+        if (t->token_len == token_len &&
+          !memcmp(t->token, token, token_len)) {
+            return t;
+        }
+    }
+    return NULL;
 }
 
@@ -31,6 +31,15 @@
 static struct os_eventq *oc_evq;
 const struct oc_transport *oc_transports[OC_TRANSPORT_MAX];
 
+#if MYNEWT_VAL(OC_TX_COALESCE_MAX_LEN)
+/*
+ * Frames being built for transports with TCP-style framing, where
+ * messages carry their own length and can be sent back to back. These
+ * are flushed when the outgoing queue has been drained.
+ */
+static struct os_mbuf *oc_tx_pend[MYNEWT_VAL(OC_TX_COALESCE_EPS)];
+#endif
+
 struct os_eventq *
 oc_evq_get(void)
 {
@@ -85,6 +94,85 @@ oc_transport_unregister(const struct oc_transport *ot)
     }
 }
 
+#if MYNEWT_VAL(OC_TX_COALESCE_MAX_LEN)
+static void
+oc_send_pend(int i)
+{
+    struct os_mbuf *m;
+
+    m = oc_tx_pend[i];
+    oc_tx_pend[i] = NULL;
+    oc_transports[OC_MBUF_ENDPOINT(m)->ep.oe_type]->ot_tx_ucast(m);
+}
+
+/*
+ * Appends the message to a frame being built for the same endpoint, or
+ * starts a new one. Returns 0 if the message was taken.
+ */
+static int
+oc_send_coalesce(struct os_mbuf *m)
+{
+    struct oc_endpoint *oe;
+    struct os_mbuf *p;
+    int ep_size;
+    int free_slot = -1;
+    int i;
+
+    oe = OC_MBUF_ENDPOINT(m);
+    ep_size = oc_endpoint_size(oe);
+    for (i = 0; i < MYNEWT_VAL(OC_TX_COALESCE_EPS); i++) {
+        p = oc_tx_pend[i];
+        if (!p) {
+            if (free_slot < 0) {
+                free_slot = i;
+            }
+            continue;
+        }
+        if (memcmp(OC_MBUF_ENDPOINT(p), oe, ep_size)) {
+            continue;
+        }
+        if (OS_MBUF_PKTLEN(p) + OS_MBUF_PKTLEN(m) >
+          MYNEWT_VAL(OC_TX_COALESCE_MAX_LEN)) {
+            oc_send_pend(i);
+            free_slot = i;
+            break;
+        }
+        os_mbuf_concat(p, m);
+        return 0;
+    }
+    if (OS_MBUF_PKTLEN(m) >= MYNEWT_VAL(OC_TX_COALESCE_MAX_LEN)) {
+        return -1;
+    }
+    if (free_slot < 0) {
+        /*
+         * All slots are building frames for other endpoints. Send the
+         * oldest one.
+         */
+        free_slot = 0;
+        oc_send_pend(0);
+    }
+    oc_tx_pend[free_slot] = m;
+    return 0;
+}
+#endif
+
+/*
+ * Sends out the frames built from coalesced messages.
+ */
+void
+oc_send_flush(void)
+{
+#if MYNEWT_VAL(OC_TX_COALESCE_MAX_LEN)
+    int i;
+
+    for (i = 0; i < MYNEWT_VAL(OC_TX_COALESCE_EPS); i++) {
+        if (oc_tx_pend[i]) {
+            oc_send_pend(i);
+        }
+    }
+#endif
+}
+
 void
 oc_send_buffer(struct os_mbuf *m)
 {
@@ -95,6 +183,11 @@ oc_send_buffer(struct os_mbuf *m)
 
     ot = oc_transports[oe->ep.oe_type];
     if (ot) {
+#if MYNEWT_VAL(OC_TX_COALESCE_MAX_LEN)
+        if ((ot->ot_flags & OC_TRANSPORT_USE_TCP) && !oc_send_coalesce(m)) {
+            return;
+        }
+#endif
         ot->ot_tx_ucast(m);
     } else {
         OC_LOG_ERROR("Unknown transport option %u\n", oe->ep.oe_type);
@@ -160,6 +253,7 @@ oc_connectivity_shutdown(void)
     int i;
     const struct oc_transport *ot;
 
+    oc_send_flush();
     for (i = 0; i < OC_TRANSPORT_MAX; i++) {
         if (!oc_transports[i]) {
             continue;
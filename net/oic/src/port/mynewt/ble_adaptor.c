@@ -222,6 +222,41 @@ oc_log_ep_gatt(char *ptr, int maxlen, const struct oc_endpoint *oe)
     return ptr;
 }
 
+int oc_ble_reass(struct os_mbuf *om1, uint16_t conn_handle, uint8_t srv_idx);
+
+/*
+ * Passes a reassembled message up. Data past its end is the start of the
+ * next message, sent back to back with it; that goes through reassembly
+ * again.
+ */
+static void
+oc_ble_rx_frame(struct os_mbuf *om, uint16_t msg_len, uint16_t conn_handle,
+                uint8_t srv_idx)
+{
+    struct os_mbuf *rest = NULL;
+    int rest_len;
+
+    rest_len = OS_MBUF_PKTLEN(om) - msg_len;
+    if (rest_len > 0) {
+        rest = os_msys_get_pkthdr(0, 0);
+        if (!rest || os_mbuf_appendfrom(rest, om, msg_len, rest_len)) {
+            OC_LOG_ERROR("oc_gatt_rx: Could not allocate mbuf\n");
+            STATS_INC(oc_ble_stats, ierr);
+            if (rest) {
+                os_mbuf_free_chain(rest);
+                rest = NULL;
+            }
+        }
+        os_mbuf_adj(om, -rest_len);
+    }
+    STATS_INC(oc_ble_stats, iframe);
+    oc_recv_message(om);
+    if (rest) {
+        STATS_INC(oc_ble_stats, iseg);
+        oc_ble_reass(rest, conn_handle, srv_idx);
+    }
+}
+
 int
 oc_ble_reass(struct os_mbuf *om1, uint16_t conn_handle, uint8_t srv_idx)
 {
@@ -230,6 +265,7 @@ oc_ble_reass(struct os_mbuf *om1, uint16_t conn_handle, uint8_t srv_idx)
     struct os_mbuf *om2;
     struct os_mbuf_pkthdr *pkt2;
     uint8_t hdr[6]; /* sizeof(coap_tcp_hdr32) */
+    uint16_t msg_len;
 
     pkt1 = OS_MBUF_PKTHDR(om1);
     assert(pkt1);
@@ -248,12 +284,13 @@ oc_ble_reass(struct os_mbuf *om1, uint16_t conn_handle, uint8_t srv_idx)
              * Data from same connection. Append.
              */
             os_mbuf_concat(om2, om1);
+            memset(hdr, 0, sizeof(hdr));
             os_mbuf_copydata(om2, 0, sizeof(hdr), hdr);
 
-            if (coap_tcp_msg_size(hdr, sizeof(hdr)) <= pkt2->omp_len) {
+            msg_len = coap_tcp_msg_size(hdr, sizeof(hdr));
+            if (msg_len <= pkt2->omp_len) {
                 STAILQ_REMOVE(&oc_ble_reass_q, pkt2, os_mbuf_pkthdr, omp_next);
-                STATS_INC(oc_ble_stats, iframe);
-                oc_recv_message(om2);
+                oc_ble_rx_frame(om2, msg_len, conn_handle, srv_idx);
             }
             pkt1 = NULL;
             break;
@@ -284,12 +321,13 @@ oc_ble_reass(struct os_mbuf *om1, uint16_t conn_handle, uint8_t srv_idx)
         oe_ble->conn_handle = conn_handle;
         pkt2 = OS_MBUF_PKTHDR(om2);
 
+        memset(hdr, 0, sizeof(hdr));
         os_mbuf_copydata(om2, 0, sizeof(hdr), hdr);
-        if (coap_tcp_msg_size(hdr, sizeof(hdr)) > pkt2->omp_len) {
+        msg_len = coap_tcp_msg_size(hdr, sizeof(hdr));
+        if (msg_len > pkt2->omp_len) {
             STAILQ_INSERT_TAIL(&oc_ble_reass_q, pkt2, omp_next);
         } else {
-            STATS_INC(oc_ble_stats, iframe);
-            oc_recv_message(om2);
+            oc_ble_rx_frame(om2, msg_len, conn_handle, srv_idx);
         }
     }
     return 0;
@@ -240,6 +240,11 @@ oc_attempt_rx_ip4_sock(struct mn_socket *rxsock)
 
     oe_ip->ep.oe_type = oc_ip4_transport_id;
     oe_ip->ep.oe_flags = 0;
+#if (MYNEWT_VAL(OC_SERVER) == 1)
+    if (rxsock == oc_mcast4) {
+        oe_ip->ep.oe_flags |= OC_ENDPOINT_RX_MULTICAST;
+    }
+#endif
     memcpy(&oe_ip->v4.address, &from.msin_addr, sizeof(oe_ip->v4.address));
     oe_ip->port = ntohs(from.msin_port);
 
@@ -238,6 +238,11 @@ oc_attempt_rx_ip6_sock(struct mn_socket *rxsock)
 
     oe_ip->ep.oe_type = oc_ip6_transport_id;
     oe_ip->ep.oe_flags = 0;
+#if (MYNEWT_VAL(OC_SERVER) == 1)
+    if (rxsock == oc_mcast6) {
+        oe_ip->ep.oe_flags |= OC_ENDPOINT_RX_MULTICAST;
+    }
+#endif
     memcpy(&oe_ip->v6.address, &from.msin6_addr, sizeof(oe_ip->v6.address));
     oe_ip->v6.scope = from.msin6_scope_id;
     oe_ip->port = ntohs(from.msin6_port);
@@ -17,9 +17,254 @@
  * under the License.
  */
 
-
 #include <stddef.h>
 #include <stdint.h>
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(OC_STORAGE_FCB2)
+
+#include <string.h>
+#include "flash_map/flash_map.h"
+#include "fcb/fcb2.h"
+
+/*
+ * The stores ("/acl", "/cred", "/doxm", "/pstat") are kept in an FCB2 as
+ * a log of records, the newest record for a store being its contents:
+ *
+ *     [ name length (1) | name | data ]
+ *
+ * A write appends one record, and none if the data has not changed; a
+ * read finds the newest record walking back from the end of the log.
+ * When the FCB fills up, the records still current in the oldest sector
+ * are copied forward and the sector is erased.
+ */
+
+#define OC_STORAGE_VERS         1
+#define OC_STORAGE_NAME_MAX     15
+
+static struct fcb2 oc_storage_fcb;
+static bool oc_storage_ready;
+
+static int
+oc_storage_init(void)
+{
+    int rc;
+
+    if (oc_storage_ready) {
+        return 0;
+    }
+
+    oc_storage_fcb.f_scratch_cnt = 1;
+    rc = fcb2_init_flash_area(&oc_storage_fcb,
+                              MYNEWT_VAL(OC_STORAGE_FLASH_AREA),
+                              MYNEWT_VAL(OC_STORAGE_MAGIC), OC_STORAGE_VERS);
+    if (rc) {
+        return -1;
+    }
+
+    /*
+     * A reset in the middle of emptying the oldest sector leaves no
+     * scratch sector; the copies in the active one are incomplete.
+     */
+    if (oc_storage_fcb.f_scratch_cnt &&
+        fcb2_free_sector_cnt(&oc_storage_fcb) < 1) {
+        fcb2_sector_erase(&oc_storage_fcb,
+                          oc_storage_fcb.f_active.fe_sector);
+        rc = fcb2_init(&oc_storage_fcb);
+        if (rc) {
+            return -1;
+        }
+    }
+
+    oc_storage_ready = true;
+    return 0;
+}
+
+/* Whether the record at loc belongs to the named store. */
+static bool
+oc_storage_match(struct fcb2_entry *loc, const char *store, int name_len)
+{
+    uint8_t hdr[1 + OC_STORAGE_NAME_MAX];
+
+    if (loc->fe_data_len < 1 + name_len) {
+        return false;
+    }
+    if (fcb2_read(loc, 0, hdr, 1 + name_len)) {
+        return false;
+    }
+    return hdr[0] == name_len && !memcmp(hdr + 1, store, name_len);
+}
+
+static int
+oc_storage_find(const char *store, int name_len, struct fcb2_entry *loc)
+{
+    memset(loc, 0, sizeof(*loc));
+    while (fcb2_getprev(&oc_storage_fcb, loc) == 0) {
+        if (oc_storage_match(loc, store, name_len)) {
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static bool
+oc_storage_same(struct fcb2_entry *loc, uint16_t off, const uint8_t *buf,
+                size_t size)
+{
+    uint8_t tmp[32];
+    size_t chunk;
+
+    if (loc->fe_data_len != off + size) {
+        return false;
+    }
+    while (size > 0) {
+        chunk = min(size, sizeof(tmp));
+        if (fcb2_read(loc, off, tmp, chunk) || memcmp(tmp, buf, chunk)) {
+            return false;
+        }
+        off += chunk;
+        buf += chunk;
+        size -= chunk;
+    }
+    return true;
+}
+
+static int
+oc_storage_copy(struct fcb2_entry *from)
+{
+    struct fcb2_entry to;
+    uint8_t tmp[32];
+    uint16_t off;
+    uint16_t chunk;
+    int rc;
+
+    rc = fcb2_append(&oc_storage_fcb, from->fe_data_len, &to);
+    if (rc) {
+        return rc;
+    }
+    for (off = 0; off < from->fe_data_len; off += chunk) {
+        chunk = min(from->fe_data_len - off, sizeof(tmp));
+        rc = fcb2_read(from, off, tmp, chunk);
+        if (rc == 0) {
+            rc = fcb2_write(&to, off, tmp, chunk);
+        }
+        if (rc) {
+            return rc;
+        }
+    }
+    return fcb2_append_finish(&to);
+}
+
+/*
+ * Copies the records of the oldest sector that have not been superseded
+ * to the scratch sector, and erases the oldest.
+ */
+static void
+oc_storage_compress(void)
+{
+    struct fcb2_entry loc;
+    struct fcb2_entry newest;
+    uint8_t hdr[1 + OC_STORAGE_NAME_MAX];
+    int name_len;
+
+    if (fcb2_append_to_scratch(&oc_storage_fcb)) {
+        return;
+    }
+
+    memset(&loc, 0, sizeof(loc));
+    while (fcb2_getnext(&oc_storage_fcb, &loc) == 0) {
+        if (loc.fe_sector != oc_storage_fcb.f_oldest_sec) {
+            break;
+        }
+        if (loc.fe_data_len < 1 || fcb2_read(&loc, 0, hdr, 1)) {
+            continue;
+        }
+        name_len = hdr[0];
+        if (name_len > OC_STORAGE_NAME_MAX ||
+            fcb2_read(&loc, 1, hdr + 1, name_len)) {
+            continue;
+        }
+        if (oc_storage_find((char *)hdr + 1, name_len, &newest) ||
+            newest.fe_sector != loc.fe_sector ||
+            newest.fe_entry_num != loc.fe_entry_num) {
+            continue;
+        }
+        oc_storage_copy(&loc);
+    }
+    fcb2_rotate(&oc_storage_fcb);
+}
+
+int
+oc_storage_config(const char *store)
+{
+    return oc_storage_init();
+}
+
+long
+oc_storage_read(const char *store, uint8_t *buf, size_t size)
+{
+    struct fcb2_entry loc;
+    int name_len;
+    size_t len;
+
+    name_len = strlen(store);
+    if (name_len > OC_STORAGE_NAME_MAX || oc_storage_init()) {
+        return -1;
+    }
+    if (oc_storage_find(store, name_len, &loc)) {
+        return -1;
+    }
+
+    /* A truncated encoding would not parse; refuse rather than cut. */
+    len = loc.fe_data_len - 1 - name_len;
+    if (len > size || fcb2_read(&loc, 1 + name_len, buf, len)) {
+        return -1;
+    }
+    return len;
+}
+
+long
+oc_storage_write(const char *store, uint8_t *buf, size_t size)
+{
+    struct fcb2_entry loc;
+    uint8_t hdr[1 + OC_STORAGE_NAME_MAX];
+    int name_len;
+    int rc;
+    int i;
+
+    name_len = strlen(store);
+    if (name_len > OC_STORAGE_NAME_MAX ||
+        1 + name_len + size >= FCB2_MAX_LEN || oc_storage_init()) {
+        return -1;
+    }
+
+    if (oc_storage_find(store, name_len, &loc) == 0 &&
+        oc_storage_same(&loc, 1 + name_len, buf, size)) {
+        return size;
+    }
+
+    for (i = 0; i < oc_storage_fcb.f_sector_cnt; i++) {
+        rc = fcb2_append(&oc_storage_fcb, 1 + name_len + size, &loc);
+        if (rc != FCB2_ERR_NOSPACE || oc_storage_fcb.f_scratch_cnt == 0) {
+            break;
+        }
+        oc_storage_compress();
+    }
+    if (rc) {
+        return -1;
+    }
+
+    hdr[0] = name_len;
+    memcpy(hdr + 1, store, name_len);
+    if (fcb2_write(&loc, 0, hdr, 1 + name_len) ||
+        fcb2_write(&loc, 1 + name_len, buf, size) ||
+        fcb2_append_finish(&loc) || fcb2_flush(&oc_storage_fcb)) {
+        return -1;
+    }
+    return size;
+}
+
+#else
 
 /* we will not really use storage until after we get security working */
 int oc_storage_config(const char *store) {
@@ -36,3 +281,5 @@ long oc_storage_write(const char *store, uint8_t *buf, size_t size)
 {
     return -1;
 }
+
+#endif
@@ -33,6 +33,38 @@ static oc_uuid_t WILDCARD = {.id = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
                                      0, 0 } };
 static oc_sec_acl_t ac_list = { 0 };
 
+#if (OC_ACL_HASH_SIZE & (OC_ACL_HASH_SIZE - 1)) != 0
+#error "OC_ACL_HASH_SIZE must be a power of two"
+#endif
+
+/* ACEs indexed by a hash of their subject UUID. */
+static oc_sec_ace_t *ace_hash[OC_ACL_HASH_SIZE];
+
+/* Bumped on every ACL change, invalidating all decision caches. */
+static uint32_t acl_generation = 1;
+
+static oc_sec_ace_t **
+oc_sec_ace_bucket(const oc_uuid_t *uuid)
+{
+    uint32_t hash = 2166136261u;
+    int i;
+
+    for (i = 0; i < 16; i++) {
+        hash ^= (uint8_t)uuid->id[i];
+        hash *= 16777619u;
+    }
+    return &ace_hash[hash & (OC_ACL_HASH_SIZE - 1)];
+}
+
+static void
+oc_sec_acl_changed(void)
+{
+    /* 0 is left for caches that were never filled. */
+    if (++acl_generation == 0) {
+        acl_generation = 1;
+    }
+}
+
 static void
 get_sub_perm_groups(oc_sec_ace_t *ace, uint16_t *groups, int *n)
 {
@@ -117,7 +149,8 @@ oc_sec_encode_acl(void)
 static oc_sec_acl_res_t *
 oc_sec_acl_get_ace(oc_uuid_t *subjectuuid, oc_resource_t *resource, bool create)
 {
-    oc_sec_ace_t *ace = (oc_sec_ace_t *)oc_list_head(ac_list.subjects);
+    oc_sec_ace_t **bucket = oc_sec_ace_bucket(subjectuuid);
+    oc_sec_ace_t *ace = *bucket;
     oc_sec_acl_res_t *res = NULL;
 #ifdef DEBUG
     char uuid[37];
@@ -129,7 +162,7 @@ oc_sec_acl_get_ace(oc_uuid_t *subjectuuid, oc_resource_t *resource, bool create)
         if (strncmp(ace->subjectuuid.id, subjectuuid->id, 16) == 0) {
             goto got_ace;
         }
-        ace = oc_list_item_next(ace);
+        ace = ace->hash_next;
     }
 
     if (create) {
@@ -170,6 +203,8 @@ new_ace:
     OC_LIST_STRUCT_INIT(ace, resources);
     strncpy(ace->subjectuuid.id, subjectuuid->id, 16);
     oc_list_add(ac_list.subjects, ace);
+    ace->hash_next = *bucket;
+    *bucket = ace;
 
 new_res:
     res = oc_memb_alloc(&res_l);
@@ -194,6 +229,7 @@ oc_sec_update_acl(oc_uuid_t *subjectuuid, oc_resource_t *resource,
     }
 
     res->permissions = permissions;
+    oc_sec_acl_changed();
 
     LOG("Added resource with permissions: %d\n", res->permissions);
 
@@ -204,6 +240,8 @@ void
 oc_sec_acl_init(void)
 {
     OC_LIST_STRUCT_INIT(&ac_list, subjects);
+    memset(ace_hash, 0, sizeof(ace_hash));
+    oc_sec_acl_changed();
 }
 
 void
@@ -227,13 +265,19 @@ oc_sec_acl_default(void)
     memcpy(&ac_list.rowneruuid, device, sizeof(oc_uuid_t));
 }
 
-bool
-oc_sec_check_acl(oc_method_t method, oc_resource_t *resource,
-                 oc_endpoint_t *endpoint)
+void
+oc_sec_acl_cache_init(oc_sec_acl_cache_t *cache)
+{
+    cache->generation = 0;
+    cache->next = 0;
+}
+
+static bool
+oc_sec_acl_decide(oc_method_t method, oc_resource_t *resource,
+                  oc_uuid_t *identity)
 {
     bool granted = false;
     oc_sec_acl_res_t *res = NULL;
-    oc_uuid_t *identity = (oc_uuid_t *)oc_sec_dtls_get_peer_uuid(endpoint);
 
     if (identity) {
         res = oc_sec_acl_get_ace(identity, resource, false);
@@ -284,6 +328,47 @@ oc_sec_check_acl(oc_method_t method, oc_resource_t *resource,
     return granted;
 }
 
+bool
+oc_sec_check_acl(oc_method_t method, oc_resource_t *resource,
+                 oc_endpoint_t *endpoint)
+{
+    oc_sec_dtls_peer_t *peer = oc_sec_dtls_get_peer(endpoint);
+    oc_sec_acl_cache_t *cache;
+    bool granted;
+    int i;
+
+    if (!peer) {
+        return oc_sec_acl_decide(method, resource, NULL);
+    }
+
+    cache = &peer->acl_cache;
+    if (cache->generation != acl_generation) {
+        cache->generation = acl_generation;
+        cache->next = 0;
+        for (i = 0; i < OC_ACL_CACHE_SIZE; i++) {
+            cache->entries[i].resource = NULL;
+        }
+    }
+
+    for (i = 0; i < OC_ACL_CACHE_SIZE; i++) {
+        if (cache->entries[i].resource == resource &&
+            cache->entries[i].method == method) {
+            return cache->entries[i].granted;
+        }
+    }
+
+    granted = oc_sec_acl_decide(method, resource, &peer->uuid);
+
+    /* Replace entries round robin. */
+    i = cache->next;
+    cache->entries[i].resource = resource;
+    cache->entries[i].method = method;
+    cache->entries[i].granted = granted;
+    cache->next = (i + 1) % OC_ACL_CACHE_SIZE;
+
+    return granted;
+}
+
 bool
 oc_sec_decode_acl(oc_rep_t *rep)
 {
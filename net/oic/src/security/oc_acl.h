@@ -27,6 +27,14 @@
 extern "C" {
 #endif
 
+#ifndef OC_ACL_HASH_SIZE
+#define OC_ACL_HASH_SIZE (4)
+#endif
+
+#ifndef OC_ACL_CACHE_SIZE
+#define OC_ACL_CACHE_SIZE (4)
+#endif
+
 typedef enum oc_sec_acl_permissions_mask {
     OC_PERM_CREATE = (1 << 0),
     OC_PERM_RETRIEVE = (1 << 1),
@@ -48,10 +56,25 @@ typedef struct oc_sec_acl_res {
 
 typedef struct oc_sec_ace {
     struct oc_sec_ace_s *next;
+    struct oc_sec_ace *hash_next;
     OC_LIST_STRUCT(resources);
     oc_uuid_t subjectuuid;
 } oc_sec_ace_t;
 
+/*
+ * Recent access decisions for one DTLS peer.  Entries are valid only while
+ * generation matches that of the ACL, which changes with every update.
+ */
+typedef struct oc_sec_acl_cache {
+    uint32_t generation;
+    uint8_t next;
+    struct {
+        oc_resource_t *resource;
+        uint8_t method;
+        bool granted;
+    } entries[OC_ACL_CACHE_SIZE];
+} oc_sec_acl_cache_t;
+
 void oc_sec_acl_default(void);
 void oc_sec_encode_acl(void);
 bool oc_sec_decode_acl(oc_rep_t *rep);
@@ -59,6 +82,7 @@ void oc_sec_acl_init(void);
 void post_acl(oc_request_t *request, oc_interface_mask_t interface);
 bool oc_sec_check_acl(oc_method_t method, oc_resource_t *resource,
                       oc_endpoint_t *endpoint);
+void oc_sec_acl_cache_init(oc_sec_acl_cache_t *cache);
 
 #ifdef __cplusplus
 }
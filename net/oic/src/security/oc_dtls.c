@@ -26,6 +26,14 @@
 #include "oc_pstat.h"
 #include "oc_svr.h"
 
+/*
+ * XXX This is the upstream glue to tinydtls, which is not part of this
+ * tree; the Mynewt port does not define OC_SECURITY, so none of this is
+ * built.  Session resumption and the RFC 9146 connection ID both need
+ * support in the DTLS record/handshake layer itself, and should be added
+ * together with the DTLS library port rather than here.  Peers are keyed
+ * by endpoint address, so a NAT rebinding shows up as a new peer.
+ */
 OC_PROCESS(oc_dtls_handler, "DTLS Process");
 OC_MEMB(dtls_peers_s, oc_sec_dtls_peer_t, MAX_DTLS_PEERS);
 OC_LIST(dtls_peers);
@@ -98,6 +106,7 @@ oc_sec_dtls_add_peer(oc_endpoint_t *endpoint)
             peer->session.size = sizeof(oc_endpoint_t);
             OC_LIST_STRUCT_INIT(peer, send_queue);
             peer->connected = false;
+            oc_sec_acl_cache_init(&peer->acl_cache);
             oc_list_add(dtls_peers, peer);
 
             oc_ri_add_timed_event_callback_seconds(&peer->session.addr,
@@ -233,6 +242,7 @@ oc_sec_dtls_get_owner_psk(struct dtls_context_t *ctx, const session_t *session,
           oc_sec_dtls_get_peer((oc_endpoint_t *)&session->addr);
         if (cred != NULL && peer != NULL) {
             memcpy(&peer->uuid, (oc_uuid_t *)desc, 16);
+            oc_sec_acl_cache_init(&peer->acl_cache);
             memcpy(result, cred->key, 16);
             return 16;
         }
@@ -18,6 +18,7 @@
 #define OC_DTLS_H_
 
 #include "deps/tinydtls/dtls.h"
+#include "oc_acl.h"
 #include "oc_uuid.h"
 #include "port/oc_connectivity.h"
 #include "util/oc_process.h"
@@ -48,8 +49,11 @@ typedef struct oc_sec_dtls_peer {
     oc_uuid_t uuid;
     bool connected;
     oc_clock_time_t timestamp;
+    oc_sec_acl_cache_t acl_cache;
 } oc_sec_dtls_peer_t;
 
+oc_sec_dtls_peer_t *oc_sec_dtls_get_peer(oc_endpoint_t *endpoint);
+
 #ifdef __cplusplus
 }
 #endif
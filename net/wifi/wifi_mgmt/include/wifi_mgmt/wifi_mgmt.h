@@ -43,6 +43,7 @@ struct wifi_ap {
     int8_t wa_rssi;
     uint8_t wa_key_type;
     uint8_t wa_channel;
+    os_time_t wa_seen;          /* set by wifi_mgmt; when last scanned */
 };
 
 struct wifi_if_ops;
@@ -65,7 +66,10 @@ struct wifi_if {
     const struct wifi_if_ops *wi_ops;
 
     uint8_t wi_scan_cnt;
+    uint8_t wi_scan_chan;       /* channel of targeted scan, 0 if full */
+    uint8_t wi_reconnect:1;
     struct wifi_ap wi_scan[WIFI_SCAN_CNT_MAX];
+    struct wifi_ap wi_last;     /* AP of the last connection attempt */
     char wi_ssid[WIFI_SSID_MAX + 1];
     char wi_key[WIFI_KEY_MAX + 1];
     uint8_t wi_myip[4];
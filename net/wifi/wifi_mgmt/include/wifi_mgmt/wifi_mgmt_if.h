@@ -34,6 +34,11 @@ struct wifi_if_ops {
     int (*wio_scan_start)(struct wifi_if *);
     int (*wio_connect)(struct wifi_if *, struct wifi_ap *);
     void (*wio_disconnect)(struct wifi_if *);
+    /*
+     * Optional. Scans one channel only; results and completion are
+     * reported as with wio_scan_start.
+     */
+    int (*wio_scan_chan)(struct wifi_if *, uint8_t channel);
 };
 
 /*
@@ -35,6 +35,7 @@ static struct os_task wifi_os_task;
 struct os_eventq wifi_evq;
 
 static struct wifi_ap *wifi_find_ap(struct wifi_if *wi, char *ssid);
+static void wifi_cache_expire(struct wifi_if *wi);
 static void wifi_events(struct os_event *);
 
 static void wifi_event_state(struct os_event *ev);
@@ -82,19 +83,90 @@ wifi_tgt_state(struct wifi_if *wi, int state)
     os_eventq_put(&wifi_evq, &wi->wi_event);
 }
 
+static struct wifi_ap *
+wifi_cache_lookup(struct wifi_if *wi, const char *bssid)
+{
+    int i;
+
+    for (i = 0; i < wi->wi_scan_cnt; i++) {
+        if (!memcmp(wi->wi_scan[i].wa_bssid, bssid, WIFI_BSSID_LEN)) {
+            return &wi->wi_scan[i];
+        }
+    }
+    return NULL;
+}
+
+static void
+wifi_cache_remove(struct wifi_if *wi, struct wifi_ap *ap)
+{
+    int i;
+
+    i = ap - wi->wi_scan;
+    wi->wi_scan_cnt--;
+    memmove(ap, ap + 1, (wi->wi_scan_cnt - i) * sizeof(*ap));
+}
+
+/*
+ * Drops scan results older than WIFI_MGMT_SCAN_CACHE_AGE.
+ */
+static void
+wifi_cache_expire(struct wifi_if *wi)
+{
+    os_time_t now;
+    uint32_t age;
+    int i;
+
+    if (MYNEWT_VAL(WIFI_MGMT_SCAN_CACHE_AGE) == 0 ||
+      os_time_ms_to_ticks(MYNEWT_VAL(WIFI_MGMT_SCAN_CACHE_AGE), &age)) {
+        return;
+    }
+    now = os_time_get();
+    for (i = 0; i < wi->wi_scan_cnt; ) {
+        if (now - wi->wi_scan[i].wa_seen > age) {
+            wifi_cache_remove(wi, &wi->wi_scan[i]);
+        } else {
+            i++;
+        }
+    }
+}
+
 /*
  * Wi-fi driver reports a response to wifi scan request.
- * Driver reports networks one at a time.
+ * Driver reports networks one at a time. A result replaces the cached
+ * entry with the same BSSID; if the cache is full, the oldest entry goes.
  */
 void
 wifi_scan_result(struct wifi_if *wi, struct wifi_ap *ap)
 {
-    if (wi->wi_scan_cnt == WIFI_SCAN_CNT_MAX) {
-        return;
+    struct wifi_ap *wa;
+    int i;
+
+    wa = wifi_cache_lookup(wi, ap->wa_bssid);
+    if (!wa) {
+        if (wi->wi_scan_cnt < WIFI_SCAN_CNT_MAX) {
+            wa = &wi->wi_scan[wi->wi_scan_cnt++];
+        } else {
+            wa = &wi->wi_scan[0];
+            for (i = 1; i < wi->wi_scan_cnt; i++) {
+                if (OS_TIME_TICK_LT(wi->wi_scan[i].wa_seen, wa->wa_seen)) {
+                    wa = &wi->wi_scan[i];
+                }
+            }
+        }
     }
-    wi->wi_scan[wi->wi_scan_cnt++] = *ap;
+    *wa = *ap;
+    wa->wa_seen = os_time_get();
 }
 
+#if MYNEWT_VAL(WIFI_MGMT_BG_SCAN_INTERVAL)
+static void
+wifi_bg_scan_arm(struct wifi_if *wi)
+{
+    os_callout_reset(&wi->wi_timer,
+      os_time_ms_to_ticks32(MYNEWT_VAL(WIFI_MGMT_BG_SCAN_INTERVAL)));
+}
+#endif
+
 /*
  * Wifi driver reports that scan is finished.
  */
@@ -104,6 +176,17 @@ wifi_scan_done(struct wifi_if *wi, int status)
     struct wifi_ap *ap = NULL;
 
     console_printf("scan_results %d: %d\n", wi->wi_scan_cnt, status);
+    if (wi->wi_state != SCANNING) {
+        /*
+         * Background scan while connected; only refreshes the cache.
+         */
+#if MYNEWT_VAL(WIFI_MGMT_BG_SCAN_INTERVAL)
+        if (wi->wi_state == CONNECTED) {
+            wifi_bg_scan_arm(wi);
+        }
+#endif
+        return;
+    }
     if (status) {
         wifi_tgt_state(wi, STOPPED);
         return;
@@ -115,7 +198,11 @@ wifi_scan_done(struct wifi_if *wi, int status)
     if (!WIFI_SSID_EMPTY(wi->wi_ssid)) {
         ap = wifi_find_ap(wi, wi->wi_ssid);
     }
-    if (ap) {
+    if (ap || wi->wi_scan_chan) {
+        /*
+         * If a single channel scan did not find the AP, CONNECTING
+         * falls back to a full scan.
+         */
         wifi_tgt_state(wi, CONNECTING);
     } else {
         wifi_tgt_state(wi, INIT);
@@ -129,8 +216,17 @@ wifi_scan_done(struct wifi_if *wi, int status)
 void
 wifi_connect_done(struct wifi_if *wi, int status)
 {
+    struct wifi_ap *ap;
+
     console_printf("connect_done : %d\n", status);
     if (status) {
+        /*
+         * Don't try this AP again without seeing it in a new scan.
+         */
+        ap = wifi_cache_lookup(wi, wi->wi_last.wa_bssid);
+        if (ap) {
+            wifi_cache_remove(wi, ap);
+        }
         wifi_tgt_state(wi, INIT);
         return;
     }
@@ -155,28 +251,52 @@ void
 wifi_disconnected(struct wifi_if *wi, int status)
 {
     console_printf("disconnect : %d\n", status);
+#if MYNEWT_VAL(WIFI_MGMT_RECONNECT)
+    if (wi->wi_state == DHCP_WAIT || wi->wi_state == CONNECTED) {
+        wi->wi_reconnect = 1;
+    }
+#endif
     wifi_tgt_state(wi, INIT);
 }
 
+/*
+ * Returns the strongest AP with this SSID among the current scan results.
+ */
 static struct wifi_ap *
 wifi_find_ap(struct wifi_if *wi, char *ssid)
 {
+    struct wifi_ap *ap = NULL;
     int i;
 
+    wifi_cache_expire(wi);
     for (i = 0; i < wi->wi_scan_cnt; i++) {
-        if (!strcmp(wi->wi_scan[i].wa_ssid, ssid)) {
-            return &wi->wi_scan[i];
+        if (!strcmp(wi->wi_scan[i].wa_ssid, ssid) &&
+          (!ap || wi->wi_scan[i].wa_rssi > ap->wa_rssi)) {
+            ap = &wi->wi_scan[i];
         }
     }
-    return NULL;
+    return ap;
 }
 
 static void
 wifi_events(struct os_event *ev)
 {
+    struct wifi_if *wi;
+
     /*
-     * Expire connection attempts. Periodic scanning if tgt AP not visible.
+     * XXX Expire connection attempts.
      */
+    wi = (struct wifi_if *)ev->ev_arg;
+    if (wi->wi_state == CONNECTED) {
+        /*
+         * Background scan. Results merge into the cache, state is kept.
+         */
+        if (wi->wi_ops->wio_scan_start(wi)) {
+#if MYNEWT_VAL(WIFI_MGMT_BG_SCAN_INTERVAL)
+            wifi_bg_scan_arm(wi);
+#endif
+        }
+    }
 }
 
 /*
@@ -249,6 +369,8 @@ wifi_step(struct wifi_if *wi)
     switch (wi->wi_tgt) {
     case STOPPED:
         if (wi->wi_state != STOPPED) {
+            os_callout_stop(&wi->wi_timer);
+            wi->wi_reconnect = 0;
             if (wi->wi_state >= CONNECTING) {
                 wi->wi_ops->wio_disconnect(wi);
             }
@@ -263,16 +385,22 @@ wifi_step(struct wifi_if *wi)
             if (!rc) {
                 wi->wi_state = INIT;
             }
-        } else if (wi->wi_state == SCANNING) {
-            wi->wi_state = wi->wi_tgt;
-        } else if (wi->wi_state == CONNECTING) {
+        } else {
+            os_callout_stop(&wi->wi_timer);
             wi->wi_state = wi->wi_tgt;
         }
         break;
     case SCANNING:
         if (wi->wi_state == INIT) {
-            memset(wi->wi_scan, 0, sizeof(wi->wi_scan));
-            rc = wi->wi_ops->wio_scan_start(wi);
+            if (MYNEWT_VAL(WIFI_MGMT_SCAN_CACHE_AGE) == 0) {
+                wi->wi_scan_cnt = 0;
+            }
+            if (wi->wi_scan_chan && wi->wi_ops->wio_scan_chan) {
+                rc = wi->wi_ops->wio_scan_chan(wi, wi->wi_scan_chan);
+            } else {
+                wi->wi_scan_chan = 0;
+                rc = wi->wi_ops->wio_scan_start(wi);
+            }
             console_printf("wifi_request_scan : %d\n", rc);
             if (rc != 0) {
                 break;
@@ -286,9 +414,23 @@ wifi_step(struct wifi_if *wi)
         if (wi->wi_state == INIT || wi->wi_state == SCANNING) {
             ap = wifi_find_ap(wi, wi->wi_ssid);
             if (!ap) {
+                /*
+                 * Look on the channel of the last AP with this SSID first,
+                 * then everywhere.
+                 */
+                if (wi->wi_state == INIT && wi->wi_ops->wio_scan_chan &&
+                  wi->wi_last.wa_channel &&
+                  !strcmp(wi->wi_last.wa_ssid, wi->wi_ssid)) {
+                    wi->wi_scan_chan = wi->wi_last.wa_channel;
+                } else {
+                    wi->wi_scan_chan = 0;
+                }
+                wi->wi_state = INIT;
                 wifi_tgt_state(wi, SCANNING);
                 break;
             }
+            wi->wi_scan_chan = 0;
+            wi->wi_last = *ap;
             rc = wi->wi_ops->wio_connect(wi, ap);
             console_printf("wifi_connect : %d\n", rc);
             if (rc == 0) {
@@ -303,6 +445,9 @@ wifi_step(struct wifi_if *wi)
         break;
     case CONNECTED:
         wi->wi_state = wi->wi_tgt;
+#if MYNEWT_VAL(WIFI_MGMT_BG_SCAN_INTERVAL)
+        wifi_bg_scan_arm(wi);
+#endif
         break;
     default:
         console_printf("wifi_step() unknown tgt : %d\n", wi->wi_tgt);
@@ -320,6 +465,12 @@ wifi_event_state(struct os_event *ev)
     while (wi->wi_state != wi->wi_tgt) {
         wifi_step(wi);
     }
+    if (wi->wi_reconnect && wi->wi_state == INIT) {
+        wi->wi_reconnect = 0;
+        if (!WIFI_SSID_EMPTY(wi->wi_ssid)) {
+            wifi_tgt_state(wi, CONNECTING);
+        }
+    }
 }
 
 static void
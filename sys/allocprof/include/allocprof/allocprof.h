@@ -0,0 +1,160 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef H_ALLOCPROF_
+#define H_ALLOCPROF_
+
+#include <inttypes.h>
+#include "os/mynewt.h"
+#include "os/os_alloc_prof.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Ring event: an object was allocated. */
+#define ALLOCPROF_OP_ALLOC          0
+/** Ring event: an object was freed. */
+#define ALLOCPROF_OP_FREE           1
+
+/**
+ * Allocation statistics for a single call site.  A call site is identified
+ * by the caller address, the allocation type (OS_ALLOC_PROF_[...]) and the
+ * pool allocated from.
+ * Lifetimes are measured in OS ticks.
+ */
+struct allocprof_site {
+    const void *aps_caller;
+    /** The pool allocated from; NULL for the heap. */
+    const void *aps_pool;
+    uint8_t aps_type;
+    /** Number of allocations made from this site. */
+    uint32_t aps_allocs;
+    /** Number of those allocations that have since been freed. */
+    uint32_t aps_frees;
+    /** Objects from this site currently outstanding. */
+    uint32_t aps_live;
+    /** High-water mark of aps_live. */
+    uint32_t aps_live_max;
+    /** Bytes from this site currently outstanding. */
+    uint32_t aps_live_bytes;
+    /** High-water mark of aps_live_bytes. */
+    uint32_t aps_live_bytes_max;
+    /**
+     * Value of aps_live when the site's allocation type last reached a new
+     * overall high-water mark; shows who held memory at the peak.
+     */
+    uint32_t aps_peak_live;
+    /** Longest observed lifetime. */
+    uint32_t aps_lifetime_max;
+    /** Sum of all observed lifetimes; divide by aps_frees for the mean. */
+    uint32_t aps_lifetime_sum;
+};
+
+/** Totals for one allocation type. */
+struct allocprof_type_info {
+    uint32_t apt_live;
+    uint32_t apt_live_max;
+    uint32_t apt_live_bytes;
+    uint32_t apt_live_bytes_max;
+};
+
+/** Profiler-wide totals. */
+struct allocprof_info {
+    struct allocprof_type_info api_types[OS_ALLOC_PROF_NUM_TYPES];
+    /** Frees of objects the profiler was not tracking. */
+    uint32_t api_untracked_frees;
+    /** Allocations not tracked because the live table was full. */
+    uint32_t api_live_dropped;
+    /** Allocations not attributed because the site table was full. */
+    uint32_t api_site_dropped;
+    /** Events not written to the ring (interrupt / critical context). */
+    uint32_t api_ring_dropped;
+};
+
+/** An entry in the event ring. */
+struct allocprof_event {
+    uint32_t ape_ptr;
+    uint32_t ape_caller;
+    uint32_t ape_size;
+    os_time_t ape_time;
+    uint8_t ape_type;
+    uint8_t ape_op;
+};
+
+/**
+ * Callback for allocprof_ring_walk().
+ *
+ * @param ev                    The event being visited.
+ * @param arg                   The argument passed to allocprof_ring_walk().
+ *
+ * @return                      0 to continue; nonzero to stop the walk.
+ */
+typedef int allocprof_walk_fn(const struct allocprof_event *ev, void *arg);
+
+/**
+ * Copies out the statistics for the next used call-site slot.
+ *
+ * Iterate with:
+ *     for (i = allocprof_site_get_next(0, &s); i >= 0;
+ *          i = allocprof_site_get_next(i + 1, &s))
+ *
+ * @param idx                   Slot index to start searching from.
+ * @param site                  Filled in with the site's statistics.
+ *
+ * @return                      The index of the slot copied;
+ *                              -1 if there are no more sites.
+ */
+int allocprof_site_get_next(int idx, struct allocprof_site *site);
+
+/**
+ * Copies out the profiler-wide totals.
+ *
+ * @param info                  Filled in with the totals.
+ */
+void allocprof_info_get(struct allocprof_info *info);
+
+/**
+ * Walks the event ring from oldest to newest entry.
+ *
+ * @param fn                    The function to call for each event.
+ * @param arg                   Argument passed to fn.
+ *
+ * @return                      0 on success;
+ *                              SYS_ENOTSUP if the ring is disabled;
+ *                              other SYS_E[...] code on failure.
+ */
+int allocprof_ring_walk(allocprof_walk_fn *fn, void *arg);
+
+/**
+ * Clears all statistics, the live table and the event ring.  Objects that
+ * were outstanding at reset are counted as untracked when freed.
+ */
+void allocprof_reset(void);
+
+/**
+ * Returns a short name for an OS_ALLOC_PROF_[...] type.
+ */
+const char *allocprof_type_name(uint8_t type);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,61 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef H_ALLOCPROF_TEST_
+#define H_ALLOCPROF_TEST_
+
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+#include "allocprof/allocprof.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ALLOCPROF_TEST_NUM_BLOCKS   8
+#define ALLOCPROF_TEST_BLOCK_SIZE   64
+
+extern struct os_mempool allocprof_test_pool;
+extern struct os_mempool allocprof_test_mbuf_mempool;
+extern struct os_mbuf_pool allocprof_test_mbuf_pool;
+
+void *allocprof_test_get_a(void);
+void *allocprof_test_get_b(void);
+
+/*
+ * Finds the site of the given type and pool; returns 0 if there is exactly
+ * one, and fills in *site.
+ */
+int allocprof_test_site_find(uint8_t type, const void *pool,
+                             struct allocprof_site *site);
+
+/* Counts the sites of the given type and pool. */
+int allocprof_test_site_count(uint8_t type, const void *pool);
+
+TEST_CASE_DECL(allocprof_test_memblock_counts);
+TEST_CASE_DECL(allocprof_test_memblock_sites);
+TEST_CASE_DECL(allocprof_test_mbuf_once);
+TEST_CASE_DECL(allocprof_test_untracked_free);
+TEST_SUITE_DECL(allocprof_test_suite);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
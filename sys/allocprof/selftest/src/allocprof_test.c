@@ -0,0 +1,129 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "allocprof_test/allocprof_test.h"
+
+struct os_mempool allocprof_test_pool;
+static os_membuf_t allocprof_test_pool_buf[
+    OS_MEMPOOL_SIZE(ALLOCPROF_TEST_NUM_BLOCKS, ALLOCPROF_TEST_BLOCK_SIZE)];
+
+#define ALLOCPROF_TEST_MBUF_SIZE    \
+    (ALLOCPROF_TEST_BLOCK_SIZE + sizeof(struct os_mbuf))
+
+struct os_mempool allocprof_test_mbuf_mempool;
+struct os_mbuf_pool allocprof_test_mbuf_pool;
+static os_membuf_t allocprof_test_mbuf_buf[
+    OS_MEMPOOL_SIZE(ALLOCPROF_TEST_NUM_BLOCKS, ALLOCPROF_TEST_MBUF_SIZE)];
+
+/* Two distinct call sites; kept out of line so their callers differ. */
+__attribute__((noinline)) void *
+allocprof_test_get_a(void)
+{
+    return os_memblock_get(&allocprof_test_pool);
+}
+
+__attribute__((noinline)) void *
+allocprof_test_get_b(void)
+{
+    return os_memblock_get(&allocprof_test_pool);
+}
+
+int
+allocprof_test_site_count(uint8_t type, const void *pool)
+{
+    struct allocprof_site site;
+    int count;
+    int i;
+
+    count = 0;
+    for (i = allocprof_site_get_next(0, &site);
+         i >= 0;
+         i = allocprof_site_get_next(i + 1, &site)) {
+
+        if (site.aps_type == type && site.aps_pool == pool) {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+int
+allocprof_test_site_find(uint8_t type, const void *pool,
+                         struct allocprof_site *out)
+{
+    struct allocprof_site site;
+    int count;
+    int i;
+
+    count = 0;
+    for (i = allocprof_site_get_next(0, &site);
+         i >= 0;
+         i = allocprof_site_get_next(i + 1, &site)) {
+
+        if (site.aps_type == type && site.aps_pool == pool) {
+            *out = site;
+            count++;
+        }
+    }
+
+    return count == 1 ? 0 : -1;
+}
+
+static void
+allocprof_test_pre(void *arg)
+{
+    int rc;
+
+    rc = os_mempool_init(&allocprof_test_pool, ALLOCPROF_TEST_NUM_BLOCKS,
+                         ALLOCPROF_TEST_BLOCK_SIZE, allocprof_test_pool_buf,
+                         "allocprof_test");
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = os_mempool_init(&allocprof_test_mbuf_mempool,
+                         ALLOCPROF_TEST_NUM_BLOCKS, ALLOCPROF_TEST_MBUF_SIZE,
+                         allocprof_test_mbuf_buf, "allocprof_test_mbuf");
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = os_mbuf_pool_init(&allocprof_test_mbuf_pool,
+                           &allocprof_test_mbuf_mempool,
+                           ALLOCPROF_TEST_MBUF_SIZE,
+                           ALLOCPROF_TEST_NUM_BLOCKS);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    allocprof_reset();
+}
+
+TEST_SUITE(allocprof_test_suite)
+{
+    tu_suite_set_pre_test_cb(allocprof_test_pre, NULL);
+
+    allocprof_test_memblock_counts();
+    allocprof_test_memblock_sites();
+    allocprof_test_mbuf_once();
+    allocprof_test_untracked_free();
+}
+
+int
+main(int argc, char **argv)
+{
+    allocprof_test_suite();
+
+    return tu_any_failed;
+}
@@ -0,0 +1,60 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "allocprof_test/allocprof_test.h"
+
+/*
+ * An mbuf is reported once, as an mbuf; the memory block under it is not
+ * reported again as a memblock.
+ */
+TEST_CASE_SELF(allocprof_test_mbuf_once)
+{
+    struct allocprof_site site;
+    struct allocprof_info info;
+    struct os_mbuf *om;
+    int rc;
+
+    om = os_mbuf_get(&allocprof_test_mbuf_pool, 0);
+    TEST_ASSERT_FATAL(om != NULL);
+
+    rc = allocprof_test_site_find(OS_ALLOC_PROF_MBUF,
+                                  &allocprof_test_mbuf_pool, &site);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(site.aps_allocs == 1);
+    TEST_ASSERT(site.aps_live == 1);
+
+    TEST_ASSERT(allocprof_test_site_count(OS_ALLOC_PROF_MEMBLOCK,
+                                          &allocprof_test_mbuf_mempool) == 0);
+
+    allocprof_info_get(&info);
+    TEST_ASSERT(info.api_types[OS_ALLOC_PROF_MBUF].apt_live == 1);
+    TEST_ASSERT(info.api_types[OS_ALLOC_PROF_MEMBLOCK].apt_live == 0);
+
+    rc = os_mbuf_free_chain(om);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = allocprof_test_site_find(OS_ALLOC_PROF_MBUF,
+                                  &allocprof_test_mbuf_pool, &site);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(site.aps_frees == 1);
+    TEST_ASSERT(site.aps_live == 0);
+
+    allocprof_info_get(&info);
+    TEST_ASSERT(info.api_untracked_frees == 0);
+}
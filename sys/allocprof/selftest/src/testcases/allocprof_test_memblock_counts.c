@@ -0,0 +1,65 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "allocprof_test/allocprof_test.h"
+
+TEST_CASE_SELF(allocprof_test_memblock_counts)
+{
+    struct allocprof_site site;
+    struct allocprof_info info;
+    void *blocks[ALLOCPROF_TEST_NUM_BLOCKS];
+    int rc;
+    int i;
+
+    for (i = 0; i < ALLOCPROF_TEST_NUM_BLOCKS; i++) {
+        blocks[i] = allocprof_test_get_a();
+        TEST_ASSERT_FATAL(blocks[i] != NULL);
+    }
+    for (i = 0; i < ALLOCPROF_TEST_NUM_BLOCKS / 2; i++) {
+        rc = os_memblock_put(&allocprof_test_pool, blocks[i]);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+
+    rc = allocprof_test_site_find(OS_ALLOC_PROF_MEMBLOCK,
+                                  &allocprof_test_pool, &site);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(site.aps_allocs == ALLOCPROF_TEST_NUM_BLOCKS);
+    TEST_ASSERT(site.aps_frees == ALLOCPROF_TEST_NUM_BLOCKS / 2);
+    TEST_ASSERT(site.aps_live == ALLOCPROF_TEST_NUM_BLOCKS / 2);
+    TEST_ASSERT(site.aps_live_max == ALLOCPROF_TEST_NUM_BLOCKS);
+    TEST_ASSERT(site.aps_live_bytes ==
+                ALLOCPROF_TEST_NUM_BLOCKS / 2 * ALLOCPROF_TEST_BLOCK_SIZE);
+
+    allocprof_info_get(&info);
+    TEST_ASSERT(info.api_types[OS_ALLOC_PROF_MEMBLOCK].apt_live_max >=
+                ALLOCPROF_TEST_NUM_BLOCKS);
+    TEST_ASSERT(info.api_untracked_frees == 0);
+
+    for (i = ALLOCPROF_TEST_NUM_BLOCKS / 2; i < ALLOCPROF_TEST_NUM_BLOCKS;
+         i++) {
+        os_memblock_put(&allocprof_test_pool, blocks[i]);
+    }
+
+    rc = allocprof_test_site_find(OS_ALLOC_PROF_MEMBLOCK,
+                                  &allocprof_test_pool, &site);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(site.aps_frees == ALLOCPROF_TEST_NUM_BLOCKS);
+    TEST_ASSERT(site.aps_live == 0);
+    TEST_ASSERT(site.aps_live_bytes == 0);
+}
@@ -0,0 +1,52 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "allocprof_test/allocprof_test.h"
+
+TEST_CASE_SELF(allocprof_test_memblock_sites)
+{
+    struct allocprof_site site;
+    void *a[2];
+    void *b;
+    int i;
+
+    a[0] = allocprof_test_get_a();
+    a[1] = allocprof_test_get_a();
+    b = allocprof_test_get_b();
+    TEST_ASSERT_FATAL(a[0] != NULL && a[1] != NULL && b != NULL);
+
+    /* One site per caller, both for the same pool. */
+    TEST_ASSERT(allocprof_test_site_count(OS_ALLOC_PROF_MEMBLOCK,
+                                          &allocprof_test_pool) == 2);
+
+    for (i = allocprof_site_get_next(0, &site);
+         i >= 0;
+         i = allocprof_site_get_next(i + 1, &site)) {
+
+        if (site.aps_pool != &allocprof_test_pool) {
+            continue;
+        }
+        TEST_ASSERT(site.aps_allocs == 1 || site.aps_allocs == 2);
+        TEST_ASSERT(site.aps_live == site.aps_allocs);
+    }
+
+    os_memblock_put(&allocprof_test_pool, a[0]);
+    os_memblock_put(&allocprof_test_pool, a[1]);
+    os_memblock_put(&allocprof_test_pool, b);
+}
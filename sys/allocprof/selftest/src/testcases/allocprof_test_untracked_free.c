@@ -0,0 +1,43 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "allocprof_test/allocprof_test.h"
+
+/* Objects allocated before a reset are counted as untracked when freed. */
+TEST_CASE_SELF(allocprof_test_untracked_free)
+{
+    struct allocprof_site site;
+    struct allocprof_info info;
+    void *block;
+    int rc;
+
+    block = allocprof_test_get_a();
+    TEST_ASSERT_FATAL(block != NULL);
+
+    allocprof_reset();
+
+    rc = os_memblock_put(&allocprof_test_pool, block);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    allocprof_info_get(&info);
+    TEST_ASSERT(info.api_untracked_frees == 1);
+    TEST_ASSERT(info.api_types[OS_ALLOC_PROF_MEMBLOCK].apt_live == 0);
+    TEST_ASSERT(allocprof_test_site_find(OS_ALLOC_PROF_MEMBLOCK,
+                                         &allocprof_test_pool, &site) != 0);
+}
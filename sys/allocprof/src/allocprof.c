@@ -0,0 +1,483 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <assert.h>
+#include <string.h>
+#include "os/mynewt.h"
+#include "cbmem/cbmem.h"
+#include "allocprof/allocprof.h"
+#include "allocprof_priv.h"
+
+#define ALLOCPROF_MAX_SITES     MYNEWT_VAL(ALLOCPROF_MAX_SITES)
+#define ALLOCPROF_MAX_LIVE      MYNEWT_VAL(ALLOCPROF_MAX_LIVE)
+#define ALLOCPROF_RING_SIZE     MYNEWT_VAL(ALLOCPROF_RING_SIZE)
+
+/* Live entry not attributed to any site (site table was full). */
+#define ALLOCPROF_SITE_NONE     0xff
+
+/* Marks a removed live-table slot that a probe must step over. */
+#define ALLOCPROF_TOMBSTONE     ((const void *)1)
+
+static_assert(ALLOCPROF_MAX_SITES > 0 &&
+              ALLOCPROF_MAX_SITES < ALLOCPROF_SITE_NONE,
+              "ALLOCPROF_MAX_SITES must be between 1 and 254");
+static_assert(ALLOCPROF_MAX_LIVE > 0, "ALLOCPROF_MAX_LIVE must be nonzero");
+
+/* An outstanding allocation. */
+struct allocprof_live {
+    const void *apl_ptr;
+    os_time_t apl_time;
+    uint32_t apl_size;
+    uint8_t apl_site;
+    uint8_t apl_type;
+};
+
+/*
+ * Both tables are open-addressing hashes with linear probing, so that a
+ * lookup made with interrupts disabled touches only a few entries.  They
+ * are only modified inside a critical section.
+ */
+static struct allocprof_site allocprof_sites[ALLOCPROF_MAX_SITES];
+static struct allocprof_live allocprof_live[ALLOCPROF_MAX_LIVE];
+static struct allocprof_info allocprof_totals;
+
+#if ALLOCPROF_RING_SIZE > 0
+static uint8_t allocprof_ring_buf[ALLOCPROF_RING_SIZE];
+static struct cbmem allocprof_ring;
+static bool allocprof_ring_ready;
+
+/* Task inside allocprof_ring_walk(); its own allocations are not logged. */
+static struct os_task *allocprof_ring_walker;
+#endif
+
+static uint32_t
+allocprof_hash(const void *a, const void *b, uint8_t type)
+{
+    uint32_t h;
+
+    h = ((uint32_t)(uintptr_t)a >> 2) ^ (uint32_t)(uintptr_t)b ^ type;
+    h *= 0x9e3779b1;
+
+    return h ^ (h >> 16);
+}
+
+static int
+allocprof_site_find(const void *caller, const void *pool, uint8_t type)
+{
+    struct allocprof_site *site;
+    uint32_t idx;
+    int i;
+
+    idx = allocprof_hash(caller, pool, type) % ALLOCPROF_MAX_SITES;
+    for (i = 0; i < ALLOCPROF_MAX_SITES; i++) {
+        site = &allocprof_sites[idx];
+        if (site->aps_allocs == 0) {
+            /* Unused slot; claim it. */
+            site->aps_caller = caller;
+            site->aps_pool = pool;
+            site->aps_type = type;
+            return idx;
+        }
+        if (site->aps_caller == caller && site->aps_pool == pool &&
+            site->aps_type == type) {
+            return idx;
+        }
+
+        if (++idx == ALLOCPROF_MAX_SITES) {
+            idx = 0;
+        }
+    }
+
+    return -1;
+}
+
+static struct allocprof_live *
+allocprof_live_insert(const void *ptr, uint8_t type)
+{
+    struct allocprof_live *live;
+    uint32_t idx;
+    int i;
+
+    idx = allocprof_hash(ptr, NULL, type) % ALLOCPROF_MAX_LIVE;
+    for (i = 0; i < ALLOCPROF_MAX_LIVE; i++) {
+        live = &allocprof_live[idx];
+        if (live->apl_ptr == NULL || live->apl_ptr == ALLOCPROF_TOMBSTONE) {
+            live->apl_ptr = ptr;
+            live->apl_type = type;
+            return live;
+        }
+
+        if (++idx == ALLOCPROF_MAX_LIVE) {
+            idx = 0;
+        }
+    }
+
+    return NULL;
+}
+
+static int
+allocprof_live_remove(const void *ptr, uint8_t type,
+                      struct allocprof_live *out)
+{
+    struct allocprof_live *live;
+    uint32_t idx;
+    int i;
+
+    idx = allocprof_hash(ptr, NULL, type) % ALLOCPROF_MAX_LIVE;
+    for (i = 0; i < ALLOCPROF_MAX_LIVE; i++) {
+        live = &allocprof_live[idx];
+        if (live->apl_ptr == NULL) {
+            break;
+        }
+        if (live->apl_ptr == ptr && live->apl_type == type) {
+            *out = *live;
+
+            /* If nothing follows this slot, no probe needs to step over it;
+             * free it and any run of tombstones ending here.  Otherwise
+             * leave a tombstone.
+             */
+            if (allocprof_live[(idx + 1) % ALLOCPROF_MAX_LIVE].apl_ptr ==
+                NULL) {
+                do {
+                    allocprof_live[idx].apl_ptr = NULL;
+                    idx = (idx + ALLOCPROF_MAX_LIVE - 1) % ALLOCPROF_MAX_LIVE;
+                } while (allocprof_live[idx].apl_ptr == ALLOCPROF_TOMBSTONE);
+            } else {
+                live->apl_ptr = ALLOCPROF_TOMBSTONE;
+            }
+            return 0;
+        }
+
+        if (++idx == ALLOCPROF_MAX_LIVE) {
+            idx = 0;
+        }
+    }
+
+    return SYS_ENOENT;
+}
+
+static void
+allocprof_ring_add(uint8_t op, uint8_t type, const void *ptr, uint32_t size,
+                   const void *caller, os_time_t now)
+{
+#if ALLOCPROF_RING_SIZE > 0
+    struct allocprof_event ev;
+    os_sr_t sr;
+
+    if (!allocprof_ring_ready) {
+        return;
+    }
+
+    /* cbmem is protected by a mutex, and must not be appended to by the
+     * task that is walking it.
+     */
+    if (os_arch_in_isr() || os_arch_in_critical() ||
+        (allocprof_ring_walker != NULL &&
+         os_sched_get_current_task() == allocprof_ring_walker)) {
+        OS_ENTER_CRITICAL(sr);
+        allocprof_totals.api_ring_dropped++;
+        OS_EXIT_CRITICAL(sr);
+        return;
+    }
+
+    ev.ape_ptr = (uint32_t)(uintptr_t)ptr;
+    ev.ape_caller = (uint32_t)(uintptr_t)caller;
+    ev.ape_size = size;
+    ev.ape_time = now;
+    ev.ape_type = type;
+    ev.ape_op = op;
+
+    cbmem_append(&allocprof_ring, &ev, sizeof ev);
+#endif
+}
+
+void
+os_alloc_prof_alloc(uint8_t type, const void *pool, const void *ptr,
+                    uint32_t size, const void *caller)
+{
+    struct allocprof_type_info *apt;
+    struct allocprof_site *site;
+    struct allocprof_live *live;
+    os_time_t now;
+    os_sr_t sr;
+    int idx;
+    int i;
+
+    assert(type < OS_ALLOC_PROF_NUM_TYPES);
+
+    now = os_time_get();
+
+    OS_ENTER_CRITICAL(sr);
+
+    idx = allocprof_site_find(caller, pool, type);
+    if (idx < 0) {
+        allocprof_totals.api_site_dropped++;
+        site = NULL;
+    } else {
+        site = &allocprof_sites[idx];
+        site->aps_allocs++;
+    }
+
+    /* Live counts are only kept for objects whose free can be matched. */
+    live = allocprof_live_insert(ptr, type);
+    if (live == NULL) {
+        allocprof_totals.api_live_dropped++;
+        goto done;
+    }
+    live->apl_time = now;
+    live->apl_size = size;
+    live->apl_site = idx < 0 ? ALLOCPROF_SITE_NONE : idx;
+
+    if (site != NULL) {
+        site->aps_live++;
+        if (site->aps_live > site->aps_live_max) {
+            site->aps_live_max = site->aps_live;
+        }
+        site->aps_live_bytes += size;
+        if (site->aps_live_bytes > site->aps_live_bytes_max) {
+            site->aps_live_bytes_max = site->aps_live_bytes;
+        }
+    }
+
+    apt = &allocprof_totals.api_types[type];
+    apt->apt_live_bytes += size;
+    if (apt->apt_live_bytes > apt->apt_live_bytes_max) {
+        apt->apt_live_bytes_max = apt->apt_live_bytes;
+    }
+    apt->apt_live++;
+    if (apt->apt_live > apt->apt_live_max) {
+        /* New high-water mark for this type: remember who holds what. */
+        apt->apt_live_max = apt->apt_live;
+        for (i = 0; i < ALLOCPROF_MAX_SITES; i++) {
+            if (allocprof_sites[i].aps_type == type) {
+                allocprof_sites[i].aps_peak_live =
+                    allocprof_sites[i].aps_live;
+            }
+        }
+    }
+
+done:
+    OS_EXIT_CRITICAL(sr);
+
+    allocprof_ring_add(ALLOCPROF_OP_ALLOC, type, ptr, size, caller, now);
+}
+
+void
+os_alloc_prof_free(uint8_t type, const void *ptr)
+{
+    struct allocprof_type_info *apt;
+    struct allocprof_site *site;
+    struct allocprof_live live;
+    const void *caller;
+    os_time_t lifetime;
+    os_time_t now;
+    os_sr_t sr;
+    int rc;
+
+    assert(type < OS_ALLOC_PROF_NUM_TYPES);
+
+    now = os_time_get();
+    caller = NULL;
+
+    OS_ENTER_CRITICAL(sr);
+
+    rc = allocprof_live_remove(ptr, type, &live);
+    if (rc != 0) {
+        allocprof_totals.api_untracked_frees++;
+        live.apl_size = 0;
+        goto done;
+    }
+
+    apt = &allocprof_totals.api_types[type];
+    apt->apt_live--;
+    apt->apt_live_bytes -= live.apl_size;
+
+    if (live.apl_site != ALLOCPROF_SITE_NONE) {
+        site = &allocprof_sites[live.apl_site];
+        caller = site->aps_caller;
+
+        lifetime = now - live.apl_time;
+        site->aps_frees++;
+        site->aps_live--;
+        site->aps_live_bytes -= live.apl_size;
+        site->aps_lifetime_sum += lifetime;
+        if (lifetime > site->aps_lifetime_max) {
+            site->aps_lifetime_max = lifetime;
+        }
+    }
+
+done:
+    OS_EXIT_CRITICAL(sr);
+
+    allocprof_ring_add(ALLOCPROF_OP_FREE, type, ptr, live.apl_size, caller,
+                       now);
+}
+
+int
+allocprof_site_get_next(int idx, struct allocprof_site *site)
+{
+    os_sr_t sr;
+
+    if (idx < 0) {
+        idx = 0;
+    }
+
+    OS_ENTER_CRITICAL(sr);
+    for (; idx < ALLOCPROF_MAX_SITES; idx++) {
+        if (allocprof_sites[idx].aps_allocs != 0) {
+            *site = allocprof_sites[idx];
+            break;
+        }
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    if (idx >= ALLOCPROF_MAX_SITES) {
+        return -1;
+    }
+
+    return idx;
+}
+
+void
+allocprof_info_get(struct allocprof_info *info)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    *info = allocprof_totals;
+    OS_EXIT_CRITICAL(sr);
+}
+
+#if ALLOCPROF_RING_SIZE > 0
+struct allocprof_walk_arg {
+    allocprof_walk_fn *fn;
+    void *arg;
+};
+
+static int
+allocprof_ring_walk_entry(struct cbmem *cbmem, struct cbmem_entry_hdr *hdr,
+                          void *arg)
+{
+    struct allocprof_walk_arg *awa;
+    struct allocprof_event ev;
+    int rc;
+
+    awa = arg;
+
+    rc = cbmem_read(cbmem, hdr, &ev, 0, sizeof ev);
+    if (rc != sizeof ev) {
+        return 0;
+    }
+
+    return awa->fn(&ev, awa->arg);
+}
+#endif
+
+int
+allocprof_ring_walk(allocprof_walk_fn *fn, void *arg)
+{
+#if ALLOCPROF_RING_SIZE > 0
+    struct allocprof_walk_arg awa;
+    int rc;
+
+    if (!allocprof_ring_ready) {
+        return SYS_ENOTSUP;
+    }
+
+    awa.fn = fn;
+    awa.arg = arg;
+
+    /* Hold the ring lock across the walk so only one walker is recorded;
+     * the lock nests inside cbmem_walk().
+     */
+    rc = cbmem_lock_acquire(&allocprof_ring);
+    if (rc != 0) {
+        return SYS_EUNKNOWN;
+    }
+
+    allocprof_ring_walker = os_sched_get_current_task();
+    rc = cbmem_walk(&allocprof_ring, allocprof_ring_walk_entry, &awa);
+    allocprof_ring_walker = NULL;
+
+    cbmem_lock_release(&allocprof_ring);
+    if (rc != 0) {
+        return SYS_EUNKNOWN;
+    }
+
+    return 0;
+#else
+    return SYS_ENOTSUP;
+#endif
+}
+
+void
+allocprof_reset(void)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    memset(allocprof_sites, 0, sizeof allocprof_sites);
+    memset(allocprof_live, 0, sizeof allocprof_live);
+    memset(&allocprof_totals, 0, sizeof allocprof_totals);
+    OS_EXIT_CRITICAL(sr);
+
+#if ALLOCPROF_RING_SIZE > 0
+    if (allocprof_ring_ready) {
+        cbmem_flush(&allocprof_ring);
+    }
+#endif
+}
+
+const char *
+allocprof_type_name(uint8_t type)
+{
+    switch (type) {
+    case OS_ALLOC_PROF_HEAP:
+        return "heap";
+    case OS_ALLOC_PROF_MEMBLOCK:
+        return "memblock";
+    case OS_ALLOC_PROF_MBUF:
+        return "mbuf";
+    default:
+        return "???";
+    }
+}
+
+void
+allocprof_init(void)
+{
+#if ALLOCPROF_RING_SIZE > 0 || MYNEWT_VAL(ALLOCPROF_CLI)
+    int rc;
+#endif
+
+    /* Ensure this function only gets called by sysinit. */
+    SYSINIT_ASSERT_ACTIVE();
+
+#if ALLOCPROF_RING_SIZE > 0
+    rc = cbmem_init(&allocprof_ring, allocprof_ring_buf,
+                    sizeof allocprof_ring_buf);
+    SYSINIT_PANIC_ASSERT(rc == 0);
+    allocprof_ring_ready = true;
+#endif
+
+#if MYNEWT_VAL(ALLOCPROF_CLI)
+    rc = allocprof_shell_register();
+    SYSINIT_PANIC_ASSERT(rc == 0);
+#endif
+}
@@ -0,0 +1,141 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(ALLOCPROF_CLI)
+
+#include <string.h>
+#include "shell/shell.h"
+#include "streamer/streamer.h"
+#include "allocprof/allocprof.h"
+#include "allocprof_priv.h"
+
+static int allocprof_shell_cmd(const struct shell_cmd *cmd,
+                               int argc, char **argv,
+                               struct streamer *streamer);
+
+static struct shell_cmd allocprof_shell_cmd_struct =
+    SHELL_CMD_EXT("allocprof", allocprof_shell_cmd, NULL);
+
+static void
+allocprof_shell_sites(struct streamer *streamer)
+{
+    struct allocprof_site site;
+    struct allocprof_info info;
+    int i;
+
+    allocprof_info_get(&info);
+
+    streamer_printf(streamer, "%-8s %8s %8s %10s %10s\n",
+                    "type", "live", "max", "bytes", "max bytes");
+    for (i = 0; i < OS_ALLOC_PROF_NUM_TYPES; i++) {
+        streamer_printf(streamer, "%-8s %8lu %8lu %10lu %10lu\n",
+                        allocprof_type_name(i),
+                        (unsigned long)info.api_types[i].apt_live,
+                        (unsigned long)info.api_types[i].apt_live_max,
+                        (unsigned long)info.api_types[i].apt_live_bytes,
+                        (unsigned long)info.api_types[i].apt_live_bytes_max);
+    }
+    streamer_printf(streamer,
+                    "untracked frees %lu, dropped: live %lu site %lu "
+                    "ring %lu\n",
+                    (unsigned long)info.api_untracked_frees,
+                    (unsigned long)info.api_live_dropped,
+                    (unsigned long)info.api_site_dropped,
+                    (unsigned long)info.api_ring_dropped);
+
+    streamer_printf(streamer, "%-8s %10s %10s %8s %8s %6s %6s %8s %8s\n",
+                    "type", "caller", "pool", "allocs", "frees", "live",
+                    "max", "@peak", "life avg/max");
+    for (i = allocprof_site_get_next(0, &site);
+         i >= 0;
+         i = allocprof_site_get_next(i + 1, &site)) {
+
+        streamer_printf(streamer,
+                        "%-8s 0x%08lx 0x%08lx %8lu %8lu %6lu %6lu %8lu "
+                        "%lu/%lu\n",
+                        allocprof_type_name(site.aps_type),
+                        (unsigned long)(uintptr_t)site.aps_caller,
+                        (unsigned long)(uintptr_t)site.aps_pool,
+                        (unsigned long)site.aps_allocs,
+                        (unsigned long)site.aps_frees,
+                        (unsigned long)site.aps_live,
+                        (unsigned long)site.aps_live_max,
+                        (unsigned long)site.aps_peak_live,
+                        site.aps_frees ?
+                            (unsigned long)(site.aps_lifetime_sum /
+                                            site.aps_frees) : 0UL,
+                        (unsigned long)site.aps_lifetime_max);
+    }
+}
+
+static int
+allocprof_shell_event(const struct allocprof_event *ev, void *arg)
+{
+    struct streamer *streamer;
+
+    streamer = arg;
+
+    streamer_printf(streamer, "%10lu %-5s %-8s 0x%08lx %6lu 0x%08lx\n",
+                    (unsigned long)ev->ape_time,
+                    ev->ape_op == ALLOCPROF_OP_ALLOC ? "alloc" : "free",
+                    allocprof_type_name(ev->ape_type),
+                    (unsigned long)ev->ape_ptr,
+                    (unsigned long)ev->ape_size,
+                    (unsigned long)ev->ape_caller);
+
+    return 0;
+}
+
+static int
+allocprof_shell_cmd(const struct shell_cmd *cmd, int argc, char **argv,
+                    struct streamer *streamer)
+{
+    int rc;
+
+    if (argc < 2 || strcmp(argv[1], "sites") == 0) {
+        allocprof_shell_sites(streamer);
+        return 0;
+    }
+
+    if (strcmp(argv[1], "ring") == 0) {
+        rc = allocprof_ring_walk(allocprof_shell_event, streamer);
+        if (rc != 0) {
+            streamer_printf(streamer, "event ring unavailable\n");
+        }
+        return rc;
+    }
+
+    if (strcmp(argv[1], "reset") == 0) {
+        allocprof_reset();
+        return 0;
+    }
+
+    streamer_printf(streamer, "usage: allocprof [sites|ring|reset]\n");
+    return SYS_EINVAL;
+}
+
+int
+allocprof_shell_register(void)
+{
+    return shell_cmd_register(&allocprof_shell_cmd_struct);
+}
+
+#endif
@@ -0,0 +1,156 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(BOOTPROF_CLI)
+#include <string.h>
+#include "shell/shell.h"
+#include "streamer/streamer.h"
+#endif
+
+#if MYNEWT_VAL(BOOTPROF_MGMT)
+#include "mgmt/mgmt.h"
+#endif
+
+/*
+ * Times from sysinit are converted to microseconds for display; a boot
+ * taking longer than the os_cputime counter wraps is not measured right.
+ */
+
+#if MYNEWT_VAL(BOOTPROF_CLI)
+static int bootprof_shell_cmd(const struct shell_cmd *cmd, int argc,
+                              char **argv, struct streamer *streamer);
+
+static struct shell_cmd bootprof_shell_cmd_struct =
+    SHELL_CMD_EXT("bootprof", bootprof_shell_cmd, NULL);
+
+static int
+bootprof_shell_cmd(const struct shell_cmd *cmd, int argc, char **argv,
+                   struct streamer *streamer)
+{
+    const struct sysinit_prof_rec *rec;
+    uint32_t total;
+    int dropped;
+    int i;
+
+    total = sysinit_prof_total(&dropped);
+
+    streamer_printf(streamer, "%10s %10s  %s\n", "start(us)", "dur(us)",
+                    "name");
+    for (i = 0; (rec = sysinit_prof_get(i)) != NULL; i++) {
+        streamer_printf(streamer, "%10lu %10lu  %s\n",
+                        (unsigned long)os_cputime_ticks_to_usecs(
+                            rec->spr_start),
+                        (unsigned long)os_cputime_ticks_to_usecs(
+                            rec->spr_ticks),
+                        rec->spr_name ? rec->spr_name : "?");
+    }
+    streamer_printf(streamer, "sysinit %lu us, dropped %d\n",
+                    (unsigned long)os_cputime_ticks_to_usecs(total),
+                    dropped);
+
+    return 0;
+}
+#endif
+
+#if MYNEWT_VAL(BOOTPROF_MGMT)
+static int bootprof_mgmt_read(struct mgmt_ctxt *ctxt);
+
+static const struct mgmt_handler bootprof_mgmt_handlers[] = {
+    [0] = { bootprof_mgmt_read, NULL },
+};
+
+static struct mgmt_group bootprof_mgmt_group = {
+    .mg_handlers = (struct mgmt_handler *)bootprof_mgmt_handlers,
+    .mg_handlers_count = 1,
+    .mg_group_id = MYNEWT_VAL(BOOTPROF_MGMT_GROUP),
+};
+
+/*
+ * Response:
+ * {
+ *      "total":<sysinit duration, us>,
+ *      "dropped":<records that did not fit>,
+ *      "recs":[{"name":<name>, "start":<us>, "dur":<us>}, ...]
+ * }
+ */
+static int
+bootprof_mgmt_read(struct mgmt_ctxt *ctxt)
+{
+    const struct sysinit_prof_rec *rec;
+    CborEncoder recs;
+    CborEncoder map;
+    CborError g_err = CborNoError;
+    uint32_t total;
+    int dropped;
+    int i;
+
+    total = sysinit_prof_total(&dropped);
+
+    g_err |= cbor_encode_text_stringz(&ctxt->encoder, "total");
+    g_err |= cbor_encode_uint(&ctxt->encoder,
+                              os_cputime_ticks_to_usecs(total));
+    g_err |= cbor_encode_text_stringz(&ctxt->encoder, "dropped");
+    g_err |= cbor_encode_int(&ctxt->encoder, dropped);
+
+    g_err |= cbor_encode_text_stringz(&ctxt->encoder, "recs");
+    g_err |= cbor_encoder_create_array(&ctxt->encoder, &recs,
+                                       CborIndefiniteLength);
+    for (i = 0; (rec = sysinit_prof_get(i)) != NULL; i++) {
+        g_err |= cbor_encoder_create_map(&recs, &map, 3);
+        g_err |= cbor_encode_text_stringz(&map, "name");
+        g_err |= cbor_encode_text_stringz(&map,
+                                          rec->spr_name ? rec->spr_name : "");
+        g_err |= cbor_encode_text_stringz(&map, "start");
+        g_err |= cbor_encode_uint(&map,
+                                  os_cputime_ticks_to_usecs(rec->spr_start));
+        g_err |= cbor_encode_text_stringz(&map, "dur");
+        g_err |= cbor_encode_uint(&map,
+                                  os_cputime_ticks_to_usecs(rec->spr_ticks));
+        g_err |= cbor_encoder_close_container(&recs, &map);
+    }
+    g_err |= cbor_encoder_close_container(&ctxt->encoder, &recs);
+
+    if (g_err) {
+        return MGMT_ERR_ENOMEM;
+    }
+    return 0;
+}
+#endif
+
+void
+bootprof_init(void)
+{
+#if MYNEWT_VAL(BOOTPROF_CLI)
+    int rc;
+#endif
+
+    /* Ensure this function only gets called by sysinit. */
+    SYSINIT_ASSERT_ACTIVE();
+
+#if MYNEWT_VAL(BOOTPROF_CLI)
+    rc = shell_cmd_register(&bootprof_shell_cmd_struct);
+    SYSINIT_PANIC_ASSERT(rc == 0);
+#endif
+
+#if MYNEWT_VAL(BOOTPROF_MGMT)
+    mgmt_register_group(&bootprof_mgmt_group);
+#endif
+}
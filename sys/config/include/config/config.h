@@ -148,6 +148,37 @@ typedef void (*conf_export_func_t)(char *name, char *val);
 typedef int (*conf_export_handler_t)(conf_export_func_t export_func,
         conf_export_tgt_t tgt);
 
+/**
+ * Set the configuration variable pointed to by argc and argv from a value in
+ * its native binary form, without going through string conversion.  See
+ * description of ch_get_handler_t for format of argc and argv.
+ *
+ * @param argc    The number of sections in the configuration variable.
+ * @param argv    The array of configuration sections
+ * @param type    Type of the value
+ * @param val     Pointer to the value
+ * @param val_len Size of the value in bytes
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+typedef int (*conf_set_typed_handler_t)(int argc, char **argv,
+        enum conf_type type, const void *val, int val_len);
+
+/**
+ * Get the configuration variable pointed to by argc and argv in its native
+ * binary form.
+ *
+ * @param argc    The number of sections in the configuration variable.
+ * @param argv    The array of configuration sections
+ * @param type    Type of the value
+ * @param val     Buffer to copy the value into
+ * @param val_len Size of the buffer; on return the size of the value.
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+typedef int (*conf_get_typed_handler_t)(int argc, char **argv,
+        enum conf_type type, void *val, int *val_len);
+
 /**
  * Configuration handler, used to register a config item/subtree.
  */
@@ -165,6 +196,32 @@ struct conf_handler {
     conf_commit_handler_t ch_commit;
     /** Export configuration value */
     conf_export_handler_t ch_export;
+    /**
+     * Set configuration value from binary form (optional).  Values loaded
+     * from persisted storage still arrive as strings through ch_set.
+     */
+    conf_set_typed_handler_t ch_set_typed;
+    /** Get configuration value in binary form (optional) */
+    conf_get_typed_handler_t ch_get_typed;
+
+    /** @cond INTERNAL_HIDDEN */
+    uint32_t ch_name_hash;
+    /** @endcond */
+};
+
+/**
+ * One setting in a batch passed to conf_save_batch().
+ */
+struct conf_batch_ent {
+    /** Name/key of the configuration item */
+    const char *cbe_name;
+    /** Value of the configuration item; NULL deletes it */
+    const char *cbe_value;
+
+    /** @cond INTERNAL_HIDDEN */
+    uint32_t cbe_hash;
+    uint8_t cbe_state;
+    /** @endcond */
 };
 
 void conf_init(void);
@@ -240,6 +297,22 @@ int conf_save_tree(char *name);
  */
 int conf_save_one(const char *name, char *var);
 
+/**
+ * Write several configuration values to persisted storage in one pass.
+ * Stored values are scanned once for the whole batch, and only entries that
+ * differ from them are written.  If a name appears more than once, the last
+ * entry wins.
+ *
+ * The writes are bracketed like a conf_save(), so stores which buffer
+ * records (FCB2 with write combining) push the batch to flash in one burst.
+ *
+ * @param ents Settings to save.
+ * @param cnt Number of entries in @p ents.
+ *
+ * @return 0 on success, non-zero on failure.
+ */
+int conf_save_batch(struct conf_batch_ent *ents, int cnt);
+
 /**
  * Set configuration item identified by @p name to be value @p val_str.
  * This finds the configuration handler for this subtree and calls it's
@@ -269,6 +342,36 @@ int conf_set_value(char *name, char *val_str);
  */
 char *conf_get_value(char *name, char *buf, int buf_len);
 
+/**
+ * Set configuration item identified by @p name from a value in its native
+ * binary form.  If the subtree's handler has a ch_set_typed handler the value
+ * is passed as is, otherwise it is converted to a string for ch_set.
+ *
+ * @param name Name/key of the configuration item.
+ * @param type Type of the value.
+ * @param val Pointer to the value; for CONF_STRING, the string.
+ * @param val_len Size of the value in bytes.
+ *
+ * @return 0 on success, non-zero on failure.
+ */
+int conf_set_value_typed(char *name, enum conf_type type, const void *val,
+  int val_len);
+
+/**
+ * Get value of configuration item identified by @p name in its native
+ * binary form.  Uses ch_get_typed if the subtree's handler has one,
+ * otherwise converts the string returned by ch_get.
+ *
+ * @param name Name/key of the configuration item.
+ * @param type Type of the value.
+ * @param val Buffer to copy the value into.
+ * @param val_len Size of the buffer; on return the size of the value.
+ *
+ * @return 0 on success, non-zero on failure.
+ */
+int conf_get_value_typed(char *name, enum conf_type type, void *val,
+  int *val_len);
+
 /**
  * Get stored value of configuration item identified by @p name.
  * This traverses the configuration area(s), and copies the value
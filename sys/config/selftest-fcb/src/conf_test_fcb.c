@@ -356,6 +356,7 @@ conf_test_fcb_pre_test3(void *arg)
 TEST_SUITE(config_test_c0)
 {
     config_empty_lookups();
+    config_test_compress_bg_fcb();
 }
 
 TEST_SUITE(config_test_c1)
@@ -366,6 +367,7 @@ TEST_SUITE(config_test_c1)
     config_test_getset_int();
     config_test_getset_bytes();
     config_test_getset_int64();
+    config_test_getset_typed();
 
     config_test_commit();
 
@@ -382,6 +384,8 @@ TEST_SUITE(config_test_c2)
 
     config_test_save_one_fcb();
     config_test_get_stored_fcb();
+    config_test_load_dedup_fcb();
+    config_test_save_batch_fcb();
 }
 
 TEST_SUITE(config_test_c3)
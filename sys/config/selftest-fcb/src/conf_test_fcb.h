@@ -88,6 +88,7 @@ TEST_CASE_DECL(config_test_getset_unknown)
 TEST_CASE_DECL(config_test_getset_int)
 TEST_CASE_DECL(config_test_getset_bytes)
 TEST_CASE_DECL(config_test_getset_int64)
+TEST_CASE_DECL(config_test_getset_typed)
 TEST_CASE_DECL(config_test_commit)
 TEST_CASE_DECL(config_test_empty_fcb)
 TEST_CASE_DECL(config_test_save_1_fcb)
@@ -97,6 +98,9 @@ TEST_CASE_DECL(config_test_compress_reset)
 TEST_CASE_DECL(config_test_save_one_fcb)
 TEST_CASE_DECL(config_test_custom_compress)
 TEST_CASE_DECL(config_test_get_stored_fcb)
+TEST_CASE_DECL(config_test_load_dedup_fcb)
+TEST_CASE_DECL(config_test_save_batch_fcb)
+TEST_CASE_DECL(config_test_compress_bg_fcb)
 
 #ifdef __cplusplus
 }
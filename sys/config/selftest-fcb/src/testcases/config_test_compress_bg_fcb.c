@@ -0,0 +1,119 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "conf_test_fcb.h"
+#include "config/config_generic_kv.h"
+
+#if MYNEWT_VAL(CONFIG_FCB_COMPRESS_RESERVE) && MYNEWT_VAL(OS_SCHEDULING)
+#define CONF_TEST_BG_KEYS   8
+
+static struct flash_area *bg_oldest;
+static int bg_erases;
+
+/*
+ * Runs the background compaction the save queued up, and counts the
+ * sectors erased so far: each one is erased when it stops being the oldest.
+ */
+static void
+config_test_compress_bg_run(struct conf_fcb *cf)
+{
+    struct os_event *ev;
+
+    while ((ev = os_eventq_get_no_wait(os_eventq_dflt_get())) != NULL) {
+        ev->ev_cb(ev);
+    }
+    bg_erases += (cf->cf_fcb.f_oldest - bg_oldest + CONF_TEST_FCB_FLASH_CNT) %
+      CONF_TEST_FCB_FLASH_CNT;
+    bg_oldest = cf->cf_fcb.f_oldest;
+}
+
+static void
+config_test_compress_bg_init(struct conf_fcb *cf)
+{
+    int rc;
+
+    config_wipe_srcs();
+    config_wipe_fcb(fcb_areas, sizeof(fcb_areas) / sizeof(fcb_areas[0]));
+
+    memset(cf, 0, sizeof(*cf));
+    cf->cf_fcb.f_magic = MYNEWT_VAL(CONFIG_FCB_MAGIC);
+    cf->cf_fcb.f_sectors = fcb_areas;
+    cf->cf_fcb.f_sector_cnt = sizeof(fcb_areas) / sizeof(fcb_areas[0]);
+
+    rc = conf_fcb_src(cf);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    bg_oldest = cf->cf_fcb.f_oldest;
+    bg_erases = 0;
+}
+#endif
+
+TEST_CASE_SELF(config_test_compress_bg_fcb)
+{
+#if MYNEWT_VAL(CONFIG_FCB_COMPRESS_RESERVE) && MYNEWT_VAL(OS_SCHEDULING)
+    static struct conf_fcb cf;
+    char name[16];
+    char val[40];
+    char buf[40];
+    uint32_t written;
+    int rc;
+    int i;
+
+    /*
+     * Nothing in the oldest sector is superseded: below the reserve, it is
+     * left alone.
+     */
+    config_test_compress_bg_init(&cf);
+    for (i = 0; cf.cf_fcb.f_active.fe_area != &fcb_areas[2]; i++) {
+        snprintf(name, sizeof(name), "bg/d%d", i);
+        snprintf(val, sizeof(val), "%032d", i);
+        rc = cf.cf_store.cs_itf->csi_save(&cf.cf_store, name, val);
+        TEST_ASSERT_FATAL(rc == 0);
+        config_test_compress_bg_run(&cf);
+    }
+    TEST_ASSERT(fcb_free_sector_cnt(&cf.cf_fcb) == 1);
+    TEST_ASSERT(bg_erases == 0);
+
+    /*
+     * The same few names over and over: a sector is erased only once
+     * that much has been written since, not after every save.
+     */
+    config_test_compress_bg_init(&cf);
+    written = 0;
+    for (i = 0; i < 2000; i++) {
+        snprintf(name, sizeof(name), "bg/k%d", i % CONF_TEST_BG_KEYS);
+        snprintf(val, sizeof(val), "%032d", i);
+        rc = cf.cf_store.cs_itf->csi_save(&cf.cf_store, name, val);
+        TEST_ASSERT_FATAL(rc == 0);
+        written += strlen(name) + 1 + strlen(val) + 2;
+        config_test_compress_bg_run(&cf);
+    }
+    TEST_ASSERT(bg_erases > 0);
+    TEST_ASSERT(bg_erases <= written / fcb_areas[0].fa_size + 2,
+                "%d erases for %u bytes", bg_erases, (unsigned)written);
+
+    for (i = 2000 - CONF_TEST_BG_KEYS; i < 2000; i++) {
+        snprintf(name, sizeof(name), "bg/k%d", i % CONF_TEST_BG_KEYS);
+        snprintf(val, sizeof(val), "%032d", i);
+        memset(buf, 0, sizeof(buf));
+        rc = conf_fcb_kv_load(&cf.cf_fcb, name, buf, sizeof(buf));
+        TEST_ASSERT(rc == 0);
+        TEST_ASSERT(!strcmp(buf, val));
+    }
+#endif
+}
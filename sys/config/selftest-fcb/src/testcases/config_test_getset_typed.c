@@ -0,0 +1,110 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "conf_test_fcb.h"
+
+static int16_t typed_val16;
+static int typed_set_called;
+
+static int
+ctest_typed_set(int argc, char **argv, enum conf_type type, const void *val,
+                int val_len)
+{
+    typed_set_called = 1;
+    if (argc == 1 && !strcmp(argv[0], "v") && type == CONF_INT16 &&
+        val_len == sizeof(typed_val16)) {
+        memcpy(&typed_val16, val, sizeof(typed_val16));
+        return 0;
+    }
+    return OS_ENOENT;
+}
+
+static int
+ctest_typed_get(int argc, char **argv, enum conf_type type, void *val,
+                int *val_len)
+{
+    if (argc == 1 && !strcmp(argv[0], "v") && type == CONF_INT16 &&
+        *val_len >= sizeof(typed_val16)) {
+        memcpy(val, &typed_val16, sizeof(typed_val16));
+        *val_len = sizeof(typed_val16);
+        return 0;
+    }
+    return OS_ENOENT;
+}
+
+static struct conf_handler ctest_typed_handler = {
+    .ch_name = "typed",
+    .ch_set_typed = ctest_typed_set,
+    .ch_get_typed = ctest_typed_get,
+};
+
+TEST_CASE_SELF(config_test_getset_typed)
+{
+    char name[80];
+    int64_t v64;
+    int16_t v16;
+    uint8_t v8;
+    int len;
+    int rc;
+
+    /* Handler with string interface only, value converted for it. */
+    v8 = 42;
+    strcpy(name, "myfoo/mybar");
+    rc = conf_set_value_typed(name, CONF_INT8, &v8, sizeof(v8));
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(test_set_called == 1);
+    TEST_ASSERT(val8 == 42);
+    ctest_clear_call_state();
+
+    v64 = 0;
+    len = sizeof(v64);
+    strcpy(name, "myfoo/mybar64");
+    val64 = 0x123456789;
+    rc = conf_get_value_typed(name, CONF_INT64, &v64, &len);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(test_get_called == 1);
+    TEST_ASSERT(v64 == 0x123456789);
+    ctest_clear_call_state();
+
+    /* Handler with binary interface, no strings involved. */
+    rc = conf_register(&ctest_typed_handler);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    v16 = -1234;
+    strcpy(name, "typed/v");
+    rc = conf_set_value_typed(name, CONF_INT16, &v16, sizeof(v16));
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(typed_set_called == 1);
+    TEST_ASSERT(typed_val16 == -1234);
+
+    v16 = 0;
+    len = sizeof(v16);
+    strcpy(name, "typed/v");
+    rc = conf_get_value_typed(name, CONF_INT16, &v16, &len);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(len == sizeof(v16));
+    TEST_ASSERT(v16 == -1234);
+
+    strcpy(name, "typed/nope");
+    rc = conf_set_value_typed(name, CONF_INT16, &v16, sizeof(v16));
+    TEST_ASSERT(rc != 0);
+
+    strcpy(name, "nosuch/v");
+    rc = conf_set_value_typed(name, CONF_INT16, &v16, sizeof(v16));
+    TEST_ASSERT(rc != 0);
+}
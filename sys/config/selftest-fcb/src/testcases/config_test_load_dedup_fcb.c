@@ -0,0 +1,76 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "conf_test_fcb.h"
+
+static int dedup_cb_cnt;
+static char dedup_last_bar[8];
+
+static void
+config_test_dedup_cb(char *name, char *val, void *cb_arg)
+{
+    dedup_cb_cnt++;
+    if (!strcmp(name, "myfoo/mybar")) {
+        strncpy(dedup_last_bar, val, sizeof(dedup_last_bar) - 1);
+    }
+}
+
+TEST_CASE_SELF(config_test_load_dedup_fcb)
+{
+    struct conf_fcb cf;
+    char val[8];
+    int rc;
+    int i;
+
+    config_wipe_srcs();
+    config_wipe_fcb(fcb_areas, sizeof(fcb_areas) / sizeof(fcb_areas[0]));
+
+    cf.cf_fcb.f_magic = MYNEWT_VAL(CONFIG_FCB_MAGIC);
+    cf.cf_fcb.f_sectors = fcb_areas;
+    cf.cf_fcb.f_sector_cnt = sizeof(fcb_areas) / sizeof(fcb_areas[0]);
+
+    rc = conf_fcb_src(&cf);
+    TEST_ASSERT(rc == 0);
+
+    rc = conf_fcb_dst(&cf);
+    TEST_ASSERT(rc == 0);
+
+    for (i = 1; i <= 5; i++) {
+        snprintf(val, sizeof(val), "%d", i);
+        rc = conf_save_one("myfoo/mybar", val);
+        TEST_ASSERT(rc == 0);
+    }
+    rc = conf_save_one("myfoo/mybar64", "7");
+    TEST_ASSERT(rc == 0);
+
+    dedup_cb_cnt = 0;
+    rc = cf.cf_store.cs_itf->csi_load(&cf.cf_store, config_test_dedup_cb,
+                                      NULL);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(!strcmp(dedup_last_bar, "5"));
+#if MYNEWT_VAL(CONFIG_FCB_LOAD_DEDUP)
+    TEST_ASSERT(dedup_cb_cnt == 2);
+#else
+    TEST_ASSERT(dedup_cb_cnt == 6);
+#endif
+
+    rc = conf_load();
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(val8 == 5);
+    TEST_ASSERT(val64 == 7);
+}
@@ -0,0 +1,76 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "conf_test_fcb.h"
+
+static int batch_rec_cnt;
+
+static void
+config_test_batch_cb(char *name, char *val, void *cb_arg)
+{
+    batch_rec_cnt++;
+}
+
+TEST_CASE_SELF(config_test_save_batch_fcb)
+{
+    struct conf_batch_ent ents[] = {
+        { .cbe_name = "myfoo/mybar", .cbe_value = "1" },
+        { .cbe_name = "myfoo/mybar64", .cbe_value = "9" },
+        { .cbe_name = "myfoo/mybar", .cbe_value = "3" },
+    };
+    struct conf_fcb cf;
+    int rc;
+
+    config_wipe_srcs();
+    config_wipe_fcb(fcb_areas, sizeof(fcb_areas) / sizeof(fcb_areas[0]));
+
+    cf.cf_fcb.f_magic = MYNEWT_VAL(CONFIG_FCB_MAGIC);
+    cf.cf_fcb.f_sectors = fcb_areas;
+    cf.cf_fcb.f_sector_cnt = sizeof(fcb_areas) / sizeof(fcb_areas[0]);
+
+    rc = conf_fcb_src(&cf);
+    TEST_ASSERT(rc == 0);
+
+    rc = conf_fcb_dst(&cf);
+    TEST_ASSERT(rc == 0);
+
+    /* The first mybar entry is superseded and never written. */
+    rc = conf_save_batch(ents, sizeof(ents) / sizeof(ents[0]));
+    TEST_ASSERT(rc == 0);
+
+    batch_rec_cnt = 0;
+    rc = cf.cf_store.cs_itf->csi_load(&cf.cf_store, config_test_batch_cb,
+                                      NULL);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(batch_rec_cnt == 2);
+
+    rc = conf_load();
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(val8 == 3);
+    TEST_ASSERT(val64 == 9);
+
+    /* Values already stored are not written again. */
+    rc = conf_save_batch(ents, sizeof(ents) / sizeof(ents[0]));
+    TEST_ASSERT(rc == 0);
+
+    batch_rec_cnt = 0;
+    rc = cf.cf_store.cs_itf->csi_load(&cf.cf_store, config_test_batch_cb,
+                                      NULL);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(batch_rec_cnt == 2);
+}
@@ -81,9 +81,23 @@ conf_unlock(void)
     os_mutex_release(&conf_mtx);
 }
 
+uint32_t
+conf_name_hash(const char *name)
+{
+    uint32_t hash;
+
+    hash = 5381;
+    while (*name) {
+        hash = (hash << 5) + hash + (uint8_t)*name++;
+    }
+    return hash;
+}
+
 int
 conf_register(struct conf_handler *handler)
 {
+    handler->ch_name_hash = conf_name_hash(handler->ch_name);
+
     conf_lock();
     SLIST_INSERT_HEAD(&conf_handlers, handler, ch_list);
     conf_unlock();
@@ -105,9 +119,11 @@ struct conf_handler *
 conf_handler_lookup(char *name)
 {
     struct conf_handler *ch;
+    uint32_t hash;
 
+    hash = conf_name_hash(name);
     SLIST_FOREACH(ch, &conf_handlers, ch_list) {
-        if (!strcmp(name, ch->ch_name)) {
+        if (ch->ch_name_hash == hash && !strcmp(name, ch->ch_name)) {
             return ch;
         }
     }
@@ -277,7 +293,7 @@ conf_set_value(char *name, char *val_str)
 
     conf_lock();
     ch = conf_parse_and_lookup(name, &name_argc, name_argv);
-    if (!ch) {
+    if (!ch || !ch->ch_set) {
         rc = OS_INVALID_PARM;
         goto out;
     }
@@ -287,6 +303,89 @@ out:
     return rc;
 }
 
+int
+conf_set_value_typed(char *name, enum conf_type type, const void *val,
+  int val_len)
+{
+    int name_argc;
+    char *name_argv[CONF_MAX_DIR_DEPTH];
+    struct conf_handler *ch;
+    char buf[CONF_MAX_VAL_LEN + 1];
+    char *str;
+    int rc;
+
+    conf_lock();
+    ch = conf_parse_and_lookup(name, &name_argc, name_argv);
+    if (!ch) {
+        rc = OS_INVALID_PARM;
+        goto out;
+    }
+    if (ch->ch_set_typed) {
+        rc = ch->ch_set_typed(name_argc - 1, &name_argv[1], type, val,
+                              val_len);
+        goto out;
+    }
+
+    if (type == CONF_BYTES) {
+        str = conf_str_from_bytes((void *)val, val_len, buf, sizeof(buf));
+    } else {
+        str = conf_str_from_value(type, (void *)val, buf, sizeof(buf));
+    }
+    if (!str || !ch->ch_set) {
+        rc = OS_INVALID_PARM;
+        goto out;
+    }
+    rc = ch->ch_set(name_argc - 1, &name_argv[1], str);
+out:
+    conf_unlock();
+    return rc;
+}
+
+int
+conf_get_value_typed(char *name, enum conf_type type, void *val,
+  int *val_len)
+{
+    int name_argc;
+    char *name_argv[CONF_MAX_DIR_DEPTH];
+    struct conf_handler *ch;
+    char buf[CONF_MAX_VAL_LEN + 1];
+    char *str;
+    int rc;
+
+    conf_lock();
+    ch = conf_parse_and_lookup(name, &name_argc, name_argv);
+    if (!ch) {
+        rc = OS_INVALID_PARM;
+        goto out;
+    }
+    if (ch->ch_get_typed) {
+        rc = ch->ch_get_typed(name_argc - 1, &name_argv[1], type, val,
+                              val_len);
+        goto out;
+    }
+    if (!ch->ch_get) {
+        rc = OS_INVALID_PARM;
+        goto out;
+    }
+
+    str = ch->ch_get(name_argc - 1, &name_argv[1], buf, sizeof(buf));
+    if (!str) {
+        rc = OS_INVALID_PARM;
+        goto out;
+    }
+    if (type == CONF_BYTES) {
+        rc = conf_bytes_from_str(str, val, val_len);
+    } else {
+        rc = conf_value_from_str(str, type, val, *val_len);
+        if (rc == 0 && type == CONF_STRING) {
+            *val_len = strlen(val);
+        }
+    }
+out:
+    conf_unlock();
+    return rc;
+}
+
 /*
  * Get value in printable string form. If value is not string, the value
  * will be filled in *buf.
@@ -43,6 +43,32 @@ struct conf_kv_load_cb_arg {
     size_t len;
 };
 
+#if MYNEWT_VAL(CONFIG_FCB_LOAD_DEDUP)
+/*
+ * Latest FCB record seen for a config name during a deduplicating load.
+ */
+struct conf_fcb_dedup_ent {
+    uint32_t cde_hash;
+    struct fcb_entry cde_loc;
+};
+
+static struct conf_fcb_dedup_ent
+    conf_fcb_dedup[MYNEWT_VAL(CONFIG_FCB_LOAD_DEDUP)];
+static int conf_fcb_dedup_cnt;
+static bool conf_fcb_dedup_busy;
+
+/* Returned from the walk callback when the table is full */
+#define CONF_FCB_DEDUP_FULL     1
+#endif
+
+#if MYNEWT_VAL(CONFIG_FCB_COMPRESS_RESERVE) && MYNEWT_VAL(OS_SCHEDULING)
+static os_event_fn conf_fcb_compress_ev_fn;
+
+static struct os_event conf_fcb_compress_ev = {
+    .ev_cb = conf_fcb_compress_ev_fn,
+};
+#endif
+
 static int conf_fcb_load(struct conf_store *, conf_store_load_cb cb,
                          void *cb_arg);
 static int conf_fcb_save(struct conf_store *, const char *name,
@@ -98,6 +124,30 @@ conf_fcb_dst(struct conf_fcb *cf)
     return OS_OK;
 }
 
+/*
+ * Reads record at loc into buf and splits it into name and value.
+ */
+static int
+conf_fcb_line_read(struct fcb_entry *loc, char *buf, int buf_len,
+                   char **name_str, char **val_str)
+{
+    int rc;
+    int len;
+
+    len = loc->fe_data_len;
+    if (len >= buf_len) {
+        len = buf_len - 1;
+    }
+
+    rc = flash_area_read(loc->fe_area, loc->fe_data_off, buf, len);
+    if (rc) {
+        return rc;
+    }
+    buf[len] = '\0';
+
+    return conf_line_parse(buf, name_str, val_str);
+}
+
 static int
 conf_fcb_load_cb(struct fcb_entry *loc, void *arg)
 {
@@ -106,28 +156,85 @@ conf_fcb_load_cb(struct fcb_entry *loc, void *arg)
     char *name_str;
     char *val_str;
     int rc;
-    int len;
 
     argp = (struct conf_fcb_load_cb_arg *)arg;
 
-    len = loc->fe_data_len;
-    if (len >= sizeof(buf)) {
-        len = sizeof(buf) - 1;
+    rc = conf_fcb_line_read(loc, buf, sizeof(buf), &name_str, &val_str);
+    if (rc) {
+        return 0;
     }
+    argp->cb(name_str, val_str, argp->cb_arg);
+    return 0;
+}
 
-    rc = flash_area_read(loc->fe_area, loc->fe_data_off, buf, len);
+#if MYNEWT_VAL(CONFIG_FCB_LOAD_DEDUP)
+/*
+ * First pass of a deduplicating load: remember the latest record of every
+ * name.  Names are kept in the order they first appear.
+ */
+static int
+conf_fcb_dedup_cb(struct fcb_entry *loc, void *arg)
+{
+    struct conf_fcb_dedup_ent *cde;
+    char buf[CONF_MAX_NAME_LEN + CONF_MAX_VAL_LEN + 32];
+    char buf2[CONF_MAX_NAME_LEN + CONF_MAX_VAL_LEN + 32];
+    char *name_str;
+    char *name2;
+    char *val_str;
+    uint32_t hash;
+    int rc;
+    int i;
+
+    rc = conf_fcb_line_read(loc, buf, sizeof(buf), &name_str, &val_str);
     if (rc) {
         return 0;
     }
-    buf[len] = '\0';
+    hash = conf_name_hash(name_str);
 
-    rc = conf_line_parse(buf, &name_str, &val_str);
+    for (i = 0; i < conf_fcb_dedup_cnt; i++) {
+        cde = &conf_fcb_dedup[i];
+        if (cde->cde_hash != hash) {
+            continue;
+        }
+        rc = conf_fcb_line_read(&cde->cde_loc, buf2, sizeof(buf2), &name2,
+                                &val_str);
+        if (rc == 0 && !strcmp(name_str, name2)) {
+            cde->cde_loc = *loc;
+            return 0;
+        }
+    }
+
+    if (conf_fcb_dedup_cnt >= MYNEWT_VAL(CONFIG_FCB_LOAD_DEDUP)) {
+        return CONF_FCB_DEDUP_FULL;
+    }
+    cde = &conf_fcb_dedup[conf_fcb_dedup_cnt++];
+    cde->cde_hash = hash;
+    cde->cde_loc = *loc;
+    return 0;
+}
+
+/*
+ * Applies only the latest value of every name.  Returns CONF_FCB_DEDUP_FULL
+ * without calling cb if there are too many names to track.
+ */
+static int
+conf_fcb_load_dedup(struct conf_fcb *cf, struct conf_fcb_load_cb_arg *arg)
+{
+    int rc;
+    int i;
+
+    conf_fcb_dedup_cnt = 0;
+    rc = fcb_walk(&cf->cf_fcb, 0, conf_fcb_dedup_cb, NULL);
     if (rc) {
-        return 0;
+        return rc;
+    }
+
+    for (i = 0; i < conf_fcb_dedup_cnt; i++) {
+        conf_fcb_load_cb(&conf_fcb_dedup[i].cde_loc, arg);
     }
-    argp->cb(name_str, val_str, argp->cb_arg);
     return 0;
 }
+#endif
 
 static int
 conf_fcb_load(struct conf_store *cs, conf_store_load_cb cb, void *cb_arg)
@@ -138,6 +245,22 @@ conf_fcb_load(struct conf_store *cs, conf_store_load_cb cb, void *cb_arg)
 
     arg.cb = cb;
     arg.cb_arg = cb_arg;
+
+#if MYNEWT_VAL(CONFIG_FCB_LOAD_DEDUP)
+    /*
+     * Table is shared; a handler saving config while it is being applied
+     * gets the plain walk.
+     */
+    if (!conf_fcb_dedup_busy) {
+        conf_fcb_dedup_busy = true;
+        rc = conf_fcb_load_dedup(cf, &arg);
+        conf_fcb_dedup_busy = false;
+        if (rc != CONF_FCB_DEDUP_FULL) {
+            return rc ? OS_EINVAL : OS_OK;
+        }
+    }
+#endif
+
     rc = fcb_walk(&cf->cf_fcb, 0, conf_fcb_load_cb, &arg);
     if (rc) {
         return OS_EINVAL;
@@ -159,24 +282,60 @@ conf_fcb_var_read(struct fcb_entry *loc, char *buf, char **name, char **val)
     return rc;
 }
 
+/*
+ * Tells whether the entry at loc has to be kept when its sector is
+ * compacted: it is not a delete and no later entry has the same name.
+ * Reads the entry into buf; name and val point into it.
+ */
+static int
+conf_fcb_entry_live(struct fcb *fcb, struct fcb_entry *loc, char *buf,
+                    char **name, char **val)
+{
+    char buf2[CONF_MAX_NAME_LEN + CONF_MAX_VAL_LEN + 32];
+    struct fcb_entry loc2;
+    char *name2, *val2;
+    int rc;
+
+    rc = conf_fcb_var_read(loc, buf, name, val);
+    if (rc || !*val) {
+        return 0;
+    }
+    loc2 = *loc;
+    while (fcb_getnext(fcb, &loc2) == 0) {
+        rc = conf_fcb_var_read(&loc2, buf2, &name2, &val2);
+        if (rc) {
+            continue;
+        }
+        if (!strcmp(*name, name2)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*
+ * Copies the live entries of the oldest sector to the head and erases it.
+ * With to_scratch, the copies go to a new sector, which may be the scratch
+ * sector; otherwise they go to the active sector, and the oldest one is
+ * kept if any of them cannot be written.
+ */
 static void
 conf_fcb_compress_internal(struct fcb *fcb,
                            int (*copy_or_not)(const char *name, const char *val,
                                               void *cn_arg),
-                           void *cn_arg)
+                           void *cn_arg, int to_scratch)
 {
     int rc;
     char buf1[CONF_MAX_NAME_LEN + CONF_MAX_VAL_LEN + 32];
-    char buf2[CONF_MAX_NAME_LEN + CONF_MAX_VAL_LEN + 32];
     struct fcb_entry loc1;
     struct fcb_entry loc2;
     char *name1, *val1;
-    char *name2, *val2;
-    int copy;
 
-    rc = fcb_append_to_scratch(fcb);
-    if (rc) {
-        return; /* XXX */
+    if (to_scratch) {
+        rc = fcb_append_to_scratch(fcb);
+        if (rc) {
+            return; /* XXX */
+        }
     }
 
     loc1.fe_area = NULL;
@@ -185,26 +344,7 @@ conf_fcb_compress_internal(struct fcb *fcb,
         if (loc1.fe_area != fcb->f_oldest) {
             break;
         }
-        rc = conf_fcb_var_read(&loc1, buf1, &name1, &val1);
-        if (rc) {
-            continue;
-        }
-        if (!val1) {
-            continue;
-        }
-        loc2 = loc1;
-        copy = 1;
-        while (fcb_getnext(fcb, &loc2) == 0) {
-            rc = conf_fcb_var_read(&loc2, buf2, &name2, &val2);
-            if (rc) {
-                continue;
-            }
-            if (!strcmp(name1, name2)) {
-                copy = 0;
-                break;
-            }
-        }
-        if (!copy) {
+        if (!conf_fcb_entry_live(fcb, &loc1, buf1, &name1, &val1)) {
             continue;
         }
 
@@ -219,16 +359,17 @@ conf_fcb_compress_internal(struct fcb *fcb,
          */
         rc = flash_area_read(loc1.fe_area, loc1.fe_data_off, buf1,
           loc1.fe_data_len);
-        if (rc) {
-            continue;
+        if (rc == 0) {
+            rc = fcb_append(fcb, loc1.fe_data_len, &loc2);
         }
-        rc = fcb_append(fcb, loc1.fe_data_len, &loc2);
-        if (rc) {
-            continue;
+        if (rc == 0) {
+            rc = flash_area_write(loc2.fe_area, loc2.fe_data_off, buf1,
+              loc1.fe_data_len);
         }
-        rc = flash_area_write(loc2.fe_area, loc2.fe_data_off, buf1,
-          loc1.fe_data_len);
         if (rc) {
+            if (!to_scratch) {
+                return;
+            }
             continue;
         }
         fcb_append_finish(fcb, &loc2);
@@ -255,7 +396,7 @@ conf_fcb_append(struct fcb *fcb, char *buf, int len)
         if (fcb->f_scratch_cnt == 0) {
             return OS_ENOMEM;
         }
-        conf_fcb_compress_internal(fcb, NULL, NULL);
+        conf_fcb_compress_internal(fcb, NULL, NULL, 1);
     }
     if (rc) {
         return OS_EINVAL;
@@ -268,12 +409,121 @@ conf_fcb_append(struct fcb *fcb, char *buf, int len)
     return OS_OK;
 }
 
+#if MYNEWT_VAL(CONFIG_FCB_COMPRESS_RESERVE) && MYNEWT_VAL(OS_SCHEDULING)
+/*
+ * Whether fcb has fewer free sectors than the reserve kept on top of
+ * the scratch sector.
+ */
+static int
+conf_fcb_below_reserve(struct fcb *fcb)
+{
+    if (fcb->f_scratch_cnt == 0 || fcb->f_oldest == fcb->f_active.fe_area) {
+        return 0;
+    }
+    return fcb_free_sector_cnt(fcb) <
+      fcb->f_scratch_cnt + MYNEWT_VAL(CONFIG_FCB_COMPRESS_RESERVE);
+}
+
+/*
+ * Rounds len up to the flash write alignment of fcb.
+ */
+static uint32_t
+conf_fcb_align(struct fcb *fcb, uint32_t len)
+{
+    if (fcb->f_align <= 1) {
+        return len;
+    }
+    return (len + fcb->f_align - 1) / fcb->f_align * fcb->f_align;
+}
+
+/*
+ * Whether compacting the oldest sector reclaims it: some of its entries
+ * are dead, and the live ones fit in what is left of the active sector.
+ * Entries take a length of 1 or 2 bytes, the data and a CRC byte, each
+ * aligned on its own.
+ */
+static int
+conf_fcb_can_reclaim(struct fcb *fcb)
+{
+    char buf[CONF_MAX_NAME_LEN + CONF_MAX_VAL_LEN + 32];
+    struct fcb_entry loc;
+    char *name, *val;
+    uint32_t live_len;
+    int dead_cnt;
+
+    live_len = 0;
+    dead_cnt = 0;
+    loc.fe_area = NULL;
+    loc.fe_elem_off = 0;
+    while (fcb_getnext(fcb, &loc) == 0) {
+        if (loc.fe_area != fcb->f_oldest) {
+            break;
+        }
+        if (conf_fcb_entry_live(fcb, &loc, buf, &name, &val)) {
+            live_len += conf_fcb_align(fcb, loc.fe_data_len < 0x80 ? 1 : 2) +
+              conf_fcb_align(fcb, loc.fe_data_len) + conf_fcb_align(fcb, 1);
+        } else {
+            dead_cnt++;
+        }
+    }
+    return dead_cnt > 0 && live_len <=
+      fcb->f_active.fe_area->fa_size - fcb->f_active.fe_elem_off;
+}
+
+/*
+ * Compacts the oldest sector from the default event queue. One sector is
+ * done per event, so a save waits for at most one sector's worth of
+ * copying. Live entries are copied to the active sector, never to a new
+ * one, so every sector erased here is one more free sector; when the oldest
+ * sector has nothing to drop or its live entries do not fit, it is left
+ * for the inline compress in conf_fcb_append.
+ */
+static void
+conf_fcb_compress_ev_fn(struct os_event *ev)
+{
+    struct flash_area *oldest;
+    struct fcb *fcb;
+
+    fcb = ev->ev_arg;
+
+    conf_lock();
+    if (conf_fcb_below_reserve(fcb) && conf_fcb_can_reclaim(fcb)) {
+        oldest = fcb->f_oldest;
+        conf_fcb_compress_internal(fcb, NULL, NULL, 0);
+
+        if (fcb->f_oldest != oldest && conf_fcb_below_reserve(fcb)) {
+            os_eventq_put(os_eventq_dflt_get(), ev);
+        }
+    }
+    conf_unlock();
+}
+
+static void
+conf_fcb_compress_kick(struct fcb *fcb)
+{
+    if (OS_EVENT_QUEUED(&conf_fcb_compress_ev)) {
+        return;
+    }
+    if (conf_fcb_below_reserve(fcb)) {
+        conf_fcb_compress_ev.ev_arg = fcb;
+        os_eventq_put(os_eventq_dflt_get(), &conf_fcb_compress_ev);
+    }
+}
+#endif
+
 static int
 conf_fcb_save(struct conf_store *cs, const char *name, const char *value)
 {
     struct conf_fcb *cf = (struct conf_fcb *)cs;
+    int rc;
 
-    return conf_fcb_kv_save(&cf->cf_fcb, name, value);
+    rc = conf_fcb_kv_save(&cf->cf_fcb, name, value);
+#if MYNEWT_VAL(CONFIG_FCB_COMPRESS_RESERVE) && MYNEWT_VAL(OS_SCHEDULING)
+    if (rc == 0) {
+        conf_fcb_compress_kick(&cf->cf_fcb);
+    }
+#endif
+    return rc;
 }
 
 void
@@ -282,7 +532,7 @@ conf_fcb_compress(struct conf_fcb *cf,
                                      void *cn_arg),
                   void *cn_arg)
 {
-    conf_fcb_compress_internal(&cf->cf_fcb, copy_or_not, cn_arg);
+    conf_fcb_compress_internal(&cf->cf_fcb, copy_or_not, cn_arg, 1);
 }
 
 static int
@@ -45,14 +45,24 @@ struct conf_kv_load_cb_arg {
 
 static int conf_fcb2_load(struct conf_store *, conf_store_load_cb cb,
                           void *cb_arg);
+static int conf_fcb2_save_start(struct conf_store *);
 static int conf_fcb2_save(struct conf_store *, const char *name,
                           const char *value);
+static int conf_fcb2_save_end(struct conf_store *);
 
 static struct conf_store_itf conf_fcb2_itf = {
     .csi_load = conf_fcb2_load,
+    .csi_save_start = conf_fcb2_save_start,
     .csi_save = conf_fcb2_save,
+    .csi_save_end = conf_fcb2_save_end,
 };
 
+/*
+ * Set between csi_save_start and csi_save_end; records are flushed once,
+ * at the end of the save.
+ */
+static bool conf_fcb2_saving;
+
 int
 conf_fcb2_src(struct conf_fcb2 *cf)
 {
@@ -238,7 +248,7 @@ conf_fcb2_compress_internal(struct fcb2 *fcb,
 }
 
 static int
-conf_fcb2_append(struct fcb2 *fcb, char *buf, int len)
+conf_fcb2_append(struct fcb2 *fcb, char *buf, int len, bool flush)
 {
     int rc;
     int i;
@@ -262,6 +272,38 @@ conf_fcb2_append(struct fcb2 *fcb, char *buf, int len)
         return OS_EINVAL;
     }
     fcb2_append_finish(&loc);
+    if (flush) {
+        /* Settings must survive a reset right after they are saved. */
+        rc = fcb2_flush(fcb);
+        if (rc) {
+            return OS_EINVAL;
+        }
+    }
+    return OS_OK;
+}
+
+static int
+conf_fcb2_line_save(struct fcb2 *fcb, const char *name, const char *value,
+                    bool flush)
+{
+    char buf[CONF_MAX_NAME_LEN + CONF_MAX_VAL_LEN + 32];
+    int len;
+
+    if (!name) {
+        return OS_INVALID_PARM;
+    }
+
+    len = conf_line_make(buf, sizeof(buf), name, value);
+    if (len < 0 || len + 2 > sizeof(buf)) {
+        return OS_INVALID_PARM;
+    }
+    return conf_fcb2_append(fcb, buf, len, flush);
+}
+
+static int
+conf_fcb2_save_start(struct conf_store *cs)
+{
+    conf_fcb2_saving = true;
     return OS_OK;
 }
 
@@ -270,7 +312,19 @@ conf_fcb2_save(struct conf_store *cs, const char *name, const char *value)
 {
     struct conf_fcb2 *cf = (struct conf_fcb2 *)cs;
 
-    return conf_fcb2_kv_save(&cf->cf2_fcb, name, value);
+    return conf_fcb2_line_save(&cf->cf2_fcb, name, value, !conf_fcb2_saving);
+}
+
+static int
+conf_fcb2_save_end(struct conf_store *cs)
+{
+    struct conf_fcb2 *cf = (struct conf_fcb2 *)cs;
+
+    conf_fcb2_saving = false;
+    if (fcb2_flush(&cf->cf2_fcb)) {
+        return OS_EINVAL;
+    }
+    return OS_OK;
 }
 
 void
@@ -339,18 +393,7 @@ conf_fcb2_kv_load(struct fcb2 *fcb, const char *name, char *value, size_t len)
 int
 conf_fcb2_kv_save(struct fcb2 *fcb, const char *name, const char *value)
 {
-    char buf[CONF_MAX_NAME_LEN + CONF_MAX_VAL_LEN + 32];
-    int len;
-
-    if (!name) {
-        return OS_INVALID_PARM;
-    }
-
-    len = conf_line_make(buf, sizeof(buf), name, value);
-    if (len < 0 || len + 2 > sizeof(buf)) {
-        return OS_INVALID_PARM;
-    }
-    return conf_fcb2_append(fcb, buf, len);
+    return conf_fcb2_line_save(fcb, name, value, true);
 }
 
 #endif
@@ -24,7 +24,7 @@
 #include <string.h>
 
 #include "mgmt/mgmt.h"
-#include "cborattr/cborattr.h"
+#include "mgmt/mgmt_decode.h"
 #include "config/config.h"
 #include "config_priv.h"
 
@@ -41,33 +41,38 @@ static struct mgmt_group conf_mgmt_group = {
     .mg_group_id = MGMT_GROUP_ID_CONFIG
 };
 
+struct conf_mgmt_req {
+    char name[CONF_MAX_NAME_LEN];
+    char val[CONF_MAX_VAL_LEN];
+    bool save;
+};
+
+static const struct mgmt_field conf_mgmt_read_fields[] = {
+    MGMT_FIELD_TSTR(struct conf_mgmt_req, "name", name),
+};
+
+static const struct mgmt_field conf_mgmt_write_fields[] = {
+    MGMT_FIELD_TSTR(struct conf_mgmt_req, "name", name),
+    MGMT_FIELD_TSTR(struct conf_mgmt_req, "val", val),
+    MGMT_FIELD_BOOL(struct conf_mgmt_req, "save", save),
+};
+
 static int
 conf_mgmt_read(struct mgmt_ctxt *cb)
 {
     int rc;
-    char name_str[CONF_MAX_NAME_LEN];
-    char val_str[CONF_MAX_VAL_LEN];
+    struct conf_mgmt_req req;
     char *val;
     CborError g_err = CborNoError;
 
-    const struct cbor_attr_t attr[2] = {
-        [0] = {
-            .attribute = "name",
-            .type = CborAttrTextStringType,
-            .addr.string = name_str,
-            .len = sizeof(name_str)
-        },
-        [1] = {
-            .attribute = NULL
-        }
-    };
-
-    rc = cbor_read_object(&cb->it, attr);
+    req.name[0] = '\0';
+    rc = mgmt_decode_map(&cb->it, conf_mgmt_read_fields,
+                         MGMT_FIELD_CNT(conf_mgmt_read_fields), &req, NULL);
     if (rc) {
         return MGMT_ERR_EINVAL;
     }
 
-    val = conf_get_value(name_str, val_str, sizeof(val_str));
+    val = conf_get_value(req.name, req.val, sizeof(req.val));
     if (!val) {
         return MGMT_ERR_EINVAL;
     }
@@ -85,45 +90,23 @@ static int
 conf_mgmt_write(struct mgmt_ctxt *cb)
 {
     int rc;
-    char name_str[CONF_MAX_NAME_LEN];
-    char val_str[CONF_MAX_VAL_LEN];
-    bool do_save = false;
-    const struct cbor_attr_t val_attr[] = {
-        [0] = {
-            .attribute = "name",
-            .type = CborAttrTextStringType,
-            .addr.string = name_str,
-            .len = sizeof(name_str)
-        },
-        [1] = {
-            .attribute = "val",
-            .type = CborAttrTextStringType,
-            .addr.string = val_str,
-            .len = sizeof(val_str)
-        },
-        [2] = {
-            .attribute = "save",
-            .type = CborAttrBooleanType,
-            .addr.boolean = &do_save
-        },
-        [3] = {
-            .attribute = NULL
-        }
-    };
+    struct conf_mgmt_req req;
 
-    name_str[0] = '\0';
-    val_str[0] = '\0';
+    req.name[0] = '\0';
+    req.val[0] = '\0';
+    req.save = false;
 
-    rc = cbor_read_object(&cb->it, val_attr);
+    rc = mgmt_decode_map(&cb->it, conf_mgmt_write_fields,
+                         MGMT_FIELD_CNT(conf_mgmt_write_fields), &req, NULL);
     if (rc) {
         return MGMT_ERR_EINVAL;
     }
 
-    if (name_str[0] != '\0') {
-        if (val_str[0] != '\0') {
-            rc = conf_set_value(name_str, val_str);
+    if (req.name[0] != '\0') {
+        if (req.val[0] != '\0') {
+            rc = conf_set_value(req.name, req.val);
         } else {
-            rc = conf_set_value(name_str, NULL);
+            rc = conf_set_value(req.name, NULL);
         }
         if (rc) {
             return MGMT_ERR_EINVAL;
@@ -133,7 +116,7 @@ conf_mgmt_write(struct mgmt_ctxt *cb)
     if (rc) {
         return MGMT_ERR_EINVAL;
     }
-    if (do_save) {
+    if (req.save) {
         rc = conf_save();
         if (rc) {
             return MGMT_ERR_EINVAL;
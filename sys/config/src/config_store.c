@@ -31,6 +31,16 @@ struct conf_dup_check_arg {
     int is_dup;
 };
 
+struct conf_batch_dup_check_arg {
+    struct conf_batch_ent *ents;
+    int cnt;
+};
+
+/* States of a batch entry */
+#define CONF_BATCH_WRITE        0   /* Differs from storage */
+#define CONF_BATCH_STORED       1   /* Same value already stored */
+#define CONF_BATCH_SUPERSEDED   2   /* Later entry has the same name */
+
 struct conf_get_val_arg {
     const char *name;
     char val[CONF_MAX_VAL_LEN + 1];
@@ -245,6 +255,97 @@ out:
     return rc;
 }
 
+static void
+conf_batch_dup_check_cb(char *name, char *val, void *cb_arg)
+{
+    struct conf_batch_dup_check_arg *cbdc = cb_arg;
+    struct conf_batch_ent *ent;
+    uint32_t hash;
+    int is_dup;
+    int i;
+
+    hash = conf_name_hash(name);
+    for (i = 0; i < cbdc->cnt; i++) {
+        ent = &cbdc->ents[i];
+        if (ent->cbe_state == CONF_BATCH_SUPERSEDED ||
+            ent->cbe_hash != hash || strcmp(name, ent->cbe_name)) {
+            continue;
+        }
+        if (!val) {
+            is_dup = !ent->cbe_value || ent->cbe_value[0] == '\0';
+        } else {
+            is_dup = ent->cbe_value && !strcmp(val, ent->cbe_value);
+        }
+        ent->cbe_state = is_dup ? CONF_BATCH_STORED : CONF_BATCH_WRITE;
+        break;
+    }
+}
+
+int
+conf_save_batch(struct conf_batch_ent *ents, int cnt)
+{
+    struct conf_store *cs;
+    struct conf_batch_dup_check_arg cbdc;
+    int rc;
+    int rc2;
+    int i;
+    int j;
+
+    for (i = 0; i < cnt; i++) {
+        if (!ents[i].cbe_name) {
+            return OS_INVALID_PARM;
+        }
+        ents[i].cbe_hash = conf_name_hash(ents[i].cbe_name);
+        ents[i].cbe_state = CONF_BATCH_WRITE;
+    }
+    for (i = 0; i < cnt; i++) {
+        for (j = i + 1; j < cnt; j++) {
+            if (ents[i].cbe_hash == ents[j].cbe_hash &&
+                !strcmp(ents[i].cbe_name, ents[j].cbe_name)) {
+                ents[i].cbe_state = CONF_BATCH_SUPERSEDED;
+                break;
+            }
+        }
+    }
+
+    conf_lock();
+    cs = conf_save_dst;
+    if (!cs) {
+        rc = OS_ENOENT;
+        goto out;
+    }
+
+    cbdc.ents = ents;
+    cbdc.cnt = cnt;
+    SLIST_FOREACH(cs, &conf_load_srcs, cs_next) {
+        cs->cs_itf->csi_load(cs, conf_batch_dup_check_cb, &cbdc);
+    }
+
+    cs = conf_save_dst;
+    if (cs->cs_itf->csi_save_start) {
+        cs->cs_itf->csi_save_start(cs);
+    }
+    rc = 0;
+    for (i = 0; i < cnt; i++) {
+        if (ents[i].cbe_state != CONF_BATCH_WRITE) {
+            continue;
+        }
+        rc = cs->cs_itf->csi_save(cs, ents[i].cbe_name, ents[i].cbe_value);
+        if (rc) {
+            break;
+        }
+    }
+    if (cs->cs_itf->csi_save_end) {
+        rc2 = cs->cs_itf->csi_save_end(cs);
+        if (!rc) {
+            rc = rc2;
+        }
+    }
+out:
+    conf_unlock();
+    return rc;
+}
+
 static void
 conf_store_one(char *name, char *value)
 {
@@ -44,6 +44,8 @@ struct console_input {
 typedef void (*console_rx_cb)(void);
 typedef int (*console_append_char_cb)(char *line, uint8_t byte);
 typedef void (*completion_cb)(char *str, console_append_char_cb cb);
+/* Sees received bytes before line editing; nonzero if it took the byte. */
+typedef int (*console_raw_rx_cb)(uint8_t byte);
 
 /**
  * De initializes the UART console.
@@ -56,6 +58,11 @@ void console_reinit(void);
 int console_init(console_rx_cb rx_cb);
 int console_is_init(void);
 void console_write(const char *str, int cnt);
+/**
+ * Writes bytes as they are, without newline translation, for binary
+ * framed output.
+ */
+void console_write_raw(const char *str, int cnt);
 #if MYNEWT_VAL(CONSOLE_COMPAT)
 int console_read(char *str, int cnt, int *newline);
 #endif
@@ -68,6 +75,11 @@ int console_printf(const char *fmt, ...)
     __attribute__ ((format (printf, 1, 2)));;
 
 void console_set_completion_cb(completion_cb cb);
+/**
+ * Installs a callback that gets every received byte first.  It may be
+ * called from interrupt context.
+ */
+void console_set_raw_rx_cb(console_raw_rx_cb cb);
 int console_handle_char(uint8_t byte);
 
 /* Set queue to send console line events to */
@@ -132,6 +144,12 @@ extern void console_rx_restart(void);
 int console_lock(int timeout);
 int console_unlock(void);
 
+/**
+ * Number of output characters discarded because the console transmit
+ * buffer was full.  Only counted when CONSOLE_UART_TX_FULL is not wait.
+ */
+uint32_t console_out_dropped(void);
+
 /**
  * Set prompt and current input line.
  *
@@ -94,6 +94,8 @@ static struct os_eventq avail_queue;
 static struct os_eventq *lines_queue;
 static struct os_event *current_line_ev;
 static completion_cb completion;
+static console_raw_rx_cb raw_rx;
+bool g_console_raw_out;
 bool g_console_silence;
 bool g_console_silence_non_nlip;
 bool g_console_ignore_non_nlip;
@@ -121,6 +123,13 @@ console_out_nolock(int c)
     return c;
 }
 
+/* Output that does not buffer drops nothing. */
+uint32_t __attribute__((weak))
+console_out_dropped(void)
+{
+    return 0;
+}
+
 void
 console_echo(int on)
 {
@@ -543,6 +552,25 @@ done:
     (void)console_unlock();
 }
 
+void
+console_write_raw(const char *str, int cnt)
+{
+    const os_time_t timeout =
+            os_time_ms_to_ticks32(MYNEWT_VAL(CONSOLE_DEFAULT_LOCK_TIMEOUT));
+
+    if (console_lock(timeout) != OS_OK) {
+        return;
+    }
+
+    if (!g_console_silence) {
+        g_console_raw_out = true;
+        console_write_nolock(str, cnt);
+        g_console_raw_out = false;
+    }
+
+    (void)console_unlock();
+}
+
 #if MYNEWT_VAL(CONSOLE_COMPAT)
 int
 console_read(char *str, int cnt, int *newline)
@@ -1121,6 +1149,10 @@ console_handle_char(uint8_t byte)
     struct console_input *input;
     static char prev_endl = '\0';
 
+    if (raw_rx && raw_rx(byte)) {
+        return 0;
+    }
+
     if (!lines_queue) {
         return 0;
     }
@@ -1298,6 +1330,12 @@ console_set_completion_cb(completion_cb cb)
     completion = cb;
 }
 
+void
+console_set_raw_rx_cb(console_raw_rx_cb cb)
+{
+    raw_rx = cb;
+}
+
 void
 console_deinit(void)
 {
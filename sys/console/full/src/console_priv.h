@@ -24,6 +24,9 @@
 extern "C" {
 #endif
 
+/* Set while console_write_raw() runs; no newline translation then */
+extern bool g_console_raw_out;
+
 int uart_console_is_init(void);
 int uart_console_deinit(void);
 int uart_console_init(void);
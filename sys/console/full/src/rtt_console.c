@@ -106,7 +106,7 @@ console_out_nolock(int character)
 {
     char c = (char)character;
 
-    if ('\n' == c) {
+    if ('\n' == c && !g_console_raw_out) {
         rtt_console_write_ch('\r');
     }
 
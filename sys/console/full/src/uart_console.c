@@ -30,8 +30,8 @@
 #include "console_priv.h"
 
 struct console_ring {
-    uint8_t head;
-    uint8_t tail;
+    uint16_t head;
+    uint16_t tail;
     uint16_t size;
     uint8_t *buf;
 };
@@ -41,6 +41,10 @@ static struct console_ring cr_tx;
 static uint8_t cr_tx_buf[MYNEWT_VAL(CONSOLE_UART_TX_BUF_SIZE)];
 typedef void (*console_write_char)(struct uart_dev*, uint8_t);
 static console_write_char write_char_cb;
+#if !MYNEWT_VAL_CHOICE(CONSOLE_UART_TX_FULL, wait)
+/* Characters discarded because the TX ring was full */
+static uint32_t cr_tx_dropped;
+#endif
 
 #if MYNEWT_VAL(CONSOLE_UART_RX_BUF_SIZE) > 0
 static struct console_ring cr_rx;
@@ -50,6 +54,11 @@ static volatile bool uart_console_rx_stalled;
 struct os_event rx_ev;
 #endif
 
+#if MYNEWT_VAL(CONSOLE_UART_BLOCK)
+/* Part of TX ring passed to UART driver which is still being sent */
+static int cr_tx_span;
+#endif
+
 static inline int
 inc_and_wrap(int i, int max)
 {
@@ -73,6 +82,18 @@ uart_console_ring_pull_char(struct console_ring *cr)
     return ch;
 }
 
+#if MYNEWT_VAL(CONSOLE_UART_BLOCK)
+/*
+ * Removes data sent by UART driver from TX ring.
+ */
+static void
+uart_console_tx_commit(void)
+{
+    cr_tx.tail = (cr_tx.tail + cr_tx_span) & (cr_tx.size - 1);
+    cr_tx_span = 0;
+}
+#endif
+
 static bool
 uart_console_ring_is_full(const struct console_ring *cr)
 {
@@ -96,6 +117,7 @@ uart_console_queue_char(struct uart_dev *uart_dev, uint8_t ch)
     }
 
     OS_ENTER_CRITICAL(sr);
+#if MYNEWT_VAL_CHOICE(CONSOLE_UART_TX_FULL, wait)
     while (uart_console_ring_is_full(&cr_tx)) {
         /* TX needs to drain */
         uart_start_tx(uart_dev);
@@ -105,10 +127,42 @@ uart_console_queue_char(struct uart_dev *uart_dev, uint8_t ch)
         }
         OS_ENTER_CRITICAL(sr);
     }
+#else
+    if (uart_console_ring_is_full(&cr_tx)) {
+        cr_tx_dropped++;
+#if MYNEWT_VAL_CHOICE(CONSOLE_UART_TX_FULL, overwrite)
+#if MYNEWT_VAL(CONSOLE_UART_BLOCK)
+        /* The oldest characters may be what the driver is sending now. */
+        if (cr_tx_span) {
+            OS_EXIT_CRITICAL(sr);
+            return;
+        }
+#endif
+        (void)uart_console_ring_pull_char(&cr_tx);
+#else
+        OS_EXIT_CRITICAL(sr);
+        return;
+#endif
+    }
+#endif
     uart_console_ring_add_char(&cr_tx, ch);
     OS_EXIT_CRITICAL(sr);
 }
 
+/*
+ * Number of characters the console has discarded because the UART could
+ * not keep up.
+ */
+uint32_t
+console_out_dropped(void)
+{
+#if MYNEWT_VAL_CHOICE(CONSOLE_UART_TX_FULL, wait)
+    return 0;
+#else
+    return cr_tx_dropped;
+#endif
+}
+
 /*
  * Flush cnt characters from console output queue.
  */
@@ -136,6 +190,10 @@ uart_console_blocking_mode(void)
     if (write_char_cb) {
         write_char_cb = uart_blocking_tx;
 
+#if MYNEWT_VAL(CONSOLE_UART_BLOCK)
+        /* Don't send again data which driver has already taken */
+        uart_console_tx_commit();
+#endif
         uart_console_tx_flush(MYNEWT_VAL(CONSOLE_UART_TX_BUF_SIZE));
     }
     OS_EXIT_CRITICAL(sr);
@@ -163,7 +221,7 @@ console_out_nolock(int c)
         return c;
     }
 
-    if ('\n' == c) {
+    if ('\n' == c && !g_console_raw_out) {
         write_char_cb(uart_dev, '\r');
     }
     write_char_cb(uart_dev, c);
@@ -219,6 +277,66 @@ uart_console_rx_char(void *arg, uint8_t byte)
 #endif
 }
 
+#if MYNEWT_VAL(CONSOLE_UART_BLOCK)
+/*
+ * Interrupts disabled when called. Driver sends contiguous part of TX ring
+ * directly, it is removed from ring on next call i.e. once it was sent.
+ */
+static int
+uart_console_tx_block(void *arg, const uint8_t **data, int max)
+{
+    int len;
+
+    uart_console_tx_commit();
+
+    if (cr_tx.head >= cr_tx.tail) {
+        len = cr_tx.head - cr_tx.tail;
+    } else {
+        len = cr_tx.size - cr_tx.tail;
+    }
+    if (len > max) {
+        len = max;
+    }
+
+    *data = &cr_tx.buf[cr_tx.tail];
+    cr_tx_span = len;
+
+    return len;
+}
+
+/*
+ * Interrupts disabled when called. Returns number of bytes consumed, driver
+ * keeps the rest until console_rx_restart() is called.
+ */
+static int
+uart_console_rx_block(void *arg, const uint8_t *data, int len)
+{
+    int i;
+
+#if MYNEWT_VAL(CONSOLE_UART_RX_BUF_SIZE) > 0
+    for (i = 0; i < len; i++) {
+        if (uart_console_ring_is_full(&cr_rx)) {
+            uart_console_rx_stalled = true;
+            break;
+        }
+        uart_console_ring_add_char(&cr_rx, data[i]);
+    }
+
+    if (i > 0 && !rx_ev.ev_queued) {
+        os_eventq_put(os_eventq_dflt_get(), &rx_ev);
+    }
+#else
+    for (i = 0; i < len; i++) {
+        if (console_handle_char(data[i]) < 0) {
+            break;
+        }
+    }
+#endif
+
+    return i;
+}
+#endif
+
 #if MYNEWT_VAL(CONSOLE_UART_RX_BUF_SIZE) > 0
 static void
 uart_console_rx_char_event(struct os_event *ev)
@@ -290,6 +408,10 @@ uart_console_init(void)
         .uc_flow_ctl = MYNEWT_VAL(CONSOLE_UART_FLOW_CONTROL),
         .uc_tx_char = uart_console_tx_char,
         .uc_rx_char = uart_console_rx_char,
+#if MYNEWT_VAL(CONSOLE_UART_BLOCK)
+        .uc_tx_block = uart_console_tx_block,
+        .uc_rx_block = uart_console_rx_block,
+#endif
     };
 
     cr_tx.size = MYNEWT_VAL(CONSOLE_UART_TX_BUF_SIZE);
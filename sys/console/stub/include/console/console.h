@@ -117,6 +117,16 @@ console_set_completion_cb(void (*completion)(char *str, console_append_char_cb c
 {
 }
 
+static void inline
+console_set_raw_rx_cb(int (*cb)(uint8_t byte))
+{
+}
+
+static void inline
+console_write_raw(const char *str, int cnt)
+{
+}
+
 static int inline
 console_handle_char(uint8_t byte)
 {
@@ -25,6 +25,7 @@ extern "C" {
 #endif
 
 #include <inttypes.h>
+#include "os/queue.h"
 
 #define COREDUMP_MAGIC              0x690c47c3
 
@@ -34,6 +35,13 @@ extern "C" {
 #define COREDUMP_TLV_IMAGE          1   /* SHA256 of image creating this */
 #define COREDUMP_TLV_MEM            2   /* Memory dump */
 #define COREDUMP_TLV_REGS           3   /* CPU registers */
+#define COREDUMP_TLV_MEM_RLE        4   /* Memory dump, run-length encoded */
+
+/*
+ * COREDUMP_TLV_MEM_RLE data is a sequence of runs, each starting with a
+ * control byte c: for c < 128, c + 1 bytes follow verbatim; otherwise the
+ * single byte that follows is repeated c - 125 times.
+ */
 
 struct coredump_tlv {
     uint8_t ct_type;
@@ -50,8 +58,24 @@ struct coredump_header {
     uint32_t ch_size;                   /* Size of everything */
 };
 
+/*
+ * Memory dumped in addition to task state with COREDUMP_MINIMAL.
+ */
+struct coredump_region {
+    SLIST_ENTRY(coredump_region) cr_next;
+    const void *cr_start;
+    uint32_t cr_size;
+};
+
 void coredump_dump(void *regs, int regs_sz);
 
+/*
+ * Adds a region to the set dumped with COREDUMP_MINIMAL, e.g. a heap or
+ * a subsystem's state.  The structure must stay valid.  Not used when all
+ * of RAM is dumped.
+ */
+void coredump_region_add(struct coredump_region *cr);
+
 /*
  * Set this to non-zero to prevent coredump from taking place.
  */
@@ -19,8 +19,10 @@
 
 #include <stddef.h>
 #include <limits.h>
+#include <string.h>
 #include "os/mynewt.h"
 #include "hal/hal_bsp.h"
+#include "hal/hal_watchdog.h"
 #include "flash_map/flash_map.h"
 #include "bootutil/image.h"
 #include "imgmgr/imgmgr.h"
@@ -29,6 +31,23 @@
 
 uint8_t coredump_disabled;
 
+#if MYNEWT_VAL(COREDUMP_MINIMAL)
+static SLIST_HEAD(, coredump_region) coredump_regions =
+    SLIST_HEAD_INITIALIZER(coredump_regions);
+#endif
+
+#if MYNEWT_VAL(COREDUMP_COMPRESS)
+/*
+ * Memory is encoded this much at a time, into one TLV each; the encoded
+ * size stays below the TLV length limit even if nothing compresses.
+ */
+#define COREDUMP_RLE_CHUNK          0x8000
+#define COREDUMP_RLE_MAX_LIT        128
+#define COREDUMP_RLE_MAX_REP        130
+
+static uint8_t coredump_rle_buf[512];
+#endif
+
 static void
 dump_core_tlv(const struct flash_area *fa, uint32_t *off,
   struct coredump_tlv *tlv, void *data)
@@ -40,6 +59,203 @@ dump_core_tlv(const struct flash_area *fa, uint32_t *off,
     *off += tlv->ct_len;
 }
 
+#if MYNEWT_VAL(COREDUMP_COMPRESS)
+struct coredump_rle {
+    const struct flash_area *fa;
+    uint32_t off;               /* where the buffer goes in flash */
+    uint32_t len;               /* encoded bytes in flash so far */
+    uint16_t buf_len;
+};
+
+static int
+coredump_rle_flush(struct coredump_rle *rle)
+{
+    if (rle->off + rle->buf_len > rle->fa->fa_size) {
+        /* Out of room; what is in flash is still a valid run sequence. */
+        return -1;
+    }
+    flash_area_write(rle->fa, rle->off, coredump_rle_buf, rle->buf_len);
+    rle->off += rle->buf_len;
+    rle->len += rle->buf_len;
+    rle->buf_len = 0;
+    return 0;
+}
+
+static int
+coredump_rle_emit(struct coredump_rle *rle, uint8_t ctl, const uint8_t *data,
+                  int len)
+{
+    if (rle->buf_len + 1 + len > sizeof(coredump_rle_buf)) {
+        if (coredump_rle_flush(rle)) {
+            return -1;
+        }
+    }
+    coredump_rle_buf[rle->buf_len++] = ctl;
+    memcpy(coredump_rle_buf + rle->buf_len, data, len);
+    rle->buf_len += len;
+    return 0;
+}
+
+/*
+ * Run-length encodes len bytes at src into flash at off.  Returns the
+ * encoded size; less of the input is covered if the area fills up.
+ */
+static uint32_t
+coredump_rle(const struct flash_area *fa, uint32_t off, const uint8_t *src,
+             uint32_t len)
+{
+    struct coredump_rle rle;
+    uint32_t lit;
+    uint32_t run;
+    uint32_t i;
+
+    rle.fa = fa;
+    rle.off = off;
+    rle.len = 0;
+    rle.buf_len = 0;
+
+    lit = 0;
+    i = 0;
+    while (i < len) {
+        for (run = 1; i + run < len && run < COREDUMP_RLE_MAX_REP &&
+                      src[i + run] == src[i]; run++) {
+        }
+        if (run < 3) {
+            /* Not worth a repeat run; part of a literal one. */
+            i++;
+            if (i - lit == COREDUMP_RLE_MAX_LIT) {
+                if (coredump_rle_emit(&rle, COREDUMP_RLE_MAX_LIT - 1,
+                                      src + lit, COREDUMP_RLE_MAX_LIT)) {
+                    return rle.len;
+                }
+                lit = i;
+            }
+            continue;
+        }
+        if (i > lit) {
+            if (coredump_rle_emit(&rle, i - lit - 1, src + lit, i - lit)) {
+                return rle.len;
+            }
+        }
+        if (coredump_rle_emit(&rle, run + 125, src + i, 1)) {
+            return rle.len;
+        }
+        i += run;
+        lit = i;
+    }
+    if (i > lit) {
+        if (coredump_rle_emit(&rle, i - lit - 1, src + lit, i - lit)) {
+            return rle.len;
+        }
+    }
+    coredump_rle_flush(&rle);
+
+    return rle.len;
+}
+#endif
+
+/*
+ * Dumps size bytes of memory at start, as as many TLVs as it takes or
+ * as fit.
+ */
+static void
+coredump_mem(const struct flash_area *fa, uint32_t *off, uint32_t start,
+             uint32_t size)
+{
+    struct coredump_tlv tlv;
+    uint32_t area_off, area_end;
+
+    tlv._pad = 0;
+    area_off = start;
+    area_end = area_off + size;
+    while (area_off < area_end) {
+        /* Writing a large RAM a chunk at a time must not trip the dog. */
+        hal_watchdog_tickle();
+
+        if (*off + sizeof(tlv) >= fa->fa_size) {
+            break;
+        }
+#if MYNEWT_VAL(COREDUMP_COMPRESS)
+        tlv.ct_type = COREDUMP_TLV_MEM_RLE;
+        tlv.ct_len = coredump_rle(fa, *off + sizeof(tlv),
+                                  (const uint8_t *)area_off,
+                                  min(area_end - area_off,
+                                      COREDUMP_RLE_CHUNK));
+        if (tlv.ct_len == 0) {
+            break;
+        }
+        tlv.ct_off = area_off;
+
+        /* Header after the data, now that its length is known. */
+        flash_area_write(fa, *off, &tlv, sizeof(tlv));
+        *off += sizeof(tlv) + tlv.ct_len;
+        area_off += COREDUMP_RLE_CHUNK;
+#else
+        tlv.ct_type = COREDUMP_TLV_MEM;
+        if (area_end - area_off > USHRT_MAX) {
+            tlv.ct_len = USHRT_MAX - 3; /* 0xfffc */
+        } else {
+            tlv.ct_len = area_end - area_off;
+        }
+        if (*off + tlv.ct_len + sizeof(tlv) > fa->fa_size) {
+            tlv.ct_len = fa->fa_size - (*off + sizeof(tlv));
+        }
+        tlv.ct_off = area_off;
+        dump_core_tlv(fa, off, &tlv, (void *)area_off);
+        area_off += tlv.ct_len;
+#endif
+    }
+}
+
+#if MYNEWT_VAL(COREDUMP_MINIMAL)
+void
+coredump_region_add(struct coredump_region *cr)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    SLIST_INSERT_HEAD(&coredump_regions, cr, cr_next);
+    OS_EXIT_CRITICAL(sr);
+}
+
+/*
+ * Dumps each task, with the part of its stack in use, and the regions
+ * added with coredump_region_add().  The stack of the task that crashed is
+ * dumped whole, as its saved stack pointer is stale.
+ */
+static void
+coredump_minimal(const struct flash_area *fa, uint32_t *off)
+{
+    struct coredump_region *cr;
+    struct os_task *cur;
+    struct os_task *t;
+    os_stack_t *bottom;
+    os_stack_t *sp;
+
+    cur = os_sched_get_current_task();
+    STAILQ_FOREACH(t, &g_os_task_list, t_os_task_list) {
+        coredump_mem(fa, off, (uint32_t)t, sizeof(*t));
+
+        bottom = t->t_stacktop - t->t_stacksize;
+        sp = t->t_stackptr;
+        if (t == cur || sp < bottom || sp > t->t_stacktop) {
+            sp = bottom;
+        }
+        coredump_mem(fa, off, (uint32_t)sp,
+                     (t->t_stacktop - sp) * sizeof(os_stack_t));
+    }
+
+    SLIST_FOREACH(cr, &coredump_regions, cr_next) {
+        coredump_mem(fa, off, (uint32_t)cr->cr_start, cr->cr_size);
+    }
+}
+#else
+void
+coredump_region_add(struct coredump_region *cr)
+{
+}
+#endif
+
 void
 coredump_dump(void *regs, int regs_sz)
 {
@@ -47,11 +263,12 @@ coredump_dump(void *regs, int regs_sz)
     struct coredump_tlv tlv;
     const struct flash_area *fa;
     struct image_version ver;
-    const struct hal_bsp_mem_dump *mem, *cur;
+#if !MYNEWT_VAL(COREDUMP_MINIMAL)
+    const struct hal_bsp_mem_dump *mem;
     int area_cnt, i;
+#endif
     uint8_t hash[IMGMGR_HASH_LEN];
     uint32_t off;
-    uint32_t area_off, area_end;
     int slot;
 
     if (coredump_disabled) {
@@ -103,29 +320,15 @@ coredump_dump(void *regs, int regs_sz)
         dump_core_tlv(fa, &off, &tlv, hash);
     }
 
+#if MYNEWT_VAL(COREDUMP_MINIMAL)
+    coredump_minimal(fa, &off);
+#else
     mem = hal_bsp_core_dump(&area_cnt);
     for (i = 0; i < area_cnt; i++) {
-        cur = &mem[i];
-        area_off = (uint32_t)cur->hbmd_start;
-        area_end = area_off + cur->hbmd_size;
-        while (area_off < area_end) {
-            tlv.ct_type = COREDUMP_TLV_MEM;
-            if (area_end - area_off > USHRT_MAX) {
-                tlv.ct_len = USHRT_MAX - 3; /* 0xfffc */
-            } else {
-                tlv.ct_len = area_end - area_off;
-            }
-            if (off + tlv.ct_len + sizeof(tlv) > fa->fa_size) {
-                if (off + sizeof(tlv) >= fa->fa_size) {
-                    break;
-                }
-                tlv.ct_len = fa->fa_size - (off + sizeof(tlv));
-            }
-            tlv.ct_off = area_off;
-            dump_core_tlv(fa, &off, &tlv, (void *)area_off);
-            area_off += tlv.ct_len;
-        }
+        coredump_mem(fa, &off, (uint32_t)mem[i].hbmd_start,
+                     mem[i].hbmd_size);
     }
+#endif
     hdr.ch_magic = COREDUMP_MAGIC;
     hdr.ch_size = off;
 
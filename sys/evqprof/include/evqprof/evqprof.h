@@ -0,0 +1,90 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef H_EVQPROF_
+#define H_EVQPROF_
+
+#include <inttypes.h>
+#include "os/mynewt.h"
+#include "os/os_eventq_prof.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define EVQPROF_BUCKETS     MYNEWT_VAL(EVQPROF_BUCKETS)
+
+/**
+ * Statistics for one event callback on one event queue.  Times are in
+ * microseconds.  Histogram bucket 0 counts times under 1 us, bucket n times
+ * from 2^(n-1) to 2^n - 1 us; the last bucket also counts anything longer.
+ */
+struct evqprof_cb {
+    const struct os_eventq *epc_evq;
+    os_event_fn *epc_cb;
+    /** Number of events dispatched. */
+    uint32_t epc_cnt;
+    /** Longest time an event waited in the queue. */
+    uint32_t epc_wait_max;
+    /** Sum of queue waits; divide by epc_cnt for the mean. */
+    uint64_t epc_wait_sum;
+    /** Longest time the callback ran. */
+    uint32_t epc_run_max;
+    /** Sum of callback run times. */
+    uint64_t epc_run_sum;
+    uint32_t epc_wait_hist[EVQPROF_BUCKETS];
+    uint32_t epc_run_hist[EVQPROF_BUCKETS];
+};
+
+/**
+ * Copies out the statistics for the next used callback slot.
+ *
+ * Iterate with:
+ *     for (i = evqprof_cb_get_next(0, &c); i >= 0;
+ *          i = evqprof_cb_get_next(i + 1, &c))
+ *
+ * @param idx                   Slot index to start searching from.
+ * @param cb                    Filled in with the callback's statistics.
+ *
+ * @return                      The index of the slot copied;
+ *                              -1 if there are no more callbacks.
+ */
+int evqprof_cb_get_next(int idx, struct evqprof_cb *cb);
+
+/**
+ * Returns the number of events not recorded because the callback table
+ * was full.
+ */
+uint32_t evqprof_dropped_get(void);
+
+/**
+ * Returns the lowest time, in microseconds, counted by a histogram bucket.
+ */
+uint32_t evqprof_bucket_floor(int bucket);
+
+/**
+ * Clears all statistics.
+ */
+void evqprof_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,167 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <assert.h>
+#include <string.h>
+#include "os/mynewt.h"
+#include "evqprof/evqprof.h"
+#include "evqprof_priv.h"
+
+#define EVQPROF_MAX_CBS     MYNEWT_VAL(EVQPROF_MAX_CBS)
+
+static_assert(EVQPROF_MAX_CBS > 0, "EVQPROF_MAX_CBS must be nonzero");
+static_assert(EVQPROF_BUCKETS > 1 && EVQPROF_BUCKETS <= 33,
+              "EVQPROF_BUCKETS must be between 2 and 33");
+
+/*
+ * Open-addressing hash with linear probing, keyed by (queue, callback).
+ * Only modified inside a critical section.
+ */
+static struct evqprof_cb evqprof_cbs[EVQPROF_MAX_CBS];
+static uint32_t evqprof_dropped;
+
+static uint32_t
+evqprof_hash(const void *a, const void *b)
+{
+    uint32_t h;
+
+    h = ((uint32_t)(uintptr_t)a >> 2) ^ (uint32_t)(uintptr_t)b;
+    h *= 0x9e3779b1;
+
+    return h ^ (h >> 16);
+}
+
+static int
+evqprof_bucket(uint32_t usecs)
+{
+    int b;
+
+    b = usecs ? 32 - __builtin_clz(usecs) : 0;
+    if (b >= EVQPROF_BUCKETS) {
+        b = EVQPROF_BUCKETS - 1;
+    }
+
+    return b;
+}
+
+void
+os_eventq_prof_record(const struct os_eventq *evq, os_event_fn *cb,
+                      uint32_t wait, uint32_t run)
+{
+    struct evqprof_cb *c;
+    uint32_t idx;
+    os_sr_t sr;
+    int i;
+
+    wait = os_cputime_ticks_to_usecs(wait);
+    run = os_cputime_ticks_to_usecs(run);
+    idx = evqprof_hash(evq, cb) % EVQPROF_MAX_CBS;
+
+    OS_ENTER_CRITICAL(sr);
+
+    for (i = 0; i < EVQPROF_MAX_CBS; i++) {
+        c = &evqprof_cbs[idx];
+        if (c->epc_cb == NULL) {
+            c->epc_evq = evq;
+            c->epc_cb = cb;
+            break;
+        }
+        if (c->epc_cb == cb && c->epc_evq == evq) {
+            break;
+        }
+        if (++idx == EVQPROF_MAX_CBS) {
+            idx = 0;
+        }
+    }
+
+    if (i == EVQPROF_MAX_CBS) {
+        evqprof_dropped++;
+    } else {
+        c->epc_cnt++;
+        c->epc_wait_sum += wait;
+        if (wait > c->epc_wait_max) {
+            c->epc_wait_max = wait;
+        }
+        c->epc_run_sum += run;
+        if (run > c->epc_run_max) {
+            c->epc_run_max = run;
+        }
+        c->epc_wait_hist[evqprof_bucket(wait)]++;
+        c->epc_run_hist[evqprof_bucket(run)]++;
+    }
+
+    OS_EXIT_CRITICAL(sr);
+}
+
+int
+evqprof_cb_get_next(int idx, struct evqprof_cb *cb)
+{
+    os_sr_t sr;
+
+    for (; idx < EVQPROF_MAX_CBS; idx++) {
+        OS_ENTER_CRITICAL(sr);
+        if (evqprof_cbs[idx].epc_cb != NULL) {
+            *cb = evqprof_cbs[idx];
+            OS_EXIT_CRITICAL(sr);
+            return idx;
+        }
+        OS_EXIT_CRITICAL(sr);
+    }
+
+    return -1;
+}
+
+uint32_t
+evqprof_dropped_get(void)
+{
+    return evqprof_dropped;
+}
+
+uint32_t
+evqprof_bucket_floor(int bucket)
+{
+    return bucket ? 1UL << (bucket - 1) : 0;
+}
+
+void
+evqprof_reset(void)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    memset(evqprof_cbs, 0, sizeof(evqprof_cbs));
+    evqprof_dropped = 0;
+    OS_EXIT_CRITICAL(sr);
+}
+
+void
+evqprof_init(void)
+{
+#if MYNEWT_VAL(EVQPROF_CLI)
+    int rc;
+#endif
+
+    /* Ensure this function only gets called by sysinit. */
+    SYSINIT_ASSERT_ACTIVE();
+
+#if MYNEWT_VAL(EVQPROF_CLI)
+    rc = evqprof_shell_register();
+    SYSINIT_PANIC_ASSERT(rc == 0);
+#endif
+}
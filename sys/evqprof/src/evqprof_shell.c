@@ -0,0 +1,130 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(EVQPROF_CLI)
+
+#include <string.h>
+#include "shell/shell.h"
+#include "streamer/streamer.h"
+#include "evqprof/evqprof.h"
+#include "evqprof_priv.h"
+
+static int evqprof_shell_cmd(const struct shell_cmd *cmd,
+                             int argc, char **argv,
+                             struct streamer *streamer);
+
+static struct shell_cmd evqprof_shell_cmd_struct =
+    SHELL_CMD_EXT("evqprof", evqprof_shell_cmd, NULL);
+
+static void
+evqprof_shell_cbs(struct streamer *streamer)
+{
+    struct evqprof_cb c;
+    int i;
+
+    streamer_printf(streamer, "%10s %10s %8s %18s %18s\n",
+                    "evq", "cb", "count", "wait avg/max us",
+                    "run avg/max us");
+    for (i = evqprof_cb_get_next(0, &c);
+         i >= 0;
+         i = evqprof_cb_get_next(i + 1, &c)) {
+
+        streamer_printf(streamer, "0x%08lx 0x%08lx %8lu %8lu/%-9lu "
+                        "%8lu/%-9lu\n",
+                        (unsigned long)(uintptr_t)c.epc_evq,
+                        (unsigned long)(uintptr_t)c.epc_cb,
+                        (unsigned long)c.epc_cnt,
+                        (unsigned long)(c.epc_wait_sum / c.epc_cnt),
+                        (unsigned long)c.epc_wait_max,
+                        (unsigned long)(c.epc_run_sum / c.epc_cnt),
+                        (unsigned long)c.epc_run_max);
+    }
+    streamer_printf(streamer, "dropped %lu\n",
+                    (unsigned long)evqprof_dropped_get());
+}
+
+static void
+evqprof_shell_hist_row(struct streamer *streamer, const char *name,
+                       const uint32_t *hist)
+{
+    int b;
+
+    streamer_printf(streamer, "  %s:", name);
+    for (b = 0; b < EVQPROF_BUCKETS; b++) {
+        if (hist[b]) {
+            streamer_printf(streamer, " %lu%s:%lu",
+                            (unsigned long)evqprof_bucket_floor(b),
+                            b == EVQPROF_BUCKETS - 1 ? "+" : "",
+                            (unsigned long)hist[b]);
+        }
+    }
+    streamer_printf(streamer, "\n");
+}
+
+static void
+evqprof_shell_hist(struct streamer *streamer)
+{
+    struct evqprof_cb c;
+    int i;
+
+    /* Nonzero buckets only, as <lowest us in bucket>:<count> */
+    for (i = evqprof_cb_get_next(0, &c);
+         i >= 0;
+         i = evqprof_cb_get_next(i + 1, &c)) {
+
+        streamer_printf(streamer, "evq 0x%08lx cb 0x%08lx\n",
+                        (unsigned long)(uintptr_t)c.epc_evq,
+                        (unsigned long)(uintptr_t)c.epc_cb);
+        evqprof_shell_hist_row(streamer, "wait", c.epc_wait_hist);
+        evqprof_shell_hist_row(streamer, "run", c.epc_run_hist);
+    }
+}
+
+static int
+evqprof_shell_cmd(const struct shell_cmd *cmd, int argc, char **argv,
+                  struct streamer *streamer)
+{
+    if (argc < 2 || strcmp(argv[1], "cbs") == 0) {
+        evqprof_shell_cbs(streamer);
+        return 0;
+    }
+
+    if (strcmp(argv[1], "hist") == 0) {
+        evqprof_shell_hist(streamer);
+        return 0;
+    }
+
+    if (strcmp(argv[1], "reset") == 0) {
+        evqprof_reset();
+        return 0;
+    }
+
+    streamer_printf(streamer, "usage: evqprof [cbs|hist|reset]\n");
+    return SYS_EINVAL;
+}
+
+int
+evqprof_shell_register(void)
+{
+    return shell_cmd_register(&evqprof_shell_cmd_struct);
+}
+
+#endif
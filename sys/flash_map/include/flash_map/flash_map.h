@@ -43,6 +43,10 @@ extern "C" {
  */
 #include <stdbool.h>
 #include <inttypes.h>
+#include "syscfg/syscfg.h"
+#if MYNEWT_VAL(FLASH_MAP_ASYNC)
+#include "os/os_callout.h"
+#endif
 
 struct flash_area {
     uint8_t fa_id;
@@ -87,6 +91,55 @@ int flash_area_write(const struct flash_area *, uint32_t off, const void *src,
   uint32_t len);
 int flash_area_erase(const struct flash_area *, uint32_t off, uint32_t len);
 
+/*
+ * Direct read access. On success *ptr points to len bytes of the area at off,
+ * readable in place; valid until the range is written or erased. Returns
+ * SYS_ENOTSUP if the device is not memory-mapped, in which case the caller
+ * falls back to flash_area_read().
+ */
+int flash_area_map(const struct flash_area *, uint32_t off, uint32_t len,
+  const void **ptr);
+
+/** nothing to do for now */
+#define flash_area_unmap(flash_area, ptr)
+
+#if MYNEWT_VAL(FLASH_MAP_ASYNC)
+struct flash_area_op;
+
+/*
+ * Called from the default event queue when an asynchronous operation
+ * finishes.  rc is 0 on success.
+ */
+typedef void (*flash_area_op_cb)(struct flash_area_op *op, int rc);
+
+/*
+ * State of one asynchronous write/erase.  Owned by the caller and must stay
+ * valid, along with the source buffer, until the callback has been invoked.
+ */
+struct flash_area_op {
+    const struct flash_area *fao_fa;
+    uint32_t fao_off;
+    const uint8_t *fao_src;         /* NULL for erase */
+    uint32_t fao_len;
+    flash_area_op_cb fao_cb;
+    void *fao_arg;
+    struct os_callout fao_callout;
+};
+
+/*
+ * Non-blocking write/erase.  Work is done a page or sector at a time from the
+ * default event queue, polling the device between steps instead of blocking.
+ * Devices without a non-blocking driver interface fall back to the blocking
+ * calls, one step per event.
+ */
+int flash_area_write_async(struct flash_area_op *op,
+  const struct flash_area *fa, uint32_t off, const void *src, uint32_t len,
+  flash_area_op_cb cb, void *arg);
+int flash_area_erase_async(struct flash_area_op *op,
+  const struct flash_area *fa, uint32_t off, uint32_t len,
+  flash_area_op_cb cb, void *arg);
+#endif
+
 /*
  * Whether the whole area is empty.
  */
@@ -122,6 +175,12 @@ int flash_area_to_sectors(int idx, int *cnt, struct flash_area *ret);
 int flash_area_to_sector_ranges(int id, int *cnt,
   struct flash_sector_range *ret);
 
+/*
+ * Given offset within flash area, return info about the sector containing it.
+ */
+int flash_area_sector_from_off(const struct flash_area *fa, uint32_t off,
+  struct flash_area *sector);
+
 /*
  * Get-next interface for obtaining info about sectors.
  * To start the get-next walk, call with *sec_id set to -1.
@@ -0,0 +1,98 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "flash_map_test.h"
+
+#if MYNEWT_VAL(FLASH_MAP_ASYNC)
+static int flash_map_test_op_rc;
+static int flash_map_test_op_done;
+
+static void
+flash_map_test_op_cb(struct flash_area_op *op, int rc)
+{
+    TEST_ASSERT(op->fao_arg == &flash_map_test_op_done);
+    flash_map_test_op_rc = rc;
+    flash_map_test_op_done = 1;
+}
+
+static void
+flash_map_test_op_wait(void)
+{
+    while (!flash_map_test_op_done) {
+        os_eventq_run(os_eventq_dflt_get());
+    }
+    flash_map_test_op_done = 0;
+}
+#endif
+
+/*
+ * Test flash_area_write_async() / flash_area_erase_async()
+ */
+TEST_CASE_SELF(flash_map_test_case_4)
+{
+#if MYNEWT_VAL(FLASH_MAP_ASYNC)
+    const struct flash_area *fa;
+    struct flash_area_op op;
+    uint32_t off;
+    uint8_t wd[512];
+    uint8_t rd[512];
+    int i;
+    int rc;
+
+    rc = flash_area_open(FLASH_AREA_IMAGE_1, &fa);
+    TEST_ASSERT_FATAL(rc == 0, "flash_area_open() fail");
+
+    rc = flash_area_erase_async(&op, fa, 0, fa->fa_size, flash_map_test_op_cb,
+                                &flash_map_test_op_done);
+    TEST_ASSERT_FATAL(rc == 0, "flash_area_erase_async() fail");
+    flash_map_test_op_wait();
+    TEST_ASSERT_FATAL(flash_map_test_op_rc == 0, "async erase failed");
+
+    for (i = 0; i < sizeof(wd); i++) {
+        wd[i] = i;
+    }
+
+    /* Unaligned start so the write straddles a page boundary. */
+    off = 100;
+    rc = flash_area_write_async(&op, fa, off, wd, sizeof(wd),
+                                flash_map_test_op_cb, &flash_map_test_op_done);
+    TEST_ASSERT_FATAL(rc == 0, "flash_area_write_async() fail");
+    flash_map_test_op_wait();
+    TEST_ASSERT_FATAL(flash_map_test_op_rc == 0, "async write failed");
+
+    rc = flash_area_read(fa, off, rd, sizeof(rd));
+    TEST_ASSERT_FATAL(rc == 0, "flash_area_read() fail");
+    TEST_ASSERT(memcmp(wd, rd, sizeof(rd)) == 0);
+
+    /* Out of bounds requests are rejected up front. */
+    rc = flash_area_write_async(&op, fa, fa->fa_size, wd, 1,
+                                flash_map_test_op_cb, &flash_map_test_op_done);
+    TEST_ASSERT(rc != 0);
+
+    rc = flash_area_erase_async(&op, fa, 0, fa->fa_size, flash_map_test_op_cb,
+                                &flash_map_test_op_done);
+    TEST_ASSERT_FATAL(rc == 0, "flash_area_erase_async() fail");
+    flash_map_test_op_wait();
+    TEST_ASSERT_FATAL(flash_map_test_op_rc == 0, "async erase failed");
+
+    memset(wd, 0xff, sizeof(wd));
+    rc = flash_area_read(fa, off, rd, sizeof(rd));
+    TEST_ASSERT_FATAL(rc == 0, "flash_area_read() fail");
+    TEST_ASSERT(memcmp(wd, rd, sizeof(rd)) == 0);
+#endif
+}
@@ -0,0 +1,63 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "flash_map_test.h"
+
+extern int flash_map_entries;
+extern struct flash_area *fa_sectors;
+
+/*
+ * Test flash_area_sector_from_off() vs flash_area_to_sectors()
+ */
+TEST_CASE_SELF(flash_map_test_case_5)
+{
+    const struct flash_area *fa;
+    struct flash_area sector;
+    int sec_cnt;
+    int i;
+    int j;
+    int rc;
+
+    for (i = 0; i < flash_map_entries; i++) {
+        rc = flash_area_open(flash_map[i].fa_id, &fa);
+        TEST_ASSERT_FATAL(rc == 0, "flash_area_open() fail");
+
+        rc = flash_area_to_sectors(fa->fa_id, &sec_cnt, fa_sectors);
+        TEST_ASSERT_FATAL(rc == 0, "flash_area_to_sectors failed");
+
+        for (j = 0; j < sec_cnt; j++) {
+            /* First and last byte of every sector */
+            rc = flash_area_sector_from_off(fa,
+                                            fa_sectors[j].fa_off - fa->fa_off,
+                                            &sector);
+            TEST_ASSERT_FATAL(rc == 0);
+            TEST_ASSERT(sector.fa_off == fa_sectors[j].fa_off);
+            TEST_ASSERT(sector.fa_size == fa_sectors[j].fa_size);
+
+            rc = flash_area_sector_from_off(fa, fa_sectors[j].fa_off +
+                                            fa_sectors[j].fa_size - 1 -
+                                            fa->fa_off, &sector);
+            TEST_ASSERT_FATAL(rc == 0);
+            TEST_ASSERT(sector.fa_off == fa_sectors[j].fa_off);
+            TEST_ASSERT(sector.fa_size == fa_sectors[j].fa_size);
+        }
+
+        rc = flash_area_sector_from_off(fa, fa->fa_size, &sector);
+        TEST_ASSERT(rc != 0);
+    }
+}
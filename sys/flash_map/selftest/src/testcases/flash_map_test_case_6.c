@@ -0,0 +1,54 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "flash_map_test.h"
+
+/*
+ * Test flash_area_map() sees what flash_area_write() wrote
+ */
+TEST_CASE_SELF(flash_map_test_case_6)
+{
+    const struct flash_area *fa;
+    const void *ptr;
+    uint8_t wd[256];
+    int rc;
+    int i;
+
+    rc = flash_area_open(FLASH_AREA_IMAGE_0, &fa);
+    TEST_ASSERT_FATAL(rc == 0, "flash_area_open() fail");
+
+    rc = flash_area_erase(fa, 0, fa->fa_size);
+    TEST_ASSERT_FATAL(rc == 0, "flash_area_erase() fail");
+
+    for (i = 0; i < sizeof(wd); i++) {
+        wd[i] = i;
+    }
+    rc = flash_area_write(fa, 16, wd, sizeof(wd));
+    TEST_ASSERT_FATAL(rc == 0, "flash_area_write() fail");
+
+    rc = flash_area_map(fa, 16, sizeof(wd), &ptr);
+    TEST_ASSERT_FATAL(rc == 0, "flash_area_map() fail");
+    TEST_ASSERT(memcmp(ptr, wd, sizeof(wd)) == 0);
+    flash_area_unmap(fa, ptr);
+
+    /* Past the end of the area */
+    rc = flash_area_map(fa, fa->fa_size - 8, 16, &ptr);
+    TEST_ASSERT(rc != 0);
+
+    flash_area_close(fa);
+}
@@ -31,6 +31,104 @@
 const struct flash_area *flash_map;
 int flash_map_entries;
 
+#if MYNEWT_VAL(FLASH_MAP_SECTOR_CACHE)
+/*
+ * Sector ranges of every flash area, built once the flash map is final.
+ * Lets the sector queries below run without calling into flash drivers.
+ */
+static struct flash_sector_range
+    flash_map_ranges[MYNEWT_VAL(FLASH_MAP_SECTOR_CACHE)];
+/* Device sector index of the first sector of each range */
+static uint16_t flash_map_range_idx[MYNEWT_VAL(FLASH_MAP_SECTOR_CACHE)];
+static struct {
+    uint16_t first;
+    uint16_t cnt;
+} flash_map_area_ranges[MYNEWT_VAL(FLASH_MAP_MAX_AREAS)];
+static bool flash_map_cached;
+
+static int flash_area_to_sector_ranges_hal(int id, int *cnt,
+  struct flash_sector_range *ret);
+
+static void
+flash_map_cache_build(void)
+{
+    const struct flash_area *fa;
+    const struct hal_flash *hf;
+    struct flash_sector_range *fsr;
+    uint32_t start;
+    uint32_t size;
+    int used;
+    int cnt;
+    int rc;
+    int i;
+    int j;
+    int k;
+
+    flash_map_cached = false;
+    if (flash_map_entries > MYNEWT_VAL(FLASH_MAP_MAX_AREAS)) {
+        return;
+    }
+
+    used = 0;
+    for (i = 0; i < flash_map_entries; i++) {
+        fa = &flash_map[i];
+        cnt = 0;
+        rc = flash_area_to_sector_ranges_hal(fa->fa_id, &cnt, NULL);
+        if (rc != 0 || used + cnt > MYNEWT_VAL(FLASH_MAP_SECTOR_CACHE)) {
+            return;
+        }
+        rc = flash_area_to_sector_ranges_hal(fa->fa_id, &cnt,
+                                             &flash_map_ranges[used]);
+        if (rc != 0) {
+            return;
+        }
+
+        /* Remember where in the device each range starts for getnext. */
+        hf = hal_bsp_flash_dev(fa->fa_device_id);
+        k = 0;
+        for (j = 0; j < cnt; j++) {
+            fsr = &flash_map_ranges[used + j];
+            for (; k < hf->hf_sector_cnt; k++) {
+                hf->hf_itf->hff_sector_info(hf, k, &start, &size);
+                if (start == fsr->fsr_flash_area.fa_off) {
+                    break;
+                }
+            }
+            flash_map_range_idx[used + j] = k;
+        }
+
+        flash_map_area_ranges[i].first = used;
+        flash_map_area_ranges[i].cnt = cnt;
+        used += cnt;
+    }
+    flash_map_cached = true;
+}
+
+/*
+ * Returns cached sector ranges of flash area with given id, or NULL if there
+ * is no cache.
+ */
+static struct flash_sector_range *
+flash_map_cache_find(int id, int *cnt, uint16_t **idx)
+{
+    int i;
+
+    if (!flash_map_cached) {
+        return NULL;
+    }
+    for (i = 0; i < flash_map_entries; i++) {
+        if (flash_map[i].fa_id == id) {
+            *cnt = flash_map_area_ranges[i].cnt;
+            if (idx) {
+                *idx = &flash_map_range_idx[flash_map_area_ranges[i].first];
+            }
+            return &flash_map_ranges[flash_map_area_ranges[i].first];
+        }
+    }
+    return NULL;
+}
+#endif
+
 int
 flash_area_open(uint8_t id, const struct flash_area **fap)
 {
@@ -57,6 +155,11 @@ flash_area_to_sectors(int id, int *cnt, struct flash_area *ret)
 {
     const struct flash_area *fa;
     const struct hal_flash *hf;
+#if MYNEWT_VAL(FLASH_MAP_SECTOR_CACHE)
+    const struct flash_sector_range *fsr;
+    int range_cnt;
+    int j;
+#endif
     uint32_t start;
     uint32_t size;
     int rc;
@@ -69,6 +172,26 @@ flash_area_to_sectors(int id, int *cnt, struct flash_area *ret)
 
     *cnt = 0;
 
+#if MYNEWT_VAL(FLASH_MAP_SECTOR_CACHE)
+    fsr = flash_map_cache_find(id, &range_cnt, NULL);
+    if (fsr) {
+        for (i = 0; i < range_cnt; i++, fsr++) {
+            for (j = 0; j < fsr->fsr_sector_count; j++) {
+                if (ret) {
+                    ret->fa_id = id;
+                    ret->fa_device_id = fa->fa_device_id;
+                    ret->fa_off = fsr->fsr_flash_area.fa_off +
+                                  j * fsr->fsr_sector_size;
+                    ret->fa_size = fsr->fsr_sector_size;
+                    ret++;
+                }
+                (*cnt)++;
+            }
+        }
+        return 0;
+    }
+#endif
+
     hf = hal_bsp_flash_dev(fa->fa_device_id);
     for (i = 0; i < hf->hf_sector_cnt; i++) {
         hf->hf_itf->hff_sector_info(hf, i, &start, &size);
@@ -94,8 +217,14 @@ flash_range_end(const struct flash_sector_range *range)
         range->fsr_sector_count * range->fsr_sector_size;
 }
 
+#if MYNEWT_VAL(FLASH_MAP_SECTOR_CACHE)
+static int
+flash_area_to_sector_ranges_hal(int id, int *cnt,
+  struct flash_sector_range *ret)
+#else
 int
 flash_area_to_sector_ranges(int id, int *cnt, struct flash_sector_range *ret)
+#endif
 {
     const struct flash_area *fa;
     const struct hal_flash *hf;
@@ -166,6 +295,8 @@ flash_area_to_sector_ranges(int id, int *cnt, struct flash_sector_range *ret)
             current->fsr_first_sector = (uint16_t)sector_in_ranges;
             current->fsr_range_start = offset;
             current->fsr_align = hal_flash_align(fa->fa_device_id);
+            offset += size;
+            sector_in_ranges++;
         }
     }
     *cnt = range_count;
@@ -174,11 +305,41 @@ flash_area_to_sector_ranges(int id, int *cnt, struct flash_sector_range *ret)
     return 0;
 }
 
+#if MYNEWT_VAL(FLASH_MAP_SECTOR_CACHE)
+int
+flash_area_to_sector_ranges(int id, int *cnt, struct flash_sector_range *ret)
+{
+    const struct flash_sector_range *fsr;
+    int range_cnt;
+
+    fsr = flash_map_cache_find(id, &range_cnt, NULL);
+    if (!fsr) {
+        return flash_area_to_sector_ranges_hal(id, cnt, ret);
+    }
+
+    if (ret) {
+        if (*cnt > 0 && *cnt < range_cnt) {
+            range_cnt = *cnt;
+        }
+        memcpy(ret, fsr, range_cnt * sizeof(*ret));
+    }
+    *cnt = range_cnt;
+
+    return 0;
+}
+#endif
+
 int
 flash_area_getnext_sector(int id, int *sec_id, struct flash_area *ret)
 {
     const struct flash_area *fa;
     const struct hal_flash *hf;
+#if MYNEWT_VAL(FLASH_MAP_SECTOR_CACHE)
+    const struct flash_sector_range *fsr;
+    uint16_t *idx;
+    int range_cnt;
+    int j;
+#endif
     uint32_t start;
     uint32_t size;
     int rc;
@@ -192,8 +353,30 @@ flash_area_getnext_sector(int id, int *sec_id, struct flash_area *ret)
         rc = SYS_EINVAL;
         goto end;
     }
-    hf = hal_bsp_flash_dev(fa->fa_device_id);
     i = *sec_id + 1;
+#if MYNEWT_VAL(FLASH_MAP_SECTOR_CACHE)
+    fsr = flash_map_cache_find(id, &range_cnt, &idx);
+    if (fsr) {
+        for (j = 0; j < range_cnt; j++, fsr++) {
+            if (i < idx[j] + fsr->fsr_sector_count) {
+                if (i < idx[j]) {
+                    i = idx[j];
+                }
+                ret->fa_id = id;
+                ret->fa_device_id = fa->fa_device_id;
+                ret->fa_off = fsr->fsr_flash_area.fa_off +
+                              (i - idx[j]) * fsr->fsr_sector_size;
+                ret->fa_size = fsr->fsr_sector_size;
+                *sec_id = i;
+                rc = 0;
+                goto end;
+            }
+        }
+        rc = SYS_ENOENT;
+        goto end;
+    }
+#endif
+    hf = hal_bsp_flash_dev(fa->fa_device_id);
     for (; i < hf->hf_sector_cnt; i++) {
         hf->hf_itf->hff_sector_info(hf, i, &start, &size);
         if (start >= fa->fa_off && start < fa->fa_off + fa->fa_size) {
@@ -212,6 +395,67 @@ end:
     return rc;
 }
 
+int
+flash_area_sector_from_off(const struct flash_area *fa, uint32_t off,
+  struct flash_area *sector)
+{
+    const struct hal_flash *hf;
+    uint32_t addr;
+    uint32_t start;
+    uint32_t size;
+    int i;
+#if MYNEWT_VAL(FLASH_MAP_SECTOR_CACHE)
+    const struct flash_sector_range *fsr;
+    int range_cnt;
+    int lo;
+    int hi;
+    int mid;
+#endif
+
+    if (off >= fa->fa_size) {
+        return SYS_EINVAL;
+    }
+    addr = fa->fa_off + off;
+
+#if MYNEWT_VAL(FLASH_MAP_SECTOR_CACHE)
+    fsr = flash_map_cache_find(fa->fa_id, &range_cnt, NULL);
+    if (fsr) {
+        lo = 0;
+        hi = range_cnt - 1;
+        while (lo <= hi) {
+            mid = (lo + hi) / 2;
+            if (addr < fsr[mid].fsr_flash_area.fa_off) {
+                hi = mid - 1;
+            } else if (addr >= flash_range_end(&fsr[mid])) {
+                lo = mid + 1;
+            } else {
+                sector->fa_id = fa->fa_id;
+                sector->fa_device_id = fa->fa_device_id;
+                start = fsr[mid].fsr_flash_area.fa_off;
+                sector->fa_off = addr - (addr - start) %
+                                 fsr[mid].fsr_sector_size;
+                sector->fa_size = fsr[mid].fsr_sector_size;
+                return 0;
+            }
+        }
+        return SYS_ENOENT;
+    }
+#endif
+
+    hf = hal_bsp_flash_dev(fa->fa_device_id);
+    for (i = 0; i < hf->hf_sector_cnt; i++) {
+        hf->hf_itf->hff_sector_info(hf, i, &start, &size);
+        if (addr >= start && addr < start + size) {
+            sector->fa_id = fa->fa_id;
+            sector->fa_device_id = fa->fa_device_id;
+            sector->fa_off = start;
+            sector->fa_size = size;
+            return 0;
+        }
+    }
+    return SYS_ENOENT;
+}
+
 int
 flash_area_read(const struct flash_area *fa, uint32_t off, void *dst,
     uint32_t len)
@@ -222,6 +466,16 @@ flash_area_read(const struct flash_area *fa, uint32_t off, void *dst,
     return hal_flash_read(fa->fa_device_id, fa->fa_off + off, dst, len);
 }
 
+int
+flash_area_map(const struct flash_area *fa, uint32_t off, uint32_t len,
+    const void **ptr)
+{
+    if (off > fa->fa_size || off + len > fa->fa_size) {
+        return -1;
+    }
+    return hal_flash_map(fa->fa_device_id, fa->fa_off + off, len, ptr);
+}
+
 int
 flash_area_write(const struct flash_area *fa, uint32_t off, const void *src,
     uint32_t len)
@@ -242,6 +496,131 @@ flash_area_erase(const struct flash_area *fa, uint32_t off, uint32_t len)
     return hal_flash_erase(fa->fa_device_id, fa->fa_off + off, len);
 }
 
+#if MYNEWT_VAL(FLASH_MAP_ASYNC)
+/*
+ * Finds the sector of the flash device containing addr.
+ */
+static int
+flash_area_op_sector(uint8_t device_id, uint32_t addr, uint32_t *start,
+  uint32_t *size)
+{
+    const struct hal_flash *hf;
+    int i;
+
+    hf = hal_bsp_flash_dev(device_id);
+    if (!hf) {
+        return SYS_EINVAL;
+    }
+    for (i = 0; i < hf->hf_sector_cnt; i++) {
+        hf->hf_itf->hff_sector_info(hf, i, start, size);
+        if (addr >= *start && addr < *start + *size) {
+            return 0;
+        }
+    }
+    return SYS_EINVAL;
+}
+
+static void
+flash_area_op_event(struct os_event *ev)
+{
+    struct flash_area_op *op;
+    uint8_t id;
+    uint32_t addr;
+    uint32_t start;
+    uint32_t size;
+    int rc;
+
+    op = ev->ev_arg;
+    id = op->fao_fa->fa_device_id;
+
+    rc = hal_flash_is_busy(id);
+    if (rc > 0) {
+        os_callout_reset(&op->fao_callout,
+                         MYNEWT_VAL(FLASH_MAP_ASYNC_POLL_TICKS));
+        return;
+    }
+    if (rc < 0 || op->fao_len == 0) {
+        goto done;
+    }
+
+    addr = op->fao_fa->fa_off + op->fao_off;
+    if (op->fao_src) {
+        rc = hal_flash_write_start(id, addr, op->fao_src, op->fao_len);
+        if (rc == SYS_ENOTSUP) {
+            rc = hal_flash_write(id, addr, op->fao_src, op->fao_len);
+            if (rc == 0) {
+                rc = op->fao_len;
+            }
+        }
+        if (rc < 0) {
+            goto done;
+        }
+        size = rc;
+        op->fao_src += size;
+    } else {
+        rc = flash_area_op_sector(id, addr, &start, &size);
+        if (rc) {
+            goto done;
+        }
+        rc = hal_flash_erase_sector_start(id, start);
+        if (rc == SYS_ENOTSUP) {
+            rc = hal_flash_erase_sector(id, start);
+        }
+        if (rc) {
+            goto done;
+        }
+        size = start + size - addr;
+        if (size > op->fao_len) {
+            size = op->fao_len;
+        }
+    }
+    op->fao_off += size;
+    op->fao_len -= size;
+
+    os_callout_reset(&op->fao_callout, MYNEWT_VAL(FLASH_MAP_ASYNC_POLL_TICKS));
+    return;
+
+done:
+    op->fao_cb(op, rc);
+}
+
+static int
+flash_area_op_start(struct flash_area_op *op, const struct flash_area *fa,
+  uint32_t off, const void *src, uint32_t len, flash_area_op_cb cb, void *arg)
+{
+    if (off > fa->fa_size || off + len > fa->fa_size) {
+        return -1;
+    }
+
+    op->fao_fa = fa;
+    op->fao_off = off;
+    op->fao_src = src;
+    op->fao_len = len;
+    op->fao_cb = cb;
+    op->fao_arg = arg;
+    os_callout_init(&op->fao_callout, os_eventq_dflt_get(),
+                    flash_area_op_event, op);
+    os_eventq_put(os_eventq_dflt_get(), &op->fao_callout.c_ev);
+
+    return 0;
+}
+
+int
+flash_area_write_async(struct flash_area_op *op, const struct flash_area *fa,
+  uint32_t off, const void *src, uint32_t len, flash_area_op_cb cb, void *arg)
+{
+    assert(src != NULL);
+    return flash_area_op_start(op, fa, off, src, len, cb, arg);
+}
+
+int
+flash_area_erase_async(struct flash_area_op *op, const struct flash_area *fa,
+  uint32_t off, uint32_t len, flash_area_op_cb cb, void *arg)
+{
+    return flash_area_op_start(op, fa, off, NULL, len, cb, arg);
+}
+#endif
+
 uint8_t
 flash_area_align(const struct flash_area *fa)
 {
@@ -424,4 +803,8 @@ flash_map_init(void)
         flash_map = mfg_areas;
         flash_map_entries = num_areas;
     }
+
+#if MYNEWT_VAL(FLASH_MAP_SECTOR_CACHE)
+    flash_map_cache_build();
+#endif
 }
@@ -74,6 +74,8 @@ struct log;
 #if MYNEWT_VAL(LOG_VERSION) > 2
 #define LOG_ETYPE_CBOR           (1)
 #define LOG_ETYPE_BINARY         (2)
+/* Format string token followed by binary-encoded arguments */
+#define LOG_ETYPE_TOKEN          (3)
 #endif
 
 /* UTC Timestamp for Jan 2016 00:00:00 */
@@ -19,6 +19,7 @@
 #ifndef __SYS_LOG_FULL_H__
 #define __SYS_LOG_FULL_H__
 
+#include <stdarg.h>
 #include "os/mynewt.h"
 #include "cbmem/cbmem.h"
 #include "log_common/log_common.h"
@@ -62,6 +63,30 @@ struct log_offset {
     void *lo_arg;
 };
 
+/** Only match entries from the module in `lf_module`. */
+#define LOG_FILTER_F_MODULE     0x01
+
+/**
+ * Used with log_walk_body_filtered(); entries whose header does not match
+ * are skipped without reading their body.
+ */
+struct log_filter {
+    /* Only match entries whose ts >= lf_ts_min; 0 for no lower bound. */
+    int64_t lf_ts_min;
+
+    /* Only match entries whose ts < lf_ts_max; 0 for no upper bound. */
+    int64_t lf_ts_max;
+
+    /* Only match entries whose level >= lf_level. */
+    uint8_t lf_level;
+
+    /* Only match entries from this module if LOG_FILTER_F_MODULE is set. */
+    uint8_t lf_module;
+
+    /* LOG_FILTER_F_[...] flags. */
+    uint8_t lf_flags;
+};
+
 #if MYNEWT_VAL(LOG_STORAGE_INFO)
 /**
  * Log storage information
@@ -131,6 +156,8 @@ struct log_handler {
 
 /* Flags used to indicate type of data in reserved payload*/
 #define LOG_FLAGS_IMG_HASH (1 << 0)
+/* The entry body is LZF-compressed (LOG_COMPRESS) */
+#define LOG_FLAGS_COMPRESSED (1 << 1)
 
 #if MYNEWT_VAL(LOG_VERSION) == 2
 struct log_entry_hdr {
@@ -515,6 +542,85 @@ log_append_mbuf(struct log *log, uint8_t module, uint8_t level,
 
 void log_printf(struct log *log, uint8_t module, uint8_t level,
         const char *msg, ...);
+
+#if MYNEWT_VAL(LOG_TOKENIZED)
+/**
+ * @brief Places a format string in the token dictionary.
+ *
+ * Evaluates to a pointer to a copy of the string literal fmt_ that is placed
+ * in the ".log_fmt" section.  The 32-bit address of that copy is the string's
+ * token; a host tool maps tokens back to format strings using the section
+ * contents of the image's ELF file, e.g.:
+ *     objcopy -O binary -j .log_fmt app.elf log_fmt.bin
+ */
+#define LOG_TOKEN_FMT(fmt_) ({                                              \
+    static const char log_token_fmt_[]                                      \
+        __attribute__((section(".log_fmt"), used)) = fmt_;                  \
+    log_token_fmt_;                                                         \
+})
+
+/**
+ * @brief Writes a tokenized entry to the specified log.
+ *
+ * Like log_printf(), but the format string is not expanded.  The entry
+ * (LOG_ETYPE_TOKEN) holds the format string's token followed by the
+ * arguments in binary:
+ *     o The token: 4 bytes, little endian.
+ *     o Integers, characters, pointers and '*' widths/precisions: LEB128
+ *       varints; signed conversions are zigzag encoded first.
+ *     o Floating point: 8-byte IEEE double, little endian.
+ *     o Strings: a length byte followed by that many bytes.
+ * The console log and the "log" shell command expand these entries back to
+ * text if LOG_TOKEN_FMT_ON_TARGET is enabled.
+ *
+ * fmt must come from LOG_TOKEN_FMT(); use LOG_TPRINTF() rather than calling
+ * this directly.
+ *
+ * @param log                   The log to write to.
+ * @param module                The module ID of the entry to write.
+ * @param level                 The severity of the entry to write.
+ * @param fmt                   The dictionary format string.
+ */
+void log_tprintf(struct log *log, uint8_t module, uint8_t level,
+                 const char *fmt, ...);
+
+#define LOG_TPRINTF(log_, mod_, lvl_, fmt_, ...)                            \
+    log_tprintf((log_), (mod_), (lvl_), LOG_TOKEN_FMT(fmt_), ##__VA_ARGS__)
+
+/**
+ * @brief Encodes a tokenized entry body.
+ *
+ * @param buf                   The buffer to encode into.
+ * @param buf_len               The size of buf, in bytes.  Arguments that do
+ *                                  not fit are dropped.
+ * @param fmt                   The dictionary format string.
+ * @param ap                    The arguments to encode.
+ *
+ * @return                      The length of the encoded body.
+ */
+int log_token_vencode(void *buf, uint16_t buf_len, const char *fmt,
+                      va_list ap);
+
+/**
+ * @brief Expands a tokenized entry body to text.
+ *
+ * Only possible if the ".log_fmt" section is part of the loaded image
+ * (LOG_TOKEN_FMT_ON_TARGET).
+ *
+ * @param dst                   The buffer to write the text to.
+ * @param dst_len               The size of dst, in bytes.
+ * @param body                  The entry body.
+ * @param body_len              The length of the entry body.
+ *
+ * @return                      The length of the text, which is always
+ *                                  null-terminated and truncated to fit;
+ *                              SYS_ENOTSUP if the format strings are not on
+ *                                  the target;
+ *                              SYS_EINVAL if the body is malformed.
+ */
+int log_token_format(char *dst, int dst_len, const void *body,
+                     uint16_t body_len);
+#endif
 int log_read(struct log *log, const void *dptr, void *buf, uint16_t off,
         uint16_t len);
 
@@ -553,6 +659,9 @@ log_hdr_len(const struct log_entry_hdr *hdr);
  *                                  start the read.
  * @param len                   The number of bytes to read.
  *
+ * A compressed entry (LOG_FLAGS_COMPRESSED) is decompressed first; off and
+ * len always refer to the original body.
+ *
  * @return                      The number of bytes actually read on success;
  *                              -1 on failure.
  */
@@ -572,6 +681,9 @@ int log_read_mbuf(struct log *log, const void *dptr, struct os_mbuf *om, uint16_
  *                                  start the read.
  * @param len                   The number of bytes to read.
  *
+ * A compressed entry (LOG_FLAGS_COMPRESSED) is decompressed first; off and
+ * len always refer to the original body.
+ *
  * @return                      The number of bytes actually read on success;
  *                              -1 on failure.
  */
@@ -597,6 +709,28 @@ int log_walk(struct log *log, log_walk_func_t walk_func,
  */
 int log_walk_body(struct log *log, log_walk_body_func_t walk_body_func,
         struct log_offset *log_offset);
+
+/**
+ * @brief Applies a callback to each message in the specified log that matches
+ * a filter.
+ *
+ * Similar to `log_walk_body`, except that only entries whose header matches
+ * the filter are passed to the callback.  The filter is checked against the
+ * entry header alone, so the body of a non-matching entry is never read.
+ * When a minimum timestamp is given and the offset does not specify one, the
+ * log handler may use it to seek (see LOG_FCB_BOOKMARKS_TS_SEEK).
+ *
+ * @param log                   The log to iterate.
+ * @param walk_body_func        The function to apply to each log entry.
+ * @param log_offset            Specifies the range of entries to process.
+ * @param filter                Header criteria entries have to match.
+ *
+ * @return                      0 if the walk completed successfully;
+ *                              nonzero on error or if the walk was aborted.
+ */
+int log_walk_body_filtered(struct log *log, log_walk_body_func_t walk_body_func,
+                           struct log_offset *log_offset,
+                           const struct log_filter *filter);
 int log_flush(struct log *log);
 
 /**
@@ -39,9 +39,11 @@ struct log_fcb_bmark {
 #endif
     /* The index of the log entry that the FCB entry contains. */
     uint32_t lfb_index;
+    /* The timestamp of the log entry that the FCB entry contains. */
+    int64_t lfb_ts;
 };
 
-/** A set of fcb log bookmarks. */
+/** A set of fcb log bookmarks, sorted by entry index. */
 struct log_fcb_bset {
     /** Array of bookmarks. */
     struct log_fcb_bmark *lfs_bmarks;
@@ -52,8 +54,8 @@ struct log_fcb_bset {
     /** The number of currently usable bookmarks. */
     int lfs_size;
 
-    /** The index where the next bookmark will get written. */
-    int lfs_next;
+    /** The minimum index distance between two adjacent bookmarks. */
+    uint32_t lfs_gap;
 };
 
 /**
@@ -94,17 +96,22 @@ struct fcb_log {
 
 /**
  * Bookmarks are an optimization to speed up lookups in FCB-backed logs.  The
- * concept is simple: maintain a set of flash area+offset pairs corresponding
- * to recently found log entries.  When we perform a log lookup, the walk
+ * concept is simple: maintain a sparse index of flash area+offset pairs
+ * corresponding to log entries.  When we perform a log lookup, the walk
  * starts from the bookmark closest to our desired entry rather than from the
  * beginning of the log.
  *
- * Bookmarks are stored in a circular buffer in the fcb_log object.  Each time
- * the log is walked, the starting point of the walk is added to the set of
- * bookmarks.
+ * Bookmarks are kept sorted by entry index in the buffer supplied to
+ * log_fcb_init_bmarks(), so the closest one is found with a binary search.
+ * A bookmark is added for every appended entry and for every entry visited
+ * while searching the log, as long as it is at least a minimum distance (in
+ * entry indices) away from its neighbours.  When the buffer fills up, the
+ * minimum distance is doubled and every other bookmark is discarded, so the
+ * index always spans the whole log.  The index is rebuilt from the first
+ * lookups after a reboot.
  *
- * FCB rotation invalidates all bookmarks.  It is up to the client code to
- * clear a log's bookmarks whenever rotation occurs.
+ * When the FCB rotates, the bookmarks pointing into the erased area are
+ * discarded.
  */
 
 /**
@@ -138,19 +145,45 @@ const struct log_fcb_bmark *
 log_fcb_closest_bmark(const struct fcb_log *fcb_log, uint32_t index);
 
 /**
- * Inserts a bookmark into the provided log.
+ * @brief Searches an fcb_log for the last bookmark whose timestamp is older
+ * than the one specified.
+ *
+ * Assumes timestamps are non-decreasing, i.e., the clock was not set back
+ * while the entries covered by the bookmarks were logged.
+ *
+ * @param fcb_log               The log to search.
+ * @param ts                    The timestamp to look for.
+ *
+ * @return                      The closest bookmark on success;
+ *                              NULL if the log has no applicable bookmarks.
+ */
+const struct log_fcb_bmark *
+log_fcb_closest_bmark_ts(const struct fcb_log *fcb_log, int64_t ts);
+
+/**
+ * Inserts a bookmark into the provided log.  The bookmark is not added if
+ * another one with a nearby index already exists.
  *
  * @param fcb_log               The log to insert a bookmark into.
  * @param entry                 The entry the bookmark should point to.
  * @param index                 The log entry index of the bookmark.
+ * @param ts                    The log entry timestamp of the bookmark.
  */
 #if MYNEWT_VAL(LOG_FCB)
 void log_fcb_add_bmark(struct fcb_log *fcb_log, const struct fcb_entry *entry,
-                       uint32_t index);
+                       uint32_t index, int64_t ts);
 #elif MYNEWT_VAL(LOG_FCB2)
 void log_fcb_add_bmark(struct fcb_log *fcb_log, const struct fcb2_entry *entry,
-                       uint32_t index);
+                       uint32_t index, int64_t ts);
 #endif
+
+/**
+ * @brief Discards the bookmarks pointing into the oldest area of the FCB.
+ * Must be called right before the FCB is rotated.
+ *
+ * @param fcb_log               The log about to be rotated.
+ */
+void log_fcb_rotate_bmarks(struct fcb_log *fcb_log);
 #endif
 
 #ifdef __cplusplus
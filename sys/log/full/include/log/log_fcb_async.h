@@ -0,0 +1,117 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef __SYS_LOG_FCB_ASYNC_H__
+#define __SYS_LOG_FCB_ASYNC_H__
+
+#include "syscfg/syscfg.h"
+
+#if MYNEWT_VAL(LOG_FCB_ASYNC)
+
+#include "log/log.h"
+#include "cbmem/cbmem.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Staging buffer overflow policies.
+ */
+/** Discard the new entry. */
+#define LOG_FCB_ASYNC_DROP          0
+/** Wait for the writer task to make room. */
+#define LOG_FCB_ASYNC_BLOCK         1
+/** Discard the oldest staged entries. */
+#define LOG_FCB_ASYNC_OVERWRITE     2
+
+/*
+ * Argument for log_fcb_async_handler
+ *
+ * log_fcb_async_init() shall be used to initialize this structure.
+ *
+ * Entries appended to the log are staged in one of two RAM buffers and a
+ * low priority writer task commits a whole buffer to the FCB at a time,
+ * while new entries are staged in the other one.  Reads and walks only see
+ * entries which have already been committed; use log_fcb_async_sync() to
+ * force staged entries out.
+ */
+struct log_fcb_async {
+    struct os_mutex lfa_mtx;
+    struct os_mutex lfa_drain_mtx;
+    struct os_sem lfa_sem;
+    struct os_callout lfa_co;
+
+    /* The registered log which uses this structure as its argument. */
+    struct log *lfa_log;
+    /* Unregistered log bound to the FCB; used by the writer task. */
+    struct log lfa_fcb;
+
+    struct cbmem lfa_cbmem[2];
+    uint8_t lfa_active;
+    uint8_t lfa_policy;
+    uint8_t lfa_waiters;
+    uint16_t lfa_cnt;
+
+    /** Number of entries discarded because no buffer space was free. */
+    uint32_t lfa_dropped;
+    /** Number of staged entries overwritten by newer ones. */
+    uint32_t lfa_overwritten;
+    /** Number of staged entries that failed to be written to flash. */
+    uint32_t lfa_errs;
+};
+
+/*
+ * Initialize log data for log_fcb_async handler
+ *
+ * The supplied buffer is split in two staging halves; an entry (header and
+ * body) has to fit in one half to be logged.  The writer task is started by
+ * the first call to this function.
+ *
+ * @param lfa            Log data structure to initialize
+ * @param fcb_arg        Log data for log_fcb; the FCB must be initialized
+ * @param buf            Staging buffer
+ * @param buf_len        Size of the staging buffer
+ * @param policy         What to do when a staging buffer is full; one of the
+ *                           LOG_FCB_ASYNC_[...] constants
+ *
+ * @return 0 on success, error code otherwise.
+ */
+int log_fcb_async_init(struct log_fcb_async *lfa, struct fcb_log *fcb_arg,
+                       void *buf, uint32_t buf_len, uint8_t policy);
+
+/*
+ * Write all staged entries to flash
+ *
+ * Commits entries from the calling context, e.g. before a reset.  Entries
+ * appended while this function runs may remain staged.
+ *
+ * @param lfa            Log data of the log to synchronize
+ */
+void log_fcb_async_sync(struct log_fcb_async *lfa);
+
+extern const struct log_handler log_fcb_async_handler;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+#endif /* __SYS_LOG_FCB_ASYNC_H__ */
@@ -0,0 +1,153 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "log_test_util/log_test_util.h"
+#include "log_test_compress.h"
+
+#define LTCU_NUM_ENTRIES    4
+
+static const char ltcu_text[] =
+    "sensor 12: temp 21.5 C; sensor 13: temp 21.5 C; sensor 14: temp 21.5 C";
+
+static uint8_t ltcu_bodies[LTCU_NUM_ENTRIES][sizeof ltcu_text];
+static uint16_t ltcu_lens[LTCU_NUM_ENTRIES];
+static bool ltcu_compressed[LTCU_NUM_ENTRIES];
+static int ltcu_idx;
+
+static int
+ltcu_walk_raw(struct log *log, struct log_offset *log_offset,
+              const void *dptr, uint16_t len)
+{
+    struct log_entry_hdr hdr;
+
+    TEST_ASSERT_FATAL(ltcu_idx < LTCU_NUM_ENTRIES);
+    TEST_ASSERT_FATAL(log_read_hdr(log, dptr, &hdr) == 0);
+
+    /* A compressed body takes less room than the original. */
+    len -= log_hdr_len(&hdr);
+    if (ltcu_compressed[ltcu_idx]) {
+        TEST_ASSERT(hdr.ue_flags & LOG_FLAGS_COMPRESSED);
+        TEST_ASSERT(len < ltcu_lens[ltcu_idx]);
+    } else {
+        TEST_ASSERT(!(hdr.ue_flags & LOG_FLAGS_COMPRESSED));
+        TEST_ASSERT(len == ltcu_lens[ltcu_idx]);
+    }
+
+    ltcu_idx++;
+
+    return 0;
+}
+
+static int
+ltcu_walk_body(struct log *log, struct log_offset *log_offset,
+               const struct log_entry_hdr *hdr, const void *dptr,
+               uint16_t len)
+{
+    uint8_t data[sizeof ltcu_text];
+    const uint8_t *exp;
+    struct os_mbuf *om;
+    int rc;
+
+    TEST_ASSERT_FATAL(ltcu_idx < LTCU_NUM_ENTRIES);
+    exp = ltcu_bodies[ltcu_idx];
+
+    /* The walk reports the original length. */
+    TEST_ASSERT_FATAL(len == ltcu_lens[ltcu_idx]);
+
+    rc = log_read_body(log, dptr, data, 0, sizeof data);
+    TEST_ASSERT(rc == len);
+    TEST_ASSERT(memcmp(data, exp, len) == 0);
+
+    /* Partial reads address the original body. */
+    if (len > 8) {
+        rc = log_read_body(log, dptr, data, 3, 5);
+        TEST_ASSERT(rc == 5);
+        TEST_ASSERT(memcmp(data, exp + 3, 5) == 0);
+
+        rc = log_read_body(log, dptr, data, len - 2, 10);
+        TEST_ASSERT(rc == 2);
+        TEST_ASSERT(memcmp(data, exp + len - 2, 2) == 0);
+    }
+
+    om = os_msys_get_pkthdr(0, 0);
+    TEST_ASSERT_FATAL(om != NULL);
+
+    rc = log_read_mbuf_body(log, dptr, om, 0, len);
+    TEST_ASSERT(rc == len);
+    TEST_ASSERT(os_mbuf_cmpf(om, 0, exp, len) == 0);
+
+    os_mbuf_free_chain(om);
+
+    ltcu_idx++;
+
+    return 0;
+}
+
+void
+ltcu_test_log(struct log *log)
+{
+    struct log_offset log_offset = { 0 };
+    struct os_mbuf *om;
+    uint32_t x;
+    int rc;
+    int i;
+
+    /* Repetitive text, both as a flat buffer and as a fragmented mbuf. */
+    for (i = 0; i < 2; i++) {
+        memcpy(ltcu_bodies[i], ltcu_text, sizeof ltcu_text);
+        ltcu_lens[i] = sizeof ltcu_text;
+        ltcu_compressed[i] = true;
+    }
+
+    /* Too short to gain anything. */
+    ltcu_bodies[2][0] = 'x';
+    ltcu_lens[2] = 1;
+    ltcu_compressed[2] = false;
+
+    /* Incompressible. */
+    x = 1;
+    for (i = 0; i < 32; i++) {
+        x = x * 1103515245 + 12345;
+        ltcu_bodies[3][i] = x >> 24;
+    }
+    ltcu_lens[3] = 32;
+    ltcu_compressed[3] = false;
+
+    for (i = 0; i < LTCU_NUM_ENTRIES; i++) {
+        if (i == 1) {
+            om = ltu_flat_to_fragged_mbuf(ltcu_bodies[i], ltcu_lens[i], 7);
+            TEST_ASSERT_FATAL(om != NULL);
+            rc = log_append_mbuf_body(log, 0, 0, LOG_ETYPE_STRING, om);
+        } else {
+            rc = log_append_body(log, 0, 0, LOG_ETYPE_BINARY, ltcu_bodies[i],
+                                 ltcu_lens[i]);
+        }
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+
+    ltcu_idx = 0;
+    rc = log_walk(log, ltcu_walk_raw, &log_offset);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(ltcu_idx == LTCU_NUM_ENTRIES);
+
+    ltcu_idx = 0;
+    rc = log_walk_body(log, ltcu_walk_body, &log_offset);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(ltcu_idx == LTCU_NUM_ENTRIES);
+}
@@ -32,6 +32,7 @@ struct ltfbu_cfg {
 
 void ltfbu_populate_log(int count);
 void ltfbu_verify_log(uint32_t start_idx);
+void ltfbu_verify_bmarks(void);
 void ltfbu_init(const struct ltfbu_cfg *cfg);
 void ltfbu_test_once(const struct ltfbu_cfg *cfg);
 
@@ -202,6 +202,32 @@ ltfbu_verify_log(uint32_t start_idx)
     TEST_ASSERT_FATAL(arg.cur == slice.count);
 }
 
+/**
+ * Verifies that the bookmarks are sorted, within capacity, and only refer to
+ * entries that are still present in the log.
+ */
+void
+ltfbu_verify_bmarks(void)
+{
+    const struct log_fcb_bset *bset;
+    int first;
+    int count;
+    int i;
+
+    bset = &ltfbu_fcb_log.fl_bset;
+    ltfbu_expected_entry_range(&first, &count);
+
+    TEST_ASSERT_FATAL(bset->lfs_size <= bset->lfs_cap);
+    for (i = 0; i < bset->lfs_size; i++) {
+        TEST_ASSERT_FATAL(bset->lfs_bmarks[i].lfb_index >=
+                          ltfbu_entry_idxs[first]);
+        if (i > 0) {
+            TEST_ASSERT_FATAL(bset->lfs_bmarks[i].lfb_index >
+                              bset->lfs_bmarks[i - 1].lfb_index);
+        }
+    }
+}
+
 void
 ltfbu_init(const struct ltfbu_cfg *cfg)
 {
@@ -258,11 +284,13 @@ ltfbu_test_once(const struct ltfbu_cfg *cfg)
      */
     for (i = 0; i < 3; i++) {
         ltfbu_populate_log(cfg->pop_count);
+        ltfbu_verify_bmarks();
 
         start_idx = 0;
         while (start_idx < ltfbu_entry_idxs[ltfbu_num_entry_idxs - 1]) {
             ltfbu_verify_log(start_idx);
             start_idx += ltfbu_skip_amount() + 1;
         }
+        ltfbu_verify_bmarks();
     }
 }
@@ -73,6 +73,9 @@ TEST_CASE_DECL(log_test_case_level);
 TEST_CASE_DECL(log_test_case_append_cb);
 
 TEST_CASE_DECL(log_test_case_2logs);
+TEST_CASE_DECL(log_test_case_fcb_async);
+TEST_CASE_DECL(log_test_case_walk_filter);
+TEST_CASE_DECL(log_test_case_tokenized);
 
 #ifdef __cplusplus
 }
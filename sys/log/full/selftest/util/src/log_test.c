@@ -53,4 +53,7 @@ TEST_SUITE(log_test_suite_misc)
 #if MYNEWT_VAL(LOG_FCB)
     log_test_case_2logs();
 #endif
+    log_test_case_fcb_async();
+    log_test_case_walk_filter();
+    log_test_case_tokenized();
 }
@@ -0,0 +1,61 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "log_test_util/log_test_util.h"
+
+#if MYNEWT_VAL(LOG_FCB_ASYNC)
+#include "log/log_fcb_async.h"
+
+static uint8_t ltu_async_buf[1024];
+#endif
+
+TEST_CASE_SELF(log_test_case_fcb_async)
+{
+#if MYNEWT_VAL(LOG_FCB_ASYNC)
+    struct log_fcb_async lfa;
+    struct fcb_log fcb_log;
+    struct log fcb_log_log;
+    struct log log;
+    char *str;
+    int rc;
+    int i;
+
+    ltu_setup_fcb(&fcb_log, &fcb_log_log);
+
+    rc = log_fcb_async_init(&lfa, &fcb_log, ltu_async_buf,
+                            sizeof ltu_async_buf, LOG_FCB_ASYNC_BLOCK);
+    TEST_ASSERT_FATAL(rc == 0);
+    log_register("async", &log, &log_fcb_async_handler, &lfa, LOG_SYSLEVEL);
+
+    for (i = 0; ; i++) {
+        str = ltu_str_logs[i];
+        if (!str) {
+            break;
+        }
+        rc = log_append_body(&log, 0, 0, LOG_ETYPE_STRING, str, strlen(str));
+        TEST_ASSERT(rc == 0);
+    }
+
+    log_fcb_async_sync(&lfa);
+    TEST_ASSERT(lfa.lfa_dropped == 0);
+    TEST_ASSERT(lfa.lfa_errs == 0);
+
+    ltu_verify_contents(&log);
+#endif
+}
@@ -0,0 +1,80 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "log_test_util/log_test_util.h"
+
+#if MYNEWT_VAL(LOG_TOKENIZED)
+static int
+ltt_walk(struct log *log, struct log_offset *log_offset,
+         const struct log_entry_hdr *hdr, const void *dptr, uint16_t len)
+{
+    uint8_t body[MYNEWT_VAL(LOG_TOKEN_MAX_LEN)];
+    char text[LOG_PRINTF_MAX_ENTRY_LEN];
+    char **exp;
+    int rc;
+
+    exp = log_offset->lo_arg;
+    TEST_ASSERT_FATAL(*exp != NULL);
+
+    TEST_ASSERT(hdr->ue_etype == LOG_ETYPE_TOKEN);
+    TEST_ASSERT_FATAL(len <= sizeof body);
+
+    /* Only the arguments are stored, not the text. */
+    TEST_ASSERT(len < strlen(*exp));
+
+    rc = log_read_body(log, dptr, body, 0, len);
+    TEST_ASSERT_FATAL(rc == len);
+
+    rc = log_token_format(text, sizeof text, body, len);
+    TEST_ASSERT(rc == strlen(*exp));
+    TEST_ASSERT(strcmp(text, *exp) == 0);
+
+    log_offset->lo_arg = exp + 1;
+
+    return 0;
+}
+#endif
+
+TEST_CASE_SELF(log_test_case_tokenized)
+{
+#if MYNEWT_VAL(LOG_TOKENIZED)
+    static char *exp[] = {
+        "conn handle=3 status=-12 rssi=-70dBm peer=fe:01",
+        "retry 2 of 8 after 'timeout' err=0x1f",
+        NULL
+    };
+    struct log_offset log_offset = { 0 };
+    struct cbmem cbmem;
+    struct log log;
+    int rc;
+
+    ltu_setup_cbmem(&cbmem, &log);
+
+    LOG_TPRINTF(&log, 0, LOG_LEVEL_INFO,
+                "conn handle=%u status=%d rssi=%ddBm peer=%02x:%02x",
+                3, -12, -70, 0xfe, 0x01);
+    LOG_TPRINTF(&log, 0, LOG_LEVEL_INFO, "retry %d of %d after '%s' err=0x%lx",
+                2, 8, "timeout", 0x1fUL);
+
+    log_offset.lo_arg = exp;
+    rc = log_walk_body(&log, ltt_walk, &log_offset);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(*(char **)log_offset.lo_arg == NULL);
+#endif
+}
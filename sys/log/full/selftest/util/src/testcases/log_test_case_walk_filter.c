@@ -0,0 +1,127 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "log_test_util/log_test_util.h"
+
+#define LTWF_NUM_ENTRIES    12
+
+struct ltwf_arg {
+    int64_t ts[LTWF_NUM_ENTRIES];
+    int count;
+};
+
+static int
+ltwf_walk(struct log *log, struct log_offset *log_offset,
+          const struct log_entry_hdr *hdr, const void *dptr, uint16_t len)
+{
+    struct ltwf_arg *arg;
+
+    arg = log_offset->lo_arg;
+    TEST_ASSERT_FATAL(arg->count < LTWF_NUM_ENTRIES);
+    arg->ts[arg->count++] = hdr->ue_ts;
+
+    return 0;
+}
+
+static int
+ltwf_count(struct log *log, const struct log_filter *filter,
+           struct ltwf_arg *arg)
+{
+    struct log_offset log_offset = { 0 };
+    int rc;
+
+    memset(arg, 0, sizeof(*arg));
+    log_offset.lo_arg = arg;
+
+    if (filter == NULL) {
+        rc = log_walk_body(log, ltwf_walk, &log_offset);
+    } else {
+        rc = log_walk_body_filtered(log, ltwf_walk, &log_offset, filter);
+    }
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(log_offset.lo_arg == arg);
+    TEST_ASSERT(log_offset.lo_ts == 0);
+
+    return arg->count;
+}
+
+TEST_CASE_SELF(log_test_case_walk_filter)
+{
+    struct log_filter filter;
+    struct ltwf_arg arg;
+    struct cbmem cbmem;
+    struct log log;
+    int64_t ts;
+    int expected;
+    int rc;
+    int i;
+
+    ltu_setup_cbmem(&cbmem, &log);
+
+#if MYNEWT_VAL(LOG_MODULE_LEVELS)
+    /* Don't let an earlier test's module levels drop entries. */
+    for (i = 0; i < 3; i++) {
+        log_level_set(i, 0);
+    }
+#endif
+
+    /* Modules 0-2, levels 0-3. */
+    for (i = 0; i < LTWF_NUM_ENTRIES; i++) {
+        rc = log_append_body(&log, i % 3, i % 4, LOG_ETYPE_STRING, "x", 1);
+        TEST_ASSERT_FATAL(rc == 0);
+        os_time_delay(1);
+    }
+
+    TEST_ASSERT(ltwf_count(&log, NULL, &arg) == LTWF_NUM_ENTRIES);
+
+    /* Empty filter matches everything. */
+    memset(&filter, 0, sizeof filter);
+    TEST_ASSERT(ltwf_count(&log, &filter, &arg) == LTWF_NUM_ENTRIES);
+
+    /* Module filter. */
+    filter.lf_flags = LOG_FILTER_F_MODULE;
+    filter.lf_module = 1;
+    TEST_ASSERT(ltwf_count(&log, &filter, &arg) == LTWF_NUM_ENTRIES / 3);
+
+    /* Level filter: levels 2 and 3. */
+    memset(&filter, 0, sizeof filter);
+    filter.lf_level = 2;
+    TEST_ASSERT(ltwf_count(&log, &filter, &arg) == LTWF_NUM_ENTRIES / 2);
+
+    /* Module and level combined: entries 4 and 10 (module 1, level >= 2). */
+    filter.lf_flags = LOG_FILTER_F_MODULE;
+    filter.lf_module = 1;
+    TEST_ASSERT(ltwf_count(&log, &filter, &arg) == 2);
+
+    /* Timestamp window [ts of entry 4, ts of entry 8). */
+    ltwf_count(&log, NULL, &arg);
+    memset(&filter, 0, sizeof filter);
+    filter.lf_ts_min = arg.ts[4];
+    filter.lf_ts_max = arg.ts[8];
+
+    expected = 0;
+    for (i = 0; i < LTWF_NUM_ENTRIES; i++) {
+        ts = arg.ts[i];
+        if (ts >= filter.lf_ts_min && ts < filter.lf_ts_max) {
+            expected++;
+        }
+    }
+    TEST_ASSERT(expected > 0);
+    TEST_ASSERT(ltwf_count(&log, &filter, &arg) == expected);
+}
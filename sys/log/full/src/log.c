@@ -37,6 +37,10 @@
 #include "shell/shell.h"
 #endif
 
+#if MYNEWT_VAL(LOG_COMPRESS)
+#include "lzf/lzf.h"
+#endif
+
 struct log_module_entry {
     int16_t id;
     const char *name;
@@ -476,6 +480,7 @@ log_chk_type(uint8_t etype)
         case LOG_ETYPE_STRING:
         case LOG_ETYPE_BINARY:
         case LOG_ETYPE_CBOR:
+        case LOG_ETYPE_TOKEN:
             break;
         default:
             rc = OS_ERROR;
@@ -507,7 +512,6 @@ log_append_prepare(struct log *log, uint8_t module, uint8_t level,
                    uint8_t etype, struct log_entry_hdr *ue)
 {
     int rc;
-    int sr;
     struct os_timeval tv;
     uint32_t idx;
 
@@ -545,18 +549,24 @@ log_append_prepare(struct log *log, uint8_t module, uint8_t level,
         goto err;
     }
 
-    OS_ENTER_CRITICAL(sr);
 #if MYNEWT_VAL(LOG_GLOBAL_IDX)
-    idx = g_log_info.li_next_index++;
+    idx = os_atomic_fetch_add_u32(&g_log_info.li_next_index, 1);
 #else
-    idx = log->l_idx++;
+    idx = os_atomic_fetch_add_u32(&log->l_idx, 1);
 #endif
-    OS_EXIT_CRITICAL(sr);
 
     /* Try to get UTC Time */
+#if MYNEWT_VAL(OS_TIMESTAMP)
+    rc = os_time_is_set() ? os_gettimeofday(&tv, NULL) : SYS_ENOENT;
+#else
     rc = os_gettimeofday(&tv, NULL);
+#endif
     if (rc || tv.tv_sec < UTC01_01_2016) {
+#if MYNEWT_VAL(OS_TIMESTAMP)
+        ue->ue_ts = os_timestamp64();
+#else
         ue->ue_ts = os_get_uptime_usec();
+#endif
     } else {
         ue->ue_ts = tv.tv_sec * 1000000 + tv.tv_usec;
     }
@@ -582,6 +592,59 @@ err:
     return (rc);
 }
 
+#if MYNEWT_VAL(LOG_COMPRESS)
+/**
+ * Compresses an entry body into buf, which holds LOG_COMPRESS_MAX_LEN bytes.
+ *
+ * @return                      The compressed length; 0 if the body should be
+ *                                  stored as is.
+ */
+static uint16_t
+log_compress_body(const struct log *log, const void *body, uint16_t body_len,
+                  uint8_t *buf)
+{
+    /* A stream log shows the body to a human as it is written. */
+    if (log->l_log->log_type == LOG_TYPE_STREAM) {
+        return 0;
+    }
+    if (body_len < 2 || body_len > MYNEWT_VAL(LOG_COMPRESS_MAX_LEN)) {
+        return 0;
+    }
+
+    /* Only keep the result if it saves at least one byte. */
+    return lzf_compress(body, body_len, buf, body_len - 1);
+}
+
+/**
+ * Reads and decompresses the body of a compressed entry.
+ *
+ * @param buf                   Receives the body; LOG_COMPRESS_MAX_LEN bytes.
+ *                                  If NULL, only the length is computed.
+ *
+ * @return                      The body length on success; SYS_EIO on
+ *                                  failure.
+ */
+static int
+log_read_compressed(struct log *log, const void *dptr,
+                    const struct log_entry_hdr *hdr, uint8_t *buf)
+{
+    uint8_t cbuf[MYNEWT_VAL(LOG_COMPRESS_MAX_LEN)];
+    int len;
+
+    len = log_read(log, dptr, cbuf, log_hdr_len(hdr), sizeof cbuf);
+    if (len <= 0) {
+        return SYS_EIO;
+    }
+
+    len = lzf_decompress(cbuf, len, buf, MYNEWT_VAL(LOG_COMPRESS_MAX_LEN));
+    if (len < 0) {
+        return SYS_EIO;
+    }
+
+    return len;
+}
+#endif
+
 /**
  * Calls the given log's append callback, if it has one.
  */
@@ -642,6 +705,10 @@ log_append_body(struct log *log, uint8_t module, uint8_t level, uint8_t etype,
                 const void *body, uint16_t body_len)
 {
     struct log_entry_hdr hdr;
+#if MYNEWT_VAL(LOG_COMPRESS)
+    uint8_t cbuf[MYNEWT_VAL(LOG_COMPRESS_MAX_LEN)];
+    uint16_t clen;
+#endif
     int rc;
 
     LOG_STATS_INC(log, writes);
@@ -657,6 +724,15 @@ log_append_body(struct log *log, uint8_t module, uint8_t level, uint8_t etype,
         return rc;
     }
 
+#if MYNEWT_VAL(LOG_COMPRESS)
+    clen = log_compress_body(log, body, body_len, cbuf);
+    if (clen != 0) {
+        hdr.ue_flags |= LOG_FLAGS_COMPRESSED;
+        body = cbuf;
+        body_len = clen;
+    }
+#endif
+
     rc = log->l_log->log_append_body(log, &hdr, body, body_len);
     if (rc != 0) {
         LOG_STATS_INC(log, errs);
@@ -771,6 +847,11 @@ log_append_mbuf_body_no_free(struct log *log, uint8_t module, uint8_t level,
                              uint8_t etype, struct os_mbuf *om)
 {
     struct log_entry_hdr hdr;
+#if MYNEWT_VAL(LOG_COMPRESS)
+    uint8_t body[MYNEWT_VAL(LOG_COMPRESS_MAX_LEN)];
+    uint8_t cbuf[MYNEWT_VAL(LOG_COMPRESS_MAX_LEN)];
+    uint16_t clen;
+#endif
     uint16_t len;
     int rc;
 
@@ -792,7 +873,20 @@ log_append_mbuf_body_no_free(struct log *log, uint8_t module, uint8_t level,
         goto drop;
     }
 
+#if MYNEWT_VAL(LOG_COMPRESS)
+    clen = 0;
+    if (len <= sizeof body && os_mbuf_copydata(om, 0, len, body) == 0) {
+        clen = log_compress_body(log, body, len, cbuf);
+    }
+    if (clen != 0) {
+        hdr.ue_flags |= LOG_FLAGS_COMPRESSED;
+        rc = log->l_log->log_append_body(log, &hdr, cbuf, clen);
+    } else {
+        rc = log->l_log->log_append_mbuf_body(log, &hdr, om);
+    }
+#else
     rc = log->l_log->log_append_mbuf_body(log, &hdr, om);
+#endif
     if (rc != 0) {
         goto err;
     }
@@ -862,8 +956,35 @@ struct log_walk_body_arg {
 
     /** The original argument passed to `log_walk`. */
     void *arg;
+
+    /** Header criteria an entry has to match; NULL matches everything. */
+    const struct log_filter *filter;
 };
 
+/**
+ * Indicates whether a log entry header satisfies the given filter.
+ */
+static bool
+log_filter_match(const struct log_filter *filter,
+                 const struct log_entry_hdr *ueh)
+{
+    if (filter->lf_ts_min != 0 && ueh->ue_ts < filter->lf_ts_min) {
+        return false;
+    }
+    if (filter->lf_ts_max != 0 && ueh->ue_ts >= filter->lf_ts_max) {
+        return false;
+    }
+    if (ueh->ue_level < filter->lf_level) {
+        return false;
+    }
+    if ((filter->lf_flags & LOG_FILTER_F_MODULE) &&
+        ueh->ue_module != filter->lf_module) {
+        return false;
+    }
+
+    return true;
+}
+
 /**
  * Performs a body walk on a single log entry.  This function reads the entry
  * header, subtracts the header length from the total entry length, and
@@ -886,8 +1007,20 @@ log_walk_body_fn(struct log *log, struct log_offset *log_offset, const void *dpt
     if (rc != 0) {
         return rc;
     }
-    if (log_offset->lo_index <= ueh.ue_index) {
+    if (log_offset->lo_index <= ueh.ue_index &&
+        (lwba->filter == NULL || log_filter_match(lwba->filter, &ueh))) {
+
         len -= log_hdr_len(&ueh);
+#if MYNEWT_VAL(LOG_COMPRESS)
+        /* Report the length the callback will be able to read. */
+        if (ueh.ue_flags & LOG_FLAGS_COMPRESSED) {
+            rc = log_read_compressed(log, dptr, &ueh, NULL);
+            if (rc < 0) {
+                return rc;
+            }
+            len = rc;
+        }
+#endif
 
         /* Pass the wrapped callback argument to the body walk function. */
         log_offset->lo_arg = lwba->arg;
@@ -921,6 +1054,33 @@ log_walk_body(struct log *log, log_walk_body_func_t walk_body_func,
     return rc;
 }
 
+int
+log_walk_body_filtered(struct log *log, log_walk_body_func_t walk_body_func,
+                       struct log_offset *log_offset,
+                       const struct log_filter *filter)
+{
+    struct log_walk_body_arg lwba = {
+        .fn = walk_body_func,
+        .arg = log_offset->lo_arg,
+        .filter = filter,
+    };
+    int64_t ts;
+    int rc;
+
+    /* Let the handler seek past entries older than the window. */
+    ts = log_offset->lo_ts;
+    if (ts == 0) {
+        log_offset->lo_ts = filter->lf_ts_min;
+    }
+
+    log_offset->lo_arg = &lwba;
+    rc = log->l_log->log_walk(log, log_walk_body_fn, log_offset);
+    log_offset->lo_arg = lwba.arg;
+    log_offset->lo_ts = ts;
+
+    return rc;
+}
+
 int
 log_walk_body_section(struct log *log, log_walk_body_func_t walk_body_func,
               struct log_offset *log_offset)
@@ -990,12 +1150,32 @@ log_read_body(struct log *log, const void *dptr, void *buf, uint16_t off,
 {
     int rc;
     struct log_entry_hdr hdr;
+#if MYNEWT_VAL(LOG_COMPRESS)
+    uint8_t body[MYNEWT_VAL(LOG_COMPRESS_MAX_LEN)];
+#endif
 
     rc = log_read_hdr(log, dptr, &hdr);
     if (rc) {
         return rc;
     }
 
+#if MYNEWT_VAL(LOG_COMPRESS)
+    if (hdr.ue_flags & LOG_FLAGS_COMPRESSED) {
+        rc = log_read_compressed(log, dptr, &hdr, body);
+        if (rc < 0) {
+            return rc;
+        }
+        if (off >= rc) {
+            return 0;
+        }
+        if (len > rc - off) {
+            len = rc - off;
+        }
+        memcpy(buf, body + off, len);
+        return len;
+    }
+#endif
+
     return log_read(log, dptr, buf, log_hdr_len(&hdr) + off, len);
 }
 
@@ -1020,12 +1200,37 @@ log_read_mbuf_body(struct log *log, const void *dptr, struct os_mbuf *om,
 {
     int rc;
     struct log_entry_hdr hdr;
+#if MYNEWT_VAL(LOG_COMPRESS)
+    uint8_t body[MYNEWT_VAL(LOG_COMPRESS_MAX_LEN)];
+#endif
 
     rc = log_read_hdr(log, dptr, &hdr);
     if (rc) {
         return rc;
     }
 
+#if MYNEWT_VAL(LOG_COMPRESS)
+    if (hdr.ue_flags & LOG_FLAGS_COMPRESSED) {
+        if (!om) {
+            return 0;
+        }
+        rc = log_read_compressed(log, dptr, &hdr, body);
+        if (rc < 0) {
+            return rc;
+        }
+        if (off >= rc) {
+            return 0;
+        }
+        if (len > rc - off) {
+            len = rc - off;
+        }
+        if (os_mbuf_append(om, body + off, len) != 0) {
+            return 0;
+        }
+        return len;
+    }
+#endif
+
     return log_read_mbuf(log, dptr, om, log_hdr_len(&hdr) + off, len);
 }
 
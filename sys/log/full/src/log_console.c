@@ -52,6 +52,11 @@ static int
 log_console_append_body(struct log *log, const struct log_entry_hdr *hdr,
                         const void *body, int body_len)
 {
+#if MYNEWT_VAL(LOG_TOKENIZED)
+    char text[LOG_PRINTF_MAX_ENTRY_LEN];
+    int len;
+#endif
+
     if (!console_is_init()) {
         return (0);
     }
@@ -60,6 +65,18 @@ log_console_append_body(struct log *log, const struct log_entry_hdr *hdr,
         log_console_print_hdr(hdr);
     }
 
+#if MYNEWT_VAL(LOG_TOKENIZED)
+    if (hdr->ue_etype == LOG_ETYPE_TOKEN) {
+        len = log_token_format(text, sizeof text, body, body_len);
+        if (len >= 0) {
+            console_write(text, len);
+        } else if (body_len >= 4) {
+            console_printf("tok=0x%08lx", (unsigned long)get_le32(body));
+        }
+        return (0);
+    }
+#endif
+
     console_write(body, body_len);
 
     return (0);
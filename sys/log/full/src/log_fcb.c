@@ -58,6 +58,9 @@ log_fcb_find_gte(struct log *log, struct log_offset *log_offset,
 {
 #if MYNEWT_VAL(LOG_FCB_BOOKMARKS)
     const struct log_fcb_bmark *bmark;
+#if MYNEWT_VAL(LOG_FCB_BOOKMARKS_TS_SEEK)
+    const struct log_fcb_bmark *ts_bmark;
+#endif
 #endif
     struct log_entry_hdr hdr;
     struct fcb_log *fcb_log;
@@ -97,6 +100,16 @@ log_fcb_find_gte(struct log *log, struct log_offset *log_offset,
 
 #if MYNEWT_VAL(LOG_FCB_BOOKMARKS)
     bmark = log_fcb_closest_bmark(fcb_log, log_offset->lo_index);
+#if MYNEWT_VAL(LOG_FCB_BOOKMARKS_TS_SEEK)
+    if (log_offset->lo_ts > 0) {
+        ts_bmark = log_fcb_closest_bmark_ts(fcb_log, log_offset->lo_ts);
+        if (ts_bmark != NULL &&
+            (bmark == NULL || ts_bmark->lfb_index > bmark->lfb_index)) {
+
+            bmark = ts_bmark;
+        }
+    }
+#endif
     if (bmark != NULL) {
         *out_entry = bmark->lfb_entry;
     }
@@ -109,6 +122,10 @@ log_fcb_find_gte(struct log *log, struct log_offset *log_offset,
             return rc;
         }
 
+#if MYNEWT_VAL(LOG_FCB_BOOKMARKS)
+        log_fcb_add_bmark(fcb_log, out_entry, hdr.ue_index, hdr.ue_ts);
+#endif
+
         if (hdr.ue_index >= log_offset->lo_index) {
             return 0;
         }
@@ -166,8 +183,8 @@ log_fcb_start_append(struct log *log, int len, struct fcb_entry *loc)
         }
 
 #if MYNEWT_VAL(LOG_FCB_BOOKMARKS)
-        /* The FCB needs to be rotated.  Invalidate all bookmarks. */
-        log_fcb_clear_bmarks(fcb_log);
+        /* The oldest area is about to be erased; drop its bookmarks. */
+        log_fcb_rotate_bmarks(fcb_log);
 #endif
 
         rc = fcb_rotate(fcb);
@@ -292,6 +309,10 @@ log_fcb_append_body(struct log *log, const struct log_entry_hdr *hdr,
         return rc;
     }
 
+#if MYNEWT_VAL(LOG_FCB_BOOKMARKS)
+    log_fcb_add_bmark(fcb_log, &loc, hdr->ue_index, hdr->ue_ts);
+#endif
+
     return 0;
 }
 
@@ -331,6 +352,9 @@ log_fcb_append_mbuf_body(struct log *log, const struct log_entry_hdr *hdr,
 {
     struct fcb *fcb;
     struct fcb_entry loc;
+#if MYNEWT_VAL(LOG_FCB_BOOKMARKS)
+    struct fcb_entry start_loc;
+#endif
     struct fcb_log *fcb_log;
     int len;
     int rc;
@@ -350,6 +374,9 @@ log_fcb_append_mbuf_body(struct log *log, const struct log_entry_hdr *hdr,
     if (rc != 0) {
         return rc;
     }
+#if MYNEWT_VAL(LOG_FCB_BOOKMARKS)
+    start_loc = loc;
+#endif
 
     rc = flash_area_write(loc.fe_area, loc.fe_data_off, hdr,
                           LOG_BASE_ENTRY_HDR_SIZE);
@@ -379,6 +406,10 @@ log_fcb_append_mbuf_body(struct log *log, const struct log_entry_hdr *hdr,
         return rc;
     }
 
+#if MYNEWT_VAL(LOG_FCB_BOOKMARKS)
+    log_fcb_add_bmark(fcb_log, &start_loc, hdr->ue_index, hdr->ue_ts);
+#endif
+
     return 0;
 }
 
@@ -519,15 +550,6 @@ log_fcb_walk_impl(struct log *log, log_walk_func_t walk_func,
     }
     fap = loc.fe_area;
 
-#if MYNEWT_VAL(LOG_FCB_BOOKMARKS)
-    /* If a minimum index was specified (i.e., we are not just retrieving the
-     * last entry), add a bookmark pointing to this walk's start location.
-     */
-    if (log_offset->lo_ts >= 0) {
-        log_fcb_add_bmark(fcb_log, &loc, log_offset->lo_index);
-    }
-#endif
-
     do {
         if (area) {
             if (fap != loc.fe_area) {
@@ -58,6 +58,9 @@ log_fcb2_find_gte(struct log *log, struct log_offset *log_offset,
 {
 #if MYNEWT_VAL(LOG_FCB_BOOKMARKS)
     const struct log_fcb_bmark *bmark;
+#if MYNEWT_VAL(LOG_FCB_BOOKMARKS_TS_SEEK)
+    const struct log_fcb_bmark *ts_bmark;
+#endif
 #endif
     struct log_entry_hdr hdr;
     struct fcb_log *fcb_log;
@@ -104,6 +107,16 @@ log_fcb2_find_gte(struct log *log, struct log_offset *log_offset,
     }
 #if MYNEWT_VAL(LOG_FCB_BOOKMARKS)
     bmark = log_fcb_closest_bmark(fcb_log, log_offset->lo_index);
+#if MYNEWT_VAL(LOG_FCB_BOOKMARKS_TS_SEEK)
+    if (log_offset->lo_ts > 0) {
+        ts_bmark = log_fcb_closest_bmark_ts(fcb_log, log_offset->lo_ts);
+        if (ts_bmark != NULL &&
+            (bmark == NULL || ts_bmark->lfb_index > bmark->lfb_index)) {
+
+            bmark = ts_bmark;
+        }
+    }
+#endif
     if (bmark != NULL) {
         *out_entry = bmark->lfb_entry;
     }
@@ -116,6 +129,10 @@ log_fcb2_find_gte(struct log *log, struct log_offset *log_offset,
             return rc;
         }
 
+#if MYNEWT_VAL(LOG_FCB_BOOKMARKS)
+        log_fcb_add_bmark(fcb_log, out_entry, hdr.ue_index, hdr.ue_ts);
+#endif
+
         if (hdr.ue_index >= log_offset->lo_index) {
             return 0;
         }
@@ -170,8 +187,8 @@ log_fcb2_start_append(struct log *log, int len, struct fcb2_entry *loc)
 #endif
 
 #if MYNEWT_VAL(LOG_FCB_BOOKMARKS)
-        /* The FCB needs to be rotated.  Invalidate all bookmarks. */
-        log_fcb_clear_bmarks(fcb_log);
+        /* The oldest area is about to be erased; drop its bookmarks. */
+        log_fcb_rotate_bmarks(fcb_log);
 #endif
 
         rc = fcb2_rotate(fcb);
@@ -224,12 +241,18 @@ log_fcb2_append_body(struct log *log, const struct log_entry_hdr *hdr,
     uint8_t buf[LOG_BASE_ENTRY_HDR_SIZE + LOG_IMG_HASHLEN +
                 LOG_FCB2_MAX_ALIGN - 1];
     struct fcb2_entry loc;
+#if MYNEWT_VAL(LOG_FCB_BOOKMARKS)
+    struct fcb_log *fcb_log;
+#endif
     const uint8_t *u8p;
     int hdr_alignment;
     int chunk_sz;
     int rc;
     uint16_t hdr_len;
 
+#if MYNEWT_VAL(LOG_FCB_BOOKMARKS)
+    fcb_log = (struct fcb_log *)log->l_arg;
+#endif
     hdr_len = log_hdr_len(hdr);
 
     rc = log_fcb2_start_append(log, hdr_len + body_len, &loc);
@@ -286,6 +309,10 @@ log_fcb2_append_body(struct log *log, const struct log_entry_hdr *hdr,
         return rc;
     }
 
+#if MYNEWT_VAL(LOG_FCB_BOOKMARKS)
+    log_fcb_add_bmark(fcb_log, &loc, hdr->ue_index, hdr->ue_ts);
+#endif
+
     return 0;
 }
 
@@ -323,6 +350,9 @@ log_fcb2_append_mbuf_body(struct log *log, const struct log_entry_hdr *hdr,
                           struct os_mbuf *om)
 {
     struct fcb2_entry loc;
+#if MYNEWT_VAL(LOG_FCB_BOOKMARKS)
+    struct fcb_log *fcb_log;
+#endif
     int len;
     int rc;
 
@@ -338,6 +368,10 @@ log_fcb2_append_mbuf_body(struct log *log, const struct log_entry_hdr *hdr,
     }
 #endif
 
+#if MYNEWT_VAL(LOG_FCB_BOOKMARKS)
+    fcb_log = (struct fcb_log *)log->l_arg;
+#endif
+
     len = log_hdr_len(hdr) + os_mbuf_len(om);
     rc = log_fcb2_start_append(log, len, &loc);
     if (rc != 0) {
@@ -370,6 +404,10 @@ log_fcb2_append_mbuf_body(struct log *log, const struct log_entry_hdr *hdr,
         return rc;
     }
 
+#if MYNEWT_VAL(LOG_FCB_BOOKMARKS)
+    log_fcb_add_bmark(fcb_log, &loc, hdr->ue_index, hdr->ue_ts);
+#endif
+
     return 0;
 }
 
@@ -497,15 +535,6 @@ log_fcb2_walk(struct log *log, log_walk_func_t walk_func,
         return rc;
     }
 
-#if MYNEWT_VAL(LOG_FCB_BOOKMARKS)
-    /* If a minimum index was specified (i.e., we are not just retrieving the
-     * last entry), add a bookmark pointing to this walk's start location.
-     */
-    if (log_off->lo_ts >= 0) {
-        log_fcb_add_bmark(fcb_log, &loc, log_off->lo_index);
-    }
-#endif
-
     do {
         rc = walk_func(log, log_off, &loc, loc.fe_data_len);
         if (rc != 0) {
@@ -0,0 +1,473 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(LOG_FCB_ASYNC)
+
+#include <assert.h>
+#include "cbmem/cbmem.h"
+#include "log/log.h"
+#include "log/log_fcb_async.h"
+
+static struct os_task log_fcb_async_task;
+static struct os_eventq log_fcb_async_evq;
+OS_TASK_STACK_DEFINE(log_fcb_async_stack,
+                     MYNEWT_VAL(LOG_FCB_ASYNC_STACK_SIZE));
+
+static void
+log_fcb_async_task_handler(void *arg)
+{
+    while (1) {
+        os_eventq_run(&log_fcb_async_evq);
+    }
+}
+
+/**
+ * Returns the number of entries contained in a staging buffer.
+ */
+static uint16_t
+log_fcb_async_count(struct cbmem *cbmem)
+{
+    struct cbmem_iter iter;
+    uint16_t cnt;
+
+    cnt = 0;
+    cbmem_iter_start(cbmem, &iter);
+    while (cbmem_iter_next(cbmem, &iter) != NULL) {
+        cnt++;
+    }
+
+    return cnt;
+}
+
+/**
+ * Indicates whether an entry of the given length can be added to a staging
+ * buffer without wrapping around, i.e., without overwriting older entries.
+ */
+static bool
+log_fcb_async_fits(const struct cbmem *cbmem, uint16_t len)
+{
+    const uint8_t *dst;
+
+    if (cbmem->c_entry_end != NULL) {
+        dst = (const uint8_t *)CBMEM_ENTRY_NEXT(cbmem->c_entry_end);
+    } else {
+        dst = cbmem->c_buf;
+    }
+
+    return dst + sizeof(struct cbmem_entry_hdr) + len <= cbmem->c_buf_end;
+}
+
+/**
+ * Swaps the staging buffers and commits the previously active one to flash.
+ */
+static void
+log_fcb_async_drain(struct log_fcb_async *lfa)
+{
+    struct cbmem_entry_hdr *ceh;
+    struct log_entry_hdr *hdr;
+    struct cbmem_iter iter;
+    struct cbmem *cbmem;
+    uint16_t hdr_len;
+    uint8_t waiters;
+    int rc;
+
+    os_mutex_pend(&lfa->lfa_drain_mtx, OS_TIMEOUT_NEVER);
+
+    os_mutex_pend(&lfa->lfa_mtx, OS_TIMEOUT_NEVER);
+    cbmem = &lfa->lfa_cbmem[lfa->lfa_active];
+    lfa->lfa_active ^= 1;
+    lfa->lfa_cnt = 0;
+    waiters = lfa->lfa_waiters;
+    lfa->lfa_waiters = 0;
+    os_mutex_release(&lfa->lfa_mtx);
+
+    /* The newly active buffer was emptied by the previous drain. */
+    while (waiters-- > 0) {
+        os_sem_release(&lfa->lfa_sem);
+    }
+
+    lfa->lfa_fcb.l_rotate_notify_cb = lfa->lfa_log->l_rotate_notify_cb;
+
+    cbmem_iter_start(cbmem, &iter);
+    while (1) {
+        ceh = cbmem_iter_next(cbmem, &iter);
+        if (ceh == NULL) {
+            break;
+        }
+
+        hdr = (struct log_entry_hdr *)(ceh + 1);
+        hdr_len = log_hdr_len(hdr);
+        rc = log_fcb_handler.log_append_body(&lfa->lfa_fcb, hdr,
+                                             (uint8_t *)hdr + hdr_len,
+                                             ceh->ceh_len - hdr_len);
+        if (rc != 0) {
+            lfa->lfa_errs++;
+            LOG_STATS_INC(lfa->lfa_log, errs);
+        }
+    }
+
+    cbmem_flush(cbmem);
+
+    os_mutex_release(&lfa->lfa_drain_mtx);
+}
+
+static void
+log_fcb_async_event_cb(struct os_event *ev)
+{
+    log_fcb_async_drain(ev->ev_arg);
+}
+
+/**
+ * Adds an entry to the active staging buffer, applying the overflow policy
+ * if it is full, and schedules the writer task.
+ */
+static int
+log_fcb_async_stage(struct log *log, const struct cbmem_scat_gath *sg,
+                    uint16_t len)
+{
+    struct log_fcb_async *lfa;
+    struct cbmem *cbmem;
+    uint16_t cnt;
+    bool fits;
+    int rc;
+
+    lfa = (struct log_fcb_async *)log->l_arg;
+
+    cbmem = &lfa->lfa_cbmem[0];
+    if (sizeof(struct cbmem_entry_hdr) + len >
+        cbmem->c_buf_end - cbmem->c_buf) {
+        return SYS_EINVAL;
+    }
+
+    while (1) {
+        os_mutex_pend(&lfa->lfa_mtx, OS_TIMEOUT_NEVER);
+
+        cbmem = &lfa->lfa_cbmem[lfa->lfa_active];
+        fits = log_fcb_async_fits(cbmem, len);
+        if (fits || lfa->lfa_policy == LOG_FCB_ASYNC_OVERWRITE) {
+            break;
+        }
+
+        /* The writer task must never wait for itself. */
+        if (lfa->lfa_policy == LOG_FCB_ASYNC_BLOCK && os_started() &&
+            os_sched_get_current_task() != &log_fcb_async_task) {
+            lfa->lfa_waiters++;
+            os_mutex_release(&lfa->lfa_mtx);
+
+            os_eventq_put(&log_fcb_async_evq, &lfa->lfa_co.c_ev);
+            os_sem_pend(&lfa->lfa_sem, OS_TIMEOUT_NEVER);
+            continue;
+        }
+
+        lfa->lfa_dropped++;
+        LOG_STATS_INC(log, drops);
+        os_mutex_release(&lfa->lfa_mtx);
+
+        os_eventq_put(&log_fcb_async_evq, &lfa->lfa_co.c_ev);
+        return SYS_ENOMEM;
+    }
+
+    rc = cbmem_append_scat_gath(cbmem, sg);
+    if (rc == 0) {
+        if (fits) {
+            lfa->lfa_cnt++;
+        } else {
+            /* cbmem discarded the oldest entries to make room. */
+            cnt = log_fcb_async_count(cbmem);
+            lfa->lfa_overwritten += lfa->lfa_cnt + 1 - cnt;
+            LOG_STATS_INCN(log, lost, lfa->lfa_cnt + 1 - cnt);
+            lfa->lfa_cnt = cnt;
+        }
+    }
+
+    os_mutex_release(&lfa->lfa_mtx);
+
+    if (!fits || MYNEWT_VAL(LOG_FCB_ASYNC_DELAY_MS) == 0) {
+        os_eventq_put(&log_fcb_async_evq, &lfa->lfa_co.c_ev);
+    } else if (!os_callout_queued(&lfa->lfa_co)) {
+        os_callout_reset(&lfa->lfa_co,
+                         os_time_ms_to_ticks32(
+                             MYNEWT_VAL(LOG_FCB_ASYNC_DELAY_MS)));
+    }
+
+    return rc;
+}
+
+static int
+log_fcb_async_append_body(struct log *log, const struct log_entry_hdr *hdr,
+                          const void *body, int body_len)
+{
+    struct cbmem_scat_gath sg = {
+        .entries = (struct cbmem_scat_gath_entry[]) {
+            {
+                .flat_buf = hdr,
+                .flat_len = log_hdr_len(hdr),
+            },
+            {
+                .flat_buf = body,
+                .flat_len = body_len,
+            },
+        },
+        .count = 2,
+    };
+
+    return log_fcb_async_stage(log, &sg, log_hdr_len(hdr) + body_len);
+}
+
+static int
+log_fcb_async_append(struct log *log, void *buf, int len)
+{
+    struct cbmem_scat_gath sg = {
+        .entries = (struct cbmem_scat_gath_entry[]) {
+            {
+                .flat_buf = buf,
+                .flat_len = len,
+            },
+        },
+        .count = 1,
+    };
+
+    return log_fcb_async_stage(log, &sg, len);
+}
+
+static int
+log_fcb_async_append_mbuf_body(struct log *log,
+                               const struct log_entry_hdr *hdr,
+                               struct os_mbuf *om)
+{
+    struct cbmem_scat_gath sg = {
+        .entries = (struct cbmem_scat_gath_entry[]) {
+            {
+                .flat_buf = hdr,
+                .flat_len = log_hdr_len(hdr),
+            },
+            {
+                .om = om,
+            },
+        },
+        .count = 2,
+    };
+
+    return log_fcb_async_stage(log, &sg,
+                               log_hdr_len(hdr) + os_mbuf_len(om));
+}
+
+static int
+log_fcb_async_append_mbuf(struct log *log, struct os_mbuf *om)
+{
+    struct cbmem_scat_gath sg = {
+        .entries = (struct cbmem_scat_gath_entry[]) {
+            {
+                .om = om,
+            },
+        },
+        .count = 1,
+    };
+
+    return log_fcb_async_stage(log, &sg, os_mbuf_len(om));
+}
+
+static int
+log_fcb_async_read(struct log *log, const void *dptr, void *buf,
+                   uint16_t offset, uint16_t len)
+{
+    struct log_fcb_async *lfa;
+
+    lfa = (struct log_fcb_async *)log->l_arg;
+
+    return log_fcb_handler.log_read(&lfa->lfa_fcb, dptr, buf, offset, len);
+}
+
+static int
+log_fcb_async_read_mbuf(struct log *log, const void *dptr,
+                        struct os_mbuf *om, uint16_t offset, uint16_t len)
+{
+    struct log_fcb_async *lfa;
+
+    lfa = (struct log_fcb_async *)log->l_arg;
+
+    return log_fcb_handler.log_read_mbuf(&lfa->lfa_fcb, dptr, om, offset,
+                                         len);
+}
+
+static int
+log_fcb_async_walk(struct log *log, log_walk_func_t walk_func,
+                   struct log_offset *log_offset)
+{
+    struct log_fcb_async *lfa;
+
+    lfa = (struct log_fcb_async *)log->l_arg;
+
+    return log_fcb_handler.log_walk(&lfa->lfa_fcb, walk_func, log_offset);
+}
+
+static int
+log_fcb_async_walk_sector(struct log *log, log_walk_func_t walk_func,
+                          struct log_offset *log_offset)
+{
+    struct log_fcb_async *lfa;
+
+    lfa = (struct log_fcb_async *)log->l_arg;
+
+    if (log_fcb_handler.log_walk_sector == NULL) {
+        return SYS_ENOTSUP;
+    }
+
+    return log_fcb_handler.log_walk_sector(&lfa->lfa_fcb, walk_func,
+                                           log_offset);
+}
+
+static int
+log_fcb_async_flush(struct log *log)
+{
+    struct log_fcb_async *lfa;
+    int rc;
+
+    lfa = (struct log_fcb_async *)log->l_arg;
+
+    os_mutex_pend(&lfa->lfa_drain_mtx, OS_TIMEOUT_NEVER);
+    os_mutex_pend(&lfa->lfa_mtx, OS_TIMEOUT_NEVER);
+
+    cbmem_flush(&lfa->lfa_cbmem[0]);
+    cbmem_flush(&lfa->lfa_cbmem[1]);
+    lfa->lfa_cnt = 0;
+
+    os_mutex_release(&lfa->lfa_mtx);
+
+    rc = log_fcb_handler.log_flush(&lfa->lfa_fcb);
+
+    os_mutex_release(&lfa->lfa_drain_mtx);
+
+    return rc;
+}
+
+#if MYNEWT_VAL(LOG_STORAGE_INFO)
+static int
+log_fcb_async_storage_info(struct log *log, struct log_storage_info *info)
+{
+    struct log_fcb_async *lfa;
+
+    lfa = (struct log_fcb_async *)log->l_arg;
+
+    return log_fcb_handler.log_storage_info(&lfa->lfa_fcb, info);
+}
+#endif
+
+#if MYNEWT_VAL(LOG_STORAGE_WATERMARK)
+static int
+log_fcb_async_set_watermark(struct log *log, uint32_t index)
+{
+    struct log_fcb_async *lfa;
+
+    lfa = (struct log_fcb_async *)log->l_arg;
+
+    return log_fcb_handler.log_set_watermark(&lfa->lfa_fcb, index);
+}
+#endif
+
+static int
+log_fcb_async_registered(struct log *log)
+{
+    struct log_fcb_async *lfa;
+
+    lfa = (struct log_fcb_async *)log->l_arg;
+
+    lfa->lfa_log = log;
+    lfa->lfa_fcb.l_name = log->l_name;
+    lfa->lfa_fcb.l_level = log->l_level;
+
+    return log_fcb_handler.log_registered(&lfa->lfa_fcb);
+}
+
+int
+log_fcb_async_init(struct log_fcb_async *lfa, struct fcb_log *fcb_arg,
+                   void *buf, uint32_t buf_len, uint8_t policy)
+{
+    uint32_t half;
+    int rc;
+
+    if (policy > LOG_FCB_ASYNC_OVERWRITE) {
+        return SYS_EINVAL;
+    }
+
+    half = buf_len / 2;
+    if (half <= sizeof(struct cbmem_entry_hdr) + LOG_BASE_ENTRY_HDR_SIZE) {
+        return SYS_EINVAL;
+    }
+
+    if (log_fcb_async_task.t_func == NULL) {
+        os_eventq_init(&log_fcb_async_evq);
+        rc = os_task_init(&log_fcb_async_task, "log_async",
+                          log_fcb_async_task_handler, NULL,
+                          MYNEWT_VAL(LOG_FCB_ASYNC_TASK_PRIO),
+                          OS_WAIT_FOREVER, log_fcb_async_stack,
+                          MYNEWT_VAL(LOG_FCB_ASYNC_STACK_SIZE));
+        if (rc != 0) {
+            return rc;
+        }
+    }
+
+    memset(lfa, 0, sizeof(*lfa));
+
+    os_mutex_init(&lfa->lfa_mtx);
+    os_mutex_init(&lfa->lfa_drain_mtx);
+    os_sem_init(&lfa->lfa_sem, 0);
+    os_callout_init(&lfa->lfa_co, &log_fcb_async_evq,
+                    log_fcb_async_event_cb, lfa);
+
+    lfa->lfa_fcb.l_log = &log_fcb_handler;
+    lfa->lfa_fcb.l_arg = fcb_arg;
+
+    cbmem_init(&lfa->lfa_cbmem[0], buf, half);
+    cbmem_init(&lfa->lfa_cbmem[1], (uint8_t *)buf + half, half);
+    lfa->lfa_policy = policy;
+
+    return 0;
+}
+
+void
+log_fcb_async_sync(struct log_fcb_async *lfa)
+{
+    /* Once the drain lock is held only the active buffer holds entries. */
+    log_fcb_async_drain(lfa);
+}
+
+const struct log_handler log_fcb_async_handler = {
+    .log_type             = LOG_TYPE_STORAGE,
+    .log_read             = log_fcb_async_read,
+    .log_read_mbuf        = log_fcb_async_read_mbuf,
+    .log_append           = log_fcb_async_append,
+    .log_append_body      = log_fcb_async_append_body,
+    .log_append_mbuf      = log_fcb_async_append_mbuf,
+    .log_append_mbuf_body = log_fcb_async_append_mbuf_body,
+    .log_walk             = log_fcb_async_walk,
+    .log_walk_sector      = log_fcb_async_walk_sector,
+    .log_flush            = log_fcb_async_flush,
+#if MYNEWT_VAL(LOG_STORAGE_INFO)
+    .log_storage_info     = log_fcb_async_storage_info,
+#endif
+#if MYNEWT_VAL(LOG_STORAGE_WATERMARK)
+    .log_set_watermark    = log_fcb_async_set_watermark,
+#endif
+    .log_registered       = log_fcb_async_registered,
+};
+
+#endif
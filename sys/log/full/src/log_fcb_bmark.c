@@ -32,6 +32,7 @@ log_fcb_init_bmarks(struct fcb_log *fcb_log,
     fcb_log->fl_bset = (struct log_fcb_bset) {
         .lfs_bmarks = buf,
         .lfs_cap = bmark_count,
+        .lfs_gap = 1,
     };
 }
 
@@ -39,46 +40,135 @@ void
 log_fcb_clear_bmarks(struct fcb_log *fcb_log)
 {
     fcb_log->fl_bset.lfs_size = 0;
-    fcb_log->fl_bset.lfs_next = 0;
+    fcb_log->fl_bset.lfs_gap = 1;
+}
+
+/**
+ * Returns the position of the first bookmark whose index is greater than the
+ * one specified.
+ */
+static int
+log_fcb_bmark_upper(const struct log_fcb_bset *bset, uint32_t index)
+{
+    int lo;
+    int hi;
+    int mid;
+
+    lo = 0;
+    hi = bset->lfs_size;
+    while (lo < hi) {
+        mid = (lo + hi) / 2;
+        if (bset->lfs_bmarks[mid].lfb_index <= index) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return lo;
 }
 
 const struct log_fcb_bmark *
 log_fcb_closest_bmark(const struct fcb_log *fcb_log, uint32_t index)
 {
-    const struct log_fcb_bmark *closest;
-    const struct log_fcb_bmark *bmark;
-    uint32_t min_diff;
-    uint32_t diff;
-    int i;
+    const struct log_fcb_bset *bset;
+    int pos;
 
-    min_diff = UINT32_MAX;
-    closest = NULL;
-
-    for (i = 0; i < fcb_log->fl_bset.lfs_size; i++) {
-        bmark = &fcb_log->fl_bset.lfs_bmarks[i];
-        if (bmark->lfb_index <= index) {
-            diff = index - bmark->lfb_index;
-            if (diff < min_diff) {
-                min_diff = diff;
-                closest = bmark;
-            }
+    bset = &fcb_log->fl_bset;
+
+    pos = log_fcb_bmark_upper(bset, index);
+    if (pos == 0) {
+        return NULL;
+    }
+
+    return &bset->lfs_bmarks[pos - 1];
+}
+
+const struct log_fcb_bmark *
+log_fcb_closest_bmark_ts(const struct fcb_log *fcb_log, int64_t ts)
+{
+    const struct log_fcb_bset *bset;
+    int lo;
+    int hi;
+    int mid;
+
+    bset = &fcb_log->fl_bset;
+
+    lo = 0;
+    hi = bset->lfs_size;
+    while (lo < hi) {
+        mid = (lo + hi) / 2;
+        if (bset->lfs_bmarks[mid].lfb_ts < ts) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
         }
     }
 
-    return closest;
+    if (lo == 0) {
+        return NULL;
+    }
+
+    return &bset->lfs_bmarks[lo - 1];
+}
+
+/**
+ * Indicates whether a bookmark for the given index, inserted at the given
+ * position, would be at least the minimum gap away from its neighbours.
+ */
+static bool
+log_fcb_bmark_fits(const struct log_fcb_bset *bset, int pos, uint32_t index)
+{
+    if (pos > 0 && index - bset->lfs_bmarks[pos - 1].lfb_index <
+                   bset->lfs_gap) {
+        return false;
+    }
+    if (pos < bset->lfs_size && bset->lfs_bmarks[pos].lfb_index - index <
+                                bset->lfs_gap) {
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Doubles the minimum gap between bookmarks and discards the ones which no
+ * longer satisfy it.  This keeps the bookmarks spread over the whole log
+ * rather than only covering its newest part.
+ */
+static void
+log_fcb_thin_bmarks(struct log_fcb_bset *bset)
+{
+    int i;
+    int j;
+
+    bset->lfs_gap *= 2;
+
+    j = 1;
+    for (i = 1; i < bset->lfs_size; i++) {
+        if (bset->lfs_bmarks[i].lfb_index -
+            bset->lfs_bmarks[j - 1].lfb_index >= bset->lfs_gap) {
+
+            bset->lfs_bmarks[j++] = bset->lfs_bmarks[i];
+        }
+    }
+    if (bset->lfs_size > 0) {
+        bset->lfs_size = j;
+    }
 }
 
 #if MYNEWT_VAL(LOG_FCB)
 void
 log_fcb_add_bmark(struct fcb_log *fcb_log, const struct fcb_entry *entry,
-                  uint32_t index)
+                  uint32_t index, int64_t ts)
 #elif MYNEWT_VAL(LOG_FCB2)
 void
 log_fcb_add_bmark(struct fcb_log *fcb_log, const struct fcb2_entry *entry,
-                  uint32_t index)
+                  uint32_t index, int64_t ts)
 #endif
 {
     struct log_fcb_bset *bset;
+    int pos;
 
     bset = &fcb_log->fl_bset;
 
@@ -86,19 +176,59 @@ log_fcb_add_bmark(struct fcb_log *fcb_log, const struct fcb2_entry *entry,
         return;
     }
 
-    bset->lfs_bmarks[bset->lfs_next] = (struct log_fcb_bmark) {
+    pos = log_fcb_bmark_upper(bset, index);
+    if (!log_fcb_bmark_fits(bset, pos, index)) {
+        return;
+    }
+
+    if (bset->lfs_size >= bset->lfs_cap) {
+        log_fcb_thin_bmarks(bset);
+        if (bset->lfs_size >= bset->lfs_cap) {
+            return;
+        }
+
+        pos = log_fcb_bmark_upper(bset, index);
+        if (!log_fcb_bmark_fits(bset, pos, index)) {
+            return;
+        }
+    }
+
+    memmove(&bset->lfs_bmarks[pos + 1], &bset->lfs_bmarks[pos],
+            (bset->lfs_size - pos) * sizeof(bset->lfs_bmarks[0]));
+
+    bset->lfs_bmarks[pos] = (struct log_fcb_bmark) {
         .lfb_entry = *entry,
         .lfb_index = index,
+        .lfb_ts = ts,
     };
+    bset->lfs_size++;
+}
 
-    if (bset->lfs_size < bset->lfs_cap) {
-        bset->lfs_size++;
-    }
+void
+log_fcb_rotate_bmarks(struct fcb_log *fcb_log)
+{
+    struct log_fcb_bset *bset;
+    struct log_fcb_bmark *bmark;
+    int i;
+    int j;
 
-    bset->lfs_next++;
-    if (bset->lfs_next >= bset->lfs_cap) {
-        bset->lfs_next = 0;
+    bset = &fcb_log->fl_bset;
+
+    j = 0;
+    for (i = 0; i < bset->lfs_size; i++) {
+        bmark = &bset->lfs_bmarks[i];
+#if MYNEWT_VAL(LOG_FCB)
+        if (bmark->lfb_entry.fe_area == fcb_log->fl_fcb.f_oldest) {
+            continue;
+        }
+#elif MYNEWT_VAL(LOG_FCB2)
+        if (bmark->lfb_entry.fe_sector == fcb_log->fl_fcb.f_oldest_sec) {
+            continue;
+        }
+#endif
+        bset->lfs_bmarks[j++] = *bmark;
     }
+    bset->lfs_size = j;
 }
 
 #endif /* MYNEWT_VAL(LOG_FCB_BOOKMARKS) */
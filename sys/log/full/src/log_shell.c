@@ -26,6 +26,7 @@
 #if MYNEWT_VAL(LOG_CLI)
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "cbmem/cbmem.h"
@@ -141,6 +142,7 @@ log_shell_cbor_reader_init(struct log_shell_cbor_reader *cbr, struct log *log,
     cbr->r.get64 = &log_shell_cbor_reader_get64;
     cbr->r.cmp = &log_shell_cbor_reader_cmp;
     cbr->r.cpy = &log_shell_cbor_reader_cpy;
+    cbr->r.span = NULL;
     cbr->r.message_size = len;
     cbr->log = log;
     cbr->dptr = dptr;
@@ -163,6 +165,9 @@ shell_log_dump_entry(struct log *log, struct log_offset *log_offset,
     int blksz;
     bool read_data = ueh->ue_etype != LOG_ETYPE_CBOR;
     bool read_hash = ueh->ue_flags & LOG_FLAGS_IMG_HASH;
+#if MYNEWT_VAL(LOG_TOKENIZED)
+    char text[LOG_PRINTF_MAX_ENTRY_LEN];
+#endif
 #else
     bool read_data = true;
 #endif
@@ -195,8 +200,21 @@ shell_log_dump_entry(struct log *log, struct log_offset *log_offset,
     case LOG_ETYPE_CBOR:
         log_shell_cbor_reader_init(&cbor_reader, log, dptr, len);
         cbor_parser_init(&cbor_reader.r, 0, &cbor_parser, &cbor_value);
+#if MYNEWT_VAL(STREAMER_CBOR)
+        streamer_cbor_pretty(streamer_console_get(), &cbor_value);
+#else
         cbor_value_to_pretty(stdout, &cbor_value);
+#endif
         break;
+#if MYNEWT_VAL(LOG_TOKENIZED)
+    case LOG_ETYPE_TOKEN:
+        if (log_token_format(text, sizeof text, data, rc) >= 0) {
+            console_write(text, strlen(text));
+            break;
+        }
+        /* Format strings not available; dump the raw entry. */
+        /* FALLTHROUGH */
+#endif
     default:
         for (off = 0; off < rc; off += blksz) {
             blksz = dlen - off;
@@ -216,17 +234,79 @@ shell_log_dump_entry(struct log *log, struct log_offset *log_offset,
     return 0;
 }
 
+/**
+ * Parses the filter options following the log name:
+ *     -s <min ts> -e <max ts> -m <module> -v <min level>
+ */
+static int
+shell_log_parse_filter(int argc, char **argv, struct log_filter *filter)
+{
+    unsigned long val;
+    char *eptr;
+    int i;
+
+    memset(filter, 0, sizeof(*filter));
+
+    for (i = 0; i < argc; i += 2) {
+        if (i + 1 >= argc || argv[i][0] != '-' || argv[i][2] != '\0') {
+            return SYS_EINVAL;
+        }
+
+        switch (argv[i][1]) {
+        case 's':
+            filter->lf_ts_min = strtoll(argv[i + 1], &eptr, 0);
+            break;
+        case 'e':
+            filter->lf_ts_max = strtoll(argv[i + 1], &eptr, 0);
+            break;
+        case 'm':
+            val = strtoul(argv[i + 1], &eptr, 0);
+            if (val > UINT8_MAX) {
+                return SYS_EINVAL;
+            }
+            filter->lf_module = val;
+            filter->lf_flags |= LOG_FILTER_F_MODULE;
+            break;
+        case 'v':
+            val = strtoul(argv[i + 1], &eptr, 0);
+            if (val > LOG_LEVEL_MAX) {
+                return SYS_EINVAL;
+            }
+            filter->lf_level = val;
+            break;
+        default:
+            return SYS_EINVAL;
+        }
+
+        if (*eptr != '\0') {
+            return SYS_EINVAL;
+        }
+    }
+
+    return 0;
+}
+
 int
 shell_log_dump_cmd(int argc, char **argv)
 {
     struct log *log;
     struct log_offset log_offset;
+    struct log_filter filter;
     bool last = false;
     bool list_only;
     int rc;
 
     list_only = ((argc > 1) && !strcmp(argv[1], "-l"));
 
+    if (argc > 2) {
+        rc = shell_log_parse_filter(argc - 2, argv + 2, &filter);
+        if (rc != 0) {
+            console_printf("usage: log [-l | <name> [-s <min ts>] "
+                           "[-e <max ts>] [-m <module>] [-v <min level>]]\n");
+            return rc;
+        }
+    }
+
     log = NULL;
     do {
         log = log_list_get_next(log);
@@ -257,7 +337,12 @@ shell_log_dump_cmd(int argc, char **argv)
         log_offset.lo_index = 0;
         log_offset.lo_data_len = 0;
 
-        rc = log_walk_body(log, shell_log_dump_entry, &log_offset);
+        if (argc > 2) {
+            rc = log_walk_body_filtered(log, shell_log_dump_entry,
+                                        &log_offset, &filter);
+        } else {
+            rc = log_walk_body(log, shell_log_dump_entry, &log_offset);
+        }
         if (rc != 0) {
             goto err;
         }
@@ -0,0 +1,586 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(LOG_TOKENIZED)
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include "log/log.h"
+
+#define LOG_TOKEN_LEN           4
+
+/** A parsed printf conversion specification. */
+struct log_token_spec {
+    /** Points to the '%'. */
+    const char *start;
+    /** Length of the specification, including the conversion character. */
+    uint8_t len;
+    /** Number of '*' widths/precisions. */
+    uint8_t stars;
+    /**
+     * Length modifier: 0, 'H' (hh), 'h', 'l', 'L' (ll), 'j', 'z', 't', or
+     * 'D' (long double).
+     */
+    char size;
+    /** Conversion character; 0 if the format string ended early. */
+    char conv;
+};
+
+/**
+ * Finds the next conversion specification at or after p.
+ *
+ * @return                      The first character following the
+ *                                  specification; NULL if there are no more.
+ */
+static const char *
+log_token_next_spec(const char *p, struct log_token_spec *spec)
+{
+    p = strchr(p, '%');
+    if (p == NULL) {
+        return NULL;
+    }
+
+    memset(spec, 0, sizeof *spec);
+    spec->start = p++;
+
+    while (*p != '\0' && strchr("-+ #0", *p) != NULL) {
+        p++;
+    }
+    while (*p == '*' || (*p >= '0' && *p <= '9') || *p == '.') {
+        if (*p == '*') {
+            spec->stars++;
+        }
+        p++;
+    }
+
+    switch (*p) {
+    case 'h':
+        p++;
+        spec->size = 'h';
+        if (*p == 'h') {
+            p++;
+            spec->size = 'H';
+        }
+        break;
+    case 'l':
+        p++;
+        spec->size = 'l';
+        if (*p == 'l') {
+            p++;
+            spec->size = 'L';
+        }
+        break;
+    case 'j':
+    case 'z':
+    case 't':
+        spec->size = *p++;
+        break;
+    case 'L':
+        p++;
+        spec->size = 'D';
+        break;
+    default:
+        break;
+    }
+
+    spec->conv = *p;
+    if (*p != '\0') {
+        p++;
+    }
+    spec->len = p - spec->start;
+
+    return p;
+}
+
+static int
+log_token_put_varint(uint8_t *buf, int off, int len, uint64_t val)
+{
+    do {
+        if (off >= len) {
+            return -1;
+        }
+        buf[off] = val & 0x7f;
+        val >>= 7;
+        if (val != 0) {
+            buf[off] |= 0x80;
+        }
+        off++;
+    } while (val != 0);
+
+    return off;
+}
+
+static int
+log_token_get_varint(const uint8_t *buf, int off, int len, uint64_t *val)
+{
+    int shift;
+
+    *val = 0;
+    for (shift = 0; shift < 64; shift += 7) {
+        if (off >= len) {
+            return -1;
+        }
+        *val |= (uint64_t)(buf[off] & 0x7f) << shift;
+        if (!(buf[off++] & 0x80)) {
+            return off;
+        }
+    }
+
+    return -1;
+}
+
+static uint64_t
+log_token_zigzag(int64_t val)
+{
+    return ((uint64_t)val << 1) ^ (uint64_t)(val >> 63);
+}
+
+static int64_t
+log_token_unzigzag(uint64_t val)
+{
+    return (int64_t)(val >> 1) ^ -(int64_t)(val & 1);
+}
+
+int
+log_token_vencode(void *buf, uint16_t buf_len, const char *fmt, va_list ap)
+{
+    struct log_token_spec spec;
+    const char *str;
+    uint64_t uval;
+    uint32_t token;
+    uint8_t *out;
+    double dval;
+    int64_t sval;
+    int slen;
+    int off;
+    int rc;
+    int i;
+
+    out = buf;
+    if (buf_len < LOG_TOKEN_LEN) {
+        return 0;
+    }
+
+    token = (uint32_t)(uintptr_t)fmt;
+    put_le32(out, token);
+    off = LOG_TOKEN_LEN;
+
+    while ((fmt = log_token_next_spec(fmt, &spec)) != NULL) {
+        for (i = 0; i < spec.stars; i++) {
+            sval = va_arg(ap, int);
+            rc = log_token_put_varint(out, off, buf_len,
+                                      log_token_zigzag(sval));
+            if (rc < 0) {
+                return off;
+            }
+            off = rc;
+        }
+
+        switch (spec.conv) {
+        case 'd':
+        case 'i':
+            switch (spec.size) {
+            case 'l':
+                sval = va_arg(ap, long);
+                break;
+            case 'L':
+                sval = va_arg(ap, long long);
+                break;
+            case 'j':
+                sval = va_arg(ap, intmax_t);
+                break;
+            case 'z':
+                sval = va_arg(ap, size_t);
+                break;
+            case 't':
+                sval = va_arg(ap, ptrdiff_t);
+                break;
+            default:
+                sval = va_arg(ap, int);
+                break;
+            }
+            rc = log_token_put_varint(out, off, buf_len,
+                                      log_token_zigzag(sval));
+            break;
+
+        case 'u':
+        case 'o':
+        case 'x':
+        case 'X':
+            switch (spec.size) {
+            case 'l':
+                uval = va_arg(ap, unsigned long);
+                break;
+            case 'L':
+                uval = va_arg(ap, unsigned long long);
+                break;
+            case 'j':
+                uval = va_arg(ap, uintmax_t);
+                break;
+            case 'z':
+                uval = va_arg(ap, size_t);
+                break;
+            case 't':
+                uval = va_arg(ap, ptrdiff_t);
+                break;
+            default:
+                uval = va_arg(ap, unsigned int);
+                break;
+            }
+            rc = log_token_put_varint(out, off, buf_len, uval);
+            break;
+
+        case 'c':
+            rc = log_token_put_varint(out, off, buf_len,
+                                      (uint8_t)va_arg(ap, int));
+            break;
+
+        case 'p':
+            rc = log_token_put_varint(out, off, buf_len,
+                                      (uintptr_t)va_arg(ap, void *));
+            break;
+
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            if (spec.size == 'D') {
+                dval = va_arg(ap, long double);
+            } else {
+                dval = va_arg(ap, double);
+            }
+            if (off + sizeof dval > buf_len) {
+                return off;
+            }
+            memcpy(out + off, &dval, sizeof dval);
+            rc = off + sizeof dval;
+            break;
+
+        case 's':
+            str = va_arg(ap, const char *);
+            slen = str == NULL ? 0 : strlen(str);
+            if (slen > UINT8_MAX) {
+                slen = UINT8_MAX;
+            }
+            /* Keep as much of the string as fits. */
+            if (off + 1 + slen > buf_len) {
+                slen = buf_len - off - 1;
+                if (slen < 0) {
+                    return off;
+                }
+            }
+            out[off] = slen;
+            if (slen > 0) {
+                memcpy(out + off + 1, str, slen);
+            }
+            rc = off + 1 + slen;
+            break;
+
+        case 'n':
+            (void)va_arg(ap, void *);
+            rc = off;
+            break;
+
+        default:
+            /* "%%" or an unknown conversion; no argument. */
+            rc = off;
+            break;
+        }
+
+        if (rc < 0) {
+            return off;
+        }
+        off = rc;
+    }
+
+    return off;
+}
+
+void
+log_tprintf(struct log *log, uint8_t module, uint8_t level,
+            const char *fmt, ...)
+{
+    uint8_t buf[MYNEWT_VAL(LOG_TOKEN_MAX_LEN)];
+    va_list args;
+    int len;
+
+    va_start(args, fmt);
+    len = log_token_vencode(buf, sizeof buf, fmt, args);
+    va_end(args);
+
+    log_append_body(log, module, level, LOG_ETYPE_TOKEN, buf, len);
+}
+
+#if MYNEWT_VAL(LOG_TOKEN_FMT_ON_TARGET)
+/**
+ * Copies a conversion specification into spec_buf, replacing each '*' with
+ * the next encoded argument.
+ *
+ * @return                      The new body offset; -1 on error.
+ */
+static int
+log_token_copy_spec(const struct log_token_spec *spec, char *spec_buf,
+                    int spec_buf_len, const uint8_t *body, int off,
+                    int body_len)
+{
+    uint64_t val;
+    int pos;
+    int rc;
+    int i;
+
+    pos = 0;
+    for (i = 0; i < spec->len; i++) {
+        if (spec->start[i] == '*') {
+            off = log_token_get_varint(body, off, body_len, &val);
+            if (off < 0) {
+                return -1;
+            }
+            rc = snprintf(spec_buf + pos, spec_buf_len - pos, "%d",
+                          (int)log_token_unzigzag(val));
+        } else {
+            rc = snprintf(spec_buf + pos, spec_buf_len - pos, "%c",
+                          spec->start[i]);
+        }
+        if (rc < 0 || rc >= spec_buf_len - pos) {
+            return -1;
+        }
+        pos += rc;
+    }
+
+    return off;
+}
+
+int
+log_token_format(char *dst, int dst_len, const void *body, uint16_t body_len)
+{
+    char str[MYNEWT_VAL(LOG_TOKEN_MAX_LEN)];
+    struct log_token_spec spec;
+    char spec_buf[32];
+    const uint8_t *in;
+    const char *fmt;
+    const char *p;
+    uint64_t uval;
+    int64_t sval;
+    double dval;
+    int slen;
+    int pos;
+    int off;
+    int rc;
+
+    in = body;
+    if (dst_len <= 0) {
+        return SYS_EINVAL;
+    }
+    dst[0] = '\0';
+    if (body_len < LOG_TOKEN_LEN) {
+        return SYS_EINVAL;
+    }
+
+    fmt = (const char *)(uintptr_t)get_le32(in);
+    off = LOG_TOKEN_LEN;
+    pos = 0;
+
+    for (p = fmt; ; p = spec.start + spec.len) {
+        if (log_token_next_spec(p, &spec) == NULL) {
+            /* Trailing text. */
+            rc = snprintf(dst + pos, dst_len - pos, "%s", p);
+            break;
+        }
+
+        /* Text preceding the specification. */
+        rc = snprintf(dst + pos, dst_len - pos, "%.*s",
+                      (int)(spec.start - p), p);
+        if (rc < 0 || rc >= dst_len - pos) {
+            break;
+        }
+        pos += rc;
+
+        off = log_token_copy_spec(&spec, spec_buf, sizeof spec_buf, in, off,
+                                  body_len);
+        if (off < 0) {
+            return SYS_EINVAL;
+        }
+
+        switch (spec.conv) {
+        case 'd':
+        case 'i':
+        case 'u':
+        case 'o':
+        case 'x':
+        case 'X':
+        case 'c':
+        case 'p':
+            off = log_token_get_varint(in, off, body_len, &uval);
+            if (off < 0) {
+                /* The entry was truncated when it was written. */
+                return pos;
+            }
+            sval = log_token_unzigzag(uval);
+
+            switch (spec.conv) {
+            case 'c':
+                rc = snprintf(dst + pos, dst_len - pos, spec_buf, (int)uval);
+                break;
+            case 'p':
+                rc = snprintf(dst + pos, dst_len - pos, spec_buf,
+                              (void *)(uintptr_t)uval);
+                break;
+            case 'd':
+            case 'i':
+                switch (spec.size) {
+                case 'l':
+                    rc = snprintf(dst + pos, dst_len - pos, spec_buf,
+                                  (long)sval);
+                    break;
+                case 'L':
+                    rc = snprintf(dst + pos, dst_len - pos, spec_buf,
+                                  (long long)sval);
+                    break;
+                case 'j':
+                    rc = snprintf(dst + pos, dst_len - pos, spec_buf,
+                                  (intmax_t)sval);
+                    break;
+                case 'z':
+                    rc = snprintf(dst + pos, dst_len - pos, spec_buf,
+                                  (size_t)sval);
+                    break;
+                case 't':
+                    rc = snprintf(dst + pos, dst_len - pos, spec_buf,
+                                  (ptrdiff_t)sval);
+                    break;
+                default:
+                    rc = snprintf(dst + pos, dst_len - pos, spec_buf,
+                                  (int)sval);
+                    break;
+                }
+                break;
+            default:
+                switch (spec.size) {
+                case 'l':
+                    rc = snprintf(dst + pos, dst_len - pos, spec_buf,
+                                  (unsigned long)uval);
+                    break;
+                case 'L':
+                    rc = snprintf(dst + pos, dst_len - pos, spec_buf,
+                                  (unsigned long long)uval);
+                    break;
+                case 'j':
+                    rc = snprintf(dst + pos, dst_len - pos, spec_buf,
+                                  (uintmax_t)uval);
+                    break;
+                case 'z':
+                    rc = snprintf(dst + pos, dst_len - pos, spec_buf,
+                                  (size_t)uval);
+                    break;
+                case 't':
+                    rc = snprintf(dst + pos, dst_len - pos, spec_buf,
+                                  (ptrdiff_t)uval);
+                    break;
+                default:
+                    rc = snprintf(dst + pos, dst_len - pos, spec_buf,
+                                  (unsigned int)uval);
+                    break;
+                }
+                break;
+            }
+            break;
+
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            if (off + sizeof dval > body_len) {
+                return pos;
+            }
+            memcpy(&dval, in + off, sizeof dval);
+            off += sizeof dval;
+            if (spec.size == 'D') {
+                rc = snprintf(dst + pos, dst_len - pos, spec_buf,
+                              (long double)dval);
+            } else {
+                rc = snprintf(dst + pos, dst_len - pos, spec_buf, dval);
+            }
+            break;
+
+        case 's':
+            if (off >= body_len) {
+                return pos;
+            }
+            slen = in[off++];
+            if (off + slen > body_len || slen >= sizeof str) {
+                return SYS_EINVAL;
+            }
+            memcpy(str, in + off, slen);
+            str[slen] = '\0';
+            off += slen;
+            rc = snprintf(dst + pos, dst_len - pos, spec_buf, str);
+            break;
+
+        case 'n':
+            rc = 0;
+            break;
+
+        case '%':
+            rc = snprintf(dst + pos, dst_len - pos, "%%");
+            break;
+
+        case '\0':
+            return pos;
+
+        default:
+            rc = snprintf(dst + pos, dst_len - pos, "%s", spec_buf);
+            break;
+        }
+
+        if (rc < 0 || rc >= dst_len - pos) {
+            break;
+        }
+        pos += rc;
+    }
+
+    if (rc < 0) {
+        return SYS_EINVAL;
+    }
+    if (rc >= dst_len - pos) {
+        /* Truncated. */
+        return dst_len - 1;
+    }
+
+    return pos + rc;
+}
+#else
+int
+log_token_format(char *dst, int dst_len, const void *body, uint16_t body_len)
+{
+    return SYS_ENOTSUP;
+}
+#endif
+
+#endif
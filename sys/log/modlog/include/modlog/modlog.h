@@ -115,6 +115,8 @@ int modlog_get(uint8_t handle, struct modlog_desc *out_desc);
  * 
  * @return                      0 on success;
  *                              SYS_ENOMEM on memory exhaustion.
+ *                              SYS_EBUSY if called from within a modlog
+ *                                  append, e.g., a log's append callback.
  *                              Other SYS_[...] error on failure.
  */
 int modlog_register(uint8_t module, struct log *log, uint8_t min_level,
@@ -123,16 +125,22 @@ int modlog_register(uint8_t module, struct log *log, uint8_t min_level,
 /**
  * @brief Deletes the configured modlog mapping with the specified handle.
  *
+ * Once this returns, no append uses the mapping anymore.
+ *
  * @param handle                The handle of the mapping to delete.
  *
  * @return                      0 on success;
  *                              SYS_ENOENT if the specified handle is unmapped.
+ *                              SYS_EBUSY if called from within a modlog
+ *                                  append, e.g., a log's append callback.
  *                              Other SYS_[...] error on failure.
  */
 int modlog_delete(uint8_t handle);
 
 /**
  * @brief Deletes all configured modlog mappings.
+ *
+ * Does nothing if called from within a modlog append.
  */
 void modlog_clear(void);
 
@@ -179,6 +187,21 @@ int modlog_append_mbuf(uint8_t module, uint8_t level, uint8_t etype,
  */
 int modlog_foreach(modlog_foreach_fn *fn, void *arg);
 
+/**
+ * @brief Indicates whether a write to the specified log module and level
+ * would be kept by any mapping.
+ *
+ * `modlog_printf()` and `modlog_tprintf()` already check this before
+ * formatting; use it to skip preparing expensive log data.
+ *
+ * @param module                The log module to check.
+ * @param level                 The severity of the log entry.
+ *
+ * @return                      true if a mapping would write the entry;
+ *                              false otherwise.
+ */
+bool modlog_level_enabled(uint8_t module, uint8_t level);
+
 /**
  * @brief Writes a formatted text entry to the specified log module.
  *
@@ -188,6 +211,19 @@ int modlog_foreach(modlog_foreach_fn *fn, void *arg);
  */
 void modlog_printf(uint8_t module, uint8_t level, const char *msg, ...);
 
+#if MYNEWT_VAL(LOG_TOKENIZED)
+/**
+ * @brief Writes a tokenized entry to the specified log module.
+ *
+ * See log_tprintf(); fmt must come from LOG_TOKEN_FMT().
+ *
+ * @param module                The log module to write to.
+ * @param level                 The severity of the log entry to write.
+ * @param fmt                   The dictionary format string.
+ */
+void modlog_tprintf(uint8_t module, uint8_t level, const char *fmt, ...);
+#endif
+
 #else /* LOG_FULL */
 
 static inline int
@@ -234,24 +270,61 @@ modlog_foreach(modlog_foreach_fn *fn, void *arg)
     return SYS_ENOTSUP;
 }
 
+static inline bool
+modlog_level_enabled(uint8_t module, uint8_t level)
+{
+    return false;
+}
+
 static inline void
 modlog_printf(uint8_t module, uint8_t level, const char *msg, ...)
 { }
 
 #endif
 
+#if MYNEWT_VAL(MODLOG_TOKENIZED)
+#define MODLOG_PRINTF_(ml_mod_, ml_lvl_, ml_msg_, ...) \
+    modlog_tprintf((ml_mod_), (ml_lvl_), LOG_TOKEN_FMT(ml_msg_), ##__VA_ARGS__)
+#else
+#define MODLOG_PRINTF_(ml_mod_, ml_lvl_, ml_msg_, ...) \
+    modlog_printf((ml_mod_), (ml_lvl_), (ml_msg_), ##__VA_ARGS__)
+#endif
+
+/**
+ * Compile-time minimum level of a log module: MODLOG_LEVEL_MOD_<n>_MIN for
+ * a module configured in one of the MODLOG_LEVEL_MOD_<n> slots, 0 for the
+ * others.  Writes below it are compiled out, arguments included, when the
+ * module is a constant.  This only adds to the global LOG_LEVEL.
+ */
+#define MODLOG_MOD_MIN_LEVEL(ml_mod_)                                       \
+    ((ml_mod_) == MYNEWT_VAL(MODLOG_LEVEL_MOD_0) ?                          \
+        MYNEWT_VAL(MODLOG_LEVEL_MOD_0_MIN) :                                \
+     (ml_mod_) == MYNEWT_VAL(MODLOG_LEVEL_MOD_1) ?                          \
+        MYNEWT_VAL(MODLOG_LEVEL_MOD_1_MIN) :                                \
+     (ml_mod_) == MYNEWT_VAL(MODLOG_LEVEL_MOD_2) ?                          \
+        MYNEWT_VAL(MODLOG_LEVEL_MOD_2_MIN) :                                \
+     (ml_mod_) == MYNEWT_VAL(MODLOG_LEVEL_MOD_3) ?                          \
+        MYNEWT_VAL(MODLOG_LEVEL_MOD_3_MIN) :                                \
+     0)
+
+#define MODLOG_LEVEL_(ml_mod_, ml_lvl_, ml_msg_, ...)                       \
+    ((ml_lvl_) >= MODLOG_MOD_MIN_LEVEL(ml_mod_) ?                           \
+        MODLOG_PRINTF_((ml_mod_), (ml_lvl_), ml_msg_, ##__VA_ARGS__) :      \
+        (void)0)
+
 #if MYNEWT_VAL(LOG_LEVEL) <= LOG_LEVEL_DEBUG || defined __DOXYGEN__
 /**
  * @brief Writes a formatted debug text entry to the specified log module.
  *
- * This expands to nothing if the global log level is greater than
+ * This expands to nothing if the global log level, or the module's
+ * compile-time level (`MODLOG_MOD_MIN_LEVEL`), is greater than
  * `LOG_LEVEL_DEBUG`.
  *
  * @param ml_mod_               The log module to write to.
  * @param ml_msg_               The "printf" formatted string to write.
  */
 #define MODLOG_DEBUG(ml_mod_, ml_msg_, ...) \
-    modlog_printf((ml_mod_), LOG_LEVEL_DEBUG, (ml_msg_), ##__VA_ARGS__)
+    MODLOG_LEVEL_((ml_mod_), LOG_LEVEL_DEBUG, ml_msg_, ##__VA_ARGS__)
 #else
 #define MODLOG_DEBUG(ml_mod_, ...) IGNORE(__VA_ARGS__)
 #endif
@@ -260,14 +333,15 @@ modlog_printf(uint8_t module, uint8_t level, const char *msg, ...)
 /**
  * @brief Writes a formatted info text entry to the specified log module.
  *
- * This expands to nothing if the global log level is greater than
+ * This expands to nothing if the global log level, or the module's
+ * compile-time level (`MODLOG_MOD_MIN_LEVEL`), is greater than
  * `LOG_LEVEL_INFO`.
  *
  * @param ml_mod_               The log module to write to.
  * @param ml_msg_               The "printf" formatted string to write.
  */
 #define MODLOG_INFO(ml_mod_, ml_msg_, ...) \
-    modlog_printf((ml_mod_), LOG_LEVEL_INFO, (ml_msg_), ##__VA_ARGS__)
+    MODLOG_LEVEL_((ml_mod_), LOG_LEVEL_INFO, ml_msg_, ##__VA_ARGS__)
 #else
 #define MODLOG_INFO(ml_mod_, ...) IGNORE(__VA_ARGS__)
 #endif
@@ -276,14 +350,15 @@ modlog_printf(uint8_t module, uint8_t level, const char *msg, ...)
 /**
  * @brief Writes a formatted warn text entry to the specified log module.
  *
- * This expands to nothing if the global log level is greater than
+ * This expands to nothing if the global log level, or the module's
+ * compile-time level (`MODLOG_MOD_MIN_LEVEL`), is greater than
  * `LOG_LEVEL_WARN`.
  *
  * @param ml_mod_               The log module to write to.
  * @param ml_msg_               The "printf" formatted string to write.
  */
 #define MODLOG_WARN(ml_mod_, ml_msg_, ...) \
-    modlog_printf((ml_mod_), LOG_LEVEL_WARN, (ml_msg_), ##__VA_ARGS__)
+    MODLOG_LEVEL_((ml_mod_), LOG_LEVEL_WARN, ml_msg_, ##__VA_ARGS__)
 #else
 #define MODLOG_WARN(ml_mod_, ...) IGNORE(__VA_ARGS__)
 #endif
@@ -292,14 +367,15 @@ modlog_printf(uint8_t module, uint8_t level, const char *msg, ...)
 /**
  * @brief Writes a formatted error text entry to the specified log module.
  *
- * This expands to nothing if the global log level is greater than
+ * This expands to nothing if the global log level, or the module's
+ * compile-time level (`MODLOG_MOD_MIN_LEVEL`), is greater than
  * `LOG_LEVEL_ERROR`.
  *
  * @param ml_mod_               The log module to write to.
  * @param ml_msg_               The "printf" formatted string to write.
  */
 #define MODLOG_ERROR(ml_mod_, ml_msg_, ...) \
-    modlog_printf((ml_mod_), LOG_LEVEL_ERROR, (ml_msg_), ##__VA_ARGS__)
+    MODLOG_LEVEL_((ml_mod_), LOG_LEVEL_ERROR, ml_msg_, ##__VA_ARGS__)
 #else
 #define MODLOG_ERROR(ml_mod_, ...) IGNORE(__VA_ARGS__)
 #endif
@@ -308,14 +384,15 @@ modlog_printf(uint8_t module, uint8_t level, const char *msg, ...)
 /**
  * @brief Writes a formatted critical text entry to the specified log module.
  *
- * This expands to nothing if the global log level is greater than
+ * This expands to nothing if the global log level, or the module's
+ * compile-time level (`MODLOG_MOD_MIN_LEVEL`), is greater than
  * `LOG_LEVEL_CRITICAL`.
  *
  * @param ml_mod_               The log module to write to.
  * @param ml_msg_               The "printf" formatted string to write.
  */
 #define MODLOG_CRITICAL(ml_mod_, ml_msg_, ...) \
-    modlog_printf((ml_mod_), LOG_LEVEL_CRITICAL, (ml_msg_), ##__VA_ARGS__)
+    MODLOG_LEVEL_((ml_mod_), LOG_LEVEL_CRITICAL, ml_msg_, ##__VA_ARGS__)
 #else
 #define MODLOG_CRITICAL(ml_mod_, ...) IGNORE(__VA_ARGS__)
 #endif
@@ -24,9 +24,11 @@ TEST_SUITE(modlog_test_suite_all)
 {
     modlog_test_case_append();
     modlog_test_case_basic();
+    modlog_test_case_level();
     modlog_test_case_printf();
     modlog_test_case_prio_flat();
     modlog_test_case_prio_mbuf();
+    modlog_test_case_update();
 }
 
 int
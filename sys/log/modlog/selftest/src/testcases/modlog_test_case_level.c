@@ -0,0 +1,72 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#include "modlog_test.h"
+
+static int mltcl_num_evals;
+
+static int
+mltcl_arg(void)
+{
+    mltcl_num_evals++;
+    return 1;
+}
+
+TEST_CASE_SELF(modlog_test_case_level)
+{
+    struct mltu_log_arg mla;
+    struct log log;
+    int rc;
+
+    memset(&mla, 0, sizeof mla);
+    mltu_register_log(&log, &mla, "log", 0);
+
+    rc = modlog_register(1, &log, LOG_LEVEL_INFO, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = modlog_register(MODLOG_MODULE_DFLT, &log, LOG_LEVEL_ERROR, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    TEST_ASSERT(!modlog_level_enabled(1, LOG_LEVEL_DEBUG));
+    TEST_ASSERT(modlog_level_enabled(1, LOG_LEVEL_INFO));
+
+    /* Unmapped modules go by the default mappings. */
+    TEST_ASSERT(!modlog_level_enabled(2, LOG_LEVEL_WARN));
+    TEST_ASSERT(modlog_level_enabled(2, LOG_LEVEL_ERROR));
+
+    modlog_printf(2, LOG_LEVEL_WARN, "dropped %d", 1);
+    TEST_ASSERT(mla.num_entries == 0);
+
+    modlog_printf(2, LOG_LEVEL_ERROR, "kept %d", 2);
+    TEST_ASSERT_FATAL(mla.num_entries == 1);
+    TEST_ASSERT(strcmp((char *)mla.entries[0].body, "kept 2") == 0);
+
+    /* The selftest compiles module 4 writes below LOG_LEVEL_WARN out. */
+    rc = modlog_register(4, &log, LOG_LEVEL_DEBUG, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    MODLOG_INFO(4, "%d", mltcl_arg());
+    TEST_ASSERT(mltcl_num_evals == 0);
+    TEST_ASSERT(mla.num_entries == 1);
+
+    MODLOG_WARN(4, "%d", mltcl_arg());
+    TEST_ASSERT(mltcl_num_evals == 1);
+    TEST_ASSERT(mla.num_entries == 2);
+}
@@ -0,0 +1,110 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "modlog_test.h"
+
+static uint8_t mltcu_handle;
+static int mltcu_cb_rc;
+
+static void
+mltcu_append_cb(struct log *log, uint32_t idx)
+{
+    /* An update from within an append would wait for the append to finish;
+     * it is rejected instead.
+     */
+    mltcu_cb_rc = modlog_delete(mltcu_handle);
+    if (mltcu_cb_rc == SYS_EBUSY) {
+        mltcu_cb_rc = modlog_register(3, log, 0, NULL);
+    }
+    modlog_clear();
+}
+
+TEST_CASE_SELF(modlog_test_case_update)
+{
+    struct mltu_log_arg mla1;
+    struct mltu_log_arg mla2;
+    struct log log1;
+    struct log log2;
+    uint8_t handle2;
+    uint8_t byte;
+    int rc;
+    int i;
+
+    memset(&mla1, 0, sizeof mla1);
+    mltu_register_log(&log1, &mla1, "log1", 0);
+
+    memset(&mla2, 0, sizeof mla2);
+    mltu_register_log(&log2, &mla2, "log2", 0);
+
+    /* Both logs are mapped to module 1; log1 tries to unmap itself, map
+     * another module and clear all mappings from its append callback.  None
+     * of it happens, and both logs keep getting entries.
+     */
+    rc = modlog_register(1, &log1, 0, &mltcu_handle);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = modlog_register(1, &log2, 0, &handle2);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    log_set_append_cb(&log1, mltcu_append_cb);
+    mltcu_cb_rc = -1;
+
+    byte = 'a';
+    mltu_append(1, 4, LOG_ETYPE_STRING, &byte, 1, false);
+    TEST_ASSERT(mltcu_cb_rc == SYS_EBUSY);
+    TEST_ASSERT(mla1.num_entries == 1);
+    TEST_ASSERT(mla2.num_entries == 1);
+
+    mltcu_cb_rc = -1;
+    mltu_append(1, 4, LOG_ETYPE_STRING, &byte, 1, true);
+    TEST_ASSERT(mltcu_cb_rc == SYS_EBUSY);
+    TEST_ASSERT(mla1.num_entries == 2);
+    TEST_ASSERT(mla2.num_entries == 2);
+
+    TEST_ASSERT(modlog_get(mltcu_handle, NULL) == 0);
+    TEST_ASSERT(modlog_get(handle2, NULL) == 0);
+
+    log_set_append_cb(&log1, NULL);
+
+    /* Outside of an append, the update goes through. */
+    rc = modlog_delete(mltcu_handle);
+    TEST_ASSERT_FATAL(rc == 0);
+    mltu_append(1, 4, LOG_ETYPE_STRING, &byte, 1, false);
+    TEST_ASSERT(mla1.num_entries == 2);
+    TEST_ASSERT(mla2.num_entries == 3);
+
+    /* Repeated updates alternate between the two mapping snapshots. */
+    for (i = 0; i < 5; i++) {
+        rc = modlog_register(2, &log1, 0, &mltcu_handle);
+        TEST_ASSERT_FATAL(rc == 0);
+
+        mltu_append(2, 4, LOG_ETYPE_STRING, &byte, 1, i % 2);
+        TEST_ASSERT(mla1.num_entries == 3 + i);
+
+        rc = modlog_delete(mltcu_handle);
+        TEST_ASSERT_FATAL(rc == 0);
+
+        mltu_append(2, 4, LOG_ETYPE_STRING, &byte, 1, i % 2);
+        TEST_ASSERT(mla1.num_entries == 3 + i);
+    }
+
+    TEST_ASSERT(mla2.num_entries == 3);
+
+    rc = modlog_delete(handle2);
+    TEST_ASSERT_FATAL(rc == 0);
+}
@@ -18,6 +18,7 @@
  */
 
 #include <stdarg.h>
+#include <string.h>
 #include "os/mynewt.h"
 #include "rwlock/rwlock.h"
 #include "log/log.h"
@@ -46,10 +47,47 @@ static struct modlog_list modlog_mappings =
     SLIST_HEAD_INITIALIZER(&modlog_mappings);
 
 /**
- * Points to the first default mapping in the list.  Since 255 is the default
- * module, the default mappings are guaranteed to come last.
+ * An append reading a mapping snapshot; lives on the append's stack.
  */
-static struct modlog_mapping *modlog_first_dflt;
+struct modlog_reader {
+    SLIST_ENTRY(modlog_reader) next;
+    /** Task the append runs in; lets an update spot appends of its own. */
+    struct os_task *task;
+    struct modlog_snap *snap;
+};
+
+SLIST_HEAD(modlog_reader_list, modlog_reader);
+
+/**
+ * Immutable copy of the mapping list, read by the append functions without
+ * taking the modlog lock.  There are two copies: an update rebuilds the one
+ * not in use, publishes it, and waits for the appends still reading the
+ * other one before it returns.
+ */
+struct modlog_snap {
+    /** Appends currently reading this copy. */
+    struct modlog_reader_list readers;
+    /** Number of valid entries in descs. */
+    uint8_t count;
+    /**
+     * Index of the first default mapping; count if there is none.  Since 255
+     * is the default module, the default mappings are guaranteed to come
+     * last.
+     */
+    uint8_t first_dflt;
+    /**
+     * Lowest min_level of the default mappings; above any level if there is
+     * none.  Lets writes nobody keeps skip formatting.
+     */
+    uint8_t dflt_min_level;
+    /** The mappings, sorted by module like the list. */
+    struct modlog_desc descs[MYNEWT_VAL(MODLOG_MAX_MAPPINGS)];
+};
+
+static struct modlog_snap modlog_snaps[2];
+
+/** Index of the copy that appends read. */
+static volatile uint32_t modlog_snap_cur;
 
 static struct modlog_mapping *
 modlog_alloc(void)
@@ -148,19 +186,11 @@ modlog_insert(struct modlog_mapping *mm)
     } else {
         SLIST_INSERT_AFTER(prev, mm, next);
     }
-
-    if (mm->desc.module == MODLOG_MODULE_DFLT) {
-        modlog_first_dflt = mm;
-    }
 }
 
 static void
 modlog_remove(struct modlog_mapping *mm, struct modlog_mapping *prev)
 {
-    if (mm == modlog_first_dflt) {
-        modlog_first_dflt = SLIST_NEXT(mm, next);
-    }
-        
     if (prev == NULL) {
         SLIST_REMOVE_HEAD(&modlog_mappings, next);
     } else {
@@ -168,6 +198,102 @@ modlog_remove(struct modlog_mapping *mm, struct modlog_mapping *prev)
     }
 }
 
+/**
+ * Tells whether the current task is in the middle of an append, i.e., is
+ * called back from a log.  It cannot update the mappings then: the update
+ * would wait for the append to finish.
+ */
+static bool
+modlog_in_append(void)
+{
+    struct modlog_reader *mr;
+    struct os_task *task;
+    bool found;
+    os_sr_t sr;
+    int i;
+
+    task = os_sched_get_current_task();
+    found = false;
+
+    OS_ENTER_CRITICAL(sr);
+    for (i = 0; i < 2 && !found; i++) {
+        SLIST_FOREACH(mr, &modlog_snaps[i].readers, next) {
+            if (mr->task == task) {
+                found = true;
+                break;
+            }
+        }
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    return found;
+}
+
+/**
+ * Copies the mapping list into the unused snapshot and makes appends use it.
+ * Returns once no append reads the previous snapshot anymore, so mappings
+ * removed by the update are no longer in use.  Must be called with the
+ * modlog lock held for writing, and not from within an append.
+ */
+static void
+modlog_publish(void)
+{
+    struct modlog_mapping *mm;
+    struct modlog_snap *snap;
+    struct modlog_snap *prev;
+    uint32_t idx;
+
+    idx = !modlog_snap_cur;
+    snap = &modlog_snaps[idx];
+    prev = &modlog_snaps[!idx];
+
+    /* The previous update drained this copy. */
+    assert(SLIST_EMPTY(&snap->readers));
+
+    snap->count = 0;
+    snap->first_dflt = 0;
+    snap->dflt_min_level = UINT8_MAX;
+    SLIST_FOREACH(mm, &modlog_mappings, next) {
+        if (mm->desc.module != MODLOG_MODULE_DFLT) {
+            snap->first_dflt++;
+        } else if (mm->desc.min_level < snap->dflt_min_level) {
+            snap->dflt_min_level = mm->desc.min_level;
+        }
+        snap->descs[snap->count++] = mm->desc;
+    }
+
+    modlog_snap_cur = idx;
+
+    while (!SLIST_EMPTY(&prev->readers)) {
+        os_time_delay(1);
+    }
+}
+
+static struct modlog_snap *
+modlog_snap_acquire(struct modlog_reader *mr)
+{
+    os_sr_t sr;
+
+    mr->task = os_sched_get_current_task();
+
+    OS_ENTER_CRITICAL(sr);
+    mr->snap = &modlog_snaps[modlog_snap_cur];
+    SLIST_INSERT_HEAD(&mr->snap->readers, mr, next);
+    OS_EXIT_CRITICAL(sr);
+
+    return mr->snap;
+}
+
+static void
+modlog_snap_release(struct modlog_reader *mr)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    SLIST_REMOVE(&mr->snap->readers, mr, modlog_reader, next);
+    OS_EXIT_CRITICAL(sr);
+}
+
 static int
 modlog_register_no_lock(uint8_t module, struct log *log, uint8_t min_level,
                         uint8_t *out_handle)
@@ -191,6 +317,7 @@ modlog_register_no_lock(uint8_t module, struct log *log, uint8_t min_level,
     };
 
     modlog_insert(mm);
+    modlog_publish();
 
     if (out_handle != NULL) {
         *out_handle = mm->desc.handle;
@@ -211,60 +338,66 @@ modlog_delete_no_lock(uint8_t handle)
     }
 
     modlog_remove(mm, prev);
+    modlog_publish();
     modlog_free(mm);
 
     return 0;
 }
 
 static int
-modlog_append_one(struct modlog_mapping *mm, uint8_t module, uint8_t level,
-                  uint8_t etype, void *data, uint16_t len)
+modlog_append_one(const struct modlog_desc *desc, uint8_t module,
+                  uint8_t level, uint8_t etype, void *data, uint16_t len)
 {
     int rc;
 
-    if (level >= mm->desc.min_level) {
-        rc = log_append_body(mm->desc.log, module, level, etype, data, len);
+    if (level >= desc->min_level) {
+        rc = log_append_body(desc->log, module, level, etype, data, len);
         if (rc != 0) {
             return SYS_EIO;
         }
     } else {
-        LOG_STATS_INC(mm->desc.log, writes);
-        LOG_STATS_INC(mm->desc.log, drops);
+        LOG_STATS_INC(desc->log, writes);
+        LOG_STATS_INC(desc->log, drops);
     }
 
     return 0;
 }
 
 static int
-modlog_append_no_lock(uint8_t module, uint8_t level, uint8_t etype,
-                      void *data, uint16_t len)
+modlog_append_snap(const struct modlog_snap *snap, uint8_t module,
+                   uint8_t level, uint8_t etype, void *data, uint16_t len)
 {
-    struct modlog_mapping *mm;
+    bool found;
     int rc;
+    int i;
 
     if (module == MODLOG_MODULE_DFLT) {
         return SYS_EINVAL;
     }
 
-    mm = modlog_find_by_module(module, NULL);
-    if (mm != NULL) {
-        while (mm != NULL && mm->desc.module == module) {
-            rc = modlog_append_one(mm, module, level, etype, data, len);
+    found = false;
+    for (i = 0; i < snap->first_dflt && snap->descs[i].module <= module;
+         i++) {
+
+        if (snap->descs[i].module == module) {
+            found = true;
+
+            rc = modlog_append_one(&snap->descs[i], module, level, etype,
+                                   data, len);
             if (rc != 0) {
                 return rc;
             }
-
-            mm = SLIST_NEXT(mm, next);
         }
+    }
+
+    if (found) {
         return 0;
     }
 
     /* No mappings match the specified module; write to the default set. */
-    for (mm = modlog_first_dflt;
-         mm != NULL;
-         mm = SLIST_NEXT(mm, next)) {
-
-        rc = modlog_append_one(mm, module, level, etype, data, len);
+    for (i = snap->first_dflt; i < snap->count; i++) {
+        rc = modlog_append_one(&snap->descs[i], module, level, etype,
+                               data, len);
         if (rc != 0) {
             return rc;
         }
@@ -273,57 +406,90 @@ modlog_append_no_lock(uint8_t module, uint8_t level, uint8_t etype,
     return 0;
 }
 
+/**
+ * Lowest level a write to the module needs to be kept by any mapping.
+ */
+static uint8_t
+modlog_snap_min_level(const struct modlog_snap *snap, uint8_t module)
+{
+    uint8_t min_level;
+    bool found;
+    int i;
+
+    if (module == MODLOG_MODULE_DFLT) {
+        return UINT8_MAX;
+    }
+
+    found = false;
+    min_level = UINT8_MAX;
+    for (i = 0; i < snap->first_dflt && snap->descs[i].module <= module;
+         i++) {
+
+        if (snap->descs[i].module == module) {
+            found = true;
+            if (snap->descs[i].min_level < min_level) {
+                min_level = snap->descs[i].min_level;
+            }
+        }
+    }
+
+    if (found) {
+        return min_level;
+    }
+
+    return snap->dflt_min_level;
+}
+
 static int
-modlog_append_mbuf_one(struct modlog_mapping *mm, uint8_t module,
+modlog_append_mbuf_one(const struct modlog_desc *desc, uint8_t module,
                        uint8_t level, uint8_t etype, struct os_mbuf *om)
 {
     int rc;
 
-    if (level >= mm->desc.min_level) {
-        rc = log_append_mbuf_body_no_free(mm->desc.log, module,
+    if (level >= desc->min_level) {
+        rc = log_append_mbuf_body_no_free(desc->log, module,
                                           level, etype, om);
         if (rc != 0) {
             return SYS_EIO;
         }
     } else {
-        LOG_STATS_INC(mm->desc.log, writes);
-        LOG_STATS_INC(mm->desc.log, drops);
+        LOG_STATS_INC(desc->log, writes);
+        LOG_STATS_INC(desc->log, drops);
     }
 
     return 0;
 }
 
 static int
-modlog_append_mbuf_no_lock(uint8_t module, uint8_t level, uint8_t etype,
-                           struct os_mbuf *om)
+modlog_append_mbuf_snap(const struct modlog_snap *snap, uint8_t module,
+                        uint8_t level, uint8_t etype, struct os_mbuf *om)
 {
-    struct modlog_mapping *mm;
     bool found;
     int rc;
+    int i;
 
     rc = 0;
 
     found = false;
-    SLIST_FOREACH(mm, &modlog_mappings, next) {
-        if (mm->desc.module == module) {
+    for (i = 0; i < snap->first_dflt && snap->descs[i].module <= module;
+         i++) {
+
+        if (snap->descs[i].module == module) {
             found = true;
 
-            rc = modlog_append_mbuf_one(mm, module, level, etype, om);
+            rc = modlog_append_mbuf_one(&snap->descs[i], module, level, etype,
+                                        om);
             if (rc != 0) {
                 break;
             }
-        } else if (mm->desc.module > module) {
-            break;
         }
     }
 
     /* If no mappings match the specified module, write to the default set. */
     if (!found) {
-        for (mm = modlog_first_dflt;
-             mm != NULL;
-             mm = SLIST_NEXT(mm, next)) {
-
-            rc = modlog_append_mbuf_one(mm, module, level, etype, om);
+        for (i = snap->first_dflt; i < snap->count; i++) {
+            rc = modlog_append_mbuf_one(&snap->descs[i], module, level, etype,
+                                        om);
             if (rc != 0) {
                 break;
             }
@@ -386,6 +552,10 @@ modlog_register(uint8_t module, struct log *log, uint8_t min_level,
 {
     int rc;
 
+    if (modlog_in_append()) {
+        return SYS_EBUSY;
+    }
+
     rwlock_acquire_write(&modlog_rwl);
     rc = modlog_register_no_lock(module, log, min_level, out_handle);
     rwlock_release_write(&modlog_rwl);
@@ -398,6 +568,10 @@ modlog_delete(uint8_t handle)
 {
     int rc;
 
+    if (modlog_in_append()) {
+        return SYS_EBUSY;
+    }
+
     rwlock_acquire_write(&modlog_rwl);
     rc = modlog_delete_no_lock(handle);
     rwlock_release_write(&modlog_rwl);
@@ -410,12 +584,17 @@ modlog_clear(void)
 {
     struct modlog_mapping *mm;
 
+    if (modlog_in_append()) {
+        return;
+    }
+
     rwlock_acquire_write(&modlog_rwl);
 
     while ((mm = SLIST_FIRST(&modlog_mappings)) != NULL) {
         modlog_remove(mm, NULL);
         modlog_free(mm);
     }
+    modlog_publish();
 
     rwlock_release_write(&modlog_rwl);
 }
@@ -424,11 +603,13 @@ int
 modlog_append(uint8_t module, uint8_t level, uint8_t etype,
               void *data, uint16_t len)
 {
+    struct modlog_reader mr;
+    struct modlog_snap *snap;
     int rc;
 
-    rwlock_acquire_read(&modlog_rwl);
-    rc = modlog_append_no_lock(module, level, etype, data, len);
-    rwlock_release_read(&modlog_rwl);
+    snap = modlog_snap_acquire(&mr);
+    rc = modlog_append_snap(snap, module, level, etype, data, len);
+    modlog_snap_release(&mr);
 
     return rc;
 }
@@ -437,11 +618,13 @@ int
 modlog_append_mbuf(uint8_t module, uint8_t level, uint8_t etype,
                    struct os_mbuf *om)
 {
+    struct modlog_reader mr;
+    struct modlog_snap *snap;
     int rc;
 
-    rwlock_acquire_read(&modlog_rwl);
-    rc = modlog_append_mbuf_no_lock(module, level, etype, om);
-    rwlock_release_read(&modlog_rwl);
+    snap = modlog_snap_acquire(&mr);
+    rc = modlog_append_mbuf_snap(snap, module, level, etype, om);
+    modlog_snap_release(&mr);
 
     return rc;
 }
@@ -458,13 +641,38 @@ modlog_foreach(modlog_foreach_fn *fn, void *arg)
     return rc;
 }
 
+bool
+modlog_level_enabled(uint8_t module, uint8_t level)
+{
+    struct modlog_reader mr;
+    struct modlog_snap *snap;
+    bool enabled;
+
+    snap = modlog_snap_acquire(&mr);
+    enabled = level >= modlog_snap_min_level(snap, module);
+    modlog_snap_release(&mr);
+
+    return enabled;
+}
+
 void
 modlog_printf(uint8_t module, uint8_t level, const char *msg, ...)
 {
     va_list args;
     char buf[MYNEWT_VAL(MODLOG_MAX_PRINTF_LEN)];
+    struct modlog_reader mr;
+    struct modlog_snap *snap;
     int len;
 
+    snap = modlog_snap_acquire(&mr);
+
+    if (level < modlog_snap_min_level(snap, module)) {
+        /* No mapping keeps it; only count the drops. */
+        modlog_append_snap(snap, module, level, LOG_ETYPE_STRING, NULL, 0);
+        modlog_snap_release(&mr);
+        return;
+    }
+
     va_start(args, msg);
     len = vsnprintf(buf, MYNEWT_VAL(MODLOG_MAX_PRINTF_LEN), msg, args);
     va_end(args);
@@ -473,8 +681,36 @@ modlog_printf(uint8_t module, uint8_t level, const char *msg, ...)
         len = MYNEWT_VAL(MODLOG_MAX_PRINTF_LEN) - 1;
     }
 
-    modlog_append(module, level, LOG_ETYPE_STRING, buf, len);
+    modlog_append_snap(snap, module, level, LOG_ETYPE_STRING, buf, len);
+    modlog_snap_release(&mr);
+}
+
+#if MYNEWT_VAL(LOG_TOKENIZED)
+void
+modlog_tprintf(uint8_t module, uint8_t level, const char *fmt, ...)
+{
+    uint8_t buf[MYNEWT_VAL(LOG_TOKEN_MAX_LEN)];
+    struct modlog_reader mr;
+    struct modlog_snap *snap;
+    va_list args;
+    int len;
+
+    snap = modlog_snap_acquire(&mr);
+
+    if (level < modlog_snap_min_level(snap, module)) {
+        modlog_append_snap(snap, module, level, LOG_ETYPE_TOKEN, NULL, 0);
+        modlog_snap_release(&mr);
+        return;
+    }
+
+    va_start(args, fmt);
+    len = log_token_vencode(buf, sizeof buf, fmt, args);
+    va_end(args);
+
+    modlog_append_snap(snap, module, level, LOG_ETYPE_TOKEN, buf, len);
+    modlog_snap_release(&mr);
 }
+#endif
 
 void
 modlog_init(void)
@@ -489,7 +725,8 @@ modlog_init(void)
     SYSINIT_PANIC_ASSERT(rc == 0);
 
     SLIST_INIT(&modlog_mappings);
-    modlog_first_dflt = NULL;
+    memset(modlog_snaps, 0, sizeof modlog_snaps);
+    modlog_snap_cur = 0;
 
     rc = rwlock_init(&modlog_rwl);
     SYSINIT_PANIC_ASSERT(rc == 0);
@@ -141,7 +141,9 @@ extern "C" {
  * In general, each series require at least single block to hold a single value.
  * As number of values increases in a series it may be necessary to allocate
  * more blocks for the same data series. Once event data is reset, all blocks
- * allocated for an event are freed.
+ * allocated for an event are freed. With METRICS_SERIES_DELTA enabled, series
+ * are stored as varint-encoded differences, so slowly changing series need
+ * about one byte per value regardless of type.
  */
 
 /* Helper to define metric type - use types defined below instead! */
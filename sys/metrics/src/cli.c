@@ -193,7 +193,11 @@ cmd_event_dump(int argc, char **argv)
     metrics_event_to_cbor(hdr, om);
     cbor_mbuf_reader_init(&reader, om, 0);
     cbor_parser_init(&reader.r, 0, &parser, &value);
+#if MYNEWT_VAL(STREAMER_CBOR)
+    streamer_cbor_pretty(streamer_console_get(), &value);
+#else
     cbor_value_to_pretty(stdout, &value);
+#endif
     os_mbuf_free_chain(om);
 
     console_printf("\n");
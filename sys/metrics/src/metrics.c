@@ -208,6 +208,70 @@ set_single_value(struct metrics_event_hdr *hdr, uint8_t metric,
     return 0;
 }
 
+#if MYNEWT_VAL(METRICS_SERIES_DELTA)
+/*
+ * Series are stored as zigzag-encoded differences between consecutive
+ * values, as LEB128 varints: slowly changing series take one byte per value
+ * regardless of type.  The last value stored is kept in the user header of
+ * the first mbuf.
+ */
+static int
+set_series_value(struct metrics_event_hdr *hdr, uint8_t metric,
+                 uint32_t val, uint8_t type)
+{
+    struct metrics_event *em = (struct metrics_event *)hdr;
+    union metrics_metric_val *v;
+    uint8_t buf[5];
+    uint32_t *last;
+    uint32_t zz;
+    int32_t delta;
+    uint16_t type_len;
+    int len;
+
+    v = &em->vals[metric];
+
+    if (!v->series) {
+        v->series = os_mbuf_get_pkthdr(&event_metric_mbuf_pool,
+                                       sizeof(uint32_t));
+        if (!v->series) {
+            return SYS_ENOMEM;
+        }
+        last = OS_MBUF_USRHDR(v->series);
+        *last = 0;
+    }
+    last = OS_MBUF_USRHDR(v->series);
+
+    type_len = type & METRICS_TYPE_SIZE_MASK;
+    assert((type_len == 1) || (type_len == 2) || (type_len == 4));
+
+    /* Truncate as a raw series would */
+    if (type_len < sizeof(uint32_t)) {
+        val &= (1UL << (type_len * 8)) - 1;
+    }
+
+    delta = (int32_t)(val - *last);
+    zz = ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+
+    len = 0;
+    do {
+        buf[len] = zz & 0x7f;
+        zz >>= 7;
+        if (zz) {
+            buf[len] |= 0x80;
+        }
+        len++;
+    } while (zz);
+
+    if (os_mbuf_append(v->series, buf, len)) {
+        return SYS_ENOMEM;
+    }
+    *last = val;
+
+    hdr->set |= (1 << metric);
+
+    return 0;
+}
+#else
 static int
 set_series_value(struct metrics_event_hdr *hdr, uint8_t metric,
                  uint32_t val, uint8_t type)
@@ -220,18 +284,24 @@ set_series_value(struct metrics_event_hdr *hdr, uint8_t metric,
 
     if (!v->series) {
         v->series = os_mbuf_get(&event_metric_mbuf_pool, 0);
+        if (!v->series) {
+            return SYS_ENOMEM;
+        }
     }
 
     val = htole32(val);
     type_len = type & METRICS_TYPE_SIZE_MASK;
     assert((type_len == 1) || (type_len == 2) || (type_len == 4));
 
-    os_mbuf_append(v->series, &val, type_len);
+    if (os_mbuf_append(v->series, &val, type_len)) {
+        return SYS_ENOMEM;
+    }
 
     hdr->set |= (1 << metric);
 
     return 0;
 }
+#endif
 
 int
 metrics_set_value(struct metrics_event_hdr *hdr, uint8_t metric,
@@ -292,139 +362,117 @@ metrics_set_series_value(struct metrics_event_hdr *hdr, uint8_t metric, uint32_t
     return set_series_value(hdr, metric, val, def->type);
 }
 
-static int
-append_series_u8_to_cbor(CborEncoder *encoder, struct os_mbuf *om)
-{
-    uint8_t *ptr;
-
-    while (om) {
-        ptr = om->om_data;
-
-        while (ptr < om->om_data + om->om_len) {
-            if (cbor_encode_uint(encoder, *ptr)) {
-                return SYS_EUNKNOWN;
-            }
-            ptr += sizeof(uint8_t);
-        }
-
-        om = SLIST_NEXT(om, om_next);
-    }
-
-    return 0;
-}
+/*
+ * Reads series bytes in order.  If consume is set, each mbuf is freed as
+ * soon as it has been read, so serializing into the metrics pool needs
+ * little more than the space the series itself took.
+ */
+struct series_reader {
+    struct os_mbuf **series;
+    struct os_mbuf *om;
+    uint16_t off;
+    bool consume;
+};
 
 static int
-append_series_s8_to_cbor(CborEncoder *encoder, struct os_mbuf *om)
+series_read_byte(struct series_reader *sr, uint8_t *byte)
 {
-    uint8_t *ptr;
-
-    while (om) {
-        ptr = om->om_data;
-
-        while (ptr < om->om_data + om->om_len) {
-            if (cbor_encode_int(encoder, (int8_t)*ptr)) {
-                return SYS_EUNKNOWN;
-            }
-            ptr += sizeof(uint8_t);
+    while (sr->om && sr->off >= sr->om->om_len) {
+        if (sr->consume) {
+            *sr->series = SLIST_NEXT(sr->om, om_next);
+            os_mbuf_free(sr->om);
+            sr->om = *sr->series;
+        } else {
+            sr->om = SLIST_NEXT(sr->om, om_next);
         }
-
-        om = SLIST_NEXT(om, om_next);
+        sr->off = 0;
     }
-
-    return 0;
-}
-
-static int
-append_series_u16_to_cbor(CborEncoder *encoder, struct os_mbuf *om)
-{
-    uint16_t u16;
-    uint8_t *ptr;
-
-    while (om) {
-        ptr = om->om_data;
-
-        while (ptr < om->om_data + om->om_len) {
-            memcpy(&u16, ptr, sizeof(uint16_t));
-            u16 = le16toh(u16);
-            if (cbor_encode_uint(encoder, u16)) {
-                return SYS_EUNKNOWN;
-            }
-            ptr += sizeof(uint16_t);
-        }
-
-        om = SLIST_NEXT(om, om_next);
+    if (!sr->om) {
+        return SYS_ENOENT;
     }
 
+    *byte = sr->om->om_data[sr->off++];
+
     return 0;
 }
 
+#if MYNEWT_VAL(METRICS_SERIES_DELTA)
 static int
-append_series_s16_to_cbor(CborEncoder *encoder, struct os_mbuf *om)
+series_read_value(struct series_reader *sr, uint16_t type_len,
+                  uint32_t *acc)
 {
-    int16_t s16;
-    uint8_t *ptr;
-
-    while (om) {
-        ptr = om->om_data;
-
-        while (ptr < om->om_data + om->om_len) {
-            memcpy(&s16, ptr, sizeof(int16_t));
-            s16 = le16toh(s16);
-            if (cbor_encode_int(encoder, s16)) {
-                return SYS_EUNKNOWN;
-            }
-            ptr += sizeof(int16_t);
+    uint32_t zz;
+    uint8_t byte;
+    int shift;
+
+    zz = 0;
+    shift = 0;
+    do {
+        if (series_read_byte(sr, &byte)) {
+            return SYS_ENOENT;
         }
+        zz |= (uint32_t)(byte & 0x7f) << shift;
+        shift += 7;
+    } while ((byte & 0x80) && shift < 32);
 
-        om = SLIST_NEXT(om, om_next);
-    }
+    *acc += (zz >> 1) ^ -(zz & 1);
 
     return 0;
 }
-
+#else
 static int
-append_series_u32_to_cbor(CborEncoder *encoder, struct os_mbuf *om)
+series_read_value(struct series_reader *sr, uint16_t type_len,
+                  uint32_t *acc)
 {
-    uint32_t u32;
-    uint8_t *ptr;
-
-    while (om) {
-        ptr = om->om_data;
+    uint8_t byte;
+    int i;
 
-        while (ptr < om->om_data + om->om_len) {
-            memcpy(&u32, ptr, sizeof(uint32_t));
-            u32 = le32toh(u32);
-            if (cbor_encode_uint(encoder, u32)) {
-                return SYS_EUNKNOWN;
-            }
-            ptr += sizeof(uint32_t);
+    *acc = 0;
+    for (i = 0; i < type_len; i++) {
+        if (series_read_byte(sr, &byte)) {
+            return SYS_ENOENT;
         }
-
-        om = SLIST_NEXT(om, om_next);
+        *acc |= (uint32_t)byte << (i * 8);
     }
 
     return 0;
 }
+#endif
 
 static int
-append_series_s32_to_cbor(CborEncoder *encoder, struct os_mbuf *om)
+append_series_to_cbor(CborEncoder *encoder, struct os_mbuf **series,
+                      uint8_t type, bool consume)
 {
-    int32_t s32;
-    uint8_t *ptr;
+    struct series_reader sr;
+    uint16_t type_len;
+    uint32_t acc;
+    uint32_t val;
+    int shift;
+    int rc;
 
-    while (om) {
-        ptr = om->om_data;
+    sr.series = series;
+    sr.om = *series;
+    sr.off = 0;
+    sr.consume = consume;
 
-        while (ptr < om->om_data + om->om_len) {
-            memcpy(&s32, ptr, sizeof(int32_t));
-            s32 = le32toh(s32);
-            if (cbor_encode_int(encoder, s32)) {
-                return SYS_EUNKNOWN;
-            }
-            ptr += sizeof(int32_t);
-        }
+    type_len = type & METRICS_TYPE_SIZE_MASK;
+    shift = 32 - type_len * 8;
+    acc = 0;
 
-        om = SLIST_NEXT(om, om_next);
+    while (series_read_value(&sr, type_len, &acc) == 0) {
+        val = acc;
+        if (shift) {
+            val &= UINT32_MAX >> shift;
+        }
+        if (type & METRICS_TYPE_SIGNED_MASK) {
+            rc = cbor_encode_int(encoder,
+                                 (int32_t)(val << shift) >> shift);
+        } else {
+            rc = cbor_encode_uint(encoder, val);
+        }
+        if (rc) {
+            return SYS_EUNKNOWN;
+        }
     }
 
     return 0;
@@ -487,40 +535,20 @@ metrics_event_to_cbor(struct metrics_event_hdr *hdr, struct os_mbuf *om)
             return SYS_ENOMEM;
         }
 
-        switch (def->type) {
-        case METRICS_TYPE_SERIES_U8:
-            append_series_u8_to_cbor(&arr, v->series);
-            break;
-        case METRICS_TYPE_SERIES_S8:
-            append_series_s8_to_cbor(&arr, v->series);
-            break;
-        case METRICS_TYPE_SERIES_U16:
-            append_series_u16_to_cbor(&arr, v->series);
-            break;
-        case METRICS_TYPE_SERIES_S16:
-            append_series_s16_to_cbor(&arr, v->series);
-            break;
-        case METRICS_TYPE_SERIES_U32:
-            append_series_u32_to_cbor(&arr, v->series);
-            break;
-        case METRICS_TYPE_SERIES_S32:
-            append_series_s32_to_cbor(&arr, v->series);
-            break;
-        default:
-            assert(0);
-        }
+        /*
+         * If om is from event_metric pool, free the series chain as it is
+         * serialized to make space for the CBOR stream - assume we do this
+         * at the end of event so will start over anyway.
+         */
+        append_series_to_cbor(&arr, &v->series, def->type,
+                              om->om_omp == &event_metric_mbuf_pool);
 
         rc = cbor_encoder_close_container(&map, &arr);
         if (rc != 0) {
             return SYS_ENOMEM;
         }
 
-        /*
-         * Let's remove existing series chain to free space in case om is from
-         * event_metric pool - assume we do this at the end of event so will
-         * start over anyway.
-         */
-        if (om->om_omp == &event_metric_mbuf_pool) {
+        if (om->om_omp == &event_metric_mbuf_pool && v->series) {
             os_mbuf_free_chain(v->series);
             v->series = NULL;
         }
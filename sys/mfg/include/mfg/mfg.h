@@ -63,6 +63,7 @@ struct mfg_reader {
 
     /** Private. */
     uint8_t mmr_idx;
+    uint8_t index_pos;
     uint32_t offset;
 };
 
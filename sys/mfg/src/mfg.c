@@ -89,6 +89,35 @@ static int mfg_num_mmrs;
 /** True if MMR detection has occurred. */
 static bool mfg_initialized;
 
+#if MYNEWT_VAL(MFG_INDEX_MAX_TLVS) > 0
+
+#if MYNEWT_VAL(MFG_INDEX_MAX_TLVS) > 255
+#error "MFG_INDEX_MAX_TLVS must fit in a uint8_t"
+#endif
+
+/**
+ * RAM copy of all TLVs, read in a single pass over the MMRs at init.  Seeks
+ * and reads are served from here; flash is only read again if the TLVs did
+ * not fit.
+ */
+struct mfg_index_entry {
+    struct mfg_meta_tlv tlv;
+
+    /* Offset of the TLV data in mfg_index_data. */
+    uint16_t data_off;
+};
+
+static struct mfg_index_entry mfg_index[MYNEWT_VAL(MFG_INDEX_MAX_TLVS)];
+static uint8_t mfg_index_data[MYNEWT_VAL(MFG_INDEX_DATA_SIZE)];
+static int mfg_index_num;
+static int mfg_index_data_len;
+
+/** True if every TLV made it into the index. */
+static bool mfg_index_complete;
+static bool mfg_index_valid;
+
+#endif
+
 void
 mfg_open(struct mfg_reader *out_reader)
 {
@@ -164,11 +193,32 @@ done:
     return rc;
 }
 
+#if MYNEWT_VAL(MFG_INDEX_MAX_TLVS) > 0
+static int
+mfg_index_seek_next(struct mfg_reader *reader)
+{
+    if (reader->index_pos >= mfg_index_num) {
+        return SYS_EDONE;
+    }
+
+    reader->cur_tlv = mfg_index[reader->index_pos].tlv;
+    reader->index_pos++;
+
+    return 0;
+}
+#endif
+
 int
 mfg_seek_next(struct mfg_reader *reader)
 {
     int rc;
 
+#if MYNEWT_VAL(MFG_INDEX_MAX_TLVS) > 0
+    if (mfg_index_valid) {
+        return mfg_index_seek_next(reader);
+    }
+#endif
+
     do {
         rc = mfg_seek_next_aux(reader);
     } while (rc == SYS_EAGAIN);
@@ -225,6 +275,20 @@ mfg_read_tlv_body(const struct mfg_reader *reader, void *dst, int max_size)
     int read_sz;
     int rc;
 
+#if MYNEWT_VAL(MFG_INDEX_MAX_TLVS) > 0
+    const struct mfg_index_entry *entry;
+
+    if (mfg_index_valid) {
+        assert(reader->index_pos > 0);
+        entry = &mfg_index[reader->index_pos - 1];
+
+        memset(dst, 0, max_size);
+        memcpy(dst, mfg_index_data + entry->data_off,
+               min(max_size, entry->tlv.size));
+        return 0;
+    }
+#endif
+
     rc = mfg_open_flash_area(reader, &fap);
     if (rc != 0) {
         return rc;
@@ -263,6 +327,42 @@ mfg_read_tlv_hash(const struct mfg_reader *reader, void *out_hash)
     return mfg_read_tlv_body(reader, out_hash, MFG_HASH_SZ);
 }
 
+#if MYNEWT_VAL(MFG_INDEX_MAX_TLVS) > 0
+/**
+ * Copies the TLV the reader points at into the index.  If it does not fit,
+ * the index is not used.
+ */
+static int
+mfg_index_add(const struct mfg_reader *reader)
+{
+    struct mfg_index_entry *entry;
+    int rc;
+
+    if (mfg_index_num >= MYNEWT_VAL(MFG_INDEX_MAX_TLVS) ||
+        mfg_index_data_len + reader->cur_tlv.size >
+        MYNEWT_VAL(MFG_INDEX_DATA_SIZE)) {
+
+        mfg_index_complete = false;
+        return 0;
+    }
+
+    entry = &mfg_index[mfg_index_num];
+    entry->tlv = reader->cur_tlv;
+    entry->data_off = mfg_index_data_len;
+
+    rc = mfg_read_tlv_body(reader, mfg_index_data + mfg_index_data_len,
+                           reader->cur_tlv.size);
+    if (rc != 0) {
+        return rc;
+    }
+
+    mfg_index_num++;
+    mfg_index_data_len += reader->cur_tlv.size;
+
+    return 0;
+}
+#endif
+
 /**
  * Reads an MMR from the end of the specified flash area.
  */
@@ -339,7 +439,8 @@ mfg_read_next_mmr(uint8_t area_id)
 
 /**
  * Reads all MMR ref TLVs in the specified MMR.  The global MMR list is
- * populated with the results for subsequent reading.
+ * populated with the results for subsequent reading.  All TLVs seen on the
+ * way are added to the index.
  */
 static int
 mfg_read_mmr_refs(void)
@@ -354,20 +455,31 @@ mfg_read_mmr_refs(void)
      * they are added to the global list and become available in this loop.
      */
     while (true) {
-        rc = mfg_seek_next_with_type(&reader, MFG_META_TLV_TYPE_MMR_REF);
+        rc = mfg_seek_next(&reader);
         switch (rc) {
         case 0:
-            /* Found an MMR ref TLV.  Read it below. */
+            /* Found a TLV.  Read it below. */
             break;
 
         case SYS_EDONE:
-            /* No more MMR ref TLVs. */
+            /* No more TLVs. */
             return 0;
 
         default:
             return rc;
         }
 
+#if MYNEWT_VAL(MFG_INDEX_MAX_TLVS) > 0
+        rc = mfg_index_add(&reader);
+        if (rc != 0) {
+            return rc;
+        }
+#endif
+
+        if (reader.cur_tlv.type != MFG_META_TLV_TYPE_MMR_REF) {
+            continue;
+        }
+
         rc = mfg_read_tlv_mmr_ref(&reader, &mmr_ref);
         if (rc != 0) {
             return rc;
@@ -406,12 +518,24 @@ mfg_init(void)
         goto err;
     }
 
+#if MYNEWT_VAL(MFG_INDEX_MAX_TLVS) > 0
+    mfg_index_complete = true;
+#endif
+
     /* Read all MMR references. */
     rc = mfg_read_mmr_refs();
     if (rc != 0) {
         goto err;
     }
 
+#if MYNEWT_VAL(MFG_INDEX_MAX_TLVS) > 0
+    if (mfg_index_complete) {
+        mfg_index_valid = true;
+    } else {
+        MFG_LOG_INFO("TLVs do not fit the index; reading from flash");
+    }
+#endif
+
     return;
 
 err:
@@ -163,6 +163,40 @@ reboot_cnt_inc(void)
     return rc;
 }
 
+#if MYNEWT_VAL(SYSINIT_PROFILE)
+/*
+ * Adds how long sysinit took this boot, and what took longest in it.
+ */
+static void
+log_reboot_write_boot_time(struct CborEncoder *map, char *buf, int buf_sz)
+{
+    const struct sysinit_prof_rec *slowest;
+    const struct sysinit_prof_rec *rec;
+    uint32_t total;
+    int i;
+
+    total = sysinit_prof_total(NULL);
+    if (total == 0) {
+        return;
+    }
+    cbor_encode_text_stringz(map, "boot");
+    cbor_encode_uint(map, os_cputime_ticks_to_usecs(total));
+
+    slowest = NULL;
+    for (i = 0; (rec = sysinit_prof_get(i)) != NULL; i++) {
+        if (slowest == NULL || rec->spr_ticks > slowest->spr_ticks) {
+            slowest = rec;
+        }
+    }
+    if (slowest != NULL && slowest->spr_name != NULL) {
+        cbor_encode_text_stringz(map, "slow");
+        snprintf(buf, buf_sz, "%s:%lu", slowest->spr_name,
+                 (unsigned long)os_cputime_ticks_to_usecs(slowest->spr_ticks));
+        cbor_encode_text_stringz(map, buf);
+    }
+}
+#endif
+
 /**
  * Logs reboot with the specified reason
  * @param reason for reboot
@@ -247,6 +281,10 @@ log_reboot_write(const struct log_reboot_info *info)
         cbor_encode_int(&map, info->pc);
     }
 
+#if MYNEWT_VAL(SYSINIT_PROFILE)
+    log_reboot_write_boot_time(&map, buf, sizeof buf);
+#endif
+
     state_flags = img_mgmt_state_flags(boot_current_slot);
     cbor_encode_text_stringz(&map, "flags");
     off = 0;
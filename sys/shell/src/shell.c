@@ -33,6 +33,23 @@
 static struct shell_module shell_modules[MYNEWT_VAL(SHELL_MAX_MODULES)];
 static size_t num_of_shell_entities;
 
+#if MYNEWT_VAL(SHELL_CMD_INDEX_SIZE) > 0
+/*
+ * Modules, and commands of all modules, sorted by name.  Commands are
+ * ordered by module first, so those of one module form a run.
+ */
+struct shell_cmd_ent {
+    uint8_t module;
+    uint16_t command;
+};
+
+static uint8_t shell_module_order[MYNEWT_VAL(SHELL_MAX_MODULES)];
+static struct shell_cmd_ent shell_cmd_index[MYNEWT_VAL(SHELL_CMD_INDEX_SIZE)];
+static int shell_cmd_index_cnt;
+/* Some command did not fit the index; commands are then scanned. */
+static bool shell_cmd_index_partial;
+#endif
+
 static const char *prompt;
 static int default_module = -1;
 
@@ -134,26 +151,180 @@ line2argv(char *str, char *argv[], size_t size, struct streamer *streamer)
     return argc;
 }
 
+#if MYNEWT_VAL(SHELL_CMD_INDEX_SIZE) > 0
+/*
+ * First position in the module order whose name is not below the first
+ * len characters of str.
+ */
 static int
-get_destination_module(const char *module_str, int len)
+shell_module_lower(const char *str, int len)
 {
-    int i;
+    int lo;
+    int hi;
+    int mid;
+
+    lo = 0;
+    hi = num_of_shell_entities;
+    while (lo < hi) {
+        mid = (lo + hi) / 2;
+        if (strncmp(str, shell_modules[shell_module_order[mid]].name,
+                    len) > 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
 
-    for (i = 0; i < num_of_shell_entities; i++) {
-        if (len < 0) {
-            if (!strcmp(module_str, shell_modules[i].name)) {
-                return i;
-            }
+/*
+ * First position in the command index, within the run of module, whose
+ * command is not below the first len characters of str.
+ */
+static int
+shell_cmd_lower(int module, const char *str, int len)
+{
+    const struct shell_cmd_ent *ent;
+    int lo;
+    int hi;
+    int mid;
+    int rc;
+
+    lo = 0;
+    hi = shell_cmd_index_cnt;
+    while (lo < hi) {
+        mid = (lo + hi) / 2;
+        ent = &shell_cmd_index[mid];
+        rc = module - ent->module;
+        if (rc == 0) {
+            rc = strncmp(str,
+                         shell_modules[module].commands[ent->command].sc_cmd,
+                         len);
+        }
+        if (rc > 0) {
+            lo = mid + 1;
         } else {
-            if (!strncmp(module_str, shell_modules[i].name, len)) {
-                return i;
-            }
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static void
+shell_module_index_add(int module)
+{
+    const char *name;
+    int pos;
+
+    name = shell_modules[module].name;
+    pos = shell_module_lower(name, strlen(name) + 1);
+    memmove(&shell_module_order[pos + 1], &shell_module_order[pos],
+            num_of_shell_entities - pos);
+    shell_module_order[pos] = module;
+}
+
+static void
+shell_cmd_index_add(int module, int command)
+{
+    const char *name;
+    int pos;
+
+    if (shell_cmd_index_cnt >= MYNEWT_VAL(SHELL_CMD_INDEX_SIZE)) {
+        shell_cmd_index_partial = true;
+        return;
+    }
+
+    name = shell_modules[module].commands[command].sc_cmd;
+    pos = shell_cmd_lower(module, name, strlen(name) + 1);
+    memmove(&shell_cmd_index[pos + 1], &shell_cmd_index[pos],
+            (shell_cmd_index_cnt - pos) * sizeof(shell_cmd_index[0]));
+    shell_cmd_index[pos].module = module;
+    shell_cmd_index[pos].command = command;
+    shell_cmd_index_cnt++;
+}
+#endif
+
+/*
+ * Iterates over modules whose name starts with the first len characters
+ * of prefix; pass len past the terminating '\0' for an exact match.  *pos
+ * is -1 on the first call.  Returns the module, or -1 after the last one.
+ * Modules come in name order when indexed, else in registration order.
+ */
+static int
+shell_module_match_next(const char *prefix, int len, int *pos)
+{
+#if MYNEWT_VAL(SHELL_CMD_INDEX_SIZE) > 0
+    int module;
+#endif
+    int i;
+
+#if MYNEWT_VAL(SHELL_CMD_INDEX_SIZE) > 0
+    i = *pos < 0 ? shell_module_lower(prefix, len) : *pos + 1;
+    *pos = i;
+    if (i < num_of_shell_entities) {
+        module = shell_module_order[i];
+        if (!strncmp(prefix, shell_modules[module].name, len)) {
+            return module;
+        }
+    }
+    return -1;
+#else
+    for (i = *pos + 1; i < num_of_shell_entities; i++) {
+        if (!strncmp(prefix, shell_modules[i].name, len)) {
+            *pos = i;
+            return i;
+        }
+    }
+    *pos = i;
+    return -1;
+#endif
+}
+
+/*
+ * As shell_module_match_next(), over the commands of a module.
+ */
+static int
+shell_cmd_match_next(int module, const char *prefix, int len, int *pos)
+{
+    const struct shell_cmd *commands;
+    int i;
+
+    commands = shell_modules[module].commands;
+
+#if MYNEWT_VAL(SHELL_CMD_INDEX_SIZE) > 0
+    if (!shell_cmd_index_partial) {
+        i = *pos < 0 ? shell_cmd_lower(module, prefix, len) : *pos + 1;
+        *pos = i;
+        if (i < shell_cmd_index_cnt && shell_cmd_index[i].module == module &&
+            !strncmp(prefix, commands[shell_cmd_index[i].command].sc_cmd,
+                     len)) {
+            return shell_cmd_index[i].command;
         }
+        return -1;
     }
+#endif
 
+    for (i = *pos + 1; commands[i].sc_cmd; i++) {
+        if (!strncmp(prefix, commands[i].sc_cmd, len)) {
+            *pos = i;
+            return i;
+        }
+    }
+    *pos = i - 1;
     return -1;
 }
 
+static int
+get_destination_module(const char *module_str, int len)
+{
+    int pos = -1;
+
+    if (len < 0) {
+        len = strlen(module_str) + 1;
+    }
+    return shell_module_match_next(module_str, len, &pos);
+}
+
 /* For a specific command: argv[0] = module name, argv[1] = command name
  * If a default module was selected: argv[0] = command name
  */
@@ -258,8 +429,9 @@ static void
 print_modules(struct streamer *streamer)
 {
     int module;
+    int pos = -1;
 
-    for (module = 0; module < num_of_shell_entities; module++) {
+    while ((module = shell_module_match_next("", 0, &pos)) >= 0) {
         streamer_printf(streamer, "%s\n", shell_modules[module].name);
     }
 }
@@ -358,8 +530,8 @@ shell_find_cmd(int argc, char *argv[], struct streamer *streamer)
 {
     const char *first_string = argv[0];
     int module = -1;
-    const struct shell_module *shell_module;
     const char *command;
+    int pos = -1;
     int i;
 
     if (!first_string || first_string[0] == '\0') {
@@ -385,14 +557,12 @@ shell_find_cmd(int argc, char *argv[], struct streamer *streamer)
         return NULL;
     }
 
-    shell_module = &shell_modules[module];
-    for (i = 0; shell_module->commands[i].sc_cmd; i++) {
-        if (!strcmp(command, shell_module->commands[i].sc_cmd)) {
-            return &shell_module->commands[i];
-        }
+    i = shell_cmd_match_next(module, command, strlen(command) + 1, &pos);
+    if (i < 0) {
+        return NULL;
     }
 
-    return NULL;
+    return &shell_modules[module].commands[i];
 }
 
 int
@@ -510,17 +680,13 @@ shell(struct os_event *ev)
 static int
 get_command_from_module(const char *command, int len, int module)
 {
+    const struct shell_cmd *commands;
+    int pos = -1;
     int i;
-    const struct shell_module *shell_module;
 
-    shell_module = &shell_modules[module];
-    for (i = 0; shell_module->commands[i].sc_cmd; i++) {
-
-        if (strlen(shell_module->commands[i].sc_cmd) != len) {
-            continue;
-        }
-
-        if (!strncmp(command, shell_module->commands[i].sc_cmd, len)) {
+    commands = shell_modules[module].commands;
+    while ((i = shell_cmd_match_next(module, command, len, &pos)) >= 0) {
+        if (strlen(commands[i].sc_cmd) == len) {
             return i;
         }
     }
@@ -639,14 +805,13 @@ complete_command(char *line, char *command_prefix,
     int first_match = -1;
     int match_count = 0;
     int i, j, common_chars = -1;
+    int pos = -1;
     const struct shell_cmd *commands;
 
     commands = shell_modules[module_idx].commands;
 
-    for (i = 0; commands[i].sc_cmd; i++) {
-        if (0 != strncmp(command_prefix, commands[i].sc_cmd, command_len)) {
-            continue;
-        }
+    while ((i = shell_cmd_match_next(module_idx, command_prefix, command_len,
+                                     &pos)) >= 0) {
         match_count++;
 
         if (match_count == 1) {
@@ -699,11 +864,10 @@ complete_command(char *line, char *command_prefix,
      * list all possible matches.
      */
     console_out('\n');
-    console_printf("%s\n", commands[first_match].sc_cmd);
-    for (i = first_match + 1; commands[i].sc_cmd; i++) {
-        if (0 == strncmp(command_prefix, commands[i].sc_cmd, command_len)) {
-            console_printf("%s\n", commands[i].sc_cmd);
-        }
+    pos = -1;
+    while ((i = shell_cmd_match_next(module_idx, command_prefix, command_len,
+                                     &pos)) >= 0) {
+        console_printf("%s\n", commands[i].sc_cmd);
     }
     /* restore prompt */
     print_prompt(line);
@@ -714,26 +878,19 @@ complete_module(char *line, char *module_prefix,
                 int module_len, console_append_char_cb append_char)
 {
     int i, j;
+    int pos = -1;
     const char *first_match = NULL;
     int common_chars = -1, space = 0;
 
     if (!module_len) {
         console_out('\n');
-        for (i = 0; i < num_of_shell_entities; i++) {
-            console_printf("%s\n", shell_modules[i].name);
-        }
+        print_modules(streamer_console_get());
         print_prompt(line);
         return;
     }
 
-    for (i = 0; i < num_of_shell_entities; i++) {
-
-        if (strncmp(module_prefix,
-                     shell_modules[i].name,
-                     module_len)) {
-            continue;
-        }
-
+    while ((i = shell_module_match_next(module_prefix, module_len,
+                                        &pos)) >= 0) {
         if (!first_match) {
             first_match = shell_modules[i].name;
             continue;
@@ -934,6 +1091,11 @@ shell_avail_queue_init(void)
 int
 shell_register(const char *module_name, const struct shell_cmd *commands)
 {
+#if MYNEWT_VAL(SHELL_CMD_INDEX_SIZE) > 0
+    int module;
+    int i;
+#endif
+
     if (num_of_shell_entities >= MYNEWT_VAL(SHELL_MAX_MODULES)) {
         DFLT_LOG_ERROR("Max number of modules reached\n");
         assert(0);
@@ -941,6 +1103,15 @@ shell_register(const char *module_name, const struct shell_cmd *commands)
 
     shell_modules[num_of_shell_entities].name = module_name;
     shell_modules[num_of_shell_entities].commands = commands;
+
+#if MYNEWT_VAL(SHELL_CMD_INDEX_SIZE) > 0
+    module = num_of_shell_entities;
+    shell_module_index_add(module);
+    for (i = 0; commands[i].sc_cmd; i++) {
+        shell_cmd_index_add(module, i);
+    }
+#endif
+
     ++num_of_shell_entities;
 
     return 0;
@@ -951,6 +1122,9 @@ shell_register(const char *module_name, const struct shell_cmd *commands)
 static struct shell_cmd compat_commands[MYNEWT_VAL(SHELL_MAX_COMPAT_COMMANDS) + 1];
 static int num_compat_commands;
 static int module_registered;
+#if MYNEWT_VAL(SHELL_CMD_INDEX_SIZE) > 0
+static int compat_module;
+#endif
 
 int
 shell_cmd_register(const struct shell_cmd *sc)
@@ -964,6 +1138,9 @@ shell_cmd_register(const struct shell_cmd *sc)
     }
 
     if (!module_registered) {
+#if MYNEWT_VAL(SHELL_CMD_INDEX_SIZE) > 0
+        compat_module = num_of_shell_entities;
+#endif
         shell_register(SHELL_COMPAT_MODULE_NAME, compat_commands);
         module_registered = 1;
 
@@ -976,6 +1153,9 @@ shell_cmd_register(const struct shell_cmd *sc)
     }
 
     compat_commands[num_compat_commands] = *sc;
+#if MYNEWT_VAL(SHELL_CMD_INDEX_SIZE) > 0
+    shell_cmd_index_add(compat_module, num_compat_commands);
+#endif
     ++num_compat_commands;
     return 0;
 }
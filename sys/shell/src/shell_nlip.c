@@ -40,6 +40,29 @@ static struct os_mqueue g_shell_nlip_mq;
 static struct os_mbuf *g_nlip_mbuf;
 static uint16_t g_nlip_expected_len;
 
+#if MYNEWT_VAL(SHELL_NLIP_BINARY)
+/*
+ * Binary frames are COBS encoded: each block is a code byte, then code - 1
+ * data bytes, then an implied 0x00 unless code is 0xff or the frame ends.
+ * That leaves 0x00 free to delimit frames, and it never shows up in
+ * console text.
+ */
+#define SHELL_NLIP_COBS_BLOCK   254
+/* Largest decoded frame: packet plus CRC */
+#define SHELL_NLIP_BIN_MAX_LEN  (MGMT_MAX_MTU + sizeof(uint16_t))
+
+static struct os_mqueue g_shell_nlip_bin_mq;
+/* Frame being received; rx state is only touched from console rx. */
+static struct os_mbuf *g_nlip_bin_mbuf;
+static bool g_nlip_bin_active;
+static bool g_nlip_bin_err;
+static bool g_nlip_bin_zero;
+static uint8_t g_nlip_bin_left;
+/* Host last sent a binary frame; answer with binary frames. */
+static bool g_nlip_bin_out;
+static uint8_t g_nlip_bin_txbuf[SHELL_NLIP_COBS_BLOCK + 1];
+#endif
+
 void
 shell_nlip_clear_pkt(void)
 {
@@ -91,6 +114,9 @@ shell_nlip_process(char *data, int len)
     }
 
     if (OS_MBUF_PKTHDR(g_nlip_mbuf)->omp_len == g_nlip_expected_len) {
+#if MYNEWT_VAL(SHELL_NLIP_BINARY)
+        g_nlip_bin_out = false;
+#endif
         if (g_shell_nlip_in_func) {
             crc = CRC16_INITIAL_CRC;
             for (m = g_nlip_mbuf; m; m = SLIST_NEXT(m, om_next)) {
@@ -114,6 +140,155 @@ err:
     return (rc);
 }
 
+#if MYNEWT_VAL(SHELL_NLIP_BINARY)
+static void
+shell_nlip_bin_append(uint8_t byte)
+{
+    if (g_nlip_bin_err) {
+        return;
+    }
+    if (OS_MBUF_PKTLEN(g_nlip_bin_mbuf) >= SHELL_NLIP_BIN_MAX_LEN ||
+        os_mbuf_append(g_nlip_bin_mbuf, &byte, 1) != 0) {
+        g_nlip_bin_err = true;
+    }
+}
+
+/*
+ * Console raw input callback; may run in interrupt context.  Decodes
+ * frames straight into an mbuf and hands complete ones to the event
+ * queue.
+ */
+static int
+shell_nlip_bin_rx(uint8_t byte)
+{
+    struct os_mbuf *m;
+
+    if (!g_nlip_bin_active) {
+        if (byte != 0) {
+            return 0;
+        }
+        g_nlip_bin_active = true;
+        g_nlip_bin_err = false;
+        g_nlip_bin_zero = false;
+        g_nlip_bin_left = 0;
+        g_nlip_bin_mbuf = os_msys_get_pkthdr(0, 0);
+        if (!g_nlip_bin_mbuf) {
+            g_nlip_bin_err = true;
+        }
+        return 1;
+    }
+
+    if (byte == 0) {
+        m = g_nlip_bin_mbuf;
+        if (m && OS_MBUF_PKTLEN(m) == 0 && !g_nlip_bin_left &&
+            !g_nlip_bin_zero) {
+            /* Back to back delimiters; the next frame starts here. */
+            return 1;
+        }
+        g_nlip_bin_mbuf = NULL;
+        g_nlip_bin_active = false;
+        if (!m) {
+            return 1;
+        }
+        if (g_nlip_bin_err || g_nlip_bin_left ||
+            os_mqueue_put(&g_shell_nlip_bin_mq, os_eventq_dflt_get(), m)) {
+            os_mbuf_free_chain(m);
+        }
+        return 1;
+    }
+
+    if (g_nlip_bin_left) {
+        shell_nlip_bin_append(byte);
+        g_nlip_bin_left--;
+        return 1;
+    }
+
+    /* Code byte; the previous block ended in a zero unless it was full. */
+    if (g_nlip_bin_zero) {
+        shell_nlip_bin_append(0);
+    }
+    g_nlip_bin_left = byte - 1;
+    g_nlip_bin_zero = byte != 0xff;
+
+    return 1;
+}
+
+static void
+shell_nlip_bin_event(struct os_event *ev)
+{
+    struct os_mbuf *m;
+    struct os_mbuf *tmp;
+    uint16_t crc;
+
+    while ((m = os_mqueue_get(&g_shell_nlip_bin_mq)) != NULL) {
+        crc = CRC16_INITIAL_CRC;
+        for (tmp = m; tmp; tmp = SLIST_NEXT(tmp, om_next)) {
+            crc = crc16_ccitt(crc, tmp->om_data, tmp->om_len);
+        }
+        if (crc != 0 || OS_MBUF_PKTLEN(m) < sizeof(crc) ||
+            !g_shell_nlip_in_func) {
+            os_mbuf_free_chain(m);
+            continue;
+        }
+
+        g_nlip_bin_out = true;
+        os_mbuf_adj(m, -sizeof(crc));
+        g_shell_nlip_in_func(m, g_shell_nlip_in_arg);
+    }
+}
+
+/*
+ * Sends a packet, with the CRC already appended, as one binary frame.
+ */
+static int
+shell_nlip_bin_mtx(struct os_mbuf *m)
+{
+    uint16_t totlen;
+    uint16_t off;
+    uint16_t n;
+    uint16_t z;
+    bool more;
+    int rc;
+
+    rc = console_lock(OS_TICKS_PER_SEC);
+    if (rc != OS_OK) {
+        return rc;
+    }
+
+    totlen = OS_MBUF_PKTLEN(m);
+    off = 0;
+    console_write_raw("", 1);
+    do {
+        n = min(SHELL_NLIP_COBS_BLOCK, totlen - off);
+        rc = os_mbuf_copydata(m, off, n, g_nlip_bin_txbuf + 1);
+        if (rc != 0) {
+            goto end;
+        }
+        for (z = 0; z < n && g_nlip_bin_txbuf[z + 1]; z++) {
+        }
+
+        g_nlip_bin_txbuf[0] = z + 1;
+        console_write_raw((char *)g_nlip_bin_txbuf, z + 1);
+        off += z;
+
+        if (z == SHELL_NLIP_COBS_BLOCK) {
+            more = off < totlen;
+        } else if (off < totlen) {
+            /* Skip the zero the block ended with. */
+            off++;
+            more = true;
+        } else {
+            more = false;
+        }
+    } while (more);
+    console_write_raw("", 1);
+
+end:
+    (void)console_unlock();
+    return rc;
+}
+#endif
+
 static int
 shell_nlip_mtx(struct os_mbuf *m)
 {
@@ -159,6 +334,12 @@ shell_nlip_mtx(struct os_mbuf *m)
     }
     memcpy(ptr, &crc, sizeof(crc));
 
+#if MYNEWT_VAL(SHELL_NLIP_BINARY)
+    if (g_nlip_bin_out) {
+        return shell_nlip_bin_mtx(m);
+    }
+#endif
+
     totlen = OS_MBUF_PKTHDR(m)->omp_len;
     off = 0;
     bodylen = 0;
@@ -268,5 +449,10 @@ void
 shell_nlip_init(void)
 {
     os_mqueue_init(&g_shell_nlip_mq, shell_event_data_in, NULL);
+
+#if MYNEWT_VAL(SHELL_NLIP_BINARY)
+    os_mqueue_init(&g_shell_nlip_bin_mq, shell_nlip_bin_event, NULL);
+    console_set_raw_rx_cb(shell_nlip_bin_rx);
+#endif
 }
 #endif
@@ -38,6 +38,9 @@ shell_os_tasks_display_cmd(const struct shell_cmd *cmd, int argc, char **argv,
 {
     struct os_task *prev_task;
     struct os_task_info oti;
+#if MYNEWT_VAL(OS_TASK_CPU_STATS)
+    struct os_cpu_stats ocs;
+#endif
     char *name;
     int found;
 
@@ -73,6 +76,10 @@ shell_os_tasks_display_cmd(const struct shell_cmd *cmd, int argc, char **argv,
                 oti.oti_stksize, oti.oti_stkusage,
                 (unsigned long)oti.oti_last_checkin,
                 (unsigned long)oti.oti_next_checkin);
+#if MYNEWT_VAL(OS_TASK_CPU_STATS)
+        streamer_printf(streamer, "%8s cputime %llu\n", "",
+                        (unsigned long long)oti.oti_cputime);
+#endif
 
     }
 
@@ -80,6 +87,16 @@ shell_os_tasks_display_cmd(const struct shell_cmd *cmd, int argc, char **argv,
         streamer_printf(streamer, "Couldn't find task with name %s\n", name);
     }
 
+#if MYNEWT_VAL(OS_TASK_CPU_STATS)
+    if (!name) {
+        os_cpu_stats_get(&ocs);
+        streamer_printf(streamer, "idle %llu isr %llu (%lu irqs)\n",
+                        (unsigned long long)ocs.ocs_idle_time,
+                        (unsigned long long)ocs.ocs_isr_time,
+                        (unsigned long)ocs.ocs_isr_cnt);
+    }
+#endif
+
     return 0;
 }
 
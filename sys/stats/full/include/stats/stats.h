@@ -22,6 +22,7 @@
 #include <stddef.h>
 #include <stdint.h>
 #include "os/os.h"
+#include "os/os_cputime.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -32,6 +33,8 @@ extern struct stats_registry_list g_stats_registry;
 
 /** The stat group is periodically written to sys/config. */
 #define STATS_HDR_F_PERSIST             0x01
+/** (private) The persisted stat group has changes not yet written. */
+#define STATS_HDR_F_DIRTY               0x02
 
 struct stats_name_map {
     uint16_t snm_off;
@@ -57,7 +60,9 @@ struct stats_hdr {
  */
 struct stats_persisted_hdr {
     struct stats_hdr sp_hdr;
+#if !MYNEWT_VAL(STATS_PERSIST_COALESCE)
     struct os_callout sp_persist_timer;
+#endif
     os_time_t sp_persist_delay;
 };
 
@@ -84,6 +89,17 @@ STATS_SECT_DECL(__name) {                   \
 #define STATS_SECT_ENTRY32(__var) uint32_t STATS_SECT_VAR(__var);
 #define STATS_SECT_ENTRY64(__var) uint64_t STATS_SECT_VAR(__var);
 
+/** Number of buckets in a histogram stat. */
+#define STATS_HIST_BUCKETS 16
+
+/**
+ * Histogram stat: an array of STATS_HIST_BUCKETS 32-bit counters.  Bucket 0
+ * counts samples of 0; bucket i counts samples in [2^(i-1), 2^i); the last
+ * bucket also counts anything larger.  Use in groups of 32-bit stats only.
+ */
+#define STATS_SECT_HIST(__var) \
+    uint32_t STATS_SECT_VAR(__var)[STATS_HIST_BUCKETS];
+
 /**
  * @brief Resets all stats in the provided group to 0.
  *
@@ -109,6 +125,23 @@ STATS_SECT_DECL(__name) {                   \
     STATS_PERSIST_SCHED((struct stats_hdr *)&__sectvarname);    \
 } while (0)
 
+#if MYNEWT_VAL(STATS_INC_ATOMIC)
+/* Whether a stat of the given size can be updated by a lock-free atomic. */
+#define STATS_SIZE_LOCK_FREE(__size)                                        \
+    ((__size) == STATS_SIZE_16 ? __GCC_ATOMIC_SHORT_LOCK_FREE == 2 :        \
+     (__size) == STATS_SIZE_32 ? __GCC_ATOMIC_INT_LOCK_FREE == 2 :          \
+     __GCC_ATOMIC_LLONG_LOCK_FREE == 2)
+
+/* (private) Adds __n to the stat lvalue __stat. */
+#define STATS_ADD_RAW(__stat, __n)                                          \
+    __builtin_choose_expr(                                                  \
+        STATS_SIZE_LOCK_FREE(sizeof (__stat)),                              \
+        (void)__atomic_fetch_add(&(__stat), (__n), __ATOMIC_RELAXED),       \
+        stats_incn_locked(&(__stat), sizeof (__stat), (__n)))
+#else
+#define STATS_ADD_RAW(__stat, __n) ((__stat) += (__n))
+#endif
+
 /**
  * @brief Adjusts a stat's in-RAM value by the specified delta.
  *
@@ -122,8 +155,7 @@ STATS_SECT_DECL(__name) {                   \
  * @param __n                   The amount to add to the specified stat.
  */
 #define STATS_INCN_RAW(__sectvarname, __var, __n)   \
-    (STATS_SET_RAW(__sectvarname, __var,            \
-                   STATS_GET(__sectvarname, __var) + (__n))
+    STATS_ADD_RAW(STATS_GET(__sectvarname, __var), __n)
 
 /**
  * @brief Increments a stat's in-RAM value.
@@ -150,8 +182,16 @@ STATS_SECT_DECL(__name) {                   \
  * @param __var                 The name of the individual stat to modify.
  * @param __n                   The amount to add to the specified stat.
  */
+#if MYNEWT_VAL(STATS_INC_ATOMIC)
+#define STATS_INCN(__sectvarname, __var, __n) do                \
+{                                                               \
+    STATS_INCN_RAW(__sectvarname, __var, __n);                  \
+    STATS_PERSIST_SCHED((struct stats_hdr *)&__sectvarname);    \
+} while (0)
+#else
 #define STATS_INCN(__sectvarname, __var, __n)       \
     STATS_SET(__sectvarname, __var, STATS_GET(__sectvarname, __var) + (__n))
+#endif
 
 /**
  * @brief Increments a stat's value.
@@ -169,6 +209,54 @@ STATS_SECT_DECL(__name) {                   \
 #define STATS_CLEAR(__sectvarname, __var)           \
     STATS_SET(__sectvarname, __var, 0)
 
+static inline int
+stats_hist_bucket(uint32_t val)
+{
+    int bucket;
+
+    if (val == 0) {
+        return 0;
+    }
+    bucket = 32 - __builtin_clz(val);
+    if (bucket >= STATS_HIST_BUCKETS) {
+        bucket = STATS_HIST_BUCKETS - 1;
+    }
+    return bucket;
+}
+
+/**
+ * @brief Records a sample in a histogram stat.
+ *
+ * Histograms are not persisted; this only updates the in-RAM value.
+ *
+ * @param __sectvarname         The name of the stat group containing the
+ *                                  histogram.
+ * @param __var                 The name of the histogram stat.
+ * @param __val                 The sample to record.
+ */
+#define STATS_HIST_RECORD(__sectvarname, __var, __val)                      \
+    STATS_ADD_RAW(                                                          \
+        STATS_GET(__sectvarname, __var)[stats_hist_bucket(__val)], 1)
+
+/**
+ * @brief Starts timing an operation for a histogram stat.
+ *
+ * @param __start               A uint32_t variable to hold the start time.
+ */
+#define STATS_TIME_BEGIN(__start) ((__start) = os_cputime_get32())
+
+/**
+ * @brief Records the os_cputime ticks elapsed since STATS_TIME_BEGIN() in a
+ * histogram stat.
+ *
+ * @param __sectvarname         The name of the stat group containing the
+ *                                  histogram.
+ * @param __var                 The name of the histogram stat.
+ * @param __start               The variable passed to STATS_TIME_BEGIN().
+ */
+#define STATS_TIME_END(__sectvarname, __var, __start)                       \
+    STATS_HIST_RECORD(__sectvarname, __var, os_cputime_get32() - (__start))
+
 #if MYNEWT_VAL(STATS_NAMES)
 
 #define STATS_NAME_MAP_NAME(__sectname) g_stats_map_ ## __sectname
@@ -180,6 +268,30 @@ const struct stats_name_map STATS_NAME_MAP_NAME(__sectname)[] = {
     { offsetof(STATS_SECT_DECL(__sectname), STATS_SECT_VAR(__entry)),       \
       #__entry },
 
+#define STATS_NAME_HIST_BUCKET(__sectname, __entry, __i)                    \
+    { offsetof(STATS_SECT_DECL(__sectname), STATS_SECT_VAR(__entry)) +      \
+          (__i) * sizeof(uint32_t),                                         \
+      #__entry "_" #__i },
+
+/* Names each bucket of a histogram stat <entry>_<bucket>. */
+#define STATS_NAME_HIST(__sectname, __entry)                                \
+    STATS_NAME_HIST_BUCKET(__sectname, __entry, 0)                          \
+    STATS_NAME_HIST_BUCKET(__sectname, __entry, 1)                          \
+    STATS_NAME_HIST_BUCKET(__sectname, __entry, 2)                          \
+    STATS_NAME_HIST_BUCKET(__sectname, __entry, 3)                          \
+    STATS_NAME_HIST_BUCKET(__sectname, __entry, 4)                          \
+    STATS_NAME_HIST_BUCKET(__sectname, __entry, 5)                          \
+    STATS_NAME_HIST_BUCKET(__sectname, __entry, 6)                          \
+    STATS_NAME_HIST_BUCKET(__sectname, __entry, 7)                          \
+    STATS_NAME_HIST_BUCKET(__sectname, __entry, 8)                          \
+    STATS_NAME_HIST_BUCKET(__sectname, __entry, 9)                          \
+    STATS_NAME_HIST_BUCKET(__sectname, __entry, 10)                         \
+    STATS_NAME_HIST_BUCKET(__sectname, __entry, 11)                         \
+    STATS_NAME_HIST_BUCKET(__sectname, __entry, 12)                         \
+    STATS_NAME_HIST_BUCKET(__sectname, __entry, 13)                         \
+    STATS_NAME_HIST_BUCKET(__sectname, __entry, 14)                         \
+    STATS_NAME_HIST_BUCKET(__sectname, __entry, 15)
+
 #define STATS_NAME_END(__sectname)                                          \
 };
 
@@ -191,6 +303,7 @@ const struct stats_name_map STATS_NAME_MAP_NAME(__sectname)[] = {
 
 #define STATS_NAME_START(__name)
 #define STATS_NAME(__name, __entry)
+#define STATS_NAME_HIST(__name, __entry)
 #define STATS_NAME_END(__name)
 #define STATS_NAME_INIT_PARMS(__name) NULL, 0
 
@@ -204,6 +317,20 @@ int stats_init_and_reg(struct stats_hdr *shdr, uint8_t size, uint8_t cnt,
                        const char *name);
 void stats_reset(struct stats_hdr *shdr);
 
+#if MYNEWT_VAL(STATS_INC_ATOMIC)
+/**
+ * @brief (private) Adds n to a stat inside a critical section.
+ *
+ * Used by `STATS_INCN_RAW()` for stat sizes the target cannot increment
+ * atomically without locking (e.g., 64-bit stats on 32-bit MCUs).
+ *
+ * @param stat                  The stat to modify.
+ * @param size                  The size of the stat, in bytes.
+ * @param n                     The amount to add to the stat.
+ */
+void stats_incn_locked(void *stat, uint8_t size, uint64_t n);
+#endif
+
 typedef int (*stats_walk_func_t)(struct stats_hdr *, void *, char *,
         uint16_t);
 int stats_walk(struct stats_hdr *, stats_walk_func_t, void *);
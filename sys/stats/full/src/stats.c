@@ -167,6 +167,31 @@ stats_module_init_internal(void)
     return rc;
 }
 
+#if MYNEWT_VAL(STATS_INC_ATOMIC)
+void
+stats_incn_locked(void *stat, uint8_t size, uint64_t n)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    switch (size) {
+    case STATS_SIZE_16:
+        *(uint16_t *)stat += n;
+        break;
+    case STATS_SIZE_32:
+        *(uint32_t *)stat += n;
+        break;
+    case STATS_SIZE_64:
+        *(uint64_t *)stat += n;
+        break;
+    default:
+        assert(0);
+        break;
+    }
+    OS_EXIT_CRITICAL(sr);
+}
+#endif
+
 /**
  * Walk a specific statistic entry, and call walk_func with arg for
  * each field within that entry.
@@ -154,14 +154,21 @@ stats_conf_export(void (*func)(char *name, char *val),
     return rc;
 }
 
+void
+stats_conf_serialize_group(const struct stats_hdr *hdr, char *name,
+                           char *data)
+{
+    stats_conf_name(hdr, name);
+    stats_conf_serialize(hdr, data);
+}
+
 int
 stats_conf_save_group(const struct stats_hdr *hdr)
 {
     char name[MYNEWT_VAL(STATS_PERSIST_MAX_NAME_SIZE)];
     char data[MYNEWT_VAL(STATS_PERSIST_BUF_SIZE)];
 
-    stats_conf_name(hdr, name);
-    stats_conf_serialize(hdr, data);
+    stats_conf_serialize_group(hdr, name, data);
 
     return conf_save_one(name, data);
 }
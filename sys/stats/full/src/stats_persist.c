@@ -22,9 +22,157 @@
 #if MYNEWT_VAL(STATS_PERSIST)
 
 #include <assert.h>
+#include "config/config.h"
 #include "stats/stats.h"
 #include "stats_priv.h"
 
+#if MYNEWT_VAL(STATS_PERSIST_COALESCE)
+
+/** Stat groups saved by one conf_save_batch() call. */
+static struct conf_batch_ent
+    stats_persist_ents[MYNEWT_VAL(STATS_PERSIST_BATCH_CNT)];
+static char stats_persist_names[MYNEWT_VAL(STATS_PERSIST_BATCH_CNT)]
+    [MYNEWT_VAL(STATS_PERSIST_MAX_NAME_SIZE)];
+static char stats_persist_data[MYNEWT_VAL(STATS_PERSIST_BATCH_CNT)]
+    [MYNEWT_VAL(STATS_PERSIST_BUF_SIZE)];
+static int stats_persist_ent_cnt;
+
+static struct os_callout stats_persist_timer;
+static os_time_t stats_persist_last;
+static bool stats_persist_flushed;
+
+static int
+stats_persist_save_batch(void)
+{
+    int rc;
+
+    if (stats_persist_ent_cnt == 0) {
+        return 0;
+    }
+    rc = conf_save_batch(stats_persist_ents, stats_persist_ent_cnt);
+    stats_persist_ent_cnt = 0;
+    return rc;
+}
+
+/**
+ * Passed to `stats_group_walk`; adds the specified stat group to the batch
+ * being saved if it has changed.
+ */
+static int
+stats_persist_flush_walk(struct stats_hdr *hdr, void *arg)
+{
+    struct conf_batch_ent *ent;
+    os_sr_t sr;
+    int *rcp;
+    int idx;
+    int rc;
+
+    rcp = arg;
+
+    OS_ENTER_CRITICAL(sr);
+    if (!(hdr->s_flags & STATS_HDR_F_DIRTY)) {
+        OS_EXIT_CRITICAL(sr);
+        return 0;
+    }
+    hdr->s_flags &= ~STATS_HDR_F_DIRTY;
+    OS_EXIT_CRITICAL(sr);
+
+    idx = stats_persist_ent_cnt++;
+    ent = &stats_persist_ents[idx];
+    stats_conf_serialize_group(hdr, stats_persist_names[idx],
+                               stats_persist_data[idx]);
+    ent->cbe_name = stats_persist_names[idx];
+    ent->cbe_value = stats_persist_data[idx];
+
+    if (stats_persist_ent_cnt == MYNEWT_VAL(STATS_PERSIST_BATCH_CNT)) {
+        rc = stats_persist_save_batch();
+        if (rc != 0 && *rcp == 0) {
+            *rcp = rc;
+        }
+    }
+    return 0;
+}
+
+static int
+stats_persist_flush_all(void)
+{
+    int rc;
+    int rc2;
+
+    os_callout_stop(&stats_persist_timer);
+
+    rc = 0;
+    stats_persist_ent_cnt = 0;
+    stats_group_walk(stats_persist_flush_walk, &rc);
+    rc2 = stats_persist_save_batch();
+    if (rc == 0) {
+        rc = rc2;
+    }
+
+    stats_persist_last = os_time_get();
+    stats_persist_flushed = true;
+    return rc;
+}
+
+static void
+stats_persist_timer_exp(struct os_event *ev)
+{
+    int rc;
+
+    rc = stats_persist_flush_all();
+    if (rc != 0) {
+        /* XXX: Trigger a system fault if configured to (requres fault feature
+         * to be merged).
+         */
+    }
+}
+
+void
+stats_persist_sched(struct stats_hdr *hdr)
+{
+    struct stats_persisted_hdr *sphdr;
+    os_time_t delay;
+    os_time_t since;
+    os_time_t min;
+    os_sr_t sr;
+    int rc;
+
+    if (!(hdr->s_flags & STATS_HDR_F_PERSIST)) {
+        return;
+    }
+
+    sphdr = (void *)hdr;
+
+    OS_ENTER_CRITICAL(sr);
+    hdr->s_flags |= STATS_HDR_F_DIRTY;
+    OS_EXIT_CRITICAL(sr);
+
+    if (os_callout_queued(&stats_persist_timer)) {
+        return;
+    }
+
+    delay = sphdr->sp_persist_delay;
+    if (stats_persist_flushed) {
+        /* Rate-limit flushes to spare the flash. */
+        min = os_time_ms_to_ticks32(
+            MYNEWT_VAL(STATS_PERSIST_MIN_INTERVAL_MS));
+        since = os_time_get() - stats_persist_last;
+        if (since < min && min - since > delay) {
+            delay = min - since;
+        }
+    }
+    rc = os_callout_reset(&stats_persist_timer, delay);
+    assert(rc == 0);
+}
+
+int
+stats_persist_flush(void)
+{
+    return stats_persist_flush_all();
+}
+
+#else /* MYNEWT_VAL(STATS_PERSIST_COALESCE) */
+
 static void
 stats_persist_timer_exp(struct os_event *ev)
 {
@@ -88,15 +236,26 @@ stats_persist_flush(void)
     return stats_group_walk(stats_persist_flush_walk, NULL);
 }
 
+#endif /* MYNEWT_VAL(STATS_PERSIST_COALESCE) */
+
+static struct sysdown_work stats_persist_sysdown_work;
+
+static void
+stats_persist_sysdown_flush(void *arg)
+{
+    stats_persist_flush();
+}
+
 /**
  * Called on system shutdown.  Flushes to disk all persisted stat groups with
- * pending writes.
+ * pending writes, concurrently with the rest of the shutdown when sysdown
+ * workers are configured.
  */
 int
 stats_persist_sysdown(int reason)
 {
-    stats_persist_flush();
-    return 0;
+    return sysdown_work_start(&stats_persist_sysdown_work,
+                              stats_persist_sysdown_flush, NULL, 0);
 }
 
 int
@@ -116,8 +275,15 @@ stats_persist_init(struct stats_hdr *hdr, uint8_t size,
     sphdr = (void *)hdr;
 
     sphdr->sp_persist_delay = persist_delay;
+#if MYNEWT_VAL(STATS_PERSIST_COALESCE)
+    if (stats_persist_timer.c_ev.ev_cb == NULL) {
+        os_callout_init(&stats_persist_timer, os_eventq_dflt_get(),
+                        stats_persist_timer_exp, NULL);
+    }
+#else
     os_callout_init(&sphdr->sp_persist_timer, os_eventq_dflt_get(),
             stats_persist_timer_exp, hdr);
+#endif
 
     return 0;
 }
@@ -58,6 +58,18 @@ void *stats_data(const struct stats_hdr *hdr);
  */
 int stats_conf_save_group(const struct stats_hdr *hdr);
 
+/**
+ * @brief Produces the config name and value a stat group is persisted as.
+ *
+ * @param hdr                   The stat group to serialize.
+ * @param name                  Filled with the config name; must hold
+ *                                  STATS_PERSIST_MAX_NAME_SIZE bytes.
+ * @param data                  Filled with the config value; must hold
+ *                                  STATS_PERSIST_BUF_SIZE bytes.
+ */
+void stats_conf_serialize_group(const struct stats_hdr *hdr, char *name,
+                                char *data);
+
 /**
  * @brief Performs a sanity check on the provided persistent stat group.
  *
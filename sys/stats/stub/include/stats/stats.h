@@ -57,6 +57,7 @@ struct stats_hdr {
 #define STATS_SECT_ENTRY16(__var)
 #define STATS_SECT_ENTRY32(__var)
 #define STATS_SECT_ENTRY64(__var)
+#define STATS_SECT_HIST(__var)
 #define STATS_RESET(__var)
 
 #define STATS_SIZE_INIT_PARMS(__sectvarname, __size) 0, 0
@@ -65,9 +66,13 @@ struct stats_hdr {
 #define STATS_INC(__sectvarname, __var)
 #define STATS_INCN(__sectvarname, __var, __n)
 #define STATS_CLEAR(__sectvarname, __var)
+#define STATS_HIST_RECORD(__sectvarname, __var, __val)
+#define STATS_TIME_BEGIN(__start) ((__start) = 0)
+#define STATS_TIME_END(__sectvarname, __var, __start) ((void)(__start))
 
 #define STATS_NAME_START(__name)
 #define STATS_NAME(__name, __entry)
+#define STATS_NAME_HIST(__name, __entry)
 #define STATS_NAME_END(__name)
 #define STATS_NAME_INIT_PARMS(__name) NULL, 0
 
@@ -24,6 +24,7 @@
 #include <assert.h>
 #include <stdbool.h>
 #include "syscfg/syscfg.h"
+#include "os/os.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -41,6 +42,34 @@ typedef int sysdown_fn(int reason);
 typedef void sysdown_panic_fn(const char *file, int line, const char *func,
                               const char *expr, const char *msg);
 typedef void sysdown_complete_fn(int status, void *arg);
+typedef void sysdown_work_fn(void *arg);
+
+/**
+ * Shutdown work that runs on a sysdown worker task, concurrently with the
+ * rest of the shutdown sequence.  See sysdown_work_start().
+ */
+struct sysdown_work {
+    struct os_event sw_ev;
+    sysdown_work_fn *sw_fn;
+    void *sw_arg;
+    os_time_t sw_deadline;
+    int sw_idx;
+    SLIST_ENTRY(sysdown_work) sw_next;
+};
+
+/**
+ * Time taken by one sysdown callback, see sysdown_timing_get().
+ */
+struct sysdown_timing {
+    /** Ticks spent in the callback. */
+    os_time_t st_cb_ticks;
+
+    /**
+     * Ticks from the start of sysdown until the work the callback started
+     * with sysdown_work_start() completed; 0 if it started none.
+     */
+    os_time_t st_done_ticks;
+};
 
 extern sysdown_fn * const sysdown_cbs[];
 extern sysdown_panic_fn *sysdown_panic_cb;
@@ -111,6 +140,45 @@ int sysdown(int reason);
  */
 void sysdown_release(void);
 
+/**
+ * @brief Runs slow shutdown work concurrently with other subprocedures.
+ *
+ * Meant for sysdown callbacks whose work, such as flushing data to flash,
+ * does not need to finish before later stages run.  The work is queued to
+ * one of SYSDOWN_WORKERS tasks and sysdown waits for it to finish before
+ * resetting the system, as it does for SYSDOWN_IN_PROGRESS.  With no
+ * workers configured the work runs before this function returns.
+ *
+ * @param work                  Work to run; must stay valid until fn
+ *                                  returns.
+ * @param fn                    Function doing the work.
+ * @param arg                   Argument passed to fn.
+ * @param timeout_ms            Time the work may take before sysdown
+ *                                  panics; 0 for only the overall
+ *                                  SYSDOWN_TIMEOUT_MS.
+ *
+ * @return                      SYSDOWN_COMPLETE, for the callback to return;
+ *                                  the work is accounted for separately.
+ */
+int sysdown_work_start(struct sysdown_work *work, sysdown_work_fn *fn,
+                       void *arg, uint32_t timeout_ms);
+
+#if MYNEWT_VAL(SYSDOWN_TIMING)
+/**
+ * @brief Returns the time taken by a sysdown callback.
+ *
+ * Can be used from a late sysdown callback, or the sysdown panic function,
+ * to record where shutdown time went.
+ *
+ * @param idx                   Index of the callback in sysdown order.
+ *
+ * @return                      The callback's timing record; NULL if idx
+ *                                  is not below SYSDOWN_TIMING_MAX or the
+ *                                  number of callbacks.
+ */
+const struct sysdown_timing *sysdown_timing_get(int idx);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
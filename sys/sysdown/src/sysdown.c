@@ -33,6 +33,22 @@ sysdown(int reason)
     return 0;
 }
 
+int
+sysdown_work_start(struct sysdown_work *work, sysdown_work_fn *fn,
+                   void *arg, uint32_t timeout_ms)
+{
+    fn(arg);
+    return SYSDOWN_COMPLETE;
+}
+
+#if MYNEWT_VAL(SYSDOWN_TIMING)
+const struct sysdown_timing *
+sysdown_timing_get(int idx)
+{
+    return NULL;
+}
+#endif
+
 #else
 
 #include <assert.h>
@@ -51,6 +67,28 @@ static_assert(SYSDOWN_TIMEOUT_TICKS >= 0 && SYSDOWN_TIMEOUT_TICKS < INT32_MAX,
 static volatile int sysdown_num_in_progress;
 bool sysdown_active;
 static struct os_callout sysdown_timer;
+static os_time_t sysdown_deadline;
+
+/* Started work that has not completed yet. */
+static SLIST_HEAD(, sysdown_work) sysdown_works =
+    SLIST_HEAD_INITIALIZER(sysdown_works);
+
+/* Index of the callback being called; -1 outside of the callback loop. */
+static int sysdown_cur_idx = -1;
+
+#if MYNEWT_VAL(SYSDOWN_WORKERS) > 0
+static struct os_eventq sysdown_work_evq;
+static struct os_task sysdown_work_tasks[MYNEWT_VAL(SYSDOWN_WORKERS)];
+static os_stack_t sysdown_work_stacks[MYNEWT_VAL(SYSDOWN_WORKERS)]
+    [OS_STACK_ALIGN(MYNEWT_VAL(SYSDOWN_WORKER_STACK_SIZE))]
+    __attribute__((aligned(OS_STACK_ALIGNMENT)));
+#endif
+
+#if MYNEWT_VAL(SYSDOWN_TIMING)
+static os_time_t sysdown_start_time;
+static int sysdown_num_timings;
+static struct sysdown_timing sysdown_timings[MYNEWT_VAL(SYSDOWN_TIMING_MAX)];
+#endif
 
 static void
 sysdown_dflt_panic_cb(const char *file, int line, const char *func,
@@ -99,15 +137,176 @@ sysdown_release(void)
     }
 }
 
+/**
+ * Arms the timeout timer for the earliest of the overall deadline and the
+ * deadlines of started work.
+ */
+static void
+sysdown_timer_arm(void)
+{
+    struct sysdown_work *work;
+    os_time_t deadline;
+    os_stime_t ticks;
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    deadline = sysdown_deadline;
+    SLIST_FOREACH(work, &sysdown_works, sw_next) {
+        if (OS_TIME_TICK_LT(work->sw_deadline, deadline)) {
+            deadline = work->sw_deadline;
+        }
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    ticks = deadline - os_time_get();
+    os_callout_reset(&sysdown_timer, ticks > 0 ? ticks : 0);
+}
+
 static void
 sysdown_timer_exp(struct os_event *unused)
 {
-    assert(0);
+    struct sysdown_work *work;
+    os_time_t now;
+    os_sr_t sr;
+
+    now = os_time_get();
+    if (OS_TIME_TICK_GEQ(now, sysdown_deadline)) {
+        SYSDOWN_PANIC_MSG("sysdown timed out");
+    }
+
+    OS_ENTER_CRITICAL(sr);
+    SLIST_FOREACH(work, &sysdown_works, sw_next) {
+        if (OS_TIME_TICK_GEQ(now, work->sw_deadline)) {
+            break;
+        }
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    if (work != NULL) {
+        SYSDOWN_PANIC_MSG("sysdown work timed out");
+    }
+
+    sysdown_timer_arm();
 }
 
+static void
+sysdown_work_done(struct sysdown_work *work)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    SLIST_REMOVE(&sysdown_works, work, sysdown_work, sw_next);
+    OS_EXIT_CRITICAL(sr);
+
+#if MYNEWT_VAL(SYSDOWN_TIMING)
+    if (work->sw_idx >= 0 && work->sw_idx < MYNEWT_VAL(SYSDOWN_TIMING_MAX)) {
+        sysdown_timings[work->sw_idx].st_done_ticks =
+            os_time_get() - sysdown_start_time;
+    }
+#endif
+
+    sysdown_release();
+}
+
+#if MYNEWT_VAL(SYSDOWN_WORKERS) > 0
+static void
+sysdown_work_ev_cb(struct os_event *ev)
+{
+    struct sysdown_work *work;
+
+    work = ev->ev_arg;
+    work->sw_fn(work->sw_arg);
+    sysdown_work_done(work);
+}
+
+static void
+sysdown_work_task(void *arg)
+{
+    while (1) {
+        os_eventq_run(&sysdown_work_evq);
+    }
+}
+
+static void
+sysdown_workers_start(void)
+{
+    int rc;
+    int i;
+
+    os_eventq_init(&sysdown_work_evq);
+    for (i = 0; i < MYNEWT_VAL(SYSDOWN_WORKERS); i++) {
+        rc = os_task_init(&sysdown_work_tasks[i], "sysdown",
+                          sysdown_work_task, NULL,
+                          MYNEWT_VAL(SYSDOWN_WORKER_PRIO) + i, OS_WAIT_FOREVER,
+                          sysdown_work_stacks[i],
+                          MYNEWT_VAL(SYSDOWN_WORKER_STACK_SIZE));
+        SYSDOWN_ASSERT_MSG(rc == 0, "sysdown worker start failed");
+    }
+}
+#endif
+
+int
+sysdown_work_start(struct sysdown_work *work, sysdown_work_fn *fn,
+                   void *arg, uint32_t timeout_ms)
+{
+    os_time_t ticks;
+    os_time_t now;
+    os_sr_t sr;
+    int rc;
+
+    SYSDOWN_ASSERT_ACTIVE();
+
+    work->sw_fn = fn;
+    work->sw_arg = arg;
+    work->sw_idx = sysdown_cur_idx;
+    work->sw_deadline = sysdown_deadline;
+    if (timeout_ms != 0) {
+        now = os_time_get();
+        rc = os_time_ms_to_ticks(timeout_ms, &ticks);
+        if (rc == 0 && OS_TIME_TICK_LT(now + ticks, sysdown_deadline)) {
+            work->sw_deadline = now + ticks;
+        }
+    }
+
+    /* The work holds its own reference until it completes. */
+    OS_ENTER_CRITICAL(sr);
+    sysdown_num_in_progress++;
+    SLIST_INSERT_HEAD(&sysdown_works, work, sw_next);
+    OS_EXIT_CRITICAL(sr);
+
+#if MYNEWT_VAL(SYSDOWN_WORKERS) > 0
+    work->sw_ev.ev_cb = sysdown_work_ev_cb;
+    work->sw_ev.ev_arg = work;
+    if (timeout_ms != 0) {
+        sysdown_timer_arm();
+    }
+    os_eventq_put(&sysdown_work_evq, &work->sw_ev);
+#else
+    fn(arg);
+    sysdown_work_done(work);
+#endif
+
+    return SYSDOWN_COMPLETE;
+}
+
+#if MYNEWT_VAL(SYSDOWN_TIMING)
+const struct sysdown_timing *
+sysdown_timing_get(int idx)
+{
+    if (idx < 0 || idx >= sysdown_num_timings) {
+        return NULL;
+    }
+
+    return &sysdown_timings[idx];
+}
+#endif
+
 int
 sysdown(int reason)
 {
+#if MYNEWT_VAL(SYSDOWN_TIMING)
+    os_time_t start;
+#endif
     os_sr_t sr;
     int rc;
     int i;
@@ -128,12 +327,38 @@ sysdown(int reason)
 
     os_callout_init(&sysdown_timer, os_eventq_dflt_get(), sysdown_timer_exp,
                     NULL);
+    sysdown_deadline = os_time_get() + SYSDOWN_TIMEOUT_TICKS;
     rc = os_callout_reset(&sysdown_timer, SYSDOWN_TIMEOUT_TICKS);
     assert(rc == 0);
 
+#if MYNEWT_VAL(SYSDOWN_WORKERS) > 0
+    sysdown_workers_start();
+#endif
+
+    /* Held while callbacks are called, so that work completing on a worker
+     * cannot finish sysdown before all callbacks have run.
+     */
+    OS_ENTER_CRITICAL(sr);
+    sysdown_num_in_progress++;
+    OS_EXIT_CRITICAL(sr);
+
+#if MYNEWT_VAL(SYSDOWN_TIMING)
+    sysdown_start_time = os_time_get();
+#endif
+
     /* Call each configured sysdown callback. */
     for (i = 0; sysdown_cbs[i] != NULL; i++) {
+        sysdown_cur_idx = i;
+#if MYNEWT_VAL(SYSDOWN_TIMING)
+        start = os_time_get();
+#endif
         rc = sysdown_cbs[i](reason);
+#if MYNEWT_VAL(SYSDOWN_TIMING)
+        if (i < MYNEWT_VAL(SYSDOWN_TIMING_MAX)) {
+            sysdown_timings[i].st_cb_ticks = os_time_get() - start;
+            sysdown_num_timings = i + 1;
+        }
+#endif
         switch (rc) {
         case SYSDOWN_COMPLETE:
             break;
@@ -149,13 +374,13 @@ sysdown(int reason)
         }
     }
 
+    sysdown_cur_idx = -1;
+
     /* If all subprocedures are complete, signal completion of sysdown.
-     * Otherwise, wait for in-progress subprocedures to signal completion
-     * asynchronously.
+     * Otherwise, wait for in-progress subprocedures and started work to
+     * signal completion asynchronously.
      */
-    if (sysdown_num_in_progress == 0) {
-        sysdown_complete();
-    }
+    sysdown_release();
 
     return 0;
 }
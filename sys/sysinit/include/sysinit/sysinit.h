@@ -23,6 +23,9 @@
 #include <inttypes.h>
 #include <assert.h>
 #include "syscfg/syscfg.h"
+#if MYNEWT_VAL(SYSINIT_ASYNC)
+#include "os/queue.h"
+#endif
 
 #if MYNEWT_VAL(SPLIT_APPLICATION)
 #include "split/split.h"
@@ -73,6 +76,99 @@ void sysinit_panic_set(sysinit_panic_fn *panic_fn);
 
 #define SYSINIT_PANIC_ASSERT(rc) SYSINIT_PANIC_ASSERT_MSG(rc, NULL)
 
+#if MYNEWT_VAL(SYSINIT_PROFILE)
+
+/**
+ * A timed part of boot: a device's initialization, a sysinit job, or
+ * anything recorded with SYSINIT_PROF_CALL().  Times are in os_cputime
+ * ticks, start relative to sysinit_start().
+ */
+struct sysinit_prof_rec {
+    const char *spr_name;
+    uint32_t spr_start;
+    uint32_t spr_ticks;
+};
+
+/**
+ * Records a part of boot which started at os_cputime start and took ticks.
+ * Records past SYSINIT_PROFILE_ENTRIES are counted as dropped.
+ */
+void sysinit_prof_add(const char *name, uint32_t start, uint32_t ticks);
+
+/**
+ * Returns the idx'th record; NULL past the last one.
+ */
+const struct sysinit_prof_rec *sysinit_prof_get(int idx);
+
+/**
+ * Returns the duration of sysinit, in os_cputime ticks; 0 until it has
+ * completed.  dropped, if not NULL, is filled with the number of records
+ * that did not fit.
+ */
+uint32_t sysinit_prof_total(int *dropped);
+
+/**
+ * Runs call, and records how long it took under name.
+ */
+#define SYSINIT_PROF_CALL(name, call) do                                    \
+{                                                                           \
+    uint32_t sysinit_prof_start_ = os_cputime_get32();                      \
+    call;                                                                   \
+    sysinit_prof_add((name), sysinit_prof_start_,                           \
+                     os_cputime_get32() - sysinit_prof_start_);             \
+} while (0)
+
+#else
+
+#define SYSINIT_PROF_CALL(name, call) do { call; } while (0)
+
+#endif
+
+#if MYNEWT_VAL(SYSINIT_ASYNC)
+
+/**
+ * A slow part of a package's initialization, run concurrently with the
+ * rest of sysinit once the jobs it depends on are done.  sysinit does not
+ * complete before all jobs have.
+ */
+struct sysinit_job {
+    const char *sj_name;
+    void (*sj_fn)(void);
+    /** Jobs that must complete first; NULL terminated, or NULL. */
+    struct sysinit_job * const *sj_deps;
+
+    /** Start time and duration, in os_cputime ticks, once done. */
+    uint32_t sj_start;
+    uint32_t sj_ticks;
+
+    /* Private. */
+    STAILQ_ENTRY(sysinit_job) sj_next;
+    volatile uint8_t sj_state;
+};
+
+/**
+ * Queues a job; to be called from a package's init function.  The jobs
+ * it depends on must have been added before.
+ */
+void sysinit_job_add(struct sysinit_job *job);
+
+/**
+ * Waits for a job to complete, running ready jobs in the meantime.  For
+ * init code that needs the result of an asynchronous job.
+ */
+void sysinit_job_wait(struct sysinit_job *job);
+
+/**
+ * Iterates over the jobs added, e.g. to report their timing.
+ *
+ * @param prev                  The previous job, or NULL for the first.
+ *
+ * @return                      The next job; NULL if there are no more.
+ */
+const struct sysinit_job *sysinit_job_next(const struct sysinit_job *prev);
+
+#endif
+
 /**
  * Asserts that system initialization is in progress.  This macro is used to
  * ensure packages don't get initialized a second time after system
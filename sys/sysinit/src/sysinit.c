@@ -39,6 +39,232 @@ sysinit_panic_fn *sysinit_panic_cb = sysinit_dflt_panic_cb;
 
 uint8_t sysinit_active;
 
+#if MYNEWT_VAL(SYSINIT_PROFILE)
+static struct sysinit_prof_rec
+    sysinit_prof_recs[MYNEWT_VAL(SYSINIT_PROFILE_ENTRIES)];
+static int sysinit_prof_cnt;
+static int sysinit_prof_dropped;
+static uint32_t sysinit_prof_t0;
+static uint32_t sysinit_prof_ticks;
+
+void
+sysinit_prof_add(const char *name, uint32_t start, uint32_t ticks)
+{
+    struct sysinit_prof_rec *rec;
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    if (sysinit_prof_cnt < MYNEWT_VAL(SYSINIT_PROFILE_ENTRIES)) {
+        rec = &sysinit_prof_recs[sysinit_prof_cnt++];
+        rec->spr_name = name;
+        rec->spr_start = start - sysinit_prof_t0;
+        rec->spr_ticks = ticks;
+    } else {
+        sysinit_prof_dropped++;
+    }
+    OS_EXIT_CRITICAL(sr);
+}
+
+const struct sysinit_prof_rec *
+sysinit_prof_get(int idx)
+{
+    if (idx < 0 || idx >= sysinit_prof_cnt) {
+        return NULL;
+    }
+    return &sysinit_prof_recs[idx];
+}
+
+uint32_t
+sysinit_prof_total(int *dropped)
+{
+    if (dropped != NULL) {
+        *dropped = sysinit_prof_dropped;
+    }
+    return sysinit_prof_ticks;
+}
+#endif
+
+#if MYNEWT_VAL(SYSINIT_ASYNC)
+
+#define SYSINIT_JOB_S_PENDING       1
+#define SYSINIT_JOB_S_RUNNING       2
+#define SYSINIT_JOB_S_DONE          3
+
+static STAILQ_HEAD(, sysinit_job) sysinit_jobs =
+    STAILQ_HEAD_INITIALIZER(sysinit_jobs);
+
+/* Released when a job is added or done, and when a job is done. */
+static struct os_sem sysinit_work_sem;
+static struct os_sem sysinit_done_sem;
+
+#if MYNEWT_VAL(SYSINIT_ASYNC_WORKERS) > 0
+static struct os_task sysinit_workers[MYNEWT_VAL(SYSINIT_ASYNC_WORKERS)];
+static os_stack_t sysinit_worker_stacks[MYNEWT_VAL(SYSINIT_ASYNC_WORKERS)]
+                                        [MYNEWT_VAL(SYSINIT_ASYNC_STACK_SIZE)];
+#endif
+
+static int
+sysinit_job_ready(const struct sysinit_job *job)
+{
+    struct sysinit_job * const *dep;
+
+    if (job->sj_state != SYSINIT_JOB_S_PENDING) {
+        return 0;
+    }
+    if (job->sj_deps != NULL) {
+        for (dep = job->sj_deps; *dep != NULL; dep++) {
+            if ((*dep)->sj_state != SYSINIT_JOB_S_DONE) {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+/* Takes the first job that can run, if any. */
+static struct sysinit_job *
+sysinit_job_take(void)
+{
+    struct sysinit_job *job;
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    STAILQ_FOREACH(job, &sysinit_jobs, sj_next) {
+        if (sysinit_job_ready(job)) {
+            job->sj_state = SYSINIT_JOB_S_RUNNING;
+            break;
+        }
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    return job;
+}
+
+static void
+sysinit_job_run(struct sysinit_job *job)
+{
+    int i;
+
+    job->sj_start = os_cputime_get32();
+    job->sj_fn();
+    job->sj_ticks = os_cputime_get32() - job->sj_start;
+    job->sj_state = SYSINIT_JOB_S_DONE;
+#if MYNEWT_VAL(SYSINIT_PROFILE)
+    sysinit_prof_add(job->sj_name, job->sj_start, job->sj_ticks);
+#endif
+
+    /* Jobs depending on this one may now be ready. */
+    for (i = 0; i < MYNEWT_VAL(SYSINIT_ASYNC_WORKERS); i++) {
+        os_sem_release(&sysinit_work_sem);
+    }
+    os_sem_release(&sysinit_done_sem);
+}
+
+#if MYNEWT_VAL(SYSINIT_ASYNC_WORKERS) > 0
+static void
+sysinit_worker(void *arg)
+{
+    struct sysinit_job *job;
+
+    while (1) {
+        job = sysinit_job_take();
+        if (job != NULL) {
+            sysinit_job_run(job);
+        } else {
+            os_sem_pend(&sysinit_work_sem, OS_TIMEOUT_NEVER);
+        }
+    }
+}
+#endif
+
+void
+sysinit_job_add(struct sysinit_job *job)
+{
+    struct sysinit_job * const *dep;
+    os_sr_t sr;
+
+    SYSINIT_ASSERT_ACTIVE();
+
+    if (job->sj_deps != NULL) {
+        for (dep = job->sj_deps; *dep != NULL; dep++) {
+            /* Also rules out cycles. */
+            SYSINIT_PANIC_ASSERT_MSG((*dep)->sj_state != 0,
+                                     "sysinit job dependency not added");
+        }
+    }
+
+    job->sj_start = 0;
+    job->sj_ticks = 0;
+
+    OS_ENTER_CRITICAL(sr);
+    job->sj_state = SYSINIT_JOB_S_PENDING;
+    STAILQ_INSERT_TAIL(&sysinit_jobs, job, sj_next);
+    OS_EXIT_CRITICAL(sr);
+
+    os_sem_release(&sysinit_work_sem);
+}
+
+void
+sysinit_job_wait(struct sysinit_job *job)
+{
+    struct sysinit_job *ready;
+
+    SYSINIT_PANIC_ASSERT_MSG(job->sj_state != 0, "sysinit job not added");
+
+    while (job->sj_state != SYSINIT_JOB_S_DONE) {
+        ready = sysinit_job_take();
+        if (ready != NULL) {
+            sysinit_job_run(ready);
+        } else {
+            os_sem_pend(&sysinit_done_sem, OS_TIMEOUT_NEVER);
+        }
+    }
+}
+
+const struct sysinit_job *
+sysinit_job_next(const struct sysinit_job *prev)
+{
+    if (prev == NULL) {
+        return STAILQ_FIRST(&sysinit_jobs);
+    }
+    return STAILQ_NEXT(prev, sj_next);
+}
+
+static void
+sysinit_jobs_start(void)
+{
+#if MYNEWT_VAL(SYSINIT_ASYNC_WORKERS) > 0
+    int rc;
+    int i;
+#endif
+
+    os_sem_init(&sysinit_work_sem, 0);
+    os_sem_init(&sysinit_done_sem, 0);
+
+#if MYNEWT_VAL(SYSINIT_ASYNC_WORKERS) > 0
+    for (i = 0; i < MYNEWT_VAL(SYSINIT_ASYNC_WORKERS); i++) {
+        rc = os_task_init(&sysinit_workers[i], "sysinit", sysinit_worker,
+                          NULL, MYNEWT_VAL(SYSINIT_ASYNC_PRIO) + i,
+                          OS_WAIT_FOREVER, sysinit_worker_stacks[i],
+                          MYNEWT_VAL(SYSINIT_ASYNC_STACK_SIZE));
+        SYSINIT_PANIC_ASSERT(rc == 0);
+    }
+#endif
+}
+
+/* Runs or waits for every job still outstanding. */
+static void
+sysinit_jobs_finish(void)
+{
+    struct sysinit_job *job;
+
+    STAILQ_FOREACH(job, &sysinit_jobs, sj_next) {
+        sysinit_job_wait(job);
+    }
+}
+
+#endif
+
 /**
  * Sets the sysinit panic function; i.e., the function which executes when
  * initialization fails.  By default, a panic triggers a failed assertion.
@@ -53,10 +279,22 @@ void
 sysinit_start(void)
 {
     sysinit_active = 1;
+#if MYNEWT_VAL(SYSINIT_PROFILE)
+    sysinit_prof_t0 = os_cputime_get32();
+#endif
+#if MYNEWT_VAL(SYSINIT_ASYNC)
+    sysinit_jobs_start();
+#endif
 }
 
 void
 sysinit_end(void)
 {
+#if MYNEWT_VAL(SYSINIT_ASYNC)
+    sysinit_jobs_finish();
+#endif
+#if MYNEWT_VAL(SYSINIT_PROFILE)
+    sysinit_prof_ticks = os_cputime_get32() - sysinit_prof_t0;
+#endif
     sysinit_active = 0;
 }
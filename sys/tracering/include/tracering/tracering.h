@@ -0,0 +1,106 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef H_TRACERING_
+#define H_TRACERING_
+
+#include <inttypes.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Trace ring records are 32-bit words, in native byte order:
+ *
+ *      word 0      os_cputime timestamp
+ *      word 1      type | nargs << 8 | id << 16
+ *      nargs words arguments
+ *
+ * Task arguments are struct os_task addresses.
+ */
+#define TRACERING_EV_BOOT               1   /* reset reason, boot count */
+#define TRACERING_EV_ISR_ENTER          2
+#define TRACERING_EV_ISR_EXIT           3
+#define TRACERING_EV_TASK_CREATE        4   /* task */
+#define TRACERING_EV_TASK_EXEC          5   /* task */
+#define TRACERING_EV_TASK_STOP_EXEC     6
+#define TRACERING_EV_TASK_READY         7   /* task */
+#define TRACERING_EV_TASK_BLOCK         8   /* task, reason */
+#define TRACERING_EV_IDLE               9
+#define TRACERING_EV_USER_START         10  /* id */
+#define TRACERING_EV_USER_STOP          11  /* id */
+#define TRACERING_EV_API                12  /* id = OS_TRACE_ID_*, args */
+#define TRACERING_EV_API_RET            13  /* id, return value if any */
+
+#define TRACERING_MAX_ARGS              3
+
+/**
+ * Appends one event to the trace ring, overwriting the oldest ones if it
+ * is full.  Callable from interrupt context.
+ */
+void tracering_rec(unsigned type, unsigned id, int nargs,
+                   uint32_t a0, uint32_t a1, uint32_t a2);
+
+struct os_task;
+
+/*
+ * Also called from the context switch and interrupt entry code in
+ * assembly, hence functions.
+ */
+void tracering_isr_enter(void);
+void tracering_isr_exit(void);
+void tracering_task_start_exec(const struct os_task *t);
+
+/**
+ * Starts or stops recording.  Recording starts at init.
+ */
+void tracering_enable(int on);
+
+/**
+ * Throws away all recorded events.
+ */
+void tracering_clear(void);
+
+/**
+ * Copies out recorded events, oldest first.
+ *
+ * @param off                   Byte offset from the oldest event.
+ * @param buf                   Where to copy to.
+ * @param len                   Bytes to copy at most.
+ *
+ * @return                      Bytes copied.
+ */
+int tracering_read(uint32_t off, void *buf, int len);
+
+/**
+ * @return                      Bytes of events recorded.
+ */
+uint32_t tracering_len(void);
+
+/**
+ * @return                      Events overwritten since last cleared.
+ */
+uint32_t tracering_dropped(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,252 @@
+#!/usr/bin/env python3
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+#
+"""Converts a trace ring download into Chrome trace event JSON.
+
+The output opens in Perfetto (ui.perfetto.dev) and chrome://tracing.
+
+The input is the concatenated "data" of the trace ring read responses.
+The other fields of the first response ("freq", "tasks", ...) can be
+saved as JSON and given with --info, for task names and real time.
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+EV_BOOT = 1
+EV_ISR_ENTER = 2
+EV_ISR_EXIT = 3
+EV_TASK_CREATE = 4
+EV_TASK_EXEC = 5
+EV_TASK_STOP_EXEC = 6
+EV_TASK_READY = 7
+EV_TASK_BLOCK = 8
+EV_IDLE = 9
+EV_USER_START = 10
+EV_USER_STOP = 11
+EV_API = 12
+EV_API_RET = 13
+
+# OS_TRACE_ID_* from os/os_trace_api.h
+API_NAMES = {
+    40: "os_eventq_put",
+    41: "os_eventq_get_no_wait",
+    42: "os_eventq_get",
+    43: "os_eventq_remove",
+    44: "os_eventq_poll_0timo",
+    45: "os_eventq_poll",
+    46: "os_eventq_waitset_poll",
+    50: "os_mutex_init",
+    51: "os_mutex_release",
+    52: "os_mutex_pend",
+    60: "os_sem_init",
+    61: "os_sem_release",
+    62: "os_sem_pend",
+    70: "os_callout_init",
+    71: "os_callout_stop",
+    72: "os_callout_reset",
+    73: "os_callout_tick",
+    80: "os_memblock_get",
+    81: "os_memblock_put_from_cb",
+    82: "os_memblock_put",
+    90: "os_mbuf_get",
+    91: "os_mbuf_get_pkthdr",
+    92: "os_mbuf_free",
+    93: "os_mbuf_free_chain",
+    100: "bus_node_read",
+    101: "bus_node_write",
+    102: "bus_node_write_read_transact",
+    103: "bus_node_lock",
+    104: "bus_node_unlock",
+    110: "hal_flash_write",
+    111: "hal_flash_erase_sector",
+    112: "hal_flash_erase",
+    113: "hal_flash_write_start",
+    114: "hal_flash_erase_sector_start",
+}
+
+PID = 1
+TID_ISR = 1
+TID_USER = 2
+
+
+def records(data, endian):
+    off = 0
+    while off + 8 <= len(data):
+        ts, hdr = struct.unpack_from(endian + "II", data, off)
+        nargs = (hdr >> 8) & 0xff
+        if off + 8 + 4 * nargs > len(data):
+            break
+        args = struct.unpack_from(endian + "I" * nargs, data, off + 8)
+        yield ts, hdr & 0xff, hdr >> 16, args
+        off += 8 + 4 * nargs
+
+
+class Converter:
+    def __init__(self, freq, tasks):
+        self.scale = 1e6 / freq
+        self.tasks = tasks
+        self.events = []
+        self.base = 0
+        self.last = None
+        self.running = None
+        self.isr_depth = 0
+        self.users = set()
+
+    def tid(self, task):
+        # Task addresses make unique thread ids, clear of the fixed ones.
+        if task not in self.tasks:
+            self.tasks[task] = "task 0x%08x" % task
+        return task
+
+    def stamp(self, ts, boot):
+        # os_cputime wraps at 32 bits, and restarts from wherever at boot;
+        # time is kept running across both.
+        if self.last is None:
+            self.base = -ts
+        elif boot:
+            self.base += self.last - ts
+        elif ts < self.last:
+            self.base += 1 << 32
+        self.last = ts
+        return (ts + self.base) * self.scale
+
+    def add(self, ph, name, us, tid, **kw):
+        ev = {"ph": ph, "name": name, "ts": us, "pid": PID, "tid": tid}
+        ev.update(kw)
+        self.events.append(ev)
+
+    def close_all(self, us):
+        if self.running is not None:
+            self.add("E", "run", us, self.running)
+            self.running = None
+        while self.isr_depth > 0:
+            self.add("E", "isr", us, TID_ISR)
+            self.isr_depth -= 1
+        for uid in sorted(self.users):
+            self.add("E", "user %d" % uid, us, TID_USER)
+        self.users.clear()
+
+    def record(self, ts, ev, eid, args):
+        us = self.stamp(ts, ev == EV_BOOT)
+
+        if ev == EV_BOOT:
+            self.close_all(us)
+            self.add("i", "boot", us, TID_ISR, s="g",
+                     args={"reset_reason": args[0] if args else None,
+                           "boots": args[1] if len(args) > 1 else None})
+        elif ev == EV_ISR_ENTER:
+            self.isr_depth += 1
+            self.add("B", "isr", us, TID_ISR)
+        elif ev == EV_ISR_EXIT:
+            if self.isr_depth > 0:
+                self.isr_depth -= 1
+                self.add("E", "isr", us, TID_ISR)
+        elif ev == EV_TASK_EXEC:
+            if self.running is not None:
+                self.add("E", "run", us, self.running)
+            self.running = self.tid(args[0])
+            self.add("B", "run", us, self.running)
+        elif ev == EV_TASK_STOP_EXEC:
+            if self.running is not None:
+                self.add("E", "run", us, self.running)
+                self.running = None
+        elif ev in (EV_TASK_CREATE, EV_TASK_READY, EV_TASK_BLOCK):
+            name = {EV_TASK_CREATE: "create", EV_TASK_READY: "ready",
+                    EV_TASK_BLOCK: "block"}[ev]
+            kw = {}
+            if ev == EV_TASK_BLOCK and len(args) > 1:
+                kw["args"] = {"reason": args[1]}
+            self.add("i", name, us, self.tid(args[0]), s="t", **kw)
+        elif ev == EV_IDLE:
+            self.add("i", "idle", us, TID_ISR, s="p")
+        elif ev == EV_USER_START:
+            uid = args[0] if args else eid
+            self.users.add(uid)
+            self.add("B", "user %d" % uid, us, TID_USER)
+        elif ev == EV_USER_STOP:
+            uid = args[0] if args else eid
+            if uid in self.users:
+                self.users.remove(uid)
+                self.add("E", "user %d" % uid, us, TID_USER)
+        elif ev in (EV_API, EV_API_RET):
+            name = API_NAMES.get(eid, "api %d" % eid)
+            tid = TID_ISR if self.isr_depth > 0 or self.running is None \
+                else self.running
+            if ev == EV_API:
+                kw = {"args": {"arg%d" % i: "0x%x" % a
+                               for i, a in enumerate(args)}}
+            else:
+                name += " ret"
+                kw = {"args": {"ret": args[0]}} if args else {}
+            self.add("i", name, us, tid, s="t", **kw)
+
+    def finish(self):
+        if self.last is not None:
+            self.close_all((self.last + self.base) * self.scale)
+        meta = [{"ph": "M", "name": "process_name", "pid": PID,
+                 "args": {"name": "mynewt"}},
+                {"ph": "M", "name": "thread_name", "pid": PID,
+                 "tid": TID_ISR, "args": {"name": "interrupts"}},
+                {"ph": "M", "name": "thread_name", "pid": PID,
+                 "tid": TID_USER, "args": {"name": "user"}}]
+        for task, name in self.tasks.items():
+            meta.append({"ph": "M", "name": "thread_name", "pid": PID,
+                         "tid": task, "args": {"name": name}})
+        return {"traceEvents": meta + self.events,
+                "displayTimeUnit": "ns"}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("dump", help="trace ring data, raw bytes")
+    parser.add_argument("-i", "--info",
+                        help="JSON with the first read response's fields")
+    parser.add_argument("-f", "--freq", type=int,
+                        help="timestamp ticks per second")
+    parser.add_argument("-b", "--big-endian", action="store_true",
+                        help="target is big endian")
+    parser.add_argument("-o", "--output", help="output file, default stdout")
+    args = parser.parse_args()
+
+    info = {}
+    if args.info:
+        with open(args.info) as f:
+            info = json.load(f)
+    freq = args.freq or info.get("freq") or 1000000
+    tasks = {t["id"]: t["name"] for t in info.get("tasks", [])}
+
+    with open(args.dump, "rb") as f:
+        data = f.read()
+
+    conv = Converter(freq, tasks)
+    for rec in records(data, ">" if args.big_endian else "<"):
+        conv.record(*rec)
+    trace = conv.finish()
+
+    out = open(args.output, "w") if args.output else sys.stdout
+    json.dump(trace, out)
+    if out is not sys.stdout:
+        out.close()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,424 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+
+#include "os/mynewt.h"
+#include "bsp/bsp.h"
+#include "hal/hal_system.h"
+#include "tracering/tracering.h"
+
+#if MYNEWT_VAL(TRACERING_MGMT)
+#include <limits.h>
+#include "mgmt/mgmt.h"
+#include "cborattr/cborattr.h"
+#endif
+
+#ifndef sec_bss_nz_core
+#define sec_bss_nz_core
+#endif
+
+#define TRACERING_MAGIC         0x52435254  /* "TRCR" */
+#define TRACERING_WORDS         (MYNEWT_VAL(TRACERING_SIZE) / 4)
+
+/*
+ * Lives in RAM that is not cleared at startup, so that the events leading
+ * up to a reset can be read after it.  Checked before use at init.  One
+ * word is always left free, so head == tail means empty.
+ */
+struct tracering {
+    uint32_t tr_magic;
+    uint32_t tr_words;
+    uint32_t tr_head;
+    uint32_t tr_tail;
+    uint32_t tr_dropped;
+    uint32_t tr_boots;
+    uint32_t tr_buf[TRACERING_WORDS];
+};
+
+static struct tracering tracering sec_bss_nz_core;
+static volatile uint8_t tracering_on;
+
+static inline uint32_t
+tracering_wrap(uint32_t idx)
+{
+    return idx >= TRACERING_WORDS ? idx - TRACERING_WORDS : idx;
+}
+
+static inline uint32_t
+tracering_used(void)
+{
+    return tracering_wrap(tracering.tr_head + TRACERING_WORDS -
+                          tracering.tr_tail);
+}
+
+static inline uint32_t
+tracering_rec_len(uint32_t idx)
+{
+    return 2 + ((tracering.tr_buf[tracering_wrap(idx + 1)] >> 8) & 0x3);
+}
+
+/*
+ * Whether what was left in RAM is a ring of whole records.
+ */
+static int
+tracering_valid(void)
+{
+    uint32_t idx;
+    uint32_t left;
+    uint32_t len;
+
+    if (tracering.tr_magic != TRACERING_MAGIC ||
+        tracering.tr_words != TRACERING_WORDS ||
+        tracering.tr_head >= TRACERING_WORDS ||
+        tracering.tr_tail >= TRACERING_WORDS) {
+        return 0;
+    }
+
+    idx = tracering.tr_tail;
+    left = tracering_used();
+    while (left > 0) {
+        len = tracering_rec_len(idx);
+        if (left < len) {
+            return 0;
+        }
+        left -= len;
+        idx = tracering_wrap(idx + len);
+    }
+
+    return 1;
+}
+
+void
+tracering_rec(unsigned type, unsigned id, int nargs,
+              uint32_t a0, uint32_t a1, uint32_t a2)
+{
+    uint32_t rec[2 + TRACERING_MAX_ARGS];
+    uint32_t head;
+    os_sr_t sr;
+    int n;
+    int i;
+
+    if (!tracering_on) {
+        return;
+    }
+
+    rec[1] = type | nargs << 8 | id << 16;
+    rec[2] = a0;
+    rec[3] = a1;
+    rec[4] = a2;
+    n = 2 + nargs;
+
+    OS_ENTER_CRITICAL(sr);
+    rec[0] = os_cputime_get32();
+
+    while (TRACERING_WORDS - 1 - tracering_used() < n) {
+        tracering.tr_tail = tracering_wrap(tracering.tr_tail +
+                                           tracering_rec_len(tracering.tr_tail));
+        tracering.tr_dropped++;
+    }
+
+    head = tracering.tr_head;
+    for (i = 0; i < n; i++) {
+        tracering.tr_buf[head] = rec[i];
+        head = tracering_wrap(head + 1);
+    }
+    tracering.tr_head = head;
+
+    OS_EXIT_CRITICAL(sr);
+}
+
+void
+tracering_isr_enter(void)
+{
+    tracering_rec(TRACERING_EV_ISR_ENTER, 0, 0, 0, 0, 0);
+}
+
+void
+tracering_isr_exit(void)
+{
+    tracering_rec(TRACERING_EV_ISR_EXIT, 0, 0, 0, 0, 0);
+}
+
+void
+tracering_task_start_exec(const struct os_task *t)
+{
+    tracering_rec(TRACERING_EV_TASK_EXEC, 0, 1, (uintptr_t)t, 0, 0);
+}
+
+void
+tracering_enable(int on)
+{
+    tracering_on = !!on;
+}
+
+void
+tracering_clear(void)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    tracering.tr_head = 0;
+    tracering.tr_tail = 0;
+    tracering.tr_dropped = 0;
+    OS_EXIT_CRITICAL(sr);
+}
+
+uint32_t
+tracering_len(void)
+{
+    return tracering_used() * 4;
+}
+
+uint32_t
+tracering_dropped(void)
+{
+    return tracering.tr_dropped;
+}
+
+int
+tracering_read(uint32_t off, void *buf, int len)
+{
+    const uint8_t *ring;
+    uint32_t used;
+    uint32_t pos;
+    uint32_t n;
+    os_sr_t sr;
+    int copied;
+
+    ring = (const uint8_t *)tracering.tr_buf;
+    copied = 0;
+
+    OS_ENTER_CRITICAL(sr);
+    used = tracering_used() * 4;
+    if (off < used) {
+        len = min(len, used - off);
+        pos = tracering.tr_tail * 4 + off;
+        while (copied < len) {
+            if (pos >= sizeof(tracering.tr_buf)) {
+                pos -= sizeof(tracering.tr_buf);
+            }
+            n = min(len - copied, sizeof(tracering.tr_buf) - pos);
+            memcpy((uint8_t *)buf + copied, ring + pos, n);
+            copied += n;
+            pos += n;
+        }
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    return copied;
+}
+
+#if MYNEWT_VAL(TRACERING_MGMT)
+static int tracering_mgmt_read(struct mgmt_ctxt *ctxt);
+static int tracering_mgmt_write(struct mgmt_ctxt *ctxt);
+
+static const struct mgmt_handler tracering_mgmt_handlers[] = {
+    [0] = { tracering_mgmt_read, tracering_mgmt_write },
+};
+
+static struct mgmt_group tracering_mgmt_group = {
+    .mg_handlers = (struct mgmt_handler *)tracering_mgmt_handlers,
+    .mg_handlers_count = 1,
+    .mg_group_id = MYNEWT_VAL(TRACERING_MGMT_GROUP),
+};
+
+/* Recording was on when a download paused it. */
+static uint8_t tracering_mgmt_resume;
+
+static CborError
+tracering_mgmt_tasks(CborEncoder *enc)
+{
+    struct os_task_info oti;
+    struct os_task *t;
+    CborEncoder tasks;
+    CborEncoder map;
+    CborError g_err = CborNoError;
+
+    g_err |= cbor_encode_text_stringz(enc, "tasks");
+    g_err |= cbor_encoder_create_array(enc, &tasks, CborIndefiniteLength);
+    t = NULL;
+    while ((t = os_task_info_get_next(t, &oti)) != NULL) {
+        g_err |= cbor_encoder_create_map(&tasks, &map, 3);
+        g_err |= cbor_encode_text_stringz(&map, "id");
+        g_err |= cbor_encode_uint(&map, (uint32_t)(uintptr_t)t);
+        g_err |= cbor_encode_text_stringz(&map, "name");
+        g_err |= cbor_encode_text_stringz(&map, oti.oti_name);
+        g_err |= cbor_encode_text_stringz(&map, "prio");
+        g_err |= cbor_encode_uint(&map, oti.oti_prio);
+        g_err |= cbor_encoder_close_container(&tasks, &map);
+    }
+    g_err |= cbor_encoder_close_container(enc, &tasks);
+
+    return g_err;
+}
+
+/*
+ * Request:
+ * {
+ *      "off":<byte offset>
+ * }
+ *
+ * Response:
+ * {
+ *      "rc":0,
+ *      "off":<byte offset>,
+ *      "data":<events>,
+ *  First response only:
+ *      "len":<bytes of events>,
+ *      "freq":<timestamp ticks per second>,
+ *      "dropped":<events overwritten>,
+ *      "boots":<resets the ring has seen>,
+ *      "tasks":[{"id":<task>, "name":<name>, "prio":<prio>}, ...]
+ * }
+ *
+ * Recording stops when offset 0 is read, so the download is consistent,
+ * and starts again once the last byte is read.
+ */
+static int
+tracering_mgmt_read(struct mgmt_ctxt *ctxt)
+{
+    unsigned long long off = UINT_MAX;
+    const struct cbor_attr_t attr[2] = {
+        [0] = {
+            .attribute = "off",
+            .type = CborAttrUnsignedIntegerType,
+            .addr.uinteger = &off
+        },
+        [1] = { 0 },
+    };
+    uint8_t data[MYNEWT_VAL(TRACERING_MGMT_CHUNK)];
+    CborError g_err = CborNoError;
+    uint32_t len;
+    int sz;
+    int rc;
+
+    rc = cbor_read_object(&ctxt->it, attr);
+    if (rc || off == UINT_MAX) {
+        return MGMT_ERR_EINVAL;
+    }
+
+    if (off == 0) {
+        if (tracering_on) {
+            tracering_mgmt_resume = 1;
+            tracering_on = 0;
+        }
+    }
+
+    len = tracering_len();
+    if (off > len) {
+        off = len;
+    }
+    sz = tracering_read(off, data, sizeof(data));
+
+    g_err |= cbor_encode_text_stringz(&ctxt->encoder, "rc");
+    g_err |= cbor_encode_int(&ctxt->encoder, MGMT_ERR_EOK);
+    g_err |= cbor_encode_text_stringz(&ctxt->encoder, "off");
+    g_err |= cbor_encode_uint(&ctxt->encoder, off);
+    g_err |= cbor_encode_text_stringz(&ctxt->encoder, "data");
+    g_err |= cbor_encode_byte_string(&ctxt->encoder, data, sz);
+
+    if (off == 0) {
+        g_err |= cbor_encode_text_stringz(&ctxt->encoder, "len");
+        g_err |= cbor_encode_uint(&ctxt->encoder, len);
+        g_err |= cbor_encode_text_stringz(&ctxt->encoder, "freq");
+        g_err |= cbor_encode_uint(&ctxt->encoder, MYNEWT_VAL(OS_CPUTIME_FREQ));
+        g_err |= cbor_encode_text_stringz(&ctxt->encoder, "dropped");
+        g_err |= cbor_encode_uint(&ctxt->encoder, tracering_dropped());
+        g_err |= cbor_encode_text_stringz(&ctxt->encoder, "boots");
+        g_err |= cbor_encode_uint(&ctxt->encoder, tracering.tr_boots);
+        g_err |= tracering_mgmt_tasks(&ctxt->encoder);
+    }
+
+    if (off + sz >= len && tracering_mgmt_resume) {
+        tracering_mgmt_resume = 0;
+        tracering_on = 1;
+    }
+
+    if (g_err) {
+        return MGMT_ERR_ENOMEM;
+    }
+    return 0;
+}
+
+/*
+ * Request:
+ * {
+ *      "run":<1 to start recording, 0 to stop; optional>,
+ *      "clear":<true to throw events away; optional>
+ * }
+ */
+static int
+tracering_mgmt_write(struct mgmt_ctxt *ctxt)
+{
+    unsigned long long run = UINT_MAX;
+    bool clear = false;
+    const struct cbor_attr_t attr[3] = {
+        [0] = {
+            .attribute = "run",
+            .type = CborAttrUnsignedIntegerType,
+            .addr.uinteger = &run
+        },
+        [1] = {
+            .attribute = "clear",
+            .type = CborAttrBooleanType,
+            .addr.boolean = &clear
+        },
+        [2] = { 0 },
+    };
+    int rc;
+
+    rc = cbor_read_object(&ctxt->it, attr);
+    if (rc) {
+        return MGMT_ERR_EINVAL;
+    }
+
+    if (clear) {
+        tracering_clear();
+    }
+    if (run != UINT_MAX) {
+        tracering_mgmt_resume = 0;
+        tracering_enable(run != 0);
+    }
+
+    return mgmt_write_rsp_status(ctxt, 0);
+}
+#endif
+
+void
+tracering_init(void)
+{
+    /* Ensure this function only gets called by sysinit. */
+    SYSINIT_ASSERT_ACTIVE();
+
+    if (!tracering_valid()) {
+        memset(&tracering, 0, offsetof(struct tracering, tr_buf));
+        tracering.tr_magic = TRACERING_MAGIC;
+        tracering.tr_words = TRACERING_WORDS;
+    }
+    tracering.tr_boots++;
+
+    tracering_on = 1;
+    tracering_rec(TRACERING_EV_BOOT, 0, 2, hal_reset_cause(),
+                  tracering.tr_boots, 0);
+
+#if MYNEWT_VAL(TRACERING_MGMT)
+    mgmt_register_group(&tracering_mgmt_group);
+#endif
+}
@@ -27,6 +27,7 @@ extern "C" {
 
 #define RUNTEST_SMP_OP_TEST    0
 #define RUNTEST_SMP_OP_LIST    1
+#define RUNTEST_SMP_OP_BENCH   2
 
 /* Define the prefix to to add to all test log messages.  If the user's syscfg
  * specifies the `RUNTEST_PREFIX` setting, use that value.  Otherwise, generate
@@ -77,6 +78,27 @@ int runtest_run(const char *test_name, const char *token);
  */
 int runtest_total_fails_get(void);
 
+#if MYNEWT_VAL(RUNTEST_BENCH)
+struct tu_bench_result;
+
+/**
+ * Runs a benchmark registered with TEST_BENCH_REGISTER() and waits for its
+ * results.
+ *
+ * @param bench_name            The name of the benchmark to run.
+ * @param warmup                Number of untimed iterations run first.
+ * @param iterations            Number of timed iterations.
+ * @param res                   On success, the timing results.
+ *
+ * @return                      0 on success;
+ *                              SYS_EAGAIN if a test is already in progress;
+ *                              SYS_ENOENT if there is no such benchmark;
+ *                              SYS_EINVAL if iterations is out of range.
+ */
+int runtest_bench(const char *bench_name, int warmup, int iterations,
+                  struct tu_bench_result *res);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -266,6 +266,38 @@ runtest_run(const char *test_name, const char *token)
     return rc;
 }
 
+#if MYNEWT_VAL(RUNTEST_BENCH)
+int
+runtest_bench(const char *bench_name, int warmup, int iterations,
+              struct tu_bench_result *res)
+{
+    struct tu_bench *tb;
+    int rc;
+
+    runtest_lock();
+
+    if (runtest_busy) {
+        rc = SYS_EAGAIN;
+    } else {
+        tb = tu_bench_find(bench_name);
+        rc = tb ? 0 : SYS_ENOENT;
+        runtest_busy = tb != NULL;
+    }
+
+    runtest_unlock();
+
+    if (rc) {
+        return rc;
+    }
+
+    /* Runs in the caller; tests are not queued while busy is set */
+    rc = tu_bench_run(tb, warmup, iterations, res);
+    runtest_busy = false;
+
+    return rc;
+}
+#endif
+
 /*
  * Package init routine to register mgmt "run" commands
  */
@@ -24,8 +24,10 @@
 #include <console/console.h>
 #include <shell/shell.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
+#include "testutil/testutil.h"
 #include "runtest/runtest.h"
 #include "runtest_priv.h"
 
@@ -35,10 +37,48 @@ struct shell_cmd runtest_cmd_struct = {
     .sc_cmd_func = runtest_cli_cmd
 };
 
+#if MYNEWT_VAL(RUNTEST_BENCH)
+static void
+runtest_cli_bench(int argc, char **argv)
+{
+    struct tu_bench_result res;
+    int iterations;
+    int warmup;
+    int rc;
+
+    iterations = argc > 3 ? atoi(argv[3]) :
+                            MYNEWT_VAL(RUNTEST_BENCH_ITERATIONS);
+    warmup = argc > 4 ? atoi(argv[4]) : MYNEWT_VAL(RUNTEST_BENCH_WARMUP);
+
+    rc = runtest_bench(argv[2], warmup, iterations, &res);
+    if (rc) {
+        console_printf("bench %s failed: %d\n", argv[2], rc);
+        return;
+    }
+
+    console_printf("{\"bench\":\"%s\",\"unit\":\"%s\",\"freq\":%lu,"
+                   "\"n\":%lu,\"min\":%lu,\"median\":%lu,\"p99\":%lu,"
+                   "\"max\":%lu}\n",
+                   argv[2], tu_bench_unit(), (unsigned long)tu_bench_freq(),
+                   (unsigned long)res.tbr_n, (unsigned long)res.tbr_min,
+                   (unsigned long)res.tbr_median, (unsigned long)res.tbr_p99,
+                   (unsigned long)res.tbr_max);
+}
+#endif
+
 static int
 runtest_cli_cmd(int argc, char **argv)
 {
+#if MYNEWT_VAL(RUNTEST_BENCH)
+    if (argc > 2 && strcmp(argv[1], "bench") == 0) {
+        runtest_cli_bench(argc, argv);
+        return 0;
+    }
+    console_printf("Usage run [list | test testname token | "
+                   "bench benchname [iterations [warmup]]] \n");
+#else
     console_printf("Usage run [list | test testname token] \n");
+#endif
     return 0;
 }
 
@@ -20,6 +20,7 @@
 #include "os/mynewt.h"
 
 #if MYNEWT_VAL(RUNTEST_MGMT)
+#include <limits.h>
 #include <string.h>
 
 #include "mgmt/mgmt.h"
@@ -33,12 +34,18 @@
 
 static int runtest_mgmt_test(struct mgmt_ctxt *);
 static int runtest_mgmt_list(struct mgmt_ctxt *);
+#if MYNEWT_VAL(RUNTEST_BENCH)
+static int runtest_mgmt_bench(struct mgmt_ctxt *);
+#endif
 
 static struct mgmt_group runtest_mgmt_group;
 
 static const struct mgmt_handler runtest_mgmt_handlers[] = {
     [RUNTEST_SMP_OP_TEST] = { NULL, runtest_mgmt_test },
-    [RUNTEST_SMP_OP_LIST] = { runtest_mgmt_list, NULL }
+    [RUNTEST_SMP_OP_LIST] = { runtest_mgmt_list, NULL },
+#if MYNEWT_VAL(RUNTEST_BENCH)
+    [RUNTEST_SMP_OP_BENCH] = { NULL, runtest_mgmt_bench },
+#endif
 };
 
 #define RUNTEST_MGMT_HANDLER_CNT \
@@ -118,6 +125,9 @@ runtest_mgmt_list(struct mgmt_ctxt *mc)
     CborError g_err = CborNoError;
     CborEncoder run_list;
     struct ts_suite *ts;
+#if MYNEWT_VAL(RUNTEST_BENCH)
+    struct tu_bench *tb;
+#endif
 
     g_err |= cbor_encode_text_stringz(&mc->encoder, "rc");
     g_err |= cbor_encode_int(&mc->encoder, MGMT_ERR_EOK);
@@ -132,12 +142,111 @@ runtest_mgmt_list(struct mgmt_ctxt *mc)
 
     g_err |= cbor_encoder_close_container(&mc->encoder, &run_list);
 
+#if MYNEWT_VAL(RUNTEST_BENCH)
+    g_err |= cbor_encode_text_stringz(&mc->encoder, "bench_list");
+    g_err |= cbor_encoder_create_array(&mc->encoder, &run_list,
+                                       CborIndefiniteLength);
+
+    SLIST_FOREACH(tb, &g_tu_benches, tb_next) {
+        g_err |= cbor_encode_text_stringz(&run_list, tb->tb_name);
+    }
+
+    g_err |= cbor_encoder_close_container(&mc->encoder, &run_list);
+#endif
+
     if (g_err) {
         return MGMT_ERR_ENOMEM;
     }
     return (0);
 }
 
+#if MYNEWT_VAL(RUNTEST_BENCH)
+/*
+ * Run a benchmark and reply with its timing:
+ *
+ * { "rc":0, "unit":"cycles", "freq":64000000, "n":100, "min":..,
+ *   "median":.., "p99":.., "max":.. }
+ */
+static int
+runtest_mgmt_bench(struct mgmt_ctxt *mc)
+{
+    char name[MYNEWT_VAL(RUNTEST_MAX_TEST_NAME_LEN)] = "";
+    long long iterations = MYNEWT_VAL(RUNTEST_BENCH_ITERATIONS);
+    long long warmup = MYNEWT_VAL(RUNTEST_BENCH_WARMUP);
+    struct tu_bench_result res;
+    CborError g_err = CborNoError;
+    int rc;
+
+    const struct cbor_attr_t attr[] = {
+        [0] = {
+            .attribute = "name",
+            .type = CborAttrTextStringType,
+            .addr.string = name,
+            .len = sizeof(name)
+        },
+        [1] = {
+            .attribute = "iterations",
+            .type = CborAttrIntegerType,
+            .addr.integer = &iterations
+        },
+        [2] = {
+            .attribute = "warmup",
+            .type = CborAttrIntegerType,
+            .addr.integer = &warmup
+        },
+        [3] = {
+            .attribute = NULL
+        }
+    };
+
+    rc = cbor_read_object(&mc->it, attr);
+    if (rc != 0 || iterations < 0 || iterations > INT_MAX ||
+        warmup < 0 || warmup > INT_MAX) {
+        return MGMT_ERR_EINVAL;
+    }
+
+    rc = runtest_bench(name, warmup, iterations, &res);
+    switch (rc) {
+    case 0:
+        break;
+
+    case SYS_EAGAIN:
+        return MGMT_ERR_EBADSTATE;
+
+    case SYS_ENOENT:
+        return MGMT_ERR_ENOENT;
+
+    case SYS_EINVAL:
+        return MGMT_ERR_EINVAL;
+
+    default:
+        return MGMT_ERR_EUNKNOWN;
+    }
+
+    g_err |= cbor_encode_text_stringz(&mc->encoder, "rc");
+    g_err |= cbor_encode_int(&mc->encoder, MGMT_ERR_EOK);
+    g_err |= cbor_encode_text_stringz(&mc->encoder, "unit");
+    g_err |= cbor_encode_text_stringz(&mc->encoder, tu_bench_unit());
+    g_err |= cbor_encode_text_stringz(&mc->encoder, "freq");
+    g_err |= cbor_encode_uint(&mc->encoder, tu_bench_freq());
+    g_err |= cbor_encode_text_stringz(&mc->encoder, "n");
+    g_err |= cbor_encode_uint(&mc->encoder, res.tbr_n);
+    g_err |= cbor_encode_text_stringz(&mc->encoder, "min");
+    g_err |= cbor_encode_uint(&mc->encoder, res.tbr_min);
+    g_err |= cbor_encode_text_stringz(&mc->encoder, "median");
+    g_err |= cbor_encode_uint(&mc->encoder, res.tbr_median);
+    g_err |= cbor_encode_text_stringz(&mc->encoder, "p99");
+    g_err |= cbor_encode_uint(&mc->encoder, res.tbr_p99);
+    g_err |= cbor_encode_text_stringz(&mc->encoder, "max");
+    g_err |= cbor_encode_uint(&mc->encoder, res.tbr_max);
+
+    if (g_err) {
+        return MGMT_ERR_ENOMEM;
+    }
+    return 0;
+}
+#endif
+
 /*
  * Register mgmt group handlers
  */
@@ -117,6 +117,54 @@ void tu_case_pass_manual(const char *file, int line,
                          const char *format, ...);
 void tu_case_post_test(void);
 
+/*
+ * Self-test case runner; see TESTUTIL_JOBS.  tu_runner_case_begin() returns
+ * nonzero if the case is not to run in the caller: it runs in a worker
+ * process, or it is a plain (non-self) case that cannot run with workers.
+ */
+int tu_runner_case_begin(const char *name, int self);
+void tu_runner_case_end(void);
+
+/*
+ * Benchmarks (TESTUTIL_BENCH).  A benchmark is a function that is timed over
+ * a number of iterations, after some untimed warm-up iterations.  Times are
+ * in CPU cycles where the core has a DWT cycle counter, and in os_cputime
+ * ticks otherwise; tu_bench_unit() and tu_bench_freq() say which.
+ */
+typedef void tu_bench_fn_t(void);
+
+struct tu_bench {
+    SLIST_ENTRY(tu_bench) tb_next;
+    const char *tb_name;
+    tu_bench_fn_t *tb_fn;
+};
+
+SLIST_HEAD(tu_bench_list, tu_bench);
+extern struct tu_bench_list g_tu_benches;
+
+struct tu_bench_result {
+    uint32_t tbr_n;
+    uint32_t tbr_min;
+    uint32_t tbr_median;
+    uint32_t tbr_p99;
+    uint32_t tbr_max;
+};
+
+int tu_bench_register(tu_bench_fn_t *fn, const char *name);
+struct tu_bench *tu_bench_find(const char *name);
+
+/**
+ * Runs a benchmark warmup times untimed, then iterations times timed.
+ *
+ * @return                      0 on success;
+ *                              SYS_EINVAL if iterations is not within
+ *                              1..TESTUTIL_BENCH_MAX_ITERATIONS.
+ */
+int tu_bench_run(const struct tu_bench *tb, int warmup, int iterations,
+                 struct tu_bench_result *res);
+const char *tu_bench_unit(void);
+uint32_t tu_bench_freq(void);
+
 extern struct tu_config tu_config;
 
 extern const char *tu_suite_name;
@@ -134,6 +182,11 @@ extern jmp_buf tu_case_jb;
 #define TEST_SUITE_REGISTER(suite_name)                     \
     tu_suite_register(suite_name, #suite_name);
 
+#define TEST_BENCH(bench_name) void bench_name(void)
+
+#define TEST_BENCH_REGISTER(bench_name)                     \
+    tu_bench_register(bench_name, #bench_name);
+
 #define TEST_SUITE(suite_name)                               \
 void                                                         \
 TEST_SUITE_##suite_name(void);                               \
@@ -160,6 +213,9 @@ TEST_SUITE_##suite_name(void);                               \
     int                                                     \
     case_name(void)                                         \
     {                                                       \
+        if (tu_runner_case_begin(#case_name, do_sysinit)) { \
+            return 0;                                       \
+        }                                                   \
         if (do_sysinit) {                                   \
             sysinit();                                      \
         }                                                   \
@@ -0,0 +1,169 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+#include "testutil_priv.h"
+
+#if MYNEWT_VAL(TESTUTIL_BENCH)
+
+#define TU_BENCH_MAX_ITERATIONS     MYNEWT_VAL(TESTUTIL_BENCH_MAX_ITERATIONS)
+
+struct tu_bench_list g_tu_benches;
+
+/* One sample per timed iteration of the running benchmark. */
+static uint32_t tu_bench_samples[TU_BENCH_MAX_ITERATIONS];
+
+#ifdef DWT_CTRL_CYCCNTENA_Msk
+const char *
+tu_bench_unit(void)
+{
+    return "cycles";
+}
+
+static void
+tu_bench_clock_init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+static inline uint32_t
+tu_bench_now(void)
+{
+    return DWT->CYCCNT;
+}
+
+uint32_t
+tu_bench_freq(void)
+{
+    return SystemCoreClock;
+}
+#else
+const char *
+tu_bench_unit(void)
+{
+    return "cputime";
+}
+
+static void
+tu_bench_clock_init(void)
+{
+}
+
+static inline uint32_t
+tu_bench_now(void)
+{
+    return os_cputime_get32();
+}
+
+uint32_t
+tu_bench_freq(void)
+{
+    return MYNEWT_VAL(OS_CPUTIME_FREQ);
+}
+#endif
+
+int
+tu_bench_register(tu_bench_fn_t *fn, const char *name)
+{
+    struct tu_bench *tb;
+
+    tb = os_malloc(sizeof(*tb));
+    if (!tb) {
+        return -1;
+    }
+    tb->tb_name = name;
+    tb->tb_fn = fn;
+    SLIST_INSERT_HEAD(&g_tu_benches, tb, tb_next);
+    return 0;
+}
+
+struct tu_bench *
+tu_bench_find(const char *name)
+{
+    struct tu_bench *tb;
+
+    SLIST_FOREACH(tb, &g_tu_benches, tb_next) {
+        if (strcmp(tb->tb_name, name) == 0) {
+            return tb;
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * Insertion sort; the samples are mostly in a narrow band, and this keeps
+ * the package free of a qsort() dependency.
+ */
+static void
+tu_bench_sort(uint32_t *v, int n)
+{
+    uint32_t x;
+    int i;
+    int j;
+
+    for (i = 1; i < n; i++) {
+        x = v[i];
+        for (j = i; j > 0 && v[j - 1] > x; j--) {
+            v[j] = v[j - 1];
+        }
+        v[j] = x;
+    }
+}
+
+int
+tu_bench_run(const struct tu_bench *tb, int warmup, int iterations,
+             struct tu_bench_result *res)
+{
+    uint32_t t0;
+    int i;
+
+    if (iterations <= 0 || iterations > TU_BENCH_MAX_ITERATIONS ||
+        warmup < 0) {
+        return SYS_EINVAL;
+    }
+
+    tu_bench_clock_init();
+
+    for (i = 0; i < warmup; i++) {
+        tb->tb_fn();
+    }
+
+    for (i = 0; i < iterations; i++) {
+        t0 = tu_bench_now();
+        tb->tb_fn();
+        tu_bench_samples[i] = tu_bench_now() - t0;
+    }
+
+    tu_bench_sort(tu_bench_samples, iterations);
+
+    res->tbr_n = iterations;
+    res->tbr_min = tu_bench_samples[0];
+    res->tbr_median = tu_bench_samples[iterations / 2];
+    /* Nearest rank: the smallest sample at or above 99% of them */
+    res->tbr_p99 = tu_bench_samples[(iterations * 99 + 99) / 100 - 1];
+    res->tbr_max = tu_bench_samples[iterations - 1];
+
+    return 0;
+}
+
+#endif
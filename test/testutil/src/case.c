@@ -102,6 +102,7 @@ tu_case_complete(void)
 {
     tu_case_idx++;
     tu_case_set_post_test_cb(NULL, NULL);
+    tu_runner_case_end();
 }
 
 void
@@ -0,0 +1,328 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Self-test case runner.
+ *
+ * With TESTUTIL_JOBS set, each self-test case (TEST_CASE_SELF,
+ * TEST_CASE_TASK) runs in a worker process of its own, forked from the test
+ * process, up to TESTUTIL_JOBS at a time.  A case starts from sysinit(), so
+ * a worker only needs the copy of the test process it is forked from; the
+ * sim and the native flash file are its own.  A worker that crashes fails
+ * its case instead of the whole run.
+ *
+ * Plain TEST_CASE cases still run in the test process.  They do not start
+ * from sysinit() and rely on the state earlier cases of their suite left
+ * behind, which with workers stays in the workers; a plain case that follows
+ * a self-test case of the same suite is therefore failed rather than run
+ * against the wrong state.  Such suites need TESTUTIL_JOBS set to 0.
+ *
+ * Workers are waited for and results summed up when the test process
+ * exits, along with the TESTUTIL_SLOWEST slowest cases:
+ *
+ *  [time] 1840 ms nffs_test_suite/nffs_test_gc
+ *  ...
+ *  [done] 52 cases, 0 failed, 2211 ms
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+#include "testutil_priv.h"
+
+#if MYNEWT_VAL(SELFTEST)
+
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+/* Exit status of a worker whose case failed; anything else but 0 is a crash. */
+#define TU_RUNNER_EXIT_FAIL     64
+
+#define TU_RUNNER_JOBS          MYNEWT_VAL(TESTUTIL_JOBS)
+#define TU_RUNNER_SLOWEST       MYNEWT_VAL(TESTUTIL_SLOWEST)
+
+struct tu_runner_case {
+    const char *suite;
+    const char *name;
+    uint64_t start;
+#if TU_RUNNER_JOBS > 0
+    pid_t pid;
+#endif
+};
+
+struct tu_runner_time {
+    const char *suite;
+    const char *name;
+    uint32_t ms;
+};
+
+#if TU_RUNNER_JOBS > 0
+static struct tu_runner_case tu_runner_jobs[TU_RUNNER_JOBS];
+static int tu_runner_worker;
+
+/* Suite of the last case handed to a worker. */
+static const char *tu_runner_forked_suite;
+#endif
+static struct tu_runner_case tu_runner_cur;
+#if TU_RUNNER_SLOWEST > 0
+static struct tu_runner_time tu_runner_slowest[TU_RUNNER_SLOWEST];
+#endif
+static int tu_runner_cases;
+static int tu_runner_failed;
+static uint64_t tu_runner_start;
+
+static uint64_t
+tu_runner_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static void
+tu_runner_record(const struct tu_runner_case *c, int failed)
+{
+#if TU_RUNNER_SLOWEST > 0
+    struct tu_runner_time t;
+    int i;
+
+    t.suite = c->suite;
+    t.name = c->name;
+    t.ms = tu_runner_ms() - c->start;
+
+    /* Insertion into the list, slowest first. */
+    for (i = 0; i < TU_RUNNER_SLOWEST; i++) {
+        if (tu_runner_slowest[i].name == NULL ||
+            t.ms > tu_runner_slowest[i].ms) {
+            memmove(&tu_runner_slowest[i + 1], &tu_runner_slowest[i],
+                    (TU_RUNNER_SLOWEST - i - 1) * sizeof(t));
+            tu_runner_slowest[i] = t;
+            break;
+        }
+    }
+#endif
+
+    tu_runner_cases++;
+    if (failed) {
+        tu_runner_failed++;
+    }
+}
+
+#if TU_RUNNER_JOBS > 0
+/**
+ * Waits for one worker to exit, and records its case.
+ *
+ * @return                      0 if a worker was waited for; -1 if none
+ *                                  are left.
+ */
+static int
+tu_runner_reap(void)
+{
+    struct tu_runner_case *c;
+    pid_t pid;
+    int status;
+    int failed;
+    int i;
+
+    pid = wait(&status);
+    if (pid < 0) {
+        return -1;
+    }
+
+    for (i = 0; i < TU_RUNNER_JOBS; i++) {
+        c = &tu_runner_jobs[i];
+        if (c->pid != pid) {
+            continue;
+        }
+
+        /* A failed case has reported itself already; a crash has not. */
+        failed = 1;
+        if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+            failed = 0;
+        } else if (WIFEXITED(status) &&
+                   WEXITSTATUS(status) == TU_RUNNER_EXIT_FAIL) {
+            /* Nothing to add. */
+        } else if (WIFSIGNALED(status)) {
+            printf("[FAIL] %s/%s worker killed by signal %d\n",
+                   c->suite, c->name, WTERMSIG(status));
+        } else {
+            printf("[FAIL] %s/%s worker exited with status %d\n",
+                   c->suite, c->name, WEXITSTATUS(status));
+        }
+        if (failed) {
+            tu_any_failed = 1;
+        }
+
+        tu_runner_record(c, failed);
+        c->pid = 0;
+        break;
+    }
+
+    return 0;
+}
+
+static struct tu_runner_case *
+tu_runner_slot(void)
+{
+    int i;
+
+    while (1) {
+        for (i = 0; i < TU_RUNNER_JOBS; i++) {
+            if (tu_runner_jobs[i].pid == 0) {
+                return &tu_runner_jobs[i];
+            }
+        }
+        tu_runner_reap();
+    }
+}
+#endif
+
+static void
+tu_runner_finish(void)
+{
+#if TU_RUNNER_SLOWEST > 0
+    const struct tu_runner_time *t;
+    int i;
+#endif
+
+#if TU_RUNNER_JOBS > 0
+    if (tu_runner_worker) {
+        return;
+    }
+    while (tu_runner_reap() == 0) {
+    }
+#endif
+
+#if TU_RUNNER_SLOWEST > 0
+    for (i = 0; i < TU_RUNNER_SLOWEST; i++) {
+        t = &tu_runner_slowest[i];
+        if (t->name == NULL) {
+            break;
+        }
+        printf("[time] %lu ms %s/%s\n", (unsigned long)t->ms, t->suite,
+               t->name);
+    }
+#endif
+    printf("[done] %d cases, %d failed, %lu ms\n", tu_runner_cases,
+           tu_runner_failed, (unsigned long)(tu_runner_ms() - tu_runner_start));
+    fflush(stdout);
+
+    /* main() returned before the workers' failures were known. */
+    if (tu_any_failed) {
+        _exit(1);
+    }
+}
+
+int
+tu_runner_case_begin(const char *name, int self)
+{
+#if TU_RUNNER_JOBS > 0
+    struct tu_runner_case *c;
+    pid_t pid;
+#endif
+
+    if (tu_runner_start == 0) {
+        tu_runner_start = tu_runner_ms();
+        atexit(tu_runner_finish);
+    }
+
+    if (!self) {
+#if TU_RUNNER_JOBS > 0
+        if (!tu_runner_worker &&
+            tu_runner_forked_suite == tu_config.ts_suite_name) {
+
+            printf("[FAIL] %s/%s plain TEST_CASE after self-test cases; "
+                   "run this suite with TESTUTIL_JOBS: 0\n",
+                   tu_config.ts_suite_name, name);
+            tu_any_failed = 1;
+            tu_runner_cases++;
+            tu_runner_failed++;
+            return 1;
+        }
+#endif
+        return 0;
+    }
+
+    tu_runner_cur.suite = tu_config.ts_suite_name;
+    tu_runner_cur.name = name;
+    tu_runner_cur.start = tu_runner_ms();
+
+#if TU_RUNNER_JOBS > 0
+    c = tu_runner_slot();
+    tu_runner_forked_suite = tu_config.ts_suite_name;
+
+    /* Output still buffered would be written by both processes. */
+    fflush(NULL);
+    pid = fork();
+    if (pid == 0) {
+        tu_runner_worker = 1;
+        return 0;
+    }
+    if (pid < 0) {
+        /* No worker; run the case here instead. */
+        return 0;
+    }
+
+    *c = tu_runner_cur;
+    c->pid = pid;
+    tu_runner_cur.name = NULL;
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+void
+tu_runner_case_end(void)
+{
+    if (tu_runner_cur.name == NULL) {
+        /* Not a self-test case. */
+        return;
+    }
+
+#if TU_RUNNER_JOBS > 0
+    if (tu_runner_worker) {
+        fflush(NULL);
+        _exit(tu_case_failed ? TU_RUNNER_EXIT_FAIL : 0);
+    }
+#endif
+
+    tu_runner_record(&tu_runner_cur, tu_case_failed);
+    tu_runner_cur.name = NULL;
+}
+
+#else
+
+int
+tu_runner_case_begin(const char *name, int self)
+{
+    return 0;
+}
+
+void
+tu_runner_case_end(void)
+{
+}
+
+#endif
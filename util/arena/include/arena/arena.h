@@ -0,0 +1,143 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef H_ARENA_
+#define H_ARENA_
+
+#include <inttypes.h>
+#include <stddef.h>
+#include "os/mynewt.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Bump-pointer region allocator.
+ *
+ * Memory is handed out by advancing an offset into the current chunk and is
+ * never freed individually; arena_reset() releases everything at once.  This
+ * suits objects whose lifetime is bounded by a single request.
+ *
+ * An arena is backed either by a caller-supplied buffer (arena_init()) or by
+ * mbufs (arena_init_mbuf()).  An mbuf-backed arena takes no memory until its
+ * first allocation and grows one mbuf at a time; each mbuf's om_len records
+ * how much of it is in use.  A single allocation cannot exceed the size of
+ * one chunk.
+ *
+ * All struct fields should be considered private.
+ */
+struct arena {
+    /** Start of the current chunk; NULL if there is none yet. */
+    uint8_t *a_base;
+    /** Size of the current chunk, in bytes. */
+    uint16_t a_size;
+    /** Bytes allocated from the current chunk. */
+    uint16_t a_used;
+
+    /** Pool that mbuf chunks come from; NULL for msys. */
+    struct os_mbuf_pool *a_omp;
+    /** First mbuf chunk; NULL for a buffer-backed arena. */
+    struct os_mbuf *a_head;
+    /** Mbuf chunk being allocated from. */
+    struct os_mbuf *a_cur;
+    /** Whether the arena is backed by mbufs. */
+    uint8_t a_mbuf;
+};
+
+/**
+ * @brief Initializes an arena backed by a flat buffer.
+ *
+ * @param arena                 The arena to initialize.
+ * @param buf                   The memory to allocate from.
+ * @param size                  The size of buf, in bytes.
+ */
+void arena_init(struct arena *arena, void *buf, uint16_t size);
+
+/**
+ * @brief Initializes an arena backed by a chain of mbufs.
+ *
+ * @param arena                 The arena to initialize.
+ * @param omp                   The mbuf pool to take chunks from; NULL to
+ *                                  use msys.
+ */
+void arena_init_mbuf(struct arena *arena, struct os_mbuf_pool *omp);
+
+/**
+ * @brief Allocates memory from an arena.
+ *
+ * The memory is aligned to OS_ALIGNMENT and remains valid until the arena is
+ * reset.
+ *
+ * @param arena                 The arena to allocate from.
+ * @param size                  The number of bytes to allocate.
+ *
+ * @return                      The allocated memory on success;
+ *                              NULL if the arena is exhausted.
+ */
+void *arena_alloc(struct arena *arena, size_t size);
+
+/**
+ * @brief Allocates zeroed memory from an arena.
+ *
+ * @param arena                 The arena to allocate from.
+ * @param size                  The number of bytes to allocate.
+ *
+ * @return                      The allocated memory on success;
+ *                              NULL if the arena is exhausted.
+ */
+void *arena_zalloc(struct arena *arena, size_t size);
+
+/**
+ * @brief Copies a NUL-terminated string into an arena.
+ *
+ * @param arena                 The arena to allocate from.
+ * @param str                   The string to copy.
+ *
+ * @return                      The copy on success;
+ *                              NULL if the arena is exhausted.
+ */
+char *arena_strdup(struct arena *arena, const char *str);
+
+/**
+ * @brief Indicates whether memory was allocated from an arena.
+ *
+ * @param arena                 The arena to check.
+ * @param ptr                   The pointer to look up.
+ *
+ * @return                      1 if ptr lies in one of the arena's chunks;
+ *                              0 otherwise.
+ */
+int arena_contains(const struct arena *arena, const void *ptr);
+
+/**
+ * @brief Releases everything allocated from an arena.
+ *
+ * A buffer-backed arena is rewound in constant time.  An mbuf-backed arena
+ * returns its chunks to their pool.  The arena can be reused afterwards.
+ *
+ * @param arena                 The arena to reset.
+ */
+void arena_reset(struct arena *arena);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,58 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "arena/arena.h"
+#include "arena_test.h"
+
+TEST_CASE_SELF(arena_test_case_buf)
+{
+    struct arena arena;
+    uint32_t buf[16];
+    uint8_t *p1;
+    uint8_t *p2;
+    char *str;
+
+    arena_init(&arena, buf, sizeof buf);
+
+    /* Allocations are aligned and do not overlap. */
+    p1 = arena_alloc(&arena, 3);
+    TEST_ASSERT_FATAL(p1 != NULL);
+    p2 = arena_alloc(&arena, 8);
+    TEST_ASSERT_FATAL(p2 != NULL);
+    TEST_ASSERT((uintptr_t)p2 % OS_ALIGNMENT == 0);
+    TEST_ASSERT(p2 >= p1 + 3);
+
+    TEST_ASSERT(arena_contains(&arena, p1));
+    TEST_ASSERT(arena_contains(&arena, p2 + 7));
+    TEST_ASSERT(!arena_contains(&arena, &arena));
+
+    str = arena_strdup(&arena, "arena");
+    TEST_ASSERT_FATAL(str != NULL);
+    TEST_ASSERT(strcmp(str, "arena") == 0);
+
+    /* Exhaustion. */
+    TEST_ASSERT(arena_alloc(&arena, sizeof buf) == NULL);
+
+    /* Reset rewinds to the start of the buffer. */
+    arena_reset(&arena);
+    TEST_ASSERT(arena_alloc(&arena, 3) == p1);
+    TEST_ASSERT(arena_alloc(&arena, sizeof buf - 4) != NULL);
+    TEST_ASSERT(arena_alloc(&arena, 1) == NULL);
+}
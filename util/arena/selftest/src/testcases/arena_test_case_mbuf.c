@@ -0,0 +1,79 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "arena/arena.h"
+#include "arena_test.h"
+
+#define ARENA_TEST_MBUF_SIZE    128
+#define ARENA_TEST_MBUF_COUNT   4
+
+static os_membuf_t arena_test_mbuf_mem[
+    OS_MEMPOOL_SIZE(ARENA_TEST_MBUF_COUNT, ARENA_TEST_MBUF_SIZE)];
+static struct os_mempool arena_test_mempool;
+static struct os_mbuf_pool arena_test_mbuf_pool;
+
+TEST_CASE_SELF(arena_test_case_mbuf)
+{
+    struct arena arena;
+    uint8_t *first;
+    uint8_t *p;
+    int rc;
+    int i;
+
+    rc = os_mempool_init(&arena_test_mempool, ARENA_TEST_MBUF_COUNT,
+                         ARENA_TEST_MBUF_SIZE, arena_test_mbuf_mem,
+                         "arena_test");
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = os_mbuf_pool_init(&arena_test_mbuf_pool, &arena_test_mempool,
+                           ARENA_TEST_MBUF_SIZE, ARENA_TEST_MBUF_COUNT);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    arena_init_mbuf(&arena, &arena_test_mbuf_pool);
+
+    /* No memory is taken until the first allocation. */
+    TEST_ASSERT(arena_test_mempool.mp_num_free == ARENA_TEST_MBUF_COUNT);
+
+    first = arena_alloc(&arena, 16);
+    TEST_ASSERT_FATAL(first != NULL);
+    TEST_ASSERT(arena_test_mempool.mp_num_free == ARENA_TEST_MBUF_COUNT - 1);
+
+    /* Two 64-byte objects do not fit in one chunk, so this takes them all. */
+    for (i = 0; i < ARENA_TEST_MBUF_COUNT; i++) {
+        p = arena_alloc(&arena, 64);
+        TEST_ASSERT_FATAL(p != NULL);
+        TEST_ASSERT(arena_contains(&arena, p));
+    }
+    TEST_ASSERT(arena_test_mempool.mp_num_free == 0);
+    TEST_ASSERT(arena_contains(&arena, first));
+
+    /* Larger than a chunk. */
+    TEST_ASSERT(arena_alloc(&arena, ARENA_TEST_MBUF_SIZE) == NULL);
+
+    /* Reset gives all chunks back. */
+    arena_reset(&arena);
+    TEST_ASSERT(arena_test_mempool.mp_num_free == ARENA_TEST_MBUF_COUNT);
+    TEST_ASSERT(!arena_contains(&arena, first));
+
+    p = arena_zalloc(&arena, 8);
+    TEST_ASSERT_FATAL(p != NULL);
+    for (i = 0; i < 8; i++) {
+        TEST_ASSERT(p[i] == 0);
+    }
+    arena_reset(&arena);
+}
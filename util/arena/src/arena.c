@@ -0,0 +1,175 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "os/mynewt.h"
+#include "arena/arena.h"
+
+void
+arena_init(struct arena *arena, void *buf, uint16_t size)
+{
+    uintptr_t start;
+    uint16_t pad;
+
+    memset(arena, 0, sizeof *arena);
+
+    start = (uintptr_t)buf;
+    pad = OS_ALIGN(start, OS_ALIGNMENT) - start;
+    if (pad > size) {
+        pad = size;
+    }
+
+    arena->a_base = (uint8_t *)buf + pad;
+    arena->a_size = size - pad;
+}
+
+void
+arena_init_mbuf(struct arena *arena, struct os_mbuf_pool *omp)
+{
+    memset(arena, 0, sizeof *arena);
+    arena->a_omp = omp;
+    arena->a_mbuf = 1;
+}
+
+/**
+ * Makes a new mbuf the current chunk of an mbuf-backed arena.
+ */
+static int
+arena_grow(struct arena *arena)
+{
+    struct os_mbuf *om;
+
+    if (arena->a_omp != NULL) {
+        om = os_mbuf_get(arena->a_omp, 0);
+    } else {
+        om = os_msys_get(0, 0);
+    }
+    if (om == NULL) {
+        return SYS_ENOMEM;
+    }
+
+    if (arena->a_cur != NULL) {
+        arena->a_cur->om_len = arena->a_used;
+        SLIST_NEXT(arena->a_cur, om_next) = om;
+    } else {
+        arena->a_head = om;
+    }
+    arena->a_cur = om;
+
+    /* om_databuf is aligned as the mbuf header is. */
+    arena->a_base = om->om_data;
+    arena->a_size = OS_MBUF_TRAILINGSPACE(om);
+    arena->a_used = 0;
+
+    return 0;
+}
+
+void *
+arena_alloc(struct arena *arena, size_t size)
+{
+    uint8_t *ptr;
+    size_t off;
+
+    size = OS_ALIGN(size, OS_ALIGNMENT);
+
+    off = arena->a_used;
+    if (arena->a_base == NULL || off + size > arena->a_size) {
+        if (!arena->a_mbuf) {
+            return NULL;
+        }
+        if (arena_grow(arena) != 0) {
+            return NULL;
+        }
+        off = 0;
+        if (size > arena->a_size) {
+            return NULL;
+        }
+    }
+
+    ptr = arena->a_base + off;
+    arena->a_used = off + size;
+    if (arena->a_cur != NULL) {
+        arena->a_cur->om_len = arena->a_used;
+    }
+
+    return ptr;
+}
+
+void *
+arena_zalloc(struct arena *arena, size_t size)
+{
+    void *ptr;
+
+    ptr = arena_alloc(arena, size);
+    if (ptr != NULL) {
+        memset(ptr, 0, size);
+    }
+
+    return ptr;
+}
+
+char *
+arena_strdup(struct arena *arena, const char *str)
+{
+    size_t len;
+    char *dup;
+
+    len = strlen(str) + 1;
+    dup = arena_alloc(arena, len);
+    if (dup != NULL) {
+        memcpy(dup, str, len);
+    }
+
+    return dup;
+}
+
+int
+arena_contains(const struct arena *arena, const void *ptr)
+{
+    const struct os_mbuf *om;
+    const uint8_t *p;
+
+    p = ptr;
+    if (!arena->a_mbuf) {
+        return arena->a_base != NULL && p >= arena->a_base &&
+               p < arena->a_base + arena->a_size;
+    }
+
+    for (om = arena->a_head; om != NULL; om = SLIST_NEXT(om, om_next)) {
+        if (p >= om->om_data && p < om->om_data + om->om_len) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+void
+arena_reset(struct arena *arena)
+{
+    if (arena->a_mbuf) {
+        os_mbuf_free_chain(arena->a_head);
+        arena->a_head = NULL;
+        arena->a_cur = NULL;
+        arena->a_base = NULL;
+        arena->a_size = 0;
+    }
+
+    arena->a_used = 0;
+}
@@ -0,0 +1,126 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "cbmem_test/cbmem_test.h"
+
+#if MYNEWT_VAL(CBMEM_LOCKLESS_READ)
+static uint8_t cbmem_test_range_buf[3 * CBMEM1_ENTRY_SIZE];
+
+/*
+ * Reads the rest of cbmem1 through the cursor, checking that the entries
+ * are whole and numbered consecutively from *first.  Returns the count.
+ */
+static int
+cbmem_test_case_4_drain(struct cbmem_cursor *cur, uint8_t *first)
+{
+    struct cbmem_entry_hdr *hdr;
+    uint8_t *p;
+    int cnt;
+    int rc;
+
+    cnt = 0;
+    while (1) {
+        rc = cbmem_read_range(&cbmem1, cur, cbmem_test_range_buf,
+                              sizeof(cbmem_test_range_buf));
+        TEST_ASSERT_FATAL(rc >= 0, "cbmem_read_range failed; rc=%d", rc);
+        if (rc == 0) {
+            break;
+        }
+
+        for (p = cbmem_test_range_buf; p < cbmem_test_range_buf + rc;
+             p += CBMEM_ENTRY_SIZE(hdr)) {
+            hdr = (struct cbmem_entry_hdr *) p;
+            TEST_ASSERT_FATAL(hdr->ceh_len == CBMEM1_ENTRY_SIZE);
+            TEST_ASSERT_FATAL(p[sizeof(*hdr)] == *first,
+                    "Expected entry %d, got %d", *first, p[sizeof(*hdr)]);
+            (*first)++;
+            cnt++;
+        }
+        TEST_ASSERT(p == cbmem_test_range_buf + rc);
+    }
+
+    return cnt;
+}
+#endif
+
+TEST_CASE(cbmem_test_case_4)
+{
+#if MYNEWT_VAL(CBMEM_LOCKLESS_READ)
+    struct cbmem_entry_hdr *hdr;
+    struct cbmem_cursor cur;
+    struct cbmem_iter iter;
+    uint8_t first;
+    int cnt;
+    int rc;
+    int i;
+
+    cbmem_iter_start(&cbmem1, &iter);
+    hdr = cbmem_iter_next(&cbmem1, &iter);
+    TEST_ASSERT_FATAL(hdr != NULL);
+    first = ((uint8_t *) hdr)[sizeof(*hdr)];
+
+    /* Bulk read-out matches the iterator, including across the wrap. */
+    cnt = 1;
+    while (cbmem_iter_next(&cbmem1, &iter) != NULL) {
+        cnt++;
+    }
+    cbmem_cursor_start(&cbmem1, &cur);
+    TEST_ASSERT(cbmem_test_case_4_drain(&cur, &first) == cnt);
+    TEST_ASSERT(cur.cc_overruns == 0);
+
+    /* A caught-up cursor picks up new entries. */
+    cbmem1_entry[0] = first;
+    rc = cbmem_append(&cbmem1, cbmem1_entry, sizeof(cbmem1_entry));
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(cbmem_test_case_4_drain(&cur, &first) == 1);
+
+    /* Too small a buffer for a single entry is an error. */
+    cbmem1_entry[0] = first;
+    rc = cbmem_append(&cbmem1, cbmem1_entry, sizeof(cbmem1_entry));
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = cbmem_read_range(&cbmem1, &cur, cbmem_test_range_buf,
+                          CBMEM1_ENTRY_SIZE);
+    TEST_ASSERT(rc == -1);
+
+    /* Once the writer laps the cursor, reading restarts at the oldest
+     * entry and the overrun is counted.
+     */
+    for (i = 1; i <= CBMEM1_ENTRY_COUNT; i++) {
+        cbmem1_entry[0] = first + i;
+        rc = cbmem_append(&cbmem1, cbmem1_entry, sizeof(cbmem1_entry));
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+    cbmem_iter_start(&cbmem1, &iter);
+    hdr = cbmem_iter_next(&cbmem1, &iter);
+    first = ((uint8_t *) hdr)[sizeof(*hdr)];
+    cnt = cbmem_test_case_4_drain(&cur, &first);
+    TEST_ASSERT(cur.cc_overruns == 1);
+    TEST_ASSERT(cnt == CBMEM1_ENTRY_COUNT - 1);
+
+    /* Flushing invalidates outstanding cursors too. */
+    cbmem_cursor_start(&cbmem1, &cur);
+    cbmem_flush(&cbmem1);
+    cbmem1_entry[0] = 0;
+    rc = cbmem_append(&cbmem1, cbmem1_entry, sizeof(cbmem1_entry));
+    TEST_ASSERT_FATAL(rc == 0);
+    first = 0;
+    TEST_ASSERT(cbmem_test_case_4_drain(&cur, &first) == 1);
+    TEST_ASSERT(cur.cc_overruns == 1);
+#endif
+}
@@ -30,6 +30,9 @@ struct cbmem_entry_hdr {
     uint16_t ceh_flags;
 } __attribute__((packed));
 
+/** Marks the unused tail of the buffer left behind by a wrap. */
+#define CBMEM_ENTRY_F_WRAP      0x0001
+
 struct cbmem {
     struct os_mutex c_lock;
 
@@ -38,6 +41,16 @@ struct cbmem {
     uint8_t *c_buf;
     uint8_t *c_buf_end;
     uint8_t *c_buf_cur_end;
+
+#if MYNEWT_VAL(CBMEM_LOCKLESS_READ)
+    /* Logical byte positions, counting across wraps, of the oldest entry,
+     * of the next append and of the start of the current lap.  Only
+     * appenders change these; readers compare against them.
+     */
+    uint32_t c_start_pos;
+    uint32_t c_end_pos;
+    uint32_t c_lap_pos;
+#endif
 };
 
 struct cbmem_iter {
@@ -46,6 +59,19 @@ struct cbmem_iter {
     struct cbmem_entry_hdr *ci_end;
 };
 
+#if MYNEWT_VAL(CBMEM_LOCKLESS_READ)
+/**
+ * Read position for cbmem_read_range().  Unlike cbmem_iter, a cursor stays
+ * usable while entries are appended; if appends overwrite the entries under
+ * it, the next read restarts at the oldest entry and counts an overrun.
+ */
+struct cbmem_cursor {
+    uint32_t cc_pos;
+    uint32_t cc_off;
+    uint32_t cc_overruns;
+};
+#endif
+
 /**
  * An individual data chunk within a scatter-gather write.  An entry can point
  * to a flat buffer or an mbuf, but not both.
@@ -101,6 +127,46 @@ int cbmem_read_mbuf(struct cbmem *cbmem, struct cbmem_entry_hdr *hdr,
                     struct os_mbuf *om, uint16_t off, uint16_t len);
 int cbmem_walk(struct cbmem *cbmem, cbmem_walk_func_t walk_func, void *arg);
 
+#if MYNEWT_VAL(CBMEM_LOCKLESS_READ)
+/**
+ * @brief Points a cursor at the oldest entry in the cbmem.
+ *
+ * @param cbmem                 The cbmem to read from.
+ * @param cur                   The cursor to initialize.
+ */
+void cbmem_cursor_start(struct cbmem *cbmem, struct cbmem_cursor *cur);
+
+/**
+ * @brief Copies as many whole entries as fit into a flat buffer.
+ *
+ * Entries are copied as stored: a struct cbmem_entry_hdr followed by
+ * ceh_len bytes of data, back to back.  The cbmem lock is not held while
+ * copying, so appenders are not held up by the read.
+ *
+ * @param cbmem                 The cbmem to read from.
+ * @param cur                   Where to start; advanced past what was copied.
+ * @param buf                   The buffer to fill.
+ * @param len                   The size of buf.
+ *
+ * @return                      The number of bytes copied, 0 when there are
+ *                                  no more entries, -1 if the next entry
+ *                                  alone does not fit in buf.
+ */
+int cbmem_read_range(struct cbmem *cbmem, struct cbmem_cursor *cur,
+                     void *buf, uint32_t len);
+
+/**
+ * @brief Appends as many whole entries as fit in max_len to an mbuf chain.
+ *
+ * Same as cbmem_read_range(), but the entries are appended to om.
+ *
+ * @return                      The number of bytes appended, 0 when there are
+ *                                  no more entries, -1 on failure.
+ */
+int cbmem_read_range_mbuf(struct cbmem *cbmem, struct cbmem_cursor *cur,
+                          struct os_mbuf *om, uint32_t max_len);
+#endif
+
 int cbmem_flush(struct cbmem *);
 
 #ifdef __cplusplus
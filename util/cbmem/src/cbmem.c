@@ -81,6 +81,12 @@ cbmem_append_internal(struct cbmem *cbmem, const void *data, uint16_t len,
     struct cbmem_entry_hdr *dst;
     uint8_t *start;
     uint8_t *end;
+#if MYNEWT_VAL(CBMEM_LOCKLESS_READ)
+    struct cbmem_entry_hdr *wrap;
+    uint32_t start_pos;
+    uint32_t prev_lap;
+    uint32_t pos;
+#endif
     int rc;
 
     rc = cbmem_lock_acquire(cbmem);
@@ -95,15 +101,35 @@ cbmem_append_internal(struct cbmem *cbmem, const void *data, uint16_t len,
     }
     end = (uint8_t *) dst + len + sizeof(*dst);
 
+#if MYNEWT_VAL(CBMEM_LOCKLESS_READ)
+    wrap = NULL;
+    pos = cbmem->c_end_pos;
+    start_pos = cbmem->c_start_pos;
+#endif
+
     /* If this item would take us past the end of this buffer, then adjust
      * the item to the beginning of the buffer.
      */
     if (end > cbmem->c_buf_end) {
+#if MYNEWT_VAL(CBMEM_LOCKLESS_READ)
+        /* Leave a marker so that readers know where this lap ends; without
+         * room for one they wrap on their own.
+         */
+        if ((uint8_t *) dst + sizeof(*dst) <= cbmem->c_buf_end) {
+            wrap = dst;
+        }
+        pos += cbmem->c_buf_end - (uint8_t *) dst;
+        prev_lap = cbmem->c_lap_pos;
+        cbmem->c_lap_pos = pos;
+#endif
         cbmem->c_buf_cur_end = (uint8_t *) dst;
         dst = (struct cbmem_entry_hdr *) cbmem->c_buf;
         end = (uint8_t *) dst + len + sizeof(*dst);
         if ((uint8_t *) cbmem->c_entry_start >= cbmem->c_buf_cur_end) {
             cbmem->c_entry_start = (struct cbmem_entry_hdr *) cbmem->c_buf;
+#if MYNEWT_VAL(CBMEM_LOCKLESS_READ)
+            start_pos = prev_lap;
+#endif
         }
     }
 
@@ -115,20 +141,48 @@ cbmem_append_internal(struct cbmem *cbmem, const void *data, uint16_t len,
     if (start && (uint8_t *) dst < start + CBMEM_ENTRY_SIZE(start) &&
             end > start) {
         while (start < end) {
+#if MYNEWT_VAL(CBMEM_LOCKLESS_READ)
+            start_pos += CBMEM_ENTRY_SIZE(start);
+#endif
             start = (uint8_t *) CBMEM_ENTRY_NEXT(start);
             if (start == cbmem->c_buf_cur_end) {
                 start = cbmem->c_buf;
+#if MYNEWT_VAL(CBMEM_LOCKLESS_READ)
+                start_pos = cbmem->c_lap_pos;
+#endif
                 break;
             }
         }
         cbmem->c_entry_start = (struct cbmem_entry_hdr *) start;
     }
 
+#if MYNEWT_VAL(CBMEM_LOCKLESS_READ)
+    /* Readers check the start position after copying an entry out, so it
+     * has to move past everything we are about to overwrite first.
+     */
+    if (!cbmem->c_entry_start) {
+        start_pos = pos;
+    }
+    __atomic_store_n(&cbmem->c_start_pos, start_pos, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    if (wrap != NULL) {
+        wrap->ceh_len = 0;
+        wrap->ceh_flags = CBMEM_ENTRY_F_WRAP;
+    }
+    dst->ceh_flags = 0;
+#endif
+
     /* Copy the entry into the log
      */
     dst->ceh_len = len;
     copy_func((uint8_t *) dst + sizeof(*dst), data, len);
 
+#if MYNEWT_VAL(CBMEM_LOCKLESS_READ)
+    __atomic_store_n(&cbmem->c_end_pos, pos + sizeof(*dst) + len,
+                     __ATOMIC_RELEASE);
+#endif
+
     cbmem->c_entry_end = dst;
     if (!cbmem->c_entry_start) {
         cbmem->c_entry_start = dst;
@@ -264,6 +318,10 @@ err:
 int
 cbmem_flush(struct cbmem *cbmem)
 {
+#if MYNEWT_VAL(CBMEM_LOCKLESS_READ)
+    uint8_t *next;
+    uint32_t pos;
+#endif
     int rc;
 
     rc = cbmem_lock_acquire(cbmem);
@@ -271,6 +329,19 @@ cbmem_flush(struct cbmem *cbmem)
         goto err;
     }
 
+#if MYNEWT_VAL(CBMEM_LOCKLESS_READ)
+    /* The next append goes to the start of the buffer; treat that as a new
+     * lap so that outstanding cursors see everything as overwritten.
+     */
+    if (cbmem->c_entry_end) {
+        next = (uint8_t *) CBMEM_ENTRY_NEXT(cbmem->c_entry_end);
+        pos = cbmem->c_end_pos + (cbmem->c_buf_end - next);
+        cbmem->c_lap_pos = pos;
+        __atomic_store_n(&cbmem->c_start_pos, pos, __ATOMIC_RELAXED);
+        __atomic_store_n(&cbmem->c_end_pos, pos, __ATOMIC_RELEASE);
+    }
+#endif
+
     cbmem->c_entry_start = NULL;
     cbmem->c_entry_end = NULL;
     cbmem->c_buf_cur_end = NULL;
@@ -392,3 +463,137 @@ cbmem_walk(struct cbmem *cbmem, cbmem_walk_func_t walk_func, void *arg)
 err:
     return (rc);
 }
+
+#if MYNEWT_VAL(CBMEM_LOCKLESS_READ)
+void
+cbmem_cursor_start(struct cbmem *cbmem, struct cbmem_cursor *cur)
+{
+    cbmem_lock_acquire(cbmem);
+
+    if (cbmem->c_entry_start) {
+        cur->cc_pos = cbmem->c_start_pos;
+        cur->cc_off = (uint8_t *) cbmem->c_entry_start - cbmem->c_buf;
+    } else {
+        cur->cc_pos = cbmem->c_end_pos;
+        cur->cc_off = 0;
+    }
+    cur->cc_overruns = 0;
+
+    cbmem_lock_release(cbmem);
+}
+
+/**
+ * Checks whether what was just read at the cursor can still be trusted,
+ * i.e. whether appenders have not yet moved the oldest entry past it.
+ */
+static int
+cbmem_cursor_valid(struct cbmem *cbmem, const struct cbmem_cursor *cur)
+{
+    uint32_t start_pos;
+
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    start_pos = __atomic_load_n(&cbmem->c_start_pos, __ATOMIC_RELAXED);
+
+    return (int32_t) (cur->cc_pos - start_pos) >= 0;
+}
+
+static void
+cbmem_cursor_resync(struct cbmem *cbmem, struct cbmem_cursor *cur)
+{
+    uint32_t overruns;
+
+    overruns = cur->cc_overruns;
+    cbmem_cursor_start(cbmem, cur);
+    cur->cc_overruns = overruns + 1;
+}
+
+static int
+cbmem_read_range_internal(struct cbmem *cbmem, struct cbmem_cursor *cur,
+                          uint8_t *buf, struct os_mbuf *om, uint32_t max_len)
+{
+    struct cbmem_entry_hdr hdr;
+    uint32_t buf_len;
+    uint32_t size;
+    uint32_t end;
+    uint32_t cnt;
+    int rc;
+
+    buf_len = cbmem->c_buf_end - cbmem->c_buf;
+    cnt = 0;
+
+    while (1) {
+        end = __atomic_load_n(&cbmem->c_end_pos, __ATOMIC_ACQUIRE);
+        if (cur->cc_pos == end) {
+            break;
+        }
+
+        if (cur->cc_off + sizeof(hdr) > buf_len) {
+            cur->cc_pos += buf_len - cur->cc_off;
+            cur->cc_off = 0;
+            continue;
+        }
+
+        memcpy(&hdr, cbmem->c_buf + cur->cc_off, sizeof(hdr));
+        if (!cbmem_cursor_valid(cbmem, cur)) {
+            cbmem_cursor_resync(cbmem, cur);
+            continue;
+        }
+
+        if (hdr.ceh_flags & CBMEM_ENTRY_F_WRAP) {
+            cur->cc_pos += buf_len - cur->cc_off;
+            cur->cc_off = 0;
+            continue;
+        }
+
+        size = sizeof(hdr) + hdr.ceh_len;
+        if (cur->cc_off + size > buf_len) {
+            /* Not a header we wrote; the cursor must be stale. */
+            cbmem_cursor_resync(cbmem, cur);
+            continue;
+        }
+        if (cnt + size > max_len) {
+            if (cnt == 0) {
+                return (-1);
+            }
+            break;
+        }
+
+        if (om != NULL) {
+            rc = os_mbuf_append(om, cbmem->c_buf + cur->cc_off, size);
+            if (rc != 0) {
+                return (cnt != 0 ? cnt : -1);
+            }
+        } else {
+            memcpy(buf + cnt, cbmem->c_buf + cur->cc_off, size);
+        }
+
+        if (!cbmem_cursor_valid(cbmem, cur)) {
+            if (om != NULL) {
+                os_mbuf_adj(om, -(int) size);
+            }
+            cbmem_cursor_resync(cbmem, cur);
+            continue;
+        }
+
+        cnt += size;
+        cur->cc_pos += size;
+        cur->cc_off += size;
+    }
+
+    return (cnt);
+}
+
+int
+cbmem_read_range(struct cbmem *cbmem, struct cbmem_cursor *cur,
+                 void *buf, uint32_t len)
+{
+    return cbmem_read_range_internal(cbmem, cur, buf, NULL, len);
+}
+
+int
+cbmem_read_range_mbuf(struct cbmem *cbmem, struct cbmem_cursor *cur,
+                      struct os_mbuf *om, uint32_t max_len)
+{
+    return cbmem_read_range_internal(cbmem, cur, NULL, om, max_len);
+}
+#endif
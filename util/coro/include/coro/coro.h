@@ -0,0 +1,223 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef H_CORO_
+#define H_CORO_
+
+#include <inttypes.h>
+#include "os/mynewt.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file coro.h
+ * @brief Stackless coroutines driven by an event queue.
+ *
+ * A coroutine is a function that can suspend in the middle of its body and
+ * later continue where it left off, without a stack of its own.  Every
+ * time it is resumed the function is called again from the event queue
+ * and jumps to the point where it suspended (protothread style).  Any
+ * number of coroutines can share the task that runs the event queue.
+ *
+ * Local variables do not survive a suspension; keep state in a structure
+ * reached through coro_arg().  Suspension points may not be used inside a
+ * switch statement of the coroutine body.
+ *
+ * Example:
+ *
+ *     static int
+ *     blink(struct coro *c)
+ *     {
+ *         CORO_BEGIN(c);
+ *         while (1) {
+ *             hal_gpio_toggle(LED);
+ *             CORO_SLEEP(c, OS_TICKS_PER_SEC);
+ *         }
+ *         CORO_END(c);
+ *     }
+ */
+
+/** Returned by a coroutine that suspended. */
+#define CORO_WAITING    0
+/** Returned by a coroutine that ran to completion. */
+#define CORO_DONE       1
+
+struct coro;
+
+/**
+ * @brief A coroutine body.
+ *
+ * @param c                     The coroutine being run.
+ *
+ * @return                      CORO_WAITING or CORO_DONE; use the CORO_*
+ *                                  macros rather than returning directly.
+ */
+typedef int coro_fn(struct coro *c);
+
+/**
+ * @brief Coroutine state.  All fields should be considered private.
+ */
+struct coro {
+    /** Posted to the event queue to resume the coroutine. */
+    struct os_event c_ev;
+    /** Resumes the coroutine after a sleep or poll interval. */
+    struct os_callout c_timer;
+    coro_fn *c_fn;
+    void *c_arg;
+    /** Where to continue in c_fn; 0 means the beginning. */
+    uint16_t c_lc;
+    uint8_t c_done;
+};
+
+/**
+ * @brief Initializes a coroutine.
+ *
+ * @param c                     The coroutine to initialize.
+ * @param evq                   The event queue that resumes the coroutine;
+ *                                  the body runs in the context of the task
+ *                                  that processes this queue.
+ * @param fn                    The coroutine body.
+ * @param arg                   Argument made available via coro_arg().
+ */
+void coro_init(struct coro *c, struct os_eventq *evq, coro_fn *fn,
+               void *arg);
+
+/**
+ * @brief Schedules a coroutine to run from the beginning.
+ *
+ * @param c                     The coroutine to start.
+ */
+void coro_start(struct coro *c);
+
+/**
+ * @brief Resumes a suspended coroutine.
+ *
+ * Safe to call from interrupt context, e.g., from a bus or DMA completion
+ * handler.  Waking a coroutine that is not suspended in CORO_WAIT() makes it
+ * re-check its current wait condition.
+ *
+ * @param c                     The coroutine to wake.
+ */
+void coro_wake(struct coro *c);
+
+/**
+ * @brief Stops a coroutine.  It will not run again until restarted with
+ * coro_start().
+ *
+ * @param c                     The coroutine to stop.
+ */
+void coro_stop(struct coro *c);
+
+/**
+ * @brief Indicates whether a coroutine has run to completion.
+ *
+ * @param c                     The coroutine to query.
+ *
+ * @return                      1 if the coroutine is done; 0 otherwise.
+ */
+static inline int
+coro_done(const struct coro *c)
+{
+    return c->c_done;
+}
+
+/**
+ * @brief Retrieves the argument passed to coro_init().
+ *
+ * @param c                     The coroutine to query.
+ *
+ * @return                      The coroutine argument.
+ */
+static inline void *
+coro_arg(const struct coro *c)
+{
+    return c->c_arg;
+}
+
+/** Marks the start of a coroutine body. */
+#define CORO_BEGIN(c)                                                       \
+    switch ((c)->c_lc) {                                                    \
+    case 0:
+
+/** Marks the end of a coroutine body. */
+#define CORO_END(c)                                                         \
+    }                                                                       \
+    (c)->c_lc = 0;                                                          \
+    return CORO_DONE
+
+/** Finishes the coroutine immediately. */
+#define CORO_EXIT(c) do {                                                   \
+    (c)->c_lc = 0;                                                          \
+    return CORO_DONE;                                                       \
+} while (0)
+
+/** Suspends until coro_wake() is called. */
+#define CORO_WAIT(c) do {                                                   \
+    (c)->c_lc = __LINE__;                                                   \
+    return CORO_WAITING;                                                    \
+    case __LINE__:;                                                         \
+} while (0)
+
+/**
+ * Suspends until a condition holds.  The condition is evaluated every time
+ * the coroutine is woken.
+ */
+#define CORO_WAIT_UNTIL(c, cond) do {                                       \
+    (c)->c_lc = __LINE__;                                                   \
+    case __LINE__:                                                          \
+    if (!(cond)) {                                                          \
+        return CORO_WAITING;                                                \
+    }                                                                       \
+} while (0)
+
+/** Lets other events on the queue run, then continues. */
+#define CORO_YIELD(c) do {                                                  \
+    (c)->c_lc = __LINE__;                                                   \
+    coro_wake(c);                                                           \
+    return CORO_WAITING;                                                    \
+    case __LINE__:;                                                         \
+} while (0)
+
+/** Suspends for the specified number of OS ticks. */
+#define CORO_SLEEP(c, ticks) do {                                           \
+    os_callout_reset(&(c)->c_timer, (ticks));                               \
+    CORO_WAIT(c);                                                           \
+} while (0)
+
+/**
+ * Suspends until a token can be taken from the semaphore.  The semaphore is
+ * retried every CORO_SEM_POLL_TICKS ticks, or whenever the coroutine is
+ * woken.
+ */
+#define CORO_SEM_PEND(c, sem) do {                                          \
+    (c)->c_lc = __LINE__;                                                   \
+    case __LINE__:                                                          \
+    if (os_sem_pend((sem), 0) != OS_OK) {                                   \
+        os_callout_reset(&(c)->c_timer, MYNEWT_VAL(CORO_SEM_POLL_TICKS));   \
+        return CORO_WAITING;                                                \
+    }                                                                       \
+} while (0)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,105 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "coro/coro.h"
+#include "coro_test.h"
+
+struct coro_test_basic_state {
+    int step;
+    int flag;
+};
+
+static int
+coro_test_basic_fn(struct coro *c)
+{
+    struct coro_test_basic_state *st;
+
+    st = coro_arg(c);
+
+    CORO_BEGIN(c);
+
+    st->step = 1;
+    CORO_YIELD(c);
+
+    st->step = 2;
+    CORO_WAIT(c);
+
+    st->step = 3;
+    CORO_WAIT_UNTIL(c, st->flag);
+
+    st->step = 4;
+
+    CORO_END(c);
+}
+
+TEST_CASE_SELF(coro_test_case_basic)
+{
+    struct coro_test_basic_state st = { 0 };
+    struct os_eventq evq;
+    struct coro c;
+
+    os_eventq_init(&evq);
+    coro_init(&c, &evq, coro_test_basic_fn, &st);
+    TEST_ASSERT(coro_done(&c));
+
+    coro_start(&c);
+    TEST_ASSERT(!coro_done(&c));
+    TEST_ASSERT(st.step == 0);
+
+    /* Runs up to the yield, which requeues the coroutine. */
+    os_eventq_run(&evq);
+    TEST_ASSERT(st.step == 1);
+    TEST_ASSERT(!STAILQ_EMPTY(&evq.evq_list));
+
+    /* Continues past the yield and suspends in CORO_WAIT(). */
+    os_eventq_run(&evq);
+    TEST_ASSERT(st.step == 2);
+    TEST_ASSERT(STAILQ_EMPTY(&evq.evq_list));
+
+    /* Wake; condition is false, so it stays suspended. */
+    coro_wake(&c);
+    os_eventq_run(&evq);
+    TEST_ASSERT(st.step == 3);
+
+    coro_wake(&c);
+    os_eventq_run(&evq);
+    TEST_ASSERT(st.step == 3);
+    TEST_ASSERT(!coro_done(&c));
+
+    st.flag = 1;
+    coro_wake(&c);
+    os_eventq_run(&evq);
+    TEST_ASSERT(st.step == 4);
+    TEST_ASSERT(coro_done(&c));
+
+    /* A finished coroutine ignores wakeups. */
+    st.step = 0;
+    coro_wake(&c);
+    os_eventq_run(&evq);
+    TEST_ASSERT(st.step == 0);
+
+    /* Restart from the beginning, then stop it while queued. */
+    coro_start(&c);
+    os_eventq_run(&evq);
+    TEST_ASSERT(st.step == 1);
+    coro_stop(&c);
+    TEST_ASSERT(coro_done(&c));
+    TEST_ASSERT(STAILQ_EMPTY(&evq.evq_list));
+}
@@ -0,0 +1,82 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "coro/coro.h"
+#include "coro_test.h"
+
+#define CORO_TEST_SLEEP_TICKS   5
+
+struct coro_test_timed_state {
+    struct os_sem sem;
+    os_time_t woke_at;
+    int got_sem;
+};
+
+static int
+coro_test_timed_fn(struct coro *c)
+{
+    struct coro_test_timed_state *st;
+
+    st = coro_arg(c);
+
+    CORO_BEGIN(c);
+
+    CORO_SLEEP(c, CORO_TEST_SLEEP_TICKS);
+    st->woke_at = os_time_get();
+
+    CORO_SEM_PEND(c, &st->sem);
+    st->got_sem = 1;
+
+    CORO_END(c);
+}
+
+TEST_CASE_TASK(coro_test_case_timed)
+{
+    struct coro_test_timed_state st = { 0 };
+    struct os_eventq evq;
+    struct coro c;
+    os_time_t start;
+    int i;
+
+    os_eventq_init(&evq);
+    os_sem_init(&st.sem, 0);
+    coro_init(&c, &evq, coro_test_timed_fn, &st);
+
+    start = os_time_get();
+    coro_start(&c);
+
+    /* Start event; then the sleep timer. */
+    os_eventq_run(&evq);
+    os_eventq_run(&evq);
+    TEST_ASSERT(st.woke_at - start >= CORO_TEST_SLEEP_TICKS);
+    TEST_ASSERT(!st.got_sem);
+
+    /* Semaphore unavailable; the coroutine keeps polling. */
+    for (i = 0; i < 3; i++) {
+        os_eventq_run(&evq);
+        TEST_ASSERT(!st.got_sem);
+    }
+
+    os_sem_release(&st.sem);
+    os_eventq_run(&evq);
+    TEST_ASSERT(st.got_sem);
+    TEST_ASSERT(coro_done(&c));
+    TEST_ASSERT(os_sem_get_count(&st.sem) == 0);
+}
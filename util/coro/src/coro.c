@@ -0,0 +1,78 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "os/mynewt.h"
+#include "coro/coro.h"
+
+static void
+coro_run(struct coro *c)
+{
+    if (c->c_done) {
+        return;
+    }
+
+    if (c->c_fn(c) == CORO_DONE) {
+        c->c_done = 1;
+        os_callout_stop(&c->c_timer);
+    }
+}
+
+static void
+coro_event_cb(struct os_event *ev)
+{
+    coro_run(ev->ev_arg);
+}
+
+void
+coro_init(struct coro *c, struct os_eventq *evq, coro_fn *fn, void *arg)
+{
+    memset(c, 0, sizeof *c);
+
+    c->c_ev.ev_cb = coro_event_cb;
+    c->c_ev.ev_arg = c;
+    os_callout_init(&c->c_timer, evq, coro_event_cb, c);
+    c->c_fn = fn;
+    c->c_arg = arg;
+    c->c_done = 1;
+}
+
+void
+coro_start(struct coro *c)
+{
+    coro_stop(c);
+
+    c->c_lc = 0;
+    c->c_done = 0;
+    os_eventq_put(c->c_timer.c_evq, &c->c_ev);
+}
+
+void
+coro_wake(struct coro *c)
+{
+    os_eventq_put(c->c_timer.c_evq, &c->c_ev);
+}
+
+void
+coro_stop(struct coro *c)
+{
+    c->c_done = 1;
+    os_callout_stop(&c->c_timer);
+    os_eventq_remove(c->c_timer.c_evq, &c->c_ev);
+}
@@ -0,0 +1,61 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Interface to CRC peripherals, for drivers that implement it.
+ */
+
+#ifndef _UTIL_CRC_HW_H_
+#define _UTIL_CRC_HW_H_
+
+#include <inttypes.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CRC_HW_CRC8             0   /* crc8_calc(), polynomial 0x07 */
+#define CRC_HW_CRC16            1   /* crc16_ccitt(), polynomial 0x1021 */
+#define CRC_HW_CRC32            2   /* crc32_calc(), 0x04c11db7 reflected */
+#define CRC_HW_CRC32C           3   /* crc32c_calc(), 0x1edc6f41 reflected */
+
+/**
+ * Runs a CRC over a buffer on a CRC peripheral.  util/crc calls this for
+ * buffers of CRC_HW_MIN_LEN bytes or more when CRC_HW is set.
+ *
+ * @param type          One of CRC_HW_*.
+ * @param crc           In: the CRC register to start from; out: the
+ *                          register after the buffer.  Reflected CRCs
+ *                          are given in reflected bit order, and without
+ *                          the inversion crc32_calc() applies.
+ * @param buf           The data.
+ * @param len           The number of bytes in buf.
+ *
+ * @return 0 on success; nonzero if the peripheral cannot do this CRC or
+ *         is not available from the caller's context, in which case
+ *         *crc is unchanged and the tables are used instead.
+ */
+int crc_hw_calc(int type, uint32_t *crc, const void *buf, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
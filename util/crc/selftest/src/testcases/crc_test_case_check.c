@@ -0,0 +1,38 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "crc/crc8.h"
+#include "crc/crc16.h"
+#include "crc/crc32.h"
+#include "crc_test.h"
+
+/* The usual check values, over the ASCII digits "123456789". */
+TEST_CASE_SELF(crc_test_case_check)
+{
+    static const char check[] = "123456789";
+
+    TEST_ASSERT(crc8_calc(crc8_init(), (void *)check, 9) == 0xfb);
+    TEST_ASSERT(crc16_ccitt(CRC16_INITIAL_CRC, check, 9) == 0x31c3);
+    TEST_ASSERT(crc16_ccitt(0xffff, check, 9) == 0x29b1);
+    TEST_ASSERT(crc32_calc(CRC32_INITIAL_CRC, check, 9) == 0xcbf43926);
+    TEST_ASSERT(crc32c_calc(CRC32_INITIAL_CRC, check, 9) == 0xe3069283);
+
+    TEST_ASSERT(crc32_calc(CRC32_INITIAL_CRC, check, 0) == 0);
+    TEST_ASSERT(crc16_ccitt(0x1234, check, 0) == 0x1234);
+}
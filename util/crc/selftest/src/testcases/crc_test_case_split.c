@@ -0,0 +1,72 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "crc/crc8.h"
+#include "crc/crc16.h"
+#include "crc/crc32.h"
+#include "crc_test.h"
+
+/*
+ * The multi-byte loops and any CRC peripheral take over at different
+ * lengths and alignments; a CRC split at any point, one byte at a time
+ * for the second part, must come out the same as one over the whole.
+ */
+TEST_CASE_SELF(crc_test_case_split)
+{
+    uint8_t data[67];
+    uint32_t c32;
+    uint32_t c32c;
+    uint32_t w32;
+    uint32_t w32c;
+    uint16_t c16;
+    uint16_t w16;
+    uint8_t c8;
+    uint8_t w8;
+    int split;
+    int off;
+    int i;
+
+    for (i = 0; i < sizeof data; i++) {
+        data[i] = i * 37 + 11;
+    }
+
+    for (off = 0; off < 4; off++) {
+        w32 = crc32_calc(0, data + off, sizeof data - off);
+        w32c = crc32c_calc(0, data + off, sizeof data - off);
+        w16 = crc16_ccitt(0xffff, data + off, sizeof data - off);
+        w8 = crc8_calc(crc8_init(), data + off, sizeof data - off);
+
+        for (split = off; split <= sizeof data; split++) {
+            c32 = crc32_calc(0, data + off, split - off);
+            c32c = crc32c_calc(0, data + off, split - off);
+            c16 = crc16_ccitt(0xffff, data + off, split - off);
+            c8 = crc8_calc(crc8_init(), data + off, split - off);
+            for (i = split; i < sizeof data; i++) {
+                c32 = crc32_calc(c32, data + i, 1);
+                c32c = crc32c_calc(c32c, data + i, 1);
+                c16 = crc16_ccitt(c16, data + i, 1);
+                c8 = crc8_calc(c8, data + i, 1);
+            }
+            TEST_ASSERT(c32 == w32);
+            TEST_ASSERT(c32c == w32c);
+            TEST_ASSERT(c16 == w16);
+            TEST_ASSERT(c8 == w8);
+        }
+    }
+}
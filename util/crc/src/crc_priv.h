@@ -0,0 +1,45 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef H_CRC_PRIV_
+#define H_CRC_PRIV_
+
+#include "syscfg/syscfg.h"
+
+#define CRC_SLICES      MYNEWT_VAL(CRC_SLICES)
+
+#if CRC_SLICES != 1 && CRC_SLICES != 4 && CRC_SLICES != 8
+#error "CRC_SLICES must be 1, 4 or 8"
+#endif
+
+#if MYNEWT_VAL(CRC_HW)
+#include "crc/crc_hw.h"
+
+/*
+ * Hands a long enough buffer to the CRC peripheral; evaluates to true if
+ * it took it, leaving the result in *(crcp).
+ */
+#define CRC_HW_TRY(type, crcp, buf, len)                                \
+    ((len) >= MYNEWT_VAL(CRC_HW_MIN_LEN) &&                             \
+     crc_hw_calc((type), (crcp), (buf), (len)) == 0)
+#else
+#define CRC_HW_TRY(type, crcp, buf, len)    ((void)(crcp), 0)
+#endif
+
+#endif
@@ -80,7 +80,6 @@ float back_f_in(float step, float max_steps, float max_val);
 float back_f_out(float step, float max_steps, float max_val);
 float back_f_io(float step, float max_steps, float max_val);
 
-
 /* Integer Functions */
 
 /* Custom */
@@ -136,4 +135,65 @@ int32_t back_int_in(int32_t step, int32_t max_steps, int32_t max_val);
 int32_t back_int_out(int32_t step, int32_t max_steps, int32_t max_val);
 int32_t back_int_io(int32_t step, int32_t max_steps, int32_t max_val);
 
+/*
+ * Q15 Functions
+ *
+ * Same curves as the integer functions, computed in Q15 fixed point with
+ * lookup tables instead of floating point.  step is clamped to
+ * [0, max_steps].
+ */
+
+/* Custom */
+int32_t exponential_custom_q15_io(int32_t step, int32_t max_steps, int32_t max_val);
+int32_t exp_sin_custom_q15_io(int32_t step, int32_t max_steps, int32_t max_val);
+int32_t sine_custom_q15_io(int32_t step, int32_t max_steps, int32_t max_val);
+
+/* Linear */
+int32_t linear_q15_io(int32_t step, int32_t max_steps, int32_t max_val);
+
+/* Exponential */
+int32_t exponential_q15_in(int32_t step, int32_t max_steps, int32_t max_val);
+int32_t exponential_q15_out(int32_t step, int32_t max_steps, int32_t max_val);
+int32_t exponential_q15_io(int32_t step, int32_t max_steps, int32_t max_val);
+
+/* Quadratic */
+int32_t quadratic_q15_in(int32_t step, int32_t max_steps, int32_t max_val);
+int32_t quadratic_q15_out(int32_t step, int32_t max_steps, int32_t max_val);
+int32_t quadratic_q15_io(int32_t step, int32_t max_steps, int32_t max_val);
+
+/* Cubic */
+int32_t cubic_q15_in(int32_t step, int32_t max_steps, int32_t max_val);
+int32_t cubic_q15_out(int32_t step, int32_t max_steps, int32_t max_val);
+int32_t cubic_q15_io(int32_t step, int32_t max_steps, int32_t max_val);
+
+/* Quartic */
+int32_t quartic_q15_in(int32_t step, int32_t max_steps, int32_t max_val);
+int32_t quartic_q15_out(int32_t step, int32_t max_steps, int32_t max_val);
+int32_t quartic_q15_io(int32_t step, int32_t max_steps, int32_t max_val);
+
+/* Quintic */
+int32_t quintic_q15_in(int32_t step, int32_t max_steps, int32_t max_val);
+int32_t quintic_q15_out(int32_t step, int32_t max_steps, int32_t max_val);
+int32_t quintic_q15_io(int32_t step, int32_t max_steps, int32_t max_val);
+
+/* Circular */
+int32_t circular_q15_in(int32_t step, int32_t max_steps, int32_t max_val);
+int32_t circular_q15_out(int32_t step, int32_t max_steps, int32_t max_val);
+int32_t circular_q15_io(int32_t step, int32_t max_steps, int32_t max_val);
+
+/* Sine */
+int32_t sine_q15_in(int32_t step, int32_t max_steps, int32_t max_val);
+int32_t sine_q15_out(int32_t step, int32_t max_steps, int32_t max_val);
+int32_t sine_q15_io(int32_t step, int32_t max_steps, int32_t max_val);
+
+/* Bounce */
+int32_t bounce_q15_in(int32_t step, int32_t max_steps, int32_t max_val);
+int32_t bounce_q15_out(int32_t step, int32_t max_steps, int32_t max_val);
+int32_t bounce_q15_io(int32_t step, int32_t max_steps, int32_t max_val);
+
+/* Back */
+int32_t back_q15_in(int32_t step, int32_t max_steps, int32_t max_val);
+int32_t back_q15_out(int32_t step, int32_t max_steps, int32_t max_val);
+int32_t back_q15_io(int32_t step, int32_t max_steps, int32_t max_val);
+
 #endif /* _UTIL_EASING_H_ */
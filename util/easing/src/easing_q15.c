@@ -0,0 +1,608 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdint.h>
+#include "easing/easing.h"
+
+/*
+ * Integer easing without floating point: the curve is evaluated for
+ * t = step / max_steps in Q15 (0..32768), then scaled by max_val.  Curves
+ * needing sin, cos or exp come from 65 entry tables, linearly
+ * interpolated; the exponential ones use log2/exp2 tables.  Polynomial,
+ * circular, bounce and back curves are computed exactly.  step is clamped
+ * to [0, max_steps].
+ */
+
+#define Q15_ONE             (1 << 15)
+#define Q15_HALF            (1 << 14)
+
+#define EASING_Q15_LUT_BITS 6
+#define EASING_Q15_LUT_LEN  ((1 << EASING_Q15_LUT_BITS) + 1)
+#define EASING_Q15_LUT_SHIFT (15 - EASING_Q15_LUT_BITS)
+
+/* Tables: round(32768 * f(i / 64)), i = 0..64 */
+
+/* f(x) = 1 - cos(x * pi / 2) */
+static const uint16_t easing_q15_sin_in_lut[EASING_Q15_LUT_LEN] = {
+        0,    10,    39,    89,   158,   246,   355,   482,
+      630,   796,   982,  1187,  1411,  1654,  1915,  2196,
+     2494,  2811,  3146,  3499,  3869,  4257,  4662,  5084,
+     5522,  5977,  6448,  6935,  7438,  7956,  8489,  9036,
+     9598, 10173, 10762, 11365, 11980, 12608, 13248, 13900,
+    14563, 15237, 15922, 16617, 17321, 18035, 18758, 19489,
+    20228, 20975, 21729, 22489, 23256, 24028, 24806, 25588,
+    26375, 27166, 27960, 28757, 29556, 30357, 31160, 31964,
+    32768,
+};
+
+/* f(x) = (exp(-cos(x * pi)) - 1 / e) / (e - 1 / e) */
+static const uint16_t easing_q15_exp_sin_lut[EASING_Q15_LUT_LEN] = {
+        0,     6,    25,    56,   100,   156,   226,   309,
+      406,   517,   643,   784,   941,  1115,  1307,  1517,
+     1745,  1994,  2264,  2555,  2870,  3209,  3573,  3962,
+     4380,  4825,  5300,  5805,  6342,  6910,  7511,  8145,
+     8813,  9514, 10248, 11016, 11816, 12647, 13508, 14397,
+    15312, 16250, 17209, 18183, 19170, 20165, 21163, 22159,
+    23146, 24119, 25072, 25998, 26890, 27742, 28547, 29299,
+    29990, 30616, 31171, 31649, 32047, 32360, 32586, 32722,
+    32768,
+};
+
+/* f(x) = log2(1 + x) */
+static const uint16_t easing_q15_log2_lut[EASING_Q15_LUT_LEN] = {
+        0,   733,  1455,  2166,  2866,  3556,  4236,  4907,
+     5568,  6220,  6863,  7498,  8124,  8742,  9352,  9954,
+    10549, 11136, 11716, 12289, 12855, 13415, 13968, 14514,
+    15055, 15589, 16117, 16639, 17156, 17667, 18173, 18673,
+    19168, 19658, 20143, 20623, 21098, 21568, 22034, 22495,
+    22952, 23404, 23852, 24296, 24736, 25172, 25604, 26031,
+    26455, 26876, 27292, 27705, 28114, 28520, 28922, 29321,
+    29717, 30109, 30498, 30884, 31267, 31647, 32024, 32397,
+    32768,
+};
+
+/* f(x) = 2^x - 1 */
+static const uint16_t easing_q15_exp2_lut[EASING_Q15_LUT_LEN] = {
+        0,   357,   718,  1082,  1451,  1823,  2200,  2581,
+     2966,  3355,  3748,  4146,  4548,  4954,  5365,  5780,
+     6200,  6624,  7053,  7487,  7925,  8368,  8816,  9269,
+     9727, 10190, 10657, 11130, 11608, 12091, 12580, 13074,
+    13573, 14078, 14588, 15103, 15625, 16152, 16684, 17223,
+    17767, 18317, 18874, 19436, 20005, 20579, 21160, 21747,
+    22341, 22941, 23548, 24161, 24781, 25408, 26041, 26681,
+    27329, 27983, 28645, 29313, 29989, 30673, 31364, 32062,
+    32768,
+};
+
+/* Back overshoot, 1.70158 and 1.70158 * 1.525 */
+#define BACK_S              55758
+#define BACK_S_IO           85030
+
+static int32_t
+easing_q15_lut(const uint16_t *lut, int32_t x)
+{
+    int32_t idx;
+    int32_t frac;
+
+    idx = x >> EASING_Q15_LUT_SHIFT;
+    if (idx >= EASING_Q15_LUT_LEN - 1) {
+        return lut[EASING_Q15_LUT_LEN - 1];
+    }
+    frac = x & ((1 << EASING_Q15_LUT_SHIFT) - 1);
+
+    return lut[idx] + (((lut[idx + 1] - lut[idx]) * frac) >>
+                       EASING_Q15_LUT_SHIFT);
+}
+
+static int32_t
+easing_q15_ratio(int32_t step, int32_t max_steps)
+{
+    if (step <= 0 || max_steps <= 0) {
+        return 0;
+    }
+    if (step >= max_steps) {
+        return Q15_ONE;
+    }
+    if (step < 0x10000) {
+        return (step << 15) / max_steps;
+    }
+    return ((int64_t)step << 15) / max_steps;
+}
+
+static int32_t
+easing_q15_scale(int32_t v, int32_t max_val)
+{
+    return ((int64_t)v * max_val + Q15_HALF) >> 15;
+}
+
+static int32_t
+easing_q15_mul(int32_t a, int32_t b)
+{
+    return (a * b) >> 15;
+}
+
+static int32_t
+easing_q15_pow(int32_t x, int n)
+{
+    int32_t v;
+
+    v = x;
+    while (--n > 0) {
+        v = easing_q15_mul(v, x);
+    }
+    return v;
+}
+
+/* Ease out and in-out built from an ease in curve */
+static int32_t
+easing_q15_out(int32_t (*in)(int32_t), int32_t t)
+{
+    return Q15_ONE - in(Q15_ONE - t);
+}
+
+static int32_t
+easing_q15_io(int32_t (*in)(int32_t), int32_t t)
+{
+    if (t < Q15_HALF) {
+        return in(2 * t) / 2;
+    }
+    return Q15_ONE - in(2 * (Q15_ONE - t)) / 2;
+}
+
+static uint32_t
+easing_q15_isqrt(uint32_t x)
+{
+    uint32_t res;
+    uint32_t bit;
+
+    res = 0;
+    bit = 1UL << 30;
+    while (bit > x) {
+        bit >>= 2;
+    }
+    while (bit) {
+        if (x >= res + bit) {
+            x -= res + bit;
+            res = (res >> 1) + bit;
+        } else {
+            res >>= 1;
+        }
+        bit >>= 2;
+    }
+    return res;
+}
+
+/* log2(x) in Q15, x > 0 */
+static int32_t
+easing_q15_log2(uint32_t x)
+{
+    int32_t k;
+    uint32_t m;
+
+    k = 31 - __builtin_clz(x);
+    if (k >= 15) {
+        m = x >> (k - 15);
+    } else {
+        m = x << (15 - k);
+    }
+
+    return (k << 15) + easing_q15_lut(easing_q15_log2_lut, m - Q15_ONE);
+}
+
+/* 2^(e / 32768), rounded to an integer */
+static int32_t
+easing_q15_exp2(int32_t e)
+{
+    uint64_t m;
+    int32_t k;
+
+    k = e >> 15;
+    m = Q15_ONE + easing_q15_lut(easing_q15_exp2_lut, e & (Q15_ONE - 1));
+    if (k >= 0) {
+        m <<= k;
+    } else {
+        m >>= -k;
+    }
+
+    return (m + Q15_HALF) >> 15;
+}
+
+/* max_val ^ t, with log2(max_val) given */
+static int32_t
+easing_q15_powv(int32_t log2_val, int32_t t)
+{
+    return easing_q15_exp2(((int64_t)log2_val * t) >> 15);
+}
+
+/* Curves of t in Q15 */
+
+static int32_t
+quadratic_q15(int32_t t)
+{
+    return easing_q15_pow(t, 2);
+}
+
+static int32_t
+cubic_q15(int32_t t)
+{
+    return easing_q15_pow(t, 3);
+}
+
+static int32_t
+quartic_q15(int32_t t)
+{
+    return easing_q15_pow(t, 4);
+}
+
+static int32_t
+quintic_q15(int32_t t)
+{
+    return easing_q15_pow(t, 5);
+}
+
+static int32_t
+circular_q15(int32_t t)
+{
+    return Q15_ONE - easing_q15_isqrt((uint32_t)Q15_ONE * Q15_ONE -
+                                      (uint32_t)t * t);
+}
+
+static int32_t
+sine_q15(int32_t t)
+{
+    return easing_q15_lut(easing_q15_sin_in_lut, t);
+}
+
+static int32_t
+bounce_out_q15(int32_t t)
+{
+    int32_t off;
+
+    /* 7.5625 * (t - a)^2 + b, pieces ending at 1, 2, 2.5 and 2.75 / 2.75 */
+    if (t < 11916) {
+        off = 0;
+    } else if (t < 23831) {
+        t -= 17873;
+        off = 24576;
+    } else if (t < 29789) {
+        t -= 26810;
+        off = 30720;
+    } else {
+        t -= 31279;
+        off = 32256;
+    }
+
+    return ((easing_q15_mul(t, t) * 121) >> 4) + off;
+}
+
+static int32_t
+bounce_in_q15(int32_t t)
+{
+    return easing_q15_out(bounce_out_q15, t);
+}
+
+/* t^2 * ((s + 1) * t - s) */
+static int32_t
+back_q15(int32_t t, int32_t s)
+{
+    int32_t v;
+
+    v = (((int64_t)(s + Q15_ONE) * t) >> 15) - s;
+    return ((int64_t)easing_q15_mul(t, t) * v) >> 15;
+}
+
+/* Custom */
+int32_t
+exponential_custom_q15_io(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    if (max_val <= 0) {
+        return 0;
+    }
+
+    return easing_q15_powv(easing_q15_log2(max_val),
+                           easing_q15_ratio(step, max_steps)) - 1;
+}
+
+int32_t
+exp_sin_custom_q15_io(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    return easing_q15_scale(easing_q15_lut(easing_q15_exp_sin_lut,
+                                           easing_q15_ratio(step, max_steps)),
+                            max_val);
+}
+
+int32_t
+sine_custom_q15_io(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    int32_t t;
+
+    /* max_val * (1 - cos(2 * pi * t)), a full sine io there and back */
+    t = easing_q15_ratio(step, max_steps);
+    if (t < Q15_HALF) {
+        t = 2 * t;
+    } else {
+        t = 2 * (Q15_ONE - t);
+    }
+
+    return easing_q15_scale(easing_q15_io(sine_q15, t), 2 * max_val);
+}
+
+/* Linear */
+int32_t
+linear_q15_io(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    return easing_q15_scale(easing_q15_ratio(step, max_steps), max_val);
+}
+
+/* Exponential */
+int32_t
+exponential_q15_in(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    int32_t t;
+
+    t = easing_q15_ratio(step, max_steps);
+    if (t == 0 || max_val <= 0) {
+        return 0;
+    }
+
+    return easing_q15_powv(easing_q15_log2(max_val), t);
+}
+
+int32_t
+exponential_q15_out(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    int32_t t;
+
+    t = easing_q15_ratio(step, max_steps);
+    if (t == Q15_ONE || max_val <= 0) {
+        return max_val;
+    }
+
+    return max_val - easing_q15_powv(easing_q15_log2(max_val), Q15_ONE - t);
+}
+
+int32_t
+exponential_q15_io(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    int32_t log2_half;
+    int32_t t;
+
+    t = easing_q15_ratio(step, max_steps);
+    if (t == 0 || max_val <= 0) {
+        return 0;
+    }
+    if (t == Q15_ONE) {
+        return max_val;
+    }
+
+    /* (max_val / 2) ^ (2 * t), mirrored for the second half */
+    log2_half = easing_q15_log2(max_val) - Q15_ONE;
+    if (t < Q15_HALF) {
+        return easing_q15_powv(log2_half, 2 * t);
+    }
+    return max_val - easing_q15_powv(log2_half, 2 * (Q15_ONE - t));
+}
+
+/* Quadratic */
+int32_t
+quadratic_q15_in(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    return easing_q15_scale(quadratic_q15(easing_q15_ratio(step, max_steps)),
+                            max_val);
+}
+
+int32_t
+quadratic_q15_out(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    return easing_q15_scale(
+        easing_q15_out(quadratic_q15, easing_q15_ratio(step, max_steps)),
+        max_val);
+}
+
+int32_t
+quadratic_q15_io(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    return easing_q15_scale(
+        easing_q15_io(quadratic_q15, easing_q15_ratio(step, max_steps)),
+        max_val);
+}
+
+/* Cubic */
+int32_t
+cubic_q15_in(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    return easing_q15_scale(cubic_q15(easing_q15_ratio(step, max_steps)),
+                            max_val);
+}
+
+int32_t
+cubic_q15_out(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    return easing_q15_scale(
+        easing_q15_out(cubic_q15, easing_q15_ratio(step, max_steps)),
+        max_val);
+}
+
+int32_t
+cubic_q15_io(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    return easing_q15_scale(
+        easing_q15_io(cubic_q15, easing_q15_ratio(step, max_steps)),
+        max_val);
+}
+
+/* Quartic */
+int32_t
+quartic_q15_in(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    return easing_q15_scale(quartic_q15(easing_q15_ratio(step, max_steps)),
+                            max_val);
+}
+
+int32_t
+quartic_q15_out(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    return easing_q15_scale(
+        easing_q15_out(quartic_q15, easing_q15_ratio(step, max_steps)),
+        max_val);
+}
+
+int32_t
+quartic_q15_io(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    return easing_q15_scale(
+        easing_q15_io(quartic_q15, easing_q15_ratio(step, max_steps)),
+        max_val);
+}
+
+/* Quintic */
+int32_t
+quintic_q15_in(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    return easing_q15_scale(quintic_q15(easing_q15_ratio(step, max_steps)),
+                            max_val);
+}
+
+int32_t
+quintic_q15_out(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    return easing_q15_scale(
+        easing_q15_out(quintic_q15, easing_q15_ratio(step, max_steps)),
+        max_val);
+}
+
+int32_t
+quintic_q15_io(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    return easing_q15_scale(
+        easing_q15_io(quintic_q15, easing_q15_ratio(step, max_steps)),
+        max_val);
+}
+
+/* Circular */
+int32_t
+circular_q15_in(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    return easing_q15_scale(circular_q15(easing_q15_ratio(step, max_steps)),
+                            max_val);
+}
+
+int32_t
+circular_q15_out(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    return easing_q15_scale(
+        easing_q15_out(circular_q15, easing_q15_ratio(step, max_steps)),
+        max_val);
+}
+
+int32_t
+circular_q15_io(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    return easing_q15_scale(
+        easing_q15_io(circular_q15, easing_q15_ratio(step, max_steps)),
+        max_val);
+}
+
+/* Sine */
+int32_t
+sine_q15_in(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    return easing_q15_scale(sine_q15(easing_q15_ratio(step, max_steps)),
+                            max_val);
+}
+
+int32_t
+sine_q15_out(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    return easing_q15_scale(
+        easing_q15_out(sine_q15, easing_q15_ratio(step, max_steps)),
+        max_val);
+}
+
+int32_t
+sine_q15_io(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    return easing_q15_scale(
+        easing_q15_io(sine_q15, easing_q15_ratio(step, max_steps)),
+        max_val);
+}
+
+/* Bounce */
+int32_t
+bounce_q15_in(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    return easing_q15_scale(bounce_in_q15(easing_q15_ratio(step, max_steps)),
+                            max_val);
+}
+
+int32_t
+bounce_q15_out(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    return easing_q15_scale(bounce_out_q15(easing_q15_ratio(step, max_steps)),
+                            max_val);
+}
+
+int32_t
+bounce_q15_io(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    int32_t t;
+    int32_t v;
+
+    t = easing_q15_ratio(step, max_steps);
+    if (t < Q15_HALF) {
+        v = bounce_in_q15(2 * t) / 2;
+    } else {
+        v = bounce_out_q15(2 * t - Q15_ONE) / 2 + Q15_HALF;
+    }
+
+    return easing_q15_scale(v, max_val);
+}
+
+/* Back */
+int32_t
+back_q15_in(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    return easing_q15_scale(back_q15(easing_q15_ratio(step, max_steps), BACK_S),
+                            max_val);
+}
+
+int32_t
+back_q15_out(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    int32_t t;
+
+    t = easing_q15_ratio(step, max_steps);
+    return easing_q15_scale(Q15_ONE - back_q15(Q15_ONE - t, BACK_S), max_val);
+}
+
+int32_t
+back_q15_io(int32_t step, int32_t max_steps, int32_t max_val)
+{
+    int32_t t;
+    int32_t v;
+
+    t = easing_q15_ratio(step, max_steps);
+    if (t < Q15_HALF) {
+        v = back_q15(2 * t, BACK_S_IO) / 2;
+    } else {
+        v = Q15_ONE - back_q15(2 * (Q15_ONE - t), BACK_S_IO) / 2;
+    }
+
+    return easing_q15_scale(v, max_val);
+}
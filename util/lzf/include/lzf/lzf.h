@@ -0,0 +1,76 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef H_LZF_
+#define H_LZF_
+
+#include <inttypes.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Small LZ77 codec for short buffers.
+ *
+ * The encoded stream uses the LZF format: a sequence of literal runs of up
+ * to 32 bytes and back-references of 3 to 264 bytes reaching up to 8 KiB
+ * behind the current position.  The compressor needs no heap and only a
+ * small hash table on the stack (see LZF_HASH_BITS); the decompressor needs
+ * no state at all.  Both work on buffers of up to 64 KiB.
+ */
+
+/**
+ * @brief Compresses a buffer.
+ *
+ * @param in                    The data to compress.
+ * @param in_len                The length of the data, in bytes.
+ * @param out                   The buffer to write the compressed data to.
+ * @param out_len               The size of out, in bytes.
+ *
+ * @return                      The compressed length on success;
+ *                              0 if the result would not fit in out.
+ */
+uint16_t lzf_compress(const void *in, uint16_t in_len, void *out,
+                      uint16_t out_len);
+
+/**
+ * @brief Decompresses a buffer produced by lzf_compress().
+ *
+ * If out is NULL nothing is written and only the decompressed length is
+ * computed.
+ *
+ * @param in                    The compressed data.
+ * @param in_len                The length of the compressed data, in bytes.
+ * @param out                   The buffer to write the result to; may be
+ *                                  NULL.
+ * @param out_len               The size of out, in bytes.
+ *
+ * @return                      The decompressed length on success;
+ *                              -1 if the input is malformed or the result
+ *                                  does not fit in out.
+ */
+int lzf_decompress(const void *in, uint16_t in_len, void *out,
+                   uint16_t out_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
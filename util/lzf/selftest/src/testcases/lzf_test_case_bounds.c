@@ -0,0 +1,49 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "lzf/lzf.h"
+#include "lzf_test.h"
+
+TEST_CASE_SELF(lzf_test_case_bounds)
+{
+    uint8_t data[64];
+    uint8_t cbuf[80];
+    uint8_t dbuf[64];
+    uint8_t bad[2];
+    uint16_t clen;
+
+    memset(data, 'z', sizeof data);
+    clen = lzf_compress(data, sizeof data, cbuf, sizeof cbuf);
+    TEST_ASSERT_FATAL(clen > 0 && clen < sizeof data);
+
+    /* The compressor gives up rather than overrun its output. */
+    TEST_ASSERT(lzf_compress(data, sizeof data, cbuf, clen - 1) == 0);
+
+    /* The decompressor refuses to overrun its output. */
+    TEST_ASSERT(lzf_decompress(cbuf, clen, dbuf, sizeof dbuf - 1) == -1);
+
+    /* Truncated input. */
+    TEST_ASSERT(lzf_decompress(cbuf, clen - 1, dbuf, sizeof dbuf) == -1);
+
+    /* A back-reference before the start of the output. */
+    bad[0] = 1 << 5;
+    bad[1] = 0;
+    TEST_ASSERT(lzf_decompress(bad, sizeof bad, dbuf, sizeof dbuf) == -1);
+}
@@ -0,0 +1,69 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "lzf/lzf.h"
+#include "lzf_test.h"
+
+static void
+lzf_test_roundtrip(const uint8_t *data, uint16_t len)
+{
+    uint8_t cbuf[600];
+    uint8_t dbuf[512];
+    uint16_t clen;
+    int dlen;
+
+    clen = lzf_compress(data, len, cbuf, sizeof cbuf);
+    TEST_ASSERT_FATAL(clen > 0);
+
+    TEST_ASSERT(lzf_decompress(cbuf, clen, NULL, 0) == len);
+
+    dlen = lzf_decompress(cbuf, clen, dbuf, sizeof dbuf);
+    TEST_ASSERT_FATAL(dlen == len);
+    TEST_ASSERT(memcmp(data, dbuf, len) == 0);
+}
+
+TEST_CASE_SELF(lzf_test_case_roundtrip)
+{
+    static const char text[] =
+        "ble_hs: conn 1 param update ok; ble_hs: conn 2 param update ok; "
+        "ble_hs: conn 3 param update ok";
+    uint8_t buf[512];
+    uint8_t cbuf[sizeof text];
+    uint32_t x;
+    int i;
+
+    /* Repetitive text shrinks. */
+    TEST_ASSERT(lzf_compress(text, sizeof text, cbuf, sizeof cbuf) <
+                sizeof text - 1);
+    lzf_test_roundtrip((const uint8_t *)text, sizeof text);
+
+    /* A single byte and a long run. */
+    lzf_test_roundtrip((const uint8_t *)"x", 1);
+    memset(buf, 'a', sizeof buf);
+    lzf_test_roundtrip(buf, sizeof buf);
+
+    /* Incompressible data still round-trips. */
+    x = 1;
+    for (i = 0; i < sizeof buf; i++) {
+        x = x * 1103515245 + 12345;
+        buf[i] = x >> 24;
+    }
+    lzf_test_roundtrip(buf, sizeof buf);
+}
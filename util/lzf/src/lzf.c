@@ -0,0 +1,214 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "os/mynewt.h"
+#include "lzf/lzf.h"
+
+#define LZF_HASH_SIZE   (1 << MYNEWT_VAL(LZF_HASH_BITS))
+
+/* Longest literal run and back-reference a single token can encode. */
+#define LZF_MAX_LIT     32
+#define LZF_MAX_REF     (7 + 255 + 2)
+#define LZF_MAX_OFF     (1 << 13)
+
+static unsigned int
+lzf_hash(const uint8_t *p)
+{
+    uint32_t v;
+
+    v = ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2];
+
+    return (v * 2654435761u) >> (32 - MYNEWT_VAL(LZF_HASH_BITS));
+}
+
+/**
+ * Writes the pending literal run [lit, lit + cnt) as one or more literal
+ * tokens.  Returns the new output position, or 0 if the output is full.
+ */
+static uint16_t
+lzf_put_lit(uint8_t *op, uint16_t opos, uint16_t out_len, const uint8_t *lit,
+            uint16_t cnt)
+{
+    uint16_t n;
+
+    while (cnt > 0) {
+        n = cnt < LZF_MAX_LIT ? cnt : LZF_MAX_LIT;
+        if (opos + 1 + n > out_len) {
+            return 0;
+        }
+        op[opos++] = n - 1;
+        memcpy(op + opos, lit, n);
+        opos += n;
+        lit += n;
+        cnt -= n;
+    }
+
+    return opos;
+}
+
+uint16_t
+lzf_compress(const void *in, uint16_t in_len, void *out, uint16_t out_len)
+{
+    /* Input position + 1 of the last 3-byte sequence with each hash. */
+    uint16_t htab[LZF_HASH_SIZE];
+    const uint8_t *ip;
+    uint8_t *op;
+    unsigned int h;
+    uint16_t lit;
+    uint16_t ipos;
+    uint16_t opos;
+    uint16_t ref;
+    uint16_t off;
+    uint16_t max;
+    uint16_t len;
+
+    ip = in;
+    op = out;
+
+    memset(htab, 0, sizeof htab);
+    lit = 0;
+    ipos = 0;
+    opos = 0;
+
+    while (ipos + 2 < in_len) {
+        h = lzf_hash(ip + ipos);
+        ref = htab[h];
+        htab[h] = ipos + 1;
+
+        if (ref == 0) {
+            ipos++;
+            continue;
+        }
+        ref--;
+        off = ipos - ref - 1;
+        if (off >= LZF_MAX_OFF || memcmp(ip + ref, ip + ipos, 3) != 0) {
+            ipos++;
+            continue;
+        }
+
+        max = in_len - ipos;
+        if (max > LZF_MAX_REF) {
+            max = LZF_MAX_REF;
+        }
+        for (len = 3; len < max && ip[ref + len] == ip[ipos + len]; len++) {
+        }
+
+        if (ipos > lit) {
+            opos = lzf_put_lit(op, opos, out_len, ip + lit, ipos - lit);
+            if (opos == 0) {
+                return 0;
+            }
+        }
+        if (opos + 3 > out_len) {
+            return 0;
+        }
+        if (len - 2 < 7) {
+            op[opos++] = ((len - 2) << 5) | (off >> 8);
+        } else {
+            op[opos++] = (7 << 5) | (off >> 8);
+            op[opos++] = len - 2 - 7;
+        }
+        op[opos++] = off;
+
+        /* Index the positions covered by the match so later data can refer
+         * to them.
+         */
+        for (ipos++, len--; len > 0; ipos++, len--) {
+            if (ipos + 2 < in_len) {
+                htab[lzf_hash(ip + ipos)] = ipos + 1;
+            }
+        }
+        lit = ipos;
+    }
+
+    if (in_len > lit) {
+        opos = lzf_put_lit(op, opos, out_len, ip + lit, in_len - lit);
+    }
+
+    return opos;
+}
+
+int
+lzf_decompress(const void *in, uint16_t in_len, void *out, uint16_t out_len)
+{
+    const uint8_t *ip;
+    uint8_t *op;
+    uint16_t ipos;
+    int opos;
+    int ref;
+    uint8_t ctrl;
+    int len;
+
+    ip = in;
+    op = out;
+    ipos = 0;
+    opos = 0;
+
+    while (ipos < in_len) {
+        ctrl = ip[ipos++];
+
+        if (ctrl < LZF_MAX_LIT) {
+            len = ctrl + 1;
+            if (ipos + len > in_len) {
+                return -1;
+            }
+            if (op != NULL) {
+                if (opos + len > out_len) {
+                    return -1;
+                }
+                memcpy(op + opos, ip + ipos, len);
+            }
+            ipos += len;
+            opos += len;
+            continue;
+        }
+
+        len = ctrl >> 5;
+        if (len == 7) {
+            if (ipos >= in_len) {
+                return -1;
+            }
+            len += ip[ipos++];
+        }
+        len += 2;
+
+        if (ipos >= in_len) {
+            return -1;
+        }
+        ref = opos - ((ctrl & 0x1f) << 8) - ip[ipos++] - 1;
+        if (ref < 0) {
+            return -1;
+        }
+
+        if (op != NULL) {
+            if (opos + len > out_len) {
+                return -1;
+            }
+            /* Byte-wise: the source may overlap the bytes being written. */
+            while (len-- > 0) {
+                op[opos++] = op[ref++];
+            }
+        } else {
+            opos += len;
+        }
+    }
+
+    return opos;
+}
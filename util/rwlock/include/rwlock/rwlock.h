@@ -22,10 +22,23 @@
 
 #include "os/mynewt.h"
 
+/**
+ * Write-preferring mode (default).  A pending writer blocks new readers, so
+ * writers cannot be starved.
+ */
+#define RWLOCK_MODE_WRITE_PREF  0
+
+/**
+ * Read-preferring mode.  New readers are admitted as long as no writer holds
+ * the lock, even if writers are waiting; writers can be starved by a steady
+ * stream of readers.
+ */
+#define RWLOCK_MODE_READ_PREF   1
+
 /**
  * @brief Readers–writer lock - lock for multiple readers, single writer.
  *
- * This lock is write-preferring.  That is:
+ * By default, this lock is write-preferring.  That is:
  *     o If there is no active writer and no pending writers, read-acquisitions
  *       do not block.
  *     o If there is an active writer or a pending writer, read-acquisitions
@@ -34,6 +47,14 @@
  *       is acquired by a pending writer if there is one.  If there are no
  *       pending writers, the lock is acquired by all pending readers.
  *
+ * A lock initialized with rwlock_init_mode(RWLOCK_MODE_READ_PREF) admits
+ * readers while writers are pending, and hands the lock to pending readers
+ * before pending writers.
+ *
+ * If RWLOCK_FAST_READ is enabled, the reader count is kept in an atomic
+ * word.  While no writer holds or waits for the lock, readers acquire and
+ * release it with a single compare-and-swap and never touch the mutex.
+ *
  * All struct fields should be considered private.
  */
 struct rwlock {
@@ -46,8 +67,16 @@ struct rwlock {
     /** Blocks and wakes up pending writers. */
     struct os_sem wsem;
 
+#if MYNEWT_VAL(RWLOCK_FAST_READ)
+    /**
+     * The number of active readers, plus RWLOCK_STATE_SLOW if readers must
+     * use the mutex-protected path.  Accessed atomically.
+     */
+    uint32_t state;
+#else
     /** The number of active readers. */
     uint8_t num_readers;
+#endif
 
     /** Whether there is an active writer. */
     bool active_writer;
@@ -63,6 +92,9 @@ struct rwlock {
      * acquisitions are allowed until all handoffs are complete.
      */
     uint8_t handoffs;
+
+    /** One of the RWLOCK_MODE_[...] values. */
+    uint8_t mode;
 };
 
 /**
@@ -72,6 +104,35 @@ struct rwlock {
  */
 void rwlock_acquire_read(struct rwlock *lock);
 
+/**
+ * @brief Acquires the lock for use by a reader, waiting no longer than the
+ * specified timeout.
+ *
+ * @param lock                  The lock to acquire.
+ * @param timeout               The maximum number of OS ticks to wait; 0 to
+ *                                  fail immediately if the lock is not
+ *                                  available.
+ *
+ * @return                      0 if the lock was acquired;
+ *                              OS_TIMEOUT if the lock was not acquired.
+ */
+int rwlock_acquire_read_timeout(struct rwlock *lock, os_time_t timeout);
+
+/**
+ * @brief Acquires the lock for use by a reader if it can be acquired without
+ * blocking.
+ *
+ * @param lock                  The lock to acquire.
+ *
+ * @return                      0 if the lock was acquired;
+ *                              OS_TIMEOUT if the lock was not acquired.
+ */
+static inline int
+rwlock_try_read(struct rwlock *lock)
+{
+    return rwlock_acquire_read_timeout(lock, 0);
+}
+
 /**
  * Releases the lock from a reader.
  *
@@ -86,6 +147,35 @@ void rwlock_release_read(struct rwlock *lock);
  */
 void rwlock_acquire_write(struct rwlock *lock);
 
+/**
+ * @brief Acquires the lock for use by a writer, waiting no longer than the
+ * specified timeout.
+ *
+ * @param lock                  The lock to acquire.
+ * @param timeout               The maximum number of OS ticks to wait; 0 to
+ *                                  fail immediately if the lock is not
+ *                                  available.
+ *
+ * @return                      0 if the lock was acquired;
+ *                              OS_TIMEOUT if the lock was not acquired.
+ */
+int rwlock_acquire_write_timeout(struct rwlock *lock, os_time_t timeout);
+
+/**
+ * @brief Acquires the lock for use by a writer if it can be acquired without
+ * blocking.
+ *
+ * @param lock                  The lock to acquire.
+ *
+ * @return                      0 if the lock was acquired;
+ *                              OS_TIMEOUT if the lock was not acquired.
+ */
+static inline int
+rwlock_try_write(struct rwlock *lock)
+{
+    return rwlock_acquire_write_timeout(lock, 0);
+}
+
 /**
  * Releases the lock from a writer.
  *
@@ -94,7 +184,7 @@ void rwlock_acquire_write(struct rwlock *lock);
 void rwlock_release_write(struct rwlock *lock);
 
 /**
- * Initializes a readers-writer lock.
+ * Initializes a write-preferring readers-writer lock.
  *
  * @param lock                  The lock to initialize.
  *
@@ -102,4 +192,16 @@ void rwlock_release_write(struct rwlock *lock);
  */
 int rwlock_init(struct rwlock *lock);
 
+/**
+ * Initializes a readers-writer lock with the specified fairness mode.
+ *
+ * @param lock                  The lock to initialize.
+ * @param mode                  One of the RWLOCK_MODE_[...] values.
+ *
+ * @return                      0 on success;
+ *                              OS_INVALID_PARM if the mode is invalid;
+ *                              other nonzero on failure.
+ */
+int rwlock_init_mode(struct rwlock *lock, uint8_t mode);
+
 #endif
@@ -22,6 +22,8 @@
 TEST_SUITE(rwlock_test_suite_basic)
 {
     rwlock_test_case_basic();
+    rwlock_test_case_timeout();
+    rwlock_test_case_read_pref();
 }
 
 int
@@ -25,5 +25,7 @@
 
 TEST_SUITE_DECL(rwlock_test_suite_basic);
 TEST_CASE_DECL(rwlock_test_case_basic);
+TEST_CASE_DECL(rwlock_test_case_timeout);
+TEST_CASE_DECL(rwlock_test_case_read_pref);
 
 #endif
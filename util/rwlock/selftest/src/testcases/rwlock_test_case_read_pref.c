@@ -0,0 +1,81 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "rwlock/rwlock.h"
+#include "rwlock_test.h"
+
+#define RTCR_WRITE_TASK_PRIO    10
+
+#define RTCR_STACK_SIZE         1024
+
+static struct os_task rtcr_task_write;
+static os_stack_t rtcr_stack_write[RTCR_STACK_SIZE];
+static struct os_sem rtcr_sem_write;
+
+static struct rwlock rtcr_rwlock;
+static int rtcr_num_writers;
+
+static void
+rtcr_write_task_handler(void *arg)
+{
+    while (1) {
+        os_sem_pend(&rtcr_sem_write, OS_TIMEOUT_NEVER);
+        rwlock_acquire_write(&rtcr_rwlock);
+        rtcr_num_writers++;
+        rwlock_release_write(&rtcr_rwlock);
+    }
+}
+
+TEST_CASE_TASK(rwlock_test_case_read_pref)
+{
+    int rc;
+
+    rc = rwlock_init_mode(&rtcr_rwlock, 0xff);
+    TEST_ASSERT(rc == OS_INVALID_PARM);
+
+    rc = rwlock_init_mode(&rtcr_rwlock, RWLOCK_MODE_READ_PREF);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    os_sem_init(&rtcr_sem_write, 0);
+    rc = os_task_init(&rtcr_task_write, "write", rtcr_write_task_handler,
+                      NULL, RTCR_WRITE_TASK_PRIO, OS_WAIT_FOREVER,
+                      rtcr_stack_write, RTCR_STACK_SIZE);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /* Reader holds the lock; writer blocks. */
+    rwlock_acquire_read(&rtcr_rwlock);
+    os_sem_release(&rtcr_sem_write);
+    TEST_ASSERT_FATAL(rtcr_num_writers == 0);
+    TEST_ASSERT_FATAL(rtcr_rwlock.pending_writers == 1);
+
+    /* A pending writer does not hold back new readers. */
+    rc = rwlock_try_read(&rtcr_rwlock);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rwlock_release_read(&rtcr_rwlock);
+    TEST_ASSERT(rtcr_num_writers == 0);
+
+    /* Last reader out hands the lock to the writer. */
+    rwlock_release_read(&rtcr_rwlock);
+    TEST_ASSERT(rtcr_num_writers == 1);
+
+    rc = rwlock_try_read(&rtcr_rwlock);
+    TEST_ASSERT(rc == 0);
+    rwlock_release_read(&rtcr_rwlock);
+}
@@ -0,0 +1,69 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "rwlock/rwlock.h"
+#include "rwlock_test.h"
+
+TEST_CASE_TASK(rwlock_test_case_timeout)
+{
+    struct rwlock rwl;
+    int rc;
+
+    rc = rwlock_init(&rwl);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /* Writer holds the lock; readers and writers time out. */
+    rc = rwlock_try_write(&rwl);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = rwlock_try_read(&rwl);
+    TEST_ASSERT(rc == OS_TIMEOUT);
+    rc = rwlock_try_write(&rwl);
+    TEST_ASSERT(rc == OS_TIMEOUT);
+    rc = rwlock_acquire_read_timeout(&rwl, 2);
+    TEST_ASSERT(rc == OS_TIMEOUT);
+    TEST_ASSERT(rwl.pending_readers == 0);
+
+    rwlock_release_write(&rwl);
+
+    /* Two readers hold the lock; writers time out. */
+    rc = rwlock_try_read(&rwl);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = rwlock_acquire_read_timeout(&rwl, 2);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = rwlock_try_write(&rwl);
+    TEST_ASSERT(rc == OS_TIMEOUT);
+    rc = rwlock_acquire_write_timeout(&rwl, 2);
+    TEST_ASSERT(rc == OS_TIMEOUT);
+    TEST_ASSERT(rwl.pending_writers == 0);
+
+    /* The abandoned writer no longer holds back new readers. */
+    rc = rwlock_try_read(&rwl);
+    TEST_ASSERT(rc == 0);
+    rwlock_release_read(&rwl);
+
+    rwlock_release_read(&rwl);
+    rwlock_release_read(&rwl);
+
+    /* Lock is free again. */
+    rc = rwlock_try_write(&rwl);
+    TEST_ASSERT(rc == 0);
+    rwlock_release_write(&rwl);
+}
@@ -26,6 +26,92 @@
 #define RWLOCK_DBG_ASSERT(expr)
 #endif
 
+#if MYNEWT_VAL(RWLOCK_FAST_READ)
+/** Set when readers must lock the mutex to acquire or release. */
+#define RWLOCK_STATE_SLOW       0x80000000
+#define RWLOCK_STATE_READERS    0x7fffffff
+#endif
+
+/**
+ * Retrieves the number of active readers.
+ */
+static uint32_t
+rwlock_num_readers(const struct rwlock *lock)
+{
+#if MYNEWT_VAL(RWLOCK_FAST_READ)
+    return os_atomic_load_u32(&lock->state) & RWLOCK_STATE_READERS;
+#else
+    return lock->num_readers;
+#endif
+}
+
+/**
+ * Adjusts the number of active readers.  The caller must lock the mutex prior
+ * to calling this.
+ *
+ * @return                      The new number of active readers.
+ */
+static uint32_t
+rwlock_add_readers(struct rwlock *lock, int delta)
+{
+#if MYNEWT_VAL(RWLOCK_FAST_READ)
+    return (os_atomic_fetch_add_u32(&lock->state, delta) + delta) &
+           RWLOCK_STATE_READERS;
+#else
+    lock->num_readers += delta;
+    return lock->num_readers;
+#endif
+}
+
+/**
+ * Enables or disables the reader fast path according to the current lock
+ * state.  Readers may only bypass the mutex while no writer is active or
+ * pending and no ownership transfer is in progress.  The caller must lock the
+ * mutex prior to calling this.
+ */
+static void
+rwlock_update_fast(struct rwlock *lock)
+{
+#if MYNEWT_VAL(RWLOCK_FAST_READ)
+    RWLOCK_DBG_ASSERT(lock->mtx.mu_owner == g_current_task);
+
+    if (lock->active_writer ||
+        lock->pending_writers > 0 ||
+        lock->pending_readers > 0 ||
+        lock->handoffs > 0) {
+
+        os_atomic_fetch_or_u32(&lock->state, RWLOCK_STATE_SLOW);
+    } else {
+        os_atomic_fetch_and_u32(&lock->state, ~RWLOCK_STATE_SLOW);
+    }
+#endif
+}
+
+/**
+ * Attempts to acquire or release a read lock without locking the mutex.
+ *
+ * @return                      true if the operation succeeded;
+ *                              false if the caller must use the slow path.
+ */
+static bool
+rwlock_fast_read(struct rwlock *lock, int delta)
+{
+#if MYNEWT_VAL(RWLOCK_FAST_READ)
+    uint32_t state;
+
+    do {
+        state = os_atomic_load_u32(&lock->state);
+        if (state & RWLOCK_STATE_SLOW) {
+            return false;
+        }
+    } while (!os_atomic_cas_u32(&lock->state, state, state + delta));
+
+    return true;
+#else
+    return false;
+#endif
+}
+
 /**
  * Unblocks the next pending user.  The caller must lock the mutex prior to
  * calling this.
@@ -33,11 +119,22 @@
 static void
 rwlock_unblock(struct rwlock *lock)
 {
+    bool to_writer;
+
     RWLOCK_DBG_ASSERT(lock->mtx.mu_owner == g_current_task);
     RWLOCK_DBG_ASSERT(lock->handoffs == 0);
 
-    /* Give priority to pending writers. */
-    if (lock->pending_writers > 0) {
+    /* Write-preferring locks give priority to pending writers;
+     * read-preferring locks only hand off to a writer if no readers are
+     * waiting.
+     */
+    if (lock->mode == RWLOCK_MODE_READ_PREF) {
+        to_writer = lock->pending_readers == 0 && lock->pending_writers > 0;
+    } else {
+        to_writer = lock->pending_writers > 0;
+    }
+
+    if (to_writer) {
         /* Indicate that ownership is being transfered to a single writer. */
         lock->handoffs = 1;
 
@@ -73,9 +170,11 @@ rwlock_read_must_block(const struct rwlock *lock)
 {
     RWLOCK_DBG_ASSERT(lock->mtx.mu_owner == g_current_task);
 
-    return lock->active_writer ||
-           lock->pending_writers > 0 ||
-           lock->handoffs > 0;
+    if (lock->active_writer || lock->handoffs > 0) {
+        return true;
+    }
+
+    return lock->mode != RWLOCK_MODE_READ_PREF && lock->pending_writers > 0;
 }
 
 /**
@@ -88,90 +187,172 @@ rwlock_write_must_block(const struct rwlock *lock)
     RWLOCK_DBG_ASSERT(lock->mtx.mu_owner == g_current_task);
 
     return lock->active_writer ||
-           lock->num_readers > 0 ||
+           rwlock_num_readers(lock) > 0 ||
            lock->handoffs > 0;
 }
 
-void
-rwlock_acquire_read(struct rwlock *lock)
+int
+rwlock_acquire_read_timeout(struct rwlock *lock, os_time_t timeout)
 {
+    os_error_t err;
     bool acquired;
 
+    if (rwlock_fast_read(lock, 1)) {
+        return 0;
+    }
+
     os_mutex_pend(&lock->mtx, OS_TIMEOUT_NEVER);
 
-    if (rwlock_read_must_block(lock)) {
-        lock->pending_readers++;
+    if (!rwlock_read_must_block(lock)) {
+        rwlock_add_readers(lock, 1);
+        acquired = true;
+    } else if (timeout == 0) {
         acquired = false;
     } else {
-        lock->num_readers++;
-        acquired = true;
+        lock->pending_readers++;
+        rwlock_update_fast(lock);
+        acquired = false;
     }
 
     os_mutex_release(&lock->mtx);
 
     if (acquired) {
         /* No contention; lock acquired. */
-        return;
+        return 0;
+    }
+    if (timeout == 0) {
+        return OS_TIMEOUT;
     }
 
     /* Wait for the lock to become available. */
-    os_sem_pend(&lock->rsem, OS_TIMEOUT_NEVER);
+    err = os_sem_pend(&lock->rsem, timeout);
 
-    /* Record reader ownership. */
     os_mutex_pend(&lock->mtx, OS_TIMEOUT_NEVER);
-    lock->num_readers++;
+
+    if (err != OS_OK) {
+        /* Timed out.  The lock may have been handed off after the timeout
+         * expired but before the mutex was acquired; if so, accept it.
+         */
+        if (os_sem_pend(&lock->rsem, 0) != OS_OK) {
+            RWLOCK_DBG_ASSERT(lock->pending_readers > 0);
+            lock->pending_readers--;
+            rwlock_update_fast(lock);
+            os_mutex_release(&lock->mtx);
+            return OS_TIMEOUT;
+        }
+    }
+
+    /* Record reader ownership. */
+    rwlock_add_readers(lock, 1);
     rwlock_complete_handoff(lock);
+    rwlock_update_fast(lock);
     os_mutex_release(&lock->mtx);
+
+    return 0;
+}
+
+void
+rwlock_acquire_read(struct rwlock *lock)
+{
+    rwlock_acquire_read_timeout(lock, OS_TIMEOUT_NEVER);
 }
 
 void
 rwlock_release_read(struct rwlock *lock)
 {
+    if (rwlock_fast_read(lock, -1)) {
+        return;
+    }
+
     os_mutex_pend(&lock->mtx, OS_TIMEOUT_NEVER);
 
-    RWLOCK_DBG_ASSERT(lock->num_readers > 0);
-    lock->num_readers--;
+    RWLOCK_DBG_ASSERT(rwlock_num_readers(lock) > 0);
 
     /* If this is the last active reader, unblock a pending writer if there is
      * one.
      */
-    if (lock->num_readers == 0) {
+    if (rwlock_add_readers(lock, -1) == 0) {
         rwlock_unblock(lock);
     }
+    rwlock_update_fast(lock);
 
     os_mutex_release(&lock->mtx);
 }
 
-void
-rwlock_acquire_write(struct rwlock *lock)
+int
+rwlock_acquire_write_timeout(struct rwlock *lock, os_time_t timeout)
 {
+    os_error_t err;
     bool acquired;
 
     os_mutex_pend(&lock->mtx, OS_TIMEOUT_NEVER);
 
-    if (rwlock_write_must_block(lock)) {
-        lock->pending_writers++;
-        acquired = false;
-    } else {
+#if MYNEWT_VAL(RWLOCK_FAST_READ)
+    /* Divert readers to the slow path so that the reader count is stable
+     * while it is inspected.
+     */
+    os_atomic_fetch_or_u32(&lock->state, RWLOCK_STATE_SLOW);
+#endif
+
+    if (!rwlock_write_must_block(lock)) {
         lock->active_writer = true;
         acquired = true;
+    } else if (timeout == 0) {
+        acquired = false;
+    } else {
+        lock->pending_writers++;
+        acquired = false;
     }
 
+    rwlock_update_fast(lock);
     os_mutex_release(&lock->mtx);
 
     if (acquired) {
         /* No contention; lock acquired. */
-        return;
+        return 0;
+    }
+    if (timeout == 0) {
+        return OS_TIMEOUT;
     }
 
     /* Wait for the lock to become available. */
-    os_sem_pend(&lock->wsem, OS_TIMEOUT_NEVER);
+    err = os_sem_pend(&lock->wsem, timeout);
 
-    /* Record writer ownership. */
     os_mutex_pend(&lock->mtx, OS_TIMEOUT_NEVER);
+
+    if (err != OS_OK) {
+        /* Timed out.  The lock may have been handed off after the timeout
+         * expired but before the mutex was acquired; if so, accept it.
+         */
+        if (os_sem_pend(&lock->wsem, 0) != OS_OK) {
+            RWLOCK_DBG_ASSERT(lock->pending_writers > 0);
+            lock->pending_writers--;
+
+            /* Readers may have been held back only by this writer. */
+            if (!lock->active_writer && lock->handoffs == 0 &&
+                lock->pending_writers == 0) {
+
+                rwlock_unblock(lock);
+            }
+            rwlock_update_fast(lock);
+            os_mutex_release(&lock->mtx);
+            return OS_TIMEOUT;
+        }
+    }
+
+    /* Record writer ownership. */
     lock->active_writer = true;
     rwlock_complete_handoff(lock);
+    rwlock_update_fast(lock);
     os_mutex_release(&lock->mtx);
+
+    return 0;
+}
+
+void
+rwlock_acquire_write(struct rwlock *lock)
+{
+    rwlock_acquire_write_timeout(lock, OS_TIMEOUT_NEVER);
 }
 
 void
@@ -183,16 +364,22 @@ rwlock_release_write(struct rwlock *lock)
     lock->active_writer = false;
 
     rwlock_unblock(lock);
+    rwlock_update_fast(lock);
 
     os_mutex_release(&lock->mtx);
 }
 
 int
-rwlock_init(struct rwlock *lock)
+rwlock_init_mode(struct rwlock *lock, uint8_t mode)
 {
     int rc;
 
+    if (mode != RWLOCK_MODE_WRITE_PREF && mode != RWLOCK_MODE_READ_PREF) {
+        return OS_INVALID_PARM;
+    }
+
     *lock = (struct rwlock) { 0 };
+    lock->mode = mode;
 
     rc = os_mutex_init(&lock->mtx);
     if (rc != 0) {
@@ -211,3 +398,9 @@ rwlock_init(struct rwlock *lock)
 
     return 0;
 }
+
+int
+rwlock_init(struct rwlock *lock)
+{
+    return rwlock_init_mode(lock, RWLOCK_MODE_WRITE_PREF);
+}
@@ -0,0 +1,253 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef H_SORT_
+#define H_SORT_
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * Type-specialized sorting and binary search.
+ *
+ * qsort() and bsearch() make an indirect call for every comparison, and
+ * move elements with memcpy-like loops of unknown size.  The macros here
+ * generate functions for one element type and one comparison instead;
+ * the comparison is inlined and elements are moved by assignment.
+ *
+ *     #define CMD_LT(a, b) (strcmp((a)->name, (b)->name) < 0)
+ *     #define CMD_CMP(key, e) strcmp((key), (e)->name)
+ *
+ *     SORT_DEFINE(cmd, struct cmd, CMD_LT)
+ *     SORT_BSEARCH_DEFINE(cmd, struct cmd, const char *, CMD_CMP)
+ *
+ *     cmd_sort(cmds, ncmds);
+ *     c = cmd_bsearch("echo", cmds, ncmds);
+ *
+ * All generated functions are static inline, so unused ones cost nothing.
+ */
+
+/** Ranges this short are finished by insertion sort. */
+#ifndef SORT_INSERTION_MAX
+#define SORT_INSERTION_MAX  12
+#endif
+
+#define SORT_SWAP_(type, x, y) do {                                            \
+    type sort_tmp_ = (x);                                                      \
+    (x) = (y);                                                                 \
+    (y) = sort_tmp_;                                                           \
+} while (0)
+
+/**
+ * Defines name_sort(type *base, size_t nmemb), an introsort of the array.
+ *
+ * Median-of-three quicksort; heapsort takes over below 2 * log2(nmemb)
+ * levels, so the worst case stays O(n log n), and short ranges are left
+ * to insertion sort.  Stack use is O(log n).  Not stable.
+ *
+ * @param name                  Prefix for the generated functions.
+ * @param type                  The element type.
+ * @param lt                    lt(const type *a, const type *b): nonzero if
+ *                                  a sorts before b.  A function or a
+ *                                  function-like macro.
+ */
+#define SORT_DEFINE(name, type, lt)                                            \
+static inline void                                                             \
+name##_sort_insertion_(type *a, size_t n)                                      \
+{                                                                              \
+    type tmp;                                                                  \
+    size_t i;                                                                  \
+    size_t j;                                                                  \
+                                                                               \
+    for (i = 1; i < n; i++) {                                                  \
+        tmp = a[i];                                                            \
+        for (j = i; j > 0 && lt(&tmp, &a[j - 1]); j--) {                       \
+            a[j] = a[j - 1];                                                   \
+        }                                                                      \
+        a[j] = tmp;                                                            \
+    }                                                                          \
+}                                                                              \
+                                                                               \
+static inline void                                                             \
+name##_sort_sift_(type *a, size_t root, size_t n)                              \
+{                                                                              \
+    type tmp;                                                                  \
+    size_t child;                                                              \
+                                                                               \
+    tmp = a[root];                                                             \
+    while ((child = 2 * root + 1) < n) {                                       \
+        if (child + 1 < n && lt(&a[child], &a[child + 1])) {                   \
+            child++;                                                           \
+        }                                                                      \
+        if (!lt(&tmp, &a[child])) {                                            \
+            break;                                                             \
+        }                                                                      \
+        a[root] = a[child];                                                    \
+        root = child;                                                          \
+    }                                                                          \
+    a[root] = tmp;                                                             \
+}                                                                              \
+                                                                               \
+static inline void                                                             \
+name##_sort_heap_(type *a, size_t n)                                           \
+{                                                                              \
+    size_t i;                                                                  \
+                                                                               \
+    for (i = n / 2; i > 0; i--) {                                              \
+        name##_sort_sift_(a, i - 1, n);                                        \
+    }                                                                          \
+    for (i = n - 1; i > 0; i--) {                                              \
+        SORT_SWAP_(type, a[0], a[i]);                                          \
+        name##_sort_sift_(a, 0, i);                                            \
+    }                                                                          \
+}                                                                              \
+                                                                               \
+static inline void                                                             \
+name##_sort_intro_(type *a, size_t n, int depth)                               \
+{                                                                              \
+    type pivot;                                                                \
+    size_t mid;                                                                \
+    size_t i;                                                                  \
+    size_t j;                                                                  \
+                                                                               \
+    while (n > SORT_INSERTION_MAX) {                                           \
+        if (depth-- == 0) {                                                    \
+            name##_sort_heap_(a, n);                                           \
+            return;                                                            \
+        }                                                                      \
+                                                                               \
+        /* Median of three; a[0] and a[n - 1] then bound both scans. */        \
+        mid = n / 2;                                                           \
+        if (lt(&a[mid], &a[0])) {                                              \
+            SORT_SWAP_(type, a[mid], a[0]);                                    \
+        }                                                                      \
+        if (lt(&a[n - 1], &a[mid])) {                                          \
+            SORT_SWAP_(type, a[n - 1], a[mid]);                                \
+            if (lt(&a[mid], &a[0])) {                                          \
+                SORT_SWAP_(type, a[mid], a[0]);                                \
+            }                                                                  \
+        }                                                                      \
+        pivot = a[mid];                                                        \
+                                                                               \
+        i = 0;                                                                 \
+        j = n - 1;                                                             \
+        while (1) {                                                            \
+            while (lt(&a[i], &pivot)) {                                        \
+                i++;                                                           \
+            }                                                                  \
+            while (lt(&pivot, &a[j])) {                                        \
+                j--;                                                           \
+            }                                                                  \
+            if (i >= j) {                                                      \
+                break;                                                         \
+            }                                                                  \
+            SORT_SWAP_(type, a[i], a[j]);                                      \
+            i++;                                                               \
+            j--;                                                               \
+        }                                                                      \
+                                                                               \
+        /* [0, j] and (j, n): recurse into the smaller, loop on the other. */  \
+        j++;                                                                   \
+        if (j < n - j) {                                                       \
+            name##_sort_intro_(a, j, depth);                                   \
+            a += j;                                                            \
+            n -= j;                                                            \
+        } else {                                                               \
+            name##_sort_intro_(a + j, n - j, depth);                           \
+            n = j;                                                             \
+        }                                                                      \
+    }                                                                          \
+                                                                               \
+    name##_sort_insertion_(a, n);                                              \
+}                                                                              \
+                                                                               \
+static inline void                                                             \
+name##_sort(type *base, size_t nmemb)                                          \
+{                                                                              \
+    size_t n;                                                                  \
+    int depth;                                                                 \
+                                                                               \
+    depth = 0;                                                                 \
+    for (n = nmemb; n > 1; n >>= 1) {                                          \
+        depth += 2;                                                            \
+    }                                                                          \
+                                                                               \
+    name##_sort_intro_(base, nmemb, depth);                                    \
+}
+
+/**
+ * Defines binary search over an array sorted in the order cmp implies:
+ *
+ * size_t name_lower_bound(key_type key, const type *base, size_t nmemb):
+ *     the index of the first element not less than key; nmemb if none.
+ *
+ * type *name_bsearch(key_type key, const type *base, size_t nmemb):
+ *     an element equal to key, or NULL.  With duplicates, the first one.
+ *
+ * @param name                  Prefix for the generated functions.
+ * @param type                  The element type.
+ * @param key_type              The type of the key searched for.
+ * @param cmp                   cmp(key_type key, const type *elem): less than,
+ *                                  equal to or greater than zero as key
+ *                                  sorts before, with or after elem.
+ */
+#define SORT_BSEARCH_DEFINE(name, type, key_type, cmp)                         \
+static inline size_t                                                           \
+name##_lower_bound(key_type key, const type *base, size_t nmemb)               \
+{                                                                              \
+    size_t lo;                                                                 \
+    size_t hi;                                                                 \
+    size_t mid;                                                                \
+                                                                               \
+    lo = 0;                                                                    \
+    hi = nmemb;                                                                \
+    while (lo < hi) {                                                          \
+        mid = lo + (hi - lo) / 2;                                              \
+        if (cmp(key, &base[mid]) > 0) {                                        \
+            lo = mid + 1;                                                      \
+        } else {                                                               \
+            hi = mid;                                                          \
+        }                                                                      \
+    }                                                                          \
+                                                                               \
+    return lo;                                                                 \
+}                                                                              \
+                                                                               \
+static inline type *                                                           \
+name##_bsearch(key_type key, const type *base, size_t nmemb)                   \
+{                                                                              \
+    size_t idx;                                                                \
+                                                                               \
+    idx = name##_lower_bound(key, base, nmemb);                                \
+    if (idx < nmemb && cmp(key, &base[idx]) == 0) {                            \
+        return (type *)&base[idx];                                             \
+    }                                                                          \
+                                                                               \
+    return NULL;                                                               \
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
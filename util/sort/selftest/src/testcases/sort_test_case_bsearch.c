@@ -0,0 +1,60 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "sort/sort.h"
+#include "sort_test.h"
+
+#define U32_CMP(key, e)     ((key) < *(e) ? -1 : (key) > *(e))
+
+SORT_BSEARCH_DEFINE(u32, uint32_t, uint32_t, U32_CMP)
+
+/* Sector start addresses, say; with a duplicate to check "first of". */
+static const uint32_t sort_test_addrs[] = {
+    0x0000, 0x1000, 0x2000, 0x2000, 0x4000, 0x8000, 0x10000,
+};
+
+#define SORT_TEST_ADDRS \
+    (sizeof(sort_test_addrs) / sizeof(sort_test_addrs[0]))
+
+TEST_CASE_SELF(sort_test_case_bsearch)
+{
+    const uint32_t *p;
+    int i;
+
+    for (i = 0; i < SORT_TEST_ADDRS; i++) {
+        p = u32_bsearch(sort_test_addrs[i], sort_test_addrs, SORT_TEST_ADDRS);
+        TEST_ASSERT_FATAL(p != NULL);
+        TEST_ASSERT(*p == sort_test_addrs[i]);
+    }
+
+    p = u32_bsearch(0x2000, sort_test_addrs, SORT_TEST_ADDRS);
+    TEST_ASSERT(p == &sort_test_addrs[2]);
+
+    TEST_ASSERT(u32_bsearch(0x0fff, sort_test_addrs, SORT_TEST_ADDRS) == NULL);
+    TEST_ASSERT(u32_bsearch(0x20000, sort_test_addrs, SORT_TEST_ADDRS) == NULL);
+    TEST_ASSERT(u32_bsearch(0, sort_test_addrs, 0) == NULL);
+
+    TEST_ASSERT(u32_lower_bound(0, sort_test_addrs, SORT_TEST_ADDRS) == 0);
+    TEST_ASSERT(u32_lower_bound(0x1001, sort_test_addrs, SORT_TEST_ADDRS) == 2);
+    TEST_ASSERT(u32_lower_bound(0x2000, sort_test_addrs, SORT_TEST_ADDRS) == 2);
+    TEST_ASSERT(u32_lower_bound(0x2001, sort_test_addrs, SORT_TEST_ADDRS) == 4);
+    TEST_ASSERT(u32_lower_bound(0x10001, sort_test_addrs, SORT_TEST_ADDRS) ==
+                SORT_TEST_ADDRS);
+}
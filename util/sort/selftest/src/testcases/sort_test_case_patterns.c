@@ -0,0 +1,98 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "sort/sort.h"
+#include "sort_test.h"
+
+#define SORT_TEST_MAX   600
+
+#define INT_LT(a, b)    (*(a) < *(b))
+
+SORT_DEFINE(sort_test_int, int, INT_LT)
+
+static int sort_test_buf[SORT_TEST_MAX];
+static unsigned int sort_test_seed = 1;
+
+static int
+sort_test_rand(void)
+{
+    sort_test_seed = sort_test_seed * 1103515245 + 12345;
+    return (sort_test_seed >> 16) & 0x7fff;
+}
+
+static int
+sort_test_fill(int pattern, int i, int n)
+{
+    switch (pattern) {
+    case 0:
+        return sort_test_rand();
+    case 1:
+        return i;
+    case 2:
+        return n - i;
+    case 3:
+        return 7;
+    case 4:
+        /* Organ pipe. */
+        return i < n / 2 ? i : n - i;
+    default:
+        /* Few distinct values. */
+        return sort_test_rand() % 4;
+    }
+}
+
+/*
+ * Sorts arrays of every length up to a few times the insertion cutoff,
+ * and some longer ones, in patterns known to hurt naive quicksorts.
+ * The output must be ordered and hold the same values: the sum and xor
+ * of the elements are kept.
+ */
+TEST_CASE_SELF(sort_test_case_patterns)
+{
+    unsigned int sum;
+    unsigned int xor;
+    int pattern;
+    int n;
+    int i;
+
+    for (n = 0; n <= SORT_TEST_MAX; n = n < 50 ? n + 1 : n * 2) {
+        for (pattern = 0; pattern < 6; pattern++) {
+            sum = 0;
+            xor = 0;
+            for (i = 0; i < n; i++) {
+                sort_test_buf[i] = sort_test_fill(pattern, i, n);
+                sum += sort_test_buf[i];
+                xor ^= sort_test_buf[i];
+            }
+
+            sort_test_int_sort(sort_test_buf, n);
+
+            for (i = 0; i < n; i++) {
+                if (i > 0) {
+                    TEST_ASSERT_FATAL(sort_test_buf[i - 1] <= sort_test_buf[i],
+                                      "n=%d pattern=%d i=%d", n, pattern, i);
+                }
+                sum -= sort_test_buf[i];
+                xor ^= sort_test_buf[i];
+            }
+            TEST_ASSERT(sum == 0 && xor == 0, "n=%d pattern=%d", n, pattern);
+        }
+    }
+}
@@ -0,0 +1,61 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "os/mynewt.h"
+#include "sort/sort.h"
+#include "sort_test.h"
+
+struct sort_test_entry {
+    const char *name;
+    int idx;
+};
+
+#define ENTRY_LT(a, b)  (strcmp((a)->name, (b)->name) < 0)
+
+SORT_DEFINE(entry, struct sort_test_entry, ENTRY_LT)
+
+static const char *const sort_test_names[] = {
+    "stat", "log", "echo", "tasks", "mpool", "date", "config", "reset",
+    "imgr", "help", "crash", "fs", "ls", "cat", "mkdir", "rm", "ver",
+};
+
+#define SORT_TEST_NAMES \
+    (sizeof(sort_test_names) / sizeof(sort_test_names[0]))
+
+/* Elements larger than a word move whole, key and payload together. */
+TEST_CASE_SELF(sort_test_case_struct)
+{
+    struct sort_test_entry entries[SORT_TEST_NAMES];
+    int i;
+
+    for (i = 0; i < SORT_TEST_NAMES; i++) {
+        entries[i].name = sort_test_names[i];
+        entries[i].idx = i;
+    }
+
+    entry_sort(entries, SORT_TEST_NAMES);
+
+    for (i = 0; i < SORT_TEST_NAMES; i++) {
+        TEST_ASSERT(entries[i].name == sort_test_names[entries[i].idx]);
+        if (i > 0) {
+            TEST_ASSERT(strcmp(entries[i - 1].name, entries[i].name) < 0);
+        }
+    }
+}
@@ -0,0 +1,226 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef H_SPSC_RING_
+#define H_SPSC_RING_
+
+#include <inttypes.h>
+#include "os/mynewt.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SPSC_RING_ALIGNED \
+    __attribute__((aligned(MYNEWT_VAL(SPSC_RING_CACHE_LINE_SIZE))))
+
+/**
+ * @brief Lock-free single-producer / single-consumer ring buffer.
+ *
+ * A ring of fixed size elements that one context (e.g., an interrupt
+ * handler) fills while exactly one other context (e.g., a task) drains it,
+ * without disabling interrupts.  The producer only ever writes sr_head and
+ * the consumer only ever writes sr_tail; both are free running counters,
+ * so the number of queued elements is always (sr_head - sr_tail).
+ *
+ * Elements can be copied in and out (spsc_ring_put() / spsc_ring_get()) or
+ * accessed in place (spsc_ring_reserve() + spsc_ring_commit() on the
+ * producer side, spsc_ring_peek() + spsc_ring_release() on the consumer
+ * side).
+ *
+ * The number of elements must be a power of two.  All struct fields should
+ * be considered private.
+ */
+struct spsc_ring {
+    uint8_t *sr_buf;
+    uint32_t sr_mask;
+    uint16_t sr_elem_size;
+
+    /** Producer index; written by the producer only. */
+    uint32_t sr_head SPSC_RING_ALIGNED;
+    /** Consumer index; written by the consumer only. */
+    uint32_t sr_tail SPSC_RING_ALIGNED;
+};
+
+/**
+ * @brief Initializes a ring buffer.
+ *
+ * @param ring                  The ring to initialize.
+ * @param buf                   Element storage; must hold
+ *                                  num_elems * elem_size bytes.
+ * @param elem_size             The size of each element, in bytes.
+ * @param num_elems             The number of elements; must be a power of
+ *                                  two.
+ *
+ * @return                      0 on success; SYS_EINVAL on error
+ */
+int spsc_ring_init(struct spsc_ring *ring, void *buf, uint16_t elem_size,
+                   uint32_t num_elems);
+
+/**
+ * @brief Reserves the next free slot for the producer to fill in place.
+ *
+ * The slot becomes visible to the consumer when spsc_ring_commit() is
+ * called.  Calling this function again without committing returns the
+ * same slot.  Producer side only.
+ *
+ * @param ring                  The ring to reserve a slot in.
+ *
+ * @return                      A pointer to the slot; NULL if the ring is
+ *                                  full.
+ */
+void *spsc_ring_reserve(struct spsc_ring *ring);
+
+/**
+ * @brief Publishes the slot returned by spsc_ring_reserve().
+ *
+ * Producer side only.
+ *
+ * @param ring                  The ring to commit to.
+ */
+void spsc_ring_commit(struct spsc_ring *ring);
+
+/**
+ * @brief Copies an element into the ring.  Producer side only.
+ *
+ * @param ring                  The ring to write to.
+ * @param elem                  The element to copy.
+ *
+ * @return                      0 on success; SYS_ENOMEM if the ring is full
+ */
+int spsc_ring_put(struct spsc_ring *ring, const void *elem);
+
+/**
+ * @brief Retrieves the oldest element without removing it from the ring.
+ *
+ * The slot stays owned by the consumer until spsc_ring_release() is
+ * called.  Consumer side only.
+ *
+ * @param ring                  The ring to read from.
+ *
+ * @return                      A pointer to the oldest element; NULL if
+ *                                  the ring is empty.
+ */
+void *spsc_ring_peek(struct spsc_ring *ring);
+
+/**
+ * @brief Removes the element returned by spsc_ring_peek() from the ring.
+ *
+ * Consumer side only.
+ *
+ * @param ring                  The ring to release from.
+ */
+void spsc_ring_release(struct spsc_ring *ring);
+
+/**
+ * @brief Copies the oldest element out of the ring and removes it.
+ *
+ * Consumer side only.
+ *
+ * @param ring                  The ring to read from.
+ * @param elem                  The buffer to copy the element into.
+ *
+ * @return                      0 on success; SYS_ENOENT if the ring is
+ *                                  empty
+ */
+int spsc_ring_get(struct spsc_ring *ring, void *elem);
+
+/**
+ * @brief Indicates how many elements are queued in the ring.
+ *
+ * The result is exact when called by either the producer or the consumer;
+ * from any other context it is only a snapshot.
+ *
+ * @param ring                  The ring to query.
+ *
+ * @return                      The number of queued elements.
+ */
+static inline uint32_t
+spsc_ring_count(const struct spsc_ring *ring)
+{
+    return __atomic_load_n(&ring->sr_head, __ATOMIC_ACQUIRE) -
+           __atomic_load_n(&ring->sr_tail, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @brief Indicates the capacity of the ring, in elements.
+ *
+ * @param ring                  The ring to query.
+ *
+ * @return                      The number of elements the ring can hold.
+ */
+static inline uint32_t
+spsc_ring_size(const struct spsc_ring *ring)
+{
+    return ring->sr_mask + 1;
+}
+
+/**
+ * @brief Defines type-safe inline wrappers around the ring functions.
+ *
+ * SPSC_RING_TYPE(adc_ring, struct adc_sample) defines adc_ring_init(),
+ * adc_ring_reserve(), adc_ring_commit(), adc_ring_put(), adc_ring_peek(),
+ * adc_ring_release() and adc_ring_get(), which take and return
+ * struct adc_sample pointers instead of void pointers.
+ *
+ * @param prefix                The prefix for the generated functions.
+ * @param type                  The element type.
+ */
+#define SPSC_RING_TYPE(prefix, type)                                        \
+static inline int                                                           \
+prefix ## _init(struct spsc_ring *ring, type *buf, uint32_t num_elems)      \
+{                                                                           \
+    return spsc_ring_init(ring, buf, sizeof(type), num_elems);              \
+}                                                                           \
+static inline type *                                                        \
+prefix ## _reserve(struct spsc_ring *ring)                                  \
+{                                                                           \
+    return (type *)spsc_ring_reserve(ring);                                 \
+}                                                                           \
+static inline void                                                          \
+prefix ## _commit(struct spsc_ring *ring)                                   \
+{                                                                           \
+    spsc_ring_commit(ring);                                                 \
+}                                                                           \
+static inline int                                                           \
+prefix ## _put(struct spsc_ring *ring, const type *elem)                    \
+{                                                                           \
+    return spsc_ring_put(ring, elem);                                       \
+}                                                                           \
+static inline type *                                                        \
+prefix ## _peek(struct spsc_ring *ring)                                     \
+{                                                                           \
+    return (type *)spsc_ring_peek(ring);                                    \
+}                                                                           \
+static inline void                                                          \
+prefix ## _release(struct spsc_ring *ring)                                  \
+{                                                                           \
+    spsc_ring_release(ring);                                                \
+}                                                                           \
+static inline int                                                           \
+prefix ## _get(struct spsc_ring *ring, type *elem)                          \
+{                                                                           \
+    return spsc_ring_get(ring, elem);                                       \
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,70 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "spsc_ring/spsc_ring.h"
+#include "spsc_ring_test.h"
+
+TEST_CASE_SELF(spsc_ring_test_case_basic)
+{
+    struct spsc_ring ring;
+    uint32_t buf[8];
+    uint32_t val;
+    uint32_t i;
+    int rc;
+
+    /* Invalid configuration - size not a power of two. */
+    rc = spsc_ring_init(&ring, buf, sizeof buf[0], 6);
+    TEST_ASSERT_FATAL(rc == SYS_EINVAL);
+
+    /* Invalid configuration - zero size. */
+    rc = spsc_ring_init(&ring, buf, sizeof buf[0], 0);
+    TEST_ASSERT_FATAL(rc == SYS_EINVAL);
+
+    rc = spsc_ring_init(&ring, buf, sizeof buf[0], 8);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(spsc_ring_size(&ring) == 8);
+    TEST_ASSERT(spsc_ring_count(&ring) == 0);
+
+    rc = spsc_ring_get(&ring, &val);
+    TEST_ASSERT(rc == SYS_ENOENT);
+
+    /* Run several times around the ring to exercise index wraparound. */
+    for (i = 0; i < 40; i++) {
+        rc = spsc_ring_put(&ring, &i);
+        TEST_ASSERT_FATAL(rc == 0);
+
+        if (i % 8 == 7) {
+            /* Full. */
+            TEST_ASSERT(spsc_ring_count(&ring) == 8);
+            rc = spsc_ring_put(&ring, &i);
+            TEST_ASSERT(rc == SYS_ENOMEM);
+
+            /* Drain in FIFO order. */
+            for (val = 0; val < 8; val++) {
+                uint32_t got;
+
+                rc = spsc_ring_get(&ring, &got);
+                TEST_ASSERT_FATAL(rc == 0);
+                TEST_ASSERT(got == i - 7 + val);
+            }
+            TEST_ASSERT(spsc_ring_count(&ring) == 0);
+        }
+    }
+}
@@ -0,0 +1,72 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "spsc_ring/spsc_ring.h"
+#include "spsc_ring_test.h"
+
+struct spsc_ring_test_sample {
+    uint16_t chan;
+    int32_t val;
+};
+
+SPSC_RING_TYPE(spsc_ring_test_samples, struct spsc_ring_test_sample)
+
+TEST_CASE_SELF(spsc_ring_test_case_zero_copy)
+{
+    struct spsc_ring_test_sample buf[4];
+    struct spsc_ring_test_sample *s;
+    struct spsc_ring ring;
+    int rc;
+    int i;
+
+    rc = spsc_ring_test_samples_init(&ring, buf, 4);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /* Producer fills slots in place. */
+    for (i = 0; i < 4; i++) {
+        s = spsc_ring_test_samples_reserve(&ring);
+        TEST_ASSERT_FATAL(s != NULL);
+        TEST_ASSERT(s == &buf[i]);
+
+        /* Reserved but uncommitted slots are invisible to the consumer. */
+        TEST_ASSERT(spsc_ring_count(&ring) == i);
+
+        s->chan = i;
+        s->val = -i;
+        spsc_ring_test_samples_commit(&ring);
+    }
+    TEST_ASSERT(spsc_ring_test_samples_reserve(&ring) == NULL);
+
+    /* Consumer reads in place. */
+    for (i = 0; i < 4; i++) {
+        s = spsc_ring_test_samples_peek(&ring);
+        TEST_ASSERT_FATAL(s != NULL);
+        TEST_ASSERT(s->chan == i && s->val == -i);
+
+        /* Peeking again yields the same element. */
+        TEST_ASSERT(spsc_ring_test_samples_peek(&ring) == s);
+        spsc_ring_test_samples_release(&ring);
+    }
+    TEST_ASSERT(spsc_ring_test_samples_peek(&ring) == NULL);
+
+    /* Freed slots can be reused. */
+    s = spsc_ring_test_samples_reserve(&ring);
+    TEST_ASSERT(s == &buf[0]);
+}
@@ -0,0 +1,123 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "os/mynewt.h"
+#include "spsc_ring/spsc_ring.h"
+
+static inline void *
+spsc_ring_slot(const struct spsc_ring *ring, uint32_t idx)
+{
+    return ring->sr_buf + (idx & ring->sr_mask) * ring->sr_elem_size;
+}
+
+int
+spsc_ring_init(struct spsc_ring *ring, void *buf, uint16_t elem_size,
+               uint32_t num_elems)
+{
+    if (buf == NULL || elem_size == 0 || num_elems == 0 ||
+        (num_elems & (num_elems - 1)) != 0) {
+        return SYS_EINVAL;
+    }
+
+    ring->sr_buf = buf;
+    ring->sr_mask = num_elems - 1;
+    ring->sr_elem_size = elem_size;
+    ring->sr_head = 0;
+    ring->sr_tail = 0;
+
+    return 0;
+}
+
+void *
+spsc_ring_reserve(struct spsc_ring *ring)
+{
+    uint32_t head;
+    uint32_t tail;
+
+    /* Only we write the head; the tail needs to be read fresh. */
+    head = ring->sr_head;
+    tail = __atomic_load_n(&ring->sr_tail, __ATOMIC_ACQUIRE);
+    if (head - tail > ring->sr_mask) {
+        return NULL;
+    }
+
+    return spsc_ring_slot(ring, head);
+}
+
+void
+spsc_ring_commit(struct spsc_ring *ring)
+{
+    /* Element contents must be visible before the new head. */
+    __atomic_store_n(&ring->sr_head, ring->sr_head + 1, __ATOMIC_RELEASE);
+}
+
+int
+spsc_ring_put(struct spsc_ring *ring, const void *elem)
+{
+    void *slot;
+
+    slot = spsc_ring_reserve(ring);
+    if (slot == NULL) {
+        return SYS_ENOMEM;
+    }
+
+    memcpy(slot, elem, ring->sr_elem_size);
+    spsc_ring_commit(ring);
+
+    return 0;
+}
+
+void *
+spsc_ring_peek(struct spsc_ring *ring)
+{
+    uint32_t head;
+    uint32_t tail;
+
+    tail = ring->sr_tail;
+    head = __atomic_load_n(&ring->sr_head, __ATOMIC_ACQUIRE);
+    if (head == tail) {
+        return NULL;
+    }
+
+    return spsc_ring_slot(ring, tail);
+}
+
+void
+spsc_ring_release(struct spsc_ring *ring)
+{
+    /* We must be done with the slot before the producer may reuse it. */
+    __atomic_store_n(&ring->sr_tail, ring->sr_tail + 1, __ATOMIC_RELEASE);
+}
+
+int
+spsc_ring_get(struct spsc_ring *ring, void *elem)
+{
+    void *slot;
+
+    slot = spsc_ring_peek(ring);
+    if (slot == NULL) {
+        return SYS_ENOENT;
+    }
+
+    memcpy(elem, slot, ring->sr_elem_size);
+    spsc_ring_release(ring);
+
+    return 0;
+}
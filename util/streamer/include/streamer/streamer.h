@@ -48,6 +48,8 @@ struct streamer {
 struct streamer_mbuf {
     struct streamer streamer; /* Must be first member. */
     struct os_mbuf *om;
+    struct os_mbuf *last;     /* Last mbuf of the chain, as last seen. */
+    uint8_t msys;             /* Grow the chain from msys. */
 };
 
 /**
@@ -92,6 +94,9 @@ struct streamer *streamer_console_get(void);
  * @param om                    The mbuf chain to write to.  This may already
  *                                  contain data.
  *
+ * The chain may be appended to between writes, but must not be shortened
+ * while the streamer is in use.
+ *
  * @return                      0 on success; SYS_E[...] on failure.
  */
 int streamer_mbuf_new(struct streamer_mbuf *sm, struct os_mbuf *om);
@@ -105,4 +110,46 @@ int streamer_mbuf_new(struct streamer_mbuf *sm, struct os_mbuf *om);
  */
 int streamer_msys_new(struct streamer_mbuf *sm);
 
+#if MYNEWT_VAL(STREAMER_CBOR)
+struct CborValue;
+
+/**
+ * @brief Writes the CBOR item at the given position in diagnostic
+ * notation, as cbor_value_to_pretty() does, without buffering the output.
+ *
+ * Memory use is bounded by STREAMER_CBOR_BUF_SIZE, whatever the size of the
+ * item.  Text strings are written as UTF-8; only quotes, backslashes and
+ * control characters are escaped.
+ *
+ * @param streamer              The streamer to write to.
+ * @param value                 The CBOR item to convert.  Not advanced.
+ *
+ * @return                      0 on success;
+ *                              SYS_EINVAL if the CBOR is malformed;
+ *                              other SYS_E[...] on streamer failure.
+ */
+int streamer_cbor_pretty(struct streamer *streamer,
+                         const struct CborValue *value);
+
+/**
+ * @brief Writes the CBOR item at the given position as JSON, as
+ * cbor_value_to_json() does, without buffering the output.
+ *
+ * Byte strings are written base64url encoded and tags are dropped.
+ *
+ * @param streamer              The streamer to write to.
+ * @param value                 The CBOR item to convert.  Not advanced.
+ * @param flags                 CborConvertStringifyMapKeys to write
+ *                                  non-string map keys in diagnostic
+ *                                  notation; other flags are ignored.
+ *
+ * @return                      0 on success;
+ *                              SYS_EINVAL if the CBOR is malformed or does
+ *                                  not map to JSON;
+ *                              other SYS_E[...] on streamer failure.
+ */
+int streamer_cbor_json(struct streamer *streamer,
+                       const struct CborValue *value, int flags);
+#endif
+
 #endif
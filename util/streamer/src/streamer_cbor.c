@@ -0,0 +1,621 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(STREAMER_CBOR)
+
+#include <stdarg.h>
+#include <stdio.h>
+#if MYNEWT_VAL(FLOAT_USER)
+#include <math.h>
+#endif
+#include "tinycbor/cbor.h"
+#include "tinycbor/cborjson.h"
+#include "streamer/streamer.h"
+
+/*
+ * Converts CBOR to text as it is parsed.  Output is collected in a small
+ * buffer and handed to the streamer a buffer at a time; strings are read
+ * from the parser a buffer at a time, so the memory used does not depend
+ * on the size of the CBOR data.
+ */
+struct streamer_cbor {
+    struct streamer *streamer;
+    int flags;
+    int rc;
+    /* Set while producing a stringified JSON map key. */
+    bool in_key;
+    uint8_t b64_carry[2];
+    uint8_t b64_carry_len;
+    uint16_t out_len;
+    char out[MYNEWT_VAL(STREAMER_CBOR_BUF_SIZE)];
+    char chunk[MYNEWT_VAL(STREAMER_CBOR_BUF_SIZE)];
+};
+
+static const char streamer_cbor_hex[] = "0123456789abcdef";
+
+static const char streamer_cbor_b64url[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+static void
+streamer_cbor_flush(struct streamer_cbor *sc)
+{
+    if (sc->out_len != 0 && sc->rc == 0) {
+        sc->rc = streamer_write(sc->streamer, sc->out, sc->out_len);
+    }
+    sc->out_len = 0;
+}
+
+static void
+streamer_cbor_put_raw(struct streamer_cbor *sc, char c)
+{
+    if (sc->out_len == sizeof(sc->out)) {
+        streamer_cbor_flush(sc);
+    }
+    sc->out[sc->out_len++] = c;
+}
+
+/* Emits a character of a quoted string, escaping it as needed. */
+static void
+streamer_cbor_put_escaped(struct streamer_cbor *sc, uint8_t c,
+                          void (*put)(struct streamer_cbor *, char))
+{
+    switch (c) {
+    case '"':
+    case '\\':
+        put(sc, '\\');
+        put(sc, c);
+        break;
+    case '\b':
+        put(sc, '\\');
+        put(sc, 'b');
+        break;
+    case '\f':
+        put(sc, '\\');
+        put(sc, 'f');
+        break;
+    case '\n':
+        put(sc, '\\');
+        put(sc, 'n');
+        break;
+    case '\r':
+        put(sc, '\\');
+        put(sc, 'r');
+        break;
+    case '\t':
+        put(sc, '\\');
+        put(sc, 't');
+        break;
+    default:
+        if (c < 0x20) {
+            put(sc, '\\');
+            put(sc, 'u');
+            put(sc, '0');
+            put(sc, '0');
+            put(sc, streamer_cbor_hex[c >> 4]);
+            put(sc, streamer_cbor_hex[c & 0xf]);
+        } else {
+            put(sc, c);
+        }
+        break;
+    }
+}
+
+/* Emits a character of output; inside a stringified key, escaped. */
+static void
+streamer_cbor_put(struct streamer_cbor *sc, char c)
+{
+    if (sc->in_key) {
+        streamer_cbor_put_escaped(sc, c, streamer_cbor_put_raw);
+    } else {
+        streamer_cbor_put_raw(sc, c);
+    }
+}
+
+static void
+streamer_cbor_puts(struct streamer_cbor *sc, const char *str)
+{
+    while (*str != '\0') {
+        streamer_cbor_put(sc, *str++);
+    }
+}
+
+static void
+streamer_cbor_printf(struct streamer_cbor *sc, const char *fmt, ...)
+{
+    char tmp[32];
+    va_list ap;
+
+    va_start(ap, fmt);
+    vsnprintf(tmp, sizeof(tmp), fmt, ap);
+    va_end(ap);
+
+    streamer_cbor_puts(sc, tmp);
+}
+
+static CborError
+streamer_cbor_text_chunk(void *arg, const void *data, size_t len)
+{
+    struct streamer_cbor *sc;
+    const uint8_t *u8p;
+    size_t i;
+
+    sc = arg;
+    u8p = data;
+    for (i = 0; i < len; i++) {
+        streamer_cbor_put_escaped(sc, u8p[i], streamer_cbor_put);
+    }
+
+    return sc->rc == 0 ? CborNoError : CborErrorIO;
+}
+
+static CborError
+streamer_cbor_hex_chunk(void *arg, const void *data, size_t len)
+{
+    struct streamer_cbor *sc;
+    const uint8_t *u8p;
+    size_t i;
+
+    sc = arg;
+    u8p = data;
+    for (i = 0; i < len; i++) {
+        streamer_cbor_put(sc, streamer_cbor_hex[u8p[i] >> 4]);
+        streamer_cbor_put(sc, streamer_cbor_hex[u8p[i] & 0xf]);
+    }
+
+    return sc->rc == 0 ? CborNoError : CborErrorIO;
+}
+
+static void
+streamer_cbor_b64_emit(struct streamer_cbor *sc, const uint8_t *b, int cnt)
+{
+    uint32_t v;
+    int i;
+
+    v = b[0] << 16;
+    if (cnt > 1) {
+        v |= b[1] << 8;
+    }
+    if (cnt > 2) {
+        v |= b[2];
+    }
+
+    /* cnt bytes make cnt + 1 characters; no padding in base64url. */
+    for (i = 0; i <= cnt; i++) {
+        streamer_cbor_put(sc, streamer_cbor_b64url[(v >> (18 - 6 * i)) & 0x3f]);
+    }
+}
+
+static CborError
+streamer_cbor_b64_chunk(void *arg, const void *data, size_t len)
+{
+    struct streamer_cbor *sc;
+    const uint8_t *u8p;
+    uint8_t b[3];
+    size_t i;
+
+    sc = arg;
+    u8p = data;
+    for (i = 0; i < len; i++) {
+        if (sc->b64_carry_len < 2) {
+            sc->b64_carry[sc->b64_carry_len++] = u8p[i];
+            continue;
+        }
+        b[0] = sc->b64_carry[0];
+        b[1] = sc->b64_carry[1];
+        b[2] = u8p[i];
+        streamer_cbor_b64_emit(sc, b, 3);
+        sc->b64_carry_len = 0;
+    }
+
+    return sc->rc == 0 ? CborNoError : CborErrorIO;
+}
+
+static CborError
+streamer_cbor_string(struct streamer_cbor *sc, CborValue *it,
+                     CborStringChunkFunction func)
+{
+    if (cbor_value_is_text_string(it)) {
+        return cbor_value_stream_text_string(it, sc->chunk, sizeof(sc->chunk),
+                                             func, sc, it);
+    }
+    return cbor_value_stream_byte_string(it, (uint8_t *)sc->chunk,
+                                         sizeof(sc->chunk), func, sc, it);
+}
+
+static void
+streamer_cbor_integer(struct streamer_cbor *sc, CborValue *it)
+{
+    uint64_t val;
+
+    cbor_value_get_raw_integer(it, &val);
+    if (cbor_value_is_unsigned_integer(it)) {
+        streamer_cbor_printf(sc, "%llu", (unsigned long long)val);
+    } else if (++val != 0) {
+        /* CBOR stores -1 - X. */
+        streamer_cbor_printf(sc, "-%llu", (unsigned long long)val);
+    } else {
+        streamer_cbor_puts(sc, "-18446744073709551616");
+    }
+}
+
+#if MYNEWT_VAL(FLOAT_USER)
+static double
+streamer_cbor_half(uint16_t half)
+{
+    int exp;
+    int mant;
+    double val;
+
+    exp = (half >> 10) & 0x1f;
+    mant = half & 0x3ff;
+    if (exp == 0) {
+        val = ldexp(mant, -24);
+    } else if (exp != 31) {
+        val = ldexp(mant + 1024, exp - 25);
+    } else {
+        val = mant == 0 ? INFINITY : NAN;
+    }
+
+    return half & 0x8000 ? -val : val;
+}
+
+static double
+streamer_cbor_float(CborValue *it)
+{
+    uint16_t f16;
+    double d;
+    float f;
+
+    switch (cbor_value_get_type(it)) {
+    case CborHalfFloatType:
+        cbor_value_get_half_float(it, &f16);
+        return streamer_cbor_half(f16);
+    case CborFloatType:
+        cbor_value_get_float(it, &f);
+        return f;
+    default:
+        cbor_value_get_double(it, &d);
+        return d;
+    }
+}
+#endif
+
+static CborError streamer_cbor_value_pretty(struct streamer_cbor *sc,
+                                            CborValue *it);
+
+static CborError
+streamer_cbor_container(struct streamer_cbor *sc, CborValue *it,
+                        CborError (*conv)(struct streamer_cbor *, CborValue *),
+                        const char *sep)
+{
+    CborValue recursed;
+    CborType type;
+    CborError err;
+    bool first;
+
+    type = cbor_value_get_type(it);
+    streamer_cbor_put(sc, type == CborArrayType ? '[' : '{');
+
+    err = cbor_value_enter_container(it, &recursed);
+    if (err) {
+        return err;
+    }
+
+    first = true;
+    while (!cbor_value_at_end(&recursed)) {
+        if (!first) {
+            streamer_cbor_puts(sc, sep);
+        }
+        first = false;
+
+        err = conv(sc, &recursed);
+        if (err) {
+            return err;
+        }
+        if (type == CborMapType) {
+            /* Only pretty printing comes here for maps. */
+            streamer_cbor_puts(sc, ": ");
+            err = conv(sc, &recursed);
+            if (err) {
+                return err;
+            }
+        }
+    }
+
+    err = cbor_value_leave_container(it, &recursed);
+    if (err) {
+        return err;
+    }
+
+    streamer_cbor_put(sc, type == CborArrayType ? ']' : '}');
+    return CborNoError;
+}
+
+static CborError
+streamer_cbor_value_pretty(struct streamer_cbor *sc, CborValue *it)
+{
+    CborError err;
+    CborTag tag;
+    uint8_t simple;
+    bool b;
+#if MYNEWT_VAL(FLOAT_USER)
+    double d;
+#endif
+
+    switch (cbor_value_get_type(it)) {
+    case CborArrayType:
+    case CborMapType:
+        return streamer_cbor_container(sc, it, streamer_cbor_value_pretty,
+                                       ", ");
+
+    case CborIntegerType:
+        streamer_cbor_integer(sc, it);
+        break;
+
+    case CborByteStringType:
+        streamer_cbor_puts(sc, "h'");
+        err = streamer_cbor_string(sc, it, streamer_cbor_hex_chunk);
+        streamer_cbor_put(sc, '\'');
+        return err;
+
+    case CborTextStringType:
+        streamer_cbor_put(sc, '"');
+        err = streamer_cbor_string(sc, it, streamer_cbor_text_chunk);
+        streamer_cbor_put(sc, '"');
+        return err;
+
+    case CborTagType:
+        cbor_value_get_tag(it, &tag);
+        streamer_cbor_printf(sc, "%llu(", (unsigned long long)tag);
+        err = cbor_value_advance_fixed(it);
+        if (err) {
+            return err;
+        }
+        err = streamer_cbor_value_pretty(sc, it);
+        streamer_cbor_put(sc, ')');
+        return err;
+
+    case CborSimpleType:
+        cbor_value_get_simple_type(it, &simple);
+        streamer_cbor_printf(sc, "simple(%u)", simple);
+        break;
+
+    case CborNullType:
+        streamer_cbor_puts(sc, "null");
+        break;
+
+    case CborUndefinedType:
+        streamer_cbor_puts(sc, "undefined");
+        break;
+
+    case CborBooleanType:
+        cbor_value_get_boolean(it, &b);
+        streamer_cbor_puts(sc, b ? "true" : "false");
+        break;
+
+#if MYNEWT_VAL(FLOAT_USER)
+    case CborHalfFloatType:
+    case CborFloatType:
+    case CborDoubleType:
+        d = streamer_cbor_float(it);
+        streamer_cbor_printf(sc, "%g", d);
+        break;
+#endif
+
+    default:
+        streamer_cbor_puts(sc, "invalid");
+        return CborErrorUnknownType;
+    }
+
+    return cbor_value_advance_fixed(it);
+}
+
+static CborError streamer_cbor_value_json(struct streamer_cbor *sc,
+                                          CborValue *it);
+
+/* JSON object keys have to be strings. */
+static CborError
+streamer_cbor_key_json(struct streamer_cbor *sc, CborValue *it)
+{
+    CborError err;
+
+    if (cbor_value_is_text_string(it)) {
+        return streamer_cbor_value_json(sc, it);
+    }
+    if (!(sc->flags & CborConvertStringifyMapKeys)) {
+        return CborErrorJsonObjectKeyNotString;
+    }
+
+    streamer_cbor_put(sc, '"');
+    sc->in_key = true;
+    err = streamer_cbor_value_pretty(sc, it);
+    sc->in_key = false;
+    streamer_cbor_put(sc, '"');
+    return err;
+}
+
+static CborError
+streamer_cbor_map_json(struct streamer_cbor *sc, CborValue *it)
+{
+    CborValue recursed;
+    CborError err;
+    bool first;
+
+    streamer_cbor_put(sc, '{');
+
+    err = cbor_value_enter_container(it, &recursed);
+    if (err) {
+        return err;
+    }
+
+    first = true;
+    while (!cbor_value_at_end(&recursed)) {
+        if (!first) {
+            streamer_cbor_put(sc, ',');
+        }
+        first = false;
+
+        err = streamer_cbor_key_json(sc, &recursed);
+        if (err) {
+            return err;
+        }
+        streamer_cbor_put(sc, ':');
+        err = streamer_cbor_value_json(sc, &recursed);
+        if (err) {
+            return err;
+        }
+    }
+
+    err = cbor_value_leave_container(it, &recursed);
+    if (err) {
+        return err;
+    }
+
+    streamer_cbor_put(sc, '}');
+    return CborNoError;
+}
+
+static CborError
+streamer_cbor_value_json(struct streamer_cbor *sc, CborValue *it)
+{
+    CborError err;
+    uint8_t simple;
+    bool b;
+#if MYNEWT_VAL(FLOAT_USER)
+    double d;
+#endif
+
+    switch (cbor_value_get_type(it)) {
+    case CborArrayType:
+        return streamer_cbor_container(sc, it, streamer_cbor_value_json, ",");
+
+    case CborMapType:
+        return streamer_cbor_map_json(sc, it);
+
+    case CborIntegerType:
+        streamer_cbor_integer(sc, it);
+        break;
+
+    case CborByteStringType:
+        streamer_cbor_put(sc, '"');
+        sc->b64_carry_len = 0;
+        err = streamer_cbor_string(sc, it, streamer_cbor_b64_chunk);
+        if (sc->b64_carry_len != 0) {
+            streamer_cbor_b64_emit(sc, sc->b64_carry, sc->b64_carry_len);
+        }
+        streamer_cbor_put(sc, '"');
+        return err;
+
+    case CborTextStringType:
+        streamer_cbor_put(sc, '"');
+        err = streamer_cbor_string(sc, it, streamer_cbor_text_chunk);
+        streamer_cbor_put(sc, '"');
+        return err;
+
+    case CborTagType:
+        /* Tags are dropped; the tagged value is converted. */
+        err = cbor_value_skip_tag(it);
+        if (err) {
+            return err;
+        }
+        return streamer_cbor_value_json(sc, it);
+
+    case CborSimpleType:
+        cbor_value_get_simple_type(it, &simple);
+        streamer_cbor_printf(sc, "\"simple(%u)\"", simple);
+        break;
+
+    case CborNullType:
+        streamer_cbor_puts(sc, "null");
+        break;
+
+    case CborUndefinedType:
+        streamer_cbor_puts(sc, "\"undefined\"");
+        break;
+
+    case CborBooleanType:
+        cbor_value_get_boolean(it, &b);
+        streamer_cbor_puts(sc, b ? "true" : "false");
+        break;
+
+#if MYNEWT_VAL(FLOAT_USER)
+    case CborHalfFloatType:
+    case CborFloatType:
+    case CborDoubleType:
+        d = streamer_cbor_float(it);
+        if (isfinite(d)) {
+            streamer_cbor_printf(sc, "%.17g", d);
+        } else {
+            streamer_cbor_puts(sc, "null");
+        }
+        break;
+#endif
+
+    default:
+        return CborErrorUnknownType;
+    }
+
+    return cbor_value_advance_fixed(it);
+}
+
+static int
+streamer_cbor_run(struct streamer *streamer, const CborValue *value,
+                  int flags,
+                  CborError (*conv)(struct streamer_cbor *, CborValue *))
+{
+    struct streamer_cbor sc;
+    CborValue it;
+    CborError err;
+
+    sc.streamer = streamer;
+    sc.flags = flags;
+    sc.rc = 0;
+    sc.in_key = false;
+    sc.b64_carry_len = 0;
+    sc.out_len = 0;
+
+    it = *value;
+    err = conv(&sc, &it);
+    streamer_cbor_flush(&sc);
+
+    if (sc.rc != 0) {
+        return sc.rc;
+    }
+    if (err != CborNoError) {
+        return SYS_EINVAL;
+    }
+    return 0;
+}
+
+int
+streamer_cbor_pretty(struct streamer *streamer, const struct CborValue *value)
+{
+    return streamer_cbor_run(streamer, value, 0, streamer_cbor_value_pretty);
+}
+
+int
+streamer_cbor_json(struct streamer *streamer, const struct CborValue *value,
+                   int flags)
+{
+    return streamer_cbor_run(streamer, value, flags, streamer_cbor_value_json);
+}
+
+#endif
@@ -17,35 +17,219 @@
  * under the License.
  */
 
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
 #include "os/mynewt.h"
 #include "streamer/streamer.h"
 
+/*
+ * Returns the last mbuf of the chain.  The streamer remembers it, so a
+ * write does not walk the chain; anything appended behind its back is
+ * skipped over here.
+ */
+static struct os_mbuf *
+streamer_mbuf_last(struct streamer_mbuf *sm)
+{
+    while (SLIST_NEXT(sm->last, om_next) != NULL) {
+        sm->last = SLIST_NEXT(sm->last, om_next);
+    }
+
+    return sm->last;
+}
+
+/*
+ * Adds an empty mbuf to the end of the chain.  A chain that came from msys
+ * grows with a block from the biggest msys pool, or from any pool with a
+ * free block if the biggest has none, so a long output ends up in few
+ * large blocks.  Other chains grow from their own pool.
+ */
+static struct os_mbuf *
+streamer_mbuf_grow(struct streamer_mbuf *sm)
+{
+    struct os_mbuf *last;
+    struct os_mbuf *om;
+
+    last = streamer_mbuf_last(sm);
+    if (sm->msys) {
+        om = os_msys_get(0, 0);
+        if (om == NULL) {
+            om = os_msys_get(1, 0);
+        }
+    } else {
+        om = os_mbuf_get(sm->om->om_omp, 0);
+    }
+    if (om == NULL) {
+        return NULL;
+    }
+
+    SLIST_NEXT(last, om_next) = om;
+    sm->last = om;
+
+    return om;
+}
+
+/*
+ * Returns the mbuf at the end of the chain with trailing space, growing the
+ * chain if needed.
+ */
+static struct os_mbuf *
+streamer_mbuf_tail(struct streamer_mbuf *sm)
+{
+    struct os_mbuf *last;
+
+    last = streamer_mbuf_last(sm);
+    if (OS_MBUF_TRAILINGSPACE(last) == 0) {
+        last = streamer_mbuf_grow(sm);
+    }
+
+    return last;
+}
+
+/* Accounts for len bytes placed in the trailing space of the given mbuf. */
+static void
+streamer_mbuf_commit(struct streamer_mbuf *sm, struct os_mbuf *om, int len)
+{
+    om->om_len += len;
+    if (OS_MBUF_IS_PKTHDR(sm->om)) {
+        OS_MBUF_PKTHDR(sm->om)->omp_len += len;
+    }
+}
+
 static int
 streamer_mbuf_write(struct streamer *streamer, const void *src, size_t len)
 {
     struct streamer_mbuf *sm;
-    int rc;
+    struct os_mbuf *last;
+    const uint8_t *u8p;
+    size_t chunk;
 
     if (len > UINT16_MAX) {
         return SYS_EINVAL;
     }
 
     sm = (struct streamer_mbuf *)streamer;
-    rc = os_mbuf_append(sm->om, src, len);
-    if (rc != 0) {
-        return os_error_to_sys(rc);
+    u8p = src;
+    while (len > 0) {
+        last = streamer_mbuf_tail(sm);
+        if (last == NULL) {
+            return SYS_ENOMEM;
+        }
+
+        chunk = min(len, OS_MBUF_TRAILINGSPACE(last));
+        memcpy(OS_MBUF_DATA(last, uint8_t *) + last->om_len, u8p, chunk);
+        streamer_mbuf_commit(sm, last, chunk);
+        u8p += chunk;
+        len -= chunk;
     }
 
     return 0;
 }
 
+#if MYNEWT_VAL(BASELIBC_PRESENT)
+
+/*
+ * With baselibc, formatted text is appended to the chain span by span as
+ * the formatter produces it; no intermediate buffer, and no length limit.
+ */
+struct streamer_mbuf_file {
+    struct File file;
+    struct streamer *streamer;
+    int rc;
+};
+
+static size_t
+streamer_mbuf_file_write(FILE *fp, const char *bp, size_t n)
+{
+    struct streamer_mbuf_file *smf;
+
+    smf = (struct streamer_mbuf_file *)fp;
+    if (smf->rc == 0) {
+        smf->rc = streamer_mbuf_write(smf->streamer, bp, n);
+    }
+
+    return smf->rc == 0 ? n : 0;
+}
+
+static const struct File_methods streamer_mbuf_file_methods = {
+    .write = streamer_mbuf_file_write,
+};
+
+static int
+streamer_mbuf_vprintf(struct streamer *streamer, const char *fmt, va_list ap)
+{
+    struct streamer_mbuf_file smf = {
+        .file.vmt = &streamer_mbuf_file_methods,
+        .streamer = streamer,
+    };
+    int num_chars;
+
+    num_chars = vfprintf(&smf.file, fmt, ap);
+    if (smf.rc != 0) {
+        return smf.rc;
+    }
+
+    return num_chars;
+}
+
+#else
+
+/*
+ * Formats straight into the trailing space of the chain.  Text that does not
+ * fit is formatted again into a fresh block, and the part that fits moved
+ * back to the previous one.  Only text longer than a whole block goes
+ * through a temporary buffer, and is cut at STREAMER_MBUF_PRINTF_MAX.
+ */
 static int
 streamer_mbuf_vprintf(struct streamer *streamer, const char *fmt, va_list ap)
 {
     char buf[MYNEWT_VAL(STREAMER_MBUF_PRINTF_MAX)];
+    struct streamer_mbuf *sm;
+    struct os_mbuf *last;
+    struct os_mbuf *om;
+    va_list ap2;
+    uint8_t *dst;
     int num_chars;
+    int space;
     int rc;
 
+    sm = (struct streamer_mbuf *)streamer;
+
+    last = streamer_mbuf_tail(sm);
+    if (last == NULL) {
+        return SYS_ENOMEM;
+    }
+
+    /* vsnprintf() needs room for the null terminator, which is not kept. */
+    space = OS_MBUF_TRAILINGSPACE(last);
+    dst = OS_MBUF_DATA(last, uint8_t *) + last->om_len;
+    va_copy(ap2, ap);
+    num_chars = vsnprintf((char *)dst, space, fmt, ap2);
+    va_end(ap2);
+    if (num_chars < 0) {
+        return SYS_EINVAL;
+    }
+    if (num_chars < space) {
+        streamer_mbuf_commit(sm, last, num_chars);
+        return num_chars;
+    }
+
+    om = streamer_mbuf_grow(sm);
+    if (om == NULL) {
+        return SYS_ENOMEM;
+    }
+    if (num_chars < OS_MBUF_TRAILINGSPACE(om)) {
+        vsnprintf(OS_MBUF_DATA(om, char *), num_chars + 1, fmt, ap);
+
+        /* Fill the previous block first. */
+        memcpy(dst, OS_MBUF_DATA(om, uint8_t *), space);
+        memmove(OS_MBUF_DATA(om, uint8_t *),
+                OS_MBUF_DATA(om, uint8_t *) + space, num_chars - space);
+        streamer_mbuf_commit(sm, last, space);
+        streamer_mbuf_commit(sm, om, num_chars - space);
+        return num_chars;
+    }
+
     num_chars = vsnprintf(buf, sizeof buf, fmt, ap);
     if (num_chars > sizeof buf - 1) {
         num_chars = sizeof buf - 1;
@@ -59,6 +243,8 @@ streamer_mbuf_vprintf(struct streamer *streamer, const char *fmt, va_list ap)
     return num_chars;
 }
 
+#endif
+
 static const struct streamer_cfg streamer_cfg_mbuf = {
     .write_cb = streamer_mbuf_write,
     .vprintf_cb = streamer_mbuf_vprintf,
@@ -74,6 +260,7 @@ streamer_mbuf_new(struct streamer_mbuf *sm, struct os_mbuf *om)
     *sm = (struct streamer_mbuf) {
         .streamer.cfg = &streamer_cfg_mbuf,
         .om = om,
+        .last = om,
     };
 
     return 0;
@@ -92,8 +279,10 @@ streamer_msys_new(struct streamer_mbuf *sm)
 
     rc = streamer_mbuf_new(sm, om);
     if (rc != 0) {
+        os_mbuf_free_chain(om);
         return rc;
     }
+    sm->msys = 1;
 
     return 0;
 }
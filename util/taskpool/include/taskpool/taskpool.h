@@ -81,4 +81,91 @@ int taskpool_wait(os_time_t max_ticks);
  */
 void taskpool_wait_assert(os_time_t max_ticks);
 
+#if MYNEWT_VAL(TASKPOOL_WORKER_NUM) > 0
+
+/**
+ * @brief A job function executed by a worker task.
+ *
+ * @param arg                   The argument passed to taskpool_submit().
+ *
+ * @return                      The job's result, reported by
+ *                                  taskpool_join().
+ */
+typedef int taskpool_job_fn(void *arg);
+
+/**
+ * @brief A unit of work queued on the worker pool.
+ *
+ * The caller owns the storage, which must remain valid until
+ * taskpool_join() returns 0 or taskpool_cancel() returns 0.  A job whose
+ * join timed out is still queued or running; its storage must not be
+ * reused until one of those calls succeeds.  All fields should be
+ * considered private.
+ */
+struct taskpool_job {
+    TAILQ_ENTRY(taskpool_job) tj_next;
+    taskpool_job_fn *tj_fn;
+    void *tj_arg;
+    struct os_sem tj_done;
+    int tj_rc;
+    uint8_t tj_state;
+    uint8_t tj_worker;
+};
+
+/**
+ * @brief Queues a job on the persistent worker pool.
+ *
+ * When called from a worker task, the job goes on that worker's own queue;
+ * otherwise jobs are spread round-robin over the workers.  A worker that
+ * runs out of jobs of its own takes the oldest job queued on another
+ * worker, so a worker blocked in a long job does not hold up the jobs
+ * behind it.
+ *
+ * @param job                   Storage for the job.
+ * @param fn                    The function to execute.
+ * @param arg                   The argument to pass to the function.
+ *
+ * @return                      0 on success; SYS_EINVAL on error.
+ */
+int taskpool_submit(struct taskpool_job *job, taskpool_job_fn *fn, void *arg);
+
+/**
+ * @brief Waits for a job to complete and retrieves its result.
+ *
+ * If no worker has started the job yet, it is run immediately in the
+ * calling task instead.  This keeps workers that wait on the jobs they
+ * submitted from deadlocking the pool.
+ *
+ * On timeout the job is running in a worker and keeps using its storage.
+ * Join it again, or keep the storage alive for as long as the pool runs.
+ *
+ * @param job                   The job to wait on.
+ * @param max_ticks             The maximum duration to wait before the wait
+ *                                  operation times out.  Units are OS ticks.
+ * @param out_rc                On success, the job's result gets written
+ *                                  here.  Pass NULL if you don't require
+ *                                  this information.
+ *
+ * @return                      0 on success;
+ *                              OS_TIMEOUT on timeout.
+ */
+int taskpool_join(struct taskpool_job *job, os_time_t max_ticks,
+                  int *out_rc);
+
+/**
+ * @brief Removes a job that no worker has started yet.
+ *
+ * On success the job will not run and its storage may be reused
+ * immediately.
+ *
+ * @param job                   The job to cancel.
+ *
+ * @return                      0 if the job was removed from its queue;
+ *                              SYS_EBUSY if the job is running;
+ *                              SYS_EALREADY if the job has completed.
+ */
+int taskpool_cancel(struct taskpool_job *job);
+
+#endif
+
 #endif
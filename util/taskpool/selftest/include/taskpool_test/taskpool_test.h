@@ -0,0 +1,57 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef H_TASKPOOL_TEST_
+#define H_TASKPOOL_TEST_
+
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+#include "taskpool/taskpool.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Records where and when a test job ran. */
+struct taskpool_test_rec {
+    /* The task that ran the job; NULL if the job has not run. */
+    struct os_task *task;
+
+    /* Order in which the job ran, starting at 1. */
+    int seq;
+};
+
+/* Released by a test to let taskpool_test_block() jobs finish. */
+extern struct os_sem taskpool_test_block_sem;
+
+/* Job functions; arg is a struct taskpool_test_rec.  Both return seq. */
+int taskpool_test_record(void *arg);
+int taskpool_test_block(void *arg);
+
+TEST_CASE_DECL(taskpool_test_submit_join);
+TEST_CASE_DECL(taskpool_test_join_inline);
+TEST_CASE_DECL(taskpool_test_steal);
+TEST_CASE_DECL(taskpool_test_cancel);
+TEST_SUITE_DECL(taskpool_test_suite);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
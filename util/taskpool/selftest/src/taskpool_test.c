@@ -0,0 +1,77 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "taskpool_test/taskpool_test.h"
+
+struct os_sem taskpool_test_block_sem;
+
+static int taskpool_test_seq;
+
+int
+taskpool_test_record(void *arg)
+{
+    struct taskpool_test_rec *rec;
+
+    rec = arg;
+    rec->task = os_sched_get_current_task();
+    rec->seq = ++taskpool_test_seq;
+
+    return rec->seq;
+}
+
+int
+taskpool_test_block(void *arg)
+{
+    int rc;
+
+    /* Runs in a worker; a fatal assert cannot unwind from here. */
+    rc = os_sem_pend(&taskpool_test_block_sem, OS_TIMEOUT_NEVER);
+    TEST_ASSERT(rc == 0);
+
+    return taskpool_test_record(arg);
+}
+
+static void
+taskpool_test_pre(void *arg)
+{
+    int rc;
+
+    rc = os_sem_init(&taskpool_test_block_sem, 0);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    taskpool_test_seq = 0;
+}
+
+TEST_SUITE(taskpool_test_suite)
+{
+    tu_suite_set_pre_test_cb(taskpool_test_pre, NULL);
+
+    taskpool_test_submit_join();
+    taskpool_test_join_inline();
+    taskpool_test_steal();
+    taskpool_test_cancel();
+}
+
+int
+main(int argc, char **argv)
+{
+    taskpool_test_suite();
+
+    return tu_any_failed;
+}
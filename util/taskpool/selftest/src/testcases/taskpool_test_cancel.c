@@ -0,0 +1,71 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "taskpool_test/taskpool_test.h"
+
+TEST_CASE_TASK(taskpool_test_cancel)
+{
+    struct taskpool_test_rec a;
+    struct taskpool_test_rec b;
+    struct taskpool_test_rec c;
+    struct taskpool_job job_a;
+    struct taskpool_job job_b;
+    struct taskpool_job job_c;
+    int job_rc;
+    int rc;
+
+    memset(&a, 0, sizeof a);
+    memset(&b, 0, sizeof b);
+    memset(&c, 0, sizeof c);
+
+    /* Block both workers so that job c stays queued. */
+    rc = taskpool_submit(&job_a, taskpool_test_block, &a);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = taskpool_submit(&job_b, taskpool_test_block, &b);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = taskpool_submit(&job_c, taskpool_test_record, &c);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = taskpool_cancel(&job_c);
+    TEST_ASSERT(rc == 0);
+    rc = taskpool_cancel(&job_a);
+    TEST_ASSERT(rc == SYS_EBUSY);
+
+    os_sem_release(&taskpool_test_block_sem);
+    os_sem_release(&taskpool_test_block_sem);
+
+    rc = taskpool_join(&job_a, OS_TICKS_PER_SEC, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = taskpool_join(&job_b, OS_TICKS_PER_SEC, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = taskpool_cancel(&job_a);
+    TEST_ASSERT(rc == SYS_EALREADY);
+
+    /* The cancelled job never ran, and its storage can be reused. */
+    TEST_ASSERT(c.task == NULL);
+
+    rc = taskpool_submit(&job_c, taskpool_test_record, &c);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = taskpool_join(&job_c, OS_TICKS_PER_SEC, &job_rc);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(c.seq == 3);
+    TEST_ASSERT(job_rc == 3);
+}
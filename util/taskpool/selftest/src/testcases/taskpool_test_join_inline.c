@@ -0,0 +1,77 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "taskpool_test/taskpool_test.h"
+
+/*
+ * With both workers blocked, a join times out on a running job and runs a
+ * queued job in the calling task.
+ */
+TEST_CASE_TASK(taskpool_test_join_inline)
+{
+    struct taskpool_test_rec a;
+    struct taskpool_test_rec b;
+    struct taskpool_test_rec c;
+    struct taskpool_job job_a;
+    struct taskpool_job job_b;
+    struct taskpool_job job_c;
+    struct os_task *self;
+    int job_rc;
+    int rc;
+
+    memset(&a, 0, sizeof a);
+    memset(&b, 0, sizeof b);
+    memset(&c, 0, sizeof c);
+    self = os_sched_get_current_task();
+
+    rc = taskpool_submit(&job_a, taskpool_test_block, &a);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = taskpool_submit(&job_b, taskpool_test_block, &b);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = taskpool_submit(&job_c, taskpool_test_record, &c);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /* Both workers are blocked; nothing has run yet. */
+    TEST_ASSERT(a.task == NULL);
+    TEST_ASSERT(b.task == NULL);
+    TEST_ASSERT(c.task == NULL);
+
+    rc = taskpool_join(&job_a, 1, NULL);
+    TEST_ASSERT(rc == OS_TIMEOUT);
+
+    rc = taskpool_join(&job_c, 0, &job_rc);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(c.task == self);
+    TEST_ASSERT(c.seq == 1);
+    TEST_ASSERT(job_rc == 1);
+
+    os_sem_release(&taskpool_test_block_sem);
+    os_sem_release(&taskpool_test_block_sem);
+
+    rc = taskpool_join(&job_a, OS_TICKS_PER_SEC, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = taskpool_join(&job_b, OS_TICKS_PER_SEC, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    TEST_ASSERT(a.task != NULL && a.task != self);
+    TEST_ASSERT(b.task != NULL && b.task != self);
+    TEST_ASSERT(a.task != b.task);
+    TEST_ASSERT(a.seq + b.seq == 2 + 3);
+}
@@ -0,0 +1,89 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "taskpool_test/taskpool_test.h"
+
+static struct taskpool_job taskpool_test_children[2];
+static struct taskpool_test_rec taskpool_test_child_recs[2];
+static struct os_task *taskpool_test_parent_task;
+
+/*
+ * Queues two children on this worker's own queue, then blocks.  The
+ * children can only run if the other worker takes them.
+ */
+static int
+taskpool_test_steal_parent(void *arg)
+{
+    int rc;
+    int i;
+
+    taskpool_test_parent_task = os_sched_get_current_task();
+
+    for (i = 0; i < 2; i++) {
+        rc = taskpool_submit(&taskpool_test_children[i], taskpool_test_record,
+                             &taskpool_test_child_recs[i]);
+        TEST_ASSERT(rc == 0);
+    }
+
+    rc = os_sem_pend(&taskpool_test_block_sem, OS_TIMEOUT_NEVER);
+    TEST_ASSERT(rc == 0);
+
+    for (i = 0; i < 2; i++) {
+        rc = taskpool_join(&taskpool_test_children[i], 0, NULL);
+        TEST_ASSERT(rc == 0);
+    }
+
+    return 0;
+}
+
+TEST_CASE_TASK(taskpool_test_steal)
+{
+    struct taskpool_test_rec *rec;
+    struct taskpool_job parent;
+    struct os_task *self;
+    int job_rc;
+    int rc;
+    int i;
+
+    memset(taskpool_test_child_recs, 0, sizeof taskpool_test_child_recs);
+    taskpool_test_parent_task = NULL;
+    self = os_sched_get_current_task();
+
+    rc = taskpool_submit(&parent, taskpool_test_steal_parent, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /* The test task runs again only once every worker is idle or blocked. */
+    TEST_ASSERT_FATAL(taskpool_test_parent_task != NULL);
+    for (i = 0; i < 2; i++) {
+        rec = &taskpool_test_child_recs[i];
+
+        /* Stolen oldest first. */
+        TEST_ASSERT(rec->seq == i + 1);
+        TEST_ASSERT(rec->task != NULL);
+        TEST_ASSERT(rec->task != taskpool_test_parent_task);
+        TEST_ASSERT(rec->task != self);
+    }
+
+    os_sem_release(&taskpool_test_block_sem);
+
+    rc = taskpool_join(&parent, OS_TICKS_PER_SEC, &job_rc);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(job_rc == 0);
+}
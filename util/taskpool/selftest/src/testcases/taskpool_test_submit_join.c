@@ -0,0 +1,55 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "taskpool_test/taskpool_test.h"
+
+TEST_CASE_TASK(taskpool_test_submit_join)
+{
+    struct taskpool_test_rec recs[4];
+    struct taskpool_job jobs[4];
+    struct os_task *self;
+    int job_rc;
+    int rc;
+    int i;
+
+    memset(recs, 0, sizeof recs);
+    self = os_sched_get_current_task();
+
+    rc = taskpool_submit(NULL, taskpool_test_record, &recs[0]);
+    TEST_ASSERT(rc == SYS_EINVAL);
+    rc = taskpool_submit(&jobs[0], NULL, &recs[0]);
+    TEST_ASSERT(rc == SYS_EINVAL);
+
+    for (i = 0; i < 4; i++) {
+        rc = taskpool_submit(&jobs[i], taskpool_test_record, &recs[i]);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+
+    for (i = 0; i < 4; i++) {
+        rc = taskpool_join(&jobs[i], OS_TICKS_PER_SEC, &job_rc);
+        TEST_ASSERT_FATAL(rc == 0);
+        TEST_ASSERT(job_rc == recs[i].seq);
+
+        /* The workers preempt the test task, so each job ran on submit. */
+        TEST_ASSERT(recs[i].seq == i + 1);
+        TEST_ASSERT(recs[i].task != NULL);
+        TEST_ASSERT(recs[i].task != self);
+    }
+}
@@ -246,6 +246,233 @@ taskpool_wait_assert(os_time_t max_ticks)
     assert(rc == 0);
 }
 
+#if MYNEWT_VAL(TASKPOOL_WORKER_NUM) > 0
+
+#define TASKPOOL_JOB_QUEUED     1
+#define TASKPOOL_JOB_RUNNING    2
+#define TASKPOOL_JOB_DONE       3
+
+/** A persistent worker task with its own job queue. */
+struct taskpool_worker {
+    OS_TASK_STACK_DEFINE_NOSTATIC(stack,
+                                  MYNEWT_VAL(TASKPOOL_WORKER_STACK_SIZE));
+    struct os_task task;
+    TAILQ_HEAD(taskpool_job_list, taskpool_job) jobs;
+    char name[sizeof "workerXX"];
+};
+
+static struct taskpool_worker
+    taskpool_workers[MYNEWT_VAL(TASKPOOL_WORKER_NUM)];
+
+/** Counts queued jobs across all workers. */
+static struct os_sem taskpool_work_sem;
+
+/** Next worker to receive a job submitted from outside the pool. */
+static uint8_t taskpool_next_worker;
+
+/**
+ * Returns the index of the worker running as the current task, or -1 if
+ * the current task is not a worker.
+ */
+static int
+taskpool_cur_worker(void)
+{
+    struct os_task *cur;
+    int i;
+
+    cur = os_sched_get_current_task();
+    for (i = 0; i < MYNEWT_VAL(TASKPOOL_WORKER_NUM); i++) {
+        if (cur == &taskpool_workers[i].task) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * Takes a job off the queues.  A worker first takes the newest job from its
+ * own queue, then the oldest job from any other queue.  Must be called with
+ * interrupts disabled.
+ */
+static struct taskpool_job *
+taskpool_job_take(int self)
+{
+    struct taskpool_job *job;
+    int i;
+
+    job = TAILQ_LAST(&taskpool_workers[self].jobs, taskpool_job_list);
+    if (job == NULL) {
+        for (i = 1; i < MYNEWT_VAL(TASKPOOL_WORKER_NUM); i++) {
+            job = TAILQ_FIRST(&taskpool_workers[
+                (self + i) % MYNEWT_VAL(TASKPOOL_WORKER_NUM)].jobs);
+            if (job != NULL) {
+                break;
+            }
+        }
+    }
+
+    if (job != NULL) {
+        TAILQ_REMOVE(&taskpool_workers[job->tj_worker].jobs, job, tj_next);
+        job->tj_state = TASKPOOL_JOB_RUNNING;
+    }
+
+    return job;
+}
+
+static void
+taskpool_job_run(struct taskpool_job *job)
+{
+    job->tj_rc = job->tj_fn(job->tj_arg);
+    job->tj_state = TASKPOOL_JOB_DONE;
+    os_sem_release(&job->tj_done);
+}
+
+static void
+taskpool_worker_handler(void *arg)
+{
+    struct taskpool_job *job;
+    os_sr_t sr;
+    int self;
+
+    self = (int)(intptr_t)arg;
+
+    while (1) {
+        os_sem_pend(&taskpool_work_sem, OS_TIMEOUT_NEVER);
+
+        OS_ENTER_CRITICAL(sr);
+        job = taskpool_job_take(self);
+        OS_EXIT_CRITICAL(sr);
+
+        /* The job may already have been run by a joiner. */
+        if (job != NULL) {
+            taskpool_job_run(job);
+        }
+    }
+}
+
+int
+taskpool_submit(struct taskpool_job *job, taskpool_job_fn *fn, void *arg)
+{
+    os_sr_t sr;
+    int worker;
+    int rc;
+
+    if (job == NULL || fn == NULL) {
+        return SYS_EINVAL;
+    }
+
+    job->tj_fn = fn;
+    job->tj_arg = arg;
+    job->tj_rc = 0;
+    rc = os_sem_init(&job->tj_done, 0);
+    if (rc != 0) {
+        return SYS_EINVAL;
+    }
+
+    worker = taskpool_cur_worker();
+
+    OS_ENTER_CRITICAL(sr);
+    if (worker == -1) {
+        worker = taskpool_next_worker;
+        taskpool_next_worker =
+            (taskpool_next_worker + 1) % MYNEWT_VAL(TASKPOOL_WORKER_NUM);
+    }
+    job->tj_worker = worker;
+    job->tj_state = TASKPOOL_JOB_QUEUED;
+    TAILQ_INSERT_TAIL(&taskpool_workers[worker].jobs, job, tj_next);
+    OS_EXIT_CRITICAL(sr);
+
+    os_sem_release(&taskpool_work_sem);
+
+    return 0;
+}
+
+int
+taskpool_join(struct taskpool_job *job, os_time_t max_ticks, int *out_rc)
+{
+    os_sr_t sr;
+    int run;
+    int rc;
+
+    OS_ENTER_CRITICAL(sr);
+    run = job->tj_state == TASKPOOL_JOB_QUEUED;
+    if (run) {
+        TAILQ_REMOVE(&taskpool_workers[job->tj_worker].jobs, job, tj_next);
+        job->tj_state = TASKPOOL_JOB_RUNNING;
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    if (run) {
+        taskpool_job_run(job);
+    }
+
+    rc = os_sem_pend(&job->tj_done, max_ticks);
+    if (rc != 0) {
+        return rc;
+    }
+
+    if (out_rc != NULL) {
+        *out_rc = job->tj_rc;
+    }
+
+    return 0;
+}
+
+int
+taskpool_cancel(struct taskpool_job *job)
+{
+    os_sr_t sr;
+    int rc;
+
+    OS_ENTER_CRITICAL(sr);
+    switch (job->tj_state) {
+    case TASKPOOL_JOB_QUEUED:
+        /* The worker woken for this job finds its queue empty. */
+        TAILQ_REMOVE(&taskpool_workers[job->tj_worker].jobs, job, tj_next);
+        job->tj_state = 0;
+        rc = 0;
+        break;
+
+    case TASKPOOL_JOB_RUNNING:
+        rc = SYS_EBUSY;
+        break;
+
+    default:
+        rc = SYS_EALREADY;
+        break;
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    return rc;
+}
+
+static void
+taskpool_worker_init(void)
+{
+    struct taskpool_worker *worker;
+    int rc;
+    int i;
+
+    rc = os_sem_init(&taskpool_work_sem, 0);
+    SYSINIT_PANIC_ASSERT(rc == 0 || rc == OS_NOT_STARTED);
+
+    for (i = 0; i < MYNEWT_VAL(TASKPOOL_WORKER_NUM); i++) {
+        worker = &taskpool_workers[i];
+
+        TAILQ_INIT(&worker->jobs);
+        snprintf(worker->name, sizeof worker->name, "worker%02d", i);
+
+        rc = os_task_init(&worker->task, worker->name,
+                          taskpool_worker_handler, (void *)(intptr_t)i,
+                          MYNEWT_VAL(TASKPOOL_WORKER_PRIO) + i,
+                          OS_WAIT_FOREVER, worker->stack,
+                          MYNEWT_VAL(TASKPOOL_WORKER_STACK_SIZE));
+        SYSINIT_PANIC_ASSERT(rc == 0);
+    }
+}
+#endif
+
 void
 taskpool_init(void)
 {
@@ -264,4 +491,8 @@ taskpool_init(void)
     for (i = 0; i < MYNEWT_VAL(TASKPOOL_NUM_TASKS); i++) {
         taskpool_entries[i].state = TASKPOOL_STATE_UNUSED;
     }
+
+#if MYNEWT_VAL(TASKPOOL_WORKER_NUM) > 0
+    taskpool_worker_init();
+#endif
 }